@@ -174,6 +174,10 @@ struct ruleset_item {
                                    * pool?  If this is NULL or "default", the
                                    * default SQL engine pool will be used. */
 
+  int priorityClass;              /* If non-zero, the priority class to be
+                                   * used for the request when it is queued
+                                   * within its SQL engine pool. */
+
   enum ruleset_flags flags;       /* The behavioral flags associated with the
                                    * rule, e.g. stop-on-match, etc. */
 
@@ -204,6 +208,9 @@ struct ruleset {
 
   struct ruleset_item *aRule;     /* An array of rules with a minimum size of
                                    * nRule. */
+
+  struct ruleset_cache *pCache;   /* Results of evaluating this ruleset, by
+                                   * client, see comdb2_evaluate_ruleset(). */
 };
 
 struct ruleset_result {
@@ -222,6 +229,11 @@ struct ruleset_result {
                                    * is not NULL, it must be freed by the
                                    * owner of this structure. */
 
+  int priorityClass;              /* What will the final priority class be
+                                   * for this ruleset?  This is taken from
+                                   * the final matched rule with a class;
+                                   * zero is the default class. */
+
   int ruleNo;                     /* Which rule, if any, was the primary one
                                    * responsible for the result action? */
 };
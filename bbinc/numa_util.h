@@ -0,0 +1,39 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_NUMA_UTIL_H
+#define INCLUDED_NUMA_UTIL_H
+
+#include <stddef.h>
+
+/* Minimal NUMA helpers read straight from sysfs; no libnuma dependency.
+ * On hosts without NUMA information everything reports a single node and
+ * the bind/pin calls are no-ops. */
+
+/* Number of online memory nodes (>= 1). */
+int comdb2_numa_nodes(void);
+
+/* Prefer placing the pages of [addr, addr + len) on node.  Pages already
+ * faulted in are migrated.  Returns 0 on success. */
+int comdb2_numa_bind_memory(void *addr, size_t len, int node);
+
+/* Restrict the calling thread to the cpus of node.  Returns 0 on success. */
+int comdb2_numa_pin_thread(int node);
+
+/* Hand out nodes round-robin, for spreading threads or regions. */
+int comdb2_numa_next_node(void);
+
+#endif
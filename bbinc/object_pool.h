@@ -86,6 +86,16 @@
 ** be paired with a return call. Borrowing without returning will exhaust
 ** the pool, eventually. However, never return an object that was not borrowed
 ** from the pool. The behavior is undefined and very dangerous.
+**
+** A generic object pool can be configured to keep a small cache of returned
+** objects per thread (OP_THREAD_CACHE). A thread's borrows are served from
+** its own cache first and its returns go there while there is room, without
+** taking the pool mutex. Cached objects still count as active objects of the
+** pool. A borrower which finds the pool exhausted takes objects from the
+** caches of other threads before creating or waiting for one, and returns
+** bypass the caches while anyone is waiting, so objects move to the threads
+** that need them. Returning an object twice is not detected when the object
+** goes to a thread cache.
 */
 
 #ifndef _INCLUDED_OBJECT_POOL_H_
@@ -152,6 +162,10 @@ typedef int (*obj_not_fn)(void **, void *);
 **
 ** OP_IDLE_TIME      - minimum amout of time an object can sit idle in the pool.
 **                     the default setting is 300000 ms (5 min)
+**
+** OP_THREAD_CACHE   - number of returned objects each thread may keep for its
+**                     next borrows, up to OP_THREAD_CACHE_MAX.
+**                     disabled (0) by default
 */
 enum comdb2_objpool_option {
     OP_CAPACITY,
@@ -161,9 +175,12 @@ enum comdb2_objpool_option {
     OP_EVICT_RATIO,
     OP_MIN_IDLES,
     OP_MIN_IDLE_RATIO,
-    OP_IDLE_TIME
+    OP_IDLE_TIME,
+    OP_THREAD_CACHE
 };
 
+#define OP_THREAD_CACHE_MAX 16
+
 /*
 ** Legal return codes from the notification function (i.e. obj_not_fn).
 **
@@ -66,6 +66,8 @@ struct workitem {
     LINKC_T(struct workitem) linkv;
     int available;
     struct string_ref *ref_persistent_info;
+    int prio_class;
+    LINKC_T(struct workitem) class_linkv;
 };
 
 typedef void (*thdpool_thdinit_fn)(struct thdpool *pool, void *thddata);
@@ -106,6 +108,17 @@ enum {
 int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
                     int queue_override, struct string_ref *persistent_info,
                     uint32_t flags);
+
+/* Queued work is taken from the priority classes of a pool in proportion to
+ * their weights; a class may also be limited in how many threads run its
+ * work at once.  Class 0 is the class of thdpool_enqueue(). */
+#define THDPOOL_MAX_CLASSES 8
+int thdpool_enqueue_class(struct thdpool *pool, thdpool_work_fn work_fn,
+                          void *work, int queue_override,
+                          struct string_ref *persistent_info, uint32_t flags,
+                          int prio_class);
+void thdpool_set_class(struct thdpool *pool, int prio_class, unsigned weight,
+                       unsigned maxthds);
 void thdpool_stop(struct thdpool *pool);
 void thdpool_resume(struct thdpool *pool);
 void thdpool_unset_exit(struct thdpool *pool);
@@ -17,6 +17,8 @@
 #ifndef INCLUDED_THRMAN_H
 #define INCLUDED_THRMAN_H
 
+#include <pthread.h>
+
 struct thr_handle;
 
 enum thrtype {
@@ -78,6 +80,9 @@ int thrman_count_type(enum thrtype type);
 struct reqlogger *thrman_get_reqlogger(struct thr_handle *thr);
 void thrman_stop_sql_connections(void);
 int thrman_wait_type_exit(enum thrtype type);
+pthread_t thrman_get_tid(struct thr_handle *thr);
+struct reqlogger *thrman_peek_reqlogger(struct thr_handle *thr);
+int thrman_foreach(int (*fn)(struct thr_handle *thr, void *arg), void *arg);
 
 enum thrsubtype thrman_get_subtype(struct thr_handle *thr);
 void thrman_set_subtype(struct thr_handle *thr, enum thrsubtype subtype);
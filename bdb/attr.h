@@ -147,6 +147,9 @@ DEF_ATTR(SQLBULKSZ, sqlbulksz, BYTES, 2 * 1024 * 1024,
 DEF_ATTR(
     ZLIBLEVEL, zlib_level, QUANTITY, 6,
     "If zlib compression is enabled, this determines the compression level.")
+DEF_ATTR(
+    ZSTDLEVEL, zstd_level, QUANTITY, 3,
+    "If zstd compression is enabled, this determines the compression level.")
 DEF_ATTR(ZTRACE, ztrace, BOOLEAN, 0, NULL)
 DEF_ATTR(PANICLOGSNAP, paniclogsnap, BOOLEAN, 1, NULL)
 DEF_ATTR(UPDATEGENIDS, updategenids, BOOLEAN, 0, NULL)
@@ -481,6 +484,9 @@ DEF_ATTR(SC_DONE_SAME_TRAN, sc_done_same_tran, BOOLEAN, 1,
          "Write scdone record in the same logical transaction as DDLs.")
 DEF_ATTR(USE_VTAG_ONDISK_VERMAP, use_vtag_ondisk_vermap, BOOLEAN, 1,
          "Use vtag_to_ondisk_vermap conversion function from vtag_to_ondisk.")
+DEF_ATTR(USE_VTAG_ONDISK_PLAN, use_vtag_ondisk_plan, BOOLEAN, 1,
+         "Convert old versions with a precompiled copy program in "
+         "vtag_to_ondisk_vermap when their fields allow it.")
 DEF_ATTR(UDP_DROP_DELTA_THRESHOLD, udp_drop_delta_threshold, QUANTITY, 10,
          "Warn if delta of dropped packets exceeds this treshold.")
 DEF_ATTR(UDP_DROP_WARN_PERCENT, udp_drop_warn_percent, PERCENT, 10,
@@ -631,6 +637,9 @@ DEF_ATTR(MASTER_LEASE_RENEW_INTERVAL, master_lease_renew_interval, MSECS, 200,
 DEF_ATTR(LOGDELETE_RUN_INTERVAL, logdelete_run_interval, SECS, 30, NULL)
 DEF_ATTR(DURABLE_LSN_REQUEST_WAITMS, durable_lsn_request_waitms, MSECS, 1000,
          NULL)
+DEF_ATTR(DURABLE_LSN_REQUEST_BATCH, durable_lsn_request_batch, BOOLEAN, 0,
+         "Replicant threads that ask for a durable lsn while a request is "
+         "in flight share the next request to the master.")
 DEF_ATTR(VERIFY_MASTER_LEASE_TRACE, verify_master_lease_trace, BOOLEAN, 0, NULL)
 DEF_ATTR(RECEIVE_COHERENCY_LEASE_TRACE, receive_coherency_lease_trace, BOOLEAN,
          0, NULL)
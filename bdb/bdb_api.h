@@ -203,7 +203,8 @@ enum {
     BDBERR_NOT_DURABLE = 39,
     BDBERR_MAX_SEQUENCE = 40,
     BDBERR_EXCEEDED_INDEXES = 41,
-    BDBERR_EXCEEDED_BLOBS = 42
+    BDBERR_EXCEEDED_BLOBS = 42,
+    BDBERR_TEMPTABLE_FULL = 43 /* over a temp space limit */
 };
 
 /* values for BDB_ATTR_LOGDELETEAGE; +ve values indicate an absolute
@@ -293,7 +294,8 @@ enum COMPRESS {
     BDB_COMPRESS_ZLIB = 1,
     BDB_COMPRESS_RLE8 = 2,
     BDB_COMPRESS_CRLE = 3,
-    BDB_COMPRESS_LZ4 = 4
+    BDB_COMPRESS_LZ4 = 4,
+    BDB_COMPRESS_ZSTD = 5 /* only with WITH_ZSTD */
 };
 
 enum OPENFLAGS { /* NOTE: For "uint32_t flags" arg to "bdb_open_*()". */
@@ -560,6 +562,8 @@ int bdb_close_temp_state(bdb_state_type *bdb_state, int *bdberr);
 uint64_t bdb_index_size_tran(bdb_state_type *bdb_state, tran_type *tran, int ixnum);
 uint64_t bdb_data_size_tran(bdb_state_type *bdb_state, tran_type *tran, int dtanum);
 uint64_t bdb_data_size(bdb_state_type *bdb_state, int dtanum);
+int bdb_prealloc_like(bdb_state_type *bdb_state, bdb_state_type *model,
+                      int pct);
 uint64_t bdb_queue_size(bdb_state_type *bdb_state, unsigned *num_extents);
 uint64_t bdb_queue_size_tran(bdb_state_type *bdb_state, tran_type *tran, unsigned *num_extents);
 uint64_t bdb_logs_size(bdb_state_type *bdb_state, unsigned *num_logs);
@@ -597,6 +601,11 @@ int bdb_check_genid_is_older(bdb_state_type *bdb_state,
  */
 int bdb_cmp_genids(unsigned long long a, unsigned long long b);
 
+/* Return a genid in the stripe of lo which lies part/nparts of the way from
+ * lo to hi.  Only meant as a position to start or stop a stripe scan at. */
+unsigned long long bdb_genid_split(unsigned long long lo, unsigned long long hi,
+                                   int part, int nparts);
+
 /* Mask-out the inplace update-id for each genid and then compare them to
  * see which one would have been allocated first:
  * Return codes:
@@ -906,9 +915,20 @@ BB_COMPILE_TIME_ASSERT(queue_cursor_size, sizeof(struct bdb_queue_cursor) == 16)
 int bdb_queue_consumer(bdb_state_type *bdb_state, int consumer, int active,
                        int *bdberr);
 
-/* add an item to the end of the queue. */
+/* A queuedb can be split into partitions, each with its own key range and
+ * its own ordering, so that a consumer per partition can drain it in
+ * parallel.  A partition's items carry the partition number in the high half
+ * of their consumer number, and in the stripe bits of their genid. */
+#define QUEUE_MAX_PARTITIONS 16
+#define QUEUE_PARTITION_SHIFT 16
+#define QUEUE_PARTITION_CONSUMER(consumer, partition)                          \
+    ((consumer) | ((partition) << QUEUE_PARTITION_SHIFT))
+
+/* add an item to the end of the queue, or of a partition of it if
+ * partition >= 0. */
 int bdb_queue_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
-                  size_t dtalen, int *bdberr, unsigned long long *out_genid);
+                  size_t dtalen, int partition, int *bdberr,
+                  unsigned long long *out_genid);
 
 /* add/consume dummy records to aid extent reclaimation.  winner of the
  * May 2006 "Most Absurd Hack" award. */
@@ -956,6 +976,11 @@ int bdb_queuedb_stats(bdb_state_type *bdb_state,
                       bdb_queue_stats_callback_t callback, tran_type *tran,
                       void *userptr, int *bdberr);
 
+/* The size of a queuedb's files, and the share of their pages that held no
+   items as of the last page sweep, or -1 if they were not swept yet */
+int bdb_queuedb_file_stats(bdb_state_type *bdb_state, int64_t *file_size,
+                           double *unused);
+
 typedef int (*bdb_queue_walk_callback_t)(int consumern, size_t item_length,
                                          unsigned int epoch, void *userptr);
 
@@ -1420,6 +1445,7 @@ void bdb_register_rtoff_callback(bdb_state_type *bdb_state, void (*func)(void));
 int bdb_get_checkpoint_time(bdb_state_type *bdb_state);
 
 int bdb_have_llmeta();
+unsigned int bdb_llmeta_chg_gen(void);
 int bdb_llmeta_open(char name[], char dir[], bdb_state_type *parent_bdb_handle,
                     int create_override, int *bdberr);
 int bdb_llmeta_set_tables(tran_type *input_trans, char **tblnames,
@@ -1649,6 +1675,10 @@ void bdb_get_cur_lsn_str(bdb_state_type *bdb_state, uint64_t *lsnbytes,
 
 unsigned long long bdb_temp_table_new_rowid(struct temp_table *tbl);
 
+/* Start counting the temp space used by this thread against the per-query
+   limit again */
+void bdb_temp_table_begin_query(void);
+
 int bdb_temp_table_put(bdb_state_type *bdb_state, struct temp_table *tbl,
                        void *key, int keylen, void *data, int dtalen,
                        void *unpacked, int *bdberr);
@@ -1751,6 +1781,8 @@ int bdb_get_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
 int bdb_set_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
                          int *bdberr);
 int bdb_delete_sc_start_lsn(tran_type *tran, const char *table, int *bdberr);
+int bdb_get_trigger_log_lsn(tran_type *tran, void *plsn, int *bdberr);
+int bdb_set_trigger_log_lsn(tran_type *tran, void *plsn, int *bdberr);
 
 enum {
     ACCESS_INVALID = 1,
@@ -1810,6 +1842,7 @@ int bdb_user_get_all_tran(tran_type *tran, char ***users, int *num);
 
 void bdb_set_instant_schema_change(bdb_state_type *bdb_state, int isc);
 void bdb_set_inplace_updates(bdb_state_type *bdb_state, int ipu);
+void bdb_set_zonemaps(bdb_state_type *bdb_state, int zonemaps);
 void bdb_set_csc2_version(bdb_state_type *bdb_state, uint8_t version);
 
 int bdb_get_active_stripe(bdb_state_type *bdb_state);
@@ -1833,6 +1866,15 @@ int bdb_the_lock_desired(void);
 
 int bdb_is_hashtable(struct temp_table *);
 
+/* Hash and compare the entries of an empty hash temptable with hashfn and
+   cmpfn (both are passed keysz, and a key that is an int length followed by
+   the bytes) instead of their whole key.  Entries that compare equal are all
+   kept, and a find followed by nexts visits every one of them. */
+int bdb_temp_hashtable_set_hash(struct temp_table *,
+                                unsigned int (*hashfn)(const void *, int),
+                                int (*cmpfn)(const void *, const void *, int),
+                                int keysz);
+
 void analyze_set_headroom(uint64_t);
 
 int bdb_is_open(bdb_state_type *bdb_state);
@@ -1911,6 +1953,32 @@ int udppfault_thdpool_init(void);
 
 extern struct thdpool *gbl_pgcompact_thdpool;
 int pgcompact_thdpool_init(void);
+int logarchive_init(void);
+
+/* Progress of the page compaction sweeper through one btree file */
+struct bdb_pgsweep_stat {
+    const char *table;
+    const char *file;
+    int64_t passes;      /* completed passes over the file */
+    int64_t pgno;        /* next page of the current pass */
+    int64_t last_pgno;   /* last page of the file */
+    int64_t leaf_pages;  /* leaf pages seen by the last pass */
+    double leaf_fill;    /* and their average fill factor */
+    int64_t reclaimable; /* pages saved at the target fill factor */
+    int64_t queued;      /* pages queued for compaction */
+};
+typedef int (*bdb_pgsweep_collect_f)(void *arg,
+                                     const struct bdb_pgsweep_stat *st);
+int bdb_pgcompact_sweep_collect(bdb_pgsweep_collect_f func, void *arg);
+/* The leaf pages of a file, and their fill factor, as of the last completed
+   sweep. Returns -1 if the file was never swept. */
+int bdb_pgsweep_file_pages(const char *fname, int64_t *leaf_pages,
+                           double *leaf_fill);
+
+/* Returns 0 if the unique index ixnum certainly has no entry for key,
+   1 if it may have one. */
+int bdb_ixfilter_may_contain(bdb_state_type *bdb_state, int ixnum,
+                             const void *key, int keylen);
 
 int get_dbnum_by_handle(bdb_state_type *bdb_state);
 int get_dbnum_by_name(bdb_state_type *bdb_state, const char *name);
@@ -1950,6 +2018,8 @@ int bdb_osql_check_table_version(bdb_state_type *bdb_state, tran_type *tran,
                                  int trak, int *bdberr);
 
 int bdb_get_myseqnum(bdb_state_type *bdb_state, seqnum_type *seqnum);
+int bdb_wait_for_applied_lsn(bdb_state_type *bdb_state, uint32_t file,
+                             uint32_t offset, int timeoutms);
 
 void bdb_replace_handle(bdb_state_type *parent, int ix, bdb_state_type *handle);
 
@@ -2044,6 +2114,17 @@ int bdb_get_table_csonparameters(tran_type *tran, const char *table,
 int bdb_set_table_csonparameters(void *parent_tran, const char *table,
                                  const char *value, int len);
 int bdb_del_table_csonparameters(void *parent_tran, const char *table);
+
+int bdb_add_zstd_dict(tran_type *tran, const char *table, uint32_t dictid,
+                      const void *dict, int len, int *bdberr);
+int bdb_get_zstd_dicts(tran_type *tran, const char *table, uint32_t **ids,
+                       void ***dicts, int **lens, int *num, int *bdberr);
+int bdb_del_zstd_dicts(tran_type *tran, const char *table, int *bdberr);
+int bdb_set_zonemap(tran_type *tran, const char *table, const void *zm,
+                    int len, int *bdberr);
+int bdb_get_zonemap(tran_type *tran, const char *table, void **zm, int *len,
+                    int *bdberr);
+int bdb_del_zonemap(tran_type *tran, const char *table, int *bdberr);
 int bdb_clear_table_parameter(void *parent_tran, const char *table,
                               const char *parameter);
 int bdb_get_table_parameter(const char *table, const char *parameter,
@@ -2300,6 +2381,12 @@ typedef struct repl_wait_and_net_use {
 } repl_wait_and_net_use_t;
 repl_wait_and_net_use_t *bdb_get_repl_wait_and_net_stats(bdb_state_type *bdb_state, int *pnnodes);
 
+/* free idle pooled or cached temp tables */
+int bdb_temp_table_clear_cache(bdb_state_type *bdb_state);
+
+/* bytes of log this node has yet to apply from the master; 0 on the master */
+uint64_t bdb_bytes_behind_master(bdb_state_type *bdb_state);
+
 
 struct cluster_info {
     char *host;
@@ -2321,6 +2408,48 @@ void allow_sc_to_run(void);
 
 int bdb_lock_stats(bdb_state_type *bdb_state, int64_t *nlocks);
 
+typedef int (*collect_lock_waits_f)(void *arg, const char *type,
+                                    const char *object, const char *mode,
+                                    int64_t waits, int64_t total_us,
+                                    int64_t max_us, const char *histogram);
+int bdb_collect_lock_waits(bdb_state_type *bdb_state, collect_lock_waits_f func,
+                           void *arg);
+void bdb_clear_lock_waits(void);
+
+typedef int (*collect_bufferpool_f)(void *arg, const char *file, int level,
+                                    int64_t resident, int64_t dirty,
+                                    int64_t accesses, int64_t hits,
+                                    int64_t misses, int64_t evictions);
+int bdb_collect_bufferpool(bdb_state_type *bdb_state,
+                           collect_bufferpool_f func, void *arg);
+typedef int (*collect_bufferpool_heat_f)(void *arg, const char *file,
+                                         int64_t first_pgno,
+                                         int64_t last_pgno, int64_t resident,
+                                         int64_t accesses);
+int bdb_collect_bufferpool_heat(bdb_state_type *bdb_state, int nranges,
+                                collect_bufferpool_heat_f func, void *arg);
+typedef int (*collect_table_io_f)(void *arg, const char *type, int ix,
+                                  int64_t faults, int64_t reads,
+                                  int64_t read_bytes, int64_t writes,
+                                  int64_t write_bytes);
+int bdb_collect_table_io(bdb_state_type *bdb_state, collect_table_io_f func,
+                         void *arg);
+typedef int (*collect_repl_history_f)(void *arg, const char *host,
+                                      int64_t time_ms, int64_t lag_bytes,
+                                      int64_t apply_bytes_per_sec,
+                                      int64_t seconds_behind, double ack_avg_ms,
+                                      double ack_max_ms, int degrading);
+int bdb_collect_repl_history(const char *host, collect_repl_history_f func,
+                             void *arg);
+void bdb_repl_pacing_stats(int64_t *delay_ms, int64_t *lag_bytes,
+                           int64_t *allowed_bytes_per_sec);
+typedef int (*collect_file_reclaim_f)(void *arg, const char *path,
+                                      int64_t size, int64_t remaining,
+                                      int64_t queued_ms);
+int bdb_collect_file_reclaim(collect_file_reclaim_f func, void *arg);
+int bdb_reclaim_unlink(const char *path);
+void bdb_lock_wait_profile_init(void);
+
 int bdb_rep_stats(bdb_state_type *bdb_state, int64_t *nrep_deadlocks);
 int bdb_rep_deadlocks(bdb_state_type *bdb_state, int64_t *nrep_deadlocks);
 
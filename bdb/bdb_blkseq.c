@@ -125,6 +125,10 @@ void bdb_cleanup_private_blkseq(bdb_state_type *bdb_state)
         free(bdb_state->blkseq_last_lsn[1]);
         bdb_state->blkseq_last_lsn[1] = NULL;
     }
+    if (bdb_state->blkseq_last_roll_time) {
+        free(bdb_state->blkseq_last_roll_time);
+        bdb_state->blkseq_last_roll_time = NULL;
+    }
 }
 
 int bdb_create_private_blkseq(bdb_state_type *bdb_state)
@@ -141,6 +145,7 @@ int bdb_create_private_blkseq(bdb_state_type *bdb_state)
     bdb_state->blkseq[1] = malloc(nstripes * sizeof(DB *));
     bdb_state->blkseq_last_lsn[0] = malloc(nstripes * sizeof(DB_LSN));
     bdb_state->blkseq_last_lsn[1] = malloc(nstripes * sizeof(DB_LSN));
+    bdb_state->blkseq_last_roll_time = malloc(nstripes * sizeof(time_t));
 
     bdb_state->blkseq_log_list = malloc(nstripes * sizeof(listc_t));
 
@@ -178,7 +183,15 @@ int bdb_create_private_blkseq(bdb_state_type *bdb_state)
         listc_init(&bdb_state->blkseq_log_list[stripe],
                    offsetof(struct seen_blkseq, lnk));
     }
-    bdb_state->blkseq_last_roll_time = comdb2_time_epoch();
+
+    /* Each stripe rolls on its own clock.  Stagger the clocks across the
+     * maxage window so the stripes don't all purge on the same pass. */
+    time_t now = comdb2_time_epoch();
+    for (int stripe = 0; stripe < nstripes; stripe++) {
+        bdb_state->blkseq_last_roll_time[stripe] =
+            now - ((time_t)stripe * bdb_state->attr->private_blkseq_maxage) /
+                      nstripes;
+    }
 
     return 0;
 }
@@ -425,13 +438,14 @@ int bdb_blkseq_clean(bdb_state_type *bdb_state, uint8_t stripe)
     int rc = 0;
     DB_ENV *env;
     int start, end;
+    int locked = 1;
 
     start = comdb2_time_epochms();
     now = comdb2_time_epoch();
 
     Pthread_mutex_lock(&bdb_state->blkseq_lk[stripe]);
 
-    last = bdb_state->blkseq_last_roll_time;
+    last = bdb_state->blkseq_last_roll_time[stripe];
 
     /* Not yet time?  Do nothing. */
     if ((now - last) < bdb_state->attr->private_blkseq_maxage)
@@ -481,7 +495,12 @@ int bdb_blkseq_clean(bdb_state_type *bdb_state, uint8_t stripe)
     bdb_state->blkseq[0][stripe] = newdb;
     bdb_state->blkseq_last_lsn[1][stripe] = bdb_state->blkseq_last_lsn[0][stripe];
 
-    bdb_state->blkseq_last_roll_time = now;
+    bdb_state->blkseq_last_roll_time[stripe] = now;
+
+    /* Nothing can reach the old tree any more.  Close and delete it
+     * without holding up inserts and lookups on this stripe. */
+    Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
+    locked = 0;
 
     /* Clean up the old blkseq file. Get its name, close it, delete it. */
     rc =
@@ -521,7 +540,8 @@ int bdb_blkseq_clean(bdb_state_type *bdb_state, uint8_t stripe)
     }
 
 done:
-    Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
+    if (locked)
+        Pthread_mutex_unlock(&bdb_state->blkseq_lk[stripe]);
     if (oldname)
         free(oldname);
 
@@ -53,6 +53,14 @@ enum { BDB_SET, BDB_NEXT, BDB_PREV };
 struct bdb_cursor_impl_tag;
 typedef struct bdb_cursor_impl_tag bdb_cursor_impl_t;
 
+/* one row fetched by next_batch; its data lives in the caller's buffer */
+typedef struct bdb_cursor_batch_row {
+    unsigned long long genid;
+    int rrn;
+    int datalen;
+    uint8_t ver;
+} bdb_cursor_batch_row_t;
+
 typedef struct bdb_cursor_ifn {
     bdb_cursor_impl_t *impl;
 
@@ -68,6 +76,9 @@ typedef struct bdb_cursor_ifn {
                 int *bdberr);
     int (*find_last_dup)(struct bdb_cursor_ifn *, void *key, int keylen,
                          int keymax, bias_info *, int *bdberr);
+    int (*next_batch)(struct bdb_cursor_ifn *cur, int maxrows, int rowsz,
+                      bdb_cursor_batch_row_t *rows, void *buf, int *nrows,
+                      int *bdberr);
 
     /* updates */
     int (*insert)(struct bdb_cursor_ifn *cur, unsigned long long genid,
@@ -72,7 +72,13 @@ enum {
                              day it may be the max possible ODH size if we
                              start adding fields. */
 
-    ODH_FLAG_COMPR_MASK = 0x7
+    ODH_FLAG_COMPR_MASK = 0x7,
+
+    /* zstd record compressed with a trained dictionary; a 4 byte
+     * big-endian dictionary id follows the header.  Binaries that predate
+     * this flag can't read such records. */
+    ODH_FLAG_DICTID = 0x8,
+    ODH_DICTID_SIZE = 4
 };
 
 /* snapisol log ops */
@@ -88,6 +94,7 @@ struct odh {
                           a max value of (1<<ODH_UPDATEID_BITS)-1 */
     uint8_t csc2vers;
     uint8_t flags;
+    uint8_t is_blob; /* not on disk; blobs don't use zstd dictionaries */
 
     void *recptr; /* Some functions set this to point to the
                      decompressed record data. */
@@ -604,6 +611,7 @@ struct bdb_cursor_impl_tag {
     /* page-order flags */
     int pageorder;       /* mark if the cursor is in page-order */
     int discardpages;    /* mark if the pages should be discarded immediately */
+    int scan;            /* positioned by first/last, not by a find */
     tmptable_t *vs_stab; /* Table of records to skip in the virtual stripe. */
     tmpcursor_t *vs_skip; /* Cursor for vs_stab. */
 
@@ -708,6 +716,7 @@ typedef struct {
     seqnum_type *seqnums; /* 1 per node num */
     pthread_mutex_t lock;
     pthread_cond_t cond;
+    int nwaiters; /* threads waiting on cond */
     pthread_key_t key;
     wait_for_lsn_list **waitlist;
     short *expected_udp_count;
@@ -818,6 +827,8 @@ struct bdb_state_tag {
                                      blob files are striped too, otherwise
                                      they are not. */
     DB *dbp_ix[MAXINDEX];                    /* handle for the ixN files */
+    struct bdb_ixfilter *ixfilter[MAXINDEX]; /* bloom filters of the unique
+                                                ixN files, see ixfilter.c */
 
     pthread_key_t tid_key;
 
@@ -1008,6 +1019,9 @@ struct bdb_state_tag {
     /* inplace updates setting */
     signed char inplace_updates;
 
+    /* the table has zone maps: an update never keeps the row's genid */
+    signed char zonemaps;
+
     signed char instant_schema_change;
 
     signed char rep_handle_dead;
@@ -1035,7 +1049,7 @@ struct bdb_state_tag {
     pthread_mutex_t *blkseq_lk;
     DB_ENV **blkseq_env;
     DB **blkseq[2];
-    time_t blkseq_last_roll_time;
+    time_t *blkseq_last_roll_time;
     DB_LSN *blkseq_last_lsn[2];
     listc_t *blkseq_log_list;
     int pvt_blkseq_stripes;
@@ -1048,6 +1062,7 @@ struct bdb_state_tag {
     pthread_mutex_t durable_lsn_lk;
     uint16_t *fld_hints;
     uint16_t *fld_hints_pd[MAXINDEX]; /* field hints for partial datacopies */
+    struct odh_zdicts *zdicts;        /* trained zstd dictionaries */
 
     int logical_live_sc;
     pthread_mutex_t sc_redo_lk;
@@ -1151,6 +1166,12 @@ int get_seqnum(bdb_state_type *bdb_state, const char *host);
 void bdb_set_key(bdb_state_type *bdb_state);
 
 uint64_t subtract_lsn(bdb_state_type *bdb_state, DB_LSN *lsn1, DB_LSN *lsn2);
+
+/* Move a log file out of the way and queue it to be compressed into
+   backup_logfiles_dir; -1 if it is still where it was */
+int bdb_logarchive_file(bdb_state_type *bdb_state, const char *logname);
+void bdb_repl_history_sample(bdb_state_type *bdb_state, const char **hosts,
+                             int count);
 void get_my_lsn(bdb_state_type *bdb_state, DB_LSN *lsnout);
 void rep_all_req(bdb_state_type *bdb_state);
 void get_master_lsn(bdb_state_type *bdb_state, DB_LSN *lsnout);
@@ -1247,6 +1268,13 @@ int bdb_retrieve_updateid(bdb_state_type *bdb_state, const void *from,
 int ip_updates_enabled_sc(bdb_state_type *bdb_state);
 int ip_updates_enabled(bdb_state_type *bdb_state);
 
+/* odh_dict.c */
+size_t odh_dict_compress(bdb_state_type *bdb_state, void *to, size_t tolen,
+                         const void *from, size_t fromlen);
+int odh_dict_decompress(bdb_state_type *bdb_state, void *to, size_t tolen,
+                        const void *from, size_t fromlen);
+void odh_dict_free(bdb_state_type *bdb_state);
+
 /* file.c */
 void delete_log_files(bdb_state_type *bdb_state);
 void delete_log_files_list(bdb_state_type *bdb_state, char **list);
@@ -1579,6 +1607,7 @@ int bdb_get_lsn_lwm(bdb_state_type *bdb_state, DB_LSN *lsnout);
 void *bdb_cursor_dbcp(bdb_cursor_impl_t *cur);
 
 extern int gbl_temptable_pool_capacity;
+extern int gbl_objpool_tcache;
 hash_t *bdb_temp_table_histhash_init(void);
 int bdb_temp_table_clear_list(bdb_state_type *bdb_state);
 int bdb_temp_table_clear_pool(bdb_state_type *bdb_state);
@@ -1863,4 +1892,9 @@ int bdb_prepare_put_pack_updateid(bdb_state_type *bdb_state, int is_blob,
 
 int net_get_lsn_rectype(const void *buf, int buflen, DB_LSN *lsn, int *myrectype);
 
+/* ixfilter.c */
+void bdb_ixfilter_add(bdb_state_type *bdb_state, int ixnum, const DBT *key);
+void bdb_ixfilter_free(bdb_state_type *bdb_state);
+void bdb_ixfilter_invalidate(void);
+
 #endif /* __bdb_int_h__ */
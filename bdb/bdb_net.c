@@ -136,7 +136,8 @@ void disable_ack_trace(void)
     gbl_ack_trace = 0;
 }
 
-int do_ack(bdb_state_type *bdb_state, DB_LSN permlsn, uint32_t generation)
+static int send_ack(bdb_state_type *bdb_state, DB_LSN permlsn,
+                    uint32_t generation)
 {
     int rc;
     char *master;
@@ -194,6 +195,102 @@ int do_ack(bdb_state_type *bdb_state, DB_LSN permlsn, uint32_t generation)
     return rc;
 }
 
+/*
+  Ack coalescing
+
+  A replicant acks every commit it applies, so at a high commit rate the
+  master spends a good share of its time taking in acks.  With
+  ack_coalesce_count above 1, do_ack only remembers the latest lsn and
+  sends it once that many acks have been held back, or ack_coalesce_ms
+  after the first one was, whichever comes first.  An ack for an lsn
+  covers every lsn before it, so nothing is lost.  Acks are sent right
+  away while we are catching up or when the generation changes.
+*/
+int gbl_ack_coalesce_count = 0;
+int gbl_ack_coalesce_ms = 1;
+
+extern pthread_attr_t gbl_pthread_attr_detached;
+
+static pthread_mutex_t held_ack_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t held_ack_cond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t held_ack_once = PTHREAD_ONCE_INIT;
+static struct {
+    bdb_state_type *bdb_state;
+    DB_LSN lsn;
+    uint32_t generation;
+    int count;
+    int first_ms;
+} held_ack;
+
+/* called with held_ack_lk; sends the held ack after dropping the lock */
+static int flush_held_ack(void)
+{
+    bdb_state_type *bdb_state = held_ack.bdb_state;
+    DB_LSN lsn = held_ack.lsn;
+    uint32_t generation = held_ack.generation;
+
+    held_ack.count = 0;
+    Pthread_mutex_unlock(&held_ack_lk);
+    return send_ack(bdb_state, lsn, generation);
+}
+
+static void *held_ack_thd(void *arg)
+{
+    struct timespec ts;
+    int left;
+
+    comdb2_name_thread(__func__);
+    Pthread_mutex_lock(&held_ack_lk);
+    while (1) {
+        if (held_ack.count == 0) {
+            Pthread_cond_wait(&held_ack_cond, &held_ack_lk);
+            continue;
+        }
+        left = held_ack.first_ms + gbl_ack_coalesce_ms - comdb2_time_epochms();
+        if (left > 0) {
+            setup_waittime(&ts, left);
+            pthread_cond_timedwait(&held_ack_cond, &held_ack_lk, &ts);
+            continue;
+        }
+        flush_held_ack();
+        Pthread_mutex_lock(&held_ack_lk);
+    }
+    return NULL;
+}
+
+static void held_ack_init(void)
+{
+    pthread_t tid;
+    Pthread_create(&tid, &gbl_pthread_attr_detached, held_ack_thd, NULL);
+}
+
+int do_ack(bdb_state_type *bdb_state, DB_LSN permlsn, uint32_t generation)
+{
+    if (gbl_ack_coalesce_count <= 1 || gbl_ack_coalesce_ms <= 0 ||
+        !bdb_state->caught_up)
+        return send_ack(bdb_state, permlsn, generation);
+
+    pthread_once(&held_ack_once, held_ack_init);
+    Pthread_mutex_lock(&held_ack_lk);
+    if (held_ack.count && held_ack.generation != generation) {
+        flush_held_ack();
+        Pthread_mutex_lock(&held_ack_lk);
+    }
+    if (held_ack.count == 0 || log_compare(&permlsn, &held_ack.lsn) > 0) {
+        held_ack.lsn = permlsn;
+        held_ack.generation = generation;
+    }
+    held_ack.bdb_state = bdb_state;
+    if (held_ack.count++ == 0) {
+        held_ack.first_ms = comdb2_time_epochms();
+        Pthread_cond_signal(&held_ack_cond);
+    }
+    if (held_ack.count >= gbl_ack_coalesce_count)
+        return flush_held_ack();
+    Pthread_mutex_unlock(&held_ack_lk);
+    return 0;
+}
+
 void comdb2_early_ack(DB_ENV *dbenv, DB_LSN permlsn, uint32_t generation)
 {
     bdb_state_type *bdb_state = (bdb_state_type *)dbenv->app_private;
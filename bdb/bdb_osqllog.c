@@ -83,6 +83,121 @@ typedef struct bdb_osql_log_repo {
 /* transaction repository */
 static bdb_osql_log_repo_t *log_repo; /* the log repo */
 
+/**
+ * Prior row images
+ *
+ * Serving a snapshot read of a row whose shadow holds only a log pointer
+ * means reconstructing the row from the log every time.  Each snapshot
+ * reader has its own shadow, so concurrent readers of a hot row repeat the
+ * same log walk.  Keep a bounded LRU of reconstructed images keyed by the
+ * LSN of the undo record, which names exactly one version of one genid.
+ * Entries are dropped when the log is truncated past them.
+ */
+typedef struct undo_row {
+    DB_LSN lsn;
+    int len;
+    LINKC_T(struct undo_row) lnk;
+    char data[1];
+} undo_row_t;
+
+static struct {
+    pthread_mutex_t lk;
+    hash_t *rows;
+    LISTC_T(undo_row_t) lru;
+    size_t bytes;
+} undo_rows = {.lk = PTHREAD_MUTEX_INITIALIZER};
+
+int gbl_undo_row_cache_kb = 0;
+int64_t gbl_undo_row_cache_hits = 0;
+int64_t gbl_undo_row_cache_misses = 0;
+
+static void undo_rows_evict_int(size_t limit)
+{
+    undo_row_t *e;
+
+    while (undo_rows.bytes > limit &&
+           (e = listc_rtl(&undo_rows.lru)) != NULL) {
+        hash_del(undo_rows.rows, e);
+        undo_rows.bytes -= e->len;
+        free(e);
+    }
+}
+
+/* Return a malloced copy of a cached image with hdrlen bytes in front. */
+static void *undo_row_get(DB_LSN *lsn, int hdrlen, int *rowlen)
+{
+    undo_row_t *e;
+    char *row = NULL;
+    size_t limit = (size_t)gbl_undo_row_cache_kb * 1024;
+
+    if (undo_rows.rows == NULL)
+        return NULL;
+
+    Pthread_mutex_lock(&undo_rows.lk);
+    undo_rows_evict_int(limit);
+    if (limit && (e = hash_find(undo_rows.rows, lsn)) != NULL) {
+        listc_rfl(&undo_rows.lru, e);
+        listc_abl(&undo_rows.lru, e);
+        if ((row = malloc(hdrlen + e->len)) != NULL) {
+            memcpy(row + hdrlen, e->data, e->len);
+            *rowlen = hdrlen + e->len;
+        }
+        gbl_undo_row_cache_hits++;
+    } else if (limit)
+        gbl_undo_row_cache_misses++;
+    Pthread_mutex_unlock(&undo_rows.lk);
+
+    return row;
+}
+
+static void undo_row_put(DB_LSN *lsn, const void *data, int len)
+{
+    undo_row_t *e;
+    size_t limit = (size_t)gbl_undo_row_cache_kb * 1024;
+
+    /* A single row may not take more than a quarter of the cache. */
+    if (len <= 0 || (size_t)len > limit / 4)
+        return;
+
+    Pthread_mutex_lock(&undo_rows.lk);
+    if (undo_rows.rows == NULL) {
+        undo_rows.rows =
+            hash_init_o(offsetof(undo_row_t, lsn), sizeof(DB_LSN));
+        listc_init(&undo_rows.lru, offsetof(undo_row_t, lnk));
+    }
+    if (hash_find(undo_rows.rows, lsn) == NULL &&
+        (e = malloc(offsetof(undo_row_t, data) + len)) != NULL) {
+        e->lsn = *lsn;
+        e->len = len;
+        memcpy(e->data, data, len);
+        hash_add(undo_rows.rows, e);
+        listc_abl(&undo_rows.lru, e);
+        undo_rows.bytes += len;
+        undo_rows_evict_int(limit);
+    }
+    Pthread_mutex_unlock(&undo_rows.lk);
+}
+
+void bdb_osql_log_undo_rows_truncate(DB_LSN *lsn)
+{
+    undo_row_t *e, *tmp;
+
+    if (undo_rows.rows == NULL)
+        return;
+
+    Pthread_mutex_lock(&undo_rows.lk);
+    LISTC_FOR_EACH_SAFE(&undo_rows.lru, e, tmp, lnk)
+    {
+        if (log_compare(&e->lsn, lsn) >= 0) {
+            listc_rfl(&undo_rows.lru, e);
+            hash_del(undo_rows.rows, e);
+            undo_rows.bytes -= e->len;
+            free(e);
+        }
+    }
+    Pthread_mutex_unlock(&undo_rows.lk);
+}
+
 static int undo_get_prevlsn(bdb_state_type *bdb_state, DBT *logdta,
                             DB_LSN *prevlsn);
 static int bdb_osql_log_try_run_optimized(bdb_cursor_impl_t *cur,
@@ -4084,6 +4199,10 @@ static int bdb_osql_log_get_optim_data_int(bdb_state_type *bdb_state,
     *row = NULL;
     *rowlen = 0;
 
+    if ((*row = undo_row_get(lsn, addcur ? sizeof(bdb_osql_log_addc_ptr_t) : 0,
+                             rowlen)) != NULL)
+        return 0;
+
     /* retrieve a log cursor */
     rc = bdb_state->dbenv->log_cursor(bdb_state->dbenv, &curlog, 0);
     if (rc) {
@@ -4141,6 +4260,7 @@ static int bdb_osql_log_get_optim_data_int(bdb_state_type *bdb_state,
             goto done;
         }
 
+        undo_row_put(lsn, ptr, del_dta->dtalen);
         free(del_dta);
 
         /* Set row. */
@@ -4195,6 +4315,7 @@ static int bdb_osql_log_get_optim_data_int(bdb_state_type *bdb_state,
             free(upd_dta);
             goto done;
         }
+        undo_row_put(lsn, ptr, upd_dta->old_dta_len);
         free(upd_dta);
 
         /* Set row. */
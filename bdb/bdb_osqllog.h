@@ -241,6 +241,12 @@ int bdb_osql_log_get_optim_data(bdb_state_type *bdb_state, DB_LSN *lsn,
  */
 int bdb_osql_log_get_optim_data_addcur(bdb_state_type *bdb_state, DB_LSN *lsn,
                                        void **row, int *rowlen, int *bdberr);
+/**
+ * Drop cached prior row images at or past a log truncation point
+ *
+ */
+void bdb_osql_log_undo_rows_truncate(DB_LSN *lsn);
+
 /**
  * Check if a buffer is a log dta pointer
  */
@@ -16,7 +16,8 @@ int bdb_queuedb_best_pagesize(int avg_item_sz);
 
 /* add to queue */
 int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
-                    size_t dtalen, int *bdberr, unsigned long long *out_genid);
+                    size_t dtalen, int partition, int *bdberr,
+                    unsigned long long *out_genid);
 
 /* no-op */
 int bdb_queuedb_add_goose(bdb_state_type *bdb_state, tran_type *tran,
@@ -56,5 +57,7 @@ int bdb_trigger_close(bdb_state_type *);
 int bdb_trigger_ispaused(bdb_state_type *);
 int bdb_trigger_pause(bdb_state_type *);
 int bdb_trigger_unpause(bdb_state_type *);
+uint64_t bdb_trigger_seq(bdb_state_type *);
+int bdb_trigger_wait(bdb_state_type *, uint64_t seen, int timeout_ms);
 
 #endif
@@ -25,6 +25,7 @@
 #include "comdb2_atomic.h"
 #include "constraints.h"
 #include "string_ref.h"
+#include <poll.h>
 #include <unistd.h>
 
 /* NOTE: This is from "comdb2.h". */
@@ -38,6 +39,7 @@ extern void set_data_func(void *to, const void *from, int sz);
 extern void fsnapf(FILE *, void *, int);
 extern int __bam_defcmp(DB *dbp, const DBT *a, const DBT *b);
 int gbl_debug_sleep_on_verify = 0;
+int gbl_verify_items_per_sec = 0;
 
 static int locprint(verify_common_t *par, char *fmt, ...)
 {
@@ -177,12 +179,45 @@ ret:
     return rc;
 }
 
+/* Hold all running verifies, across tables and threads, to
+ * verify_items_per_sec.  A thread books time for a batch of about 10ms worth
+ * of items at once and sleeps until its turn, so that it never sits on a
+ * cursor's page for long.
+ */
+static void verify_throttle(void)
+{
+    static pthread_mutex_t lk = PTHREAD_MUTEX_INITIALIZER;
+    static int64_t next_us;
+    static __thread int items;
+    int64_t now, start;
+    int rate = gbl_verify_items_per_sec;
+    int batch;
+
+    if (rate <= 0)
+        return;
+    batch = rate / 100 > 0 ? rate / 100 : 1;
+    if (++items < batch)
+        return;
+    items = 0;
+
+    now = comdb2_time_epochus();
+    Pthread_mutex_lock(&lk);
+    start = next_us > now ? next_us : now;
+    next_us = start + (int64_t)batch * 1000000 / rate;
+    Pthread_mutex_unlock(&lk);
+    if (start > now)
+        poll(NULL, 0, (start - now) / 1000);
+}
+
 /* Check client connection and print progress, called for every item verified
  * Every second will client connection will be checked if it dropped
  * Print progress report report every progress_report_seconds
+ * Also paces the item against verify_items_per_sec
  */
 static inline int check_connection_and_progress(verify_common_t *par, int t_ms)
 {
+    verify_throttle();
+
     unsigned int last = par->last_connection_check; // get a copy of the last timestamp
     if (bdb_lock_desired(par->bdb_state)) {
         logmsg(LOGMSG_WARN, "master change, stopped verify\n");
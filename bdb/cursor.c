@@ -199,6 +199,9 @@ static int bdb_btree_update_shadows_with_pglogs_int(bdb_cursor_impl_t *cur,
 /* local bdb cursor functionality */
 static int bdb_cursor_first(bdb_cursor_ifn_t *cur, int *bdberr);
 static int bdb_cursor_next(bdb_cursor_ifn_t *cur, int *bdberr);
+static int bdb_cursor_next_batch(bdb_cursor_ifn_t *cur, int maxrows,
+                                 int rowsz, bdb_cursor_batch_row_t *rows,
+                                 void *buf, int *nrows, int *bdberr);
 static int bdb_cursor_prev(bdb_cursor_ifn_t *cur, int *bdberr);
 static int bdb_cursor_last(bdb_cursor_ifn_t *cur, int *bdberr);
 static int bdb_cursor_find(bdb_cursor_ifn_t *cur, void *key, int keylen,
@@ -661,6 +664,7 @@ bdb_cursor_ifn_t *bdb_cursor_open(
     pcur_ifn->impl = cur;
     pcur_ifn->first = bdb_cursor_first;
     pcur_ifn->next = bdb_cursor_next;
+    pcur_ifn->next_batch = bdb_cursor_next_batch;
     pcur_ifn->prev = bdb_cursor_prev;
     pcur_ifn->last = bdb_cursor_last;
     pcur_ifn->find = bdb_cursor_find;
@@ -3889,12 +3893,30 @@ static int bdb_cursor_getpageorder(bdb_cursor_ifn_t *pcur_ifn)
     return cur->pageorder;
 }
 
+/* Tell the bufferpool that pages read by this thread are for a scan. */
+extern __thread int memp_scan_hint;
+
+static inline int bdb_cursor_move_hinted(bdb_cursor_impl_t *cur, int how,
+                                         int *bdberr)
+{
+    int save = memp_scan_hint;
+    int rc;
+
+    memp_scan_hint = cur->scan;
+    rc = bdb_cursor_move(cur, how, bdberr);
+    memp_scan_hint = save;
+
+    return rc;
+}
+
 static int bdb_cursor_first(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
 {
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
     int rc;
 
-    rc = bdb_cursor_move(cur, DB_FIRST, bdberr);
+    /* a walk started from either end is a scan until the next find */
+    cur->scan = 1;
+    rc = bdb_cursor_move_hinted(cur, DB_FIRST, bdberr);
 
     return rc;
 }
@@ -3904,7 +3926,8 @@ static int bdb_cursor_last(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
     int rc;
 
-    rc = bdb_cursor_move(cur, DB_LAST, bdberr);
+    cur->scan = 1;
+    rc = bdb_cursor_move_hinted(cur, DB_LAST, bdberr);
 
     return rc;
 }
@@ -3914,7 +3937,7 @@ static int bdb_cursor_next(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
     int rc;
 
-    rc = bdb_cursor_move(cur, DB_NEXT, bdberr);
+    rc = bdb_cursor_move_hinted(cur, DB_NEXT, bdberr);
 
     /* must stand on the last row */
     if (rc == IX_PASTEOF) {
@@ -3945,6 +3968,47 @@ static int bdb_cursor_next(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
     return rc;
 }
 
+/**
+ * Move forward over up to maxrows rows, copying each one into buf, rowsz
+ * bytes apart, so the caller can serve them without coming back here.
+ *
+ * Returns 0 if the batch filled up; the cursor stands on the last copied
+ * row.  Otherwise returns the rc (and bdberr) of the move that stopped the
+ * batch; if that move found a row larger than rowsz, the cursor stands on
+ * it and the row is not copied.
+ */
+static int bdb_cursor_next_batch(bdb_cursor_ifn_t *pcur_ifn, int maxrows,
+                                 int rowsz, bdb_cursor_batch_row_t *rows,
+                                 void *buf, int *nrows, int *bdberr)
+{
+    bdb_cursor_impl_t *cur = pcur_ifn->impl;
+    bdb_cursor_batch_row_t *row;
+    int rc;
+
+    *nrows = 0;
+    while (*nrows < maxrows) {
+        rc = bdb_cursor_next(pcur_ifn, bdberr);
+        if ((rc != IX_FND && rc != IX_NOTFND) || cur->datalen > rowsz)
+            return rc;
+
+        row = &rows[*nrows];
+        row->genid = cur->genid;
+        row->rrn = cur->rrn;
+        row->datalen = cur->datalen;
+        row->ver = cur->ver;
+        memcpy((uint8_t *)buf + (size_t)(*nrows) * rowsz, cur->data,
+               cur->datalen);
+        (*nrows)++;
+    }
+
+    if (cur->trak) {
+        logmsg(LOGMSG_USER, "Cur %p batched %d rows, last genid=%llx\n", cur,
+               *nrows, cur->genid);
+    }
+
+    return 0;
+}
+
 static int bdb_cursor_prev(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
 {
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
@@ -3953,7 +4017,7 @@ static int bdb_cursor_prev(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
 /* The YAST test does an 'order by rowid desc' */
 /* assert(cur->type != BDBC_DT); */
 
-    rc = bdb_cursor_move(cur, DB_PREV, bdberr);
+    rc = bdb_cursor_move_hinted(cur, DB_PREV, bdberr);
 
     /* must stand on the last row */
     if (rc == IX_PASTEOF) {
@@ -4008,6 +4072,8 @@ static int bdb_cursor_find_last_dup(bdb_cursor_ifn_t *pcur_ifn, void *key,
     int newkeylen;
     int rc = 0;
 
+    cur->scan = 0;
+
     *bdberr = 0;
 
     if (cur->trak) {
@@ -6408,6 +6474,7 @@ static int bdb_cursor_find(bdb_cursor_ifn_t *pcur_ifn, void *key, int keylen,
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
     int rc, cnt = 0, max = cur->state->attr->max_rowlocks_reposition;
 
+    cur->scan = 0;
 again:
     rc = bdb_cursor_find_int(pcur_ifn, key, keylen, dirLeft, bdberr);
     if (-1 == rc && BDBERR_NEED_REPOSITION == *bdberr) {
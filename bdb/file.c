@@ -64,6 +64,10 @@
 #include <assert.h>
 #include <poll.h>
 #include <libgen.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/falloc.h>
+#endif
 
 #include <str0.h>
 
@@ -86,6 +90,7 @@
 
 #include "endian_core.h"
 #include "bdb_osqltrn.h"
+#include "bdb_osqllog.h"
 
 #include "printformats.h"
 #include "util.h"
@@ -105,6 +110,7 @@
 #include <schema_lk.h>
 #include <tohex.h>
 #include <timer_util.h>
+#include <numa_util.h>
 
 extern int gbl_bdblock_debug;
 extern int gbl_keycompr;
@@ -114,6 +120,8 @@ extern int gbl_fullrecovery;
 extern char *gbl_myhostname;
 extern size_t gbl_blobmem_cap;
 extern int gbl_backup_logfiles;
+extern int gbl_backup_logfiles_compress;
+extern int gbl_memp_numa;
 
 #define FILENAMELEN 100
 
@@ -127,6 +135,7 @@ int gbl_debug_children_lock = 0;
 int gbl_queuedb_genid_filename = 1;
 int gbl_queuedb_file_threshold = 0;
 int gbl_queuedb_file_interval = 60000;
+int gbl_queuedb_file_threshold_live = 0;
 static const char NEW_PREFIX[] = "new.";
 
 static pthread_once_t ONCE_LOCK = PTHREAD_ONCE_INIT;
@@ -165,6 +174,7 @@ const char *get_sc_to_name(const char *name);
 
 extern void *lwm_printer_thd(void *p);
 unsigned int sc_get_logical_redo_lwm();
+unsigned int trigger_log_lwm(void);
 /* Sorry - reaching into berkeley "internals" here.  This should
  * probably be an environment method. */
 extern int __db_find_recovery_start_if_enabled(DB_ENV *dbenv, DB_LSN *lsn);
@@ -245,6 +255,8 @@ void set_repinfo_master_host(bdb_state_type *bdb_state, char *master,
         logmsg(LOGMSG_USER, "Setting repinfo master to %s from %s line %u\n",
                master, func, line);
     }
+    if (bdb_state->repinfo->master_host != master)
+        bdb_ixfilter_invalidate();
     bdb_state->repinfo->master_host = master;
 }
 
@@ -1419,6 +1431,7 @@ static int close_dbs_int(bdb_state_type *bdb_state, DB_TXN *tid, int flags)
      * fooled by dangling pointers! */
     bzero(bdb_state->dbp_data, sizeof(bdb_state->dbp_data));
     bzero(bdb_state->dbp_ix, sizeof(bdb_state->dbp_ix));
+    bdb_ixfilter_free(bdb_state);
 
     /* since we always succeed, mark the db as closed now */
     bdb_state->isopen = 0;
@@ -1787,9 +1800,18 @@ int bdb_handle_reset(bdb_state_type *bdb_state)
     return bdb_handle_reset_tran(bdb_state, NULL, NULL);
 }
 
+/* The indexes that get a page hash along with the data: unique ones,
+   whose lookups by a whole key find at most one entry. */
+static DB *bdb_hash_ix_dbp(bdb_state_type *bdb_state, int ixnum)
+{
+    if (bdb_state->ixdups[ixnum] || bdb_state->ixrecnum[ixnum])
+        return NULL;
+    return bdb_state->dbp_ix[ixnum];
+}
+
 int bdb_handle_dbp_add_hash(bdb_state_type *bdb_state, int szkb)
 {
-    int dtanum, strnum;
+    int dtanum, strnum, ixnum;
     DB *dbp;
     for (dtanum = 0; dtanum < bdb_state->numdtafiles; dtanum++) {
         for (strnum = bdb_get_datafile_num_files(bdb_state, dtanum) - 1;
@@ -1803,12 +1825,21 @@ int bdb_handle_dbp_add_hash(bdb_state_type *bdb_state, int szkb)
             }
         }
     }
+    for (ixnum = 0; ixnum < bdb_state->numix; ixnum++) {
+        dbp = bdb_hash_ix_dbp(bdb_state, ixnum);
+        if (dbp) {
+            // hashed by a fingerprint of the whole key
+            dbp->pg_hash_keylen = bdb_state->ixlen[ixnum];
+            dbp->flags |= DB_AM_HASH;
+            genid_hash_resize(bdb_state->dbenv, &(dbp->pg_hash), szkb);
+        }
+    }
     return 0;
 }
 
 int bdb_handle_dbp_drop_hash(bdb_state_type *bdb_state)
 {
-    int dtanum, strnum;
+    int dtanum, strnum, ixnum;
     DB *dbp;
     for (dtanum = 0; dtanum < bdb_state->numdtafiles; dtanum++) {
         for (strnum = bdb_get_datafile_num_files(bdb_state, dtanum) - 1;
@@ -1823,9 +1854,34 @@ int bdb_handle_dbp_drop_hash(bdb_state_type *bdb_state)
             }
         }
     }
+    for (ixnum = 0; ixnum < bdb_state->numix; ixnum++) {
+        dbp = bdb_hash_ix_dbp(bdb_state, ixnum);
+        if (dbp) {
+            dbp->flags &= ~(DB_AM_HASH);
+            genid_hash_free(bdb_state->dbenv, dbp->pg_hash);
+            dbp->pg_hash = NULL;
+            dbp->pg_hash_keylen = 0;
+        }
+    }
     return 0;
 }
 
+static void bdb_hash_stat_ix(bdb_state_type *bdb_state)
+{
+    DB *dbp;
+    int ixnum;
+    for (ixnum = 0; ixnum < bdb_state->numix; ixnum++) {
+        dbp = bdb_hash_ix_dbp(bdb_state, ixnum);
+        if (dbp == NULL || !(dbp->flags & DB_AM_HASH) || !dbp->pg_hash)
+            continue;
+        logmsg(LOGMSG_INFO, "ix %d n_bt_search: %u n_bt_hash: %u "
+                            "n_bt_hash_hit: %u n_bt_hash_miss: %u\n",
+               ixnum, dbp->pg_hash_stat.n_bt_search,
+               dbp->pg_hash_stat.n_bt_hash, dbp->pg_hash_stat.n_bt_hash_hit,
+               dbp->pg_hash_stat.n_bt_hash_miss);
+    }
+}
+
 int bdb_handle_dbp_hash_stat(bdb_state_type *bdb_state)
 {
     DB *dbp;
@@ -1858,6 +1914,7 @@ int bdb_handle_dbp_hash_stat(bdb_state_type *bdb_state)
     logmsg(LOGMSG_INFO, "time_bt_search: %.3fms\n",
            (double)stat.t_bt_search.tv_sec * 1000 +
                (double)stat.t_bt_search.tv_usec / 1000);
+    bdb_hash_stat_ix(bdb_state);
 
     return has_hash;
 }
@@ -1865,7 +1922,7 @@ int bdb_handle_dbp_hash_stat(bdb_state_type *bdb_state)
 int bdb_handle_dbp_hash_stat_reset(bdb_state_type *bdb_state)
 {
     DB *dbp;
-    int dtanum, strnum;
+    int dtanum, strnum, ixnum;
     for (dtanum = 0; dtanum < bdb_state->numdtafiles; dtanum++) {
         for (strnum = bdb_get_datafile_num_files(bdb_state, dtanum) - 1;
              strnum >= 0; strnum--) {
@@ -1874,6 +1931,11 @@ int bdb_handle_dbp_hash_stat_reset(bdb_state_type *bdb_state)
                 bzero(&(dbp->pg_hash_stat), sizeof(dbp_bthash_stat));
         }
     }
+    for (ixnum = 0; ixnum < bdb_state->numix; ixnum++) {
+        dbp = bdb_state->dbp_ix[ixnum];
+        if (dbp)
+            bzero(&(dbp->pg_hash_stat), sizeof(dbp_bthash_stat));
+    }
 
     return 0;
 }
@@ -1907,6 +1969,8 @@ void *watcher_thread(void *arg);
 void *checkpoint_thread(void *arg);
 void *logdelete_thread(void *arg);
 void *memp_trickle_thread(void *arg);
+void *pg_compact_sweep_thread(void *arg);
+void *ix_filter_thread(void *arg);
 void *deadlockdetect_thread(void *arg);
 
 void make_lsn(DB_LSN *logseqnum, unsigned int filenum, unsigned int offsetnum)
@@ -2124,6 +2188,23 @@ uint64_t subtract_lsn(bdb_state_type *bdb_state, DB_LSN *lsn2, DB_LSN *lsn1)
     return num_bytes;
 }
 
+uint64_t bdb_bytes_behind_master(bdb_state_type *bdb_state)
+{
+    DB_LSN my_lsn, master_lsn = {0};
+
+    if (bdb_state->parent)
+        bdb_state = bdb_state->parent;
+    if (bdb_amimaster(bdb_state))
+        return 0;
+    get_master_lsn(bdb_state, &master_lsn);
+    if (master_lsn.file == 0)
+        return 0;
+    get_my_lsn(bdb_state, &my_lsn);
+    if (log_compare(&my_lsn, &master_lsn) >= 0)
+        return 0;
+    return subtract_lsn(bdb_state, &master_lsn, &my_lsn);
+}
+
 /*
 static void print_ourlsn(bdb_state_type *bdb_state)
 {
@@ -2309,6 +2390,14 @@ extern int comdb2_reload_schemas(DB_ENV *dbenv, DB_LSN *lsn);
 extern int comdb2_replicated_truncate(DB_ENV *dbenv, DB_LSN *lsn,
                                       uint32_t flags);
 extern int comdb2_recovery_cleanup(DB_ENV *dbenv, DB_LSN *lsn, int is_master);
+extern void bdb_serial_writes_truncate(DB_LSN *lsn);
+
+static int bdb_replicated_truncate(DB_ENV *dbenv, DB_LSN *lsn, uint32_t flags)
+{
+    bdb_osql_log_undo_rows_truncate(lsn);
+    bdb_serial_writes_truncate(lsn);
+    return comdb2_replicated_truncate(dbenv, lsn, flags);
+}
 
 int bdb_is_standalone(void *dbenv, void *in_bdb_state)
 {
@@ -2362,6 +2451,9 @@ static DB_ENV *dbenv_open(bdb_state_type *bdb_state)
 
     net_set_heartbeat_check_time(bdb_state->repinfo->netinfo, 60);
 
+    /* large files are unlinked at a throttled rate, see reclaim.c */
+    db_env_set_func_unlink(bdb_reclaim_unlink);
+
     /* Create the environment handle. */
     rc = db_env_create(&dbenv, 0);
     if (rc != 0) {
@@ -2528,6 +2620,12 @@ static DB_ENV *dbenv_open(bdb_state_type *bdb_state)
             ncache = 1;
     }
 
+    /* with a numa-bound cache, give every node the same number of segments */
+    if (gbl_memp_numa && comdb2_numa_nodes() > 1) {
+        int nodes = comdb2_numa_nodes();
+        ncache = ((ncache + nodes - 1) / nodes) * nodes;
+    }
+
     char b1[64], b2[64];
     logmsg(LOGMSG_INFO, "Cache:%s  Segments:%d  Segment-size:%s\n",
            prettysz(bdb_state->attr->cachesize * 1024ULL, b1), ncache,
@@ -2567,13 +2665,16 @@ static DB_ENV *dbenv_open(bdb_state_type *bdb_state)
 
     dbenv->set_check_standalone(dbenv, comdb2_is_standalone);
     dbenv->set_truncate_sc_callback(dbenv, comdb2_reload_schemas);
-    dbenv->set_rep_truncate_callback(dbenv, comdb2_replicated_truncate);
+    dbenv->set_rep_truncate_callback(dbenv, bdb_replicated_truncate);
     dbenv->set_rep_recovery_cleanup(dbenv, comdb2_recovery_cleanup);
 
     /* Register logical start and commit functions */
     dbenv->set_logical_start(dbenv, berkdb_start_logical);
     dbenv->set_logical_commit(dbenv, berkdb_commit_logical);
 
+    /* Profile lock waits by lock object */
+    bdb_lock_wait_profile_init();
+
     /* register our environments name for sanity checking purposes. */
     logmsg(LOGMSG_INFO, "registering <%s> with net code\n", bdb_state->name);
     net_register_name(bdb_state->repinfo->netinfo, bdb_state->name);
@@ -2758,6 +2859,10 @@ static DB_ENV *dbenv_open(bdb_state_type *bdb_state)
             logmsg(LOGMSG_ERROR, "failed to create temp table pool\n");
             exit(1);
         }
+        if (gbl_objpool_tcache > 0 &&
+            comdb2_objpool_setopt(bdb_state->temp_table_pool, OP_THREAD_CACHE,
+                                  gbl_objpool_tcache) != 0)
+            logmsg(LOGMSG_WARN, "bad objpool_tcache %d\n", gbl_objpool_tcache);
         logmsg(LOGMSG_INFO, "Temptable pool enabled.\n");
     }
 
@@ -3544,6 +3649,19 @@ static void delete_log_files_int(bdb_state_type *bdb_state)
         }
     }
 
+    /* deferred triggers haven't read past this yet */
+    unsigned int trigger_lwm = trigger_log_lwm();
+    if (trigger_lwm) {
+        if (trigger_lwm < local_lowfilenum)
+            local_lowfilenum = trigger_lwm;
+        if (trigger_lwm < lowfilenum) {
+            lowfilenum = trigger_lwm;
+            if (bdb_state->attr->debug_log_deletion) {
+                logmsg(LOGMSG_USER, "Setting lowfilenum to %d for deferred triggers\n", lowfilenum);
+            }
+        }
+    }
+
     /* debug: print filenums from other nodes */
 
     /* if we have a maximum filenum defined in bdb attributes which is lower,
@@ -3854,7 +3972,14 @@ low_headroom:
 
                 int deleted = 0;
 
-                if (gbl_backup_logfiles && bdb_state->repinfo->master_host == bdb_state->repinfo->myhost) {
+                if (gbl_backup_logfiles && gbl_backup_logfiles_compress &&
+                    bdb_state->repinfo->master_host == bdb_state->repinfo->myhost &&
+                    bdb_logarchive_file(bdb_state, logname) == 0) {
+                    if (ctrace_info) {
+                        ctrace("queued log %s for archival\n", logname);
+                    }
+                    deleted = 1;
+                } else if (gbl_backup_logfiles && bdb_state->repinfo->master_host == bdb_state->repinfo->myhost) {
                     // logname includes directory so need just the filename
                     char *base = basename(logname);
                     char *newname = comdb2_location("backup_logfiles_dir", "%s", base);
@@ -5888,6 +6013,28 @@ static bdb_state_type *bdb_open_int(
                 return NULL;
             }
 
+            /*
+              create the page compaction sweeper.
+              it stays idle until page_compact_sweep_pages is set.
+              */
+            rc = pthread_create(&dummy_tid, &attr, pg_compact_sweep_thread,
+                                bdb_state);
+            if (rc != 0)
+                logmsg(LOGMSG_ERROR, "unable to create pgcompact sweep thread "
+                                     "- rc=%d %s\n",
+                       rc, strerror(rc));
+
+            /*
+              create the index filter builder.
+              it stays idle until ix_filter_mb is set.
+              */
+            rc = pthread_create(&dummy_tid, &attr, ix_filter_thread,
+                                bdb_state);
+            if (rc != 0)
+                logmsg(LOGMSG_ERROR, "unable to create ix filter thread "
+                                     "- rc=%d %s\n",
+                       rc, strerror(rc));
+
             /* create the deadlock detect thread if we arent doing auto
                deadlock detection */
             if (!bdb_state->attr->autodeadlockdetect) {
@@ -7022,6 +7169,7 @@ static int bdb_free_int(bdb_state_type *bdb_state, bdb_state_type *replace,
         for (int i = 0; i < child->numix; ++i) {
             free(child->fld_hints_pd[i]);
         }
+        odh_dict_free(child);
 
         // free bthash
         bdb_handle_dbp_drop_hash(child);
@@ -7259,6 +7407,66 @@ uint64_t bdb_data_size_tran(bdb_state_type *bdb_state, tran_type *tran, int dtan
     return total;
 }
 
+/* Reserve len bytes of disk for a file without changing its size, the same
+ * way berkdb preallocates on writes */
+static int prealloc_file(const char *bdbname, uint64_t len)
+{
+    char physname[PATH_MAX];
+    int fd, rc = 0;
+
+    if (len == 0)
+        return 0;
+    bdb_trans(bdbname, physname);
+    if ((fd = open(physname, O_WRONLY)) == -1)
+        return errno;
+#ifdef __linux__
+    if (syscall(SYS_fallocate, fd, FALLOC_FL_KEEP_SIZE, (off_t)0,
+                (off_t)len) == -1)
+        rc = errno;
+#endif
+    close(fd);
+    return rc;
+}
+
+/* Preallocate the files of bdb_state to pct percent of the size of the
+ * matching files of model, which must have the same schema */
+int bdb_prealloc_like(bdb_state_type *bdb_state, bdb_state_type *model,
+                      int pct)
+{
+    char bdbname[PATH_MAX];
+    int dtanum, stripenum, numstripes, ixnum, rc;
+
+    if (pct <= 0 || bdb_state->numdtafiles != model->numdtafiles ||
+        bdb_state->numix != model->numix)
+        return 0;
+
+    for (dtanum = 0; dtanum < bdb_state->numdtafiles; dtanum++) {
+        numstripes = 1;
+        if (dtanum == 0 || bdb_state->attr->blobstripe)
+            numstripes = bdb_state->attr->dtastripe;
+        for (stripenum = 0; stripenum < numstripes; stripenum++) {
+            char modelname[PATH_MAX], physname[PATH_MAX];
+            form_datafile_name(model, NULL, dtanum, stripenum, modelname,
+                               sizeof(modelname));
+            form_datafile_name(bdb_state, NULL, dtanum, stripenum, bdbname,
+                               sizeof(bdbname));
+            rc = prealloc_file(
+                bdbname,
+                mystat(bdb_trans(modelname, physname)) / 100 * pct);
+            if (rc)
+                return rc;
+        }
+    }
+    for (ixnum = 0; ixnum < bdb_state->numix; ixnum++) {
+        form_indexfile_name(bdb_state, NULL, ixnum, bdbname, sizeof(bdbname));
+        rc = prealloc_file(bdbname,
+                           bdb_index_size_tran(model, NULL, ixnum) / 100 * pct);
+        if (rc)
+            return rc;
+    }
+    return 0;
+}
+
 static size_t dirent_buf_size(const char *dir)
 {
     long name_max;
@@ -282,7 +282,10 @@ static unsigned int get_dupecount_from_genid(unsigned long long genid)
 static inline unsigned long long get_gblcontext_int(bdb_state_type *bdb_state)
 {
     return (bdb_state->genid_format == LLMETA_GENID_48BIT)
-               ? flibc_htonll((HI48(bdb_state) << 16) | LO16(bdb_state))
+               ? flibc_htonll((__atomic_load_n(&HI48(bdb_state),
+                                               __ATOMIC_ACQUIRE)
+                               << 16) |
+                              LO16(bdb_state))
                : bdb_state->gblcontext.orig;
 }
 
@@ -301,8 +304,15 @@ static inline void set_gblcontext_int(bdb_state_type *bdb_state,
     } else if (bdb_state->genid_format != LLMETA_GENID_48BIT) {
         bdb_state->gblcontext.orig = gblcontext;
     } else {
+        /* never move back past a genid get_genid_48bit handed out while we
+         * were comparing */
+        uint64_t hi48 = flibc_ntohll(gblcontext) >> 16;
+        uint64_t cur = __atomic_load_n(&HI48(bdb_state), __ATOMIC_ACQUIRE);
+        while (cur < hi48 &&
+               !__atomic_compare_exchange_n(&HI48(bdb_state), &cur, hi48, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            ;
         LO16(bdb_state) = gblcontext >> 48;
-        HI48(bdb_state) = flibc_ntohll(gblcontext) >> 16;
     }
 }
 
@@ -390,6 +400,9 @@ static inline void set_commit_genid_lsn_gen(bdb_state_type *bdb_state,
 
 #define SEED48_MAX ((1ULL << 48) - 1)
 
+/* The 48-bit genid is a plain counter, so a data genid only needs an atomic
+ * increment.  The lock is for seeding, and for commit genids, which have to
+ * be recorded together with their lsn. */
 static unsigned long long get_genid_48bit(bdb_state_type *bdb_state,
                                           unsigned int dtafile, DB_LSN *lsn,
                                           uint32_t generation, uint64_t seed)
@@ -398,14 +411,18 @@ static unsigned long long get_genid_48bit(bdb_state_type *bdb_state,
     unsigned long long seed48;
     static time_t lastwarn = 0;
     time_t now;
+    int locked = 0;
     dtafile &= 0xf;
 
-    Pthread_mutex_lock(&(bdb_state->gblcontext_lock));
+    if (lsn || seed) {
+        Pthread_mutex_lock(&(bdb_state->gblcontext_lock));
+        locked = 1;
+    }
 
     if (seed)
-        HI48(bdb_state) = seed;
+        __atomic_store_n(&HI48(bdb_state), seed, __ATOMIC_RELEASE);
 
-    while (HI48(bdb_state) >= SEED48_MAX) {
+    while (__atomic_load_n(&HI48(bdb_state), __ATOMIC_ACQUIRE) >= SEED48_MAX) {
         /* This database needs a clean dump & load (or we need to expand our
          * genids */
         logmsg(LOGMSG_ERROR, "%s: this database has run out of genids!\n",
@@ -414,14 +431,15 @@ static unsigned long long get_genid_48bit(bdb_state_type *bdb_state,
     }
 
     LO16(bdb_state) = dtafile;
-    seed48 = ++HI48(bdb_state);
+    seed48 = __atomic_add_fetch(&HI48(bdb_state), 1, __ATOMIC_ACQ_REL);
 
     genid = flibc_htonll((seed48 << 16) | dtafile);
     if (lsn) {
         set_commit_genid_lsn_gen(bdb_state, genid, lsn, &generation);
     }
 
-    Pthread_mutex_unlock(&(bdb_state->gblcontext_lock));
+    if (locked)
+        Pthread_mutex_unlock(&(bdb_state->gblcontext_lock));
 
     if (bdb_state->attr->genid48_warn_threshold &&
         (SEED48_MAX - seed48) <= bdb_state->attr->genid48_warn_threshold &&
@@ -710,6 +728,19 @@ unsigned long long bdb_mask_stripe(bdb_state_type *bdb_state,
     return (a & ~(GENID_STRIPE_MASK));
 }
 
+unsigned long long bdb_genid_split(unsigned long long lo, unsigned long long hi,
+                                   int part, int nparts)
+{
+    unsigned long long hlo = flibc_ntohll(lo);
+    unsigned long long hhi = flibc_ntohll(hi);
+    unsigned long long split;
+
+    if (hhi <= hlo || nparts <= 0)
+        return lo;
+    split = flibc_htonll(hlo + (hhi - hlo) / nparts * part);
+    return (split & ~(GENID_STRIPE_MASK)) | (lo & GENID_STRIPE_MASK);
+}
+
 /* Compare two genids to determine which one would have been allocated first.
  * Return codes:
  *    -1    a < b
@@ -172,6 +172,21 @@ static void log_stats(FILE *out, bdb_state_type *bdb_state)
     prn_stat(st_disk_offset);
     prn_stat(st_maxcommitperflush);
     prn_stat(st_mincommitperflush);
+    prn_lstat(st_gc_commits);
+    prn_lstat(st_gc_windows);
+    prn_lstat(st_gc_wait_us);
+    prn_stat(st_gc_window_us);
+    prn_stat(st_gc_fsync_us);
+    prn_stat(st_gc_arrival_us);
+    prn_lstat(st_uring_writes);
+    prn_lstat(st_uring_syncs);
+    prn_lstat(st_tier_syncs);
+    prn_lstat(st_tier_full);
+    prn_lstat(st_resv_puts);
+    prn_lstat(st_resv_waits);
+    prn_lstat(st_lz4_records);
+    prn_lstat(st_lz4_in_bytes);
+    prn_lstat(st_lz4_out_bytes);
     prn_stat(st_regsize);
     prn_stat(st_region_wait);
     prn_stat(st_region_nowait);
@@ -347,7 +362,9 @@ static void rep_stats(FILE *out, bdb_state_type *bdb_state)
     char str[80];
     extern int64_t gbl_rep_trans_parallel, gbl_rep_trans_serial,
         gbl_rep_trans_deadlocked, gbl_rep_trans_inline,
-        gbl_rep_rowlocks_multifile;
+        gbl_rep_rowlocks_multifile, gbl_rep_trans_by_page,
+        gbl_rep_page_phases, gbl_rep_prefetch_enqueued,
+        gbl_recovery_redo_batches, gbl_recovery_redo_records;
 
     bdb_state->dbenv->rep_stat(bdb_state->dbenv, &stats, 0);
 
@@ -401,6 +418,16 @@ static void rep_stats(FILE *out, bdb_state_type *bdb_state)
             gbl_rep_rowlocks_multifile);
     logmsgf(LOGMSG_USER, out, "txn deadlocked: %" PRId64 "\n",
             gbl_rep_trans_deadlocked);
+    logmsgf(LOGMSG_USER, out, "txn by page: %" PRId64 "\n",
+            gbl_rep_trans_by_page);
+    logmsgf(LOGMSG_USER, out, "txn page phases: %" PRId64 "\n",
+            gbl_rep_page_phases);
+    logmsgf(LOGMSG_USER, out, "txn pages prefetched: %" PRId64 "\n",
+            gbl_rep_prefetch_enqueued);
+    logmsgf(LOGMSG_USER, out, "recovery redo batches: %" PRId64 "\n",
+            gbl_recovery_redo_batches);
+    logmsgf(LOGMSG_USER, out, "recovery redo records: %" PRId64 "\n",
+            gbl_recovery_redo_records);
     prn_lstat(lc_cache_hits);
     prn_lstat(lc_cache_misses);
     prn_stat(lc_cache_size);
@@ -551,6 +578,8 @@ static void cache_stats(FILE *out, bdb_state_type *bdb_state, int extra)
     prn_lstat(st_ro_levict);
     prn_lstat(st_rw_levict);
     prn_lstat(st_pf_evict);
+    prn_lstat(st_scan_in);
+    prn_lstat(st_scan_promote);
     prn_lstat(st_rw_evict_skip);
     prn_lstat(st_page_trickle);
     prn_lstat(st_pages);
@@ -563,6 +592,8 @@ static void cache_stats(FILE *out, bdb_state_type *bdb_state, int extra)
     prn_lstat(st_hash_nowait);
     prn_lstat(st_hash_wait);
     prn_lstat(st_hash_max_wait);
+    prn_lstat(st_hash_opt_hit);
+    prn_lstat(st_hash_opt_fallback);
     prn_lstat(st_region_wait);
     prn_lstat(st_region_nowait);
     prn_lstat(st_alloc);
@@ -572,6 +603,13 @@ static void cache_stats(FILE *out, bdb_state_type *bdb_state, int extra)
     prn_lstat(st_alloc_max_pages);
     prn_lstat(st_ckp_pages_sync);
     prn_lstat(st_ckp_pages_skip);
+    prn_lstat(st_ctier_hit);
+    prn_lstat(st_ctier_miss);
+    prn_lstat(st_ctier_insert);
+    prn_lstat(st_ctier_evict);
+    prn_lstat(st_ctier_reject);
+    prn_lstat(st_ctier_pages);
+    prn_lstat(st_ctier_bytes);
 
     if (extra) {
         bdb_state->dbenv->memp_dump_region(bdb_state->dbenv, "A", out);
@@ -598,6 +636,120 @@ static void cache_stats(FILE *out, bdb_state_type *bdb_state, int extra)
     free(stats);
 }
 
+static int rstat_cmp(const void *a, const void *b)
+{
+    const DB_MPOOL_RSTAT *ra = a, *rb = b;
+    int cmp = strcmp(ra->file_name, rb->file_name);
+    if (cmp)
+        return cmp;
+    return (ra->level > rb->level) - (ra->level < rb->level);
+}
+
+/* Call func for every (file, btree level) with pages in the cache or
+ * hits, misses or evictions since the stats were last cleared.  Residency
+ * is counted by walking the whole cache. */
+int bdb_collect_bufferpool(bdb_state_type *bdb_state,
+                           collect_bufferpool_f func, void *arg)
+{
+    DB_ENV *dbenv = bdb_state->dbenv;
+    DB_MPOOL_FSTAT **fsp = NULL, **f;
+    DB_MPOOL_RSTAT *rsp = NULL, key, *r;
+    u_int32_t nrs = 0;
+    int level, rc;
+
+    if ((rc = dbenv->memp_stat(dbenv, NULL, &fsp, 0)) != 0)
+        return rc;
+    if ((rc = dbenv->memp_residency(dbenv, &rsp, &nrs, NULL, NULL, 0)) != 0) {
+        free(fsp);
+        return rc;
+    }
+    qsort(rsp, nrs, sizeof(*rsp), rstat_cmp);
+
+    for (f = fsp; rc == 0 && f != NULL && *f != NULL; ++f) {
+        for (level = 0; rc == 0 && level < MPOOL_STAT_LEVELS; level++) {
+            key.file_name = (*f)->file_name;
+            key.level = level;
+            r = bsearch(&key, rsp, nrs, sizeof(*rsp), rstat_cmp);
+            if (r == NULL && (*f)->st_level_hit[level] == 0 &&
+                (*f)->st_level_miss[level] == 0 &&
+                (*f)->st_level_evict[level] == 0)
+                continue;
+            rc = func(arg, (*f)->file_name, level, r ? r->resident : 0,
+                      r ? r->dirty : 0, r ? r->accesses : 0,
+                      (*f)->st_level_hit[level], (*f)->st_level_miss[level],
+                      (*f)->st_level_evict[level]);
+        }
+    }
+    free(rsp);
+    free(fsp);
+    return rc;
+}
+
+/* Call func for every range of pages, of nranges per file, with pages in
+ * the cache */
+int bdb_collect_bufferpool_heat(bdb_state_type *bdb_state, int nranges,
+                                collect_bufferpool_heat_f func, void *arg)
+{
+    DB_ENV *dbenv = bdb_state->dbenv;
+    DB_MPOOL_RSTAT *rsp = NULL;
+    DB_MPOOL_HSTAT *hsp = NULL;
+    u_int32_t nrs = 0, nhs = 0, i;
+    int rc;
+
+    if ((rc = dbenv->memp_residency(dbenv, &rsp, &nrs, &hsp, &nhs,
+                                    nranges)) != 0)
+        return rc;
+    for (i = 0; rc == 0 && i < nhs; i++)
+        rc = func(arg, hsp[i].file_name, hsp[i].first_pgno, hsp[i].last_pgno,
+                  hsp[i].resident, hsp[i].accesses);
+    free(rsp);
+    free(hsp);
+    return rc;
+}
+
+/* Sum the I/O of all the stripes of one file of a table */
+static void table_file_io(DB_ENV *dbenv, DB **dbps, int n, DB_MPOOL_IOSTAT *st)
+{
+    DB_MPOOL_IOSTAT one;
+    int i;
+
+    memset(st, 0, sizeof(*st));
+    for (i = 0; i < n; i++) {
+        if (dbps[i] == NULL ||
+            dbenv->memp_iostat(dbenv, dbps[i]->fileid, &one) != 0)
+            continue;
+        st->st_faults += one.st_faults;
+        st->st_reads += one.st_reads;
+        st->st_read_bytes += one.st_read_bytes;
+        st->st_writes += one.st_writes;
+        st->st_write_bytes += one.st_write_bytes;
+    }
+}
+
+/* Call func with the I/O of the data file, each blob file and each index
+ * of a table.  Blobs and indexes are numbered from 0. */
+int bdb_collect_table_io(bdb_state_type *bdb_state, collect_table_io_f func,
+                         void *arg)
+{
+    DB_ENV *dbenv = bdb_state->dbenv;
+    DB_MPOOL_IOSTAT st;
+    int dtanum, ix, rc = 0;
+
+    for (dtanum = 0; rc == 0 && dtanum < bdb_state->numdtafiles; dtanum++) {
+        table_file_io(dbenv, bdb_state->dbp_data[dtanum],
+                      bdb_get_datafile_num_files(bdb_state, dtanum), &st);
+        rc = func(arg, dtanum ? "blob" : "data", dtanum ? dtanum - 1 : 0,
+                  st.st_faults, st.st_reads, st.st_read_bytes, st.st_writes,
+                  st.st_write_bytes);
+    }
+    for (ix = 0; rc == 0 && ix < bdb_state->numix; ix++) {
+        table_file_io(dbenv, &bdb_state->dbp_ix[ix], 1, &st);
+        rc = func(arg, "index", ix, st.st_faults, st.st_reads,
+                  st.st_read_bytes, st.st_writes, st.st_write_bytes);
+    }
+    return rc;
+}
+
 static void temp_cache_stats(FILE *out, bdb_state_type *bdb_state)
 {
     DB_MPOOL_STAT *stats;
@@ -1289,6 +1441,7 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
         "*logstat        - log stats", "*txnstat        - transaction stats",
         "*ltranstat      - logical transaction stats",
         "*lockstat       - lock subsystem stats",
+        " lockwaitsclear - reset the comdb2_lock_waits profile",
         " fulldiag       - dump loads of stuff - please use with f prefix",
         "*sanc           - list 'sanctioned' cluster members",
         " repdbg[yn]     - verbose replication yes/no",
@@ -1440,6 +1593,8 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
         lock_info(out, bdb_state, line, st, lline);
     else if (tokcmp(tok, ltok, "activelocks") == 0)
         bdb_dump_active_locks(bdb_state, out);
+    else if (tokcmp(tok, ltok, "lockwaitsclear") == 0)
+        bdb_clear_lock_waits();
     else if (tokcmp(tok, ltok, "dumpcache") == 0)
         bdb_dump_cache(bdb_state, out);
     else if (tokcmp(tok, ltok, "truncrepdb") == 0)
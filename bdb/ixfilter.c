@@ -0,0 +1,336 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+  Bloom filters for unique indexes
+
+  On the master, every unique index can get an in-memory bloom filter of
+  its keys.  The filter is built by a background scan and kept up to date
+  by ll_key_add(); keys are never taken out, so a deleted key only costs a
+  false positive.  A unique-key check that the filter says can't match
+  skips its descent of the btree.
+
+  A filter is only trusted while the node stays the master it was built
+  under: writes that come in through replication don't pass through
+  ll_key_add().  Master changes happen under the bdb write lock, so no
+  transaction spans one.  Filters are freed when the table's files are
+  closed, also under the write lock.
+*/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bdb_int.h"
+#include "locks.h"
+#include "locks_wrap.h"
+#include "memory_sync.h"
+#include "crc32c.h"
+#include <comdb2_atomic.h>
+#include <logmsg.h>
+#include <thrman.h>
+
+#include <build/db_int.h>
+#include "dbinc/mp.h"
+
+/* memory for all the filters, in MB; 0 turns them off */
+int gbl_ix_filter_mb = 0;
+
+/* bits per expected key; 10 with 7 probes is about a 1% false positive
+   rate */
+#define IXFILTER_BITS_PER_KEY 10
+#define IXFILTER_PROBES 7
+#define IXFILTER_MIN_KEYS 1024
+
+/* keys scanned between checks for someone wanting the bdb write lock */
+#define IXFILTER_SCAN_CHUNK 1000
+
+struct bdb_ixfilter {
+    uint64_t *bits;
+    uint64_t mask;     /* number of bits - 1 */
+    uint64_t capacity; /* keys it was sized for */
+    uint64_t nkeys;    /* keys added, including duplicates */
+    int epoch;         /* ixfilter_epoch when it was built */
+    int ready;         /* the build scan is done */
+    size_t size;
+    struct bdb_ixfilter *retired; /* outgrown filters, freed on close */
+};
+
+/* bumped every time the master changes */
+static int ixfilter_epoch;
+static int64_t ixfilter_bytes;
+
+extern int gbl_is_physical_replicant;
+
+void bdb_ixfilter_invalidate(void)
+{
+    ATOMIC_ADD32(ixfilter_epoch, 1);
+}
+
+static inline void ixfilter_hash(const void *key, int len, uint32_t *h1,
+                                 uint32_t *h2)
+{
+    const uint8_t *p = key;
+    uint32_t h = 2166136261u;
+    int i;
+
+    *h1 = crc32c(p, len);
+    for (i = 0; i < len; ++i)
+        h = (h ^ p[i]) * 16777619u;
+    *h2 = h | 1;
+}
+
+static void ixfilter_set(struct bdb_ixfilter *f, const void *key, int len)
+{
+    uint32_t h1, h2;
+    uint64_t bit, m;
+    int i;
+
+    ixfilter_hash(key, len, &h1, &h2);
+    for (i = 0; i < IXFILTER_PROBES; ++i) {
+        bit = (h1 + (uint64_t)i * h2) & f->mask;
+        m = 1ULL << (bit & 63);
+        if ((f->bits[bit >> 6] & m) == 0)
+            __sync_fetch_and_or(&f->bits[bit >> 6], m);
+    }
+    ATOMIC_ADD64(f->nkeys, 1);
+}
+
+static int ixfilter_test(const struct bdb_ixfilter *f, const void *key,
+                         int len)
+{
+    uint32_t h1, h2;
+    uint64_t bit;
+    int i;
+
+    ixfilter_hash(key, len, &h1, &h2);
+    for (i = 0; i < IXFILTER_PROBES; ++i) {
+        bit = (h1 + (uint64_t)i * h2) & f->mask;
+        if ((f->bits[bit >> 6] & (1ULL << (bit & 63))) == 0)
+            return 0;
+    }
+    return 1;
+}
+
+void bdb_ixfilter_add(bdb_state_type *bdb_state, int ixnum, const DBT *key)
+{
+    struct bdb_ixfilter *f = bdb_state->ixfilter[ixnum];
+
+    /* the key may carry a genid to keep nulls unique; filter the key */
+    if (f && key->size >= bdb_state->ixlen[ixnum])
+        ixfilter_set(f, key->data, bdb_state->ixlen[ixnum]);
+}
+
+int bdb_ixfilter_may_contain(bdb_state_type *bdb_state, int ixnum,
+                             const void *key, int keylen)
+{
+    repinfo_type *repinfo = bdb_state->repinfo;
+    struct bdb_ixfilter *f;
+
+    if (ixnum < 0 || ixnum >= bdb_state->numix ||
+        keylen < bdb_state->ixlen[ixnum])
+        return 1;
+    f = bdb_state->ixfilter[ixnum];
+    if (f == NULL || !f->ready || f->epoch != ATOMIC_LOAD32(ixfilter_epoch) ||
+        f->nkeys > f->capacity || repinfo->master_host != repinfo->myhost)
+        return 1;
+    return ixfilter_test(f, key, bdb_state->ixlen[ixnum]);
+}
+
+void bdb_ixfilter_free(bdb_state_type *bdb_state)
+{
+    struct bdb_ixfilter *f, *next;
+    int i;
+
+    for (i = 0; i < MAXINDEX; ++i) {
+        for (f = bdb_state->ixfilter[i]; f; f = next) {
+            next = f->retired;
+            ATOMIC_ADD64(ixfilter_bytes, -(int64_t)f->size);
+            free(f->bits);
+            free(f);
+        }
+        bdb_state->ixfilter[i] = NULL;
+    }
+}
+
+/* Size a filter for roughly twice the keys the index file can hold now. */
+static struct bdb_ixfilter *ixfilter_alloc(bdb_state_type *bdb_state,
+                                          int ixnum)
+{
+    struct bdb_ixfilter *f;
+    DB *dbp = bdb_state->dbp_ix[ixnum];
+    db_pgno_t last = 0;
+    uint64_t nkeys, nbits;
+    size_t entsz, size;
+
+    __memp_last_pgno(dbp->mpf, &last);
+    entsz = bdb_state->ixlen[ixnum] + sizeof(unsigned long long) + 16;
+    if (bdb_state->ixdta[ixnum])
+        entsz += bdb_state->lrl;
+    nkeys = 2 * ((uint64_t)(last + 1) * dbp->pgsize / entsz);
+    if (nkeys < IXFILTER_MIN_KEYS)
+        nkeys = IXFILTER_MIN_KEYS;
+    for (nbits = 64; nbits < nkeys * IXFILTER_BITS_PER_KEY; nbits <<= 1)
+        ;
+    size = nbits / 8;
+
+    if (ATOMIC_LOAD64(ixfilter_bytes) + size >
+        (uint64_t)gbl_ix_filter_mb * 1024 * 1024)
+        return NULL;
+    if ((f = calloc(1, sizeof(*f))) == NULL)
+        return NULL;
+    if ((f->bits = calloc(1, size)) == NULL) {
+        free(f);
+        return NULL;
+    }
+    f->mask = nbits - 1;
+    f->capacity = nkeys;
+    f->size = size;
+    ATOMIC_ADD64(ixfilter_bytes, size);
+    return f;
+}
+
+/* Fill f from the index.  Returns 0 when the whole index was read. */
+static int ixfilter_scan(bdb_state_type *bdb_state, int ixnum,
+                         struct bdb_ixfilter *f)
+{
+    DB *dbp = bdb_state->dbp_ix[ixnum];
+    DBC *dbcp;
+    DBT key = {0}, data = {0};
+    unsigned char keybuf[MAXKEYSZ];
+    char dumbuf;
+    int n, rc;
+
+    rc = dbp->cursor(dbp, NULL, &dbcp, DB_DIRTY_READ);
+    if (rc)
+        return rc;
+
+    key.data = keybuf;
+    key.ulen = sizeof(keybuf);
+    key.flags = DB_DBT_USERMEM;
+    data.data = &dumbuf;
+    data.ulen = 1;
+    data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+
+    n = 0;
+    rc = dbcp->c_get(dbcp, &key, &data, DB_FIRST);
+    while (rc == 0) {
+        if (key.size >= bdb_state->ixlen[ixnum])
+            ixfilter_set(f, key.data, bdb_state->ixlen[ixnum]);
+        if (++n % IXFILTER_SCAN_CHUNK == 0 &&
+            (bdb_state->parent->bdb_lock_desired || db_is_exiting())) {
+            rc = -1;
+            break;
+        }
+        rc = dbcp->c_get(dbcp, &key, &data, DB_NEXT);
+    }
+    dbcp->c_close(dbcp);
+    return rc == DB_NOTFOUND ? 0 : rc;
+}
+
+/*
+ * Build the next filter that needs it.  The filter is published before the
+ * scan so that keys added while it runs go in too; a key added before it is
+ * published is already in the btree, where the scan finds it.
+ */
+static void ixfilter_build(bdb_state_type *bdb_state)
+{
+    bdb_state_type *child;
+    struct bdb_ixfilter *f, *old;
+    int epoch = ATOMIC_LOAD32(ixfilter_epoch);
+    int i, ix, rc;
+
+    for (i = 0; i < bdb_state->numchildren; ++i) {
+        child = bdb_state->children[i];
+        if (child == NULL || child->bdbtype != BDBTYPE_TABLE)
+            continue;
+        for (ix = 0; ix < child->numix; ++ix) {
+            if (child->ixdups[ix] || child->dbp_ix[ix] == NULL)
+                continue;
+            old = child->ixfilter[ix];
+            if (old && old->ready && old->epoch == epoch &&
+                old->nkeys <= old->capacity)
+                continue;
+
+            if (old && old->nkeys <= old->capacity) {
+                /* no lookup trusts it, so it can be refilled in place */
+                f = old;
+                f->ready = 0;
+                MEMORY_SYNC;
+                memset(f->bits, 0, f->size);
+                f->nkeys = 0;
+            } else {
+                /* outgrown: lookups may still be reading the old one */
+                if ((f = ixfilter_alloc(child, ix)) == NULL)
+                    continue;
+                f->retired = old;
+            }
+            MEMORY_SYNC;
+            child->ixfilter[ix] = f;
+            MEMORY_SYNC;
+
+            rc = ixfilter_scan(child, ix, f);
+            if (rc == 0) {
+                f->epoch = epoch;
+                MEMORY_SYNC;
+                f->ready = 1;
+                logmsg(LOGMSG_INFO,
+                       "%s: built filter for %s ix %d, %zu bytes, %" PRIu64
+                       " keys\n",
+                       __func__, child->name, ix, f->size, f->nkeys);
+            } else if (rc != -1) {
+                logmsg(LOGMSG_ERROR, "%s: scanning %s ix %d rc %d\n", __func__,
+                       child->name, ix, rc);
+            }
+            /* one filter per call, so the bdb lock is let go in between */
+            return;
+        }
+    }
+}
+
+void *ix_filter_thread(void *arg)
+{
+    bdb_state_type *bdb_state = arg;
+    repinfo_type *repinfo;
+
+    if (bdb_state->parent)
+        bdb_state = bdb_state->parent;
+    repinfo = bdb_state->repinfo;
+
+    while (!bdb_state->after_llmeta_init_done)
+        sleep(1);
+
+    thrman_register(THRTYPE_GENERIC);
+    thread_started("bdb ix filter");
+
+    bdb_thread_event(bdb_state, 1);
+
+    while (!db_is_exiting()) {
+        sleep(1);
+
+        if (gbl_ix_filter_mb <= 0 || gbl_is_physical_replicant ||
+            repinfo->master_host != repinfo->myhost)
+            continue;
+
+        BDB_READLOCK("ix_filter_thread");
+        ixfilter_build(bdb_state);
+        BDB_RELLOCK();
+    }
+
+    bdb_thread_event(bdb_state, 0);
+    return NULL;
+}
@@ -862,6 +862,7 @@ int ll_key_add(bdb_state_type *bdb_state, unsigned long long ingenid,
         if (rc) {
             return rc;
         }
+        bdb_ixfilter_add(bdb_state, ixnum, dbt_key);
 
         if (!rc && add_snapisol_logging(bdb_state, tran)) {
             tran_type *parent = (tran->parent) ? tran->parent : tran;
@@ -983,7 +984,9 @@ static int ll_dta_upd_int(bdb_state_type *bdb_state, int rrn,
         if (keep_genid_intact) {
             inplace = 1;
         } else if (0 == *newgenid) {
-            if (ip_updates_enabled(bdb_state)) {
+            /* A zone map covers a range of genids with the values it saw
+               there; a row that changes must leave the range. */
+            if (ip_updates_enabled(bdb_state) && !bdb_state->zonemaps) {
                 int newupd = (1 + get_updateid_from_genid(bdb_state, oldgenid));
                 if (newupd <= max_updateid(bdb_state)) {
                     *newgenid = set_updateid(bdb_state, newupd, oldgenid);
@@ -170,6 +170,9 @@ typedef enum {
     LLMETA_SEQUENCE_VALUE = 53,
     LLMETA_LUA_SFUNC_FLAG = 54,
     LLMETA_NEWSC_REDO_GENID = 55, /* 55 + TABLENAME + GENID -> MAX-LSN */
+    LLMETA_TRIGGER_LOG_LSN = 56,  /* where deferred triggers have read to */
+    LLMETA_ZSTD_DICT = 57,        /* 57 + TABLENAME + DICTID -> DICT */
+    LLMETA_ZONEMAP = 58,          /* 58 + TABLENAME -> ZONE MAP */
 } llmetakey_t;
 
 struct llmeta_file_type_key {
@@ -1254,9 +1257,138 @@ static const uint8_t *llmeta_tablename_alias_data_get(
     return p_buf;
 }
 
+extern u_int32_t __memp_chg_gen(DB_MPOOLFILE *);
+
+/* Small llmeta records read outside of a transaction (table versions, user
+ * permissions, ...) are cached.  An entry keeps llmeta's change generation
+ * from before it was read and is only used while the generation hasn't
+ * moved; dirtying any llmeta page, here or by replication, moves it.  So
+ * any write to llmeta makes every entry stale, on the master and on
+ * replicants alike. */
+int gbl_llmeta_cache_size = 1024;
+
+enum { LLMETA_CACHE_DTALEN = 64 };
+
+typedef struct {
+    uint8_t key[LLMETA_IXLEN];
+    DB_MPOOLFILE *mpf;
+    u_int32_t gen;
+    int maxlen;
+    int rc;
+    int bdberr;
+    int fndlen;
+    uint8_t dta[LLMETA_CACHE_DTALEN];
+    lrucache_link lnk;
+} llmeta_cache_entry_t;
+
+static lrucache *llmeta_cache;
+static pthread_mutex_t llmeta_cache_mu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t llmeta_cache_once = PTHREAD_ONCE_INIT;
+
+static unsigned int llmeta_cache_hash(const void *p, int len)
+{
+    unsigned int h = 0;
+    const uint8_t *key = p;
+    for (int i = 0; i < LLMETA_IXLEN; ++i) {
+        h = ((h % 8388013) << 8) + (key[i]);
+    }
+    return h;
+}
+
+static int llmeta_cache_cmp(const void *key1, const void *key2, int len)
+{
+    return memcmp(key1, key2, LLMETA_IXLEN);
+}
+
+static void llmeta_cache_init(void)
+{
+    llmeta_cache = lrucache_init(llmeta_cache_hash, llmeta_cache_cmp, free,
+                                 offsetof(llmeta_cache_entry_t, lnk),
+                                 offsetof(llmeta_cache_entry_t, key),
+                                 LLMETA_IXLEN, gbl_llmeta_cache_size);
+}
+
+/* bdb_lite_exact_fetch_tran on llmeta, through the cache when it can be.
+ * Only found and not-found answers are cached, never deadlocks or errors. */
+static int llmeta_exact_fetch_tran(tran_type *tran, void *key, void *fnddta,
+                                   int maxlen, int *fndlen, int *bdberr)
+{
+    llmeta_cache_entry_t *ent;
+    DB_MPOOLFILE *mpf;
+    u_int32_t gen;
+    int rc, add = 0;
+
+    if (tran || gbl_llmeta_cache_size <= 0 || maxlen > LLMETA_CACHE_DTALEN)
+        return bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, fnddta,
+                                         maxlen, fndlen, bdberr);
+
+    pthread_once(&llmeta_cache_once, llmeta_cache_init);
+    mpf = llmeta_bdb_state->dbp_data[0][0]->mpf;
+    /* before the read: a write that races with it makes what we cache stale
+     * rather than letting it look current */
+    gen = __memp_chg_gen(mpf);
+
+    Pthread_mutex_lock(&llmeta_cache_mu);
+    if ((ent = lrucache_find(llmeta_cache, key)) != NULL) {
+        int hit = ent->mpf == mpf && ent->gen == gen && ent->maxlen == maxlen;
+        if (hit) {
+            rc = ent->rc;
+            *bdberr = ent->bdberr;
+            if (rc == 0) {
+                *fndlen = ent->fndlen;
+                if (ent->fndlen)
+                    memcpy(fnddta, ent->dta, ent->fndlen);
+            }
+        }
+        lrucache_release(llmeta_cache, key);
+        if (hit) {
+            Pthread_mutex_unlock(&llmeta_cache_mu);
+            return rc;
+        }
+    }
+    Pthread_mutex_unlock(&llmeta_cache_mu);
+
+    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, NULL, key, fnddta, maxlen,
+                                   fndlen, bdberr);
+    if (rc && *bdberr != BDBERR_FETCH_DTA)
+        return rc;
+
+    Pthread_mutex_lock(&llmeta_cache_mu);
+    if ((ent = lrucache_find(llmeta_cache, key)) == NULL &&
+        (ent = calloc(1, sizeof(*ent))) != NULL) {
+        memcpy(ent->key, key, LLMETA_IXLEN);
+        add = 1;
+    }
+    if (ent) {
+        ent->mpf = mpf;
+        ent->gen = gen;
+        ent->maxlen = maxlen;
+        ent->rc = rc;
+        ent->bdberr = *bdberr;
+        ent->fndlen = rc == 0 ? *fndlen : 0;
+        if (ent->fndlen)
+            memcpy(ent->dta, fnddta, ent->fndlen);
+        if (add)
+            lrucache_add(llmeta_cache, ent);
+        else
+            lrucache_release(llmeta_cache, key);
+    }
+    Pthread_mutex_unlock(&llmeta_cache_mu);
+    return rc;
+}
+
 /* returns true if we have a llmeta table open else false */
 int bdb_have_llmeta() { return llmeta_bdb_state != NULL; }
 
+/* moves whenever llmeta is written, locally or by replication; see
+ * llmeta_exact_fetch_tran */
+unsigned int bdb_llmeta_chg_gen(void)
+{
+    if (llmeta_bdb_state == NULL)
+        return 0;
+    return __memp_chg_gen(llmeta_bdb_state->dbp_data[0][0]->mpf);
+}
+
 /* opens the low level meta table, if this is not called, any calls to
  * bdb_get_file_version* will return successfully but with a 0 version_number
  * any calls to bdb_new_file_version will fail */
@@ -1526,7 +1658,7 @@ int bdb_llmeta_get_tables(
 
 retry:
     /* try to fetch the version number */
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, input_trans, key, p_outbuf,
+    rc = llmeta_exact_fetch_tran(input_trans, key, p_outbuf,
                                    outbuflen, &fndlen, bdberr);
 
     /* handle return codes */
@@ -1821,7 +1953,7 @@ bdb_chg_file_versions_int(tran_type *trans, /* must be !NULL */
 
         char fnddta[sizeof(unsigned long long)];
         int fndlen = 0;
-        rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, trans, key, fnddta,
+        rc = llmeta_exact_fetch_tran(trans, key, fnddta,
                                        sizeof(fnddta), &fndlen, bdberr);
         if (!rc) {
             rc = bdb_lite_add(llmeta_bdb_state, trans, fnddta, fndlen, new_key,
@@ -2573,7 +2705,7 @@ static int bdb_get_file_version(
 
 retry:
     /* try to fetch the version number */
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, &tmpversion,
+    rc = llmeta_exact_fetch_tran(tran, key, &tmpversion,
                                    sizeof(tmpversion), &fndlen, bdberr);
 
     /* handle return codes */
@@ -2804,7 +2936,7 @@ static int bdb_get_pagesize(tran_type *tran, /* transaction to use */
 retry:
 
     /* try to fetch the version number */
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, &pgsize,
+    rc = llmeta_exact_fetch_tran(tran, key, &pgsize,
                                    sizeof(int), &fndlen, bdberr);
 
     /* handle return codes */
@@ -4838,7 +4970,7 @@ int bdb_get_high_genid(
 
 retry:
     /* try to fetch the schema change data */
-    rc = bdb_lite_exact_fetch(llmeta_bdb_state, key, &tmpgenid,
+    rc = llmeta_exact_fetch_tran(NULL, key, &tmpgenid,
                               sizeof(tmpgenid), &fndlen, bdberr);
 
     /* genids don't get flipped */
@@ -4923,7 +5055,7 @@ int bdb_get_file_lwm(bdb_state_type *bdb_state, tran_type *tran, DB_LSN *lsn,
     }
 
     /* llmeta_bdb_state */
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, &tmplsn,
+    rc = llmeta_exact_fetch_tran(tran, key, &tmplsn,
                                    sizeof(tmplsn), &fndlen, bdberr);
     if (rc) {
         /* if we don't have an entry, return 1:0. */
@@ -5158,7 +5290,7 @@ int bdb_get_sp_get_default_version_tran(tran_type *tran, const char *sp_name, in
 
     int default_ver;
     int default_version;
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, &default_ver, sizeof(int), &size, bdberr);
+    rc = llmeta_exact_fetch_tran(tran, key, &default_ver, sizeof(int), &size, bdberr);
     buf_get(&default_version, sizeof(default_version), (uint8_t *)&default_ver,
             ((uint8_t *)&default_ver) + sizeof(default_ver));
     if (rc)
@@ -5444,7 +5576,7 @@ int bdb_get_global_stripe_info(tran_type *tran, int *stripes, int *blobstripe,
         return -1;
     }
 
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, buf,
+    rc = llmeta_exact_fetch_tran(tran, key, buf,
                                    LLMETA_GLOBAL_STRIPE_INFO_LEN, &fndlen,
                                    bdberr);
 
@@ -5558,7 +5690,7 @@ int bdb_get_num_sc_done(bdb_state_type *bdb_state, tran_type *tran,
         return -1;
     }
 
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, &tmpnum,
+    rc = llmeta_exact_fetch_tran(tran, key, &tmpnum,
                                    sizeof(tmpnum), &fndlen, bdberr);
 
     tmpnum = flibc_ntohll(tmpnum);
@@ -5652,7 +5784,7 @@ int bdb_get_sc_seed(bdb_state_type *bdb_state, tran_type *tran,
         return -1;
     }
 
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, data_buf,
+    rc = llmeta_exact_fetch_tran(tran, key, data_buf,
                                    data_sz, &fndlen, bdberr);
     if (rc == 0) {
         *genid = *(unsigned long long *)data_buf;
@@ -6119,7 +6251,7 @@ int bdb_tbl_op_access_get(bdb_state_type *bdb_state, tran_type *input_trans,
         return -1;
     }
 
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, input_trans, key, NULL, 0,
+    rc = llmeta_exact_fetch_tran(input_trans, key, NULL, 0,
                                    &fndlen, bdberr);
 
     return rc;
@@ -6352,7 +6484,7 @@ static int bdb_feature_get_int(bdb_state_type *bdb_state, tran_type *tran,
         return -1;
     }
 
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, NULL, 0,
+    rc = llmeta_exact_fetch_tran(tran, key, NULL, 0,
                                    &fndlen, bdberr);
 
     return rc;
@@ -6410,7 +6542,7 @@ static int bdb_tbl_access_get(bdb_state_type *bdb_state, tran_type *input_trans,
         return -1;
     }
 
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, input_trans, key, NULL, 0,
+    rc = llmeta_exact_fetch_tran(input_trans, key, NULL, 0,
                                    &fndlen, bdberr);
 
     return rc;
@@ -6852,6 +6984,22 @@ int bdb_llmeta_print_record(bdb_state_type *bdb_state, void *key, int keylen,
         logmsg(LOGMSG_USER, "LLMETA_SC_START_LSN: table=\"%s\" [%u:%u]\n",
                akey.dbname, adata.lsn.file, adata.lsn.offset);
     } break;
+    case LLMETA_TRIGGER_LOG_LSN: {
+        struct llmeta_db_lsn_data_type adata = {{0}};
+
+        if (datalen < sizeof(adata)) {
+            logmsg(LOGMSG_USER, "%s:%d: wrong LLMETA_TRIGGER_LOG_LSN entry\n",
+                   __FILE__, __LINE__);
+            *bdberr = BDBERR_MISC;
+            return -1;
+        }
+
+        p_buf_data =
+            llmeta_db_lsn_data_type_get(&adata, p_buf_data, p_buf_end_data);
+
+        logmsg(LOGMSG_USER, "LLMETA_TRIGGER_LOG_LSN: [%u:%u]\n",
+               adata.lsn.file, adata.lsn.offset);
+    } break;
     case LLMETA_TABLE_USER_READ:
     case LLMETA_TABLE_USER_WRITE: {
         struct llmeta_tbl_access akey;
@@ -6933,6 +7081,25 @@ int bdb_llmeta_print_record(bdb_state_type *bdb_state, void *key, int keylen,
                    "LLMETA_TABLE_PARAMETERS table=\"%s\" value=\"%s\"\n",
                    tblname, (char *)data);
         } break;
+        case LLMETA_ZSTD_DICT: {
+            char tblname[LLMETA_TBLLEN + 1] = {0};
+            uint32_t dictid = 0;
+            p_buf_key = buf_no_net_get(&(tblname), LLMETA_TBLLEN,
+                                       p_buf_key + sizeof(int), p_buf_end_key);
+            buf_get(&dictid, sizeof(dictid), p_buf_key, p_buf_end_key);
+
+            logmsg(LOGMSG_USER,
+                   "LLMETA_ZSTD_DICT table=\"%s\" dictid=%u size=%d\n",
+                   tblname, dictid, datalen);
+        } break;
+        case LLMETA_ZONEMAP: {
+            char tblname[LLMETA_TBLLEN + 1] = {0};
+            buf_no_net_get(&(tblname), LLMETA_TBLLEN, p_buf_key + sizeof(int),
+                           p_buf_end_key);
+
+            logmsg(LOGMSG_USER, "LLMETA_ZONEMAP table=\"%s\" size=%d\n",
+                   tblname, datalen);
+        } break;
         default:
             logmsg(LOGMSG_USER, "Todo (type=%d)\n", type);
             break;
@@ -7027,7 +7194,7 @@ int bdb_get_analyzecoverage_table(tran_type *input_trans, const char *tbl_name,
 
 retry:
     /* try to fetch the schema change data */
-    rc = bdb_lite_exact_fetch(llmeta_bdb_state, key, &tmpval, sizeof(tmpval),
+    rc = llmeta_exact_fetch_tran(NULL, key, &tmpval, sizeof(tmpval),
                               &fndlen, bdberr);
 
     /* tmpval may need to get flipped */
@@ -7266,7 +7433,7 @@ int bdb_get_analyzethreshold_table(tran_type *input_trans, const char *tbl_name,
 
 retry:
     /* try to fetch the schema change data */
-    rc = bdb_lite_exact_fetch(llmeta_bdb_state, key, &tmpval, sizeof(tmpval),
+    rc = llmeta_exact_fetch_tran(NULL, key, &tmpval, sizeof(tmpval),
                               &fndlen, bdberr);
 
     /* tmpval may need to get flipped */
@@ -7335,7 +7502,7 @@ int bdb_get_rowlocks_state(int *rlstate, tran_type *tran, int *bdberr)
     llmeta_rowlocks_state_key_type_put(&rowlocks_key, p_buf, p_buf_end);
 
 retry:
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, data,
+    rc = llmeta_exact_fetch_tran(tran, key, data,
                                    LLMETA_ROWLOCKS_STATE_DATA_LEN, &fndlen,
                                    bdberr);
 
@@ -7614,7 +7781,7 @@ static int llmeta_get_uint64(llmetakey_t key, uint64_t *value)
     char llkey[LLMETA_IXLEN] = {0};
     key = htonl(key);
     memcpy(llkey, &key, sizeof(key));
-    if ((rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, NULL, llkey, &tmp,
+    if ((rc = llmeta_exact_fetch_tran(NULL, llkey, &tmp,
                                         sizeof(tmp), &fndlen, &bdberr)) == 0) {
         *value = flibc_htonll(tmp);
     } else if (bdberr == BDBERR_FETCH_DTA) {
@@ -7645,7 +7812,7 @@ rep:
     memcpy(llkey, &key, sizeof(key));
     int fndlen;
     uint64_t tmp;
-    if ((rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, llkey, &tmp,
+    if ((rc = llmeta_exact_fetch_tran(tran, llkey, &tmp,
                                         sizeof(tmp), &fndlen, &bdberr)) != 0) {
         if (bdberr == BDBERR_FETCH_DTA) {
             // not found -- just add
@@ -7931,7 +8098,7 @@ char *llmeta_get_tablename_alias_tran(tran_type *tran, const char *tablename_ali
     }
 
 retry:
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, &key_buf, data_buf, LLMETA_TABLENAME_ALIAS_DATA_LEN, &fndlen,
+    rc = llmeta_exact_fetch_tran(tran, &key_buf, data_buf, LLMETA_TABLENAME_ALIAS_DATA_LEN, &fndlen,
                                    &bdberr);
     if (rc || bdberr != BDBERR_NOERROR) {
         if (bdberr == BDBERR_DEADLOCK) {
@@ -8371,7 +8538,7 @@ int bdb_table_version_select_verbose(const char *tblname, tran_type *tran,
 
 retry:
     /* try to fetch the version number */
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, fnddata,
+    rc = llmeta_exact_fetch_tran(tran, key, fnddata,
                                    sizeof(fnddata), &fnddatalen, bdberr);
 
     /* handle return codes */
@@ -9814,7 +9981,7 @@ static int table_file_callback(bdb_state_type *bdb_state, tran_type *tran, unsig
     int fndlen;
     int bdberr;
 
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, rec, &version, sizeof(version), &fndlen, &bdberr);
+    rc = llmeta_exact_fetch_tran(tran, rec, &version, sizeof(version), &fndlen, &bdberr);
 
     return (rc == 0 && fndlen == sizeof(version) && version == *file_version);
 }
@@ -10346,6 +10513,192 @@ done:
     return rc;
 }
 
+/*
+** Trained zstd dictionaries, per table.  Records compressed with a dictionary
+** carry its id in the ODH, so a dictionary is never replaced, only added to.
+** Schema:
+**    key: LLMETA_ZSTD_DICT + TABLENAME + DICTID
+**  value: dictionary as returned by ZDICT_trainFromBuffer()
+*/
+struct zstd_dict_key {
+    int32_t key; // LLMETA_ZSTD_DICT
+    char tblname[LLMETA_TBLLEN];
+    uint32_t dictid;
+};
+enum { ZSTD_DICT_KEY_PREFIX = sizeof(int32_t) + LLMETA_TBLLEN };
+
+int bdb_add_zstd_dict(tran_type *tran, const char *table, uint32_t dictid,
+                      const void *dict, int len, int *bdberr)
+{
+    union {
+        struct zstd_dict_key zkey;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+
+    u.zkey.key = htonl(LLMETA_ZSTD_DICT);
+    strncpy0(u.zkey.tblname, table, sizeof(u.zkey.tblname));
+    u.zkey.dictid = htonl(dictid);
+
+    return kv_put(tran, &u, (void *)dict, len, bdberr);
+}
+
+/* Fetch every dictionary stored for "table", in dictid order.  The caller
+ * frees each dicts[i] and the three arrays. */
+int bdb_get_zstd_dicts(tran_type *tran, const char *table, uint32_t **ids,
+                       void ***dicts, int **lens, int *num, int *bdberr)
+{
+    union {
+        struct zstd_dict_key zkey;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+    uint8_t out[LLMETA_IXLEN];
+    int n = 0, alloc = 0, fnd;
+
+    *ids = NULL;
+    *dicts = NULL;
+    *lens = NULL;
+
+    u.zkey.key = htonl(LLMETA_ZSTD_DICT);
+    strncpy0(u.zkey.tblname, table, sizeof(u.zkey.tblname));
+
+    int rc = bdb_lite_fetch_partial_tran(llmeta_bdb_state, tran, &u,
+                                         ZSTD_DICT_KEY_PREFIX, out, &fnd,
+                                         bdberr);
+    while (rc == 0 && fnd == 1) {
+        if (memcmp(&u, out, ZSTD_DICT_KEY_PREFIX) != 0) {
+            break;
+        }
+        void *dta;
+        int dsz;
+        rc = bdb_lite_exact_var_fetch_tran(llmeta_bdb_state, tran, out, &dta,
+                                           &dsz, bdberr);
+        if (rc || *bdberr != BDBERR_NOERROR) {
+            break;
+        }
+        if (n == alloc) {
+            alloc += 4;
+            *ids = realloc(*ids, sizeof(uint32_t) * alloc);
+            *dicts = realloc(*dicts, sizeof(void *) * alloc);
+            *lens = realloc(*lens, sizeof(int) * alloc);
+        }
+        (*ids)[n] = ntohl(((struct zstd_dict_key *)out)->dictid);
+        (*dicts)[n] = dta;
+        (*lens)[n] = dsz;
+        ++n;
+        uint8_t nxt[LLMETA_IXLEN];
+        rc = bdb_lite_fetch_keys_fwd_tran(llmeta_bdb_state, tran, out, nxt, 1,
+                                          &fnd, bdberr);
+        memcpy(out, nxt, sizeof(out));
+    }
+    *num = n;
+    return rc;
+}
+
+static void free_zstd_dicts(uint32_t *ids, void **dicts, int *lens, int num)
+{
+    for (int i = 0; i < num; ++i)
+        free(dicts[i]);
+    free(ids);
+    free(dicts);
+    free(lens);
+}
+
+/* drop (and optionally re-add under "newname") all dictionaries of "table" */
+static int move_zstd_dicts(tran_type *tran, const char *table,
+                           const char *newname, int *bdberr)
+{
+    union {
+        struct zstd_dict_key zkey;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+    uint32_t *ids;
+    void **dicts;
+    int *lens;
+    int num = 0;
+
+    int rc = bdb_get_zstd_dicts(tran, table, &ids, &dicts, &lens, &num, bdberr);
+    for (int i = 0; rc == 0 && i < num; ++i) {
+        memset(&u, 0, sizeof(u));
+        u.zkey.key = htonl(LLMETA_ZSTD_DICT);
+        strncpy0(u.zkey.tblname, table, sizeof(u.zkey.tblname));
+        u.zkey.dictid = htonl(ids[i]);
+        rc = kv_del(tran, &u, bdberr);
+        if (rc == 0 && newname)
+            rc = bdb_add_zstd_dict(tran, newname, ids[i], dicts[i], lens[i],
+                                   bdberr);
+    }
+    free_zstd_dicts(ids, dicts, lens, num);
+    return rc;
+}
+
+int bdb_del_zstd_dicts(tran_type *tran, const char *table, int *bdberr)
+{
+    return move_zstd_dicts(tran, table, NULL, bdberr);
+}
+
+/*
+** Zone maps the master keeps for a table (see db/zonemap.c).
+** Schema:
+**    key: LLMETA_ZONEMAP + TABLENAME
+**  value: serialized zone map
+*/
+struct zonemap_key {
+    int32_t key; // LLMETA_ZONEMAP
+    char tblname[LLMETA_TBLLEN];
+};
+
+static void zonemap_key_init(void *u, const char *table)
+{
+    struct zonemap_key *k = u;
+    k->key = htonl(LLMETA_ZONEMAP);
+    strncpy0(k->tblname, table, sizeof(k->tblname));
+}
+
+int bdb_set_zonemap(tran_type *tran, const char *table, const void *zm,
+                    int len, int *bdberr)
+{
+    union {
+        struct zonemap_key zkey;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+
+    zonemap_key_init(&u, table);
+    return kv_put(tran, &u, (void *)zm, len, bdberr);
+}
+
+/* returns 0 and the zone map in "*zm" (caller frees), 1 if there is none,
+ * -1 on error */
+int bdb_get_zonemap(tran_type *tran, const char *table, void **zm, int *len,
+                    int *bdberr)
+{
+    union {
+        struct zonemap_key zkey;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+
+    zonemap_key_init(&u, table);
+    *zm = NULL;
+    int rc = bdb_lite_exact_var_fetch_tran(llmeta_bdb_state, tran, &u, zm, len,
+                                           bdberr);
+    if (rc && *bdberr == BDBERR_FETCH_DTA)
+        return 1;
+    return rc ? -1 : 0;
+}
+
+int bdb_del_zonemap(tran_type *tran, const char *table, int *bdberr)
+{
+    union {
+        struct zonemap_key zkey;
+        uint8_t buf[LLMETA_IXLEN];
+    } u = {{0}};
+
+    zonemap_key_init(&u, table);
+    int rc = kv_del(tran, &u, bdberr);
+    if (rc && *bdberr == BDBERR_DEL_DTA)
+        rc = 0; /* there was none */
+    return rc;
+}
+
 /* rename transactionally all llmeta information about a table */
 int bdb_rename_table_metadata(bdb_state_type *bdb_state, tran_type *tran,
                               const char *newname, int version, int *bdberr)
@@ -10362,6 +10715,16 @@ int bdb_rename_table_metadata(bdb_state_type *bdb_state, tran_type *tran,
     if (rc)
         return rc;
 
+    /* rename trained zstd dictionaries */
+    rc = move_zstd_dicts(tran, bdb_state->name, newname, bdberr);
+    if (rc)
+        return rc;
+
+    /* the zone map is rebuilt under the new name */
+    rc = bdb_del_zonemap(tran, bdb_state->name, bdberr);
+    if (rc)
+        return rc;
+
     /* rename csc2 */
     rc = bdb_rename_csc2_version(tran, bdb_state->name, newname, version,
                                  bdberr);
@@ -10376,8 +10739,8 @@ int bdb_rename_table_metadata(bdb_state_type *bdb_state, tran_type *tran,
     return rc;
 }
 
-int bdb_get_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
-                         int *bdberr)
+static int get_start_lsn(tran_type *tran, int type, const char *table,
+                         void *plsn, int *bdberr)
 {
     int rc;
     char key[LLMETA_IXLEN] = {0};
@@ -10391,7 +10754,7 @@ int bdb_get_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
 
     *bdberr = BDBERR_NOERROR;
 
-    schema_change.file_type = LLMETA_SC_START_LSN;
+    schema_change.file_type = type;
     /*copy the table name and check its length so that we have a clean key*/
     strncpy0(schema_change.dbname, table, sizeof(schema_change.dbname));
     schema_change.dbname_len = strlen(schema_change.dbname) + 1;
@@ -10405,7 +10768,7 @@ int bdb_get_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
         return -1;
     }
 
-    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, &tmplsn,
+    rc = llmeta_exact_fetch_tran(tran, key, &tmplsn,
                                    sizeof(tmplsn), &fndlen, bdberr);
     if (rc == 0) {
         p_buf = (uint8_t *)&tmplsn;
@@ -10422,8 +10785,8 @@ int bdb_get_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
     return rc;
 }
 
-int bdb_set_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
-                         int *bdberr)
+static int set_start_lsn(tran_type *tran, int type, const char *table,
+                         void *plsn, int *bdberr)
 {
     int rc;
     int started_our_own_transaction = 0;
@@ -10448,7 +10811,7 @@ int bdb_set_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
         }
     }
 
-    schema_change.file_type = LLMETA_SC_START_LSN;
+    schema_change.file_type = type;
     /*copy the table name and check its length so that we have a clean key*/
     strncpy0(schema_change.dbname, table, sizeof(schema_change.dbname));
     schema_change.dbname_len = strlen(schema_change.dbname) + 1;
@@ -10476,7 +10839,7 @@ int bdb_set_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
         return -1;
     }
 
-    rc = bdb_get_sc_start_lsn(tran, table, &oldlsn, bdberr);
+    rc = get_start_lsn(tran, type, table, &oldlsn, bdberr);
     if (rc) { // not found, just add -- should refactor
         if (*bdberr == BDBERR_FETCH_DTA) {
             rc = bdb_lite_add(llmeta_bdb_state, tran, &tmplsn, sizeof(tmplsn),
@@ -10521,6 +10884,28 @@ done:
     return rc;
 }
 
+int bdb_get_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
+                         int *bdberr)
+{
+    return get_start_lsn(tran, LLMETA_SC_START_LSN, table, plsn, bdberr);
+}
+
+int bdb_set_sc_start_lsn(tran_type *tran, const char *table, void *plsn,
+                         int *bdberr)
+{
+    return set_start_lsn(tran, LLMETA_SC_START_LSN, table, plsn, bdberr);
+}
+
+int bdb_get_trigger_log_lsn(tran_type *tran, void *plsn, int *bdberr)
+{
+    return get_start_lsn(tran, LLMETA_TRIGGER_LOG_LSN, "", plsn, bdberr);
+}
+
+int bdb_set_trigger_log_lsn(tran_type *tran, void *plsn, int *bdberr)
+{
+    return set_start_lsn(tran, LLMETA_TRIGGER_LOG_LSN, "", plsn, bdberr);
+}
+
 int bdb_delete_sc_start_lsn(tran_type *tran, const char *table, int *bdberr)
 {
     int rc;
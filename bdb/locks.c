@@ -68,6 +68,8 @@
 #include "genid.h"
 #include "crc32c.h"
 #include <logmsg.h>
+#include "comdb2_atomic.h"
+#include "quantize.h"
 
 extern int __dbreg_get_name(DB_ENV *, u_int8_t *, char **);
 
@@ -589,6 +591,31 @@ static int bdb_lock_ix_value_fromlid(bdb_state_type *bdb_state, int lid,
     return rc;
 }
 
+/*
+ * Rowlocks this thread has most recently been granted, by genid.  A logical
+ * transaction that asks again for a row it already holds takes another
+ * reference on the granted lock through lock_reget, which locks only that
+ * lock's object partition.  Entries are never trusted on their own: a lock
+ * released since it was cached has a new generation and reget refuses it.
+ */
+#define ROWLOCK_FASTPATH_SLOTS 16
+struct rowlock_fastpath {
+    int lid;
+    int mode;
+    char name[ROWLOCK_KEY_SIZE];
+    DB_LOCK lk;
+};
+static __thread struct rowlock_fastpath rowlock_fastpath[ROWLOCK_FASTPATH_SLOTS];
+int gbl_rowlock_fastpath = 0;
+uint64_t gbl_rowlock_fastpath_hits = 0;
+
+static inline struct rowlock_fastpath *
+rowlock_fastpath_slot(unsigned long long genid)
+{
+    return &rowlock_fastpath[(genid ^ (genid >> 32)) %
+                             ROWLOCK_FASTPATH_SLOTS];
+}
+
 /* fileid (20) + fluff (2) + genid (8)  =  30 byte names */
 int bdb_lock_row_fromlid_int(bdb_state_type *bdb_state, int lid, int idx,
                              unsigned long long genid, int how, DB_LOCK *dblk,
@@ -631,10 +658,30 @@ int bdb_lock_row_fromlid_int(bdb_state_type *bdb_state, int lid, int idx,
     else
         tryflags = flags;
 
+    int fastpath = gbl_rowlock_fastpath && flags == 0 &&
+                   !gbl_disable_rowlocks && !gbl_random_rowlocks &&
+                   lkptr->size == ROWLOCK_KEY_SIZE;
+    struct rowlock_fastpath *fp = fastpath ? rowlock_fastpath_slot(genid) : NULL;
+
+    if (fp && fp->lid == lid && fp->mode == lockmode &&
+        memcmp(fp->name, nameptr, ROWLOCK_KEY_SIZE) == 0 &&
+        bdb_state->dbenv->lock_reget(bdb_state->dbenv, lid, &fp->lk, dblk) ==
+            0) {
+        ATOMIC_ADD64(gbl_rowlock_fastpath_hits, 1);
+        return 0;
+    }
+
     rc = berkdb_lock_rowlock(bdb_state, lid, tryflags, lkptr, lockmode, dblk);
     if (BDBERR_DEADLOCK == rc)
         rc = BDBERR_DEADLOCK_ROWLOCK;
 
+    if (rc == 0 && fp) {
+        fp->lid = lid;
+        fp->mode = lockmode;
+        memcpy(fp->name, nameptr, ROWLOCK_KEY_SIZE);
+        fp->lk = *dblk;
+    }
+
     return rc;
 }
 
@@ -873,3 +920,179 @@ void bdb_thread_assert_nolocks(bdb_state_type *bdb_state)
     }
     assert(nlocks == 0);
 }
+
+/*
+ * Lock wait profile.  Every lock_wait_profile'th lock wait is counted against
+ * its (lock object, requested mode), with a histogram of wait times.  The
+ * lock object itself names the file and the page, row or other object, so it
+ * is kept as is and only described when the profile is read.
+ */
+#define LOCKWAIT_OBJ_MAX 33
+#define LOCKWAIT_HIST_STEP_US 1000
+#define LOCKWAIT_HIST_MAX_US 64000
+
+typedef struct lockwait_key {
+    uint8_t obj[LOCKWAIT_OBJ_MAX];
+    uint8_t objlen;
+    int mode;
+} lockwait_key_t;
+
+typedef struct lockwait_ent {
+    lockwait_key_t key;
+    int64_t waits;
+    int64_t total_us;
+    int64_t max_us;
+    struct quantize *hist;
+} lockwait_ent_t;
+
+int gbl_lock_wait_profile = 1;
+int gbl_lock_wait_profile_max = 4096;
+uint64_t gbl_lock_wait_profile_dropped = 0;
+
+static pthread_mutex_t lockwaits_lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *lockwaits;
+
+static void bdb_lock_wait_record(const void *obj, size_t sz, int mode,
+                                 u_int64_t waitus)
+{
+    static __thread unsigned nwaits;
+    int sample = gbl_lock_wait_profile;
+    lockwait_key_t key;
+    lockwait_ent_t *ent;
+
+    if (sample <= 0 || (++nwaits % sample) != 0 || sz > LOCKWAIT_OBJ_MAX)
+        return;
+    if (waitus > INT_MAX)
+        waitus = INT_MAX;
+
+    memset(&key, 0, sizeof(key));
+    memcpy(key.obj, obj, sz);
+    key.objlen = sz;
+    key.mode = mode;
+
+    Pthread_mutex_lock(&lockwaits_lk);
+    if (lockwaits == NULL)
+        lockwaits =
+            hash_init_o(offsetof(lockwait_ent_t, key), sizeof(lockwait_key_t));
+    if ((ent = hash_find(lockwaits, &key)) == NULL) {
+        if (hash_get_num_entries(lockwaits) >= gbl_lock_wait_profile_max ||
+            (ent = calloc(1, sizeof(*ent))) == NULL) {
+            gbl_lock_wait_profile_dropped++;
+            Pthread_mutex_unlock(&lockwaits_lk);
+            return;
+        }
+        ent->key = key;
+        ent->hist =
+            quantize_new(LOCKWAIT_HIST_STEP_US, LOCKWAIT_HIST_MAX_US, "us");
+        if (ent->hist == NULL) {
+            free(ent);
+            gbl_lock_wait_profile_dropped++;
+            Pthread_mutex_unlock(&lockwaits_lk);
+            return;
+        }
+        hash_add(lockwaits, ent);
+    }
+    ent->waits++;
+    ent->total_us += waitus;
+    if (ent->max_us < waitus)
+        ent->max_us = waitus;
+    quantize(ent->hist, (int)waitus);
+    Pthread_mutex_unlock(&lockwaits_lk);
+}
+
+void bdb_lock_wait_profile_init(void)
+{
+    gbl_bb_log_lock_waits_fn = bdb_lock_wait_record;
+}
+
+static const char *lock_wait_type(int objlen, const uint8_t *obj)
+{
+    switch (objlen) {
+    case 28: {
+        int type;
+        memcpy(&type, obj + 24, sizeof(type));
+        return type == 1 ? "handle" : "page";
+    }
+    case 30:
+        return "rowlock";
+    case 31:
+        return "minmax";
+    case 24:
+        return "ixhash";
+    case 20:
+        return "stripe";
+    case 32:
+        return "table";
+    case 8:
+        return "lsn";
+    case 4:
+        return "rep";
+    default:
+        return "other";
+    }
+}
+
+struct lockwait_collect {
+    bdb_state_type *bdb_state;
+    collect_lock_waits_f func;
+    void *arg;
+    int rc;
+};
+
+static int collect_lock_wait(void *obj, void *arg)
+{
+    lockwait_ent_t *ent = obj;
+    struct lockwait_collect *c = arg;
+    char desc[128], hist[512];
+    DBT dbt = {0};
+
+    switch (ent->key.objlen) {
+    case 4: case 8: case 20: case 24: case 28: case 30: case 31: case 32:
+        dbt.data = ent->key.obj;
+        dbt.size = ent->key.objlen;
+        bdb_describe_lock_dbt(c->bdb_state->dbenv, &dbt, desc, sizeof(desc));
+        break;
+    default:
+        snprintf(desc, sizeof(desc), "lock object size %d", ent->key.objlen);
+        break;
+    }
+    quantize_tostr(ent->hist, hist, sizeof(hist));
+
+    c->rc = c->func(c->arg, lock_wait_type(ent->key.objlen, ent->key.obj),
+                    desc, lock_mode_to_str(ent->key.mode), ent->waits,
+                    ent->total_us, ent->max_us, hist);
+    return c->rc;
+}
+
+/* Call func for every profiled (lock object, mode), under the profile lock */
+int bdb_collect_lock_waits(bdb_state_type *bdb_state, collect_lock_waits_f func,
+                           void *arg)
+{
+    struct lockwait_collect c = {
+        .bdb_state = bdb_state, .func = func, .arg = arg, .rc = 0};
+
+    Pthread_mutex_lock(&lockwaits_lk);
+    if (lockwaits)
+        hash_for(lockwaits, collect_lock_wait, &c);
+    Pthread_mutex_unlock(&lockwaits_lk);
+    return c.rc;
+}
+
+static int free_lock_wait(void *obj, void *arg)
+{
+    lockwait_ent_t *ent = obj;
+    quantize_free(ent->hist);
+    free(ent);
+    return 0;
+}
+
+void bdb_clear_lock_waits(void)
+{
+    Pthread_mutex_lock(&lockwaits_lk);
+    if (lockwaits) {
+        hash_for(lockwaits, free_lock_wait, NULL);
+        hash_clear(lockwaits);
+    }
+    gbl_lock_wait_profile_dropped = 0;
+    Pthread_mutex_unlock(&lockwaits_lk);
+}
@@ -0,0 +1,200 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+  Compressed log archival
+
+  With backup_logfiles on, the master used to move each log file it
+  deleted into backup_logfiles_dir, one at a time, from the log deletion
+  path.  With backup_logfiles_compress, the file is instead renamed into
+  <txndir>/archive, which is instant, and a small pool gzips it into
+  backup_logfiles_dir as <log>.gz.  gzip keeps a crc32 and the length of
+  the log in its trailer, so "gzip -t" checks an archived file and
+  "gunzip" restores it for phys_rep or comdb2ar.  The output is written
+  to <log>.gz.tmp, synced and renamed, so a crash never leaves a partial
+  .gz behind; files still in <txndir>/archive are queued again the first
+  time a log is archived after a restart.  If a file can't be
+  compressed it is moved into backup_logfiles_dir as it is.
+*/
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "bdb_int.h"
+#include <thdpool.h>
+#include <locks_wrap.h>
+#include <logmsg.h>
+#include "util.h"
+
+int gbl_backup_logfiles_compress = 0;
+int gbl_backup_logfiles_threads = 2;
+
+static struct thdpool *logarchive_pool;
+static pthread_mutex_t logarchive_lk = PTHREAD_MUTEX_INITIALIZER;
+static int logarchive_requeued;
+
+int logarchive_init(void)
+{
+    logarchive_pool = thdpool_create("logarchivepool", 0);
+    thdpool_set_stack_size(logarchive_pool, (1 << 20));
+    thdpool_set_minthds(logarchive_pool, 0);
+    thdpool_set_maxthds(logarchive_pool, gbl_backup_logfiles_threads);
+    thdpool_set_maxqueue(logarchive_pool, 100000);
+    thdpool_set_linger(logarchive_pool, 10);
+    thdpool_set_longwaitms(logarchive_pool, 60000);
+    return 0;
+}
+
+static int gzip_file(const char *from, const char *to)
+{
+    char buf[64 * 1024];
+    char tmp[PATH_MAX];
+    gzFile out = NULL;
+    ssize_t n;
+    int fd, ofd = -1, rc = -1;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", to);
+    if ((fd = open(from, O_RDONLY)) < 0)
+        return -1;
+    if ((ofd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0 ||
+        (out = gzdopen(dup(ofd), "wb1")) == NULL)
+        goto done;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        if (gzwrite(out, buf, n) != n)
+            goto done;
+    }
+    if (n < 0)
+        goto done;
+    rc = gzclose(out) == Z_OK ? 0 : -1;
+    out = NULL;
+    if (rc == 0 && (fsync(ofd) != 0 || rename(tmp, to) != 0))
+        rc = -1;
+
+done:
+    if (out)
+        gzclose(out);
+    if (ofd >= 0)
+        close(ofd);
+    close(fd);
+    if (rc)
+        unlink(tmp);
+    return rc;
+}
+
+static void logarchive_work(struct thdpool *pool, void *work, void *thddata,
+                            int op)
+{
+    char *staged = work;
+    char *base, *gz, *raw, cmd[PATH_MAX * 2 + 8];
+
+    if (op == THD_RUN) {
+        base = strrchr(staged, '/') + 1;
+        gz = comdb2_location("backup_logfiles_dir", "%s.gz", base);
+        if (gzip_file(staged, gz) == 0) {
+            unlink(staged);
+            logmsg(LOGMSG_DEBUG, "archived log %s to %s\n", base, gz);
+        } else {
+            logmsg(LOGMSG_ERROR,
+                   "%s: can't compress %s to %s: %d %s, moving it as is\n",
+                   __func__, staged, gz, errno, strerror(errno));
+            raw = comdb2_location("backup_logfiles_dir", "%s", base);
+            snprintf(cmd, sizeof(cmd), "mv %s %s", staged, raw);
+            if (system(cmd))
+                logmsg(LOGMSG_ERROR, "%s: Error system(\"%s\")\n", __func__,
+                       cmd);
+            free(raw);
+        }
+        free(gz);
+    }
+    free(staged);
+}
+
+static int logarchive_enqueue(const char *staged)
+{
+    char *work = strdup(staged);
+
+    if (work == NULL)
+        return ENOMEM;
+    if (thdpool_enqueue(logarchive_pool, logarchive_work, work, 0, NULL, 0)) {
+        free(work);
+        return -1;
+    }
+    return 0;
+}
+
+/* Queue what a previous run staged but didn't get to */
+static void logarchive_requeue(const char *dir)
+{
+    char path[PATH_MAX];
+    struct dirent *d;
+    DIR *dh;
+
+    if ((dh = opendir(dir)) == NULL)
+        return;
+    while ((d = readdir(dh)) != NULL) {
+        if (strncmp(d->d_name, "log.", 4) != 0)
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, d->d_name);
+        if (logarchive_enqueue(path) == 0)
+            logmsg(LOGMSG_INFO, "%s: archiving %s left from before\n",
+                   __func__, path);
+    }
+    closedir(dh);
+}
+
+int bdb_logarchive_file(bdb_state_type *bdb_state, const char *logname)
+{
+    char dir[PATH_MAX], staged[PATH_MAX];
+    const char *base = strrchr(logname, '/');
+
+    if (logarchive_pool == NULL)
+        return -1;
+    base = base ? base + 1 : logname;
+    snprintf(dir, sizeof(dir), "%s/archive", bdb_state->txndir);
+    snprintf(staged, sizeof(staged), "%s/%s", dir, base);
+
+    Pthread_mutex_lock(&logarchive_lk);
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+        Pthread_mutex_unlock(&logarchive_lk);
+        logmsg(LOGMSG_ERROR, "%s: can't create %s: %d %s\n", __func__, dir,
+               errno, strerror(errno));
+        return -1;
+    }
+    if (!logarchive_requeued) {
+        logarchive_requeued = 1;
+        logarchive_requeue(dir);
+    }
+    Pthread_mutex_unlock(&logarchive_lk);
+
+    /* same file system as the log, so this can't leave a partial copy */
+    if (rename(logname, staged) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: rename %s to %s: %d %s\n", __func__, logname,
+               staged, errno, strerror(errno));
+        return -1;
+    }
+    /* it is out of the log directory either way; a full queue leaves it
+       for the next restart */
+    if (logarchive_enqueue(staged) != 0)
+        logmsg(LOGMSG_ERROR, "%s: can't queue %s\n", __func__, staged);
+    return 0;
+}
@@ -20,6 +20,9 @@
  * In the future we may add fields to the ODH.  When that happens this module
  * gets more complicated as we will have to maintain binary compatibiiuty with
  * previous revisions.  For now though the ODH is 7 bytes which keeps it simple.
+ * The one exception is ODH_FLAG_DICTID: a zstd record compressed with a
+ * trained dictionary (see odh_dict.c) has the 4 byte dictionary id between
+ * the header and the compressed data.
  *
  * The initial design of this made it easy to plug in to the existing bdb
  * code.  As this gets more established we can make a few optimisations to avoid
@@ -46,6 +49,9 @@
 #include <comdb2rle.h>
 
 #include <lz4.h>
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
 #include <logmsg.h>
 
 #if LZ4_VERSION_NUMBER < 10701
@@ -64,7 +70,7 @@ static void write_odh(void *buf, const struct odh *odh, uint8_t flags);
  *    flags             . idx 0, byte 1
  *                      .
  *                      .
- *                      .
+ *                      . 3    dictid follows (zstd only)
  *                      . 2 -+
  *                      . 1  |- Compress
  *                      . 0 _+
@@ -151,6 +157,8 @@ const char *bdb_algo2compr(int alg)
         return "crle";
     case BDB_COMPRESS_LZ4:
         return "lz4";
+    case BDB_COMPRESS_ZSTD:
+        return "zstd";
     default:
         return "????";
     }
@@ -166,6 +174,10 @@ int bdb_compr2algo(const char *a)
         return BDB_COMPRESS_CRLE;
     if (strncasecmp(a, "lz4", 3) == 0)
         return BDB_COMPRESS_LZ4;
+#ifdef WITH_ZSTD
+    if (strcasecmp(a, "zstd") == 0)
+        return BDB_COMPRESS_ZSTD;
+#endif
     if (strncasecmp(a, "none", 4) == 0)
         return BDB_COMPRESS_NONE;
     return BDB_COMPRESS_NONE;
@@ -265,6 +277,7 @@ void init_odh(bdb_state_type *bdb_state, struct odh *odh, void *rec,
     else
         odh->csc2vers = 0;
     odh->flags = 0;
+    odh->is_blob = is_blob;
     odh->recptr = rec;
     if (is_blob) {
         odh->flags |= (bdb_state->compress_blobs & ODH_FLAG_COMPR_MASK);
@@ -422,13 +435,46 @@ int bdb_pack(bdb_state_type *bdb_state, const struct odh *odh, void *to,
                 *recsize = rc + ODH_SIZE;
             }
             break;
+
+#ifdef WITH_ZSTD
+        case BDB_COMPRESS_ZSTD: {
+            /* like lz4, only keep it if it's smaller than the input */
+            size_t zrc = 0;
+            if (!odh->is_blob)
+                zrc = odh_dict_compress(bdb_state, (char *)to + ODH_SIZE,
+                                        odh->length - 1, odh->recptr,
+                                        odh->length);
+            if (zrc) {
+                flags |= ODH_FLAG_DICTID;
+                *recsize = zrc + ODH_SIZE;
+                break;
+            }
+            zrc = ZSTD_compress((char *)to + ODH_SIZE, odh->length - 1,
+                                odh->recptr, odh->length,
+                                bdb_state->attr->zstd_level);
+            if (ZSTD_isError(zrc)) {
+                alg = BDB_COMPRESS_NONE;
+                if (bdb_state->attr->ztrace) {
+                    logmsg(LOGMSG_USER, "no zstd compression gain for %u bytes\n",
+                           (unsigned)odh->length);
+                }
+            } else {
+                *recsize = zrc + ODH_SIZE;
+            }
+            break;
+        }
+#endif
+
+        default:
+            alg = BDB_COMPRESS_NONE;
+            break;
         }
 
         if (alg == BDB_COMPRESS_NONE) {
             /* No compression, or compression was no good. */
             memcpy(((char *)to) + ODH_SIZE, odh->recptr, odh->length);
             *recsize = odh->length + ODH_SIZE;
-            flags &= ~ODH_FLAG_COMPR_MASK;
+            flags &= ~(ODH_FLAG_COMPR_MASK | ODH_FLAG_DICTID);
         }
         write_odh(to, odh, flags);
         *recptr = to;
@@ -603,6 +649,41 @@ static int bdb_unpack_updateid(bdb_state_type *bdb_state, const void *from, size
                 if (rc != odh->length) {
                     goto err;
                 }
+            } else if (alg == BDB_COMPRESS_ZSTD) {
+#ifdef WITH_ZSTD
+                size_t zrc;
+                if (odh->flags & ODH_FLAG_DICTID) {
+                    rc = odh_dict_decompress(bdb_state, to, odh->length,
+                                             (char *)from + ODH_SIZE,
+                                             fromlen - ODH_SIZE);
+                    if (rc != odh->length) {
+                        logmsg(LOGMSG_ERROR,
+                               "%s:ERROR odh_dict_decompress rc %d expected "
+                               "%u\n",
+                               __func__, rc, odh->length);
+                        goto err;
+                    }
+                    zrc = rc;
+                } else {
+                    zrc = ZSTD_decompress(to, odh->length,
+                                          (char *)from + ODH_SIZE,
+                                          fromlen - ODH_SIZE);
+                }
+                if (ZSTD_isError(zrc) || zrc != odh->length) {
+                    logmsg(LOGMSG_ERROR,
+                           "%s:ERROR ZSTD_decompress %s expected %u\n",
+                           __func__,
+                           ZSTD_isError(zrc) ? ZSTD_getErrorName(zrc) : "short",
+                           odh->length);
+                    goto err;
+                }
+#else
+                logmsg(LOGMSG_ERROR,
+                       "%s:ERROR zstd compressed record, but built without "
+                       "zstd\n",
+                       __func__);
+                goto err;
+#endif
             }
 
             /* Successfully decompressed */
@@ -1362,6 +1443,15 @@ inline void bdb_set_inplace_updates(bdb_state_type *bdb_state, int ipu)
     }
 }
 
+inline void bdb_set_zonemaps(bdb_state_type *bdb_state, int zonemaps)
+{
+    if (bdb_state == NULL) {
+        logmsg(LOGMSG_ERROR, "%s(NULL)!!\n", __func__);
+        return;
+    }
+    bdb_state->zonemaps = zonemaps;
+}
+
 inline void bdb_set_datacopy_odh(bdb_state_type *bdb_state, int cdc)
 {
     if (bdb_state == NULL) {
@@ -1380,6 +1470,9 @@ int bdb_validate_compression_alg(int alg)
     case BDB_COMPRESS_ZLIB:
     case BDB_COMPRESS_RLE8:
     case BDB_COMPRESS_CRLE:
+#ifdef WITH_ZSTD
+    case BDB_COMPRESS_ZSTD:
+#endif
         return alg;
     }
     return -1;
@@ -0,0 +1,481 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+  Trained zstd dictionaries for data records
+
+  Rows are small and look alike, so zstd on its own finds little to work
+  with inside a single record.  With zstd_dict on, the master samples the
+  data records of each zstd table, trains a dictionary from them
+  (ZDICT_trainFromBuffer) and saves it in llmeta under the table name and
+  a new dictionary id.  From then on records are compressed against it and
+  carry ODH_FLAG_DICTID with the 4 byte id right after the header.
+
+  Every zstd_dict_retrain_sec the master samples again and adds a new
+  dictionary; older ones stay in llmeta for as long as the table exists,
+  since records written with them still name them.  Replicas, and a new
+  master, load dictionaries from llmeta the first time they see an id
+  they don't have.  The llmeta write commits before the dictionary is
+  used, so a replica has it before any record that refers to it.
+
+  Blobs are not sampled or compressed with dictionaries.
+*/
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "bdb_int.h"
+#include "locks.h"
+#include "locks_wrap.h"
+#include "thread_util.h"
+#include "logmsg.h"
+
+int gbl_zstd_dict = 0;
+int gbl_zstd_dict_kb = 16;
+int gbl_zstd_dict_samples = 2000;
+int gbl_zstd_dict_retrain_sec = 86400;
+
+#ifdef WITH_ZSTD
+
+#include <zstd.h>
+#include <zdict.h>
+
+extern pthread_attr_t gbl_pthread_attr_detached;
+
+struct odh_zdict {
+    uint32_t id;
+    ZSTD_CDict *cdict;
+    ZSTD_DDict *ddict;
+};
+
+struct odh_zdicts {
+    char *table;
+    bdb_state_type *env;
+    int level;
+    int refs;     /* the table handle, plus a training thread */
+    int dropped;  /* table handle is gone */
+
+    pthread_rwlock_t lk;
+    int loaded;
+    int ndicts;
+    struct odh_zdict *dicts;
+    int cur; /* index of the dictionary we compress with, -1 for none */
+
+    pthread_mutex_t samplk;
+    int training;
+    time_t trained_at;
+    uint8_t *samples;
+    size_t *samplesz;
+    unsigned nsamples;
+    size_t samplebytes;
+};
+
+struct train_arg {
+    struct odh_zdicts *z;
+    uint8_t *samples;
+    size_t *samplesz;
+    unsigned nsamples;
+};
+
+static pthread_mutex_t create_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t ctx_once = PTHREAD_ONCE_INIT;
+static pthread_key_t cctx_key;
+static pthread_key_t dctx_key;
+
+static void free_cctx(void *p)
+{
+    ZSTD_freeCCtx(p);
+}
+
+static void free_dctx(void *p)
+{
+    ZSTD_freeDCtx(p);
+}
+
+static void ctx_init(void)
+{
+    Pthread_key_create(&cctx_key, free_cctx);
+    Pthread_key_create(&dctx_key, free_dctx);
+}
+
+static ZSTD_CCtx *get_cctx(void)
+{
+    Pthread_once(&ctx_once, ctx_init);
+    ZSTD_CCtx *c = pthread_getspecific(cctx_key);
+    if (c == NULL && (c = ZSTD_createCCtx()) != NULL)
+        Pthread_setspecific(cctx_key, c);
+    return c;
+}
+
+static ZSTD_DCtx *get_dctx(void)
+{
+    Pthread_once(&ctx_once, ctx_init);
+    ZSTD_DCtx *d = pthread_getspecific(dctx_key);
+    if (d == NULL && (d = ZSTD_createDCtx()) != NULL)
+        Pthread_setspecific(dctx_key, d);
+    return d;
+}
+
+static void zdicts_put(struct odh_zdicts *z)
+{
+    Pthread_mutex_lock(&create_lk);
+    int refs = --z->refs;
+    Pthread_mutex_unlock(&create_lk);
+    if (refs)
+        return;
+    for (int i = 0; i < z->ndicts; ++i) {
+        ZSTD_freeCDict(z->dicts[i].cdict);
+        ZSTD_freeDDict(z->dicts[i].ddict);
+    }
+    free(z->dicts);
+    free(z->samples);
+    free(z->samplesz);
+    free(z->table);
+    Pthread_rwlock_destroy(&z->lk);
+    Pthread_mutex_destroy(&z->samplk);
+    free(z);
+}
+
+/* Dictionaries are stored under the table's final name, like its files: a
+ * schema change writes through a "new." handle for the same table.  A
+ * handle that was renamed since starts over. */
+static struct odh_zdicts *get_zdicts(bdb_state_type *bdb_state)
+{
+    struct odh_zdicts *z = bdb_state->zdicts, *old = NULL;
+    int bdberr;
+    const char *name =
+        bdb_state->origname
+            ? bdb_state->origname
+            : bdb_unprepend_new_prefix(bdb_state->name, &bdberr);
+
+    if (z && strcmp(z->table, name) == 0)
+        return z;
+    Pthread_mutex_lock(&create_lk);
+    if ((z = bdb_state->zdicts) != NULL && strcmp(z->table, name) != 0) {
+        old = z;
+        z = NULL;
+    }
+    if (z == NULL) {
+        z = calloc(1, sizeof(*z));
+        z->table = strdup(name);
+        z->env = bdb_state->parent ? bdb_state->parent : bdb_state;
+        z->level = bdb_state->attr->zstd_level;
+        z->refs = 1;
+        z->cur = -1;
+        Pthread_rwlock_init(&z->lk, NULL);
+        Pthread_mutex_init(&z->samplk, NULL);
+        bdb_state->zdicts = z;
+    }
+    Pthread_mutex_unlock(&create_lk);
+    if (old) {
+        old->dropped = 1;
+        zdicts_put(old);
+    }
+    return z;
+}
+
+static int find_dict(struct odh_zdicts *z, uint32_t id)
+{
+    for (int i = 0; i < z->ndicts; ++i)
+        if (z->dicts[i].id == id)
+            return i;
+    return -1;
+}
+
+static int add_dict(struct odh_zdicts *z, uint32_t id, const void *dict,
+                    size_t len)
+{
+    struct odh_zdict d = {.id = id};
+    d.cdict = ZSTD_createCDict(dict, len, z->level);
+    d.ddict = ZSTD_createDDict(dict, len);
+    if (d.cdict == NULL || d.ddict == NULL) {
+        ZSTD_freeCDict(d.cdict);
+        ZSTD_freeDDict(d.ddict);
+        return -1;
+    }
+    z->dicts = realloc(z->dicts, sizeof(d) * (z->ndicts + 1));
+    z->dicts[z->ndicts] = d;
+    if (z->cur < 0 || id > z->dicts[z->cur].id)
+        z->cur = z->ndicts;
+    return z->ndicts++;
+}
+
+/* Pick up any dictionaries in llmeta that we don't have yet.  Caller holds
+ * z->lk for write. */
+static void load_dicts(struct odh_zdicts *z)
+{
+    uint32_t *ids;
+    void **dicts;
+    int *lens;
+    int num = 0, bdberr = 0;
+
+    int rc = bdb_get_zstd_dicts(NULL, z->table, &ids, &dicts, &lens, &num,
+                                &bdberr);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: %s: can't read zstd dictionaries rc %d "
+                             "bdberr %d\n",
+               __func__, z->table, rc, bdberr);
+    }
+    for (int i = 0; i < num; ++i) {
+        if (find_dict(z, ids[i]) < 0 &&
+            add_dict(z, ids[i], dicts[i], lens[i]) < 0)
+            logmsg(LOGMSG_ERROR, "%s: %s: bad zstd dictionary %u\n", __func__,
+                   z->table, ids[i]);
+        free(dicts[i]);
+    }
+    free(ids);
+    free(dicts);
+    free(lens);
+
+    if (!z->loaded) {
+        z->loaded = 1;
+        /* we don't know how old a stored dictionary is; give it a full
+         * retrain interval from when we first saw it */
+        if (z->ndicts)
+            z->trained_at = time(NULL);
+    }
+}
+
+static void *train_thd(void *arg)
+{
+    struct train_arg *t = arg;
+    struct odh_zdicts *z = t->z;
+    bdb_state_type *bdb_state = z->env;
+    size_t cap = (size_t)gbl_zstd_dict_kb << 10;
+    void *dict = malloc(cap);
+    size_t len;
+    uint32_t id = 0;
+    int rc = -1, bdberr = 0;
+
+    comdb2_name_thread(__func__);
+    thread_started("zstd dict train");
+    bdb_thread_event(bdb_state, BDBTHR_EVENT_START_RDWR);
+
+    len = ZDICT_trainFromBuffer(dict, cap, t->samples, t->samplesz,
+                                t->nsamples);
+    if (ZDICT_isError(len)) {
+        logmsg(LOGMSG_WARN, "%s: %s: training on %u records failed: %s\n",
+               __func__, z->table, t->nsamples, ZDICT_getErrorName(len));
+        goto done;
+    }
+
+    BDB_READLOCK("zstd_dict_train");
+    if (bdb_amimaster(bdb_state) && !z->dropped) {
+        /* a previous master may have added dictionaries we haven't seen */
+        Pthread_rwlock_wrlock(&z->lk);
+        load_dicts(z);
+        for (int i = 0; i < z->ndicts; ++i)
+            if (z->dicts[i].id >= id)
+                id = z->dicts[i].id + 1;
+        Pthread_rwlock_unlock(&z->lk);
+
+        rc = bdb_add_zstd_dict(NULL, z->table, id, dict, len, &bdberr);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s: %s: can't save zstd dictionary %u rc %d "
+                                 "bdberr %d\n",
+                   __func__, z->table, id, rc, bdberr);
+        }
+    }
+    BDB_RELLOCK();
+
+    if (rc == 0) {
+        Pthread_rwlock_wrlock(&z->lk);
+        rc = add_dict(z, id, dict, len);
+        Pthread_rwlock_unlock(&z->lk);
+        if (rc >= 0) {
+            logmsg(LOGMSG_INFO, "%s: %s: zstd dictionary %u, %zu bytes from %u "
+                                "records\n",
+                   __func__, z->table, id, len, t->nsamples);
+        }
+    }
+
+done:
+    Pthread_mutex_lock(&z->samplk);
+    z->trained_at = time(NULL);
+    z->training = 0;
+    Pthread_mutex_unlock(&z->samplk);
+
+    bdb_thread_event(bdb_state, BDBTHR_EVENT_DONE_RDWR);
+    zdicts_put(z);
+    free(dict);
+    free(t->samples);
+    free(t->samplesz);
+    free(t);
+    return NULL;
+}
+
+/* Keep a copy of rec for the next training run, and start one when we have
+ * enough.  ZDICT wants about 100 times the dictionary size to work with. */
+static void sample(struct odh_zdicts *z, const void *rec, size_t len)
+{
+    size_t maxbytes = ((size_t)gbl_zstd_dict_kb << 10) * 100;
+    unsigned want = gbl_zstd_dict_samples;
+    struct train_arg *t;
+    pthread_t tid;
+
+    if (z->training || want == 0)
+        return;
+    /* trained_at is 0 until we have a dictionary or have tried to train one */
+    if (z->trained_at &&
+        (gbl_zstd_dict_retrain_sec <= 0 ||
+         time(NULL) - z->trained_at < gbl_zstd_dict_retrain_sec))
+        return;
+
+    Pthread_mutex_lock(&z->samplk);
+    if (z->training) {
+        Pthread_mutex_unlock(&z->samplk);
+        return;
+    }
+    if (z->samples == NULL) {
+        z->samples = malloc(maxbytes);
+        z->samplesz = malloc(sizeof(size_t) * want);
+        z->nsamples = 0;
+        z->samplebytes = 0;
+    }
+    if (z->samplebytes + len <= maxbytes) {
+        memcpy(z->samples + z->samplebytes, rec, len);
+        z->samplesz[z->nsamples++] = len;
+        z->samplebytes += len;
+    }
+    if (z->nsamples < want && z->samplebytes + len <= maxbytes) {
+        Pthread_mutex_unlock(&z->samplk);
+        return;
+    }
+
+    t = malloc(sizeof(*t));
+    t->z = z;
+    t->samples = z->samples;
+    t->samplesz = z->samplesz;
+    t->nsamples = z->nsamples;
+    z->samples = NULL;
+    z->samplesz = NULL;
+    z->training = 1;
+    Pthread_mutex_unlock(&z->samplk);
+
+    Pthread_mutex_lock(&create_lk);
+    z->refs++;
+    Pthread_mutex_unlock(&create_lk);
+    Pthread_create(&tid, &gbl_pthread_attr_detached, train_thd, t);
+}
+
+/* Compress a data record with the table's current dictionary.  Writes the
+ * big-endian dictionary id then the frame to "to".  Returns the bytes
+ * written, or 0 if there is no dictionary or it didn't fit in tolen. */
+size_t odh_dict_compress(bdb_state_type *bdb_state, void *to, size_t tolen,
+                         const void *from, size_t fromlen)
+{
+    struct odh_zdicts *z;
+    uint32_t id;
+    size_t zrc;
+
+    if (!gbl_zstd_dict || tolen <= sizeof(id))
+        return 0;
+
+    z = get_zdicts(bdb_state);
+    if (!z->loaded) {
+        Pthread_rwlock_wrlock(&z->lk);
+        if (!z->loaded)
+            load_dicts(z);
+        Pthread_rwlock_unlock(&z->lk);
+    }
+    if (bdb_amimaster(z->env))
+        sample(z, from, fromlen);
+
+    Pthread_rwlock_rdlock(&z->lk);
+    if (z->cur < 0) {
+        Pthread_rwlock_unlock(&z->lk);
+        return 0;
+    }
+    id = z->dicts[z->cur].id;
+    ZSTD_CCtx *cctx = get_cctx();
+    zrc = cctx ? ZSTD_compress_usingCDict(cctx, (uint8_t *)to + sizeof(id),
+                                          tolen - sizeof(id), from, fromlen,
+                                          z->dicts[z->cur].cdict)
+               : 0;
+    Pthread_rwlock_unlock(&z->lk);
+
+    if (cctx == NULL || ZSTD_isError(zrc))
+        return 0;
+    id = htonl(id);
+    memcpy(to, &id, sizeof(id));
+    return zrc + sizeof(id);
+}
+
+/* Undo odh_dict_compress.  Returns the decompressed size, or -1. */
+int odh_dict_decompress(bdb_state_type *bdb_state, void *to, size_t tolen,
+                        const void *from, size_t fromlen)
+{
+    struct odh_zdicts *z = get_zdicts(bdb_state);
+    uint32_t id;
+    size_t zrc;
+    int ix;
+
+    if (fromlen < sizeof(id))
+        return -1;
+    memcpy(&id, from, sizeof(id));
+    id = ntohl(id);
+
+    Pthread_rwlock_rdlock(&z->lk);
+    while ((ix = find_dict(z, id)) < 0) {
+        Pthread_rwlock_unlock(&z->lk);
+        Pthread_rwlock_wrlock(&z->lk);
+        if ((ix = find_dict(z, id)) < 0)
+            load_dicts(z);
+        if (ix < 0 && (ix = find_dict(z, id)) < 0) {
+            Pthread_rwlock_unlock(&z->lk);
+            logmsg(LOGMSG_ERROR, "%s: %s: no zstd dictionary %u\n", __func__,
+                   z->table, id);
+            return -1;
+        }
+        Pthread_rwlock_unlock(&z->lk);
+        Pthread_rwlock_rdlock(&z->lk);
+    }
+    ZSTD_DCtx *dctx = get_dctx();
+    zrc = dctx ? ZSTD_decompress_usingDDict(dctx, to, tolen,
+                                            (const uint8_t *)from + sizeof(id),
+                                            fromlen - sizeof(id),
+                                            z->dicts[ix].ddict)
+               : 0;
+    Pthread_rwlock_unlock(&z->lk);
+
+    if (dctx == NULL || ZSTD_isError(zrc))
+        return -1;
+    return zrc;
+}
+
+/* Table handle is going away.  A training thread may still hold a
+ * reference; it won't save what it trains. */
+void odh_dict_free(bdb_state_type *bdb_state)
+{
+    struct odh_zdicts *z = bdb_state->zdicts;
+    if (z == NULL)
+        return;
+    bdb_state->zdicts = NULL;
+    z->dropped = 1;
+    zdicts_put(z);
+}
+
+#else
+
+void odh_dict_free(bdb_state_type *bdb_state)
+{
+}
+
+#endif
@@ -1387,6 +1387,17 @@ int phys_rowlocks_log_bench_lk(bdb_state_type *bdb_state,
         /* Basecase for rowlocks - don't grab any locks */
         break;
 
+    case 4:
+        /* Grab the same rowlock in every physical txn of the logical txn */
+        ullarg1 = arg1;
+        genid1 = (unsigned long long)(ullarg1 << 32);
+        rc = bdb_lock_row_write_getlock(llmeta_bdb_state, logical_tran, -1,
+                                        genid1, &rowlk1, &lk1, 0);
+        if (rc)
+            goto done;
+        gotrowlock1 = 1;
+        break;
+
     case 3:
         /* Grab 2 rowlocks */
         ullarg1 = arg1;
@@ -577,13 +577,15 @@ unsigned long long bdb_queue_item_genid(const struct bdb_queue_found *dta)
 
 /* add an item to the end of the queue. */
 int bdb_queue_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
-                  size_t dtalen, int *bdberr, unsigned long long *out_genid)
+                  size_t dtalen, int partition, int *bdberr,
+                  unsigned long long *out_genid)
 {
     int rc = 0;
 
     BDB_READLOCK("bdb_queue_add");
     if (bdb_state->bdbtype == BDBTYPE_QUEUEDB) {
-        rc = bdb_queuedb_add(bdb_state, tran, dta, dtalen, bdberr, out_genid);
+        rc = bdb_queuedb_add(bdb_state, tran, dta, dtalen, partition, bdberr,
+                             out_genid);
     } else {
         bdb_lock_table_read(bdb_state, tran);
         rc = bdb_queue_add_int(bdb_state, tran, dta, dtalen, bdberr, out_genid);
@@ -30,6 +30,7 @@
 
 extern int gbl_queuedb_file_threshold;
 extern int gbl_queuedb_file_interval;
+extern int gbl_queuedb_file_threshold_live;
 
 /* Another implementation of queues.  Don't really "trust" berkeley queues.
  * We've had some issues with
@@ -92,6 +93,59 @@ static uint8_t *queuedb_key_put(struct queuedb_key *p_queuedb_key,
     return p_buf;
 }
 
+static int queuedb_genid_partition(unsigned long long genid)
+{
+    int partition = get_dtafile_from_genid(genid);
+    return partition < 0 ? 0 : partition;
+}
+
+/* Position dbcp on the first, or the last, item of a partition.  Returns
+ * DB_NOTFOUND if the partition is empty.  Partitions have their own key
+ * ranges, so looking up the last item of one locks its own tail page rather
+ * than the tail of the whole queue. */
+static int queuedb_cget_partition(bdb_state_type *bdb_state, DBC *dbcp,
+                                  int partition, int last, DBT *dbt_data,
+                                  uint8_t *ver, u_int32_t flags)
+{
+    struct queuedb_key k = {0};
+    uint8_t key[QUEUEDB_KEY_LEN];
+    DBT dbt_key = {0};
+    int rc;
+
+    k.consumer = QUEUE_PARTITION_CONSUMER(0, partition + (last ? 1 : 0));
+    queuedb_key_put(&k, key, key + sizeof(key));
+    dbt_key.data = key;
+    dbt_key.size = dbt_key.ulen = QUEUEDB_KEY_LEN;
+    dbt_key.flags = DB_DBT_USERMEM;
+
+    rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, dbt_data, ver,
+                         DB_SET_RANGE | flags);
+    if (last) {
+        /* step back from the start of the next partition */
+        if (rc == 0 && (dbt_data->flags & DB_DBT_MALLOC)) {
+            free(dbt_data->data);
+            dbt_data->data = NULL;
+        }
+        if (rc == 0)
+            rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, dbt_data, ver,
+                                 DB_PREV | flags);
+        else if (rc == DB_NOTFOUND)
+            rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, dbt_data, ver,
+                                 DB_LAST | flags);
+    }
+    if (rc)
+        return rc;
+    if (queuedb_key_get(&k, key, key + sizeof(key)) == NULL ||
+        (k.consumer >> QUEUE_PARTITION_SHIFT) != partition) {
+        if (dbt_data->flags & DB_DBT_MALLOC) {
+            free(dbt_data->data);
+            dbt_data->data = NULL;
+        }
+        return DB_NOTFOUND;
+    }
+    return 0;
+}
+
 static int bdb_queuedb_is_db_empty(DB *db, tran_type *tran)
 {
     int rc;
@@ -123,18 +177,60 @@ done:
     return rc;
 }
 
+/* Pages freed by consumers, and by the page sweeper merging what they left
+ * half empty, are reused by later enqueues.  With queuedb_file_threshold_live
+ * only the leaf pages in use as of the last sweep count toward the
+ * threshold, so churn alone never rolls a queue over to a new file. */
 static int bdb_queuedb_is_db_full(DB *db)
 {
     if (gbl_queuedb_file_threshold <= 0) return 0; /* never full? */
     char new[PATH_MAX];
     struct stat sb;
+    int64_t leaf_pages;
+    double leaf_fill;
     if (stat(bdb_trans(db->fname, new), &sb) != 0) {
         logmsg(LOGMSG_ERROR, "%s: stat rc %d\n", __func__, errno);
         return 0; /* cannot detect, assume no? */
     }
+    if (gbl_queuedb_file_threshold_live &&
+        bdb_pgsweep_file_pages(db->fname, &leaf_pages, &leaf_fill) == 0) {
+        return ((leaf_pages * db->pgsize / 1048576) >=
+                gbl_queuedb_file_threshold);
+    }
     return ((sb.st_size / 1048576) >= gbl_queuedb_file_threshold);
 }
 
+int bdb_queuedb_file_stats(bdb_state_type *bdb_state, int64_t *file_size,
+                           double *unused)
+{
+    char new[PATH_MAX];
+    struct stat sb;
+    int64_t pages = 0, leaf_pages, total_leaf = 0;
+    double leaf_fill;
+    int swept = 1;
+
+    *file_size = 0;
+    *unused = -1;
+    for (int i = 0; i < 2; i++) {
+        DB *db = bdb_state->dbp_data[i][0];
+        if (db == NULL)
+            continue;
+        if (stat(bdb_trans(db->fname, new), &sb) != 0)
+            return -1;
+        *file_size += sb.st_size;
+        pages += sb.st_size / db->pgsize;
+        if (bdb_pgsweep_file_pages(db->fname, &leaf_pages, &leaf_fill) == 0)
+            total_leaf += leaf_pages;
+        else
+            swept = 0;
+    }
+    if (swept && pages > total_leaf)
+        *unused = (double)(pages - total_leaf) / pages;
+    else if (swept && pages)
+        *unused = 0;
+    return 0;
+}
+
 static int start_qdb_schemachange(struct schema_change_type *sc)
 {
     javasp_do_procedure_wrlock();
@@ -320,7 +416,8 @@ int bdb_queuedb_best_pagesize(int avg_item_sz)
 
 /* add to queue */
 int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
-                    size_t dtalen, int *bdberr, unsigned long long *out_genid)
+                    size_t dtalen, int partition, int *bdberr,
+                    unsigned long long *out_genid)
 {
     struct bdb_queue_priv *qstate = (struct bdb_queue_priv *)bdb_state->qpriv;
 
@@ -354,6 +451,7 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
     void *databuf = NULL;
     void *freeme1 = NULL;
     void *freeme2 = NULL;
+    int part = partition < 0 ? 0 : partition;
 
     if (gbl_debug_queuedb)
         logmsg(LOGMSG_USER, ">>> bdb_queuedb_add %s\n", bdb_state->name);
@@ -383,9 +481,13 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
     dbt_data.data = NULL;
     dbt_data.flags = DB_DBT_MALLOC;
 
-    /* Lock last page */
-    rc = bdb_cget_unpack(bdb_state, dbcp1, &dbt_key, &dbt_data, &ver,
-                         DB_LAST | DB_RMW);
+    /* Lock last page (of our partition) */
+    if (partition < 0)
+        rc = bdb_cget_unpack(bdb_state, dbcp1, &dbt_key, &dbt_data, &ver,
+                             DB_LAST | DB_RMW);
+    else
+        rc = queuedb_cget_partition(bdb_state, dbcp1, partition, 1, &dbt_data,
+                                    &ver, DB_RMW);
 
     if (rc == 0) {
         freeme1 = dbt_data.data;
@@ -402,8 +504,9 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
     }
 
     /* DB_RMW holds a writelock on rightmost btree page */
+    /* the genid carries the partition, so consume can find the item */
     if (bdb_state->ondisk_header) {
-        genid = qfnd_odh.genid = get_genid(bdb_state, 0);
+        genid = qfnd_odh.genid = get_genid(bdb_state, part);
         qfnd_odh.data_len = dtalen;
         qfnd_odh.data_offset = sizeof(struct bdb_queue_found_seq);
         qfnd_odh.trans.tid = tran->tid->txnid;
@@ -444,8 +547,12 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
             dbt_data.data = NULL;
             dbt_data.flags = DB_DBT_MALLOC;
 
-            rc2 = bdb_cget_unpack(bdb_state, dbcp2, &dbt_key, &dbt_data, &ver,
-                                  DB_LAST);
+            if (partition < 0)
+                rc2 = bdb_cget_unpack(bdb_state, dbcp2, &dbt_key, &dbt_data,
+                                      &ver, DB_LAST);
+            else
+                rc2 = queuedb_cget_partition(bdb_state, dbcp2, partition, 1,
+                                             &dbt_data, &ver, 0);
 
             if (rc2 == 0) {
                 freeme2 = dbt_data.data;
@@ -471,10 +578,10 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
                 *bdberr = BDBERR_MISC;
                 rc = -1;
                 goto done;
-            } else if (bdb_state->persistent_seq) {
+            } else if (bdb_state->persistent_seq && partition < 0) {
                 get_queue_sequence_tran(bdb_state->name, &prev_seq.seq, tran);
             }
-        } else if (bdb_state->persistent_seq) {
+        } else if (bdb_state->persistent_seq && partition < 0) {
             get_queue_sequence_tran(bdb_state->name, &prev_seq.seq, tran);
         }
         qfnd_odh.seq = (prev_seq.seq + 1);
@@ -486,7 +593,7 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
         p_buf_end = p_buf + dtalen + sizeof(struct bdb_queue_found_seq);
         p_buf = queue_found_seq_put(&qfnd_odh, p_buf, p_buf_end);
     } else {
-        genid = qfnd.genid = get_genid(bdb_state, 0);
+        genid = qfnd.genid = get_genid(bdb_state, part);
         qfnd.data_len = dtalen;
         qfnd.data_offset = sizeof(struct bdb_queue_found);
         qfnd.trans.tid = tran->tid->txnid;
@@ -523,7 +630,7 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
             uint8_t *p_buf, *p_buf_end;
             p_buf = key;
             p_buf_end = key + sizeof(key);
-            k.consumer = i;
+            k.consumer = QUEUE_PARTITION_CONSUMER(i, part);
             k.genid = genid;
             p_buf = queuedb_key_put(&k, p_buf, p_buf_end);
             if (p_buf == NULL) {
@@ -614,6 +721,83 @@ done:
     return rc;
 }
 
+/* A partitioned queue has a sequence per partition, so its depth is the sum
+ * of its partitions' depths.  Sets *partitioned, and does nothing else,
+ * unless the queue has items outside partition 0. */
+static int queuedb_partition_stats(bdb_state_type *bdb_state, DBC *dbcp1,
+                                   DBC *dbcp2,
+                                   bdb_queue_stats_callback_t callback,
+                                   void *userptr, int *partitioned)
+{
+    struct bdb_queue_found_seq qfnd_odh;
+    struct queuedb_key k;
+    uint8_t key[QUEUEDB_KEY_LEN];
+    DBT dbt_key = {0}, dbt_data = {0};
+    uint8_t ver = 0;
+    unsigned int epoch = 0, depth = 0;
+    size_t item_length = 0;
+    long long first_seq;
+    int rc, found = 0;
+
+    *partitioned = 0;
+    dbt_key.data = key;
+    dbt_key.ulen = sizeof(key);
+    dbt_key.flags = DB_DBT_USERMEM;
+    dbt_data.flags = DB_DBT_PARTIAL;
+    rc = dbcp2->c_get(dbcp2, &dbt_key, &dbt_data, DB_LAST);
+    if (rc == DB_NOTFOUND && dbcp2 != dbcp1)
+        rc = dbcp1->c_get(dbcp1, &dbt_key, &dbt_data, DB_LAST);
+    if (rc)
+        return rc == DB_NOTFOUND ? 0 : rc;
+    if (queuedb_key_get(&k, key, key + sizeof(key)) == NULL ||
+        (k.consumer >> QUEUE_PARTITION_SHIFT) == 0)
+        return 0;
+    *partitioned = 1;
+
+    dbt_data.flags = DB_DBT_REALLOC;
+    for (int p = 0; p < QUEUE_MAX_PARTITIONS; p++) {
+        rc = queuedb_cget_partition(bdb_state, dbcp1, p, 0, &dbt_data, &ver, 0);
+        if (rc == DB_NOTFOUND && dbcp2 != dbcp1)
+            rc = queuedb_cget_partition(bdb_state, dbcp2, p, 0, &dbt_data,
+                                        &ver, 0);
+        if (rc == DB_NOTFOUND)
+            continue;
+        if (rc)
+            goto done;
+        if (queue_found_seq_get(&qfnd_odh, dbt_data.data,
+                                (uint8_t *)dbt_data.data + dbt_data.size) ==
+            NULL)
+            continue;
+        first_seq = qfnd_odh.seq;
+        if (!found || qfnd_odh.epoch < epoch) {
+            epoch = qfnd_odh.epoch;
+            item_length = dbt_data.size;
+        }
+        found = 1;
+
+        rc = queuedb_cget_partition(bdb_state, dbcp2, p, 1, &dbt_data, &ver, 0);
+        if (rc == DB_NOTFOUND && dbcp2 != dbcp1)
+            rc = queuedb_cget_partition(bdb_state, dbcp1, p, 1, &dbt_data,
+                                        &ver, 0);
+        if (rc == DB_NOTFOUND)
+            continue;
+        if (rc)
+            goto done;
+        if (queue_found_seq_get(&qfnd_odh, dbt_data.data,
+                                (uint8_t *)dbt_data.data + dbt_data.size) ==
+            NULL)
+            continue;
+        if (qfnd_odh.seq >= first_seq)
+            depth += (qfnd_odh.seq - first_seq) + 1;
+    }
+    rc = 0;
+    if (found)
+        callback(0, item_length, epoch, depth, userptr);
+done:
+    free(dbt_data.data);
+    return rc;
+}
+
 int bdb_queuedb_stats(bdb_state_type *bdb_state,
                       bdb_queue_stats_callback_t callback, tran_type *tran,
                       void *userptr, int *bdberr)
@@ -665,6 +849,22 @@ int bdb_queuedb_stats(bdb_state_type *bdb_state,
         dbcp2 = dbcp1; /* no second file, use same cursor */
     }
 
+    int partitioned;
+    rc = queuedb_partition_stats(bdb_state, dbcp1, dbcp2, callback, userptr,
+                                 &partitioned);
+    if (rc == DB_LOCK_DEADLOCK) {
+        *bdberr = BDBERR_DEADLOCK;
+        rc = -1;
+        goto done;
+    } else if (rc) {
+        logmsg(LOGMSG_ERROR, "%s partition stats berk rc %d\n", __func__, rc);
+        *bdberr = BDBERR_MISC;
+        rc = -1;
+        goto done;
+    } else if (partitioned) {
+        goto done;
+    }
+
     rc = bdb_cget_unpack(bdb_state, dbcp1, &dbt_key, &dbt_data, &ver, DB_FIRST);
 
     int did_dbcp2_first = 0;
@@ -1209,7 +1409,8 @@ static int bdb_queuedb_consume_int(bdb_state_type *bdb_state, DB *db,
                                    int put_seq, int *bdberr)
 {
     struct queuedb_key k = {
-        .consumer = consumer,
+        .consumer = QUEUE_PARTITION_CONSUMER(
+            consumer, queuedb_genid_partition(fnd->genid)),
         .genid = fnd->genid
     };
     uint8_t ver = 0;
@@ -1417,3 +1618,19 @@ int bdb_trigger_unpause(bdb_state_type *bdb_state)
     DB_ENV *dbenv = bdb_state->dbenv;
     return dbenv->trigger_unpause(dbenv, bdb_state->name);
 }
+
+/* Read before looking in the queue, then pass to bdb_trigger_wait to sleep
+ * until something is enqueued or the trigger changes status */
+uint64_t bdb_trigger_seq(bdb_state_type *bdb_state)
+{
+    DB_ENV *dbenv = bdb_state->dbenv;
+    u_int64_t seq;
+    dbenv->trigger_seq(dbenv, bdb_state->name, &seq);
+    return seq;
+}
+
+int bdb_trigger_wait(bdb_state_type *bdb_state, uint64_t seen, int timeout_ms)
+{
+    DB_ENV *dbenv = bdb_state->dbenv;
+    return dbenv->trigger_wait(dbenv, bdb_state->name, seen, timeout_ms);
+}
@@ -0,0 +1,204 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+  Throttled file reclaim
+
+  Unlinking a large file frees all of its extents at once, which on a big
+  table (a dropped time partition shard, the old files of a rebuild) keeps
+  the disk busy for seconds.  With file_reclaim_chunk_mb set, berkdb's
+  unlinks go through bdb_reclaim_unlink: a file bigger than one chunk is
+  opened, its name is removed right away, and the reclaim thread then
+  truncates it a chunk at a time, at file_reclaim_mb_per_sec, before
+  closing it.  The file is gone from the directory as soon as the unlink
+  returns; only its space comes back slowly.  If we crash before we are
+  done, the kernel frees what is left when the process exits.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <build/db.h>
+#include "bdb_int.h"
+#include "locks_wrap.h"
+#include <list.h>
+#include "logmsg.h"
+
+int gbl_file_reclaim_chunk_mb = 0;
+int gbl_file_reclaim_mb_per_sec = 256;
+
+struct reclaim_file {
+    char *path;
+    int fd;
+    int64_t size;
+    int64_t remaining;
+    int64_t queued_ms;
+    LINKC_T(struct reclaim_file) lnk;
+};
+
+extern pthread_attr_t gbl_pthread_attr_detached;
+
+static pthread_mutex_t lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+static LISTC_T(struct reclaim_file) files;
+static int started;
+
+static void reclaim_one(struct reclaim_file *f)
+{
+    int64_t chunk, next, rate;
+
+    while (f->remaining > 0) {
+        chunk = (int64_t)gbl_file_reclaim_chunk_mb << 20;
+        if (chunk <= 0)
+            chunk = f->remaining;
+        next = f->remaining > chunk ? f->remaining - chunk : 0;
+        if (ftruncate(f->fd, next)) {
+            logmsg(LOGMSG_ERROR, "%s: ftruncate %s to %" PRId64 ": %s\n",
+                   __func__, f->path, next, strerror(errno));
+            break;
+        }
+        Pthread_mutex_lock(&lk);
+        f->remaining = next;
+        Pthread_mutex_unlock(&lk);
+
+        /* pace the next chunk so this one is paid for at the set rate */
+        rate = (int64_t)gbl_file_reclaim_mb_per_sec << 20;
+        if (next > 0 && rate > 0)
+            poll(NULL, 0, chunk * 1000 / rate);
+    }
+    close(f->fd);
+}
+
+static void *reclaim_thd(void *arg)
+{
+    struct reclaim_file *f;
+
+    comdb2_name_thread(__func__);
+    while (1) {
+        Pthread_mutex_lock(&lk);
+        while ((f = files.top) == NULL)
+            Pthread_cond_wait(&cond, &lk);
+        Pthread_mutex_unlock(&lk);
+
+        /* stays listed while we work on it, so it shows progress */
+        reclaim_one(f);
+
+        logmsg(LOGMSG_INFO, "%s: reclaimed %" PRId64 " bytes of %s in %" PRId64
+                            "ms\n",
+               __func__, f->size, f->path, comdb2_time_epochms() - f->queued_ms);
+        Pthread_mutex_lock(&lk);
+        listc_rfl(&files, f);
+        Pthread_mutex_unlock(&lk);
+        free(f->path);
+        free(f);
+    }
+    return NULL;
+}
+
+static void reclaim_init(void)
+{
+    pthread_t tid;
+    Pthread_mutex_lock(&lk);
+    listc_init(&files, offsetof(struct reclaim_file, lnk));
+    started = 1;
+    Pthread_mutex_unlock(&lk);
+    Pthread_create(&tid, &gbl_pthread_attr_detached, reclaim_thd, NULL);
+}
+
+/* Installed as berkdb's unlink; same contract as unlink(2) */
+int bdb_reclaim_unlink(const char *path)
+{
+    struct reclaim_file *f;
+    struct stat st;
+    int64_t chunk = (int64_t)gbl_file_reclaim_chunk_mb << 20;
+    int fd, err;
+
+    if (chunk <= 0)
+        return unlink(path);
+    if ((fd = open(path, O_WRONLY)) == -1)
+        return unlink(path);
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size <= chunk ||
+        (f = calloc(1, sizeof(*f))) == NULL) {
+        close(fd);
+        return unlink(path);
+    }
+    if (unlink(path)) {
+        err = errno;
+        close(fd);
+        free(f);
+        errno = err;
+        return -1;
+    }
+
+    f->path = strdup(path);
+    f->fd = fd;
+    f->size = f->remaining = st.st_size;
+    f->queued_ms = comdb2_time_epochms();
+
+    pthread_once(&once, reclaim_init);
+    Pthread_mutex_lock(&lk);
+    listc_abl(&files, f);
+    Pthread_cond_signal(&cond);
+    Pthread_mutex_unlock(&lk);
+    return 0;
+}
+
+int bdb_collect_file_reclaim(collect_file_reclaim_f func, void *arg)
+{
+    struct reclaim_file *f;
+    struct {
+        char path[PATH_MAX];
+        int64_t size, remaining, queued_ms;
+    } *copy = NULL;
+    int i, n = 0, rc = 0;
+
+    Pthread_mutex_lock(&lk);
+    if (!started) {
+        Pthread_mutex_unlock(&lk);
+        return 0;
+    }
+    if (files.count > 0 &&
+        (copy = malloc(files.count * sizeof(*copy))) == NULL) {
+        Pthread_mutex_unlock(&lk);
+        return ENOMEM;
+    }
+    LISTC_FOR_EACH(&files, f, lnk)
+    {
+        strncpy(copy[n].path, f->path ? f->path : "", PATH_MAX - 1);
+        copy[n].path[PATH_MAX - 1] = 0;
+        copy[n].size = f->size;
+        copy[n].remaining = f->remaining;
+        copy[n].queued_ms = f->queued_ms;
+        n++;
+    }
+    Pthread_mutex_unlock(&lk);
+
+    for (i = 0; rc == 0 && i < n; i++)
+        rc = func(arg, copy[i].path, copy[i].size, copy[i].remaining,
+                  copy[i].queued_ms);
+    free(copy);
+    return rc;
+}
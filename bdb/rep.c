@@ -39,6 +39,8 @@
 #include "gettimeofday_ms.h"
 
 #include <build/db_int.h>
+#include "dbinc/db_page.h"
+#include "dbinc/db_am.h"
 #include "dbinc/log.h"
 #include "dbinc/mp.h"
 #include <trigger.h>
@@ -47,6 +49,7 @@
 #include <compat.h>
 #include "str0.h"
 #include <thrman.h>
+#include <tracering.h>
 #ifdef _LINUX_SOURCE
 #include <sys/syscall.h>
 #endif
@@ -401,10 +404,37 @@ int bdb_is_an_unconnected_master(bdb_state_type *bdb_state)
 }
 
 
+int gbl_transfermaster_direct = 1;
+int gbl_transfermaster_catchup_ms = 2000;
+
+/* The coherent, up node that has applied the most log, or NULL */
+static char *transfermaster_candidate(bdb_state_type *bdb_state)
+{
+    const char *hostlist[REPMAX];
+    char *best = NULL;
+    DB_LSN best_lsn = {0}, lsn;
+    int count, i;
+
+    count = net_get_all_nodes_connected(bdb_state->repinfo->netinfo, hostlist);
+    for (i = 0; i < count; i++) {
+        char *host = (char *)hostlist[i];
+        if (bdb_state->coherent_state[nodeix(host)] != STATE_COHERENT ||
+            !bdb_state->callback->nodeup_rtn(bdb_state, host))
+            continue;
+        lsn = bdb_state->seqnum_info->seqnums[nodeix(host)].lsn;
+        if (best == NULL || log_compare(&lsn, &best_lsn) > 0) {
+            best = host;
+            best_lsn = lsn;
+        }
+    }
+    return best;
+}
+
 void bdb_transfermaster(bdb_state_type *bdb_state)
 {
     int rc = 0;
     const char *hostlist[REPMAX];
+    char *tohost;
 
     if (bdb_state->parent)
         bdb_state = bdb_state->parent;
@@ -420,6 +450,15 @@ void bdb_transfermaster(bdb_state_type *bdb_state)
         return;
     }
 
+    /* handing over to the most caught up node takes one round trip; an
+       election takes several, and the winner may still have to catch up */
+    if (gbl_transfermaster_direct &&
+        (tohost = transfermaster_candidate(bdb_state)) != NULL) {
+        bdb_transfermaster_tonode(bdb_state, tohost);
+        if (bdb_state->repinfo->master_host != bdb_state->repinfo->myhost)
+            return;
+    }
+
     rc = bdb_downgrade(bdb_state, 0, NULL);
     if (rc) {
         logmsg(LOGMSG_ERROR, "%s:%d bdb_downgrade failed rc=%d ?\n", __FILE__,
@@ -517,9 +556,11 @@ void bdb_transfermaster_tonode(bdb_state_type *bdb_state, char *tohost)
     bdb_downgrade_noelect(bdb_state);
 
     numsleeps = 0;
-    DB_LSN tohost_lsn = bdb_state->seqnum_info->seqnums[nodeix(tohost)].lsn;
-    DB_LSN myhost_lsn = bdb_state->seqnum_info->seqnums[nodeix(myhost)].lsn;
+    DB_LSN tohost_lsn, myhost_lsn;
 again:
+    /* writes have stopped; poll for the node to apply the last of them */
+    tohost_lsn = bdb_state->seqnum_info->seqnums[nodeix(tohost)].lsn;
+    myhost_lsn = bdb_state->seqnum_info->seqnums[nodeix(myhost)].lsn;
     if (((tohost_lsn.file > myhost_lsn.file) ||
          (tohost_lsn.file == myhost_lsn.file &&
           tohost_lsn.offset >= myhost_lsn.offset)) &&
@@ -529,15 +570,16 @@ again:
                __func__, tohost, tohost_lsn.file, tohost_lsn.offset,
                myhost_lsn.file, myhost_lsn.offset);
     } else {
-        numsleeps++;
-        if (numsleeps > 2) {
+        if (numsleeps * 10 >= gbl_transfermaster_catchup_ms) {
             logmsg(LOGMSG_ERROR, "transfer master falling back to election\n");
             bdb_downgrade(bdb_state, 0, NULL);
             return;
         }
 
-        logmsg(LOGMSG_WARN, "node %s is still behind, waiting 1 second\n", tohost);
-        sleep(1);
+        if (numsleeps++ == 0)
+            logmsg(LOGMSG_WARN, "node %s is still behind, waiting up to %d ms\n",
+                   tohost, gbl_transfermaster_catchup_ms);
+        poll(NULL, 0, 10);
         goto again;
     }
 
@@ -715,9 +757,11 @@ int berkdb_send_rtn(DB_ENV *dbenv, const DBT *control, const DBT *rec,
     struct rep_type_berkdb_rep_seqnum p_rep_type_berkdb_rep_seqnum = {0};
     uint8_t *p_buf, *p_buf_end;
     int rectype = 0;
-    int *seqnum;
+    int seqnum;
+    uint8_t buf_hdr[REP_TYPE_BERKDB_REP_BUF_HDR_LEN];
+    uint8_t ctrlbuf_hdr[REP_TYPE_BERKDB_REP_CTRLBUF_HDR_LEN];
+    struct iovec iov[5];
     int nodelay;
-    int useheap = 0;
     int is_logput = 0;
     tran_type *tran = NULL;
 
@@ -793,20 +837,13 @@ int berkdb_send_rtn(DB_ENV *dbenv, const DBT *control, const DBT *rec,
             sizeof(int) +   /* controlcrc */
             control->size;  /* controlbuf */
 
-    if (bufsz > 1024 * 65)
-        useheap = 1;
-
-    char *buf = useheap ? malloc(bufsz) : alloca(bufsz);
-
     bytecount += bufsz;
 
-    p_buf = (uint8_t *)buf;
-    p_buf_end = ((uint8_t *)buf + bufsz);
-
+    /* The record is gathered by net straight from the caller's buffers
+       (for a broadcast, into one copy shared by every replicant) rather
+       than being packed into a local buffer first. */
     /* not included in the buf headers as it's set multiple times */
-    seqnum = (int *)p_buf;
-    *seqnum = 0;
-    p_buf += sizeof(int);
+    seqnum = 0;
 
     if (bdb_state->rep_trace) {
         char str[80];
@@ -835,18 +872,24 @@ int berkdb_send_rtn(DB_ENV *dbenv, const DBT *control, const DBT *rec,
     p_rep_type_berkdb_rep_ctrlbuf_hdr.controlbufsz = control->size;
 
     /* pack buffer header */
-    p_buf = rep_type_berkdb_rep_buf_hdr_put(&(p_rep_type_berkdb_rep_buf_hdr),
-                                            p_buf, p_buf_end);
-
-    /* pack buffer */
-    p_buf = buf_no_net_put(rec->data, rec->size, p_buf, p_buf_end);
+    rep_type_berkdb_rep_buf_hdr_put(&(p_rep_type_berkdb_rep_buf_hdr), buf_hdr,
+                                    buf_hdr + sizeof(buf_hdr));
 
     /* pack control buffer header */
-    p_buf = rep_type_berkdb_rep_ctrlbuf_hdr_put(
-        &(p_rep_type_berkdb_rep_ctrlbuf_hdr), p_buf, p_buf_end);
-
-    /* pack control buffer payload */
-    p_buf = buf_no_net_put(control->data, control->size, p_buf, p_buf_end);
+    rep_type_berkdb_rep_ctrlbuf_hdr_put(&(p_rep_type_berkdb_rep_ctrlbuf_hdr),
+                                        ctrlbuf_hdr,
+                                        ctrlbuf_hdr + sizeof(ctrlbuf_hdr));
+
+    iov[0].iov_base = &seqnum;
+    iov[0].iov_len = sizeof(seqnum);
+    iov[1].iov_base = buf_hdr;
+    iov[1].iov_len = sizeof(buf_hdr);
+    iov[2].iov_base = rec->data;
+    iov[2].iov_len = rec->size;
+    iov[3].iov_base = ctrlbuf_hdr;
+    iov[3].iov_len = sizeof(ctrlbuf_hdr);
+    iov[4].iov_base = control->data;
+    iov[4].iov_len = control->size;
 
     nodelay = 0;
 
@@ -897,11 +940,12 @@ int berkdb_send_rtn(DB_ENV *dbenv, const DBT *control, const DBT *rec,
     }
 
     if (host == db_eid_broadcast) {
-        void *data[2];
-        int sz[2];
-        int type[2];
-        int flag[2];
+        const struct iovec *msgiov[2];
+        int msgiovcnt[2];
+        int msgtype[2];
         int num = 0;
+        struct iovec ctxiov;
+        uint32_t sendflags;
         uint64_t gblcontext;
         if (bdb_state->repinfo->master_host == bdb_state->repinfo->myhost &&
             is_logput && tran && bdb_state->attr->net_send_gblcontext &&
@@ -912,35 +956,39 @@ int berkdb_send_rtn(DB_ENV *dbenv, const DBT *control, const DBT *rec,
                 logmsg(LOGMSG_ERROR, "SENDING context -1 to all nodes\n");
                 cheap_stack_trace();
             }
-            data[num] = &gblcontext;
-            sz[num] = sizeof(gblcontext);
-            type[num] = USER_TYPE_GBLCONTEXT;
-            flag[num] = 0;
+            /* queued ahead of the record, in the same send and with the
+               record's flags, so a replicant gets both or neither */
+            ctxiov.iov_base = &gblcontext;
+            ctxiov.iov_len = sizeof(gblcontext);
+            msgiov[num] = &ctxiov;
+            msgiovcnt[num] = 1;
+            msgtype[num] = USER_TYPE_GBLCONTEXT;
             ++num;
         }
-        data[num] = buf;
-        sz[num] = bufsz;
-        type[num] = USER_TYPE_BERKDB_REP;
-        flag[num] =
+        msgiov[num] = iov;
+        msgiovcnt[num] = 5;
+        msgtype[num] = USER_TYPE_BERKDB_REP;
+        ++num;
+        sendflags =
             (!is_logput ? (NET_SEND_NODROP | NET_SEND_NODELAY) : 0) |
             ((flags & DB_REP_NODROP) ? NET_SEND_NODROP : 0) |
             (bdb_state->attr->net_inorder_logputs ? NET_SEND_INORDER : 0) |
             (nodelay ? NET_SEND_NODELAY : 0) |
             (flags & DB_REP_TRACE ? NET_SEND_TRACE : 0);
-        ++num;
-        rc = net_send_all(bdb_state->repinfo->netinfo, num, data, sz, type, flag);
+        rc = net_send_all_iov(bdb_state->repinfo->netinfo, num, msgtype, msgiov,
+                              msgiovcnt, sendflags);
     } else {
         int tmpseq;
-        uint8_t *p_seq_num = (uint8_t *)seqnum;
-        uint8_t *p_seq_num_end = ((uint8_t *)seqnum + sizeof(int));
+        uint8_t *p_seq_num = (uint8_t *)&seqnum;
+        uint8_t *p_seq_num_end = ((uint8_t *)&seqnum + sizeof(int));
 
         p_rep_type_berkdb_rep_seqnum.seqnum = tmpseq =
             get_seqnum(bdb_state, host);
         rep_type_berkdb_rep_seqnum_put(&p_rep_type_berkdb_rep_seqnum, p_seq_num,
                                        p_seq_num_end);
 
-        p_seq_num = (uint8_t *)seqnum;
-        p_seq_num_end = ((uint8_t *)seqnum + sizeof(int));
+        p_seq_num = (uint8_t *)&seqnum;
+        p_seq_num_end = ((uint8_t *)&seqnum + sizeof(int));
 
         rep_type_berkdb_rep_seqnum_put(&p_rep_type_berkdb_rep_seqnum, p_seq_num,
                                        p_seq_num_end);
@@ -969,17 +1017,14 @@ int berkdb_send_rtn(DB_ENV *dbenv, const DBT *control, const DBT *rec,
             sendflags |= NET_SEND_TRACE;
         }
 
-        rc = net_send_flags(bdb_state->repinfo->netinfo, host,
-                            USER_TYPE_BERKDB_REP, buf, bufsz, sendflags);
+        rc = net_send_iov(bdb_state->repinfo->netinfo, host,
+                          USER_TYPE_BERKDB_REP, iov, 5, sendflags);
     }
 
     if (rc != 0) {
         outrc = 1;
     }
 
-    if (useheap)
-        free(buf);
-
     return outrc;
 }
 
@@ -2274,6 +2319,7 @@ static void got_new_seqnum_from_node(bdb_state_type *bdb_state,
     int track_times;
     int node_ix = nodeix(host);
     int seqnum_trace = bdb_state->attr->wait_for_seqnum_trace;
+    int wake = 0;
 
     track_times = bdb_state->attr->track_replication_times;
 
@@ -2434,6 +2480,8 @@ static void got_new_seqnum_from_node(bdb_state_type *bdb_state,
                 &bdb_state->seqnum_info->seqnums[node_ix])) {
         memcpy(&(bdb_state->seqnum_info->seqnums[node_ix]), seqnum,
                sizeof(seqnum_type));
+        /* only worth waking waiters if this node moved */
+        wake = bdb_state->seqnum_info->nwaiters > 0;
     }
 
     if (gbl_set_seqnum_trace) {
@@ -2496,7 +2544,8 @@ static void got_new_seqnum_from_node(bdb_state_type *bdb_state,
         return;
 
     /* wake up anyone who might be waiting to see this seqnum */
-    Pthread_cond_broadcast(&(bdb_state->seqnum_info->cond));
+    if (wake)
+        Pthread_cond_broadcast(&(bdb_state->seqnum_info->cond));
 
     /* new LSN from node: we may need to make the node coherent */
     Pthread_mutex_lock(&(bdb_state->coherent_state_lock));
@@ -2989,8 +3038,10 @@ again:
         reset_ts = 0;
     }
 
+    bdb_state->seqnum_info->nwaiters++;
     rc = pthread_cond_timedwait(&(bdb_state->seqnum_info->cond),
                                 &(bdb_state->seqnum_info->lock), &waittime);
+    bdb_state->seqnum_info->nwaiters--;
 
     /* Keep track of the number of wakeups */
     wakecnt++;
@@ -3653,6 +3704,42 @@ int send_myseqnum_to_master(bdb_state_type *bdb_state, int nodelay)
     return rc;
 }
 
+/* Wait up to timeoutms for this node to have applied the commit at
+ * file:offset.  Everything committed is visible on the master.  Returns 0 once
+ * it is applied, -1 on timeout. */
+int bdb_wait_for_applied_lsn(bdb_state_type *bdb_state, uint32_t file,
+                             uint32_t offset, int timeoutms)
+{
+    DB_LSN want = {.file = file, .offset = offset};
+    struct timespec waittime;
+    seqnum_type *mine;
+    int rc = 0;
+
+    if (bdb_state->parent)
+        bdb_state = bdb_state->parent;
+    if (bdb_state->repinfo->master_host == bdb_state->repinfo->myhost)
+        return 0;
+
+    setup_waittime(&waittime, timeoutms > 0 ? timeoutms : 0);
+    Pthread_mutex_lock(&(bdb_state->seqnum_info->lock));
+    mine = &bdb_state->seqnum_info->seqnums[nodeix(bdb_state->repinfo->myhost)];
+    /* INT_MAX is what we advertise while catching up */
+    while (mine->lsn.file == INT_MAX || log_compare(&mine->lsn, &want) < 0) {
+        if (timeoutms <= 0 || rc == ETIMEDOUT) {
+            rc = -1;
+            break;
+        }
+        bdb_state->seqnum_info->nwaiters++;
+        rc = pthread_cond_timedwait(&(bdb_state->seqnum_info->cond),
+                                    &(bdb_state->seqnum_info->lock), &waittime);
+        bdb_state->seqnum_info->nwaiters--;
+    }
+    if (rc != -1)
+        rc = 0;
+    Pthread_mutex_unlock(&(bdb_state->seqnum_info->lock));
+    return rc;
+}
+
 void send_myseqnum_to_all(bdb_state_type *bdb_state, int nodelay)
 {
     uint8_t seqnum[BDB_SEQNUM_TYPE_LEN];
@@ -3704,6 +3791,8 @@ void bdb_set_seqnum(void *in_bdb_state)
         int myhost_ix = nodeix(bdb_state->repinfo->myhost);
         bdb_state->seqnum_info->seqnums[myhost_ix].lsn = lastlsn;
         bdb_state->seqnum_info->seqnums[myhost_ix].generation = mygen;
+        if (bdb_state->seqnum_info->nwaiters)
+            Pthread_cond_broadcast(&(bdb_state->seqnum_info->cond));
 
         if (gbl_set_seqnum_trace && (now = time(NULL)) - lastpr) {
             logmsg(LOGMSG_USER, "%s line %d set %s seqnum to %d:%d gen %d\n",
@@ -3897,6 +3986,8 @@ static int process_berkdb(bdb_state_type *bdb_state, char *host, DBT *control,
     r = bdb_state->dbenv->rep_process_message(bdb_state->dbenv, control, rec,
                                               &host, &permlsn,
                                               &commit_generation, online);
+    TRACE_RING(TRACE_REP, "from %s type %lld gen %lld rc %lld", host, rectype,
+               generation, r);
 
     if (got_vote2lock) {
         if (bdb_get_rep_master(bdb_state, &master, &gen, &egen) != 0) {
@@ -4061,6 +4152,9 @@ static int process_berkdb(bdb_state_type *bdb_state, char *host, DBT *control,
         int myhost_ix = nodeix(bdb_state->repinfo->myhost);
         bdb_state->seqnum_info->seqnums[myhost_ix].lsn = permlsn;
         bdb_state->seqnum_info->seqnums[myhost_ix].generation = generation;
+        /* wake reads waiting to see a commit (bdb_wait_for_applied_lsn) */
+        if (bdb_state->seqnum_info->nwaiters)
+            Pthread_cond_broadcast(&(bdb_state->seqnum_info->cond));
         Pthread_mutex_unlock(&(bdb_state->seqnum_info->lock));
 
         /*
@@ -4550,6 +4644,253 @@ int pgcompact_thdpool_init(void)
     thdpool_set_longwaitms(gbl_pgcompact_thdpool, 10000);
     return 0;
 }
+/* The sweeper walks the data and index btrees of every table, and the
+   files of every queuedb, this many pages a second, and queues their sparse
+   leaf pages for compaction. The pages freed by merging go back to the
+   freelist of their file. */
+extern double gbl_pg_compact_thresh;
+int gbl_pg_compact_sweep_pages = 0;
+
+/* the largest number of pages looked at under one bdb lock */
+#define PGSWEEP_CHUNK 100
+
+struct pgsweep_file {
+    char *table;
+    char *file;
+    u_int32_t fullsz;    /* usable bytes on a page */
+    int round;           /* sweep round the file was last seen in */
+    int64_t passes;      /* number of completed passes */
+    db_pgno_t pgno;      /* next page of the current pass */
+    db_pgno_t last_pgno; /* last page of the file */
+    u_int64_t nleaf, used;           /* the current pass so far */
+    u_int64_t last_nleaf, last_used; /* the last completed pass */
+    u_int64_t nqueued;
+};
+
+static pthread_mutex_t pgsweep_lk = PTHREAD_MUTEX_INITIALIZER;
+static struct pgsweep_file *pgsweep_files;
+static int pgsweep_nfiles;
+static int pgsweep_round;
+
+static struct pgsweep_file *pgsweep_get(bdb_state_type *child, DB *dbp)
+{
+    struct pgsweep_file *f;
+    int i;
+
+    for (i = 0; i < pgsweep_nfiles; ++i) {
+        if (strcmp(pgsweep_files[i].file, dbp->fname) == 0)
+            return &pgsweep_files[i];
+    }
+    f = realloc(pgsweep_files, (pgsweep_nfiles + 1) * sizeof(*f));
+    if (f == NULL)
+        return NULL;
+    pgsweep_files = f;
+    f = &pgsweep_files[pgsweep_nfiles++];
+    memset(f, 0, sizeof(*f));
+    f->table = strdup(child->name);
+    f->file = strdup(dbp->fname);
+    f->fullsz = dbp->pgsize - SIZEOF_PAGE;
+    return f;
+}
+
+/* forget the files of tables that were dropped or rebuilt */
+static void pgsweep_prune(int round)
+{
+    int i = 0;
+    while (i < pgsweep_nfiles) {
+        struct pgsweep_file *f = &pgsweep_files[i];
+        if (f->round >= round) {
+            ++i;
+            continue;
+        }
+        free(f->table);
+        free(f->file);
+        *f = pgsweep_files[--pgsweep_nfiles];
+    }
+}
+
+/* Return the btree at position ifile of child: the data stripes first,
+   then the indexes. A queuedb has up to two files, the second one only
+   while it rolls over. */
+static DB *pgsweep_dbp(bdb_state_type *child, int ifile)
+{
+    if (child->bdbtype == BDBTYPE_QUEUEDB)
+        return ifile < 2 ? child->dbp_data[ifile][0] : NULL;
+    if (ifile < child->attr->dtastripe)
+        return child->dbp_data[0][ifile];
+    ifile -= child->attr->dtastripe;
+    if (ifile < child->numix)
+        return child->dbp_ix[ifile];
+    return NULL;
+}
+
+/* Sweep up to npages pages from where the last call stopped. Returns the
+   number of pages left over. */
+static int pgsweep(bdb_state_type *bdb_state, int npages)
+{
+    static int itable, ifile;
+    bdb_state_type *child;
+    struct pgsweep_file *f;
+    DB *dbp;
+    u_int64_t nleaf, used, nqueued;
+    db_pgno_t pgno, last;
+    int n, rc;
+
+    if (itable >= bdb_state->numchildren) {
+        /* every table was swept */
+        Pthread_mutex_lock(&pgsweep_lk);
+        pgsweep_prune(pgsweep_round);
+        ++pgsweep_round;
+        Pthread_mutex_unlock(&pgsweep_lk);
+        itable = ifile = 0;
+        return 0;
+    }
+
+    child = bdb_state->children[itable];
+    dbp = (child && (child->bdbtype == BDBTYPE_TABLE ||
+                     child->bdbtype == BDBTYPE_QUEUEDB))
+              ? pgsweep_dbp(child, ifile)
+              : NULL;
+    if (dbp == NULL) {
+        ++itable;
+        ifile = 0;
+        return npages;
+    }
+
+    Pthread_mutex_lock(&pgsweep_lk);
+    f = pgsweep_get(child, dbp);
+    if (f == NULL) {
+        Pthread_mutex_unlock(&pgsweep_lk);
+        return 0;
+    }
+    f->round = pgsweep_round;
+    pgno = f->pgno;
+    Pthread_mutex_unlock(&pgsweep_lk);
+
+    n = npages < PGSWEEP_CHUNK ? npages : PGSWEEP_CHUNK;
+    nleaf = used = nqueued = 0;
+    rc = __db_pgcompact_sweep(dbp, &pgno, n, gbl_pg_compact_thresh, &nleaf,
+                              &used, &nqueued);
+    if (rc != 0) {
+        logmsg(LOGMSG_ERROR, "%s: sweeping %s rc %d\n", __func__, dbp->fname,
+               rc);
+        pgno = PGNO_INVALID;
+    }
+    __memp_last_pgno(dbp->mpf, &last);
+
+    Pthread_mutex_lock(&pgsweep_lk);
+    f->nleaf += nleaf;
+    f->used += used;
+    f->nqueued += nqueued;
+    f->last_pgno = last;
+    f->pgno = pgno;
+    if (pgno == PGNO_INVALID) {
+        /* the pass is done: move on to the next file */
+        if (rc == 0) {
+            f->last_nleaf = f->nleaf;
+            f->last_used = f->used;
+            ++f->passes;
+        }
+        f->nleaf = f->used = 0;
+        ++ifile;
+    }
+    Pthread_mutex_unlock(&pgsweep_lk);
+
+    return npages - n;
+}
+
+void *pg_compact_sweep_thread(void *arg)
+{
+    bdb_state_type *bdb_state = arg;
+    repinfo_type *repinfo;
+    int npages;
+
+    if (bdb_state->parent)
+        bdb_state = bdb_state->parent;
+    repinfo = bdb_state->repinfo;
+
+    while (!bdb_state->after_llmeta_init_done)
+        sleep(1);
+
+    thrman_register(THRTYPE_GENERIC);
+    thread_started("bdb pgcompact sweep");
+
+    bdb_thread_event(bdb_state, 1);
+
+    while (!db_is_exiting()) {
+        sleep(1);
+
+        /* the master does the merging; replicants get the result */
+        if (gbl_pg_compact_sweep_pages <= 0 || gbl_pg_compact_thresh <= 0 ||
+            repinfo->master_host != repinfo->myhost)
+            continue;
+
+        npages = gbl_pg_compact_sweep_pages;
+        while (npages > 0 && !db_is_exiting()) {
+            BDB_READLOCK("pg_compact_sweep_thread");
+            npages = pgsweep(bdb_state, npages);
+            BDB_RELLOCK();
+        }
+    }
+
+    bdb_thread_event(bdb_state, 0);
+    return NULL;
+}
+
+int bdb_pgcompact_sweep_collect(bdb_pgsweep_collect_f func, void *arg)
+{
+    struct bdb_pgsweep_stat st;
+    struct pgsweep_file *f;
+    int i, rc = 0;
+
+    Pthread_mutex_lock(&pgsweep_lk);
+    for (i = 0; i < pgsweep_nfiles && rc == 0; ++i) {
+        f = &pgsweep_files[i];
+        st.table = f->table;
+        st.file = f->file;
+        st.passes = f->passes;
+        st.pgno = f->pgno;
+        st.last_pgno = f->last_pgno;
+        st.leaf_pages = f->last_nleaf;
+        st.leaf_fill =
+            f->last_nleaf ? (double)f->last_used / (f->last_nleaf * f->fullsz)
+                          : 0;
+        /* the leaf pages the last pass could do without at the target
+           fill factor */
+        st.reclaimable = 0;
+        if (f->last_nleaf && gbl_pg_compact_target_ff > 0) {
+            double want = f->last_used / (f->fullsz * gbl_pg_compact_target_ff);
+            if (want < f->last_nleaf)
+                st.reclaimable = f->last_nleaf - (u_int64_t)want;
+        }
+        st.queued = f->nqueued;
+        rc = func(arg, &st);
+    }
+    Pthread_mutex_unlock(&pgsweep_lk);
+    return rc;
+}
+
+int bdb_pgsweep_file_pages(const char *fname, int64_t *leaf_pages,
+                           double *leaf_fill)
+{
+    struct pgsweep_file *f;
+    int i, rc = -1;
+
+    Pthread_mutex_lock(&pgsweep_lk);
+    for (i = 0; i < pgsweep_nfiles; ++i) {
+        f = &pgsweep_files[i];
+        if (strcmp(f->file, fname) != 0 || f->passes == 0)
+            continue;
+        *leaf_pages = f->last_nleaf;
+        *leaf_fill = f->last_nleaf
+                         ? (double)f->last_used / (f->last_nleaf * f->fullsz)
+                         : 0;
+        rc = 0;
+        break;
+    }
+    Pthread_mutex_unlock(&pgsweep_lk);
+    return rc;
+}
 /****** btree page compact routines END ******/
 
 void berkdb_receive_msg(void *ack_handle, void *usr_ptr, char *from_host,
@@ -5469,6 +5810,9 @@ void *watcher_thread(void *arg)
                 }
             }
 
+            bdb_repl_history_sample(bdb_state, (const char **)hostlist,
+                                    count);
+
             if (bdb_state->attr->track_replication_times) {
                 int now;
                 now = comdb2_time_epochms();
@@ -5806,9 +6150,12 @@ int bdb_wait_for_seqnum_from_n(bdb_state_type *bdb_state, seqnum_type *seqnum,
                 num_acks++;
             }
         }
-        if (num_acks < n)
+        if (num_acks < n) {
+            bdb_state->seqnum_info->nwaiters++;
             Pthread_cond_wait(&bdb_state->seqnum_info->cond,
                               &bdb_state->seqnum_info->lock);
+            bdb_state->seqnum_info->nwaiters--;
+        }
         Pthread_mutex_unlock(&bdb_state->seqnum_info->lock);
     }
     return 0;
@@ -5898,10 +6245,19 @@ int bdb_debug_logreq(bdb_state_type *bdb_state, int file, int offset)
 // .. Because Thread C started AFTER Thread B, it should see a durable LSN
 //    corresponding to B's writes
 //
+// What does work is sharing a request that hasn't been SENT yet: everyone
+// waiting for it started before it went out, so whatever the master answers
+// is at least as new as what each of them must see.  With
+// DURABLE_LSN_REQUEST_BATCH, one thread has a request in flight at a time;
+// threads that arrive meanwhile wait, and when it returns one of them sends
+// the next request on behalf of all of them.  Under load a replicant sends
+// one request per master round trip instead of one per transaction.
+//
 
-int request_durable_lsn_from_master(bdb_state_type *bdb_state, 
-        uint32_t *durable_file, uint32_t *durable_offset, 
-        uint32_t *durable_gen) {
+static int request_durable_lsn_one(bdb_state_type *bdb_state,
+        uint32_t *durable_file, uint32_t *durable_offset,
+        uint32_t *durable_gen)
+{
 
     const uint8_t *p_buf, *p_buf_end;
     DB_LSN durable_lsn;
@@ -6010,4 +6366,58 @@ int request_durable_lsn_from_master(bdb_state_type *bdb_state,
     return 0;
 }
 
+static pthread_mutex_t durable_req_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t durable_req_cd = PTHREAD_COND_INITIALIZER;
+static struct {
+    uint64_t sent; /* requests sent so far */
+    uint64_t done; /* request the result below is from */
+    int inflight;
+    int rc;
+    uint32_t file, offset, gen;
+} durable_req;
+
+int request_durable_lsn_from_master(bdb_state_type *bdb_state,
+        uint32_t *durable_file, uint32_t *durable_offset,
+        uint32_t *durable_gen)
+{
+    uint64_t mine, id;
+    uint32_t file, offset, gen;
+    int rc;
+
+    if (!bdb_state->attr->durable_lsn_request_batch ||
+        bdb_state->repinfo->master_host == bdb_state->repinfo->myhost)
+        return request_durable_lsn_one(bdb_state, durable_file,
+                                       durable_offset, durable_gen);
+
+    Pthread_mutex_lock(&durable_req_lk);
+    /* any request sent from now on will do */
+    mine = durable_req.sent + 1;
+    while (durable_req.done < mine) {
+        if (durable_req.inflight) {
+            Pthread_cond_wait(&durable_req_cd, &durable_req_lk);
+            continue;
+        }
+        durable_req.inflight = 1;
+        id = ++durable_req.sent;
+        Pthread_mutex_unlock(&durable_req_lk);
+
+        rc = request_durable_lsn_one(bdb_state, &file, &offset, &gen);
+
+        Pthread_mutex_lock(&durable_req_lk);
+        durable_req.inflight = 0;
+        durable_req.done = id;
+        durable_req.rc = rc;
+        durable_req.file = file;
+        durable_req.offset = offset;
+        durable_req.gen = gen;
+        Pthread_cond_broadcast(&durable_req_cd);
+    }
+    rc = durable_req.rc;
+    *durable_file = durable_req.file;
+    *durable_offset = durable_req.offset;
+    *durable_gen = durable_req.gen;
+    Pthread_mutex_unlock(&durable_req_lk);
+    return rc;
+}
+
 
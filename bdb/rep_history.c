@@ -0,0 +1,360 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+  Replication lag history
+
+  On the master, the watcher thread takes a sample of every connected
+  replicant each time round its loop: how many bytes of log it is behind,
+  how fast it applied log since the previous sample, and its ack latency
+  over the last 10 seconds.  Samples go in a ring per replicant of
+  repl_history_samples entries, read by comdb2_repl_history.
+
+  A replicant whose lag has grown in each of its last repl_lag_trend_samples
+  samples, and is over commitdelaybehindthresh, is degrading: it is applying
+  slower than the master is writing, and will eventually time out.  We say
+  so once per episode, and with repl_lag_trend_delay set, the master raises
+  its commit delay as if that replicant had asked for it, before it gets far
+  enough behind to go incoherent.
+
+  With repl_target_lag_bytes set, the master instead paces its commits
+  toward that lag.  Each round it takes the coherent replicant furthest
+  behind, and the rate the master may write at is that replicant's apply
+  rate, plus whatever closes the gap to the target over the next
+  repl_pacing_horizon_ms.  If the master wrote faster than that, the commit
+  delay grows in proportion; if slower, it decays.  The delay is capped at
+  repl_pacing_max_delay_ms, and the decision shows in the repl_pacing_*
+  metrics.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <build/db.h>
+#include "bdb_int.h"
+#include "locks_wrap.h"
+#include <averager.h>
+#include <nodemap.h>
+#include "logmsg.h"
+
+int gbl_repl_history_samples = 300;
+int gbl_repl_lag_trend_samples = 10;
+int gbl_repl_lag_trend_delay = 0;
+int gbl_repl_target_lag_bytes = 0;
+int gbl_repl_pacing_horizon_ms = 10000;
+int gbl_repl_pacing_max_delay_ms = 100;
+
+extern int gbl_commit_delay_trace;
+
+struct rep_sample {
+    int64_t time_ms;
+    int64_t lag_bytes;
+    int64_t apply_bytes_per_sec;
+    double ack_avg_ms;
+    double ack_max_ms;
+    int degrading;
+};
+
+struct rep_history {
+    const char *host; /* interned */
+    DB_LSN last_lsn;
+    int64_t last_ms;
+    int degrading;
+    int size;
+    int head; /* next slot to fill */
+    int count;
+    struct rep_sample *ring;
+};
+
+static pthread_mutex_t lk = PTHREAD_MUTEX_INITIALIZER;
+static struct rep_history nodes[REPMAX];
+static int nnodes;
+
+/* last pacing decision */
+static struct {
+    DB_LSN master_lsn;
+    int64_t time_ms;
+    int64_t delay_ms;
+    int64_t lag_bytes;
+    int64_t allowed_bytes_per_sec;
+} pace;
+
+static struct rep_history *find_node(const char *host, int add)
+{
+    int i;
+    for (i = 0; i < nnodes; i++)
+        if (nodes[i].host == host)
+            return &nodes[i];
+    if (!add || nnodes == REPMAX)
+        return NULL;
+    memset(&nodes[nnodes], 0, sizeof(nodes[nnodes]));
+    nodes[nnodes].host = host;
+    return &nodes[nnodes++];
+}
+
+static struct rep_sample *sample_at(struct rep_history *h, int age)
+{
+    return &h->ring[(h->head - 1 - age + 2 * h->size) % h->size];
+}
+
+static int is_degrading(bdb_state_type *bdb_state, struct rep_history *h)
+{
+    int i, n = gbl_repl_lag_trend_samples;
+
+    if (n < 2 || h->count < n)
+        return 0;
+    if (sample_at(h, 0)->lag_bytes <=
+        bdb_state->attr->commitdelaybehindthresh)
+        return 0;
+    for (i = 0; i < n - 1; i++)
+        if (sample_at(h, i)->lag_bytes <= sample_at(h, i + 1)->lag_bytes)
+            return 0;
+    return 1;
+}
+
+static void delay_more(bdb_state_type *bdb_state, const char *host)
+{
+    if (bdb_state->attr->commitdelay == 0)
+        bdb_state->attr->commitdelay = 1;
+    else
+        bdb_state->attr->commitdelay *= 2;
+    if (bdb_state->attr->commitdelay > bdb_state->attr->commitdelaymax)
+        bdb_state->attr->commitdelay = bdb_state->attr->commitdelaymax;
+    if (gbl_commit_delay_trace)
+        logmsg(LOGMSG_USER, "%s: %s is degrading, commitdelay now %d\n",
+               __func__, host, bdb_state->attr->commitdelay);
+}
+
+/* Set the commit delay from how far behind the slowest coherent replicant
+ * is, and how fast it is catching up */
+static void pace_commits(bdb_state_type *bdb_state, int64_t now,
+                         DB_LSN master_lsn, int64_t lag, int64_t apply)
+{
+    int64_t target = gbl_repl_target_lag_bytes;
+    int64_t horizon = gbl_repl_pacing_horizon_ms;
+    int64_t write = 0, allowed, delay;
+
+    if (target <= 0) {
+        /* hand the delay back to the other controls */
+        if (pace.delay_ms) {
+            bdb_state->attr->commitdelay = 0;
+            pace.delay_ms = 0;
+        }
+        pace.time_ms = 0;
+        return;
+    }
+    if (horizon <= 0)
+        horizon = 1000;
+
+    if (pace.time_ms && now > pace.time_ms &&
+        log_compare(&master_lsn, &pace.master_lsn) > 0)
+        write = subtract_lsn(bdb_state, &master_lsn, &pace.master_lsn) *
+                1000 / (now - pace.time_ms);
+    pace.master_lsn = master_lsn;
+    pace.time_ms = now;
+
+    /* never let pacing stop the master outright while the replicant is
+     * applying at all */
+    allowed = apply + (target - lag) * 1000 / horizon;
+    if (allowed < apply / 8)
+        allowed = apply / 8;
+
+    delay = pace.delay_ms;
+    if (write <= allowed || write == 0) {
+        delay = delay * 3 / 4;
+    } else if (allowed <= 0) {
+        delay = gbl_repl_pacing_max_delay_ms;
+    } else {
+        /* halfway toward the delay that brings write down to allowed */
+        int64_t want = (delay ? delay : 1) * write / allowed;
+        delay = (delay + want + 1) / 2;
+    }
+    if (delay > gbl_repl_pacing_max_delay_ms)
+        delay = gbl_repl_pacing_max_delay_ms;
+    if (delay < 0)
+        delay = 0;
+
+    if (gbl_commit_delay_trace && delay != pace.delay_ms)
+        logmsg(LOGMSG_USER,
+               "%s: lag %" PRId64 " target %" PRId64 " write %" PRId64
+               "/s allowed %" PRId64 "/s, commitdelay %" PRId64 "\n",
+               __func__, lag, target, write, allowed, delay);
+
+    Pthread_mutex_lock(&lk);
+    pace.delay_ms = delay;
+    pace.lag_bytes = lag;
+    pace.allowed_bytes_per_sec = allowed;
+    Pthread_mutex_unlock(&lk);
+    bdb_state->attr->commitdelay = delay;
+}
+
+/* Called by the watcher thread on the master */
+void bdb_repl_history_sample(bdb_state_type *bdb_state, const char **hosts,
+                             int count)
+{
+    struct rep_history *h;
+    struct rep_sample *s;
+    struct averager *avg;
+    DB_LSN master_lsn, lsn;
+    int64_t now = comdb2_time_epochms();
+    int i, ix, size, degrading, delayed = 0;
+    int64_t worst_lag = 0, worst_apply = 0;
+
+    size = gbl_repl_history_samples;
+    if (size <= 0)
+        return;
+
+    Pthread_mutex_lock(&bdb_state->seqnum_info->lock);
+    master_lsn = bdb_state->seqnum_info
+                     ->seqnums[nodeix(bdb_state->repinfo->master_host)]
+                     .lsn;
+    Pthread_mutex_unlock(&bdb_state->seqnum_info->lock);
+
+    for (i = 0; i < count; i++) {
+        ix = nodeix(hosts[i]);
+
+        Pthread_mutex_lock(&lk);
+        if ((h = find_node(hosts[i], 1)) == NULL) {
+            Pthread_mutex_unlock(&lk);
+            continue;
+        }
+        if (h->size != size) {
+            free(h->ring);
+            h->ring = calloc(size, sizeof(struct rep_sample));
+            h->size = h->ring ? size : 0;
+            h->head = h->count = 0;
+            if (h->ring == NULL) {
+                Pthread_mutex_unlock(&lk);
+                continue;
+            }
+        }
+        s = &h->ring[h->head];
+        memset(s, 0, sizeof(*s));
+        s->time_ms = now;
+
+        Pthread_mutex_lock(&bdb_state->seqnum_info->lock);
+        master_lsn = bdb_state->seqnum_info
+                         ->seqnums[nodeix(bdb_state->repinfo->master_host)]
+                         .lsn;
+        lsn = bdb_state->seqnum_info->seqnums[ix].lsn;
+        if ((avg = bdb_state->seqnum_info->time_10seconds[ix]) != NULL) {
+            s->ack_avg_ms = averager_avg(avg);
+            s->ack_max_ms = averager_max(avg);
+        }
+        Pthread_mutex_unlock(&bdb_state->seqnum_info->lock);
+
+        s->lag_bytes = log_compare(&master_lsn, &lsn) > 0
+                           ? subtract_lsn(bdb_state, &master_lsn, &lsn)
+                           : 0;
+        if (h->last_ms && now > h->last_ms &&
+            log_compare(&lsn, &h->last_lsn) > 0)
+            s->apply_bytes_per_sec =
+                subtract_lsn(bdb_state, &lsn, &h->last_lsn) * 1000 /
+                (now - h->last_ms);
+        h->last_lsn = lsn;
+        h->last_ms = now;
+        h->head = (h->head + 1) % h->size;
+        if (h->count < h->size)
+            h->count++;
+
+        /* s is the newest sample now */
+        degrading = is_degrading(bdb_state, h);
+        if (degrading && !h->degrading) {
+            logmsg(LOGMSG_WARN,
+                   "%s: %s is falling behind, %" PRId64 " bytes behind "
+                   "after growing for %d samples\n",
+                   __func__, hosts[i], s->lag_bytes,
+                   gbl_repl_lag_trend_samples);
+        }
+        h->degrading = s->degrading = degrading;
+        Pthread_mutex_unlock(&lk);
+
+        if (bdb_state->coherent_state[ix] == STATE_COHERENT &&
+            s->lag_bytes >= worst_lag) {
+            worst_lag = s->lag_bytes;
+            worst_apply = s->apply_bytes_per_sec;
+        }
+
+        /* once per round, however many are behind */
+        if (degrading && gbl_repl_lag_trend_delay && !delayed &&
+            !gbl_repl_target_lag_bytes &&
+            bdb_state->coherent_state[ix] == STATE_COHERENT) {
+            delay_more(bdb_state, hosts[i]);
+            delayed = 1;
+        }
+    }
+
+    pace_commits(bdb_state, now, master_lsn, worst_lag, worst_apply);
+}
+
+void bdb_repl_pacing_stats(int64_t *delay_ms, int64_t *lag_bytes,
+                           int64_t *allowed_bytes_per_sec)
+{
+    Pthread_mutex_lock(&lk);
+    *delay_ms = gbl_repl_target_lag_bytes > 0 ? pace.delay_ms : 0;
+    *lag_bytes = pace.lag_bytes;
+    *allowed_bytes_per_sec = pace.allowed_bytes_per_sec;
+    Pthread_mutex_unlock(&lk);
+}
+
+/* Call func for every sample, oldest first, of host, or of every replicant
+ * if host is NULL */
+int bdb_collect_repl_history(const char *host, collect_repl_history_f func,
+                             void *arg)
+{
+    struct rep_history *h;
+    struct rep_sample *copy = NULL, *p;
+    const char *hostname;
+    int64_t eta;
+    int i, j, n, rc = 0;
+
+    for (i = 0; rc == 0; i++) {
+        /* copy one node's samples out, so func can take its time */
+        Pthread_mutex_lock(&lk);
+        if (i >= nnodes) {
+            Pthread_mutex_unlock(&lk);
+            break;
+        }
+        h = &nodes[i];
+        hostname = h->host;
+        n = h->count;
+        if (host && strcmp(host, hostname) != 0)
+            n = 0;
+        if (n > 0 && (p = realloc(copy, n * sizeof(*copy))) == NULL) {
+            Pthread_mutex_unlock(&lk);
+            rc = ENOMEM;
+            break;
+        } else if (n > 0) {
+            copy = p;
+            for (j = 0; j < n; j++)
+                copy[j] = *sample_at(h, n - 1 - j);
+        }
+        Pthread_mutex_unlock(&lk);
+
+        for (j = 0; rc == 0 && j < n; j++) {
+            p = &copy[j];
+            eta = p->apply_bytes_per_sec
+                      ? p->lag_bytes / p->apply_bytes_per_sec
+                      : (p->lag_bytes ? -1 : 0);
+            rc = func(arg, hostname, p->time_ms, p->lag_bytes,
+                      p->apply_bytes_per_sec, eta, p->ack_avg_ms,
+                      p->ack_max_ms, p->degrading);
+        }
+    }
+    free(copy);
+    return rc;
+}
@@ -52,8 +52,207 @@
 #include <llog_auto.h>
 #include <llog_ext.h>
 
+/*
+ * Recent write index
+ *
+ * Every serializable commit walks the logical log of each transaction that
+ * committed since its read set was taken, reconstructing deleted and added
+ * keys from the log as it goes.  Transactions validating at about the same
+ * time walk the same recent commits.  Keep the (table, index, key) writes of
+ * walked transactions in a bounded LRU keyed by the transaction's last
+ * logical LSN, so later checks go straight to the range comparison.
+ * Entries are dropped when the log is truncated past them.
+ */
+typedef struct serial_txn_writes {
+    DB_LSN lsn;
+    int len;
+    LINKC_T(struct serial_txn_writes) lnk;
+    uint8_t data[1];
+} serial_txn_writes_t;
+
+static struct {
+    pthread_mutex_t lk;
+    hash_t *txns;
+    LISTC_T(serial_txn_writes_t) lru;
+    size_t bytes;
+} serial_writes = {.lk = PTHREAD_MUTEX_INITIALIZER};
+
+int gbl_serial_write_cache_kb = 0;
+int64_t gbl_serial_write_cache_hits = 0;
+int64_t gbl_serial_write_cache_misses = 0;
+
+/* Writes of the transaction being walked: ix, keylen, tbllen, table, key */
+struct serial_writes_buf {
+    int on;
+    int len;
+    int alloc;
+    uint8_t *buf;
+};
+static __thread struct serial_writes_buf serial_writes_tls;
+
+static void serial_writes_evict_int(size_t limit)
+{
+    serial_txn_writes_t *e;
+
+    while (serial_writes.bytes > limit &&
+           (e = listc_rtl(&serial_writes.lru)) != NULL) {
+        hash_del(serial_writes.txns, e);
+        serial_writes.bytes -= e->len;
+        free(e);
+    }
+}
+
+/* Return a malloced copy of the cached writes of the txn ending at lsn */
+static uint8_t *serial_writes_get(DB_LSN *lsn, int *len)
+{
+    serial_txn_writes_t *e;
+    uint8_t *data = NULL;
+    size_t limit = (size_t)gbl_serial_write_cache_kb * 1024;
+
+    if (serial_writes.txns == NULL)
+        return NULL;
+
+    Pthread_mutex_lock(&serial_writes.lk);
+    serial_writes_evict_int(limit);
+    if (limit && (e = hash_find(serial_writes.txns, lsn)) != NULL) {
+        listc_rfl(&serial_writes.lru, e);
+        listc_abl(&serial_writes.lru, e);
+        if ((data = malloc(e->len + 1)) != NULL) {
+            memcpy(data, e->data, e->len);
+            *len = e->len;
+        }
+        gbl_serial_write_cache_hits++;
+    } else if (limit)
+        gbl_serial_write_cache_misses++;
+    Pthread_mutex_unlock(&serial_writes.lk);
+
+    return data;
+}
+
+static void serial_writes_put(DB_LSN *lsn, const uint8_t *data, int len)
+{
+    serial_txn_writes_t *e;
+    size_t limit = (size_t)gbl_serial_write_cache_kb * 1024;
+
+    /* A single transaction may not take more than a quarter of the cache. */
+    if ((size_t)len > limit / 4)
+        return;
+
+    Pthread_mutex_lock(&serial_writes.lk);
+    if (serial_writes.txns == NULL) {
+        serial_writes.txns =
+            hash_init_o(offsetof(serial_txn_writes_t, lsn), sizeof(DB_LSN));
+        listc_init(&serial_writes.lru, offsetof(serial_txn_writes_t, lnk));
+    }
+    if (hash_find(serial_writes.txns, lsn) == NULL &&
+        (e = malloc(offsetof(serial_txn_writes_t, data) + len)) != NULL) {
+        e->lsn = *lsn;
+        e->len = len;
+        memcpy(e->data, data, len);
+        hash_add(serial_writes.txns, e);
+        listc_abl(&serial_writes.lru, e);
+        serial_writes.bytes += len;
+        serial_writes_evict_int(limit);
+    }
+    Pthread_mutex_unlock(&serial_writes.lk);
+}
+
+void bdb_serial_writes_truncate(DB_LSN *lsn)
+{
+    serial_txn_writes_t *e, *tmp;
+
+    if (serial_writes.txns == NULL)
+        return;
+
+    Pthread_mutex_lock(&serial_writes.lk);
+    LISTC_FOR_EACH_SAFE(&serial_writes.lru, e, tmp, lnk)
+    {
+        if (log_compare(&e->lsn, lsn) >= 0) {
+            listc_rfl(&serial_writes.lru, e);
+            hash_del(serial_writes.txns, e);
+            serial_writes.bytes -= e->len;
+            free(e);
+        }
+    }
+    Pthread_mutex_unlock(&serial_writes.lk);
+}
+
+static void serial_writes_add(struct serial_writes_buf *wr, DBT *table, int ix,
+                              void *key, int keylen)
+{
+    int tbllen = strnlen(table->data, table->size);
+    int need = 3 * sizeof(int) + tbllen + 1 + keylen;
+
+    if (wr->len + need > wr->alloc) {
+        int alloc = (wr->len + need) * 2;
+        uint8_t *buf = realloc(wr->buf, alloc);
+        if (buf == NULL) {
+            wr->on = 0;
+            return;
+        }
+        wr->buf = buf;
+        wr->alloc = alloc;
+    }
+    memcpy(wr->buf + wr->len, &ix, sizeof(int));
+    memcpy(wr->buf + wr->len + sizeof(int), &keylen, sizeof(int));
+    memcpy(wr->buf + wr->len + 2 * sizeof(int), &tbllen, sizeof(int));
+    wr->len += 3 * sizeof(int);
+    memcpy(wr->buf + wr->len, table->data, tbllen);
+    wr->buf[wr->len + tbllen] = 0;
+    wr->len += tbllen + 1;
+    if (keylen)
+        memcpy(wr->buf + wr->len, key, keylen);
+    wr->len += keylen;
+}
+
+static int serial_check_write(bdb_state_type *bdb_state,
+                              struct serial_writes_buf *wr, DBT *table, int ix,
+                              void *key, int keylen, void *ranges)
+{
+    if (wr->on)
+        serial_writes_add(wr, table, ix, key, keylen);
+    return bdb_state->callback->serialcheck_rtn(table->data, ix, key, keylen,
+                                                ranges);
+}
+
+/* Run the range check over the writes recorded by serial_writes_add */
+static int serial_check_writes(bdb_state_type *bdb_state, uint8_t *data,
+                               int len, void *ranges)
+{
+    int off = 0, ix, keylen, tbllen, rc;
+
+    while (off < len) {
+        memcpy(&ix, data + off, sizeof(int));
+        memcpy(&keylen, data + off + sizeof(int), sizeof(int));
+        memcpy(&tbllen, data + off + 2 * sizeof(int), sizeof(int));
+        off += 3 * sizeof(int);
+        char *tbl = (char *)data + off;
+        off += tbllen + 1;
+        rc = bdb_state->callback->serialcheck_rtn(
+            tbl, ix, keylen ? data + off : NULL, keylen, ranges);
+        off += keylen;
+        if (rc)
+            return rc;
+    }
+    return 0;
+}
+
 int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
 {
+    DB_LSN txnlsn = lsn;
+    struct serial_writes_buf *wr = &serial_writes_tls;
+    uint8_t *cached;
+    int cachedlen;
+
+    if (gbl_serial_write_cache_kb > 0 &&
+        (cached = serial_writes_get(&txnlsn, &cachedlen)) != NULL) {
+        int rc = serial_check_writes(bdb_state, cached, cachedlen, ranges);
+        free(cached);
+        return rc;
+    }
+    wr->on = gbl_serial_write_cache_kb > 0;
+    wr->len = 0;
+
     int rc = 0;
     DBT logdta;
     DB_LSN undolsn;
@@ -105,8 +304,8 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             if (rc)
                 return rc;
             logp = add_dta;
-            rc = bdb_state->callback->serialcheck_rtn(add_dta->table.data, -2,
-                                                      NULL, 0, ranges);
+            rc = serial_check_write(bdb_state, wr, &add_dta->table, -2, NULL,
+                                    0, ranges);
             lsn = add_dta->prevllsn;
             break;
 
@@ -119,8 +318,8 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             undolsn = add_ix->prev_lsn;
             rc = bdb_reconstruct_add(bdb_state, &undolsn, key, add_ix->keylen,
                                      NULL, add_ix->dtalen, NULL, NULL);
-            rc = bdb_state->callback->serialcheck_rtn(
-                add_ix->table.data, add_ix->ix, key, add_ix->keylen, ranges);
+            rc = serial_check_write(bdb_state, wr, &add_ix->table, add_ix->ix,
+                                    key, add_ix->keylen, ranges);
             free(key);
             lsn = add_ix->prevllsn;
             break;
@@ -155,8 +354,8 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             if (rc)
                 return rc;
             logp = del_dta;
-            rc = bdb_state->callback->serialcheck_rtn(del_dta->table.data, -2,
-                                                      NULL, 0, ranges);
+            rc = serial_check_write(bdb_state, wr, &del_dta->table, -2, NULL,
+                                    0, ranges);
             lsn = del_dta->prevllsn;
             break;
 
@@ -170,8 +369,8 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             rc = bdb_reconstruct_delete(bdb_state, &undolsn, NULL, NULL, key,
                                         del_ix->keylen, NULL, del_ix->dtalen,
                                         NULL);
-            rc = bdb_state->callback->serialcheck_rtn(
-                del_ix->table.data, del_ix->ix, key, del_ix->keylen, ranges);
+            rc = serial_check_write(bdb_state, wr, &del_ix->table, del_ix->ix,
+                                    key, del_ix->keylen, ranges);
             free(key);
             lsn = del_ix->prevllsn;
             break;
@@ -182,8 +381,8 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             if (rc)
                 return rc;
             logp = upd_dta;
-            rc = bdb_state->callback->serialcheck_rtn(upd_dta->table.data, -2,
-                                                      NULL, 0, ranges);
+            rc = serial_check_write(bdb_state, wr, &upd_dta->table, -2, NULL,
+                                    0, ranges);
             lsn = upd_dta->prevllsn;
             break;
 
@@ -192,9 +391,8 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             if (rc)
                 return rc;
             logp = upd_ix;
-            rc = bdb_state->callback->serialcheck_rtn(
-                upd_ix->table.data, upd_ix->ix, upd_ix->key.data,
-                upd_ix->key.size, ranges);
+            rc = serial_check_write(bdb_state, wr, &upd_ix->table, upd_ix->ix,
+                                    upd_ix->key.data, upd_ix->key.size, ranges);
             lsn = upd_ix->prevllsn;
             break;
 
@@ -204,8 +402,8 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             if (rc)
                 return rc;
             logp = add_dta_lk;
-            rc = bdb_state->callback->serialcheck_rtn(add_dta_lk->table.data,
-                                                      -2, NULL, 0, ranges);
+            rc = serial_check_write(bdb_state, wr, &add_dta_lk->table, -2,
+                                    NULL, 0, ranges);
             lsn = add_dta_lk->prevllsn;
             break;
 
@@ -215,9 +413,9 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             if (rc)
                 return rc;
             logp = add_ix_lk;
-            rc = bdb_state->callback->serialcheck_rtn(
-                add_ix_lk->table.data, add_ix_lk->ix, add_ix_lk->key.data,
-                add_ix_lk->key.size, ranges);
+            rc = serial_check_write(bdb_state, wr, &add_ix_lk->table,
+                                    add_ix_lk->ix, add_ix_lk->key.data,
+                                    add_ix_lk->key.size, ranges);
             lsn = add_ix_lk->prevllsn;
             break;
 
@@ -227,8 +425,8 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             if (rc)
                 return rc;
             logp = del_dta_lk;
-            rc = bdb_state->callback->serialcheck_rtn(del_dta_lk->table.data,
-                                                      -2, NULL, 0, ranges);
+            rc = serial_check_write(bdb_state, wr, &del_dta_lk->table, -2,
+                                    NULL, 0, ranges);
             lsn = del_dta_lk->prevllsn;
             break;
 
@@ -243,9 +441,9 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             rc = bdb_reconstruct_delete(bdb_state, &undolsn, NULL, NULL, key,
                                         del_ix_lk->keylen, NULL,
                                         del_ix_lk->dtalen, NULL);
-            rc = bdb_state->callback->serialcheck_rtn(
-                del_ix_lk->table.data, del_ix_lk->ix, key, del_ix_lk->keylen,
-                ranges);
+            rc = serial_check_write(bdb_state, wr, &del_ix_lk->table,
+                                    del_ix_lk->ix, key, del_ix_lk->keylen,
+                                    ranges);
             free(key);
             lsn = del_ix_lk->prevllsn;
             break;
@@ -256,8 +454,8 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             if (rc)
                 return rc;
             logp = upd_dta_lk;
-            rc = bdb_state->callback->serialcheck_rtn(upd_dta_lk->table.data,
-                                                      -2, NULL, 0, ranges);
+            rc = serial_check_write(bdb_state, wr, &upd_dta_lk->table, -2,
+                                    NULL, 0, ranges);
             lsn = upd_dta_lk->prevllsn;
             break;
 
@@ -267,9 +465,9 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
             if (rc)
                 return rc;
             logp = upd_ix_lk;
-            rc = bdb_state->callback->serialcheck_rtn(
-                upd_ix_lk->table.data, upd_ix_lk->ix, upd_ix_lk->key.data,
-                upd_ix_lk->key.size, ranges);
+            rc = serial_check_write(bdb_state, wr, &upd_ix_lk->table,
+                                    upd_ix_lk->ix, upd_ix_lk->key.data,
+                                    upd_ix_lk->key.size, ranges);
             lsn = upd_ix_lk->prevllsn;
             break;
 
@@ -321,6 +519,10 @@ int serial_check_this_txn(bdb_state_type *bdb_state, DB_LSN lsn, void *ranges)
     }
 
     cur->close(cur, 0);
+
+    /* Only a complete walk describes the transaction */
+    if (wr->on)
+        serial_writes_put(&txnlsn, wr->buf, wr->len);
     return 0;
 }
 
@@ -17,6 +17,7 @@
 #include <alloca.h>
 
 #include <errno.h>
+#include <inttypes.h>
 #include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -146,10 +147,14 @@ struct temp_cursor {
     struct temp_list_node *list_cur;
     void *hash_cur;
     unsigned int hash_cur_buk;
+    struct hashobj *hash_probe; /* key of the last find, if keys repeat */
     LINKC_T(struct temp_cursor) lnk;
     int ind;
     int keymalloclen;
     int datamalloclen;
+    unsigned gen; /* tbl->gen when `ind' was last known to be right */
+    int ghost;    /* the item at the cursor was deleted; `ind' is where it
+                     would be */
 };
 
 typedef struct arr_elem {
@@ -159,6 +164,18 @@ typedef struct arr_elem {
     uint8_t *dta;
 } arr_elem_t;
 
+/* Key and data copies of a temparray are carved out of a list of arena
+   chunks rather than malloc'd one by one. Nothing is released until the
+   array is truncated, spilled or destroyed. */
+typedef struct arr_chunk {
+    struct arr_chunk *next;
+    size_t used;
+    size_t size;
+    uint8_t buf[1];
+} arr_chunk_t;
+
+#define TEMP_ARRAY_CHUNK_SZ (64 * 1024)
+
 #define COPY_KV_TO_CUR(c)                                                      \
     do {                                                                       \
         arr_elem_t *elem = &(c)->tbl->elements[(c)->ind];                      \
@@ -192,14 +209,42 @@ typedef struct arr_elem {
    or the in-memory data size exceeds a pre-configured cache size,
    a temparray will fall back to a temptable.
    A temparray is more efficient than a temptable. Besides, it uses far
-   less memory than a temptable for small and medium-sized requests. */
+   less memory than a temptable for small and medium-sized requests.
+
+   A memory temptable keeps the same sorted array, with btree semantics
+   (unique keys, cursors that survive inserts and deletes), in place of
+   a btree. It grows until the memory held by all such tables would go
+   past temptable_mem_budget_mb, and only then moves to a btree. */
 enum {
     TEMP_TABLE_TYPE_BTREE,
     TEMP_TABLE_TYPE_HASH,
     TEMP_TABLE_TYPE_LIST,
-    TEMP_TABLE_TYPE_ARRAY
+    TEMP_TABLE_TYPE_ARRAY,
+    TEMP_TABLE_TYPE_MEMORY
 };
 
+/* memory for all in-memory temptables, in MB; 0 puts every temptable
+   in a btree */
+int gbl_temptable_mem_budget_mb = 0;
+
+/* bytes of elements and arena held by temparrays and memory temptables */
+static int64_t temptable_mem_bytes;
+
+/* limits on the size of temptable btrees, in MB, for all of them together
+   and for those a query grows; 0 is no limit */
+int gbl_temptable_space_limit_mb = 0;
+int gbl_temptable_query_space_limit_mb = 0;
+
+/* btree inserts into a temptable between looks at its size */
+#define TEMP_SPACE_CHECK_PUTS 256
+
+/* bytes in temptable btree files, as of the last look at each */
+static int64_t temptable_space_bytes;
+
+/* growth of temptable btrees by this thread since
+   bdb_temp_table_begin_query() */
+static __thread int64_t temptable_query_bytes;
+
 struct temp_table {
     DB_ENV *dbenv_temp;
 
@@ -207,6 +252,11 @@ struct temp_table {
     DB *tmpdb; /* in-memory table */
     LISTC_T(struct temp_list_node) temp_tbl_list;
     hash_t *temp_hash_tbl;
+    /* hash temptables: hash and compare entries with these when set, and
+       keep every entry even if it compares equal to another one */
+    hashfunc_t *hashfn;
+    cmpfunc_t *hashcmpfn;
+    int hashkeysz;
 
     tmptbl_cmp cmpfunc;
     void *usermem;
@@ -223,6 +273,13 @@ struct temp_table {
     unsigned long long inmemsz;
     unsigned long long cachesz;
     arr_elem_t *elements;
+    int capacity;       /* slots in `elements' */
+    arr_chunk_t *arena; /* arena chunks of a temparray, newest first */
+    int64_t arenasz;    /* bytes in the arena chunks */
+    int64_t memcharged; /* bytes counted in temptable_mem_bytes */
+    unsigned gen;       /* bumped when elements of a memory temptable move */
+    int64_t spacecharged; /* bytes counted in temptable_space_bytes */
+    unsigned puts;        /* btree inserts, for TEMP_SPACE_CHECK_PUTS */
 };
 
 enum { TMPTBL_PRIORITY, TMPTBL_WAIT };
@@ -241,6 +298,13 @@ static int key_memcmp(void *usermem, int key1len, const void *key1, int key2len,
                       const void *key2);
 static int temp_table_compare(DB *db, const DBT *dbt1, const DBT *dbt2);
 
+static hash_t *temp_hash_create(struct temp_table *tbl)
+{
+    if (tbl->hashfn)
+        return hash_init_user(tbl->hashfn, tbl->hashcmpfn, 0, tbl->hashkeysz);
+    return hash_init_user(hashfunc, hashcmpfunc, 0, 0);
+}
+
 /* refactored both insert and put code paths here */
 static int bdb_temp_table_insert_put(bdb_state_type *, struct temp_table *,
                                      void *key, int keylen, void *data,
@@ -334,6 +398,115 @@ error:
     return rc;
 }
 
+static void temp_mem_charge(struct temp_table *tbl)
+{
+    int64_t sz = tbl->arenasz + (int64_t)tbl->capacity * sizeof(arr_elem_t);
+    if (sz != tbl->memcharged) {
+        ATOMIC_ADD64(temptable_mem_bytes, sz - tbl->memcharged);
+        tbl->memcharged = sz;
+    }
+}
+
+/* berkeley extension/kludge */
+extern long long __db_filesz(DB *dbp);
+
+void bdb_temp_table_begin_query(void)
+{
+    temptable_query_bytes = 0;
+}
+
+/* Called when the btree file of the table went away or was recreated */
+static void temp_space_discharge(struct temp_table *tbl)
+{
+    if (tbl->spacecharged) {
+        ATOMIC_ADD64(temptable_space_bytes, -tbl->spacecharged);
+        tbl->spacecharged = 0;
+    }
+}
+
+/* Take note of the size of the btree file of the table. Returns 1 if that
+   puts the node or this query over its temp space limit. */
+static int temp_space_check(struct temp_table *tbl)
+{
+    long long sz = __db_filesz(tbl->tmpdb);
+    int64_t delta = sz - tbl->spacecharged;
+    int64_t total;
+
+    if (delta) {
+        total = ATOMIC_ADD64(temptable_space_bytes, delta);
+        tbl->spacecharged = sz;
+        if (delta > 0)
+            temptable_query_bytes += delta;
+    } else {
+        total = ATOMIC_LOAD64(temptable_space_bytes);
+    }
+
+    if (gbl_temptable_space_limit_mb > 0 &&
+        total > (int64_t)gbl_temptable_space_limit_mb * 1024 * 1024) {
+        logmsg(LOGMSG_ERROR, "%s: temptables hold %" PRId64 " bytes, over "
+                             "temptable_space_limit_mb\n",
+               __func__, total);
+        return 1;
+    }
+    if (gbl_temptable_query_space_limit_mb > 0 &&
+        temptable_query_bytes >
+            (int64_t)gbl_temptable_query_space_limit_mb * 1024 * 1024) {
+        logmsg(LOGMSG_ERROR, "%s: query grew temptables by %" PRId64
+                             " bytes, over temptable_query_space_limit_mb\n",
+               __func__, temptable_query_bytes);
+        return 1;
+    }
+    return 0;
+}
+
+static uint8_t *temp_array_alloc(struct temp_table *tbl, size_t len)
+{
+    arr_chunk_t *chunk = tbl->arena;
+    size_t sz;
+
+    /* keep the copies aligned for the comparison functions */
+    len = (len + 7) & ~(size_t)7;
+
+    if (chunk == NULL || chunk->size - chunk->used < len) {
+        sz = len > TEMP_ARRAY_CHUNK_SZ ? len : TEMP_ARRAY_CHUNK_SZ;
+        chunk = malloc(offsetof(arr_chunk_t, buf) + sz);
+        if (chunk == NULL)
+            return NULL;
+        chunk->used = 0;
+        chunk->size = sz;
+        chunk->next = tbl->arena;
+        tbl->arena = chunk;
+        tbl->arenasz += offsetof(arr_chunk_t, buf) + sz;
+        temp_mem_charge(tbl);
+    }
+
+    chunk->used += len;
+    return chunk->buf + chunk->used - len;
+}
+
+/* Release the arena. If `keep' is set, the oldest chunk is retained (and
+   emptied) so that a pooled table doesn't go back to malloc on reuse. */
+static void temp_array_free_arena(struct temp_table *tbl, int keep)
+{
+    arr_chunk_t *chunk = tbl->arena, *next;
+
+    while (chunk != NULL) {
+        next = chunk->next;
+        if (next == NULL && keep && chunk->size == TEMP_ARRAY_CHUNK_SZ) {
+            chunk->used = 0;
+            tbl->arena = chunk;
+            tbl->arenasz = offsetof(arr_chunk_t, buf) + chunk->size;
+            temp_mem_charge(tbl);
+            return;
+        }
+        free(chunk);
+        chunk = next;
+    }
+    tbl->arena = NULL;
+    tbl->arenasz = 0;
+    temp_mem_charge(tbl);
+}
+
 static int bdb_array_copy_to_temp_db(bdb_state_type *bdb_state,
                                      struct temp_table *tbl, int *bdberr)
 {
@@ -366,10 +539,7 @@ static int bdb_array_copy_to_temp_db(bdb_state_type *bdb_state,
         }
     }
 
-    for (ii = 0; ii != nents; ++ii) {
-        elem = &tbl->elements[ii];
-        free(elem->key);
-    }
+    temp_array_free_arena(tbl, 0);
     tbl->inmemsz = 0;
     tbl->num_mem_entries = nents;
 
@@ -452,7 +622,7 @@ static int bdb_hash_table_copy_to_temp_db(bdb_state_type *bdb_state,
     }
     hash_clear(tbl->temp_hash_tbl);
     hash_free(tbl->temp_hash_tbl);
-    tbl->temp_hash_tbl = hash_init_user(hashfunc, hashcmpfunc, 0, 0);
+    tbl->temp_hash_tbl = temp_hash_create(tbl);
 
     /* its now a btree! */
     tbl->temp_table_type = TEMP_TABLE_TYPE_BTREE;
@@ -478,6 +648,196 @@ done:
     return rc;
 }
 
+/* Compare the element with a search key, like temp_table_compare() */
+static inline int temp_mem_cmp(struct temp_table *tbl, arr_elem_t *elem,
+                               const void *key, int keylen, void *unpacked)
+{
+    if (unpacked)
+        return tbl->cmpfunc(NULL, elem->keylen, elem->key, -1, unpacked);
+    return tbl->cmpfunc(tbl->usermem, elem->keylen, elem->key, keylen, key);
+}
+
+/* Position of the first element not less than `key'. Sets *found if it
+   is equal to `key'. */
+static int temp_mem_search(struct temp_table *tbl, const void *key,
+                           int keylen, void *unpacked, int *found)
+{
+    int lo = 0, hi = tbl->num_mem_entries - 1, mid, cmp;
+
+    *found = 0;
+    if (hi < 0)
+        return 0;
+
+    /* keys mostly arrive in order: try past the end first */
+    cmp = temp_mem_cmp(tbl, &tbl->elements[hi], key, keylen, unpacked);
+    if (cmp < 0)
+        return hi + 1;
+    if (cmp == 0) {
+        *found = 1;
+        return hi;
+    }
+
+    while (lo < hi) {
+        mid = (lo + hi) >> 1;
+        cmp = temp_mem_cmp(tbl, &tbl->elements[mid], key, keylen, unpacked);
+        if (cmp < 0)
+            lo = mid + 1;
+        else if (cmp > 0)
+            hi = mid;
+        else {
+            *found = 1;
+            return mid;
+        }
+    }
+    *found = (temp_mem_cmp(tbl, &tbl->elements[lo], key, keylen, unpacked) == 0);
+    return lo;
+}
+
+/* Make room for an element (if `newelem' is set) and `len' bytes of
+   arena. Returns 1 if that would go over the memory budget. */
+static int temp_mem_reserve(struct temp_table *tbl, size_t len, int newelem)
+{
+    arr_chunk_t *chunk = tbl->arena;
+    arr_elem_t *elements;
+    int64_t need = 0;
+    int cap = 0;
+
+    len = (len + 7) & ~(size_t)7;
+    if (chunk == NULL || chunk->size - chunk->used < len)
+        need += offsetof(arr_chunk_t, buf) +
+                (len > TEMP_ARRAY_CHUNK_SZ ? len : TEMP_ARRAY_CHUNK_SZ);
+    if (newelem && tbl->num_mem_entries == tbl->capacity) {
+        cap = tbl->capacity ? tbl->capacity * 2 : 64;
+        need += (int64_t)(cap - tbl->capacity) * sizeof(arr_elem_t);
+    }
+
+    if (need && ATOMIC_LOAD64(temptable_mem_bytes) + need >
+                    (int64_t)gbl_temptable_mem_budget_mb * 1024 * 1024)
+        return 1;
+
+    if (cap) {
+        elements = realloc(tbl->elements, cap * sizeof(arr_elem_t));
+        if (elements == NULL)
+            return 1;
+        tbl->elements = elements;
+        tbl->capacity = cap;
+        temp_mem_charge(tbl);
+    }
+    return 0;
+}
+
+/* Don't keep a large element array around once it's no longer needed */
+static void temp_mem_trim(struct temp_table *tbl)
+{
+    if (tbl->capacity > tbl->max_mem_entries) {
+        free(tbl->elements);
+        tbl->elements = NULL;
+        tbl->capacity = 0;
+        temp_mem_charge(tbl);
+    }
+}
+
+/* Bring the position of a cursor up to date after elements moved */
+static void temp_mem_sync(struct temp_cursor *cur)
+{
+    int found;
+
+    if (cur->gen == cur->tbl->gen)
+        return;
+    cur->gen = cur->tbl->gen;
+    if (!cur->valid)
+        return;
+    cur->ind = temp_mem_search(cur->tbl, cur->key, cur->keylen, NULL, &found);
+    cur->ghost = !found;
+}
+
+static int temp_mem_copy_to_cur(struct temp_cursor *cur)
+{
+    COPY_KV_TO_CUR(cur);
+    cur->ghost = 0;
+    cur->gen = cur->tbl->gen;
+    return 0;
+}
+
+/* Move a memory temptable to a btree, keeping where its cursors are */
+static int bdb_mem_copy_to_temp_db(bdb_state_type *bdb_state,
+                                   struct temp_table *tbl, int *bdberr)
+{
+    int rc = 0, ii;
+    DBT dbt_key, dbt_data;
+    struct temp_cursor *cur;
+    arr_elem_t *elem;
+    unsigned long long nents = tbl->num_mem_entries;
+    unsigned long long rowid = tbl->rowid;
+    char dumbuf;
+
+    if (tbl->dbenv_temp == NULL &&
+        (rc = create_temp_db_env(bdb_state, tbl, bdberr)) != 0)
+        return rc;
+
+    bzero(&dbt_key, sizeof(DBT));
+    bzero(&dbt_data, sizeof(DBT));
+    for (ii = 0; ii != nents; ++ii) {
+        elem = &tbl->elements[ii];
+        dbt_key.flags = dbt_data.flags = DB_DBT_USERMEM;
+        dbt_key.ulen = dbt_key.size = elem->keylen;
+        dbt_data.ulen = dbt_data.size = elem->dtalen;
+        dbt_data.data = elem->dta;
+        dbt_key.data = elem->key;
+
+        rc = tbl->tmpdb->put(tbl->tmpdb, NULL, &dbt_key, &dbt_data, 0);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s:%d put rc %d\n", __FILE__, __LINE__, rc);
+            return rc;
+        }
+    }
+
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        rc = tbl->tmpdb->cursor(tbl->tmpdb, NULL, &cur->cur, 0);
+        if (rc) {
+            cur->cur = NULL;
+            logmsg(LOGMSG_ERROR, "%s:%d cursor rc %d\n", __FILE__, __LINE__,
+                   rc);
+            return rc;
+        }
+        if (!cur->valid)
+            continue;
+        temp_mem_sync(cur);
+
+        /* put the btree cursor where the next and prev would go from; a
+           deleted item is put back and deleted again under the cursor */
+        bzero(&dbt_key, sizeof(DBT));
+        bzero(&dbt_data, sizeof(DBT));
+        dbt_key.data = cur->key;
+        dbt_key.size = cur->keylen;
+        if (!cur->ghost) {
+            dbt_data.data = &dumbuf;
+            dbt_data.ulen = 1;
+            dbt_data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+            rc = cur->cur->c_get(cur->cur, &dbt_key, &dbt_data, DB_SET);
+        } else {
+            rc = cur->cur->c_put(cur->cur, &dbt_key, &dbt_data, DB_KEYFIRST);
+            if (rc == 0)
+                rc = cur->cur->c_del(cur->cur, 0);
+        }
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s:%d reposition rc %d\n", __FILE__,
+                   __LINE__, rc);
+            cur->valid = 0;
+            return rc;
+        }
+    }
+
+    temp_array_free_arena(tbl, 0);
+    temp_mem_trim(tbl);
+    tbl->inmemsz = 0;
+    tbl->num_mem_entries = nents;
+    tbl->rowid = rowid;
+    tbl->temp_table_type = TEMP_TABLE_TYPE_BTREE;
+    return 0;
+}
+
 static void bdb_temp_table_reset(struct temp_table *tbl)
 {
     tbl->rowid = 0;
@@ -542,6 +902,7 @@ static int bdb_temp_table_init_temp_db(bdb_state_type *bdb_state,
     }
 
     tbl->tmpdb = db;
+    temp_space_discharge(tbl);
 
     bdb_temp_table_reset(tbl);
 
@@ -563,6 +924,7 @@ static int bdb_temp_table_env_close(bdb_state_type *bdb_state,
         }
         tbl->tmpdb = NULL;
     }
+    temp_space_discharge(tbl);
     rc = tbl->dbenv_temp->close(tbl->dbenv_temp, 0);
     if (rc) {
         logmsg(LOGMSG_ERROR, "%s: failed to close dbenv_temp rc=%d\n", __func__, rc);
@@ -768,6 +1130,10 @@ static struct temp_table *bdb_temp_table_create_type(bdb_state_type *bdb_state,
     }
 
     if (table != NULL) {
+        if (temp_table_type == TEMP_TABLE_TYPE_BTREE &&
+            gbl_temptable_mem_budget_mb > 0)
+            temp_table_type = TEMP_TABLE_TYPE_MEMORY;
+
         switch (temp_table_type) {
         case TEMP_TABLE_TYPE_BTREE:
             if (table->dbenv_temp == NULL) {
@@ -779,7 +1145,7 @@ static struct temp_table *bdb_temp_table_create_type(bdb_state_type *bdb_state,
             break;
         case TEMP_TABLE_TYPE_HASH:
             if (table->temp_hash_tbl == NULL) {
-                table->temp_hash_tbl = hash_init_user(hashfunc, hashcmpfunc, 0, 0);
+                table->temp_hash_tbl = temp_hash_create(table);
                 if (table->temp_hash_tbl == NULL) {
                     bdb_temp_table_destroy_pool_wrapper(table, bdb_state);
                     return NULL;
@@ -790,14 +1156,21 @@ static struct temp_table *bdb_temp_table_create_type(bdb_state_type *bdb_state,
             listc_init(&table->temp_tbl_list, offsetof(struct temp_list_node, lnk));
             break;
         case TEMP_TABLE_TYPE_ARRAY:
-            if (table->elements == NULL) {
-                table->elements = calloc(table->max_mem_entries, sizeof(arr_elem_t));
-                if (table->elements == NULL) {
+            if (table->capacity < table->max_mem_entries) {
+                arr_elem_t *elements = realloc(
+                    table->elements, table->max_mem_entries * sizeof(arr_elem_t));
+                if (elements == NULL) {
                     bdb_temp_table_destroy_pool_wrapper(table, bdb_state);
                     return NULL;
                 }
+                table->elements = elements;
+                table->capacity = table->max_mem_entries;
+                temp_mem_charge(table);
             }
             break;
+        case TEMP_TABLE_TYPE_MEMORY:
+            /* elements and the arena are allocated on the first insert */
+            break;
         }
 
         table->num_mem_entries = 0;
@@ -871,6 +1244,11 @@ struct temp_cursor *bdb_temp_table_cursor(bdb_state_type *bdb_state,
     case TEMP_TABLE_TYPE_ARRAY:
         cur->ind = 0;
         break;
+
+    case TEMP_TABLE_TYPE_MEMORY:
+        cur->ind = 0;
+        cur->gen = tbl->gen;
+        break;
     }
 
     if (rc) {
@@ -905,6 +1283,14 @@ int bdb_temp_table_insert(bdb_state_type *bdb_state, struct temp_cursor *cur,
 
     int rc = bdb_temp_table_insert_put(bdb_state, tbl, key, keylen, data,
                                        dtalen, bdberr);
+    if (rc == 0 && tbl->temp_table_type == TEMP_TABLE_TYPE_MEMORY &&
+        cur->valid) {
+        /* like a btree cursor, move onto the new item */
+        int found;
+        cur->ind = temp_mem_search(tbl, key, keylen, NULL, &found);
+        rc = temp_mem_copy_to_cur(cur);
+        goto done;
+    }
     if (rc <= 0)
         goto done;
 
@@ -944,28 +1330,55 @@ int bdb_temp_table_update(bdb_state_type *bdb_state, struct temp_cursor *cur,
     uint8_t *keycopy, *dtacopy;
 
     if (cur->tbl->temp_table_type != TEMP_TABLE_TYPE_BTREE &&
-        cur->tbl->temp_table_type != TEMP_TABLE_TYPE_ARRAY) {
+        cur->tbl->temp_table_type != TEMP_TABLE_TYPE_ARRAY &&
+        cur->tbl->temp_table_type != TEMP_TABLE_TYPE_MEMORY) {
         logmsg(LOGMSG_ERROR, "bdb_temp_table_update operation "
                              "only supported for btree or array.\n");
         return -1;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEMORY) {
+        if (!cur->valid)
+            return -1;
+        temp_mem_sync(cur);
+        if (cur->ghost)
+            return -1;
+        /* the key is the same, so only the data changes */
+        rc = bdb_temp_table_insert_put(bdb_state, cur->tbl,
+                                       cur->tbl->elements[cur->ind].key,
+                                       cur->tbl->elements[cur->ind].keylen,
+                                       data, dtalen, bdberr);
+        if (rc < 0)
+            return rc;
+        if (rc == 0)
+            goto done;
+    }
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
         if (!cur->valid)
             return -1;
 
-        /* Free the existing elements and update the memory footprint. */
+        /* Update the memory footprint. The old copy stays in the arena
+           unless the new one fits in its place. */
         elem = &cur->tbl->elements[cur->ind];
-        free(elem->key);
         cur->tbl->inmemsz -= (elem->keylen + elem->dtalen);
 
-        /* malloc and copy */
-        keycopy = malloc(keylen + dtalen);
+        if (keylen + dtalen <= elem->keylen + elem->dtalen)
+            keycopy = elem->key;
+        else
+            keycopy = temp_array_alloc(cur->tbl, keylen + dtalen);
         if (keycopy == NULL)
             return -1;
         dtacopy = keycopy + keylen;
-        memcpy(keycopy, key, keylen);
-        memcpy(dtacopy, data, dtalen);
+        /* key and data may point into the element we overwrite: when the
+           key grows, the data moves right and has to go first */
+        if (keylen > elem->keylen) {
+            memmove(dtacopy, data, dtalen);
+            memmove(keycopy, key, keylen);
+        } else {
+            memmove(keycopy, key, keylen);
+            memmove(dtacopy, data, dtalen);
+        }
 
         /* Update the element and the memory footprint. */
         elem->keylen = keylen;
@@ -997,6 +1410,7 @@ int bdb_temp_table_update(bdb_state_type *bdb_state, struct temp_cursor *cur,
         rc = -1;
     }
 
+done:
     dbghexdump(3, key, keylen);
     dbgtrace(3, "temp_table_update(cursor %d) = %d\n", cur->curid, rc);
     return rc;
@@ -1022,6 +1436,7 @@ unsigned long long bdb_temp_table_new_rowid(struct temp_table *tbl)
         }
         break;
     case TEMP_TABLE_TYPE_ARRAY:
+    case TEMP_TABLE_TYPE_MEMORY:
         if (tbl->num_mem_entries == 0)
             tbl->rowid = 0;
         break;
@@ -1096,6 +1511,8 @@ static int bdb_temp_table_first_last(bdb_state_type *bdb_state,
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASH) {
         cur->valid = 0;
         char *data;
+        free(cur->hash_probe);
+        cur->hash_probe = NULL;
         if (how != DB_FIRST) {
             logmsg(LOGMSG_ERROR, "bdb_temp_table_first_last operation not supported "
                             "for temp list.\n");
@@ -1129,6 +1546,17 @@ static int bdb_temp_table_first_last(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEMORY) {
+        arrlen = cur->tbl->num_mem_entries;
+        if (arrlen == 0) {
+            cur->valid = 0;
+            return IX_EMPTY;
+        }
+
+        cur->ind = (how == DB_LAST) ? (arrlen - 1) : 0;
+        return temp_mem_copy_to_cur(cur);
+    }
+
     REOPEN_CURSOR(cur);
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
@@ -1200,8 +1628,13 @@ static int bdb_temp_table_next_prev_norewind(bdb_state_type *bdb_state,
                             "for temp list.\n");
             return -1;
         }
-        char *data = hash_next(cur->tbl->temp_hash_tbl, &cur->hash_cur,
-                               &cur->hash_cur_buk);
+        char *data;
+        if (cur->hash_probe)
+            data = hash_find_next(cur->tbl->temp_hash_tbl, cur->hash_probe,
+                                  &cur->hash_cur);
+        else
+            data = hash_next(cur->tbl->temp_hash_tbl, &cur->hash_cur,
+                             &cur->hash_cur_buk);
         if (data) {
             cur->keylen = *(int *)data;
             cur->key = data + sizeof(int);
@@ -1226,6 +1659,21 @@ static int bdb_temp_table_next_prev_norewind(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEMORY) {
+        cur->valid = 1;
+        temp_mem_sync(cur);
+        cur->valid = 0;
+        /* from a deleted item, the next one is already at `ind' */
+        if (how == DB_NEXT && !cur->ghost)
+            ++cur->ind;
+        else if (how == DB_PREV)
+            --cur->ind;
+        if (cur->ind < 0 || cur->ind >= cur->tbl->num_mem_entries)
+            return IX_PASTEOF;
+
+        return temp_mem_copy_to_cur(cur);
+    }
+
     REOPEN_CURSOR(cur);
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
@@ -1403,9 +1851,6 @@ done:
     return rc;
 }
 
-/* berkeley extension/kludge */
-extern long long __db_filesz(DB *dbp);
-
 static int bdb_temp_table_truncate_temp_db(bdb_state_type *bdb_state,
                                            struct temp_table *tbl, int *bdberr)
 {
@@ -1450,8 +1895,7 @@ int bdb_temp_table_truncate(bdb_state_type *bdb_state, struct temp_table *tbl,
 {
     if (tbl == NULL)
         return 0;
-    int rc = 0, ii = 0;
-    arr_elem_t *elem;
+    int rc = 0;
 
     switch (tbl->temp_table_type) {
     case TEMP_TABLE_TYPE_LIST: {
@@ -1480,22 +1924,29 @@ int bdb_temp_table_truncate(bdb_state_type *bdb_state, struct temp_table *tbl,
             }
             hash_clear(tbl->temp_hash_tbl);
             hash_free(tbl->temp_hash_tbl);
-            tbl->temp_hash_tbl = hash_init_user(hashfunc, hashcmpfunc, 0, 0);
+            tbl->temp_hash_tbl = temp_hash_create(tbl);
         }
         break;
 
     case TEMP_TABLE_TYPE_ARRAY:
-        for (; ii != tbl->num_mem_entries; ++ii) {
-            elem = &tbl->elements[ii];
-            free(elem->key);
-        }
+        temp_array_free_arena(tbl, 1);
         tbl->inmemsz = 0;
         tbl->num_mem_entries = 0;
         break;
 
+    case TEMP_TABLE_TYPE_MEMORY:
+        temp_array_free_arena(tbl, 1);
+        temp_mem_trim(tbl);
+        tbl->inmemsz = 0;
+        tbl->num_mem_entries = 0;
+        ++tbl->gen;
+        break;
+
     case TEMP_TABLE_TYPE_BTREE:
 
-        if (tbl->num_mem_entries < 100)
+        /* a pooled table doesn't hold on to a file that outgrew its cache */
+        if (tbl->num_mem_entries < 100 &&
+            __db_filesz(tbl->tmpdb) <= tbl->cachesz)
             rc = bdb_temp_table_truncate_temp_db(bdb_state, tbl, bdberr);
         else
             rc = bdb_temp_table_init_temp_db(bdb_state, tbl, bdberr);
@@ -1606,6 +2057,16 @@ int bdb_temp_table_close(bdb_state_type *bdb_state, struct temp_table *tbl,
         Pthread_mutex_unlock(&(bdb_state->temp_list_lock));
     }
 
+    if (tbl->hashfn) {
+        tbl->hashfn = NULL;
+        tbl->hashcmpfn = NULL;
+        tbl->hashkeysz = 0;
+        if (tbl->temp_hash_tbl) {
+            hash_free(tbl->temp_hash_tbl);
+            tbl->temp_hash_tbl = temp_hash_create(tbl);
+        }
+    }
+
     bdb_temp_table_reset(tbl);
 
     if (gbl_temptable_pool_capacity > 0) {
@@ -1627,8 +2088,7 @@ int bdb_temp_table_destroy_lru(struct temp_table *tbl,
                                int *bdberr)
 {
     DB_MPOOL_STAT *tmp;
-    int rc, ii;
-    arr_elem_t *elem;
+    int rc;
 
     rc = 0;
 
@@ -1727,19 +2187,18 @@ int bdb_temp_table_destroy_lru(struct temp_table *tbl,
     } break;
 
     case TEMP_TABLE_TYPE_ARRAY:
-        for (ii = 0; ii != tbl->num_mem_entries; ++ii) {
-            elem = &tbl->elements[ii];
-            free(elem->key);
-        }
-        break;
-
+    case TEMP_TABLE_TYPE_MEMORY:
     case TEMP_TABLE_TYPE_BTREE:
         break;
     }
 
     if (tbl->temp_hash_tbl != NULL)
         hash_free(tbl->temp_hash_tbl);
+    temp_array_free_arena(tbl, 0);
     free(tbl->elements);
+    tbl->elements = NULL;
+    tbl->capacity = 0;
+    temp_mem_charge(tbl);
 
     /* close the environments*/
     if (tbl->dbenv_temp != NULL)
@@ -1798,7 +2257,6 @@ int bdb_temp_table_delete(bdb_state_type *bdb_state, struct temp_cursor *cur,
 
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
         elem = &cur->tbl->elements[cur->ind];
-        free(elem->key);
         --cur->tbl->num_mem_entries;
         cur->tbl->inmemsz -= (elem->keylen + elem->dtalen);
         memmove(elem, elem + 1,
@@ -1807,6 +2265,24 @@ int bdb_temp_table_delete(bdb_state_type *bdb_state, struct temp_cursor *cur,
         goto done;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEMORY) {
+        temp_mem_sync(cur);
+        if (cur->ghost) {
+            rc = -1;
+            goto done;
+        }
+        elem = &cur->tbl->elements[cur->ind];
+        --cur->tbl->num_mem_entries;
+        cur->tbl->inmemsz -= (elem->keylen + elem->dtalen);
+        memmove(elem, elem + 1,
+                sizeof(arr_elem_t) * (cur->tbl->num_mem_entries - cur->ind));
+        /* like a btree cursor, stay on the deleted item */
+        cur->ghost = 1;
+        cur->gen = ++cur->tbl->gen;
+        rc = 0;
+        goto done;
+    }
+
     REOPEN_CURSOR(cur);
 
     rc = cur->cur->c_del(cur->cur, 0);
@@ -1871,7 +2347,26 @@ static int bdb_temp_table_find_hash(struct temp_cursor *cur, const void *key, in
             o->len = keylen;
             memcpy(o->data, key, keylen);
 
-            data = hash_find(cur->tbl->temp_hash_tbl, o);
+            if (cur->tbl->hashfn) {
+                /* keys repeat: remember the probe so that next can visit
+                   the other matches, and never settle for a mismatch */
+                free(cur->hash_probe);
+                cur->hash_probe = should_free ? o : malloc(keylen + sizeof(int));
+                if (cur->hash_probe == NULL) {
+                    if (should_free)
+                        free(o);
+                    return -1;
+                }
+                if (!should_free)
+                    memcpy(cur->hash_probe, o, keylen + sizeof(int));
+                data = hash_find_first(cur->tbl->temp_hash_tbl, cur->hash_probe,
+                                       &cur->hash_cur);
+                if (!data)
+                    return IX_PASTEOF;
+                should_free = 0;
+            } else {
+                data = hash_find(cur->tbl->temp_hash_tbl, o);
+            }
             if (should_free)
                 free(o);
         }
@@ -1955,6 +2450,18 @@ int bdb_temp_table_find(bdb_state_type *bdb_state, struct temp_cursor *cur,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEMORY) {
+        /* the smallest key not less than `key', else the last one */
+        if (cur->tbl->num_mem_entries == 0) {
+            cur->valid = 0;
+            return IX_EMPTY;
+        }
+        cur->ind = temp_mem_search(cur->tbl, key, keylen, unpacked, &found);
+        if (cur->ind == cur->tbl->num_mem_entries)
+            --cur->ind;
+        return temp_mem_copy_to_cur(cur);
+    }
+
     REOPEN_CURSOR(cur);
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
@@ -2107,6 +2614,17 @@ int bdb_temp_table_find_exact(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEMORY) {
+        cur->ind = temp_mem_search(cur->tbl, key, keylen, NULL, &found);
+        if (!found) {
+            cur->valid = 0;
+            return IX_NOTFND;
+        }
+        if (temp_mem_copy_to_cur(cur))
+            return -1;
+        return IX_FND;
+    }
+
     REOPEN_CURSOR(cur);
 
     /* Make a copy of the user key */
@@ -2187,7 +2705,8 @@ static int bdb_temp_table_reset_cursor(bdb_state_type *bdb_state, struct temp_cu
     tbl = cur->tbl;
 
     if (tbl->temp_table_type == TEMP_TABLE_TYPE_BTREE ||
-        tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
+        tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY ||
+        tbl->temp_table_type == TEMP_TABLE_TYPE_MEMORY) {
         if (cur->key) {
             free(cur->key);
             cur->key = NULL;
@@ -2220,6 +2739,7 @@ int bdb_temp_table_close_cursor(bdb_state_type *bdb_state, struct temp_cursor *c
 
     listc_rfl(&tbl->cursors, cur);
     rc = bdb_temp_table_reset_cursor(bdb_state, cur, bdberr);
+    free(cur->hash_probe);
     free(cur);
 
     return rc;
@@ -2299,6 +2819,26 @@ inline int bdb_is_hashtable(struct temp_table *tt)
     return (tt->temp_table_type == TEMP_TABLE_TYPE_HASH);
 }
 
+int bdb_temp_hashtable_set_hash(struct temp_table *tbl, hashfunc_t *hashfn,
+                                cmpfunc_t *cmpfn, int keysz)
+{
+    hash_t *h;
+
+    if (tbl->temp_table_type != TEMP_TABLE_TYPE_HASH ||
+        tbl->num_mem_entries != 0)
+        return -1;
+
+    tbl->hashfn = hashfn;
+    tbl->hashcmpfn = cmpfn;
+    tbl->hashkeysz = keysz;
+    if ((h = temp_hash_create(tbl)) == NULL)
+        return -1;
+    if (tbl->temp_hash_tbl)
+        hash_free(tbl->temp_hash_tbl);
+    tbl->temp_hash_tbl = h;
+    return 0;
+}
+
 int bdb_temp_table_maybe_set_priority_thread(bdb_state_type *bdb_state)
 {
     int rc = TMPTBL_WAIT;
@@ -2365,7 +2905,7 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
                                      int keylen, void *data, int dtalen,
                                      int *bdberr)
 {
-    int rc, cmp, lo, hi, mid;
+    int rc, cmp, lo, hi, mid, found;
     tmptbl_cmp cmpfn;
     arr_elem_t *elem;
     uint8_t *keycopy, *dtacopy;
@@ -2387,7 +2927,7 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
         hash_data = malloc(keylen + dtalen + 2 * sizeof(int));
         memcpy(hash_data, &keylen, sizeof(int));
         memcpy((uint8_t *)hash_data + sizeof(int), key, keylen);
-        old = hash_find(tbl->temp_hash_tbl, hash_data);
+        old = tbl->hashfn ? NULL : hash_find(tbl->temp_hash_tbl, hash_data);
 
         if (old == NULL) {
             memcpy((uint8_t *)hash_data + keylen + sizeof(int), &dtalen,
@@ -2417,7 +2957,7 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
            If 1 or more elements of the same key already exist,
            insert it after the last one of those elements. */
 
-        keycopy = malloc(keylen + dtalen);
+        keycopy = temp_array_alloc(tbl, keylen + dtalen);
         if (keycopy == NULL)
             return -1;
         dtacopy = keycopy + keylen;
@@ -2426,9 +2966,13 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
 
         lo = 0;
         hi = tbl->num_mem_entries - 1;
-        if (hi >= 0) {
-            cmpfn = tbl->cmpfunc;
-
+        cmpfn = tbl->cmpfunc;
+        /* Keys mostly arrive in order (e.g. a bplog is keyed by sequence
+           number): check the tail first and append without searching. */
+        if (hi >= 0 && cmpfn(NULL, tbl->elements[hi].keylen,
+                             tbl->elements[hi].key, keylen, key) <= 0) {
+            lo = hi + 1;
+        } else if (hi >= 0) {
             while (lo <= hi) {
                 mid = (lo + hi) >> 1;
                 elem = &tbl->elements[mid];
@@ -2468,9 +3012,69 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (tbl->temp_table_type == TEMP_TABLE_TYPE_MEMORY) {
+        /* btree semantics: a key that is already there gets the new data */
+        lo = temp_mem_search(tbl, key, keylen, NULL, &found);
+        if (found) {
+            elem = &tbl->elements[lo];
+            if (dtalen <= elem->dtalen) {
+                dtacopy = elem->dta;
+            } else if (temp_mem_reserve(tbl, dtalen, 0) == 0) {
+                dtacopy = temp_array_alloc(tbl, dtalen);
+            } else {
+                goto spill;
+            }
+            if (dtacopy == NULL)
+                return -1;
+            memcpy(dtacopy, data, dtalen);
+            tbl->inmemsz += dtalen - elem->dtalen;
+            elem->dta = dtacopy;
+            elem->dtalen = dtalen;
+            return 0;
+        }
+
+        if (temp_mem_reserve(tbl, keylen + dtalen, 1))
+            goto spill;
+        keycopy = temp_array_alloc(tbl, keylen + dtalen);
+        if (keycopy == NULL)
+            return -1;
+        dtacopy = keycopy + keylen;
+        memcpy(keycopy, key, keylen);
+        memcpy(dtacopy, data, dtalen);
+
+        elem = &tbl->elements[lo];
+        if (lo < tbl->num_mem_entries) {
+            memmove(elem + 1, elem,
+                    sizeof(arr_elem_t) * (tbl->num_mem_entries - lo));
+            ++tbl->gen;
+        }
+        elem->keylen = keylen;
+        elem->key = keycopy;
+        elem->dtalen = dtalen;
+        elem->dta = dtacopy;
+
+        ++tbl->num_mem_entries;
+        tbl->inmemsz += (keylen + dtalen);
+        return 0;
+
+    spill:
+        gbl_temptable_spills++;
+        rc = bdb_mem_copy_to_temp_db(bdb_state, tbl, bdberr);
+        if (unlikely(rc)) {
+            return -1;
+        }
+    }
+
     assert (tbl->temp_table_type == TEMP_TABLE_TYPE_BTREE);
     tbl->num_mem_entries++;
 
+    if ((gbl_temptable_space_limit_mb > 0 ||
+         gbl_temptable_query_space_limit_mb > 0) &&
+        ++tbl->puts % TEMP_SPACE_CHECK_PUTS == 0 && temp_space_check(tbl)) {
+        *bdberr = BDBERR_TEMPTABLE_FULL;
+        return -1;
+    }
+
     return 1;
 }
 
@@ -2484,7 +3088,9 @@ inline const char *bdb_temp_table_filename(struct temp_table *tbl)
 inline void bdb_temp_table_flush(struct temp_table *tbl)
 {
     DB *db = tbl->tmpdb;
-    db->sync(db, 0);
+    /* nothing to flush for a temptable that is still in memory */
+    if (db && tbl->temp_table_type == TEMP_TABLE_TYPE_BTREE)
+        db->sync(db, 0);
 }
 
 int bdb_temp_table_stat(bdb_state_type *bdb_state, DB_MPOOL_STAT **gspp)
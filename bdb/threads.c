@@ -353,6 +353,33 @@ int gbl_checkpoint_count;
 int gbl_cache_flush_interval = 30;
 int backend_opened(void);
 
+static int cache_load_done;
+
+/* Fault the saved pagelist back into the bufferpool.  This runs on its own
+ * thread so that a large cache doesn't hold up checkpoints while it loads. */
+static void *load_cache_thread(void *arg)
+{
+    bdb_state_type *bdb_state = arg;
+    int start, rc;
+
+    thrman_register(THRTYPE_GENERIC);
+    thread_started("bdb load cache");
+    bdb_thread_event(bdb_state, 1);
+
+    start = comdb2_time_epochms();
+    BDB_READLOCK("load_cache_thread");
+    rc = bdb_state->dbenv->memp_load_default(bdb_state->dbenv);
+    BDB_RELLOCK();
+    if (rc == 0)
+        logmsg(LOGMSG_INFO, "loaded saved pagelist in %d ms\n",
+               comdb2_time_epochms() - start);
+
+    bdb_thread_event(bdb_state, 0);
+    /* the pagelist may be rewritten from the cache now */
+    XCHANGE32(cache_load_done, 1);
+    return NULL;
+}
+
 void *checkpoint_thread(void *arg)
 {
     int rc, now;
@@ -417,13 +444,16 @@ void *checkpoint_thread(void *arg)
         }
 
         /* This is spawned before we open tables- don't repopulate the
-         * cache until the backend has opened */
-        if ((gbl_cache_flush_interval > 0) &&
+         * cache until the backend has opened, and don't overwrite the
+         * saved pagelist until it has been loaded */
+        if ((gbl_cache_flush_interval > 0) && backend_opened() &&
             ((now = time(NULL)) - last_cache_dump) > gbl_cache_flush_interval) {
             if (!loaded_cache) {
-                bdb_state->dbenv->memp_load_default(bdb_state->dbenv);
+                pthread_t tid;
+                Pthread_create(&tid, &gbl_pthread_attr_detached,
+                               load_cache_thread, bdb_state);
                 loaded_cache = 1;
-            } else {
+            } else if (ATOMIC_LOAD32(cache_load_done)) {
                 bdb_state->dbenv->memp_dump_default(bdb_state->dbenv, 0);
                 last_cache_dump = now;
             }
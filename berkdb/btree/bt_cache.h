@@ -2,9 +2,12 @@
 #define INCLUDE_BT_CACHE_H
 
 struct __db;
-int rcache_find(struct __db *, void **cached_pg, void **bfpool_pg,
-	uint16_t * gen, uint32_t * slot);
-int rcache_save(struct __db *, void *page, uint16_t gen);
+/* The most levels of a btree a descent will take from the cache */
+#define RCACHE_MAX_LEVELS 8
+
+int rcache_find(struct __db *, uint32_t pgno, void **cached_pg,
+	void **bfpool_pg, uint16_t * gen, uint32_t * slot);
+int rcache_save(struct __db *, uint32_t pgno, void *page, uint16_t gen);
 void rcache_invalidate(uint32_t slot);
 
 #define GET_BH_GEN(pg) (*(uint16_t *)((uint8_t *)pg - (offsetof(BH, buf) - offsetof(BH, generation))))
@@ -73,6 +73,7 @@ extern int gbl_disable_overflow_page_trace;
 #endif
 
 int gbl_skip_cget_in_db_put = 1;
+int gbl_bt_near_append = 1;
 __thread DB *prefault_dbp = NULL;
 
 /*
@@ -3781,7 +3782,7 @@ __bam_c_search(dbc, root_pgno, key, flags, exactp)
 	BTREE_CURSOR *cp;
 	DB *dbp;
 	PAGE *h;
-	db_indx_t indx, *inp;
+	db_indx_t base, indx, lim, *inp;
 	db_pgno_t bt_lpgno;
 	db_recno_t recno;
 	u_int32_t sflags;
@@ -3890,7 +3891,7 @@ fast_search:	/*
 				return (ret);
 
 			if (cmp < 0)
-				goto try_begin;
+				goto try_near;
 			if (cmp > 0) {
 				indx += P_INDX;
 				goto fast_hit;
@@ -3909,6 +3910,47 @@ fast_search:	/*
 			    indx > 0 && inp[indx - P_INDX] == inp[indx];
 			    indx -= P_INDX);
 			goto fast_hit;
+
+			/*
+			 * A key that sorts within the last page belongs on it
+			 * too, as everything left of it sorts before its first
+			 * key.  Nearly ordered keys, such as the genids of
+			 * concurrent transactions, land here.
+			 */
+try_near:		if (!gbl_bt_near_append || NUM_ENT(h) == P_INDX)
+				goto try_begin;
+			if ((ret = __bam_cmp(dbp,
+			    key, h, 0, t->bt_compare, &cmp)) != 0)
+				return (ret);
+			if (cmp < 0)
+				goto try_begin;
+			for (base = 0, lim = NUM_ENT(h) / P_INDX; lim != 0;
+			    lim >>= 1) {
+				indx = base + ((lim >> 1) * P_INDX);
+				if ((ret = __bam_cmp(dbp,
+				    key, h, indx, t->bt_compare, &cmp)) != 0)
+					return (ret);
+				if (cmp == 0)
+					break;
+				if (cmp > 0) {
+					base = indx + P_INDX;
+					--lim;
+				}
+			}
+			if (cmp != 0) {
+				indx = base;
+				goto fast_hit;
+			}
+			if (flags == DB_KEYLAST)
+				for (;
+				    indx < (db_indx_t)(NUM_ENT(h) - P_INDX) &&
+				    inp[indx] == inp[indx + P_INDX];
+				    indx += P_INDX);
+			else
+				for (;
+				    indx > 0 && inp[indx - P_INDX] == inp[indx];
+				    indx -= P_INDX);
+			goto fast_hit;
 		}
 try_begin:	if (h->prev_pgno == PGNO_INVALID) {
 			indx = 0;
@@ -3990,13 +4032,15 @@ search:		if ((ret = __bam_search(dbc, root_pgno,
 	 * remember where it was so we can do it more quickly next time.
 	 * If there are duplicates and we are inserting into the last slot,
 	 * the cursor will point _to_ the last item, not after it, which
-	 * is why we subtract P_INDX below.
+	 * is why we subtract P_INDX below.  With gbl_bt_near_append, any
+	 * slot of the last page will do.
 	 */
 	if (TYPE(cp->page) == P_LBTREE &&
 	    (flags == DB_KEYFIRST || flags == DB_KEYLAST))
 		t->bt_lpgno =
 		    (NEXT_PGNO(cp->page) == PGNO_INVALID &&
-		    cp->indx >= NUM_ENT(cp->page) - P_INDX) ||
+		    (gbl_bt_near_append ||
+		    cp->indx >= NUM_ENT(cp->page) - P_INDX)) ||
 		    (PREV_PGNO(cp->page) == PGNO_INVALID &&
 		    cp->indx == 0) ? cp->pgno : PGNO_INVALID;
 	return (0);
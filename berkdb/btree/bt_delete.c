@@ -413,7 +413,7 @@ err:		for (; epg <= cp->csp; ++epg) {
 		if ((ret = __memp_fget(mpf, &pgno, 0, &child)) != 0)
 			goto stop;
 
-		if (F_ISSET(dbp, DB_AM_HASH) &&
+		if (F_ISSET(dbp, DB_AM_HASH) && dbp->pg_hash_keylen == 0 &&
 		    (hash = dbp->pg_hash) != NULL &&TYPE(child) == P_LBTREE) {
 			/*
 			 * Update the page numbers in the genid-pg hash
@@ -20,6 +20,7 @@
 #include "logmsg.h"
 
 extern struct thdpool *gbl_udppfault_thdpool;
+extern int comdb2_time_epochms();
 
 static inline int chk_forward(DBC *dbc);
 static inline int chk_backward(DBC *dbc);
@@ -36,8 +37,18 @@ void start_loading_async_pp(struct thdpool *pool, void *work, void *thddata,
     int op);
 void start_loading_async_cb(btpf_job * job);
 static inline int advance_on_tree(DBC *dbc);
+static inline void load_leaf(DBC *dbc, db_pgno_t pgno);
 
-#define LOAD(mpf,x) enqueue_touch_page(mpf, x);
+#define LOAD(mpf,x) load_leaf(dbc, x);
+
+/* Most overflow items we follow per leaf, and pages per overflow chain */
+#define BTPF_OVFL_ITEMS 64
+#define BTPF_OVFL_PAGES 64
+
+typedef struct {
+	DB *db;
+	db_pgno_t pgno;
+} btpf_leaf;
 
 #define LOAD_SYNC(mpf,x,page) {                                                     \
     __memp_fget(mpf, &x, DB_MPOOL_PFGET, &page);                                    \
@@ -149,6 +160,7 @@ btpf_rst(btpf * x)
 	x->rdr_rec_cnt = 0;
 	x->rdr_pg_cnt = 0;
 	x->wndw = 0;
+	x->last_ms = 0;
 	x->tr_page = PGNO_INVALID;
 	x->on = PF_ON;
 	// TODO update stats
@@ -348,15 +360,34 @@ chk_backward(DBC *dbc)
 	return rst;
 }
 
+/*
+ * With btpf_wndw_ms set, the window is what the cursor read since the last
+ * refill scaled to btpf_wndw_ms: a fast scan gets a deep window, a slow
+ * consumer stops pulling pages into the cache long before it needs them.
+ */
 static inline int
 adj_wndw(DBC *dbc, btpf * f)
 {
-	if (f->wndw == 0) {
+	int now = comdb2_time_epochms();
+	int64_t elapsed, want;
+
+	if (WNDW_MS(dbc) > 0 && f->wndw != 0 && f->last_ms != 0) {
+		elapsed = now - f->last_ms;
+		if (elapsed < 1)
+			elapsed = 1;
+		want = (int64_t)f->rdr_pg_cnt * WNDW_MS(dbc) / elapsed;
+		if (want < WNDW_MIN(dbc))
+			want = WNDW_MIN(dbc);
+		if (want > WNDW_MAX(dbc))
+			want = WNDW_MAX(dbc);
+		f->wndw = want;
+	} else if (f->wndw == 0) {
 		f->wndw = WNDW_MIN(dbc);
 	} else {
 		f->wndw *=  WNDW_INC(dbc);
 		f->wndw = f->wndw > WNDW_MAX(dbc) ? WNDW_MAX(dbc) : f->wndw;
 	}
+	f->last_ms = now;
 #if BTPF_DEBUG 
 	fprintf(stderr, "Adapting window to %d\n", f->wndw);
 #endif
@@ -491,6 +522,86 @@ start_loading_async_cb(btpf_job * job)
 
 }
 
+/*
+ * Read ahead a leaf page and the overflow pages its items point to.  Those
+ * are only known once the leaf is in, so the leaf is read under a page lock
+ * like the parent pages are; the overflow chains are then touched without
+ * it, as pages are only being brought into the cache.
+ */
+static void
+load_leaf_ovfl(DB *dbp, db_pgno_t pgno)
+{
+	DB_MPOOLFILE *mpf = dbp->mpf;
+	DBC *dbc;
+	DB_LOCK lock;
+	PAGE *h;
+	BOVERFLOW *bo;
+	db_pgno_t ovfl[BTPF_OVFL_ITEMS];
+	db_indx_t i;
+	int n = 0, j, cnt;
+
+	if (dbp->cursor(dbp, NULL, &dbc, 0) != 0)
+		return;
+
+	if (__db_lget(dbc, 0, pgno, DB_LOCK_READ, 0, &lock) != 0)
+		goto done;
+	if (__memp_fget(mpf, &pgno, DB_MPOOL_PFGET, &h) == 0) {
+		if (TYPE(h) == P_LBTREE) {
+			for (i = 0; i < NUM_ENT(h) && n < BTPF_OVFL_ITEMS; i++) {
+				bo = GET_BOVERFLOW(dbp, h, i);
+				if (B_TYPE(bo) == B_OVERFLOW && !B_DISSET(bo))
+					ovfl[n++] = bo->pgno;
+			}
+		}
+		(void)__memp_fput(mpf, h, DB_MPOOL_PFPUT);
+	}
+	(void)__LPUT(dbc, lock);
+
+	for (j = 0; j < n; j++) {
+		pgno = ovfl[j];
+		for (cnt = 0; pgno != PGNO_INVALID && cnt < BTPF_OVFL_PAGES;
+		    cnt++) {
+			if (__memp_fget(mpf, &pgno, DB_MPOOL_PFGET, &h) != 0)
+				break;
+			pgno = TYPE(h) == P_OVERFLOW ? NEXT_PGNO(h) : PGNO_INVALID;
+			(void)__memp_fput(mpf, h, DB_MPOOL_PFPUT);
+		}
+	}
+done:
+	(void)__db_c_close(dbc);
+}
+
+static void
+load_leaf_pp(struct thdpool *pool, void *work, void *thddata, int op)
+{
+	btpf_leaf *leaf = work;
+
+	switch (op) {
+	case THD_RUN:
+		load_leaf_ovfl(leaf->db, leaf->pgno);
+		break;
+	}
+	free(leaf);
+}
+
+static inline void
+load_leaf(DBC *dbc, db_pgno_t pgno)
+{
+	btpf_leaf *leaf;
+
+	if (!PF_OVFL(dbc)) {
+		enqueue_touch_page(dbc->dbp->mpf, pgno);
+		return;
+	}
+	if ((leaf = malloc(sizeof(btpf_leaf))) == NULL)
+		return;
+	leaf->db = dbc->dbp;
+	leaf->pgno = pgno;
+	if (thdpool_enqueue(gbl_udppfault_thdpool, load_leaf_pp, leaf, 0,
+		NULL, 0) != 0)
+		free(leaf);
+}
+
 static inline int
 advance_on_tree(DBC *dbc)
 {
@@ -17,6 +17,8 @@
 #define WNDW_INC(dbc) dbc->dbp->dbenv->attr.btpf_wndw_inc
 #define WNDW_MAX(dbc) dbc->dbp->dbenv->attr.btpf_wndw_max
 #define MIN_TH(dbc)   dbc->dbp->dbenv->attr.btpf_min_th
+#define WNDW_MS(dbc)  dbc->dbp->dbenv->attr.btpf_wndw_ms
+#define PF_OVFL(dbc)  dbc->dbp->dbenv->attr.btpf_ovfl
 
 typedef enum {
 	INIT,
@@ -56,6 +58,7 @@ typedef struct {
 	u_int32_t   rdr_pg_cnt; // pages read by the cursor to catch up
 	u_int32_t   wndw;
 	u_int32_t   on; // pre-faulting is on/off
+	int         last_ms; // when the window was last refilled
    
 	db_pgno_t curlf[RMBR_LVL];	// the chain of pages to reach the cursor 
 	db_indx_t curindx[RMBR_LVL];	// current entry per level
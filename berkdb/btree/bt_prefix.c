@@ -866,6 +866,62 @@ bk_decompress(DB *dbp, PAGE *pg, BKEYDATA **bk, uint8_t * buf, size_t len)
 	return 0;
 }
 
+/*
+ * Compare key against the page prefix once per page.  Every entry stored
+ * with B_PFX starts with these bytes, so a non-zero result orders key
+ * against all of them.
+ */
+int
+pfx_cmp(const pfx_t * pfx, const DBT *key)
+{
+	u_int32_t n = key->size < pfx->npfx ? key->size : pfx->npfx;
+	int cmp = memcmp(key->data, pfx->pfx, n);
+
+	if (cmp == 0 && key->size < pfx->npfx)
+		cmp = -1;
+	return cmp;
+}
+
+/*
+ * Memcmp-order key against a prefixed (B_PFX, not B_RLE) entry piecewise:
+ * key[npfx..] against the stored bytes, then against the suffix.  Saves
+ * rebuilding the entry in a KEYBUF on every probe.  Returns 1 if the entry
+ * cannot be compared this way and the caller should decompress it.
+ */
+int
+bk_pfx_cmp(const pfx_t * pfx, int pfxcmp, const DBT *key, BKEYDATA *bk,
+    int *cmpp)
+{
+	const uint8_t *k;
+	u_int32_t klen, n;
+	db_indx_t bklen;
+	int cmp;
+
+	if (B_TYPE(bk) != B_KEYDATA || !B_PISSET(bk) || B_RISSET(bk))
+		return 1;
+	if (pfxcmp != 0) {
+		*cmpp = pfxcmp;
+		return 0;
+	}
+	k = (const uint8_t *)key->data + pfx->npfx;
+	klen = key->size - pfx->npfx;
+	ASSIGN_ALIGN(db_indx_t, bklen, bk->len);
+
+	n = klen < bklen ? klen : bklen;
+	if ((cmp = memcmp(k, bk->data, n)) != 0 || klen < bklen) {
+		*cmpp = cmp ? cmp : -1;
+		return 0;
+	}
+	k += bklen;
+	klen -= bklen;
+
+	n = klen < pfx->nsfx ? klen : pfx->nsfx;
+	if ((cmp = memcmp(k, pfx->sfx, n)) == 0)
+		cmp = (long)klen - (long)pfx->nsfx;
+	*cmpp = cmp;
+	return 0;
+}
+
 // PUBLIC: int pfx_bulk_page __P((DBC *, uint8_t *, int32_t *, uint32_t ));
 int
 pfx_bulk_page(DBC *dbc, uint8_t * np, int32_t *offp, uint32_t space)
@@ -20,6 +20,11 @@ typedef struct pfx_type_t pfx_t;
 pfx_t *pgpfx(struct __db *, struct _db_page *, void *buf, int sz);
 struct _bkeydata *bk_decompress_int(pfx_t *, struct _bkeydata *, void *buf);
 
+//for search: compare without decompressing
+int pfx_cmp(const pfx_t *, const DBT *key);
+int bk_pfx_cmp(const pfx_t *, int pfxcmp, const DBT *key, struct _bkeydata *,
+    int *cmpp);
+
 void prefix_tocpu(struct __db *, struct _db_page *);
 void prefix_fromcpu(struct __db *, struct _db_page *);
 
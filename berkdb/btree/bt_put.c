@@ -571,6 +571,14 @@ user_copy:
 /* COMDB2 HACK to make snapisol & rowlocks work */
 int bdb_logical_logging_enabled();
 
+/*
+ * Log an in-place replacement as one repl record per changed byte range
+ * when the ranges are at least this far apart (0 logs a single range).
+ * Each record reads back the same as any other repl, so replicants and
+ * recovery need nothing new.
+ */
+int gbl_repl_log_split_gap = 0;
+
 /*
  * __bam_ritem --
  *	Replace an item on a page.
@@ -589,6 +597,7 @@ __bam_ritem(dbc, h, indx, data)
 	DB *dbp;
 	DBT orig, repl;
 	db_indx_t cnt, lo, ln, min, off, prefix, suffix;
+	u_int32_t beg, end, last, same, gap;
 	int32_t nbytes;
 	int ret;
 	db_indx_t *inp;
@@ -624,6 +633,42 @@ __bam_ritem(dbc, h, indx, data)
 		    suffix < min && *p == *t && !disable_prefix_suffix_opt;
 		    ++suffix, --p, --t);
 
+		/*
+		 * A fixed size record with a few columns changed far apart
+		 * (a counter, an updateid in the header) logs each changed
+		 * range on its own rather than everything in between.
+		 */
+		gap = gbl_repl_log_split_gap;
+		if (gap > 0 && data->size == bk->len &&
+		    prefix + suffix < bk->len && !disable_prefix_suffix_opt) {
+			p = bk->data;
+			t = data->data;
+			last = bk->len - suffix;
+			for (beg = prefix; beg < last;) {
+				for (end = beg + 1, same = 0; end < last; ++end) {
+					if (p[end] != t[end])
+						same = 0;
+					else if (++same == gap)
+						break;
+				}
+				/* end is past the range, or on its gap-th same byte */
+				if (end < last)
+					end -= same - 1;
+				orig.data = p + beg;
+				orig.size = end - beg;
+				repl.data = t + beg;
+				repl.size = end - beg;
+				if ((ret = __bam_repl_log(dbp, dbc->txn, &LSN(h), 0,
+				    PGNO(h), &LSN(h), (u_int32_t)indx,
+				    (u_int32_t)B_DISSET(bk), &orig, &repl, beg,
+				    bk->len - end)) != 0)
+					return (ret);
+				for (beg = end; beg < last && p[beg] == t[beg]; ++beg)
+					;
+			}
+			goto logged;
+		}
+
 		/* We only log the parts of the keys that have changed. */
 		orig.data = (u_int8_t *)bk->data + prefix;
 		orig.size = bk->len - (prefix + suffix);
@@ -635,6 +680,7 @@ __bam_ritem(dbc, h, indx, data)
 			return (ret);
 	} else
 		LSN_NOT_LOGGED(LSN(h));
+logged:
 
 	/*
 	 * Set references to the first in-use byte on the page and the
@@ -381,7 +381,7 @@ done:	*lsnp = argp->prev_lsn;
 	}
 	if (file_dbp && dbp &&
 		!F_ISSET(dbp, DB_AM_RECOVER) &&
-		F_ISSET(dbp, DB_AM_HASH) &&
+		F_ISSET(dbp, DB_AM_HASH) && dbp->pg_hash_keylen == 0 &&
 		(hash = dbp->pg_hash) != NULL &&!rootsplit) {
 		argp_lp = argp->pg.data;
 		// Update the page numbers in the genid-pg hash
@@ -555,7 +555,8 @@ done:	*lsnp = argp->prev_lsn;
 
 	if (dbp &&
 	    !F_ISSET(dbp, DB_AM_RECOVER) &&
-	    F_ISSET(dbp, DB_AM_HASH) && (hash = dbp->pg_hash) != NULL) {
+	    F_ISSET(dbp, DB_AM_HASH) && dbp->pg_hash_keylen == 0 &&
+	    (hash = dbp->pg_hash) != NULL) {
 		add_to_hash = argp->root_pgno == 1 ? 0 : 1;
 		child = (PAGE *)argp->pgdbt.data;
 		for (off = 0; off < NUM_ENT(child); off += P_INDX) {
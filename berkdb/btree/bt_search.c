@@ -307,6 +307,46 @@ genidsetzero(void *g)
 	memset(g, 0, HASH_GENID_SIZE);
 }
 
+/*
+ * Return what the page hash entries of dbp are keyed on for key: the
+ * genid itself, or for a unique index a 64-bit fingerprint of the key,
+ * written to buf.  A fingerprint can collide, so a lookup through it has
+ * to find the key on the page, and starts from the root when it doesn't.
+ */
+static const void *
+bthash_key(DB *dbp, const DBT *key, u_int8_t *buf)
+{
+	const u_int8_t *p;
+	u_int64_t h;
+	u_int32_t i;
+
+	if (dbp->pg_hash_keylen == 0)
+		return (key->data);
+	for (h = 14695981039346656037ULL, p = key->data, i = 0;
+	    i < key->size; ++i)
+		h = (h ^ p[i]) * 1099511628211ULL;
+	memcpy(buf, &h, GENID_SIZE);
+	return (buf);
+}
+
+/* Remember the cached page the descent is on, to validate it later. */
+#define RCACHE_PUSH()							\
+	do {								\
+		rc_path[rc_depth].cached_pg = cached_pg;		\
+		rc_path[rc_depth].bfpool_pg = bfpool_pg;		\
+		rc_path[rc_depth].gen = gen;				\
+		rc_path[rc_depth].slot = slot;				\
+		++rc_depth;						\
+	} while (0)
+
+/* Copy an inner page into the rcache. */
+#define RCACHE_SAVE(pgno, h)						\
+	do {								\
+		uint16_t __gen = LSN(h).file + LSN(h).offset;		\
+		GET_BH_GEN(h) = __gen;					\
+		rcache_save(dbp, pgno, h, __gen);			\
+	} while (0)
+
 /*
  * __bam_search --
  *	Search a btree for a key.
@@ -340,6 +380,14 @@ __bam_search(dbc, root_pgno, key, flags, stop, recnop, exactp)
 	int save = 0;
 	uint16_t gen;
 	uint32_t slot;
+	/* the cached copies the descent went through, root first */
+	struct {
+		void *cached_pg;
+		void *bfpool_pg;
+		uint16_t gen;
+		uint32_t slot;
+	} rc_path[RCACHE_MAX_LEVELS];
+	int rc_depth, rc_retry = 0, depth, levels, j;
 	unsigned int hh = 0;
 	genid_hash *hash = NULL;
 	__genid_pgno *hashtbl = NULL;
@@ -347,6 +395,9 @@ __bam_search(dbc, root_pgno, key, flags, stop, recnop, exactp)
 	int add_to_hash = 0;
 	db_pgno_t hash_pg = 0;
 	db_pgno_t pg_copy = 0;
+	const void *hkey = NULL;
+	u_int8_t hkeybuf[GENID_SIZE];
+	int no_hash = 0;
 
 	struct timeval before, after, diff;
 
@@ -380,6 +431,7 @@ __bam_search(dbc, root_pgno, key, flags, stop, recnop, exactp)
 try_again:
 
 	INTERNAL_PTR_CHECK(cp == dbc->internal);
+	rc_depth = depth = 0;
 
 	pg = root_pgno == PGNO_INVALID ? cp->root : root_pgno;
 	stack = LF_ISSET(S_STACK) && F_ISSET(cp, C_RECNUM);
@@ -389,12 +441,16 @@ try_again:
 	gettimeofday(&before, NULL);
 
 	extern int gbl_rcache;
+	extern int gbl_rcache_levels;
 
-	if (gbl_rcache && pg == 1 && bfpool_pg == NULL &&
+	levels = gbl_rcache_levels < RCACHE_MAX_LEVELS ?
+	    gbl_rcache_levels : RCACHE_MAX_LEVELS;
+	if (gbl_rcache && pg == 1 && !rc_retry &&
 	    lock_mode == DB_LOCK_READ && LF_ISSET(S_FIND)) {
 		save = 1;
 		if (rcache_find(
-		    dbp, &cached_pg, &bfpool_pg, &gen, &slot) == 0) {
+		    dbp, pg, &cached_pg, &bfpool_pg, &gen, &slot) == 0) {
+			RCACHE_PUSH();
 			h = cached_pg;
 			goto got_pg;
 		}
@@ -436,23 +492,32 @@ try_again:
 	  numbers are always correct in our scheme), key must be
 	  deleted and we return NOTFOUND 3) Othervise, key should be
 	  found in the page.
+
+	  The unique indexes of a table with a page hash are hashed
+	  too, but their entries hold a fingerprint of the key, which
+	  can collide, and splits don't move them.  So in cases 1) and
+	  2) we search again from the root page, which also repairs the
+	  entry.
 	*/
 	if (!stack &&
+	    !no_hash &&
 	    !LF_ISSET(S_PARENT) &&
 	    F_ISSET(dbp, DB_AM_HASH) &&
 	    (hash = dbp->pg_hash) != NULL &&
-	    key->size == GENID_SIZE) {
+	    key->size == (dbp->pg_hash_keylen ? dbp->pg_hash_keylen :
+	    GENID_SIZE)) {
 		dbp->pg_hash_stat.n_bt_hash++;
 		hashtbl = hash->tbl;
+		hkey = bthash_key(dbp, key, hkeybuf);
 		//1 Hash-to-correct-entry
-		hh = hash_fixedwidth((unsigned char *)(key->data)) % 
+		hh = hash_fixedwidth((unsigned char *)hkey) %
 			(hash->ntbl);
 		//2 Verify that the genid is correct
-		if (genidcmp(hashtbl[hh].genid, key->data) == 0) {
+		if (genidcmp(hashtbl[hh].genid, hkey) == 0) {
 			//3 Grab the page number
 			hash_pg = hashtbl[hh].pgno;
 			//4 Verify that the genid is correct (again)
-			if (genidcmp(hashtbl[hh].genid, key->data) == 0) {
+			if (genidcmp(hashtbl[hh].genid, hkey) == 0) {
 				pg_copy = pg;
 				pg = hash_pg;
 				got_pg_from_hash = 1;
@@ -491,12 +556,12 @@ hash_backup:
 	}
 
 	if (got_pg_from_hash) {
-		if ((genidcmp(hashtbl[hh].genid, key->data) != 0) ||
+		if ((genidcmp(hashtbl[hh].genid, hkey) != 0) ||
 		    ((hash_pg = hashtbl[hh].pgno) != h->pgno)) {
 			// hash page changed between searching the hash and getting page lock
 			(void)__memp_fput(mpf, h, 0);
 			(void)__LPUT(dbc, lock);
-			if (genidcmp(hashtbl[hh].genid, key->data) == 0) {
+			if (genidcmp(hashtbl[hh].genid, hkey) == 0) {
 				// use the new hash pg
 				pg = hash_pg;
 				got_pg_from_hash = 1;
@@ -515,16 +580,14 @@ hash_backup:
 			genidsetzero(hashtbl[hh].genid);
 			hashtbl[hh].pgno = 0;
 			Pthread_mutex_unlock(&(hash->mutex));
+			if (dbp->pg_hash_keylen)
+				goto hash_fallback;
 			goto notfound;
 		}
 	}
 
-	if (save && TYPE(h) == P_IBTREE) {	// WORKS ONLY WHEN ROOT IS INTERNAL
-		uint16_t gen = LSN(h).file + LSN(h).offset;
-
-		GET_BH_GEN(h) = gen;
-		rcache_save(dbp, h, gen);
-	}
+	if (save && TYPE(h) == P_IBTREE)	// WORKS ONLY WHEN ROOT IS INTERNAL
+		RCACHE_SAVE(pg, h);
 
 	INTERNAL_PTR_CHECK(cp == dbc->internal);
 
@@ -581,12 +644,28 @@ got_pg:func = t->bt_compare;
 		adjust = TYPE(h) == P_LBTREE ? P_INDX : O_INDX;
 		uint8_t buf[KEYBUF];
 
+		/*
+		 * On a prefix-compressed leaf, parse the page prefix and
+		 * order the key against it once, instead of rebuilding
+		 * every probed entry from it.
+		 */
+		pfx_t *pfx = NULL;
+		int pfxcmp = 0;
+		uint8_t pfxbuf[KEYBUF];
+		if (func == __bam_defcmp && IS_PREFIX(h) &&
+		    (TYPE(h) == P_LBTREE || TYPE(h) == P_LDUP) &&
+		    (pfx = pgpfx(dbp, h, pfxbuf, KEYBUF)) != NULL)
+			pfxcmp = pfx_cmp(pfx, key);
+
 		for (base = 0,
 		    lim = NUM_ENT(h) / (db_indx_t) adjust; lim != 0;
 		    lim >>= 1) {
 			indx = base + ((lim >> 1) * adjust);
 
-			if ((ret =
+			if (pfx != NULL && bk_pfx_cmp(pfx, pfxcmp, key,
+				GET_BKEYDATA(dbp, h, indx), &cmp) == 0)
+				;
+			else if ((ret =
 				__bam_cmp_inline(dbp, key, h, indx, func, &cmp,
 				    buf)) != 0)
 				goto err;
@@ -609,6 +688,9 @@ got_pg:func = t->bt_compare;
 		 * Delete only deletes exact matches.
 		 */
 		if (TYPE(h) == P_LBTREE || TYPE(h) == P_LDUP) {
+			if (got_pg_from_hash && dbp->pg_hash_keylen)
+				goto hash_fallback;
+
 			*exactp = 0;
 
 			if (LF_ISSET(S_EXACT))
@@ -727,6 +809,18 @@ next:		if (recnop != NULL)
 			lock_mode = stack &&
 			    LF_ISSET(S_WRITE) ? DB_LOCK_WRITE : DB_LOCK_READ;
 
+			if (cached_pg && !stack && rc_depth < levels &&
+			    rcache_find(dbp, pg, &cached_pg, &bfpool_pg, &gen,
+			    &slot) == 0) {
+				/*
+				 * The next inner page is cached too: descend
+				 * without the buffer pool or a lock.
+				 */
+				RCACHE_PUSH();
+				h = cached_pg;
+				++depth;
+				continue;
+			}
 			if (cached_pg) {
 				/* Used rcache to get here. Don't lck couple. */
 				if ((ret = __db_lget(dbc, 0, pg, lock_mode, 0,
@@ -762,27 +856,36 @@ next:		if (recnop != NULL)
 				 */
 				cached_pg = NULL;
 
-				rcache_invalidate(slot);
+				for (j = 0; j < rc_depth; ++j)
+					rcache_invalidate(rc_path[j].slot);
+				rc_retry = 1;
 				__LPUT(dbc, lock);
 				goto try_again;
 			}
 			goto err;
 		}
+		++depth;
 
 		if (cached_pg) {
-			/* Used rcache and got child page. Validate rcache. */
-			DB_LSN *l1 = &LSN(cached_pg);
-			DB_LSN *l2 = &LSN(bfpool_pg);
+			/*
+			 * Used rcache and got child page. Validate every
+			 * cached page on the way down.
+			 */
 			cached_pg = NULL;
 
-			if (gen == GET_BH_GEN(bfpool_pg)
-			    && memcmp(l1, l2, sizeof(DB_LSN)) == 0 && gen == GET_BH_GEN(bfpool_pg)	//re-check. warm&fuzzy
-			    ) {
-				;
-			} else {
+			for (j = 0; j < rc_depth; ++j) {
+				DB_LSN *l1 = &LSN(rc_path[j].cached_pg);
+				DB_LSN *l2 = &LSN(rc_path[j].bfpool_pg);
+				gen = rc_path[j].gen;
+
+				if (gen == GET_BH_GEN(rc_path[j].bfpool_pg)
+				    && memcmp(l1, l2, sizeof(DB_LSN)) == 0 && gen == GET_BH_GEN(rc_path[j].bfpool_pg)	//re-check. warm&fuzzy
+				    )
+					continue;
 				__memp_fput(mpf, h, 0);
 				__LPUT(dbc, lock);
-				rcache_invalidate(slot);
+				rcache_invalidate(rc_path[j].slot);
+				rc_retry = 1;
 				goto try_again;
 			}
 		}
@@ -803,6 +906,9 @@ next:		if (recnop != NULL)
 		default:
 			return (__db_pgfmt(dbp->dbenv, PGNO(h)));
 		}
+
+		if (save && depth < levels && TYPE(h) == P_IBTREE)
+			RCACHE_SAVE(pg, h);
 	}
 	/* NOTREACHED */
 
@@ -915,7 +1021,7 @@ found:	*exactp = 1;
 		//3 Write the pagenumber
 		hashtbl[hh].pgno = h->pgno;
 		//4 Write the correct genid
-		genidcpy(hashtbl[hh].genid, key->data);
+		genidcpy(hashtbl[hh].genid, hkey);
 		Pthread_mutex_unlock(&(hash->mutex));
 	}
 	gettimeofday(&after, NULL);
@@ -926,6 +1032,18 @@ found:	*exactp = 1;
 
 	return (0);
 
+hash_fallback:
+	/*
+	 * A fingerprint may have led to the wrong page; only a search from
+	 * the root can say the key isn't there.
+	 */
+	(void)__memp_fput(mpf, h, 0);
+	(void)__LPUT(dbc, lock);
+	got_pg_from_hash = 0;
+	add_to_hash = 1;
+	no_hash = 1;
+	goto try_again;
+
 notfound:
 	INTERNAL_PTR_CHECK(cp == dbc->internal);
 	/* Keep the page locked for serializability. */
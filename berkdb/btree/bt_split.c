@@ -448,7 +448,7 @@ __bam_page(dbc, pp, cp)
 	if ((ret = __bam_pinsert(dbc, pp, lp, rp, 0)) != 0)
 		goto err;
 
-	if (F_ISSET(dbp, DB_AM_HASH) &&
+	if (F_ISSET(dbp, DB_AM_HASH) && dbp->pg_hash_keylen == 0 &&
 	    (hash = dbp->pg_hash) != NULL &&TYPE(rp) == P_LBTREE) {
 		// Update the page numbers in the genid-pg hash
 		for (off = 0; off < NUM_ENT(rp); off += P_INDX) {
@@ -1022,6 +1022,159 @@ noprefix:			nksize = child_bk->len;
 	return (0);
 }
 
+/*
+ * __bam_split_isize --
+ *	Return the on-page size of the item at indx; for P_LBTREE pages that
+ *	is the size of the key/data pair starting at indx.
+ */
+static u_int32_t
+__bam_split_isize(dbp, pp, indx)
+	DB *dbp;
+	PAGE *pp;
+	db_indx_t indx;
+{
+	BKEYDATA *bk;
+	db_indx_t len;
+	u_int32_t nbytes;
+	int i;
+
+	if (TYPE(pp) == P_IBTREE)
+		return (B_TYPE(GET_BINTERNAL(dbp, pp, indx)) == B_KEYDATA ?
+		    BINTERNAL_SIZE(GET_BINTERNAL(dbp, pp, indx)->len) :
+		    BINTERNAL_SIZE(BOVERFLOW_SIZE));
+
+	for (nbytes = 0, i = 0; i < P_INDX; ++i) {
+		bk = GET_BKEYDATA(dbp, pp, indx + i);
+		if (B_TYPE(bk) == B_KEYDATA) {
+			ASSIGN_ALIGN(db_indx_t, len, bk->len);
+			nbytes += BKEYDATA_SIZE(len);
+		} else
+			nbytes += BOVERFLOW_SIZE;
+	}
+	return (nbytes);
+}
+
+/*
+ * __bam_split_sepsize --
+ *	Return the length of the separator __bam_pinsert would promote if
+ *	the page were split at indx, or UINT_MAX if it can't be split there
+ *	or the separator can't be shortened.
+ */
+static u_int32_t
+__bam_split_sepsize(dbc, pp, indx, lbuf, rbuf)
+	DBC *dbc;
+	PAGE *pp;
+	db_indx_t indx;
+	u_int8_t *lbuf, *rbuf;
+{
+	BINTERNAL *bi;
+	BKEYDATA *lk, *rk;
+	BTREE *t;
+	DB *dbp;
+	DBT a, b;
+	db_indx_t *inp;
+
+	dbp = dbc->dbp;
+	t = dbp->bt_internal;
+
+	if (TYPE(pp) == P_IBTREE) {
+		/* The first key of the right page moves up as is. */
+		bi = GET_BINTERNAL(dbp, pp, indx);
+		return (B_TYPE(bi) == B_KEYDATA ? bi->len : UINT_MAX);
+	}
+
+	/* Never split a set of duplicates. */
+	inp = P_INP(dbp, pp);
+	if (inp[indx] == inp[indx - P_INDX] || t->bt_prefix == NULL)
+		return (UINT_MAX);
+
+	lk = GET_BKEYDATA(dbp, pp, indx - P_INDX);
+	rk = GET_BKEYDATA(dbp, pp, indx);
+	if (bk_decompress(dbp, pp, &lk, lbuf, KEYBUF) != 0 ||
+	    bk_decompress(dbp, pp, &rk, rbuf, KEYBUF) != 0)
+		return (UINT_MAX);
+	if (B_TYPE(lk) != B_KEYDATA || B_TYPE(rk) != B_KEYDATA)
+		return (UINT_MAX);
+
+	memset(&a, 0, sizeof(a));
+	a.data = lk->data;
+	ASSIGN_ALIGN_DIFF(u_int32_t, a.size, db_indx_t, lk->len);
+	memset(&b, 0, sizeof(b));
+	b.data = rk->data;
+	ASSIGN_ALIGN_DIFF(u_int32_t, b.size, db_indx_t, rk->len);
+	return ((u_int32_t)t->bt_prefix(dbp, &a, &b));
+}
+
+int gbl_bt_split_window = 0;
+int gbl_bt_append_split_pct = 90;
+
+/*
+ * __bam_split_shortest --
+ *	Look up to gbl_bt_split_window entries either side of splitp for the
+ *	split point that promotes the shortest separator to the parent.  The
+ *	data moved from one side to the other is kept under an eighth of
+ *	the page, so the split stays roughly balanced.
+ */
+static db_indx_t
+__bam_split_shortest(dbc, pp, splitp)
+	DBC *dbc;
+	PAGE *pp;
+	db_indx_t splitp;
+{
+	DB *dbp;
+	db_indx_t adjust, best, off;
+	u_int32_t bestlen, len, slack, nbytes;
+	int lo, hi;
+	u_int8_t *lbuf, *rbuf;
+
+	dbp = dbc->dbp;
+	if (F_ISSET(dbc, DBC_OPD) ||
+	    (TYPE(pp) != P_LBTREE && TYPE(pp) != P_IBTREE))
+		return (splitp);
+
+	adjust = TYPE(pp) == P_LBTREE ? P_INDX : O_INDX;
+	lbuf = alloca(KEYBUF);
+	rbuf = alloca(KEYBUF);
+	slack = (dbp->pgsize - HOFFSET(pp)) / 8;
+
+	best = splitp;
+	bestlen = __bam_split_sepsize(dbc, pp, splitp, lbuf, rbuf);
+
+	/* Entries to the left; splitting there moves data to the right. */
+	lo = (int)splitp - gbl_bt_split_window * adjust;
+	if (lo < adjust)
+		lo = adjust;
+	for (nbytes = 0, off = splitp; off > lo;) {
+		off -= adjust;
+		if ((nbytes += __bam_split_isize(dbp, pp, off)) > slack)
+			break;
+		if ((len = __bam_split_sepsize(dbc, pp, off, lbuf, rbuf)) <
+		    bestlen) {
+			best = off;
+			bestlen = len;
+		}
+	}
+
+	/* Entries to the right; ties keep whichever is closer to splitp. */
+	hi = (int)splitp + gbl_bt_split_window * adjust;
+	if (hi > NUM_ENT(pp) - adjust)
+		hi = NUM_ENT(pp) - adjust;
+	for (nbytes = 0, off = splitp; off < hi;) {
+		if ((nbytes += __bam_split_isize(dbp, pp, off)) > slack)
+			break;
+		off += adjust;
+		if ((len = __bam_split_sepsize(dbc, pp, off, lbuf, rbuf)) <
+		    bestlen ||
+		    (len == bestlen && best < splitp &&
+		    off - splitp < splitp - best)) {
+			best = off;
+			bestlen = len;
+		}
+	}
+
+	return (best);
+}
+
 /*
  * __bam_psplit --
  *	Do the real work of splitting the page.
@@ -1036,7 +1189,7 @@ __bam_psplit(dbc, cp, lp, rp, splitret)
 	DB *dbp;
 	PAGE *pp;
 	db_indx_t half, *inp, nbytes, off, splitp, top;
-	int adjust, cnt, iflag, isbigkey, ret;
+	int adjust, cnt, iflag, isbigkey, ret, sorted;
 
 	dbp = dbc->dbp;
 	pp = cp->page;
@@ -1081,7 +1234,7 @@ __bam_psplit(dbc, cp, lp, rp, splitret)
 		off = NUM_ENT(pp) - adjust;
 	else if (PREV_PGNO(pp) == PGNO_INVALID && cp->indx == 0)
 		off = adjust;
-	if (off != 0)
+	if ((sorted = (off != 0)) != 0)
 		goto sort;
 
 	/*
@@ -1107,6 +1260,18 @@ __bam_psplit(dbc, cp, lp, rp, splitret)
 	 */
 	top = NUM_ENT(pp) - adjust;
 	half = (dbp->pgsize - HOFFSET(pp)) / 2;
+
+	/*
+	 * Nearly ordered inserts into the last leaf, such as the genids of
+	 * concurrent transactions, miss the test above and would leave each
+	 * page they split half empty.  When the insert is in the last part
+	 * of the last leaf, keep gbl_bt_append_split_pct of it on the left.
+	 */
+	if (TYPE(pp) == P_LBTREE && NEXT_PGNO(pp) == PGNO_INVALID &&
+	    gbl_bt_append_split_pct > 50 && gbl_bt_append_split_pct < 100 &&
+	    cp->indx >= NUM_ENT(pp) * gbl_bt_append_split_pct / 100)
+		half = (dbp->pgsize - HOFFSET(pp)) *
+		    gbl_bt_append_split_pct / 100;
 	for (nbytes = 0, off = 0; off < top && nbytes < half; ++off)
 		switch (TYPE(pp)) {
 		case P_IBTREE:
@@ -1211,6 +1376,13 @@ sort:	splitp = off;
 			}
 		}
 
+	/*
+	 * Shorter separators mean more keys per internal page.  When asked,
+	 * trade a little balance for the shortest separator near splitp.
+	 */
+	if (!sorted && gbl_bt_split_window > 0)
+		splitp = __bam_split_shortest(dbc, pp, splitp);
+
 	if (IS_PREFIX(pp)) {
 		/* Don't copy prefix if this looks like an append */
 		BKEYDATA *pfx = P_PFXENTRY(dbp, pp);
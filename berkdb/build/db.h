@@ -140,6 +140,9 @@ struct __db_lsn;	typedef struct __db_lsn DB_LSN;
 struct __db_ltran; typedef struct __db_ltran DB_LTRAN;
 struct __db_mpool;	typedef struct __db_mpool DB_MPOOL;
 struct __db_mpool_fstat;typedef struct __db_mpool_fstat DB_MPOOL_FSTAT;
+struct __db_mpool_hstat;typedef struct __db_mpool_hstat DB_MPOOL_HSTAT;
+struct __db_mpool_rstat;typedef struct __db_mpool_rstat DB_MPOOL_RSTAT;
+struct __db_mpool_iostat;typedef struct __db_mpool_iostat DB_MPOOL_IOSTAT;
 struct __db_mpool_stat;	typedef struct __db_mpool_stat DB_MPOOL_STAT;
 struct __db_mpoolfile;	typedef struct __db_mpoolfile DB_MPOOLFILE;
 struct __db_preplist;	typedef struct __db_preplist DB_PREPLIST;
@@ -618,6 +621,13 @@ struct __db_ltran {
 #define	DB_user_BEGIN		10000
 #define	DB_debug_FLAG		0x80000000
 
+/*
+ * DB_lz4_FLAG marks a log record whose body was LZ4-compressed by log_put;
+ * see log/log_compress.c.  Log cursors hand back the original record
+ * unless DB_LOG_RAW is set on the cursor.
+ */
+#define	DB_lz4_FLAG		0x40000000
+
 struct __db_log_cursor_stat {
     int incursor_count;
     int ondisk_count;
@@ -643,6 +653,9 @@ struct __db_log_cursor {
 
 	DBT	  c_dbt;		/* Return DBT. */
 
+	u_int8_t *c_zbuf;		/* Decompression buffer. */
+	u_int32_t c_zbuf_size;
+
 #define	DB_LOGC_BUF_SIZE	(32 * 1024)
 	u_int8_t *bp;			/* Allocated read buffer. */
 	u_int32_t bp_size;		/* Read buffer length in bytes. */
@@ -673,6 +686,7 @@ struct __db_log_cursor {
 #define	DB_LOG_SILENT_ERR	0x04	/* Turn-off error messages. */
 #define DB_LOG_NO_PANIC		0x08    /* Don't panic on error. */
 #define DB_LOG_CUSTOM_SIZE  0x10    /* This cursor has a custom size */
+#define DB_LOG_RAW		0x20    /* Return records as stored. */
 	u_int32_t flags;
     struct __db_log_cursor *next;
     struct __db_log_cursor *prev;
@@ -704,6 +718,21 @@ struct __db_log_stat {
 	u_int32_t st_regsize;		/* Region size. */
 	u_int32_t st_maxcommitperflush;	/* Max number of commits in a flush. */
 	u_int32_t st_mincommitperflush;	/* Min number of commits in a flush. */
+	u_int64_t st_gc_commits;	/* Commits made durable by syncs. */
+	u_int64_t st_gc_windows;	/* Syncs delayed for group commit. */
+	u_int64_t st_gc_wait_us;	/* Total group commit delay. */
+	u_int32_t st_gc_window_us;	/* Last group commit window. */
+	u_int32_t st_gc_fsync_us;	/* Average fsync latency. */
+	u_int32_t st_gc_arrival_us;	/* Average gap between commits. */
+	u_int64_t st_uring_writes;	/* Log writes issued through io_uring. */
+	u_int64_t st_uring_syncs;	/* Log syncs issued through io_uring. */
+	u_int64_t st_tier_syncs;	/* Log syncs made to the log tier. */
+	u_int64_t st_tier_full;		/* Log tier filled before draining. */
+	u_int64_t st_resv_puts;		/* Records copied outside the lock. */
+	u_int64_t st_resv_waits;	/* Waits for reserved copies to land. */
+	u_int64_t st_lz4_records;	/* Records compressed by log_put. */
+	u_int64_t st_lz4_in_bytes;	/* Their original size. */
+	u_int64_t st_lz4_out_bytes;	/* Their compressed size. */
 	u_int32_t st_total_wakeups;	/* Total writer td-wakeup. */
 	u_int32_t st_false_wakeups;	/* No-write td-wakeup counter. */
 	u_int32_t st_max_td_written;	/* Max flushed in a wakeup. */
@@ -901,6 +930,8 @@ struct __db_mpool_stat {
 	u_int64_t st_ro_levict;		/* Clean leaf pages forced from cache.*/
 	u_int64_t st_rw_levict;		/* Dirty leaf pages forced from cache.*/
 	u_int64_t st_pf_evict;		/* Prefault pages forced from  cache. */
+	u_int64_t st_scan_in;		/* Pages read in by table scans. */
+	u_int64_t st_scan_promote;	/* Scan pages re-referenced. */
 	u_int64_t st_rw_evict_skip;	/* Dirty pages skipped during evict. */
 	u_int64_t st_page_trickle;	/* Pages written by memp_trickle. */
 	u_int64_t st_pages;		/* Total number of pages. */
@@ -913,6 +944,8 @@ struct __db_mpool_stat {
 	u_int64_t st_hash_nowait;	/* Hash lock granted with nowait. */
 	u_int64_t st_hash_wait;		/* Hash lock granted after wait. */
 	u_int64_t st_hash_max_wait;	/* Max hash lock granted after wait. */
+	u_int64_t st_hash_opt_hit;	/* Hits pinned without hash lock. */
+	u_int64_t st_hash_opt_fallback;	/* Unlocked pins needing the lock. */
 	u_int64_t st_region_nowait;	/* Region lock granted with nowait. */
 	u_int64_t st_region_wait;	/* Region lock granted after wait. */
 	u_int64_t st_alloc;		/* Number of page allocations. */
@@ -922,6 +955,13 @@ struct __db_mpool_stat {
 	u_int64_t st_alloc_max_pages;	/* Max checked during allocation. */
 	u_int64_t st_ckp_pages_sync;	/* Number of pages sync'd using perfect ckp. */
 	u_int64_t st_ckp_pages_skip;	/* Number of pages skipped using perfect ckp. */
+	u_int64_t st_ctier_hit;		/* Misses filled from compressed tier. */
+	u_int64_t st_ctier_miss;	/* Misses not in compressed tier. */
+	u_int64_t st_ctier_insert;	/* Pages saved to compressed tier. */
+	u_int64_t st_ctier_evict;	/* Pages dropped from compressed tier. */
+	u_int64_t st_ctier_reject;	/* Pages that didn't compress enough. */
+	u_int64_t st_ctier_pages;	/* Pages in compressed tier. */
+	u_int64_t st_ctier_bytes;	/* Bytes used by compressed tier. */
 };
 
 /* Mpool file statistics structure. */
@@ -940,6 +980,39 @@ struct __db_mpool_fstat {
 	u_int64_t st_page_out;		/* Pages written out. */
 	u_int64_t st_ro_merges;		/* Read merges performed. */
 	u_int64_t st_rw_merges;		/* Write merges performed. */
+					/* By btree level; 0 is not btree,
+					   the last counts deeper levels too. */
+#define	MPOOL_STAT_LEVELS	8
+	u_int64_t st_level_hit[MPOOL_STAT_LEVELS];
+	u_int64_t st_level_miss[MPOOL_STAT_LEVELS];
+	u_int64_t st_level_evict[MPOOL_STAT_LEVELS];
+};
+
+/* Mpool residency of one file at one btree level. */
+struct __db_mpool_rstat {
+	char *file_name;		/* File name. */
+	u_int32_t level;		/* As st_level_hit. */
+	u_int64_t resident;		/* Pages in the cache. */
+	u_int64_t dirty;		/* Dirty pages in the cache. */
+	u_int64_t accesses;		/* Gets since they were read in. */
+};
+
+/* Mpool residency of one range of pages of a file. */
+struct __db_mpool_hstat {
+	char *file_name;		/* File name. */
+	db_pgno_t first_pgno;		/* Range of pages. */
+	db_pgno_t last_pgno;
+	u_int64_t resident;		/* Pages in the cache. */
+	u_int64_t accesses;		/* Gets since they were read in. */
+};
+
+/* I/O of one file, by file id, since the environment was opened. */
+struct __db_mpool_iostat {
+	u_int64_t st_faults;		/* Gets that missed the cache. */
+	u_int64_t st_reads;		/* Pages read from disk. */
+	u_int64_t st_read_bytes;	/* Bytes read from disk. */
+	u_int64_t st_writes;		/* Pages written to disk. */
+	u_int64_t st_write_bytes;	/* Bytes written to disk. */
 };
 
 /*******************************************************
@@ -1794,6 +1867,8 @@ struct __db {
 	int is_free;
 
 	genid_hash *pg_hash;
+	u_int32_t pg_hash_keylen;	/* 0: genid keys, else exact key size of
+					   a unique index hashed by fingerprint */
 
 	dbp_bthash_stat pg_hash_stat;
 
@@ -2172,6 +2247,10 @@ struct __lc_cache_entry {
 struct __lc_cache {
 	int nent;
 	int memused;
+	u_int64_t hits;
+	u_int64_t misses;
+	u_int64_t evictions;	/* transactions dropped to make room */
+	u_int64_t trimmed;	/* transactions cut back to their LSNs */
 	hash_t *txnid_hash;
 	struct __lc_cache_entry *ent;
 	LISTC_T(struct __lc_cache_entry) lru;
@@ -2189,6 +2268,10 @@ typedef int (*collect_locks_f)(void *args, int64_t threadid, int32_t lockerid,
 		const char *mode, const char *status, const char *table,
 		int64_t page, const char *rectype);
 
+typedef int (*collect_lock_partitions_f)(void *args, const char *type,
+		int partition, u_int64_t acquired, u_int64_t contended,
+		u_int64_t waits);
+
 /* Database Environment handle. */
 struct __db_env {
 	/*******************************************************
@@ -2444,6 +2527,8 @@ struct __db_env {
 	int  (*lock_get) __P((DB_ENV *,
 		u_int32_t, u_int32_t, const DBT *, db_lockmode_t, DB_LOCK *));
     int  (*lock_query) __P((DB_ENV *, u_int32_t, const DBT *, db_lockmode_t));
+	int  (*lock_reget) __P((DB_ENV *,
+		u_int32_t, const DB_LOCK *, DB_LOCK *));
 	int  (*lock_put) __P((DB_ENV *, DB_LOCK *));
 	int  (*lock_id) __P((DB_ENV *, u_int32_t *));
 	int  (*lock_id_flags) __P((DB_ENV *, u_int32_t *, u_int32_t));
@@ -2452,6 +2537,8 @@ struct __db_env {
 	int  (*lock_id_set_logical_abort) __P((DB_ENV *, u_int32_t));
 	int  (*lock_stat) __P((DB_ENV *, DB_LOCK_STAT **, u_int32_t));
 	int  (*collect_locks) __P((DB_ENV *, collect_locks_f, void *arg));
+	int  (*collect_lock_partitions)
+		__P((DB_ENV *, collect_lock_partitions_f, void *arg));
 	int  (*lock_locker_lockcount)
 		__P((DB_ENV *, u_int32_t id, u_int32_t *nlocks));
 	int  (*lock_locker_pagelockcount)
@@ -2481,6 +2568,10 @@ struct __db_env {
 		int (*)(DB_ENV *, db_pgno_t, void *, DBT *)));
 	int  (*memp_stat) __P((DB_ENV *,
 		DB_MPOOL_STAT **, DB_MPOOL_FSTAT ***, u_int32_t));
+	int  (*memp_residency) __P((DB_ENV *, DB_MPOOL_RSTAT **, u_int32_t *,
+		DB_MPOOL_HSTAT **, u_int32_t *, u_int32_t));
+	int  (*memp_iostat) __P((DB_ENV *, const u_int8_t *,
+		DB_MPOOL_IOSTAT *));
 	int  (*memp_sync) __P((DB_ENV *, DB_LSN *));
 	int  (*memp_dump) __P((DB_ENV *, SBUF2 *, u_int64_t maxpages));
 	int  (*memp_load) __P((DB_ENV *, SBUF2 *));
@@ -2714,6 +2805,8 @@ struct __db_env {
 	int(*trigger_ispaused) __P((DB_ENV *, const char *));
 	int(*trigger_pause) __P((DB_ENV *, const char *));
 	int(*trigger_unpause) __P((DB_ENV *, const char *));
+	int(*trigger_seq) __P((DB_ENV *, const char *, u_int64_t *));
+	int(*trigger_wait) __P((DB_ENV *, const char *, u_int64_t, int));
 
 	int (*pgin[DB_TYPE_MAX]) __P((DB_ENV *, db_pgno_t, void *, DBT *));
 	int (*pgout[DB_TYPE_MAX]) __P((DB_ENV *, db_pgno_t, void *, DBT *));
@@ -2898,6 +2991,10 @@ extern int gbl_bb_berkdb_enable_memp_timing;
 extern int gbl_bb_berkdb_enable_memp_pg_timing;
 extern int gbl_bb_berkdb_enable_shalloc_timing;
 
+/* Called after a lock wait with the lock object, requested mode and wait */
+extern void (*gbl_bb_log_lock_waits_fn)(const void *, size_t sz, int mode,
+    u_int64_t waitus);
+
 struct berkdb_deadlock_info {
 	u_int32_t lid;
 };
@@ -407,7 +407,9 @@ ufid_for_recovery_record(DB_ENV *env, DB_LSN *lsn, int rectype,
 		} else {
 			LOGCOPY_32(&fileid, (char *)dbt->data + off);
 			DB *dbp = NULL;
-			__dbreg_id_to_db(env, NULL, &dbp, fileid, 0, lsn, 0);
+			if (__dbreg_id_to_db(env, NULL, &dbp, fileid, 0, lsn,
+			    0) != 0 || dbp == NULL)
+				return (0);
 			is_fuid = 1;
 			memcpy(fuid, (char *)dbp->fileid, DB_FILE_ID_LEN);
 		}
@@ -193,7 +193,7 @@ __db_pitem_opcode(dbc, pagep, indx, nbytes, hdr, data, opcode)
 	/* If there is an active Lua trigger/consumer, wake it up. */
 	struct __db_trigger_subscription *t = dbp->trigger_subscription;
 	if (t && t->active && (indx & 1)) {
-		Pthread_cond_signal(&t->cond);
+		__db_trigger_notify(t);
 	}
 
 	/*
@@ -27,6 +27,7 @@
 #include "dbinc/btree.h"
 #include "dbinc/lock.h"
 #include "dbinc/log.h"
+#include "dbinc/mp.h"
 #include "dbinc/txn.h"
 #include "dbinc_auto/dbreg_auto.h"
 #include "dbinc_auto/dbreg_ext.h"
@@ -119,3 +120,82 @@ __db_ispgcompactible(dbp, pgno, dbt, ff)
 		ret = t_ret;
 	return (ret);
 }
+
+struct bdb_state_tag;
+int send_pg_compact_req(struct bdb_state_tag *bdb_state, int32_t fileid,
+    uint32_t size, void *data);
+
+/*
+ * __db_pgcompact_sweep --
+ *	Look at up to npages pages of the btree starting at *pgnop, and queue
+ *	the leaf pages sparser than ff for compaction.  *pgnop is advanced
+ *	past the pages looked at, and set to PGNO_INVALID at the end of the
+ *	file.  The number of leaf pages seen, the bytes used on them and the
+ *	number of pages queued are added to *nleafp, *usedp and *nqueuedp.
+ *
+ * PUBLIC: int __db_pgcompact_sweep __P((DB *, db_pgno_t *, u_int32_t,
+ * PUBLIC:     double, u_int64_t *, u_int64_t *, u_int64_t *));
+ */
+int
+__db_pgcompact_sweep(dbp, pgnop, npages, ff, nleafp, usedp, nqueuedp)
+	DB *dbp;
+	db_pgno_t *pgnop;
+	u_int32_t npages;
+	double ff;
+	u_int64_t *nleafp;
+	u_int64_t *usedp;
+	u_int64_t *nqueuedp;
+{
+	DB_ENV *dbenv;
+	DB_MPOOLFILE *dbmfp;
+	DBT dbt;
+	PAGE *h;
+	db_pgno_t pgno, last, end;
+	u_int32_t fullsz, freesz;
+	int ret, sparse;
+
+	dbenv = dbp->dbenv;
+	dbmfp = dbp->mpf;
+	fullsz = dbp->pgsize - SIZEOF_PAGE;
+
+	/* Compaction requests name the file by its log file id. */
+	if (dbp->log_filename == NULL)
+		return (EINVAL);
+
+	__memp_last_pgno(dbmfp, &last);
+
+	/* Page 0 is the meta page. */
+	pgno = (*pgnop == PGNO_INVALID) ? 1 : *pgnop;
+	for (end = pgno + npages; pgno <= last && pgno < end; ++pgno) {
+		/* Don't let the sweep push the working set out of the cache. */
+		if ((ret = __memp_fget(dbmfp, &pgno, DB_MPOOL_NOCACHE, &h)) != 0)
+			return (ret);
+
+		/* Without the page lock this is only an estimate; the
+		   compaction check below takes the lock and looks again. */
+		sparse = 0;
+		if (TYPE(h) == P_LBTREE && NUM_ENT(h) > 0) {
+			freesz = P_FREESPACE(dbp, h);
+			++*nleafp;
+			*usedp += fullsz - freesz;
+			sparse = freesz >= (1 - ff) * fullsz;
+		}
+
+		if ((ret = __memp_fput(dbmfp, h, DB_MPOOL_NOCACHE)) != 0)
+			return (ret);
+
+		if (!sparse)
+			continue;
+
+		memset(&dbt, 0, sizeof(dbt));
+		if (__db_ispgcompactible(dbp, pgno, &dbt, ff) == 0 &&
+		    send_pg_compact_req(dbenv->app_private,
+		    dbp->log_filename->id, dbt.size, dbt.data) == 0)
+			++*nqueuedp;
+		if (dbt.data != NULL)
+			__os_free(dbenv, dbt.data);
+	}
+
+	*pgnop = (pgno > last) ? PGNO_INVALID : pgno;
+	return (0);
+}
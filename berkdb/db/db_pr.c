@@ -763,6 +763,7 @@ __db_prdbt(dbtp, checkprint, prefix, handle, callback, is_recno, vdp)
 #define	DBTBUFLEN	100
 	u_int8_t *p, *hp;
 	char buf[DBTBUFLEN], hbuf[DBTBUFLEN];
+	char obuf[4096], *op;
 
 	if (vdp != NULL) {
 		/*
@@ -818,29 +819,36 @@ __db_prdbt(dbtp, checkprint, prefix, handle, callback, is_recno, vdp)
 
 		if (ret != 0)
 			return (ret);
-	} else if (checkprint) {
-		for (len = dbtp->size, p = dbtp->data; len--; ++p)
-			if (isprint((int)*p)) {
-				if (*p == '\\' &&
-				    (ret = callback(handle, "\\")) != 0)
-					return (ret);
-				snprintf(buf, DBTBUFLEN, "%c", *p);
-				if ((ret = callback(handle, buf)) != 0)
+	} else {
+		/*
+		 * Encode into obuf and hand the callback a chunk at a time
+		 * rather than a byte at a time; the output is the same.  Each
+		 * byte takes at most 3 characters.
+		 */
+		for (len = dbtp->size, p = dbtp->data, op = obuf; len--; ++p) {
+			if (op + 3 >= obuf + sizeof(obuf)) {
+				*op = '\0';
+				if ((ret = callback(handle, obuf)) != 0)
 					return (ret);
+				op = obuf;
+			}
+			if (!checkprint) {
+				*op++ = hex[(u_int8_t)(*p & 0xf0) >> 4];
+				*op++ = hex[*p & 0x0f];
+			} else if (isprint((int)*p)) {
+				if (*p == '\\')
+					*op++ = '\\';
+				*op++ = *p;
 			} else {
-				snprintf(buf, DBTBUFLEN, "\\%c%c",
-				    hex[(u_int8_t)(*p & 0xf0) >> 4],
-				    hex[*p & 0x0f]);
-				if ((ret = callback(handle, buf)) != 0)
-					return (ret);
+				*op++ = '\\';
+				*op++ = hex[(u_int8_t)(*p & 0xf0) >> 4];
+				*op++ = hex[*p & 0x0f];
 			}
-	} else
-		for (len = dbtp->size, p = dbtp->data; len--; ++p) {
-			snprintf(buf, DBTBUFLEN, "%c%c",
-			    hex[(u_int8_t)(*p & 0xf0) >> 4], hex[*p & 0x0f]);
-			if ((ret = callback(handle, buf)) != 0)
-				return (ret);
 		}
+		*op = '\0';
+		if (op != obuf && (ret = callback(handle, obuf)) != 0)
+			return (ret);
+	}
 
 	return (callback(handle, "\n"));
 }
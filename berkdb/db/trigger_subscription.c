@@ -1,5 +1,7 @@
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
 #include <plhash.h>
 #include "dbinc/trigger_subscription.h"
 #include <locks_wrap.h>
@@ -27,8 +29,58 @@ struct __db_trigger_subscription *__db_get_trigger_subscription(const char *name
 		s->name = strdup(name);
 		Pthread_cond_init(&s->cond, NULL);
 		Pthread_mutex_init(&s->lock, NULL);
+		Pthread_cond_init(&s->seq_cond, NULL);
+		Pthread_mutex_init(&s->seq_lock, NULL);
 		hash_add(htab, s);
 	}
 	Pthread_mutex_unlock(&subscription_lk);
 	return s;
 }
+
+/*
+ * Wake whoever waits on this queue.  Only takes seq_lock if someone is
+ * waiting: a waiter registers before it looks at seq, so either we see it
+ * registered or it sees the new seq.
+ */
+void __db_trigger_notify(struct __db_trigger_subscription *t)
+{
+	__atomic_add_fetch(&t->seq, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&t->waiters, __ATOMIC_SEQ_CST) == 0)
+		return;
+	Pthread_mutex_lock(&t->seq_lock);
+	Pthread_cond_broadcast(&t->seq_cond);
+	Pthread_mutex_unlock(&t->seq_lock);
+}
+
+uint64_t __db_trigger_seq(struct __db_trigger_subscription *t)
+{
+	return __atomic_load_n(&t->seq, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Wait up to timeout_ms for seq to move past seen.
+ * Returns 0 if it did, ETIMEDOUT if it did not.
+ */
+int __db_trigger_wait(struct __db_trigger_subscription *t, uint64_t seen,
+    int timeout_ms)
+{
+	struct timespec ts;
+	struct timeval now;
+	int rc = 0;
+
+	gettimeofday(&now, NULL);
+	ts.tv_sec = now.tv_sec + timeout_ms / 1000;
+	ts.tv_nsec = now.tv_usec * 1000 + (timeout_ms % 1000) * 1000000L;
+	if (ts.tv_nsec >= 1000000000L) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000L;
+	}
+
+	Pthread_mutex_lock(&t->seq_lock);
+	__atomic_add_fetch(&t->waiters, 1, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&t->seq, __ATOMIC_SEQ_CST) == seen && rc == 0)
+		rc = pthread_cond_timedwait(&t->seq_cond, &t->seq_lock, &ts);
+	__atomic_sub_fetch(&t->waiters, 1, __ATOMIC_SEQ_CST);
+	Pthread_mutex_unlock(&t->seq_lock);
+	return __db_trigger_seq(t) != seen ? 0 : ETIMEDOUT;
+}
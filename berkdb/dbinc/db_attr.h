@@ -29,6 +29,7 @@ BERK_DEF_ATTR(check_applied_lsns_fatal, "Abort if check_applied_lsns fails", BER
 BERK_DEF_ATTR(check_applied_lsns_debug, "Lots of verbose trace for debugging applied LSNs.", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(sgio_enabled, "Do scatter gather I/O", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(sgio_max, "Max scatter gather I/O to do at one time", BERK_ATTR_TYPE_INTEGER, 10 * MEGABYTE)
+BERK_DEF_ATTR(mp_dio_align, "Align buffer pool pages for direct I/O so page reads and writes skip the bounce buffer", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(btpf_enabled, "Enables index pages read ahead", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(btpf_wndw_min, "Minimum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 100 )
 BERK_DEF_ATTR(btpf_wndw_max, "Maximum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 1000 )
@@ -36,15 +37,17 @@ BERK_DEF_ATTR(btpf_wndw_inc, "Increment factor for the number of pages read ahea
 BERK_DEF_ATTR(btpf_pg_gap, "Min. number of records to the page limit before read ahead", BERK_ATTR_TYPE_INTEGER, 0)
 BERK_DEF_ATTR(btpf_cu_gap, "How close a cursor should be (pages) to the prefaulted limit before prefaulting again", BERK_ATTR_TYPE_INTEGER, 5)
 BERK_DEF_ATTR(btpf_min_th, "Preload pages only if the tree has heigth less than this parameter", BERK_ATTR_TYPE_INTEGER, 1)
+BERK_DEF_ATTR(btpf_wndw_ms, "Size the read ahead window to what the cursor reads in this many ms (0 to grow by btpf_wndw_inc instead)", BERK_ATTR_TYPE_INTEGER, 100)
+BERK_DEF_ATTR(btpf_ovfl, "Also read ahead the overflow pages of the leaf pages read ahead", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(recovery_verify, "After recovery, run a full pass to make sure everything is applied", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(recovery_verify_fatal, "Abort if recovery_verify is set, and fails.", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(cache_lc, "Collect logs into LSN_COLLECTIONs as they come in", BERK_ATTR_TYPE_BOOLEAN, 0)
-BERK_DEF_ATTR(cache_lc_max, "Keep this many transactions around in LC cache", BERK_ATTR_TYPE_INTEGER, 16)
+BERK_DEF_ATTR(cache_lc_max, "Keep this many transactions around in LC cache", BERK_ATTR_TYPE_INTEGER, 64)
 BERK_DEF_ATTR(cache_lc_debug, "Lots of verbose messages out of LC cache system", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(cache_lc_trace_evictions, "Print a message at the point of eviction", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(cache_lc_trace_misses, "Print a message on cache miss", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(cache_lc_check, "Check LC cache system on every transaction", BERK_ATTR_TYPE_BOOLEAN, 0)
-BERK_DEF_ATTR(cache_lc_memlimit, "Limit total memory used by LC cache (0 = unlimited).", BERK_ATTR_TYPE_INTEGER, 2097152)
+BERK_DEF_ATTR(cache_lc_memlimit, "Limit total memory used by LC cache (0 = unlimited).", BERK_ATTR_TYPE_INTEGER, 16777216)
 BERK_DEF_ATTR(cache_lc_memlimit_tran, "Limit per transaction memory used by LC cache", BERK_ATTR_TYPE_INTEGER, 1048576)
 BERK_DEF_ATTR(consolidate_dbreg_ranges, "Combine adjacent dbreg ranges for same file", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(max_latch, "Size of latch array", BERK_ATTR_TYPE_INTEGER, 200000)
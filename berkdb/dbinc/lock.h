@@ -73,7 +73,7 @@ typedef struct
 } Comdb2LockDebug;
 
 #ifdef  __x86_64
-#define FLUFF uint8_t fluff[88]
+#define FLUFF uint8_t fluff[48]
 #else
 #define FLUFF uint8_t fluff[1]
 #endif
@@ -83,6 +83,11 @@ typedef struct
 	pthread_mutex_t	mtx;
 	Comdb2LockDebug	lock;
 	Comdb2LockDebug	unlock;
+	u_int64_t	nacquired;	/* times the mutex was taken */
+	u_int64_t	ncontended;	/* ... and had to wait for it */
+	u_int64_t	nwaits;		/* lock waits begun under it */
+	u_int64_t	nrequests;	/* lock gets on its objects */
+	u_int64_t	nreleases;	/* lock puts on its objects */
 	FLUFF;
 } PthreadMutexWithFluff;
 
@@ -90,9 +95,9 @@ typedef struct
 
 #ifdef  __x86_64
 #  ifdef __APPLE__
-#    define FLUFF uint8_t fluff[128]
+#    define FLUFF uint8_t fluff[88]
 #  else
-#    define FLUFF uint8_t fluff[152]
+#    define FLUFF uint8_t fluff[112]
 #  endif
 #else
 #define FLUFF uint8_t fluff[1]
@@ -101,6 +106,11 @@ typedef struct
 typedef struct
 {
 	pthread_mutex_t	mtx;
+	u_int64_t	nacquired;	/* times the mutex was taken */
+	u_int64_t	ncontended;	/* ... and had to wait for it */
+	u_int64_t	nwaits;		/* lock waits begun under it */
+	u_int64_t	nrequests;	/* lock gets on its objects */
+	u_int64_t	nreleases;	/* lock puts on its objects */
 	FLUFF;
 } PthreadMutexWithFluff;
 
@@ -402,6 +412,20 @@ do {									\
 #define	UNLOCKREGION(dbenv, lt)
 #endif
 
+/*
+ * Take a partition mutex, counting the acquisition and whether another
+ * thread held it.  The counters live in the mutex's padding and are only
+ * updated by the holder.
+ */
+#define lock_counted_mutex(m) \
+do { \
+	if (pthread_mutex_trylock(&(m)->mtx) != 0) { \
+		Pthread_mutex_lock(&(m)->mtx); \
+		(m)->ncontended++; \
+	} \
+	(m)->nacquired++; \
+} while (0)
+
 #ifdef LOCKMGRDBG
 #define lock_lockers(region) \
 do { \
@@ -415,7 +439,7 @@ do { \
 #define lock_obj_partition(region, partition)\
 do { \
 	assert((partition) < gbl_lk_parts); \
-	Pthread_mutex_lock(&(region)->obj_tab_mtx[(partition)].mtx); \
+	lock_counted_mutex(&(region)->obj_tab_mtx[(partition)]); \
 	(region)->obj_tab_mtx[(partition)].lock.file = __FILE__; \
 	(region)->obj_tab_mtx[(partition)].lock.func = __func__; \
 	(region)->obj_tab_mtx[(partition)].lock.line = __LINE__; \
@@ -425,7 +449,7 @@ do { \
 #define lock_locker_partition(region, partition) \
 do { \
 	assert((partition) < gbl_lkr_parts); \
-	Pthread_mutex_lock(&(region)->locker_tab_mtx[(partition)].mtx); \
+	lock_counted_mutex(&(region)->locker_tab_mtx[(partition)]); \
 	(region)->locker_tab_mtx[(partition)].lock.file = __FILE__; \
 	(region)->locker_tab_mtx[(partition)].lock.func = __func__; \
 	(region)->locker_tab_mtx[(partition)].lock.line = __LINE__; \
@@ -482,8 +506,8 @@ do { \
 #else // no LOCKMGRDBG
 
 #define lock_lockers(region) Pthread_mutex_lock(&(region)->lockers_mtx.mtx)
-#define lock_obj_partition(region, partition) Pthread_mutex_lock(&(region)->obj_tab_mtx[(partition)].mtx)
-#define lock_locker_partition(region, partition) Pthread_mutex_lock(&(region)->locker_tab_mtx[(partition)].mtx)
+#define lock_obj_partition(region, partition) lock_counted_mutex(&(region)->obj_tab_mtx[(partition)])
+#define lock_locker_partition(region, partition) lock_counted_mutex(&(region)->locker_tab_mtx[(partition)])
 #define lock_detector(region) Pthread_mutex_lock(&(region)->dd_mtx.mtx)
 #define unlock_lockers(region) Pthread_mutex_unlock(&(region)->lockers_mtx.mtx)
 #define unlock_obj_partition(region, partition) Pthread_mutex_unlock(&region->obj_tab_mtx[partition].mtx)
@@ -60,6 +60,7 @@ struct __fname {
  *	The log subsystem information.
  *******************************************************/
 struct __db_log;	typedef struct __db_log DB_LOG;
+struct __db_log_tier;	typedef struct __db_log_tier DB_LOG_TIER;
 struct __hdr;		typedef struct __hdr HDR;
 struct __log;		typedef struct __log LOG;
 struct __log_persist;	typedef struct __log_persist LOGP;
@@ -101,6 +102,14 @@ struct __db_log {
 
 	u_int8_t *bufp;			/* Region buffer. */
 
+/*
+ * The io_uring log writer is only used while holding the flush mutex.
+ */
+	DB_OS_URING *uring;		/* Ring for log writes and syncs. */
+	int	  uring_failed;		/* Ring setup failed; don't retry. */
+
+	DB_LOG_TIER *tier;		/* Commit log tier, see log_tier.c. */
+
 /* These fields are not protected. */
 	DB_ENV	 *dbenv;		/* Reference to error information. */
 	REGINFO	  reginfo;		/* Region information. */
@@ -260,6 +269,22 @@ struct __log {
 	u_int32_t ncommit;		/* Number of txns waiting to commit. */
 
 	DB_LSN	  t_lsn;		/* LSN of first commit */
+
+	/*
+	 * Adaptive group commit: moving averages of the time between
+	 * flush requests and of fsync latency, in microseconds.
+	 */
+	u_int64_t gc_last_arrival;	/* Time of the last flush request. */
+	u_int32_t gc_arrival_us;	/* Average gap between requests. */
+	u_int32_t gc_fsync_us;		/* Average fsync latency. */
+
+	/*
+	 * Records whose buffer space has been reserved but whose bytes are
+	 * still being copied in outside the region lock.  Anything that
+	 * reads or writes the buffer waits for this to drain; while the
+	 * region lock is held it can only go down.
+	 */
+	u_int32_t copies_pending;
 	SH_TAILQ_HEAD(__commit, __db_commit) commits;/* list of txns waiting to commit. */
 	SH_TAILQ_HEAD(__free, __db_commit) free_commits;/* free list of commit structs. */
 
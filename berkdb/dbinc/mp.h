@@ -171,6 +171,14 @@ struct __mpool {
 	 * know that none exist.
 	 */
 	DB_LSN	  trickle_lsn;		/* Maximum checkpoint LSN. */
+
+	/*
+	 * Fuzzy checkpoint pacing: the log position and time of the last
+	 * fuzzy pass, and a running average of the log generation rate.
+	 */
+	DB_LSN	  fuzzy_lsn;		/* End of log at the last pass. */
+	int64_t	  fuzzy_ms;		/* Time of the last pass. */
+	u_int64_t fuzzy_log_rate;	/* Log bytes per second. */
 };
 
 typedef SH_TAILQ_HEAD(HashTab, __bh) HashTab;
@@ -179,8 +187,49 @@ struct __db_mpool_hash {
 	HashTab 	hash_bucket;	/* Head of bucket. */
 	uint32_t 	hash_page_dirty;/* Count of dirty pages. */
 	u_int32_t	hash_priority;	/* Minimum priority of bucket buffer. */
+	u_int32_t	hash_optreaders;/* Unlocked readers walking bucket. */
 };
 
+/*
+ * Optimistic buffer lookup.
+ *
+ * __memp_fget may walk a bucket without its mutex and pin a buffer that is
+ * already pinned by someone else, with a compare-and-swap on its reference
+ * count.  To make that safe:
+ *   - every change to BH->ref is atomic, even under the bucket mutex;
+ *   - a buffer is never unlinked and then freed or reused while unlocked
+ *     readers are walking its bucket (__memp_bhfree drains them);
+ *   - a buffer is published into a bucket only once its header is
+ *     initialized, and carries BH_TRASH until its contents are valid.
+ */
+#define	BH_REF_INC(bhp)							\
+	__atomic_add_fetch(&(bhp)->ref, 1, __ATOMIC_SEQ_CST)
+#define	BH_REF_DEC(bhp)							\
+	__atomic_sub_fetch(&(bhp)->ref, 1, __ATOMIC_SEQ_CST)
+#define	MP_HASH_PUBLISH()	__atomic_thread_fence(__ATOMIC_SEQ_CST)
+/*
+ * The full fences order the evictor's unlink before its read of the reader
+ * count, and a reader's increment before its walk: either the evictor sees
+ * the reader, or the reader doesn't see the buffer.  Readers are short, so
+ * spin briefly, then yield rather than burn the bucket mutex holder's CPU.
+ */
+#define	MP_HASH_READER_ENTER(hp) do {					\
+	(void)__atomic_add_fetch(&(hp)->hash_optreaders, 1, __ATOMIC_SEQ_CST);\
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);			\
+} while (0)
+#define	MP_HASH_READER_EXIT(hp)						\
+	(void)__atomic_sub_fetch(&(hp)->hash_optreaders, 1, __ATOMIC_SEQ_CST)
+#define	MP_HASH_DRAIN_SPINS	64
+#define	MP_HASH_DRAIN(hp) do {						\
+	int __spins = 0;						\
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);			\
+	while (__atomic_load_n(&(hp)->hash_optreaders, __ATOMIC_SEQ_CST))\
+		if (++__spins >= MP_HASH_DRAIN_SPINS) {			\
+			__spins = 0;					\
+			__os_yield(NULL, 0);				\
+		}							\
+} while (0)
+
 /*
  * The base mpool priority is 1/4th of the name space, or just under 2^30.
  * When the LRU counter wraps, we shift everybody down to a base-relative
@@ -290,6 +339,14 @@ struct __mpoolfile {
 	u_int32_t  flags;
 
     int32_t    flushed;
+
+	/*
+	 * With chg_gen_on set, chg_gen is bumped every time one of our
+	 * pages is marked dirty, so readers can tell whether anything in
+	 * the file changed since they last looked.
+	 */
+	u_int32_t  chg_gen_on;
+	u_int32_t  chg_gen;
 };
 
 /*
@@ -310,6 +367,7 @@ struct __bh {
 #define	BH_TRASH	0x020		/* Page is garbage. */
 #define BH_NOINCR	0x040		/* Don't increment lru_cache. */
 #define BH_PREFAULT	0x080		/* prefault pages */
+#define	BH_SCAN		0x100		/* Read in by a table scan. */
 	u_int16_t	flags;
 	u_int16_t	generation;	/* This changes before page changes */
 	u_int32_t	priority;	/* LRU priority. */
@@ -333,5 +391,14 @@ struct __bh {
 	u_int8_t   buf[1];		/* Variable length data. */
 };
 
+/*
+ * MP_LEVEL --
+ *	The btree level of a page for the per-level statistics.  Level and
+ *	type are single bytes, so this works on unconverted pages too.
+ */
+#define	MP_LEVEL(buf)							\
+	(!ISINTERNAL(buf) && !ISLEAF(buf) ? 0 :				\
+	LEVEL(buf) >= MPOOL_STAT_LEVELS ? MPOOL_STAT_LEVELS - 1 : LEVEL(buf))
+
 #include "dbinc_auto/mp_ext.h"
 #endif /* !_DB_MP_H_ */
@@ -28,6 +28,12 @@ extern "C" {
 #define	DB_OSO_TRUNC	0x0100		/* POSIX: O_TRUNC */
 #define DB_OSO_OSYNC	0x0200		/* O_SYNC */
 
+/*
+ * Buffer, size and offset alignment for I/O on files opened with
+ * DB_OSO_DIRECT.
+ */
+#define	DB_DIO_ALIGN	512
+
 /*
  * Seek options understood by __os_seek.
  */
@@ -79,6 +85,9 @@ struct __fh_t {
 	u_int8_t flags;
 };
 
+/* io_uring handle, see os/os_uring.c. */
+typedef struct __os_uring DB_OS_URING;
+
 #if defined(__cplusplus)
 }
 #endif
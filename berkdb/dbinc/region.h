@@ -222,6 +222,7 @@ struct __db_reginfo_t {		/* __db_r_attach IN parameters. */
 #define	REGION_JOIN_OK		0x04	/* Caller is looking for a match. */
 	u_int32_t   flags;
 	int         fd;
+	size_t      hugemap_len;	/* Length mapped on huge pages, or 0. */
 };
 
 /*
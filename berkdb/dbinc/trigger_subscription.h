@@ -10,8 +10,22 @@ struct __db_trigger_subscription {
 	uint8_t status;
 	pthread_cond_t cond;
 	pthread_mutex_t lock;
+
+	/*
+	 * Bumped on every insert and status change.  Consumers wait on
+	 * seq_cond for it to move past the value they last saw.  seq_lock is
+	 * only held to wait or to wake waiters, never while holding page
+	 * locks, so inserters can take it where they could not take lock.
+	 */
+	uint64_t seq;
+	int waiters;
+	pthread_cond_t seq_cond;
+	pthread_mutex_t seq_lock;
 };
 
 struct __db_trigger_subscription *__db_get_trigger_subscription(const char *);
+void __db_trigger_notify(struct __db_trigger_subscription *);
+uint64_t __db_trigger_seq(struct __db_trigger_subscription *);
+int __db_trigger_wait(struct __db_trigger_subscription *, uint64_t, int);
 
 #endif //TRIGGER_SUBSCRIPTION_H
@@ -186,6 +186,22 @@ int
 __db_shalloc(p, len, align, retp)
 	void *p, *retp;
 	size_t len, align;
+{
+	return (__db_shalloc_at(p, len, align, 0, retp));
+}
+
+/*
+ * __db_shalloc_at --
+ *	Allocate some space from the shared region, aligning the address
+ *	off bytes into the allocation rather than its start.  off must be
+ *	a multiple of a db_align_t.  Malloc'd regions ignore the alignment.
+ *
+ * PUBLIC: int __db_shalloc_at __P((void *, size_t, size_t, size_t, void *));
+ */
+int
+__db_shalloc_at(p, len, align, off, retp)
+	void *p, *retp;
+	size_t len, align, off;
 {
 	struct __data *elp;
 	size_t *sp;
@@ -229,8 +245,8 @@ __db_shalloc(p, len, align, retp)
 		 *      + Find the closest previous correctly-aligned address.
 		 */
 		rp = (u_int8_t *)elp + sizeof(size_t) + elp->len;
-		rp = (u_int8_t *)rp - len;
-		rp = (u_int8_t *)((db_alignp_t) rp & ~(align - 1));
+		rp = (u_int8_t *)rp - len + off;
+		rp = (u_int8_t *)((db_alignp_t) rp & ~(align - 1)) - off;
 
 		/*
 		 * Rp may now point before elp->links, in which case the chunk
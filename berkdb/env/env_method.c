@@ -96,6 +96,8 @@ static int __dbenv_trigger_close __P((DB_ENV *, const char *));
 static int __dbenv_trigger_ispaused __P((DB_ENV *, const char *));
 static int __dbenv_trigger_pause __P((DB_ENV *, const char *));
 static int __dbenv_trigger_unpause __P((DB_ENV *, const char *));
+static int __dbenv_trigger_seq __P((DB_ENV *, const char *, u_int64_t *));
+static int __dbenv_trigger_wait __P((DB_ENV *, const char *, u_int64_t, int));
 int __dbenv_apply_log __P((DB_ENV *, unsigned int, unsigned int, int64_t,
             void*, int));
 size_t __dbenv_get_log_header_size __P((DB_ENV*)); 
@@ -341,6 +343,8 @@ __dbenv_init(dbenv)
 	dbenv->trigger_ispaused = __dbenv_trigger_ispaused;
 	dbenv->trigger_pause = __dbenv_trigger_pause;
 	dbenv->trigger_unpause = __dbenv_trigger_unpause;
+	dbenv->trigger_seq = __dbenv_trigger_seq;
+	dbenv->trigger_wait = __dbenv_trigger_wait;
 
 	return (0);
 }
@@ -1414,8 +1418,8 @@ __dbenv_trigger_open(dbenv, fname)
 	Pthread_mutex_lock(&t->lock);
 	DB_ASSERT(t->status == TRIGGER_SUBSCRIPTION_CLOSED);
 	t->status = TRIGGER_SUBSCRIPTION_OPEN;
-	Pthread_cond_signal(&t->cond);
 	Pthread_mutex_unlock(&t->lock);
+	__db_trigger_notify(t);
 	return 0;
 }
 
@@ -1429,8 +1433,8 @@ __dbenv_trigger_close(dbenv, fname)
 	Pthread_mutex_lock(&t->lock);
 	DB_ASSERT(t->status == TRIGGER_SUBSCRIPTION_OPEN);
 	t->status = TRIGGER_SUBSCRIPTION_CLOSED;
-	Pthread_cond_signal(&t->cond);
 	Pthread_mutex_unlock(&t->lock);
+	__db_trigger_notify(t);
 	return 0;
 }
 
@@ -1458,8 +1462,8 @@ __dbenv_trigger_pause(dbenv, fname)
 	Pthread_mutex_lock(&t->lock);
 	DB_ASSERT(t->status == TRIGGER_SUBSCRIPTION_OPEN);
 	t->status = TRIGGER_SUBSCRIPTION_PAUSED;
-	Pthread_cond_signal(&t->cond);
 	Pthread_mutex_unlock(&t->lock);
+	__db_trigger_notify(t);
 	return 0;
 }
 
@@ -1473,7 +1477,33 @@ __dbenv_trigger_unpause(dbenv, fname)
 	Pthread_mutex_lock(&t->lock);
 	DB_ASSERT(t->status == TRIGGER_SUBSCRIPTION_PAUSED);
 	t->status = TRIGGER_SUBSCRIPTION_OPEN;
-	Pthread_cond_signal(&t->cond);
 	Pthread_mutex_unlock(&t->lock);
+	__db_trigger_notify(t);
 	return 0;
 }
+
+static int
+__dbenv_trigger_seq(dbenv, fname, seq)
+	DB_ENV *dbenv;
+	const char *fname;
+	u_int64_t *seq;
+{
+	*seq = __db_trigger_seq(__db_get_trigger_subscription(fname));
+	return 0;
+}
+
+/*
+ * Wait for an insert into, or a status change of, the queue since the
+ * caller read seen from trigger_seq.  Returns 0 if there was one,
+ * ETIMEDOUT if there was not after timeout_ms.
+ */
+static int
+__dbenv_trigger_wait(dbenv, fname, seen, timeout_ms)
+	DB_ENV *dbenv;
+	const char *fname;
+	u_int64_t seen;
+	int timeout_ms;
+{
+	return __db_trigger_wait(__db_get_trigger_subscription(fname), seen,
+	    timeout_ms);
+}
@@ -55,6 +55,7 @@ static const char revid[] =
 
 #include "list.h"
 #include "logmsg.h"
+#include "thdpool.h"
 
 #ifndef TESTSUITE
 void bdb_get_writelock(void *bdb_state,
@@ -87,6 +88,7 @@ static int __log_find_latest_checkpoint_before_lsn_try_harder(DB_ENV *dbenv,
 	DB_LOGC *logc, DB_LSN *max_lsn, DB_LSN *foundlsn);
 int gbl_ufid_dbreg_test = 0;
 int gbl_ufid_log = 0;
+extern int gbl_recovery_parallel_redo;
 
 /* Get the recovery LSN. */
 int
@@ -965,9 +967,14 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 	void *txninfo;
 	DB_LSN logged_checkpoint_lsn;
 	int start_recovery_at_dbregs;
+	struct __recovery_processor *redo;
+	struct thdpool *redo_pool;
 
 	COMPQUIET(nfiles, (double)0);
 
+	redo = NULL;
+	redo_pool = NULL;
+
 	logc = NULL;
 	ckp_args = NULL;
 	dtab = NULL;
@@ -1426,6 +1433,25 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 
 	logmsg(LOGMSG_WARN, "running forward pass from %u:%u -> %u:%u\n",
 		lsn.file, lsn.offset, stop_lsn.file, stop_lsn.offset);
+
+	/*
+	 * Committed page records can be redone in parallel, split by page.
+	 * The recovery workers are only created once recovery is done, so
+	 * bring up a pool of our own if there isn't one yet.
+	 */
+	if (gbl_recovery_parallel_redo > 0 &&
+		dbenv->num_recovery_worker_threads > 0) {
+		if (dbenv->recovery_workers == NULL) {
+			redo_pool = thdpool_create("recovery_redo", 0);
+			thdpool_set_maxthds(redo_pool,
+				dbenv->num_recovery_worker_threads);
+			thdpool_set_maxqueue(redo_pool, 8000);
+			dbenv->recovery_workers = redo_pool;
+		}
+		if ((ret = __rep_redo_batch_open(dbenv, txninfo, &redo)) != 0)
+			goto err;
+	}
+
 	for (ret = __log_c_get(logc, &lsn, &data, DB_NEXT);
 		ret == 0; ret = __log_c_get(logc, &lsn, &data, DB_NEXT)) {
 		/*
@@ -1448,6 +1474,16 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 			dbenv->db_feedback(dbenv, DB_RECOVER, progress);
 		}
 
+		if (redo != NULL) {
+			if ((ret = __rep_redo_batch_add(dbenv, redo, &data,
+				&lsn)) == 0)
+				continue;
+			if (ret != DB_NOTFOUND)
+				goto msgerr;
+			if ((ret = __rep_redo_batch_flush(dbenv, redo)) != 0)
+				goto msgerr;
+		}
+
 		ret = __db_dispatch(dbenv, dbenv->recover_dtab,
 			dbenv->recover_dtab_size, &data, &lsn,
 			DB_TXN_FORWARD_ROLL, txninfo);
@@ -1462,6 +1498,16 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 
 	if (ret != 0 && ret != DB_NOTFOUND)
 		goto err;
+	if (redo != NULL) {
+		if ((ret = __rep_redo_batch_flush(dbenv, redo)) != 0)
+			goto err;
+		__rep_redo_batch_close(dbenv, redo);
+		redo = NULL;
+	}
+	if (redo_pool != NULL) {
+		dbenv->recovery_workers = NULL;
+		thdpool_destroy(&redo_pool, -1);
+	}
 	dbenv->recovery_pass = DB_TXN_NOT_IN_RECOVERY;
 
 	/*
@@ -1668,6 +1714,13 @@ msgerr:	__db_err(dbenv,
 err:	if (logc != NULL && (t_ret = __log_c_close(logc)) != 0 && ret == 0)
 		ret = t_ret;
 
+	if (redo != NULL)
+		__rep_redo_batch_close(dbenv, redo);
+	if (redo_pool != NULL) {
+		dbenv->recovery_workers = NULL;
+		thdpool_destroy(&redo_pool, -1);
+	}
+
 	if (txninfo != NULL)
 		__db_txnlist_end(dbenv, txninfo);
 
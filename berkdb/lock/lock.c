@@ -79,7 +79,8 @@ unsigned gbl_ddlk = 0;
 void comdb2_dump_blocker(unsigned int);
 extern void comdb2_cheapstack_sym(FILE *f, char *fmt, ...);
 
-void (*gbl_bb_log_lock_waits_fn) (const void *, size_t sz, int waitms) = NULL;
+void (*gbl_bb_log_lock_waits_fn) (const void *, size_t sz, int mode,
+    u_int64_t waitus) = NULL;
 
 static int __lock_freelock __P((DB_LOCKTAB *,
 	struct __db_lock *, DB_LOCKER *, u_int32_t));
@@ -2178,8 +2179,6 @@ __lock_get_internal_int(lt, locker, in_locker, flags, obj, lock_mode, timeout,
 		abort();
 	}
 
-	region->stat.st_nrequests++;
-
 	sh_locker = *in_locker;
 
 	if (sh_locker == NULL) {
@@ -2263,6 +2262,13 @@ __lock_get_internal_int(lt, locker, in_locker, flags, obj, lock_mode, timeout,
 	}
 	lock->partition = partition;
 
+	/*
+	 * Count the request on the partition, which we hold, rather than on
+	 * the region's stat block: every concurrent reader would otherwise
+	 * write the same cache line on each lock get.
+	 */
+	region->obj_tab_mtx[partition].nrequests++;
+
 	/* Throw deadlock if this is a reader-thread and the bdb lock is desired */
 	if (!LF_ISSET(DB_LOCK_LOGICAL) &&
 	    rep_return_deadlock(dbenv, sh_obj->lockobj.size)) {
@@ -2699,6 +2705,7 @@ upgrade:
 		 */
 		newl->status = DB_LSTAT_WAITING;
 		region->stat.st_nconflicts++;
+		region->obj_tab_mtx[partition].nwaits++;
 
 		if (gbl_lock_conflict_trace) {
 			static u_int32_t conftime = 0;
@@ -2824,6 +2831,13 @@ upgrade:
 			unlock_detector(region);
 		}
 
+		/*
+		 * Flag the wait again now that the detector can see it: a
+		 * pass which cleared need_dd before we were on wlockers
+		 * would otherwise leave this wait unexamined.
+		 */
+		region->need_dd = 1;
+
 		/*
 		 * We are about to wait; before waiting, see if the deadlock
 		 * detector should be run.
@@ -2861,7 +2875,7 @@ upgrade:
 				 * callback to record some basic info about
 				 * the lock. */
 				gbl_bb_log_lock_waits_fn(sh_obj->lockobj.data,
-				    sh_obj->lockobj.size, U2M(x2 - x1));
+				    sh_obj->lockobj.size, lock_mode, x2 - x1);
 			}
 		}
 
@@ -3101,6 +3115,84 @@ __lock_query_pp(dbenv, locker, obj, lock_mode)
 	return (ret);
 }
 
+/*
+ * __lock_reget --
+ *	Take another reference on a lock that locker already holds, locking
+ *	only the lock's object partition.  held must be a lock previously
+ *	returned to this locker; if it has since been released (its
+ *	generation moved on), is no longer granted, or the locker has been
+ *	told to deadlock, return DB_NOTFOUND and let the caller go through
+ *	lock_get.
+ */
+static int
+__lock_reget(dbenv, locker, held, lock)
+	DB_ENV *dbenv;
+	u_int32_t locker;
+	const DB_LOCK *held;
+	DB_LOCK *lock;
+{
+	DB_LOCKTAB *lt;
+	DB_LOCKREGION *region;
+	struct __db_lock *lp;
+	int ret;
+
+	lt = dbenv->lk_handle;
+	region = lt->reginfo.primary;
+
+	if (F_ISSET(dbenv, DB_ENV_NOLOCKING) || IS_REP_CLIENT(dbenv) ||
+	    !LOCK_ISSET(*held) || LOCK_ISLATCH(*held) ||
+	    held->partition >= gbl_lk_parts)
+		return (DB_NOTFOUND);
+
+	/*
+	 * The generation is bumped under the object partition when the lock
+	 * is released, and never goes back; holding the partition the lock
+	 * was granted in is enough to see that here.
+	 */
+	ret = DB_NOTFOUND;
+	lock_obj_partition(region, held->partition);
+	lp = (struct __db_lock *)R_ADDR(&lt->reginfo, held->off);
+	if (lp->gen == held->gen && lp->status == DB_LSTAT_HELD &&
+	    lp->mode == held->mode && lp->holderp->id == locker &&
+	    !F_ISSET(lp->holderp, DB_LOCKER_DEADLOCK)) {
+		lp->refcount++;
+		region->obj_tab_mtx[held->partition].nrequests++;
+		*lock = *held;
+		ret = 0;
+	}
+	unlock_obj_partition(region, held->partition);
+	return (ret);
+}
+
+/*
+ * __lock_reget_pp --
+ *	DB_ENV->lock_reget pre/post processing.
+ *
+ * PUBLIC: int __lock_reget_pp __P((DB_ENV *,
+ * PUBLIC:	 u_int32_t, const DB_LOCK *, DB_LOCK *));
+ */
+int
+__lock_reget_pp(dbenv, locker, held, lock)
+	DB_ENV *dbenv;
+	u_int32_t locker;
+	const DB_LOCK *held;
+	DB_LOCK *lock;
+{
+	int rep_check, ret;
+
+	PANIC_CHECK(dbenv);
+	ENV_REQUIRES_CONFIG(dbenv,
+	    dbenv->lk_handle, "DB_ENV->lock_reget", DB_INIT_LOCK);
+
+	rep_check = IS_ENV_REPLICATED(dbenv) ? 1 : 0;
+	if (rep_check)
+		__env_rep_enter(dbenv);
+	ret = __lock_reget(dbenv, locker, held, lock);
+	if (rep_check)
+		__env_rep_exit(dbenv);
+	return (ret);
+}
+
 static inline int
 __lock_get_internal(lt, locker, sh_locker, flags, obj, lock_mode, timeout, lock)
 	DB_LOCKTAB *lt;
@@ -3372,10 +3464,11 @@ __lock_put_internal(lt, lockp, lock, obj_ndx, need_dd, flags)
 		return (0);
 	}
 
+	partition = lockp->lockobj->partition;
 	if (LF_ISSET(DB_LOCK_DOALL))
-		region->stat.st_nreleases += lockp->refcount;
+		region->obj_tab_mtx[partition].nreleases += lockp->refcount;
 	else
-		region->stat.st_nreleases++;
+		region->obj_tab_mtx[partition].nreleases++;
 
 	if (!LF_ISSET(DB_LOCK_DOALL) && lockp->refcount > 1) {
 		lockp->refcount--;
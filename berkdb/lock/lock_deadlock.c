@@ -460,6 +460,10 @@ __dd_print_tracked(idmap, deadmap, nlockers, victim)
 
 uint64_t detect_skip = 0;
 uint64_t detect_run = 0;
+uint64_t detect_idle = 0;
+
+/* Skip the waits-for build when no wait has started since the last pass. */
+int gbl_deadlock_detect_incremental = 0;
 
 #define LOCK_DETECT_Q 1
 
@@ -591,6 +595,18 @@ __lock_detect_int(dbenv, atype, abortp, can_retry)
 		atype = DB_LOCK_EXPIRE;
 #endif
 
+	/*
+	 * A new cycle can only close when some locker starts to wait, and
+	 * every such wait (as well as a retry or a put which promoted nobody)
+	 * sets need_dd.  If nothing has set it since the last pass, the
+	 * waits-for graph has no new edges, so only look for expired waiters.
+	 */
+	if (gbl_deadlock_detect_incremental && region->need_dd == 0 &&
+	    atype != DB_LOCK_EXPIRE) {
+		++detect_idle;
+		atype = DB_LOCK_EXPIRE;
+	}
+
 	/* Reset need_dd, so we know we've run the detector. */
 	region->need_dd = 0;
 
@@ -1610,11 +1626,6 @@ out:
 		unlock_locker_partition(region, lkr_partition);
 	}
 
-	/*
-	 * Pass complete, reset the deadlock detector bit.
-	 */
-	region->need_dd = 0;
-
 	/*
 	 * If this is a sparse-map, sort the alloclist.
 	 */
@@ -102,6 +102,7 @@ __lock_dbenv_create(dbenv)
 		dbenv->lock_dump_region = __lock_dump_region;
 		dbenv->lock_get = __lock_get_pp;
 		dbenv->lock_query = __lock_query_pp;
+		dbenv->lock_reget = __lock_reget_pp;
 
 		dbenv->lock_abort_logical_waiters =
 		    __lock_abort_logical_waiters_pp;
@@ -114,6 +115,7 @@ __lock_dbenv_create(dbenv)
 		    __lock_id_set_logical_abort_pp;
 		dbenv->lock_put = __lock_put_pp;
 		dbenv->collect_locks = __lock_collect_pp;
+		dbenv->collect_lock_partitions = __lock_collect_partitions_pp;
 		dbenv->lock_stat = __lock_stat_pp;
 		dbenv->lock_locker_lockcount = __lock_locker_lockcount_pp;
 		dbenv->lock_locker_pagelockcount =
@@ -346,6 +346,11 @@ __lock_init(dbenv, lt)
 		Pthread_mutex_init(&region->obj_tab_mtx[i].mtx, NULL);
 		bzero(region->obj_tab_mtx[i].fluff,
 		    sizeof(region->obj_tab_mtx[i].fluff));
+		region->obj_tab_mtx[i].nacquired = 0;
+		region->obj_tab_mtx[i].ncontended = 0;
+		region->obj_tab_mtx[i].nwaits = 0;
+		region->obj_tab_mtx[i].nrequests = 0;
+		region->obj_tab_mtx[i].nreleases = 0;
 		if ((ret = __db_shalloc(lt->reginfo.addr,
 		    region->object_p_size * sizeof(ObjTab), 0, &addr)) != 0) {
 			goto mem_err;
@@ -379,6 +384,11 @@ __lock_init(dbenv, lt)
 		Pthread_mutex_init(&region->locker_tab_mtx[i].mtx, NULL);
 		bzero(region->locker_tab_mtx[i].fluff,
 		    sizeof(region->locker_tab_mtx[i].fluff));
+		region->locker_tab_mtx[i].nacquired = 0;
+		region->locker_tab_mtx[i].ncontended = 0;
+		region->locker_tab_mtx[i].nwaits = 0;
+		region->locker_tab_mtx[i].nrequests = 0;
+		region->locker_tab_mtx[i].nreleases = 0;
 		if ((ret = __db_shalloc(lt->reginfo.addr,
 		    region->locker_p_size * sizeof(LockerTab),
 		    0, &addr)) != 0) {
@@ -42,6 +42,8 @@ static const char revid[] = "$Id: lock_stat.c,v 11.44 2003/09/13 19:20:36 bostic
 #include "logmsg.h"
 #include <locks_wrap.h>
 
+extern uint64_t detect_run, detect_skip, detect_idle;
+
 static void __lock_dump_locker __P((DB_LOCKTAB *, DB_LOCKER *, FILE *));
 static void __lock_dump_object __P((DB_LOCKTAB *, DB_LOCKOBJ *, FILE *, int));
 static void __lock_printheader __P((FILE *));
@@ -99,6 +101,7 @@ __lock_stat(dbenv, statp, flags)
 	DB_LOCKREGION *region;
 	DB_LOCKTAB *lt;
 	DB_LOCK_STAT *stats, tmp;
+	u_int32_t i;
 	int ret;
 
 	*statp = NULL;
@@ -118,6 +121,16 @@ __lock_stat(dbenv, statp, flags)
 	stats->st_region_wait = lt->reginfo.rp->mutex.mutex_set_wait;
 	stats->st_region_nowait = lt->reginfo.rp->mutex.mutex_set_nowait;
 	stats->st_regsize = lt->reginfo.rp->size;
+
+	/* Request and release counts are kept per object partition. */
+	for (i = 0; i < gbl_lk_parts; ++i) {
+		stats->st_nrequests += region->obj_tab_mtx[i].nrequests;
+		stats->st_nreleases += region->obj_tab_mtx[i].nreleases;
+		if (LF_ISSET(DB_STAT_CLEAR))
+			region->obj_tab_mtx[i].nrequests =
+			    region->obj_tab_mtx[i].nreleases = 0;
+	}
+
 	if (LF_ISSET(DB_STAT_CLEAR)) {
 		tmp = region->stat;
 		memset(&region->stat, 0, sizeof(region->stat));
@@ -225,6 +238,9 @@ __lock_dump_region_int_int(dbenv, area, fp, just_active_locks, lockerid)
 		    "osynch_off", (u_long)lrp->osynch_off,
 		    "lsynch_off", (u_long)lrp->lsynch_off,
 		    "need_dd", (u_long)lrp->need_dd);
+		logmsgf(LOGMSG_USER, fp,
+		    "detector passes: %"PRIu64", queued: %"PRIu64", idle: %"PRIu64"\n",
+		    detect_run, detect_skip, detect_idle);
 		if (LOCK_TIME_ISVALID(&lrp->next_timeout)) {
 			struct tm mytime;
 			strftime(buf, sizeof(buf), "%m-%d-%H:%M:%S",
@@ -817,6 +833,51 @@ __lock_collect_pp(dbenv, func, arg)
 }
 
 
+/*
+ * __lock_collect_partitions_pp --
+ *	Report the acquire, contention and wait counts of each object and
+ *	locker partition.
+ *
+ * PUBLIC: int __lock_collect_partitions_pp __P((DB_ENV *,
+ * PUBLIC:     collect_lock_partitions_f, void *));
+ */
+int
+__lock_collect_partitions_pp(dbenv, func, arg)
+	DB_ENV *dbenv;
+	collect_lock_partitions_f func;
+	void *arg;
+{
+	DB_LOCKTAB *lt;
+	DB_LOCKREGION *lrp;
+	PthreadMutexWithFluff *m;
+	int i, ret;
+
+	PANIC_CHECK(dbenv);
+	ENV_REQUIRES_CONFIG(dbenv,
+		dbenv->lk_handle, "DB_ENV->collect_lock_partitions", DB_INIT_LOCK);
+
+	lt = dbenv->lk_handle;
+	lrp = lt->reginfo.primary;
+
+	/*
+	 * The counters are bumped by the mutex holder; a racy read is good
+	 * enough for reporting and keeps us off the hot partitions.
+	 */
+	for (i = 0; i < gbl_lk_parts; ++i) {
+		m = &lrp->obj_tab_mtx[i];
+		if ((ret = func(arg, "object", i, m->nacquired, m->ncontended,
+		    m->nwaits)) != 0)
+			return (ret);
+	}
+	for (i = 0; i < gbl_lkr_parts; ++i) {
+		m = &lrp->locker_tab_mtx[i];
+		if ((ret = func(arg, "locker", i, m->nacquired, m->ncontended,
+		    m->nwaits)) != 0)
+			return (ret);
+	}
+	return (0);
+}
+
 /*
  * COMDB2 MODIFICATION
  *
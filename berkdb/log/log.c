@@ -109,6 +109,10 @@ __log_open(dbenv)
 		if (lp->log_size == 0)
 			lp->log_size = LG_MAX_DEFAULT;
 
+		/* Put back what only reached the log tier before a crash. */
+		if ((ret = __log_tier_open(dblp)) != 0)
+			goto err;
+
 		if ((ret = __log_recover(dblp)) != 0)
 			goto err;
 
@@ -149,6 +153,7 @@ __log_open(dbenv)
 	return (0);
 
 err:	dbenv->lg_handle = NULL;
+	__log_tier_close(dblp);
 	if (dblp->reginfo.addr != NULL) {
 		if (F_ISSET(&dblp->reginfo, REGION_CREATE))
 			ret = __db_panic(dbenv, ret);
@@ -853,6 +858,9 @@ __log_dbenv_refresh(dbenv)
 	F_SET(dblp, DBLOG_RECOVER);
 	ret = __dbreg_close_files(dbenv);
 
+	/* Drain the log tier while the current log file is still open. */
+	__log_tier_close(dblp);
+
 	/* Discard the per-thread lock. */
 	if (dblp->mutexp != NULL)
 		__db_mutex_free(dbenv, &dblp->reginfo, dblp->mutexp);
@@ -863,6 +871,10 @@ __log_dbenv_refresh(dbenv)
 		ret = t_ret;
 
 	/* Close open files, release allocated memory. */
+	if (dblp->uring != NULL) {
+		__os_uring_destroy(dbenv, dblp->uring);
+		dblp->uring = NULL;
+	}
 	if (dblp->lfhp != NULL) {
 		if ((t_ret =
 		    __os_closehandle(dbenv, dblp->lfhp)) != 0 && ret == 0)
@@ -958,6 +970,8 @@ __log_stat(dbenv, statp, flags)
 		dblp->reginfo.rp->mutex.mutex_set_nowait = 0;
 	}
 	stats->st_regsize = dblp->reginfo.rp->size;
+	stats->st_gc_fsync_us = region->gc_fsync_us;
+	stats->st_gc_arrival_us = region->gc_arrival_us;
 
 	stats->st_cur_file = region->lsn.file;
 	stats->st_cur_offset = region->lsn.offset;
@@ -1091,6 +1105,10 @@ __log_vtruncate(dbenv, lsn, ckplsn, trunclsn)
 	if ((ret = __log_flush_int(dblp, NULL, 0)) != 0)
 		goto err;
 
+	/* Tier chunks past the truncation point must not be replayed. */
+	if (dblp->tier != NULL && (ret = __log_tier_drain(dblp)) != 0)
+		goto err;
+
 	end_lsn = lp->lsn;
 	lp->lsn = *lsn;
 	lp->len = c_len;
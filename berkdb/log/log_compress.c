@@ -0,0 +1,223 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Log record compression.
+ *
+ * Large page-level records (item adds and deletes, overflow items, item
+ * replacement and page splits) can be LZ4-compressed by log_put before
+ * they are checksummed and written.  A compressed record keeps its record
+ * type word in front, with DB_lz4_FLAG set, followed by the original record
+ * size and the compressed remainder of the record:
+ *
+ *	rectype | DB_lz4_FLAG	4 bytes
+ *	original size		4 bytes
+ *	LZ4 block		original size - 4 bytes once decompressed
+ *
+ * The compressed bytes are what goes into the log file and what a master
+ * sends to its replicants, so a replicant's log stays byte-identical to
+ * the master's.  Log cursors decompress on the way out, so recovery and
+ * replicant apply see the original record; code that ships log records
+ * elsewhere opens its cursor with DB_LOG_RAW to get them as stored.
+ *
+ * Compression is never applied to records that carry a commit context,
+ * to transaction, checkpoint or file registration records, or when the
+ * environment is encrypted.
+ */
+
+#include "db_config.h"
+
+#ifndef NO_SYSTEM_INCLUDES
+#include <sys/types.h>
+
+#include <string.h>
+#endif
+
+#include "db_int.h"
+#include "dbinc/db_page.h"
+#include "dbinc/btree.h"
+#include "dbinc/db_swap.h"
+#include "dbinc/log.h"
+
+#include <lz4.h>
+
+#if LZ4_VERSION_NUMBER < 10701
+#define LZ4_compress_default LZ4_compress_limitedOutput
+#endif
+
+/* Compress eligible records at least this large; 0 disables compression. */
+int gbl_log_compress_min = 0;
+
+/* Keep the compressed form only if it is this percentage or less. */
+int gbl_log_compress_max_ratio = 85;
+
+#define	LZ4_REC_HDR	(2 * sizeof(u_int32_t))
+
+static int __log_rec_compressible __P((u_int32_t));
+
+static int
+__log_rec_compressible(rectype)
+	u_int32_t rectype;
+{
+	/* The ufid variants are numbered 1000 above the originals. */
+	if (rectype > 1000 && rectype < DB_user_BEGIN)
+		rectype -= 1000;
+
+	switch (rectype) {
+	case DB___db_addrem:
+	case DB___db_big:
+	case DB___bam_repl:
+	case DB___bam_split:
+	case DB___bam_rsplit:
+		return (1);
+	default:
+		return (0);
+	}
+}
+
+/*
+ * __log_rec_compress --
+ *	Compress a log record into newly allocated memory.  Returns 0 and
+ *	fills in out if the record was compressed; the caller frees
+ *	out->data.  Returns DB_NOTFOUND if the record should be logged as is.
+ *
+ * PUBLIC: int __log_rec_compress __P((DB_ENV *, const DBT *, DBT *));
+ */
+int
+__log_rec_compress(dbenv, in, out)
+	DB_ENV *dbenv;
+	const DBT *in;
+	DBT *out;
+{
+	DB_LOG *dblp;
+	LOG *lp;
+	u_int32_t rectype, flagged, orig;
+	u_int8_t *zp;
+	int bound, clen, limit;
+
+	if (gbl_log_compress_min <= 0 ||
+	    in->size < (u_int32_t)gbl_log_compress_min || in->size <= LZ4_REC_HDR || CRYPTO_ON(dbenv))
+		return (DB_NOTFOUND);
+
+	LOGCOPY_32(&rectype, in->data);
+	if (!__log_rec_compressible(rectype))
+		return (DB_NOTFOUND);
+
+	limit = (int)(((u_int64_t)in->size * gbl_log_compress_max_ratio) / 100);
+	if (limit <= (int)LZ4_REC_HDR)
+		return (DB_NOTFOUND);
+
+	bound = LZ4_compressBound(in->size - sizeof(u_int32_t));
+	if (__os_malloc(dbenv, LZ4_REC_HDR + bound, &zp) != 0)
+		return (DB_NOTFOUND);
+
+	clen = LZ4_compress_default(
+	    (const char *)in->data + sizeof(u_int32_t),
+	    (char *)zp + LZ4_REC_HDR, in->size - sizeof(u_int32_t), bound);
+	if (clen <= 0 || LZ4_REC_HDR + clen > (u_int32_t)limit) {
+		__os_free(dbenv, zp);
+		return (DB_NOTFOUND);
+	}
+
+	flagged = rectype | DB_lz4_FLAG;
+	orig = in->size;
+	LOGCOPY_32(zp, &flagged);
+	LOGCOPY_32(zp + sizeof(u_int32_t), &orig);
+
+	memset(out, 0, sizeof(*out));
+	out->data = zp;
+	out->size = (u_int32_t)(LZ4_REC_HDR + clen);
+
+	dblp = dbenv->lg_handle;
+	lp = dblp->reginfo.primary;
+	(void)__atomic_add_fetch(&lp->stat.st_lz4_records, 1, __ATOMIC_RELAXED);
+	(void)__atomic_add_fetch(&lp->stat.st_lz4_in_bytes,
+	    in->size, __ATOMIC_RELAXED);
+	(void)__atomic_add_fetch(&lp->stat.st_lz4_out_bytes,
+	    out->size, __ATOMIC_RELAXED);
+	return (0);
+}
+
+/*
+ * __log_rec_is_compressed --
+ *	Return 1 if the record body was written by __log_rec_compress.
+ *
+ * PUBLIC: int __log_rec_is_compressed __P((const void *, u_int32_t));
+ */
+int
+__log_rec_is_compressed(data, size)
+	const void *data;
+	u_int32_t size;
+{
+	u_int32_t rectype;
+
+	if (size < LZ4_REC_HDR)
+		return (0);
+	LOGCOPY_32(&rectype, data);
+	return ((rectype & (DB_lz4_FLAG | DB_debug_FLAG)) == DB_lz4_FLAG);
+}
+
+/*
+ * __log_rec_decompress --
+ *	Decompress a record into *bufp, growing it as needed.  On success
+ *	*sizep is the size of the original record.
+ *
+ * PUBLIC: int __log_rec_decompress __P((DB_ENV *,
+ * PUBLIC:     const void *, u_int32_t, u_int8_t **, u_int32_t *, u_int32_t *));
+ */
+int
+__log_rec_decompress(dbenv, data, size, bufp, buf_sizep, sizep)
+	DB_ENV *dbenv;
+	const void *data;
+	u_int32_t size;
+	u_int8_t **bufp;
+	u_int32_t *buf_sizep;
+	u_int32_t *sizep;
+{
+	const u_int8_t *p;
+	u_int32_t rectype, orig;
+	int ret, dlen;
+
+	p = data;
+	LOGCOPY_32(&rectype, p);
+	LOGCOPY_32(&orig, p + sizeof(u_int32_t));
+	if (orig < sizeof(u_int32_t)) {
+		__db_err(dbenv, "corrupt compressed log record, size %lu",
+		    (u_long)orig);
+		return (EINVAL);
+	}
+
+	if (*buf_sizep < orig) {
+		if ((ret = __os_realloc(dbenv, orig, bufp)) != 0)
+			return (ret);
+		*buf_sizep = orig;
+	}
+
+	rectype &= ~DB_lz4_FLAG;
+	LOGCOPY_32(*bufp, &rectype);
+	dlen = LZ4_decompress_safe((const char *)p + LZ4_REC_HDR,
+	    (char *)*bufp + sizeof(u_int32_t), size - LZ4_REC_HDR,
+	    orig - sizeof(u_int32_t));
+	if (dlen != (int)(orig - sizeof(u_int32_t))) {
+		__db_err(dbenv,
+		    "corrupt compressed log record, decompressed %d of %lu",
+		    dlen, (u_long)orig);
+		return (EINVAL);
+	}
+
+	*sizep = orig;
+	return (0);
+}
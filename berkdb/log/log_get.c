@@ -231,6 +231,7 @@ __log_c_close(logc)
             (void)__os_closehandle(dbenv, logc->c_fhp);
             logc->c_fhp = NULL;
         }
+        F_CLR(logc, DB_LOG_RAW);
         Pthread_mutex_lock(&curlk);
         logc->prev = NULL;
         logc->next = curhd;
@@ -247,6 +248,8 @@ __log_c_close(logc)
 
 	if (logc->c_dbt.data != NULL)
 		__os_free(dbenv, logc->c_dbt.data);
+	if (logc->c_zbuf != NULL)
+		__os_free(dbenv, logc->c_zbuf);
 
 	__os_free(dbenv, logc->bp);
 	__os_free(dbenv, logc);
@@ -472,8 +475,8 @@ __log_c_get_int(logc, alsn, dbt, flags)
 	LOG *lp;
 	RLOCK rlock;
 	logfile_validity status;
-	u_int32_t cnt;
-	u_int8_t *rp;
+	u_int32_t cnt, rlen;
+	u_int8_t *rdata, *rp;
 	int eof, is_hmac, ret, st, tot;
 
 	dbenv = logc->dbenv;
@@ -745,9 +748,25 @@ cksum:	/*
 		}
 	}
 
+	/*
+	 * Compressed records are handed back decompressed unless the caller
+	 * wants them as stored.  Compression is never used with encryption,
+	 * so the flag can be checked before decrypting.
+	 */
+	rdata = rp + hdr.size;
+	rlen = (u_int32_t)(hdr.len - hdr.size);
+	if (!CRYPTO_ON(dbenv) && !F_ISSET(logc, DB_LOG_RAW) &&
+	    __log_rec_is_compressed(rdata, rlen)) {
+		if ((ret = __log_rec_decompress(dbenv, rdata, rlen,
+		    &logc->c_zbuf, &logc->c_zbuf_size, &rlen)) != 0) {
+			ret = EAGAIN;
+			goto err;
+		}
+		rdata = logc->c_zbuf;
+	}
+
 	/* Copy the record into the user's DBT. */
-	if ((ret = __db_retcopy(dbenv, dbt, rp + hdr.size,
-	    (u_int32_t)(hdr.len - hdr.size),
+	if ((ret = __db_retcopy(dbenv, dbt, rdata, rlen,
 	    &logc->c_dbt.data, &logc->c_dbt.ulen)) != 0)
 		goto err;
 
@@ -992,6 +1011,9 @@ __log_c_inregion_int(logc, lsn, rlockp, last_lsn, hdr, pp)
 		logc->lockwaitus += (tot > 0 ? tot : 0);
 	}
 
+	/* Records reserved by log_put may still be copying in. */
+	__log_wait_copies(lp);
+
 	/*
 	 * The routines to read from disk must avoid reading past the logical
 	 * end of the log, so pass that information back to it.
@@ -38,6 +38,7 @@ static const char revid[] = "$Id: log_put.c,v 11.145 2003/09/13 19:20:39 bostic
 #include "dbinc/db_swap.h"
 #include "dbinc/txn.h"
 #include <pthread.h>
+#include <sched.h>
 
 #include <alloca.h>
 #include <netinet/in.h>
@@ -45,6 +46,7 @@ static const char revid[] = "$Id: log_put.c,v 11.145 2003/09/13 19:20:39 bostic
 #include "logmsg.h"
 #include <locks_wrap.h>
 #include <poll.h>
+#include <epochlib.h>
 
 extern unsigned long long get_commit_context(const void *, uint32_t generation);
 extern int bdb_update_startlwm_berk(void *statearg, unsigned long long ltranid,
@@ -61,10 +63,14 @@ static int __log_fill_segments __P((DB_LOG *, DB_LSN *, DB_LSN *, void *,
 	u_int32_t));
 static int __log_flush_commit __P((DB_ENV *, const DB_LSN *, u_int32_t));
 static int __log_newfh __P((DB_LOG *));
+static int __log_uring_ready __P((DB_LOG *));
+struct __log_resv;
 static int __log_put_next __P((DB_ENV *,
 	DB_LSN *, u_int64_t *, DBT *, const DBT *, HDR *, DB_LSN *, int,
-	u_int8_t *key, u_int32_t));
+	u_int8_t *key, u_int32_t, struct __log_resv *));
+static void __log_resv_copy __P((LOG *, struct __log_resv *));
 static int __log_putr __P((DB_LOG *, DB_LSN *, const DBT *, u_int32_t, HDR *));
+static size_t __log_putr_hdr __P((DB_ENV *, const DBT *, u_int32_t, HDR *));
 static int __log_write __P((DB_LOG *, void *, u_int32_t));
 
 pthread_mutex_t log_write_lk = PTHREAD_MUTEX_INITIALIZER;
@@ -134,6 +140,48 @@ __log_put_pp(dbenv, lsnp, udbt, flags)
 
 int gbl_commit_delay_trace = 0;
 
+/*
+ * Adaptive group commit.  When enabled, a thread that finds no flush in
+ * progress may hold off its fsync for a short window so that commits
+ * arriving meanwhile queue behind it and share the sync.  The window is
+ * sized from the observed gap between flush requests and the observed
+ * fsync latency, and is never longer than gbl_group_commit_max_wait_us.
+ */
+int gbl_group_commit_adaptive = 0;
+int gbl_group_commit_max_wait_us = 1000;
+
+#define	GC_EWMA(avg, sample)	((avg) = ((avg) == 0) ?		\
+	(u_int32_t)(sample) : (u_int32_t)(((u_int64_t)(avg) * 7 + (sample)) / 8))
+#define	GC_MAX_GAP_US		1000000
+
+/*
+ * io_uring log writer.  When enabled, the buffer writes made by a log flush
+ * are queued on a ring and submitted together with the fdatasync in one
+ * system call; see os/os_uring.c.  log_uring_defer is set only by a thread
+ * holding the flush mutex, for the span of its in-memory buffer write.
+ */
+int gbl_log_uring = 0;
+static __thread int log_uring_defer = 0;
+
+/*
+ * Log buffer reservation.  A master's log_put claims its LSN and buffer
+ * range under the region lock as before, but copies the record into the
+ * buffer after dropping the lock, so concurrent committers copy in
+ * parallel instead of one after another.  Only records that fit in the
+ * in-memory buffer without filling it are reserved; anything that has to
+ * write the buffer, and in-region log reads, first waits for outstanding
+ * copies with __log_wait_copies.  Single-segment buffers only.
+ */
+int gbl_log_reserve = 0;
+
+struct __log_resv {
+	u_int8_t *dst;			/* Reserved buffer space, or NULL. */
+	HDR hdr;			/* Finished record header. */
+	size_t nr;			/* Header bytes to copy. */
+	const void *data;		/* Record body. */
+	u_int32_t size;
+};
+
 static inline int is_commit_record(int rectype) {
     switch(rectype) {
         /* regop regop_gen regop_rowlocks */
@@ -164,10 +212,13 @@ __log_put_int_int(dbenv, lsnp, contextp, udbt, flags, off_context, usr_ptr)
 	DB_LSN lsn, old_lsn;
 	HDR hdr;
 	LOG *lp;
-	int lock_held, need_free, ret;
+	int is_master, lock_held, need_free, ret;
 	u_int8_t *key;
 	int rectype = 0;
 	int delay;
+	struct __log_resv resv, *resvp;
+	DBT zdbt;
+	int need_zfree;
 
 	dblp = dbenv->lg_handle;
 	lp = dblp->reginfo.primary;
@@ -177,7 +228,8 @@ __log_put_int_int(dbenv, lsnp, contextp, udbt, flags, off_context, usr_ptr)
 	u_int8_t *pp;
     int adjsize = 0;
 
-	lock_held = need_free = 0;
+	lock_held = need_free = need_zfree = 0;
+	resv.dst = NULL;
 	flags &= (~(DB_LOG_DONT_LOCK | DB_LOG_DONT_INFLATE));
 
 	{
@@ -211,7 +263,19 @@ __log_put_int_int(dbenv, lsnp, contextp, udbt, flags, off_context, usr_ptr)
 	 * so that we retain an unencrypted copy of the log record to send
 	 * to clients.
 	 */
-	if (!LF_ISSET(DB_LOG_NOCOPY) || IS_REP_MASTER(dbenv)) {
+	/*
+	 * Compress large page records.  From here on the compressed form is
+	 * the record: it is what gets logged and what replicants are sent,
+	 * so their logs match ours byte for byte.  Records that will have a
+	 * commit context patched in are left alone.
+	 */
+	if (off_context < 0 && __log_rec_compress(dbenv, udbt, &zdbt) == 0) {
+		udbt = &zdbt;
+		t = zdbt;
+		need_zfree = 1;
+	}
+
+	if (!need_zfree && (!LF_ISSET(DB_LOG_NOCOPY) || IS_REP_MASTER(dbenv))) {
 		if (CRYPTO_ON(dbenv)) {
             adjsize = db_cipher->adj_size(udbt->size);
 			t.size += adjsize;
@@ -258,6 +322,15 @@ __log_put_int_int(dbenv, lsnp, contextp, udbt, flags, off_context, usr_ptr)
     }
 
 
+	/*
+	 * Only a master drops the region lock before returning, which is
+	 * where a reserved record gets copied in.  Decide once: if the role
+	 * changed between reserving and copying, a flush below would wait
+	 * on our own reservation with the region locked.
+	 */
+	is_master = IS_REP_MASTER(dbenv);
+	resvp = (gbl_log_reserve && is_master) ? &resv : NULL;
+
 	R_LOCK(dbenv, &dblp->reginfo);
 	lock_held = 1;
 
@@ -266,7 +339,7 @@ __log_put_int_int(dbenv, lsnp, contextp, udbt, flags, off_context, usr_ptr)
     Pthread_mutex_lock(&gbl_logput_lk);
 	if ((ret =
 		__log_put_next(dbenv, lsnp, contextp, dbt, udbt, &hdr, &old_lsn,
-		    off_context, key, flags)) != 0)
+		    off_context, key, flags, resvp)) != 0)
 		goto panic_check;
 
     Pthread_cond_broadcast(&gbl_logput_cond);
@@ -279,7 +352,7 @@ __log_put_int_int(dbenv, lsnp, contextp, udbt, flags, off_context, usr_ptr)
 		bdb_update_startlwm_berk(dbenv->app_private, ltranid, &lsn);
 	}
 
-	if (IS_REP_MASTER(dbenv)) {
+	if (is_master) {
 
 		/*
 		 * Replication masters need to drop the lock to send
@@ -288,6 +361,8 @@ __log_put_int_int(dbenv, lsnp, contextp, udbt, flags, off_context, usr_ptr)
 		 */
 		R_UNLOCK(dbenv, &dblp->reginfo);
 		lock_held = 0;
+		if (resv.dst != NULL)
+			__log_resv_copy(lp, &resv);
 		/*
 		 * If we are not a rep application, but are sharing a
 		 * master rep env, we should not be writing log records.
@@ -361,6 +436,9 @@ __log_put_int_int(dbenv, lsnp, contextp, udbt, flags, off_context, usr_ptr)
 			R_LOCK(dbenv, &dblp->reginfo);
 			lock_held = 1;
 		}
+		/* The flush waits for reserved copies, ours included. */
+		if (resv.dst != NULL)
+			__log_resv_copy(lp, &resv);
 		if ((ret = __log_flush_commit(dbenv, &lsn, flags)) != 0)
 			goto panic_check;
 	}
@@ -388,8 +466,12 @@ panic_check:	/*
 err:
 	if (lock_held)
 		R_UNLOCK(dbenv, &dblp->reginfo);
+	if (resv.dst != NULL)
+		__log_resv_copy(lp, &resv);
 	if (need_free)
 		__os_free(dbenv, dbt->data);
+	if (need_zfree)
+		__os_free(dbenv, zdbt.data);
 
 	if (IS_REP_MASTER(dbenv) && is_commit_record(rectype) && 
 			(delay = bdb_commitdelay(dbenv->app_private))) {
@@ -623,7 +705,7 @@ __log_txn_lsn(dbenv, lsnp, mbytesp, bytesp)
  * turn out to be.
  */
 static int
-__log_put_next(dbenv, lsn, context, dbt, udbt, hdr, old_lsnp, off_context, key, flags)
+__log_put_next(dbenv, lsn, context, dbt, udbt, hdr, old_lsnp, off_context, key, flags, resv)
 	DB_ENV *dbenv;
 	DB_LSN *lsn;
 	u_int64_t *context;
@@ -634,6 +716,7 @@ __log_put_next(dbenv, lsn, context, dbt, udbt, hdr, old_lsnp, off_context, key,
 	int off_context;
 	u_int8_t *key;
 	u_int32_t flags;
+	struct __log_resv *resv;
 {
 	DB_LOG *dblp;
 	DB_LSN old_lsn;
@@ -750,10 +833,71 @@ __log_put_next(dbenv, lsn, context, dbt, udbt, hdr, old_lsnp, off_context, key,
 				hdr->chksum);
 	}
 
+	/*
+	 * Reserve the space if the record fits without filling the buffer,
+	 * so the copy can happen once the region lock is released.
+	 */
+	if (resv != NULL && lp->num_segments == 1 &&
+	    lp->b_off + hdr->size + dbt->size < lp->buffer_size) {
+		resv->nr = __log_putr_hdr(dbenv,
+		    dbt, lp->lsn.offset - lp->len, hdr);
+		resv->hdr = *hdr;
+		resv->data = dbt->data;
+		resv->size = dbt->size;
+
+		if (lp->b_off == 0)
+			lp->f_lsn = *lsn;
+		resv->dst = dblp->bufp + lp->b_off;
+		(void)__atomic_add_fetch(&lp->copies_pending, 1,
+		    __ATOMIC_ACQ_REL);
+		lp->b_off += resv->nr + dbt->size;
+
+		lp->len = (u_int32_t)(resv->nr + dbt->size);
+		lp->lsn.offset += (u_int32_t)(resv->nr + dbt->size);
+		return (0);
+	}
+
 	/* Actually put the record. */
 	return (__log_putr(dblp, lsn, dbt, lp->lsn.offset - lp->len, hdr));
 }
 
+/*
+ * __log_resv_copy --
+ *	Copy a reserved record into the log buffer.  Called without the
+ *	region lock.
+ */
+static void
+__log_resv_copy(lp, resv)
+	LOG *lp;
+	struct __log_resv *resv;
+{
+	memcpy(resv->dst, &resv->hdr, resv->nr);
+	memcpy(resv->dst + resv->nr, resv->data, resv->size);
+	resv->dst = NULL;
+
+	(void)__atomic_sub_fetch(&lp->copies_pending, 1, __ATOMIC_RELEASE);
+	(void)__atomic_add_fetch(&lp->stat.st_resv_puts, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * __log_wait_copies --
+ *	Wait for reserved records to be copied into the log buffer.  Called
+ *	with the region lock held, so no new reservations can be made.
+ *
+ * PUBLIC: void __log_wait_copies __P((LOG *));
+ */
+void
+__log_wait_copies(lp)
+	LOG *lp;
+{
+	if (__atomic_load_n(&lp->copies_pending, __ATOMIC_ACQUIRE) == 0)
+		return;
+
+	++lp->stat.st_resv_waits;
+	while (__atomic_load_n(&lp->copies_pending, __ATOMIC_ACQUIRE) != 0)
+		sched_yield();
+}
+
 /*
  * Return 1 if the in-memory buffer is empty, 0 if it is not.
  *
@@ -1105,7 +1249,6 @@ __log_putr(dblp, lsn, dbt, prev, h)
 	u_int32_t prev;
 	HDR *h;
 {
-	DB_CIPHER *db_cipher;
 	DB_ENV *dbenv;
 	LOG *lp;
 	DB_LSN tmplsn;
@@ -1119,7 +1262,6 @@ __log_putr(dblp, lsn, dbt, prev, h)
 	/*
 	 * If we weren't given a header, use a local one.
 	 */
-	db_cipher = dbenv->crypto_handle;
 	if (h == NULL) {
 		hdr = &tmp;
 		memset(hdr, 0, sizeof(HDR));
@@ -1132,30 +1274,7 @@ __log_putr(dblp, lsn, dbt, prev, h)
 
 	/* Panic if we fail. */
 
-	/*
-	 * Initialize the header.  If we just switched files, lsn.offset will
-	 * be 0, and what we really want is the offset of the previous record
-	 * in the previous file.  Fortunately, prev holds the value we want.
-	 */
-	hdr->prev = prev;
-	hdr->len = (u_int32_t)hdr->size + dbt->size;
-
-	/*
-	 * If we were passed in a nonzero checksum, our caller calculated
-	 * the checksum before acquiring the log mutex, as an optimization.
-	 *
-	 * If our caller calculated a real checksum of 0, we'll needlessly
-	 * recalculate it.  C'est la vie;  there's no out-of-bounds value
-	 * here.
-	 */
-	if (hdr->chksum[0] == 0)
-		__db_chksum(dbt->data, dbt->size,
-		    (CRYPTO_ON(dbenv)) ? db_cipher->mac_key : NULL,
-		    hdr->chksum);
-
-	nr = hdr->size;
-	if (LOG_SWAPPED())
-		__log_hdrswap(hdr, CRYPTO_ON(dbenv));
+	nr = __log_putr_hdr(dbenv, dbt, prev, hdr);
 
 	/* Run segmented __log_fill if enabled. */
 	if (lp->num_segments > 1) {
@@ -1195,6 +1314,50 @@ err:
 	return (ret);
 }
 
+/*
+ * __log_putr_hdr --
+ *	Finish the header for a record being put at the end of the log and
+ *	return the number of header bytes to write.
+ */
+static size_t
+__log_putr_hdr(dbenv, dbt, prev, hdr)
+	DB_ENV *dbenv;
+	const DBT *dbt;
+	u_int32_t prev;
+	HDR *hdr;
+{
+	DB_CIPHER *db_cipher;
+	size_t nr;
+
+	db_cipher = dbenv->crypto_handle;
+
+	/*
+	 * Initialize the header.  If we just switched files, lsn.offset will
+	 * be 0, and what we really want is the offset of the previous record
+	 * in the previous file.  Fortunately, prev holds the value we want.
+	 */
+	hdr->prev = prev;
+	hdr->len = (u_int32_t)hdr->size + dbt->size;
+
+	/*
+	 * If we were passed in a nonzero checksum, our caller calculated
+	 * the checksum before acquiring the log mutex, as an optimization.
+	 *
+	 * If our caller calculated a real checksum of 0, we'll needlessly
+	 * recalculate it.  C'est la vie;  there's no out-of-bounds value
+	 * here.
+	 */
+	if (hdr->chksum[0] == 0)
+		__db_chksum(dbt->data, dbt->size,
+		    (CRYPTO_ON(dbenv)) ? db_cipher->mac_key : NULL,
+		    hdr->chksum);
+
+	nr = hdr->size;
+	if (LOG_SWAPPED())
+		__log_hdrswap(hdr, CRYPTO_ON(dbenv));
+	return (nr);
+}
+
 /*
  * __log_flush_pp --
  *	DB_ENV->log_flush pre/post processing.
@@ -1288,6 +1451,42 @@ __log_lwr_lsn(dblp)
 	}
 }
 
+/*
+ * __log_uring_ready --
+ *	Return 1 if this flush should queue its buffer writes on the ring,
+ *	creating the ring on first use.  Called with the region locked and
+ *	the flush mutex held.
+ */
+static int
+__log_uring_ready(dblp)
+	DB_LOG *dblp;
+{
+	DB_ENV *dbenv;
+	LOG *lp;
+	int ret;
+
+	if (!gbl_log_uring || dblp->uring_failed || dblp->tier != NULL)
+		return (0);
+
+	dbenv = dblp->dbenv;
+	lp = dblp->reginfo.primary;
+
+	/* A file switch goes through the synchronous path. */
+	if (dblp->lfhp == NULL || dblp->lfname != lp->lsn.file ||
+	    !__os_uring_fh_ok(dbenv, dblp->lfhp))
+		return (0);
+
+	if (dblp->uring == NULL &&
+	    (ret = __os_uring_create(dbenv, &dblp->uring)) != 0) {
+		logmsg(LOGMSG_WARN,
+		    "%s: io_uring unavailable (%s), using synchronous "
+		    "log writes\n", __func__, strerror(ret));
+		dblp->uring_failed = 1;
+		return (0);
+	}
+	return (1);
+}
+
 /*
  * __log_flush_int --
  *	Write all records less than or equal to the specified LSN; internal
@@ -1311,7 +1510,8 @@ __log_flush_int(dblp, lsnp, release)
 	DB_MUTEX *flush_mutexp;
 	LOG *lp;
 	u_int32_t ncommit, w_off, listcnt;
-	int do_flush, first, ret, wrote_inmem;
+	u_int64_t fsync_start, fsync_us;
+	int do_flush, first, ret, uring_sync, wrote_inmem;
 
 	dbenv = dblp->dbenv;
 	lp = dblp->reginfo.primary;
@@ -1371,6 +1571,51 @@ __log_flush_int(dblp, lsnp, release)
 	 */
 #endif
 
+	if (release) {
+		u_int64_t now, gap;
+		u_int32_t window;
+
+		now = comdb2_time_epochus();
+		if (lp->gc_last_arrival != 0 && now > lp->gc_last_arrival) {
+			gap = now - lp->gc_last_arrival;
+			if (gap > GC_MAX_GAP_US)
+				gap = GC_MAX_GAP_US;
+			GC_EWMA(lp->gc_arrival_us, gap);
+		}
+		lp->gc_last_arrival = now;
+
+		/*
+		 * Only delay the sync when requests arrive faster than a
+		 * sync completes: otherwise nobody would join the group and
+		 * the wait would be pure latency.
+		 */
+		if (gbl_group_commit_adaptive && lp->in_flush == 0 &&
+		    lp->gc_arrival_us != 0 &&
+		    lp->gc_arrival_us < lp->gc_fsync_us) {
+			window = lp->gc_fsync_us;
+			if (window > (u_int32_t)gbl_group_commit_max_wait_us)
+				window = gbl_group_commit_max_wait_us;
+			if (window > 0) {
+				/*
+				 * Look like a flush in progress so arriving
+				 * committers queue up on the waiter list.
+				 */
+				lp->in_flush++;
+				R_UNLOCK(dbenv, &dblp->reginfo);
+				(void)__os_sleep(dbenv, 0, window);
+				R_LOCK(dbenv, &dblp->reginfo);
+				lp->in_flush--;
+
+				if (log_compare(&flush_lsn, &lp->t_lsn) < 0)
+					flush_lsn = lp->t_lsn;
+				lp->stat.st_gc_windows++;
+				lp->stat.st_gc_wait_us +=
+				    comdb2_time_epochus() - now;
+				lp->stat.st_gc_window_us = window;
+			}
+		}
+	}
+
 	/*
 	 * If a flush is in progress and we're allowed to do so, drop
 	 * the region lock and block waiting for the next flush.
@@ -1475,10 +1720,13 @@ flush:	MUTEX_LOCK(dbenv, flush_mutexp);
 	f_lsn = __log_lwr_lsn( dblp );
 	wrote_inmem = 0;
 	if (!__inmemory_buf_empty(lp) && log_compare(&flush_lsn, &f_lsn) >= 0){
+		log_uring_defer = __log_uring_ready(dblp);
 		ret = __write_inmemory_buffer( dblp, 1 );
+		log_uring_defer = 0;
 		wrote_inmem = 1;
 
 		if (ret != 0) {
+			(void)__os_uring_wait(dbenv, dblp->uring);
 			MUTEX_UNLOCK(dbenv, flush_mutexp);
 			goto done;
 		}
@@ -1532,13 +1780,42 @@ flush:	MUTEX_LOCK(dbenv, flush_mutexp);
 	w_off = lp->w_off;
 	f_lsn = lp->f_lsn;
 
+	/*
+	 * Writes queued on the ring go out with the sync.  They have to land
+	 * before the region is released, since the buffer they point into
+	 * can be refilled as soon as it is; the sync itself overlaps with
+	 * other threads logging, exactly as in the synchronous path.
+	 */
+	fsync_start = comdb2_time_epochus();
+	uring_sync = 0;
+	if (__os_uring_pending(dblp->uring) != 0) {
+		if ((ret = __os_uring_submit_sync(dbenv,
+		    dblp->uring, dblp->lfhp)) != 0) {
+			(void)__os_uring_wait(dbenv, dblp->uring);
+			MUTEX_UNLOCK(dbenv, flush_mutexp);
+			__db_err(dbenv, "DB_ENV->log_flush: error writing to log");
+			return (__db_panic(dbenv, ret));
+		}
+		uring_sync = 1;
+		++lp->stat.st_uring_syncs;
+	}
+
+	if (dblp->tier != NULL)
+		++lp->stat.st_tier_syncs;
+
 	s_lsn = __log_lwr_lsn(dblp);
 	lp->in_flush++;
 	if (release)
 		R_UNLOCK(dbenv, &dblp->reginfo);
 
 	/* Sync all writes to disk. */
-	if ((ret = __os_fsync(dbenv, dblp->lfhp)) != 0) {
+	if (uring_sync)
+		ret = __os_uring_wait(dbenv, dblp->uring);
+	else if (dblp->tier != NULL)
+		ret = __log_tier_sync(dblp);
+	else
+		ret = __os_fsync(dbenv, dblp->lfhp);
+	if (ret != 0) {
 		MUTEX_UNLOCK(dbenv, flush_mutexp);
 		if (release)
 			R_LOCK(dbenv, &dblp->reginfo);
@@ -1564,12 +1841,14 @@ flush:	MUTEX_LOCK(dbenv, flush_mutexp);
 	if (1 == lp->num_segments && 0 == lp->b_off)
 		lp->s_lsn.offset = w_off;
 
+	fsync_us = comdb2_time_epochus() - fsync_start;
 	MUTEX_UNLOCK(dbenv, flush_mutexp);
 	if (release)
 		R_LOCK(dbenv, &dblp->reginfo);
 
 	lp->in_flush--;
 	++lp->stat.st_scount;
+	GC_EWMA(lp->gc_fsync_us, fsync_us);
 
 	/*
 	 * How many flush calls (usually commits) did this call actually sync?
@@ -1650,6 +1929,7 @@ done:	listcnt = 0;
 			}
 		}
 	}
+	lp->stat.st_gc_commits += ncommit;
 	if (lp->stat.st_maxcommitperflush < ncommit)
 		lp->stat.st_maxcommitperflush = ncommit;
 	if (lp->stat.st_mincommitperflush > ncommit ||
@@ -1950,6 +2230,9 @@ __log_write(dblp, addr, len)
 	dbenv = dblp->dbenv;
 	lp = dblp->reginfo.primary;
 
+	/* Reserved records must be in the buffer before it goes out. */
+	__log_wait_copies(lp);
+
 	/*
 	 * If we haven't opened the log file yet or the current one
 	 * has changed, acquire a new log file.
@@ -1958,13 +2241,25 @@ __log_write(dblp, addr, len)
 		if ((ret = __log_newfh(dblp)) != 0)
 			return (ret);
 
-	/*
-	 * Seek to the offset in the file (someone may have written it
-	 * since we last did).
-	 */
-	if ((ret = __os_seek(dbenv,
-	    dblp->lfhp, 0, 0, lp->w_off, 0, DB_OS_SEEK_SET)) != 0 ||
-	    (ret = __os_write(dbenv, dblp->lfhp, addr, len, &nw)) != 0)
+	if (log_uring_defer) {
+		/* Queue the write; the flush submits it with the sync. */
+		if ((ret = __os_uring_pwrite(dbenv, dblp->uring,
+		    dblp->lfhp, addr, len, (off_t)lp->w_off)) != 0)
+			return (ret);
+		++lp->stat.st_uring_writes;
+	} else {
+		/*
+		 * Seek to the offset in the file (someone may have written it
+		 * since we last did).
+		 */
+		if ((ret = __os_seek(dbenv,
+		    dblp->lfhp, 0, 0, lp->w_off, 0, DB_OS_SEEK_SET)) != 0 ||
+		    (ret = __os_write(dbenv, dblp->lfhp, addr, len, &nw)) != 0)
+			return (ret);
+	}
+
+	if (dblp->tier != NULL && (ret = __log_tier_append(dblp,
+	    dblp->lfname, lp->w_off, addr, len)) != 0)
 		return (ret);
 
 	/* Reset the buffer offset and update the seek offset. */
@@ -2071,6 +2366,10 @@ __log_newfh(dblp)
 
 	/* Close any previous file descriptor. */
 	if (dblp->lfhp != NULL) {
+		/* The log tier only covers the current log file. */
+		if (dblp->tier != NULL &&
+		    (ret = __os_fsync(dbenv, dblp->lfhp)) != 0)
+			return (ret);
 		(void)__os_closehandle(dbenv, dblp->lfhp);
 		dblp->lfhp = NULL;
 	}
@@ -0,0 +1,599 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Commit log tier.
+ *
+ * A commit normally waits for an fsync of the log file it appended to.
+ * Appending changes the file size, so that fsync also commits file system
+ * metadata.  With log_tier_path set, every write __log_write makes to a log
+ * file is also copied into a fixed size file mapped in memory, as a chunk
+ * that records the log file, offset and length it belongs to.  A log flush
+ * then only msyncs the new chunks: an overwrite of a preallocated range,
+ * with no metadata.  On a DAX mount (persistent memory) that is a CPU
+ * cache flush; on NVMe it is a small ranged write.
+ *
+ * A drain thread fsyncs the current log file every log_tier_drain_ms and
+ * marks the chunks written before it as drained.  A log file switch syncs
+ * the file being left, so only the current log file is ever behind.  When
+ * everything is drained the tier starts over from the beginning under a
+ * new generation; if it fills up first, the writer syncs the log file
+ * itself and starts over.
+ *
+ * When the environment is opened, before log recovery looks for the end
+ * of the log, chunks of the current generation past the drained mark are
+ * written back into their log files.  A chunk is only taken if its
+ * checksum matches, so a torn tail ends the replay.
+ */
+
+#include "db_config.h"
+
+#ifndef NO_SYSTEM_INCLUDES
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+#include "db_int.h"
+#include "dbinc/log.h"
+
+#include <crc32c.h>
+#include <locks_wrap.h>
+#include "logmsg.h"
+
+char *gbl_log_tier_path = NULL;
+int gbl_log_tier_mb = 64;
+int gbl_log_tier_drain_ms = 10;
+
+#define	TIER_MAGIC		0x4c544852	/* "LTHR" */
+#define	TIER_CHUNK_MAGIC	0x4c544348	/* "LTCH" */
+#define	TIER_VERSION		1
+#define	TIER_HDRSZ		4096
+#define	TIER_ALIGN(n)		(((n) + 7) & ~(size_t)7)
+
+struct tier_hdr {
+	u_int32_t magic;
+	u_int32_t version;
+	u_int32_t gen;
+	u_int32_t pad;
+	u_int64_t size;
+	u_int64_t drained;
+};
+
+struct tier_chunk {
+	u_int32_t magic;
+	u_int32_t gen;
+	u_int32_t file;
+	u_int32_t offset;
+	u_int32_t len;
+	u_int32_t crc;
+};
+
+struct __db_log_tier {
+	pthread_mutex_t lk;
+	int fd;
+	u_int8_t *base;
+	size_t size;
+	size_t pgsz;
+	u_int32_t gen;
+	size_t head;		/* Next chunk goes here. */
+	size_t synced;		/* Chunks below this are persistent. */
+	size_t drained;		/* Chunks below this are in synced log files. */
+	u_int32_t last_file;	/* Log file of the newest chunk. */
+
+	pthread_t drain_td;
+	int stop;
+	DB_FH *dfhp;		/* Drain thread's log file handle. */
+	u_int32_t dfile;
+};
+
+static u_int32_t
+__tier_crc(c, data)
+	struct tier_chunk *c;
+	const void *data;
+{
+	struct tier_chunk h;
+
+	h = *c;
+	h.crc = 0;
+	return (crc32c((const uint8_t *)&h, sizeof(h)) ^
+	    crc32c((const uint8_t *)data, c->len));
+}
+
+/* Persist [lo, hi) of the mapping. */
+static int
+__tier_msync(tier, lo, hi)
+	DB_LOG_TIER *tier;
+	size_t lo, hi;
+{
+	lo &= ~(tier->pgsz - 1);
+	if (hi <= lo)
+		return (0);
+	return (msync(tier->base + lo, hi - lo, MS_SYNC) == 0 ? 0 : errno);
+}
+
+/*
+ * Start over under a new generation.  The new header has to be persistent
+ * before any chunk of the new generation can be, or recovery would stop at
+ * the first of them.  Called with the tier locked.
+ */
+static int
+__tier_reset(tier)
+	DB_LOG_TIER *tier;
+{
+	struct tier_hdr *hdr;
+
+	hdr = (struct tier_hdr *)tier->base;
+	tier->gen++;
+	tier->head = tier->synced = tier->drained = TIER_HDRSZ;
+	hdr->gen = tier->gen;
+	hdr->drained = TIER_HDRSZ;
+	return (__tier_msync(tier, 0, TIER_HDRSZ));
+}
+
+/* Write one chunk back into its log file. */
+static int
+__tier_replay_chunk(dblp, c, data)
+	DB_LOG *dblp;
+	struct tier_chunk *c;
+	void *data;
+{
+	DB_ENV *dbenv;
+	DB_FH *fhp;
+	size_t nw;
+	char *name, *prev;
+	int exists, ret;
+
+	dbenv = dblp->dbenv;
+	if ((ret = __log_name(dblp, c->file, &name, NULL, 0)) != 0)
+		return (ret);
+
+	/*
+	 * Only bring back a missing file if it is the start of the log file
+	 * after an existing one; anything else was removed on purpose.
+	 */
+	if (__os_exists(name, NULL) != 0) {
+		exists = 0;
+		if (c->offset == 0 && c->file > 1 &&
+		    __log_name(dblp, c->file - 1, &prev, NULL, 0) == 0) {
+			exists = (__os_exists(prev, NULL) == 0);
+			__os_free(dbenv, prev);
+		}
+		if (!exists) {
+			__os_free(dbenv, name);
+			return (0);
+		}
+	}
+
+	if ((ret = __os_open(dbenv, name, DB_OSO_CREATE | DB_OSO_LOG,
+	    dbenv->db_mode, &fhp)) != 0) {
+		__db_err(dbenv, "%s: log tier replay can't open: %s",
+		    name, db_strerror(ret));
+		__os_free(dbenv, name);
+		return (ret);
+	}
+	if ((ret = __os_seek(dbenv,
+	    fhp, 0, 0, c->offset, 0, DB_OS_SEEK_SET)) == 0 &&
+	    (ret = __os_write(dbenv, fhp, data, c->len, &nw)) == 0)
+		ret = __os_fsync(dbenv, fhp);
+	(void)__os_closehandle(dbenv, fhp);
+	if (ret != 0)
+		__db_err(dbenv, "%s: log tier replay failed: %s",
+		    name, db_strerror(ret));
+	__os_free(dbenv, name);
+	return (ret);
+}
+
+/* Write undrained chunks of a tier left by a previous run into the log. */
+static int
+__tier_replay(dblp, base, size)
+	DB_LOG *dblp;
+	u_int8_t *base;
+	size_t size;
+{
+	struct tier_hdr *hdr;
+	struct tier_chunk *c;
+	size_t off;
+	int n, ret;
+
+	hdr = (struct tier_hdr *)base;
+	if (size < TIER_HDRSZ || hdr->magic != TIER_MAGIC ||
+	    hdr->version != TIER_VERSION || hdr->size != size ||
+	    hdr->drained < TIER_HDRSZ || hdr->drained > size)
+		return (0);
+
+	n = 0;
+	for (off = hdr->drained;
+	    off + sizeof(*c) <= size; off += TIER_ALIGN(sizeof(*c) + c->len)) {
+		c = (struct tier_chunk *)(base + off);
+		if (c->magic != TIER_CHUNK_MAGIC || c->gen != hdr->gen ||
+		    c->len > size - off - sizeof(*c) ||
+		    c->crc != __tier_crc(c, c + 1))
+			break;
+		if ((ret = __tier_replay_chunk(dblp, c, c + 1)) != 0)
+			return (ret);
+		n++;
+	}
+	if (n > 0)
+		logmsg(LOGMSG_INFO, "%s: wrote %d log tier chunk(s) back into "
+		    "the log\n", __func__, n);
+	return (0);
+}
+
+/* Make the tier file exactly size bytes of written zeroes. */
+static int
+__tier_prealloc(fd, size)
+	int fd;
+	size_t size;
+{
+	char *zero;
+	size_t off, n;
+	ssize_t w;
+	int ret;
+
+	if (ftruncate(fd, 0) != 0)
+		return (errno);
+	if ((zero = calloc(1, MEGABYTE)) == NULL)
+		return (ENOMEM);
+	ret = 0;
+	for (off = 0; off < size; off += n) {
+		n = size - off < MEGABYTE ? size - off : MEGABYTE;
+		if ((w = pwrite(fd, zero, n, off)) != (ssize_t)n) {
+			ret = w < 0 ? errno : EIO;
+			break;
+		}
+	}
+	free(zero);
+	if (ret == 0 && fsync(fd) != 0)
+		ret = errno;
+	return (ret);
+}
+
+static void *
+__tier_map(fd, size)
+	int fd;
+	size_t size;
+{
+	void *p;
+
+#if defined(MAP_SYNC) && defined(MAP_SHARED_VALIDATE)
+	/* On a DAX mount stores reach the media without page cache. */
+	p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+	    MAP_SHARED_VALIDATE | MAP_SYNC, fd, 0);
+	if (p != MAP_FAILED)
+		return (p);
+#endif
+	p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	return (p == MAP_FAILED ? NULL : p);
+}
+
+static void *
+__tier_drain_td(arg)
+	void *arg;
+{
+	DB_ENV *dbenv;
+	DB_LOG *dblp;
+	DB_LOG_TIER *tier;
+	struct tier_hdr *hdr;
+	size_t lo, hi;
+	u_int32_t file, gen;
+	char *name;
+	int ret;
+
+	dblp = arg;
+	dbenv = dblp->dbenv;
+	tier = dblp->tier;
+	hdr = (struct tier_hdr *)tier->base;
+
+	while (!tier->stop) {
+		poll(NULL, 0, gbl_log_tier_drain_ms > 0 ? gbl_log_tier_drain_ms : 1);
+
+		Pthread_mutex_lock(&tier->lk);
+		lo = tier->drained;
+		hi = tier->head;
+		gen = tier->gen;
+		file = tier->last_file;
+		Pthread_mutex_unlock(&tier->lk);
+		if (hi == lo)
+			continue;
+
+		/*
+		 * Older log files were synced when the log moved past them,
+		 * so syncing the newest one covers every chunk below hi.
+		 */
+		if (tier->dfhp == NULL || tier->dfile != file) {
+			if (tier->dfhp != NULL) {
+				(void)__os_closehandle(dbenv, tier->dfhp);
+				tier->dfhp = NULL;
+			}
+			if (__log_name(dblp, file, &name, NULL, 0) != 0)
+				continue;
+			ret = __os_open(dbenv, name, DB_OSO_LOG, 0, &tier->dfhp);
+			__os_free(dbenv, name);
+			if (ret != 0) {
+				tier->dfhp = NULL;
+				continue;
+			}
+			tier->dfile = file;
+		}
+		if ((ret = __os_fsync(dbenv, tier->dfhp)) != 0) {
+			logmsg(LOGMSG_ERROR, "%s: log file %u sync failed: %s\n",
+			    __func__, file, strerror(ret));
+			continue;
+		}
+
+		Pthread_mutex_lock(&tier->lk);
+		if (tier->gen == gen && hi > tier->drained) {
+			if (tier->head == hi)
+				ret = __tier_reset(tier);
+			else {
+				tier->drained = hi;
+				hdr->drained = hi;
+			}
+		}
+		Pthread_mutex_unlock(&tier->lk);
+		if (ret != 0)
+			logmsg(LOGMSG_ERROR, "%s: log tier header sync failed: "
+			    "%s\n", __func__, strerror(ret));
+	}
+	return (NULL);
+}
+
+/*
+ * __log_tier_open --
+ *	Map the commit log tier, if one is configured, writing back whatever
+ *	a previous run left in it.  Called before log recovery.
+ *
+ * PUBLIC: int __log_tier_open __P((DB_LOG *));
+ */
+int
+__log_tier_open(dblp)
+	DB_LOG *dblp;
+{
+	DB_ENV *dbenv;
+	DB_LOG_TIER *tier;
+	LOG *lp;
+	struct stat st;
+	struct tier_hdr *hdr;
+	u_int8_t *old;
+	size_t size;
+	int fd, ret;
+
+	if (gbl_log_tier_path == NULL || gbl_log_tier_path[0] == '\0')
+		return (0);
+
+	dbenv = dblp->dbenv;
+	lp = dblp->reginfo.primary;
+	size = (size_t)gbl_log_tier_mb * MEGABYTE;
+	if (size < TIER_HDRSZ + 4 * (size_t)lp->buffer_size) {
+		__db_err(dbenv, "log_tier_mb %d is too small for a %u byte "
+		    "log buffer", gbl_log_tier_mb, lp->buffer_size);
+		return (EINVAL);
+	}
+
+	if ((fd = open(gbl_log_tier_path, O_RDWR | O_CREAT, 0666)) < 0) {
+		ret = errno;
+		__db_err(dbenv, "%s: can't open log tier: %s",
+		    gbl_log_tier_path, strerror(ret));
+		return (ret);
+	}
+	if (fstat(fd, &st) != 0) {
+		ret = errno;
+		goto err;
+	}
+
+	/* Whatever the size we run with now, finish what the last run left. */
+	if (st.st_size >= TIER_HDRSZ) {
+		if ((old = __tier_map(fd, (size_t)st.st_size)) == NULL) {
+			ret = errno;
+			goto err;
+		}
+		ret = __tier_replay(dblp, old, (size_t)st.st_size);
+		(void)munmap(old, (size_t)st.st_size);
+		if (ret != 0)
+			goto err;
+	}
+
+	if ((size_t)st.st_size != size &&
+	    (ret = __tier_prealloc(fd, size)) != 0)
+		goto err;
+
+	if ((ret = __os_calloc(dbenv, 1, sizeof(*tier), &tier)) != 0)
+		goto err;
+	if ((tier->base = __tier_map(fd, size)) == NULL) {
+		ret = errno;
+		__os_free(dbenv, tier);
+		goto err;
+	}
+	Pthread_mutex_init(&tier->lk, NULL);
+	tier->fd = fd;
+	tier->size = size;
+	tier->pgsz = (size_t)sysconf(_SC_PAGESIZE);
+
+	hdr = (struct tier_hdr *)tier->base;
+	tier->gen = hdr->magic == TIER_MAGIC ? hdr->gen : 0;
+	hdr->magic = TIER_MAGIC;
+	hdr->version = TIER_VERSION;
+	hdr->size = size;
+	if ((ret = __tier_reset(tier)) != 0) {
+		(void)munmap(tier->base, size);
+		__os_free(dbenv, tier);
+		goto err;
+	}
+
+	dblp->tier = tier;
+	if ((ret = pthread_create(&tier->drain_td,
+	    NULL, __tier_drain_td, dblp)) != 0) {
+		dblp->tier = NULL;
+		(void)munmap(tier->base, size);
+		__os_free(dbenv, tier);
+		goto err;
+	}
+	logmsg(LOGMSG_INFO, "log tier %s: %zu bytes, generation %u\n",
+	    gbl_log_tier_path, size, tier->gen);
+	return (0);
+
+err:	__db_err(dbenv, "%s: log tier: %s", gbl_log_tier_path, strerror(ret));
+	(void)close(fd);
+	return (ret);
+}
+
+/*
+ * __log_tier_append --
+ *	Copy a write made to log file "file" at "offset" into the tier.
+ *	Called from __log_write with the region locked.
+ *
+ * PUBLIC: int __log_tier_append __P((DB_LOG *,
+ * PUBLIC:     u_int32_t, u_int32_t, void *, u_int32_t));
+ */
+int
+__log_tier_append(dblp, file, offset, addr, len)
+	DB_LOG *dblp;
+	u_int32_t file, offset;
+	void *addr;
+	u_int32_t len;
+{
+	DB_LOG_TIER *tier;
+	LOG *lp;
+	struct tier_chunk *c;
+	size_t need;
+	int ret;
+
+	tier = dblp->tier;
+	lp = dblp->reginfo.primary;
+	need = TIER_ALIGN(sizeof(*c) + len);
+	ret = 0;
+
+	Pthread_mutex_lock(&tier->lk);
+	if (tier->head + need > tier->size) {
+		/* Full: make the log file durable and start over. */
+		if ((ret = __os_fsync(dblp->dbenv, dblp->lfhp)) == 0)
+			ret = __tier_reset(tier);
+		++lp->stat.st_tier_full;
+		if (ret != 0 || tier->head + need > tier->size) {
+			Pthread_mutex_unlock(&tier->lk);
+			return (ret != 0 ? ret : ENOSPC);
+		}
+	}
+	c = (struct tier_chunk *)(tier->base + tier->head);
+	memcpy(c + 1, addr, len);
+	c->magic = TIER_CHUNK_MAGIC;
+	c->gen = tier->gen;
+	c->file = file;
+	c->offset = offset;
+	c->len = len;
+	c->crc = __tier_crc(c, c + 1);
+	tier->head += need;
+	tier->last_file = file;
+	Pthread_mutex_unlock(&tier->lk);
+	return (0);
+}
+
+/*
+ * __log_tier_sync --
+ *	Make everything appended so far persistent; stands in for the log
+ *	file fsync of a log flush.
+ *
+ * PUBLIC: int __log_tier_sync __P((DB_LOG *));
+ */
+int
+__log_tier_sync(dblp)
+	DB_LOG *dblp;
+{
+	DB_LOG_TIER *tier;
+	size_t lo, hi;
+	u_int32_t gen;
+	int ret;
+
+	tier = dblp->tier;
+	Pthread_mutex_lock(&tier->lk);
+	lo = tier->synced;
+	hi = tier->head;
+	gen = tier->gen;
+	Pthread_mutex_unlock(&tier->lk);
+
+	/*
+	 * If the tier started over meanwhile, what we appended is already in
+	 * a synced log file and the range we sync is merely wasted.
+	 */
+	if ((ret = __tier_msync(tier, lo, hi)) != 0)
+		return (ret);
+
+	Pthread_mutex_lock(&tier->lk);
+	if (tier->gen == gen && hi > tier->synced)
+		tier->synced = hi;
+	Pthread_mutex_unlock(&tier->lk);
+	return (0);
+}
+
+/*
+ * __log_tier_drain --
+ *	Sync the current log file and empty the tier, before the log is
+ *	truncated or the environment is closed.
+ *
+ * PUBLIC: int __log_tier_drain __P((DB_LOG *));
+ */
+int
+__log_tier_drain(dblp)
+	DB_LOG *dblp;
+{
+	DB_LOG_TIER *tier;
+	int ret;
+
+	tier = dblp->tier;
+	ret = 0;
+	Pthread_mutex_lock(&tier->lk);
+	if (dblp->lfhp != NULL)
+		ret = __os_fsync(dblp->dbenv, dblp->lfhp);
+	if (ret == 0)
+		ret = __tier_reset(tier);
+	Pthread_mutex_unlock(&tier->lk);
+	return (ret);
+}
+
+/*
+ * __log_tier_close --
+ *	Drain and unmap the tier.
+ *
+ * PUBLIC: void __log_tier_close __P((DB_LOG *));
+ */
+void
+__log_tier_close(dblp)
+	DB_LOG *dblp;
+{
+	DB_LOG_TIER *tier;
+
+	if ((tier = dblp->tier) == NULL)
+		return;
+	tier->stop = 1;
+	pthread_join(tier->drain_td, NULL);
+	(void)__log_tier_drain(dblp);
+	if (tier->dfhp != NULL)
+		(void)__os_closehandle(dblp->dbenv, tier->dfhp);
+	(void)munmap(tier->base, tier->size);
+	(void)close(tier->fd);
+	Pthread_mutex_destroy(&tier->lk);
+	dblp->tier = NULL;
+	__os_free(dblp->dbenv, tier);
+}
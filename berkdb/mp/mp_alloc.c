@@ -40,6 +40,37 @@ typedef struct {
 } HS;
 
 static void __memp_bad_buffer __P((DB_MPOOL_HASH *));
+static int __memp_shalloc __P((DB_ENV *, void *, MPOOLFILE *, size_t, void *));
+
+/*
+ * __memp_shalloc --
+ *	Allocate a buffer.  With direct I/O and mp_dio_align set, page
+ *	buffers are placed so that their data is aligned for direct I/O and
+ *	can be read and written without a bounce buffer.  The length is
+ *	rounded up so that buffers carved one after the other from the same
+ *	free chunk stay aligned, at a cost of up to DB_DIO_ALIGN bytes each.
+ */
+static int
+__memp_shalloc(dbenv, addr, mfp, len, retp)
+	DB_ENV *dbenv;
+	void *addr;
+	MPOOLFILE *mfp;
+	size_t len;
+	void *retp;
+{
+	size_t alen;
+
+	if (mfp != NULL && dbenv->attr.mp_dio_align &&
+	    F_ISSET(dbenv, DB_ENV_DIRECT_DB) &&
+	    SSZA(BH, buf) % MUTEX_ALIGN == 0 &&
+	    SSZA(BH, buf) % sizeof(db_align_t) == 0) {
+		alen = ALIGN(len + sizeof(size_t), DB_DIO_ALIGN) -
+		    sizeof(size_t);
+		return (__db_shalloc_at(addr,
+		    alen, DB_DIO_ALIGN, SSZA(BH, buf), retp));
+	}
+	return (__db_shalloc(addr, len, MUTEX_ALIGN, retp));
+}
 
 // PUBLIC: int __memp_dump_bufferpool_info __P((DB_ENV *, FILE *));
 int
@@ -111,6 +142,7 @@ __memp_dump_bufferpool_info(dbenv, f)
 int __gbl_max_mpalloc_sleeptime = 60;
 
 extern char gbl_dbname[MAX_DBNAME_LENGTH];
+extern int gbl_memp_ctier_mb;
 
 /* copy and paste from bdb/info.c - don't want to call back into bdb */
 static void dump_page_stats(DB_ENV *dbenv) {
@@ -313,7 +345,7 @@ __memp_alloc_flags(dbmp, memreg, mfp, len, offsetp, flags, retp)
 	 * we need in the hopes it will coalesce into a contiguous chunk of the
 	 * right size.  In the latter case we branch back here and try again.
 	 */
-alloc:	if ((ret = __db_shalloc(memreg->addr, len, MUTEX_ALIGN, &p)) == 0) {
+alloc:	if ((ret = __memp_shalloc(dbenv, memreg->addr, mfp, len, &p)) == 0) {
 		if (mfp != NULL) {
 			c_mp->stat.st_pages++;
 			c_mp->stat.st_used_bytes += len;
@@ -521,16 +553,18 @@ found:		if (offsetp != NULL)
 				goto next_hb;
 			}
 
-			++bhp->ref;
+			(void)BH_REF_INC(bhp);
 			ret = __memp_bhwrite(dbmp, hp, bh_mfp, bhp, 0);
-			--bhp->ref;
+			(void)BH_REF_DEC(bhp);
 			if (ret == 0) {
 				++c_mp->stat.st_rw_evict;
 				if(ISLEAF(bhp->buf)) ++c_mp->stat.st_rw_levict;
+				++bh_mfp->stat.st_level_evict[MP_LEVEL(bhp->buf)];
 			}
 		} else {
 			++c_mp->stat.st_ro_evict;
 			if(ISLEAF(bhp->buf)) ++c_mp->stat.st_ro_levict;
+			++bh_mfp->stat.st_level_evict[MP_LEVEL(bhp->buf)];
 		}
 
 		/*
@@ -555,6 +589,9 @@ found:		if (offsetp != NULL)
 		 * If so, we can simply reuse it.  Else, free the buffer and
 		 * its space and keep looking.
 		 */
+		if (gbl_memp_ctier_mb > 0)
+			__memp_ctier_put(bh_mfp, bhp);
+
 		if (mfp != NULL &&
 		    mfp->stat.st_pagesize == bh_mfp->stat.st_pagesize) {
 			__memp_bhfree(dbmp, hp, bhp, 0);
@@ -248,6 +248,7 @@ __dir_pgread_multi(dbmfp, pgno, numpages, pages)
 		}
 
 		++mfp->stat.st_page_in;
+		__memp_ioacct(mfp, 0, 1, nr, 0, 0);
 
 		if ((ret = mfp->ftype == 0 ? 0 :
 			__dir_pg(dbmfp, pgno, &pages[idx], 1)) != 0)
@@ -415,7 +416,7 @@ __memp_pgread(dbmfp, hp, bhp, can_create, is_recovery_page)
 	MPOOLFILE *mfp;
 	DB_MUTEX *mutexp;
 	size_t len, nr, pagesize;
-	int ret, try_recover;
+	int needs_pgin, ret, try_recover;
 
 	mutexp = &hp->hash_mutex;
 	dbenv = dbmfp->dbenv;
@@ -431,6 +432,19 @@ __memp_pgread(dbmfp, hp, bhp, can_create, is_recovery_page)
 	MUTEX_LOCK(dbenv, &bhp->mutex);
 	MUTEX_UNLOCK(dbenv, mutexp);
 
+	/*
+	 * A clean copy of the page may be sitting in the compressed tier.
+	 * An image saved in on-disk format still has to go through pgin.
+	 */
+	if (!is_recovery_page &&
+	    __memp_ctier_get(mfp, bhp, &needs_pgin) == 0) {
+		++mfp->stat.st_page_in;
+		ret = 0;
+		if (needs_pgin && mfp->ftype != 0)
+			goto call_pgin;
+		goto err;
+	}
+
 	/*
 	 * Temporary files may not yet have been created.  We don't create
 	 * them now, we create them when the pages have to be flushed.
@@ -479,8 +493,10 @@ __memp_pgread(dbmfp, hp, bhp, can_create, is_recovery_page)
 			memset(bhp->buf + len, CLEAR_BYTE, pagesize - len);
 #endif
 		++mfp->stat.st_page_create;
-	} else
+	} else {
 		++mfp->stat.st_page_in;
+		__memp_ioacct(mfp, 0, 1, nr, 0, 0);
+	}
 
 	if (0) {
 recover_page:
@@ -495,6 +511,7 @@ recover_page:
 	}
 
 	/* Call any pgin function. */
+call_pgin:
 	ret = mfp->ftype == 0 ? 0 : __memp_pg(dbmfp, bhp, 1);
 
 	/* Search the recovery page cache on cksum error. */
@@ -1022,6 +1039,8 @@ __memp_pgwrite_multi(dbenv, dbmfp, hps, bhps, numpages, wrrec)
 	mfp->file_written = 1;
 	mfp->stat.st_page_out += numpages;
 	mfp->stat.st_rw_merges += numpages - 1;
+	__memp_ioacct(mfp, 0, 0, 0,
+	    numpages, (size_t)numpages * mfp->stat.st_pagesize);
 
 err:
 file_dead:
@@ -1224,6 +1243,10 @@ __memp_bhfree(dbmp, hp, bhp, free_mem)
 	 * the hash bucket's priority, if necessary.
 	 */
 	SH_TAILQ_REMOVE(&hp->hash_bucket, bhp, hq, __bh);
+
+	/* Unlocked readers may still be looking at it; let them finish. */
+	MP_HASH_DRAIN(hp);
+
 	if (bhp->priority == hp->hash_priority)
 		hp->hash_priority =
 		    SH_TAILQ_FIRST(&hp->hash_bucket, __bh) == NULL ?
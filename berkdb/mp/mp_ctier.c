@@ -0,0 +1,367 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Compressed buffer-pool tier.
+ *
+ * Clean pages evicted by __memp_alloc are LZ4-compressed and kept in a
+ * bounded, process-local cache.  A later miss in __memp_pgread checks the
+ * tier before going to disk; a hit decompresses straight into the buffer
+ * header and removes the entry, so a page is never both resident in the
+ * pool and in the tier.  Entries are keyed on (MPOOLFILE, pgno) and are
+ * dropped when the MPOOLFILE is discarded; the file id is checked as well,
+ * so an entry that races with a discard can never be served to a new file
+ * whose MPOOLFILE happens to land at the same address.
+ *
+ * The tier is disabled unless memp_ctier_mb is set.
+ */
+
+#include "db_config.h"
+
+#ifndef NO_SYSTEM_INCLUDES
+#include <sys/types.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#include "db_int.h"
+#include "dbinc/db_shash.h"
+#include "dbinc/mp.h"
+
+#include <lz4.h>
+#include "logmsg.h"
+#include "comdb2_atomic.h"
+
+#if LZ4_VERSION_NUMBER < 10701
+#define LZ4_compress_default LZ4_compress_limitedOutput
+#endif
+
+/* Size of the compressed tier in megabytes; 0 disables it. */
+int gbl_memp_ctier_mb = 0;
+
+/* Keep a page only if it compresses to this percentage or less. */
+int gbl_memp_ctier_max_ratio = 75;
+
+#define	CTIER_NSHARDS	64
+#define	CTIER_NBUCKETS	4096
+
+/* The saved image is in on-disk format and must go through pgin. */
+#define	CTIER_PGIN	0x01
+
+struct ctier_ent {
+	struct ctier_ent *hnext;	/* Hash chain. */
+	struct ctier_ent *lprev;	/* LRU list: older. */
+	struct ctier_ent *lnext;	/* LRU list: newer. */
+	MPOOLFILE *mfp;
+	u_int8_t fileid[DB_FILE_ID_LEN];
+	db_pgno_t pgno;
+	u_int32_t pgsz;
+	u_int32_t clen;
+	u_int32_t flags;
+	char data[1];
+};
+
+struct ctier_shard {
+	pthread_mutex_t lk;
+	struct ctier_ent **hash;
+	struct ctier_ent *oldest;
+	struct ctier_ent *newest;
+	size_t bytes;
+	u_int32_t count;
+} __attribute__ ((aligned(64)));
+
+static struct ctier_shard ctier[CTIER_NSHARDS];
+static pthread_once_t ctier_once = PTHREAD_ONCE_INIT;
+
+static struct {
+	u_int64_t hit;
+	u_int64_t miss;
+	u_int64_t insert;
+	u_int64_t evict;
+	u_int64_t reject;
+} ctier_stat;
+
+static void
+ctier_init(void)
+{
+	int i;
+
+	for (i = 0; i < CTIER_NSHARDS; i++)
+		pthread_mutex_init(&ctier[i].lk, NULL);
+}
+
+static inline u_int32_t
+ctier_hash(mfp, pgno)
+	MPOOLFILE *mfp;
+	db_pgno_t pgno;
+{
+	u_int64_t h;
+
+	h = ((u_int64_t)(uintptr_t)mfp >> 4) * 0x9E3779B97F4A7C15ULL;
+	h ^= (u_int64_t)pgno * 0xC2B2AE3D27D4EB4FULL;
+	return ((u_int32_t)(h >> 32));
+}
+
+static void
+ctier_unlink(sh, ep, h)
+	struct ctier_shard *sh;
+	struct ctier_ent *ep;
+	u_int32_t h;
+{
+	struct ctier_ent **pp;
+
+	for (pp = &sh->hash[h % CTIER_NBUCKETS]; *pp != ep; pp = &(*pp)->hnext)
+		;
+	*pp = ep->hnext;
+
+	if (ep->lprev != NULL)
+		ep->lprev->lnext = ep->lnext;
+	else
+		sh->oldest = ep->lnext;
+	if (ep->lnext != NULL)
+		ep->lnext->lprev = ep->lprev;
+	else
+		sh->newest = ep->lprev;
+
+	sh->bytes -= sizeof(*ep) + ep->clen;
+	sh->count--;
+}
+
+static struct ctier_ent *
+ctier_find(sh, mfp, pgno, h)
+	struct ctier_shard *sh;
+	MPOOLFILE *mfp;
+	db_pgno_t pgno;
+	u_int32_t h;
+{
+	struct ctier_ent *ep;
+
+	if (sh->hash == NULL)
+		return (NULL);
+	for (ep = sh->hash[h % CTIER_NBUCKETS]; ep != NULL; ep = ep->hnext)
+		if (ep->mfp == mfp && ep->pgno == pgno)
+			break;
+	if (ep != NULL &&
+	    memcmp(ep->fileid, mfp->fileid, DB_FILE_ID_LEN) != 0) {
+		ctier_unlink(sh, ep, h);
+		free(ep);
+		ep = NULL;
+	}
+	return (ep);
+}
+
+/*
+ * __memp_ctier_put --
+ *	Save a compressed copy of a clean buffer that is about to be evicted.
+ *	Called with the buffer's hash bucket locked.
+ *
+ * PUBLIC: void __memp_ctier_put __P((MPOOLFILE *, BH *));
+ */
+void
+__memp_ctier_put(mfp, bhp)
+	MPOOLFILE *mfp;
+	BH *bhp;
+{
+	struct ctier_shard *sh;
+	struct ctier_ent *ep, *old;
+	size_t budget, pgsz;
+	u_int32_t h;
+	int bound, clen;
+
+	if (gbl_memp_ctier_mb <= 0)
+		return;
+	if (mfp->deadfile || F_ISSET(mfp, MP_TEMP))
+		return;
+	if (F_ISSET(bhp, BH_DIRTY | BH_DIRTY_CREATE | BH_TRASH | BH_DISCARD))
+		return;
+
+	pthread_once(&ctier_once, ctier_init);
+
+	pgsz = mfp->stat.st_pagesize;
+	bound = LZ4_compressBound((int)pgsz);
+	if ((ep = malloc(sizeof(*ep) + bound)) == NULL)
+		return;
+
+	clen = LZ4_compress_default((const char *)bhp->buf, ep->data,
+	    (int)pgsz, bound);
+	if (clen <= 0 ||
+	    (size_t)clen * 100 > pgsz * (size_t)gbl_memp_ctier_max_ratio) {
+		free(ep);
+		ATOMIC_ADD64(ctier_stat.reject, 1);
+		return;
+	}
+	if ((old = realloc(ep, sizeof(*ep) + clen)) != NULL)
+		ep = old;
+
+	ep->mfp = mfp;
+	memcpy(ep->fileid, mfp->fileid, DB_FILE_ID_LEN);
+	ep->pgno = bhp->pgno;
+	ep->pgsz = (u_int32_t)pgsz;
+	ep->clen = (u_int32_t)clen;
+	ep->flags = F_ISSET(bhp, BH_CALLPGIN) ? CTIER_PGIN : 0;
+	ep->lnext = NULL;
+
+	h = ctier_hash(mfp, bhp->pgno);
+	sh = &ctier[h % CTIER_NSHARDS];
+	budget = ((size_t)gbl_memp_ctier_mb << 20) / CTIER_NSHARDS;
+
+	pthread_mutex_lock(&sh->lk);
+	if (sh->hash == NULL &&
+	    (sh->hash = calloc(CTIER_NBUCKETS, sizeof(*sh->hash))) == NULL) {
+		pthread_mutex_unlock(&sh->lk);
+		free(ep);
+		return;
+	}
+	if ((old = ctier_find(sh, mfp, bhp->pgno, h)) != NULL) {
+		ctier_unlink(sh, old, h);
+		free(old);
+	}
+	while (sh->oldest != NULL && sh->bytes + sizeof(*ep) + clen > budget) {
+		old = sh->oldest;
+		ctier_unlink(sh, old, ctier_hash(old->mfp, old->pgno));
+		free(old);
+		ATOMIC_ADD64(ctier_stat.evict, 1);
+	}
+
+	ep->hnext = sh->hash[h % CTIER_NBUCKETS];
+	sh->hash[h % CTIER_NBUCKETS] = ep;
+	ep->lprev = sh->newest;
+	if (sh->newest != NULL)
+		sh->newest->lnext = ep;
+	else
+		sh->oldest = ep;
+	sh->newest = ep;
+	sh->bytes += sizeof(*ep) + clen;
+	sh->count++;
+	ATOMIC_ADD64(ctier_stat.insert, 1);
+	pthread_mutex_unlock(&sh->lk);
+}
+
+/*
+ * __memp_ctier_get --
+ *	Fill a buffer from the compressed tier.  Returns 0 on a hit and sets
+ *	*needs_pgin if the saved image is in on-disk format.  The entry is
+ *	removed from the tier either way.
+ *
+ * PUBLIC: int __memp_ctier_get __P((MPOOLFILE *, BH *, int *));
+ */
+int
+__memp_ctier_get(mfp, bhp, needs_pgin)
+	MPOOLFILE *mfp;
+	BH *bhp;
+	int *needs_pgin;
+{
+	struct ctier_shard *sh;
+	struct ctier_ent *ep;
+	u_int32_t h;
+	int n;
+
+	if (F_ISSET(mfp, MP_TEMP))
+		return (DB_NOTFOUND);
+
+	h = ctier_hash(mfp, bhp->pgno);
+	sh = &ctier[h % CTIER_NSHARDS];
+
+	/* Unlocked peek: an empty shard can't have our page. */
+	if (sh->count == 0) {
+		if (gbl_memp_ctier_mb > 0)
+			ATOMIC_ADD64(ctier_stat.miss, 1);
+		return (DB_NOTFOUND);
+	}
+
+	pthread_mutex_lock(&sh->lk);
+	if ((ep = ctier_find(sh, mfp, bhp->pgno, h)) == NULL) {
+		ATOMIC_ADD64(ctier_stat.miss, 1);
+		pthread_mutex_unlock(&sh->lk);
+		return (DB_NOTFOUND);
+	}
+	ctier_unlink(sh, ep, h);
+	pthread_mutex_unlock(&sh->lk);
+
+	n = -1;
+	if (ep->pgsz == mfp->stat.st_pagesize)
+		n = LZ4_decompress_safe(ep->data, (char *)bhp->buf,
+		    (int)ep->clen, (int)ep->pgsz);
+	if (n != (int)ep->pgsz) {
+		logmsg(LOGMSG_ERROR, "%s: bad compressed image for page %u\n",
+		    __func__, (unsigned)bhp->pgno);
+		free(ep);
+		ATOMIC_ADD64(ctier_stat.miss, 1);
+		return (DB_NOTFOUND);
+	}
+
+	*needs_pgin = F_ISSET(ep, CTIER_PGIN) ? 1 : 0;
+	free(ep);
+	ATOMIC_ADD64(ctier_stat.hit, 1);
+	return (0);
+}
+
+/*
+ * __memp_ctier_discard --
+ *	Drop every saved page belonging to an MPOOLFILE.
+ *
+ * PUBLIC: void __memp_ctier_discard __P((MPOOLFILE *));
+ */
+void
+__memp_ctier_discard(mfp)
+	MPOOLFILE *mfp;
+{
+	struct ctier_shard *sh;
+	struct ctier_ent *ep, *next;
+	int i;
+
+	for (i = 0; i < CTIER_NSHARDS; i++) {
+		sh = &ctier[i];
+		if (sh->count == 0)
+			continue;
+		pthread_mutex_lock(&sh->lk);
+		for (ep = sh->oldest; ep != NULL; ep = next) {
+			next = ep->lnext;
+			if (ep->mfp != mfp)
+				continue;
+			ctier_unlink(sh, ep, ctier_hash(ep->mfp, ep->pgno));
+			free(ep);
+		}
+		pthread_mutex_unlock(&sh->lk);
+	}
+}
+
+/*
+ * __memp_ctier_stat --
+ *	Copy the compressed tier statistics into an mpool stat structure.
+ *
+ * PUBLIC: void __memp_ctier_stat __P((DB_MPOOL_STAT *));
+ */
+void
+__memp_ctier_stat(sp)
+	DB_MPOOL_STAT *sp;
+{
+	int i;
+
+	sp->st_ctier_hit = ctier_stat.hit;
+	sp->st_ctier_miss = ctier_stat.miss;
+	sp->st_ctier_insert = ctier_stat.insert;
+	sp->st_ctier_evict = ctier_stat.evict;
+	sp->st_ctier_reject = ctier_stat.reject;
+	sp->st_ctier_pages = 0;
+	sp->st_ctier_bytes = 0;
+	for (i = 0; i < CTIER_NSHARDS; i++) {
+		sp->st_ctier_pages += ctier[i].count;
+		sp->st_ctier_bytes += ctier[i].bytes;
+	}
+}
@@ -214,6 +214,57 @@ __memp_falloc_len(mfp, offset, len)
 
 u_int64_t gbl_memp_pgreads = 0;
 
+/* Pin already-pinned resident pages without the hash bucket mutex. */
+int gbl_memp_optimistic_fget = 0;
+
+/*
+ * Scan resistance: pages read in while the calling thread has the scan
+ * hint set are tagged BH_SCAN and returned to the cold end of the pool,
+ * until some other access references them again.
+ */
+int gbl_memp_scan_resistant = 0;
+__thread int memp_scan_hint = 0;
+
+#define	MP_OPT_MAXSTEPS	16
+
+/*
+ * __memp_fget_optimistic --
+ *	Try to pin a resident page without taking the hash bucket mutex.
+ *	Only buffers somebody else already has pinned are eligible: those
+ *	can't be evicted, and adding a pin never changes their priority or
+ *	their place in the bucket.  Returns the pinned buffer, or NULL if
+ *	the caller has to search the bucket the usual way.
+ */
+static BH *
+__memp_fget_optimistic(hp, mfp, pgno)
+	DB_MPOOL_HASH *hp;
+	MPOOLFILE *mfp;
+	db_pgno_t pgno;
+{
+	BH *bhp;
+	u_int16_t ref;
+	int steps;
+
+	MP_HASH_READER_ENTER(hp);
+	for (steps = 0, bhp = SH_TAILQ_FIRST(&hp->hash_bucket, __bh);
+	    bhp != NULL && steps < MP_OPT_MAXSTEPS;
+	    ++steps, bhp = SH_TAILQ_NEXT(bhp, hq, __bh)) {
+		if (bhp->pgno != pgno || bhp->mpf != mfp)
+			continue;
+		ref = __atomic_load_n(&bhp->ref, __ATOMIC_ACQUIRE);
+		while (ref != 0 && ref < UINT16_T_MAX - 1 &&
+		    !F_ISSET(bhp, BH_LOCKED | BH_TRASH | BH_CALLPGIN))
+			if (__atomic_compare_exchange_n(&bhp->ref, &ref,
+			    (u_int16_t)(ref + 1), 0,
+			    __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE))
+				goto done;
+		break;
+	}
+	bhp = NULL;
+done:	MP_HASH_READER_EXIT(hp);
+	return (bhp);
+}
+
 /*
  * __memp_fget_internal --
  *	Get a page from the file.
@@ -326,6 +377,39 @@ hb_search:
 	hp = R_ADDR(&dbmp->reginfo[n_cache], c_mp->htab);
 	hp = &hp[NBUCKET(c_mp, mfp, *pgnoaddr)];
 
+	/*
+	 * Hot pages are usually pinned by other readers already; try to add
+	 * our pin without the bucket mutex.  If the buffer turns out to need
+	 * I/O or conversion, carry the pin into the locked path below.
+	 */
+	if (gbl_memp_optimistic_fget &&
+	    (flags == 0 || flags == DB_MPOOL_CREATE) &&
+	    (bhp = __memp_fget_optimistic(hp, mfp, *pgnoaddr)) != NULL) {
+		b_incr = 1;
+		if (!F_ISSET(bhp, BH_LOCKED | BH_TRASH | BH_CALLPGIN)) {
+			/* No mutex here: other optimistic hits race us. */
+			if (ISINTERNAL(bhp->buf))
+				ATOMIC_ADD64(mfp->stat.st_cache_ihit, 1);
+			else if (ISLEAF(bhp->buf))
+				ATOMIC_ADD64(mfp->stat.st_cache_lhit, 1);
+			ATOMIC_ADD64(
+			    mfp->stat.st_level_hit[MP_LEVEL(bhp->buf)], 1);
+			ATOMIC_ADD64(mfp->stat.st_cache_hit, 1);
+			ATOMIC_ADD64(c_mp->stat.st_hash_opt_hit, 1);
+
+			*(void **)addrp = bhp->buf;
+			if (bhp->fget_count < UINT_MAX)
+				ATOMIC_ADD32(bhp->fget_count, 1);
+			if (gbl_bb_berkdb_enable_memp_timing)
+				bb_memp_hit(start_time_us);
+			return (0);
+		}
+		ATOMIC_ADD64(c_mp->stat.st_hash_opt_fallback, 1);
+		st_hsearch = 1;
+		MUTEX_LOCK(dbenv, &hp->hash_mutex);
+		goto pinned;
+	}
+
 	/* Search the hash chain for the page. */
 retry:	st_hsearch = 0;
 	MUTEX_LOCK(dbenv, &hp->hash_mutex);
@@ -349,8 +433,9 @@ retry:	st_hsearch = 0;
 			MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
 			goto err;
 		}
-		++bhp->ref;
+		(void)BH_REF_INC(bhp);
 		b_incr = 1;
+pinned:
 
 		/*
 		 * BH_LOCKED --
@@ -367,7 +452,7 @@ retry:	st_hsearch = 0;
 			 * and try again.
 			 */
 			if (!first && bhp->ref_sync != 0) {
-				--bhp->ref;
+				(void)BH_REF_DEC(bhp);
 				b_incr = 0;
 				MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
 				__os_yield(dbenv, 1);
@@ -390,13 +475,23 @@ retry:	st_hsearch = 0;
 			MUTEX_LOCK(dbenv, &hp->hash_mutex);
 		}
 
-		/* Layer violation */
+		/*
+		 * Layer violation.  Atomic, as optimistic hits update the same
+		 * counters without any mutex.
+		 */
 		if (ISINTERNAL(bhp->buf))
-			++mfp->stat.st_cache_ihit;
+			ATOMIC_ADD64(mfp->stat.st_cache_ihit, 1);
 		else if (ISLEAF(bhp->buf))
-			++mfp->stat.st_cache_lhit;
+			ATOMIC_ADD64(mfp->stat.st_cache_lhit, 1);
+		ATOMIC_ADD64(mfp->stat.st_level_hit[MP_LEVEL(bhp->buf)], 1);
 
-		++mfp->stat.st_cache_hit;
+		ATOMIC_ADD64(mfp->stat.st_cache_hit, 1);
+
+		/* A non-scan reference promotes a scan page. */
+		if (F_ISSET(bhp, BH_SCAN) && !memp_scan_hint) {
+			F_CLR(bhp, BH_SCAN);
+			ATOMIC_ADD64(c_mp->stat.st_scan_promote, 1);
+		}
 
         if (LF_ISSET(DB_MPOOL_PFGET))
             ++c_mp->stat.st_page_pf_in_late;
@@ -626,7 +721,7 @@ alloc:		/*
 		 * another one.
 		 */
 		if (flags == DB_MPOOL_NEW) {
-			--bhp->ref;
+			(void)BH_REF_DEC(bhp);
 			b_incr = 0;
 			goto alloc;
 		}
@@ -657,6 +752,13 @@ alloc:		/*
 		bhp->priority = UINT32_T_MAX;
 		bhp->pgno = *pgnoaddr;
 		bhp->mpf = mfp;
+
+		/*
+		 * Unlocked readers can see the buffer as soon as it is linked:
+		 * keep it marked as garbage until its contents are valid.
+		 */
+		F_SET(bhp, BH_TRASH);
+		MP_HASH_PUBLISH();
 		SH_TAILQ_INSERT_TAIL(&hp->hash_bucket, bhp, hq);
 
 		hp->hash_priority =
@@ -720,6 +822,11 @@ alloc:		/*
 
 			F_SET(bhp, BH_TRASH);
 			++mfp->stat.st_cache_miss;
+			__memp_ioacct(mfp, 1, 0, 0, 0, 0);
+			if (gbl_memp_scan_resistant && memp_scan_hint) {
+				F_SET(bhp, BH_SCAN);
+				ATOMIC_ADD64(c_mp->stat.st_scan_in, 1);
+			}
 			if (LF_ISSET(DB_MPOOL_PFGET)) {
 				++c_mp->stat.st_page_pf_in;
                 
@@ -748,6 +855,12 @@ alloc:		/*
 		if ((ret = __db_mutex_setup(dbenv,
 		    &dbmp->reginfo[n_cache], &bhp->mutex, 0)) != 0)
 			goto err;
+
+		/* A created page is valid now; let unlocked readers have it. */
+		if (extending) {
+			MP_HASH_PUBLISH();
+			F_CLR(bhp, BH_TRASH);
+		}
 	}
 
 	DB_ASSERT(bhp->ref != 0);
@@ -808,6 +921,7 @@ alloc:		/*
 				++mfp->stat.st_cache_imiss;
 			else if (ISLEAF(bhp->buf))
 				++mfp->stat.st_cache_lmiss;
+			++mfp->stat.st_level_miss[MP_LEVEL(bhp->buf)];
 		}
 	}
 
@@ -840,7 +954,7 @@ alloc:		/*
 
 	*(void **)addrp = bhp->buf;
 	if (bhp->fget_count < UINT_MAX)
-			bhp->fget_count++;
+		ATOMIC_ADD32(bhp->fget_count, 1);
 
 	if (gbl_bb_berkdb_enable_memp_timing)
 		bb_memp_hit(start_time_us);
@@ -855,7 +969,7 @@ err:	/*
 		if (bhp->ref == 1)
 			(void)__memp_bhfree(dbmp, hp, bhp, 1);
 		else {
-			--bhp->ref;
+			(void)BH_REF_DEC(bhp);
 			MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
 		}
 	}
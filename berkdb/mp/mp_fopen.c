@@ -24,6 +24,7 @@ static const char revid[] = "$Id: mp_fopen.c,v 11.120 2003/11/07 18:45:15 ubell
 #include "dbinc/log.h"
 #include "dbinc/mp.h"
 #include "locks_wrap.h"
+#include "comdb2_atomic.h"
 #include "assert.h"
 
 #ifdef HAVE_RPC
@@ -1156,6 +1157,33 @@ __memp_last_pgno(dbmfp, pgnoaddr)
 	R_UNLOCK(dbenv, dbmp->reginfo);
 }
 
+/*
+ * __memp_chg_gen --
+ *	Return the file's change generation, turning tracking on first.
+ *	The generation moves whenever a page of the file is dirtied,
+ *	whether by a transaction here or by replication applying one.
+ *
+ * !!!
+ * Undocumented interface: DB private.
+ *
+ * PUBLIC: u_int32_t __memp_chg_gen __P((DB_MPOOLFILE *));
+ */
+u_int32_t
+__memp_chg_gen(dbmfp)
+	DB_MPOOLFILE *dbmfp;
+{
+	static u_int32_t seed;
+	MPOOLFILE *mfp = dbmfp->mfp;
+
+	/*
+	 * Start each file somewhere new, so a file that is closed and
+	 * reopened doesn't hand out generations it has handed out before.
+	 */
+	if (!mfp->chg_gen_on && XCHANGE32(mfp->chg_gen_on, 1) == 0)
+		XCHANGE32(mfp->chg_gen, ATOMIC_ADD32(seed, 1 << 24));
+	return (ATOMIC_LOAD32(mfp->chg_gen));
+}
+
 /*
  * memp_fclose_pp --
  *	DB_MPOOLFILE->close pre/post processing.
@@ -1458,6 +1486,9 @@ __memp_mf_discard(dbmp, mfp)
 	 */
 	mfp->deadfile = 1;
 
+	/* Pages saved in the compressed tier are keyed on this MPOOLFILE. */
+	__memp_ctier_discard(mfp);
+
 	/* Discard the mutex we're holding. */
 	MUTEX_UNLOCK(dbenv, &mfp->mutex);
 
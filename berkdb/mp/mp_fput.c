@@ -25,6 +25,7 @@ static const char revid[] = "$Id: mp_fput.c,v 11.48 2003/09/30 17:12:00 sue Exp
 #include "comdb2_atomic.h"
 
 extern int gbl_enable_cache_internal_nodes;
+extern int gbl_memp_scan_resistant;
 
 static void __memp_reset_lru __P((DB_ENV *, REGINFO *));
 
@@ -162,6 +163,8 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 		ATOMIC_ADD32(c_mp->stat.st_page_dirty, -1);
 		F_CLR(bhp, BH_DIRTY);
 	}
+	if (LF_ISSET(DB_MPOOL_DIRTY) && dbmfp->mfp->chg_gen_on)
+		ATOMIC_ADD32(dbmfp->mfp->chg_gen, 1);
 	if (LF_ISSET(DB_MPOOL_DIRTY) && !F_ISSET(bhp, BH_DIRTY)) {
 		ATOMIC_ADD32(hp->hash_page_dirty, 1);
 		ATOMIC_ADD32(c_mp->stat.st_page_dirty, 1);
@@ -192,7 +195,7 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 	 * thread waiting to flush the buffer to disk, we're done.  Ignore the
 	 * discard flags (for now) and leave the buffer's priority alone.
 	 */
-	if (--bhp->ref > 1 || (bhp->ref == 1 && !F_ISSET(bhp, BH_LOCKED))) {
+	if (BH_REF_DEC(bhp) > 1 || (bhp->ref == 1 && !F_ISSET(bhp, BH_LOCKED))) {
 #ifdef REF_SYNC_TEST
 		if (F_ISSET(bhp, BH_LOCKED) && bhp->ref_sync) {
 			fprintf(stderr,
@@ -221,6 +224,17 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 	 */
 	else if (LF_ISSET(DB_MPOOL_NOCACHE) && F_ISSET(bhp, BH_NOINCR)) {
 		bhp->priority = 0;
+	}
+	/*
+	 * A page that only a table scan has used goes back as if it was last
+	 * touched a full cache turn ago, and doesn't advance the LRU clock:
+	 * it is evicted ahead of the working set, but not before the scan
+	 * is done with it.
+	 */
+	else if (gbl_memp_scan_resistant && F_ISSET(bhp, BH_SCAN)) {
+		bhp->priority = c_mp->lru_count > c_mp->stat.st_pages ?
+		    c_mp->lru_count - (u_int32_t)c_mp->stat.st_pages : 0;
+		incr_count = 0;
 	} else {
 		/*
 		 * We don't lock the LRU counter or the stat.st_pages field, if
@@ -107,6 +107,8 @@ __memp_fset(dbmfp, pgaddr, flags)
 		ATOMIC_ADD32(c_mp->stat.st_page_dirty, -1);
 		F_CLR(bhp, BH_DIRTY);
 	}
+	if (LF_ISSET(DB_MPOOL_DIRTY) && dbmfp->mfp->chg_gen_on)
+		ATOMIC_ADD32(dbmfp->mfp->chg_gen, 1);
 	if (LF_ISSET(DB_MPOOL_DIRTY) && !F_ISSET(bhp, BH_DIRTY)) {
 		ATOMIC_ADD32(hp->hash_page_dirty, 1);
 		ATOMIC_ADD32(c_mp->stat.st_page_dirty, 1);
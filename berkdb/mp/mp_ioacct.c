@@ -0,0 +1,196 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Per-file I/O accounting.
+ *
+ * Page faults (gets that missed the cache), pages and bytes read, and pages
+ * and bytes written are counted per file id, so that they can be attributed
+ * to tables and indexes.  Each thread adds to a small private batch, and only
+ * folds the batch into the shared table every IOACCT_BATCH events, when it
+ * sees more distinct files than the batch holds, or when it exits.  Counts
+ * can therefore lag by up to IOACCT_BATCH events per thread.
+ *
+ * The shared table is keyed on the file id rather than the MPOOLFILE, as a
+ * batch may outlive the MPOOLFILE it counted.  Entries are never removed;
+ * there is one per file ever read or written.
+ */
+
+#include "db_config.h"
+
+#ifndef NO_SYSTEM_INCLUDES
+#include <sys/types.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#include "db_int.h"
+#include "dbinc/db_shash.h"
+#include "dbinc/mp.h"
+
+#include "plhash.h"
+
+#define	IOACCT_BATCH	64
+#define	IOACCT_FILES	8
+
+struct ioacct_ent {
+	u_int8_t fileid[DB_FILE_ID_LEN];
+	DB_MPOOL_IOSTAT st;
+};
+
+struct ioacct_batch {
+	u_int32_t nevents;
+	u_int32_t nfiles;
+	struct {
+		MPOOLFILE *mfp;
+		struct ioacct_ent ent;
+	} files[IOACCT_FILES];
+};
+
+static pthread_mutex_t ioacct_lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *ioacct_files;
+static pthread_once_t ioacct_once = PTHREAD_ONCE_INIT;
+static pthread_key_t ioacct_key;
+static __thread struct ioacct_batch ioacct_batch;
+
+static void
+__memp_ioacct_flush(b)
+	struct ioacct_batch *b;
+{
+	struct ioacct_ent *e, *f;
+	u_int32_t i;
+
+	if (b->nfiles == 0)
+		return;
+	Pthread_mutex_lock(&ioacct_lk);
+	for (i = 0; i < b->nfiles; i++) {
+		f = &b->files[i].ent;
+		if ((e = hash_find(ioacct_files, f->fileid)) == NULL) {
+			if ((e = calloc(1, sizeof(*e))) == NULL)
+				continue;
+			memcpy(e->fileid, f->fileid, DB_FILE_ID_LEN);
+			hash_add(ioacct_files, e);
+		}
+		e->st.st_faults += f->st.st_faults;
+		e->st.st_reads += f->st.st_reads;
+		e->st.st_read_bytes += f->st.st_read_bytes;
+		e->st.st_writes += f->st.st_writes;
+		e->st.st_write_bytes += f->st.st_write_bytes;
+	}
+	Pthread_mutex_unlock(&ioacct_lk);
+	b->nfiles = 0;
+	b->nevents = 0;
+}
+
+static void
+__memp_ioacct_thread_exit(arg)
+	void *arg;
+{
+	__memp_ioacct_flush(arg);
+}
+
+static void
+__memp_ioacct_init(void)
+{
+	ioacct_files = hash_init_o(offsetof(struct ioacct_ent, fileid),
+	    DB_FILE_ID_LEN);
+	(void)pthread_key_create(&ioacct_key, __memp_ioacct_thread_exit);
+}
+
+/*
+ * __memp_ioacct --
+ *	Count faults, reads and writes of a file.
+ *
+ * PUBLIC: void __memp_ioacct __P((MPOOLFILE *,
+ * PUBLIC:     u_int32_t, u_int32_t, size_t, u_int32_t, size_t));
+ */
+void
+__memp_ioacct(mfp, faults, reads, read_bytes, writes, write_bytes)
+	MPOOLFILE *mfp;
+	u_int32_t faults, reads;
+	size_t read_bytes;
+	u_int32_t writes;
+	size_t write_bytes;
+{
+	struct ioacct_batch *b;
+	struct ioacct_ent *e;
+	u_int32_t i;
+
+	b = &ioacct_batch;
+	if (b->nevents == 0 && b->nfiles == 0) {
+		/* First event since the last flush: make sure we flush on exit. */
+		(void)pthread_once(&ioacct_once, __memp_ioacct_init);
+		if (pthread_getspecific(ioacct_key) == NULL)
+			(void)pthread_setspecific(ioacct_key, b);
+	}
+
+	/*
+	 * The MPOOLFILE may have been discarded and its memory reused since
+	 * it was batched, so check the file id too.
+	 */
+	for (i = 0; i < b->nfiles; i++)
+		if (b->files[i].mfp == mfp && memcmp(b->files[i].ent.fileid,
+		    mfp->fileid, DB_FILE_ID_LEN) == 0)
+			break;
+	if (i == b->nfiles) {
+		if (b->nfiles == IOACCT_FILES)
+			__memp_ioacct_flush(b);
+		i = b->nfiles++;
+		b->files[i].mfp = mfp;
+		memset(&b->files[i].ent, 0, sizeof(b->files[i].ent));
+		memcpy(b->files[i].ent.fileid, mfp->fileid, DB_FILE_ID_LEN);
+	}
+	e = &b->files[i].ent;
+	e->st.st_faults += faults;
+	e->st.st_reads += reads;
+	e->st.st_read_bytes += read_bytes;
+	e->st.st_writes += writes;
+	e->st.st_write_bytes += write_bytes;
+
+	if (++b->nevents >= IOACCT_BATCH)
+		__memp_ioacct_flush(b);
+}
+
+/*
+ * __memp_iostat_pp --
+ *	DB_ENV->memp_iostat: the counts of a file, zero if it was never read
+ *	or written.
+ *
+ * PUBLIC: int __memp_iostat_pp __P((DB_ENV *, const u_int8_t *,
+ * PUBLIC:     DB_MPOOL_IOSTAT *));
+ */
+int
+__memp_iostat_pp(dbenv, fileid, st)
+	DB_ENV *dbenv;
+	const u_int8_t *fileid;
+	DB_MPOOL_IOSTAT *st;
+{
+	struct ioacct_ent *e;
+
+	PANIC_CHECK(dbenv);
+	ENV_REQUIRES_CONFIG(dbenv,
+	    dbenv->mp_handle, "memp_iostat", DB_INIT_MPOOL);
+
+	memset(st, 0, sizeof(*st));
+	(void)pthread_once(&ioacct_once, __memp_ioacct_init);
+	Pthread_mutex_lock(&ioacct_lk);
+	if ((e = hash_find(ioacct_files, fileid)) != NULL)
+		*st = e->st;
+	Pthread_mutex_unlock(&ioacct_lk);
+	return (0);
+}
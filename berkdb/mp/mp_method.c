@@ -81,6 +81,8 @@ __memp_dbenv_create(dbenv)
 		dbenv->memp_dump_region = NULL;
 		dbenv->memp_register = __dbcl_memp_register;
 		dbenv->memp_stat = __dbcl_memp_stat;
+		dbenv->memp_residency = NULL;
+		dbenv->memp_iostat = NULL;
 		dbenv->memp_sync = __dbcl_memp_sync;
 		dbenv->memp_trickle = __dbcl_memp_trickle;
 	} else
@@ -99,6 +101,8 @@ __memp_dbenv_create(dbenv)
 		dbenv->memp_dump_region = __memp_dump_region;
 		dbenv->memp_register = __memp_register_pp;
 		dbenv->memp_stat = __memp_stat_pp;
+		dbenv->memp_residency = __memp_residency_pp;
+		dbenv->memp_iostat = __memp_iostat_pp;
 		dbenv->memp_sync = __memp_sync_pp;
 		dbenv->memp_dump = __memp_dump_pp;
 		dbenv->memp_load = __memp_load_pp;
@@ -21,7 +21,10 @@ static const char revid[] = "$Id: mp_region.c,v 11.55 2003/06/30 17:20:19 bostic
 #include "db_int.h"
 #include "dbinc/db_shash.h"
 #include "dbinc/mp.h"
+#include "numa_util.h"
 
+/* Bind each cache region to a NUMA node, round-robin. */
+int gbl_memp_numa = 0;
 
 static int __mpool_init __P((DB_ENV *, DB_MPOOL *, int, int));
 #ifdef HAVE_MUTEX_SYSTEM_RESOURCES
@@ -180,6 +183,18 @@ __memp_open(dbenv)
 		dbmp->reginfo[i].primary =
 		    R_ADDR(&dbmp->reginfo[i], dbmp->reginfo[i].rp->primary);
 
+	/*
+	 * Spread the cache regions, and with them their hash buckets and
+	 * buffers, across NUMA nodes.  The region a page lives in is fixed
+	 * by its hash, so this balances remote accesses rather than
+	 * eliminating them; threads are spread to match (sql_numa_pin).
+	 */
+	if (gbl_memp_numa && dbmp->nreg > 1 &&
+	    F_ISSET(dbmp->reginfo, REGION_CREATE))
+		for (i = 0; i < dbmp->nreg; ++i)
+			(void)comdb2_numa_bind_memory(dbmp->reginfo[i].addr,
+			    dbmp->reginfo[i].rp->size, i % comdb2_numa_nodes());
+
 	/* If the region is threaded, allocate a mutex to lock the handles. */
 	if (F_ISSET(dbenv, DB_ENV_THREAD) &&
 	    (ret = __db_mutex_setup(dbenv, dbmp->reginfo, &dbmp->mutexp,
@@ -251,6 +266,9 @@ __mpool_init(dbenv, dbmp, reginfo_off, htab_buckets)
 		mp->mpfhash = hash_init(DB_FILE_ID_LEN);
 		ZERO_LSN(mp->lsn);
 		ZERO_LSN(mp->trickle_lsn);
+		ZERO_LSN(mp->fuzzy_lsn);
+		mp->fuzzy_ms = 0;
+		mp->fuzzy_log_rate = 0;
 
 		mp->nreg = dbmp->nreg;
 		if ((ret = __db_shalloc(dbmp->reginfo[0].addr,
@@ -271,6 +289,7 @@ __mpool_init(dbenv, dbmp, reginfo_off, htab_buckets)
 		SH_TAILQ_INIT(&htab[i].hash_bucket);
 		htab[i].hash_priority = 0;
 		htab[i].hash_page_dirty = 0;
+		htab[i].hash_optreaders = 0;
 	}
 	mp->htab_buckets = mp->stat.st_hash_buckets = htab_buckets;
 
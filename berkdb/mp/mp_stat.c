@@ -21,6 +21,7 @@ static const char revid[] = "$Id: mp_stat.c,v 11.58 2003/09/13 19:20:41 bostic E
 #include "dbinc/db_page.h"
 #include "dbinc/db_shash.h"
 #include "dbinc/db_am.h"
+#include "dbinc/btree.h"
 #include "dbinc/log.h"
 #include "dbinc/mp.h"
 #include "logmsg.h"
@@ -32,6 +33,8 @@ static void __memp_pbh __P((DB_MPOOL *, BH *, MPOOLFILE **, FILE *));
 static int  __memp_stat __P((DB_ENV *,
 		DB_MPOOL_STAT **, DB_MPOOL_FSTAT ***, u_int32_t));
 static void __memp_stat_wait __P((REGINFO *, MPOOL *, DB_MPOOL_STAT *, int));
+static int  __memp_residency __P((DB_ENV *, DB_MPOOL_RSTAT **, u_int32_t *,
+		DB_MPOOL_HSTAT **, u_int32_t *, u_int32_t));
 
 /*
  * __memp_stat_pp --
@@ -110,6 +113,7 @@ __memp_stat(dbenv, gspp, fspp, flags)
 		sp->st_used_bytes = c_mp->stat.st_used_bytes;
 		sp->st_ncache = dbmp->nreg;
 		sp->st_regsize = dbmp->reginfo[0].rp->size;
+		__memp_ctier_stat(sp);
 
 		/* Walk the cache list and accumulate the global information. */
 		for (i = 0; i < mp->nreg; ++i) {
@@ -136,6 +140,8 @@ __memp_stat(dbenv, gspp, fspp, flags)
 			sp->st_ro_levict += c_mp->stat.st_ro_levict;
 			sp->st_rw_levict += c_mp->stat.st_rw_levict;
 			sp->st_pf_evict += c_mp->stat.st_pf_evict;
+			sp->st_scan_in += c_mp->stat.st_scan_in;
+			sp->st_scan_promote += c_mp->stat.st_scan_promote;
 			sp->st_rw_evict_skip += c_mp->stat.st_rw_evict_skip;
 			sp->st_page_trickle += c_mp->stat.st_page_trickle;
 			sp->st_pages += c_mp->stat.st_pages;
@@ -150,6 +156,9 @@ __memp_stat(dbenv, gspp, fspp, flags)
 			sp->st_hash_searches += c_mp->stat.st_hash_searches;
 			sp->st_hash_longest += c_mp->stat.st_hash_longest;
 			sp->st_hash_examined += c_mp->stat.st_hash_examined;
+			sp->st_hash_opt_hit += c_mp->stat.st_hash_opt_hit;
+			sp->st_hash_opt_fallback +=
+			    c_mp->stat.st_hash_opt_fallback;
 			/*
 			 * st_hash_nowait	calculated by __memp_stat_wait
 			 * st_hash_wait
@@ -286,6 +295,233 @@ __memp_stat(dbenv, gspp, fspp, flags)
 	return (0);
 }
 
+/*
+ * __memp_residency_pp --
+ *	DB_ENV->memp_residency pre/post processing.
+ *
+ * PUBLIC: int __memp_residency_pp __P((DB_ENV *, DB_MPOOL_RSTAT **,
+ * PUBLIC:     u_int32_t *, DB_MPOOL_HSTAT **, u_int32_t *, u_int32_t));
+ */
+int
+__memp_residency_pp(dbenv, rspp, nrsp, hspp, nhsp, nranges)
+	DB_ENV *dbenv;
+	DB_MPOOL_RSTAT **rspp;
+	u_int32_t *nrsp;
+	DB_MPOOL_HSTAT **hspp;
+	u_int32_t *nhsp;
+	u_int32_t nranges;
+{
+	PANIC_CHECK(dbenv);
+	ENV_REQUIRES_CONFIG(dbenv,
+	    dbenv->mp_handle, "memp_residency", DB_INIT_MPOOL);
+
+	if (hspp != NULL && nranges == 0) {
+		__db_err(dbenv, "DB_ENV->memp_residency: no page ranges");
+		return (EINVAL);
+	}
+	return (__memp_residency(dbenv, rspp, nrsp, hspp, nhsp, nranges));
+}
+
+struct __mp_res_file {
+	MPOOLFILE *mfp;
+	char *name;
+	db_pgno_t last_pgno;
+};
+
+static int
+__mp_res_cmp(a, b)
+	const void *a, *b;
+{
+	const struct __mp_res_file *fa = a, *fb = b;
+
+	if (fa->mfp == fb->mfp)
+		return (0);
+	return ((uintptr_t)fa->mfp < (uintptr_t)fb->mfp ? -1 : 1);
+}
+
+/*
+ * __memp_residency --
+ *	Walk every buffer in the cache and count them by file and btree
+ *	level, and, if hspp is set, by file and one of nranges equal ranges of
+ *	page numbers.  Each result is a single allocation, with the file names
+ *	after the array; rows with no pages are left out.
+ */
+static int
+__memp_residency(dbenv, rspp, nrsp, hspp, nhsp, nranges)
+	DB_ENV *dbenv;
+	DB_MPOOL_RSTAT **rspp;
+	u_int32_t *nrsp;
+	DB_MPOOL_HSTAT **hspp;
+	u_int32_t *nhsp;
+	u_int32_t nranges;
+{
+	BH *bhp;
+	DB_MPOOL *dbmp;
+	DB_MPOOL_HASH *hp;
+	DB_MPOOL_HSTAT *hsp;
+	DB_MPOOL_RSTAT *rsp;
+	MPOOL *c_mp, *mp;
+	MPOOLFILE *mfp;
+	struct __mp_res_file *files, key, *f;
+	DB_MPOOL_RSTAT *levels;
+	DB_MPOOL_HSTAT *ranges;
+	size_t len;
+	u_int32_t bucket, i, j, level, nfiles, nrows, r;
+	int ret;
+	char *name;
+
+	dbmp = dbenv->mp_handle;
+	mp = dbmp->reginfo[0].primary;
+	files = NULL;
+	levels = NULL;
+	ranges = NULL;
+	*rspp = NULL;
+	*nrsp = 0;
+	if (hspp != NULL) {
+		*hspp = NULL;
+		*nhsp = 0;
+	}
+
+	/*
+	 * Note the files first.  A file can go away while we walk the cache,
+	 * so buffers are matched to them by address, and only the names we
+	 * copied here are used.
+	 */
+	R_LOCK(dbenv, dbmp->reginfo);
+	for (nfiles = 0, mfp = SH_TAILQ_FIRST(&mp->mpfq, __mpoolfile);
+	    mfp != NULL; mfp = SH_TAILQ_NEXT(mfp, q, __mpoolfile))
+		++nfiles;
+	if ((ret = __os_calloc(dbenv,
+	    nfiles + 1, sizeof(*files), &files)) != 0) {
+		R_UNLOCK(dbenv, dbmp->reginfo);
+		return (ret);
+	}
+	for (i = 0, mfp = SH_TAILQ_FIRST(&mp->mpfq, __mpoolfile);
+	    mfp != NULL && i < nfiles;
+	    ++i, mfp = SH_TAILQ_NEXT(mfp, q, __mpoolfile)) {
+		files[i].mfp = mfp;
+		files[i].last_pgno = mfp->last_pgno;
+		if ((ret = __os_strdup(dbenv,
+		    __memp_fns(dbmp, mfp), &files[i].name)) != 0)
+			break;
+	}
+	R_UNLOCK(dbenv, dbmp->reginfo);
+	if (ret != 0)
+		goto err;
+	qsort(files, nfiles, sizeof(*files), __mp_res_cmp);
+
+	if ((ret = __os_calloc(dbenv, (size_t)nfiles * MPOOL_STAT_LEVELS + 1,
+	    sizeof(*levels), &levels)) != 0)
+		goto err;
+	if (hspp != NULL && (ret = __os_calloc(dbenv,
+	    (size_t)nfiles * nranges + 1, sizeof(*ranges), &ranges)) != 0)
+		goto err;
+
+	for (i = 0; i < dbmp->nreg; ++i) {
+		c_mp = dbmp->reginfo[i].primary;
+		for (hp = R_ADDR(&dbmp->reginfo[i], c_mp->htab), bucket = 0;
+		    bucket < c_mp->htab_buckets; ++hp, ++bucket) {
+			if (SH_TAILQ_FIRST(&hp->hash_bucket, __bh) == NULL)
+				continue;
+			MUTEX_LOCK(dbenv, &hp->hash_mutex);
+			for (bhp = SH_TAILQ_FIRST(&hp->hash_bucket, __bh);
+			    bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh)) {
+				key.mfp = bhp->mpf;
+				if ((f = bsearch(&key, files, nfiles,
+				    sizeof(*files), __mp_res_cmp)) == NULL)
+					continue;
+				j = f - files;
+				level = F_ISSET(bhp, BH_TRASH) ?
+				    0 : MP_LEVEL(bhp->buf);
+				rsp = &levels[j * MPOOL_STAT_LEVELS + level];
+				++rsp->resident;
+				if (F_ISSET(bhp, BH_DIRTY))
+					++rsp->dirty;
+				rsp->accesses += bhp->fget_count;
+				if (ranges == NULL)
+					continue;
+				r = (u_int32_t)(((u_int64_t)bhp->pgno *
+				    nranges) / ((u_int64_t)f->last_pgno + 1));
+				if (r >= nranges)
+					r = nranges - 1;
+				hsp = &ranges[j * nranges + r];
+				++hsp->resident;
+				hsp->accesses += bhp->fget_count;
+			}
+			MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+		}
+	}
+
+	/* Copy out the rows that have pages. */
+	for (nrows = 0, len = 0, j = 0; j < nfiles * MPOOL_STAT_LEVELS; ++j)
+		if (levels[j].resident != 0) {
+			++nrows;
+			len += sizeof(*rsp) +
+			    strlen(files[j / MPOOL_STAT_LEVELS].name) + 1;
+		}
+	if ((ret = __os_umalloc(dbenv, len + 1, rspp)) != 0)
+		goto err;
+	rsp = *rspp;
+	name = (char *)(rsp + nrows);
+	for (j = 0; j < nfiles * MPOOL_STAT_LEVELS; ++j) {
+		if (levels[j].resident == 0)
+			continue;
+		*rsp = levels[j];
+		rsp->level = j % MPOOL_STAT_LEVELS;
+		rsp->file_name = name;
+		strcpy(name, files[j / MPOOL_STAT_LEVELS].name);
+		name += strlen(name) + 1;
+		++rsp;
+	}
+	*nrsp = nrows;
+
+	if (ranges != NULL) {
+		for (nrows = 0, len = 0, j = 0; j < nfiles * nranges; ++j)
+			if (ranges[j].resident != 0) {
+				++nrows;
+				len += sizeof(*hsp) +
+				    strlen(files[j / nranges].name) + 1;
+			}
+		if ((ret = __os_umalloc(dbenv, len + 1, hspp)) != 0) {
+			__os_ufree(dbenv, *rspp);
+			*rspp = NULL;
+			*nrsp = 0;
+			goto err;
+		}
+		hsp = *hspp;
+		name = (char *)(hsp + nrows);
+		for (j = 0; j < nfiles * nranges; ++j) {
+			if (ranges[j].resident == 0)
+				continue;
+			f = &files[j / nranges];
+			r = j % nranges;
+			*hsp = ranges[j];
+			hsp->first_pgno = (db_pgno_t)((((u_int64_t)
+			    f->last_pgno + 1) * r + nranges - 1) / nranges);
+			hsp->last_pgno = (db_pgno_t)((((u_int64_t)
+			    f->last_pgno + 1) * (r + 1) + nranges - 1) /
+			    nranges - 1);
+			hsp->file_name = name;
+			strcpy(name, f->name);
+			name += strlen(name) + 1;
+			++hsp;
+		}
+		*nhsp = nrows;
+	}
+
+err:	if (files != NULL) {
+		for (i = 0; i < nfiles; ++i)
+			if (files[i].name != NULL)
+				__os_free(dbenv, files[i].name);
+		__os_free(dbenv, files);
+	}
+	if (levels != NULL)
+		__os_free(dbenv, levels);
+	if (ranges != NULL)
+		__os_free(dbenv, ranges);
+	return (ret);
+}
+
 #define	FMAP_ENTRIES	200			/* Files we map. */
 
 #define	MPOOL_DUMP_HASH	0x01			/* Debug hash chains. */
@@ -480,6 +716,7 @@ __memp_pbh(dbmp, bhp, fmap, fp)
 		{ BH_TRASH,		"trash" },
 		{ BH_NOINCR,		"low prio" },
 		{ BH_PREFAULT,		"prefault" },
+		{ BH_SCAN,		"scan" },
 		{ 0,			NULL }
 	};
 	int i;
@@ -51,6 +51,7 @@ typedef struct {
 
 static int __bhcmp __P((const void *, const void *));
 static int __bhlru __P((const void *, const void *));
+static int __bhfirstdirty __P((const void *, const void *));
 static int __memp_close_flush_files __P((DB_ENV *, DB_MPOOL *));
 static int __memp_sync_files __P((DB_ENV *, DB_MPOOL *));
 
@@ -655,7 +656,7 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 				bhparray[j]->ref_sync = 0;
 
 				/* Discard our reference and unlock the bucket*/
-				--bhparray[j]->ref;
+				(void)BH_REF_DEC(bhparray[j]);
 				MUTEX_UNLOCK(dbenv, &hparray[j]->hash_mutex);
 			}
 
@@ -728,7 +729,7 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 		bhp->ref_sync = bhp->ref;
 
 		/* Pin the buffer into memory and lock it. */
-		++bhp->ref;
+		(void)BH_REF_INC(bhp);
 		F_SET(bhp, BH_LOCKED);
 		MUTEX_LOCK(dbenv, &bhp->mutex);
 
@@ -912,7 +913,7 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 
 				/* Discard our reference and unlock
 				 * the bucket. */
-				--bhparray[j]->ref;
+				(void)BH_REF_DEC(bhparray[j]);
 				MUTEX_UNLOCK(dbenv, &hparray[j]->hash_mutex);
 			}
 
@@ -982,7 +983,7 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 			bhp->ref_sync = 0;
 
 			/* Discard our reference and unlock the bucket. */
-			--bhp->ref;
+			(void)BH_REF_DEC(bhp);
 			MUTEX_UNLOCK(dbenv, mutexp);
 		}
 
@@ -1046,7 +1047,7 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 		bhparray[j]->ref_sync = 0;
 
 		/* Discard our reference and unlock the bucket. */
-		--bhparray[j]->ref;
+		(void)BH_REF_DEC(bhparray[j]);
 		MUTEX_UNLOCK(dbenv, &hparray[j]->hash_mutex);
 	}
 
@@ -1359,8 +1360,10 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 			}
 			ar_cnt = j;
 		}
-		c_mp->stat.st_ckp_pages_skip += accum_skip;
-		c_mp->stat.st_ckp_pages_sync += accum_sync;
+		if (op != DB_SYNC_TRICKLE) {
+			c_mp->stat.st_ckp_pages_skip += accum_skip;
+			c_mp->stat.st_ckp_pages_sync += accum_sync;
+		}
 	}
 
 	/* If there no buffers to write, we're done. */
@@ -1383,6 +1386,9 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 	 */
 	if (op == DB_SYNC_LRU)
 		qsort(bharray, ar_cnt, sizeof(BH_TRACK), __bhlru);
+	else if (op == DB_SYNC_TRICKLE && ckp_lsnp != NULL &&
+	    ar_cnt > trickle_max)
+		qsort(bharray, ar_cnt, sizeof(BH_TRACK), __bhfirstdirty);
 	else if (ar_cnt > 1)
 		qsort(bharray, ar_cnt, sizeof(BH_TRACK), __bhcmp);
 
@@ -1395,10 +1401,10 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 		ar_cnt = trickle_max;
 
 	/*
-	 * Write the LRU pages in file/page order, only sorting as many
-	 * as ar_cnt.
+	 * Write the LRU (or oldest first-dirtied) pages in file/page order,
+	 * only sorting as many as ar_cnt.
 	 */
-	if (op == DB_SYNC_LRU)
+	if (op == DB_SYNC_LRU || (op == DB_SYNC_TRICKLE && ckp_lsnp != NULL))
 		qsort(bharray, ar_cnt, sizeof(BH_TRACK), __bhcmp);
 
 	/*
@@ -2539,3 +2545,17 @@ __bhlru(p1, p2)
 
 	return (0);
 }
+
+static int
+__bhfirstdirty(p1, p2)
+	const void *p1, *p2;
+{
+	BH_TRACK *bhp1, *bhp2;
+
+	bhp1 = (BH_TRACK *)p1;
+	bhp2 = (BH_TRACK *)p2;
+
+	/* Sort by the LSN the page was first dirtied at. */
+	return (log_compare(&bhp1->track_tx_begin_lsn,
+	    &bhp2->track_tx_begin_lsn));
+}
@@ -25,6 +25,18 @@ static const char revid[] = "$Id: mp_trickle.c,v 11.30 2003/09/13 19:20:41 bosti
 #include <time.h>
 
 static int __memp_trickle __P((DB_ENV *, int, int *, int));
+static int __memp_trickle_fuzzy __P((DB_ENV *, DB_LSN *, u_int32_t, int *));
+
+extern int comdb2_time_epochms();
+
+/*
+ * Fuzzy checkpoints: write dirty pages continuously so that a page stays
+ * dirty for about this many seconds at most.  0 disables.
+ */
+int gbl_ckp_fuzzy_target_secs = 0;
+
+/* Most pages a single fuzzy pass writes.  0 means no limit. */
+int gbl_ckp_fuzzy_max_pages = 0;
 
 /*
  * __memp_trickle_pp --
@@ -65,7 +77,7 @@ __memp_trickle(dbenv, pct, nwrotep, lru)
 	MPOOL *c_mp, *mp;
 	DB_LSN last_lsn;
 	u_int32_t dirty, i, total, dtmp;
-	int n, ret, wrote;
+	int fuzzy, n, ret, wrote;
 
 	dbmp = dbenv->mp_handle;
 	mp = dbmp->reginfo[0].primary;
@@ -99,16 +111,28 @@ __memp_trickle(dbenv, pct, nwrotep, lru)
 		dirty += dtmp;
 	}
 
+	if (nwrotep == NULL)
+		nwrotep = &wrote;
+
+	fuzzy = 0;
+	if (gbl_ckp_fuzzy_target_secs > 0 && dirty != 0) {
+		if ((ret = __memp_trickle_fuzzy(dbenv,
+		    &last_lsn, dirty, &fuzzy)) != 0)
+			goto done;
+		mp->stat.st_page_trickle += fuzzy;
+		dirty = fuzzy < dirty ? dirty - fuzzy : 0;
+	}
+
 	/*
 	 * !!!
 	 * Be careful in modifying this calculation, total may be 0.
 	 */
 	n = ((total * pct) / 100) - (total - dirty);
-	if (dirty == 0 || n <= 0)
+	if (dirty == 0 || n <= 0) {
+		*nwrotep = fuzzy;
 		goto done;
+	}
 
-	if (nwrotep == NULL)
-		nwrotep = &wrote;
 	if (dbenv->iomap && dbenv->attr.iomap_enabled)
 		dbenv->iomap->memptrickle_active = time(NULL);
 	/* With perfect checkpoints it is unlikely to ensure the percentage
@@ -119,8 +143,95 @@ __memp_trickle(dbenv, pct, nwrotep, lru)
 		dbenv->iomap->memptrickle_active = 0;
 
 	mp->stat.st_page_trickle += *nwrotep;
+	*nwrotep += fuzzy;
 
 done:	memcpy(&mp->trickle_lsn, &last_lsn, sizeof(DB_LSN));
 
 	return (ret);
 }
+
+/*
+ * __memp_trickle_fuzzy --
+ *	Fuzzy checkpointing.  Rather than leaving every dirty page for the
+ *	next checkpoint, write them at a steady rate: a pass writes the share
+ *	of the dirty pages due in the time since the last pass, so the whole
+ *	dirty set turns over every gbl_ckp_fuzzy_target_secs.  If perfect
+ *	checkpoints track when pages were first dirtied, only pages first
+ *	dirtied further back than the log generated in that many seconds, at
+ *	the current log rate, are written, oldest first.
+ */
+static int
+__memp_trickle_fuzzy(dbenv, last_lsnp, dirty, nwrotep)
+	DB_ENV *dbenv;
+	DB_LSN *last_lsnp;
+	u_int32_t dirty;
+	int *nwrotep;
+{
+	DB_LSN target_lsn, *ckp_lsnp;
+	DB_MPOOL *dbmp;
+	LOG *lp;
+	MPOOL *mp;
+	u_int64_t n, window;
+	int64_t bytes, elapsed, now;
+	u_int32_t log_size;
+	int ret;
+
+	dbmp = dbenv->mp_handle;
+	mp = dbmp->reginfo[0].primary;
+	lp = ((DB_LOG *)dbenv->lg_handle)->reginfo.primary;
+	log_size = lp->log_size;
+	*nwrotep = 0;
+
+	now = comdb2_time_epochms();
+	if (mp->fuzzy_ms == 0 || IS_ZERO_LSN(mp->fuzzy_lsn)) {
+		mp->fuzzy_ms = now;
+		mp->fuzzy_lsn = *last_lsnp;
+		return (0);
+	}
+	if ((elapsed = now - mp->fuzzy_ms) <= 0)
+		return (0);
+
+	/* Let time accumulate until at least a page is due. */
+	n = ((u_int64_t)dirty * elapsed) /
+	    ((u_int64_t)gbl_ckp_fuzzy_target_secs * 1000);
+	if (gbl_ckp_fuzzy_max_pages > 0 && n > (u_int64_t)gbl_ckp_fuzzy_max_pages)
+		n = gbl_ckp_fuzzy_max_pages;
+	if (n == 0)
+		return (0);
+
+	bytes = ((int64_t)last_lsnp->file - mp->fuzzy_lsn.file) * log_size +
+	    ((int64_t)last_lsnp->offset - mp->fuzzy_lsn.offset);
+	if (bytes < 0)
+		bytes = 0;
+	mp->fuzzy_log_rate =
+	    (mp->fuzzy_log_rate * 3 + (bytes * 1000) / elapsed) / 4;
+	mp->fuzzy_ms = now;
+	mp->fuzzy_lsn = *last_lsnp;
+
+	ckp_lsnp = NULL;
+	if (dbenv->tx_perfect_ckp && log_size != 0) {
+		window = mp->fuzzy_log_rate * gbl_ckp_fuzzy_target_secs;
+		target_lsn = *last_lsnp;
+		if (window / log_size >= target_lsn.file)
+			return (0);
+		target_lsn.file -= (u_int32_t)(window / log_size);
+		window %= log_size;
+		if (target_lsn.offset >= window)
+			target_lsn.offset -= (u_int32_t)window;
+		else if (target_lsn.file > 1) {
+			--target_lsn.file;
+			target_lsn.offset += log_size - (u_int32_t)window;
+		} else
+			return (0);
+		ckp_lsnp = &target_lsn;
+	}
+
+	if (dbenv->iomap && dbenv->attr.iomap_enabled)
+		dbenv->iomap->memptrickle_active = time(NULL);
+	ret = __memp_sync_int(dbenv, NULL, (int)n,
+	    DB_SYNC_TRICKLE, nwrotep, 1, ckp_lsnp, 1);
+	if (dbenv->iomap && dbenv->attr.iomap_enabled)
+		dbenv->iomap->memptrickle_active = 0;
+
+	return (ret);
+}
@@ -65,6 +65,7 @@ extern void (*__berkdb_trace_func)(const char *);
 static int __berkdb_fsync_alarm_ms = 0;
 static long long *__berkdb_num_fsyncs = 0;
 static void (*fsync_callback)(int fd) = 0;
+static void (*fsync_time_callback)(uint64_t us) = 0;
 
 /* defined in os_rw.c */
 uint64_t bb_berkdb_fasttime(void);
@@ -81,6 +82,13 @@ __berkdb_register_fsync_callback(void (*callback) (int fd))
 	fsync_callback = callback;
 }
 
+/* called with the duration of every fsync, in microseconds */
+void
+__berkdb_register_fsync_time_callback(void (*callback) (uint64_t us))
+{
+	fsync_time_callback = callback;
+}
+
 void
 berk_fsync_alarm_ms(int x)
 {
@@ -88,6 +96,23 @@ berk_fsync_alarm_ms(int x)
 	__berkdb_fsync_alarm_ms = x;
 }
 
+/*
+ * __os_fsync_account --
+ *	Count a sync of fd that was issued outside of __os_fsync.
+ *
+ * PUBLIC: void __os_fsync_account __P((int));
+ */
+void
+__os_fsync_account(fd)
+	int fd;
+{
+	if (__berkdb_num_fsyncs)
+		(*__berkdb_num_fsyncs)++;
+
+	if (fsync_callback)
+		fsync_callback(fd);
+}
+
 /*
  * __os_fsync --
  *	Flush a file descriptor.
@@ -132,7 +157,7 @@ __os_fsync(dbenv, fhp)
 
 	retries = 0;
 
-	if (ckalmn)
+	if (ckalmn || fsync_time_callback)
 		x1 = bb_berkdb_fasttime();
 
 #if defined(_AIX)
@@ -165,11 +190,11 @@ __os_fsync(dbenv, fhp)
 	    ++retries < DB_RETRY);
 #endif
 
-	if (ckalmn)
+	if (ckalmn || fsync_time_callback)
 		x2 = bb_berkdb_fasttime();
 
 
-	if ((x2 - x1) > M2U(ckalmn) && __berkdb_trace_func) {
+	if (ckalmn && (x2 - x1) > M2U(ckalmn) && __berkdb_trace_func) {
 		char s[80];
 
 		snprintf(s, sizeof(s), "LONG FSYNC FD=%d %d ms\n",
@@ -183,6 +208,9 @@ __os_fsync(dbenv, fhp)
 	if (fsync_callback)
 		fsync_callback(fhp->fd);
 
+	if (fsync_time_callback)
+		fsync_time_callback(x2 - x1);
+
 
 	if (ret != 0)
 		__db_err(dbenv, "fsync %s", strerror(ret));
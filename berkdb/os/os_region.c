@@ -17,6 +17,7 @@ static const char revid[] = "$Id: os_region.c,v 11.17 2003/07/13 17:45:23 bostic
 #include <stdlib.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <errno.h>
 #include <sys/mman.h>
 #include <sys/types.h>
 #endif
@@ -27,6 +28,7 @@ static const char revid[] = "$Id: os_region.c,v 11.17 2003/07/13 17:45:23 bostic
 
 extern char gbl_dbname[MAX_DBNAME_LENGTH];
 extern int gbl_largepages;
+extern int gbl_hugepage_mb;
 
 
 struct region {
@@ -90,6 +92,49 @@ __dbenv_regiontype(int type)
   will return the memory.
 */
 
+/*
+  explicit huge pages:
+
+  lrl option "hugepage_mb 2" (or 1024) backs every region of at least that
+  size with anonymous 2MB (or 1GB) huge pages, mapped with MAP_HUGETLB.
+  this needs no hugetlbfs mount, only enough pages of that size reserved:
+
+       echo 102400 > /sys/kernel/mm/hugepages/hugepages-2048kB/nr_hugepages
+
+  1GB pages usually have to be reserved on the kernel command line
+  (hugepagesz=1G hugepages=N).  if pages of the asked size can't be had, 2MB
+  pages are tried, then normal pages.  what each region got is logged.
+*/
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+static void *
+__os_r_hugemap(size_t *sizep, size_t *hugep)
+{
+#ifdef MAP_HUGETLB
+	size_t huge, size;
+	void *addr;
+
+	for (huge = (size_t)gbl_hugepage_mb << 20; huge >= (2UL << 20);
+	    huge = (huge == (2UL << 20)) ? 0 : (2UL << 20)) {
+		if (*sizep < huge)
+			continue;
+		size = (*sizep + huge - 1) & ~(huge - 1);
+		addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+		    ((__builtin_ctzl(huge)) << MAP_HUGE_SHIFT), -1, 0);
+		if (addr != MAP_FAILED) {
+			*sizep = size;
+			*hugep = huge;
+			return (addr);
+		}
+	}
+#endif
+	*hugep = 0;
+	return (NULL);
+}
+
 /*
  * __os_r_attach --
  *	Attach to a shared memory region.
@@ -109,13 +154,32 @@ __os_r_attach(dbenv, infop, rp)
 	OS_VMROUNDOFF(rp->size);
 
 	infop->fd = -1;
+	infop->hugemap_len = 0;
 
 	/* memory regions are separately tracked. To avoid
 	   double-counting on "berkdb" allocator, system malloc is
 	   used to create the region. */
 	dbenv->set_use_sys_malloc(dbenv, 1);
 
-	if (!gbl_largepages || rp->size < MB_2) {
+	if (!gbl_largepages && gbl_hugepage_mb && rp->size >= MB_2) {
+		size_t size = rp->size, huge;
+
+		infop->addr = __os_r_hugemap(&size, &huge);
+		if (infop->addr != NULL) {
+			logmsg(LOGMSG_USER, "%s region %u: %zu MB on %zu MB "
+			    "huge pages\n", __dbenv_regiontype(rp->type),
+			    infop->id, size >> 20, huge >> 20);
+			rp->size = size;
+			infop->hugemap_len = size;
+			ret = 0;
+		} else {
+			logmsg(LOGMSG_WARN, "%s region %u: no huge pages for "
+			    "%zu MB (%s), using normal pages\n",
+			    __dbenv_regiontype(rp->type), infop->id,
+			    (size_t)rp->size >> 20, strerror(errno));
+			ret = __os_calloc(dbenv, 1, rp->size, &infop->addr);
+		}
+	} else if (!gbl_largepages || rp->size < MB_2) {
         if (rp->size != 0)
             ret = __os_calloc(dbenv, 1, rp->size, &infop->addr);
         else {
@@ -176,7 +240,10 @@ __os_r_detach(dbenv, infop, destroy)
 
 	dbenv->set_use_sys_malloc(dbenv, 1);
 
-	if (infop->fd < 0 && infop->addr) {
+	if (infop->hugemap_len != 0) {
+		munmap(infop->addr, infop->hugemap_len);
+		infop->hugemap_len = 0;
+	} else if (infop->fd < 0 && infop->addr) {
 		__os_free(dbenv, infop->addr);
 	} else {
 		char name[MAXPATHLEN];
@@ -97,6 +97,10 @@ init_iobuf(void)
 	Pthread_key_create(&iobufkey, free_iobuf);
 }
 
+/* Direct I/O can use the caller's buffer as is if it is aligned. */
+#define	DIO_ALIGNED(buf, bufsz)						\
+	(((((uintptr_t)(buf)) | (bufsz)) & (DB_DIO_ALIGN - 1)) == 0)
+
 static void *
 get_aligned_buffer(void *buf, size_t bufsz, int copy)
 {
@@ -107,10 +111,10 @@ get_aligned_buffer(void *buf, size_t bufsz, int copy)
 		b = malloc(sizeof(struct iobuf));
 		b->sz = bufsz;
 #if ! defined  ( _SUN_SOURCE ) && ! defined ( _HP_SOURCE )
-		if (posix_memalign(&b->buf, 512, bufsz))
+		if (posix_memalign(&b->buf, DB_DIO_ALIGN, bufsz))
 			return NULL;
 #else
-		b->buf = memalign(512, bufsz);
+		b->buf = memalign(DB_DIO_ALIGN, bufsz);
 		if (b->buf == NULL)
 			return NULL;
 #endif
@@ -121,10 +125,10 @@ get_aligned_buffer(void *buf, size_t bufsz, int copy)
 
 		b->sz = 0;
 #if ! defined ( _SUN_SOURCE ) &&  ! defined ( _HP_SOURCE )
-		if (posix_memalign(&b->buf, 512, bufsz))
+		if (posix_memalign(&b->buf, DB_DIO_ALIGN, bufsz))
 			return NULL;
 #else
-		b->buf = memalign(512, bufsz);
+		b->buf = memalign(DB_DIO_ALIGN, bufsz);
 		if (b->buf == NULL)
 			return NULL;
 #endif
@@ -144,7 +148,7 @@ __berkdb_pread(int fd, void *buf, size_t bufsz, off_t offset, int direct)
 
 	pthread_once(&once, init_iobuf);
 
-	if (direct)
+	if (direct && !DIO_ALIGNED(buf, bufsz))
 		abuf = get_aligned_buffer(buf, bufsz, 0);
 	else
 		abuf = buf;
@@ -165,7 +169,7 @@ __berkdb_pwrite(DB_ENV *dbenv, int fd, void *buf, size_t bufsz,
 
 	pthread_once(&once, init_iobuf);
 
-	if (direct)
+	if (direct && !DIO_ALIGNED(buf, bufsz))
 		abuf = get_aligned_buffer(buf, bufsz, 1);
 	else
 		abuf = buf;
@@ -568,7 +572,7 @@ static int __berkdb_read(DB_ENV *dbenv, int fd, void *buf, size_t bufsz, int dir
 	int rc;
 
 	pthread_once(&once, init_iobuf);
-	if (direct)
+	if (direct && !DIO_ALIGNED(buf, bufsz))
 		abuf = get_aligned_buffer(buf, bufsz, 0);
 	else
 		abuf = buf;
@@ -584,7 +588,7 @@ static int __berkdb_write(DB_ENV *dbenv, int fd, void *buf, size_t bufsz, int di
 	int nretries = 0;
 
 	pthread_once(&once, init_iobuf);
-	if (direct)
+	if (direct && !DIO_ALIGNED(buf, bufsz))
 		abuf = get_aligned_buffer(buf, bufsz, 1);
 	else
 		abuf = buf;
@@ -0,0 +1,592 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Minimal io_uring wrapper for the log writer.
+ *
+ * Writes are queued with __os_uring_pwrite and go to the kernel together
+ * with a trailing fdatasync in __os_uring_submit_sync, which is a single
+ * io_uring_enter call.  The fsync is marked IOSQE_IO_DRAIN so it starts
+ * only once every queued write has completed, while the writes themselves
+ * are free to be in flight at the same time.  __os_uring_submit_sync
+ * returns as soon as the writes are done, so the caller can release the
+ * memory they came from and collect the sync later with __os_uring_wait.
+ *
+ * The ring is driven through the raw system calls so there is no liburing
+ * dependency.  A ring is not thread-safe; callers serialize access.
+ */
+
+#include "db_config.h"
+
+#ifndef NO_SYSTEM_INCLUDES
+#include <sys/types.h>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+#include "db_int.h"
+
+#if defined(_LINUX_SOURCE) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define	HAVE_OS_URING	1
+#endif
+#endif
+
+#ifdef HAVE_OS_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define	URING_MAX_OPS	16
+
+#define	URING_OP_WRITE	1
+#define	URING_OP_FSYNC	2
+
+struct __os_uring_op {
+	int op;				/* URING_OP_*, 0 if the slot is free. */
+	int fd;
+	u_int8_t *buf;
+	size_t len;
+	off_t off;
+};
+
+struct __os_uring {
+	int fd;				/* Ring file descriptor. */
+
+	void *sq_ring;			/* Submission queue mapping. */
+	size_t sq_ring_sz;
+	u_int32_t *sq_head;
+	u_int32_t *sq_tail;
+	u_int32_t *sq_mask;
+	u_int32_t *sq_array;
+	struct io_uring_sqe *sqes;
+	size_t sqes_sz;
+
+	void *cq_ring;			/* Completion queue mapping. */
+	size_t cq_ring_sz;
+	u_int32_t *cq_head;
+	u_int32_t *cq_tail;
+	u_int32_t *cq_mask;
+	struct io_uring_cqe *cqes;
+
+	u_int32_t nops;			/* Slots in use. */
+	u_int32_t nqueued;		/* Filled but not yet submitted. */
+	u_int32_t ninflight;		/* Submitted but not yet reaped. */
+	u_int32_t nwrites;		/* Writes queued or in flight. */
+	int error;			/* First error seen. */
+	int resync_fd;			/* Short write finished after the sync
+					 * may have run; sync again, or -1. */
+
+	struct __os_uring_op ops[URING_MAX_OPS];
+};
+
+static int __os_uring_enter __P((DB_OS_URING *, u_int32_t, u_int32_t));
+static void __os_uring_reap __P((DB_ENV *, DB_OS_URING *));
+static int __os_uring_wait_until __P((DB_ENV *, DB_OS_URING *, int));
+static struct io_uring_sqe *__os_uring_get_sqe __P((DB_ENV *,
+    DB_OS_URING *, u_int32_t *));
+
+/*
+ * __os_uring_create --
+ *	Set up a ring.  Returns an errno value, typically ENOSYS or EPERM
+ *	where the kernel or a seccomp profile does not allow io_uring.
+ *
+ * PUBLIC: int __os_uring_create __P((DB_ENV *, DB_OS_URING **));
+ */
+int
+__os_uring_create(dbenv, ringp)
+	DB_ENV *dbenv;
+	DB_OS_URING **ringp;
+{
+	struct io_uring_params p;
+	DB_OS_URING *ring;
+	void *ptr;
+	int ret;
+
+	*ringp = NULL;
+	if ((ret = __os_calloc(dbenv, 1, sizeof(*ring), &ring)) != 0)
+		return (ret);
+
+	memset(&p, 0, sizeof(p));
+	ring->resync_fd = -1;
+	ring->fd = (int)syscall(__NR_io_uring_setup, URING_MAX_OPS, &p);
+	if (ring->fd < 0) {
+		ret = __os_get_errno();
+		__os_free(dbenv, ring);
+		return (ret);
+	}
+
+	ring->sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof(u_int32_t);
+	ring->cq_ring_sz =
+	    p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_ring_sz > ring->sq_ring_sz)
+			ring->sq_ring_sz = ring->cq_ring_sz;
+		ring->cq_ring_sz = ring->sq_ring_sz;
+	}
+
+	ptr = mmap(NULL, ring->sq_ring_sz, PROT_READ | PROT_WRITE,
+	    MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	if (ptr == MAP_FAILED)
+		goto err;
+	ring->sq_ring = ptr;
+
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		ring->cq_ring = ring->sq_ring;
+	else {
+		ptr = mmap(NULL, ring->cq_ring_sz, PROT_READ | PROT_WRITE,
+		    MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+		if (ptr == MAP_FAILED)
+			goto err;
+		ring->cq_ring = ptr;
+	}
+
+	ring->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+	ptr = mmap(NULL, ring->sqes_sz, PROT_READ | PROT_WRITE,
+	    MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if (ptr == MAP_FAILED)
+		goto err;
+	ring->sqes = ptr;
+
+	ring->sq_head = (u_int32_t *)((u_int8_t *)ring->sq_ring + p.sq_off.head);
+	ring->sq_tail = (u_int32_t *)((u_int8_t *)ring->sq_ring + p.sq_off.tail);
+	ring->sq_mask =
+	    (u_int32_t *)((u_int8_t *)ring->sq_ring + p.sq_off.ring_mask);
+	ring->sq_array =
+	    (u_int32_t *)((u_int8_t *)ring->sq_ring + p.sq_off.array);
+	ring->cq_head = (u_int32_t *)((u_int8_t *)ring->cq_ring + p.cq_off.head);
+	ring->cq_tail = (u_int32_t *)((u_int8_t *)ring->cq_ring + p.cq_off.tail);
+	ring->cq_mask =
+	    (u_int32_t *)((u_int8_t *)ring->cq_ring + p.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)
+	    ((u_int8_t *)ring->cq_ring + p.cq_off.cqes);
+
+	*ringp = ring;
+	return (0);
+
+err:	ret = __os_get_errno();
+	__os_uring_destroy(dbenv, ring);
+	return (ret);
+}
+
+/*
+ * __os_uring_destroy --
+ *	Wait for anything outstanding and tear the ring down.
+ *
+ * PUBLIC: void __os_uring_destroy __P((DB_ENV *, DB_OS_URING *));
+ */
+void
+__os_uring_destroy(dbenv, ring)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+{
+	if (ring == NULL)
+		return;
+
+	if (ring->sqes != NULL)
+		(void)__os_uring_wait(dbenv, ring);
+
+	if (ring->sqes != NULL)
+		(void)munmap(ring->sqes, ring->sqes_sz);
+	if (ring->cq_ring != NULL && ring->cq_ring != ring->sq_ring)
+		(void)munmap(ring->cq_ring, ring->cq_ring_sz);
+	if (ring->sq_ring != NULL)
+		(void)munmap(ring->sq_ring, ring->sq_ring_sz);
+	if (ring->fd >= 0)
+		(void)close(ring->fd);
+	__os_free(dbenv, ring);
+}
+
+/*
+ * __os_uring_fh_ok --
+ *	Return 1 if writes and syncs on this handle can go through a ring;
+ *	handles that __os_fsync would skip, or that have replacement I/O
+ *	functions installed, keep using the synchronous path.
+ *
+ * PUBLIC: int __os_uring_fh_ok __P((DB_ENV *, DB_FH *));
+ */
+int
+__os_uring_fh_ok(dbenv, fhp)
+	DB_ENV *dbenv;
+	DB_FH *fhp;
+{
+	if (fhp == NULL || !F_ISSET(fhp, DB_FH_OPENED) || fhp->fd == -1)
+		return (0);
+	if (F_ISSET(fhp, DB_FH_NOSYNC | DB_FH_TEMP | DB_FH_DIRECT | DB_FH_SYNC))
+		return (0);
+	if (DB_GLOBAL(j_write) != NULL || DB_GLOBAL(j_fsync) != NULL)
+		return (0);
+	if (dbenv->attr.debug_enospc_chance)
+		return (0);
+	return (1);
+}
+
+/*
+ * __os_uring_pwrite --
+ *	Queue a write of len bytes at off.  The caller must keep addr valid
+ *	until __os_uring_submit_sync or __os_uring_wait returns.
+ *
+ * PUBLIC: int __os_uring_pwrite __P((DB_ENV *,
+ * PUBLIC:     DB_OS_URING *, DB_FH *, void *, size_t, off_t));
+ */
+int
+__os_uring_pwrite(dbenv, ring, fhp, addr, len, off)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+	DB_FH *fhp;
+	void *addr;
+	size_t len;
+	off_t off;
+{
+	struct io_uring_sqe *sqe;
+	u_int32_t slot;
+
+	if (len == 0)
+		return (0);
+	if ((sqe = __os_uring_get_sqe(dbenv, ring, &slot)) == NULL)
+		return (ring->error != 0 ? ring->error : EIO);
+
+	ring->ops[slot].op = URING_OP_WRITE;
+	ring->ops[slot].fd = fhp->fd;
+	ring->ops[slot].buf = addr;
+	ring->ops[slot].len = len;
+	ring->ops[slot].off = off;
+
+	sqe->opcode = IORING_OP_WRITE;
+	sqe->fd = fhp->fd;
+	sqe->addr = (u_int64_t)(uintptr_t)addr;
+	sqe->len = (u_int32_t)len;
+	sqe->off = (u_int64_t)off;
+	sqe->user_data = slot;
+
+	ring->nwrites++;
+	return (0);
+}
+
+/*
+ * __os_uring_pending --
+ *	Return the number of writes queued or in flight.
+ *
+ * PUBLIC: u_int32_t __os_uring_pending __P((DB_OS_URING *));
+ */
+u_int32_t
+__os_uring_pending(ring)
+	DB_OS_URING *ring;
+{
+	return (ring == NULL ? 0 : ring->nwrites);
+}
+
+/*
+ * __os_uring_submit_sync --
+ *	Queue an fdatasync of fhp behind every queued write, submit them all
+ *	in one call and wait for the writes (but not the sync) to complete.
+ *	Returns the first write error.
+ *
+ * PUBLIC: int __os_uring_submit_sync __P((DB_ENV *, DB_OS_URING *, DB_FH *));
+ */
+int
+__os_uring_submit_sync(dbenv, ring, fhp)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+	DB_FH *fhp;
+{
+	struct io_uring_sqe *sqe;
+	u_int32_t slot;
+	int ret;
+
+	if ((sqe = __os_uring_get_sqe(dbenv, ring, &slot)) == NULL)
+		return (ring->error != 0 ? ring->error : EIO);
+
+	ring->ops[slot].op = URING_OP_FSYNC;
+	ring->ops[slot].fd = fhp->fd;
+
+	sqe->opcode = IORING_OP_FSYNC;
+	sqe->fd = fhp->fd;
+	sqe->flags = IOSQE_IO_DRAIN;
+	sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+	sqe->user_data = slot;
+
+	if ((ret = __os_uring_wait_until(dbenv, ring, 0)) != 0)
+		return (ret);
+
+	ret = ring->error;
+	ring->error = 0;
+	return (ret);
+}
+
+/*
+ * __os_uring_wait --
+ *	Submit anything queued and wait for every operation to complete.
+ *	Returns the first error seen since the last call.  A NULL ring is
+ *	allowed and has nothing to wait for.
+ *
+ * PUBLIC: int __os_uring_wait __P((DB_ENV *, DB_OS_URING *));
+ */
+int
+__os_uring_wait(dbenv, ring)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+{
+	int ret;
+
+	if (ring == NULL)
+		return (0);
+	if ((ret = __os_uring_wait_until(dbenv, ring, 1)) != 0)
+		return (ret);
+
+	/* The tail of a short write isn't covered by the queued sync. */
+	if (ring->resync_fd != -1) {
+		while (fdatasync(ring->resync_fd) != 0)
+			if ((ret = __os_get_errno()) != EINTR) {
+				__db_err(dbenv, "fsync %s", strerror(ret));
+				if (ring->error == 0)
+					ring->error = ret;
+				break;
+			}
+		__os_fsync_account(ring->resync_fd);
+		ring->resync_fd = -1;
+	}
+
+	ret = ring->error;
+	ring->error = 0;
+	return (ret);
+}
+
+/*
+ * __os_uring_wait_until --
+ *	Submit queued entries and reap completions until either nothing is
+ *	outstanding (all != 0) or no writes are outstanding (all == 0).
+ */
+static int
+__os_uring_wait_until(dbenv, ring, all)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+	int all;
+{
+	int ret;
+
+	for (;;) {
+		__os_uring_reap(dbenv, ring);
+		if (ring->nqueued == 0 &&
+		    (all ? ring->ninflight == 0 : ring->nwrites == 0))
+			return (0);
+		if ((ret = __os_uring_enter(ring, ring->nqueued, 1)) != 0)
+			return (ret);
+	}
+}
+
+/*
+ * __os_uring_get_sqe --
+ *	Return the next free submission entry, draining the ring first if
+ *	it is full.
+ */
+static struct io_uring_sqe *
+__os_uring_get_sqe(dbenv, ring, slotp)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+	u_int32_t *slotp;
+{
+	struct io_uring_sqe *sqe;
+	u_int32_t slot, tail, idx;
+
+	if (ring->nops == URING_MAX_OPS &&
+	    __os_uring_wait_until(dbenv, ring, 1) != 0)
+		return (NULL);
+
+	for (slot = 0; slot < URING_MAX_OPS; slot++)
+		if (ring->ops[slot].op == 0)
+			break;
+	DB_ASSERT(slot < URING_MAX_OPS);
+
+	tail = *ring->sq_tail;
+	idx = tail & *ring->sq_mask;
+	sqe = &ring->sqes[idx];
+	memset(sqe, 0, sizeof(*sqe));
+	ring->sq_array[idx] = idx;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	ring->nops++;
+	ring->nqueued++;
+	*slotp = slot;
+	return (sqe);
+}
+
+static int
+__os_uring_enter(ring, to_submit, min_complete)
+	DB_OS_URING *ring;
+	u_int32_t to_submit, min_complete;
+{
+	int ret;
+
+	for (;;) {
+		ret = (int)syscall(__NR_io_uring_enter, ring->fd, to_submit,
+		    min_complete, IORING_ENTER_GETEVENTS, NULL, 0);
+		if (ret >= 0)
+			break;
+		if ((ret = __os_get_errno()) != EINTR)
+			return (ret);
+	}
+
+	ring->nqueued -= (u_int32_t)ret;
+	ring->ninflight += (u_int32_t)ret;
+	return (0);
+}
+
+/*
+ * __os_uring_reap --
+ *	Process completions.  A short write is finished synchronously; by
+ *	then the drained sync may already have run, so __os_uring_wait syncs
+ *	the file again.
+ */
+static void
+__os_uring_reap(dbenv, ring)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+{
+	struct io_uring_cqe *cqe;
+	struct __os_uring_op *op;
+	u_int32_t head, tail;
+	ssize_t nw;
+	size_t done;
+	int err;
+
+	head = *ring->cq_head;
+	tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	for (; head != tail; head++) {
+		cqe = &ring->cqes[head & *ring->cq_mask];
+		op = &ring->ops[cqe->user_data];
+		err = 0;
+
+		if (cqe->res < 0)
+			err = -cqe->res;
+		else if (op->op == URING_OP_WRITE &&
+		    (size_t)cqe->res < op->len) {
+			for (done = (size_t)cqe->res; done < op->len;
+			    done += (size_t)nw) {
+				nw = pwrite(op->fd, op->buf + done,
+				    op->len - done, op->off + (off_t)done);
+				if (nw < 0) {
+					if ((err = __os_get_errno()) != EINTR)
+						break;
+					err = 0;
+					nw = 0;
+				} else if (nw == 0) {
+					err = EIO;
+					break;
+				}
+			}
+			ring->resync_fd = op->fd;
+		}
+
+		if (op->op == URING_OP_WRITE)
+			ring->nwrites--;
+		else {
+			if (err != 0)
+				__db_err(dbenv, "fsync %s", strerror(err));
+			__os_fsync_account(op->fd);
+		}
+		if (err != 0 && ring->error == 0)
+			ring->error = err;
+
+		memset(op, 0, sizeof(*op));
+		ring->nops--;
+		ring->ninflight--;
+	}
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+#else /* !HAVE_OS_URING */
+
+int
+__os_uring_create(dbenv, ringp)
+	DB_ENV *dbenv;
+	DB_OS_URING **ringp;
+{
+	COMPQUIET(dbenv, NULL);
+	*ringp = NULL;
+	return (ENOSYS);
+}
+
+void
+__os_uring_destroy(dbenv, ring)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+{
+	COMPQUIET(dbenv, NULL);
+	COMPQUIET(ring, NULL);
+}
+
+int
+__os_uring_fh_ok(dbenv, fhp)
+	DB_ENV *dbenv;
+	DB_FH *fhp;
+{
+	COMPQUIET(dbenv, NULL);
+	COMPQUIET(fhp, NULL);
+	return (0);
+}
+
+int
+__os_uring_pwrite(dbenv, ring, fhp, addr, len, off)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+	DB_FH *fhp;
+	void *addr;
+	size_t len;
+	off_t off;
+{
+	COMPQUIET(dbenv, NULL);
+	COMPQUIET(ring, NULL);
+	COMPQUIET(fhp, NULL);
+	COMPQUIET(addr, NULL);
+	COMPQUIET(len, 0);
+	COMPQUIET(off, 0);
+	return (ENOSYS);
+}
+
+u_int32_t
+__os_uring_pending(ring)
+	DB_OS_URING *ring;
+{
+	COMPQUIET(ring, NULL);
+	return (0);
+}
+
+int
+__os_uring_submit_sync(dbenv, ring, fhp)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+	DB_FH *fhp;
+{
+	COMPQUIET(dbenv, NULL);
+	COMPQUIET(ring, NULL);
+	COMPQUIET(fhp, NULL);
+	return (ENOSYS);
+}
+
+int
+__os_uring_wait(dbenv, ring)
+	DB_ENV *dbenv;
+	DB_OS_URING *ring;
+{
+	COMPQUIET(dbenv, NULL);
+	COMPQUIET(ring, NULL);
+	return (0);
+}
+
+#endif /* HAVE_OS_URING */
@@ -17,6 +17,7 @@
 #include "dbinc_auto/fileops_auto.h"
 #include "dbinc_auto/qam_auto.h"
 #include "dbinc/txn.h"
+#include "dbinc/log.h"
 #include "dbinc_auto/txn_ext.h"
 #include "dbinc_auto/txn_auto.h"
 #include "dbinc_auto/db_auto.h"
@@ -38,11 +39,11 @@ __lc_cache_init(DB_ENV *dbenv, int reinit)
 {
 	int ret;
 
+	/* On reinit the caller already holds the lock. */
 	if (!reinit) {
 		Pthread_mutex_init(&dbenv->lc_cache.lk, NULL);
-	} 
-
-	Pthread_mutex_lock(&dbenv->lc_cache.lk);
+		Pthread_mutex_lock(&dbenv->lc_cache.lk);
+	}
 
 	LC_CACHE *lcc;
 
@@ -62,10 +63,17 @@ __lc_cache_init(DB_ENV *dbenv, int reinit)
 	}
 	lcc->nent = dbenv->attr.cache_lc_max;
 	lcc->memused = 0;
+	if (!reinit) {
+		lcc->hits = 0;
+		lcc->misses = 0;
+		lcc->evictions = 0;
+		lcc->trimmed = 0;
+	}
 
 	ret = 0;
 err:
-	Pthread_mutex_unlock(&dbenv->lc_cache.lk);
+	if (!reinit)
+		Pthread_mutex_unlock(&dbenv->lc_cache.lk);
 	return ret;
 }
 
@@ -121,6 +129,63 @@ free_ent(DB_ENV *dbenv, LC_CACHE_ENTRY * e)
 	}
 }
 
+/*
+ * Drop the record bodies of a cached transaction but keep its LSNs.  The
+ * transaction stays in the cache: apply reads the missing records by LSN
+ * rather than walking the transaction's prev_lsn chain back through the log.
+ */
+static void
+trim_ent(DB_ENV *dbenv, LC_CACHE_ENTRY * e)
+{
+	if (e->lc.memused == 0)
+		return;
+	for (int i = 0; i < e->lc.nlsns; i++) {
+		if (e->lc.array[i].rec.data) {
+			__os_free(dbenv, e->lc.array[i].rec.data);
+			e->lc.array[i].rec.data = NULL;
+			e->lc.array[i].rec.size = 0;
+		}
+	}
+	dbenv->lc_cache.memused -= e->lc.memused;
+	e->lc.memused = 0;
+	dbenv->lc_cache.trimmed++;
+	if (dbenv->attr.cache_lc_debug || dbenv->attr.cache_lc_trace_evictions)
+		logmsg(LOGMSG_USER, ">> trimmed record bodies for txnid %x\n",
+		    e->txnid);
+}
+
+/*
+ * Trim least recently used transactions other than keep until need more
+ * bytes fit under cache_lc_memlimit.  Returns 1 if they do.
+ */
+static int
+make_room(DB_ENV *dbenv, int need, LC_CACHE_ENTRY * keep)
+{
+	LC_CACHE_ENTRY *e;
+
+	if (dbenv->attr.cache_lc_memlimit == 0)
+		return 1;
+	LISTC_FOR_EACH(&dbenv->lc_cache.lru, e, lnk) {
+		if (dbenv->lc_cache.memused + need <=
+		    dbenv->attr.cache_lc_memlimit)
+			break;
+		if (e != keep)
+			trim_ent(dbenv, e);
+	}
+	return (dbenv->lc_cache.memused + need <=
+	    dbenv->attr.cache_lc_memlimit);
+}
+
+/* Should the next record of this transaction be cached with its body? */
+static int
+keep_body(DB_ENV *dbenv, LC_CACHE_ENTRY * e, int size)
+{
+	if (dbenv->attr.cache_lc_memlimit_tran &&
+	    e->lc.memused + size > dbenv->attr.cache_lc_memlimit_tran)
+		return 0;
+	return make_room(dbenv, size, e);
+}
+
 static int
 append_lsn_collection(DB_ENV *dbenv, LSN_COLLECTION * dest,
     LSN_COLLECTION * src)
@@ -154,9 +219,13 @@ err:
 	return ret;
 }
 
-/* add a log record to an existing collection */
+/*
+ * add a log record to an existing collection; without body, only its LSN
+ * is kept and apply reads the record from the log
+ */
 static int
-lsn_collection_add(DB_ENV *dbenv, LSN_COLLECTION * lc, DB_LSN lsn, DBT *dbt)
+lsn_collection_add(DB_ENV *dbenv, LSN_COLLECTION * lc, DB_LSN lsn, DBT *dbt,
+    int body)
 {
 	int ret;
 	int nalloc;
@@ -172,6 +241,33 @@ lsn_collection_add(DB_ENV *dbenv, LSN_COLLECTION * lc, DB_LSN lsn, DBT *dbt)
 			lc->array[i].rec.flags = DB_DBT_MALLOC;
 	}
 	lc->array[lc->nlsns].lsn = lsn;
+	if (!body) {
+		lc->array[lc->nlsns].rec.data = NULL;
+		lc->array[lc->nlsns].rec.size = 0;
+		lc->nlsns++;
+		return 0;
+	}
+	/*
+	 * Records off the wire are as the master logged them; keep the
+	 * cache in the form log cursors return, as apply expects.
+	 */
+	if (__log_rec_is_compressed(dbt->data, dbt->size)) {
+		u_int8_t *buf = NULL;
+		u_int32_t bufsize = 0, size;
+
+		if ((ret = __log_rec_decompress(dbenv, dbt->data, dbt->size,
+		    &buf, &bufsize, &size)) != 0) {
+			if (buf != NULL)
+				__os_free(dbenv, buf);
+			goto err;
+		}
+		lc->array[lc->nlsns].rec.data = buf;
+		lc->array[lc->nlsns].rec.size = size;
+		lc->nlsns++;
+		lc->memused += size;
+		dbenv->lc_cache.memused += size;
+		return 0;
+	}
 	lc->array[lc->nlsns].rec.size = dbt->size;
 	if ((ret = __os_malloc(dbenv, dbt->size, &lc->array[lc->nlsns].rec.data)) != 0)
 		goto err;
@@ -196,6 +292,13 @@ lc_dump_cache(DB_ENV *dbenv, int needlock)
 	LC_CACHE_ENTRY *e;
 
 	logmsg(LOGMSG_USER, "Total used: %d\n", dbenv->lc_cache.memused);
+	logmsg(LOGMSG_USER, "Hits: %" PRIu64 " misses: %" PRIu64
+	    " hit rate: %.1f%% evictions: %" PRIu64 " trimmed: %" PRIu64 "\n",
+	    dbenv->lc_cache.hits, dbenv->lc_cache.misses,
+	    dbenv->lc_cache.hits + dbenv->lc_cache.misses ?
+	    100.0 * dbenv->lc_cache.hits /
+	    (dbenv->lc_cache.hits + dbenv->lc_cache.misses) : 0.0,
+	    dbenv->lc_cache.evictions, dbenv->lc_cache.trimmed);
 	for (int ent = 0; ent < dbenv->lc_cache.nent; ent++) {
 		e = &dbenv->lc_cache.ent[ent];
 		if (e->txnid) {
@@ -295,6 +398,7 @@ __lc_cache_feed(DB_ENV *dbenv, DB_LSN lsn, DBT dbt)
 		} while (e);
 
 		__os_free(dbenv, dbenv->lc_cache.ent);
+		hash_free(dbenv->lc_cache.txnid_hash);
 		/* recreate */
 		__lc_cache_init(dbenv, 1);
 		e = NULL;
@@ -327,35 +431,13 @@ __lc_cache_feed(DB_ENV *dbenv, DB_LSN lsn, DBT dbt)
 			/* Don't append __txn_child - but we still need to add the child
 			 * transaction's log, which happens below. */
 			if (type != DB___txn_child) {
-				/* all is well, append to lsn collection */
-				if ((dbenv->attr.cache_lc_memlimit &&
-					dbenv->lc_cache.memused + dbt.size >
-					dbenv->attr.cache_lc_memlimit) ||
-				    (dbenv->attr.cache_lc_memlimit_tran &&
-					e->lc.memused + dbt.size >
-					dbenv->attr.cache_lc_memlimit_tran)) {
-					listc_rfl(&dbenv->lc_cache.lru, e);
-					free_ent(dbenv, e);
-					if (dbenv->attr.cache_lc_debug ||
-					    dbenv->attr.
-					    cache_lc_trace_evictions) {
-						logmsg(LOGMSG_USER, 
-                            "total lc cache %d (limit %d) tran %d  (limit %d) next %d\n",
-						    dbenv->lc_cache.memused,
-						    dbenv->attr.
-						    cache_lc_memlimit,
-						    e->lc.memused,
-						    dbenv->attr.
-						    cache_lc_memlimit_tran,
-						    dbt.size);
-					}
-					ret = 0;
-					goto err;
-				}
-
+				/*
+				 * all is well, append to lsn collection; past
+				 * the memory limits keep just the LSN
+				 */
 				ret =
 				    lsn_collection_add(dbenv, &e->lc, lsn,
-				    &dbt);
+				    &dbt, keep_body(dbenv, e, dbt.size));
 				if (dbenv->attr.cache_lc_debug)
 					logmsg(LOGMSG_USER, ">> txnid %x got lsn " PR_LSN
 					    ", appending to cache ret %d\n",
@@ -371,23 +453,6 @@ __lc_cache_feed(DB_ENV *dbenv, DB_LSN lsn, DBT dbt)
 		__rep_classify_type(type, &e->lc.had_serializable_records);
 	}
 	if (e == NULL) {
-		if ((dbenv->attr.cache_lc_memlimit &&
-			dbenv->lc_cache.memused + dbt.size >
-			dbenv->attr.cache_lc_memlimit) ||
-		    (dbenv->attr.cache_lc_memlimit_tran &&
-			dbt.size > dbenv->attr.cache_lc_memlimit_tran)) {
-			if (dbenv->attr.cache_lc_debug) {
-				logmsg(LOGMSG_USER, 
-                    "total lc cache %d (limit %d) tran 0 (limit %d) next %d\n",
-				    dbenv->lc_cache.memused,
-				    dbenv->attr.cache_lc_memlimit,
-				    dbenv->attr.cache_lc_memlimit_tran,
-				    dbt.size);
-			}
-			ret = 0;
-			goto err;
-		}
-
 		if (dbenv->attr.cache_lc_debug)
 			logmsg(LOGMSG_USER, ">> didn't find txnid %x\n", txnid);
 		/* We didn't find it.  If it's a first record for a transaction, add to cache */
@@ -406,6 +471,7 @@ __lc_cache_feed(DB_ENV *dbenv, DB_LSN lsn, DBT dbt)
 					    txnid);
 				e = listc_rtl(&dbenv->lc_cache.lru);
 				free_ent(dbenv, e);
+				dbenv->lc_cache.evictions++;
 				e = listc_rtl(&dbenv->lc_cache.avail);
 			}
 			if (e == NULL) {
@@ -420,7 +486,7 @@ __lc_cache_feed(DB_ENV *dbenv, DB_LSN lsn, DBT dbt)
 			if (type != DB___txn_child) {
 				ret =
 				    lsn_collection_add(dbenv, &e->lc, lsn,
-				    &dbt);
+				    &dbt, keep_body(dbenv, e, dbt.size));
 
 				if (ret) {
 					if (dbenv->attr.cache_lc_debug)
@@ -486,16 +552,11 @@ __lc_cache_feed(DB_ENV *dbenv, DB_LSN lsn, DBT dbt)
 					logmsg(LOGMSG_USER, "found child txn %x\n",
 					    ce->txnid);
 
-				if (dbenv->attr.cache_lc_memlimit &&
+				/* Too big together: keep the child's LSNs only. */
+				if (dbenv->attr.cache_lc_memlimit_tran &&
 				    e->lc.memused + ce->lc.memused >
-				    dbenv->attr.cache_lc_memlimit) {
-					listc_rfl(&dbenv->lc_cache.lru, e);
-					free_ent(dbenv, e);
-					listc_rfl(&dbenv->lc_cache.lru, ce);
-					free_ent(dbenv, ce);
-					ret = 0;
-					goto err;
-				}
+				    dbenv->attr.cache_lc_memlimit_tran)
+					trim_ent(dbenv, ce);
 
 				/* We don't want to reallocate any of those log records - just move over
 				 * the LSN_COLLECTION pointers. */
@@ -601,6 +662,7 @@ __lc_cache_get(DB_ENV *dbenv, DB_LSN *lsnp, LSN_COLLECTION * lcout,
 
 			ZERO_LSN(*lsnp);
 
+			dbenv->lc_cache.hits++;
 			Pthread_mutex_unlock(&dbenv->lc_cache.lk);
 			return 0;
 		} else {
@@ -616,6 +678,7 @@ __lc_cache_get(DB_ENV *dbenv, DB_LSN *lsnp, LSN_COLLECTION * lcout,
 		logmsg(LOGMSG_USER, "didn't find txnid %x, " PR_LSN "\n", txnid,
 		    PARM_LSNP(lsnp));
 
+	dbenv->lc_cache.misses++;
 	Pthread_mutex_unlock(&dbenv->lc_cache.lk);
 	return DB_NOTFOUND;
 }
@@ -1582,6 +1582,7 @@ __rep_flush(dbenv)
 
 	if ((ret = __log_cursor(dbenv, &logc)) != 0)
 		return (ret);
+	F_SET(logc, DB_LOG_RAW);
 
 	memset(&rec, 0, sizeof(rec));
 	memset(&lsn, 0, sizeof(lsn));
@@ -1393,8 +1393,9 @@ skip:				/*
 			goto errlock;
 		/* A confused replicant can send a request
 		 * for an invalid log record, and cause the master
-		 * to panic.  Don't let that happen. */
-		F_SET(logc, DB_LOG_NO_PANIC);
+		 * to panic.  Don't let that happen.  Send records as stored
+		 * so the client's log matches ours byte for byte. */
+		F_SET(logc, DB_LOG_NO_PANIC | DB_LOG_RAW);
 		memset(&data_dbt, 0, sizeof(data_dbt));
 		oldfilelsn = lsn = rp->lsn;
 
@@ -1644,7 +1645,7 @@ more:
 		fromline = __LINE__;
 		if ((ret = __log_cursor(dbenv, &logc)) != 0)
 			goto errlock;
-		F_SET(logc, DB_LOG_NO_PANIC);
+		F_SET(logc, DB_LOG_NO_PANIC | DB_LOG_RAW);
 		memset(&data_dbt, 0, sizeof(data_dbt));
 		ret = __log_c_get(logc, &rp->lsn, &data_dbt, DB_SET);
 		int resp_rc;
@@ -4061,6 +4062,425 @@ fuid_hash_free(void *obj, void *unused)
 	return 0;
 }
 
+/* Wait for the workers a processor handed queues to. */
+static void
+wait_for_workers(DB_ENV *dbenv, struct __recovery_processor *rp)
+{
+	Pthread_mutex_lock(&rp->lk);
+	int lastpr = 0, pollus =
+		dbenv->attr.recovery_processor_poll_interval_us;
+	if (pollus <= 0)
+		pollus = 1000;
+
+	while (rp->num_busy_workers) {
+		int rc;
+		struct timespec ts;
+
+		clock_gettime(CLOCK_REALTIME, &ts);
+		if (!lastpr)
+			lastpr = ts.tv_sec + 1;
+
+		/* This should stay small:  All workers could finish before the cond_timedwait. */
+		ts.tv_nsec += (1000 * pollus);
+		if (ts.tv_nsec > 1000000000) {
+			ts.tv_nsec %= 1000000000;
+			ts.tv_sec++;
+		}
+
+		rc = pthread_cond_timedwait(&rp->wait, &rp->lk, &ts);
+		if (rp->num_busy_workers && rc == ETIMEDOUT &&
+			ts.tv_sec > lastpr) {
+			logmsg(LOGMSG_WARN, "waiting for %d workers\n",
+				rp->num_busy_workers);
+			lastpr = ts.tv_sec;
+		}
+	}
+	Pthread_mutex_unlock(&rp->lk);
+}
+
+/*
+ * Apply transactions of at least this many records split by page rather
+ * than by file.  0 disables.
+ */
+int gbl_rep_page_apply_min = 0;
+
+/* Number of page partitions per file for page-split apply. */
+int gbl_rep_page_apply_parts = 8;
+
+int64_t gbl_rep_trans_by_page = 0, gbl_rep_page_phases = 0;
+
+/* Which queue owns a page partition in the current phase. */
+struct page_owner {
+	int fileid;
+	u_int32_t part;
+	int phase;
+	struct __recovery_queue *rq;
+};
+
+/* Run a phase's queues and wait for them to finish. */
+static void
+page_apply_phase(DB_ENV *dbenv, struct __recovery_processor *rp,
+	struct __recovery_queue **qs, int nq)
+{
+	int i;
+
+	if (nq == 0)
+		return;
+
+	gbl_rep_page_phases++;
+
+	Pthread_mutex_lock(&rp->lk);
+	rp->num_busy_workers += nq;
+	Pthread_mutex_unlock(&rp->lk);
+
+	if (nq == 1) {
+		worker_thd(NULL, qs[0], NULL, -1);
+		return;
+	}
+
+	for (i = 0; i < nq; i++)
+		thdpool_enqueue(dbenv->recovery_workers, worker_thd, qs[i],
+			0, NULL, 0);
+	wait_for_workers(dbenv, rp);
+}
+
+/*
+ * Intra-transaction parallel apply.  Records are bucketed by file and by
+ * page partition (page number modulo gbl_rep_page_apply_parts), using the
+ * pages each record touches according to the getallpgnos dispatch table.
+ * The transaction is applied as a series of phases; within a phase each
+ * queue owns a disjoint set of partitions, and queues run in parallel.
+ * Per-page order is kept because a partition only ever belongs to one
+ * queue in a phase, and phases run one after the other.  A record that
+ * spans partitions owned by different queues ends the phase; a record
+ * that touches no pages we can identify is applied alone, between phases.
+ */
+static int
+processor_apply_by_page(DB_ENV *dbenv, struct __recovery_processor *rp,
+	DB_LOGC *logc, DBT *data_dbt)
+{
+	struct __recovery_queue **qs = NULL, *rq;
+	struct __recovery_record *rr;
+	struct page_owner *po, key;
+	struct fuid_integer *fint;
+	hash_t *fuid_hash = NULL, *owner_hash = NULL;
+	u_int8_t fuid[DB_FILE_ID_LEN] = {0};
+	TXN_RECS t = { 0 };
+	DBT *dbt;
+	DB_LSN *lsnp;
+	u_int32_t rectype, nparts;
+	int i, j, ret = 0, nq = 0, nqalloc = 0, phase = 0;
+	int fileid, max_fileid = 0, split;
+
+	nparts = gbl_rep_page_apply_parts > 0 ? gbl_rep_page_apply_parts : 1;
+	/* Keyed on fileid and part. */
+	owner_hash = hash_init(offsetof(struct page_owner, phase));
+	gbl_rep_trans_by_page++;
+
+	for (i = 0; i < rp->lc.nlsns; i++) {
+		lsnp = &rp->lc.array[i].lsn;
+
+		if (rp->lc.array[i].rec.data == NULL) {
+			if ((ret = __log_c_get(logc, lsnp, data_dbt,
+				DB_SET)) != 0) {
+				__db_err(dbenv,
+					"failed to read the log at [%lu][%lu]",
+					(u_long)lsnp->file, (u_long)lsnp->offset);
+				goto err;
+			}
+			dbt = data_dbt;
+		} else
+			dbt = &rp->lc.array[i].rec;
+
+		LOGCOPY_32(&rectype, dbt->data);
+		fileid = -1;
+		if (ufid_for_recovery_record(dbenv, NULL, rectype, fuid, dbt)) {
+			if (!fuid_hash)
+				fuid_hash = hash_init(DB_FILE_ID_LEN);
+			if ((fint = hash_find(fuid_hash, fuid)) == NULL) {
+				fint = malloc(sizeof(*fint));
+				memcpy(fint->fuid, fuid, DB_FILE_ID_LEN);
+				fint->fileid = ++max_fileid;
+				hash_add(fuid_hash, fint);
+			}
+			fileid = fint->fileid;
+		}
+
+		t.npages = 0;
+		if (fileid != -1 && __db_dispatch(dbenv, dbenv->pgnos_dtab,
+			dbenv->pgnos_dtab_size, dbt, lsnp, DB_TXN_GETALLPGNOS,
+			&t) != 0)
+			t.npages = 0;
+
+		/* Find the queue owning this record's pages, if any. */
+		rq = NULL;
+		split = (t.npages == 0);
+		for (j = 0; j < t.npages && !split; j++) {
+			key.fileid = fileid;
+			key.part = t.array[j].pgdesc.pgno % nparts;
+			po = hash_find(owner_hash, &key);
+			if (po == NULL || po->phase != phase)
+				continue;
+			if (rq == NULL)
+				rq = po->rq;
+			else if (rq != po->rq)
+				split = 1;
+		}
+
+		if (split) {
+			page_apply_phase(dbenv, rp, qs, nq);
+			phase++;
+			nq = 0;
+			rq = NULL;
+		}
+
+		if (rq == NULL) {
+			if (nq == nqalloc) {
+				qs = realloc(qs, (nqalloc + 8) * sizeof(*qs));
+				for (j = nqalloc; j < nqalloc + 8; j++) {
+					qs[j] = malloc(sizeof(struct __recovery_queue));
+					qs[j]->processor = rp;
+					qs[j]->used = 0;
+					listc_init(&qs[j]->records,
+						offsetof(struct __recovery_record,
+						lnk));
+				}
+				nqalloc += 8;
+			}
+			rq = qs[nq++];
+			rq->fileid = fileid;
+		}
+
+		for (j = 0; j < t.npages; j++) {
+			key.fileid = fileid;
+			key.part = t.array[j].pgdesc.pgno % nparts;
+			if ((po = hash_find(owner_hash, &key)) == NULL) {
+				po = malloc(sizeof(*po));
+				po->fileid = key.fileid;
+				po->part = key.part;
+				hash_add(owner_hash, po);
+			}
+			po->phase = phase;
+			po->rq = rq;
+		}
+
+		rr = pool_getablk(rp->recpool);
+		if (rp->lc.array[i].rec.data)
+			rr->logdbt = rp->lc.array[i].rec;
+		else
+			rr->logdbt.data = NULL;
+		rr->lsn = *lsnp;
+		rr->fileid = fileid;
+		listc_abl(&rq->records, rr);
+
+		/* Records without pages are applied on their own. */
+		if (t.npages == 0) {
+			page_apply_phase(dbenv, rp, qs, nq);
+			phase++;
+			nq = 0;
+		}
+	}
+	page_apply_phase(dbenv, rp, qs, nq);
+
+err:
+	for (j = 0; j < nqalloc; j++)
+		free(qs[j]);
+	free(qs);
+	if (t.array)
+		__os_free(dbenv, t.array);
+	if (fuid_hash) {
+		hash_for(fuid_hash, fuid_hash_free, NULL);
+		hash_clear(fuid_hash);
+		hash_free(fuid_hash);
+	}
+	hash_for(owner_hash, fuid_hash_free, NULL);
+	hash_clear(owner_hash);
+	hash_free(owner_hash);
+	return ret;
+}
+
+/*
+ * Redo committed page records of startup recovery in batches of at least
+ * this many records, split by page across the recovery workers.  0
+ * disables.
+ */
+int gbl_recovery_parallel_redo = 0;
+
+int64_t gbl_recovery_redo_batches = 0, gbl_recovery_redo_records = 0;
+
+/*
+ * Records whose forward roll only redoes the pages it names.  Everything
+ * else (allocation, file and transaction records, queue and hash records,
+ * logical records) is rolled forward serially between batches.
+ */
+static int
+redo_rectype_parallel(u_int32_t rectype)
+{
+	if (rectype & DB_debug_FLAG)
+		return 0;
+	/* The ufid variants are numbered 1000 above the originals. */
+	if (rectype > 1000 && rectype < DB_user_BEGIN)
+		rectype -= 1000;
+
+	switch (rectype) {
+	case DB___db_addrem:
+	case DB___db_big:
+	case DB___db_ovref:
+	case DB___db_relink:
+	case DB___bam_split:
+	case DB___bam_rsplit:
+	case DB___bam_adj:
+	case DB___bam_cadjust:
+	case DB___bam_cdel:
+	case DB___bam_repl:
+	case DB___bam_prefix:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/*
+ * __rep_redo_batch_open --
+ *	Set up a processor to batch the forward pass of recovery.  txninfo
+ *	is the caller's transaction list; workers only ever read the
+ *	records, never the list.
+ *
+ * PUBLIC: int __rep_redo_batch_open __P((DB_ENV *, void *,
+ * PUBLIC:     struct __recovery_processor **));
+ */
+int
+__rep_redo_batch_open(dbenv, txninfo, rpp)
+	DB_ENV *dbenv;
+	void *txninfo;
+	struct __recovery_processor **rpp;
+{
+	struct __recovery_processor *rp;
+	int ret;
+
+	if ((ret = __os_calloc(dbenv, 1, sizeof(*rp), &rp)) != 0)
+		return ret;
+	Pthread_mutex_init(&rp->lk, NULL);
+	Pthread_cond_init(&rp->wait, NULL);
+	rp->recpool = pool_setalloc_init(sizeof(struct __recovery_record), 0,
+		malloc, free);
+	rp->dbenv = dbenv;
+	rp->lockid = DB_LOCK_INVALIDID;
+	rp->txninfo = txninfo;
+	*rpp = rp;
+	return 0;
+}
+
+/*
+ * __rep_redo_batch_flush --
+ *	Redo the records batched so far and wait for them to finish.
+ *
+ * PUBLIC: int __rep_redo_batch_flush __P((DB_ENV *,
+ * PUBLIC:     struct __recovery_processor *));
+ */
+int
+__rep_redo_batch_flush(dbenv, rp)
+	DB_ENV *dbenv;
+	struct __recovery_processor *rp;
+{
+	DB_LOGC *logc;
+	DBT data_dbt;
+	int ret, t_ret;
+
+	if (rp->lc.nlsns == 0)
+		return 0;
+
+	if ((ret = __log_cursor(dbenv, &logc)) != 0)
+		return ret;
+	bzero(&data_dbt, sizeof(DBT));
+	data_dbt.flags = DB_DBT_REALLOC;
+
+	gbl_recovery_redo_batches++;
+	gbl_recovery_redo_records += rp->lc.nlsns;
+	ret = processor_apply_by_page(dbenv, rp, logc, &data_dbt);
+
+	if ((t_ret = __log_c_close(logc)) != 0 && ret == 0)
+		ret = t_ret;
+	if (data_dbt.data)
+		__os_free(dbenv, data_dbt.data);
+	lc_free(dbenv, rp, &rp->lc);
+	return ret;
+}
+
+/*
+ * __rep_redo_batch_add --
+ *	Take a forward-pass record into the batch.  Returns 0 if the record
+ *	was batched, or needs no redo at all, and DB_NOTFOUND if the caller
+ *	must flush the batch and roll the record forward itself.
+ *
+ * PUBLIC: int __rep_redo_batch_add __P((DB_ENV *,
+ * PUBLIC:     struct __recovery_processor *, DBT *, DB_LSN *));
+ */
+int
+__rep_redo_batch_add(dbenv, rp, rec, lsnp)
+	DB_ENV *dbenv;
+	struct __recovery_processor *rp;
+	DBT *rec;
+	DB_LSN *lsnp;
+{
+	LSN_COLLECTION *lc;
+	u_int32_t rectype, txnid;
+	int nalloc, ret;
+
+	LOGCOPY_32(&rectype, rec->data);
+	if (!redo_rectype_parallel(rectype))
+		return DB_NOTFOUND;
+
+	/* The same test __db_dispatch makes for the forward pass. */
+	LOGCOPY_32(&txnid, (u_int8_t *)rec->data + sizeof(rectype));
+	if (txnid == 0 ||
+		__db_txnlist_find(dbenv, rp->txninfo, txnid) != TXN_COMMIT)
+		return 0;
+
+	lc = &rp->lc;
+	if (lc->nalloc < lc->nlsns + 1) {
+		nalloc = lc->nalloc == 0 ? 20 : lc->nalloc * 2;
+		if ((ret = __os_realloc(dbenv,
+			nalloc * sizeof(struct logrecord), &lc->array)) != 0)
+			return ret;
+		bzero(&lc->array[lc->nalloc],
+			(nalloc - lc->nalloc) * sizeof(struct logrecord));
+		lc->nalloc = nalloc;
+	}
+	lc->array[lc->nlsns].lsn = *lsnp;
+	if ((ret = __os_malloc(dbenv, rec->size,
+		&lc->array[lc->nlsns].rec.data)) != 0)
+		return ret;
+	memcpy(lc->array[lc->nlsns].rec.data, rec->data, rec->size);
+	lc->array[lc->nlsns].rec.size = rec->size;
+	lc->memused += rec->size;
+	lc->nlsns++;
+
+	if (lc->nlsns >= gbl_recovery_parallel_redo)
+		return __rep_redo_batch_flush(dbenv, rp);
+	return 0;
+}
+
+/*
+ * __rep_redo_batch_close --
+ *	Free a processor from __rep_redo_batch_open.  Records still batched
+ *	are discarded, so flush first.
+ *
+ * PUBLIC: void __rep_redo_batch_close __P((DB_ENV *,
+ * PUBLIC:     struct __recovery_processor *));
+ */
+void
+__rep_redo_batch_close(dbenv, rp)
+	DB_ENV *dbenv;
+	struct __recovery_processor *rp;
+{
+	lc_free(dbenv, rp, &rp->lc);
+	pool_free(rp->recpool);
+	Pthread_mutex_destroy(&rp->lk);
+	Pthread_cond_destroy(&rp->wait);
+	__os_free(dbenv, rp);
+}
+
 static void
 processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 {
@@ -4165,6 +4585,17 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 	if ((ret = __log_cursor(dbenv, &logc)) != 0)
 		goto err;
 
+	/* Large transactions can be split by page instead of by file. */
+	if (gbl_rep_page_apply_min > 0 &&
+		rp->lc.nlsns >= gbl_rep_page_apply_min &&
+		!(dbenv->flags & DB_ENV_ROWLOCKS)) {
+		data_dbt.flags = DB_DBT_REALLOC;
+		if ((ret = processor_apply_by_page(dbenv, rp, logc,
+			&data_dbt)) != 0)
+			goto err;
+		goto applied;
+	}
+
 	/* First, bucket records per queue. */
 	data_dbt.flags = DB_DBT_REALLOC;
 
@@ -4178,7 +4609,7 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 		lsnp = &rp->lc.array[i].lsn;
 
 		if (rp->lc.array[i].rec.data == NULL) {
-			assert(!rp->lc.filled_from_cache);
+			/* Also cached records trimmed to their LSN. */
 			if ((ret =
 				__log_c_get(logc, lsnp, &data_dbt,
 					DB_SET)) != 0) {
@@ -4305,38 +4736,8 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 	}
 
 	/* Wait for worker threads to finish */
-	if (!inline_worker) {
-		Pthread_mutex_lock(&rp->lk);
-		int lastpr = 0, pollus =
-			dbenv->attr.recovery_processor_poll_interval_us;
-		if (pollus <= 0)
-			pollus = 1000;
-
-		while (rp->num_busy_workers) {
-			int rc;
-			struct timespec ts;
-
-			clock_gettime(CLOCK_REALTIME, &ts);
-			if (!lastpr)
-				lastpr = ts.tv_sec + 1;
-
-			/* This should stay small:  All workers could finish before the cond_timedwait. */
-			ts.tv_nsec += (1000 * pollus);
-			if (ts.tv_nsec > 1000000000) {
-				ts.tv_nsec %= 1000000000;
-				ts.tv_sec++;
-			}
-
-			rc = pthread_cond_timedwait(&rp->wait, &rp->lk, &ts);
-			if (rp->num_busy_workers && rc == ETIMEDOUT &&
-				ts.tv_sec > lastpr) {
-				logmsg(LOGMSG_WARN, "waiting for %d workers\n",
-					rp->num_busy_workers);
-				lastpr = ts.tv_sec;
-			}
-		}
-		Pthread_mutex_unlock(&rp->lk);
-	}
+	if (!inline_worker)
+		wait_for_workers(dbenv, rp);
 
 
 #if 0
@@ -4366,6 +4767,7 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 	}
 #endif
 
+applied:
 	/* TODO: when we're convinced that lsn_chain is overkill, nix it */
 	if (dbenv->lsn_chain) {
 		bzero(&lock_prev_lsn_dbt, sizeof(DBT));
@@ -4890,7 +5292,7 @@ __rep_process_txn_int(dbenv, rctl, rec, ltrans, maxlsn, commit_gen, lockid, rp,
 		lsnp = &lsn;
 
 		if (!lc.array[i].rec.data) {
-			assert(!lc.filled_from_cache);
+			/* Also cached records trimmed to their LSN. */
 			if ((ret =
 				__log_c_get(logc, lsnp, &data_dbt,
 					DB_SET)) != 0) {
@@ -5211,6 +5613,115 @@ reset_recovery_processor(rp)
 
 extern int gbl_force_serial_on_writelock;
 
+/*
+ * Prefetch up to this many pages per replicated transaction before it is
+ * applied.  0 disables.
+ */
+int gbl_rep_prefetch_pages = 0;
+
+int64_t gbl_rep_prefetch_enqueued = 0;
+
+struct bdb_state_tag;
+extern int enque_udppfault_filepage(struct bdb_state_tag *, unsigned int,
+	unsigned int);
+
+#define	PREFETCH_RECENT	16
+
+/*
+ * Walk a transaction's records ahead of apply and queue asynchronous reads
+ * of the pages they reference on the prefault pool, so apply finds them in
+ * the cache instead of missing on each one in turn.  Pages are identified
+ * with the getallpgnos dispatch table; a few recently queued pages are
+ * remembered so runs of records against the same page queue it once.  We
+ * stop at gbl_rep_prefetch_pages, or as soon as the prefault queue is full.
+ */
+static void
+prefetch_lc_pages(DB_ENV *dbenv, LSN_COLLECTION *lc)
+{
+	struct {
+		int32_t fid;
+		db_pgno_t pgno;
+	} recent[PREFETCH_RECENT];
+	DB_LOGC *logc = NULL;
+	DBT data_dbt = { 0 }, *dbt;
+	TXN_RECS t = { 0 };
+	DB *dbp;
+	u_int8_t fuid[DB_FILE_ID_LEN];
+	u_int32_t rectype;
+	int32_t fid, ufid_fid;
+	int i, j, k, nrecent = 0, queued = 0;
+
+	data_dbt.flags = DB_DBT_REALLOC;
+
+	for (i = 0; i < lc->nlsns && queued < gbl_rep_prefetch_pages; i++) {
+		if (lc->array[i].rec.data == NULL) {
+			if (logc == NULL && __log_cursor(dbenv, &logc) != 0)
+				break;
+			if (__log_c_get(logc, &lc->array[i].lsn, &data_dbt,
+				DB_SET) != 0)
+				break;
+			dbt = &data_dbt;
+		} else
+			dbt = &lc->array[i].rec;
+
+		LOGCOPY_32(&rectype, dbt->data);
+		if (rectype >= DB_user_BEGIN)
+			continue;
+
+		t.npages = 0;
+		if (__db_dispatch(dbenv, dbenv->pgnos_dtab,
+			dbenv->pgnos_dtab_size, dbt, &lc->array[i].lsn,
+			DB_TXN_GETALLPGNOS, &t) != 0)
+			continue;
+
+		ufid_fid = -1;
+		for (j = 0; j < t.npages && queued < gbl_rep_prefetch_pages;
+			j++) {
+			if ((fid = t.array[j].fid) < 0) {
+				/* ufid records carry the file's uid instead. */
+				if (ufid_fid < 0) {
+					dbp = NULL;
+					if (!ufid_for_recovery_record(dbenv, NULL,
+						rectype, fuid, dbt) ||
+						__ufid_to_db(dbenv, NULL, &dbp,
+						fuid, NULL) != 0 || dbp == NULL ||
+						dbp->log_filename == NULL)
+						break;
+					ufid_fid = dbp->log_filename->id;
+				}
+				fid = ufid_fid;
+			}
+
+			for (k = 0; k < nrecent; k++)
+				if (recent[k].fid == fid &&
+					recent[k].pgno == t.array[j].pgdesc.pgno)
+					break;
+			if (k < nrecent)
+				continue;
+
+			if (enque_udppfault_filepage(dbenv->app_private, fid,
+				t.array[j].pgdesc.pgno) != 0)
+				goto done;
+
+			recent[queued % PREFETCH_RECENT].fid = fid;
+			recent[queued % PREFETCH_RECENT].pgno =
+				t.array[j].pgdesc.pgno;
+			if (nrecent < PREFETCH_RECENT)
+				nrecent++;
+			queued++;
+		}
+	}
+
+done:
+	gbl_rep_prefetch_enqueued += queued;
+	if (t.array)
+		__os_free(dbenv, t.array);
+	if (data_dbt.data)
+		free(data_dbt.data);
+	if (logc)
+		(void)__log_c_close(logc);
+}
+
 static inline int
 __rep_process_txn_concurrent_int(dbenv, rctl, rec, ltrans, ctrllsn, maxlsn,
 	commit_gen, prev_commit_lsn)
@@ -5601,6 +6112,9 @@ bad_resize:	;
 	qsort(rp->lc.array, rp->lc.nlsns, sizeof(struct logrecord),
 		__rep_lsn_cmp);
 
+	if (gbl_rep_prefetch_pages > 0)
+		prefetch_lc_pages(dbenv, &rp->lc);
+
 #ifndef NDEBUG
 	if (txn_rl_args) {
 		int cmp;
@@ -6112,6 +6626,9 @@ __rep_collect_txn_txnid(dbenv, lsnp, lc, had_serializable_records, rp, txnid)
 						bad_compare = 1;
 						break;
 					}
+					/* Trimmed: only the LSN was cached. */
+					if (lc->array[i].rec.data == NULL)
+						continue;
 					if (checklc.array[i].rec.size !=
 						lc->array[i].rec.size) {
 						__db_err(dbenv,
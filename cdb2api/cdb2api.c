@@ -121,9 +121,24 @@ static int cdb2cfg_override = CDB2CFG_OVERRIDE_DEFAULT;
 #define CDB2_REQUEST_FP_DEFAULT 0
 static int CDB2_REQUEST_FP = CDB2_REQUEST_FP_DEFAULT;
 
+#define CDB2_COLUMNAR_ROWS_DEFAULT 0
+static int CDB2_COLUMNAR_ROWS = CDB2_COLUMNAR_ROWS_DEFAULT;
+
+#define CDB2_MAX_STMT_IDS_DEFAULT 0
+static int CDB2_MAX_STMT_IDS = CDB2_MAX_STMT_IDS_DEFAULT;
+
+#define CDB2_READ_YOUR_WRITES_DEFAULT 0
+static int CDB2_READ_YOUR_WRITES = CDB2_READ_YOUR_WRITES_DEFAULT;
+
 #define CDB2_GET_HOSTNAME_FROM_SOCKPOOL_FD_DEFAULT 1
 static int CDB2_GET_HOSTNAME_FROM_SOCKPOOL_FD = CDB2_GET_HOSTNAME_FROM_SOCKPOOL_FD_DEFAULT;
 
+#define CDB2_LOCAL_SOCKET_POOL_DEFAULT 0
+static int CDB2_LOCAL_SOCKET_POOL = CDB2_LOCAL_SOCKET_POOL_DEFAULT;
+
+#define CDB2_LOAD_BALANCE_DEFAULT 0
+static int CDB2_LOAD_BALANCE = CDB2_LOAD_BALANCE_DEFAULT;
+
 #include <openssl/conf.h>
 #include <openssl/crypto.h>
 static ssl_mode cdb2_c_ssl_mode = SSL_ALLOW;
@@ -299,7 +314,12 @@ static void reset_the_configuration(void)
     cdb2_allow_pmux_route = CDB2_ALLOW_PMUX_ROUTE_DEFAULT;
     cdb2cfg_override = CDB2CFG_OVERRIDE_DEFAULT;
     CDB2_REQUEST_FP = CDB2_REQUEST_FP_DEFAULT;
+    CDB2_COLUMNAR_ROWS = CDB2_COLUMNAR_ROWS_DEFAULT;
+    CDB2_MAX_STMT_IDS = CDB2_MAX_STMT_IDS_DEFAULT;
+    CDB2_READ_YOUR_WRITES = CDB2_READ_YOUR_WRITES_DEFAULT;
     CDB2_GET_HOSTNAME_FROM_SOCKPOOL_FD = CDB2_GET_HOSTNAME_FROM_SOCKPOOL_FD_DEFAULT;
+    CDB2_LOCAL_SOCKET_POOL = CDB2_LOCAL_SOCKET_POOL_DEFAULT;
+    CDB2_LOAD_BALANCE = CDB2_LOAD_BALANCE_DEFAULT;
 
     cdb2_c_ssl_mode = SSL_ALLOW;
 
@@ -955,6 +975,40 @@ typedef struct cnonce {
 #define TYPE_LEN 64
 #define POLICY_LEN 24
 
+/* A statement queued by cdb2_pipeline_statement */
+#define CDB2_PIPELINE_MAX_SENT 64
+#define CDB2_PIPELINE_MAX_BYTES (64 * 1024)
+
+enum { PIPELINE_QUEUED, PIPELINE_SENT, PIPELINE_DONE };
+
+typedef struct cdb2_pipelined {
+    char *sql;
+    int n_bindvars;
+    CDB2SQLQUERY__Bindvalue **bindvars; /* copies, for running or retrying */
+    int state;
+    int rc;                             /* if PIPELINE_DONE */
+    size_t bytes;
+    char cnonce[CNONCE_STR_SZ];         /* if PIPELINE_SENT */
+    struct cdb2_pipelined *next;
+} cdb2_pipelined;
+
+static void pipeline_free(cdb2_pipelined *p);
+static void clear_stmt_ids(cdb2_hndl_tp *hndl);
+
+/* Text and server id of a statement; see stmt_id in sqlquery.proto */
+struct cdb2_stmt_id {
+    char *sql;
+    int id;
+};
+
+/* One column of a columnar row block; see col_block in sqlresponse.proto */
+struct cdb2_col_block {
+    int width;                /* 0 for variable width */
+    const uint8_t *isnull;
+    const uint8_t *off;       /* col_nrows + 1 uint32 offsets, or NULL */
+    const uint8_t *data;
+};
+
 struct cdb2_hndl {
     char dbname[DBNAME_LEN];
     char cluster[64];
@@ -1040,6 +1094,30 @@ struct cdb2_hndl {
     int comdb2db_timeout;
     int socket_timeout;
     int request_fp; /* 1 if requesting the fingerprint; 0 otherwise. */
+    int columnar_rows; /* 1 if requesting columnar row blocks. */
+    int load_balance;  /* 1 if choosing nodes by the load they report. */
+    /* Statement ids assigned by the server on the current connection */
+    int max_stmt_ids;
+    int n_stmt_ids;
+    struct cdb2_stmt_id *stmt_ids;
+    /* Commit lsn of our last write, sent with queries if read_your_writes */
+    int read_your_writes;
+    int read_lsn_file;
+    int read_lsn_offset;
+    /* Rows of lastresponse, if it is a columnar row block */
+    int col_nrows;
+    int col_row;
+    int col_ncols;
+    struct cdb2_col_block *col_block;
+    /* First row of the batch returned by cdb2_next_records */
+    int batch_row;
+    /* Statements queued by cdb2_pipeline_statement, oldest first */
+    cdb2_pipelined *pipeline;
+    cdb2_pipelined *pipeline_tail;
+    int pipeline_nsent;
+    size_t pipeline_bytes;
+    int pipeline_running;
+    int pipeline_sent_query; /* the running statement was already sent */
     cdb2_event events;
     // Protobuf allocator data used only for row data i.e. lastresponse
     void *protobuf_data;
@@ -1472,10 +1550,30 @@ static void read_comdb2db_cfg(cdb2_hndl_tp *hndl, SBUF2 *s, const char *comdb2db
                 tok = strtok_r(NULL, " :,", &last);
                 if (tok)
                     CDB2_REQUEST_FP = (strncasecmp(tok, "true", 4) == 0);
+            } else if (strcasecmp("columnar_rows", tok) == 0) {
+                tok = strtok_r(NULL, " :,", &last);
+                if (tok)
+                    CDB2_COLUMNAR_ROWS = (strncasecmp(tok, "true", 4) == 0);
+            } else if (strcasecmp("max_stmt_ids", tok) == 0) {
+                tok = strtok_r(NULL, " :,", &last);
+                if (tok)
+                    CDB2_MAX_STMT_IDS = atoi(tok);
+            } else if (strcasecmp("read_your_writes", tok) == 0) {
+                tok = strtok_r(NULL, " :,", &last);
+                if (tok)
+                    CDB2_READ_YOUR_WRITES = (strncasecmp(tok, "true", 4) == 0);
             } else if (strcasecmp("get_hostname_from_sockpool_fd", tok) == 0) {
                 tok = strtok_r(NULL, " :,", &last);
                 if (tok)
                     CDB2_GET_HOSTNAME_FROM_SOCKPOOL_FD = (strncasecmp(tok, "true", 4) == 0);
+            } else if (strcasecmp("local_socket_pool", tok) == 0) {
+                tok = strtok_r(NULL, " :,", &last);
+                if (tok)
+                    CDB2_LOCAL_SOCKET_POOL = atoi(tok);
+            } else if (strcasecmp("load_balance", tok) == 0) {
+                tok = strtok_r(NULL, " :,", &last);
+                if (tok)
+                    CDB2_LOAD_BALANCE = (strncasecmp(tok, "true", 4) == 0);
             }
             pthread_mutex_unlock(&cdb2_sockpool_mutex);
         }
@@ -1872,6 +1970,113 @@ static void sockpool_remove_fd(int fd)
     }
 }
 
+/* In-process socket pool
+
+   With local_socket_pool set, connections a handle is done with are kept in
+   this process, up to that many, and given to the next handle that wants
+   the same typestr, without a round trip to the sockpool daemon.  The pool
+   is split in shards by typestr, each with its own lock, so handles of
+   different databases do not wait on each other.  Connections that do not
+   fit, or expire, go to the daemon or are closed as before.  A forked child
+   does not reuse its parent's connections. */
+#define LOCAL_POOL_SHARDS 8
+
+struct local_pool_fd {
+    char typestr[48];
+    int dbnum;
+    int fd;
+    time_t expires;
+};
+
+static struct local_pool_shard {
+    pthread_mutex_t lk;
+    pid_t pid;
+    int count;
+    int alloc;
+    struct local_pool_fd *fds;
+} local_pool[LOCAL_POOL_SHARDS] = {
+    [0 ... LOCAL_POOL_SHARDS - 1] = {.lk = PTHREAD_MUTEX_INITIALIZER}};
+
+static struct local_pool_shard *local_pool_shard(const char *typestr)
+{
+    unsigned h = 5381;
+    while (*typestr)
+        h = h * 33 + (unsigned char)*typestr++;
+    return &local_pool[h % LOCAL_POOL_SHARDS];
+}
+
+/* The shard lock must be held */
+static void local_pool_check_pid(struct local_pool_shard *sh)
+{
+    pid_t pid = getpid();
+    if (sh->pid == pid)
+        return;
+    /* inherited from our parent: our copies are ours to close, but the
+     * connections are still the parent's */
+    for (int i = 0; i < sh->count; i++)
+        close(sh->fds[i].fd);
+    sh->count = 0;
+    sh->pid = pid;
+}
+
+static int local_pool_get(const char *typestr, int dbnum)
+{
+    struct local_pool_shard *sh = local_pool_shard(typestr);
+    time_t now = time(NULL);
+    int fd = -1;
+
+    pthread_mutex_lock(&sh->lk);
+    local_pool_check_pid(sh);
+    for (int i = sh->count - 1; i >= 0; i--) {
+        struct local_pool_fd *p = &sh->fds[i];
+        if (p->dbnum != dbnum || strcmp(p->typestr, typestr) != 0)
+            continue;
+        if (p->expires < now) {
+            close(p->fd);
+            sh->fds[i] = sh->fds[--sh->count];
+            continue;
+        }
+        fd = p->fd;
+        sh->fds[i] = sh->fds[--sh->count];
+        break;
+    }
+    pthread_mutex_unlock(&sh->lk);
+    return fd;
+}
+
+/* Returns 0 if the pool took the connection */
+static int local_pool_put(const char *typestr, int fd, int ttl, int dbnum)
+{
+    struct local_pool_shard *sh = local_pool_shard(typestr);
+    int max = (CDB2_LOCAL_SOCKET_POOL + LOCAL_POOL_SHARDS - 1) /
+              LOCAL_POOL_SHARDS;
+    int rc = -1;
+
+    if (strlen(typestr) >= sizeof(sh->fds[0].typestr))
+        return -1;
+
+    pthread_mutex_lock(&sh->lk);
+    local_pool_check_pid(sh);
+    if (sh->count == sh->alloc && sh->alloc < max) {
+        struct local_pool_fd *fds =
+            realloc(sh->fds, max * sizeof(struct local_pool_fd));
+        if (fds) {
+            sh->fds = fds;
+            sh->alloc = max;
+        }
+    }
+    if (sh->count < sh->alloc && sh->count < max) {
+        struct local_pool_fd *p = &sh->fds[sh->count++];
+        strcpy(p->typestr, typestr);
+        p->dbnum = dbnum;
+        p->fd = fd;
+        p->expires = time(NULL) + (ttl > 0 ? ttl : 10);
+        rc = 0;
+    }
+    pthread_mutex_unlock(&sh->lk);
+    return rc;
+}
+
 // cdb2_socket_pool_get_ll: low-level
 static int cdb2_socket_pool_get_ll(const char *typestr, int dbnum, int *port)
 {
@@ -1880,6 +2085,10 @@ static int cdb2_socket_pool_get_ll(const char *typestr, int dbnum, int *port)
     int sp_generation = -1;
     int fd = -1;
 
+    if (CDB2_LOCAL_SOCKET_POOL > 0 && sockpool_enabled != -1 &&
+        (fd = local_pool_get(typestr, dbnum)) != -1)
+        return fd;
+
     pthread_mutex_lock(&cdb2_sockpool_mutex);
     if (sockpool_enabled == 0) {
         time_t current_time = time(NULL);
@@ -2000,6 +2209,10 @@ void cdb2_socket_pool_donate_ext(const char *typestr, int fd, int ttl,
     int sockpool_fd = -1;
     int sp_generation = -1;
 
+    if (CDB2_LOCAL_SOCKET_POOL > 0 && sockpool_enabled != -1 &&
+        local_pool_put(typestr, fd, ttl, dbnum) == 0)
+        return;
+
     pthread_mutex_lock(&cdb2_sockpool_mutex);
     enabled = sockpool_enabled;
     if (enabled == 1) {
@@ -2351,6 +2564,7 @@ static int newsql_connect(cdb2_hndl_tp *hndl, int node_indx)
     hndl->sb = sb;
     hndl->num_set_commands_sent = 0;
     hndl->sent_client_info = 0;
+    clear_stmt_ids(hndl);
     hndl->connected_host = node_indx;
     hndl->hosts_connected[hndl->connected_host] = 1;
     debugprint("connected_host=%s\n", hndl->hosts[hndl->connected_host]);
@@ -2363,6 +2577,39 @@ after_callback:
     return rc;
 }
 
+static void clear_stmt_ids(cdb2_hndl_tp *hndl)
+{
+    for (int i = 0; i < hndl->n_stmt_ids; i++)
+        free(hndl->stmt_ids[i].sql);
+    free(hndl->stmt_ids);
+    hndl->stmt_ids = NULL;
+    hndl->n_stmt_ids = 0;
+}
+
+static int find_stmt_id(cdb2_hndl_tp *hndl, const char *sql)
+{
+    for (int i = 0; i < hndl->n_stmt_ids; i++) {
+        if (strcmp(hndl->stmt_ids[i].sql, sql) == 0)
+            return hndl->stmt_ids[i].id;
+    }
+    return 0;
+}
+
+static void add_stmt_id(cdb2_hndl_tp *hndl, const char *sql, int id)
+{
+    struct cdb2_stmt_id *ids;
+    sql = cdb2_skipws(sql);
+    if (hndl->n_stmt_ids >= hndl->max_stmt_ids || find_stmt_id(hndl, sql))
+        return;
+    ids = realloc(hndl->stmt_ids, (hndl->n_stmt_ids + 1) * sizeof(*ids));
+    if (ids == NULL)
+        return;
+    hndl->stmt_ids = ids;
+    if ((ids[hndl->n_stmt_ids].sql = strdup(sql)) == NULL)
+        return;
+    ids[hndl->n_stmt_ids++].id = id;
+}
+
 static void newsql_disconnect(cdb2_hndl_tp *hndl, SBUF2 *sb, int line)
 {
     if (sb == NULL)
@@ -2373,7 +2620,7 @@ static void newsql_disconnect(cdb2_hndl_tp *hndl, SBUF2 *sb, int line)
     int fd = sbuf2fileno(sb);
 
     int timeoutms = 10 * 1000;
-    if (hndl->is_admin ||
+    if (hndl->is_admin || hndl->pipeline_nsent ||
         (hndl->firstresponse &&
          (!hndl->lastresponse ||
           (hndl->lastresponse->response_type != RESPONSE_TYPE__LAST_ROW))) ||
@@ -2386,6 +2633,18 @@ static void newsql_disconnect(cdb2_hndl_tp *hndl, SBUF2 *sb, int line)
     }
     hndl->use_hint = 0;
     hndl->sb = NULL;
+
+    /* Pipelined statements on this connection are lost; run them again */
+    for (cdb2_pipelined *p = hndl->pipeline; p; p = p->next) {
+        if (p->state == PIPELINE_SENT)
+            p->state = PIPELINE_QUEUED;
+    }
+    hndl->pipeline_nsent = 0;
+    hndl->pipeline_bytes = 0;
+    hndl->pipeline_sent_query = 0;
+
+    /* Statement ids do not outlive the connection */
+    clear_stmt_ids(hndl);
     return;
 }
 
@@ -2544,6 +2803,81 @@ static int getRandomExclude(int max, int exclude)
     return val;
 }
 
+/* Load that nodes sent with their last rows, shared by all handles in the
+ * process.  With load_balance, a handle picks two nodes at random and starts
+ * with the one that reported less load; nodes we have not heard from lately
+ * count as idle, so every node keeps getting tried. */
+#define CDB2_HOST_LOAD_SLOTS 64
+#define CDB2_HOST_LOAD_TTL 10
+struct cdb2_host_load {
+    char dbname[DBNAME_LEN];
+    char host[CDB2HOSTNAME_LEN];
+    int score;
+    time_t when;
+};
+static struct cdb2_host_load cdb2_host_loads[CDB2_HOST_LOAD_SLOTS];
+static pthread_mutex_t cdb2_host_load_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void cdb2_note_host_load(cdb2_hndl_tp *hndl, const char *host,
+                                const CDB2SQLRESPONSE__Loadinfo *load)
+{
+    struct cdb2_host_load *slot = NULL, *l;
+    /* a ms of queueing, 10% of cpu and a MB of lag weigh about the same */
+    int score = load->queue_ms + load->cpu_pct / 10 + load->lag_kb / 1024;
+
+    pthread_mutex_lock(&cdb2_host_load_lock);
+    for (int i = 0; i < CDB2_HOST_LOAD_SLOTS; i++) {
+        l = &cdb2_host_loads[i];
+        if (strcmp(l->dbname, hndl->dbname) == 0 &&
+            strcmp(l->host, host) == 0) {
+            slot = l;
+            break;
+        }
+        if (slot == NULL || l->when < slot->when)
+            slot = l;
+    }
+    strncpy(slot->dbname, hndl->dbname, sizeof(slot->dbname) - 1);
+    strncpy(slot->host, host, sizeof(slot->host) - 1);
+    slot->score = score;
+    slot->when = time(NULL);
+    pthread_mutex_unlock(&cdb2_host_load_lock);
+}
+
+static int cdb2_host_load_score(cdb2_hndl_tp *hndl, const char *host)
+{
+    time_t now = time(NULL);
+    int score = 0;
+
+    pthread_mutex_lock(&cdb2_host_load_lock);
+    for (int i = 0; i < CDB2_HOST_LOAD_SLOTS; i++) {
+        struct cdb2_host_load *l = &cdb2_host_loads[i];
+        if (l->when + CDB2_HOST_LOAD_TTL >= now &&
+            strcmp(l->dbname, hndl->dbname) == 0 &&
+            strcmp(l->host, host) == 0) {
+            score = l->score;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&cdb2_host_load_lock);
+    return score;
+}
+
+/* Pick the first of hosts [0, max) to try, avoiding the master */
+static int cdb2_pick_host(cdb2_hndl_tp *hndl, int max)
+{
+    int first = getRandomExclude(max, hndl->master);
+    int second;
+
+    if (!hndl->load_balance || max < 3)
+        return first;
+    second = getRandomExclude(max, hndl->master);
+    if (second != first &&
+        cdb2_host_load_score(hndl, hndl->hosts[second]) <
+            cdb2_host_load_score(hndl, hndl->hosts[first]))
+        return second;
+    return first;
+}
+
 static int cdb2_connect_sqlhost(cdb2_hndl_tp *hndl)
 {
     if (hndl->sb) {
@@ -2560,11 +2894,10 @@ retry_connect:
     if ((hndl->node_seq == 0) &&
         ((hndl->flags & CDB2_RANDOM) || ((hndl->flags & CDB2_RANDOMROOM) &&
                                          (hndl->num_hosts_sameroom == 0)))) {
-        hndl->node_seq = getRandomExclude(hndl->num_hosts, hndl->master);
+        hndl->node_seq = cdb2_pick_host(hndl, hndl->num_hosts);
     } else if ((hndl->flags & CDB2_RANDOMROOM) && (hndl->node_seq == 0) &&
                (hndl->num_hosts_sameroom > 0)) {
-        hndl->node_seq =
-            getRandomExclude(hndl->num_hosts_sameroom, hndl->master);
+        hndl->node_seq = cdb2_pick_host(hndl, hndl->num_hosts_sameroom);
         /* First try on same room. */
         if (0 == cdb2_try_connect_range(hndl, hndl->node_seq,
                                         hndl->num_hosts_sameroom))
@@ -2770,6 +3103,7 @@ static void clear_responses(cdb2_hndl_tp *hndl)
         free((void *)hndl->last_buf);
         hndl->last_buf = NULL;
         hndl->lastresponse = NULL;
+        hndl->col_nrows = 0;
     }
 
     if (hndl->firstresponse) {
@@ -2889,6 +3223,7 @@ static int cdb2_send_query(cdb2_hndl_tp *hndl, cdb2_hndl_tp *event_hndl,
     CDB2QUERY query = CDB2__QUERY__INIT;
     CDB2SQLQUERY sqlquery = CDB2__SQLQUERY__INIT;
     CDB2SQLQUERY__Snapshotinfo snapshotinfo;
+    CDB2SQLQUERY__Snapshotinfo read_lsn;
 
     // This should be sent once right after we connect, not with every query
     CDB2SQLQUERY__Cinfo cinfo = CDB2__SQLQUERY__CINFO__INIT;
@@ -2907,6 +3242,19 @@ static int cdb2_send_query(cdb2_hndl_tp *hndl, cdb2_hndl_tp *event_hndl,
 
     sqlquery.dbname = (char *)dbname;
     sqlquery.sql_query = (char *)cdb2_skipws(sql);
+    if (hndl && sb == hndl->sb && hndl->max_stmt_ids > 0) {
+        /* Send statements with bound values by id, once the server has
+           assigned one on this connection */
+        int id = find_stmt_id(hndl, sqlquery.sql_query);
+        if (id) {
+            sqlquery.has_stmt_id = 1;
+            sqlquery.stmt_id = id;
+            sqlquery.sql_query = "";
+        } else if (n_bindvars > 0 && hndl->n_stmt_ids < hndl->max_stmt_ids) {
+            sqlquery.has_prepare = 1;
+            sqlquery.prepare = 1;
+        }
+    }
 #if _LINUX_SOURCE
     sqlquery.little_endian = 1;
 #else
@@ -2937,6 +3285,12 @@ static int cdb2_send_query(cdb2_hndl_tp *hndl, cdb2_hndl_tp *event_hndl,
         /* Request server to send back row data flat, instead of storing it in
            a nested data structure. This helps reduce server's memory footprint. */
         features[n_features++] = CDB2_CLIENT_FEATURES__FLAT_COL_VALS;
+        /* Request batches of rows packed column by column. */
+        if (hndl->columnar_rows)
+            features[n_features++] = CDB2_CLIENT_FEATURES__COLUMNAR_ROWS;
+        /* Ask for the node's load with the last row. */
+        if (hndl->load_balance)
+            features[n_features++] = CDB2_CLIENT_FEATURES__LOAD_INFO;
 
         features[n_features++] = CDB2_CLIENT_FEATURES__ALLOW_MASTER_DBINFO;
         if ((hndl->flags & CDB2_DIRECT_CPU) ||
@@ -2974,6 +3328,13 @@ static int cdb2_send_query(cdb2_hndl_tp *hndl, cdb2_hndl_tp *event_hndl,
             snapshotinfo.offset = hndl->snapshot_offset;
             sqlquery.snapshot_info = &snapshotinfo;
         }
+
+        if (hndl->read_your_writes && hndl->read_lsn_file) {
+            cdb2__sqlquery__snapshotinfo__init(&read_lsn);
+            read_lsn.file = hndl->read_lsn_file;
+            read_lsn.offset = hndl->read_lsn_offset;
+            sqlquery.read_lsn = &read_lsn;
+        }
     } else if (retries_done) {
         features[n_features++] = CDB2_CLIENT_FEATURES__ALLOW_MASTER_DBINFO;
         features[n_features++] = CDB2_CLIENT_FEATURES__ALLOW_MASTER_EXEC;
@@ -3108,6 +3469,60 @@ static int retry_queries_and_skip(cdb2_hndl_tp *hndl, int num_retry,
         return (rcode);                                                        \
     } while (0)
 
+/* Index the columns of the columnar row block in lastresponse */
+static int cdb2_col_block_init(cdb2_hndl_tp *hndl)
+{
+    CDB2SQLRESPONSE *resp = hndl->lastresponse;
+    int nrows = resp->col_rows;
+    int ncols = hndl->firstresponse ? hndl->firstresponse->n_value : 0;
+    const uint8_t *p = resp->col_block.data;
+    const uint8_t *end = p + resp->col_block.len;
+
+    hndl->col_nrows = 0;
+    if (nrows <= 0 || ncols <= 0)
+        goto bad;
+    if (ncols > hndl->col_ncols) {
+        struct cdb2_col_block *cols =
+            realloc(hndl->col_block, sizeof(struct cdb2_col_block) * ncols);
+        if (cols == NULL)
+            goto bad;
+        hndl->col_block = cols;
+        hndl->col_ncols = ncols;
+    }
+    for (int i = 0; i < ncols; i++) {
+        struct cdb2_col_block *c = &hndl->col_block[i];
+        if ((size_t)(end - p) < 1 + (size_t)nrows)
+            goto bad;
+        c->width = *p++;
+        c->isnull = p;
+        p += nrows;
+        size_t len;
+        if (c->width) {
+            c->off = NULL;
+            len = (size_t)c->width * nrows;
+        } else {
+            uint32_t last;
+            if ((size_t)(end - p) < sizeof(uint32_t) * (nrows + 1))
+                goto bad;
+            c->off = p;
+            p += sizeof(uint32_t) * (nrows + 1);
+            memcpy(&last, p - sizeof(uint32_t), sizeof(uint32_t));
+            len = last;
+        }
+        if ((size_t)(end - p) < len)
+            goto bad;
+        c->data = p;
+        p += len;
+    }
+    hndl->col_nrows = nrows;
+    hndl->col_row = 0;
+    return 0;
+
+bad:
+    sprintf(hndl->errstr, "%s: Malformed columnar rows from server", __func__);
+    return -1;
+}
+
 static int cdb2_next_record_int(cdb2_hndl_tp *hndl, int shouldretry)
 {
     int len;
@@ -3129,6 +3544,13 @@ retry_next_record:
             PRINT_AND_RETURN_OK(CDB2_OK_DONE);
         }
 
+        /* Serve the next row of a columnar block */
+        if (hndl->col_row + 1 < hndl->col_nrows) {
+            hndl->col_row++;
+            hndl->rows_read++;
+            PRINT_AND_RETURN_OK(CDB2_OK);
+        }
+
         if (hndl->lastresponse->response_type == RESPONSE_TYPE__COLUMN_VALUES &&
                 hndl->lastresponse->error_code != 0) {
             int rc = cdb2_convert_error_code(hndl->lastresponse->error_code);
@@ -3187,17 +3609,38 @@ retry_next_record:
         hndl->protobuf_offset = 0;
     }
 
+    hndl->col_nrows = 0;
     hndl->lastresponse =
         cdb2__sqlresponse__unpack(&hndl->allocator, len, hndl->last_buf);
     debugprint("hndl->lastresponse->response_type=%d\n",
                hndl->lastresponse->response_type);
 
+    if (hndl->lastresponse->has_col_rows &&
+        cdb2_col_block_init(hndl) != 0) {
+        newsql_disconnect(hndl, hndl->sb, __LINE__);
+        PRINT_AND_RETURN_OK(-1);
+    }
+
     if (hndl->lastresponse->snapshot_info &&
         hndl->lastresponse->snapshot_info->file) {
         hndl->snapshot_file = hndl->lastresponse->snapshot_info->file;
         hndl->snapshot_offset = hndl->lastresponse->snapshot_info->offset;
     }
 
+    /* Later reads wait for any node to have applied this commit */
+    CDB2SQLRESPONSE__Snapshotinfo *commit_lsn = hndl->lastresponse->commit_lsn;
+    if (commit_lsn && commit_lsn->file &&
+        (commit_lsn->file > hndl->read_lsn_file ||
+         (commit_lsn->file == hndl->read_lsn_file &&
+          (unsigned)commit_lsn->offset > (unsigned)hndl->read_lsn_offset))) {
+        hndl->read_lsn_file = commit_lsn->file;
+        hndl->read_lsn_offset = commit_lsn->offset;
+    }
+
+    if (hndl->lastresponse->load && hndl->connected_host >= 0)
+        cdb2_note_host_load(hndl, hndl->hosts[hndl->connected_host],
+                            hndl->lastresponse->load);
+
     if (hndl->lastresponse->response_type == RESPONSE_TYPE__COLUMN_VALUES) {
         // "Good" rcodes are not retryable
         if (is_retryable(hndl->lastresponse->error_code) &&
@@ -3436,6 +3879,14 @@ int cdb2_close(cdb2_hndl_tp *hndl)
     if (hndl->protobuf_data)
         free(hndl->protobuf_data);
 
+    free(hndl->col_block);
+
+    while (hndl->pipeline) {
+        cdb2_pipelined *p = hndl->pipeline;
+        hndl->pipeline = p->next;
+        pipeline_free(p);
+    }
+
     if (hndl->num_set_commands) {
         while (hndl->num_set_commands) {
             hndl->num_set_commands--;
@@ -4209,7 +4660,9 @@ static int cdb2_run_statement_typed_int(cdb2_hndl_tp *hndl, const char *sql,
 
     if (!hndl->in_trans) { /* only one cnonce for a transaction. */
         clear_snapshot_info(hndl, __LINE__);
-        if ((rc = next_cnonce(hndl)) != 0)
+        if (hndl->pipeline_sent_query)
+            ; /* keep the cnonce it was sent with */
+        else if ((rc = next_cnonce(hndl)) != 0)
             PRINT_AND_RETURN(rc);
     }
     hndl->retry_all = 1;
@@ -4301,7 +4754,11 @@ retry_queries:
     hndl->ntypes = ntypes;
     hndl->types = types;
 
-    if (!hndl->in_trans || is_begin) {
+    if (hndl->pipeline_sent_query) {
+        /* cdb2_pipeline_statement sent it on this connection already */
+        hndl->pipeline_sent_query = 0;
+        rc = 0;
+    } else if (!hndl->in_trans || is_begin) {
         hndl->query_no = 0;
         rc = cdb2_send_query(
             hndl, hndl, hndl->sb, hndl->dbname, (char *)sql,
@@ -4571,6 +5028,8 @@ read_record:
 
     // we have (hndl->first_buf != NULL)
     hndl->firstresponse = cdb2__sqlresponse__unpack(NULL, len, hndl->first_buf);
+    if (hndl->firstresponse && hndl->firstresponse->has_stmt_id)
+        add_stmt_id(hndl, sql, hndl->firstresponse->stmt_id);
     if (err_val) {
         /* we've read the 1st response of commit/rollback.
            that is all we need so simply return here.
@@ -4777,6 +5236,12 @@ int cdb2_run_statement_typed(cdb2_hndl_tp *hndl, const char *sql, int ntypes,
     if (overwrite_rc)
         goto after_callback;
 
+    if (hndl->pipeline_nsent && !hndl->pipeline_running) {
+        sprintf(hndl->errstr, "%s: Pipelined statements are pending", __func__);
+        rc = CDB2ERR_BADSTATE;
+        goto after_callback;
+    }
+
     if (hndl->temp_trans && hndl->in_trans) {
         cdb2_run_statement_typed_int(hndl, "rollback", 0, NULL, __LINE__);
     }
@@ -4840,6 +5305,172 @@ after_callback:
     return rc;
 }
 
+static void pipeline_free(cdb2_pipelined *p)
+{
+    for (int i = 0; i < p->n_bindvars; i++) {
+        free(p->bindvars[i]->varname);
+        if (p->bindvars[i]->value.len)
+            free(p->bindvars[i]->value.data);
+        free(p->bindvars[i]);
+    }
+    free(p->bindvars);
+    free(p->sql);
+    free(p);
+}
+
+/* Copy the current bindings of hndl into p */
+static int pipeline_copy_bindvars(cdb2_hndl_tp *hndl, cdb2_pipelined *p)
+{
+    if (hndl->n_bindvars == 0)
+        return 0;
+    p->bindvars = calloc(hndl->n_bindvars, sizeof(CDB2SQLQUERY__Bindvalue *));
+    if (p->bindvars == NULL)
+        return -1;
+    for (int i = 0; i < hndl->n_bindvars; i++) {
+        CDB2SQLQUERY__Bindvalue *src = hndl->bindvars[i];
+        CDB2SQLQUERY__Bindvalue *dst = malloc(sizeof(*dst));
+        if (dst == NULL)
+            return -1;
+        *dst = *src;
+        dst->varname = NULL;
+        dst->value.data = NULL;
+        p->bindvars[p->n_bindvars++] = dst;
+        if (src->varname && (dst->varname = strdup(src->varname)) == NULL)
+            return -1;
+        if (src->value.len) {
+            if ((dst->value.data = malloc(src->value.len)) == NULL)
+                return -1;
+            memcpy(dst->value.data, src->value.data, src->value.len);
+        } else {
+            dst->value.data = src->value.data; /* NULL or "" */
+        }
+        p->bytes += src->value.len;
+    }
+    return 0;
+}
+
+static int pipeline_can_send(cdb2_hndl_tp *hndl, cdb2_pipelined *p)
+{
+    const char *sql = p->sql;
+    if (hndl->in_trans || hndl->is_hasql || hndl->temp_trans ||
+        hndl->use_hint || hndl->num_set_commands_sent != hndl->num_set_commands)
+        return 0;
+    if (strncasecmp(sql, "set", 3) == 0 || strncasecmp(sql, "begin", 5) == 0 ||
+        strncasecmp(sql, "commit", 6) == 0 ||
+        strncasecmp(sql, "rollback", 8) == 0)
+        return 0;
+    if (hndl->pipeline_nsent >= CDB2_PIPELINE_MAX_SENT ||
+        hndl->pipeline_bytes + p->bytes > CDB2_PIPELINE_MAX_BYTES)
+        return 0;
+    /* Statements have to reach the server in order */
+    for (cdb2_pipelined *q = hndl->pipeline; q != p; q = q->next) {
+        if (q->state == PIPELINE_QUEUED)
+            return 0;
+    }
+    return 1;
+}
+
+int cdb2_pipeline_statement(cdb2_hndl_tp *hndl, const char *sql)
+{
+    cdb2_pipelined *p;
+    int rc = 0;
+    for (int i = 0; i < hndl->n_bindvars; i++) {
+        if (hndl->bindvars[i]->bind_array) {
+            sprintf(hndl->errstr, "%s: Array bindings can not be pipelined",
+                    __func__);
+            return CDB2ERR_NOTSUPPORTED;
+        }
+    }
+    if ((p = calloc(1, sizeof(cdb2_pipelined))) == NULL)
+        return CDB2ERR_MALLOC;
+    sql = cdb2_skipws(sql);
+    p->sql = strdup(sql);
+    p->state = PIPELINE_QUEUED;
+    p->bytes = strlen(sql);
+    if (p->sql == NULL || pipeline_copy_bindvars(hndl, p) != 0) {
+        pipeline_free(p);
+        sprintf(hndl->errstr, "%s: Out of memory", __func__);
+        return CDB2ERR_MALLOC;
+    }
+
+    if (hndl->pipeline_tail)
+        hndl->pipeline_tail->next = p;
+    else
+        hndl->pipeline = p;
+    hndl->pipeline_tail = p;
+
+    if (!pipeline_can_send(hndl, p)) {
+        /* Runs in cdb2_pipeline_next */
+    } else if (!hndl->sb || !hndl->firstresponse) {
+        /* A connection that has not served a statement yet may still have
+           to be redirected or upgraded to SSL: run the first one now */
+        if (hndl->pipeline == p) {
+            hndl->pipeline_running = 1;
+            p->rc = cdb2_run_statement_typed(hndl, sql, 0, NULL);
+            hndl->pipeline_running = 0;
+            p->state = PIPELINE_DONE;
+        }
+    } else if ((rc = next_cnonce(hndl)) == 0 &&
+               (rc = cdb2_send_query(
+                    hndl, hndl, hndl->sb, hndl->dbname, p->sql,
+                    hndl->num_set_commands, hndl->num_set_commands_sent,
+                    hndl->commands, p->n_bindvars, p->bindvars, 0, NULL, 0, 0,
+                    0, 0, __LINE__)) == 0) {
+        p->state = PIPELINE_SENT;
+        memcpy(p->cnonce, hndl->cnonce.str, sizeof(p->cnonce));
+        hndl->pipeline_nsent++;
+        hndl->pipeline_bytes += p->bytes;
+    } else {
+        /* Run it in cdb2_pipeline_next, which retries as usual */
+        newsql_disconnect(hndl, hndl->sb, __LINE__);
+        rc = 0;
+    }
+
+    if (log_calls)
+        fprintf(stderr, "%p> cdb2_pipeline_statement(%p, \"%s\") = %d\n",
+                (void *)pthread_self(), hndl, sql, rc);
+    return rc;
+}
+
+int cdb2_pipeline_next(cdb2_hndl_tp *hndl)
+{
+    cdb2_pipelined *p = hndl->pipeline;
+    int rc;
+    if (p == NULL) {
+        sprintf(hndl->errstr, "%s: No pipelined statement", __func__);
+        return CDB2ERR_BADSTATE;
+    }
+    hndl->pipeline = p->next;
+    if (hndl->pipeline == NULL)
+        hndl->pipeline_tail = NULL;
+
+    if (p->state == PIPELINE_DONE) {
+        rc = p->rc;
+    } else {
+        int n_bindvars = hndl->n_bindvars;
+        CDB2SQLQUERY__Bindvalue **bindvars = hndl->bindvars;
+        if (p->state == PIPELINE_SENT) {
+            hndl->pipeline_nsent--;
+            hndl->pipeline_bytes -= p->bytes;
+            hndl->pipeline_sent_query = 1;
+            memcpy(hndl->cnonce.str, p->cnonce, sizeof(p->cnonce));
+        }
+        hndl->n_bindvars = p->n_bindvars;
+        hndl->bindvars = p->bindvars;
+        hndl->pipeline_running = 1;
+        rc = cdb2_run_statement_typed(hndl, p->sql, 0, NULL);
+        hndl->pipeline_running = 0;
+        hndl->pipeline_sent_query = 0;
+        hndl->n_bindvars = n_bindvars;
+        hndl->bindvars = bindvars;
+    }
+    if (log_calls)
+        fprintf(stderr, "%p> cdb2_pipeline_next(%p) \"%s\" = %d\n",
+                (void *)pthread_self(), hndl, p->sql, rc);
+    pipeline_free(p);
+    return rc;
+}
+
 int cdb2_numcolumns(cdb2_hndl_tp *hndl)
 {
     int rc;
@@ -4965,12 +5596,39 @@ static int col_values_flattened(CDB2SQLRESPONSE *resp)
     return (resp->has_flat_col_vals && resp->flat_col_vals);
 }
 
+static int col_block_size(cdb2_hndl_tp *hndl, int row, int col)
+{
+    struct cdb2_col_block *c = &hndl->col_block[col];
+    uint32_t off[2];
+    if (c->isnull[row])
+        return 0;
+    if (c->width)
+        return c->width;
+    memcpy(off, c->off + row * sizeof(uint32_t), sizeof(off));
+    return off[1] - off[0];
+}
+
+static void *col_block_value(cdb2_hndl_tp *hndl, int row, int col)
+{
+    struct cdb2_col_block *c = &hndl->col_block[col];
+    uint32_t off;
+    if (c->isnull[row])
+        return NULL;
+    if (c->width)
+        return (void *)(c->data + (size_t)c->width * row);
+    memcpy(&off, c->off + row * sizeof(uint32_t), sizeof(off));
+    return (void *)(c->data + off);
+}
+
 int cdb2_column_size(cdb2_hndl_tp *hndl, int col)
 {
     CDB2SQLRESPONSE *lastresponse = hndl->lastresponse;
     /* sanity check. just in case. */
     if (lastresponse == NULL)
         return -1;
+    /* data came back in a columnar block */
+    if (hndl->col_nrows)
+        return col_block_size(hndl, hndl->col_row, col);
     /* data came back in the child column structure */
     if (lastresponse->value != NULL)
         return lastresponse->value[col]->value.len;
@@ -4984,6 +5642,14 @@ void *cdb2_column_value(cdb2_hndl_tp *hndl, int col)
     /* sanity check. just in case. */
     if (lastresponse == NULL)
         return NULL;
+    /* data came back in a columnar block */
+    if (hndl->col_nrows) {
+        /* handle empty values */
+        if (col_block_size(hndl, hndl->col_row, col) == 0 &&
+            !hndl->col_block[col].isnull[hndl->col_row])
+            return (void *)"";
+        return col_block_value(hndl, hndl->col_row, col);
+    }
     /* data came back in the child column structure */
     if (lastresponse->value != NULL) {
         /* handle empty values */
@@ -5003,6 +5669,50 @@ void *cdb2_column_value(cdb2_hndl_tp *hndl, int col)
     return NULL;
 }
 
+int cdb2_next_records(cdb2_hndl_tp *hndl, int max, int *nrows)
+{
+    *nrows = 0;
+    if (max < 1)
+        max = 1;
+    int rc = cdb2_next_record(hndl);
+    if (rc != CDB2_OK)
+        return rc;
+    int n = 1;
+    if (hndl->col_nrows) {
+        /* Hand out the rest of the columnar block in place */
+        n = hndl->col_nrows - hndl->col_row;
+        if (n > max)
+            n = max;
+        hndl->batch_row = hndl->col_row;
+        hndl->col_row += n - 1;
+        hndl->rows_read += n - 1;
+    }
+    *nrows = n;
+    if (log_calls)
+        fprintf(stderr, "%p> cdb2_next_records(%p, %d) = %d rows\n",
+                (void *)pthread_self(), hndl, max, n);
+    return rc;
+}
+
+int cdb2_batch_column_size(cdb2_hndl_tp *hndl, int row, int col)
+{
+    if (hndl->col_nrows)
+        return col_block_size(hndl, hndl->batch_row + row, col);
+    return row == 0 ? cdb2_column_size(hndl, col) : -1;
+}
+
+void *cdb2_batch_column_value(cdb2_hndl_tp *hndl, int row, int col)
+{
+    if (hndl->col_nrows) {
+        row += hndl->batch_row;
+        if (col_block_size(hndl, row, col) == 0 &&
+            !hndl->col_block[col].isnull[row])
+            return (void *)"";
+        return col_block_value(hndl, row, col);
+    }
+    return row == 0 ? cdb2_column_value(hndl, col) : NULL;
+}
+
 int cdb2_bind_param(cdb2_hndl_tp *hndl, const char *varname, int type,
                     const void *varaddr, int length)
 {
@@ -5167,6 +5877,95 @@ int cdb2_clearbindings(cdb2_hndl_tp *hndl)
     return 0;
 }
 
+/* Append identifier `id', double-quoted, to `out' */
+static char *bulk_quote(char *out, const char *id)
+{
+    *out++ = '"';
+    for (; *id; id++) {
+        if (*id == '"')
+            *out++ = '"';
+        *out++ = *id;
+    }
+    *out++ = '"';
+    return out;
+}
+
+/* cdb2_bulk_insert -- insert nrows rows, given column by column
+ * values[i] is an array of nrows values of types[i], each typelens[i] long,
+ * as for cdb2_bind_array. The rows are sent MAX_BIND_ARRAY at a time, each
+ * batch as one statement which zips the bound arrays together. */
+int cdb2_bulk_insert(cdb2_hndl_tp *hndl, const char *table, int ncols,
+                     const char **columns, const int *types,
+                     const void **values, const int *typelens, int nrows)
+{
+    size_t len = 64 + 2 * strlen(table);
+    char *sql, *p, (*names)[16];
+    int rc = 0;
+
+    if (hndl->n_bindvars) {
+        sprintf(hndl->errstr, "%s: handle has bound values", __func__);
+        return CDB2ERR_BADSTATE;
+    }
+    if (ncols <= 0 || nrows < 0) {
+        sprintf(hndl->errstr, "%s: bad column or row count", __func__);
+        return CDB2ERR_BADREQ;
+    }
+    for (int i = 0; i < ncols; i++)
+        len += 2 * strlen(columns[i]) + 96;
+    sql = malloc(len);
+    names = malloc(ncols * sizeof(*names));
+    if (sql == NULL || names == NULL) {
+        free(sql);
+        free(names);
+        return CDB2ERR_MALLOC;
+    }
+
+    /* INSERT INTO "t"("a","b") SELECT c0.value, c1.value FROM carray(@_b0)
+       c0, carray(@_b1) c1 WHERE c1.rowid=c0.rowid */
+    p = sql + sprintf(sql, "INSERT INTO ");
+    p = bulk_quote(p, table);
+    for (int i = 0; i < ncols; i++) {
+        *p++ = i ? ',' : '(';
+        p = bulk_quote(p, columns[i]);
+    }
+    p += sprintf(p, ") SELECT ");
+    for (int i = 0; i < ncols; i++)
+        p += sprintf(p, "%sc%d.value", i ? ", " : "", i);
+    p += sprintf(p, " FROM ");
+    for (int i = 0; i < ncols; i++) {
+        sprintf(names[i], "_bulk%d", i);
+        p += sprintf(p, "%scarray(@%s) c%d", i ? ", " : "", names[i], i);
+    }
+    for (int i = 1; i < ncols; i++)
+        p += sprintf(p, " %s c%d.rowid=c0.rowid", i > 1 ? "AND" : "WHERE", i);
+
+    for (int row = 0; row < nrows && rc == 0; row += MAX_BIND_ARRAY) {
+        int count = nrows - row;
+        if (count > MAX_BIND_ARRAY)
+            count = MAX_BIND_ARRAY;
+        for (int i = 0; i < ncols && rc == 0; i++) {
+            size_t sz = types[i] == CDB2_CSTRING ? sizeof(char *) : typelens[i];
+            rc = cdb2_bind_array(hndl, names[i], types[i],
+                                 (const char *)values[i] + row * sz, count,
+                                 typelens[i]);
+        }
+        if (rc == 0)
+            rc = cdb2_run_statement(hndl, sql);
+        while (rc == CDB2_OK)
+            rc = cdb2_next_record(hndl);
+        if (rc == CDB2_OK_DONE)
+            rc = 0;
+        cdb2_clearbindings(hndl);
+    }
+
+    if (log_calls)
+        fprintf(stderr, "%p> cdb2_bulk_insert(%p, \"%s\", %d, %d) = %d\n",
+                (void *)pthread_self(), hndl, table, ncols, nrows, rc);
+    free(names);
+    free(sql);
+    return rc;
+}
+
 static int comdb2db_get_dbhosts(cdb2_hndl_tp *hndl, const char *comdb2db_name,
                                 int comdb2db_num, const char *host, int port,
                                 char hosts[][CDB2HOSTNAME_LEN], int *num_hosts,
@@ -6429,6 +7228,10 @@ int cdb2_open(cdb2_hndl_tp **handle, const char *dbname, const char *type,
     hndl->allocator.allocator_data = hndl;
 
     hndl->request_fp = CDB2_REQUEST_FP;
+    hndl->columnar_rows = CDB2_COLUMNAR_ROWS;
+    hndl->load_balance = CDB2_LOAD_BALANCE;
+    hndl->max_stmt_ids = CDB2_MAX_STMT_IDS;
+    hndl->read_your_writes = CDB2_READ_YOUR_WRITES;
 
 out:
     if (log_calls) {
@@ -208,12 +208,17 @@ int cdb2_close(cdb2_hndl_tp *hndl);
 int cdb2_run_statement(cdb2_hndl_tp *hndl, const char *sql);
 int cdb2_run_statement_typed(cdb2_hndl_tp *hndl, const char *sql, int ntypes,
                              int *types);
+int cdb2_pipeline_statement(cdb2_hndl_tp *hndl, const char *sql);
+int cdb2_pipeline_next(cdb2_hndl_tp *hndl);
 
 int cdb2_numcolumns(cdb2_hndl_tp *hndl);
 const char *cdb2_column_name(cdb2_hndl_tp *hndl, int col);
 int cdb2_column_type(cdb2_hndl_tp *hndl, int col);
 int cdb2_column_size(cdb2_hndl_tp *hndl, int col);
 void *cdb2_column_value(cdb2_hndl_tp *hndl, int col);
+int cdb2_next_records(cdb2_hndl_tp *hndl, int max, int *nrows);
+int cdb2_batch_column_size(cdb2_hndl_tp *hndl, int row, int col);
+void *cdb2_batch_column_value(cdb2_hndl_tp *hndl, int row, int col);
 const char *cdb2_errstr(cdb2_hndl_tp *hndl);
 const char *cdb2_cnonce(cdb2_hndl_tp *hndl);
 void cdb2_set_debug_trace(cdb2_hndl_tp *hndl);
@@ -235,6 +240,9 @@ int cdb2_bind_index(cdb2_hndl_tp *hndl, int index, int type,
 int cdb2_bind_array(cdb2_hndl_tp *hndl, const char *name, int type,
                     const void *varaddr, unsigned int count, int typelen);
 int cdb2_clearbindings(cdb2_hndl_tp *hndl);
+int cdb2_bulk_insert(cdb2_hndl_tp *hndl, const char *table, int ncols,
+                     const char **columns, const int *types,
+                     const void **values, const int *typelens, int nrows);
 
 const char *cdb2_dbname(cdb2_hndl_tp *hndl);
 
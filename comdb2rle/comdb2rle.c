@@ -22,6 +22,14 @@
 #include <arpa/nameser_compat.h>
 #include "comdb2rle.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #ifndef BYTE_ORDER
 #   error "BYTE_ORDER not defined"
 #endif
@@ -227,63 +235,60 @@ static uint32_t space_reqd(uint32_t r, uint32_t s)
            (s > 1 ? (varint_need(s) + s) : s);
 }
 
-/* Check if 'sz' bytes repeat */
-static uint32_t repeats(Data in, uint32_t sz, uint32_t *r_)
+/* Return the first i in [0, n) where d[i] != d[i + s], or n.
+ * Reads d[0 .. n + s). Compares 32 (AVX2) or 16 (SSE2/NEON) bytes at a
+ * time, then 8, then byte at a time for the remainder. */
+static size_t mismatch_shift(const uint8_t *d, size_t n, uint32_t s)
 {
-    uint32_t r;
-    r = *r_ = 0;
-    if (in.sz < (sz * 2))
-        return 0;
-    uint8_t *bp, *bx, bt;
-    uint16_t *wp, word;
-    switch (sz) {
-    case 1:
-        bt = *in.dt;        // 1st byte
-        bp = in.dt + sz;    // byte ptr
-        bx = in.dt + in.sz; // byte ptr max
-#ifndef _SUN_SOURCE
-        if (in.sz > 16) {
-            size_t qz = in.sz - in.sz % 8; // # of quads
-            uint64_t qw;
-            memset(&qw, bt, sizeof(qw));             // 1st quad
-            uint64_t *qp = (uint64_t *)in.dt;        // quad ptr
-            uint64_t *qx = (uint64_t *)(in.dt + qz); // quad ptr max
-            while (qp < qx && *qp == qw)
-                ++qp;
-            if ((uint8_t *)qp != in.dt) {
-                if (qp < qx) // last quad != 1st
-                    --qp;
-                bp = (uint8_t *)qp;
-            }
-        }
+    const uint8_t *a = d, *b = d + s;
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        uint32_t ne = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+        if (ne)
+            return i + __builtin_ctz(ne);
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        uint32_t ne = 0xffff & ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+        if (ne)
+            return i + __builtin_ctz(ne);
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t eq = vceqq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        if (vminvq_u8(eq) != 0xff)
+            break; /* locate it below */
+    }
 #endif
-        // check remainder byte at a time
-        while (bp < bx && *bp == bt)
-            ++bp;
-        r = bp - in.dt - 1;
-        break;
 #ifndef _SUN_SOURCE
-    case 2:
-        word = *(uint16_t *)in.dt;
-        wp = (uint16_t *)(in.dt + sz);
-        in.sz -= (in.sz % sz);
-        while ((in.sz -= sz) != 0 && word == *wp) {
-            ++wp;
-            ++r;
-        }
-        break;
-#endif
-    default:
-        bp = in.dt + sz;
-        in.sz -= (in.sz % sz);
-        while ((in.sz -= sz) != 0) {
-            if (memcmp(in.dt, bp, sz))
-                break;
-            bp += sz;
-            ++r;
-        }
-        break;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, sizeof(x));
+        memcpy(&y, b + i, sizeof(y));
+        if (x != y)
+            break; /* locate it below */
     }
+#endif
+    while (i < n && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+/* Check if 'sz' bytes repeat
+ * Pattern of sz bytes repeats r times iff every byte in the first r * sz
+ * matches the one sz bytes after it. */
+static uint32_t repeats(Data in, uint32_t sz, uint32_t *r_)
+{
+    *r_ = 0;
+    if (in.sz < (sz * 2))
+        return 0;
+    size_t len = in.sz - (in.sz % sz);
+    uint32_t r = mismatch_shift(in.dt, len - sz, sz) / sz;
     *r_ = r;
     return r;
 }
@@ -293,7 +298,7 @@ static int well_known(uint8_t *d, uint32_t s, uint32_t *w)
 {
     *w = MAXPAT;
     for (uint32_t i = 0; i < MAXPAT; ++i) {
-        if (s == psizes[i])
+        if (s == psizes[i] && *d == patterns[i][0])
             if (memcmp(d, patterns[i], psizes[i]) == 0) {
                 *w = i;
                 return 1;
@@ -529,6 +534,17 @@ int decompressComdb2RLE(Comdb2RLE *d)
             memset(output.dt, *p, r);
             output.dt += r;
             output.sz -= r;
+        } else if (r > 3) {
+            /* copy the pattern once, then keep doubling what's written */
+            size_t total = (size_t)s * (r + 1), done = s;
+            memcpy(output.dt, p, s);
+            while (done < total) {
+                size_t n = done < total - done ? done : total - done;
+                memcpy(output.dt + done, output.dt, n);
+                done += n;
+            }
+            output.dt += total;
+            output.sz -= total;
         } else
             for (uint32_t i = 0; i <= r; ++i) {
                 switch (s) {
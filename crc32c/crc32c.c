@@ -80,7 +80,17 @@ uint32_t crc32c_software(const uint8_t* buf, uint32_t sz, uint32_t crc)
 #include <smmintrin.h>
 #include <wmmintrin.h>
 
+/* VPCLMULQDQ needs gcc 8 or clang 6 to build; use it only if we can */
+#if (defined(__clang__) && __clang_major__ >= 6) || \
+    (!defined(__clang__) && __GNUC__ >= 8)
+#define CRC32C_VPCLMUL
+#include <immintrin.h>
+#endif
+
 /* Fwd declare available methods to compute crc32c */
+#ifdef CRC32C_VPCLMUL
+static uint32_t crc32c_vpclmul(const uint8_t *buf, uint32_t sz, uint32_t crc);
+#endif
 static uint32_t crc32c_sse_pcl(const uint8_t *buf, uint32_t sz, uint32_t crc);
 static uint32_t crc32c_sse(const uint8_t *buf, uint32_t sz, uint32_t crc);
 
@@ -99,10 +109,34 @@ typedef long long v2di __attribute__ ((vector_size(16)));
 #define SSE4_2 bit_SSE4_2
 #define PCLMUL bit_PCLMUL
 #endif
+#ifdef CRC32C_VPCLMUL
+/* AVX-512F + VPCLMULQDQ, and the OS saves the zmm registers */
+static int have_vpclmul(uint32_t ecx1)
+{
+	uint32_t eax, ebx, ecx, edx, xcr0_lo, xcr0_hi;
+	if (!(ecx1 & bit_OSXSAVE) || __get_cpuid_max(0, NULL) < 7)
+		return 0;
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	if (!(ebx & bit_AVX512F) || !(ecx & (1 << 10))) // VPCLMULQDQ
+		return 0;
+	__asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+	return (xcr0_lo & 0xe6) == 0xe6; // sse, avx, opmask, zmm state
+}
+#endif
+
 void crc32c_init(int v)
 {
 	uint32_t eax, ebx, ecx, edx;
 	__cpuid(1, eax, ebx, ecx, edx);
+#ifdef CRC32C_VPCLMUL
+	if ((ecx & SSE4_2) && (ecx & PCLMUL) && have_vpclmul(ecx)) {
+		crc32c_func = crc32c_vpclmul;
+		if (v) {
+			logmsg(LOGMSG_INFO, "AVX-512 + VPCLMULQDQ SUPPORT FOR CRC32C\n");
+			logmsg(LOGMSG_INFO, "crc32c = crc32c_vpclmul\n");
+		}
+	} else
+#endif
 	if (ecx & SSE4_2) {
 		if (ecx & PCLMUL) {
 			crc32c_func = crc32c_sse_pcl;
@@ -246,6 +280,101 @@ static uint32_t crc32c_sse_pcl(const uint8_t *buf, uint32_t sz, uint32_t crc)
 	return out;
 }
 
+#ifdef CRC32C_VPCLMUL
+#define VPCLMUL_TARGET __attribute__((target("avx512f,vpclmulqdq,pclmul,sse4.2")))
+
+/*
+ * Fold constants for the reflected crc32c polynomial: a 128-bit lane is moved
+ * n bits forward by multiplying its low qword by x^(n+32) and its high qword
+ * by x^(n-32) (mod P, bit-reflected, shifted left by 1).
+ */
+#define K_2048_LO 0x0dcb17aa4
+#define K_2048_HI 0x0b9e02b86
+#define K_512_LO  0x0740eef02
+#define K_512_HI  0x09e4addf8
+#define K_384_LO  0x01c291d04
+#define K_384_HI  0x1d82c63da
+#define K_256_LO  0x1384aa63a
+#define K_256_HI  0x0ba4fc28e
+#define K_128_LO  0x0f20c0dfe
+#define K_128_HI  0x14cd00bd6
+
+VPCLMUL_TARGET
+static inline __m512i fold_512(__m512i x, __m512i k, __m512i data)
+{
+	__m512i lo = _mm512_clmulepi64_epi128(x, k, 0x00);
+	__m512i hi = _mm512_clmulepi64_epi128(x, k, 0x11);
+	return _mm512_ternarylogic_epi64(lo, hi, data, 0x96); // lo ^ hi ^ data
+}
+
+VPCLMUL_TARGET
+static inline __m128i fold_128(__m128i x, __m128i k)
+{
+	return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+			     _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+#define K512(k) _mm512_broadcast_i32x4(_mm_set_epi64x(k##_HI, k##_LO))
+#define K128(k) _mm_set_epi64x(k##_HI, k##_LO)
+
+/*
+ * Compute chksum by folding 256 bytes at a time into four zmm registers with
+ * VPCLMULQDQ. What is left after folding is 16 bytes which have the same crc
+ * as everything folded into them; finish those with crc32 and use SSE for
+ * the last (< 64) bytes. Use PCLMUL for input < 256 bytes.
+ */
+VPCLMUL_TARGET
+static uint32_t crc32c_vpclmul(const uint8_t *buf, uint32_t sz, uint32_t crc)
+{
+	if (sz < 256)
+		return crc32c_sse_pcl(buf, sz, crc);
+
+	__m512i x0, x1, x2, x3, k;
+	__m128i a0, a1, a2, a3;
+	uint64_t out;
+
+	x0 = _mm512_loadu_si512(buf);
+	x1 = _mm512_loadu_si512(buf + 64);
+	x2 = _mm512_loadu_si512(buf + 128);
+	x3 = _mm512_loadu_si512(buf + 192);
+	x0 = _mm512_xor_si512(x0, _mm512_zextsi128_si512(_mm_cvtsi32_si128(crc)));
+	buf += 256;
+	sz -= 256;
+
+	k = K512(K_2048);
+	while (sz >= 256) {
+		x0 = fold_512(x0, k, _mm512_loadu_si512(buf));
+		x1 = fold_512(x1, k, _mm512_loadu_si512(buf + 64));
+		x2 = fold_512(x2, k, _mm512_loadu_si512(buf + 128));
+		x3 = fold_512(x3, k, _mm512_loadu_si512(buf + 192));
+		buf += 256;
+		sz -= 256;
+	}
+
+	k = K512(K_512);
+	x0 = fold_512(x0, k, x1);
+	x0 = fold_512(x0, k, x2);
+	x0 = fold_512(x0, k, x3);
+	while (sz >= 64) {
+		x0 = fold_512(x0, k, _mm512_loadu_si512(buf));
+		buf += 64;
+		sz -= 64;
+	}
+
+	a0 = _mm512_extracti32x4_epi32(x0, 0);
+	a1 = _mm512_extracti32x4_epi32(x0, 1);
+	a2 = _mm512_extracti32x4_epi32(x0, 2);
+	a3 = _mm512_extracti32x4_epi32(x0, 3);
+	a0 = _mm_xor_si128(fold_128(a0, K128(K_384)), fold_128(a1, K128(K_256)));
+	a0 = _mm_xor_si128(a0, _mm_xor_si128(fold_128(a2, K128(K_128)), a3));
+
+	out = _mm_crc32_u64(0, _mm_extract_epi64(a0, 0));
+	out = _mm_crc32_u64(out, _mm_extract_epi64(a0, 1));
+	if (sz) out = crc32c_8s(buf, sz, out);
+	return out;
+}
+#endif
+
 /* Compute chksum 1 byte at a time until input is sizeof(intptr) aligned */
 static inline
 uint32_t crc32c_until_aligned(const uint8_t **buf_, uint32_t *sz_, uint32_t crc)
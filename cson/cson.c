@@ -759,3 +759,129 @@ char const *cson_rc_string(int rc)
 {
     return "malformed JSON";
 }
+
+/**********************/
+/** Streaming writer **/
+/**********************/
+/* Appends JSON text as it is written: no tree and no allocation per value.
+ * Pass a NULL key for array elements. The buffer is kept across
+ * cson_writer_reset() so a reused writer stops allocating altogether. */
+struct cson_writer {
+    JsonString str;
+    int depth;
+};
+static void cson__writer_key(cson_writer *w, char const *key)
+{
+    jsonAppendSeparator(&w->str);
+    if (key) {
+        jsonAppendString(&w->str, key, strlen(key));
+        jsonAppendChar(&w->str, ':');
+    }
+}
+cson_writer *cson_writer_new(void)
+{
+    cson_writer *w = calloc(1, sizeof(cson_writer));
+    jsonInit(&w->str, NULL);
+    return w;
+}
+void cson_writer_free(cson_writer *w)
+{
+    if (!w) return;
+    jsonReset(&w->str);
+    free(w);
+}
+void cson_writer_reset(cson_writer *w)
+{
+    // keep the buffer for the next document
+    w->str.nUsed = 0;
+    w->str.bErr = 0;
+    w->depth = 0;
+}
+int cson_writer_object_begin(cson_writer *w, char const *key)
+{
+    cson__writer_key(w, key);
+    jsonAppendChar(&w->str, '{');
+    ++w->depth;
+    return w->str.bErr ? -1 : 0;
+}
+int cson_writer_object_end(cson_writer *w)
+{
+    if (w->depth <= 0) return -1;
+    jsonAppendChar(&w->str, '}');
+    --w->depth;
+    return w->str.bErr ? -1 : 0;
+}
+int cson_writer_array_begin(cson_writer *w, char const *key)
+{
+    cson__writer_key(w, key);
+    jsonAppendChar(&w->str, '[');
+    ++w->depth;
+    return w->str.bErr ? -1 : 0;
+}
+int cson_writer_array_end(cson_writer *w)
+{
+    if (w->depth <= 0) return -1;
+    jsonAppendChar(&w->str, ']');
+    --w->depth;
+    return w->str.bErr ? -1 : 0;
+}
+int cson_writer_int(cson_writer *w, char const *key, cson_int_t v)
+{
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%" PRId64, v);
+    cson__writer_key(w, key);
+    jsonAppendRaw(&w->str, buf, n);
+    return w->str.bErr ? -1 : 0;
+}
+int cson_writer_double(cson_writer *w, char const *key, cson_double_t v)
+{
+    char buf[64];
+    int n = snprintf(buf, sizeof(buf), "%.15g", v);
+    cson__writer_key(w, key);
+    jsonAppendRaw(&w->str, buf, n);
+    return w->str.bErr ? -1 : 0;
+}
+int cson_writer_string(cson_writer *w, char const *key, char const *str, unsigned int n)
+{
+    cson__writer_key(w, key);
+    jsonAppendString(&w->str, str, n);
+    return w->str.bErr ? -1 : 0;
+}
+int cson_writer_bool(cson_writer *w, char const *key, char v)
+{
+    cson__writer_key(w, key);
+    if (v) jsonAppendRaw(&w->str, "true", 4);
+    else jsonAppendRaw(&w->str, "false", 5);
+    return w->str.bErr ? -1 : 0;
+}
+int cson_writer_null(cson_writer *w, char const *key)
+{
+    cson__writer_key(w, key);
+    jsonAppendRaw(&w->str, "null", 4);
+    return w->str.bErr ? -1 : 0;
+}
+int cson_writer_value(cson_writer *w, char const *key, cson_value *val)
+{
+    if (val->sub_type) {
+        cson__render(val);
+    }
+    cson__writer_key(w, key);
+    jsonAppendValue(&w->str, val);
+    return w->str.bErr ? -1 : 0;
+}
+int cson_writer_output(cson_writer *w, cson_data_dest_f f, void *arg)
+{
+    if (w->depth || w->str.bErr) return -1;
+    int rc = f(arg, w->str.zBuf, w->str.nUsed);
+    if (rc == 0) {
+        rc = f(arg, "\n", 1);
+    }
+    return rc;
+}
+int cson_writer_output_buffer(cson_writer *w, cson_buffer *buf)
+{
+    if (w->depth || w->str.bErr) return -1;
+    buf->mem = w->str.zBuf;
+    buf->used = w->str.nUsed;
+    return 0;
+}
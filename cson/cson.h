@@ -34,6 +34,7 @@ typedef struct cson_array cson_array;
 typedef struct cson_buffer cson_buffer;
 typedef struct cson_kvp cson_kvp;
 typedef struct cson_object_iterator cson_object_iterator;
+typedef struct cson_writer cson_writer;
 typedef int (*cson_data_dest_f)(void *, const void *, unsigned int);
 
 struct cson_buffer {
@@ -97,6 +98,22 @@ unsigned int cson_array_length_get(cson_array const *);
 void cson_free_value(cson_value *);
 void cson_value_free(cson_value *);
 
+cson_writer *cson_writer_new(void);
+int cson_writer_array_begin(cson_writer *, char const *key);
+int cson_writer_array_end(cson_writer *);
+int cson_writer_bool(cson_writer *, char const *key, char v);
+int cson_writer_double(cson_writer *, char const *key, cson_double_t);
+int cson_writer_int(cson_writer *, char const *key, cson_int_t);
+int cson_writer_null(cson_writer *, char const *key);
+int cson_writer_object_begin(cson_writer *, char const *key);
+int cson_writer_object_end(cson_writer *);
+int cson_writer_output(cson_writer *, cson_data_dest_f dest, void *destState);
+int cson_writer_output_buffer(cson_writer *, cson_buffer *buf);
+int cson_writer_string(cson_writer *, char const *key, char const *str, unsigned int n);
+int cson_writer_value(cson_writer *, char const *key, cson_value *);
+void cson_writer_free(cson_writer *);
+void cson_writer_reset(cson_writer *);
+
 #ifdef __cplusplus
 }
 #endif
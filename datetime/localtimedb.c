@@ -2393,17 +2393,33 @@ register struct tm *const tmp;
     return tmp;
 }
 
-static struct tm *db_localsub(timep, offset, tmp) const db_time_t *const timep;
-const long offset;
-struct tm *const tmp;
+/* The stretch of time between two transitions of a zone, and the type in
+ * effect during it: lo <= t < hi */
+struct db_interval {
+    db_time_t lo;
+    db_time_t hi;
+    int type;
+};
+
+/*
+** db_localsub() for zone sp.  If iv is set, it is the interval the previous
+** value fell in: a value in it needs no lookup, otherwise iv is moved to the
+** interval of this one.  Only the locked path sets tzname.
+*/
+static struct tm *db_localsub_sp(const struct db_state *sp,
+                                 const db_time_t *const timep,
+                                 const long offset, struct tm *const tmp,
+                                 struct db_interval *iv)
 {
-    register struct db_state *sp;
     register const struct ttinfo *ttisp;
     register int i;
     register struct tm *result;
     const db_time_t t = *timep;
 
-    sp = db_lclptr;
+    if (iv && t >= iv->lo && t < iv->hi) {
+        i = iv->type;
+        goto found;
+    }
 
     if ((sp->goback && t < sp->ats[0]) ||
         (sp->goahead && t > sp->ats[sp->timecnt - 1])) {
@@ -2430,7 +2446,7 @@ struct tm *const tmp;
             newt -= seconds;
         if (newt < sp->ats[0] || newt > sp->ats[sp->timecnt - 1])
             return NULL; /* "cannot happen" */
-        result = db_localsub(&newt, offset, tmp);
+        result = db_localsub_sp(sp, &newt, offset, tmp, NULL);
         if (result == tmp) {
             register db_time_t newy;
 
@@ -2455,6 +2471,11 @@ struct tm *const tmp;
                 i = 0;
                 break;
             }
+        if (iv) {
+            /* UTC and fixed offset zones have no transitions at all */
+            iv->lo = LLONG_MIN;
+            iv->hi = sp->timecnt == 0 ? LLONG_MAX : sp->ats[0];
+        }
     } else {
         register int lo = 1;
         register int hi = sp->timecnt;
@@ -2468,7 +2489,18 @@ struct tm *const tmp;
                 lo = mid + 1;
         }
         i = (int)sp->types[lo - 1];
+        if (iv) {
+            /* past the last transition goahead takes over */
+            iv->lo = sp->ats[lo - 1];
+            if (lo < sp->timecnt)
+                iv->hi = sp->ats[lo];
+            else
+                iv->hi = sp->goahead ? sp->ats[lo - 1] + 1 : LLONG_MAX;
+        }
     }
+    if (iv)
+        iv->type = i;
+found:
     ttisp = &sp->ttis[i];
     /*
     ** To get (wrong) behavior that's compatible with System V Release 2.0
@@ -2478,13 +2510,70 @@ struct tm *const tmp;
     */
     result = db_timesub(&t, ttisp->tt_gmtoff, sp, tmp);
     tmp->tm_isdst = ttisp->tt_isdst;
-    tzname[tmp->tm_isdst] = &sp->chars[ttisp->tt_abbrind];
+    if (iv == NULL)
+        tzname[tmp->tm_isdst] = &sp->chars[ttisp->tt_abbrind];
 #ifdef TM_ZONE
     tmp->TM_ZONE = &sp->chars[ttisp->tt_abbrind];
 #endif /* defined TM_ZONE */
     return result;
 }
 
+static struct tm *db_localsub(timep, offset, tmp) const db_time_t *const timep;
+const long offset;
+struct tm *const tmp;
+{
+    return db_localsub_sp(db_lclptr, timep, offset, tmp, NULL);
+}
+
+/*
+** Each thread remembers the last few zones it converted to, and for each the
+** interval its last value fell in.  Zones are never unloaded, so with its
+** zone at hand a thread converts without global_dt_mutex; a run of values in
+** one zone, like a column of a result set, mostly skips the transition
+** search as well.
+*/
+#define DB_TZ_CACHE_ENTS 4
+
+struct db_tz_cache_ent {
+    char name[NAME_KEY_MAX];
+    const struct db_state *sp;
+    struct db_interval iv;
+};
+
+static __thread struct db_tz_cache_ent db_tz_cache[DB_TZ_CACHE_ENTS];
+static __thread unsigned db_tz_cache_next;
+
+static struct db_tz_cache_ent *db_tz_cache_get(const char *name)
+{
+    struct db_tz_cache_ent *ent;
+    const struct db_state *sp = NULL;
+    int i;
+
+    if (name[0] == '\0' || strlen(name) >= NAME_KEY_MAX)
+        return NULL;
+    for (i = 0; i < DB_TZ_CACHE_ENTS; ++i) {
+        ent = &db_tz_cache[i];
+        if (ent->sp && strcmp(ent->name, name) == 0)
+            return ent;
+    }
+
+    /* db_tzset() loads the zone if it has to; the hash has the copy that
+     * stays put */
+    Pthread_mutex_lock(&global_dt_mutex);
+    if (!db_tzset(name))
+        sp = find_tz(name);
+    Pthread_mutex_unlock(&global_dt_mutex);
+    if (sp == NULL)
+        return NULL;
+
+    ent = &db_tz_cache[db_tz_cache_next++ % DB_TZ_CACHE_ENTS];
+    strcpy(ent->name, name);
+    ent->sp = sp;
+    ent->iv.lo = 0;
+    ent->iv.hi = 0;
+    return ent;
+}
+
 /*
 struct tm* db_testpoint(name, timeval)
 register const char * const     name;
@@ -2500,6 +2589,10 @@ const db_time_t *const timeval;
 struct tm *outtm;
 {
     struct tm *ret = NULL;
+    struct db_tz_cache_ent *ent;
+
+    if ((ent = db_tz_cache_get(name)) != NULL)
+        return db_localsub_sp(ent->sp, timeval, 0L, outtm, &ent->iv) ? 0 : -1;
 
     Pthread_mutex_lock(&global_dt_mutex);
 
@@ -0,0 +1,191 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "comdb2.h"
+#include "sql.h"
+#include "bdb_api.h"
+#include "thread_stats.h"
+#include "averager.h"
+#include "admission.h"
+#include <cdb2api.h>
+#include <comdb2_atomic.h>
+#include <epochlib.h>
+#include <logmsg.h>
+#include <locks_wrap.h>
+
+int gbl_admission_control = 0;
+int gbl_admission_queue_ms = 100;
+int gbl_admission_miss_pct = 0;
+int gbl_admission_lockwait_ms = 0;
+int gbl_admission_min_class = 1;
+int gbl_admission_delay_ms = 20;
+
+/* seconds the signals are averaged over */
+#define ADMISSION_WINDOW 5
+
+static int64_t queue_sum_ms;
+static int64_t queue_waits;
+
+static int admission_state = ADMISSION_NORMAL;
+static int64_t admission_delayed;
+static int64_t admission_shed;
+
+/* the averagers belong to the stat thread; others read the last results */
+static struct averager *queue_avg, *miss_avg, *lockwait_avg;
+static pthread_mutex_t admission_lk = PTHREAD_MUTEX_INITIALIZER;
+static struct admission_stats last;
+
+void admission_note_queue_time(int ms)
+{
+    ATOMIC_ADD64(queue_sum_ms, ms);
+    ATOMIC_ADD64(queue_waits, 1);
+}
+
+const char *admission_state_name(enum admission_state state)
+{
+    switch (state) {
+    case ADMISSION_NORMAL:
+        return "normal";
+    case ADMISSION_DELAY:
+        return "delay";
+    case ADMISSION_SHED:
+        return "shed";
+    }
+    return "unknown";
+}
+
+static double over(double value, int threshold)
+{
+    return threshold > 0 ? value / threshold : 0;
+}
+
+void admission_update(void)
+{
+    static int64_t last_qsum, last_qn, last_hits, last_misses,
+        last_lockwait_us;
+    static int sampled;
+    int64_t qsum, qn, hits, misses, evicts, lockwait_us, n;
+    int now = comdb2_time_epoch();
+    enum admission_state state;
+    double level, load, cpu_pct = 0;
+    int64_t lag_bytes;
+    long ncpu;
+
+    if (queue_avg == NULL) {
+        queue_avg = averager_new(ADMISSION_WINDOW, 0);
+        miss_avg = averager_new(ADMISSION_WINDOW, 0);
+        lockwait_avg = averager_new(ADMISSION_WINDOW, 0);
+    }
+
+    qsum = ATOMIC_LOAD64(queue_sum_ms);
+    qn = ATOMIC_LOAD64(queue_waits);
+    if (bdb_get_bpool_counters(thedb->bdb_env, &hits, &misses, &evicts))
+        return;
+    lockwait_us = bdb_get_process_stats()->lock_wait_time_us;
+
+    if (sampled) {
+        /* a second with nothing dequeued says nothing about queue time */
+        if ((n = qn - last_qn) > 0)
+            averager_add(queue_avg, (qsum - last_qsum) / n, now);
+        /* miss rate in tenths of a percent */
+        if ((n = (hits - last_hits) + (misses - last_misses)) > 0)
+            averager_add(miss_avg, (misses - last_misses) * 1000 / n, now);
+        averager_add(lockwait_avg, (lockwait_us - last_lockwait_us) / 1000,
+                     now);
+    }
+    sampled = 1;
+    last_qsum = qsum;
+    last_qn = qn;
+    last_hits = hits;
+    last_misses = misses;
+    last_lockwait_us = lockwait_us;
+
+    averager_purge_old(queue_avg, now);
+    averager_purge_old(miss_avg, now);
+    averager_purge_old(lockwait_avg, now);
+
+    /* not thresholds, but clients that balance on load want them too */
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu > 0 && getloadavg(&load, 1) == 1)
+        cpu_pct = load * 100 / ncpu;
+    lag_bytes = bdb_bytes_behind_master(thedb->bdb_env);
+
+    Pthread_mutex_lock(&admission_lk);
+    last.queue_ms = averager_avg(queue_avg);
+    last.miss_pct = averager_avg(miss_avg) / 10;
+    last.lockwait_ms = averager_avg(lockwait_avg);
+    last.cpu_pct = cpu_pct;
+    last.lag_bytes = lag_bytes;
+
+    level = over(last.queue_ms, gbl_admission_queue_ms);
+    if (over(last.miss_pct, gbl_admission_miss_pct) > level)
+        level = over(last.miss_pct, gbl_admission_miss_pct);
+    if (over(last.lockwait_ms, gbl_admission_lockwait_ms) > level)
+        level = over(last.lockwait_ms, gbl_admission_lockwait_ms);
+    last.level = level;
+
+    if (!gbl_admission_control || level < 1)
+        state = ADMISSION_NORMAL;
+    else if (level < 2)
+        state = ADMISSION_DELAY;
+    else
+        state = ADMISSION_SHED;
+    if (state != last.state) {
+        logmsg(state == ADMISSION_NORMAL ? LOGMSG_INFO : LOGMSG_WARN,
+               "admission control %s -> %s: queue %.1f ms, buffer pool miss "
+               "%.1f%%, lock waits %.1f ms/s\n",
+               admission_state_name(last.state), admission_state_name(state),
+               last.queue_ms, last.miss_pct, last.lockwait_ms);
+        last.state = state;
+    }
+    Pthread_mutex_unlock(&admission_lk);
+
+    admission_state = state;
+}
+
+int admission_check(struct sqlclntstate *clnt)
+{
+    int state = ATOMIC_LOAD32(admission_state);
+
+    /* work already under way, a transaction or a retry, goes ahead so
+       that what was admitted can finish */
+    if (state == ADMISSION_NORMAL || clnt->admin ||
+        clnt->prio_class < gbl_admission_min_class || in_client_trans(clnt) ||
+        clnt->osql.replay != OSQL_RETRY_NONE)
+        return 0;
+
+    if (state == ADMISSION_SHED) {
+        ATOMIC_ADD64(admission_shed, 1);
+        return CDB2ERR_REJECTED;
+    }
+    ATOMIC_ADD64(admission_delayed, 1);
+    poll(NULL, 0, gbl_admission_delay_ms);
+    return 0;
+}
+
+void admission_get_stats(struct admission_stats *st)
+{
+    Pthread_mutex_lock(&admission_lk);
+    *st = last;
+    Pthread_mutex_unlock(&admission_lk);
+    st->delayed = ATOMIC_LOAD64(admission_delayed);
+    st->shed = ATOMIC_LOAD64(admission_shed);
+}
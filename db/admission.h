@@ -0,0 +1,69 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_ADMISSION_H
+#define INCLUDED_ADMISSION_H
+
+/*
+  Admission control
+
+  Once a second the stat thread samples how long SQL requests waited in the
+  engine pool queue, the buffer pool miss rate, and the time threads spent
+  waiting for locks.  Each is averaged over a few seconds and compared with
+  its threshold.  While the worst of them is over its threshold, requests in
+  the low-priority classes are delayed before they are queued; at twice the
+  threshold they are rejected with CDB2ERR_REJECTED, which clients retry
+  after backing off.
+*/
+
+#include <stdint.h>
+
+struct sqlclntstate;
+
+enum admission_state {
+    ADMISSION_NORMAL = 0,
+    ADMISSION_DELAY = 1,
+    ADMISSION_SHED = 2
+};
+
+struct admission_stats {
+    enum admission_state state;
+    double level; /* worst signal, as a multiple of its threshold */
+    double queue_ms;
+    double miss_pct;
+    double lockwait_ms; /* ms of lock waits per second */
+    double cpu_pct;     /* 1 minute load average, per cpu */
+    int64_t lag_bytes;  /* log not yet applied from the master */
+    int64_t delayed;
+    int64_t shed;
+};
+
+extern int gbl_admission_control;
+
+/* A SQL request waited ms in the engine pool queue */
+void admission_note_queue_time(int ms);
+
+/* Sample the signals; called once a second by the stat thread */
+void admission_update(void);
+
+/* Called before a request is queued.  Returns 0 to go ahead, possibly after
+   a delay, or the error to reject it with */
+int admission_check(struct sqlclntstate *clnt);
+
+const char *admission_state_name(enum admission_state state);
+void admission_get_stats(struct admission_stats *st);
+
+#endif
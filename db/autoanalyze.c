@@ -248,6 +248,32 @@ out:
     return val;
 }
 
+/* Percentage of the rows counted by the last analyze of tbl that were
+ * written since; -1 if the table was never analyzed.  The counters are
+ * only maintained on the master.
+ */
+double auto_analyze_changed_percent(struct dbtable *tbl)
+{
+    if (tbl->aa_lastepoch == 0)
+        return -1;
+
+    int include_updates = bdb_attr_get(thedb->bdb_attr, BDB_ATTR_AA_COUNT_UPD);
+    unsigned prev = tbl->saved_write_count[RECORD_WRITE_DEL] +
+                    tbl->saved_write_count[RECORD_WRITE_INS];
+    unsigned curr = tbl->write_count[RECORD_WRITE_DEL] +
+                    tbl->write_count[RECORD_WRITE_INS];
+
+    if (include_updates) {
+        prev += tbl->saved_write_count[RECORD_WRITE_UPD];
+        curr += tbl->write_count[RECORD_WRITE_UPD];
+    }
+
+    unsigned int changed = ATOMIC_LOAD32(tbl->aa_saved_counter) + (curr - prev);
+    if (changed == 0)
+        return 0;
+    return (100.0 * changed) / get_num_rows_from_stat1(tbl);
+}
+
 // print autoanalyze stats
 void stat_auto_analyze(void)
 {
@@ -22,5 +22,7 @@ void stat_auto_analyze(void);
 void *auto_analyze_main(void *);
 void *auto_analyze_table(void *);
 void autoanalyze_after_fastinit(char *);
+struct dbtable;
+double auto_analyze_changed_percent(struct dbtable *);
 
 #endif // INCLUDE_AUTOANALYZE_H
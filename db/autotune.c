@@ -0,0 +1,229 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "comdb2.h"
+#include "sql.h"
+#include "thdpool.h"
+#include "admission.h"
+#include "autotune.h"
+#include <epochlib.h>
+#include <logmsg.h>
+
+int gbl_autotune = 0;
+int gbl_autotune_apply = 0;
+int gbl_autotune_interval_secs = 60;
+int gbl_autotune_max_factor = 2;
+
+/* below these the signals count as healthy */
+#define AUTOTUNE_QUEUE_MS 10
+#define AUTOTUNE_MISS_PCT 5
+#define AUTOTUNE_LOCKWAIT_MS 200
+
+/* a step is a quarter of the current value, and at least 1 */
+#define AUTOTUNE_STEP(v) ((v) / 4 > 0 ? (v) / 4 : 1)
+
+struct autotune_sample {
+    struct admission_stats adm;
+    int reqq;     /* most requests seen queued in handle_buf */
+    int sqlbusy;  /* most busy engine pool threads */
+    int cpu_busy; /* load average at or over the number of cpus */
+};
+
+struct autotune_knob {
+    const char *name; /* as in the lrl and "put tunable" */
+    int live;         /* can be changed at runtime */
+    int (*get)(void);
+    int (*want)(const struct autotune_knob *, const struct autotune_sample *,
+                int cur);
+    int start; /* value when tuning began, 0 if not yet read */
+    int recommended;
+};
+
+static int get_sqlpool_maxt(void)
+{
+    return thdpool_get_maxthds(get_default_sql_pool(0));
+}
+
+static int get_maxt(void)
+{
+    return gbl_maxthreads;
+}
+
+static int get_cachekb(void)
+{
+    return thedb->cacheszkb;
+}
+
+static int clamp(const struct autotune_knob *k, int v)
+{
+    long long hi = (long long)k->start * gbl_autotune_max_factor;
+
+    if (v > hi)
+        v = hi;
+    if (v < k->start)
+        v = k->start;
+    return v;
+}
+
+/* Queued SQL with cpu to spare and few lock waits: more engine threads will
+   help.  Lock bound or mostly idle: go back towards the lrl value */
+static int want_sqlpool_maxt(const struct autotune_knob *k,
+                             const struct autotune_sample *s, int cur)
+{
+    if (s->adm.lockwait_ms >= AUTOTUNE_LOCKWAIT_MS ||
+        (s->adm.queue_ms == 0 && s->sqlbusy < cur / 2))
+        return clamp(k, cur - AUTOTUNE_STEP(cur));
+    if (s->adm.queue_ms >= AUTOTUNE_QUEUE_MS && !s->cpu_busy)
+        return clamp(k, cur + AUTOTUNE_STEP(cur));
+    return cur;
+}
+
+static int want_maxt(const struct autotune_knob *k,
+                     const struct autotune_sample *s, int cur)
+{
+    if (s->reqq > 0 && !s->cpu_busy &&
+        s->adm.lockwait_ms < AUTOTUNE_LOCKWAIT_MS)
+        return clamp(k, cur + AUTOTUNE_STEP(cur));
+    if (s->reqq == 0)
+        return clamp(k, cur - AUTOTUNE_STEP(cur));
+    return cur;
+}
+
+static int want_cachekb(const struct autotune_knob *k,
+                        const struct autotune_sample *s, int cur)
+{
+    int v = cur;
+
+    if (s->adm.miss_pct >= AUTOTUNE_MISS_PCT)
+        v = clamp(k, cur + AUTOTUNE_STEP(cur));
+    if (thedb->cacheszkbmax > 0 && v > thedb->cacheszkbmax)
+        v = thedb->cacheszkbmax;
+    return v > cur ? v : cur;
+}
+
+static struct autotune_knob knobs[] = {
+    {"sqlenginepool.maxt", 1, get_sqlpool_maxt, want_sqlpool_maxt},
+    {"maxt", 1, get_maxt, want_maxt},
+    {"cachekb", 0, get_cachekb, want_cachekb},
+};
+
+#define NKNOBS (sizeof(knobs) / sizeof(knobs[0]))
+
+static void autotune_persist(void)
+{
+    char path[PATH_MAX], tmp[PATH_MAX];
+    FILE *f;
+    int i;
+
+    snprintf(path, sizeof(path), "%s/%s.autotune", thedb->basedir,
+             thedb->envname);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    if ((f = fopen(tmp, "w")) == NULL) {
+        logmsg(LOGMSG_ERROR, "autotune: can't write %s\n", tmp);
+        return;
+    }
+    fprintf(f, "# autotune recommendations, epoch %d\n", comdb2_time_epoch());
+    for (i = 0; i < NKNOBS; i++) {
+        if (knobs[i].start)
+            fprintf(f, "%s %d\n", knobs[i].name, knobs[i].recommended);
+    }
+    if (fclose(f) != 0 || rename(tmp, path) != 0) {
+        logmsg(LOGMSG_ERROR, "autotune: can't write %s\n", path);
+        unlink(tmp);
+    }
+}
+
+static void autotune_decide(const struct autotune_sample *s)
+{
+    struct autotune_knob *k;
+    char val[32];
+    int changed = 0;
+    int cur, v, i;
+
+    for (i = 0; i < NKNOBS; i++) {
+        k = &knobs[i];
+        cur = k->get();
+        if (!k->start)
+            k->start = k->recommended = cur;
+        /* recommendations for what can't change live build on each other */
+        if (!k->live || !gbl_autotune_apply)
+            cur = k->recommended;
+        v = k->want(k, s, cur);
+        if (v == k->recommended)
+            continue;
+
+        logmsg(LOGMSG_USER,
+               "autotune: %s %d -> %d (queue %.1f ms, requests queued %d, "
+               "miss %.1f%%, lock waits %.1f ms/s, cpu %s)%s\n",
+               k->name, cur, v, s->adm.queue_ms, s->reqq, s->adm.miss_pct,
+               s->adm.lockwait_ms, s->cpu_busy ? "busy" : "ok",
+               (k->live && gbl_autotune_apply) ? "" : ", recommended only");
+        k->recommended = v;
+        changed = 1;
+
+        if (k->live && gbl_autotune_apply) {
+            snprintf(val, sizeof(val), "%d", v);
+            if (handle_runtime_tunable(k->name, val) != TUNABLE_ERR_OK) {
+                logmsg(LOGMSG_ERROR, "autotune: failed to set %s %s\n",
+                       k->name, val);
+                k->recommended = k->get();
+            }
+        }
+    }
+    if (changed)
+        autotune_persist();
+}
+
+void autotune_update(void)
+{
+    static struct autotune_sample s;
+    static int last;
+    int now = comdb2_time_epoch();
+    struct thdpool *pool;
+    double load;
+    long ncpu;
+    int n;
+
+    if (!gbl_autotune) {
+        last = 0;
+        return;
+    }
+    if (!last)
+        last = now;
+
+    if ((n = thd_queue_depth()) > s.reqq)
+        s.reqq = n;
+    pool = get_default_sql_pool(0);
+    if ((n = thdpool_get_nbusythds(pool)) > s.sqlbusy)
+        s.sqlbusy = n;
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu > 0 && getloadavg(&load, 1) == 1 && load >= ncpu)
+        s.cpu_busy = 1;
+
+    if (gbl_autotune_interval_secs <= 0 ||
+        now - last < gbl_autotune_interval_secs)
+        return;
+    last = now;
+
+    admission_get_stats(&s.adm);
+    autotune_decide(&s);
+    memset(&s, 0, sizeof(s));
+}
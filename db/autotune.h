@@ -0,0 +1,41 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_AUTOTUNE_H
+#define INCLUDED_AUTOTUNE_H
+
+/*
+  Auto-tuning
+
+  Opt-in with autotune.  Every autotune_interval_secs the stat thread looks
+  at the signals admission control already averages (engine pool queue time,
+  buffer pool miss rate, lock waits), the request queue and the load average,
+  and decides, for a short whitelist of tunables, whether each should move one
+  step.  A tunable never leaves [start, start * autotune_max_factor], where
+  start is the value it had when tuning began, so the lrl stays the floor.
+
+  Every recommendation is logged and the current ones are written as lrl
+  lines to <dbdir>/<dbname>.autotune.  With autotune_apply on, recommendations
+  for tunables that can change at runtime are applied the same way as
+  "put tunable"; the others (cache size) are only recommended.
+*/
+
+extern int gbl_autotune;
+
+/* Called once a second by the stat thread */
+void autotune_update(void);
+
+#endif
@@ -23,6 +23,7 @@ extern int gbl_delay_sql_lock_release_sec;
 void __berkdb_set_num_read_ios(long long *n);
 void __berkdb_set_num_write_ios(long long *n);
 void __berkdb_set_num_fsyncs(long long *n);
+void __berkdb_register_fsync_time_callback(void (*callback)(uint64_t us));
 void berk_memp_sync_alarm_ms(int);
 
 #include <pthread.h>
@@ -137,6 +138,11 @@ void berk_memp_sync_alarm_ms(int);
 #include "comdb2_query_preparer.h"
 #include <net_appsock.h>
 #include "sc_csc2.h"
+#include "admission.h"
+#include "autotune.h"
+#include "memgov.h"
+#include "profiler.h"
+#include "zonemap.h"
 
 #define tokdup strndup
 
@@ -208,6 +214,9 @@ int gbl_enque_flush_interval;
 int gbl_enque_reorder_lookahead = 20;
 int gbl_morecolumns = 0;
 int gbl_return_long_column_names = 1;
+int gbl_newsql_columnar_rows = 256;
+int gbl_newsql_max_stmt_ids = 64;
+int gbl_master_offload_reads = 0;
 int gbl_maxreclen;
 int gbl_penaltyincpercent = 20;
 int gbl_maxwthreadpenalty;
@@ -367,6 +376,7 @@ uint32_t gbl_nnewsql;
 long long gbl_nnewsql_steps;
 
 uint32_t gbl_masterrejects = 0;
+uint32_t gbl_master_read_offloads = 0;
 
 volatile uint32_t gbl_analyze_gen = 0;
 volatile int gbl_views_gen = 0;
@@ -457,6 +467,7 @@ int gbl_throttle_sql_overload_dump_sec = 5;
 int gbl_toblock_net_throttle = 0;
 
 int gbl_temptable_pool_capacity = 8192;
+int gbl_objpool_tcache = 0; /* objects kept per thread in front of pools */
 
 int gbl_ftables = 0;
 
@@ -665,6 +676,7 @@ int gbl_reorder_idx_writes = 1;
 char *gbl_recovery_options = NULL;
 
 int gbl_rcache = 0;
+int gbl_rcache_levels = 1;
 
 int gbl_noenv_messages = 1;
 
@@ -1788,6 +1800,7 @@ dbtable *newqdb(struct dbenv *env, const char *name, int avgsz, int pagesize,
 
     tbl = calloc(1, sizeof(dbtable));
     tbl->tablename = strdup(name);
+    tbl->interned_name = intern(name);
     tbl->dbenv = env;
     tbl->dbtype = isqueuedb ? DBTYPE_QUEUEDB : DBTYPE_QUEUE;
     tbl->avgitemsz = avgsz;
@@ -1796,6 +1809,7 @@ dbtable *newqdb(struct dbenv *env, const char *name, int avgsz, int pagesize,
 
     if (tbl->dbtype == DBTYPE_QUEUEDB || tbl->dbtype == DBTYPE_QUEUE) {
         Pthread_rwlock_init(&tbl->consumer_lk, NULL);
+        Pthread_mutex_init(&tbl->consumer_stats_lk, NULL);
     }
 
     return tbl;
@@ -1874,8 +1888,10 @@ void cleanup_newdb(dbtable *tbl)
         free(tbl->lua_sfuncs);
     }
 
-    if (tbl->dbtype == DBTYPE_QUEUEDB)
+    if (tbl->dbtype == DBTYPE_QUEUEDB) {
         Pthread_rwlock_destroy(&tbl->consumer_lk);
+        Pthread_mutex_destroy(&tbl->consumer_stats_lk);
+    }
 
     free(tbl);
 }
@@ -2286,6 +2302,7 @@ static int llmeta_load_tables(struct dbenv *dbenv, void *tran)
                COMDB2_STATIC_TABLE);
         dbenv->static_table.dbs_idx = -1;
         dbenv->static_table.tablename = COMDB2_STATIC_TABLE;
+        dbenv->static_table.interned_name = intern(COMDB2_STATIC_TABLE);
         dbenv->static_table.dbenv = dbenv;
         dbenv->static_table.dbtype = DBTYPE_TAGGED_TABLE;
         dbenv->static_table.handle = dbenv->bdb_env;
@@ -2642,6 +2659,12 @@ int llmeta_dump_mapping_table(struct dbenv *dbenv, const char *table, int err)
     return llmeta_dump_mapping_table_tran(NULL, dbenv, table, err);
 }
 
+static void fsync_time_callback(uint64_t us)
+{
+    if (thedb)
+        time_metric_add(thedb->fsync_time, us);
+}
+
 struct dbenv *newdbenv(char *dbname, char *lrlname)
 {
     int rc;
@@ -2762,6 +2785,18 @@ struct dbenv *newdbenv(char *dbname, char *lrlname)
     dbenv->queue_depth = time_metric_new("queue_depth");
     dbenv->concurrent_queries = time_metric_new("concurrent_queries");
     dbenv->connections = time_metric_new("connections");
+    dbenv->commit_time = time_metric_new("commit_time");
+    dbenv->repl_wait_time = time_metric_new("repl_wait_time");
+    dbenv->fsync_time = time_metric_new("fsync_time");
+
+    /* percentiles for the latencies */
+    time_metric_enable_hist(dbenv->handle_buf_queue_time);
+    time_metric_enable_hist(dbenv->sql_queue_time);
+    time_metric_enable_hist(dbenv->service_time);
+    time_metric_enable_hist(dbenv->commit_time);
+    time_metric_enable_hist(dbenv->repl_wait_time);
+    time_metric_enable_hist(dbenv->fsync_time);
+    __berkdb_register_fsync_time_callback(fsync_time_callback);
 
     return dbenv;
 }
@@ -3495,6 +3530,10 @@ static int init(int argc, char **argv)
         logmsg(LOGMSG_FATAL, "failed to initialise page compact module\n");
         return -1;
     }
+    if (logarchive_init()) {
+        logmsg(LOGMSG_FATAL, "failed to initialise log archive module\n");
+        return -1;
+    }
 
     initresourceman(NULL);
 
@@ -4836,6 +4875,10 @@ void *statthd(void *p)
             bdb_show_reptimes_compact(thedb->bdb_env);
 
 
+        admission_update();
+        autotune_update();
+        memgov_update();
+
         /* Push out old metrics */
         time_metric_purge_old(thedb->handle_buf_queue_time);
         time_metric_purge_old(thedb->sql_queue_time);
@@ -5424,7 +5467,8 @@ static void goodbye()
    TOOL(cdb2_printlog)  \
    TOOL(cdb2_stat)      \
    TOOL(cdb2_verify)    \
-   TOOL(cdb2_pgdump)
+   TOOL(cdb2_pgdump)    \
+   TOOL(cdb2_bench)
 
 #undef TOOL
 #define TOOL(x) int tool_ ##x ##_main(int argc, char *argv[]);
@@ -5586,7 +5630,13 @@ int main(int argc, char **argv)
 
     create_watchdog_thread(thedb);
     create_old_blkseq_thread(thedb);
+    if (!gbl_is_physical_replicant)
+        create_trigger_log_thread(thedb);
+    if (!gbl_is_physical_replicant)
+        create_zonemap_thread(thedb);
     create_stat_thread(thedb);
+    profiler_init();
+    fdb_schema_poll_init();
 
     /* create the offloadsql repository */
     if (!gbl_create_mode && thedb->nsiblings > 0) {
@@ -5789,6 +5839,7 @@ int rename_db(dbtable *db, const char *newname)
     /* db */
     _db_hash_del(db);
     db->tablename = (char *)newname;
+    db->interned_name = intern(newname);
     _db_hash_add(db);
 
     Pthread_rwlock_unlock(&thedb_lock);
@@ -597,10 +597,28 @@ void consumer_unlock_int(struct dbtable *db, const char *func, int line);
  * We now have different types of db (I overloaded this structure rather than
  * create a new structure because the ireq usedb concept is endemic anyway).
  */
+#define QUEUE_ACK_BUCKETS 20
+
+/* Consumer side stats of a queue, kept by the node its consumers run on */
+struct queue_consumer_stats {
+    int64_t dequeued;    /* events handed to consumers */
+    int64_t redelivered; /* of those, ones handed out again before consumed */
+    int64_t acked;       /* events consumed */
+    int64_t ack_total_ms;
+    int64_t ack_max_ms;
+    /* bucket i counts acks that took under 2^i ms; the last, the rest */
+    int64_t ack_hist[QUEUE_ACK_BUCKETS];
+    int64_t rate_sec; /* second rate_cnt is counting acks for */
+    int64_t rate_cnt;
+    int64_t rate_prev; /* acks in the second before rate_sec */
+};
+
 typedef struct dbtable {
     struct dbenv *dbenv; /*chain back to my environment*/
     char *lrlfname;
     char *tablename;
+    const char *interned_name; /* intern(tablename): never freed, so it can be
+                                  kept past the table and compared by pointer */
     char *sqlaliasname;
     struct ireq *iq; /* iq used at sc time */
 
@@ -694,6 +712,10 @@ typedef struct dbtable {
     int goose_consume_cnt;
     int goose_add_cnt;
 
+    /* consumer stats, see dbqueuedb_count_ack() */
+    pthread_mutex_t consumer_stats_lk;
+    struct queue_consumer_stats consumer_stats;
+
     /* needed for foreign table support */
     int dtastripe;
 
@@ -759,10 +781,18 @@ typedef struct dbtable {
      * every schema change (add, alter, drop, etc.) but not for fastinit */
     unsigned long long tableversion;
 
+    /* zone map of the table, and when we last looked for a newer one (see
+     * zonemap.c) */
+    struct zonemap *zonemap;
+    int zonemap_checked;
+
     /* map of tag fields for schema version to curr schema */
     unsigned int * versmap[MAXVER + 1];
     /* is tag version compatible with ondisk schema */
     uint8_t vers_compat_ondisk[MAXVER + 1];
+    /* compiled copy program from tag version to ondisk schema, NULL if the
+     * version needs a field by field conversion */
+    struct vers_plan *versplan[MAXVER + 1];
 
     /* lock for consumer list */
     pthread_rwlock_t consumer_lk;
@@ -973,6 +1003,9 @@ struct dbenv {
     struct time_metric* connections;
     struct time_metric *sql_queue_time;
     struct time_metric *handle_buf_queue_time;
+    struct time_metric *commit_time;    /* us, osql commit end to end */
+    struct time_metric *repl_wait_time; /* us, master waiting on replicants */
+    struct time_metric *fsync_time;     /* us */
     LISTC_T(struct lrl_handler) lrl_handlers;
     LISTC_T(struct message_handler) message_handlers;
 
@@ -1135,6 +1168,13 @@ typedef struct snap_uid {
     char key[MAX_SNAP_KEY_LEN]; /* cnonce */
 } snap_uid_t;
 
+/* lsn of a transaction's commit record; clients carry it to later reads so a
+ * replicant can tell when it has applied their writes */
+typedef struct commit_lsn {
+    uint32_t file;
+    uint32_t offset;
+} commit_lsn_t;
+
 enum { SNAP_UID_LENGTH = 16 + 4 + (4 * 5) + 4 + 64 };
 
 BB_COMPILE_TIME_ASSERT(snap_uid_size, sizeof(snap_uid_t) == SNAP_UID_LENGTH);
@@ -1215,6 +1255,11 @@ struct osql_target {
     SBUF2 *sb;
     int (*send)(struct osql_target *target, int usertype, void *data,
                 int datalen, int nodelay, void *tail, int tailen);
+    /* replicant side coalescing of ops, see osql_batch_send() */
+    int batch_enabled;
+    int batch_len;
+    int batch_cap;
+    uint8_t *batch;
 };
 typedef struct osql_target osql_target_t;
 
@@ -1384,6 +1429,10 @@ struct ireq {
     int reptimems;
     int timeoutms;
 
+    /* commit seqnum left for the commit ack thread (async_commit_ack) */
+    db_seqnum_type commit_ack_seqnum;
+    commit_lsn_t commit_lsn;
+
     /* more stats - number of retries done under this request */
     uint32_t retries;
 
@@ -1423,6 +1472,7 @@ struct ireq {
     unsigned sc_locked : 1;
     unsigned sc_should_abort : 1;
     unsigned sc_closed_files : 1;
+    unsigned commit_ack_deferred : 1;
 
     int sc_running;
     int comdbg_flags;
@@ -1702,6 +1752,7 @@ extern unsigned int gbl_nnewsql;
 extern long long gbl_nnewsql_steps;
 
 extern unsigned int gbl_masterrejects;
+extern unsigned int gbl_master_read_offloads;
 
 extern int gbl_selectv_rangechk;
 
@@ -1804,6 +1855,7 @@ extern int gbl_rep_process_txn_time;
 extern int gbl_deadlock_policy_override;
 
 extern int gbl_temptable_pool_capacity;
+extern int gbl_objpool_tcache;
 extern int gbl_memstat_freq;
 
 extern int gbl_forbid_datetime_truncation;
@@ -1829,6 +1881,8 @@ extern int gbl_dohsql_max_queued_kb_highwm;
 extern int gbl_dohsql_full_queue_poll_msec;
 extern int gbl_dohsql_max_threads;
 extern int gbl_dohsql_pool_thr_slack;
+extern int gbl_dohsql_agg_shards;
+extern int gbl_dohsql_remote_shards;
 extern int gbl_sockbplog;
 extern int gbl_sockbplog_sockpool;
 
@@ -2066,6 +2120,7 @@ int trans_abort_logical(struct ireq *iq, void *trans, void *blkseq, int blklen,
 int trans_wait_for_seqnum(struct ireq *iq, char *source_host,
                           db_seqnum_type *ss);
 int trans_wait_for_last_seqnum(struct ireq *iq, char *source_host);
+int trans_defer_commit_ack(struct ireq *iq, int rc);
 
 /* find context for pseudo-stable cursors */
 int get_context(struct ireq *iq, unsigned long long *context);
@@ -2263,6 +2318,7 @@ int ix_find_auxdb_by_primkey_tran(int auxdb, struct ireq *iq, void *key,
 int ix_find_by_key_tran(struct ireq *iq, void *key, int keylen, int index,
                         void *fndkey, int *fndrrn, unsigned long long *genid,
                         void *fnddta, int *fndlen, int maxlen, void *trans);
+int ix_may_exist(struct ireq *iq, int ixnum, void *key, int keylen);
 int ix_find_auxdb_by_key_tran(int auxdb, struct ireq *iq, void *key, int keylen,
                               int index, void *fndkey, int *fndrrn,
                               unsigned long long *genid, void *fnddta,
@@ -2539,6 +2595,8 @@ int lite_get_keys_auxdb(int auxdb, struct ireq *iq, void *firstkey,
 struct bdb_queue_found;
 struct bdb_queue_cursor;
 int dbq_add(struct ireq *iq, void *trans, const void *dta, size_t dtalen);
+int dbq_add_partition(struct ireq *iq, void *trans, const void *dta,
+                      size_t dtalen, int partition);
 int dbq_consume(struct ireq *iq, void *trans, int consumer,
                 const struct bdb_queue_found *fnd);
 int dbq_consume_genid(struct ireq *, void *trans, int consumer, const genid_t);
@@ -2585,6 +2643,7 @@ master_entry_t *create_master_entry_array(struct dbtable **dbs, int num_dbs,
                                           hash_t *view_hash, int *nents);
 void cleanup_sqlite_master();
 void create_sqlite_master();
+int get_sqlmaster_gen(void);
 int destroy_sqlite_master(master_entry_t *, int);
 int sql_syntax_check(struct ireq *iq, struct dbtable *db);
 void sql_dump_running_statements(void);
@@ -2681,6 +2740,10 @@ int dbqueuedb_restart_consumers(struct dbtable *db);
 int dbqueuedb_check_consumer(const char *method);
 int dbqueuedb_get_name(struct dbtable *db, char **spname);
 int dbqueuedb_get_stats(struct dbtable *db, struct consumer_stat *stats, uint32_t lockid);
+void dbqueuedb_count_dequeue(struct dbtable *db, int redelivered);
+void dbqueuedb_count_ack(struct dbtable *db, int n, int64_t latency_ms);
+int64_t dbqueuedb_get_consumer_stats(struct dbtable *db,
+                                     struct queue_consumer_stats *stats);
 
 /* Resource manager */
 void initresourceman(const char *newlrlname);
@@ -2913,6 +2976,7 @@ void watchdog_disable(void);
 void watchdog_enable(void);
 
 void create_old_blkseq_thread(struct dbenv *dbenv);
+void create_trigger_log_thread(struct dbenv *dbenv);
 void debug_traverse_data(char *tbl);
 int add_gtid(struct ireq *iq, int source_db, tranid_t id);
 int rem_gtid(struct ireq *iq, tranid_t id);
@@ -3504,6 +3568,8 @@ int table_version_set(tran_type *tran, const char *tablename,
 int sc_timepart_add_table(const char *existingTableName,
                           const char *newTableName, struct errstat *err);
 int sc_timepart_drop_table(const char *tableName, struct errstat *err);
+int sc_timepart_compress_table(const char *tableName, int compress,
+                               struct errstat *err);
 int sc_timepart_truncate_table(const char *tableName, struct errstat *err,
                                void *partition);
 
@@ -3618,6 +3684,7 @@ void init_password_cache();
 void destroy_password_cache();
 
 extern int gbl_rcache;
+extern int gbl_rcache_levels;
 extern int gbl_throttle_txn_chunks_msec;
 extern int gbl_sql_release_locks_on_slow_reader;
 extern int gbl_fail_client_write_lock;
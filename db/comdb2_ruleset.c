@@ -16,14 +16,19 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stddef.h>
 #include <unistd.h>
 #include "sqliteInt.h"
 #include "sql.h"
 #include "comdb2_atomic.h"
 #include "comdb2_ruleset.h"
+#include "thdpool.h"
 #include "logmsg.h"
 #include "sbuf2.h"
 #include "tohex.h"
+#include "plhash.h"
+#include "locks_wrap.h"
 
 #define RULESET_MIN_BUF   (300)
 #define RULESET_MAX_BUF   (8192)
@@ -49,6 +54,31 @@ extern void re_free(void*);
 
 static uint64_t gbl_ruleset_generation = 0;
 
+/*
+** Every criterion but "sql" is a property of the client (origin host, task,
+** user) or of the fingerprint, so the result of evaluating a ruleset that
+** does not match on SQL text only depends on those.  Results are cached by
+** that tuple, along with which rules were evaluated and matched so that
+** their counters keep counting.  Loading rules into the ruleset or
+** enabling/disabling one clears the cache.
+*/
+int gbl_ruleset_cache_size = 1024;
+
+struct ruleset_cache_entry {
+  char *zKey;                     /* Client tuple, see ruleset_cache_key() */
+  struct ruleset_result result;
+  size_t count;                   /* What comdb2_evaluate_ruleset() returned */
+  int iEnd;                       /* Rules evaluated were aRule[0..iEnd) */
+  int nMatch;
+  int *aMatch;                    /* Index of the rules that matched */
+};
+
+struct ruleset_cache {
+  pthread_mutex_t mu;
+  hash_t *h;
+  int bNoCache;                   /* Some rule matches on SQL text */
+};
+
 static int glob_match(
   const char *zStr1,
   const char *zStr2
@@ -336,6 +366,17 @@ static void comdb2_dump_ruleset_item(
          zFingerprint, rule->evalCount, rule->matchCount);
 }
 
+static void comdb2_ruleset_item_matched(
+  struct ruleset *rules,
+  struct ruleset_item *rule
+){
+  rule->matchCount++;
+  loglvl level = (rule->flags&RULESET_F_PRINT) ? LOGMSG_USER : LOGMSG_DEBUG;
+  if( logmsg_level_ok(level) ){
+    comdb2_dump_ruleset_item(level,"MATCHED",rules,rule);
+  }
+}
+
 static ruleset_match_t comdb2_evaluate_ruleset_item(
   xStrCmp stringComparer,
   struct ruleset *rules,
@@ -457,6 +498,9 @@ static ruleset_match_t comdb2_evaluate_ruleset_item(
       break;
     }
   }
+  if( rule->priorityClass!=0 ){
+    result->priorityClass = rule->priorityClass;
+  }
   /*
   ** NOTE: If we get to this point, it is for one of the following reasons:
   **
@@ -465,11 +509,7 @@ static ruleset_match_t comdb2_evaluate_ruleset_item(
   **
   **       2. This rule matched using the specified mode and all criteria.
   */
-  rule->matchCount++;
-  loglvl level = (rule->flags&RULESET_F_PRINT) ? LOGMSG_USER : LOGMSG_DEBUG;
-  if( logmsg_level_ok(level) ){
-    comdb2_dump_ruleset_item(level,"MATCHED",rules,rule);
-  }
+  comdb2_ruleset_item_matched(rules, rule);
   result->flags |= rule->flags; /* NOTE: OR matched rule flags together. */
   return (rule->flags&RULESET_F_STOP) ? RULESET_M_STOP : RULESET_M_TRUE;
 }
@@ -487,6 +527,165 @@ int comdb2_ruleset_fingerprints_allowed(void){
   return gbl_strict_dbl_quotes;
 }
 
+static int ruleset_cache_free_entry(void *obj, void *arg){
+  struct ruleset_cache_entry *pEntry = obj;
+  free(pEntry->zKey);
+  free(pEntry->result.zPool);
+  free(pEntry->aMatch);
+  free(pEntry);
+  return 0;
+}
+
+static struct ruleset_cache *ruleset_cache_new(void){
+  struct ruleset_cache *pCache = calloc(1, sizeof(struct ruleset_cache));
+  if( pCache==NULL ) return NULL;
+  pCache->h = hash_init_strptr(offsetof(struct ruleset_cache_entry, zKey));
+  if( pCache->h==NULL ){
+    free(pCache);
+    return NULL;
+  }
+  Pthread_mutex_init(&pCache->mu, NULL);
+  pCache->bNoCache = -1;
+  return pCache;
+}
+
+/* NOTE: Caller must hold pCache->mu, if the cache is shared. */
+static void ruleset_cache_clear_locked(struct ruleset_cache *pCache){
+  hash_for(pCache->h, ruleset_cache_free_entry, NULL);
+  hash_clear(pCache->h);
+  pCache->bNoCache = -1; /* NOTE: Rules may have changed, check again. */
+}
+
+static void ruleset_cache_clear(struct ruleset *rules){
+  struct ruleset_cache *pCache = rules->pCache;
+  if( pCache==NULL ) return;
+  Pthread_mutex_lock(&pCache->mu);
+  ruleset_cache_clear_locked(pCache);
+  Pthread_mutex_unlock(&pCache->mu);
+}
+
+static void ruleset_cache_free(struct ruleset_cache *pCache){
+  if( pCache==NULL ) return;
+  ruleset_cache_clear_locked(pCache);
+  hash_free(pCache->h);
+  Pthread_mutex_destroy(&pCache->mu);
+  free(pCache);
+}
+
+/*
+** Returns the cache key for the context, which the caller must free with
+** sqlite3_free(), or NULL if results for it can't be cached.
+*/
+static char *ruleset_cache_key(
+  struct ruleset *rules,
+  struct ruleset_item_criteria *context
+){
+  char zFingerprint[FPSZ*2+1]; /* 0123456789ABCDEF0123456789ABCDEF\0 */
+
+  if( rules->pCache==NULL || gbl_ruleset_cache_size<=0 ) return NULL;
+  memset(zFingerprint, 0, sizeof(zFingerprint));
+  if( context->pFingerprint!=NULL ){
+    util_tohex(zFingerprint, (char *)context->pFingerprint, FPSZ);
+  }
+  /* NOTE: Length prefixes keep NULL, empty and separators unambiguous. */
+  return sqlite3_mprintf("%d:%s%d:%s%d:%s%s:%d",
+      context->zOriginHost ? (int)strlen(context->zOriginHost) : -1,
+      context->zOriginHost ? context->zOriginHost : "",
+      context->zOriginTask ? (int)strlen(context->zOriginTask) : -1,
+      context->zOriginTask ? context->zOriginTask : "",
+      context->zUser ? (int)strlen(context->zUser) : -1,
+      context->zUser ? context->zUser : "",
+      zFingerprint, comdb2_ruleset_fingerprints_allowed());
+}
+
+/*
+** If the result for zKey is cached, count the rules it evaluated and
+** matched as if they had been, copy it to result, and return 1.
+*/
+static int ruleset_cache_find(
+  struct ruleset *rules,
+  const char *zKey,
+  struct ruleset_result *result,
+  size_t *pCount
+){
+  struct ruleset_cache *pCache = rules->pCache;
+  struct ruleset_cache_entry *pEntry;
+  int found = 0;
+
+  Pthread_mutex_lock(&pCache->mu);
+  if( pCache->bNoCache==-1 ){
+    pCache->bNoCache = 0;
+    for(int i=0; i<rules->nRule; i++){
+      if( rules->aRule[i].ruleNo!=0 && rules->aRule[i].criteria.zSql!=NULL ){
+        pCache->bNoCache = 1;
+        break;
+      }
+    }
+  }
+  if( pCache->bNoCache ){
+    found = -1;
+  }else if( (pEntry = hash_find(pCache->h, &zKey))!=NULL ){
+    for(int i=0; i<pEntry->iEnd; i++){
+      struct ruleset_item *rule = &rules->aRule[i];
+      if( rule->ruleNo==0 ){ continue; }
+      if( rule->flags&RULESET_F_DISABLE ){ continue; }
+      rule->evalCount++;
+    }
+    for(int i=0; i<pEntry->nMatch; i++){
+      comdb2_ruleset_item_matched(rules, &rules->aRule[pEntry->aMatch[i]]);
+    }
+    *result = pEntry->result;
+    if( result->zPool!=NULL ) result->zPool = strdup(result->zPool);
+    *pCount = pEntry->count;
+    found = 1;
+  }
+  Pthread_mutex_unlock(&pCache->mu);
+  return found;
+}
+
+/* NOTE: Takes ownership of aMatch. */
+static void ruleset_cache_add(
+  struct ruleset *rules,
+  const char *zKey,
+  const struct ruleset_result *result,
+  size_t count,
+  int iEnd,
+  int nMatch,
+  int *aMatch
+){
+  struct ruleset_cache *pCache = rules->pCache;
+  struct ruleset_cache_entry *pEntry;
+
+  pEntry = calloc(1, sizeof(struct ruleset_cache_entry));
+  if( pEntry==NULL ){
+    free(aMatch);
+    return;
+  }
+  pEntry->zKey = strdup(zKey);
+  pEntry->result = *result;
+  pEntry->result.zPool = result->zPool ? strdup(result->zPool) : NULL;
+  pEntry->count = count;
+  pEntry->iEnd = iEnd;
+  pEntry->nMatch = nMatch;
+  pEntry->aMatch = aMatch;
+  if( pEntry->zKey==NULL || (result->zPool && pEntry->result.zPool==NULL) ){
+    ruleset_cache_free_entry(pEntry, NULL);
+    return;
+  }
+
+  Pthread_mutex_lock(&pCache->mu);
+  if( hash_find(pCache->h, &zKey)!=NULL ){
+    ruleset_cache_free_entry(pEntry, NULL); /* NOTE: Raced, already there. */
+  }else{
+    if( hash_get_num_entries(pCache->h)>=gbl_ruleset_cache_size ){
+      ruleset_cache_clear_locked(pCache);
+      pCache->bNoCache = 0; /* NOTE: Rules did not change. */
+    }
+    hash_add(pCache->h, pEntry);
+  }
+  Pthread_mutex_unlock(&pCache->mu);
+}
+
 size_t comdb2_evaluate_ruleset(
   xStrCmp stringComparer,
   struct ruleset *rules,
@@ -495,7 +694,25 @@ size_t comdb2_evaluate_ruleset(
 ){
   size_t count = 0;
   if( rules!=NULL ){
-    for(int i=0; i<rules->nRule; i++){
+    char *zKey = NULL;
+    int *aMatch = NULL;
+    int nMatch = 0;
+    int bError = 0;
+    int i;
+    if( stringComparer==NULL ){
+      zKey = ruleset_cache_key(rules, context);
+      if( zKey!=NULL ){
+        int found = ruleset_cache_find(rules, zKey, result, &count);
+        if( found!=0 ){
+          sqlite3_free(zKey);
+          if( found==1 ) return count;
+          zKey = NULL;
+        }else{
+          aMatch = malloc(rules->nRule * sizeof(int));
+        }
+      }
+    }
+    for(i=0; i<rules->nRule; i++){
       struct ruleset_item *rule = &rules->aRule[i];
       if( rule->ruleNo==0 ){ continue; }
       if( rule->flags&RULESET_F_DISABLE ){ continue; }
@@ -505,11 +722,26 @@ size_t comdb2_evaluate_ruleset(
       if( match==RULESET_M_ERROR ){
         /* HACK: Invalidate current ruleset result if error. */
         memset(result, 0, sizeof(struct ruleset_result));
+        bError = 1;
+        break;
+      }
+      if( match==RULESET_M_STOP ){
+        count++;
+        if( aMatch!=NULL ) aMatch[nMatch++] = i;
+        i++;
         break;
       }
-      if( match==RULESET_M_STOP ){ count++; break; }
-      if( match==RULESET_M_TRUE ){ count++; }
+      if( match==RULESET_M_TRUE ){
+        count++;
+        if( aMatch!=NULL ) aMatch[nMatch++] = i;
+      }
+    }
+    if( aMatch!=NULL && !bError ){
+      ruleset_cache_add(rules, zKey, result, count, i, nMatch, aMatch);
+    }else{
+      free(aMatch);
     }
+    sqlite3_free(zKey);
   }
   return count;
 }
@@ -520,7 +752,7 @@ size_t comdb2_ruleset_result_to_str(
   size_t nBuf
 ){
   char zBuf2[RULESET_MIN_BUF] = {0};
-  return (size_t)snprintf(zBuf, nBuf,
+  size_t n = (size_t)snprintf(zBuf, nBuf,
       "ruleNo=%d, action=%s, flags=%s (0x%llX), pool=%s",
       result->ruleNo,
       comdb2_ruleset_action_to_str(result->action, NULL, 0, 1),
@@ -528,6 +760,10 @@ size_t comdb2_ruleset_result_to_str(
       (unsigned long long int)result->flags,
       result->zPool ? result->zPool : "<null>"
   );
+  if( result->priorityClass!=0 && n<nBuf ){
+    n += (size_t)snprintf(zBuf+n, nBuf-n, ", class=%d", result->priorityClass);
+  }
+  return n;
 }
 
 static int blob_string_to_fingerprint(
@@ -569,6 +805,7 @@ int comdb2_enable_ruleset_item(
   }else{
     rule->flags |= RULESET_F_DISABLE;
   }
+  ruleset_cache_clear(rules);
   return 0;
 }
 
@@ -909,6 +1146,7 @@ static void comdb2_free_ruleset_int(
     free(rules->aRule);
     rules->aRule = NULL;
   }
+  ruleset_cache_free(rules->pCache);
   free(rules);
 }
 
@@ -988,6 +1226,7 @@ int comdb2_load_ruleset(
              zFileName, lineNo, sizeof(struct ruleset));
     goto failure;
   }
+  rules->pCache = ruleset_cache_new(); /* NOTE: Optional, may be NULL. */
   fd = open(zFileName, O_RDONLY);
   if( fd==-1 ){
     snprintf(zError, sizeof(zError), "%s:%d, open (read) failed errno=%d",
@@ -1133,6 +1372,39 @@ int comdb2_load_ruleset(
             zTok = strtok_r(NULL, RULESET_DELIM, &zSav);
             continue;
           }
+          zField = "class";
+          if( sqlite3_stricmp(zTok, zField)==0 ){
+            if( rules->version<2 ){
+              snprintf(zError, sizeof(zError),
+                       "%s:%d, version %lld does not support classes",
+                       zFileName, lineNo, rules->version);
+              goto failure;
+            }
+            zTok = strtok_r(NULL, RULESET_DELIM, &zSav);
+            if( zTok==NULL ){
+              snprintf(zError, sizeof(zError),
+                       "%s:%d, expected %s value after '%s'",
+                       zFileName, lineNo, zField, zField);
+              goto failure;
+            }
+            i64 iClass = 0;
+            if( sqlite3Atoi64(zTok, &iClass, strlen(zTok), SQLITE_UTF8)!=0 ){
+              snprintf(zError, sizeof(zError),
+                       "%s:%d, bad %s value '%s', not an integer",
+                       zFileName, lineNo, zField, zTok);
+              goto failure;
+            }
+            if( iClass<1 || iClass>=THDPOOL_MAX_CLASSES ){
+              snprintf(zError, sizeof(zError),
+                       "%s:%d, bad %s value '%s', must be between 1 and %d",
+                       zFileName, lineNo, zField, zTok,
+                       THDPOOL_MAX_CLASSES-1);
+              goto failure;
+            }
+            rule->priorityClass = (int)iClass;
+            zTok = strtok_r(NULL, RULESET_DELIM, &zSav);
+            continue;
+          }
           zField = "flags";
           if( sqlite3_stricmp(zTok, zField)==0 ){
             zTok = strtok_r(NULL, RULESET_TEXT_DELIM, &zSav);
@@ -1340,6 +1612,7 @@ int comdb2_load_ruleset(
       goto failure;
     }
     comdb2_free_ruleset_int(rules);
+    ruleset_cache_clear(*pRules);
   }else{
     *pRules = rules;
   }
@@ -1407,6 +1680,10 @@ int comdb2_save_ruleset(
       if( i>0 && mayNeedLf ){ sbuf2printf(sb, "\n"); mayNeedLf = 0; }
       sbuf2printf(sb, "rule %d pool %s\n", ruleNo, rule->zPool);
     }
+    if( rules->version>=2 && rule->priorityClass!=0 ){
+      if( i>0 && mayNeedLf ){ sbuf2printf(sb, "\n"); mayNeedLf = 0; }
+      sbuf2printf(sb, "rule %d class %d\n", ruleNo, rule->priorityClass);
+    }
     if( rule->flags!=RULESET_F_NONE ){
       memset(zBuf, 0, sizeof(zBuf));
       comdb2_ruleset_flags_to_str(rule->flags, zBuf, sizeof(zBuf));
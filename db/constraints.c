@@ -640,6 +640,46 @@ int check_update_constraints(struct ireq *iq, void *trans,
 
 /* FOR UPDATES/DELETES, MUST VERIFY AGAINST DELETED RECORD'S TABLE TO SEE IF
  * THERE'RE ANY  KEYS WITH SAME VALUE.  IT IS OK TO DELETE IF THATS THE CASE */
+/* Walk a constraint list once and queue prefaults for the pages the
+ * deferred passes are about to read, so the io threads bring them in in
+ * parallel instead of each check missing on them one at a time.  For the
+ * add list these are the new rows that deferred keys and parent keys are
+ * formed from; for the del list, the referencing keys in child tables. */
+int gbl_prefault_constraints = 0;
+
+static void prefault_constraint_table(void *table, int is_del)
+{
+    unsigned long long last_genid = 0ULL;
+    int rc, err = 0, nqueued = 0;
+    void *cur;
+
+    if (table == NULL || (cur = get_constraint_table_cursor(table)) == NULL)
+        return;
+
+    rc = bdb_temp_table_first(thedb->bdb_env, cur, &err);
+    while (rc == 0 && nqueued < thedb->prefaultiopool.maxq) {
+        cte *ctrq = (cte *)bdb_temp_table_data(cur);
+        if (ctrq == NULL)
+            break;
+        if (is_del) {
+            struct backward_ct *bct = &ctrq->ctop.bwdct;
+            struct dbtable *db = get_dbtable_by_name(bct->tablename);
+            if (db && enque_pfault_oldkey(db, bct->key, bct->sixlen,
+                                          bct->sixnum, 0, -1, 0, 0, 1, 0) == 0)
+                nqueued++;
+        } else {
+            struct forward_ct *curop = &ctrq->ctop.fwdct;
+            if (curop->genid != last_genid &&
+                enque_pfault_olddata(curop->usedb, curop->genid, 0, -1, 0, 0,
+                                     1, 0) == 0)
+                nqueued++;
+            last_genid = curop->genid;
+        }
+        rc = bdb_temp_table_next(thedb->bdb_env, cur, &err);
+    }
+    close_constraint_table_cursor(cur);
+}
+
 int verify_del_constraints(struct ireq *iq, void *trans, int *errout)
 {
     int rc = 0, fndrrn = 0, err = 0;
@@ -1173,6 +1213,11 @@ int delayed_key_adds(struct ireq *iq, void *trans, int *blkpos, int *ixout,
         return ERR_INTERNAL;
     }
 
+    if (gbl_prefault_constraints && thedb->prefaultiopool.numthreads > 0) {
+        prefault_constraint_table(thdinfo->ct_add_table, 0);
+        prefault_constraint_table(thdinfo->ct_del_table, 1);
+    }
+
     void *cur = get_constraint_table_cursor(thdinfo->ct_add_table);
     if (cur == NULL) {
         if (iq->debug)
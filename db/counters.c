@@ -0,0 +1,285 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+  Commutative counter updates
+
+  "UPDATE t SET c = c + ?" on a hot row sends the master the row genid the
+  replicant read and the whole new image.  When a concurrent transaction
+  commits first that genid is gone, upd_record fails with ERR_VERIFY and the
+  replicant retries the statement, so a hot counter serialises on full round
+  trips, not just on its row lock.
+
+  Columns listed in counter_columns ("table.column,...", integers only) can
+  be treated as commutative.  The replicant decides per statement: in the
+  updCols it sends, it tags UPDCOL_DELTA the counter columns the statement
+  sets to "c + expr" or "c - expr", where expr reads nothing from the row,
+  and only if its WHERE clause reads no counter column (see
+  tagCounterDeltas in sqlite/src/update.c).  An absolute "SET c = 5", or a
+  guarded "SET c = c - 1 WHERE c > 0", is never tagged and keeps failing
+  with ERR_VERIFY when the row moved under it.
+
+  For tables that have counter columns, the master keeps the
+  images of recently replaced row versions, keyed by the genid they had, with
+  the genid that replaced them.  An update that finds its genid gone looks up
+  the image it was computed against; if every column that differs is tagged, it
+  follows the chain to the current version, locks it, and applies the same
+  deltas to it.  Each transaction still gets its own physical update, but
+  they queue on the row lock instead of failing back to the replicant.
+
+  A version image never changes once written, so an entry left behind by a
+  transaction that aborted is still right; its successor genid just won't
+  load and we fall back to the verify error.
+*/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "comdb2.h"
+#include "counters.h"
+#include "types.h"
+#include "flibc.h"
+#include <plhash.h>
+#include <list.h>
+#include "logmsg.h"
+
+char *gbl_counter_columns = NULL;
+int gbl_counter_image_cache = 10000;
+
+/* how far we follow replaced versions before giving up */
+#define COUNTER_MAX_CHAIN 64
+
+struct counter_image {
+    unsigned long long genid; /* version this is the image of */
+    unsigned long long next;  /* version that replaced it */
+    const struct dbtable *tbl;
+    int version; /* table schema version the image was written in */
+    int len;
+    LINKC_T(struct counter_image) lnk;
+    char dta[1];
+};
+
+static pthread_mutex_t lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *images;
+static LISTC_T(struct counter_image) fifo;
+
+/* Is "tbl.col" (or any column of tbl if col is NULL) listed? */
+static int listed(const char *tbl, const char *col)
+{
+    const char *p = gbl_counter_columns;
+    size_t tlen = strlen(tbl);
+    size_t clen = col ? strlen(col) : 0;
+
+    while (p && *p) {
+        const char *end = strchr(p, ',');
+        const char *dot;
+        if (end == NULL)
+            end = p + strlen(p);
+        dot = memchr(p, '.', end - p);
+        if (dot && dot - p == tlen && strncasecmp(p, tbl, tlen) == 0 &&
+            (col == NULL ||
+             (end - dot - 1 == clen && strncasecmp(dot + 1, col, clen) == 0)))
+            return 1;
+        p = *end ? end + 1 : end;
+    }
+    return 0;
+}
+
+int counter_table_name(const char *table)
+{
+    if (gbl_counter_columns == NULL || gbl_counter_image_cache <= 0)
+        return 0;
+    return listed(table, NULL);
+}
+
+int counter_table(const struct dbtable *tbl)
+{
+    return counter_table_name(tbl->tablename);
+}
+
+int counter_column(const char *table, const char *column)
+{
+    if (gbl_counter_columns == NULL)
+        return 0;
+    return listed(table, column);
+}
+
+void counter_remember(const struct dbtable *tbl, unsigned long long genid,
+                      unsigned long long newgenid, const void *dta, int len)
+{
+    struct counter_image *img, *old;
+
+    img = malloc(offsetof(struct counter_image, dta) + len);
+    if (img == NULL)
+        return;
+    img->genid = genid;
+    img->next = newgenid;
+    img->tbl = tbl;
+    img->version = tbl->schema_version;
+    img->len = len;
+    memcpy(img->dta, dta, len);
+
+    Pthread_mutex_lock(&lk);
+    if (images == NULL) {
+        images = hash_init_o(offsetof(struct counter_image, genid),
+                             sizeof(unsigned long long));
+        listc_init(&fifo, offsetof(struct counter_image, lnk));
+    }
+    /* a retry after an abort replaces the same version again */
+    if ((old = hash_find(images, &genid)) != NULL) {
+        hash_del(images, old);
+        listc_rfl(&fifo, old);
+        free(old);
+    }
+    hash_add(images, img);
+    listc_abl(&fifo, img);
+    while (fifo.count > gbl_counter_image_cache) {
+        old = listc_rtl(&fifo);
+        hash_del(images, old);
+        free(old);
+    }
+    Pthread_mutex_unlock(&lk);
+}
+
+/* Copy the image of "genid" into dta and return the newest version we know
+ * replaced it, or 0 if we don't have it */
+static unsigned long long find_image(const struct dbtable *tbl,
+                                     unsigned long long genid, void *dta,
+                                     int len)
+{
+    struct counter_image *img;
+    unsigned long long next = 0;
+
+    Pthread_mutex_lock(&lk);
+    if (images && (img = hash_find(images, &genid)) != NULL &&
+        img->tbl == tbl && img->version == tbl->schema_version &&
+        img->len == len) {
+        memcpy(dta, img->dta, len);
+        next = img->next;
+    }
+    Pthread_mutex_unlock(&lk);
+    return next;
+}
+
+/* Follow replaced versions from genid to the newest one we know of */
+static unsigned long long newest(unsigned long long genid)
+{
+    struct counter_image *img;
+    int i;
+
+    Pthread_mutex_lock(&lk);
+    for (i = 0; images && i < COUNTER_MAX_CHAIN; i++) {
+        if ((img = hash_find(images, &genid)) == NULL)
+            break;
+        genid = img->next;
+    }
+    Pthread_mutex_unlock(&lk);
+    return genid;
+}
+
+static int get_counter(const struct field *f, const uint8_t *p, int64_t *v)
+{
+    int64_t be;
+    int isnull, outsz;
+
+    if (SERVER_BINT_to_CLIENT_INT(p, f->len, NULL, NULL, &be, sizeof(be),
+                                  &isnull, &outsz, NULL, NULL) ||
+        isnull)
+        return -1;
+    *v = flibc_ntohll(be);
+    return 0;
+}
+
+static int put_counter(const struct field *f, int64_t v, uint8_t *p)
+{
+    int64_t be = flibc_htonll(v);
+    int outsz;
+
+    return CLIENT_INT_to_SERVER_BINT(&be, sizeof(be), 0, NULL, NULL, p,
+                                     f->len, &outsz, NULL, NULL);
+}
+
+int counter_rebase(struct ireq *iq, void *trans, int rrn,
+                   unsigned long long genid, const void *rec,
+                   const int *updCols, void *newdta, void *curdta, int len,
+                   unsigned long long *curgenid)
+{
+    struct dbtable *tbl = iq->usedb;
+    struct schema *s = get_schema(tbl, -1);
+    const uint8_t *base_rec, *new_rec = rec;
+    uint8_t *base, *cur = curdta, *out = newdta;
+    unsigned long long g;
+    int i, rc, fndlen;
+
+    /* the replicant computed blob, partial and expression keys against the
+     * version it read; we can't redo those here */
+    if (tbl->numblobs || tbl->ix_partial || tbl->ix_expr)
+        return -1;
+    /* the replicant tags, column by column, what it knows to be a delta */
+    if (updCols == NULL || updCols[0] != s->nmembers)
+        return -1;
+    /* snapshot and serializable must see the conflict */
+    if (iq->sorese && (iq->sorese->type == OSQL_SNAPISOL_REQ ||
+                       iq->sorese->type == OSQL_SERIAL_REQ))
+        return -1;
+
+    base = alloca(len);
+    if ((g = find_image(tbl, genid, base, len)) == 0)
+        return -1;
+    base_rec = base;
+
+    for (i = 0; i < COUNTER_MAX_CHAIN; i++) {
+        g = newest(g);
+        rc = ix_load_for_write_by_genid_tran(iq, rrn, g, curdta, &fndlen, len,
+                                             trans);
+        if (rc == RC_INTERNAL_RETRY)
+            return rc;
+        if (rc == 0 && fndlen == len)
+            break;
+        /* replaced while we walked; go again if we learnt of a newer one */
+        if (newest(g) == g)
+            return -1;
+    }
+    if (i == COUNTER_MAX_CHAIN)
+        return -1;
+
+    memcpy(out, cur, len);
+    for (i = 0; i < s->nmembers; i++) {
+        const struct field *f = &s->member[i];
+        int64_t a, b, c, v;
+
+        if (memcmp(base_rec + f->offset, new_rec + f->offset, f->len) == 0)
+            continue;
+        if (updCols[i + 1] != UPDCOL_DELTA || f->type != SERVER_BINT ||
+            !listed(tbl->tablename, f->name))
+            return -1;
+        if (get_counter(f, base_rec + f->offset, &a) ||
+            get_counter(f, new_rec + f->offset, &b) ||
+            get_counter(f, cur + f->offset, &c))
+            return -1;
+        if (__builtin_sub_overflow(b, a, &v) ||
+            __builtin_add_overflow(c, v, &v) ||
+            put_counter(f, v, out + f->offset))
+            return -1;
+    }
+
+    if (iq->debug)
+        reqprintf(iq, "COUNTER REBASE GENID 0x%llx -> 0x%llx", genid, g);
+    *curgenid = g;
+    return 0;
+}
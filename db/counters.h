@@ -0,0 +1,49 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef _COUNTERS_H_
+#define _COUNTERS_H_
+
+#include "comdb2.h"
+
+/* updCols value the replicant sets for a counter column that the update
+ * moves by "c = c + expr" or "c = c - expr", with a WHERE clause that reads
+ * no counter column.  Any value but -1 means the column changed. */
+#define UPDCOL_DELTA -2
+
+/* Does this table have any columns listed in counter_columns? */
+int counter_table(const struct dbtable *tbl);
+int counter_table_name(const char *table);
+
+/* Is table.column listed in counter_columns? */
+int counter_column(const char *table, const char *column);
+
+/* Remember the image of row version "genid", replaced by "newgenid" */
+void counter_remember(const struct dbtable *tbl, unsigned long long genid,
+                      unsigned long long newgenid, const void *dta, int len);
+
+/* An update of row version "genid" found it gone.  If the only columns it
+ * changes are counters that "updCols" tags UPDCOL_DELTA, load the current
+ * version for write into "curdta", form in "newdta" the current row plus the
+ * update's deltas, and return 0 with the current genid in "*curgenid".
+ * Returns -1 if the update cannot be rebased, or RC_INTERNAL_RETRY on
+ * deadlock. */
+int counter_rebase(struct ireq *iq, void *trans, int rrn,
+                   unsigned long long genid, const void *rec,
+                   const int *updCols, void *newdta, void *curdta, int len,
+                   unsigned long long *curgenid);
+
+#endif
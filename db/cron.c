@@ -16,6 +16,7 @@
 
 #include "cron.h"
 #include "cron_systable.h"
+#include "thdpool.h"
 
 /**
  * Primitive cron job that monitors a ordered list of epoch marked events,
@@ -28,9 +29,10 @@ struct cron_sched {
     pthread_t tid; /* pthread id of the thread owning this cron structure */
     pthread_cond_t cond; /* locking and signaling */
     pthread_mutex_t mtx;
-    int running; /* marked under mtx lock, signaling a event processing if set
+    int running; /* marked under mtx lock, number of events being processed
                   */
-    LISTC_T(struct cron_event) events; /* list of events */
+    LISTC_T(struct cron_event) events;   /* list of events */
+    LISTC_T(struct cron_event) inflight; /* events handed to cron_pool */
     LINKC_T(struct cron_sched) lnk;    /* link the cron schedulers */
     sched_if_t impl;
 };
@@ -43,6 +45,12 @@ typedef struct cron_scheds {
 static cron_scheds_t crons;
 pthread_mutex_t _crons_mtx = PTHREAD_MUTEX_INITIALIZER;
 
+/* max events of one scheduler running at once; 1 runs them in order on the
+   scheduler thread, more hands due events to cron_pool so that a slow event
+   does not hold back unrelated ones */
+int gbl_cron_event_concurrency = 1;
+static struct thdpool *cron_pool;
+
 static void *_cron_runner(void *arg);
 static int _queue_event(cron_sched_t *sched, int epoch, FCRON func, void *arg1,
                         void *arg2, void *arg3, void *arg4, uuid_t *source_id,
@@ -81,6 +89,7 @@ cron_sched_t *cron_add_event(cron_sched_t *sched, const char *name, int epoch,
         Pthread_mutex_init(&sched->mtx, NULL);
         Pthread_cond_init(&sched->cond, NULL);
         listc_init(&sched->events, offsetof(struct cron_event, lnk));
+        listc_init(&sched->inflight, offsetof(struct cron_event, lnk));
         if (!impl) {
             /* default to a time based cron */
             time_cron_create(&sched->impl, NULL, NULL);
@@ -221,9 +230,8 @@ static int _queue_event(cron_sched_t *sched, int epoch, FCRON func, void *arg1,
     return err->errval = CRON_NOERR;
 }
 
-static void _destroy_event(cron_sched_t *sched, cron_event_t *event)
+static void _free_event(cron_event_t *event)
 {
-    listc_rfl(&sched->events, event);
     if (event->arg1)
         free(event->arg1);
     if (event->arg2)
@@ -235,6 +243,162 @@ static void _destroy_event(cron_sched_t *sched, cron_event_t *event)
     free(event);
 }
 
+static void _destroy_event(cron_sched_t *sched, cron_event_t *event)
+{
+    listc_rfl(&sched->events, event);
+    _free_event(event);
+}
+
+static void _log_event_error(cron_sched_t *sched, cron_event_t *event,
+                             struct errstat *xerr)
+{
+    if (xerr->errval)
+        logmsg(LOGMSG_ERROR, "Schedule %s error event %d rc=%d errstr=%s\n",
+               (sched->impl.name) ? sched->impl.name : "(noname)",
+               event->epoch, xerr->errval, xerr->errstr);
+}
+
+static struct thdpool *_get_cron_pool(void)
+{
+    Pthread_mutex_lock(&_crons_mtx);
+    if (!cron_pool) {
+        cron_pool = thdpool_create("cronpool", 0);
+        if (cron_pool) {
+            if (!gbl_exit_on_pthread_create_fail)
+                thdpool_unset_exit(cron_pool);
+            thdpool_set_minthds(cron_pool, 0);
+            thdpool_set_maxthds(cron_pool, 0);
+            thdpool_set_linger(cron_pool, 30);
+            thdpool_set_longwaitms(cron_pool, 1000000);
+            thdpool_set_maxqueue(cron_pool, 1000);
+        }
+    }
+    Pthread_mutex_unlock(&_crons_mtx);
+    return cron_pool;
+}
+
+static void _cron_pool_run(struct thdpool *pool, void *work, void *thddata,
+                           int op)
+{
+    cron_event_t *event = (cron_event_t *)work;
+    cron_sched_t *sched = event->schedif->sched;
+    struct errstat xerr = {0};
+
+    if (op == THD_RUN)
+        event->func(event, &xerr);
+
+    Pthread_mutex_lock(&sched->mtx);
+    sched->running--;
+    _log_event_error(sched, event, &xerr);
+    listc_rfl(&sched->inflight, event);
+    _free_event(event);
+    /* wake the scheduler and anyone in cron_lock */
+    Pthread_cond_broadcast(&sched->cond);
+    Pthread_mutex_unlock(&sched->mtx);
+}
+
+/* Events from the same source run in the order they were scheduled */
+static int _source_inflight(cron_sched_t *sched, cron_event_t *event)
+{
+    cron_event_t *crt;
+
+    if (comdb2uuid_is_zero(event->source_id))
+        return 0;
+    LISTC_FOR_EACH(&sched->inflight, crt, lnk)
+    {
+        if (comdb2uuidcmp(crt->source_id, event->source_id) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * Hand all due events to cron_pool, up to gbl_cron_event_concurrency at once.
+ * Called with sched->mtx held. Returns the event to sleep until, or NULL if
+ * there is none or a due event has to wait for a running one to finish
+ *
+ */
+static cron_event_t *_dispatch_events(cron_sched_t *sched)
+{
+    struct thdpool *pool = _get_cron_pool();
+    cron_event_t *event, *next;
+    struct errstat xerr;
+
+    event = sched->events.top;
+    while (event && sched->impl.is_exec_time(&sched->impl, event)) {
+        next = event->lnk.next;
+
+        if (sched->running >= gbl_cron_event_concurrency) {
+            return NULL;
+        }
+        if (_source_inflight(sched, event)) {
+            /* checked again once the running one finishes */
+            return NULL;
+        }
+
+        listc_rfl(&sched->events, event);
+        listc_abl(&sched->inflight, event);
+        sched->running++;
+
+        if (!pool || thdpool_enqueue(pool, _cron_pool_run, event, 0, NULL, 0)) {
+            /* no pool thread; run it here, as we would serially */
+            bzero(&xerr, sizeof(xerr));
+            Pthread_mutex_unlock(&sched->mtx);
+            event->func(event, &xerr);
+            Pthread_mutex_lock(&sched->mtx);
+            sched->running--;
+            _log_event_error(sched, event, &xerr);
+            listc_rfl(&sched->inflight, event);
+            _free_event(event);
+            Pthread_cond_broadcast(&sched->cond);
+            /* the list might have changed while unlocked */
+            next = sched->events.top;
+        }
+        event = next;
+    }
+    return event;
+}
+
+/**
+ * Run all due events in order on the scheduler thread.
+ * Called with sched->mtx held. Returns the first event that is not due yet
+ *
+ */
+static cron_event_t *_run_events(cron_sched_t *sched)
+{
+    cron_event_t *event;
+    struct errstat xerr;
+
+    while ((event = sched->events.top) != NULL) {
+        if (sched->impl.is_exec_time(&sched->impl, event)) {
+            bzero(&xerr, sizeof(xerr));
+
+            /* lets do it */
+            /* NOTE: we don't need to keep the scheduler lock here!
+               The event pointer should be stable, but the list can change
+               in the
+               meantime.  This prevents callbacks that acquire resources
+               locks from
+               deadlocking with other resource threads that try to schedule
+               an event
+               We mark the cron job as working, to exclude access to top
+               event to any other thread !!!
+               */
+            sched->running++;
+            Pthread_mutex_unlock(&sched->mtx);
+            event->func(event, &xerr);
+            Pthread_mutex_lock(&sched->mtx);
+            sched->running--;
+
+            _log_event_error(sched, event, &xerr);
+            _destroy_event(sched, event);
+        } else {
+            break;
+        }
+    }
+    return event;
+}
+
 /**
  * Regular wake up and run job
  * Function is meant to be used with pthread_create
@@ -247,7 +411,6 @@ static void *_cron_runner(void *arg)
     cron_sched_t *sched = (cron_sched_t *)arg;
     cron_event_t *event;
     int rc;
-    struct errstat xerr;
     int locked;
 
     if (!sched) {
@@ -260,36 +423,10 @@ static void *_cron_runner(void *arg)
         Pthread_mutex_lock(&sched->mtx);
         locked = 1;
 
-        while ((event = sched->events.top) != NULL) {
-            if (sched->impl.is_exec_time(&sched->impl, event)) {
-                bzero(&xerr, sizeof(xerr));
-
-                /* lets do it */
-                /* NOTE: we don't need to keep the scheduler lock here!
-                   The event pointer should be stable, but the list can change
-                   in the
-                   meantime.  This prevents callbacks that acquire resources
-                   locks from
-                   deadlocking with other resource threads that try to schedule
-                   an event
-                   We mark the cron job as working, to exclude access to top
-                   event to any other thread !!!
-                   */
-                sched->running = 1;
-                Pthread_mutex_unlock(&sched->mtx);
-                event->func(event, &xerr);
-                Pthread_mutex_lock(&sched->mtx);
-                sched->running = 0;
-
-                if (xerr.errval)
-                    logmsg(LOGMSG_ERROR,
-                           "Schedule %s error event %d rc=%d errstr=%s\n",
-                           (sched->impl.name) ? sched->impl.name : "(noname)",
-                           event->epoch, xerr.errval, xerr.errstr);
-                _destroy_event(sched, event);
-            } else {
-                break;
-            }
+        if (gbl_cron_event_concurrency > 1) {
+            event = _dispatch_events(sched);
+        } else {
+            event = _run_events(sched);
         }
 
         if (db_is_exiting())
@@ -401,7 +538,7 @@ void cron_clear_queue_for_sourceid(cron_sched_t *sched, uuid_t *source_id)
     cron_unlock(sched);
 }
 
-/* Note for running event, if any, to finish */
+/* Wait for running events, if any, to finish */
 void cron_lock(cron_sched_t *sched)
 {
     struct timespec now;
@@ -23,6 +23,7 @@
 #include "views.h"
 
 int gbl_check_access_controls;
+int gbl_sql_access_cache = 1;
 extern ssl_mode gbl_client_ssl_mode;
 
 static void check_auth_enabled(struct dbenv *dbenv)
@@ -188,6 +189,54 @@ int check_sql_access(struct sqlthdstate *thd, struct sqlclntstate *clnt)
     return rc;
 }
 
+/* Table permissions a session's user was granted, as bits by dbs_idx, so
+ * a cursor open is a bit test instead of up to four llmeta lookups.
+ * Grants, revokes, and adding, dropping or renaming tables all write llmeta,
+ * on the master and through replication, so the bits are only trusted
+ * while llmeta's change gen is where it was when they were set.  The gen
+ * is taken before the check that sets a bit, so a revoke racing with that
+ * check still clears it.  Only grants are cached; denials are rechecked. */
+static int access_cache_test(struct sqlclntstate *clnt, const dbtable *db,
+                             int access_type)
+{
+    int idx = db->dbs_idx;
+    unsigned int gen;
+
+    if (!gbl_sql_access_cache || idx < 0 ||
+        idx >= sizeof(clnt->access_cache.read) * 8)
+        return 0;
+
+    gen = bdb_llmeta_chg_gen();
+    if (clnt->access_cache.llmeta_gen != gen ||
+        clnt->access_cache.authgen != gbl_bpfunc_auth_gen ||
+        strcmp(clnt->access_cache.user, clnt->current_user.name) != 0) {
+        bzero(clnt->access_cache.read, sizeof(clnt->access_cache.read));
+        bzero(clnt->access_cache.write, sizeof(clnt->access_cache.write));
+        clnt->access_cache.llmeta_gen = gen;
+        clnt->access_cache.authgen = gbl_bpfunc_auth_gen;
+        strcpy(clnt->access_cache.user, clnt->current_user.name);
+        return 0;
+    }
+
+    uint8_t *bits = access_type == ACCESS_WRITE ? clnt->access_cache.write
+                                                : clnt->access_cache.read;
+    return bits[idx >> 3] & (1 << (idx & 7));
+}
+
+static void access_cache_grant(struct sqlclntstate *clnt, const dbtable *db,
+                               int access_type)
+{
+    int idx = db->dbs_idx;
+
+    if (!gbl_sql_access_cache || idx < 0 ||
+        idx >= sizeof(clnt->access_cache.read) * 8)
+        return;
+
+    uint8_t *bits = access_type == ACCESS_WRITE ? clnt->access_cache.write
+                                                : clnt->access_cache.read;
+    bits[idx >> 3] |= (1 << (idx & 7));
+}
+
 int (*externalComdb2AuthenticateUserRead)(void *, const char *tablename) = NULL;
 int (*externalComdb2AuthenticateUserWrite)(void *,
                                            const char *tablename) = NULL;
@@ -243,7 +292,8 @@ int access_control_check_sql_write(struct BtCursor *pCur,
     } else {
         /* Check read access if its not user schema. */
         /* Check it only if engine is open already. */
-        if (gbl_uses_password && (thd->clnt->in_sqlite_init == 0)) {
+        if (gbl_uses_password && (thd->clnt->in_sqlite_init == 0) &&
+            !access_cache_test(clnt, pCur->db, ACCESS_WRITE)) {
             rc = bdb_check_user_tbl_access(
                 pCur->db->dbenv->bdb_env, thd->clnt->current_user.name,
                 pCur->db->tablename, ACCESS_WRITE, &bdberr);
@@ -258,6 +308,7 @@ int access_control_check_sql_write(struct BtCursor *pCur,
 
                 return SQLITE_ABORT;
             }
+            access_cache_grant(clnt, pCur->db, ACCESS_WRITE);
         }
     }
 
@@ -319,7 +370,8 @@ int access_control_check_sql_read(struct BtCursor *pCur, struct sql_thread *thd)
             return SQLITE_ABORT;
         }
     } else {
-        if (gbl_uses_password && thd->clnt->in_sqlite_init == 0) {
+        if (gbl_uses_password && thd->clnt->in_sqlite_init == 0 &&
+            !access_cache_test(clnt, pCur->db, ACCESS_READ)) {
             rc = bdb_check_user_tbl_access(
                 pCur->db->dbenv->bdb_env, thd->clnt->current_user.name,
                 pCur->db->tablename, ACCESS_READ, &bdberr);
@@ -334,6 +386,7 @@ int access_control_check_sql_read(struct BtCursor *pCur, struct sql_thread *thd)
 
                 return SQLITE_ABORT;
             }
+            access_cache_grant(clnt, pCur->db, ACCESS_READ);
         }
     }
 
@@ -79,6 +79,19 @@ void calc_fingerprint(const char *zNormSql, size_t *pnNormSql,
     MD5Final(fingerprint, &ctx);
 }
 
+/* As calc_fingerprint(), reusing what stmt kept if zNormSql is its own
+ * normalized SQL, so a cached statement is only hashed once. */
+void calc_stmt_fingerprint(sqlite3_stmt *stmt, const char *zNormSql,
+                           size_t *pnNormSql,
+                           unsigned char fingerprint[FINGERPRINTSZ])
+{
+    if (stmt && stmt_fingerprint(stmt, zNormSql, fingerprint, pnNormSql))
+        return;
+    calc_fingerprint(zNormSql, pnNormSql, fingerprint);
+    if (stmt && zNormSql)
+        stmt_set_fingerprint(stmt, zNormSql, fingerprint, *pnNormSql);
+}
+
 static int have_type_overrides(struct sqlclntstate *clnt) {
     return clnt->plugin.override_count(clnt) > 0;
 }
@@ -176,7 +189,10 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt,
     assert(zNormSql);
 
     /* Calculate fingerprint */
-    calc_fingerprint(zNormSql, &nNormSql, fingerprint);
+    calc_stmt_fingerprint(stmt, zNormSql, &nNormSql, fingerprint);
+
+    /* the request's io and lock waits are final by now */
+    reqlog_stage_collect(logger);
 
     Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
     if (gbl_fingerprint_hash == NULL) gbl_fingerprint_hash = hash_init(FINGERPRINTSZ);
@@ -206,6 +222,8 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt,
         t->curr_analyze_gen = gbl_analyze_gen;
         t->zNormSql = strdup(zNormSql);
         t->nNormSql = nNormSql;
+        if (logger)
+            reqlog_stage_hist_add(&t->stages, logger);
         hash_add(gbl_fingerprint_hash, t);
 
         char fp[FINGERPRINTSZ*2+1]; /* 16 ==> 33 */
@@ -248,6 +266,8 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt,
         t->time += time;
         t->prepTime += prepTime;
         t->rows += nrows;
+        if (logger)
+            reqlog_stage_hist_add(&t->stages, logger);
 
         /* Do a check after an interval */
         if (t->check_next_queries) {
@@ -30,6 +30,7 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #include "comdb2_query_preparer.h"
+#include "hdrhist.h"
 
 struct comdb2_metrics_store {
     int64_t cache_hits;
@@ -102,6 +103,21 @@ struct comdb2_metrics_store {
     int64_t nsslpartialhandshakes;
     double weighted_queue_depth;
     int64_t weighted_standing_queue_time;
+    int64_t service_time_p50;
+    int64_t service_time_p99;
+    int64_t service_time_p999;
+    int64_t commit_time_p50;
+    int64_t commit_time_p99;
+    int64_t commit_time_p999;
+    int64_t repl_wait_time_p50;
+    int64_t repl_wait_time_p99;
+    int64_t repl_wait_time_p999;
+    int64_t fsync_time_p50;
+    int64_t fsync_time_p99;
+    int64_t fsync_time_p999;
+    int64_t repl_pacing_delay_ms;
+    int64_t repl_pacing_lag_bytes;
+    int64_t repl_pacing_allowed_rate;
 };
 
 static struct comdb2_metrics_store stats;
@@ -277,6 +293,36 @@ comdb2_metric gbl_metrics[] = {
     {"weighted_standing_queue_time", "How long the database has had a weighted standing queue",
      STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST,
      &stats.weighted_standing_queue_time, NULL},
+    {"service_time_p50", "Median service time over the recent window (ms)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.service_time_p50, NULL},
+    {"service_time_p99", "99th percentile service time over the recent window (ms)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.service_time_p99, NULL},
+    {"service_time_p999", "99.9th percentile service time over the recent window (ms)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.service_time_p999, NULL},
+    {"commit_time_p50", "Median commit time over the recent window (us)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.commit_time_p50, NULL},
+    {"commit_time_p99", "99th percentile commit time over the recent window (us)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.commit_time_p99, NULL},
+    {"commit_time_p999", "99.9th percentile commit time over the recent window (us)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.commit_time_p999, NULL},
+    {"repl_wait_time_p50", "Median replication wait time over the recent window (us)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.repl_wait_time_p50, NULL},
+    {"repl_wait_time_p99", "99th percentile replication wait time over the recent window (us)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.repl_wait_time_p99, NULL},
+    {"repl_wait_time_p999", "99.9th percentile replication wait time over the recent window (us)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.repl_wait_time_p999, NULL},
+    {"fsync_time_p50", "Median fsync time over the recent window (us)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.fsync_time_p50, NULL},
+    {"fsync_time_p99", "99th percentile fsync time over the recent window (us)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.fsync_time_p99, NULL},
+    {"fsync_time_p999", "99.9th percentile fsync time over the recent window (us)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.fsync_time_p999, NULL},
+    {"repl_pacing_delay_ms", "Commit delay set by replication pacing (ms)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.repl_pacing_delay_ms, NULL},
+    {"repl_pacing_lag_bytes", "Lag of the replicant replication pacing last paced for (bytes)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.repl_pacing_lag_bytes, NULL},
+    {"repl_pacing_allowed_rate", "Log write rate replication pacing last allowed (bytes/sec)",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.repl_pacing_allowed_rate, NULL},
 };
 
 const char *metric_collection_type_string(comdb2_collection_type t) {
@@ -296,6 +342,18 @@ int gbl_metrics_count = sizeof(gbl_metrics) / sizeof(comdb2_metric);
 extern int n_commits;
 extern long n_fstrap;
 
+/* p50, p99 and p999 of the metric's recent window into p[0..2] */
+static void refresh_percentiles(struct time_metric *t, int64_t *p)
+{
+    struct hdrhist *h = time_metric_get_hist(t, 1);
+    if (h == NULL)
+        return;
+    p[0] = hdrhist_percentile(h, 50);
+    p[1] = hdrhist_percentile(h, 99);
+    p[2] = hdrhist_percentile(h, 99.9);
+    hdrhist_free(h);
+}
+
 static int64_t refresh_diskspace(struct dbenv *dbenv, tran_type *tran)
 {
     int64_t total = 0;
@@ -533,6 +591,13 @@ int refresh_metrics(void)
 
     bdb_rep_deadlocks(thedb->bdb_env, &stats.rep_deadlocks);
 
+    refresh_percentiles(thedb->service_time, &stats.service_time_p50);
+    refresh_percentiles(thedb->commit_time, &stats.commit_time_p50);
+    refresh_percentiles(thedb->repl_wait_time, &stats.repl_wait_time_p50);
+    refresh_percentiles(thedb->fsync_time, &stats.fsync_time_p50);
+    bdb_repl_pacing_stats(&stats.repl_pacing_delay_ms, &stats.repl_pacing_lag_bytes,
+                          &stats.repl_pacing_allowed_rate);
+
     stats.weighted_standing_queue_time = metrics_weighted_standing_queue_time();
     if (gbl_track_weighted_queue_metrics_separately)
         stats.standing_queue_time = metrics_standing_queue_time();
@@ -653,6 +718,9 @@ static void update_cpu_percent(void)
 }
 
 void update_metrics(void) {
+    struct time_metric *t;
+    for (t = time_metric_first(); t; t = time_metric_next(t))
+        time_metric_roll_hist(t);
     update_cpu_percent();
     update_standing_queue_time();
     update_weighted_standing_queue_metrics();
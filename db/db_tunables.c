@@ -66,6 +66,16 @@ extern int gbl_enque_reorder_lookahead;
 extern int gbl_exit_alarm_sec;
 extern int gbl_fdb_track;
 extern int gbl_fdb_track_hints;
+extern int gbl_fdb_project_columns;
+extern int gbl_fdb_stream_window_rows;
+extern int gbl_fdb_stream_window_ms;
+extern int gbl_fdb_schema_poll_ms;
+extern int gbl_file_reclaim_chunk_mb;
+extern int gbl_file_reclaim_mb_per_sec;
+extern int gbl_zstd_dict;
+extern int gbl_zstd_dict_kb;
+extern int gbl_zstd_dict_samples;
+extern int gbl_zstd_dict_retrain_sec;
 extern int gbl_forbid_ulonglong;
 extern int gbl_force_highslot;
 extern int gbl_fdb_allow_cross_classes;
@@ -74,15 +84,22 @@ extern int gbl_goslow;
 extern int gbl_heartbeat_send;
 extern int gbl_keycompr;
 extern int gbl_largepages;
+extern int gbl_hugepage_mb;
 extern int gbl_loghist;
 extern int gbl_loghist_verbose;
 extern int gbl_master_retry_poll_ms;
 extern int gbl_master_swing_osql_verbose;
+extern int gbl_transfermaster_direct;
+extern int gbl_transfermaster_catchup_ms;
+extern int gbl_backup_logfiles_compress;
+extern int gbl_backup_logfiles_threads;
 extern int gbl_master_swing_sock_restart_sleep;
 extern int gbl_max_lua_instructions;
+extern int gbl_lua_sp_pool_size;
 extern int gbl_max_sqlcache;
 extern int __gbl_max_mpalloc_sleeptime;
 extern int gbl_mem_nice;
+extern int gbl_mem_tcache;
 extern int gbl_netbufsz;
 extern int gbl_net_lmt_upd_incoherent_nodes;
 extern int gbl_net_max_mem;
@@ -129,6 +146,7 @@ extern int diffstat_thresh;
 extern int reqltruncate;
 extern int analyze_max_comp_threads;
 extern int analyze_max_table_threads;
+extern int gbl_analyze_incremental_pct;
 extern int gbl_block_set_commit_genid_trace;
 extern int gbl_abort_on_unset_ha_flag;
 extern int gbl_write_dummy_trace;
@@ -150,12 +168,63 @@ extern uint32_t gbl_max_cascaded_rows_per_txn;
 extern uint32_t gbl_max_time_per_txn_ms;
 extern int gbl_force_serial_on_writelock;
 extern int gbl_processor_thd_poll;
+extern int gbl_rep_page_apply_min;
+extern int gbl_repl_log_split_gap;
+extern int gbl_rep_page_apply_parts;
+extern int gbl_rep_prefetch_pages;
+extern int gbl_recovery_parallel_redo;
+extern int gbl_ckp_fuzzy_target_secs;
+extern int gbl_ckp_fuzzy_max_pages;
+extern int gbl_deadlock_detect_incremental;
+extern int gbl_undo_row_cache_kb;
+extern int gbl_rowlock_fastpath;
+extern int gbl_lock_wait_profile;
+extern int gbl_lock_wait_profile_max;
+extern int gbl_serial_write_cache_kb;
+extern int gbl_prefault_constraints;
+extern int gbl_sql_cursor_batch_bytes;
+extern int gbl_sql_result_cache_kb;
+extern int gbl_csc2_version_cache;
+extern int gbl_sql_result_cache_max_staleness_ms;
+extern int gbl_ruleset_cache_size;
+extern int gbl_admission_control;
+extern int gbl_admission_queue_ms;
+extern int gbl_admission_miss_pct;
+extern int gbl_admission_lockwait_ms;
+extern int gbl_admission_min_class;
+extern int gbl_admission_delay_ms;
+extern int gbl_autotune;
+extern int gbl_autotune_apply;
+extern int gbl_autotune_interval_secs;
+extern int gbl_autotune_max_factor;
+extern int gbl_mem_budget_mb;
+extern int gbl_profiler_hz;
+extern int gbl_profiler_max_stacks;
+extern int gbl_bufferpool_heatmap_ranges;
+extern int gbl_repl_history_samples;
+extern int gbl_repl_lag_trend_samples;
+extern int gbl_repl_lag_trend_delay;
+extern int gbl_repl_target_lag_bytes;
+extern int gbl_repl_pacing_horizon_ms;
+extern int gbl_repl_pacing_max_delay_ms;
+extern int gbl_trace_ring_mask;
+extern int gbl_trace_ring_entries;
+extern int gbl_sql_arena_kb;
+extern int gbl_sql_hash_join;
+extern int gbl_sql_sorter_threads;
+extern int gbl_newsql_columnar_rows;
+extern int gbl_newsql_max_stmt_ids;
+extern int gbl_master_offload_reads;
+extern int gbl_sql_flush_coalesce_usec;
+extern int gbl_sql_async_done_flush;
 extern int gbl_time_rep_apply;
 extern int gbl_incoherent_logput_window;
 extern int gbl_dump_net_queue_on_partial_write;
 extern int gbl_dump_full_net_queue;
 extern int gbl_debug_partial_write;
 extern int gbl_debug_sleep_on_verify;
+extern int gbl_verify_items_per_sec;
+extern int gbl_table_open_threads;
 extern int gbl_max_clientstats_cache;
 extern int gbl_decoupled_logputs;
 extern int gbl_dedup_rep_all_reqs;
@@ -208,6 +277,7 @@ extern int gbl_osql_send_startgen;
 extern int gbl_create_default_user;
 extern int gbl_allow_neg_column_size;
 extern int gbl_client_heartbeat_ms;
+extern int gbl_sql_idle_timeout_sec;
 extern int gbl_rep_wait_release_ms;
 extern int gbl_rep_wait_core_ms;
 extern int gbl_random_get_curtran_failures;
@@ -215,6 +285,7 @@ extern int gbl_random_thdpool_work_timeout;
 extern int gbl_thdpool_queue_only;
 extern int gbl_random_sql_work_delayed;
 extern int gbl_random_sql_work_rejected;
+extern int gbl_sql_incremental_schema_refresh;
 extern int gbl_instrument_dblist;
 extern int gbl_replicated_truncate_timeout;
 extern int gbl_match_on_ckp;
@@ -225,6 +296,7 @@ extern int gbl_verbose_set_sc_in_progress;
 extern int gbl_send_failed_dispatch_message;
 extern int gbl_physrep_reconnect_penalty;
 extern int gbl_physrep_register_interval;
+extern int gbl_physrep_fetch_ahead;
 extern int gbl_logdelete_lock_trace;
 extern int gbl_flush_log_at_checkpoint;
 extern int gbl_online_recovery;
@@ -242,6 +314,21 @@ extern int gbl_load_cache_max_pages;
 extern int gbl_dump_cache_max_pages;
 extern int gbl_max_pages_per_cache_thread;
 extern int gbl_memp_dump_cache_threshold;
+extern int gbl_memp_ctier_mb;
+extern int gbl_memp_ctier_max_ratio;
+extern int gbl_memp_numa;
+extern int gbl_memp_optimistic_fget;
+extern int gbl_memp_scan_resistant;
+extern int gbl_group_commit_adaptive;
+extern int gbl_group_commit_max_wait_us;
+extern int gbl_log_uring;
+extern char *gbl_log_tier_path;
+extern int gbl_log_tier_mb;
+extern int gbl_log_tier_drain_ms;
+extern int gbl_log_reserve;
+extern int gbl_log_compress_min;
+extern int gbl_log_compress_max_ratio;
+extern int gbl_sql_numa_pin;
 extern int gbl_disable_ckp;
 extern int gbl_abort_on_illegal_log_put;
 extern int gbl_sc_close_txn;
@@ -253,6 +340,7 @@ extern int gbl_client_queued_slow_seconds;
 extern int gbl_client_running_slow_seconds;
 extern int gbl_client_abort_on_slow;
 extern int gbl_max_trigger_threads;
+extern int gbl_deferred_trigger_batch;
 extern int gbl_alternate_normalize;
 extern int gbl_sc_logbytes_per_second;
 extern int gbl_fingerprint_max_queries;
@@ -262,6 +350,16 @@ extern unsigned gbl_ddlk;
 extern int gbl_abort_on_missing_ufid;
 extern int gbl_ufid_dbreg_test;
 extern int gbl_debug_add_replication_latency;
+extern int gbl_async_commit_ack;
+extern int gbl_commit_ack_group_max;
+extern char *gbl_counter_columns;
+extern int gbl_counter_image_cache;
+extern char *gbl_zonemap_columns;
+extern int gbl_zonemap_zone_rows;
+extern int gbl_zonemap_build_sec;
+extern int gbl_zonemap_refresh_sec;
+extern int gbl_zonemap_max_zones;
+extern int gbl_read_lsn_wait_ms;
 extern int gbl_javasp_early_release;
 
 extern long long sampling_threshold;
@@ -276,6 +374,10 @@ extern uint8_t _non_dedicated_subnet;
 extern char *gbl_crypto;
 extern char *gbl_spfile_name;
 extern char *gbl_timepart_file_name;
+extern int gbl_timepart_prealloc_pct;
+extern int gbl_timepart_cold_shard_age;
+extern int gbl_cron_event_concurrency;
+extern char *gbl_timepart_cold_shard_compress;
 extern char *gbl_test_log_file;
 extern pthread_mutex_t gbl_test_log_file_mtx;
 extern char *gbl_machine_class;
@@ -283,8 +385,19 @@ extern int gbl_ref_sync_pollms;
 extern int gbl_ref_sync_wait_txnlist;
 extern int gbl_ref_sync_iterations;
 extern int gbl_sc_pause_at_end;
+extern int gbl_sc_ranges_per_stripe;
+extern int gbl_pg_compact_sweep_pages;
+extern int gbl_bt_split_window;
+extern int gbl_bt_append_split_pct;
+extern int gbl_bt_near_append;
+extern int gbl_ix_filter_mb;
+extern int gbl_temptable_mem_budget_mb;
+extern int gbl_temptable_space_limit_mb;
+extern int gbl_temptable_query_space_limit_mb;
 extern int gbl_sc_is_at_end;
 extern int gbl_max_password_cache_size;
+extern int gbl_llmeta_cache_size;
+extern int gbl_sql_access_cache;
 extern int gbl_check_constraint_feature;
 extern int gbl_default_function_feature;
 extern int gbl_on_del_set_null_feature;
@@ -308,6 +421,8 @@ extern int gbl_warnthresh;
 
 /* bdb/bdb_net.c */
 extern int gbl_ack_trace;
+extern int gbl_ack_coalesce_count;
+extern int gbl_ack_coalesce_ms;
 
 /* bdb/bdblock.c */
 extern int gbl_bdblock_debug;
@@ -339,6 +454,7 @@ int gbl_ddl_cascade_drop = 1;
 extern int gbl_queuedb_genid_filename;
 extern int gbl_queuedb_file_threshold;
 extern int gbl_queuedb_file_interval;
+extern int gbl_queuedb_file_threshold_live;
 extern int gbl_queuedb_timeout_sec;
 
 extern int gbl_timeseries_metrics;
@@ -348,6 +464,11 @@ extern int gbl_abort_irregular_set_durable_lsn;
 extern int gbl_legacy_defaults;
 extern int gbl_legacy_schema;
 extern int gbl_selectv_writelock_on_update;
+extern int gbl_osql_bplog_prefetch_ops;
+extern int gbl_osql_bplog_conflict_wait_ms;
+extern int gbl_osql_bplog_stream_ops;
+extern int gbl_osql_bplog_stream_idle_ms;
+extern int gbl_osql_batch_bytes;
 extern int gbl_selectv_writelock;
 extern int gbl_msgwaittime;
 extern int gbl_scwaittime;
@@ -364,6 +485,7 @@ extern int gbl_instrument_consumer_lock;
 extern int gbl_reject_mixed_ddl_dml;
 extern int gbl_debug_create_master_entry;
 extern int eventlog_nkeep;
+extern int gbl_eventlog_queue_max;
 extern int gbl_debug_systable_locks;
 extern int gbl_assert_systable_locks;
 extern int gbl_track_curtran_gettran_locks;
@@ -384,6 +506,7 @@ int gbl_group_concat_mem_limit; /* 0 implies allow upto SQLITE_MAX_LENGTH,
                                    sqlite's limit */
 int gbl_page_order_table_scan;
 int gbl_old_column_names = 1;
+int gbl_bufferpool_heatmap_ranges = 16;
 int gbl_enable_sq_flattening_optimization = 1;
 int gbl_mask_internal_tunables = 1;
 int gbl_allow_readonly_runtime_mod = 0;
@@ -657,6 +780,19 @@ static int lk_verify(void *context, void *value)
     return 0;
 }
 
+static int hugepage_verify(void *context, void *value)
+{
+    comdb2_tunable *tunable = (comdb2_tunable *)context;
+    int mb = *(int *)value;
+
+    if (mb != 0 && mb != 2 && mb != 1024) {
+        logmsg(LOGMSG_ERROR, "Invalid value for '%s'. (0, 2 or 1024)\n",
+               tunable->name);
+        return 1;
+    }
+    return 0;
+}
+
 static int memnice_update(void *context, void *value)
 {
     int nicerc;
@@ -63,6 +63,12 @@ REGISTER_TUNABLE("analyze_comp_threshold",
                  "scan the entire index. (Default: 104857600)",
                  TUNABLE_INTEGER, &sampling_threshold, READONLY, NULL, NULL,
                  analyze_set_sampling_threshold, NULL);
+REGISTER_TUNABLE("analyze_incremental_pct",
+                 "Analyze of the whole database skips tables whose writes "
+                 "since their last analyze are below this percentage of their "
+                 "rows. (Default: 0, disabled)",
+                 TUNABLE_INTEGER, &gbl_analyze_incremental_pct, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("analyze_tbl_threads",
                  "Number of threads to go through generated samples when "
                  "generating index statistics. (Default: 5)",
@@ -90,6 +96,23 @@ REGISTER_TUNABLE("broken_max_rec_sz", NULL, TUNABLE_INTEGER,
 REGISTER_TUNABLE("broken_num_parser", NULL, TUNABLE_BOOLEAN,
                  &gbl_broken_num_parser, READONLY | NOARG | READEARLY, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("bt_split_window",
+                 "When splitting a B-tree page, look this many entries either "
+                 "side of the middle for the split point with the shortest "
+                 "separator key. 0 splits in the middle. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_bt_split_window, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("bt_append_split_pct",
+                 "When an insert near the end of the last B-tree leaf splits "
+                 "it, keep this percent of the data on the left page. 50 or "
+                 "less splits in the middle. (Default: 90)",
+                 TUNABLE_INTEGER, &gbl_bt_append_split_pct, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("bt_near_append",
+                 "Let inserts that sort anywhere on the last B-tree leaf go "
+                 "straight to it, like appends. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_bt_near_append, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("buffers_per_context", NULL, TUNABLE_INTEGER,
                  &gbl_buffers_per_context, READONLY | NOZERO, NULL, NULL, NULL,
                  NULL);
@@ -114,6 +137,17 @@ REGISTER_TUNABLE("chkpoint_alarm_time",
                  "(Default: 60 secs)",
                  TUNABLE_INTEGER, &gbl_chkpoint_alarm_time, READONLY, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("ckp_fuzzy_target_secs",
+                 "Write dirty pages continuously from the memptrickle thread "
+                 "so that pages stay dirty for about this many seconds at "
+                 "most.  0 disables.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_ckp_fuzzy_target_secs, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("ckp_fuzzy_max_pages",
+                 "Most pages a single fuzzy checkpoint pass writes.  0 means "
+                 "no limit.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_ckp_fuzzy_max_pages, 0, NULL, NULL,
+                 NULL, NULL);
 /* Generate the value of 'cluster' on fly (define value()). */
 /*
 REGISTER_TUNABLE("cluster",
@@ -155,6 +189,11 @@ REGISTER_TUNABLE(
     "ddl_cascade_drop",
     "On DROP, also drop the dependent keys/constraints. (Default: 1)",
     TUNABLE_BOOLEAN, &gbl_ddl_cascade_drop, READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("deadlock_detect_incremental",
+                 "Skip the waits-for graph build when no lock wait has "
+                 "started since the last detector pass. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_deadlock_detect_incremental, 0, NULL,
+                 NULL, NULL, NULL);
 REGISTER_TUNABLE("deadlock_policy_override", NULL, TUNABLE_INTEGER,
                  &gbl_deadlock_policy_override, READONLY, NULL, NULL,
                  deadlock_policy_override_update, NULL);
@@ -470,6 +509,38 @@ REGISTER_TUNABLE("fdbdebg", NULL, TUNABLE_INTEGER, &gbl_fdb_track, 0, NULL,
                  NULL, NULL, NULL);
 REGISTER_TUNABLE("fdbtrackhints", NULL, TUNABLE_INTEGER, &gbl_fdb_track_hints,
                  READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_project_columns",
+                 "Fetch only the columns a query reads from remote tables, "
+                 "as NULL otherwise. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_fdb_project_columns, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("fdb_stream_window_rows",
+                 "Rows a remote sql result streams before they are flushed "
+                 "to the requester; 1 flushes every row. (Default: 64)",
+                 TUNABLE_INTEGER, &gbl_fdb_stream_window_rows, NOZERO, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_stream_window_ms",
+                 "Longest a streamed remote sql row waits to be flushed, in "
+                 "ms. (Default: 10)",
+                 TUNABLE_INTEGER, &gbl_fdb_stream_window_ms, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("fdb_schema_poll_ms",
+                 "Check the version of every cached remote table this often, "
+                 "in ms, and mark changed ones for refresh; 0 disables. "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_fdb_schema_poll_ms, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("file_reclaim_chunk_mb",
+                 "Give back the space of unlinked files bigger than this, in "
+                 "MB, one chunk at a time from a background thread; 0 "
+                 "unlinks them at once. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_file_reclaim_chunk_mb, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("file_reclaim_mb_per_sec",
+                 "Rate at which file_reclaim_chunk_mb gives back space, in "
+                 "MB per second; 0 does not throttle. (Default: 256)",
+                 TUNABLE_INTEGER, &gbl_file_reclaim_mb_per_sec, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("forbid_ulonglong", "Disallow u_longlong. (Default: on)",
                  TUNABLE_BOOLEAN, &gbl_forbid_ulonglong,
                  NOARG | READEARLY, NULL, NULL, NULL, NULL);
@@ -512,6 +583,12 @@ REGISTER_TUNABLE("heartbeat_send_time",
                  NULL, NULL, NULL);
 REGISTER_TUNABLE("hostname", NULL, TUNABLE_STRING, &gbl_myhostname,
                  READONLY | READEARLY, NULL, NULL, hostname_update, NULL);
+REGISTER_TUNABLE("hugepage_mb",
+                 "Back berkdb regions, such as the buffer pool, with explicit "
+                 "huge pages of this many MB (2 or 1024), falling back to "
+                 "smaller pages.  0 disables. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_hugepage_mb, READONLY, NULL,
+                 hugepage_verify, NULL, NULL);
 REGISTER_TUNABLE("incoherent_alarm_time", NULL, TUNABLE_INTEGER,
                  &gbl_incoherent_alarm_time, READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("incoherent_msg_freq", NULL, TUNABLE_INTEGER,
@@ -530,6 +607,23 @@ REGISTER_TUNABLE("init_with_queue_compr", NULL, TUNABLE_ENUM,
 REGISTER_TUNABLE("init_with_compr_blobs", NULL, TUNABLE_ENUM,
                  &gbl_init_with_compr_blobs, READONLY, init_with_compr_value,
                  NULL, init_with_compr_blobs_update, NULL);
+REGISTER_TUNABLE("zstd_dict",
+                 "Compress the data records of zstd tables with a dictionary "
+                 "trained from their own records. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_zstd_dict, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("zstd_dict_kb",
+                 "Size of a trained zstd dictionary, in KB. (Default: 16)",
+                 TUNABLE_INTEGER, &gbl_zstd_dict_kb, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("zstd_dict_samples",
+                 "Records sampled to train a zstd dictionary. (Default: 2000)",
+                 TUNABLE_INTEGER, &gbl_zstd_dict_samples, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("zstd_dict_retrain_sec",
+                 "Train a new zstd dictionary this often, in seconds; 0 keeps "
+                 "the first one. (Default: 86400)",
+                 TUNABLE_INTEGER, &gbl_zstd_dict_retrain_sec, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("init_with_genid48",
                  "Enables Genid48 for the database. (Default: on)",
                  TUNABLE_INTEGER, &gbl_init_with_genid48, READONLY | NOARG,
@@ -580,6 +674,11 @@ REGISTER_TUNABLE("iothreads",
                  "Number of threads to use for I/O prefaulting. (Default: 0)",
                  TUNABLE_INTEGER, &gbl_iothreads, READONLY, NULL, NULL, NULL,
                  NULL);
+REGISTER_TUNABLE("ix_filter_mb",
+                 "Memory budget in MB for the bloom filters the master keeps "
+                 "of unique indexes, so that lookups for absent keys skip the "
+                 "btree. 0 turns them off. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_ix_filter_mb, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("keycompr",
                  "Enable index compression (applies to newly allocated index "
                  "pages, rebuild table to force for all pages.",
@@ -607,6 +706,16 @@ REGISTER_TUNABLE("lock_dba_user",
                  "permissions cannot be modified. (Default: off)",
                  TUNABLE_BOOLEAN, &gbl_lock_dba_user, READONLY | NOARG, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("lock_wait_profile",
+                 "Profile one in this many lock waits by lock object in "
+                 "comdb2_lock_waits. 0 disables. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_lock_wait_profile, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("lock_wait_profile_max",
+                 "Most lock objects tracked by the lock wait profile. "
+                 "(Default: 4096)",
+                 TUNABLE_INTEGER, &gbl_lock_wait_profile_max, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("log_delete_age", "Log deletion policy", TUNABLE_INTEGER,
                  &db->log_delete_age, READONLY, NULL, NULL, NULL, NULL);
 /* The following 3 tunables have been marked internal as we do not want them
@@ -627,6 +736,15 @@ REGISTER_TUNABLE("log_delete_now",
                  TUNABLE_INTEGER, &db->log_delete_age,
                  READONLY | NOARG | INTERNAL, NULL, NULL, log_delete_now_update,
                  NULL);
+REGISTER_TUNABLE("backup_logfiles_compress",
+                 "Gzip log files archived into backup_logfiles_dir on background "
+                 "threads instead of moving them as they are. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_backup_logfiles_compress, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("backup_logfiles_threads",
+                 "Threads that compress archived log files. (Default: 2)",
+                 TUNABLE_INTEGER, &gbl_backup_logfiles_threads, READONLY, NULL,
+                 NULL, NULL, NULL);
 REGISTER_TUNABLE("loghist", NULL, TUNABLE_INTEGER, &gbl_loghist,
                  READONLY | NOARG, NULL, NULL, loghist_update, NULL);
 REGISTER_TUNABLE("loghist_verbose", NULL, TUNABLE_BOOLEAN, &gbl_loghist_verbose,
@@ -663,6 +781,18 @@ REGISTER_TUNABLE("master_swing_osql_verbose_off",
                  "Disables 'master_swing_osql_verbose'", TUNABLE_BOOLEAN,
                  &gbl_master_swing_osql_verbose, INVERSE_VALUE | NOARG, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("transfermaster_direct",
+                 "When the master gives up mastership, hand it to the coherent "
+                 "node that has applied the most log instead of calling an "
+                 "election. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_transfermaster_direct, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("transfermaster_catchup_ms",
+                 "How long a master transfer waits for the new master to "
+                 "apply the last of the log before calling an election "
+                 "instead. (Default: 2000)",
+                 TUNABLE_INTEGER, &gbl_transfermaster_catchup_ms, 0, NULL,
+                 NULL, NULL, NULL);
 REGISTER_TUNABLE("master_swing_sock_restart_sleep",
                  "For testing: sleep in osql_sock_restart when master swings",
                  TUNABLE_INTEGER, &gbl_master_swing_sock_restart_sleep,
@@ -687,6 +817,12 @@ REGISTER_TUNABLE("maxthrottletime", NULL, TUNABLE_INTEGER,
                  &gbl_osql_max_throttle_sec, READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("max_incoherent_nodes", NULL, TUNABLE_INTEGER,
                  &gbl_max_incoherent_nodes, READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("lua_sp_pool_size",
+                 "Keep up to this many idle Lua states of closed connections "
+                 "for the next connection of the same user to call the same "
+                 "stored procedure.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_lua_sp_pool_size, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("max_lua_instructions",
                  "Maximum lua opcodes to execute before we assume the stored "
                  "procedure is looping and kill it. (Default: 10000)",
@@ -725,6 +861,10 @@ REGISTER_TUNABLE("max_query_fingerprints",
                  NULL, NULL, NULL);
 REGISTER_TUNABLE("memnice", NULL, TUNABLE_INTEGER, &gbl_mem_nice,
                  READONLY | NOARG, NULL, NULL, memnice_update, NULL);
+REGISTER_TUNABLE("mem_tcache",
+                 "Keep per-thread caches of small freed blocks of the shared "
+                 "subsystem memory areas. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_mem_tcache, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("mempget_timeout", NULL, TUNABLE_INTEGER,
                  &__gbl_max_mpalloc_sleeptime, READONLY, NULL, NULL, NULL,
                  NULL);
@@ -868,10 +1008,22 @@ REGISTER_TUNABLE("nullsort", NULL, TUNABLE_ENUM,
 REGISTER_TUNABLE("num_contexts", NULL, TUNABLE_INTEGER, &gbl_num_contexts,
                  READONLY | NOZERO, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("num_record_converts",
-                 "During schema changes, pack this many records into a "
-                 "transaction. (Default: 100)",
+                 "During READ_ONLY schema changes, pack this many records "
+                 "into a transaction. (Default: 100)",
                  TUNABLE_INTEGER, &gbl_num_record_converts, READONLY | NOZERO,
                  NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sc_ranges_per_stripe",
+                 "During READ_ONLY schema changes, convert each stripe with "
+                 "this many threads, each scanning its own genid range. Such "
+                 "schema changes cannot be resumed. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_sc_ranges_per_stripe, READONLY | NOZERO,
+                 NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("objpool_tcache",
+                 "Number of returned objects each thread keeps for itself in "
+                 "front of the request and temp table pools, up to 16.  0 "
+                 "disables. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_objpool_tcache, READONLY, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE(
     "old_column_names",
     "Generate and use column names from sqlite version 3.8.9 (Default: on)",
@@ -915,6 +1067,36 @@ REGISTER_TUNABLE("osqlprefaultthreads",
                  "If set, send prefaulting hints to nodes. (Default: 0)",
                  TUNABLE_INTEGER, &gbl_osqlpfault_threads, READONLY, NULL, NULL,
                  NULL, NULL);
+REGISTER_TUNABLE("osql_bplog_conflict_wait_ms",
+                 "Before applying a bplog on the master, wait up to this many "
+                 "ms for sessions already applying that update or delete the "
+                 "same rows. Requires reorder_socksql_no_deadlock. "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_osql_bplog_conflict_wait_ms, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("osql_bplog_prefetch_ops",
+                 "When applying a bplog on the master, prefault the pages for "
+                 "this many ops ahead of the block processor. Requires "
+                 "osqlprefaultthreads. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_osql_bplog_prefetch_ops, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("osql_bplog_stream_ops",
+                 "Dispatch a session to the block processor once it has sent "
+                 "this many ops, and apply the rest as they arrive. Not for "
+                 "reordered bplogs. 0 to disable. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_osql_bplog_stream_ops, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("osql_bplog_stream_idle_ms",
+                 "Fail a streamed session if no op arrives for this many ms. "
+                 "0 to wait forever. (Default: 10000)",
+                 TUNABLE_INTEGER, &gbl_osql_bplog_stream_idle_ms, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("osql_batch_bytes",
+                 "Coalesce the ops a replicant sends to the master into "
+                 "messages of up to this many bytes. The master must support "
+                 "batched ops. 0 to disable. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_osql_batch_bytes, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("osql_verify_ext_chk",
                  "For block transaction mode only - after this many verify "
                  "errors, check if transaction is non-commitable (see default "
@@ -936,6 +1118,12 @@ REGISTER_TUNABLE("page_compact_target_ff", NULL, TUNABLE_DOUBLE,
 REGISTER_TUNABLE("page_compact_thresh_ff", NULL, TUNABLE_DOUBLE,
                  &gbl_pg_compact_thresh, READONLY | NOARG, NULL, NULL,
                  page_compact_thresh_ff_update, NULL);
+REGISTER_TUNABLE("page_compact_sweep_pages",
+                 "On the master, walk this many btree pages a second and "
+                 "queue the sparse leaf pages for page compaction. "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_pg_compact_sweep_pages, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("page_latches",
                  "If set, in rowlocks mode, will acquire fast latches on pages "
                  "instead of full locks. (Default: off)",
@@ -963,6 +1151,12 @@ REGISTER_TUNABLE("portmux_bind_path", NULL, TUNABLE_STRING,
                  portmux_bind_path_set, NULL);
 REGISTER_TUNABLE("portmux_port", NULL, TUNABLE_INTEGER, &portmux_port,
                  READONLY | READEARLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("prefault_constraints",
+                 "Queue prefaults for the rows and keys read by a "
+                 "transaction's deferred key and foreign key checks before "
+                 "running them. Needs prefault io threads. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_prefault_constraints, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("prefaulthelper_blockops", NULL, TUNABLE_INTEGER,
                  &gbl_prefaulthelper_blockops, READONLY, NULL, NULL, NULL,
                  NULL);
@@ -986,6 +1180,122 @@ REGISTER_TUNABLE("verbose_prioritize_queries",
                  "fingerprint.  (Default: off)", TUNABLE_BOOLEAN,
                  &gbl_verbose_prioritize_queries, EXPERIMENTAL | INTERNAL,
                  NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("ruleset_cache_size",
+                 "Ruleset results cached by origin, user and fingerprint; "
+                 "0 evaluates every rule for every request. (Default: 1024)",
+                 TUNABLE_INTEGER, &gbl_ruleset_cache_size, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("admission_control",
+                 "Delay, then reject, low-priority SQL requests while the "
+                 "engine is saturated. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_admission_control, NOARG, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("admission_queue_ms",
+                 "Average SQL engine pool queue time at which admission "
+                 "control starts delaying requests; 0 ignores it. "
+                 "(Default: 100)",
+                 TUNABLE_INTEGER, &gbl_admission_queue_ms, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("admission_miss_pct",
+                 "Buffer pool miss rate, in percent, at which admission "
+                 "control starts delaying requests; 0 ignores it. "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_admission_miss_pct, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("admission_lockwait_ms",
+                 "Milliseconds per second spent waiting for locks at which "
+                 "admission control starts delaying requests; 0 ignores it. "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_admission_lockwait_ms, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("admission_min_class",
+                 "Lowest ruleset priority class subject to admission "
+                 "control. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_admission_min_class, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("admission_delay_ms",
+                 "How long admission control holds back a low-priority "
+                 "request before queueing it. (Default: 20)",
+                 TUNABLE_INTEGER, &gbl_admission_delay_ms, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("autotune",
+                 "Recommend changes to engine pool threads, maxt and cache "
+                 "size from live load. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_autotune, NOARG, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("autotune_apply",
+                 "Apply the autotune recommendations that can change at "
+                 "runtime. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_autotune_apply, NOARG, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("autotune_interval_secs",
+                 "Seconds between autotune decisions. (Default: 60)",
+                 TUNABLE_INTEGER, &gbl_autotune_interval_secs, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("autotune_max_factor",
+                 "Autotune never takes a tunable past this multiple of the "
+                 "value it started from. (Default: 2)",
+                 TUNABLE_INTEGER, &gbl_autotune_max_factor, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("mem_budget_mb",
+                 "Shrink caches when the resident size of the process nears "
+                 "this many MB; 0 disables the memory governor. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_mem_budget_mb, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("profiler_hz",
+                 "Sample the stacks of all registered threads this many "
+                 "times a second; 0 disables the profiler. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_profiler_hz, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("profiler_max_stacks",
+                 "Most distinct stacks the profiler keeps. (Default: 10000)",
+                 TUNABLE_INTEGER, &gbl_profiler_max_stacks, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("bufferpool_heatmap_ranges",
+                 "Number of page ranges comdb2_buffer_pool_heatmap splits "
+                 "each file into. (Default: 16)",
+                 TUNABLE_INTEGER, &gbl_bufferpool_heatmap_ranges, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("repl_history_samples",
+                 "Samples of each replicant kept for comdb2_repl_history. "
+                 "0 stops sampling. (Default: 300)",
+                 TUNABLE_INTEGER, &gbl_repl_history_samples, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("repl_lag_trend_samples",
+                 "A replicant whose lag grew in this many consecutive samples "
+                 "is reported as falling behind. (Default: 10)",
+                 TUNABLE_INTEGER, &gbl_repl_lag_trend_samples, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("repl_lag_trend_delay",
+                 "Raise the master's commit delay while a coherent replicant "
+                 "is falling behind. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_repl_lag_trend_delay, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("repl_target_lag_bytes",
+                 "Pace master commits to keep the slowest coherent replicant "
+                 "about this many bytes behind. 0 is off. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_repl_target_lag_bytes, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("repl_pacing_horizon_ms",
+                 "Replication pacing closes the gap to the target lag over "
+                 "this long. (Default: 10000)",
+                 TUNABLE_INTEGER, &gbl_repl_pacing_horizon_ms, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("repl_pacing_max_delay_ms",
+                 "Largest commit delay replication pacing sets. "
+                 "(Default: 100)",
+                 TUNABLE_INTEGER, &gbl_repl_pacing_max_delay_ms, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("trace_ring_mask",
+                 "Categories traced to the per-thread trace rings: 1 osql, "
+                 "2 net, 4 rep. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_trace_ring_mask, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("trace_ring_entries",
+                 "Traces each thread's trace ring holds, rounded up to a power "
+                 "of 2. Applies to rings created after it is set. "
+                 "(Default: 4096)",
+                 TUNABLE_INTEGER, &gbl_trace_ring_entries, NOZERO, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("random_lock_release_interval", NULL, TUNABLE_INTEGER,
                  &gbl_sql_random_release_interval, READONLY, NULL, NULL, NULL,
                  NULL);
@@ -994,6 +1304,12 @@ REGISTER_TUNABLE("rangextlim", NULL, TUNABLE_INTEGER, &gbl_rangextunit,
 REGISTER_TUNABLE(
     "rcache", "Keep a lookaside cache of root pages for B-trees. (Default: off)",
     TUNABLE_BOOLEAN, &gbl_rcache, READONLY | NOARG, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("rcache_levels",
+                 "Number of levels of each B-tree, from the root down, that "
+                 "'rcache' keeps and descends through without the buffer "
+                 "pool. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_rcache_levels, NOZERO, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("reallearly",
                  "Acknowledge as soon as a commit record is seen by the "
                  "replicant (before it's applied). This effectively makes "
@@ -1055,6 +1371,11 @@ REGISTER_TUNABLE("round_robin_stripes",
                  "default is to keep stripe affinity by writer. (Default: off)",
                  TUNABLE_BOOLEAN, &gbl_round_robin_stripes, READONLY | NOARG,
                  NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("rowlock_fastpath",
+                 "Re-acquire rowlocks a logical transaction already holds "
+                 "without a full lock-table lookup. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_rowlock_fastpath, NOARG, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("rr_enable_count_changes", NULL, TUNABLE_BOOLEAN,
                  &gbl_rrenablecountchanges, READONLY | NOARG, NULL, NULL, NULL,
                  NULL);
@@ -1091,6 +1412,27 @@ REGISTER_TUNABLE("sort_nulls_with_header",
                  NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("spfile", NULL, TUNABLE_STRING, &gbl_spfile_name, READONLY,
                  NULL, NULL, file_update, NULL);
+REGISTER_TUNABLE("cron_event_concurrency",
+                 "Most events of one cron scheduler that run at once; above 1 "
+                 "due events run on a thread pool. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_cron_event_concurrency, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("timepart_cold_shard_age",
+                 "Rebuild a time partition shard compressed once it is this "
+                 "many periods old; 0 disables. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_timepart_cold_shard_age, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("timepart_cold_shard_compress",
+                 "Compression used for cold time partition shards. "
+                 "(Default: zlib)",
+                 TUNABLE_STRING, &gbl_timepart_cold_shard_compress, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("timepart_prealloc_pct",
+                 "Reserve disk for a new time partition shard when it is "
+                 "created, as a percentage of the size of the newest shard; "
+                 "0 disables. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_timepart_prealloc_pct, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("timepartitions", NULL, TUNABLE_STRING,
                  &gbl_timepart_file_name, READONLY, NULL, NULL, file_update,
                  NULL);
@@ -1108,6 +1450,69 @@ REGISTER_TUNABLE("sqlsortermem", "Maximum amount of memory to be "
                                  "(Default: 314572800)",
                  TUNABLE_INTEGER, &gbl_sqlite_sorter_mem, READONLY, NULL, NULL,
                  NULL, NULL);
+REGISTER_TUNABLE("sql_cursor_batch_bytes",
+                 "Read-only table scans fetch up to this many bytes of rows "
+                 "from the bdb cursor per call and serve the following nexts "
+                 "from that buffer. (Default: 0, disabled)",
+                 TUNABLE_INTEGER, &gbl_sql_cursor_batch_bytes, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_arena_kb",
+                 "Carve small sqlite allocations of a running statement out "
+                 "of chunks of this many kilobytes, emptied once the "
+                 "statement is done. (Default: 0, disabled)",
+                 TUNABLE_INTEGER, &gbl_sql_arena_kb, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("sql_hash_join",
+                 "Build automatic indexes for equi-joins as hash tables on "
+                 "the join columns. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_sql_hash_join, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("sql_result_cache_kb",
+                 "Keep the rows of read-only statements in a cache of this "
+                 "many kilobytes, served until the next commit. "
+                 "(Default: 0, disabled)",
+                 TUNABLE_INTEGER, &gbl_sql_result_cache_kb, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_result_cache_max_staleness_ms",
+                 "Serve cached statement results for up to this many ms "
+                 "after they were read, even if something committed since. "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sql_result_cache_max_staleness_ms, 0,
+                 NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("newsql_columnar_rows",
+                 "Rows per columnar block sent to clients that request "
+                 "columnar rows. (Default: 256)",
+                 TUNABLE_INTEGER, &gbl_newsql_columnar_rows, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("sql_async_done_flush",
+                 "Once a statement is done, let the connection event loop "
+                 "send the rest of its response instead of the sql engine "
+                 "thread. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_sql_async_done_flush, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_flush_coalesce_usec",
+                 "Defer a flush of query results requested this soon (in "
+                 "microseconds) after the previous one, so that rows "
+                 "produced in a burst share a write. 0 to disable. "
+                 "(Default: 500)",
+                 TUNABLE_INTEGER, &gbl_sql_flush_coalesce_usec, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("newsql_max_stmt_ids",
+                 "Statement ids a client connection may have the server "
+                 "assign to its statements. (Default: 64)",
+                 TUNABLE_INTEGER, &gbl_newsql_max_stmt_ids, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("master_offload_reads",
+                 "Drop connections that send a read outside a transaction to "
+                 "the master, so the client retries it on a replicant. "
+                 "(Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_master_offload_reads, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_sorter_threads",
+                 "Sort large in-memory sorter lists on up to this many "
+                 "threads. (Default: 4)",
+                 TUNABLE_INTEGER, &gbl_sql_sorter_threads, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("sql_stat4_scan", "Possibly adjust the cost of a full table "
                                    "scan based on STAT4 data.  (Default: off)",
                  TUNABLE_BOOLEAN, &gbl_sqlite_stat4_scan, READONLY | INTERNAL |
@@ -1122,6 +1527,12 @@ REGISTER_TUNABLE("sql_time_threshold",
                  "reported as running a long time. (Default: 5000 ms)",
                  TUNABLE_INTEGER, &gbl_sql_time_threshold, READONLY, NULL, NULL,
                  NULL, NULL);
+REGISTER_TUNABLE("sql_incremental_schema_refresh",
+                 "When a schema change leaves sqlite_master unchanged, update "
+                 "the changed tables in each sql engine instead of reopening "
+                 "it.  (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_sql_incremental_schema_refresh, 0, NULL,
+                 NULL, NULL, NULL);
 REGISTER_TUNABLE("sql_tranlevel_default",
                  "Sets the default SQL transaction level for the database.",
                  TUNABLE_ENUM, &gbl_sql_tranlevel_default, READONLY,
@@ -1150,6 +1561,22 @@ REGISTER_TUNABLE("temptable_limit",
                  "create. (Default: 8192)",
                  TUNABLE_INTEGER, &gbl_temptable_pool_capacity, READONLY, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("temptable_mem_budget_mb",
+                 "Keep temp tables in memory until all of them together hold "
+                 "this many MB, then move them to btrees; 0 always uses "
+                 "btrees. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_temptable_mem_budget_mb, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("temptable_space_limit_mb",
+                 "Fail inserts into temp tables once all temp table btrees "
+                 "together hold this many MB; 0 is no limit. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_temptable_space_limit_mb, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("temptable_query_space_limit_mb",
+                 "Fail a query once it has grown temp table btrees by this "
+                 "many MB; 0 is no limit. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_temptable_query_space_limit_mb, 0, NULL,
+                 NULL, NULL, NULL);
 REGISTER_TUNABLE("test_blob_race", NULL, TUNABLE_INTEGER, &gbl_test_blob_race,
                  READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("test_scindex_deadlock",
@@ -1178,6 +1605,11 @@ REGISTER_TUNABLE("db_lock_maxid_override", "Override berkley lock_maxid for "
                  NULL, NULL, NULL);
 REGISTER_TUNABLE("udp", NULL, TUNABLE_BOOLEAN, &gbl_udp, READONLY | NOARG, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("undo_row_cache_kb",
+                 "Size in KB of the cache of row versions rebuilt from the log "
+                 "for snapshot readers. 0 disables the cache. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_undo_row_cache_kb, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("unnatural_types", "Same as 'surprise'", TUNABLE_BOOLEAN,
                  &gbl_surprise, READONLY | NOARG, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("update_delete_limit", NULL, TUNABLE_BOOLEAN,
@@ -1266,6 +1698,16 @@ REGISTER_TUNABLE("ack_trace",
 REGISTER_TUNABLE("no_ack_trace", "Disables 'ack_trace'", TUNABLE_BOOLEAN,
                  &gbl_ack_trace, INVERSE_VALUE | READONLY | NOARG, NULL, NULL,
                  NULL, NULL);
+REGISTER_TUNABLE("ack_coalesce_count",
+                 "Replicants hold back up to this many acks and send only the "
+                 "latest; 0 or 1 acks every commit. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_ack_coalesce_count, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("ack_coalesce_ms",
+                 "Longest a replicant holds back an ack with "
+                 "ack_coalesce_count on. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_ack_coalesce_ms, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("bdblock_debug", NULL, TUNABLE_BOOLEAN, &gbl_bdblock_debug,
                  READONLY | NOARG, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("debug.autoanalyze", "debug autoanalyze operations",
@@ -1428,6 +1870,35 @@ REGISTER_TUNABLE("processor_thd_poll", "Poll before dispatching worker thds. "
                                        "(Default: 0ms)",
                  TUNABLE_INTEGER, &gbl_processor_thd_poll,
                  EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("repl_log_split_gap",
+                 "Log a same-size record replacement as one record per "
+                 "changed byte range when the ranges are at least this many "
+                 "bytes apart.  0 disables.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_repl_log_split_gap, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("rep_page_apply_min",
+                 "Apply replicated transactions of at least this many log "
+                 "records in parallel by page rather than by file.  "
+                 "0 disables.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_rep_page_apply_min, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("rep_page_apply_parts",
+                 "Number of page partitions per file for page-parallel "
+                 "apply.  (Default: 8)",
+                 TUNABLE_INTEGER, &gbl_rep_page_apply_parts, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("rep_prefetch_pages",
+                 "Queue asynchronous reads for up to this many pages of a "
+                 "replicated transaction before applying it.  0 disables.  "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_rep_prefetch_pages, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("recovery_parallel_redo",
+                 "Redo committed page records during recovery in batches of "
+                 "this many records, in parallel on the recovery worker "
+                 "threads.  0 disables.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_recovery_parallel_redo, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("time_rep_apply", "Display rep-apply times periodically. "
                                    "(Default: off)",
                  TUNABLE_BOOLEAN, &gbl_time_rep_apply, EXPERIMENTAL | INTERNAL,
@@ -1451,6 +1922,17 @@ REGISTER_TUNABLE("debug_partial_write", "Simulate partial write in net.  "
 REGISTER_TUNABLE("debug_verify_sleep", "Sleep one-second per record in verify.  "
                  "(Default: off)", TUNABLE_BOOLEAN, &gbl_debug_sleep_on_verify,
                  EXPERIMENTAL | INTERNAL, NULL,NULL, NULL, NULL);
+REGISTER_TUNABLE("table_open_threads",
+                 "Open the tables on this many threads at startup.  0 or 1 "
+                 "opens them one at a time.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_table_open_threads, READONLY, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("verify_items_per_sec",
+                 "Limit all running table verifies together to this many "
+                 "records, keys and blobs checked per second.  0 for no "
+                 "limit.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_verify_items_per_sec, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE(
     "max_clientstats",
     "Max number of client stats stored in comdb2_clientstats. (Default: 10000)",
@@ -1527,6 +2009,48 @@ REGISTER_TUNABLE("early_ack_trace",
 REGISTER_TUNABLE("commit_delay_trace", "Verbose commit-delays.  (Default: off)",
                  TUNABLE_BOOLEAN, &gbl_commit_delay_trace,
                  EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("group_commit_adaptive",
+                 "Delay log syncs briefly when commits arrive faster than "
+                 "an fsync completes, so they share one sync.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_group_commit_adaptive, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("group_commit_max_wait_us",
+                 "Upper bound on the adaptive group commit window in "
+                 "microseconds.  (Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_group_commit_max_wait_us, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("log_uring",
+                 "Submit log flush writes and the log sync through io_uring "
+                 "in a single system call.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_log_uring, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("log_tier_path",
+                 "File, ideally on persistent memory or NVMe, that log flushes "
+                 "make durable instead of syncing the log file.",
+                 TUNABLE_STRING, &gbl_log_tier_path, READONLY, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("log_tier_mb",
+                 "Size of the log_tier_path file in megabytes.  (Default: 64)",
+                 TUNABLE_INTEGER, &gbl_log_tier_mb, READONLY, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("log_tier_drain_ms",
+                 "How often the log file is synced so the log tier can be "
+                 "reused.  (Default: 10)",
+                 TUNABLE_INTEGER, &gbl_log_tier_drain_ms, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("log_reserve",
+                 "Reserve log buffer space under the log region lock and copy "
+                 "records in after releasing it.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_log_reserve, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("log_compress_min",
+                 "LZ4-compress page-level log records at least this many "
+                 "bytes long; 0 disables.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_log_compress_min, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("log_compress_max_ratio",
+                 "Log a compressed record only if it is at most this "
+                 "percentage of the original.  (Default: 85)",
+                 TUNABLE_INTEGER, &gbl_log_compress_max_ratio, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("set_coherent_state_trace",
                  "Verbose coherency trace.  (Default: off)", TUNABLE_BOOLEAN,
                  &gbl_set_coherent_state_trace, EXPERIMENTAL | INTERNAL, NULL,
@@ -1599,6 +2123,11 @@ REGISTER_TUNABLE("queuedb_file_interval",
                  "Check on this interval each queuedb against its configured "
                  "maximum file size. (Default: 60000ms)", TUNABLE_INTEGER,
                  &gbl_queuedb_file_interval, READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("queuedb_file_threshold_live",
+                 "Count only the pages holding items, as of the last page "
+                 "sweep, against queuedb_file_threshold.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_queuedb_file_threshold_live, 0, NULL,
+                 NULL, NULL, NULL);
 REGISTER_TUNABLE("random_election_timeout",
                  "Use a random timeout in election.  (Default: on)",
                  TUNABLE_BOOLEAN, &gbl_rand_elect_timeout,
@@ -1659,6 +2188,14 @@ REGISTER_TUNABLE("client_heartbeat_ms",
                  TUNABLE_INTEGER, &gbl_client_heartbeat_ms,
                  EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("sql_idle_timeout_sec",
+                 "Close a SQL connection that sends nothing for this many "
+                 "seconds between requests while not in a transaction, giving "
+                 "its slot back.  Applies to libevent connections.  0 "
+                 "disables.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sql_idle_timeout_sec, 0, NULL, NULL,
+                 NULL, NULL);
+
 REGISTER_TUNABLE("rep_release_wait_ms",
                  "Release sql-locks if rep-thd is blocked for this many ms."
                  "  (Default: 60000)",
@@ -1731,6 +2268,19 @@ REGISTER_TUNABLE(
     TUNABLE_INTEGER, &gbl_dohsql_full_queue_poll_msec, 0, NULL, NULL, NULL,
     NULL);
 
+REGISTER_TUNABLE(
+    "dohsql_agg_shards",
+    "Split single table COUNT/SUM/MIN/MAX queries into up to this many key "
+    "range shards, using the index samples from analyze (0 or 1 disables).",
+    TUNABLE_INTEGER, &gbl_dohsql_agg_shards, 0, NULL, NULL, NULL, NULL);
+
+REGISTER_TUNABLE(
+    "dohsql_remote_shards",
+    "Split plain single remote table scans into up to this many key range "
+    "shards fetched concurrently, using the remote index samples (0 or 1 "
+    "disables).",
+    TUNABLE_INTEGER, &gbl_dohsql_remote_shards, 0, NULL, NULL, NULL, NULL);
+
 REGISTER_TUNABLE("random_fail_client_write_lock",
                  "Force a random client write-lock failure 1/this many times.  "
                  "(Default: 0)",
@@ -1790,6 +2340,13 @@ REGISTER_TUNABLE("physrep_register_interval",
                  TUNABLE_INTEGER, &gbl_physrep_register_interval, 0, NULL, NULL,
                  NULL, NULL);
 
+REGISTER_TUNABLE("physrep_fetch_ahead",
+                 "Log records a physical replicant reads ahead of the one it "
+                 "is applying; 1 or less reads and applies in turn.  "
+                 "(Default: 1024)",
+                 TUNABLE_INTEGER, &gbl_physrep_fetch_ahead, 0, NULL, NULL,
+                 NULL, NULL);
+
 REGISTER_TUNABLE("blocking_physrep",
                  "Physical replicant blocks on select.  "
                  "(Default: false)",
@@ -1820,6 +2377,11 @@ REGISTER_TUNABLE("send_failed_dispatch_message",
                  TUNABLE_BOOLEAN, &gbl_send_failed_dispatch_message,
                  EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("csc2_version_cache",
+                 "Keep the parsed schemas of this many old table versions, so "
+                 "reloads do not parse their csc2 again. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_csc2_version_cache, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("legacy_schema", "Only allow legacy compatible csc2 schema",
                  TUNABLE_BOOLEAN, &gbl_legacy_schema,
                  EXPERIMENTAL | INTERNAL | READEARLY, NULL, NULL, NULL, NULL);
@@ -1854,6 +2416,10 @@ REGISTER_TUNABLE("libevent_appsock", "Use libevent for appsock connections. (Def
 REGISTER_TUNABLE("libevent_rte_only", "Prevent listening on TCP socket. (Default: off)",
                  TUNABLE_BOOLEAN, &gbl_libevent_rte_only, READONLY, 0, 0, 0, 0);
 
+REGISTER_TUNABLE("libevent_appsock_bases",
+                 "Event bases serving appsock connections; 0 for one per core. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_libevent_appsock_bases, READONLY, 0, 0, 0, 0);
+
 REGISTER_TUNABLE("online_recovery",
                  "Don't get the bdb-writelock for recovery.  (Default: on)",
                  TUNABLE_BOOLEAN, &gbl_online_recovery, EXPERIMENTAL | INTERNAL,
@@ -1922,6 +2488,13 @@ REGISTER_TUNABLE("debug_children_lock",
                  TUNABLE_BOOLEAN, &gbl_debug_children_lock,
                  EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("serial_write_cache_kb",
+                 "Size in KB of the cache on the master of keys written by "
+                 "recently committed transactions, used by serializable "
+                 "commit checks. "
+                 "0 disables the cache. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_serial_write_cache_kb, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("serialize_reads_like_writes",
                  "Send read-only multi-statement schedules to the master.  "
                  "(Default: off)",
@@ -1970,6 +2543,46 @@ REGISTER_TUNABLE("max_pages_per_cache_thread",
                  TUNABLE_INTEGER, &gbl_max_pages_per_cache_thread, INTERNAL,
                  NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("memp_ctier_mb",
+                 "Size in megabytes of the compressed tier that keeps clean "
+                 "pages evicted from the buffer pool.  0 disables it.  "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_memp_ctier_mb, 0, NULL, NULL, NULL,
+                 NULL);
+
+REGISTER_TUNABLE("memp_ctier_max_ratio",
+                 "Only keep an evicted page in the compressed tier if it "
+                 "compresses to this percentage of its size or less.  "
+                 "(Default: 75)",
+                 TUNABLE_INTEGER, &gbl_memp_ctier_max_ratio, 0, NULL, NULL,
+                 NULL, NULL);
+
+REGISTER_TUNABLE("memp_numa",
+                 "Bind buffer pool cache segments to NUMA nodes round-robin, "
+                 "rounding the segment count up to a multiple of the number "
+                 "of nodes.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_memp_numa, READONLY, NULL, NULL, NULL,
+                 NULL);
+
+REGISTER_TUNABLE("sql_numa_pin",
+                 "Pin each new SQL engine thread to the cpus of one NUMA "
+                 "node, round-robin.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_sql_numa_pin, 0, NULL, NULL, NULL,
+                 NULL);
+
+REGISTER_TUNABLE("memp_optimistic_fget",
+                 "Pin buffer pool pages that are already pinned by another "
+                 "thread without taking the hash bucket lock.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_memp_optimistic_fget, 0, NULL, NULL,
+                 NULL, NULL);
+
+REGISTER_TUNABLE("memp_scan_resistant",
+                 "Return pages read in by table scans to the cold end of the "
+                 "buffer pool, so scans don't flush the working set.  "
+                 "(Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_memp_scan_resistant, 0, NULL, NULL,
+                 NULL, NULL);
+
 REGISTER_TUNABLE("memp_dump_cache_threshold",
                  "Don't flush the cache until this percentage of pages have "
                  "changed.  (Default: 20)",
@@ -1997,6 +2610,12 @@ REGISTER_TUNABLE("longreq_log_freq_sec",
 
 REGISTER_TUNABLE("eventlog_nkeep", "Keep this many eventlog files (Default: 2)",
                  TUNABLE_INTEGER, &eventlog_nkeep, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("eventlog_queue_max",
+                 "Events queued for the eventlog thread before new ones are "
+                 "dropped; 0 writes them on the request thread. "
+                 "(Default: 10000)",
+                 TUNABLE_INTEGER, &gbl_eventlog_queue_max, 0, NULL, NULL,
+                 NULL, NULL);
 
 REGISTER_TUNABLE("waitalive_iterations",
                  "Wait this many iterations for a "
@@ -2032,6 +2651,52 @@ REGISTER_TUNABLE("debug_add_replication_latency", "Sleep after distributed commi
                  TUNABLE_BOOLEAN, &gbl_debug_add_replication_latency, EXPERIMENTAL | INTERNAL, 
                  NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("async_commit_ack",
+                 "Block processor threads leave the wait for replication of "
+                 "an osql commit to the commit ack thread. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_async_commit_ack, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("commit_ack_group_max",
+                 "Most osql commits the commit ack thread answers with a "
+                 "single wait for replication. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_commit_ack_group_max, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("counter_columns",
+                 "Comma separated table.column integer columns whose updates "
+                 "commute; a concurrent update of the row re-applies the "
+                 "delta instead of failing verification.",
+                 TUNABLE_STRING, &gbl_counter_columns, READONLY, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("counter_image_cache",
+                 "Replaced row versions of counter_columns tables the master "
+                 "remembers for rebasing updates. (Default: 10000)",
+                 TUNABLE_INTEGER, &gbl_counter_image_cache, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("zonemap_columns",
+                 "Comma separated table.column columns the master keeps zone "
+                 "maps (min and max per range of rows) of; full scans skip "
+                 "the ranges their WHERE clause rules out.",
+                 TUNABLE_STRING, &gbl_zonemap_columns, READONLY, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("zonemap_zone_rows",
+                 "Rows per zone of a zone map. (Default: 10000)",
+                 TUNABLE_INTEGER, &gbl_zonemap_zone_rows, NOZERO, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("zonemap_build_sec",
+                 "How often the master extends zone maps; 0 stops it. "
+                 "(Default: 60)",
+                 TUNABLE_INTEGER, &gbl_zonemap_build_sec, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("zonemap_refresh_sec",
+                 "How often a node loads newer zone maps. (Default: 60)",
+                 TUNABLE_INTEGER, &gbl_zonemap_refresh_sec, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("zonemap_max_zones",
+                 "Most zones a zone map has before neighbouring zones are "
+                 "merged. (Default: 65536)",
+                 TUNABLE_INTEGER, &gbl_zonemap_max_zones, NOZERO, NULL, NULL,
+                 NULL, NULL);
+
 REGISTER_TUNABLE("ref_sync_pollms",
                  "Set pollms for ref_sync thread.  "
                  "(Default: 250)",
@@ -2135,6 +2800,25 @@ REGISTER_TUNABLE(
     TUNABLE_INTEGER, &gbl_max_password_cache_size, 0, NULL, NULL,
     max_password_cache_size_update, NULL);
 
+REGISTER_TUNABLE("read_lsn_wait_ms",
+                 "How long a query carrying the client's last commit lsn waits "
+                 "for this node to apply it before asking the client to change "
+                 "nodes. (Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_read_lsn_wait_ms, 0, NULL, NULL, NULL,
+                 NULL);
+
+REGISTER_TUNABLE("sql_access_cache",
+                 "Remember the tables a session's user may read or write "
+                 "until llmeta changes. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_sql_access_cache, 0, NULL, NULL, NULL,
+                 NULL);
+
+REGISTER_TUNABLE("llmeta_cache_size",
+                 "Number of small llmeta records cached for reads outside of "
+                 "a transaction; 0 turns the cache off. (Default: 1024)",
+                 TUNABLE_INTEGER, &gbl_llmeta_cache_size, READONLY, NULL,
+                 NULL, NULL, NULL);
+
 REGISTER_TUNABLE("debug_systable_locks",
                  "Grab the comdb2_systables lock in every schema change.  "
                  "(Default: off)",
@@ -2154,6 +2838,12 @@ REGISTER_TUNABLE("permit_small_sequences", "Allow int32 and int16 length sequenc
 REGISTER_TUNABLE("max_trigger_threads", "Maximum number of trigger threads allowed", TUNABLE_INTEGER,
                  &gbl_max_trigger_threads, 0, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("deferred_trigger_batch",
+                 "Most transactions whose deferred trigger events are enqueued "
+                 "in one transaction.  (Default: 100)",
+                 TUNABLE_INTEGER, &gbl_deferred_trigger_batch, NOZERO, NULL,
+                 NULL, NULL, NULL);
+
 REGISTER_TUNABLE("test_fdb_io", "Testing fail mode remote sql.  (Default: off)",
                  TUNABLE_BOOLEAN, &gbl_test_io_errors, INTERNAL, NULL, NULL,
                  NULL, NULL);
@@ -184,6 +184,59 @@ int dbqueuedb_get_stats(struct dbtable *db, struct consumer_stat *stats, uint32_
     return rc;
 }
 
+void dbqueuedb_count_dequeue(struct dbtable *db, int redelivered)
+{
+    struct queue_consumer_stats *s = &db->consumer_stats;
+    Pthread_mutex_lock(&db->consumer_stats_lk);
+    s->dequeued++;
+    if (redelivered)
+        s->redelivered++;
+    Pthread_mutex_unlock(&db->consumer_stats_lk);
+}
+
+/* n events consumed, latency_ms after the oldest of them was handed out */
+void dbqueuedb_count_ack(struct dbtable *db, int n, int64_t latency_ms)
+{
+    struct queue_consumer_stats *s = &db->consumer_stats;
+    int64_t now = comdb2_time_epoch();
+    int b = 0;
+    if (latency_ms < 0)
+        latency_ms = 0;
+    while (b < QUEUE_ACK_BUCKETS - 1 && latency_ms >= (1LL << b))
+        b++;
+    Pthread_mutex_lock(&db->consumer_stats_lk);
+    s->acked += n;
+    s->ack_total_ms += latency_ms * n;
+    if (latency_ms > s->ack_max_ms)
+        s->ack_max_ms = latency_ms;
+    s->ack_hist[b] += n;
+    if (s->rate_sec != now) {
+        s->rate_prev = s->rate_sec == now - 1 ? s->rate_cnt : 0;
+        s->rate_sec = now;
+        s->rate_cnt = 0;
+    }
+    s->rate_cnt += n;
+    Pthread_mutex_unlock(&db->consumer_stats_lk);
+}
+
+/* Copies out the consumer stats and returns the acks in the last whole
+ * second */
+int64_t dbqueuedb_get_consumer_stats(struct dbtable *db,
+                                     struct queue_consumer_stats *stats)
+{
+    int64_t now = comdb2_time_epoch(), rate;
+    Pthread_mutex_lock(&db->consumer_stats_lk);
+    *stats = db->consumer_stats;
+    Pthread_mutex_unlock(&db->consumer_stats_lk);
+    if (stats->rate_sec == now)
+        rate = stats->rate_prev;
+    else if (stats->rate_sec == now - 1)
+        rate = stats->rate_cnt;
+    else
+        rate = 0;
+    return rate;
+}
+
 int queue_consume(struct ireq* iq, const void* fnd, int consumern)
 {
     const int sleeptime = 1;
@@ -20,9 +20,12 @@
 #include "ast.h"
 #include "dohsql.h"
 #include "sql.h"
+#include "memcompare.c"
 
 int gbl_dohast_disable = 0;
 int gbl_dohast_verbose = 0;
+int gbl_dohsql_agg_shards = 0;
+int gbl_dohsql_remote_shards = 0;
 
 static void node_free(dohsql_node_t **pnode, sqlite3 *db);
 static void _save_params(Parse *pParse, dohsql_node_t *node);
@@ -167,7 +170,8 @@ Expr *_find_join_constrains(Expr *where, int iRightJoinTable)
 
 char *sqlite_struct_to_string(Vdbe *v, Select *p, Expr *extraRows,
                               int *order_size, int **order_dir,
-                              struct params_info **pParamsOut, int is_union)
+                              struct params_info **pParamsOut, int is_union,
+                              const char *shard_where)
 {
     char *cols = NULL;
     char *tbl = NULL;
@@ -207,6 +211,19 @@ char *sqlite_struct_to_string(Vdbe *v, Select *p, Expr *extraRows,
         }
     }
 
+    /* restrict a key range shard */
+    if (shard_where) {
+        char *tmp;
+        if (where)
+            tmp = sqlite3_mprintf("(%s) aND %s", where, shard_where);
+        else
+            tmp = sqlite3_mprintf("%s", shard_where);
+        sqlite3_free(where);
+        if (!tmp)
+            return NULL;
+        where = tmp;
+    }
+
     if (p->pOrderBy) {
         orderby = describeExprList(v, p->pOrderBy, order_size, order_dir,
                                    pParamsOut, is_union);
@@ -484,7 +501,7 @@ static dohsql_node_t *gen_oneselect(Vdbe *v, Select *p, Expr *extraRows,
     node->type = AST_TYPE_SELECT;
     p->pPrior = p->pNext = NULL;
     node->sql = sqlite_struct_to_string(v, p, extraRows, order_size, order_dir,
-                                        &node->params, is_union);
+                                        &node->params, is_union, NULL);
     p->pPrior = prior;
     p->pNext = next;
 
@@ -526,6 +543,7 @@ static void node_free(dohsql_node_t **pnode, sqlite3 *db)
     if ((*pnode)->order_dir) {
         free((*pnode)->order_dir);
     }
+    free((*pnode)->aggs);
     free(*pnode);
     *pnode = NULL;
 }
@@ -644,6 +662,300 @@ done:
     return node;
 }
 
+/**
+ * Single table aggregates
+ *
+ * A select over one table whose result columns are all count, sum, min or
+ * max aggregates can be split into key ranges of one of the table's
+ * indexes.  Each shard computes the partial aggregates over its range and
+ * the coordinator merges them (see dohsql_dist_next_row_agg).  Range
+ * boundaries come from the sqlite_stat4 samples of the index, so the
+ * shards get about the same number of rows; without analyze the query
+ * runs serially as before.
+ */
+static int _agg_column_op(Expr *expr)
+{
+    Expr *arg;
+    int nargs;
+
+    if (expr->op != TK_AGG_FUNCTION ||
+        ExprHasProperty(expr, EP_Distinct | EP_WinFunc))
+        return DOHSQL_AGG_NONE;
+
+    nargs = expr->x.pList ? expr->x.pList->nExpr : 0;
+    if (strcasecmp(expr->u.zToken, "count") == 0)
+        return (nargs <= 1) ? DOHSQL_AGG_COUNT : DOHSQL_AGG_NONE;
+
+    if (nargs != 1)
+        return DOHSQL_AGG_NONE;
+    arg = expr->x.pList->a[0].pExpr;
+    if (arg->op != TK_COLUMN || !arg->y.pTab || arg->iColumn < 0)
+        return DOHSQL_AGG_NONE;
+
+    if (strcasecmp(expr->u.zToken, "sum") == 0) {
+        /* integer and real sums only, decimals keep their own arithmetic */
+        char aff = arg->y.pTab->aCol[arg->iColumn].affinity;
+        return (aff == SQLITE_AFF_INTEGER || aff == SQLITE_AFF_REAL)
+                   ? DOHSQL_AGG_SUM
+                   : DOHSQL_AGG_NONE;
+    }
+    if (strcasecmp(expr->u.zToken, "min") == 0)
+        return DOHSQL_AGG_MIN;
+    if (strcasecmp(expr->u.zToken, "max") == 0)
+        return DOHSQL_AGG_MAX;
+    return DOHSQL_AGG_NONE;
+}
+
+/* Read the leading column of an index sample */
+static int _sample_first_field(IndexSample *sample, Mem *m)
+{
+    const unsigned char *a = (const unsigned char *)sample->p;
+    u32 hdr, t;
+    int ihdr;
+
+    ihdr = getVarint32(a, hdr);
+    if (hdr > sample->n || ihdr >= hdr)
+        return -1;
+    getVarint32(&a[ihdr], t);
+    if (hdr + sqlite3VdbeSerialTypeLen(t) > sample->n)
+        return -1;
+    sqlite3VdbeSerialGet(&a[hdr], t, m);
+    switch (sqlite3_value_type(m)) {
+    case SQLITE_INTEGER:
+    case SQLITE_FLOAT:
+    case SQLITE_TEXT:
+    case SQLITE_BLOB:
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+static char *_sample_literal(Mem *m)
+{
+    switch (sqlite3_value_type(m)) {
+    case SQLITE_INTEGER:
+        return sqlite3_mprintf("%lld", sqlite3_value_int64(m));
+    case SQLITE_FLOAT:
+        return sqlite3_mprintf("%!.17g", sqlite3_value_double(m));
+    case SQLITE_TEXT: {
+        char *txt = sqlite3_mprintf("%.*s", sqlite3_value_bytes(m),
+                                    sqlite3_value_text(m));
+        char *ret = txt ? sqlite3_mprintf("%Q", txt) : NULL;
+        sqlite3_free(txt);
+        return ret;
+    }
+    case SQLITE_BLOB: {
+        const unsigned char *b = sqlite3_value_blob(m);
+        int n = sqlite3_value_bytes(m);
+        char *ret = sqlite3_malloc(2 * n + 4);
+        if (!ret)
+            return NULL;
+        ret[0] = 'x';
+        ret[1] = '\'';
+        for (int i = 0; i < n; i++)
+            sprintf(&ret[2 + 2 * i], "%02x", b[i]);
+        ret[2 + 2 * n] = '\'';
+        ret[3 + 2 * n] = '\0';
+        return ret;
+    }
+    }
+    return NULL;
+}
+
+/* Pick up to maxshards - 1 increasing boundaries for the leading column of
+ * the best sampled index of the table; returns the number of boundaries */
+static int _agg_shard_bounds(Table *pTab, int maxshards, int *iColumn,
+                             char **bounds)
+{
+    Index *pIdx, *best = NULL;
+    Mem prev, crt;
+    int nbounds = 0;
+
+    for (pIdx = pTab->pIndex; pIdx; pIdx = pIdx->pNext) {
+        if (pIdx->nSample < maxshards || pIdx->aiColumn[0] < 0 ||
+            pIdx->aSortOrder[0] != SQLITE_SO_ASC ||
+            (pIdx->azColl[0] &&
+             sqlite3StrICmp(pIdx->azColl[0], sqlite3StrBINARY) != 0))
+            continue;
+        if (!best || pIdx->nSample > best->nSample)
+            best = pIdx;
+    }
+    if (!best)
+        return 0;
+
+    for (int i = 1; i < maxshards; i++) {
+        IndexSample *sample = &best->aSample[(i * best->nSample) / maxshards];
+
+        memset(&crt, 0, sizeof(crt));
+        if (_sample_first_field(sample, &crt))
+            continue;
+        /* samples are ordered; skip repeats of a popular leading value */
+        if (nbounds > 0 && sqlite3MemCompare(&crt, &prev, NULL) <= 0)
+            continue;
+        if ((bounds[nbounds] = _sample_literal(&crt)) == NULL)
+            break;
+        prev = crt;
+        nbounds++;
+    }
+    *iColumn = best->aiColumn[0];
+    return nbounds;
+}
+
+/* Split the single table select p into key ranges of the leading column of
+ * its best sampled index, run as a union of up to maxshards selects; aggs,
+ * if not NULL, says how to merge the shards' partial aggregates */
+static dohsql_node_t *gen_range_shards(Vdbe *v, Select *p, int maxshards,
+                                       int *aggs)
+{
+    dohsql_node_t *node = NULL;
+    Table *pTab = p->pSrc->a[0].pTab;
+    char **bounds = NULL;
+    int nbounds = 0, iColumn = -1;
+    int i;
+
+    bounds = calloc(maxshards, sizeof(char *));
+    if (!bounds)
+        goto done;
+
+    nbounds = _agg_shard_bounds(pTab, maxshards, &iColumn, bounds);
+    if (nbounds == 0)
+        goto done;
+
+    node = (dohsql_node_t *)calloc(1, sizeof(dohsql_node_t) +
+                                          (nbounds + 1) * sizeof(void *));
+    if (!node)
+        goto done;
+    node->type = AST_TYPE_UNION;
+    node->nodes = (dohsql_node_t **)(node + 1);
+    node->nnodes = nbounds + 1;
+    node->ncols = p->pEList->nExpr;
+
+    const char *col = pTab->aCol[iColumn].zName;
+    for (i = 0; i <= nbounds; i++) {
+        char *range;
+        dohsql_node_t *shard;
+
+        if (i == 0)
+            range = sqlite3_mprintf("(\"%w\" < %s oR \"%w\" iS NuLL)", col,
+                                    bounds[0], col);
+        else if (i == nbounds)
+            range = sqlite3_mprintf("\"%w\" >= %s", col, bounds[i - 1]);
+        else
+            range = sqlite3_mprintf("\"%w\" >= %s aND \"%w\" < %s", col,
+                                    bounds[i - 1], col, bounds[i]);
+        shard = calloc(1, sizeof(dohsql_node_t));
+        node->nodes[i] = shard;
+        if (!range || !shard) {
+            sqlite3_free(range);
+            node_free(&node, v->db);
+            goto done;
+        }
+        shard->type = AST_TYPE_SELECT;
+        shard->ncols = node->ncols;
+        shard->sql = sqlite_struct_to_string(v, p, NULL, &shard->order_size,
+                                             &shard->order_dir, &shard->params,
+                                             0, range);
+        sqlite3_free(range);
+        if (!shard->sql) {
+            node_free(&node, v->db);
+            goto done;
+        }
+        char *tmp = node->sql ? sqlite3_mprintf("%s uNioN aLL %s", node->sql,
+                                                shard->sql)
+                              : sqlite3_mprintf("%s", shard->sql);
+        sqlite3_free(node->sql);
+        node->sql = tmp;
+        if (!tmp) {
+            node_free(&node, v->db);
+            goto done;
+        }
+    }
+    node->aggs = aggs;
+
+done:
+    if (bounds) {
+        for (i = 0; i < nbounds; i++)
+            sqlite3_free(bounds[i]);
+        free(bounds);
+    }
+    return node;
+}
+
+static int _max_shards(int shards)
+{
+    if (gbl_dohsql_max_threads && shards > gbl_dohsql_max_threads)
+        shards = gbl_dohsql_max_threads;
+    return shards;
+}
+
+static dohsql_node_t *gen_agg_shards(Vdbe *v, Select *p)
+{
+    dohsql_node_t *node;
+    Table *pTab;
+    int *aggs;
+    int maxshards;
+    int i;
+
+    maxshards = _max_shards(gbl_dohsql_agg_shards);
+    if (maxshards < 2)
+        return NULL;
+
+    if (p->pPrior || p->pSrc->nSrc != 1 || p->pGroupBy || p->pHaving ||
+        p->pOrderBy || p->pLimit || p->pWith || (p->selFlags & SF_Distinct) ||
+        !(p->selFlags & SF_Aggregate))
+        return NULL;
+    pTab = p->pSrc->a[0].pTab;
+    /* remote tables have the samples of their own analyze */
+    if (!pTab || pTab->iDb == 1 || IsVirtual(pTab) || pTab->pSelect)
+        return NULL;
+
+    aggs = calloc(p->pEList->nExpr, sizeof(int));
+    if (!aggs)
+        return NULL;
+    for (i = 0; i < p->pEList->nExpr; i++) {
+        if ((aggs[i] = _agg_column_op(p->pEList->a[i].pExpr)) ==
+            DOHSQL_AGG_NONE) {
+            free(aggs);
+            return NULL;
+        }
+    }
+
+    node = gen_range_shards(v, p, maxshards, aggs);
+    if (!node)
+        free(aggs);
+    return node;
+}
+
+/**
+ * Remote table scans
+ *
+ * A plain select over one remote table spends its time waiting on the
+ * remote database, so it is split into key ranges the same way as single
+ * table aggregates, and the ranges are fetched concurrently.  The rows come
+ * back in no particular order, so ORDER BY, LIMIT and DISTINCT keep the
+ * query serial.
+ */
+static dohsql_node_t *gen_remote_shards(Vdbe *v, Select *p)
+{
+    Table *pTab;
+    int maxshards;
+
+    maxshards = _max_shards(gbl_dohsql_remote_shards);
+    if (maxshards < 2)
+        return NULL;
+
+    if (p->pPrior || p->pSrc->nSrc != 1 || p->pGroupBy || p->pHaving ||
+        p->pOrderBy || p->pLimit || p->pWith || (p->selFlags & SF_Distinct) ||
+        (p->selFlags & SF_Aggregate))
+        return NULL;
+    pTab = p->pSrc->a[0].pTab;
+    if (!pTab || pTab->iDb <= 1 || IsVirtual(pTab) || pTab->pSelect)
+        return NULL;
+
+    return gen_range_shards(v, p, maxshards, NULL);
+}
+
 static int skip_tables(Select *p)
 {
     int i;
@@ -695,9 +1007,14 @@ static dohsql_node_t *gen_select(Vdbe *v, Select *p)
     )
         return NULL;
 
-    if (p->op == TK_SELECT)
-        ret = gen_oneselect(v, p, NULL, NULL, NULL, 0);
-    else
+    if (p->op == TK_SELECT) {
+        if (gbl_dohsql_agg_shards > 1)
+            ret = gen_agg_shards(v, p);
+        if (!ret && gbl_dohsql_remote_shards > 1)
+            ret = gen_remote_shards(v, p);
+        if (!ret)
+            ret = gen_oneselect(v, p, NULL, NULL, NULL, 0);
+    } else
         ret = gen_union(v, p, span);
 
     return ret;
@@ -900,7 +1217,10 @@ static int _exprCallback(Walker *pWalker, Expr *pExpr)
         }
         return WRC_Abort;
     case TK_AGG_FUNCTION:
-        if (strcasecmp(pExpr->u.zToken, "count") == 0) {
+        if (strcasecmp(pExpr->u.zToken, "count") == 0 ||
+            strcasecmp(pExpr->u.zToken, "sum") == 0 ||
+            strcasecmp(pExpr->u.zToken, "min") == 0 ||
+            strcasecmp(pExpr->u.zToken, "max") == 0) {
             return WRC_Continue;
         }
         /* fallthrough */
@@ -19,6 +19,7 @@
 #include "sql.h"
 #include "shard_range.h"
 #include "sqliteInt.h"
+#include "vdbeInt.h"
 #include "queue.h"
 #include "reqlog.h"
 #include "dohsql.h"
@@ -122,6 +123,10 @@ struct dohsql {
     int order_size;
     int *order_dir;
     int nparams;
+    /* partial aggregates support */
+    int *aggs;     /* merge operation per column, if any */
+    Mem *agg_row;  /* merged result row */
+    int agg_ready; /* agg_row holds the final row */
     /* stats */
     dohsql_req_stats_t stats;
     struct plugin_callbacks backup;
@@ -149,6 +154,7 @@ static void sqlengine_work_shard(struct thdpool *pool, void *work,
 static int order_init(dohsql_t *conns, dohsql_node_t *node);
 static int dohsql_dist_next_row_ordered(struct sqlclntstate *clnt,
                                         sqlite3_stmt *stmt);
+static int dohsql_dist_next_row(struct sqlclntstate *clnt, sqlite3_stmt *stmt);
 static int _param_index(dohsql_connector_t *conn, const char *b, int64_t *c);
 static int _param_value(dohsql_connector_t *conn, struct param_data *b, int c,
                         const char *src);
@@ -473,6 +479,8 @@ static int dohsql_dist_column_count(struct sqlclntstate *clnt, sqlite3_stmt *_)
                                          sqlite3_stmt *stmt, int iCol)         \
     {                                                                          \
         dohsql_t *conns = clnt->conns;                                         \
+        if (conns->agg_ready)                                                  \
+            return sqlite3_value_##type(&conns->agg_row[iCol]);                \
         if (conns->row_src == 0)                                               \
             return sqlite3_column_##type(stmt, iCol);                          \
         if (!conns->row->unpacked) {                                           \
@@ -495,6 +503,8 @@ static const intv_t *dohsql_dist_column_interval(struct sqlclntstate *clnt,
                                                  int type)
 {
     dohsql_t *conns = clnt->conns;
+    if (conns->agg_ready)
+        return sqlite3_value_interval(&conns->agg_row[iCol], type);
     if (conns->row_src == 0)
         return sqlite3_column_interval(stmt, iCol, type);
 
@@ -510,6 +520,8 @@ static sqlite3_value *dohsql_dist_column_value(struct sqlclntstate *clnt,
 {
     dohsql_t *conns = clnt->conns;
 
+    if (conns->agg_ready)
+        return &conns->agg_row[i];
     if (conns->row_src == 0)
         return sqlite3_column_value(stmt, i);
 
@@ -775,6 +787,77 @@ static int _check_offset(dohsql_t *conns)
     return SQLITE_ROW;
 }
 
+/**
+ * fold one shard's partial aggregates into the merged row
+ *
+ */
+static void agg_merge_row(struct sqlclntstate *clnt, sqlite3_stmt *stmt)
+{
+    dohsql_t *conns = clnt->conns;
+    int i;
+
+    for (i = 0; i < conns->ncols; i++) {
+        Mem *acc = &conns->agg_row[i];
+        Mem *val = dohsql_dist_column_value(clnt, stmt, i);
+        i64 sum;
+
+        if (sqlite3_value_type(val) == SQLITE_NULL)
+            continue;
+        if (acc->flags & MEM_Null) {
+            sqlite3VdbeMemCopy(acc, val);
+            continue;
+        }
+
+        switch (conns->aggs[i]) {
+        case DOHSQL_AGG_COUNT:
+            sqlite3VdbeMemSetInt64(acc, sqlite3_value_int64(acc) +
+                                            sqlite3_value_int64(val));
+            break;
+        case DOHSQL_AGG_SUM:
+            sum = sqlite3_value_int64(acc);
+            if (sqlite3_value_type(acc) == SQLITE_INTEGER &&
+                sqlite3_value_type(val) == SQLITE_INTEGER &&
+                sqlite3AddInt64(&sum, sqlite3_value_int64(val)) == 0)
+                sqlite3VdbeMemSetInt64(acc, sum);
+            else
+                sqlite3VdbeMemSetDouble(acc, sqlite3_value_double(acc) +
+                                                 sqlite3_value_double(val));
+            break;
+        case DOHSQL_AGG_MIN:
+            if (sqlite3MemCompare(val, acc, NULL) < 0)
+                sqlite3VdbeMemCopy(acc, val);
+            break;
+        case DOHSQL_AGG_MAX:
+            if (sqlite3MemCompare(val, acc, NULL) > 0)
+                sqlite3VdbeMemCopy(acc, val);
+            break;
+        }
+    }
+}
+
+/**
+ * each shard returns one row of partial aggregates (count, sum, min, max);
+ * fold all of them and return the single merged row
+ *
+ */
+static int dohsql_dist_next_row_agg(struct sqlclntstate *clnt,
+                                    sqlite3_stmt *stmt)
+{
+    dohsql_t *conns = clnt->conns;
+    int rc;
+
+    if (conns->agg_ready)
+        return SQLITE_DONE;
+
+    while ((rc = dohsql_dist_next_row(clnt, stmt)) == SQLITE_ROW)
+        agg_merge_row(clnt, stmt);
+    if (rc != SQLITE_DONE)
+        return rc;
+
+    conns->agg_ready = 1;
+    return SQLITE_ROW;
+}
+
 /**
  * this is a non-ordered merge of N engine outputs
  *
@@ -1096,8 +1179,12 @@ static void _master_clnt_set(struct sqlclntstate *clnt)
     clnt->conns->backup = clnt->plugin;
 
     clnt->plugin.column_count = dohsql_dist_column_count;
-    clnt->plugin.next_row = (clnt->conns->order) ? dohsql_dist_next_row_ordered
-                                                 : dohsql_dist_next_row;
+    if (clnt->conns->order)
+        clnt->plugin.next_row = dohsql_dist_next_row_ordered;
+    else if (clnt->conns->aggs)
+        clnt->plugin.next_row = dohsql_dist_next_row_agg;
+    else
+        clnt->plugin.next_row = dohsql_dist_next_row;
     clnt->plugin.column_type = dohsql_dist_column_type;
     clnt->plugin.column_int64 = dohsql_dist_column_int64;
     clnt->plugin.column_double = dohsql_dist_column_double;
@@ -1226,6 +1313,16 @@ int dohsql_distribute(dohsql_node_t *node)
             return SHARD_ERR_MALLOC;
         }
         flags = THDPOOL_FORCE_DISPATCH;
+    } else if (node->aggs) {
+        conns->agg_row = (Mem *)calloc(conns->ncols, sizeof(Mem));
+        if (!conns->agg_row) {
+            free(conns);
+            return SHARD_ERR_MALLOC;
+        }
+        for (i = 0; i < conns->ncols; i++)
+            sqlite3VdbeMemInit(&conns->agg_row[i], NULL, MEM_Null);
+        conns->aggs = node->aggs;
+        node->aggs = NULL;
     }
     clnt->conns = conns;
     /* augment interface */
@@ -1352,6 +1449,12 @@ int dohsql_end_distribute(struct sqlclntstate *clnt, struct reqlogger *logger)
         free(conns->order);
         free(conns->order_dir);
     }
+    if (conns->aggs) {
+        for (i = 0; i < conns->ncols; i++)
+            sqlite3VdbeMemRelease(&conns->agg_row[i]);
+        free(conns->agg_row);
+        free(conns->aggs);
+    }
     _master_clnt_reset(clnt);
     clnt->conns = NULL;
     free(conns);
@@ -1972,6 +2075,12 @@ void explain_distribution(dohsql_node_t *node)
         if (write_response(clnt, RESPONSE_ROW_STR, &pstr, 1))
             return;
 
+        if (node->aggs) {
+            snprintf(str, sizeof(str), "Merge partial aggregates");
+            if (write_response(clnt, RESPONSE_ROW_STR, &pstr, 1))
+                return;
+        }
+
         for (i = 0; i < node->nnodes; i++) {
             if (write_response(clnt, RESPONSE_ROW_STR, &node->nodes[i]->sql, 1))
                 return;
@@ -25,6 +25,15 @@ struct params_info {
     struct param_data *params;
 };
 
+/* How the coordinator merges a column of the per shard rows */
+enum dohsql_agg {
+    DOHSQL_AGG_NONE = 0,
+    DOHSQL_AGG_COUNT = 1,
+    DOHSQL_AGG_SUM = 2,
+    DOHSQL_AGG_MIN = 3,
+    DOHSQL_AGG_MAX = 4
+};
+
 struct dohsql_node {
     enum ast_type type;
     char *sql;
@@ -35,6 +44,7 @@ struct dohsql_node {
     int *order_dir;
     int nparams;
     struct params_info *params;
+    int *aggs; /* per column dohsql_agg, if shards return partial aggregates */
 };
 typedef struct dohsql_node dohsql_node_t;
 
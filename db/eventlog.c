@@ -47,6 +47,8 @@
 #include "string_ref.h"
 
 extern int64_t comdb2_time_epochus(void);
+extern hash_t *gbl_fingerprint_hash;
+extern pthread_mutex_t gbl_fingerprint_hash_mu;
 
 static int gbl_print_cnonce_as_hex = 1;
 static char *gbl_eventlog_fname = NULL;
@@ -63,7 +65,32 @@ static pthread_mutex_t eventlog_lk = PTHREAD_MUTEX_INITIALIZER;
 static int eventlog_every_n = 1;
 static int64_t eventlog_count = 0;
 
+/* Events are serialised on the request thread and queued; the eventlog
+ * thread does the compression and rolling.  Past
+ * gbl_eventlog_queue_max queued events new ones are dropped and counted;
+ * 0 writes on the request thread as before. */
+int gbl_eventlog_queue_max = 10000;
+
+struct eventlog_ent {
+    cson_writer *w;
+    int newsql;                 /* may need a "newsql" event first */
+    struct string_ref *sql_ref; /* for the "newsql" event */
+    int64_t startus;
+    char fingerprint[FINGERPRINTSZ];
+    LINKC_T(struct eventlog_ent) lnk;
+};
+
+static pthread_mutex_t eventlog_q_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t eventlog_q_cond = PTHREAD_COND_INITIALIZER;
+/* keeps batches in order when the thread and a command both drain */
+static pthread_mutex_t eventlog_drain_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t eventlog_thd_once = PTHREAD_ONCE_INIT;
+typedef LISTC_T(struct eventlog_ent) eventlog_ent_list;
+static eventlog_ent_list eventlog_q;
+static int64_t eventlog_dropped = 0;
+
 static void eventlog_roll(void);
+static void eventlog_roll_cleanup();
 #define min(x, y) ((x) < (y) ? (x) : (y))
 
 struct sqltrack {
@@ -182,6 +209,7 @@ void eventlog_init()
 {
     seen_sql = hash_init_o(offsetof(struct sqltrack, fingerprint), FINGERPRINTSZ);
     listc_init(&sql_statements, offsetof(struct sqltrack, lnk));
+    listc_init(&eventlog_q, offsetof(struct eventlog_ent, lnk));
     char *fname = eventlog_fname(thedb->envname);
     if (eventlog_enabled) eventlog = eventlog_open(fname, 0);
 }
@@ -318,59 +346,59 @@ void eventlog_bind_interval(cson_array *arr, const char *name, intv_t *tv)
     eventlog_append_value(arr, name, type, cson_value_new_string(str, n));
 }
 
-void eventlog_tables(cson_object *obj, const struct reqlogger *logger)
+void eventlog_tables(cson_writer *w, const struct reqlogger *logger)
 {
     if (logger->ntables == 0) return;
 
-    cson_value *tables = cson_value_new_array();
-    cson_array *arr = cson_value_get_array(tables);
-
-    for (int i = 0; i < logger->ntables; i++) {
-        cson_value *v = cson_value_new_string(logger->sqltables[i],
-                                              strlen(logger->sqltables[i]));
-        cson_array_append(arr, v);
-    }
-
-    cson_object_set(obj, "tables", tables);
+    cson_writer_array_begin(w, "tables");
+    for (int i = 0; i < logger->ntables; i++)
+        cson_writer_string(w, NULL, logger->sqltables[i],
+                           strlen(logger->sqltables[i]));
+    cson_writer_array_end(w);
 }
 
-void eventlog_perfdata(cson_object *obj, const struct reqlogger *logger)
+void eventlog_perfdata(cson_writer *w, const struct reqlogger *logger)
 {
     const struct berkdb_thread_stats *thread_stats = bdb_get_thread_stats();
 
-    cson_value *perfval = cson_value_new_object();
-    cson_object *perfobj = cson_value_get_object(perfval);
-
-    cson_object_set(perfobj, "tottime", cson_new_int(logger->durationus));
-    cson_object_set(perfobj, "processingtime",
-                    cson_new_int(logger->durationus - logger->queuetimeus));
+    cson_writer_object_begin(w, "perf");
+    cson_writer_int(w, "tottime", logger->durationus);
+    cson_writer_int(w, "processingtime",
+                    logger->durationus - logger->queuetimeus);
     if (logger->queuetimeus)
-        cson_object_set(perfobj, "qtime", cson_new_int(logger->queuetimeus));
+        cson_writer_int(w, "qtime", logger->queuetimeus);
 
     if (thread_stats->n_lock_waits || thread_stats->n_preads ||
         thread_stats->n_pwrites || thread_stats->pread_time_us ||
         thread_stats->pwrite_time_us || thread_stats->lock_wait_time_us) {
         if (thread_stats->n_lock_waits) {
             // NB: lockwaits/lockwaittime accumulate over deadlock/retries
-            cson_object_set(perfobj, "lockwaits",
-                            cson_new_int(thread_stats->n_lock_waits));
-            cson_object_set(perfobj, "lockwaittime",
-                            cson_new_int(thread_stats->lock_wait_time_us));
+            cson_writer_int(w, "lockwaits", thread_stats->n_lock_waits);
+            cson_writer_int(w, "lockwaittime",
+                            thread_stats->lock_wait_time_us);
         }
         if (thread_stats->n_preads) {
-            cson_object_set(perfobj, "reads",
-                            cson_new_int(thread_stats->n_preads));
-            cson_object_set(perfobj, "readtime",
-                            cson_new_int(thread_stats->pread_time_us));
+            cson_writer_int(w, "reads", thread_stats->n_preads);
+            cson_writer_int(w, "readtime", thread_stats->pread_time_us);
         }
         if (thread_stats->n_pwrites) {
-            cson_object_set(perfobj, "writes",
-                            cson_new_int(thread_stats->n_pwrites));
-            cson_object_set(perfobj, "writetime",
-                            cson_new_int(thread_stats->pwrite_time_us));
+            cson_writer_int(w, "writes", thread_stats->n_pwrites);
+            cson_writer_int(w, "writetime", thread_stats->pwrite_time_us);
         }
     }
-    cson_object_set(obj, "perf", perfval);
+
+    int stages = 0;
+    for (int i = 0; i < REQL_NSTAGES; i++) {
+        if (logger->stageus[i] == 0)
+            continue;
+        if (!stages++)
+            cson_writer_object_begin(w, "stages");
+        cson_writer_int(w, reqlog_stage_name(i), logger->stageus[i]);
+    }
+    if (stages)
+        cson_writer_object_end(w);
+
+    cson_writer_object_end(w);
 }
 
 static int write_json(void *state, const void *src, unsigned int n)
@@ -380,119 +408,114 @@ static int write_json(void *state, const void *src, unsigned int n)
     return rc != n;
 }
 
-static void eventlog_context(cson_object *obj, const struct reqlogger *logger)
+static int write_json_FILE(void *state, const void *src, unsigned int n)
+{
+    return fwrite(src, n, 1, state) != 1;
+}
+
+static void eventlog_context(cson_writer *w, const struct reqlogger *logger)
 {
     if (logger->ncontext > 0) {
-        cson_value *contexts = cson_value_new_array();
-        cson_array *arr = cson_value_get_array(contexts);
-        for (int i = 0; i < logger->ncontext; i++) {
-            cson_value *v = cson_value_new_string(logger->context[i],
-                                                  strlen(logger->context[i]));
-            cson_array_append(arr, v);
-        }
-        cson_object_set(obj, "context", contexts);
+        cson_writer_array_begin(w, "context");
+        for (int i = 0; i < logger->ncontext; i++)
+            cson_writer_string(w, NULL, logger->context[i],
+                               strlen(logger->context[i]));
+        cson_writer_array_end(w);
     }
 }
 
-static void eventlog_path(cson_object *obj, const struct reqlogger *logger)
+static void eventlog_path(cson_writer *w, const struct reqlogger *logger)
 {
     if (eventlog == NULL || !eventlog_enabled)
         return;
 
     if (!logger->path || logger->path->n_components == 0) return;
 
-    cson_value *components = cson_value_new_array();
-    cson_array *arr = cson_value_get_array(components);
-
+    cson_writer_array_begin(w, "path");
     for (int i = 0; i < logger->path->n_components; i++) {
-        cson_value *component;
-        component = cson_value_new_object();
-        cson_object *lobj = cson_value_get_object(component);
         struct client_query_path_component *c;
         c = &logger->path->path_stats[i];
+        cson_writer_object_begin(w, NULL);
         if (c->table[0])
-            cson_object_set(lobj, "table",
-                            cson_value_new_string(c->table, strlen(c->table)));
+            cson_writer_string(w, "table", c->table, strlen(c->table));
         if (c->ix != -1)
-            cson_object_set(lobj, "index", cson_new_int(c->ix));
+            cson_writer_int(w, "index", c->ix);
         if (c->nfind)
-            cson_object_set(lobj, "find", cson_new_int(c->nfind));
+            cson_writer_int(w, "find", c->nfind);
         if (c->nnext)
-            cson_object_set(lobj, "next", cson_new_int(c->nnext));
+            cson_writer_int(w, "next", c->nnext);
         if (c->nwrite)
-            cson_object_set(lobj, "write", cson_new_int(c->nwrite));
-        cson_array_append(arr, component);
+            cson_writer_int(w, "write", c->nwrite);
+        cson_writer_object_end(w);
     }
-    cson_object_set(obj, "path", components);
+    cson_writer_array_end(w);
 }
 
 /* add never seen before "newsql" query, also print it to log */
-static void eventlog_add_newsql(const struct reqlogger *logger)
+static void eventlog_add_newsql(const struct eventlog_ent *e)
 {
     struct sqltrack *st;
     st = malloc(sizeof(struct sqltrack));
-    memcpy(st->fingerprint, logger->fingerprint, sizeof(logger->fingerprint));
+    memcpy(st->fingerprint, e->fingerprint, sizeof(e->fingerprint));
     hash_add(seen_sql, st);
     listc_abl(&sql_statements, st);
 
-    cson_value *newval;
-    cson_object *newobj;
-    newval = cson_value_new_object();
-    newobj = cson_value_get_object(newval);
-
-    cson_object_set(newobj, "time", cson_new_int(logger->startus));
-    cson_object_set(newobj, "type",
-            cson_value_new_string("newsql", strlen("newsql")));
+    cson_writer *w = cson_writer_new();
+    cson_writer_object_begin(w, NULL);
+    cson_writer_int(w, "time", e->startus);
+    cson_writer_string(w, "type", "newsql", strlen("newsql"));
 
-    if (logger->sql_ref != NULL) {
-        cson_object_set(newobj, "sql", cson_value_new_string(string_ref_cstr(logger->sql_ref),
-                                                             string_ref_len(logger->sql_ref)));
+    if (e->sql_ref != NULL) {
+        cson_writer_string(w, "sql", string_ref_cstr(e->sql_ref),
+                           string_ref_len(e->sql_ref));
     }
 
     char expanded_fp[2 * FINGERPRINTSZ + 1];
-    util_tohex(expanded_fp, logger->fingerprint, FINGERPRINTSZ);
-    cson_object_set(newobj, "fingerprint",
-            cson_value_new_string(expanded_fp, FINGERPRINTSZ * 2));
+    util_tohex(expanded_fp, e->fingerprint, FINGERPRINTSZ);
+    cson_writer_string(w, "fingerprint", expanded_fp, FINGERPRINTSZ * 2);
+    cson_writer_object_end(w);
 
     /* yes, this can spill the file to beyond the configured size - we need
        this event to be in the same file as the event its being logged for */
-    cson_output(newval, write_json, eventlog);
-    if (eventlog_verbose) cson_output_FILE(newval, stdout);
-    cson_value_free(newval);
+    cson_writer_output(w, write_json, eventlog);
+    if (eventlog_verbose) cson_writer_output(w, write_json_FILE, stdout);
+    cson_writer_free(w);
 }
 
 static const char *ev_str[] = { "unset", "txn", "sql", "sp" };
 
-static inline void cson_snap_info_key(cson_object *obj, snap_uid_t *snap_info)
+static inline void cson_snap_info_key(cson_writer *w, snap_uid_t *snap_info)
 {
-    if (!obj || !snap_info)
+    if (!w || !snap_info)
         return;
 
     if (gbl_print_cnonce_as_hex) {
         char cnonce[2 * snap_info->keylen + 1];
         /* util_tohex() takes care of null-terminating the resulting string. */
         util_tohex(cnonce, snap_info->key, snap_info->keylen);
-        cson_object_set(obj, "cnonce",
-                        cson_value_new_string(cnonce, snap_info->keylen * 2));
+        cson_writer_string(w, "cnonce", cnonce, snap_info->keylen * 2);
     } else {
-        cson_object_set(obj, "cnonce",
-                        cson_value_new_string(snap_info->key, snap_info->keylen));
+        cson_writer_string(w, "cnonce", snap_info->key, snap_info->keylen);
     }
 }
 
 
-static void populate_obj(cson_object *obj, const struct reqlogger *logger)
+static void populate_obj(cson_writer *w, const struct reqlogger *logger)
 {
-    cson_object_set(obj, "time", cson_new_int(logger->startus));
+    cson_writer_object_begin(w, NULL);
+    cson_writer_int(w, "time", logger->startus);
     if (logger->event_type != EV_UNSET) {
         const char *str = ev_str[logger->event_type];
-        cson_object_set(obj, "type", cson_value_new_string(str, strlen(str)));
+        cson_writer_string(w, "type", str, strlen(str));
     }
 
     if (logger->sql_ref && eventlog_detailed) {
-        cson_object_set(obj, "sql", cson_value_new_string(string_ref_cstr(logger->sql_ref),
-                                                          string_ref_len(logger->sql_ref)));
-        cson_object_set(obj, "bound_parameters", logger->bound_param_cson);
+        cson_writer_string(w, "sql", string_ref_cstr(logger->sql_ref),
+                           string_ref_len(logger->sql_ref));
+        if (logger->bound_param_cson) {
+            cson_writer_value(w, "bound_parameters", logger->bound_param_cson);
+            cson_value_free(logger->bound_param_cson);
+        }
     }
 
     snap_uid_t snap, *p = NULL;
@@ -500,108 +523,244 @@ static void populate_obj(cson_object *obj, const struct reqlogger *logger)
         p = IQ_SNAPINFO(logger->iq);
     else if (logger->clnt && get_cnonce(logger->clnt, &snap) == 0)
         p = &snap;
-    cson_snap_info_key(obj, p);
+    cson_snap_info_key(w, p);
 
     if (logger->have_id)
-        cson_object_set(obj, "id", cson_value_new_string(logger->id, strlen(logger->id)));
+        cson_writer_string(w, "id", logger->id, strlen(logger->id));
     if (logger->sqlcost)
-        cson_object_set(obj, "cost", cson_new_double(logger->sqlcost));
+        cson_writer_double(w, "cost", logger->sqlcost);
     if (logger->sqlrows)
-        cson_object_set(obj, "rows", cson_new_int(logger->sqlrows));
+        cson_writer_int(w, "rows", logger->sqlrows);
     if (logger->vreplays)
-        cson_object_set(obj, "replays", cson_new_int(logger->vreplays));
+        cson_writer_int(w, "replays", logger->vreplays);
 
     if (logger->error) {
-        cson_object_set(obj, "rc", cson_new_int(logger->rc));
-        cson_object_set(obj, "error_code", cson_new_int(logger->error_code));
-        cson_object_set(obj, "error", cson_value_new_string(logger->error, strlen(logger->error)));
+        cson_writer_int(w, "rc", logger->rc);
+        cson_writer_int(w, "error_code", logger->error_code);
+        cson_writer_string(w, "error", logger->error, strlen(logger->error));
 
         if (logger->iq && logger->iq->retries > 0)
-            cson_object_set(obj, "deadlockretries", cson_new_int(logger->iq->retries));
+            cson_writer_int(w, "deadlockretries", logger->iq->retries);
     }
 
-    cson_object_set(obj, "host", cson_value_new_string(logger->origin, strlen(logger->origin)));
+    cson_writer_string(w, "host", logger->origin, strlen(logger->origin));
 
     if (logger->have_fingerprint) {
         char expanded_fp[2 * FINGERPRINTSZ + 1];
         util_tohex(expanded_fp, logger->fingerprint, FINGERPRINTSZ);
-        cson_object_set(obj, "fingerprint", cson_value_new_string(expanded_fp, FINGERPRINTSZ * 2));
+        cson_writer_string(w, "fingerprint", expanded_fp, FINGERPRINTSZ * 2);
     }
 
     if (logger->clnt) {
         uint64_t clientstarttime = get_client_starttime(logger->clnt);
         if (clientstarttime && logger->startus > clientstarttime)
-            cson_object_set(obj, "startlag", /* in microseconds */
-                            cson_new_int(logger->startus - clientstarttime));
+            cson_writer_int(w, "startlag", /* in microseconds */
+                            logger->startus - clientstarttime);
         int clientretries = get_client_retries(logger->clnt);
         if (clientretries > 0)
-            cson_object_set(obj, "clientretries", cson_new_int(clientretries));
+            cson_writer_int(w, "clientretries", clientretries);
 
-        cson_object_set(obj, "connid", cson_new_int(logger->clnt->connid));
-        cson_object_set(obj, "pid", cson_new_int(logger->clnt->last_pid));
+        cson_writer_int(w, "connid", logger->clnt->connid);
+        cson_writer_int(w, "pid", logger->clnt->last_pid);
         if (logger->clnt->argv0)
-            cson_object_set(obj, "client",
-                            cson_value_new_string(logger->clnt->argv0, strlen(logger->clnt->argv0)));
+            cson_writer_string(w, "client", logger->clnt->argv0,
+                               strlen(logger->clnt->argv0));
     }
 
     if (logger->nwrites > 0) {
-        cson_object_set(obj, "nwrites", cson_new_int(logger->nwrites));
+        cson_writer_int(w, "nwrites", logger->nwrites);
     }
     if (logger->cascaded_nwrites > 0) {
-        cson_object_set(obj, "casc_nwrites", cson_new_int(logger->cascaded_nwrites));
+        cson_writer_int(w, "casc_nwrites", logger->cascaded_nwrites);
     }
-    eventlog_context(obj, logger);
-    eventlog_perfdata(obj, logger);
-    eventlog_tables(obj, logger);
-    eventlog_path(obj, logger);
+    eventlog_context(w, logger);
+    eventlog_perfdata(w, logger);
+    eventlog_tables(w, logger);
+    eventlog_path(w, logger);
+    cson_writer_object_end(w);
 }
 
-static inline void add_to_fingerprints(const struct reqlogger *logger)
+/* one "stages" event per tracked fingerprint, carrying its cumulative
+ * per-stage histograms (log2 microsecond buckets, trailing zeros trimmed) */
+static int eventlog_stages_fp(void *obj, void *arg)
 {
-    int isSqlErr = logger->error && logger->sql_ref;
+    const struct fingerprint_track *t = obj;
+    const struct reqlog_stage_hist *h = &t->stages;
+    cson_writer *w = arg;
+    int stages = 0;
 
-    if ((EV_SQL == logger->event_type || isSqlErr) && !hash_find(seen_sql, logger->fingerprint)) {
-        eventlog_add_newsql(logger);
+    for (int i = 0; i < REQL_NSTAGES; i++) {
+        if (h->totus[i] != 0)
+            stages = 1;
     }
+    if (!stages)
+        return 0;
+
+    char expanded_fp[2 * FINGERPRINTSZ + 1];
+    util_tohex(expanded_fp, (const char *)t->fingerprint, FINGERPRINTSZ);
+    cson_writer_reset(w);
+    cson_writer_object_begin(w, NULL);
+    cson_writer_int(w, "time", comdb2_time_epochus());
+    cson_writer_string(w, "type", "stages", strlen("stages"));
+    cson_writer_string(w, "fingerprint", expanded_fp, FINGERPRINTSZ * 2);
+    cson_writer_int(w, "count", t->count);
+    cson_writer_object_begin(w, "stages");
+    for (int i = 0; i < REQL_NSTAGES; i++) {
+        int n = REQL_STAGE_NBUCKETS;
+        if (h->totus[i] == 0)
+            continue;
+        while (n > 0 && h->buckets[i][n - 1] == 0)
+            n--;
+        cson_writer_object_begin(w, reqlog_stage_name(i));
+        cson_writer_int(w, "totus", h->totus[i]);
+        cson_writer_array_begin(w, "hist");
+        for (int b = 0; b < n; b++)
+            cson_writer_int(w, NULL, h->buckets[i][b]);
+        cson_writer_array_end(w);
+        cson_writer_object_end(w);
+    }
+    cson_writer_object_end(w);
+    cson_writer_object_end(w);
+    cson_writer_output(w, write_json, eventlog);
+    if (eventlog_verbose) cson_writer_output(w, write_json_FILE, stdout);
+    return 0;
 }
 
-void eventlog_add(const struct reqlogger *logger)
+// this function must be called while holding eventlog_lk
+static void eventlog_stages(void)
 {
-    if (eventlog == NULL || !eventlog_enabled ||
-        (logger->clnt && logger->clnt->skip_eventlog)) {
+    if (eventlog == NULL || !eventlog_enabled)
         return;
-    }
+    cson_writer *w = cson_writer_new();
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    if (gbl_fingerprint_hash)
+        hash_for(gbl_fingerprint_hash, eventlog_stages_fp, w);
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+    cson_writer_free(w);
+}
 
-    int loc_count = ATOMIC_ADD64(eventlog_count, 1);
-    if (eventlog_every_n > 1 && loc_count % eventlog_every_n != 0) {
+// this function must be called while holding eventlog_lk
+static void eventlog_write(const struct eventlog_ent *e, int *call_roll_cleanup)
+{
+    if (eventlog == NULL || !eventlog_enabled)
         return;
+    if (eventlog_rollat > 0 && bytes_written > eventlog_rollat) {
+        eventlog_roll();
+        *call_roll_cleanup = 1;
     }
+    if (e->newsql && !hash_find(seen_sql, e->fingerprint))
+        eventlog_add_newsql(e);
+    cson_writer_output(e->w, write_json, eventlog);
+    if (eventlog_verbose)
+        cson_writer_output(e->w, write_json_FILE, stdout);
+}
 
-    cson_value *val = cson_value_new_object();
-    cson_object *obj = cson_value_get_object(val);
-    populate_obj(obj, logger);
+/* write out everything queued so far, in order */
+static void eventlog_drain(void)
+{
+    eventlog_ent_list batch;
+    struct eventlog_ent *e;
     int call_roll_cleanup = 0;
 
-    Pthread_mutex_lock(&eventlog_lk);
-
-    if (eventlog != NULL && eventlog_enabled) {
-        if (eventlog_rollat > 0 && bytes_written > eventlog_rollat) {
-            eventlog_roll();
-            call_roll_cleanup = 1;
+    Pthread_mutex_lock(&eventlog_drain_lk);
+    Pthread_mutex_lock(&eventlog_q_lk);
+    batch = eventlog_q;
+    listc_init(&eventlog_q, offsetof(struct eventlog_ent, lnk));
+    Pthread_mutex_unlock(&eventlog_q_lk);
+
+    if (batch.count > 0) {
+        Pthread_mutex_lock(&eventlog_lk);
+        LISTC_FOR_EACH(&batch, e, lnk)
+        {
+            eventlog_write(e, &call_roll_cleanup);
         }
-        add_to_fingerprints(logger);
-        cson_output(val, write_json, eventlog);
+        Pthread_mutex_unlock(&eventlog_lk);
     }
-    Pthread_mutex_unlock(&eventlog_lk);
+    Pthread_mutex_unlock(&eventlog_drain_lk);
 
-    if (call_roll_cleanup) {
+    while ((e = listc_rtl(&batch)) != NULL) {
+        cson_writer_free(e->w);
+        put_ref(&e->sql_ref);
+        free(e);
+    }
+    if (call_roll_cleanup)
         eventlog_roll_cleanup();
+}
+
+static void *eventlog_thd(void *arg)
+{
+    comdb2_name_thread(__func__);
+    while (1) {
+        Pthread_mutex_lock(&eventlog_q_lk);
+        while (eventlog_q.count == 0)
+            Pthread_cond_wait(&eventlog_q_cond, &eventlog_q_lk);
+        Pthread_mutex_unlock(&eventlog_q_lk);
+        eventlog_drain();
     }
+    return NULL;
+}
 
-    if (eventlog_verbose)
-        cson_output_FILE(val, stdout);
+static void eventlog_thd_start(void)
+{
+    pthread_t tid;
+    Pthread_create(&tid, &gbl_pthread_attr_detached, eventlog_thd, NULL);
+}
+
+/* takes ownership of w */
+static void eventlog_enqueue(cson_writer *w, const struct reqlogger *logger)
+{
+    struct eventlog_ent *e = calloc(1, sizeof(*e));
+    int qmax = gbl_eventlog_queue_max;
+
+    if (e == NULL) {
+        cson_writer_free(w);
+        return;
+    }
+    e->w = w;
+    if (logger) {
+        int isSqlErr = logger->error && logger->sql_ref;
+        e->newsql = EV_SQL == logger->event_type || isSqlErr;
+        if (logger->sql_ref)
+            e->sql_ref = get_ref(logger->sql_ref);
+        e->startus = logger->startus;
+        memcpy(e->fingerprint, logger->fingerprint, sizeof(e->fingerprint));
+    }
+
+    Pthread_mutex_lock(&eventlog_q_lk);
+    if (qmax > 0 && eventlog_q.count >= qmax) {
+        eventlog_dropped++;
+        Pthread_mutex_unlock(&eventlog_q_lk);
+        cson_writer_free(e->w);
+        put_ref(&e->sql_ref);
+        free(e);
+        return;
+    }
+    listc_abl(&eventlog_q, e);
+    if (qmax > 0)
+        Pthread_cond_signal(&eventlog_q_cond);
+    Pthread_mutex_unlock(&eventlog_q_lk);
 
-    cson_value_free(val);
+    if (qmax > 0)
+        pthread_once(&eventlog_thd_once, eventlog_thd_start);
+    else
+        eventlog_drain();
+}
+
+void eventlog_add(const struct reqlogger *logger)
+{
+    if (eventlog == NULL || !eventlog_enabled ||
+        (logger->clnt && logger->clnt->skip_eventlog)) {
+        return;
+    }
+
+    int loc_count = ATOMIC_ADD64(eventlog_count, 1);
+    if (eventlog_every_n > 1 && loc_count % eventlog_every_n != 0) {
+        return;
+    }
+
+    cson_writer *w = cson_writer_new();
+    populate_obj(w, logger);
+    eventlog_enqueue(w, logger);
 }
 
 void eventlog_status(void)
@@ -610,12 +769,18 @@ void eventlog_status(void)
         logmsg(LOGMSG_USER, "Eventlog enabled, file:%s\n", gbl_eventlog_fname);
     else
         logmsg(LOGMSG_USER, "Eventlog disabled\n");
+    Pthread_mutex_lock(&eventlog_q_lk);
+    logmsg(LOGMSG_USER, "Eventlog queued %d (max %d), dropped %" PRId64 "\n",
+           eventlog_q.count, gbl_eventlog_queue_max, eventlog_dropped);
+    Pthread_mutex_unlock(&eventlog_q_lk);
 }
 
 // roll the log: close existing file open a new one
 // this function must be called while holding eventlog_lk
 static void eventlog_roll(void)
 {
+    /* leave the stage histograms for the period in the file being closed */
+    eventlog_stages();
     eventlog_close();
 
     char *fname = eventlog_fname(thedb->envname);
@@ -647,6 +812,7 @@ static void eventlog_disable(void)
 
 void eventlog_stop(void)
 {
+    eventlog_drain();
     Pthread_mutex_lock(&eventlog_lk);
     eventlog_disable();
     Pthread_mutex_unlock(&eventlog_lk);
@@ -671,6 +837,7 @@ static void eventlog_help(void)
                         "events dir <dir>         - set custom directory for event log files\n"
                         "events file <file>       - set log file to custom location\n"
                         "events flush             - flush log\n"
+                        "events stages            - log stage histograms for all fingerprints\n"
                         "events help              - this help message\n");
 }
 
@@ -700,6 +867,8 @@ static void eventlog_process_message_locked(char *line, int lline, int *toff, in
     } else if (tokcmp(tok, ltok, "roll") == 0) {
         eventlog_roll();
         *call_roll_cleanup = 1;
+    } else if (tokcmp(tok, ltok, "stages") == 0) {
+        eventlog_stages();
     } else if (tokcmp(tok, ltok, "keep") == 0) {
         int nfiles;
         tok = segtok(line, lline, toff, &ltok);
@@ -809,6 +978,8 @@ static void eventlog_process_message_locked(char *line, int lline, int *toff, in
 void eventlog_process_message(char *line, int lline, int *toff)
 {
     int call_roll_cleanup = 0;
+    /* commands act on everything logged before them */
+    eventlog_drain();
     Pthread_mutex_lock(&eventlog_lk);
     eventlog_process_message_locked(line, lline, toff, &call_roll_cleanup);
     Pthread_mutex_unlock(&eventlog_lk);
@@ -824,34 +995,28 @@ void eventlog_deadlock_cycle(locker_info *idmap, u_int32_t *deadmap,
     if (!eventlog_enabled || eventlog == NULL) {
         return;
     }
-    cson_value *dd_list = cson_value_new_array();
-    cson_array *arr = cson_value_get_array(dd_list);
+    uint64_t startus = comdb2_time_epochus();
+    extern char *gbl_myhostname;
+    cson_writer *w = cson_writer_new();
+    cson_writer_object_begin(w, NULL);
+    cson_writer_int(w, "time", startus);
+    cson_writer_string(w, "host", gbl_myhostname, strlen(gbl_myhostname));
+    cson_writer_array_begin(w, "deadlock_cycle");
     for (int j = 0; j < nlockers; j++) {
         if (!ISSET_MAP(deadmap, j))
             continue;
-        cson_value *lobj = cson_value_new_object();
-        cson_object *vobj = cson_value_get_object(lobj);
-        cson_snap_info_key(vobj, idmap[j].snap_info);
+        cson_writer_object_begin(w, NULL);
+        cson_snap_info_key(w, idmap[j].snap_info);
         char hex[11];
         sprintf(hex, "0x%x", idmap[j].id);
-        cson_object_set(vobj, "lid", cson_value_new_string(hex, strlen(hex)));
-        cson_object_set(vobj, "lcount", cson_value_new_integer(idmap[j].lcount));
+        cson_writer_string(w, "lid", hex, strlen(hex));
+        cson_writer_int(w, "lcount", idmap[j].lcount);
         if (j == victim)
-            cson_object_set(vobj, "victim", cson_value_new_bool(1));
-        cson_array_append(arr, lobj);
+            cson_writer_bool(w, "victim", 1);
+        cson_writer_object_end(w);
     }
+    cson_writer_array_end(w);
+    cson_writer_object_end(w);
     logmsg(LOGMSG_USER, "\n");
-    uint64_t startus = comdb2_time_epochus();
-    extern char *gbl_myhostname;
-    cson_value *host = cson_value_new_string(gbl_myhostname, strlen(gbl_myhostname));
-    cson_value *dval = cson_value_new_object();
-    cson_object *obj = cson_value_get_object(dval);
-    cson_object_set(obj, "time", cson_new_int(startus));
-    cson_object_set(obj, "host", host);
-    cson_object_set(obj, "deadlock_cycle", dd_list);
-    Pthread_mutex_lock(&eventlog_lk);
-    if (eventlog_enabled && eventlog != NULL)
-        cson_output(dval, write_json, eventlog);
-    Pthread_mutex_unlock(&eventlog_lk);
-    cson_value_free(dval);
+    eventlog_enqueue(w, NULL);
 }
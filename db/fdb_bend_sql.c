@@ -41,6 +41,11 @@
 #include "logmsg.h"
 
 extern int gbl_fdb_track;
+
+/* remote sql results are flushed to the requester in windows */
+int gbl_fdb_stream_window_rows = 64;
+int gbl_fdb_stream_window_ms = 10;
+
 extern int blockproc2sql_error(int rc, const char *func, int line);
 
 
@@ -91,10 +96,11 @@ int fdb_svc_cursor_open_sql(char *tid, char *cid, int code_release, int version,
 
 /**
  * Send back a streamed row with return code (marks also eos)
+ * Without flush, the row stays buffered until a later row is flushed
  *
  */
 int fdb_svc_sql_row(SBUF2 *sb, char *cid, char *row, int rowlen, int ret,
-                    int isuuid)
+                    int isuuid, int flush)
 {
     /* NOTE: we assume everything required is embedded in the sqlite row
        including genid and datacopy fields - as generated by select
@@ -109,7 +115,7 @@ int fdb_svc_sql_row(SBUF2 *sb, char *cid, char *row, int rowlen, int ret,
     }
 
     rc = fdb_bend_send_row(sb, NULL, cid, genid, row, rowlen, NULL, 0, ret,
-                           isuuid);
+                           isuuid, flush);
 
     return rc;
 }
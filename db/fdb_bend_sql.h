@@ -29,10 +29,11 @@ int fdb_appsock_work(const char *cid, struct sqlclntstate *clnt, int version,
 
 /**
  * Send back a streamed row with return code (marks also eos)
+ * Without flush, the row stays buffered until a later row is flushed
  *
  */
 int fdb_svc_sql_row(SBUF2 *sb, char *cid, char *row, int rowlen, int rc,
-                    int isuuid);
+                    int isuuid, int flush);
 
 /**
  * For requests where we want to avoid a dedicated genid lookup socket, this
@@ -61,6 +61,7 @@ extern int gbl_partial_indexes;
 extern int gbl_expressions_indexes;
 
 int gbl_fdb_track = 0;
+int gbl_fdb_project_columns = 1;
 int gbl_fdb_track_times = 0;
 int gbl_test_io_errors = 0;
 
@@ -2627,6 +2628,13 @@ static char *_build_run_sql_from_hint(BtCursor *pCur, Mem *m, int ncols,
             using_col_filter = 1;
         } else {
             tableName = fdbc->ent->name;
+
+            /* fetch only the columns the query reads */
+            if (gbl_fdb_project_columns)
+                columnsDesc = sqlite3DescribeTableColumns(
+                    sqlitedb, tableName, fdbc->ent->tbl->fdb->dbname,
+                    pCur->col_mask);
+            using_col_filter = columnsDesc != NULL;
         }
     }
 
@@ -3155,9 +3163,16 @@ static int fdb_cursor_find_sql_common(BtCursor *pCur, Mem *key, int nfields,
                 abort();
             }
 
-            sql = sqlite3_mprintf("select *, rowid from \"%w\" "
+            char *columnsDesc = NULL;
+            if (gbl_fdb_project_columns)
+                columnsDesc = sqlite3DescribeTableColumns(
+                    pCur->sqlite, fdbc->ent->tbl->name,
+                    fdbc->ent->tbl->fdb->dbname, pCur->col_mask);
+            sql = sqlite3_mprintf("select %s, rowid from \"%w\" "
                                   "where rowid = %lld",
+                                  columnsDesc ? columnsDesc : "*",
                                   fdbc->ent->tbl->name, key->u.i);
+            sqlite3_free(columnsDesc);
             sqllen = strlen(sql) + 1;
         } else {
             if (fdbc->sql_hint) {
@@ -4920,6 +4935,44 @@ void fdb_cursor_use_table(fdb_cursor_t *cur, struct fdb *fdb,
 }
 
 
+/* run "select table_version()" for table on an open handle */
+static int _get_remote_version_hndl(cdb2_hndl_tp *db, const char *table,
+                                    unsigned long long *version)
+{
+    char *sql;
+    int rc;
+
+    sql = sqlite3_mprintf("select table_version('%q')", table);
+    if (sql == NULL)
+        return FDB_ERR_MALLOC;
+
+    rc = cdb2_run_statement(db, sql);
+    sqlite3_free(sql);
+    if (rc)
+        return FDB_ERR_GENERIC;
+
+    rc = cdb2_next_record(db);
+    if (rc == CDB2_OK && cdb2_column_type(db, 0) == CDB2_INTEGER) {
+        *version = *(unsigned long long *)cdb2_column_value(db, 0);
+        rc = FDB_NOERR;
+    } else
+        rc = FDB_ERR_GENERIC;
+
+    /* drain the statement so the handle can be reused */
+    while (cdb2_next_record(db) == CDB2_OK)
+        ;
+
+    return rc;
+}
+
+static int _open_remote_hndl(cdb2_hndl_tp **db, const char *dbname,
+                             enum mach_class class, int local)
+{
+    if (local)
+        return cdb2_open(db, dbname, "localhost", CDB2_DIRECT_CPU);
+    return cdb2_open(db, dbname, mach_class_class2name(class), 0);
+}
+
 /**
  * Retrieve the schema of a remote table
  *
@@ -4928,55 +4981,183 @@ int fdb_get_remote_version(const char *dbname, const char *table,
                            enum mach_class class, int local,
                            unsigned long long *version)
 {
-    char *sql = NULL;
     cdb2_hndl_tp *db;
     int rc;
-    const char *location;
-    int flags;
 
-    if (local) {
-        location = "localhost";
-        flags = CDB2_DIRECT_CPU;
-    } else {
-        location = mach_class_class2name(class);
-        flags = 0;
-    }
+    rc = _open_remote_hndl(&db, dbname, class, local);
+    if (rc)
+        return FDB_ERR_GENERIC;
 
-    sql = sqlite3_mprintf("select table_version('%q')", table);
-    if (sql == NULL)
-        return FDB_ERR_MALLOC;
+    rc = _get_remote_version_hndl(db, table, version);
 
-    rc = cdb2_open(&db, dbname, location, flags);
-    if (rc) {
-        sqlite3_free(sql);
-        return FDB_ERR_GENERIC;
+    cdb2_close(db);
+
+    return rc;
+}
+
+/* Remote schema poller
+
+   A remote table's cached schema is only found stale when a query runs
+   against it and the remote side rejects the version we sent, after which
+   the query is prepared again and blocks while the schema is fetched.  With
+   fdb_schema_poll_ms set, a background thread checks the version of every
+   cached remote table that often, one connection per remote db, and marks
+   the ones that changed as stale; the next query to use them refreshes them
+   at prepare time instead of failing remotely first.
+ */
+int gbl_fdb_schema_poll_ms = 0;
+
+struct fdb_poll_db {
+    char *dbname;
+    enum mach_class class;
+    int local;
+    int ntbls;
+    char **tbls;
+    unsigned long long *versions;
+    int *found;
+};
+
+static int _collect_poll_tbl(void *obj, void *arg)
+{
+    fdb_tbl_t *tbl = obj;
+    struct fdb_poll_db *p = arg;
+
+    /* stats tables come and go with their data table */
+    if (strncasecmp(tbl->name, "sqlite_", 7) == 0)
+        return 0;
+    p->tbls[p->ntbls] = strdup(tbl->name);
+    if (p->tbls[p->ntbls])
+        p->ntbls++;
+    return 0;
+}
+
+static void _free_poll_dbs(struct fdb_poll_db *dbs, int n)
+{
+    int i, j;
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < dbs[i].ntbls; j++)
+            free(dbs[i].tbls[j]);
+        free(dbs[i].tbls);
+        free(dbs[i].versions);
+        free(dbs[i].found);
+        free(dbs[i].dbname);
     }
+    free(dbs);
+}
 
-    rc = cdb2_run_statement(db, sql);
-    if (rc) {
-        rc = FDB_ERR_GENERIC;
-        goto done;
+/* copy out the names of every cached table, so no fdb lock is held while we
+ * talk to the remote dbs */
+static struct fdb_poll_db *_collect_poll_dbs(int *n)
+{
+    struct fdb_poll_db *dbs, *p;
+    fdb_t *fdb;
+    int i, cnt;
+
+    *n = 0;
+    Pthread_rwlock_rdlock(&fdbs.arr_lock);
+    dbs = calloc(fdbs.nused ? fdbs.nused : 1, sizeof(*dbs));
+    for (i = 0; dbs && i < fdbs.nused; i++) {
+        fdb = fdbs.arr[i];
+        p = &dbs[*n];
+        __lock_wrlock_shared(fdb);
+        cnt = hash_get_num_entries(fdb->h_tbls_name);
+        p->tbls = calloc(cnt ? cnt : 1, sizeof(char *));
+        p->versions = calloc(cnt ? cnt : 1, sizeof(unsigned long long));
+        p->found = calloc(cnt ? cnt : 1, sizeof(int));
+        p->dbname = strdup(fdb->dbname);
+        if (p->tbls && p->versions && p->found && p->dbname) {
+            p->class = fdb->class;
+            p->local = fdb->local;
+            hash_for(fdb->h_tbls_name, _collect_poll_tbl, p);
+        }
+        Pthread_rwlock_unlock(&fdb->h_rwlock);
+        (*n)++;
     }
+    Pthread_rwlock_unlock(&fdbs.arr_lock);
 
-    rc = cdb2_next_record(db);
-    if (rc == CDB2_OK) {
-        switch (cdb2_column_type(db, 0)) {
-        case CDB2_INTEGER:
-            *version = *(unsigned long long *)cdb2_column_value(db, 0);
-            rc = FDB_NOERR;
-            break;
-        default:
-            rc = FDB_ERR_GENERIC;
-            break;
+    return dbs;
+}
+
+static void _mark_stale_tables(struct fdb_poll_db *p)
+{
+    fdb_tbl_t *tbl;
+    fdb_t *fdb;
+    int i;
+
+    Pthread_rwlock_rdlock(&fdbs.arr_lock);
+    fdb = __cache_fnd_fdb(p->dbname, NULL);
+    if (fdb) {
+        __lock_wrlock_shared(fdb);
+        for (i = 0; i < p->ntbls; i++) {
+            if (!p->found[i])
+                continue;
+            tbl = hash_find_readonly(fdb->h_tbls_name, &p->tbls[i]);
+            if (!tbl || tbl->version == p->versions[i] ||
+                tbl->need_version == p->versions[i] + 1)
+                continue;
+            if (gbl_fdb_track)
+                logmsg(LOGMSG_USER,
+                       "Remote table %s.%s new version is %llu, cached %llu\n",
+                       p->dbname, p->tbls[i], p->versions[i], tbl->version);
+            tbl->need_version = p->versions[i] + 1;
         }
-    } else
-        rc = FDB_ERR_GENERIC;
+        Pthread_rwlock_unlock(&fdb->h_rwlock);
+    }
+    Pthread_rwlock_unlock(&fdbs.arr_lock);
+}
 
-done:
-    cdb2_close(db);
-    sqlite3_free(sql);
+static void _poll_remote_versions(void)
+{
+    struct fdb_poll_db *dbs, *p;
+    cdb2_hndl_tp *db;
+    int i, j, n;
 
-    return rc;
+    dbs = _collect_poll_dbs(&n);
+    if (dbs == NULL)
+        return;
+
+    for (i = 0; i < n && !db_is_exiting(); i++) {
+        p = &dbs[i];
+        if (p->ntbls == 0)
+            continue;
+        if (_open_remote_hndl(&db, p->dbname, p->class, p->local))
+            continue;
+        for (j = 0; j < p->ntbls; j++)
+            p->found[j] = _get_remote_version_hndl(db, p->tbls[j],
+                                                   &p->versions[j]) == FDB_NOERR;
+        cdb2_close(db);
+        _mark_stale_tables(p);
+    }
+
+    _free_poll_dbs(dbs, n);
+}
+
+static void *fdb_schema_poll_thd(void *arg)
+{
+    int64_t last = 0, now;
+
+    comdb2_name_thread(__func__);
+    thrman_register(THRTYPE_GENERIC);
+
+    while (!db_is_exiting()) {
+        poll(NULL, 0, 100);
+        if (gbl_fdb_schema_poll_ms <= 0)
+            continue;
+        now = comdb2_time_epochms();
+        if (now - last < gbl_fdb_schema_poll_ms)
+            continue;
+        _poll_remote_versions();
+        last = comdb2_time_epochms();
+    }
+    return NULL;
+}
+
+void fdb_schema_poll_init(void)
+{
+    pthread_t tid;
+    Pthread_create(&tid, &gbl_pthread_attr_detached, fdb_schema_poll_thd,
+                   NULL);
 }
 
 static int _validate_existing_table(fdb_t *fdb, int cls, int local)
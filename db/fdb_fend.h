@@ -416,6 +416,12 @@ int fdb_get_remote_version(const char *dbname, const char *table,
                            enum mach_class class, int local,
                            unsigned long long *version);
 
+/**
+ * Start the thread polling remote table versions (see fdb_schema_poll_ms)
+ *
+ */
+void fdb_schema_poll_init(void);
+
 int fdb_table_exists(int rootpage);
 
 int fdb_set_genid_deleted(fdb_tran_t *, unsigned long long);
@@ -589,6 +589,7 @@ static int trans_wait_for_seqnum_int(void *bdb_handle, struct dbenv *dbenv,
     int rc = 0;
     int sync;
     int start_ms, end_ms;
+    uint64_t start_us;
 
     if (iq->sc_pending) {
         sync = REP_SYNC_FULL;
@@ -600,6 +601,8 @@ static int trans_wait_for_seqnum_int(void *bdb_handle, struct dbenv *dbenv,
 
     /*wait for synchronization, if necessary */
     start_ms = comdb2_time_epochms();
+    start_us = comdb2_time_epochus();
+    reqlog_stage_begin(iq->reqlogger, REQL_STAGE_REPLWAIT);
     switch (sync) {
     default:
 
@@ -676,6 +679,8 @@ static int trans_wait_for_seqnum_int(void *bdb_handle, struct dbenv *dbenv,
 
     end_ms = comdb2_time_epochms();
     iq->reptimems = end_ms - start_ms;
+    reqlog_stage_end(iq->reqlogger, REQL_STAGE_REPLWAIT);
+    time_metric_add(dbenv->repl_wait_time, comdb2_time_epochus() - start_us);
 
     return rc;
 }
@@ -712,6 +717,174 @@ int trans_commit_logical_tran(void *trans, int *bdberr)
 
 int gbl_javasp_early_release = 1;
 int gbl_debug_add_replication_latency = 0;
+int gbl_async_commit_ack = 0;
+int gbl_commit_ack_group_max = 1;
+
+/*
+  Asynchronous commit acknowledgement
+
+  With async_commit_ack on, an osql transaction that committed fine on the
+  master does not wait for the replicants on its block processor thread.
+  trans_commit_int records the commit seqnum in the ireq instead, and
+  handle_ireq hands the reply over to the commit ack thread through
+  trans_defer_commit_ack.  The block processor goes on to the next bplog;
+  the commit ack thread waits for the seqnum to become durable, same as the
+  synchronous path would have, and only then signals the sql thread.
+  With commit_ack_group_max above 1, the thread takes up to that many
+  queued commits at once and waits only for the newest of them; a single
+  durable wait and lease delay then answers the whole group.
+*/
+struct commit_ack {
+    osql_target_t target;
+    unsigned long long rqid;
+    uuid_t uuid;
+    int nops;
+    struct errstat errstat;
+    snap_uid_t snap;
+    int has_snap;
+    int rc;
+    db_seqnum_type seqnum;
+    uint64_t txnsize;
+    commit_lsn_t lsn;
+    LINKC_T(struct commit_ack) lnk;
+};
+
+static pthread_mutex_t commit_ack_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t commit_ack_cond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t commit_ack_once = PTHREAD_ONCE_INIT;
+static LISTC_T(struct commit_ack) commit_acks;
+
+static int commit_ack_can_defer(struct ireq *iq)
+{
+    if (!gbl_async_commit_ack || gbl_debug_add_replication_latency)
+        return 0;
+    if (!iq->sorese || iq->sorese->target.type != OSQL_OVER_NET)
+        return 0;
+    if (iq->sc_pending || iq->sc || iq->tranddl)
+        return 0;
+    return thedb->rep_sync == REP_SYNC_FULL;
+}
+
+/* Wait for a seqnum to be durable, as trans_commit_int would have */
+static int commit_ack_wait(db_seqnum_type *seqnum, uint64_t txnsize)
+{
+    uint64_t start_us, now, next_commit;
+    int rc, timeoutms;
+
+    start_us = comdb2_time_epochus();
+    rc = bdb_wait_for_seqnum_from_all_adaptive_newcoh(
+        thedb->bdb_env, (seqnum_type *)seqnum, txnsize, &timeoutms);
+    if (bdb_attr_get(thedb->bdb_attr, BDB_ATTR_COHERENCY_LEASE)) {
+        now = gettimeofday_ms();
+        next_commit = next_commit_timestamp();
+        if (next_commit > now)
+            poll(0, 0, next_commit - now);
+    }
+    time_metric_add(thedb->repl_wait_time, comdb2_time_epochus() - start_us);
+    return rc;
+}
+
+static void *commit_ack_thd(void *arg)
+{
+    LISTC_T(struct commit_ack) group;
+    struct commit_ack *a, *last;
+    uint64_t txnsize;
+    int rc, grouprc, max, count;
+
+    comdb2_name_thread(__func__);
+    thread_started("commit ack");
+    listc_init(&group, offsetof(struct commit_ack, lnk));
+    while (1) {
+        Pthread_mutex_lock(&commit_ack_lk);
+        while (commit_acks.count == 0)
+            Pthread_cond_wait(&commit_ack_cond, &commit_ack_lk);
+        max = gbl_commit_ack_group_max > 1 ? gbl_commit_ack_group_max : 1;
+        while (group.count < max && (a = listc_rtl(&commit_acks)) != NULL)
+            listc_abl(&group, a);
+        Pthread_mutex_unlock(&commit_ack_lk);
+
+        /* commits reach us from several block processors, so the newest is
+         * not always the last one queued; once it is durable, all are */
+        last = NULL;
+        txnsize = 0;
+        LISTC_FOR_EACH(&group, a, lnk)
+        {
+            if (last == NULL ||
+                bdb_seqnum_compare(thedb->bdb_env, (seqnum_type *)&a->seqnum,
+                                   (seqnum_type *)&last->seqnum) > 0)
+                last = a;
+            txnsize += a->txnsize;
+        }
+        count = group.count;
+        grouprc = commit_ack_wait(&last->seqnum, txnsize);
+
+        while ((a = listc_rtl(&group)) != NULL) {
+            rc = grouprc;
+            /* the older commits may still have made it */
+            if (rc && count > 1 && a != last)
+                rc = commit_ack_wait(&a->seqnum, a->txnsize);
+            if (rc == BDBERR_NOT_DURABLE) {
+                a->errstat.errval = ERR_NOT_DURABLE;
+                a->rc = ERR_NOT_DURABLE;
+            } else if (rc != 0) {
+                logmsg(LOGMSG_ERROR,
+                       "*WARNING* bdb_wait_seqnum:error syncing all nodes rc "
+                       "%d\n",
+                       rc);
+            }
+            osql_comm_signal_sqlthr_rc(&a->target, a->rqid, a->uuid, a->nops,
+                                       &a->errstat,
+                                       a->has_snap ? &a->snap : NULL, a->rc,
+                                       &a->lsn);
+            free(a);
+        }
+    }
+    return NULL;
+}
+
+static void commit_ack_init(void)
+{
+    pthread_t tid;
+    listc_init(&commit_acks, offsetof(struct commit_ack, lnk));
+    Pthread_create(&tid, &gbl_pthread_attr_detached, commit_ack_thd, NULL);
+}
+
+/* Reply to the sorese request once its deferred commit is durable.  Returns
+ * non-zero if the caller has to send the reply itself. */
+int trans_defer_commit_ack(struct ireq *iq, int rc)
+{
+    struct commit_ack *a;
+
+    if (!iq->commit_ack_deferred)
+        return 1;
+    iq->commit_ack_deferred = 0;
+    if ((a = calloc(1, sizeof(*a))) == NULL) {
+        /* wait here, as we would have without async_commit_ack */
+        trans_wait_for_seqnum_int(thedb->bdb_env, thedb, iq, gbl_myhostname,
+                                  -1, 1, &iq->commit_ack_seqnum);
+        return 1;
+    }
+    a->target = iq->sorese->target;
+    a->rqid = iq->sorese->rqid;
+    comdb2uuidcpy(a->uuid, iq->sorese->uuid);
+    a->nops = iq->sorese->nops;
+    a->errstat = iq->errstat;
+    if (IQ_HAS_SNAPINFO(iq)) {
+        a->snap = *IQ_SNAPINFO(iq);
+        a->has_snap = 1;
+    }
+    a->rc = rc;
+    memcpy(&a->seqnum, &iq->commit_ack_seqnum, sizeof(a->seqnum));
+    a->txnsize = iq->txnsize;
+    a->lsn = iq->commit_lsn;
+
+    pthread_once(&commit_ack_once, commit_ack_init);
+    Pthread_mutex_lock(&commit_ack_lk);
+    listc_abl(&commit_acks, a);
+    Pthread_cond_signal(&commit_ack_cond);
+    Pthread_mutex_unlock(&commit_ack_lk);
+    return 0;
+}
 
 static int trans_commit_int(struct ireq *iq, void *trans, char *source_host,
                             int timeoutms, int adaptive, int logical,
@@ -752,6 +925,19 @@ static int trans_commit_int(struct ireq *iq, void *trans, char *source_host,
         return rc;
     }
 
+    if (release_schema_lk) {
+        DB_LSN *lsn = (DB_LSN *)&ss;
+        iq->commit_lsn.file = lsn->file;
+        iq->commit_lsn.offset = lsn->offset;
+    }
+
+    /* parent commit of an osql transaction: let the commit ack thread wait */
+    if (release_schema_lk && adaptive && commit_ack_can_defer(iq)) {
+        memcpy(&iq->commit_ack_seqnum, &ss, sizeof(ss));
+        iq->commit_ack_deferred = 1;
+        return 0;
+    }
+
     rc = trans_wait_for_seqnum_int(bdb_handle, thedb, iq, source_host,
                                    timeoutms, adaptive, &ss);
 
@@ -2277,6 +2463,15 @@ int ix_find_by_key_tran(struct ireq *iq, void *key, int keylen, int index,
                                      trans);
 }
 
+/* Returns 0 when the unique index certainly has no entry for key, so a
+   uniqueness check can skip ix_find_by_key_tran(). */
+int ix_may_exist(struct ireq *iq, int ixnum, void *key, int keylen)
+{
+    if (iq->usedb->ix_dupes[ixnum])
+        return 1;
+    return bdb_ixfilter_may_contain(iq->usedb->handle, ixnum, key, keylen);
+}
+
 int ix_find_auxdb_by_key_tran(int auxdb, struct ireq *iq, void *key, int keylen,
                               int index, void *fndkey, int *fndrrn,
                               unsigned long long *genid, void *fnddta,
@@ -3898,16 +4093,78 @@ void get_disable_skipscan_all()
 
 
 /* open the db files, etc */
+int gbl_table_open_threads = 0;
+
+struct open_tables_arg {
+    struct dbenv *dbenv;
+    uint32_t flags;
+    int next;
+};
+
+static void *open_tables_thd(void *varg)
+{
+    struct open_tables_arg *arg = varg;
+    struct dbenv *dbenv = arg->dbenv;
+    struct dbtable *db;
+    int ii, bdberr;
+
+    comdb2_name_thread(__func__);
+    backend_thread_event(thedb, COMDB2_THR_EVENT_START_RDWR);
+    while ((ii = ATOMIC_ADD32(arg->next, 1) - 1) < dbenv->num_dbs) {
+        db = dbenv->dbs[ii];
+        db->handle = bdb_open_more_tran(
+            db->tablename, dbenv->basedir, db->lrl, db->nix,
+            (short *)db->ix_keylen, db->ix_dupes, db->ix_recnums,
+            db->ix_datacopy, db->ix_datacopylen, db->ix_collattr, db->ix_nullsallowed,
+            db->numblobs + 1, dbenv->bdb_env, NULL, arg->flags, &bdberr);
+    }
+    backend_thread_event(thedb, COMDB2_THR_EVENT_DONE_RDWR);
+    return NULL;
+}
+
+/* Open the tables on table_open_threads threads.  A table that fails to open
+ * is left without a handle for the serial loop in backend_open_tran to try
+ * again, and to report. */
+static void open_tables_parallel(struct dbenv *dbenv, uint32_t flags)
+{
+    struct open_tables_arg arg = {.dbenv = dbenv, .flags = flags};
+    int nthds = gbl_table_open_threads;
+    pthread_t *thds;
+    int i, start = comdb2_time_epochms();
+
+    if (nthds > dbenv->num_dbs)
+        nthds = dbenv->num_dbs;
+    thds = calloc(nthds, sizeof(pthread_t));
+    for (i = 0; i < nthds; i++)
+        Pthread_create(&thds[i], NULL, open_tables_thd, &arg);
+    for (i = 0; i < nthds; i++)
+        Pthread_join(thds[i], NULL);
+    free(thds);
+    logmsg(LOGMSG_INFO, "opened %d tables on %d threads in %dms\n",
+           dbenv->num_dbs, nthds, comdb2_time_epochms() - start);
+}
+
 int backend_open_tran(struct dbenv *dbenv, tran_type *tran, uint32_t flags)
 {
     int bdberr, ii;
     struct dbtable *db = NULL;
     int rc;
+    int preopened = 0;
+
+    /* at startup, open the tables in parallel if asked to */
+    if (tran == NULL && !gbl_create_mode && gbl_table_open_threads > 1 &&
+        dbenv->num_dbs > 1) {
+        open_tables_parallel(dbenv, flags);
+        preopened = 1;
+    }
 
     /* open tables */
     for (ii = 0; ii < dbenv->num_dbs; ii++) {
         db = dbenv->dbs[ii];
 
+        if (preopened && db->handle)
+            continue;
+
         if (db->dbnum)
             logmsg(LOGMSG_INFO, "open table '%s' (dbnum %d)\n", db->tablename,
                    db->dbnum);
@@ -5134,6 +5391,14 @@ int lite_del_auxdb(int auxdb, struct ireq *iq, void *trans, void *key)
 /*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 
 int dbq_add(struct ireq *iq, void *trans, const void *dta, size_t dtalen)
+{
+    return dbq_add_partition(iq, trans, dta, dtalen, -1);
+}
+
+/* add to one partition of a partitioned queue (or to an unpartitioned queue
+ * if partition is -1) */
+int dbq_add_partition(struct ireq *iq, void *trans, const void *dta,
+                      size_t dtalen, int partition)
 {
     int bdberr;
     void *bdb_handle;
@@ -5142,7 +5407,7 @@ int dbq_add(struct ireq *iq, void *trans, const void *dta, size_t dtalen)
     if (!bdb_handle)
         return ERR_NO_AUXDB;
     iq->gluewhere = "bdb_queue_add";
-    bdb_queue_add(bdb_handle, trans, dta, dtalen, &bdberr, &genid);
+    bdb_queue_add(bdb_handle, trans, dta, dtalen, partition, &bdberr, &genid);
     iq->gluewhere = "bdb_queue_add done";
 
     if (bdberr == 0) {
@@ -31,6 +31,7 @@
 #include <epochlib.h>
 #include <list.h>
 #include <pool.h>
+#include <object_pool.h>
 #include <time.h>
 
 #include "debug_switches.h"
@@ -57,7 +58,7 @@ enum THD_EV { THD_EV_END = 0, THD_EV_START = 1 };
 
 /* request pool & queue */
 
-static pool_t *p_reqs; /* request pool */
+static comdb2_objpool_t p_reqs; /* request pool */
 
 struct dbq_entry_t {
     LINKC_T(struct dbq_entry_t) qlnk;
@@ -167,13 +168,25 @@ void thd_cleanup()
     pool_clear(pq_reqs);
     pool_clear(p_slocks);
     pool_clear(p_bufs);
-    pool_clear(p_reqs);
+    comdb2_objpool_destroy(p_reqs);
     pool_clear(p_thds);
     Pthread_cond_destroy(&coalesce_wakeup);
     Pthread_attr_destroy(&attr);
     Pthread_mutex_destroy(&lock);
 }
 
+static int ireq_new(void **iqp, void *unused)
+{
+    *iqp = malloc(sizeof(struct ireq));
+    return *iqp == NULL ? ENOMEM : 0;
+}
+
+static int ireq_del(void *iq, void *unused)
+{
+    free(iq);
+    return 0;
+}
+
 int thd_init(void)
 {
     Pthread_mutex_init(&lock, 0);
@@ -185,11 +198,17 @@ int thd_init(void)
         logmsg(LOGMSG_ERROR, "thd_init:failed thd pool init");
         return -1;
     }
-    p_reqs = pool_setalloc_init(sizeof(struct ireq), 0, malloc, free);
-    if (p_reqs == 0) {
+    /* requests beyond the capacity are allocated and freed unpooled */
+    if (comdb2_objpool_create_lifo(&p_reqs, "ireq",
+                                   gbl_maxqueue + gbl_maxthreads, ireq_new,
+                                   NULL, ireq_del, NULL, NULL, NULL) != 0) {
         logmsg(LOGMSG_ERROR, "thd_init:failed req pool init");
         return -1;
     }
+    if (gbl_objpool_tcache > 0 &&
+        comdb2_objpool_setopt(p_reqs, OP_THREAD_CACHE, gbl_objpool_tcache))
+        logmsg(LOGMSG_WARN, "thd_init:bad objpool_tcache %d\n",
+               gbl_objpool_tcache);
     p_bufs = pool_setalloc_init(MAX_BUFFER_SIZE, 64, malloc, free);
     if (p_bufs == 0) {
         logmsg(LOGMSG_ERROR, "thd_init:failed buf pool init");
@@ -584,7 +603,7 @@ static void *thd_req(void *vthd)
 #if 0
             fprintf(stderr, "%s:%d: THD=%p relablk iq=%p\n", __func__, __LINE__, pthread_self(), thd->iq);
 #endif
-            pool_relablk(p_reqs, thd->iq); /* this request is done, so release
+            comdb2_objpool_return(p_reqs, thd->iq); /* this request is done, so release
                                             * resource. */
             /* get next item off hqueue */
             nxtrq = (struct dbq_entry_t *)listc_rtl(&q_reqs);
@@ -723,7 +742,7 @@ static int reterr(intptr_t curswap, struct thd *thd, struct ireq *iq, int rc)
                         iq->sb = NULL;
                     }
                 }
-                pool_relablk(p_reqs, iq);
+                comdb2_objpool_return(p_reqs, iq);
             }
         }
         UNLOCK(&lock);
@@ -762,14 +781,10 @@ static int reterr_withfree(struct ireq *iq, int rc)
         iq->p_buf_out_end = iq->p_buf_out_start = iq->p_buf_out = NULL;
         iq->p_buf_in_end = iq->p_buf_in = NULL;
 
-        LOCK(&lock)
-        {
 #if 0
-           fprintf(stderr, "%s:%d: THD=%p relablk iq=%p\n", __func__, __LINE__, pthread_self(), iq);
+        fprintf(stderr, "%s:%d: THD=%p relablk iq=%p\n", __func__, __LINE__, pthread_self(), iq);
 #endif
-            pool_relablk(p_reqs, iq);
-        }
-        UNLOCK(&lock);
+        comdb2_objpool_return(p_reqs, iq);
 
         return 0;
     } else {
@@ -990,11 +1005,8 @@ int handle_buf_main2(struct dbenv *dbenv, SBUF2 *sb, const uint8_t *p_buf,
 #endif
 
         /* allocate a request for later dispatch to available thread */
-        LOCK(&lock)
-        {
-            iq = (struct ireq *)pool_getablk(p_reqs);
-        }
-        UNLOCK(&lock);
+        if (comdb2_objpool_forcedborrow(p_reqs, (void **)&iq) != 0)
+            iq = NULL;
         if (!iq) {
             logmsg(LOGMSG_ERROR, "handle_buf:failed allocate req\n");
             return reterr(0, 0, iq, ERR_INTERNAL);
@@ -1242,8 +1254,7 @@ int handle_buf_main(struct dbenv *dbenv, SBUF2 *sb, const uint8_t *p_buf,
 
 void destroy_ireq(struct dbenv *dbenv, struct ireq *iq)
 {
-    LOCK(&lock) { pool_relablk(p_reqs, iq); }
-    UNLOCK(&lock);
+    comdb2_objpool_return(p_reqs, iq);
 }
 
 static int is_req_write(int opcode)
@@ -213,8 +213,11 @@ static int check_index(struct ireq *iq, void *trans, int ixnum, blob_buffer_t *b
         return 0;
     }
 
-    rc = ix_find_by_key_tran(iq, key, ixkeylen, ixnum, NULL, &fndrrn, &fndgenid,
-                             NULL, NULL, 0, trans);
+    if (!ix_may_exist(iq, ixnum, key, ixkeylen))
+        rc = IX_NOTFND;
+    else
+        rc = ix_find_by_key_tran(iq, key, ixkeylen, ixnum, NULL, &fndrrn,
+                                 &fndgenid, NULL, NULL, 0, trans);
     if (rc == IX_FND) {
         *ixfailnum = ixnum;
         /* If following changes, update OSQL_INSREC in osqlcomm.c */
@@ -402,9 +405,12 @@ int add_record_indices(struct ireq *iq, void *trans, blob_buffer_t *blobs,
             if (vgenid && iq->usedb->ix_dupes[ixnum] == 0 && !isnullk) {
                 int fndrrn = 0;
                 unsigned long long fndgenid = 0ULL;
-                rc =
-                    ix_find_by_key_tran(iq, key, ixkeylen, ixnum, NULL, &fndrrn,
-                                        &fndgenid, NULL, NULL, 0, trans);
+                if (!ix_may_exist(iq, ixnum, key, ixkeylen))
+                    rc = IX_NOTFND;
+                else
+                    rc = ix_find_by_key_tran(iq, key, ixkeylen, ixnum, NULL,
+                                             &fndrrn, &fndgenid, NULL, NULL, 0,
+                                             trans);
                 if (rc == IX_FND && fndgenid == vgenid) {
                     rc = ERR_VERIFY;
                     goto done;
@@ -1003,9 +1009,13 @@ int upd_new_record_add2indices(struct ireq *iq, void *trans,
         if (vgenid && iq->usedb->ix_dupes[ixnum] == 0 && !isnullk) {
             int fndrrn = 0;
             unsigned long long fndgenid = 0ULL;
-            rc = ix_find_by_key_tran(iq, key, getkeysize(iq->usedb, ixnum),
-                                     ixnum, NULL, &fndrrn, &fndgenid, NULL,
-                                     NULL, 0, trans);
+            int ixkeylen = getkeysize(iq->usedb, ixnum);
+            if (!ix_may_exist(iq, ixnum, key, ixkeylen))
+                rc = IX_NOTFND;
+            else
+                rc = ix_find_by_key_tran(iq, key, ixkeylen, ixnum, NULL,
+                                         &fndrrn, &fndgenid, NULL, NULL, 0,
+                                         trans);
             if (rc == IX_FND && fndgenid == vgenid) {
                 return ERR_VERIFY;
             } else if (rc == IX_FND) {
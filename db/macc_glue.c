@@ -18,6 +18,7 @@
 #include "tag.h"
 #include "dynschematypes.h"
 #include "dynschemaload.h"
+#include "intern_strings.h"
 
 static dbtable *newdb_from_schema(struct dbenv *env, char *tblname, int dbnum,
                                   int dbix);
@@ -127,6 +128,7 @@ static dbtable *newdb_from_schema(struct dbenv *env, char *tblname, int dbnum,
 
     tbl->dbtype = DBTYPE_TAGGED_TABLE;
     tbl->tablename = strdup(tblname);
+    tbl->interned_name = intern(tblname);
     tbl->dbenv = env;
     tbl->dbnum = dbnum;
     tbl->lrl = dyns_get_db_table_size(); /* this gets adjusted later */
@@ -0,0 +1,160 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "comdb2.h"
+#include "bdb_api.h"
+#include "memgov.h"
+#include <comdb2_atomic.h>
+#include <logmsg.h>
+#include <mem.h>
+
+int gbl_mem_budget_mb = 0;
+
+/* percent of the budget where we start giving memory back, and where we
+   stop holding caches down */
+#define MEMGOV_HIGH_PCT 90
+#define MEMGOV_LOW_PCT 80
+
+/* NICE_MODERATE in dlmalloc.h */
+#define MEMGOV_NICE 1
+
+extern int gbl_max_sqlcache;
+
+static int64_t sqlcache_lookups;
+static int64_t sqlcache_hits;
+
+/* 0 while the governor holds nothing down */
+static int sqlcache_limit;
+
+/* niceness to go back to, or -1 if we haven't changed it */
+static int saved_nice = -1;
+
+static int under_pressure;
+
+void memgov_note_sqlcache_lookup(int hit)
+{
+    ATOMIC_ADD64(sqlcache_lookups, 1);
+    if (hit)
+        ATOMIC_ADD64(sqlcache_hits, 1);
+}
+
+int memgov_sqlcache_limit(void)
+{
+    int limit = ATOMIC_LOAD32(sqlcache_limit);
+
+    if (limit > 0 && limit < gbl_max_sqlcache)
+        return limit;
+    return gbl_max_sqlcache;
+}
+
+static int64_t resident_mb(void)
+{
+    long long size, resident;
+    FILE *f;
+    int n;
+
+    if ((f = fopen("/proc/self/statm", "r")) == NULL)
+        return -1;
+    n = fscanf(f, "%lld %lld", &size, &resident);
+    fclose(f);
+    if (n != 2)
+        return -1;
+    return resident * sysconf(_SC_PAGESIZE) / (1024 * 1024);
+}
+
+/* Give memory back, cheapest first */
+static void memgov_shrink(int pct, int hit_pct)
+{
+    int limit = memgov_sqlcache_limit();
+
+    bdb_temp_table_clear_cache(thedb->bdb_env);
+    comdb2ma_release();
+
+    /* a cache that rarely hits costs more than it saves */
+    if (limit > 1) {
+        limit -= hit_pct < 50 ? limit / 2 : limit / 4;
+        if (limit < 1)
+            limit = 1;
+        XCHANGE32(sqlcache_limit, limit);
+    }
+
+    if (pct >= 100 && saved_nice < 0 && comdb2ma_niceness() < MEMGOV_NICE) {
+        saved_nice = comdb2ma_niceness();
+        comdb2ma_nice(MEMGOV_NICE);
+    }
+}
+
+static void memgov_relax(void)
+{
+    int limit = ATOMIC_LOAD32(sqlcache_limit);
+
+    if (limit > 0) {
+        limit += limit / 4 > 0 ? limit / 4 : 1;
+        XCHANGE32(sqlcache_limit, limit >= gbl_max_sqlcache ? 0 : limit);
+    }
+    if (saved_nice >= 0) {
+        comdb2ma_nice(saved_nice);
+        saved_nice = -1;
+    }
+}
+
+void memgov_update(void)
+{
+    static int64_t last_lookups, last_hits;
+    int64_t lookups, hits, rss;
+    int pct, hit_pct;
+
+    lookups = ATOMIC_LOAD64(sqlcache_lookups);
+    hits = ATOMIC_LOAD64(sqlcache_hits);
+    hit_pct = lookups > last_lookups
+                  ? (hits - last_hits) * 100 / (lookups - last_lookups)
+                  : 100;
+    last_lookups = lookups;
+    last_hits = hits;
+
+    if (gbl_mem_budget_mb <= 0 || (rss = resident_mb()) < 0) {
+        under_pressure = 0;
+        XCHANGE32(sqlcache_limit, 0);
+        if (saved_nice >= 0) {
+            comdb2ma_nice(saved_nice);
+            saved_nice = -1;
+        }
+        return;
+    }
+
+    pct = rss * 100 / gbl_mem_budget_mb;
+    if (pct >= MEMGOV_HIGH_PCT) {
+        if (!under_pressure)
+            logmsg(LOGMSG_WARN,
+                   "memgov: resident %lld MB is %d%% of budget %d MB, "
+                   "shrinking caches (statement cache hits %d%%)\n",
+                   (long long)rss, pct, gbl_mem_budget_mb, hit_pct);
+        under_pressure = 1;
+        memgov_shrink(pct, hit_pct);
+    } else if (pct < MEMGOV_LOW_PCT) {
+        if (under_pressure)
+            logmsg(LOGMSG_INFO,
+                   "memgov: resident %lld MB is %d%% of budget %d MB, "
+                   "letting caches grow\n",
+                   (long long)rss, pct, gbl_mem_budget_mb);
+        under_pressure = 0;
+        memgov_relax();
+    }
+}
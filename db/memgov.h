@@ -0,0 +1,46 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_MEMGOV_H
+#define INCLUDED_MEMGOV_H
+
+/*
+  Memory governor
+
+  Opt-in with mem_budget_mb.  Once a second the stat thread compares the
+  resident size of the process with the budget.  Over 90% of it, the caches
+  that are cheapest to lose give memory back first: idle pooled temp tables,
+  then the free pages the allocators hold, then the per-thread statement
+  caches, which shrink faster the fewer lookups they satisfy.  Over the budget
+  the allocators are also made nicer.  Below 80% the statement caches grow
+  back towards max_sqlcache and the allocators go back to their old niceness.
+
+  The buffer pool can't be resized while running, so it is left alone; size
+  cachekb so that it fits in the budget with room to spare.
+*/
+
+extern int gbl_mem_budget_mb;
+
+/* Called once a second by the stat thread */
+void memgov_update(void);
+
+/* Most statements a thread should keep in each of its statement caches */
+int memgov_sqlcache_limit(void);
+
+/* A thread looked for a statement in its cache */
+void memgov_note_sqlcache_lookup(int hit);
+
+#endif
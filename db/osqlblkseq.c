@@ -30,9 +30,15 @@
 
 int gbl_block_blkseq_poll = 10; /* 10 msec */
 
-static hash_t *hiqs = NULL;
-static hash_t *hiqs_cnonce = NULL;
-static pthread_mutex_t hmtx = PTHREAD_MUTEX_INITIALIZER;
+/* The in-flight set is split into shards by key hash, so concurrent
+ * transactions only contend when their blkseqs land in the same shard. */
+#define OSQL_BLKSEQ_SHARDS 32
+
+static struct blkseq_shard {
+    pthread_mutex_t mtx;
+    hash_t *hiqs;
+    hash_t *hiqs_cnonce;
+} shards[OSQL_BLKSEQ_SHARDS];
 
 unsigned int cnonce_hashfunc(const void *key, int len)
 {
@@ -57,20 +63,33 @@ int cnonce_hashcmpfunc(const void *key1, const void *key2, int len)
     return -1;
 }
 
+static inline struct blkseq_shard *cnonce_shard(struct ireq *iq)
+{
+    return &shards[cnonce_hashfunc(IQ_SNAPINFO(iq), 0) % OSQL_BLKSEQ_SHARDS];
+}
+
+static inline struct blkseq_shard *seq_shard(struct ireq *iq)
+{
+    return &shards[hash_default_fixedwidth((const unsigned char *)&iq->seq,
+                                           sizeof(fstblkseq_t)) %
+                   OSQL_BLKSEQ_SHARDS];
+}
+
 int osql_blkseq_register_cnonce(struct ireq *iq)
 {
+    struct blkseq_shard *sh = cnonce_shard(iq);
     void *iq_src = NULL;
     int rc = 0;
 
-    assert(hiqs_cnonce != NULL);
+    assert(sh->hiqs_cnonce != NULL);
 
-    Pthread_mutex_lock(&hmtx);
-    iq_src = hash_find(hiqs_cnonce, IQ_SNAPINFO(iq));
+    Pthread_mutex_lock(&sh->mtx);
+    iq_src = hash_find(sh->hiqs_cnonce, IQ_SNAPINFO(iq));
     if (!iq_src) { /* not there, we add it */
-        hash_add(hiqs_cnonce, IQ_SNAPINFO(iq));
+        hash_add(sh->hiqs_cnonce, IQ_SNAPINFO(iq));
         rc = OSQL_BLOCKSEQ_FIRST;
     }
-    Pthread_mutex_unlock(&hmtx);
+    Pthread_mutex_unlock(&sh->mtx);
 #ifdef DEBUG_BLKSEQ
     if (!iq_src) {
         logmsg(LOGMSG_DEBUG, "Added to blkseq %*s\n",
@@ -84,9 +103,9 @@ int osql_blkseq_register_cnonce(struct ireq *iq)
                IQ_SNAPINFO(iq)->keylen - 3, IQ_SNAPINFO(iq)->key);
         poll(NULL, 0, gbl_block_blkseq_poll);
 
-        Pthread_mutex_lock(&hmtx);
-        iq_src = hash_find_readonly(hiqs_cnonce, IQ_SNAPINFO(iq));
-        Pthread_mutex_unlock(&hmtx);
+        Pthread_mutex_lock(&sh->mtx);
+        iq_src = hash_find_readonly(sh->hiqs_cnonce, IQ_SNAPINFO(iq));
+        Pthread_mutex_unlock(&sh->mtx);
 
         if (!iq_src) {
             /* done waiting */
@@ -98,12 +117,18 @@ int osql_blkseq_register_cnonce(struct ireq *iq)
     return rc;
 }
 
-/* call with hmtx acquired */
 static inline int osql_blkseq_unregister_cnonce(struct ireq *iq)
 {
-    assert(hiqs_cnonce != NULL);
+    struct blkseq_shard *sh = cnonce_shard(iq);
+    int rc;
+
+    assert(sh->hiqs_cnonce != NULL);
+
+    Pthread_mutex_lock(&sh->mtx);
+    rc = hash_del(sh->hiqs_cnonce, IQ_SNAPINFO(iq));
+    Pthread_mutex_unlock(&sh->mtx);
 
-    return hash_del(hiqs_cnonce, IQ_SNAPINFO(iq));
+    return rc;
 }
 
 /*
@@ -114,21 +139,24 @@ int osql_blkseq_init(void)
 {
     int rc = 0;
 
-    Pthread_mutex_lock(&hmtx);
+    for (int i = 0; i < OSQL_BLKSEQ_SHARDS; i++) {
+        struct blkseq_shard *sh = &shards[i];
 
-    hiqs = hash_init_o(offsetof(struct ireq, seq), sizeof(fstblkseq_t));
-    if (!hiqs) {
-        logmsg(LOGMSG_FATAL, "UNABLE TO init hash\n");
-        abort();
-    }
+        Pthread_mutex_init(&sh->mtx, NULL);
 
-    hiqs_cnonce = hash_init_user(cnonce_hashfunc, cnonce_hashcmpfunc, 0, 0);
-    if (!hiqs) {
-        logmsg(LOGMSG_FATAL, "UNABLE TO init cnonce hash\n");
-        abort();
-    }
+        sh->hiqs = hash_init_o(offsetof(struct ireq, seq), sizeof(fstblkseq_t));
+        if (!sh->hiqs) {
+            logmsg(LOGMSG_FATAL, "UNABLE TO init hash\n");
+            abort();
+        }
 
-    Pthread_mutex_unlock(&hmtx);
+        sh->hiqs_cnonce =
+            hash_init_user(cnonce_hashfunc, cnonce_hashcmpfunc, 0, 0);
+        if (!sh->hiqs_cnonce) {
+            logmsg(LOGMSG_FATAL, "UNABLE TO init cnonce hash\n");
+            abort();
+        }
+    }
 
     return rc;
 }
@@ -142,26 +170,27 @@ int osql_blkseq_init(void)
  */
 int osql_blkseq_register(struct ireq *iq)
 {
+    struct blkseq_shard *sh = seq_shard(iq);
     struct ireq *iq_src = NULL;
     int rc = 0;
 
-    assert(hiqs != NULL);
+    assert(sh->hiqs != NULL);
 
-    Pthread_mutex_lock(&hmtx);
-    iq_src = hash_find(hiqs, (const void *)&iq->seq);
+    Pthread_mutex_lock(&sh->mtx);
+    iq_src = hash_find(sh->hiqs, (const void *)&iq->seq);
     if (!iq_src) { /* not there, we add it */
-        hash_add(hiqs, iq);
+        hash_add(sh->hiqs, iq);
         rc = OSQL_BLOCKSEQ_FIRST;
     }
-    Pthread_mutex_unlock(&hmtx);
+    Pthread_mutex_unlock(&sh->mtx);
 
     /* rc == 0 means we need to wait for it to go away */
     while (rc == 0) {
         poll(NULL, 0, gbl_block_blkseq_poll);
 
-        Pthread_mutex_lock(&hmtx);
-        iq_src = hash_find_readonly(hiqs, (const void *)&iq->seq);
-        Pthread_mutex_unlock(&hmtx);
+        Pthread_mutex_lock(&sh->mtx);
+        iq_src = hash_find_readonly(sh->hiqs, (const void *)&iq->seq);
+        Pthread_mutex_unlock(&sh->mtx);
 
         if (!iq_src) {
             /* done waiting */
@@ -186,11 +215,14 @@ int osql_blkseq_unregister(struct ireq *iq)
     if (!iq->have_blkseq)
         return 0;
 
-    assert(hiqs != NULL);
+    struct blkseq_shard *sh = seq_shard(iq);
 
-    Pthread_mutex_lock(&hmtx);
+    assert(sh->hiqs != NULL);
+
+    Pthread_mutex_lock(&sh->mtx);
+    hash_del(sh->hiqs, iq);
+    Pthread_mutex_unlock(&sh->mtx);
 
-    hash_del(hiqs, iq);
     if (IQ_HAS_SNAPINFO_KEY(iq)) {
 #ifdef DEBUG_BLKSEQ
         int rc = osql_blkseq_unregister_cnonce(iq);
@@ -198,8 +230,6 @@ int osql_blkseq_unregister(struct ireq *iq)
         osql_blkseq_unregister_cnonce(iq);
 #endif
     }
-
-    Pthread_mutex_unlock(&hmtx);
 #ifdef DEBUG_BLKSEQ
     if (IQ_HAS_SNAPINFO_KEY(iq))
         logmsg(LOGMSG_DEBUG, "Removed from blkseq %*s, rc=%d\n",
@@ -55,11 +55,25 @@
 #include "sc_global.h"
 #include "schemachange.h"
 #include "gettimeofday_ms.h"
+#include "comdb2_atomic.h"
 
 extern int gbl_reorder_idx_writes;
 extern uint32_t gbl_max_time_per_txn_ms;
 
 
+/* Rows a session updates or deletes, hashed into a small bitmap, so a bplog
+ * about to be applied can tell whether a session applied ahead of it is
+ * likely to lock the same rows. */
+#define BPLOG_CONFLICT_WORDS 64
+#define BPLOG_CONFLICT_BITS (BPLOG_CONFLICT_WORDS * 64)
+
+typedef struct bplog_inflight {
+    uint64_t rows[BPLOG_CONFLICT_WORDS];
+    int nrows;
+    struct bplog_inflight *prev;
+    struct bplog_inflight *next;
+} bplog_inflight_t;
+
 struct blocksql_tran {
     pthread_mutex_t store_mtx; /* mutex for db access - those are non-env dbs */
     struct temp_table *db_ins; /* keeps the list of INSERT ops for a session */
@@ -86,6 +100,15 @@ struct blocksql_tran {
 
     /* prefetch */
     struct dbtable *last_db;
+
+    /* early conflict check */
+    bplog_inflight_t inflight;
+
+    /* streaming: the block processor applies ops while they still arrive */
+    int streaming;
+    int stream_done; /* the last op is saved */
+    int stream_rc;   /* set if the session was cancelled mid-stream */
+    pthread_cond_t stream_cond;
 };
 
 typedef struct oplog_key {
@@ -104,6 +127,34 @@ typedef struct {
 } selectv_genid_t;
 
 int gbl_selectv_writelock_on_update = 1;
+int gbl_osql_bplog_prefetch_ops = 0;
+int gbl_osql_bplog_conflict_wait_ms = 0;
+int gbl_osql_bplog_stream_ops = 0;
+int gbl_osql_bplog_stream_idle_ms = 10000;
+uint64_t gbl_osql_bplog_conflict_waits = 0;
+uint64_t gbl_osql_bplog_conflict_timeouts = 0;
+
+/* Sessions currently applying their bplog, oldest first */
+static pthread_mutex_t bplog_inflight_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bplog_inflight_cond = PTHREAD_COND_INITIALIZER;
+static bplog_inflight_t *bplog_inflight_head;
+static bplog_inflight_t *bplog_inflight_tail;
+
+/* Lookahead prefetch for bplog apply: a second pair of cursors walks the
+ * sorted bplog in the same order as the block processor, and hands the
+ * upcoming ops to the osql prefault pool (see osqlpfthdpool.c).  This lets
+ * page reads for the next ops overlap with the apply of the current one. */
+typedef struct bplog_prefetch {
+    struct temp_cursor *dbc;
+    struct temp_cursor *dbc_ins;
+    oplog_key_t *opkey;
+    oplog_key_t *opkey_ins;
+    uint8_t add_stripe;
+    int drain_adds;
+    int pos; /* apply order position of the next op to prefetch */
+    int eof;
+    struct dbtable *last_db;
+} bplog_prefetch_t;
 
 static int apply_changes(struct ireq *iq, blocksql_tran_t *tran, void *iq_tran,
                          int *nops, struct block_err *err,
@@ -112,6 +163,8 @@ static int apply_changes(struct ireq *iq, blocksql_tran_t *tran, void *iq_tran,
                                      blob_buffer_t blobs[MAXBLOBS], int,
                                      struct block_err *, int *));
 static int req2blockop(int reqtype);
+static int bplog_conflict_enter(struct ireq *iq, bplog_inflight_t *in);
+static void bplog_conflict_leave(bplog_inflight_t *in);
 extern const char *get_tablename_from_rpl(int is_uuid, const char *rpl,
                                           int *tableversion);
 extern void live_sc_off(struct dbtable * db);
@@ -208,6 +261,7 @@ blocksql_tran_t *osql_bplog_create(int is_uuid, int is_reorder)
 
     tran->is_uuid = is_uuid;
     Pthread_mutex_init(&tran->store_mtx, NULL);
+    Pthread_cond_init(&tran->stream_cond, NULL);
 
     /* init temporary table and cursor */
     tran->db = bdb_temp_array_create(thedb->bdb_env, &bdberr);
@@ -335,11 +389,16 @@ int osql_bplog_commit(struct ireq *iq, void *iq_trans, int *nops,
 {
     blocksql_tran_t *tran = iq->sorese->tran;
     ckgenid_state_t cgstate = {.iq = iq, .trans = iq_trans, .err = err};
-    int rc;
+    int rc, queued;
+
+    /* Don't start locking rows another session is applying right now */
+    queued = bplog_conflict_enter(iq, &tran->inflight);
 
     /* Pre-process selectv's, getting a writelock on rows that are later updated
      */
     if ((rc = osql_process_selectv(tran, pselectv_callback, &cgstate)) != 0) {
+        if (queued)
+            bplog_conflict_leave(&tran->inflight);
         iq->timings.req_applied = osql_log_time();
         return rc;
     }
@@ -347,6 +406,9 @@ int osql_bplog_commit(struct ireq *iq, void *iq_trans, int *nops,
     /* apply changes */
     rc = apply_changes(iq, tran, iq_trans, nops, err, osql_process_packet);
 
+    if (queued)
+        bplog_conflict_leave(&tran->inflight);
+
     iq->timings.req_applied = osql_log_time();
 
     return rc;
@@ -403,6 +465,7 @@ void osql_bplog_close(blocksql_tran_t **ptran)
     }
 
     Pthread_mutex_destroy(&tran->store_mtx);
+    Pthread_cond_destroy(&tran->stream_cond);
 
     rc = bdb_temp_table_close(thedb->bdb_env, tran->db, &bdberr);
     if (rc != 0) {
@@ -421,6 +484,99 @@ void osql_bplog_close(blocksql_tran_t **ptran)
     free(tran);
 }
 
+static void bplog_conflict_add(bplog_inflight_t *in, uint16_t tbl_idx,
+                               unsigned long long genid)
+{
+    uint64_t h = (genid ^ ((uint64_t)tbl_idx << 48)) * 0x9e3779b97f4a7c15ULL;
+    int bit = (h >> 52) % BPLOG_CONFLICT_BITS;
+
+    in->rows[bit / 64] |= 1ULL << (bit % 64);
+    in->nrows++;
+}
+
+static int bplog_conflict_overlaps(const bplog_inflight_t *a,
+                                   const bplog_inflight_t *b)
+{
+    for (int i = 0; i < BPLOG_CONFLICT_WORDS; i++) {
+        if (a->rows[i] & b->rows[i])
+            return 1;
+    }
+    return 0;
+}
+
+/* Queue this session behind the sessions already applying their bplogs, and
+ * wait (up to osql_bplog_conflict_wait_ms) for those that touch the same rows
+ * to finish.  A session only ever waits on sessions queued ahead of it, so
+ * waiters cannot form a cycle; if the wait times out we apply anyway and
+ * leave it to the deadlock detector.  Returns 1 if the session was queued. */
+static int bplog_conflict_enter(struct ireq *iq, bplog_inflight_t *in)
+{
+    int waited = 0;
+    struct timespec deadline;
+
+    /* a bitmap this full would conflict with everything */
+    if (gbl_osql_bplog_conflict_wait_ms <= 0 || in->nrows == 0 ||
+        in->nrows > BPLOG_CONFLICT_BITS / 8)
+        return 0;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += gbl_osql_bplog_conflict_wait_ms / 1000;
+    deadline.tv_nsec += (gbl_osql_bplog_conflict_wait_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    Pthread_mutex_lock(&bplog_inflight_mtx);
+    in->next = NULL;
+    in->prev = bplog_inflight_tail;
+    if (bplog_inflight_tail)
+        bplog_inflight_tail->next = in;
+    else
+        bplog_inflight_head = in;
+    bplog_inflight_tail = in;
+
+    for (;;) {
+        bplog_inflight_t *ahead;
+        for (ahead = in->prev; ahead; ahead = ahead->prev) {
+            if (bplog_conflict_overlaps(ahead, in))
+                break;
+        }
+        if (ahead == NULL)
+            break;
+        if (!waited) {
+            waited = 1;
+            ATOMIC_ADD64(gbl_osql_bplog_conflict_waits, 1);
+            if (iq->debug)
+                reqprintf(iq, "BPLOG WAITING ON CONFLICTING SESSION");
+        }
+        if (pthread_cond_timedwait(&bplog_inflight_cond, &bplog_inflight_mtx,
+                                   &deadline) == ETIMEDOUT) {
+            ATOMIC_ADD64(gbl_osql_bplog_conflict_timeouts, 1);
+            break;
+        }
+    }
+    Pthread_mutex_unlock(&bplog_inflight_mtx);
+
+    return 1;
+}
+
+static void bplog_conflict_leave(bplog_inflight_t *in)
+{
+    Pthread_mutex_lock(&bplog_inflight_mtx);
+    if (in->prev)
+        in->prev->next = in->next;
+    else
+        bplog_inflight_head = in->next;
+    if (in->next)
+        in->next->prev = in->prev;
+    else
+        bplog_inflight_tail = in->prev;
+    in->prev = in->next = NULL;
+    Pthread_cond_broadcast(&bplog_inflight_cond);
+    Pthread_mutex_unlock(&bplog_inflight_mtx);
+}
+
 static void setup_reorder_key(blocksql_tran_t *tran, int type,
                               osql_sess_t *sess, unsigned long long rqid,
                               char *rpl, oplog_key_t *key)
@@ -462,6 +618,8 @@ static void setup_reorder_key(blocksql_tran_t *tran, int type,
 #if DEBUG_REORDER
             logmsg(LOGMSG_DEBUG, "REORDER: Received genid 0x%llx\n", genid);
 #endif
+            if (type != OSQL_RECGENID)
+                bplog_conflict_add(&tran->inflight, tran->tbl_idx, genid);
         }
         tran->last_genid = genid;
         key->is_rec = 1;
@@ -534,7 +692,8 @@ static void _pre_process_saveop(osql_sess_t *sess, blocksql_tran_t *tran,
         break;
     }
 
-    if (tran->is_selectv_wl_upd)
+    /* the block processor has already taken the selectv locks */
+    if (tran->is_selectv_wl_upd && !tran->streaming)
         osql_cache_selectv(tran, rpl, type);
 }
 
@@ -584,6 +743,15 @@ int osql_bplog_saveop(osql_sess_t *sess, blocksql_tran_t *tran, char *rpl,
     /* add the op into the temporary table */
     Pthread_mutex_lock(&tran->store_mtx);
 
+    if (tran->streaming && type == OSQL_SCHEMACHANGE) {
+        /* the block processor was not set up for ddl; fail it */
+        if (!tran->stream_rc)
+            tran->stream_rc = ERR_SC;
+        Pthread_cond_signal(&tran->stream_cond);
+        Pthread_mutex_unlock(&tran->store_mtx);
+        return 0;
+    }
+
     struct temp_table *tmptbl = tran->db;
     if (tran->is_reorder_on) {
         setup_reorder_key(tran, type, sess, sess->rqid, rpl, &key);
@@ -609,6 +777,8 @@ int osql_bplog_saveop(osql_sess_t *sess, blocksql_tran_t *tran, char *rpl,
                                &sess->iq->osql_step_ix, sess->rqid, sess->uuid,
                                tran->seq);
         }
+        if (tran->streaming)
+            Pthread_cond_signal(&tran->stream_cond);
     }
 
     Pthread_mutex_unlock(&tran->store_mtx);
@@ -616,6 +786,49 @@ int osql_bplog_saveop(osql_sess_t *sess, blocksql_tran_t *tran, char *rpl,
     return rc;
 }
 
+/**
+ * Large sessions can be handed to the block processor before all their ops
+ * have arrived; it applies them in the order they were saved and waits for
+ * the rest.  Reordered bplogs are only sorted once complete, ddl needs to be
+ * known when the request starts, and snapisol/serial need the whole read
+ * set, so those are left alone.
+ * Returns 1 if the bplog was marked streaming and should be dispatched now.
+ */
+int osql_bplog_stream_start(osql_sess_t *sess, blocksql_tran_t *tran)
+{
+    int start = 0;
+
+    if (gbl_osql_bplog_stream_ops <= 0 || tran->is_reorder_on ||
+        sess->is_tranddl)
+        return 0;
+    if (sess->type != OSQL_SOCK_REQ && sess->type != OSQL_SOCK_REQ_COST &&
+        sess->type != OSQL_RECOM_REQ)
+        return 0;
+
+    Pthread_mutex_lock(&tran->store_mtx);
+    if (!tran->streaming && tran->seq >= gbl_osql_bplog_stream_ops) {
+        tran->streaming = 1;
+        start = 1;
+    }
+    Pthread_mutex_unlock(&tran->store_mtx);
+
+    return start;
+}
+
+/**
+ * No more ops will be saved for a streaming bplog; rc is non-zero if the
+ * session was cancelled before its last op
+ */
+void osql_bplog_stream_end(blocksql_tran_t *tran, int rc)
+{
+    Pthread_mutex_lock(&tran->store_mtx);
+    tran->stream_done = 1;
+    if (rc && !tran->stream_rc)
+        tran->stream_rc = rc;
+    Pthread_cond_signal(&tran->stream_cond);
+    Pthread_mutex_unlock(&tran->store_mtx);
+}
+
 /**
  * Set proper blkseq from session to iq
  * NOTE: We don't need to create buffers _SEQ, _SEQV2 for it
@@ -884,9 +1097,101 @@ get_next_merge_tmps(struct temp_cursor *dbc, struct temp_cursor *dbc_ins,
 #define DEBUG_PRINT_TMPBL_READ()
 #endif
 
+/* Position the prefetch cursors on the first op; returns non-zero if there is
+ * nothing to prefetch */
+static int bplog_prefetch_init(struct ireq *iq, bplog_prefetch_t *pf)
+{
+    int bdberr = 0;
+    int rc = bdb_temp_table_first(thedb->bdb_env, pf->dbc, &bdberr);
+    if (rc)
+        return rc;
+    pf->opkey = (oplog_key_t *)bdb_temp_table_key(pf->dbc);
+    return init_ins_tbl(iq->reqlogger, pf->dbc_ins, &pf->opkey_ins,
+                        &pf->add_stripe, &bdberr);
+}
+
+/* Enqueue faults for all the ops up to apply position 'upto' */
+static void bplog_prefetch_advance(struct ireq *iq, osql_sess_t *sess,
+                                   bplog_prefetch_t *pf, int upto)
+{
+    int bdberr = 0;
+
+    while (!pf->eof && pf->pos <= upto) {
+        char *data = NULL;
+        int datalen = 0;
+        get_tmptbl_data_and_len(pf->dbc, pf->dbc_ins, pf->drain_adds, &data,
+                                &datalen);
+        if (data)
+            osql_page_prefault_step(data, datalen, &pf->last_db,
+                                    &iq->osql_step_ix, sess->rqid, sess->uuid,
+                                    pf->pos);
+        pf->pos++;
+        if (get_next_merge_tmps(pf->dbc, pf->dbc_ins, &pf->opkey,
+                                &pf->opkey_ins, &pf->drain_adds, &bdberr,
+                                pf->add_stripe))
+            pf->eof = 1;
+    }
+}
+
+/* Position a streaming bplog cursor on op "seq", waiting for the session to
+ * save it.  Returns the cursor rc (IX_PASTEOF if the session ended first);
+ * if the stream was cancelled, or went idle, sets *rc_out instead.  Called
+ * with store_mtx held. */
+static int bplog_stream_next(struct ireq *iq, blocksql_tran_t *tran,
+                             struct temp_cursor *dbc, uint32_t seq,
+                             oplog_key_t **opkey, int *bdberr,
+                             struct block_err *err, int *rc_out)
+{
+    oplog_key_t key = {0};
+    int idle_ms = 0;
+    int rc;
+
+    while (!tran->stream_rc && !tran->stream_done && tran->seq <= seq) {
+        struct timespec ts;
+
+        if (bdb_lock_desired(thedb->bdb_env) ||
+            (gbl_osql_bplog_stream_idle_ms > 0 &&
+             idle_ms >= gbl_osql_bplog_stream_idle_ms)) {
+            tran->stream_rc = ERR_NOMASTER;
+            break;
+        }
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 100 * 1000000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        if (pthread_cond_timedwait(&tran->stream_cond, &tran->store_mtx,
+                                   &ts) == ETIMEDOUT)
+            idle_ms += 100;
+    }
+
+    if (tran->stream_rc) {
+        err->blockop_num = 0;
+        err->errcode = tran->stream_rc;
+        err->ixnum = 0;
+        if (tran->stream_rc == ERR_SC)
+            reqerrstr(iq, ERR_SC, "schema change in a streamed transaction");
+        reqlog_set_error(iq->reqlogger, "bplog stream cancelled",
+                         tran->stream_rc);
+        *rc_out = tran->stream_rc;
+        return 0;
+    }
+    if (tran->seq <= seq)
+        return IX_PASTEOF;
+
+    key.seq = seq;
+    rc = bdb_temp_table_find(thedb->bdb_env, dbc, &key, sizeof(key), NULL,
+                             bdberr);
+    if (rc == 0)
+        *opkey = (oplog_key_t *)bdb_temp_table_key(dbc);
+    return rc;
+}
+
 static int process_this_session(
     struct ireq *iq, void *iq_tran, osql_sess_t *sess, int *bdberr, int *nops,
     struct block_err *err, struct temp_cursor *dbc, struct temp_cursor *dbc_ins,
+    bplog_prefetch_t *pf,
     int (*func)(struct ireq *, unsigned long long, uuid_t, void *, char **, int,
                 int *, int **, blob_buffer_t blobs[MAXBLOBS], int,
                 struct block_err *, int *))
@@ -901,6 +1206,8 @@ static int process_this_session(
     int step = 0;
     int receivedrows = 0;
     int flags = 0;
+    blocksql_tran_t *tran = sess->tran;
+    int streaming = tran->streaming;
 
     iq->queryid = osql_sess_queryid(sess);
     if (gbl_max_time_per_txn_ms)
@@ -956,6 +1263,9 @@ static int process_this_session(
     if (sess->tran_rows > 1 && gbl_reorder_idx_writes)
         iq->osql_flags |= OSQL_FLAGS_REORDER_IDX_ON;
 
+    if (pf && bplog_prefetch_init(iq, pf) != 0)
+        pf = NULL;
+
     while (!rc && !rc_out) {
         char *data = NULL;
         int datalen = 0;
@@ -977,12 +1287,28 @@ static int process_this_session(
 
         lastrcv = receivedrows;
 
+        if (pf) {
+            bplog_prefetch_advance(iq, sess, pf,
+                                   step + gbl_osql_bplog_prefetch_ops);
+            /* drop faults for the ops we have already applied */
+            if (iq->osql_step_ix)
+                gbl_osqlpf_step[*(iq->osql_step_ix)].step =
+                    (unsigned long long)step << 7;
+        }
+
+        /* let the session keep saving ops while we apply this one */
+        if (streaming)
+            Pthread_mutex_unlock(&tran->store_mtx);
+
         /* This call locks pages:
          * func is osql_process_packet or osql_process_schemachange */
         rc_out = func(iq, sess->rqid, sess->uuid, iq_tran, &data, datalen,
                       &flags, &updCols, blobs, step, err, &receivedrows);
         free(data);
 
+        if (streaming)
+            Pthread_mutex_lock(&tran->store_mtx);
+
         if (rc_out != 0 && rc_out != OSQL_RC_DONE) {
             reqlog_set_error(iq->reqlogger, "Error processing", rc_out);
             /* error processing, can be a verify error or deadlock */
@@ -994,11 +1320,15 @@ static int process_this_session(
         }
 
         step++;
-        rc = get_next_merge_tmps(dbc, dbc_ins, &opkey, &opkey_ins, &drain_adds,
-                                 bdberr, add_stripe);
+        if (streaming)
+            rc = bplog_stream_next(iq, tran, dbc, opkey->seq + 1, &opkey,
+                                   bdberr, err, &rc_out);
+        else
+            rc = get_next_merge_tmps(dbc, dbc_ins, &opkey, &opkey_ins,
+                                     &drain_adds, bdberr, add_stripe);
     }
 
-    if (iq->osql_step_ix)
+    if (iq->osql_step_ix && !pf)
         gbl_osqlpf_step[*(iq->osql_step_ix)].step = opkey->seq << 7;
 
     /* if for some reason the session has not completed correctly,
@@ -1040,6 +1370,8 @@ static int apply_changes(struct ireq *iq, blocksql_tran_t *tran, void *iq_tran,
     int bdberr = 0;
     struct temp_cursor *dbc = NULL;
     struct temp_cursor *dbc_ins = NULL;
+    bplog_prefetch_t prefetch = {0};
+    bplog_prefetch_t *pf = NULL;
 
     /* lock the table (it should get no more access anway) */
     Pthread_mutex_lock(&tran->store_mtx);
@@ -1081,11 +1413,30 @@ static int apply_changes(struct ireq *iq, blocksql_tran_t *tran, void *iq_tran,
         }
     }
 
+    /* only worth it if there are more rows than the prefetch window */
+    if (gbl_osql_bplog_prefetch_ops > 0 && gbl_osqlpfault_threads > 0 &&
+        func == osql_process_packet && !tran->streaming &&
+        iq->sorese->tran_rows > gbl_osql_bplog_prefetch_ops) {
+        prefetch.dbc =
+            bdb_temp_table_cursor(thedb->bdb_env, tran->db, NULL, &bdberr);
+        if (prefetch.dbc && tran->db_ins)
+            prefetch.dbc_ins = bdb_temp_table_cursor(
+                thedb->bdb_env, tran->db_ins, NULL, &bdberr);
+        if (prefetch.dbc && (prefetch.dbc_ins || !tran->db_ins))
+            pf = &prefetch;
+        bdberr = 0;
+    }
+
     listc_init(&iq->bpfunc_lst, offsetof(bpfunc_lstnode_t, linkct));
 
     /* go through the complete list and apply all the changes */
     out_rc = process_this_session(iq, iq_tran, iq->sorese, &bdberr, nops, err,
-                                  dbc, dbc_ins, func);
+                                  dbc, dbc_ins, pf, func);
+
+    if (prefetch.dbc)
+        bdb_temp_table_close_cursor(thedb->bdb_env, prefetch.dbc, &bdberr);
+    if (prefetch.dbc_ins)
+        bdb_temp_table_close_cursor(thedb->bdb_env, prefetch.dbc_ins, &bdberr);
 
     Pthread_mutex_unlock(&tran->store_mtx);
 
@@ -93,6 +93,20 @@ void osql_bplog_close(blocksql_tran_t **ptran);
 int osql_bplog_saveop(osql_sess_t *sess, blocksql_tran_t *tran, char *rpl,
                       int rplen, int type);
 
+/**
+ * Returns 1 if this session has saved enough ops to be dispatched now, with
+ * the block processor applying the rest as they arrive
+ *
+ */
+int osql_bplog_stream_start(osql_sess_t *sess, blocksql_tran_t *tran);
+
+/**
+ * No more ops will be saved for a streaming bplog; rc is non-zero if the
+ * session was cancelled
+ *
+ */
+void osql_bplog_stream_end(blocksql_tran_t *tran, int rc);
+
 /**
  * Construct a blockprocessor transaction buffer containing
  * a sock sql /recom  / snapisol / serial transaction
@@ -292,7 +292,8 @@ int osql_chkboard_sqlsession_exists(unsigned long long rqid, uuid_t uuid)
 
 int osql_chkboard_sqlsession_rc(unsigned long long rqid, uuid_t uuid, int nops,
                                 void *data, struct errstat *errstat,
-                                struct query_effects *effects)
+                                struct query_effects *effects,
+                                const commit_lsn_t *lsn)
 {
     if (!checkboard)
         return 0;
@@ -330,6 +331,8 @@ int osql_chkboard_sqlsession_rc(unsigned long long rqid, uuid_t uuid, int nops,
     if (gbl_master_sends_query_effects && effects) {
         memcpy(&entry->clnt->effects, effects, sizeof(struct query_effects));
     }
+    if (lsn)
+        entry->clnt->commit_lsn = *lsn;
 
     Pthread_cond_signal(&entry->cond);
     Pthread_mutex_unlock(&entry->mtx);
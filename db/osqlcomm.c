@@ -1200,6 +1200,8 @@ enum {
         OSQLCOMM_UUID_RPL_TYPE_LEN + OSQLCOMM_DONE_TYPE_LEN,
     OSQLCOMM_DONE_UUID_RPL_v2_LEN =
         OSQLCOMM_DONE_UUID_RPL_v1_LEN + (2 * sizeof(struct query_effects)),
+    OSQLCOMM_DONE_UUID_RPL_v3_LEN =
+        OSQLCOMM_DONE_UUID_RPL_v2_LEN + sizeof(commit_lsn_t),
 };
 
 #if 0
@@ -3207,7 +3209,7 @@ static void net_snap_uid_rpl(void *hndl, void *uptr, char *fromhost,
     snap_uid_t snap_info;
     snap_uid_get(&snap_info, dtap, (uint8_t *)dtap + dtalen);
     osql_chkboard_sqlsession_rc(OSQL_RQID_USE_UUID, snap_info.uuid, 0,
-                                &snap_info, NULL, &snap_info.effects);
+                                &snap_info, NULL, &snap_info.effects, NULL);
 }
 
 int gbl_disable_cnonce_blkseq;
@@ -4881,14 +4883,15 @@ int osql_comm_send_socksqlreq(osql_target_t *target, const char *sql, int sqlen,
  */
 int osql_comm_signal_sqlthr_rc(osql_target_t *target, unsigned long long rqid,
                                uuid_t uuid, int nops, struct errstat *xerr,
-                               snap_uid_t *snap, int rc)
+                               snap_uid_t *snap, int rc,
+                               const commit_lsn_t *lsn)
 {
     uuidstr_t us;
     int msglen = 0;
     int type;
     union {
         char a[OSQLCOMM_DONE_XERR_UUID_RPL_LEN];
-        char b[OSQLCOMM_DONE_UUID_RPL_v2_LEN];
+        char b[OSQLCOMM_DONE_UUID_RPL_v3_LEN];
         char c[OSQLCOMM_DONE_XERR_RPL_LEN];
         char d[OSQLCOMM_DONE_RPL_LEN];
     } largest_message;
@@ -4904,7 +4907,8 @@ int osql_comm_signal_sqlthr_rc(osql_target_t *target, unsigned long long rqid,
     if (target->host == gbl_myhostname) {
         /* local */
         return osql_chkboard_sqlsession_rc(rqid, uuid, nops, snap, xerr,
-                                           (snap) ? &snap->effects : NULL);
+                                           (snap) ? &snap->effects : NULL,
+                                           rc ? NULL : lsn);
     }
 
     /* remote */
@@ -4921,7 +4925,7 @@ int osql_comm_signal_sqlthr_rc(osql_target_t *target, unsigned long long rqid,
         } else {
             osql_done_uuid_rpl_t rpl_ok = {{0}};
             uint8_t *p_buf = buf;
-            uint8_t *p_buf_end = buf + OSQLCOMM_DONE_UUID_RPL_v2_LEN;
+            uint8_t *p_buf_end = buf + OSQLCOMM_DONE_UUID_RPL_v3_LEN;
             if (likely(gbl_master_sends_query_effects)) {
                 rpl_ok.hd.type = OSQL_DONE_WITH_EFFECTS;
             } else {
@@ -4944,6 +4948,15 @@ int osql_comm_signal_sqlthr_rc(osql_target_t *target, unsigned long long rqid,
                 p_buf = osqlcomm_query_effects_put(&(rpl_ok.fk_effects), p_buf,
                                                    p_buf_end);
                 msglen = OSQLCOMM_DONE_UUID_RPL_v2_LEN;
+
+                /* Trailing commit lsn; older replicants ignore it. */
+                if (lsn && lsn->file) {
+                    p_buf = buf_put(&lsn->file, sizeof(lsn->file), p_buf,
+                                    p_buf_end);
+                    p_buf = buf_put(&lsn->offset, sizeof(lsn->offset), p_buf,
+                                    p_buf_end);
+                    msglen = OSQLCOMM_DONE_UUID_RPL_v3_LEN;
+                }
             }
         }
         type = osql_net_type_to_net_uuid_type(NET_OSQL_SIGNAL);
@@ -5357,6 +5370,27 @@ static int offload_socket_send(SBUF2 *sb, int usertype, void *data, int datalen,
     return 0;
 }
 
+/* Feed each op of an OSQL_BATCH to net_osql_rpl, in the order it was
+   packed by the replicant */
+static void net_osql_rpl_batch(void *hndl, void *uptr, char *fromnode,
+                               int usertype, const uint8_t *p_buf,
+                               const uint8_t *p_buf_end, uint8_t is_tcp)
+{
+    int oplen;
+
+    while (p_buf < p_buf_end) {
+        if (!(p_buf = buf_get(&oplen, sizeof(oplen), p_buf, p_buf_end)) ||
+            oplen <= 0 || oplen > (p_buf_end - p_buf)) {
+            logmsg(LOGMSG_ERROR, "%s: malformed batch from %s\n", __func__,
+                   fromnode);
+            return;
+        }
+        net_osql_rpl(hndl, uptr, fromnode, usertype, (void *)p_buf, oplen,
+                     is_tcp);
+        p_buf += oplen;
+    }
+}
+
 static void net_osql_rpl(void *hndl, void *uptr, char *fromnode, int usertype,
                          void *dtap, int dtalen, uint8_t is_tcp)
 {
@@ -5410,6 +5444,12 @@ static void net_osql_rpl(void *hndl, void *uptr, char *fromnode, int usertype,
     printf("NET RPL rqid=%llu tmp=%llu\n", ((osql_rpl_t*)dtap)->sid, osql_log_time());
 #endif
 
+    if (!rc && type == OSQL_BATCH) {
+        net_osql_rpl_batch(hndl, uptr, fromnode, usertype, p_buf, p_buf_end,
+                           is_tcp);
+        return;
+    }
+
     if (!rc) {
         rc = osql_sess_rcvop(rqid, uuid, type, dtap, dtalen, &found);
     }
@@ -7041,7 +7081,8 @@ void signal_replicant_error(osql_target_t *target, unsigned long long rqid,
 {
     struct errstat generr = {0};
     errstat_set_rcstrf(&generr, rc, msg);
-    int rc2 = osql_comm_signal_sqlthr_rc(target, rqid, uuid, 0, &generr, 0, rc);
+    int rc2 = osql_comm_signal_sqlthr_rc(target, rqid, uuid, 0, &generr, 0, rc,
+                                         NULL);
     if (rc2) {
         uuidstr_t us;
         comdb2uuidstr(uuid, us);
@@ -7179,6 +7220,7 @@ static void net_sorese_signal(void *hndl, void *uptr, char *fromhost,
     struct errstat *xerr;
     struct query_effects effects;
     struct query_effects *p_effects = NULL;
+    commit_lsn_t lsn = {0};
     uint8_t *p_buf = (uint8_t *)dtap;
     uint8_t *p_buf_end = p_buf + dtalen;
     uuid_t uuid;
@@ -7208,6 +7250,13 @@ static void net_sorese_signal(void *hndl, void *uptr, char *fromhost,
         if (type == OSQL_DONE_WITH_EFFECTS) {
             p_effects = &effects;
         }
+        if (type == OSQL_DONE_WITH_EFFECTS && rqid == OSQL_RQID_USE_UUID &&
+            dtalen >= OSQLCOMM_DONE_UUID_RPL_v3_LEN) {
+            const uint8_t *p_lsn =
+                (uint8_t *)dtap + OSQLCOMM_DONE_UUID_RPL_v2_LEN;
+            p_lsn = buf_get(&lsn.file, sizeof(lsn.file), p_lsn, p_buf_end);
+            buf_get(&lsn.offset, sizeof(lsn.offset), p_lsn, p_buf_end);
+        }
 
 #if 0
       printf("Done rqid=%llu tmp=%llu\n", hdr->sid, osql_log_time());
@@ -7218,9 +7267,11 @@ static void net_sorese_signal(void *hndl, void *uptr, char *fromhost,
             uint8_t *p_buf_end = (p_buf + sizeof(struct errstat));
             osqlcomm_errstat_type_get(&errstat, p_buf, p_buf_end);
 
-            osql_chkboard_sqlsession_rc(rqid, uuid, 0, NULL, &errstat, NULL);
+            osql_chkboard_sqlsession_rc(rqid, uuid, 0, NULL, &errstat, NULL,
+                                        NULL);
         } else {
-            osql_chkboard_sqlsession_rc(rqid, uuid, done.nops, NULL, NULL, p_effects);
+            osql_chkboard_sqlsession_rc(rqid, uuid, done.nops, NULL, NULL,
+                                        p_effects, lsn.file ? &lsn : NULL);
         }
 
     } else {
@@ -7765,8 +7816,11 @@ static void osql_extract_snap_info(osql_sess_t *sess, void *rpl, int rpllen,
 
 #define UNK_ERR_SEND_RETRY 10
 
-int offload_net_send(const char *host, int usertype, void *data, int datalen,
-                     int nodelay, void *tail, int tailen)
+/* With owned set, data is a malloc'ed payload without a tail that net takes
+   over on success instead of copying it. */
+static int offload_net_send_int(const char *host, int usertype, void *data,
+                                int datalen, int nodelay, void *tail,
+                                int tailen, int owned)
 {
     osql_comm_t *comm = get_thecomm();
     if (!comm)
@@ -7791,15 +7845,26 @@ int offload_net_send(const char *host, int usertype, void *data, int datalen,
         rc = net_local_route_packet_tail(usertype, data, datalen, tail, tailen);
         if (rc) {
             logmsg(LOGMSG_ERROR, "%s failed to route locally!\n", __func__);
+        } else if (owned) {
+            free(data);
         }
         return rc;
     }
 
     while (rc) {
 
-        /* remote send */
-        rc = net_send_tail(netinfo_ptr, host, usertype, data, datalen, nodelay,
-                           tail, tailen);
+        /* remote send: an owned payload is handed to net as is; otherwise
+           the header and the row/blob payload go out as separate segments,
+           copied once from the caller's buffers */
+        if (owned) {
+            rc = net_send_owned(netinfo_ptr, host, usertype, data, datalen,
+                                nodelay ? NET_SEND_NODELAY : 0);
+        } else {
+            struct iovec iov[2] = {{.iov_base = data, .iov_len = datalen},
+                                   {.iov_base = tail, .iov_len = tailen}};
+            rc = net_send_iov(netinfo_ptr, host, usertype, iov, tail ? 2 : 1,
+                              nodelay ? NET_SEND_NODELAY : 0);
+        }
         if (NET_SEND_FAIL_QUEUE_FULL == rc) {
 
             if (total_wait > gbl_osql_bkoff_netsend_lmt) {
@@ -7843,6 +7908,102 @@ int offload_net_send(const char *host, int usertype, void *data, int datalen,
     return rc;
 }
 
+int offload_net_send(const char *host, int usertype, void *data, int datalen,
+                     int nodelay, void *tail, int tailen)
+{
+    return offload_net_send_int(host, usertype, data, datalen, nodelay, tail,
+                                tailen, 0);
+}
+
+int gbl_osql_batch_bytes = 0;
+
+/* A batch is a single NET_OSQL_SOCK_RPL_UUID message carrying the ops of one
+ * session, each prefixed by its length:
+ *
+ *   | osql_uuid_rpl_t (OSQL_BATCH) | len1 | op1 | len2 | op2 | ...
+ *
+ * The master unpacks it in net_osql_rpl and handles the ops in order. */
+int osql_batch_flush(osql_target_t *target)
+{
+    int rc;
+
+    if (target->batch_len == 0)
+        return 0;
+
+    /* The batch is handed to net rather than copied into the write queue;
+       the next op starts a fresh one. */
+    rc = offload_net_send_int(target->host, NET_OSQL_SOCK_RPL_UUID,
+                              target->batch, target->batch_len, 0, NULL, 0, 1);
+    if (rc == 0) {
+        target->batch = NULL;
+        target->batch_cap = 0;
+    }
+    target->batch_len = 0;
+    return rc;
+}
+
+void osql_batch_free(osql_target_t *target)
+{
+    free(target->batch);
+    target->batch = NULL;
+    target->batch_len = target->batch_cap = 0;
+}
+
+int osql_batch_send(osql_target_t *target, int usertype, void *data,
+                    int datalen, int nodelay, void *tail, int tailen)
+{
+    int budget = gbl_osql_batch_bytes;
+    int oplen = datalen + ((tail && tailen > 0) ? tailen : 0);
+    uint8_t *p_buf, *p_buf_end;
+    int type = OSQL_BATCH;
+    int rc;
+
+    /* Only plain ops are coalesced; anything flushed (commit, abort) or
+       too big for a batch goes out on its own, after the pending ops. */
+    if (usertype != NET_OSQL_SOCK_RPL_UUID || nodelay ||
+        target->host == gbl_myhostname ||
+        datalen < OSQLCOMM_UUID_RPL_TYPE_LEN ||
+        OSQLCOMM_UUID_RPL_TYPE_LEN + (int)sizeof(int) + oplen > budget)
+        goto direct;
+
+    if (target->batch_len + (int)sizeof(int) + oplen > budget &&
+        (rc = osql_batch_flush(target)) != 0)
+        return rc;
+
+    if (target->batch_cap < budget) {
+        uint8_t *batch = realloc(target->batch, budget);
+        if (batch == NULL)
+            goto direct;
+        target->batch = batch;
+        target->batch_cap = budget;
+    }
+
+    p_buf = target->batch + target->batch_len;
+    p_buf_end = target->batch + target->batch_cap;
+
+    /* the batch header is the one of its first op, retyped */
+    if (target->batch_len == 0) {
+        memcpy(p_buf, data, OSQLCOMM_UUID_RPL_TYPE_LEN);
+        buf_put(&type, sizeof(type), p_buf, p_buf_end);
+        p_buf += OSQLCOMM_UUID_RPL_TYPE_LEN;
+    }
+
+    p_buf = buf_put(&oplen, sizeof(oplen), p_buf, p_buf_end);
+    p_buf = buf_no_net_put(data, datalen, p_buf, p_buf_end);
+    if (tail && tailen > 0)
+        p_buf = buf_no_net_put(tail, tailen, p_buf, p_buf_end);
+
+    target->batch_len = p_buf - target->batch;
+    return 0;
+
+direct:
+    if ((rc = osql_batch_flush(target)) != 0)
+        return rc;
+
+    return offload_net_send(target->host, usertype, data, datalen, nodelay,
+                            tail, tailen);
+}
+
 /**
  * Read a commit (DONE/XERR) from a socket, used in bplog over socket
  * Timeoutms limits total amount of waiting for a commit
@@ -205,7 +205,8 @@ int osql_send_updstat(osql_target_t *target, unsigned long long rqid,
  */
 int osql_comm_signal_sqlthr_rc(osql_target_t *target, unsigned long long rqid,
                                uuid_t uuid, int nops, struct errstat *xerr,
-                               snap_uid_t *snap, int rc);
+                               snap_uid_t *snap, int rc,
+                               const commit_lsn_t *lsn);
 /**
  * if anything goes wrong during master bplog processing,
  * let replicant know (wrapper around signal_sqlthr_rc)
@@ -375,6 +376,9 @@ enum osqlpfrq_type {
 int osql_page_prefault(char *rpl, int rplen, struct dbtable **last_db,
                        int **iq_step_ix, unsigned long long rqid, uuid_t uuid,
                        unsigned long long seq);
+int osql_page_prefault_step(char *rpl, int rplen, struct dbtable **last_db,
+                            int **iq_step_ix, unsigned long long rqid,
+                            uuid_t uuid, unsigned long long seq);
 
 int osql_set_usedb(struct ireq *iq, const char *tablename, int tableversion,
                    int step, struct block_err *err);
@@ -410,6 +414,19 @@ int offload_comm_send_blockreply(char *host, unsigned long long rqid, void *buf,
 int offload_net_send(const char *host, int usertype, void *data, int datalen,
                      int nodelay, void *tail, int tailen);
 
+extern int gbl_osql_batch_bytes;
+
+/* Send an op to the master, coalescing it with the following ones into a
+   single OSQL_BATCH message of up to gbl_osql_batch_bytes */
+int osql_batch_send(osql_target_t *target, int usertype, void *data,
+                    int datalen, int nodelay, void *tail, int tailen);
+
+/* Send any ops still pending in the batch */
+int osql_batch_flush(osql_target_t *target);
+
+/* Release the batch buffer */
+void osql_batch_free(osql_target_t *target);
+
 /**
  * Copy and pack the host-ordered client_query_stats type into big-endian
  * format.  This routine only packs up to the path_stats component:  use
@@ -562,30 +562,35 @@ static void osqlpfault_do_work_pp(struct thdpool *pool, void *work,
     free(req);
 }
 
-int osql_page_prefault(char *rpl, int rplen, struct dbtable **last_db,
-                       int **iq_step_ix, unsigned long long rqid, uuid_t uuid,
-                       unsigned long long seq)
+static int *osqlpf_step_alloc(unsigned long long rqid, uuid_t uuid)
 {
-    static int last_step_idex = 0;
     int *ii;
+
+    Pthread_mutex_lock(&osqlpf_mutex);
+    ii = queue_next(gbl_osqlpf_stepq);
+    Pthread_mutex_unlock(&osqlpf_mutex);
+    if (ii == NULL) {
+        logmsg(LOGMSG_ERROR, "osql io prefault got a BUG!\n");
+        exit(1);
+    }
+    gbl_osqlpf_step[*ii].rqid = rqid;
+    comdb2uuidcpy(gbl_osqlpf_step[*ii].uuid, uuid);
+    return ii;
+}
+
+static int osql_page_prefault_int(char *rpl, int rplen,
+                                  struct dbtable **last_db, int step_idex,
+                                  unsigned long long rqid, uuid_t uuid,
+                                  unsigned long long seq)
+{
     osql_rpl_t rpl_op;
     uint8_t *p_buf = (uint8_t *)rpl;
     uint8_t *p_buf_end = p_buf + rplen;
     osqlcomm_rpl_type_get(&rpl_op, p_buf, p_buf_end);
 
-    if (seq == 0) {
-        Pthread_mutex_lock(&osqlpf_mutex);
-        ii = queue_next(gbl_osqlpf_stepq);
-        Pthread_mutex_unlock(&osqlpf_mutex);
-        if (ii == NULL) {
-            logmsg(LOGMSG_ERROR, "osql io prefault got a BUG!\n");
-            exit(1);
-        }
-        last_step_idex = *ii;
-        *iq_step_ix = ii;
-        gbl_osqlpf_step[last_step_idex].rqid = rqid;
-        comdb2uuidcpy(gbl_osqlpf_step[last_step_idex].uuid, uuid);
-    }
+    /* nothing to fault in until we know which table the op is for */
+    if (rpl_op.type != OSQL_USEDB && *last_db == NULL)
+        return 0;
 
     switch (rpl_op.type) {
     case OSQL_USEDB: {
@@ -611,8 +616,8 @@ int osql_page_prefault(char *rpl, int rplen, struct dbtable **last_db,
         p_buf = (uint8_t *)&((osql_del_rpl_t *)rpl)->dt;
         p_buf = (uint8_t *)osqlcomm_del_type_get(&dt, p_buf, p_buf_end,
                                                  rpl_op.type == OSQL_DELETE);
-        enque_osqlpfault_olddata_oldkeys(*last_db, dt.genid, last_step_idex,
-                                         rqid, uuid, seq);
+        enque_osqlpfault_olddata_oldkeys(*last_db, dt.genid, step_idex, rqid,
+                                         uuid, seq);
     } break;
     case OSQL_INSREC:
     case OSQL_INSERT: {
@@ -621,8 +626,8 @@ int osql_page_prefault(char *rpl, int rplen, struct dbtable **last_db,
         uint8_t *p_buf = (uint8_t *)&((osql_ins_rpl_t *)rpl)->dt;
         pData = (uint8_t *)osqlcomm_ins_type_get(&dt, p_buf, p_buf_end,
                                                  rpl_op.type == OSQL_INSREC);
-        enque_osqlpfault_newdata_newkeys(*last_db, pData, dt.nData,
-                                         last_step_idex, rqid, uuid, seq);
+        enque_osqlpfault_newdata_newkeys(*last_db, pData, dt.nData, step_idex,
+                                         rqid, uuid, seq);
     } break;
     case OSQL_UPDREC:
     case OSQL_UPDATE: {
@@ -632,7 +637,7 @@ int osql_page_prefault(char *rpl, int rplen, struct dbtable **last_db,
         pData = (uint8_t *)osqlcomm_upd_type_get(&dt, p_buf, p_buf_end,
                                                  rpl_op.type == OSQL_UPDATE);
         enque_osqlpfault_olddata_oldkeys_newkeys(*last_db, dt.genid, pData,
-                                                 dt.nData, last_step_idex, rqid,
+                                                 dt.nData, step_idex, rqid,
                                                  uuid, seq);
     } break;
     default:
@@ -640,3 +645,33 @@ int osql_page_prefault(char *rpl, int rplen, struct dbtable **last_db,
     }
     return 0;
 }
+
+int osql_page_prefault(char *rpl, int rplen, struct dbtable **last_db,
+                       int **iq_step_ix, unsigned long long rqid, uuid_t uuid,
+                       unsigned long long seq)
+{
+    static int last_step_idex = 0;
+
+    if (seq == 0) {
+        *iq_step_ix = osqlpf_step_alloc(rqid, uuid);
+        last_step_idex = **iq_step_ix;
+    }
+
+    return osql_page_prefault_int(rpl, rplen, last_db, last_step_idex, rqid,
+                                  uuid, seq);
+}
+
+/* Same as above, but the step slot is owned by the request: it is allocated
+ * on first use and released by the block processor once the transaction is
+ * done.  'seq' is the position of the op in apply order, so that faults for
+ * ops that the block processor has already applied are dropped. */
+int osql_page_prefault_step(char *rpl, int rplen, struct dbtable **last_db,
+                            int **iq_step_ix, unsigned long long rqid,
+                            uuid_t uuid, unsigned long long seq)
+{
+    if (*iq_step_ix == NULL)
+        *iq_step_ix = osqlpf_step_alloc(rqid, uuid);
+
+    return osql_page_prefault_int(rpl, rplen, last_db, **iq_step_ix, rqid,
+                                  uuid, seq);
+}
@@ -32,6 +32,9 @@
 #include "tohex.h"
 #include "comdb2_atomic.h"
 
+extern uint64_t gbl_osql_bplog_conflict_waits;
+extern uint64_t gbl_osql_bplog_conflict_timeouts;
+
 typedef struct osql_repository {
     hash_t *rqs; /* hash of outstanding requests */
     hash_t *rqsuuid;
@@ -57,8 +60,11 @@ int osql_repository_init(void)
         goto error;
 
     Pthread_mutex_init(&tmp->hshlck, NULL);
-    tmp->rqs = hash_init(sizeof(unsigned long long)); /* indexed after rqid */
-    tmp->rqsuuid = hash_init_o(offsetof(osql_sess_t, uuid), sizeof(uuid_t));
+    /* indexed after rqid */
+    tmp->rqs = hash_init_flat_o(offsetof(osql_sess_t, rqid),
+                                sizeof(unsigned long long));
+    tmp->rqsuuid =
+        hash_init_flat_o(offsetof(osql_sess_t, uuid), sizeof(uuid_t));
 
     if (!tmp->rqs || !tmp->rqsuuid)
         goto error;
@@ -254,6 +260,9 @@ int osql_repository_printcrtsessions(void)
 
     maxops = get_osql_maxtransfer();
     logmsg(LOGMSG_USER, "Maximum transaction size: %d bplog entries\n", maxops);
+    logmsg(LOGMSG_USER,
+           "Bplog conflict waits: %" PRIu64 " (%" PRIu64 " timed out)\n",
+           gbl_osql_bplog_conflict_waits, gbl_osql_bplog_conflict_timeouts);
 
     Pthread_mutex_lock(&theosql->hshlck);
 
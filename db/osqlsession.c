@@ -35,6 +35,7 @@
 #include "str0.h"
 #include "reqlog.h"
 #include "osqlsqlnet.h"
+#include "tracering.h"
 
 struct sess_impl {
     int clients; /* number of threads using the session */
@@ -43,12 +44,13 @@ struct sess_impl {
     unsigned terminate : 1;  /* Set when this session is about to be terminated */
     unsigned socket : 1;     /* Set if request comes over socket instead of net */
     unsigned embedded_sql : 1; /* Set if sql is part of session malloc object */
+    unsigned streaming : 1;  /* Set while a dispatched session still gets ops */
 
     pthread_mutex_t mtx; /* dispatched/terminate/clients protection */
 };
 
 static void _destroy_session(osql_sess_t **psess);
-static int handle_buf_sorese(osql_sess_t *psess);
+static int handle_buf_sorese(osql_sess_t *psess, int streaming);
 static osql_sess_t *_osql_sess_create(osql_sess_t *sess, char *tzname, int type,
                                       unsigned long long rqid, uuid_t uuid,
                                       const char *host, int is_reorder_on);
@@ -192,7 +194,7 @@ int osql_sess_addclient(osql_sess_t *psess)
     int rc = 0;
 
     Pthread_mutex_lock(&sess->mtx);
-    if (sess->dispatched) {
+    if (sess->dispatched && !sess->streaming) {
         rc = -1;
     } else
         sess->clients += 1;
@@ -270,6 +272,27 @@ void osql_sess_reqlogquery(osql_sess_t *sess, struct reqlogger *reqlog)
         free(info);
 }
 
+/**
+ * A streaming session got its last op, or was cancelled (rc non-zero);
+ * let the block processor applying it know.
+ * Returns 1 if the session was streaming
+ *
+ */
+static int _stream_stop(osql_sess_t *psess, int rc)
+{
+    sess_impl_t *sess = psess->impl;
+    int streaming;
+
+    Pthread_mutex_lock(&sess->mtx);
+    streaming = sess->streaming;
+    sess->streaming = 0;
+    Pthread_mutex_unlock(&sess->mtx);
+
+    if (streaming)
+        osql_bplog_stream_end(psess->tran, rc);
+    return streaming;
+}
+
 /**
  * Handles a new op received for session "rqid"
  * It saves the packet in the local bplog
@@ -296,6 +319,8 @@ int osql_sess_rcvop(unsigned long long rqid, uuid_t uuid, int type, void *data,
     is_msg_done =
         osql_comm_is_done(sess, type, data, datalen, rqid == OSQL_RQID_USE_UUID,
                           &perr, NULL) != 0;
+    TRACE_RING(TRACE_OSQL, "rcvop rqid %llx type %lld len %lld done %lld",
+               rqid, type, datalen, is_msg_done);
 
     /* we have received an OSQL_XERR; replicant wants to abort the transaction;
        discard the session and be done */
@@ -322,6 +347,10 @@ int osql_sess_rcvop(unsigned long long rqid, uuid_t uuid, int type, void *data,
 
     /* release the session */
     if (!is_msg_done) {
+        /* large sessions start applying before they are done */
+        if (osql_bplog_stream_start(sess, sess->tran))
+            return handle_buf_sorese(sess, 1);
+
         rc = osql_repository_put(sess);
         if (rc == 1) {
             /* session was marked terminated and not finished*/
@@ -330,13 +359,26 @@ int osql_sess_rcvop(unsigned long long rqid, uuid_t uuid, int type, void *data,
         return 0;
     }
 
+    /* a streaming session is already with the block processor */
+    if (_stream_stop(sess, 0)) {
+        osql_repository_put(sess);
+        return 0;
+    }
+
     /* IT WAS A DONE MESSAGE
        HERE IS THE DISPATCH */
-    return handle_buf_sorese(sess);
+    return handle_buf_sorese(sess, 0);
 
 failed_stream:
     if (is_msg_done && perr)
-        osql_comm_signal_sqlthr_rc(&sess->target, rqid, uuid, 0, &sess->xerr, NULL, 0);
+        osql_comm_signal_sqlthr_rc(&sess->target, rqid, uuid, 0, &sess->xerr,
+                                   NULL, 0, NULL);
+
+    /* the block processor owns a streaming session; it will close it */
+    if (_stream_stop(sess, ERR_NOMASTER)) {
+        osql_repository_put(sess);
+        return rc;
+    }
 
     /* release the session */
     osql_repository_put(sess);
@@ -367,7 +409,8 @@ int osql_sess_rcvop_socket(osql_sess_t *sess, int type, void *data, int datalen,
     if (*is_msg_done && perr) {
         if (debug_switch_test_sync_osql_cancel())
             poll(NULL, 0, 1000);
-        osql_comm_signal_sqlthr_rc(&sess->target, sess->rqid, sess->uuid, 0, &sess->xerr, NULL, 0);
+        osql_comm_signal_sqlthr_rc(&sess->target, sess->rqid, sess->uuid, 0,
+                                   &sess->xerr, NULL, 0, NULL);
         sess->is_cancelled = 1;
         return 0;
     }
@@ -388,7 +431,7 @@ int osql_sess_rcvop_socket(osql_sess_t *sess, int type, void *data, int datalen,
         logmsg(LOGMSG_ERROR, "%p Dispatching transaction\n", (void *)pthread_self());
     /* IT WAS A DONE MESSAGE
        HERE IS THE DISPATCH */
-    return handle_buf_sorese(sess);
+    return handle_buf_sorese(sess, 0);
 }
 
 int osql_sess_queryid(osql_sess_t *sess)
@@ -416,6 +459,11 @@ int osql_sess_try_terminate(osql_sess_t *psess, const char *host)
     Pthread_mutex_lock(&sess->mtx);
 
     if (sess->dispatched) {
+        /* cancel a streaming session; its block processor will close it */
+        if (sess->streaming) {
+            sess->streaming = 0;
+            osql_bplog_stream_end(psess->tran, ERR_NOMASTER);
+        }
         keep_sess = 1;
         goto done;
     }
@@ -451,8 +499,11 @@ done:
  *   If the sesssion dispatch fails (queue full?), we need to send back retry
  *   error code to the source replicant
  *
+ *   A streaming session is dispatched before its last op; it keeps taking
+ *   ops until the reader sees the last one
+ *
  */
-static int handle_buf_sorese(osql_sess_t *psess)
+static int handle_buf_sorese(osql_sess_t *psess, int streaming)
 {
     sess_impl_t *sess = psess->impl;
     int debug;
@@ -469,6 +520,7 @@ static int handle_buf_sorese(osql_sess_t *psess)
     /* NOTE: the session here has one client at least, so it will not be
     close; it might be terminanted but we allow to dispatch */
     sess->dispatched = 1;
+    sess->streaming = streaming;
     psess->sess_endus = comdb2_time_epochus();
     bzero(&psess->xerr, sizeof(psess->xerr));
     Pthread_mutex_unlock(&sess->mtx);
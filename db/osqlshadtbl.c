@@ -33,6 +33,7 @@
 #include "logmsg.h"
 #include "str0.h"
 #include "schemachange.h"
+#include "counters.h"
 
 #include <dbinc/queue.h>
 
@@ -1262,8 +1263,24 @@ int osql_save_dbq_consume(struct sqlclntstate *clnt, const char *spname,
                           genid_t genid)
 {
     shadbq_t *shad = &clnt->osql.shadbq;
+    genid_t *genids;
+    int i;
+
+    if (shad->spname != spname)
+        shad->ngenids = 0;
     shad->spname = spname;
-    shad->genid = genid;
+    for (i = 0; i < shad->ngenids; i++)
+        if (shad->genids[i] == genid)
+            return 0;
+    if (shad->ngenids == shad->alloc) {
+        genids = realloc(shad->genids,
+                         (shad->alloc * 2 + 8) * sizeof(genid_t));
+        if (genids == NULL)
+            return -1;
+        shad->genids = genids;
+        shad->alloc = shad->alloc * 2 + 8;
+    }
+    shad->genids[shad->ngenids++] = genid;
     return 0;
 }
 
@@ -1322,8 +1339,10 @@ int osql_save_updcols(struct BtCursor *pCur, struct sql_thread *thd,
             assert(updCols[0] == oldUpdCols[0]);
 
             for (i = 0; i < updCols[0]; i++) {
-                if (oldUpdCols[i + 1] ==
-                    -1) /* use the new setting if this was not updated */
+                /* use the new setting if this was not updated; a column
+                   stays a counter delta only if every update was one */
+                if (oldUpdCols[i + 1] == -1 ||
+                    (oldUpdCols[i + 1] == UPDCOL_DELTA && updCols[i + 1] != -1))
                     oldUpdCols[i + 1] = updCols[i + 1];
             }
 
@@ -2147,20 +2166,23 @@ static int process_local_shadtbl_upd(struct sqlclntstate *clnt, shad_tbl_t *tbl,
 }
 
 /*
-** We can consume only one item at a time (the item at the head of the DBQ).
-** Setting up a shadow tmptbl to store dbq name and one genid, seems a bit
-** overkill. I will just save this info in sqlclntstate.
+** A transaction consumes a handful of items of one DBQ (one, or a batch
+** from dbconsumer:consume_batch()).  Setting up a shadow tmptbl to store
+** them seems a bit overkill.  I will just save this info in sqlclntstate.
 */
 static int process_local_shadtbl_dbq(struct sqlclntstate *clnt, int *bdberr,
                                      int *crt_nops)
 {
-
-    if (clnt->osql_max_trans && (*crt_nops) > clnt->osql_max_trans) {
-        return SQLITE_TOOBIG;
-    }
     shadbq_t *shadbq = &clnt->osql.shadbq;
-    if (shadbq->spname && shadbq->genid) {
-        osql_dbq_consume(clnt, shadbq->spname, shadbq->genid);
+    int i;
+
+    if (shadbq->spname == NULL)
+        return SQLITE_OK;
+    for (i = 0; i < shadbq->ngenids; i++) {
+        if (clnt->osql_max_trans && (*crt_nops) > clnt->osql_max_trans) {
+            return SQLITE_TOOBIG;
+        }
+        osql_dbq_consume(clnt, shadbq->spname, shadbq->genids[i]);
         ++(*crt_nops);
     }
     return SQLITE_OK;
@@ -2359,8 +2381,8 @@ static int delete_record_indexes(BtCursor *pCur, char *pdta, int dtasize,
 
 static inline void osql_destroy_dbq(osqlstate_t *osql)
 {
-    osql->shadbq.spname = NULL;
-    osql->shadbq.genid = 0;
+    free(osql->shadbq.genids);
+    memset(&osql->shadbq, 0, sizeof(osql->shadbq));
 }
 
 static void osql_destroy_dbq_hash(osqlstate_t *);
@@ -39,6 +39,9 @@ void init_bplog_net(osql_target_t *target)
     target->type = OSQL_OVER_NET;
     target->sb = NULL;
     target->send = _send;
+    target->batch_enabled = 0;
+    target->batch_len = target->batch_cap = 0;
+    target->batch = NULL;
 }
 
 /**
@@ -56,6 +59,10 @@ int osql_begin_net(struct sqlclntstate *clnt, int type, int keep_rqid)
     osql->target.send = _send;
     assert(osql->target.sb == NULL);
 
+    /* anything left over from a previous attempt is resent by the caller */
+    osql->target.batch_enabled = (gbl_osql_batch_bytes > 0);
+    osql->target.batch_len = 0;
+
     /* protect against no master */
     if (osql->target.host == NULL || osql->target.host == db_eid_invalid)
         return 0; /* loop in caller */
@@ -84,12 +91,17 @@ int osql_begin_net(struct sqlclntstate *clnt, int type, int keep_rqid)
  */
 int osql_end_net(struct sqlclntstate *clnt)
 {
+    osql_batch_free(&clnt->osql.target);
     return osql_unregister_sqlthr(clnt);
 }
 
 static int _send(osql_target_t *target, int usertype, void *data, int datalen,
                  int nodelay, void *tail, int tailen)
 {
+    if (target->batch_enabled)
+        return osql_batch_send(target, usertype, data, datalen, nodelay, tail,
+                               tailen);
+
     return offload_net_send(target->host, usertype, data, datalen, nodelay,
                             tail, tailen);
 }
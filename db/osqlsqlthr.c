@@ -980,10 +980,12 @@ extern int gbl_is_physical_replicant;
 int osql_sock_commit(struct sqlclntstate *clnt, int type)
 {
     osqlstate_t *osql = &clnt->osql;
+    struct reqlogger *logger = clnt->thd ? clnt->thd->logger : NULL;
     int rc = 0, rc2;
     int rcout = 0;
     int retries = 0;
     int bdberr = 0;
+    uint64_t commit_start_us = 0;
 
     if (gbl_is_physical_replicant) {
         logmsg(LOGMSG_ERROR, "%s attempted write against physical replicant\n", __func__);
@@ -1011,12 +1013,14 @@ int osql_sock_commit(struct sqlclntstate *clnt, int type)
     }
 
     osql->timings.commit_start = osql_log_time();
+    reqlog_stage_begin(logger, REQL_STAGE_COMMIT);
 
     if (clnt->dbtran.mode == TRANLEVEL_SOSQL && !osql->sock_started) {
         goto done;
     }
 
     assert(osql->sock_started);
+    commit_start_us = comdb2_time_epochus();
 
     /* send results of sql processing to block master */
     /* if (thd->clnt->query_stats)*/
@@ -1035,7 +1039,9 @@ retry:
         }
     }
 
+    reqlog_stage_begin(logger, REQL_STAGE_BPLOG);
     rc = osql_send_commit_logic(clnt, retries, req2netrpl(type));
+    reqlog_stage_end(logger, REQL_STAGE_BPLOG);
     if (rc) {
         logmsg(LOGMSG_ERROR, "%s:%d: failed to send commit to master rc was %d\n", __FILE__,
                 __LINE__, rc);
@@ -1052,7 +1058,9 @@ retry:
             /*cheap_stack_trace();*/
             abort();
         }
+        reqlog_stage_begin(logger, REQL_STAGE_MASTER);
         rc = osql_wait(clnt);
+        reqlog_stage_end(logger, REQL_STAGE_MASTER);
         if (rc) {
             rcout = SQLITE_CLIENT_CHANGENODE;
             logmsg(LOGMSG_ERROR, "%s line %d setting rcout to (%d) from %d\n", 
@@ -1176,6 +1184,10 @@ err:
 
 done:
     osql->timings.commit_end = osql_log_time();
+    reqlog_stage_end(logger, REQL_STAGE_COMMIT);
+    if (commit_start_us)
+        time_metric_add(thedb->commit_time,
+                        comdb2_time_epochus() - commit_start_us);
 
     /* mark socksql as non-retriable if seletv are present
        also don't retry distributed transactions
@@ -39,11 +39,38 @@ static size_t *cnct_len = NULL;
 static size_t *cnct_idx = NULL;
 static time_t retry_time = 3;
 
+/* one log record, as returned by comdb2_transaction_logs */
+struct phys_rec {
+    char *lsn;
+    int64_t gen;
+    int has_gen;
+    int64_t timestamp;
+    int has_timestamp;
+    void *blob;
+    int blob_len;
+};
+
+/* Records fetched ahead of the apply, so the network and the apply
+   overlap; see physrep_fetch_ahead */
+struct phys_fetch {
+    pthread_mutex_t lk;
+    pthread_cond_t cond;
+    struct phys_rec *recs;
+    int size;
+    int head;
+    int count;
+    int done; /* fetcher stopped, with rc */
+    int rc;
+    int stop; /* asked to stop */
+};
+
+int gbl_physrep_fetch_ahead = 1024;
+
 /* forward declarations */
 static DB_Connection *get_connect(char *hostname);
 static int insert_connect(char *hostname, char *dbname, size_t tier);
 static void delete_connect(DB_Connection *cnct);
-static LOG_INFO handle_record(LOG_INFO prev_info);
+static LOG_INFO handle_record(LOG_INFO prev_info, struct phys_rec *rec);
 static int find_new_repl_db(void);
 static DB_Connection *get_rand_connect(size_t tier);
 static void *keep_in_sync(void *args);
@@ -121,6 +148,149 @@ int gbl_physrep_register_interval = 3600;
 static int last_register;
 int gbl_blocking_physrep = 0;
 
+/* Fill rec from the current row of repl_db; with copy, rec owns its memory
+   and outlives the row */
+static int read_record(struct phys_rec *rec, int copy)
+{
+    char *lsn = (char *)cdb2_column_value(repl_db, 0);
+    int64_t *gen = (int64_t *)cdb2_column_value(repl_db, 2);
+    int64_t *timestamp = (int64_t *)cdb2_column_value(repl_db, 3);
+    void *blob = cdb2_column_value(repl_db, 4);
+
+    memset(rec, 0, sizeof(*rec));
+    if ((rec->has_gen = gen != NULL))
+        rec->gen = *gen;
+    if ((rec->has_timestamp = timestamp != NULL))
+        rec->timestamp = *timestamp;
+    rec->blob_len = cdb2_column_size(repl_db, 4);
+    if (!copy) {
+        rec->lsn = lsn;
+        rec->blob = blob;
+        return 0;
+    }
+    rec->lsn = strdup(lsn ? lsn : "");
+    rec->blob = malloc(rec->blob_len > 0 ? rec->blob_len : 1);
+    if (rec->lsn == NULL || rec->blob == NULL) {
+        free(rec->lsn);
+        free(rec->blob);
+        return -1;
+    }
+    if (blob && rec->blob_len > 0)
+        memcpy(rec->blob, blob, rec->blob_len);
+    return 0;
+}
+
+static int master_changed(struct phys_rec *rec, int64_t gen,
+                          volatile int64_t *highest_gen)
+{
+    if (!rec->has_gen || rec->gen <= *highest_gen)
+        return 0;
+    if (gbl_verbose_physrep) {
+        logmsg(LOGMSG_USER, "%s: My master changed, set truncate flag\n",
+               __func__);
+        logmsg(LOGMSG_USER, "%s: gen: %" PRId64 ", rec_gen: %" PRId64 "\n",
+               __func__, gen, rec->gen);
+    }
+    *highest_gen = rec->gen;
+    return 1;
+}
+
+static void *fetch_thd(void *arg)
+{
+    struct phys_fetch *f = arg;
+    struct phys_rec rec;
+    int rc;
+
+    comdb2_name_thread(__func__);
+    while ((rc = cdb2_next_record(repl_db)) == CDB2_OK) {
+        if (read_record(&rec, 1)) {
+            rc = -1;
+            break;
+        }
+        Pthread_mutex_lock(&f->lk);
+        while (f->count == f->size && !f->stop)
+            Pthread_cond_wait(&f->cond, &f->lk);
+        if (f->stop) {
+            Pthread_mutex_unlock(&f->lk);
+            free(rec.lsn);
+            free(rec.blob);
+            break;
+        }
+        f->recs[(f->head + f->count) % f->size] = rec;
+        f->count++;
+        Pthread_cond_signal(&f->cond);
+        Pthread_mutex_unlock(&f->lk);
+    }
+    Pthread_mutex_lock(&f->lk);
+    f->done = 1;
+    f->rc = rc;
+    Pthread_cond_signal(&f->cond);
+    Pthread_mutex_unlock(&f->lk);
+    return NULL;
+}
+
+/* Apply the rest of the current comdb2_transaction_logs query, with a
+   thread reading up to physrep_fetch_ahead records ahead of us.  Returns
+   what the last cdb2_next_record returned, as the inline loop does. */
+static int apply_fetched(LOG_INFO *prev_info, int64_t gen,
+                         volatile int64_t *highest_gen, int *do_truncate)
+{
+    struct phys_fetch f = {0};
+    struct phys_rec rec;
+    pthread_t tid;
+    int rc;
+
+    f.size = gbl_physrep_fetch_ahead;
+    if ((f.recs = calloc(f.size, sizeof(struct phys_rec))) == NULL)
+        return -1;
+    Pthread_mutex_init(&f.lk, NULL);
+    Pthread_cond_init(&f.cond, NULL);
+    Pthread_create(&tid, NULL, fetch_thd, &f);
+
+    while (1) {
+        Pthread_mutex_lock(&f.lk);
+        while (f.count == 0 && !f.done)
+            Pthread_cond_wait(&f.cond, &f.lk);
+        if (f.count == 0) {
+            Pthread_mutex_unlock(&f.lk);
+            break;
+        }
+        rec = f.recs[f.head];
+        f.head = (f.head + 1) % f.size;
+        f.count--;
+        Pthread_cond_signal(&f.cond);
+        Pthread_mutex_unlock(&f.lk);
+
+        if (do_repl && master_changed(&rec, gen, highest_gen))
+            *do_truncate = 1;
+        else if (do_repl)
+            *prev_info = handle_record(*prev_info, &rec);
+        free(rec.lsn);
+        free(rec.blob);
+        if (!do_repl || *do_truncate)
+            break;
+    }
+
+    /* the fetcher stops at its next record; it owns repl_db until then */
+    Pthread_mutex_lock(&f.lk);
+    f.stop = 1;
+    Pthread_cond_signal(&f.cond);
+    Pthread_mutex_unlock(&f.lk);
+    pthread_join(tid, NULL);
+
+    rc = f.rc;
+    while (f.count > 0) {
+        free(f.recs[f.head].lsn);
+        free(f.recs[f.head].blob);
+        f.head = (f.head + 1) % f.size;
+        f.count--;
+    }
+    free(f.recs);
+    Pthread_cond_destroy(&f.cond);
+    Pthread_mutex_destroy(&f.lk);
+    return rc;
+}
+
 static void *keep_in_sync(void *args)
 {
     comdb2_name_thread(__func__);
@@ -210,26 +380,23 @@ repl_loop:
         }
 
         /* our log matches, so apply each record log received */
-        while (do_repl && !do_truncate &&
-               (rc = cdb2_next_record(repl_db)) == CDB2_OK) {
-            /* check the generation id to make sure the master hasn't
-             * switched */
-            int64_t *rec_gen = (int64_t *)cdb2_column_value(repl_db, 2);
-            if (rec_gen && *rec_gen > highest_gen) {
-                int64_t new_gen = *rec_gen;
-                if (gbl_verbose_physrep) {
-                    logmsg(LOGMSG_USER,
-                           "%s: My master changed, set truncate flag\n",
-                           __func__);
-                    logmsg(LOGMSG_USER,
-                           "%s: gen: %" PRId64 ", rec_gen: %" PRId64 "\n",
-                           __func__, gen, *rec_gen);
-                }
-                do_truncate = 1;
-                highest_gen = new_gen;
+        if (gbl_physrep_fetch_ahead > 1) {
+            rc = apply_fetched(&prev_info, gen, &highest_gen, &do_truncate);
+            if (do_truncate)
                 goto repl_loop;
+        } else {
+            while (do_repl && !do_truncate &&
+                   (rc = cdb2_next_record(repl_db)) == CDB2_OK) {
+                struct phys_rec rec;
+                read_record(&rec, 0);
+                /* check the generation id to make sure the master hasn't
+                 * switched */
+                if (master_changed(&rec, gen, &highest_gen)) {
+                    do_truncate = 1;
+                    goto repl_loop;
+                }
+                prev_info = handle_record(prev_info, &rec);
             }
-            prev_info = handle_record(prev_info);
         }
 
         if (rc != CDB2_OK_DONE || do_truncate) {
@@ -281,21 +448,16 @@ int apply_log_procedure(unsigned int file, unsigned int offset, void *blob,
 }
 
 /* privates */
-static LOG_INFO handle_record(LOG_INFO prev_info)
+static LOG_INFO handle_record(LOG_INFO prev_info, struct phys_rec *rec)
 {
     /* vars for 1 record */
-    void *blob;
-    int blob_len;
-    char *lsn;
-    int64_t *timestamp;
+    void *blob = rec->blob;
+    int blob_len = rec->blob_len;
+    char *lsn = rec->lsn;
+    int64_t *timestamp = rec->has_timestamp ? &rec->timestamp : NULL;
     int rc;
     unsigned int file, offset;
 
-    lsn = (char *)cdb2_column_value(repl_db, 0);
-    timestamp = (int64_t *)cdb2_column_value(repl_db, 3);
-    blob = cdb2_column_value(repl_db, 4);
-    blob_len = cdb2_column_size(repl_db, 4);
-
     if ((rc = char_to_lsn(lsn, &file, &offset)) != 0) {
         logmsg(LOGMSG_ERROR, "Could not parse lsn:%s\n", lsn);
     }
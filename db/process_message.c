@@ -62,6 +62,9 @@ extern int __berkdb_read_alarm_ms;
 #include "comdb2_ruleset.h"
 #include "osqluprec.h"
 #include "schemachange.h"
+#include "profiler.h"
+#include "tracering.h"
+#include "zonemap.h"
 
 extern struct ruleset *gbl_ruleset;
 extern int gbl_exit_alarm_sec;
@@ -113,6 +116,7 @@ void rowlocks_print_stats(FILE *f);
 void rowlocks_bench(void *, int, int);
 void rowlocks_lock1_bench(void *, int, int);
 void rowlocks_lock2_bench(void *, int, int);
+void rowlocks_relock_bench(void *, int, int);
 void commit_bench(void *, int, int);
 void bdb_detect(void *);
 void enable_ack_trace(void);
@@ -150,6 +154,9 @@ static const char *HELP_MAIN[] = {
     "sqlpool        - on/off/stat/mark #/ # of threads.  fast sql pool thread "
     "control",
     "scon/scof      - request report",
+    "profiler [dump <file>|reset] - sampling profiler stats, folded "
+    "stacks or reset",
+    "tracering dump [<file>]|clear - write out or clear the trace rings",
     "erron/erroff   - db error report back to client",
     "ling #         - set of seconds for idle thread linger",
     "maxt #         - set max # of threads",
@@ -587,6 +594,8 @@ extern int gbl_fdb_track_hints;
 extern unsigned long long release_locks_on_si_lockwait_cnt;
 extern int reset_blkmax(void);
 extern int gbl_new_snapisol;
+extern int64_t gbl_undo_row_cache_hits;
+extern int64_t gbl_undo_row_cache_misses;
 #ifdef NEWSI_STAT
 void bdb_print_logfile_pglogs_stat();
 void bdb_clear_logfile_pglogs_stat();
@@ -929,6 +938,9 @@ clipper_usage:
         bdb_osql_trn_clients_status();
         logmsg(LOGMSG_USER, "Release locks on snapisol lockwait count: %llu\n",
                release_locks_on_si_lockwait_cnt);
+        logmsg(LOGMSG_USER,
+               "Undo row cache hits: %" PRId64 " misses: %" PRId64 "\n",
+               gbl_undo_row_cache_hits, gbl_undo_row_cache_misses);
         if (gbl_new_snapisol) {
             logmsg(LOGMSG_USER, "newsi memory pool stat:\n");
             bdb_newsi_mempool_stat();
@@ -1611,6 +1623,64 @@ clipper_usage:
         thd_stats();
     } else if (tokcmp(tok, ltok, "thr") == 0) {
         thrman_dump();
+    } else if (tokcmp(tok, ltok, "profiler") == 0) {
+        tok = segtok(line, lline, &st, &ltok);
+        if (tokcmp(tok, ltok, "reset") == 0) {
+            profiler_reset();
+        } else if (tokcmp(tok, ltok, "dump") == 0) {
+            char *file;
+            FILE *f;
+            tok = segtok(line, lline, &st, &ltok);
+            if (ltok == 0) {
+                logmsg(LOGMSG_ERROR, "Usage: profiler dump <file>\n");
+                return -1;
+            }
+            file = tokdup(tok, ltok);
+            if ((f = fopen(file, "w")) == NULL) {
+                logmsg(LOGMSG_ERROR, "can't open %s: %s\n", file,
+                       strerror(errno));
+            } else {
+                profiler_dump(f);
+                fclose(f);
+                logmsg(LOGMSG_USER, "wrote folded stacks to %s\n", file);
+            }
+            free(file);
+        } else {
+            struct profiler_stats pst;
+            profiler_get_stats(&pst);
+            logmsg(LOGMSG_USER,
+                   "profiler_hz %d, samples %" PRId64 ", stacks %" PRId64
+                   ", missed %" PRId64 ", dropped %" PRId64 "\n",
+                   gbl_profiler_hz, pst.samples, pst.stacks, pst.missed,
+                   pst.dropped);
+        }
+    } else if (tokcmp(tok, ltok, "tracering") == 0) {
+        tok = segtok(line, lline, &st, &ltok);
+        if (tokcmp(tok, ltok, "clear") == 0) {
+            trace_ring_clear();
+        } else if (tokcmp(tok, ltok, "dump") == 0) {
+            char *file;
+            FILE *f;
+            tok = segtok(line, lline, &st, &ltok);
+            if (ltok == 0) {
+                trace_ring_dump(stdout);
+                fflush(stdout);
+                return 0;
+            }
+            file = tokdup(tok, ltok);
+            if ((f = fopen(file, "w")) == NULL) {
+                logmsg(LOGMSG_ERROR, "can't open %s: %s\n", file,
+                       strerror(errno));
+            } else {
+                trace_ring_dump(f);
+                fclose(f);
+                logmsg(LOGMSG_USER, "wrote trace rings to %s\n", file);
+            }
+            free(file);
+        } else {
+            logmsg(LOGMSG_ERROR, "Usage: tracering dump [<file>]|clear\n");
+            return -1;
+        }
     } else if (tokcmp(tok, ltok, "thrtrc") == 0) {
         tok = segtok(line, lline, &st, &ltok);
         if (ltok > 0)
@@ -1831,6 +1901,8 @@ clipper_usage:
             logmsg(LOGMSG_USER, "num new sql queries     %u\n", gbl_nnewsql);
             logmsg(LOGMSG_USER, "num master rejects      %u\n",
                    gbl_masterrejects);
+            logmsg(LOGMSG_USER, "num master read offloads %u\n",
+                   gbl_master_read_offloads);
             logmsg(LOGMSG_USER, "sql ticks               %llu\n", gbl_sqltick);
             logmsg(LOGMSG_USER, "sql deadlocks recover attempts %llu failures %llu\n",
                    gbl_sql_deadlock_reconstructions, gbl_sql_deadlock_failures);
@@ -2380,6 +2452,8 @@ clipper_usage:
         tokcpy(tok, ltok, table);
 
         stat_bt_hash_table_reset(table);
+    } else if (tokcmp(tok, ltok, "zonemapstat") == 0) {
+        zonemap_stat();
     } else if (tokcmp(tok, ltok, "fastinit") == 0 ||
                tokcmp(tok, ltok, "reinit") == 0) {
         char table[MAXTABLELEN];
@@ -4547,6 +4621,30 @@ clipper_usage:
             rowlocks_lock2_bench(thedb->bdb_env, lcnt, pcnt);
             Pthread_mutex_unlock(&testguard);
         }
+    } else if (tokcmp(tok, ltok, "rowlocks_relock_bench") == 0) {
+        int lcnt = 0;
+        int pcnt = 0;
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok > 0) {
+            lcnt = toknum(tok, ltok);
+
+            tok = segtok(line, lline, &st, &ltok);
+            if (ltok > 0) {
+                pcnt = toknum(tok, ltok);
+            }
+        }
+        if (thedb->master != gbl_myhostname) {
+            logmsg(LOGMSG_ERROR, "I am not the master node\n");
+        } else if (!gbl_rowlocks) {
+            logmsg(LOGMSG_ERROR, "I am not in rowlocks mode\n");
+        } else if (lcnt <= 0 || pcnt <= 0) {
+            logmsg(LOGMSG_ERROR,
+                   "rowlocks_relock_bench requires ltxn-count & ptxn-count\n");
+        } else {
+            Pthread_mutex_lock(&testguard);
+            rowlocks_relock_bench(thedb->bdb_env, lcnt, pcnt);
+            Pthread_mutex_unlock(&testguard);
+        }
     } else if (tokcmp(tok, ltok, "deadlock_policy_override") == 0) {
         tok = segtok(line, lline, &st, &ltok);
         if (ltok > 0) {
@@ -0,0 +1,347 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "comdb2.h"
+#include "sql.h"
+#include "thrman.h"
+#include "reqlog.h"
+#include "plhash.h"
+#include "walkback.h"
+#include "tohex.h"
+#include "logmsg.h"
+#include "profiler.h"
+
+#ifdef __GLIBC__
+extern char **backtrace_symbols(void *const *, int);
+#else
+#define backtrace_symbols(A, B) NULL
+#endif
+
+int gbl_profiler_hz = 0;
+int gbl_profiler_max_stacks = 10000;
+
+#define PROF_MAXFRAMES 32
+#define PROF_TIMEOUT_US 10000
+
+/* the hash key is the whole struct, so it must be zeroed before it is
+ * filled in */
+struct prof_key {
+    int type;
+    int oncpu;
+    int nframes;
+    int have_fingerprint;
+    char fingerprint[FINGERPRINTSZ];
+    void *pcs[PROF_MAXFRAMES]; /* innermost first */
+};
+
+struct prof_stack {
+    struct prof_key key;
+    int64_t samples;
+};
+
+static pthread_mutex_t lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *stacks;
+static int64_t nsamples, nmissed, ndropped;
+
+/* The profiler samples one thread at a time, so there is a single slot for
+ * the signal handler to fill in.  The handler only writes to it if it can
+ * move it from ARMED to BUSY; a sample that times out is disarmed first, so
+ * a late signal finds nothing to do. */
+enum { SLOT_IDLE, SLOT_ARMED, SLOT_BUSY, SLOT_DONE };
+static struct {
+    int state;
+    int oncpu;
+    unsigned nframes;
+    void *pcs[PROF_MAXFRAMES];
+} slot;
+
+/* wall and cpu time at this thread's previous sample */
+static __thread int64_t last_wall_ns, last_cpu_ns;
+
+static int64_t ts_ns(clockid_t clk)
+{
+    struct timespec ts;
+    if (clock_gettime(clk, &ts))
+        return 0;
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void profiler_signal(int signo, siginfo_t *info, void *context)
+{
+    int saved_errno = errno;
+    int armed = SLOT_ARMED;
+    int64_t wall, cpu;
+
+    if (!__atomic_compare_exchange_n(&slot.state, &armed, SLOT_BUSY, 0,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        errno = saved_errno;
+        return;
+    }
+
+    if (stack_pc_getlist((ucontext_t *)context, slot.pcs, PROF_MAXFRAMES,
+                         &slot.nframes))
+        slot.nframes = 0;
+
+    wall = ts_ns(CLOCK_MONOTONIC);
+    cpu = ts_ns(CLOCK_THREAD_CPUTIME_ID);
+    /* a thread's first sample compares against all the cpu it used since it
+     * started, which is as good a guess as any */
+    slot.oncpu = 2 * (cpu - last_cpu_ns) >= (wall - last_wall_ns);
+    last_wall_ns = wall;
+    last_cpu_ns = cpu;
+
+    __atomic_store_n(&slot.state, SLOT_DONE, __ATOMIC_RELEASE);
+    errno = saved_errno;
+}
+
+static void record_sample(const struct prof_key *key)
+{
+    struct prof_stack *s;
+
+    Pthread_mutex_lock(&lk);
+    if ((s = hash_find(stacks, key)) == NULL) {
+        if (hash_get_num_entries(stacks) >= gbl_profiler_max_stacks ||
+            (s = malloc(sizeof(*s))) == NULL) {
+            ndropped++;
+            Pthread_mutex_unlock(&lk);
+            return;
+        }
+        s->key = *key;
+        s->samples = 0;
+        hash_add(stacks, s);
+    }
+    s->samples++;
+    nsamples++;
+    Pthread_mutex_unlock(&lk);
+}
+
+/* Called with the thread list locked, so thr can't go away under us */
+static int sample_thread(struct thr_handle *thr, void *arg)
+{
+    struct prof_key key;
+    int state, armed, waited;
+
+    if (thr == arg)
+        return 0;
+
+    memset(&key, 0, sizeof(key));
+    key.type = thrman_get_type(thr);
+    key.have_fingerprint =
+        reqlog_get_fingerprint(thrman_peek_reqlogger(thr), key.fingerprint,
+                               sizeof(key.fingerprint));
+
+    __atomic_store_n(&slot.state, SLOT_ARMED, __ATOMIC_RELEASE);
+    if (pthread_kill(thrman_get_tid(thr), SIGPROF)) {
+        __atomic_store_n(&slot.state, SLOT_IDLE, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    for (waited = 0;; waited += 20) {
+        state = __atomic_load_n(&slot.state, __ATOMIC_ACQUIRE);
+        if (state == SLOT_DONE)
+            break;
+        if (state == SLOT_ARMED && waited >= PROF_TIMEOUT_US) {
+            armed = SLOT_ARMED;
+            if (__atomic_compare_exchange_n(&slot.state, &armed, SLOT_IDLE, 0,
+                                            __ATOMIC_ACQUIRE,
+                                            __ATOMIC_RELAXED)) {
+                Pthread_mutex_lock(&lk);
+                nmissed++;
+                Pthread_mutex_unlock(&lk);
+                return 0;
+            }
+            continue; /* the handler got there first; it won't be long */
+        }
+        usleep(20);
+    }
+
+    key.oncpu = slot.oncpu;
+    key.nframes = slot.nframes;
+    memcpy(key.pcs, slot.pcs, key.nframes * sizeof(void *));
+    __atomic_store_n(&slot.state, SLOT_IDLE, __ATOMIC_RELAXED);
+
+    if (key.nframes > 0)
+        record_sample(&key);
+    return 0;
+}
+
+static void *profiler_thd(void *arg)
+{
+    struct sigaction sa = {0};
+    struct thr_handle *self;
+    int hz;
+
+    comdb2_name_thread(__func__);
+    self = thrman_register(THRTYPE_GENERIC);
+
+    sa.sa_sigaction = profiler_signal;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, NULL)) {
+        logmsg(LOGMSG_ERROR, "%s: sigaction rc %d %s\n", __func__, errno,
+               strerror(errno));
+        return NULL;
+    }
+
+    while (!db_is_exiting()) {
+        hz = gbl_profiler_hz;
+        if (hz <= 0) {
+            sleep(1);
+            continue;
+        }
+        if (hz > 1000)
+            hz = 1000;
+        thrman_foreach(sample_thread, self);
+        usleep(1000000 / hz);
+    }
+    return NULL;
+}
+
+void profiler_init(void)
+{
+    pthread_t tid;
+    stacks = hash_init_flat_o(offsetof(struct prof_stack, key),
+                              sizeof(struct prof_key));
+    Pthread_create(&tid, &gbl_pthread_attr_detached, profiler_thd, NULL);
+}
+
+static int copy_stack(void *obj, void *arg)
+{
+    struct prof_stack **out = arg;
+    **out = *(struct prof_stack *)obj;
+    (*out)++;
+    return 0;
+}
+
+/* "frame;frame;..." outermost first; functions without a symbol are shown
+ * as their address */
+static char *fold_stack(const struct prof_key *key)
+{
+    char **syms = backtrace_symbols(key->pcs, key->nframes);
+    size_t len = 1, off = 0;
+    char *out, *name, *end;
+    char pc[32];
+    int i;
+
+    for (i = 0; i < key->nframes; i++)
+        len += (syms ? strlen(syms[i]) : 0) + sizeof(pc) + 1;
+    if ((out = malloc(len)) == NULL) {
+        free(syms);
+        return NULL;
+    }
+    out[0] = 0;
+    for (i = key->nframes - 1; i >= 0; i--) {
+        name = NULL;
+        if (syms && (name = strchr(syms[i], '(')) != NULL) {
+            name++;
+            end = name + strcspn(name, "+)");
+            if (end == name)
+                name = NULL;
+        }
+        if (name == NULL) {
+            snprintf(pc, sizeof(pc), "%p", key->pcs[i]);
+            name = pc;
+            end = pc + strlen(pc);
+        }
+        off += snprintf(out + off, len - off, "%s%.*s", off ? ";" : "",
+                        (int)(end - name), name);
+    }
+    free(syms);
+    return out;
+}
+
+int profiler_foreach(profiler_stack_fn *fn, void *arg)
+{
+    struct prof_stack *copy, *p;
+    char fp[FINGERPRINTSZ * 2 + 1];
+    char *stack;
+    int i, n, rc = 0;
+
+    /* copy out, so symbolizing doesn't hold up the profiler */
+    Pthread_mutex_lock(&lk);
+    n = hash_get_num_entries(stacks);
+    if ((copy = malloc((n ? n : 1) * sizeof(*copy))) == NULL) {
+        Pthread_mutex_unlock(&lk);
+        return ENOMEM;
+    }
+    p = copy;
+    hash_for(stacks, copy_stack, &p);
+    Pthread_mutex_unlock(&lk);
+
+    for (i = 0; i < n && rc == 0; i++) {
+        if ((stack = fold_stack(&copy[i].key)) == NULL) {
+            rc = ENOMEM;
+            break;
+        }
+        if (copy[i].key.have_fingerprint)
+            util_tohex(fp, copy[i].key.fingerprint, FINGERPRINTSZ);
+        rc = fn(arg, thrman_type2a(copy[i].key.type),
+                copy[i].key.have_fingerprint ? fp : NULL, copy[i].key.oncpu,
+                copy[i].samples, stack);
+        free(stack);
+    }
+    free(copy);
+    return rc;
+}
+
+static int dump_stack(void *arg, const char *type, const char *fingerprint,
+                      int oncpu, int64_t samples, const char *stack)
+{
+    fprintf((FILE *)arg, "%s;%s;%s;%s %" PRId64 "\n", type,
+            fingerprint ? fingerprint : "-", oncpu ? "on-cpu" : "off-cpu",
+            stack, samples);
+    return 0;
+}
+
+int profiler_dump(FILE *f)
+{
+    return profiler_foreach(dump_stack, f);
+}
+
+static int free_stack(void *obj, void *arg)
+{
+    free(obj);
+    return 0;
+}
+
+void profiler_reset(void)
+{
+    Pthread_mutex_lock(&lk);
+    hash_for(stacks, free_stack, NULL);
+    hash_clear(stacks);
+    nsamples = nmissed = ndropped = 0;
+    Pthread_mutex_unlock(&lk);
+}
+
+void profiler_get_stats(struct profiler_stats *st)
+{
+    Pthread_mutex_lock(&lk);
+    st->samples = nsamples;
+    st->missed = nmissed;
+    st->dropped = ndropped;
+    st->stacks = hash_get_num_entries(stacks);
+    Pthread_mutex_unlock(&lk);
+}
@@ -0,0 +1,61 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_PROFILER_H
+#define INCLUDED_PROFILER_H
+
+/*
+  Sampling profiler
+
+  While profiler_hz is set, a profiler thread wakes that many times a second
+  and interrupts every registered thread in turn with SIGPROF.  The handler
+  unwinds the interrupted stack, and notes whether the thread used at least
+  half of the time since its last sample on cpu (on-cpu) or not (off-cpu,
+  i.e. blocked on a lock, IO or the network).  Samples are aggregated in
+  memory by thread type, fingerprint of the request the thread was running,
+  on/off-cpu and stack.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+
+struct profiler_stats {
+    int64_t samples; /* stacks recorded */
+    int64_t missed;  /* threads that did not answer in time */
+    int64_t dropped; /* samples with a new stack once the table was full */
+    int64_t stacks;  /* distinct stacks held */
+};
+
+extern int gbl_profiler_hz;
+extern int gbl_profiler_max_stacks;
+
+void profiler_init(void);
+
+/* Called for every aggregated stack.  fingerprint is in hex or NULL; stack
+ * has the frames outermost first, separated by ';'. */
+typedef int profiler_stack_fn(void *arg, const char *type,
+                              const char *fingerprint, int oncpu,
+                              int64_t samples, const char *stack);
+int profiler_foreach(profiler_stack_fn *fn, void *arg);
+
+/* Write the stacks in folded format, one "frame;frame;... count" per line,
+ * prefixed with the thread type, fingerprint and on/off-cpu */
+int profiler_dump(FILE *f);
+
+void profiler_reset(void);
+void profiler_get_stats(struct profiler_stats *st);
+
+#endif
@@ -49,6 +49,7 @@
 #include "debug_switches.h"
 #include "logmsg.h"
 #include "indices.h"
+#include "counters.h"
 #include "comdb2_atomic.h"
 #include "schemachange.h"
 #include "gettimeofday_ms.h"
@@ -1041,6 +1042,24 @@ int upd_record(struct ireq *iq, void *trans, void *primkey, int rrn,
             reqprintf(iq, "ix_load_for_write_by_genid_tran RRN %d GENID 0x%llx "
                           "DTALEN %zu FNDLEN %d RC %d",
                       rrn, vgenid, od_len, fndlen, rc);
+
+        /* a concurrent update got there first; counters can still apply */
+        if (rc != 0 && rc != RC_INTERNAL_RETRY && !vrecord && updCols &&
+            !is_event_from_sc(flags) && strcmp(tag, ".ONDISK") == 0 &&
+            counter_table(iq->usedb)) {
+            void *cnt_dta = alloca(od_len);
+            unsigned long long curgenid;
+            int crc = counter_rebase(iq, trans, rrn, vgenid, record, updCols,
+                                     cnt_dta, old_dta, od_len, &curgenid);
+            if (crc == 0) {
+                record = cnt_dta;
+                vgenid = curgenid;
+                fndlen = od_len;
+                rc = 0;
+            } else if (crc == RC_INTERNAL_RETRY) {
+                rc = crc;
+            }
+        }
     }
     if (rc != 0 || od_len != fndlen) {
         if (iq->debug)
@@ -1317,6 +1336,10 @@ int upd_record(struct ireq *iq, void *trans, void *primkey, int rrn,
         goto err;
     }
 
+    if (flags != RECFLAGS_UPGRADE_RECORD && !is_event_from_sc(flags) &&
+        counter_table(iq->usedb))
+        counter_remember(iq->usedb, vgenid, *genid, old_dta, od_len);
+
     // if even one ix is done deferred, we want to do the post_update deferred
     int deferredAdd = 0;
     int same_genid_with_upd =
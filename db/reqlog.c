@@ -73,6 +73,7 @@
 
 #include "eventlog.h"
 #include "reqlog_int.h"
+#include "thread_stats.h"
 
 #include <tohex.h>
 #include "string_ref.h"
@@ -1048,9 +1049,6 @@ static void reqlog_free_tables(struct reqlogger *logger) {
     }
     assert(logger->tables == NULL);
 
-    for (int i = 0; i < logger->ntables; ++i) {
-        free(logger->sqltables[i]);
-    }
     free(logger->sqltables);
 }
 
@@ -2065,6 +2063,7 @@ void reqlog_end_request(struct reqlogger *logger, int rc, const char *callfunc,
     logger->durationus =
         (comdb2_time_epochus() - logger->startprcsus) + logger->queuetimeus;
 
+    reqlog_stage_collect(logger);
     eventlog_add(logger);
 
     /* now see if this matches any of our rules */
@@ -3037,6 +3036,19 @@ void reqlog_set_fingerprint(struct reqlogger *logger, const char *fingerprint,
     logger->have_fingerprint = 1;
 }
 
+/* Copy out the fingerprint of the request in progress; returns 0 if there is
+ * none.  May be called from another thread without locking, in which case the
+ * copy can be torn if the request changes under it. */
+int reqlog_get_fingerprint(const struct reqlogger *logger, char *fingerprint,
+                           size_t n)
+{
+    if (logger == NULL || !logger->have_fingerprint)
+        return 0;
+    size_t min = (FINGERPRINTSZ < n) ? FINGERPRINTSZ : n;
+    memcpy(fingerprint, logger->fingerprint, min);
+    return 1;
+}
+
 inline void reqlog_set_event(struct reqlogger *logger, evtype_t ev)
 {
     logger->event_type = ev;
@@ -3047,14 +3059,20 @@ inline evtype_t reqlog_get_event(struct reqlogger *logger)
     return logger->event_type;
 }
 
+/* table must be interned (dbtable->interned_name): it is kept, not copied,
+ * and a table already on the list is found by pointer */
 void reqlog_add_table(struct reqlogger *logger, const char *table)
 {
+    for (int i = 0; i < logger->ntables; i++) {
+        if (logger->sqltables[i] == table)
+            return;
+    }
     if (logger->ntables == logger->alloctables) {
         logger->alloctables = logger->alloctables * 2 + 10;
         logger->sqltables =
             realloc(logger->sqltables, logger->alloctables * sizeof(char *));
     }
-    logger->sqltables[logger->ntables++] = strdup(table);
+    logger->sqltables[logger->ntables++] = table;
 }
 
 inline void reqlog_set_error(struct reqlogger *logger, const char *error,
@@ -3099,6 +3117,76 @@ inline void reqlog_set_nwrites(struct reqlogger *logger, int nwrites, int cascad
     logger->cascaded_nwrites = cascaded_nwrites;
 }
 
+static const char *stage_names[REQL_NSTAGES] = {
+    "queue",  "prepare", "firstrow", "iowait", "lockwait",
+    "bplog",  "master",  "replwait", "commit"};
+
+const char *reqlog_stage_name(enum reqlog_stage stage)
+{
+    return stage < REQL_NSTAGES ? stage_names[stage] : "unknown";
+}
+
+void reqlog_stage_begin(struct reqlogger *logger, enum reqlog_stage stage)
+{
+    if (logger)
+        getbbhrtime(&logger->stagestart[stage]);
+}
+
+void reqlog_stage_end(struct reqlogger *logger, enum reqlog_stage stage)
+{
+    bbhrtime_t now;
+    int64_t ns;
+
+    if (!logger)
+        return;
+    getbbhrtime(&now);
+    ns = diff_bbhrtime(&now, &logger->stagestart[stage]);
+    if (ns > 0)
+        logger->stageus[stage] += ns / 1000;
+}
+
+void reqlog_stage_add(struct reqlogger *logger, enum reqlog_stage stage,
+                      uint64_t us)
+{
+    if (logger)
+        logger->stageus[stage] += us;
+}
+
+uint64_t reqlog_stage_us(const struct reqlogger *logger,
+                         enum reqlog_stage stage)
+{
+    return logger ? logger->stageus[stage] : 0;
+}
+
+/* Fill in the stages that are measured elsewhere: queue time, and the
+ * berkdb io and lock waits that this thread accumulated for the request.
+ * Safe to call more than once. */
+void reqlog_stage_collect(struct reqlogger *logger)
+{
+    const struct berkdb_thread_stats *t = bdb_get_thread_stats();
+
+    if (!logger)
+        return;
+    logger->stageus[REQL_STAGE_QUEUE] = logger->queuetimeus;
+    logger->stageus[REQL_STAGE_IOWAIT] = t->pread_time_us + t->pwrite_time_us;
+    logger->stageus[REQL_STAGE_LOCKWAIT] = t->lock_wait_time_us;
+}
+
+void reqlog_stage_hist_add(struct reqlog_stage_hist *hist,
+                           const struct reqlogger *logger)
+{
+    for (int i = 0; i < REQL_NSTAGES; i++) {
+        uint64_t us = logger->stageus[i];
+        int b = 0;
+        if (us == 0)
+            continue;
+        while (b < REQL_STAGE_NBUCKETS - 1 && (us >> b) > 1)
+            b++;
+        hist->totus[i] += us;
+        hist->buckets[i][b]++;
+    }
+}
+
 struct dump_client_sql_options  {
     struct reqlogger *logger;
     int do_snap;
@@ -3159,7 +3247,7 @@ void add_fingerprint_to_rawstats(struct rawnodestats *stats, unsigned char *fing
     Pthread_mutex_lock(&stats->lk);
     if (stats->fingerprints == NULL) {
         // TODO: where does this get destroyed?
-        stats->fingerprints = hash_init_o(offsetof(struct query_count, fingerprint), FINGERPRINTSZ);
+        stats->fingerprints = hash_init_flat_o(offsetof(struct query_count, fingerprint), FINGERPRINTSZ);
         if (stats->fingerprints == NULL)
             abort();
     }
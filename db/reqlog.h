@@ -37,6 +37,30 @@ enum { REQL_BAD_CSTR_FLAG = 1 };
 
 typedef enum { EV_UNSET, EV_TXN, EV_SQL, EV_SP } evtype_t;
 
+/* Stages of a request timed separately from its total duration.  A stage
+ * may be entered several times per request; its times are summed. */
+enum reqlog_stage {
+    REQL_STAGE_QUEUE,    /* waiting for a worker thread */
+    REQL_STAGE_PREPARE,  /* preparing statements */
+    REQL_STAGE_FIRSTROW, /* start of execution until the first row */
+    REQL_STAGE_IOWAIT,   /* berkdb page reads and writes */
+    REQL_STAGE_LOCKWAIT, /* berkdb lock waits */
+    REQL_STAGE_BPLOG,    /* sending the bplog to the master */
+    REQL_STAGE_MASTER,   /* master applying the bplog */
+    REQL_STAGE_REPLWAIT, /* master waiting for replicants to ack */
+    REQL_STAGE_COMMIT,   /* the whole commit, as seen by the client */
+    REQL_NSTAGES
+};
+
+/* log2 buckets of microseconds; the last bucket holds everything >= 2^22us */
+#define REQL_STAGE_NBUCKETS 24
+
+/* per-fingerprint stage histograms */
+struct reqlog_stage_hist {
+    uint64_t totus[REQL_NSTAGES];
+    uint32_t buckets[REQL_NSTAGES][REQL_STAGE_NBUCKETS];
+};
+
 int reqlog_init(const char *dbname);
 struct reqlogger *reqlog_alloc(void);
 void reqlog_reset(struct reqlogger *logger);
@@ -81,6 +105,7 @@ void reqlog_set_queue_time(struct reqlogger *logger, uint64_t timeus);
 uint64_t reqlog_get_queue_time(const struct reqlogger *logger);
 void reqlog_reset_fingerprint(struct reqlogger *logger, size_t n);
 void reqlog_set_fingerprint(struct reqlogger *logger, const char *fp, size_t n);
+int reqlog_get_fingerprint(const struct reqlogger *logger, char *fp, size_t n);
 void reqlog_set_rqid(struct reqlogger *logger, void *id, int idlen);
 void reqlog_set_event(struct reqlogger *logger, evtype_t evtype);
 evtype_t reqlog_get_event(struct reqlogger *logger);
@@ -97,6 +122,17 @@ void reqlog_set_clnt(struct reqlogger *, struct sqlclntstate *);
 void reqlog_set_clnt(struct reqlogger *, struct sqlclntstate *);
 void reqlog_set_nwrites(struct reqlogger *logger, int nwrites, int cascaded_nwrites);
 
+const char *reqlog_stage_name(enum reqlog_stage stage);
+void reqlog_stage_begin(struct reqlogger *logger, enum reqlog_stage stage);
+void reqlog_stage_end(struct reqlogger *logger, enum reqlog_stage stage);
+void reqlog_stage_add(struct reqlogger *logger, enum reqlog_stage stage,
+                      uint64_t us);
+uint64_t reqlog_stage_us(const struct reqlogger *logger,
+                         enum reqlog_stage stage);
+void reqlog_stage_collect(struct reqlogger *logger);
+void reqlog_stage_hist_add(struct reqlog_stage_hist *hist,
+                           const struct reqlogger *logger);
+
 void reqlog_long_running_sql_statements(void);
 void log_long_running_sql_statements(void);
 
@@ -6,6 +6,7 @@
 #include "cson.h"
 #include "sql.h"
 #include "reqlog.h"
+#include "bbhrtime.h"
 
 /* This used to be private to reqlog.  Moving to a shared header since
    eventlog also needs access to reqlog internals.  I am not sure
@@ -120,7 +121,7 @@ struct reqlogger {
 
     int ntables;
     int alloctables;
-    char **sqltables;
+    const char **sqltables; /* interned, see reqlog_add_table */
     char *error;
     char error_code;
 
@@ -128,6 +129,10 @@ struct reqlogger {
     int ncontext;
     char **context;
     struct sqlclntstate *clnt;
+
+    /* per stage elapsed time; see reqlog_stage_begin() */
+    uint64_t stageus[REQL_NSTAGES];
+    bbhrtime_t stagestart[REQL_NSTAGES];
 };
 
 /* a rage of values to look for */
@@ -22,7 +22,8 @@ enum {
     COMMIT_BENCH = 0,
     ROWLOCKS_BENCH = 1,
     ROWLOCKS_LOCK1_BENCH = 2,
-    ROWLOCKS_LOCK2_BENCH = 3
+    ROWLOCKS_LOCK2_BENCH = 3,
+    ROWLOCKS_RELOCK_BENCH = 4
 };
 
 /* Not pretty */
@@ -31,6 +32,7 @@ int ll_rowlocks_bench(bdb_state_type *bdb_state, tran_type *tran, int op,
 int ll_commit_bench(bdb_state_type *bdb_state, tran_type *tran, int op,
                     int arg1, int arg2, void *payload, int paylen);
 int bdb_tran_set_request_ack(void *trans);
+extern uint64_t gbl_rowlock_fastpath_hits;
 unsigned long long rep_get_send_callcount(void);
 unsigned long long rep_get_send_bytecount(void);
 void rep_reset_send_callcount(void);
@@ -152,6 +154,8 @@ static void rowlocks_bench_int(bdb_state_type *bdb_state, int op, int count,
         interval_flushes;
     tran_type *trans = NULL;
     struct ireq iq;
+    uint64_t fastpath_hits;
+    int64_t lkrequests = 0, lkrequests_end = 0;
 
     assert(op > 0);
     assert(count >= 1 && phys_txns_per_logical >= 1);
@@ -164,6 +168,9 @@ static void rowlocks_bench_int(bdb_state_type *bdb_state, int op, int count,
     net_reset_explicit_flushes();
     net_reset_send_interval_flushes();
 
+    fastpath_hits = gbl_rowlock_fastpath_hits;
+    bdb_get_lock_counters(thedb->bdb_env, NULL, NULL, NULL, &lkrequests);
+
     start = comdb2_time_epoch();
 
     for (i = 0; i < count; i++) {
@@ -233,6 +240,13 @@ static void rowlocks_bench_int(bdb_state_type *bdb_state, int op, int count,
            interval_flushes,
            interval_flushes ? (int)(physcnt / interval_flushes) : 0);
 
+    fastpath_hits = gbl_rowlock_fastpath_hits - fastpath_hits;
+    bdb_get_lock_counters(thedb->bdb_env, NULL, NULL, NULL, &lkrequests_end);
+    lkrequests = lkrequests_end - lkrequests;
+    printf("%" PRId64 " lock-requests (%d per record), %" PRIu64
+           " rowlock-fastpath hits\n",
+           lkrequests, (int)(lkrequests / physcnt), fastpath_hits);
+
     return;
 }
 
@@ -254,6 +268,12 @@ void rowlocks_lock2_bench(void *state, int lcount, int count)
     rowlocks_bench_int(bdb_state, ROWLOCKS_LOCK2_BENCH, lcount, count);
 }
 
+void rowlocks_relock_bench(void *state, int lcount, int count)
+{
+    bdb_state_type *bdb_state = state;
+    rowlocks_bench_int(bdb_state, ROWLOCKS_RELOCK_BENCH, lcount, count);
+}
+
 void commit_bench(void *state, int tcount, int count)
 {
     bdb_state_type *bdb_state = state;
@@ -456,9 +456,11 @@ int handle_ireq(struct ireq *iq)
 
             if (iq->sorese->rqid == 0)
                 abort();
-            osql_comm_signal_sqlthr_rc(
-                &iq->sorese->target, iq->sorese->rqid, iq->sorese->uuid,
-                iq->sorese->nops, &iq->errstat, IQ_SNAPINFO(iq), sorese_rc);
+            if (trans_defer_commit_ack(iq, sorese_rc))
+                osql_comm_signal_sqlthr_rc(
+                    &iq->sorese->target, iq->sorese->rqid, iq->sorese->uuid,
+                    iq->sorese->nops, &iq->errstat, IQ_SNAPINFO(iq), sorese_rc,
+                    &iq->commit_lsn);
 
             iq->timings.req_sentrc = osql_log_time();
 
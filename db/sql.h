@@ -37,6 +37,7 @@
 #include <sp.h>
 #include "sql_stmt_cache.h"
 #include "db_access.h"
+#include "reqlog.h"
 
 /* Modern transaction modes, more or less */
 enum transaction_level {
@@ -83,6 +84,7 @@ struct fingerprint_track {
     size_t nNormSql;  /* Length of normalized SQL query */
     int typeMismatch; /* Type(s) did not match when compared to sqlitex's */
     int nameMismatch; /* Column name(s) did not match when compared to sqlitex's */
+    struct reqlog_stage_hist stages; /* Per-stage latency histograms */
 };
 
 struct sql_authorizer_state {
@@ -92,6 +94,7 @@ struct sql_authorizer_state {
     int numDdls;                       /* number of DDLs found */
     int numVTableLocks;
     char **vTableLocks;
+    char lastReadTable[MAXTABLELEN];   /* table of the last SQLITE_READ */
 };
 
 /* Thread specific sql state */
@@ -109,6 +112,8 @@ struct sqlthdstate {
     stmt_cache_t *stmt_cache;
 
     int dbopen_gen;
+    int sqlmaster_gen;
+    int lua_version;
     int analyze_gen;
     int views_gen;
 
@@ -140,7 +145,9 @@ typedef struct fdbtimings {
 
 typedef struct {
     const char *spname;
-    genid_t genid;
+    genid_t *genids; /* items consumed by this transaction */
+    int ngenids;
+    int alloc;
 } shadbq_t;
 
 struct srs_tran;
@@ -322,6 +329,14 @@ enum early_verify_error {
     EARLY_ERR_GENCHANGE = 3
 };
 
+/* "set explain ..." */
+enum explain_mode {
+    EXPLAIN_OFF = 0,
+    EXPLAIN_PLAN = 1,    /* show plan */
+    EXPLAIN_VERBOSE = 2, /* show plan + wheretrace */
+    EXPLAIN_ANALYZE = 3  /* run, then show actuals per loop and cursor */
+};
+
 enum connection_state
 {
     CONNECTION_NEW,
@@ -620,6 +635,10 @@ struct sqlclntstate {
                                 * a specifically assigned SQL thread pool is
                                 * being used. */
 
+    int prio_class;            /* Priority class of the request within its
+                                * SQL thread pool, as assigned by the
+                                * ruleset; zero is the default class. */
+
     struct sqlworkstate work;  /* This is the primary data related to the SQL
                                 * client request in progress.  This includes
                                 * the original SQL query and its normalized
@@ -716,10 +735,21 @@ struct sqlclntstate {
 
     struct query_effects effects;
     struct query_effects log_effects;
+    commit_lsn_t commit_lsn; /* of the last commit, returned to the client */
+    commit_lsn_t read_lsn;   /* don't run until we have applied this */
     int64_t nsteps;
 
     struct user current_user;
     int authgen;
+    struct {
+        /* read/write granted to current_user, by dbs_idx; valid while
+         * llmeta and the auth gen are unchanged (see db_access.c) */
+        unsigned int llmeta_gen;
+        int authgen;
+        char user[MAX_USERNAME_LEN];
+        uint8_t read[256]; /* We can track upto 2048 tables */
+        uint8_t write[256];
+    } access_cache;
 
     char *origin;
     uint8_t dirty[256]; /* We can track upto 2048 tables */
@@ -805,7 +835,7 @@ struct sqlclntstate {
     int8_t has_recording;
     int8_t is_retry;
     int8_t get_cost;
-    int8_t is_explain;
+    int8_t is_explain; /* EXPLAIN_* */
     uint8_t is_analyze;
     uint8_t is_overlapping;
     uint32_t init_gen;
@@ -835,6 +865,9 @@ struct sqlclntstate {
     int conns_idx;
     int shard_slice;
 
+    /* rows of the running statement, collected or replayed */
+    struct result_cache_state *result_cache;
+
     char *argv0;
     char *stack;
 
@@ -861,6 +894,8 @@ struct sqlclntstate {
     int64_t connid;
     int64_t total_sql;
     int64_t sql_since_reset;
+    int64_t net_bytes_written;
+    int64_t net_write_calls;
     int64_t num_resets;
     time_t connect_time;
     time_t last_reset_time;
@@ -880,6 +915,10 @@ struct sqlclntstate {
     int8_t rowbuffer;
     /* 1 if client has requested flat column values. */
     int flat_col_vals;
+    /* 1 if client has requested columnar row blocks. */
+    int columnar_rows;
+    /* 1 if client wants our load with the last row. */
+    int load_info;
     plugin_func *recover_ddlk;
     replay_func *recover_ddlk_fail;
     unsigned skip_eventlog: 1;
@@ -891,6 +930,16 @@ struct sqlclntstate {
 };
 
 /* Query stats. */
+/* Buffer pool, lock and time spent in a cursor's finds and moves.  Only
+   kept under "set explain analyze" */
+struct cursor_actuals {
+    int64_t fgets;  /* page gets; counted with the memp_timing switch on */
+    int64_t preads; /* pages read from disk */
+    int64_t nlockwaits;
+    int64_t lockwait_us;
+    int64_t time_us;
+};
+
 struct query_path_component {
     char lcl_tbl_name[MAXTABLELEN];
     char rmt_db[MAX_DBNAME_LENGTH];
@@ -899,6 +948,7 @@ struct query_path_component {
     int nnext;
     int nwrite;
     int nblobs;
+    struct cursor_actuals actual;
     LINKC_T(struct query_path_component) lnk;
 };
 
@@ -978,6 +1028,7 @@ struct BtCursor {
     int dtabuflen;
     void *keybuf;
     int keybuflen;
+    int keybuf_lazy; /* lastkey is not converted into keybuf yet */
 
     int dtabuf_alloc;
     int keybuf_alloc;
@@ -1009,10 +1060,13 @@ struct BtCursor {
     blob_status_t blobs;
 
     bdb_cursor_ifn_t *bdbcur;
+    struct cursor_batch *batch; /* rows fetched ahead by a read-only scan */
+    struct cursor_zonemap *zonemap; /* zones a full scan can step over */
 
     int nmove, nfind, nwrite;
     int nblobs;
     int num_nexts;
+    struct cursor_actuals actual;
 
     int numblobs;
 
@@ -1060,6 +1114,9 @@ struct BtCursor {
 
     blob_status_t blob_descriptor;
     int have_blob_descriptor;
+    /* OPFLAG_LENGTHARG/OPFLAG_TYPEOFARG of the column being read: blobs
+       stored out of the row need not be fetched */
+    uint8_t blob_nofetch;
 
     unsigned long long last_cached_genid;
 
@@ -1141,6 +1198,8 @@ struct connection_info {
     char *sql;
     char *fingerprint;
     int64_t is_admin;
+    int64_t net_bytes_written; /* by the libevent transport */
+    int64_t net_write_calls;
     int64_t is_ssl; /* 1 if this an SSL connection */
     int64_t has_cert; /* 1 if the SSL connection has an X509 certificate */
     char *common_name; /* common name in the certificate */
@@ -1245,6 +1304,8 @@ int sqlengine_prepare_engine(struct sqlthdstate *, struct sqlclntstate *,
 int sqlserver2sqlclient_error(int rc);
 uint16_t stmt_num_tbls(sqlite3_stmt *);
 int newsql_dump_query_plan(struct sqlclntstate *clnt, sqlite3 *hndl);
+void explain_analyze_report(struct sqlclntstate *clnt, sqlite3_stmt *stmt,
+                            struct sql_thread *thd, int64_t nrows);
 void init_cursor(BtCursor *, Vdbe *, Btree *);
 void run_stmt_setup(struct sqlclntstate *, sqlite3_stmt *);
 int sql_index_name_trans(char *namebuf, int len, struct schema *schema,
@@ -1343,6 +1404,9 @@ void clnt_query_cost(struct sqlthdstate *thd, double *pCost, int64_t *pPrepMs);
 int clear_fingerprints(void);
 void calc_fingerprint(const char *zNormSql, size_t *pnNormSql,
                       unsigned char fingerprint[FINGERPRINTSZ]);
+void calc_stmt_fingerprint(sqlite3_stmt *, const char *zNormSql,
+                           size_t *pnNormSql,
+                           unsigned char fingerprint[FINGERPRINTSZ]);
 void add_fingerprint(struct sqlclntstate *, sqlite3_stmt *, const char *,
                      const char *, int64_t, int64_t, int64_t, int64_t,
                      struct reqlogger *, unsigned char *fingerprint_out);
@@ -0,0 +1,611 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Cached statement results.
+ *
+ * An entry is keyed by the text of the statement, its bound parameters and
+ * the client settings that change how rows are produced (timezone, datetime
+ * precision and user).  It holds the packed result rows, the version of each
+ * table the statement references and the commit genid sampled before the
+ * statement started reading.  The entry is served only while the commit
+ * genid has not moved and every table keeps its version; table versions
+ * only move on schema changes, so the commit genid is what catches writes.
+ *
+ * With sql_result_cache_max_staleness_ms set, an entry outlives commits for
+ * that long after its rows were read.  Dashboards that rerun the same
+ * aggregate then read it precomputed, at most that stale, instead of
+ * recomputing it after every unrelated write; comdb2_sql_result_cache shows
+ * the age of each entry and whether anything committed since.
+ *
+ * Served rows go through the same send path as stepped rows: the plugin
+ * column callbacks are pointed at the unpacked cached row, like dohsql does
+ * for rows produced by its shards, and the vdbe is never stepped.
+ */
+
+#include <stddef.h>
+#include "comdb2.h"
+#include "epochlib.h"
+#include "sql.h"
+#include "sqliteInt.h"
+#include "vdbeInt.h"
+#include "md5.h"
+#include "list.h"
+#include "plhash.h"
+#include "sql_result_cache.h"
+
+extern int sqlite3_unpacked_to_packed(Mem *mems, int nmems, char **ret_rec,
+                                      int *ret_rec_len);
+
+int gbl_sql_result_cache_kb = 0;
+int gbl_sql_result_cache_max_staleness_ms = 0;
+
+typedef struct result_cache_entry {
+    unsigned char digest[FINGERPRINTSZ];
+    char *key;
+    int keylen;
+    unsigned long long commit_genid;
+    int read_ms; /* when the statement started reading */
+    int ntables;
+    char **tables;
+    unsigned long long *versions;
+    int ncols;
+    char *rows;
+    size_t rowslen;
+    size_t size;
+    long long hits;
+    LINKC_T(struct result_cache_entry) lnk;
+} result_cache_entry_t;
+
+struct result_cache_state {
+    int serving;
+    unsigned char digest[FINGERPRINTSZ];
+    char *key;
+    int keylen;
+    unsigned long long commit_genid;
+    int read_ms;
+    int ncols;
+
+    /* collected rows, or a private copy of the rows being served; each row
+     * is an int length followed by the packed row */
+    char *rows;
+    size_t rowslen;
+    size_t rowsalloc;
+    int giveup;
+    int complete;
+    int ntables;
+    char **tables;
+    unsigned long long *versions;
+
+    /* replay */
+    size_t off;
+    Mem *row;
+    int rc;
+    struct plugin_callbacks backup;
+};
+
+static struct {
+    pthread_mutex_t mtx;
+    hash_t *hash;
+    LISTC_T(result_cache_entry_t) lru;
+    size_t bytes;
+} cache = {.mtx = PTHREAD_MUTEX_INITIALIZER};
+
+static void free_tables(int ntables, char **tables,
+                        unsigned long long *versions)
+{
+    for (int i = 0; i < ntables; i++)
+        free(tables[i]);
+    free(tables);
+    free(versions);
+}
+
+static void free_entry(result_cache_entry_t *e)
+{
+    free(e->key);
+    free(e->rows);
+    free_tables(e->ntables, e->tables, e->versions);
+    free(e);
+}
+
+static void free_state(struct result_cache_state *st)
+{
+    free(st->key);
+    free(st->rows);
+    free_tables(st->ntables, st->tables, st->versions);
+    free(st);
+}
+
+/* cache.mtx held */
+static void remove_entry(result_cache_entry_t *e)
+{
+    hash_del(cache.hash, e);
+    listc_rfl(&cache.lru, e);
+    cache.bytes -= e->size;
+    free_entry(e);
+}
+
+static int result_cache_eligible(struct sqlclntstate *clnt,
+                                 sqlite3_stmt *stmt)
+{
+    Vdbe *v = (Vdbe *)stmt;
+
+    if (clnt->ctrl_sqlengine != SQLENG_NORMAL_PROCESS ||
+        clnt->in_client_trans || clnt->intrans)
+        return 0;
+    if (!clnt->isselect || v->explain || clnt->is_explain ||
+        clnt->verify_indexes)
+        return 0;
+    if (clnt->osql.replay != OSQL_RETRY_NONE)
+        return 0;
+    /* distributed, lua and other engines that already own the callbacks */
+    if (clnt->conns || clnt->plugin.state || clnt->plugin.next_row)
+        return 0;
+    /* remote and system tables change without a local commit */
+    if (sqlite3_stmt_has_remotes(stmt) || v->numVTableLocks > 0)
+        return 0;
+
+    for (int i = 0; i < v->nOp; i++) {
+        Op *op = &v->aOp[i];
+        FuncDef *f;
+
+        if (op->opcode == OP_VOpen)
+            return 0;
+        if (op->opcode != OP_Function && op->opcode != OP_PureFunc &&
+            op->opcode != OP_Function0 && op->opcode != OP_PureFunc0)
+            continue;
+        if (op->p4type == P4_FUNCCTX)
+            f = op->p4.pCtx->pFunc;
+        else if (op->p4type == P4_FUNCDEF)
+            f = op->p4.pFunc;
+        else
+            return 0;
+        /* now(), random(), udfs and the like */
+        if (!(f->funcFlags & SQLITE_FUNC_CONSTANT) ||
+            (f->funcFlags & SQLITE_FUNC_SLOCHNG))
+            return 0;
+    }
+    return 1;
+}
+
+static int result_cache_key(struct sqlclntstate *clnt, sqlite3_stmt *stmt,
+                            struct result_cache_state *st)
+{
+    Vdbe *v = (Vdbe *)stmt;
+    const char *sql = sqlite3_sql(stmt);
+    const char *user =
+        clnt->current_user.have_name ? clnt->current_user.name : "";
+    char *params = NULL;
+    int paramslen = 0;
+    size_t sqllen, tzlen, userlen;
+    char *p;
+    MD5Context ctx = {0};
+
+    if (!sql)
+        return -1;
+    if (v->nVar > 0 &&
+        sqlite3_unpacked_to_packed(v->aVar, v->nVar, &params, &paramslen))
+        return -1;
+
+    sqllen = strlen(sql) + 1;
+    tzlen = strlen(clnt->tzname) + 1;
+    userlen = strlen(user) + 1;
+    st->keylen = sqllen + tzlen + userlen + sizeof(int) + paramslen;
+    p = st->key = malloc(st->keylen);
+    if (!p) {
+        free(params);
+        return -1;
+    }
+    memcpy(p, sql, sqllen);
+    p += sqllen;
+    memcpy(p, clnt->tzname, tzlen);
+    p += tzlen;
+    memcpy(p, user, userlen);
+    p += userlen;
+    memcpy(p, &clnt->dtprec, sizeof(int));
+    p += sizeof(int);
+    if (paramslen)
+        memcpy(p, params, paramslen);
+    free(params);
+
+    MD5Init(&ctx);
+    MD5Update(&ctx, (unsigned char *)st->key, st->keylen);
+    MD5Final(st->digest, &ctx);
+    return 0;
+}
+
+static int table_versions_match(result_cache_entry_t *e)
+{
+    for (int i = 0; i < e->ntables; i++) {
+        struct dbtable *db = get_dbtable_by_name(e->tables[i]);
+        if (!db || db->tableversion != e->versions[i])
+            return 0;
+    }
+    return 1;
+}
+
+/* Something committed since e was read; may it still be served? */
+static int staleness_ok(result_cache_entry_t *e)
+{
+    int max = gbl_sql_result_cache_max_staleness_ms;
+    return max > 0 && comdb2_time_epochms() - e->read_ms <= max;
+}
+
+/* Returns 1 and a private copy of the rows if st is cached and current, or
+ * no staler than sql_result_cache_max_staleness_ms allows */
+static int result_cache_lookup(struct result_cache_state *st)
+{
+    result_cache_entry_t *e;
+    int found = 0;
+
+    Pthread_mutex_lock(&cache.mtx);
+    if (!cache.hash || (e = hash_find(cache.hash, st->digest)) == NULL)
+        goto done;
+    if (e->keylen != st->keylen || memcmp(e->key, st->key, st->keylen))
+        goto done;
+    if ((e->commit_genid != st->commit_genid && !staleness_ok(e)) ||
+        e->ncols != st->ncols || !table_versions_match(e)) {
+        remove_entry(e);
+        goto done;
+    }
+    if (e->rowslen && (st->rows = malloc(e->rowslen)) == NULL)
+        goto done;
+    if (e->rowslen)
+        memcpy(st->rows, e->rows, e->rowslen);
+    st->rowslen = e->rowslen;
+    e->hits++;
+    listc_rfl(&cache.lru, e);
+    listc_abl(&cache.lru, e);
+    found = 1;
+done:
+    Pthread_mutex_unlock(&cache.mtx);
+    return found;
+}
+
+static void result_cache_store(struct result_cache_state *st)
+{
+    result_cache_entry_t *e, *old;
+    size_t budget = (size_t)gbl_sql_result_cache_kb * 1024;
+
+    e = calloc(1, sizeof(result_cache_entry_t));
+    if (!e)
+        return;
+    memcpy(e->digest, st->digest, FINGERPRINTSZ);
+    e->key = st->key;
+    e->keylen = st->keylen;
+    e->commit_genid = st->commit_genid;
+    e->read_ms = st->read_ms;
+    e->ntables = st->ntables;
+    e->tables = st->tables;
+    e->versions = st->versions;
+    e->ncols = st->ncols;
+    e->rows = st->rows;
+    e->rowslen = st->rowslen;
+    e->size = sizeof(result_cache_entry_t) + e->keylen + e->rowslen +
+              e->ntables * (sizeof(char *) + sizeof(unsigned long long));
+    for (int i = 0; i < e->ntables; i++)
+        e->size += strlen(e->tables[i]) + 1;
+    st->key = NULL;
+    st->tables = NULL;
+    st->versions = NULL;
+    st->ntables = 0;
+    st->rows = NULL;
+
+    Pthread_mutex_lock(&cache.mtx);
+    if (!cache.hash) {
+        cache.hash = hash_init_o(offsetof(result_cache_entry_t, digest),
+                                 FINGERPRINTSZ);
+        listc_init(&cache.lru, offsetof(result_cache_entry_t, lnk));
+    }
+    if (!cache.hash) {
+        Pthread_mutex_unlock(&cache.mtx);
+        free_entry(e);
+        return;
+    }
+    if ((old = hash_find(cache.hash, e->digest)) != NULL)
+        remove_entry(old);
+    if (hash_add(cache.hash, e)) {
+        Pthread_mutex_unlock(&cache.mtx);
+        free_entry(e);
+        return;
+    }
+    listc_abl(&cache.lru, e);
+    cache.bytes += e->size;
+    while (cache.bytes > budget && (old = cache.lru.top) != NULL)
+        remove_entry(old);
+    Pthread_mutex_unlock(&cache.mtx);
+}
+
+void result_cache_clear(void)
+{
+    result_cache_entry_t *e;
+
+    Pthread_mutex_lock(&cache.mtx);
+    if (cache.hash) {
+        while ((e = cache.lru.top) != NULL)
+            remove_entry(e);
+    }
+    Pthread_mutex_unlock(&cache.mtx);
+}
+
+int result_cache_collect(struct result_cache_info **info, int *count)
+{
+    unsigned long long commit_genid;
+    result_cache_entry_t *e;
+    struct result_cache_info *out;
+    int now = comdb2_time_epochms();
+    int n = 0;
+
+    *info = NULL;
+    *count = 0;
+    commit_genid = bdb_get_commit_genid(thedb->bdb_env, NULL);
+
+    Pthread_mutex_lock(&cache.mtx);
+    if (!cache.hash || cache.lru.count == 0) {
+        Pthread_mutex_unlock(&cache.mtx);
+        return 0;
+    }
+    out = calloc(cache.lru.count, sizeof(struct result_cache_info));
+    if (!out) {
+        Pthread_mutex_unlock(&cache.mtx);
+        return -1;
+    }
+    LISTC_FOR_EACH(&cache.lru, e, lnk)
+    {
+        struct result_cache_info *i = &out[n];
+        size_t len = 1;
+
+        for (int t = 0; t < e->ntables; t++)
+            len += strlen(e->tables[t]) + 1;
+        /* the key starts with the statement text */
+        if ((i->sql = strdup(e->key)) == NULL ||
+            (i->tables = calloc(1, len)) == NULL) {
+            free(i->sql);
+            break;
+        }
+        for (int t = 0; t < e->ntables; t++) {
+            if (t)
+                strcat(i->tables, ",");
+            strcat(i->tables, e->tables[t]);
+        }
+        i->bytes = e->size;
+        i->hits = e->hits;
+        i->age_ms = now - e->read_ms;
+        i->stale = e->commit_genid != commit_genid ? "Y" : "N";
+        n++;
+    }
+    Pthread_mutex_unlock(&cache.mtx);
+
+    *info = out;
+    *count = n;
+    return 0;
+}
+
+void result_cache_collect_free(struct result_cache_info *info, int count)
+{
+    for (int i = 0; i < count; i++) {
+        free(info[i].sql);
+        free(info[i].tables);
+    }
+    free(info);
+}
+
+static int result_cache_next_row(struct sqlclntstate *clnt,
+                                 sqlite3_stmt *stmt)
+{
+    struct result_cache_state *st = clnt->result_cache;
+    int len;
+
+    sqlite3UnpackedResultFree(&st->row, st->ncols);
+    if (st->off >= st->rowslen)
+        return st->rc = SQLITE_DONE;
+
+    memcpy(&len, st->rows + st->off, sizeof(int));
+    st->row = sqlite3UnpackedResult(stmt, st->ncols,
+                                    st->rows + st->off + sizeof(int), len);
+    st->off += sizeof(int) + len;
+    if (!st->row)
+        return st->rc = SQLITE_NOMEM;
+    return st->rc = SQLITE_ROW;
+}
+
+#define FUNC_COLUMN_TYPE(ret, type)                                            \
+    static ret result_cache_column_##type(struct sqlclntstate *clnt,           \
+                                          sqlite3_stmt *stmt, int iCol)        \
+    {                                                                          \
+        return sqlite3_value_##type(&clnt->result_cache->row[iCol]);               \
+    }
+
+FUNC_COLUMN_TYPE(int, type)
+FUNC_COLUMN_TYPE(sqlite_int64, int64)
+FUNC_COLUMN_TYPE(double, double)
+FUNC_COLUMN_TYPE(const unsigned char *, text)
+FUNC_COLUMN_TYPE(int, bytes)
+FUNC_COLUMN_TYPE(const void *, blob)
+FUNC_COLUMN_TYPE(const dttz_t *, datetime)
+
+static const intv_t *result_cache_column_interval(struct sqlclntstate *clnt,
+                                                  sqlite3_stmt *stmt, int iCol,
+                                                  int type)
+{
+    return sqlite3_value_interval(&clnt->result_cache->row[iCol], type);
+}
+
+static int result_cache_sqlite_error(struct sqlclntstate *clnt,
+                                     sqlite3_stmt *stmt, const char **errstr)
+{
+    struct result_cache_state *st = clnt->result_cache;
+
+    *errstr = NULL;
+    if (st->rc == SQLITE_NOMEM)
+        *errstr = "out of memory";
+    return st->rc;
+}
+
+static void result_cache_serve(struct sqlclntstate *clnt,
+                               struct result_cache_state *st)
+{
+    st->serving = 1;
+    st->backup = clnt->plugin;
+    clnt->plugin.next_row = result_cache_next_row;
+    clnt->plugin.column_type = result_cache_column_type;
+    clnt->plugin.column_int64 = result_cache_column_int64;
+    clnt->plugin.column_double = result_cache_column_double;
+    clnt->plugin.column_text = result_cache_column_text;
+    clnt->plugin.column_bytes = result_cache_column_bytes;
+    clnt->plugin.column_blob = result_cache_column_blob;
+    clnt->plugin.column_datetime = result_cache_column_datetime;
+    clnt->plugin.column_interval = result_cache_column_interval;
+    clnt->plugin.sqlite_error = result_cache_sqlite_error;
+}
+
+int result_cache_begin(struct sqlclntstate *clnt, sqlite3_stmt *stmt)
+{
+    struct result_cache_state *st;
+
+    /* a statement rerun after a remote schema change */
+    if (clnt->result_cache)
+        result_cache_end(clnt, -1);
+
+    if (gbl_sql_result_cache_kb <= 0) {
+        if (cache.bytes)
+            result_cache_clear();
+        return 0;
+    }
+    if (!result_cache_eligible(clnt, stmt))
+        return 0;
+
+    st = calloc(1, sizeof(struct result_cache_state));
+    if (!st)
+        return 0;
+    if (result_cache_key(clnt, stmt, st)) {
+        free_state(st);
+        return 0;
+    }
+    st->ncols = sqlite3_column_count(stmt);
+    st->commit_genid = bdb_get_commit_genid(thedb->bdb_env, NULL);
+    st->read_ms = comdb2_time_epochms();
+    clnt->result_cache = st;
+
+    if (result_cache_lookup(st)) {
+        result_cache_serve(clnt, st);
+        return 1;
+    }
+    return 0;
+}
+
+void result_cache_row(struct sqlclntstate *clnt, sqlite3_stmt *stmt)
+{
+    struct result_cache_state *st = clnt->result_cache;
+    size_t max = (size_t)gbl_sql_result_cache_kb * 1024 / 4;
+    long long size = 0;
+    char *packed;
+    int len;
+
+    if (!st || st->serving || st->giveup)
+        return;
+
+    packed = sqlite3PackedResult(stmt, &size);
+    if (!packed || st->rowslen + sizeof(int) + size > max) {
+        free(packed);
+        free(st->rows);
+        st->rows = NULL;
+        st->rowslen = st->rowsalloc = 0;
+        st->giveup = 1;
+        return;
+    }
+    if (st->rowslen + sizeof(int) + size > st->rowsalloc) {
+        size_t alloc = st->rowsalloc ? st->rowsalloc * 2 : 4096;
+        char *rows;
+        while (alloc < st->rowslen + sizeof(int) + size)
+            alloc *= 2;
+        if (alloc > max)
+            alloc = max;
+        if ((rows = realloc(st->rows, alloc)) == NULL) {
+            free(packed);
+            st->giveup = 1;
+            return;
+        }
+        st->rows = rows;
+        st->rowsalloc = alloc;
+    }
+    len = size;
+    memcpy(st->rows + st->rowslen, &len, sizeof(int));
+    memcpy(st->rows + st->rowslen + sizeof(int), packed, size);
+    st->rowslen += sizeof(int) + size;
+    free(packed);
+}
+
+void result_cache_complete(struct sqlclntstate *clnt, sqlite3_stmt *stmt)
+{
+    struct result_cache_state *st = clnt->result_cache;
+    Vdbe *v = (Vdbe *)stmt;
+
+    if (!st || st->serving || st->giveup)
+        return;
+
+    if (v->numTables > 0) {
+        st->tables = calloc(v->numTables, sizeof(char *));
+        st->versions = calloc(v->numTables, sizeof(unsigned long long));
+        if (!st->tables || !st->versions) {
+            st->giveup = 1;
+            return;
+        }
+    }
+    for (int i = 0; i < v->numTables; i++) {
+        const char *name = v->tbls[i]->zName;
+        struct dbtable *db = get_dbtable_by_name(name);
+        if (!db || (st->tables[i] = strdup(name)) == NULL) {
+            st->giveup = 1;
+            return;
+        }
+        st->versions[i] = db->tableversion;
+        st->ntables++;
+    }
+    st->complete = 1;
+}
+
+void result_cache_end(struct sqlclntstate *clnt, int rc)
+{
+    struct result_cache_state *st = clnt->result_cache;
+
+    if (!st)
+        return;
+    clnt->result_cache = NULL;
+
+    if (st->serving) {
+        struct plugin_callbacks *backup = &st->backup;
+
+        sqlite3UnpackedResultFree(&st->row, st->ncols);
+        clnt->plugin.next_row = backup->next_row;
+        clnt->plugin.column_type = backup->column_type;
+        clnt->plugin.column_int64 = backup->column_int64;
+        clnt->plugin.column_double = backup->column_double;
+        clnt->plugin.column_text = backup->column_text;
+        clnt->plugin.column_bytes = backup->column_bytes;
+        clnt->plugin.column_blob = backup->column_blob;
+        clnt->plugin.column_datetime = backup->column_datetime;
+        clnt->plugin.column_interval = backup->column_interval;
+        clnt->plugin.sqlite_error = backup->sqlite_error;
+    } else if (rc == 0 && st->complete && !st->giveup &&
+               gbl_sql_result_cache_kb > 0 &&
+               /* nothing committed while the rows were read */
+               bdb_get_commit_genid(thedb->bdb_env, NULL) ==
+                   st->commit_genid) {
+        result_cache_store(st);
+    }
+    free_state(st);
+}
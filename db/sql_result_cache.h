@@ -0,0 +1,68 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef __INCLUDED_SQL_RESULT_CACHE_H
+#define __INCLUDED_SQL_RESULT_CACHE_H
+
+/*
+  Result caching in Comdb2
+
+  Rows of an eligible read-only statement are kept, keyed by the statement
+  text and its bound parameters, and replayed through the plugin column
+  callbacks for as long as no commit has happened since they were read, or
+  for up to sql_result_cache_max_staleness_ms after they were read.
+*/
+
+struct sqlclntstate;
+struct sqlite3_stmt;
+
+extern int gbl_sql_result_cache_kb;
+extern int gbl_sql_result_cache_max_staleness_ms;
+
+/* One cached result, as listed by comdb2_sql_result_cache */
+struct result_cache_info {
+    char *sql;
+    char *tables; /* comma separated */
+    long long bytes;
+    long long hits;
+    long long age_ms;  /* since the rows were read */
+    const char *stale; /* "Y" if something committed since */
+};
+
+/* Called before the first step; if the rows are cached, installs the
+   callbacks that replay them and returns 1.  Otherwise the rows produced
+   by the statement may be collected by result_cache_row() */
+int result_cache_begin(struct sqlclntstate *clnt, struct sqlite3_stmt *stmt);
+
+/* Collect the current result row of stmt */
+void result_cache_row(struct sqlclntstate *clnt, struct sqlite3_stmt *stmt);
+
+/* The statement stepped to SQLITE_DONE */
+void result_cache_complete(struct sqlclntstate *clnt,
+                           struct sqlite3_stmt *stmt);
+
+/* Called once the statement is done; stores collected rows if the
+   statement succeeded, and restores the callbacks after a replay */
+void result_cache_end(struct sqlclntstate *clnt, int rc);
+
+/* Drop every cached result */
+void result_cache_clear(void);
+
+/* Snapshot the cached results; free with result_cache_collect_free() */
+int result_cache_collect(struct result_cache_info **info, int *count);
+void result_cache_collect_free(struct result_cache_info *info, int count);
+
+#endif
@@ -15,10 +15,12 @@
  */
 
 #include <sqliteInt.h>
+#include <vdbeInt.h>
 #include "sql_stmt_cache.h"
 #include "sql.h"
 #include "lrucache.h"
 #include "dohsql.h" // dohsql_wait_for_master()
+#include "memgov.h"
 
 int gbl_max_sqlcache = 10;
 int gbl_enable_sql_stmt_caching = STMT_CACHE_ALL;
@@ -52,18 +54,56 @@ int stmt_cache_delete(stmt_cache_t *stmt_cache)
     return 0;
 }
 
-static int strcmpfunc_stmt(char *a, char *b, int len)
+/* Statement texts are kept once per process, refcounted by the entries of
+ * every sql engine cache that holds the statement. */
+typedef struct shared_sql {
+    char *sql;
+    int ref;
+    char mem[0];
+} shared_sql_t;
+
+static pthread_mutex_t shared_sql_lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *shared_sql_hash = NULL;
+
+static char *shared_sql_get(const char *sql)
 {
-    return strcmp(a, b);
+    shared_sql_t *s = NULL;
+
+    Pthread_mutex_lock(&shared_sql_lk);
+    if (!shared_sql_hash)
+        shared_sql_hash = hash_init_strptr(offsetof(shared_sql_t, sql));
+    if (!shared_sql_hash)
+        goto done;
+    if ((s = hash_find(shared_sql_hash, &sql)) == NULL) {
+        size_t len = strlen(sql) + 1;
+        s = malloc(sizeof(shared_sql_t) + len);
+        if (!s)
+            goto done;
+        s->sql = s->mem;
+        memcpy(s->mem, sql, len);
+        s->ref = 0;
+        if (hash_add(shared_sql_hash, s)) {
+            free(s);
+            s = NULL;
+            goto done;
+        }
+    }
+    s->ref++;
+done:
+    Pthread_mutex_unlock(&shared_sql_lk);
+    return s ? s->sql : NULL;
 }
 
-static u_int strhashfunc_stmt(u_char *keyp, int len)
+static void shared_sql_put(char *sql)
 {
-    unsigned hash;
-    u_char *key = keyp;
-    for (hash = 0; *key; key++)
-        hash = ((hash % 8388013) << 8) + ((*key));
-    return hash;
+    shared_sql_t *s = (shared_sql_t *)(sql - offsetof(shared_sql_t, mem));
+
+    Pthread_mutex_lock(&shared_sql_lk);
+    if (--s->ref == 0) {
+        hash_del(shared_sql_hash, s);
+        free(s);
+    }
+    Pthread_mutex_unlock(&shared_sql_lk);
 }
 
 /* Initialize the specified stmt cache object and/or return a new one. */
@@ -77,9 +117,7 @@ stmt_cache_t *stmt_cache_new(stmt_cache_t *in_stmt_cache)
         return NULL;
     }
 
-    stmt_cache->hash = hash_init_user(
-        (hashfunc_t *)strhashfunc_stmt, (cmpfunc_t *)strcmpfunc_stmt,
-        offsetof(stmt_cache_entry_t, sql), MAX_HASH_SQL_LENGTH);
+    stmt_cache->hash = hash_init_strptr(offsetof(stmt_cache_entry_t, sql));
     if (!stmt_cache->hash) {
         logmsg(LOGMSG_ERROR, "%s:%d failed to initialized stmt_cache\n",
                __func__, __LINE__);
@@ -110,7 +148,7 @@ static int stmt_cache_requeue_entry(stmt_cache_t *stmt_cache,
         return -1;
     }
 
-    if (hash_find(stmt_cache->hash, entry->sql) != NULL) {
+    if (hash_find(stmt_cache->hash, &entry->sql) != NULL) {
         return -1; // already there, don't add again
     }
 
@@ -138,6 +176,8 @@ static void stmt_cache_free_entry(stmt_cache_entry_t *entry)
         free(entry->query);
         entry->query = NULL;
     }
+    if (entry->sql)
+        shared_sql_put(entry->sql);
     sqlite3_free(entry);
 }
 
@@ -176,7 +216,7 @@ static int stmt_cache_remove_entry(stmt_cache_t *stmt_cache,
     void *list = GET_STMT_LIST(stmt_cache, entry->stmt);
 
     listc_maybe_rfl(list, entry);
-    int rc = hash_del(stmt_cache->hash, entry->sql);
+    int rc = hash_del(stmt_cache->hash, entry);
     if (!noComplain && rc) {
         logmsg(LOGMSG_ERROR, "%s:%d failed to delete entry (rc: %d)\n",
                __func__, __LINE__, rc);
@@ -204,19 +244,27 @@ int stmt_cache_add_entry(stmt_cache_t *stmt_cache, const char *sql,
 
     /* stored procedure can call same stmt from a lua thread more than once so
      * we should not add stmt that exists already */
-    if (hash_find(stmt_cache->hash, sql) != NULL) {
+    if (hash_find(stmt_cache->hash, &sql) != NULL) {
         return -1;
     }
 
     void *list = GET_STMT_LIST(stmt_cache, stmt);
 
-    /* remove older entries to make room for new ones */
-    if (gbl_max_sqlcache <= listc_size(list)) {
+    /* remove older entries to make room for new ones, and any over what
+     * the memory governor lets us keep */
+    int max = memgov_sqlcache_limit();
+    while (listc_size(list) > 0 && max <= listc_size(list)) {
         stmt_cache_delete_last_entry(stmt_cache, list);
     }
 
     stmt_cache_entry_t *entry = sqlite3_malloc(sizeof(stmt_cache_entry_t));
-    strncpy(entry->sql, sql, MAX_HASH_SQL_LENGTH - 1);
+    if (!entry)
+        return -1;
+    entry->query = NULL;
+    if ((entry->sql = shared_sql_get(sql)) == NULL) {
+        sqlite3_free(entry);
+        return -1;
+    }
     entry->stmt = stmt;
 
     query_data_func(clnt, &entry->stmt_data, &entry->stmt_data_sz,
@@ -230,7 +278,11 @@ int stmt_cache_add_entry(stmt_cache_t *stmt_cache, const char *sql,
     else
         entry->query = NULL;
 
-    return stmt_cache_requeue_entry(stmt_cache, entry);
+    if (stmt_cache_requeue_entry(stmt_cache, entry)) {
+        stmt_cache_free_entry(entry);
+        return -1;
+    }
+    return 0;
 }
 
 int stmt_cache_find_entry(stmt_cache_t *stmt_cache, const char *sql,
@@ -242,7 +294,7 @@ int stmt_cache_find_entry(stmt_cache_t *stmt_cache, const char *sql,
     if (strlen(sql) >= MAX_HASH_SQL_LENGTH)
         return -1;
 
-    *entry = hash_find(stmt_cache->hash, sql);
+    *entry = hash_find(stmt_cache->hash, &sql);
 
     if (*entry == NULL)
         return -1;
@@ -264,6 +316,53 @@ int stmt_cache_reset(stmt_cache_t *stmt_cache)
     return 0;
 }
 
+/* A table version saved in the engine schema is behind its dbtable */
+static int stmt_table_is_stale(Table *tab)
+{
+    struct dbtable *db;
+
+    if (tab->pSelect || (db = get_dbtable_by_name(tab->zName)) == NULL)
+        return 0;
+    return tab->version != (int)db->tableversion;
+}
+
+static int stmt_uses_stale_table(sqlite3_stmt *stmt)
+{
+    Vdbe *v = (Vdbe *)stmt;
+
+    for (int i = 0; i < v->numTables; i++) {
+        if (stmt_table_is_stale(v->tbls[i]))
+            return 1;
+    }
+    return 0;
+}
+
+/* Finalize the cached statements that use a table changed since the engine
+ * schema was parsed; call before bringing the schema table versions up to
+ * date */
+void stmt_cache_invalidate_stale(stmt_cache_t *stmt_cache)
+{
+    stmt_cache_entry_t *entry, *tmp;
+
+    if (!stmt_cache)
+        return;
+
+    LISTC_FOR_EACH_SAFE(&stmt_cache->param_stmt_list, entry, tmp, lnk)
+    {
+        if (stmt_uses_stale_table(entry->stmt)) {
+            stmt_cache_remove_entry(stmt_cache, entry, 0);
+            stmt_cache_finalize_entry(entry);
+        }
+    }
+    LISTC_FOR_EACH_SAFE(&stmt_cache->noparam_stmt_list, entry, tmp, lnk)
+    {
+        if (stmt_uses_stale_table(entry->stmt)) {
+            stmt_cache_remove_entry(stmt_cache, entry, 0);
+            stmt_cache_finalize_entry(entry);
+        }
+    }
+}
+
 /** Table which stores sql strings and sql hints
  * We will hit this table if the thread running the queries from
  * certain sql control changes.
@@ -479,6 +578,7 @@ int stmt_cache_get(struct sqlthdstate *thd, struct sqlclntstate *clnt,
             rec->stmt = rec->stmt_entry->stmt;
         }
     }
+    memgov_note_sqlcache_lookup(rec->stmt != NULL);
 
     if (rec->stmt) {
         rec->sql = sqlite3_sql(rec->stmt); // save expanded query
@@ -55,7 +55,7 @@ typedef int(plugin_query_data_func)(struct sqlclntstate *, void **, int *, int,
                                     int);
 
 typedef struct stmt_cache_entry {
-    char sql[MAX_HASH_SQL_LENGTH];
+    char *sql; /* shared by all the engines caching this statement */
     char *query;
     sqlite3_stmt *stmt;
 
@@ -88,6 +88,7 @@ struct sql_state {
 stmt_cache_t *stmt_cache_new(stmt_cache_t *);
 int stmt_cache_delete(stmt_cache_t *);
 int stmt_cache_reset(stmt_cache_t *);
+void stmt_cache_invalidate_stale(stmt_cache_t *);
 int stmt_cache_get(struct sqlthdstate *, struct sqlclntstate *,
                    struct sql_state *, int);
 int stmt_cache_put(struct sqlthdstate *, struct sqlclntstate *,
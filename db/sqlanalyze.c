@@ -63,6 +63,10 @@ static int analyze_hard_max_table_threads = 15;
 /* maximum number of analyze-table threads */
 int analyze_max_table_threads = 5;
 
+/* analyze of the whole database skips tables whose writes since their
+ * last analyze are below this percentage of their rows; 0 disables */
+int gbl_analyze_incremental_pct = 0;
+
 /* current number of analyze-sampling threads */
 static int analyze_cur_table_threads = 0;
 
@@ -1153,6 +1157,21 @@ int analyze_database(SBUF2 *sb, int scale, int override_llmeta)
             continue;
         }
 
+        /* skip tables with current statistics */
+        if (gbl_analyze_incremental_pct > 0 &&
+            thedb->master == gbl_myhostname) {
+            double pct = auto_analyze_changed_percent(thedb->dbs[i]);
+            if (pct >= 0 && pct < gbl_analyze_incremental_pct) {
+                sbuf2printf(sb, "?Table '%s' changed %.2f%% since its last "
+                                "analyze, skipping\n",
+                            thedb->dbs[i]->tablename, pct);
+                logmsg(LOGMSG_INFO, "analyze: table '%s' changed %.2f%%, "
+                                    "skipping\n",
+                       thedb->dbs[i]->tablename, pct);
+                continue;
+            }
+        }
+
         /* initialize table-descriptor */
         td[idx].table_state = TABLE_STARTUP;
         td[idx].sb = sb;
@@ -392,6 +392,17 @@ static void describe_cursor(Vdbe *v, int pc, struct cursor_info *cur)
     }
 }
 
+/* An index cursor is covering unless the program seeks the table to the
+ * rowid it stands on */
+static int index_cursor_is_covering(Vdbe *v, int iIdxCur)
+{
+    for (int i = 0; i < v->nOp; i++) {
+        if (v->aOp[i].opcode == OP_DeferredSeek && v->aOp[i].p1 == iIdxCur)
+            return 0;
+    }
+    return 1;
+}
+
 /*
 ** Parameter azArray points to a zero-terminated array of strings. zStr
 ** points to a single nul-terminated string. Return non-zero if zStr
@@ -833,8 +844,8 @@ void get_one_explain_line(sqlite3 *hndl, strbuf *out, Vdbe *v, int indent,
         strbuf_appendf(out, "Open read cursor [%d] if not already open on ",
                        op->p1);
         int is_index = print_cursor_description(out, &cur[op->p1]);
-        if (is_index && op->opcode == OP_OpenRead) {
-            if (op->p5 == 0xff) {
+        if (is_index) {
+            if (!index_cursor_is_covering(v, op->p1)) {
                 strbuf_append(out, "(not a covering index)");
             } else {
                 strbuf_append(out, "(covering index)");
@@ -848,8 +859,8 @@ void get_one_explain_line(sqlite3 *hndl, strbuf *out, Vdbe *v, int indent,
         strbuf_appendf(out, "Open %s cursor [%d] on ",
                        (op->opcode != OP_OpenWrite ? "read" : "write"), op->p1);
         is_index = print_cursor_description(out, &cur[op->p1]);
-        if (is_index && op->opcode == OP_OpenRead) {
-            if (op->p5 == 0xff) {
+        if (is_index && op->opcode != OP_OpenWrite) {
+            if (!index_cursor_is_covering(v, op->p1)) {
                 strbuf_append(out, "(not a covering index)");
             } else {
                 strbuf_append(out, "(covering index)");
@@ -877,6 +888,8 @@ void get_one_explain_line(sqlite3 *hndl, strbuf *out, Vdbe *v, int indent,
         }
         if (op->p5 == BTREE_UNORDERED) {
             strbuf_append(out, " [Hash table]");
+        } else if (op->p5 & BTREE_HASHED) {
+            strbuf_appendf(out, " [Hash table on %d columns]", op->p3);
         }
         break;
     }
@@ -1235,7 +1248,7 @@ int newsql_dump_query_plan(struct sqlclntstate *clnt, sqlite3 *hndl)
     FILE *f = NULL;
 
     //if verbose explain get costs dumped to tmpfile by setting wheretrace
-    if (clnt->is_explain == 2) {
+    if (clnt->is_explain == EXPLAIN_VERBOSE) {
         sqlite3WhereTrace = clnt->where_trace_flags;
         f = tmpfile();
         if (f == NULL) {
@@ -1315,3 +1328,81 @@ int newsql_dump_query_plan(struct sqlclntstate *clnt, sqlite3 *hndl)
     return 0;
 }
 
+
+/* "set explain analyze": the statement ran with its rows discarded; send what
+   each loop and each table or index actually did instead */
+void explain_analyze_report(struct sqlclntstate *clnt, sqlite3_stmt *stmt,
+                            struct sql_thread *thd, int64_t nrows)
+{
+    struct query_path_component *qc;
+    strbuf *out = strbuf_new();
+    char *row[1];
+    int i;
+
+    for (i = 0; 1; i++) {
+        sqlite3_int64 nLoop, nVisit;
+        double rEst;
+        int iSid;
+        const char *zExplain;
+        if (sqlite3_stmt_scanstatus(stmt, i, SQLITE_SCANSTAT_NLOOP,
+                                    (void *)&nLoop))
+            break;
+        sqlite3_stmt_scanstatus(stmt, i, SQLITE_SCANSTAT_SELECTID,
+                                (void *)&iSid);
+        sqlite3_stmt_scanstatus(stmt, i, SQLITE_SCANSTAT_NVISIT,
+                                (void *)&nVisit);
+        sqlite3_stmt_scanstatus(stmt, i, SQLITE_SCANSTAT_EST, (void *)&rEst);
+        sqlite3_stmt_scanstatus(stmt, i, SQLITE_SCANSTAT_EXPLAIN,
+                                (void *)&zExplain);
+        strbuf_clear(out);
+        strbuf_appendf(out,
+                       "Loop %d (select %d): %s: loops %lld, rows %lld, "
+                       "estimated rows per loop %g",
+                       i + 1, iSid, zExplain, (long long)nLoop,
+                       (long long)nVisit, rEst);
+        row[0] = (char *)strbuf_buf(out);
+        write_response(clnt, RESPONSE_ROW_STR, row, 1);
+    }
+
+    if (thd) {
+        LISTC_FOR_EACH(&thd->query_stats, qc, lnk)
+        {
+            struct dbtable *tbl;
+            const struct cursor_actuals *a = &qc->actual;
+
+            strbuf_clear(out);
+            if (qc->rmt_db[0]) {
+                strbuf_appendf(out, "Remote %s.%s", qc->rmt_db,
+                               qc->lcl_tbl_name);
+            } else if (qc->ix < 0) {
+                strbuf_appendf(out, "Table %s", qc->lcl_tbl_name);
+            } else if ((tbl = get_dbtable_by_name(qc->lcl_tbl_name)) &&
+                       qc->ix < tbl->nix) {
+                strbuf_appendf(out, "Index %s.%s", qc->lcl_tbl_name,
+                               tbl->ixschema[qc->ix]->csctag);
+            } else {
+                strbuf_appendf(out, "Index %s.%d", qc->lcl_tbl_name, qc->ix);
+            }
+            strbuf_appendf(out, ": finds %d, moves %d, writes %d, blobs %d",
+                           qc->nfind, qc->nnext, qc->nwrite, qc->nblobs);
+            if (a->fgets)
+                strbuf_appendf(out, ", pages %" PRId64 " (%" PRId64
+                                    " hit, %" PRId64 " read)",
+                               a->fgets, a->fgets - a->preads, a->preads);
+            else
+                strbuf_appendf(out, ", pages read %" PRId64, a->preads);
+            strbuf_appendf(out,
+                           ", lock waits %" PRId64 " (%" PRId64
+                           " us), time %" PRId64 " us",
+                           a->nlockwaits, a->lockwait_us, a->time_us);
+            row[0] = (char *)strbuf_buf(out);
+            write_response(clnt, RESPONSE_ROW_STR, row, 1);
+        }
+    }
+
+    strbuf_clear(out);
+    strbuf_appendf(out, "Rows returned %" PRId64, nrows);
+    row[0] = (char *)strbuf_buf(out);
+    write_response(clnt, RESPONSE_ROW_STR, row, 1);
+    strbuf_free(out);
+}
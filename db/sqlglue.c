@@ -61,6 +61,7 @@
 #include <sbuf2.h>
 
 #include <bdb_api.h>
+#include "thread_stats.h"
 #include <bdb_cursor.h>
 #include <bdb_fetch.h>
 #include <bdb_int.h>
@@ -107,6 +108,7 @@
 #include "comdb2_query_preparer.h"
 #include <portmuxapi.h>
 #include "cdb2_constants.h"
+#include "zonemap.h"
 
 int gbl_delay_sql_lock_release_sec = 5;
 
@@ -171,6 +173,10 @@ static int ddguard_bdb_cursor_move(struct sql_thread *thd, BtCursor *pCur,
                                    struct ireq *iq_do_prefault,
                                    int freshcursor);
 static int is_sql_update_mode(int mode);
+static int cursor_move_postop(BtCursor *pCur);
+static int cursor_zonemap_skip(struct sql_thread *thd, BtCursor *pCur,
+                               int *batched, int *bdberr);
+static void cursor_zonemap_free(BtCursor *pCur);
 static int queryOverlapsCursors(struct sqlclntstate *clnt, BtCursor *pCur);
 
 enum { AUTHENTICATE_READ = 1, AUTHENTICATE_WRITE = 2 };
@@ -2205,6 +2211,7 @@ struct schema_mem {
     struct schema *sc;
     Mem *min;
     Mem *mout;
+    unsigned long long *keys; /* bit i set if column i is not NULL */
 };
 
 /**
@@ -2597,6 +2604,187 @@ static int get_matching_genid(BtCursor *cur, int rrn, unsigned long long *genid)
     return 0;
 }
 
+/* Read-only table scans fetch this many bytes of rows per bdb call */
+int gbl_sql_cursor_batch_bytes = 0;
+
+/**
+ * Rows a table cursor fetched ahead of sqlite.  The bdb cursor stands on the
+ * last buffered row, so once the buffer is drained the scan simply moves on.
+ */
+struct cursor_batch {
+    bdb_cursor_batch_row_t *rows;
+    uint8_t *data;
+    int rowsz;
+    int maxrows;
+    int nrows;       /* rows buffered */
+    int pos;         /* next row to serve */
+    int tail_rc;     /* rc of the move that ended the batch, 0 if it filled */
+    int tail_bdberr; /* -- " -- */
+    int nexts;       /* consecutive nexts, batching starts after a few */
+};
+
+static int cursor_batch_ok(BtCursor *pCur)
+{
+    return gbl_sql_cursor_batch_bytes > 0 &&
+           pCur->cursor_class == CURSORCLASS_TABLE && pCur->bdbcur &&
+           !pCur->writeTransaction && !pCur->is_recording &&
+           !pCur->is_btree_count;
+}
+
+static void cursor_batch_free(BtCursor *pCur)
+{
+    if (!pCur->batch)
+        return;
+    free(pCur->batch->rows);
+    free(pCur->batch->data);
+    free(pCur->batch);
+    pCur->batch = NULL;
+}
+
+static inline void cursor_batch_reset(BtCursor *pCur)
+{
+    if (pCur->batch) {
+        pCur->batch->nrows = pCur->batch->pos = 0;
+        pCur->batch->tail_rc = pCur->batch->tail_bdberr = 0;
+        pCur->batch->nexts = 0;
+    }
+}
+
+static inline int cursor_batch_pending(BtCursor *pCur)
+{
+    return pCur->batch && (pCur->batch->pos < pCur->batch->nrows ||
+                           pCur->batch->tail_rc);
+}
+
+static int cursor_batch_fill(struct sql_thread *thd, BtCursor *pCur)
+{
+    struct cursor_batch *cb = pCur->batch;
+    int rowsz = getdatsize(pCur->db);
+    int maxrows = gbl_sql_cursor_batch_bytes / rowsz;
+    int bdberr = 0;
+    int rc;
+
+    if (maxrows < 2)
+        return -1;
+
+    if (!cb) {
+        cb = pCur->batch = calloc(1, sizeof(struct cursor_batch));
+        if (!cb)
+            return -1;
+    }
+    if (cb->rowsz != rowsz || cb->maxrows != maxrows) {
+        free(cb->rows);
+        free(cb->data);
+        cb->rows = malloc(maxrows * sizeof(bdb_cursor_batch_row_t));
+        cb->data = malloc((size_t)maxrows * rowsz);
+        if (!cb->rows || !cb->data) {
+            cursor_batch_free(pCur);
+            return -1;
+        }
+        cb->rowsz = rowsz;
+        cb->maxrows = maxrows;
+    }
+
+    if (authenticate_cursor(pCur, AUTHENTICATE_READ) != 0)
+        return -1;
+
+    rc = pCur->bdbcur->next_batch(pCur->bdbcur, maxrows, rowsz, cb->rows,
+                                  cb->data, &cb->nrows, &bdberr);
+    cb->pos = 0;
+    cb->tail_rc = rc;
+    cb->tail_bdberr = bdberr;
+
+    if (bdberr == BDBERR_DEADLOCK) {
+        /* don't sit on the locks while the buffer drains; the bdb cursor
+           repositions on its last row when it is relocked */
+        rc = recover_deadlock(thedb->bdb_env, thd, NULL, 0);
+        if (rc) {
+            cb->tail_rc = -1;
+            cb->tail_bdberr = (rc == SQLITE_CLIENT_CHANGENODE)
+                                  ? BDBERR_NOT_DURABLE
+                                  : BDBERR_DEADLOCK;
+        } else {
+            cb->tail_rc = cb->tail_bdberr = 0;
+        }
+    } else if (bdberr == 0) {
+        rc = cursor_move_postop(pCur);
+        if (rc) {
+            cb->tail_rc = (rc < 0) ? SQLITE_BUSY : rc;
+            cb->tail_bdberr = (rc == SQLITE_CLIENT_CHANGENODE)
+                                  ? BDBERR_NOT_DURABLE
+                                  : BDBERR_DEADLOCK;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Serve a next from the batch, filling it if needed.  Returns 1 if a
+ * buffered row was served, 2 if the move that ended the batch is replayed
+ * (*rc and *bdberr are set; for a found rc the bdb cursor stands on the
+ * row), and 0 if the caller has to move the bdb cursor itself.
+ */
+static int cursor_batch_next(struct sql_thread *thd, BtCursor *pCur, int *rc,
+                             int *bdberr)
+{
+    struct cursor_batch *cb = pCur->batch;
+
+    if (!cb || (cb->pos >= cb->nrows && cb->tail_rc == 0)) {
+        if (!cursor_batch_ok(pCur))
+            return 0;
+        if (!cb || cb->nexts < bdb_attr_get(thedb->bdb_attr,
+                                            BDB_ATTR_BULK_SQL_THRESHOLD)) {
+            if (!cb)
+                cb = pCur->batch = calloc(1, sizeof(struct cursor_batch));
+            if (cb)
+                cb->nexts++;
+            return 0;
+        }
+        if (cursor_batch_fill(thd, pCur))
+            return 0;
+        cb = pCur->batch;
+        if (cb->nrows == 0 && cb->tail_rc == 0)
+            return 0; /* recovered a deadlock before the first row */
+    }
+
+    if (cb->pos < cb->nrows) {
+        *rc = IX_FND;
+        return 1;
+    }
+
+    *rc = cb->tail_rc;
+    *bdberr = cb->tail_bdberr;
+    cb->nrows = cb->pos = 0;
+    cb->tail_rc = cb->tail_bdberr = 0;
+    return 2;
+}
+
+/**
+ * Any move other than next ends batching; the bdb cursor is ahead of sqlite
+ * if rows are still buffered, so move it back before a prev.
+ */
+static int cursor_batch_drop(struct sql_thread *thd, BtCursor *pCur, int how)
+{
+    unsigned long long genid = pCur->genid;
+    int pending = cursor_batch_pending(pCur);
+    int bdberr = 0;
+    int rc;
+
+    cursor_batch_reset(pCur);
+    if (!pending || how != CPREV)
+        return 0;
+
+    rc = ddguard_bdb_cursor_find(thd, pCur, pCur->bdbcur, &genid,
+                                 sizeof(genid), 0, 0, &bdberr);
+    if (rc != IX_FND) {
+        logmsg(LOGMSG_ERROR, "%s: failed to reposition on %llx rc %d bdberr %d\n",
+               __func__, genid, rc, bdberr);
+        return (bdberr == BDBERR_DEADLOCK) ? SQLITE_DEADLOCK : SQLITE_INTERNAL;
+    }
+    return 0;
+}
+
 static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
 {
     struct sql_thread *thd = pCur->thd;
@@ -2605,6 +2793,7 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
     int done = 0;
     int rc = SQLITE_OK;
     int outrc = SQLITE_OK;
+    int batched = 0;
     uint8_t ver;
 
     if (access_control_check_sql_read(pCur, thd)) {
@@ -2632,7 +2821,18 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
         thd->nmove++;
 
     bdberr = 0;
-    rc = ddguard_bdb_cursor_move(thd, pCur, 0, &bdberr, how, NULL, 0);
+    if (how == CNEXT) {
+        batched = cursor_batch_next(thd, pCur, &rc, &bdberr);
+    } else if (pCur->batch) {
+        rc = cursor_batch_drop(thd, pCur, how);
+        if (rc)
+            return rc;
+    }
+    if (!batched)
+        rc = ddguard_bdb_cursor_move(thd, pCur, 0, &bdberr, how, NULL, 0);
+    if (pCur->zonemap && (how == CFIRST || how == CNEXT) && rc == IX_FND &&
+        bdberr == 0)
+        rc = cursor_zonemap_skip(thd, pCur, &batched, &bdberr);
     switch(bdberr) {
     case BDBERR_NOT_DURABLE: return SQLITE_CLIENT_CHANGENODE;
     case BDBERR_TRANTOOCOMPLEX: return SQLITE_TRANTOOCOMPLEX;
@@ -2661,8 +2861,19 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
                buf = pCur->bdbcur->data(pCur->bdbcur);
                ver = pCur->bdbcur->ver(pCur->bdbcur);
              */
-            pCur->bdbcur->get_found_data(pCur->bdbcur, &pCur->rrn, &pCur->genid,
-                                         &sz, &buf, &ver);
+            if (batched == 1) {
+                struct cursor_batch *cb = pCur->batch;
+                bdb_cursor_batch_row_t *row = &cb->rows[cb->pos];
+                pCur->rrn = row->rrn;
+                pCur->genid = row->genid;
+                sz = row->datalen;
+                buf = cb->data + (size_t)cb->pos * cb->rowsz;
+                ver = row->ver;
+                cb->pos++;
+            } else {
+                pCur->bdbcur->get_found_data(pCur->bdbcur, &pCur->rrn,
+                                             &pCur->genid, &sz, &buf, &ver);
+            }
             vtag_to_ondisk_vermap(pCur->db, buf, &sz, ver);
             if (sz > getdatsize(pCur->db)) {
                 /* This shouldn't happen, but check anyway */
@@ -2726,6 +2937,29 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
     return outrc;
 }
 
+/* Convert the ondisk key the index cursor stands on into keybuf, if that
+ * was deferred by the last move */
+static int cursor_cook_key(BtCursor *pCur)
+{
+    int rc;
+
+    if (!pCur->keybuf_lazy)
+        return SQLITE_OK;
+    pCur->keybuf_lazy = 0;
+
+    rc = ondisk_to_sqlite_tz(pCur->db, pCur->sc, pCur->lastkey /* in */,
+                             pCur->rrn, pCur->genid, pCur->keybuf /* out */,
+                             pCur->keybuf_alloc, 0, NULL, NULL, NULL,
+                             &pCur->keybuflen, pCur->clnt->tzname, pCur);
+    if (rc) {
+        /* keys are always fixed length, so -2 should be impossible */
+        logmsg(LOGMSG_ERROR, "%s: ondisk_to_sqlite_tz error rc = %d\n",
+               __func__, rc);
+        return SQLITE_INTERNAL;
+    }
+    return SQLITE_OK;
+}
+
 static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
 {
     struct sql_thread *thd = pCur->thd;
@@ -2734,7 +2968,6 @@ static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
     int done = 0;
     int rc = SQLITE_OK;
     int outrc = SQLITE_OK;
-    struct sqlclntstate *clnt = thd->clnt;
 
     if (access_control_check_sql_read(pCur, thd)) {
         return SQLITE_ACCESS;
@@ -2850,17 +3083,9 @@ static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
         if (unlikely(pCur->is_btree_count))
             return outrc;
 
-        /* if this cursor is on a key, convert key */
-        rc = ondisk_to_sqlite_tz(pCur->db, pCur->sc, pCur->lastkey /* in */,
-                                 pCur->rrn, pCur->genid, pCur->keybuf /* out */,
-                                 pCur->keybuf_alloc, 0, NULL, NULL, NULL,
-                                 &pCur->keybuflen, clnt->tzname, pCur);
-
-        if (rc) {
-            /* keys are always fixed length, so -2 should be impossible */
-           logmsg(LOGMSG_ERROR, "%s: ondisk_to_sqlite_tz error rc = %d\n", __func__, rc);
-            outrc = SQLITE_INTERNAL;
-        }
+        /* the key is converted when the sqlite record is asked for; covered
+         * and raw columns are read straight from lastkey */
+        pCur->keybuf_lazy = 1;
     } else if (rc == IX_ACCESS) {
         outrc = SQLITE_ACCESS;
     } else if (rc) {
@@ -3610,7 +3835,7 @@ int sqlite3BtreeOpen(
         if (rc != SQLITE_OK) goto done;
         assert(masterPgno == 1); /* sqlite_temp_master root page number */
         listc_init(&bt->cursors, offsetof(BtCursor, lnk));
-        if (flags & BTREE_UNORDERED) {
+        if (flags & (BTREE_UNORDERED | BTREE_HASHED)) {
             bt->is_hashtable = 1;
         }
         thd->bttmp = bt;
@@ -4361,7 +4586,7 @@ int sqlite3BtreeKey(BtCursor *pCur, u32 offset, u32 amt, void *pBuf)
         /* this is genid */
         assert(amt == sizeof(pCur->genid));
         memcpy(pBuf, &pCur->genid, sizeof(pCur->genid));
-    } else {
+    } else if ((rc = cursor_cook_key(pCur)) == SQLITE_OK) {
         memcpy(pBuf, ((char *)pCur->keybuf) + offset, amt);
     }
 
@@ -4519,7 +4744,8 @@ i64 sqlite3BtreeIntegerKey(BtCursor *pCur)
         else
             size = pCur->rrn;
     } else {
-        size = pCur->keybuflen;
+        rc = cursor_cook_key(pCur);
+        size = rc ? 0 : pCur->keybuflen;
     }
 
     reqlog_logf(pCur->bt->reqlogger, REQL_TRACE,
@@ -5581,6 +5807,7 @@ cursor_find_remote(BtCursor *pCur,            /* The cursor to be moved */
 static int bias_cmp(bias_info *info, void *found)
 {
     BtCursor *cur = info->cur;
+    cur->keybuf_lazy = 0;
     ondisk_to_sqlite_tz(cur->db, cur->sc, found, cur->rrn, cur->genid,
                         cur->keybuf, cur->keybuf_alloc, 0, NULL, NULL, NULL,
                         &cur->keybuflen, cur->clnt->tzname, cur);
@@ -6118,6 +6345,7 @@ int sqlite3BtreeMovetoUnpacked(BtCursor *pCur, /* The cursor to be moved */
 #endif
             pCur->eof = 0;
             pCur->lastkey = pCur->fndkey;
+            pCur->keybuf_lazy = 0;
             rc = ondisk_to_sqlite_tz(pCur->db, pCur->sc, pCur->fndkey,
                                      pCur->rrn, pCur->genid, pCur->keybuf,
                                      pCur->keybuf_alloc, 0, NULL, NULL, NULL,
@@ -6249,6 +6477,10 @@ const void *sqlite3BtreeKeyFetch(BtCursor *pCur, u32 *pAmt)
         *pAmt = bdb_temp_table_keysize(pCur->tmptable->cursor);
         goto done;
     }
+    if (cursor_cook_key(pCur)) {
+        *pAmt = 0;
+        goto done;
+    }
     out = pCur->keybuf;
     *pAmt = pCur->keybuflen;
 done:
@@ -6487,6 +6719,11 @@ int sqlite3BtreeCloseCursor(BtCursor *pCur)
             /* note: we record writes in record routines on the master */
             qc->nwrite += pCur->nwrite;
             qc->nblobs += pCur->nblobs;
+            qc->actual.fgets += pCur->actual.fgets;
+            qc->actual.preads += pCur->actual.preads;
+            qc->actual.nlockwaits += pCur->actual.nlockwaits;
+            qc->actual.lockwait_us += pCur->actual.lockwait_us;
+            qc->actual.time_us += pCur->actual.time_us;
         }
     }
 
@@ -6521,6 +6758,8 @@ skip:
             free(pCur->dtabuf);
         }
         free(pCur->keybuf);
+        cursor_batch_free(pCur);
+        cursor_zonemap_free(pCur);
 
         if (pCur->is_sampled_idx) {
             rc = sampler_close(pCur->sampler);
@@ -6802,6 +7041,71 @@ int is_datacopy(BtCursor *pCur, int *fnum)
     return 0;
 }
 
+/* Decoders for the fixed-width numeric fields that column scans read most.
+   They give the same result as SERVER_BINT_to_CLIENT_INT and
+   SERVER_BREAL_to_CLIENT_REAL into a native 8 byte integer or double,
+   without going through the generic converters. */
+static inline int get_data_bint(const uint8_t *in, int len, i64 *out)
+{
+    switch (len) {
+    case 3: {
+        uint16_t v;
+        memcpy(&v, &in[1], sizeof(v));
+        *out = (int16_t)(ntohs(v) ^ 0x8000U);
+        return 0;
+    }
+    case 5: {
+        uint32_t v;
+        memcpy(&v, &in[1], sizeof(v));
+        *out = (int32_t)(ntohl(v) ^ 0x80000000UL);
+        return 0;
+    }
+    case 9: {
+        uint64_t v;
+        memcpy(&v, &in[1], sizeof(v));
+        *out = (int64_t)(flibc_ntohll(v) ^ 0x8000000000000000ULL);
+        return 0;
+    }
+    }
+    return -1;
+}
+
+static inline int get_data_breal(const uint8_t *in, int len, double *out)
+{
+    switch (len) {
+    case 5: {
+        uint32_t v;
+        float f;
+        memcpy(&v, &in[1], sizeof(v));
+        v = ntohl(v);
+        v ^= ((v >> 31) - 1) | 0x80000000U;
+        memcpy(&f, &v, sizeof(f));
+        *out = f;
+        return 0;
+    }
+    case 9: {
+        uint64_t v;
+        memcpy(&v, &in[1], sizeof(v));
+        v = flibc_ntohll(v);
+        v ^= ((v >> 63) - 1) | 0x8000000000000000ULL;
+        memcpy(out, &v, sizeof(*out));
+        return 0;
+    }
+    }
+    return -1;
+}
+
+/* A blob whose content is never looked at: length() and typeof() only need
+ * its size, which the row has, so leave the blob btree alone and hand sqlite
+ * a zero-filled blob of that size. */
+static void blob_nofetch_mem(Mem *m, int len)
+{
+    m->z = NULL;
+    m->n = 0;
+    m->u.nZero = len;
+    m->flags = MEM_Blob | MEM_Zero;
+}
+
 int get_data(BtCursor *pCur, struct schema *sc, uint8_t *in, int fnum, Mem *m,
              uint8_t flip_orig, const char *tzname)
 {
@@ -6874,31 +7178,19 @@ int get_data(BtCursor *pCur, struct schema *sc, uint8_t *in, int fnum, Mem *m,
         break;
 
     case SERVER_BINT:
-        rc = SERVER_BINT_to_CLIENT_INT(
-            in, f->len, NULL /*convopts */, NULL /*blob */, &ival, sizeof(ival),
-            &null, &outdtsz, &convopts, NULL /*blob */);
-        m->u.i = ival;
-        if (rc == -1)
+        /* null was checked above */
+        if ((rc = get_data_bint(in, f->len, &ival)) != 0)
             goto done;
-        if (null) {
-            m->flags = MEM_Null;
-        } else {
-            m->flags = MEM_Int;
-        }
+        m->u.i = ival;
+        m->flags = MEM_Int;
         break;
 
     case SERVER_BREAL: {
         double dval = 0;
-        rc = SERVER_BREAL_to_CLIENT_REAL(
-            in, f->len, NULL /*convopts */, NULL /*blob */, &dval, sizeof(dval),
-            &null, &outdtsz, &convopts, NULL /*blob */);
-        m->u.r = dval;
-        if (rc == -1)
+        if ((rc = get_data_breal(in, f->len, &dval)) != 0)
             goto done;
-        if (null)
-            m->flags = MEM_Null;
-        else
-            m->flags = MEM_Real;
+        m->u.r = dval;
+        m->flags = MEM_Real;
         break;
     }
     case SERVER_BCSTR:
@@ -7106,6 +7398,8 @@ int get_data(BtCursor *pCur, struct schema *sc, uint8_t *in, int fnum, Mem *m,
 
             /*fprintf(stderr, "m->n = %d\n", m->n); */
             m->flags = MEM_Blob;
+        } else if (pCur->blob_nofetch) {
+            blob_nofetch_mem(m, len);
         } else
             rc = fetch_blob_into_sqlite_mem(pCur, sc, fnum, m, record);
 
@@ -7130,6 +7424,11 @@ int get_data(BtCursor *pCur, struct schema *sc, uint8_t *in, int fnum, Mem *m,
 
             /*fprintf(stderr, "m->n = %d\n", m->n); */
             m->flags = MEM_Str | MEM_Ephem;
+        } else if (pCur->blob_nofetch & OPFLAG_TYPEOFARG) {
+            /* length() counts characters, so only typeof() can skip it */
+            m->z = "";
+            m->n = 0;
+            m->flags = MEM_Str | MEM_Static;
         } else
             rc = fetch_blob_into_sqlite_mem(pCur, sc, fnum, m, record);
         break;
@@ -7146,6 +7445,8 @@ int get_data(BtCursor *pCur, struct schema *sc, uint8_t *in, int fnum, Mem *m,
             m->z = NULL;
             m->flags = MEM_Blob;
             m->n = 0;
+        } else if (pCur->blob_nofetch) {
+            blob_nofetch_mem(m, len);
         } else {
             rc = fetch_blob_into_sqlite_mem(pCur, sc, fnum, m, record);
         }
@@ -7442,6 +7743,113 @@ static int lk_tmptbl_cursor_count(BtCursor *btcursor, i64 *count)
     return rc;
 }
 
+/* Walks the fields of the record in a hash temptable key, which is an int
+   length followed by the record itself */
+struct hashkey_fields {
+    const unsigned char *rec;
+    u32 len;
+    u32 hdrsz;
+    u32 hdroff;
+    u32 off;
+};
+
+static void hashkey_fields_init(struct hashkey_fields *f, const void *key)
+{
+    f->len = *(const int *)key;
+    f->rec = (const unsigned char *)key + sizeof(int);
+    f->hdroff = getVarint32(f->rec, f->hdrsz);
+    f->off = f->hdrsz;
+}
+
+static int hashkey_fields_next(struct hashkey_fields *f, Mem *m)
+{
+    u32 type;
+    if (f->hdroff >= f->hdrsz)
+        return 0;
+    f->hdroff += getVarint32(f->rec + f->hdroff, type);
+    if (f->off + sqlite3VdbeSerialTypeLen(type) > f->len)
+        return 0;
+    m->db = NULL;
+    m->enc = SQLITE_UTF8;
+    f->off += sqlite3VdbeSerialGet(f->rec + f->off, type, m);
+    return 1;
+}
+
+/* Hash the first nField fields of a transient index key.  Values that
+   sqlite3MemCompare() finds equal must hash alike: integral reals hash as
+   the integer, and types compared by conversion share one bucket. */
+static unsigned int hashkey_prefix_hash(const void *key, int nField)
+{
+    struct hashkey_fields f;
+    unsigned int h = 0;
+    Mem m;
+    int i;
+
+    hashkey_fields_init(&f, key);
+    for (i = 0; i < nField && hashkey_fields_next(&f, &m); i++) {
+        unsigned int fh;
+        if (m.flags & MEM_Int) {
+            fh = hash_default_fixedwidth((unsigned char *)&m.u.i,
+                                         sizeof(m.u.i));
+        } else if (m.flags & MEM_Real) {
+            i64 iv = (i64)m.u.r;
+            if (m.u.r > -9.2e18 && m.u.r < 9.2e18 && (double)iv == m.u.r)
+                fh = hash_default_fixedwidth((unsigned char *)&iv, sizeof(iv));
+            else
+                fh = hash_default_fixedwidth((unsigned char *)&m.u.r,
+                                             sizeof(m.u.r));
+        } else if (m.flags & (MEM_Str | MEM_Blob)) {
+            fh = hash_default_fixedwidth((unsigned char *)m.z, m.n);
+        } else if (m.flags & MEM_Null) {
+            fh = 0;
+        } else {
+            fh = 1;
+        }
+        h = h * 31 + fh;
+    }
+    return h;
+}
+
+static int hashkey_prefix_cmp(const void *key1, const void *key2, int nField)
+{
+    struct hashkey_fields f1, f2;
+    Mem m1, m2;
+    int i;
+
+    hashkey_fields_init(&f1, key1);
+    hashkey_fields_init(&f2, key2);
+    for (i = 0; i < nField; i++) {
+        int more1 = hashkey_fields_next(&f1, &m1);
+        int more2 = hashkey_fields_next(&f2, &m2);
+        if (!more1 || !more2)
+            return more1 - more2;
+        if (sqlite3MemCompare(&m1, &m2, NULL))
+            return 1;
+    }
+    return 0;
+}
+
+/*
+** Hash the transient index opened by pCur on the first nField columns of
+** its keys, so that an equality seek on those columns finds its matches
+** with a hash lookup; see constructAutomaticIndex().  Large indexes spill
+** into an ordered temp table, which serves the same seeks.
+*/
+int sqlite3BtreeSetHashPrefix(BtCursor *pCur, int nField)
+{
+    if (!pCur->bt->is_temporary || !bdb_is_hashtable(pCur->tmptable->tbl))
+        return SQLITE_OK;
+    if (bdb_temp_hashtable_set_hash(pCur->tmptable->tbl, hashkey_prefix_hash,
+                                    hashkey_prefix_cmp, nField)) {
+        logmsg(LOGMSG_ERROR, "%s: failed to hash on %d fields\n", __func__,
+               nField);
+        return SQLITE_INTERNAL;
+    }
+    reqlog_logf(pCur->bt->reqlogger, REQL_TRACE,
+                "SetHashPrefix(pCur %d, nField %d)\n", pCur->cursorid, nField);
+    return SQLITE_OK;
+}
+
 static int
 sqlite3BtreeCursor_temptable(Btree *pBt,      /* The btree */
                              int iTable,      /* Root page of table to open */
@@ -7840,7 +8248,7 @@ static int sqlite3LockStmtTables_int(sqlite3_stmt *pStmt, int after_recovery)
             db->nsql++; /* per table nsql stats */
         }
 
-        reqlog_add_table(thrman_get_reqlogger(thrman_self()), db->tablename);
+        reqlog_add_table(thrman_get_reqlogger(thrman_self()), db->interned_name);
     }
 
     if (!after_recovery)
@@ -8817,7 +9225,8 @@ int sqlite3BtreeInsert(
             logmsg(LOGMSG_ERROR, 
                    "sqlite3BtreeInsert:  table insert error rc = %d bdberr %d\n",
                    rc, bdberr);
-            rc = SQLITE_INTERNAL;
+            rc = (bdberr == BDBERR_TEMPTABLE_FULL) ? SQLITE_FULL
+                                                   : SQLITE_INTERNAL;
             /* return rc; */
             goto done;
         }
@@ -10055,9 +10464,11 @@ int recover_deadlock_flags(bdb_state_type *bdb_state, struct sql_thread *thd,
     return rc;
 }
 
-static int ddguard_bdb_cursor_find(struct sql_thread *thd, BtCursor *pCur,
-                                   bdb_cursor_ifn_t *cur, void *key, int keylen,
-                                   int is_temp_bdbcur, int bias, int *bdberr)
+static int ddguard_bdb_cursor_find_int(struct sql_thread *thd,
+                                       BtCursor *pCur, bdb_cursor_ifn_t *cur,
+                                       void *key, int keylen,
+                                       int is_temp_bdbcur, int bias,
+                                       int *bdberr)
 {
     int nretries = 0;
     int max_retries =
@@ -10098,6 +10509,10 @@ static int ddguard_bdb_cursor_find(struct sql_thread *thd, BtCursor *pCur,
         }
     }
 
+    /* the cursor leaves the batched scan */
+    if (pCur->batch && cur == pCur->bdbcur)
+        cursor_batch_reset(pCur);
+
     if (debug_switch_simulate_find_deadlock() && !simulatedeadlock)
         simulatedeadlock = 1;
     if (debug_switch_simulate_find_deadlock_retry() && simulatedeadlock == 2)
@@ -10259,11 +10674,12 @@ static int ddguard_bdb_cursor_find(struct sql_thread *thd, BtCursor *pCur,
     return rc;
 }
 
-static int ddguard_bdb_cursor_find_last_dup(struct sql_thread *thd,
-                                            BtCursor *pCur,
-                                            bdb_cursor_ifn_t *cur, void *key,
-                                            int keylen, int keymax,
-                                            bias_info *info, int *bdberr)
+static int ddguard_bdb_cursor_find_last_dup_int(struct sql_thread *thd,
+                                                BtCursor *pCur,
+                                                bdb_cursor_ifn_t *cur,
+                                                void *key, int keylen,
+                                                int keymax, bias_info *info,
+                                                int *bdberr)
 {
     int bias = info->bias;
     int nretries = 0;
@@ -10465,9 +10881,10 @@ static int ddguard_bdb_cursor_find_last_dup(struct sql_thread *thd,
     return rc;
 }
 
-static int ddguard_bdb_cursor_move(struct sql_thread *thd, BtCursor *pCur,
-                                   int flags, int *bdberr, int how,
-                                   struct ireq *iq_do_prefault, int freshcursor)
+static int ddguard_bdb_cursor_move_int(struct sql_thread *thd,
+                                       BtCursor *pCur, int flags, int *bdberr,
+                                       int how, struct ireq *iq_do_prefault,
+                                       int freshcursor)
 {
     bdb_cursor_ifn_t *cur = pCur->bdbcur;
     int nretries = 0;
@@ -10568,6 +10985,75 @@ static int ddguard_bdb_cursor_move(struct sql_thread *thd, BtCursor *pCur,
     return rc;
 }
 
+struct cursor_op_mark {
+    struct berkdb_thread_stats st;
+    uint64_t start_us;
+};
+
+/* Under "set explain analyze", charge what the thread did in the buffer pool
+   and lock manager during a find or move to the cursor */
+static inline int cursor_op_begin(struct sql_thread *thd,
+                                  struct cursor_op_mark *m)
+{
+    if (!thd->clnt || thd->clnt->is_explain != EXPLAIN_ANALYZE)
+        return 0;
+    m->st = *bdb_get_thread_stats();
+    m->start_us = comdb2_time_epochus();
+    return 1;
+}
+
+static void cursor_op_end(BtCursor *pCur, const struct cursor_op_mark *m)
+{
+    const struct berkdb_thread_stats *st = bdb_get_thread_stats();
+
+    pCur->actual.fgets += st->n_memp_fgets - m->st.n_memp_fgets;
+    pCur->actual.preads += st->n_preads - m->st.n_preads;
+    pCur->actual.nlockwaits += st->n_lock_waits - m->st.n_lock_waits;
+    pCur->actual.lockwait_us += st->lock_wait_time_us - m->st.lock_wait_time_us;
+    pCur->actual.time_us += comdb2_time_epochus() - m->start_us;
+}
+
+static int ddguard_bdb_cursor_find(struct sql_thread *thd, BtCursor *pCur,
+                                   bdb_cursor_ifn_t *cur, void *key, int keylen,
+                                   int is_temp_bdbcur, int bias, int *bdberr)
+{
+    struct cursor_op_mark m;
+    int analyze = cursor_op_begin(thd, &m);
+    int rc = ddguard_bdb_cursor_find_int(thd, pCur, cur, key, keylen,
+                                         is_temp_bdbcur, bias, bdberr);
+    if (analyze)
+        cursor_op_end(pCur, &m);
+    return rc;
+}
+
+static int ddguard_bdb_cursor_find_last_dup(struct sql_thread *thd,
+                                            BtCursor *pCur,
+                                            bdb_cursor_ifn_t *cur, void *key,
+                                            int keylen, int keymax,
+                                            bias_info *info, int *bdberr)
+{
+    struct cursor_op_mark m;
+    int analyze = cursor_op_begin(thd, &m);
+    int rc = ddguard_bdb_cursor_find_last_dup_int(thd, pCur, cur, key, keylen,
+                                                  keymax, info, bdberr);
+    if (analyze)
+        cursor_op_end(pCur, &m);
+    return rc;
+}
+
+static int ddguard_bdb_cursor_move(struct sql_thread *thd, BtCursor *pCur,
+                                   int flags, int *bdberr, int how,
+                                   struct ireq *iq_do_prefault, int freshcursor)
+{
+    struct cursor_op_mark m;
+    int analyze = cursor_op_begin(thd, &m);
+    int rc = ddguard_bdb_cursor_move_int(thd, pCur, flags, bdberr, how,
+                                         iq_do_prefault, freshcursor);
+    if (analyze)
+        cursor_op_end(pCur, &m);
+    return rc;
+}
+
 /* these transaction modes can perform sql writes */
 static int is_sql_update_mode(int mode)
 {
@@ -11359,7 +11845,9 @@ const char *comdb2_get_sql(void)
 }
 
 int gbl_fdb_track_hints = 0;
-static void sqlite3BtreeCursorHint_Range(BtCursor *pCur, const Expr *pExpr)
+static void cursor_zonemap_hint(BtCursor *pCur, const Expr *pExpr, Mem *aMem);
+static void sqlite3BtreeCursorHint_Range(BtCursor *pCur, const Expr *pExpr,
+                                         Mem *aMem)
 {
     char *expr = "?no vdbe engine?";
 
@@ -11379,6 +11867,8 @@ static void sqlite3BtreeCursorHint_Range(BtCursor *pCur, const Expr *pExpr)
             logmsg(LOGMSG_USER, "Hint \"%s\"\n", expr);
 
         sqlite3_free(expr);
+    } else if (pCur && pCur->cursor_class == CURSORCLASS_TABLE && pCur->db) {
+        cursor_zonemap_hint(pCur, pExpr, aMem);
     }
 }
 
@@ -11409,8 +11899,9 @@ void sqlite3BtreeCursorHint(BtCursor *pCur, int eHintType, ...)
 
     case BTREE_HINT_RANGE: {
         Expr *expr = va_arg(ap, Expr *);
+        Mem *aMem = va_arg(ap, Mem *);
 
-        sqlite3BtreeCursorHint_Range(pCur, expr);
+        sqlite3BtreeCursorHint_Range(pCur, expr, aMem);
 
         break;
     }
@@ -12438,6 +12929,268 @@ done:
     return rc;
 }
 
+int ondisk_field_cmp(struct schema *sc, int fnum, const void *a, const void *b)
+{
+    Mem ma = {{0}}, mb = {{0}};
+    get_data_from_ondisk(sc, (uint8_t *)a, NULL, 0, fnum, &ma, 0, "UTC");
+    get_data_from_ondisk(sc, (uint8_t *)b, NULL, 0, fnum, &mb, 0, "UTC");
+    return sqlite3MemCompare(&ma, &mb, NULL);
+}
+
+/**
+ * The terms a full table scan was hinted with (see codeZonemapHint), each
+ * "column op value", and the zone map of the table they are checked
+ * against.
+ */
+struct cursor_zonemap {
+    struct zonemap *zm;
+    int nterms;
+    struct {
+        int col; /* column of the zone map */
+        int op;  /* TK_LT, TK_LE, TK_GT, TK_GE or TK_EQ */
+        Mem val;
+    } terms[2 * ZONEMAP_MAXCOLS];
+    int zone;           /* last zone checked */
+    int pruned;         /* whether no row of it can match */
+    uint8_t *min, *max; /* .ONDISK records with the bounds of that zone */
+};
+
+static void cursor_zonemap_free(BtCursor *pCur)
+{
+    struct cursor_zonemap *cz = pCur->zonemap;
+    if (!cz)
+        return;
+    for (int i = 0; i < cz->nterms; i++)
+        sqlite3VdbeMemRelease(&cz->terms[i].val);
+    zonemap_put(cz->zm);
+    free(cz->min);
+    free(cz->max);
+    free(cz);
+    pCur->zonemap = NULL;
+}
+
+/* 1 for numbers, 2 for strings, 3 for datetimes, 0 for anything else */
+static int zonemap_class(int flags)
+{
+    if (flags & MEM_Datetime)
+        return 3;
+    if (flags & (MEM_Int | MEM_Real))
+        return 1;
+    if (flags & MEM_Str)
+        return 2;
+    return 0;
+}
+
+static int zonemap_field_class(const struct field *f)
+{
+    switch (f->type) {
+    case SERVER_BINT:
+    case SERVER_UINT:
+    case SERVER_BREAL:
+        return 1;
+    case SERVER_BCSTR:
+        return 2;
+    default:
+        return 3;
+    }
+}
+
+/* Keep "column op value" if the value compares with the column's values the
+ * way the comparison opcode would compare them */
+static void cursor_zonemap_term(BtCursor *pCur, struct cursor_zonemap *cz,
+                                const Expr *pExpr, Mem *aMem)
+{
+    const Expr *pCol = pExpr->pLeft, *pVal = pExpr->pRight;
+    struct schema *sc = pCur->db->schema;
+    int col, aff;
+    Mem *m;
+
+    if (pCol->op != TK_COLUMN || pVal->op != TK_REGISTER ||
+        cz->nterms == sizeof(cz->terms) / sizeof(cz->terms[0]))
+        return;
+    for (col = 0; col < cz->zm->ncols; col++) {
+        if (cz->zm->cols[col].fnum == pCol->iColumn)
+            break;
+    }
+    aff = pVal->affinity;
+    if (col == cz->zm->ncols || aff == SQLITE_AFF_DECIMAL ||
+        aff == SQLITE_AFF_SMALL)
+        return;
+
+    m = &cz->terms[cz->nterms].val;
+    memset(m, 0, sizeof(*m));
+    m->flags = MEM_Null;
+    m->db = aMem[pVal->iTable].db;
+    if (sqlite3VdbeMemCopy(m, &aMem[pVal->iTable]))
+        return;
+    if (aff >= SQLITE_AFF_NUMERIC &&
+        (m->flags & (MEM_Int | MEM_Real | MEM_Str)) == MEM_Str)
+        sqlite3ValueApplyAffinity(m, SQLITE_AFF_NUMERIC, SQLITE_UTF8);
+    if (!(m->flags & MEM_Null) &&
+        zonemap_class(m->flags) !=
+            zonemap_field_class(&sc->member[pCol->iColumn])) {
+        sqlite3VdbeMemRelease(m);
+        return;
+    }
+    cz->terms[cz->nterms].col = col;
+    cz->terms[cz->nterms].op = pExpr->op;
+    cz->nterms++;
+}
+
+static void cursor_zonemap_terms(BtCursor *pCur, struct cursor_zonemap *cz,
+                                 const Expr *pExpr, Mem *aMem)
+{
+    switch (pExpr->op) {
+    case TK_AND:
+        cursor_zonemap_terms(pCur, cz, pExpr->pLeft, aMem);
+        cursor_zonemap_terms(pCur, cz, pExpr->pRight, aMem);
+        break;
+    case TK_LT:
+    case TK_LE:
+    case TK_GT:
+    case TK_GE:
+    case TK_EQ:
+        cursor_zonemap_term(pCur, cz, pExpr, aMem);
+        break;
+    }
+}
+
+/* A full scan of a table with zone maps was hinted with terms on their
+ * columns.  Only plain reads of committed rows step over zones: there is
+ * no shadow of the transaction's own writes to merge in, and no read set
+ * to record. */
+static void cursor_zonemap_hint(BtCursor *pCur, const Expr *pExpr, Mem *aMem)
+{
+    struct cursor_zonemap *cz;
+    struct zonemap *zm;
+
+    cursor_zonemap_free(pCur);
+    if (!pCur->bdbcur || pCur->is_btree_count || pCur->is_recording ||
+        pCur->writeTransaction || pCur->clnt->dbtran.mode != TRANLEVEL_SOSQL)
+        return;
+    if ((zm = zonemap_get(pCur->db)) == NULL)
+        return;
+
+    cz = calloc(1, sizeof(struct cursor_zonemap));
+    cz->zm = zm;
+    cz->zone = -1;
+    pCur->zonemap = cz;
+    cursor_zonemap_terms(pCur, cz, pExpr, aMem);
+    if (cz->nterms == 0) {
+        cursor_zonemap_free(pCur);
+        return;
+    }
+    cz->min = malloc(getdatsize(pCur->db));
+    cz->max = malloc(getdatsize(pCur->db));
+}
+
+/* Can no row of zone "zone" satisfy every term? */
+static int cursor_zonemap_prune(BtCursor *pCur, int zone)
+{
+    struct cursor_zonemap *cz = pCur->zonemap;
+    const struct zonemap_zone *z = &cz->zm->zones[zone];
+    struct schema *sc = pCur->db->schema;
+
+    if (cz->zone == zone)
+        return cz->pruned;
+    cz->zone = zone;
+    cz->pruned = 0;
+
+    zonemap_unpack(cz->zm, zone, 0, cz->min);
+    zonemap_unpack(cz->zm, zone, 1, cz->max);
+    for (int i = 0; i < cz->nterms && !cz->pruned; i++) {
+        Mem *v = &cz->terms[i].val;
+        int col = cz->terms[i].col;
+        int fnum = cz->zm->cols[col].fnum;
+        Mem min = {{0}}, max = {{0}};
+        int lo, hi;
+
+        /* a comparison with null is never true */
+        if ((v->flags & MEM_Null) || !(z->nonnull & (1u << col))) {
+            cz->pruned = 1;
+            break;
+        }
+        get_data_from_ondisk(sc, cz->min, NULL, 0, fnum, &min, 0, "UTC");
+        get_data_from_ondisk(sc, cz->max, NULL, 0, fnum, &max, 0, "UTC");
+        lo = sqlite3MemCompare(&min, v, NULL);
+        hi = sqlite3MemCompare(&max, v, NULL);
+        switch (cz->terms[i].op) {
+        case TK_LT:
+            cz->pruned = lo >= 0;
+            break;
+        case TK_LE:
+            cz->pruned = lo > 0;
+            break;
+        case TK_GT:
+            cz->pruned = hi <= 0;
+            break;
+        case TK_GE:
+            cz->pruned = hi < 0;
+            break;
+        case TK_EQ:
+            cz->pruned = lo > 0 || hi < 0;
+            break;
+        }
+    }
+    return cz->pruned;
+}
+
+/**
+ * The scan found a row.  While it is in a zone that no row of can match,
+ * move the cursor past the end of the zone, on to the next stripe if that
+ * was the last zone of one.  Returns the rc of the last move.
+ */
+static int cursor_zonemap_skip(struct sql_thread *thd, BtCursor *pCur,
+                               int *batched, int *bdberr)
+{
+    struct cursor_zonemap *cz = pCur->zonemap;
+    bdb_state_type *handle = pCur->db->handle;
+    int rc = IX_FND, nskipped = 0;
+
+    if (pCur->bdbcur->getpageorder(pCur->bdbcur))
+        return rc;
+
+    while (rc == IX_FND) {
+        unsigned long long genid, hi;
+        int zone, stripe;
+
+        if (*batched == 1)
+            genid = pCur->batch->rows[pCur->batch->pos].genid;
+        else
+            genid = pCur->bdbcur->genid(pCur->bdbcur);
+        if ((stripe = get_dtafile_from_genid(genid)) < 0)
+            break;
+        zone = zonemap_find(cz->zm, bdb_mask_updateid(handle, genid));
+        if (zone < 0 || !cursor_zonemap_prune(pCur, zone))
+            break;
+
+        nskipped++;
+        *batched = 0;
+        hi = cz->zm->zones[zone].hi;
+        rc = ddguard_bdb_cursor_find(thd, pCur, pCur->bdbcur, &hi, sizeof(hi),
+                                     0, 0, bdberr);
+        /* find stops at the end of the stripe */
+        while (rc == IX_PASTEOF && *bdberr == 0 && ++stripe < gbl_dtastripe) {
+            genid = get_lowest_genid_for_datafile(stripe);
+            rc = ddguard_bdb_cursor_find(thd, pCur, pCur->bdbcur, &genid,
+                                         sizeof(genid), 0, 0, bdberr);
+        }
+        if (rc == IX_NOTFND)
+            rc = IX_FND; /* on the first row after the key */
+        if (rc == IX_FND && *bdberr == 0) {
+            genid = pCur->bdbcur->genid(pCur->bdbcur);
+            if (bdb_cmp_genids(bdb_mask_updateid(handle, genid), hi) <= 0)
+                rc = ddguard_bdb_cursor_move(thd, pCur, 0, bdberr, CNEXT, NULL,
+                                             0);
+        }
+        if (*bdberr)
+            break;
+    }
+    if (nskipped)
+        zonemap_skipped(nskipped);
+    return rc;
+}
+
 static int bind_stmt_mem(struct schema *sc, sqlite3_stmt *stmt, Mem *m)
 {
     int i, rc;
@@ -12508,6 +13261,13 @@ int verify_indexes_column_value(sqlite3_stmt *stmt, void *sm)
     struct schema_mem *psm = (struct schema_mem *)sm;
     Mem *pTo = psm->mout;
     Mem *pFrom = sqlite3_column_value(stmt, 0);
+    if (psm->keys) {
+        int ncols = sqlite3_column_count(stmt);
+        for (int i = 0; i < ncols; i++) {
+            if (sqlite3_column_type(stmt, i) != SQLITE_NULL)
+                *psm->keys |= (1ULL << i);
+        }
+    }
     if (pTo) {
         memcpy(pTo, pFrom, MEMCELLSIZE);
         pTo->db = NULL;
@@ -12546,12 +13306,14 @@ int verify_indexes_column_value(sqlite3_stmt *stmt, void *sm)
 }
 
 static int run_verify_indexes_query(char *sql, struct schema *sc, Mem *min,
-                                     Mem *mout, int *exist)
+                                     Mem *mout, unsigned long long *keys,
+                                     int *exist)
 {
     struct schema_mem sm;
     sm.sc = sc;
     sm.min = min;
     sm.mout = mout;
+    sm.keys = keys;
 
     struct sqlclntstate clnt;
     start_internal_sql_clnt(&clnt);
@@ -12578,7 +13340,10 @@ unsigned long long verify_indexes(struct dbtable *db, uint8_t *rec,
     struct schema *sc;
     strbuf *sql;
     char temp_newdb_name[MAXTABLELEN];
+    const char *tblname;
     int i, ixnum, len, rc;
+    int npartial = 0;
+    int exist = 0;
 
     unsigned long long dirty_keys = 0ULL;
 
@@ -12623,37 +13388,43 @@ unsigned long long verify_indexes(struct dbtable *db, uint8_t *rec,
     len = strlen(db->tablename);
     len = crc32c((uint8_t *)db->tablename, len);
     snprintf(temp_newdb_name, MAXTABLELEN, "sc_alter_temp_%X", len);
+    tblname = is_alter ? temp_newdb_name : db->tablename;
 
+    /* one query evaluates the predicates of all partial indexes: column
+     * ixnum is 1 if the row belongs in index ixnum, NULL if it does not;
+     * each query is a round trip to a sql thread, so one per row, not one
+     * per partial index */
+    strbuf_appendf(sql, "WITH \"%s\"(\"%s\"", tblname, sc->member[0].name);
+    for (i = 1; i < sc->nmembers; i++) {
+        strbuf_appendf(sql, ", \"%s\"", sc->member[i].name);
+    }
+    strbuf_appendf(sql, ") AS (SELECT @%s", sc->member[0].name);
+    for (i = 1; i < sc->nmembers; i++) {
+        strbuf_appendf(sql, ", @%s", sc->member[i].name);
+    }
+    strbuf_append(sql, ") SELECT ");
     for (ixnum = 0; ixnum < db->nix; ixnum++) {
-        if (db->ixschema[ixnum]->where == NULL)
-            dirty_keys |= (1ULL << ixnum);
-        else {
-            int exist = 0;
-            strbuf_clear(sql);
-            strbuf_appendf(sql, "WITH \"%s\"(\"%s\"",
-                           is_alter ? temp_newdb_name : db->tablename,
-                           sc->member[0].name);
-            for (i = 1; i < sc->nmembers; i++) {
-                strbuf_appendf(sql, ", \"%s\"", sc->member[i].name);
-            }
-            strbuf_appendf(sql, ") AS (SELECT @%s", sc->member[0].name);
-            for (i = 1; i < sc->nmembers; i++) {
-                strbuf_appendf(sql, ", @%s", sc->member[i].name);
-            }
-            strbuf_appendf(sql, ") SELECT 1 FROM \"%s\" %s",
-                           is_alter ? temp_newdb_name : db->tablename,
+        if (ixnum)
+            strbuf_append(sql, ", ");
+        if (db->ixschema[ixnum]->where == NULL) {
+            strbuf_append(sql, "1");
+        } else {
+            strbuf_appendf(sql, "(SELECT 1 FROM \"%s\" %s)", tblname,
                            db->ixschema[ixnum]->where);
-            rc = run_verify_indexes_query((char *)strbuf_buf(sql), sc, m, NULL,
-                                          &exist);
-            if (rc) {
-                fprintf(stderr, "%s: failed to run internal query, rc %d\n",
-                        __func__, rc);
-                goto done;
-            }
-            if (exist)
-                dirty_keys |= (1ULL << ixnum);
+            npartial++;
         }
     }
+    if (npartial == 0) {
+        dirty_keys = db->nix ? (-1ULL >> (64 - db->nix)) : 0ULL;
+        goto done;
+    }
+    rc = run_verify_indexes_query((char *)strbuf_buf(sql), sc, m, NULL,
+                                  &dirty_keys, &exist);
+    if (rc) {
+        fprintf(stderr, "%s: failed to run internal query, rc %d\n",
+                __func__, rc);
+        goto done;
+    }
 
 done:
     if (m)
@@ -12748,7 +13519,8 @@ int indexes_expressions_data(struct schema *sc, const char *inbuf, char *outbuf,
     build_indexes_expressions_query(sql, sc, "expridx_temp", f->name);
 
     rc =
-        run_verify_indexes_query((char *)strbuf_buf(sql), sc, m, &mout, &exist);
+        run_verify_indexes_query((char *)strbuf_buf(sql), sc, m, &mout, NULL,
+                                 &exist);
     if (rc || !exist) {
         logmsg(LOGMSG_ERROR, "%s: failed to run internal query, rc %d\n",
                __func__, rc);
@@ -13032,6 +13804,7 @@ int verify_check_constraints(struct dbtable *table, uint8_t *rec,
         sm.sc = sc;
         sm.min = m;
         sm.mout = &mout;
+        sm.keys = NULL;
 
         start_internal_sql_clnt(&clnt);
         clnt.dbtran.mode = TRANLEVEL_SOSQL;
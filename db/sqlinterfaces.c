@@ -104,6 +104,8 @@
 #include "tohex.h"
 
 #include "dohsql.h"
+#include "sql_result_cache.h"
+#include "admission.h"
 #include "comdb2_query_preparer.h"
 #include "string_ref.h"
 
@@ -135,6 +137,8 @@ extern unsigned long long gbl_sql_deadlock_failures;
 extern int gbl_allow_pragma;
 extern int g_osql_max_trans;
 extern int gbl_fdb_track;
+extern int gbl_fdb_stream_window_rows;
+extern int gbl_fdb_stream_window_ms;
 extern int gbl_stable_rootpages_test;
 extern int gbl_verbose_normalized_queries;
 extern int gbl_group_concat_mem_limit;
@@ -188,6 +192,9 @@ int gbl_dump_history_on_too_many_verify_errors = 0;
 int gbl_thdpool_queue_only = 0;
 int gbl_random_sql_work_delayed = 0;
 int gbl_random_sql_work_rejected = 0;
+int gbl_sql_incremental_schema_refresh = 1;
+
+extern volatile int gbl_lua_version;
 
 comdb2_query_preparer_t *query_preparer_plugin;
 
@@ -298,6 +305,7 @@ const char *WriteRespString[] = { RESPONSE_TYPES };
 #undef XRESPONSE
 
 int gbl_client_heartbeat_ms = 100;
+int gbl_sql_idle_timeout_sec = 0;
 int gbl_fail_client_write_lock = 0;
 
 struct sqlclntstate *get_sql_clnt(void){
@@ -668,28 +676,175 @@ void sql_mem_shutdown_and_restore(void *arg, void **poldm)
     sql_mspace = *poldm; *poldm = NULL;
 }
 
+/*
+ * Statement arena.  While a statement runs, small sqlite allocations are
+ * carved out of a chunk of the mspace with a bump pointer instead of each
+ * going through dlmalloc.  Every chunk counts the allocations that are still
+ * live in it: sql_mem_free() only drops the count, and a chunk is emptied in
+ * one go once the statement is done and nothing in it is live anymore.
+ * Anything the statement leaves behind (cached engines, schema) keeps its
+ * chunk alive until it is freed, so nothing is ever released early.
+ *
+ * Like the mspace, sqlite memory is only freed by the thread that allocated
+ * it, so the counts need no locking.
+ */
+int gbl_sql_arena_kb = 0;
+
+/* allocations larger than 1/SQL_ARENA_MAX_FRACTION of a chunk are left to
+ * the mspace */
+#define SQL_ARENA_MAX_FRACTION 8
+
+/* Sits right before an arena allocation, where comdb2_malloc() keeps its
+ * allocator pointer.  The magic has the high bit set, so that slot can never
+ * hold it for a mspace allocation. */
+#define SQL_ARENA_MAGIC 0xa7e4a5a5U
+struct sql_arena_hdr {
+    struct sql_arena_chunk *chunk;
+    unsigned int size;
+    unsigned int magic;
+};
+
+struct sql_arena_chunk {
+    size_t used;
+    size_t size;
+    int live;    /* allocations not yet freed */
+    int retired; /* no longer bumped from; free it once live drops to 0 */
+    char data[];
+};
+
+static __thread struct sql_arena {
+    struct sql_arena_chunk *cur;
+    int active;
+} sql_arena;
+
+static inline struct sql_arena_hdr *sql_arena_hdr(void *mem)
+{
+    struct sql_arena_hdr *hdr = (struct sql_arena_hdr *)mem - 1;
+    return hdr->magic == SQL_ARENA_MAGIC ? hdr : NULL;
+}
+
+static void *sql_arena_malloc(int size)
+{
+    struct sql_arena_chunk *c = sql_arena.cur;
+    struct sql_arena_hdr *hdr;
+    size_t chunksz = (size_t)gbl_sql_arena_kb * 1024;
+    size_t need = sizeof(struct sql_arena_hdr) + ((size + 7) & ~7);
+
+    if (need > chunksz / SQL_ARENA_MAX_FRACTION)
+        return NULL;
+
+    if (c == NULL || c->used + need > c->size) {
+        if (c) {
+            if (c->live == 0)
+                comdb2_free(c);
+            else
+                c->retired = 1;
+            sql_arena.cur = NULL;
+        }
+        c = comdb2_malloc(sql_mspace, sizeof(struct sql_arena_chunk) + chunksz);
+        if (c == NULL)
+            return NULL;
+        c->used = 0;
+        c->size = chunksz;
+        c->live = 0;
+        c->retired = 0;
+        sql_arena.cur = c;
+    }
+
+    hdr = (struct sql_arena_hdr *)(c->data + c->used);
+    hdr->chunk = c;
+    hdr->size = need - sizeof(struct sql_arena_hdr);
+    hdr->magic = SQL_ARENA_MAGIC;
+    c->used += need;
+    c->live++;
+    return hdr + 1;
+}
+
+static void sql_arena_free(struct sql_arena_hdr *hdr)
+{
+    struct sql_arena_chunk *c = hdr->chunk;
+
+    hdr->magic = 0;
+    if (--c->live == 0 && c->retired)
+        comdb2_free(c);
+}
+
+/* Allocations of the statement come from the arena until
+ * sql_arena_end() */
+static void sql_arena_begin(void)
+{
+    if (gbl_sql_arena_kb > 0 && !gbl_disable_sql_dlmalloc)
+        sql_arena.active = 1;
+}
+
+static void sql_arena_end(void)
+{
+    struct sql_arena_chunk *c = sql_arena.cur;
+
+    sql_arena.active = 0;
+    if (c == NULL)
+        return;
+    if (c->live == 0 && c->size == (size_t)gbl_sql_arena_kb * 1024) {
+        /* the common case: the next statement reuses the whole chunk */
+        c->used = 0;
+        return;
+    }
+    if (c->live == 0)
+        comdb2_free(c);
+    else
+        c->retired = 1;
+    sql_arena.cur = NULL;
+}
+
 static void *sql_mem_malloc(int size)
 {
+    void *mem;
+
     if (unlikely(sql_mspace == NULL))
         sql_mem_init(NULL);
 
+    if (sql_arena.active && (mem = sql_arena_malloc(size)) != NULL)
+        return mem;
+
     return comdb2_malloc(sql_mspace, size);
 }
 
 static void sql_mem_free(void *mem)
 {
-    comdb2_free(mem);
+    struct sql_arena_hdr *hdr;
+
+    if (mem && (hdr = sql_arena_hdr(mem)) != NULL)
+        sql_arena_free(hdr);
+    else
+        comdb2_free(mem);
 }
 
 static void *sql_mem_realloc(void *mem, int size)
 {
+    struct sql_arena_hdr *hdr;
+    void *out;
+
     if (unlikely(sql_mspace == NULL))
         sql_mem_init(NULL);
 
+    if (mem && (hdr = sql_arena_hdr(mem)) != NULL) {
+        if (size <= hdr->size)
+            return mem;
+        if ((out = sql_mem_malloc(size)) == NULL)
+            return NULL;
+        memcpy(out, mem, hdr->size);
+        sql_arena_free(hdr);
+        return out;
+    }
+
     return comdb2_realloc(sql_mspace, mem, size);
 }
 
-static int sql_mem_size(void *mem) { return comdb2_malloc_usable_size(mem); }
+static int sql_mem_size(void *mem)
+{
+    struct sql_arena_hdr *hdr = sql_arena_hdr(mem);
+    return hdr ? hdr->size : comdb2_malloc_usable_size(mem);
+}
 
 static int sql_mem_roundup(int i) { return i; }
 
@@ -836,7 +991,15 @@ static int comdb2_authorizer_for_sqlite(
       pAuthState->numDdls++;
       return allowTempDDL ? SQLITE_OK : SQLITE_DENY;
     case SQLITE_READ:
-        record_locked_vtable(pAuthState, zArg1);
+        /* called once per column read; skip the module lookup for
+         * further columns of the same table */
+        if (zArg1 && strcmp(zArg1, pAuthState->lastReadTable) != 0) {
+            record_locked_vtable(pAuthState, zArg1);
+            if (strlen(zArg1) < sizeof(pAuthState->lastReadTable))
+                strcpy(pAuthState->lastReadTable, zArg1);
+            else
+                pAuthState->lastReadTable[0] = '\0';
+        }
         return SQLITE_OK;
     default:
       return SQLITE_OK;
@@ -855,6 +1018,7 @@ static void comdb2_set_authstate(struct sqlthdstate *thd, struct sqlclntstate *c
     thd->authState.numDdls = 0;
     thd->authState.numVTableLocks = 0;
     thd->authState.vTableLocks = NULL;
+    thd->authState.lastReadTable[0] = '\0';
     thd->authState.db = thd->sqldb;
 }
 
@@ -1613,9 +1777,15 @@ static void log_queue_time(struct reqlogger *logger, struct sqlclntstate *clnt)
 {
     if (!gbl_track_queue_time)
         return;
-    if (clnt->deque_timeus > clnt->enque_timeus)
-        reqlog_logf(logger, REQL_INFO, "queuetime=%dms",
-                    U2M(clnt->deque_timeus - clnt->enque_timeus));
+    if (clnt->deque_timeus > clnt->enque_timeus) {
+        if (clnt->prio_class)
+            reqlog_logf(logger, REQL_INFO, "queuetime=%dms class=%d",
+                        U2M(clnt->deque_timeus - clnt->enque_timeus),
+                        clnt->prio_class);
+        else
+            reqlog_logf(logger, REQL_INFO, "queuetime=%dms",
+                        U2M(clnt->deque_timeus - clnt->enque_timeus));
+    }
     reqlog_set_queue_time(logger, clnt->deque_timeus - clnt->enque_timeus);
 }
 
@@ -2534,6 +2704,26 @@ static int reload_analyze(struct sqlthdstate *thd, struct sqlclntstate *clnt,
     return rc;
 }
 
+/* The engine schema still matches sqlite_master: bring the table versions it
+   saved at parse time up to date, dropping cached statements that used a
+   changed table, instead of reopening the engine */
+static void refresh_engine_tables(struct sqlthdstate *thd)
+{
+    Schema *pSchema = thd->sqldb->aDb[0].pSchema;
+    struct dbtable *db;
+    HashElem *e;
+
+    stmt_cache_invalidate_stale(thd->stmt_cache);
+
+    sqlite3_mutex_enter(sqlite3_db_mutex(thd->sqldb));
+    for (e = sqliteHashFirst(&pSchema->tblHash); e; e = sqliteHashNext(e)) {
+        Table *tab = sqliteHashData(e);
+        if (!tab->pSelect && (db = get_dbtable_by_name(tab->zName)) != NULL)
+            tab->version = (int)db->tableversion;
+    }
+    sqlite3_mutex_leave(sqlite3_db_mutex(thd->sqldb));
+}
+
 #define TRK \
     if (gbl_fdb_track) \
         logmsg(LOGMSG_USER, \
@@ -2556,7 +2746,14 @@ static int check_thd_gen(struct sqlthdstate *thd, struct sqlclntstate *clnt, int
 
     if (thd->dbopen_gen != bdb_get_dbopen_gen()) {
         TRK;
-        return SQLITE_SCHEMA;
+        /* lua functions are registered, and auth cached, at open */
+        if (!gbl_sql_incremental_schema_refresh ||
+            thd->sqlmaster_gen != get_sqlmaster_gen() ||
+            thd->lua_version != gbl_lua_version)
+            return SQLITE_SCHEMA;
+        refresh_engine_tables(thd);
+        comdb2_reset_authstate(thd);
+        thd->dbopen_gen = bdb_get_dbopen_gen();
     }
     if (thd->analyze_gen != cached_analyze_gen) {
         int ret;
@@ -2957,7 +3154,7 @@ static struct fingerprint_track *prepare_fingerprint(struct sqlclntstate *clnt,
     }
 
     /* Calculate fingerprint */
-    calc_fingerprint(zNormSql, &unused, fingerprint);
+    calc_stmt_fingerprint(rec->stmt, zNormSql, &unused, fingerprint);
 
     /* Store for virtual table use. */
     memcpy(clnt->work.aFingerprint, fingerprint, FINGERPRINTSZ);
@@ -3015,6 +3212,7 @@ static int get_prepared_stmt_int(struct sqlthdstate *thd,
 
     /* If we did not get a cached stmt, need to prepare it in sql engine */
     int startPrepMs = comdb2_time_epochms(); /* start of prepare phase */
+    reqlog_stage_begin(thd->logger, REQL_STAGE_PREPARE);
     while (rec->stmt == NULL) {
         clnt->in_sqlite_init = 1;
         comdb2_set_authstate(thd, clnt, flags);
@@ -3080,6 +3278,7 @@ static int get_prepared_stmt_int(struct sqlthdstate *thd,
         update_schema_remotes(clnt, rec);
     }
 
+    reqlog_stage_end(thd->logger, REQL_STAGE_PREPARE);
     if (rec->stmt) {
         thd->sqlthd->prepms = comdb2_time_epochms() - startPrepMs;
         if (!t) prepare_fingerprint(clnt, rec, fingerprint, flags);
@@ -3426,7 +3625,8 @@ static int handle_non_sqlite_requests(struct sqlthdstate *thd,
         handle_stored_proc(thd, clnt);
         *outrc = 0;
         return 1;
-    } else if (clnt->is_explain) { // only via newsql--cdb2api
+    } else if (clnt->is_explain && clnt->is_explain != EXPLAIN_ANALYZE) {
+        // only via newsql--cdb2api
         rdlock_schema_lk();
         int rc = sqlengine_prepare_engine(thd, clnt, PREPARE_RECREATE);
         unlock_schema_lk();
@@ -3479,13 +3679,18 @@ static int send_columns(struct sqlclntstate *clnt, struct sqlite3_stmt *stmt)
     if (clnt->osql.sent_column_data || skip_response(clnt))
         return 0;
     clnt->osql.sent_column_data = 1;
+    if (clnt->is_explain == EXPLAIN_ANALYZE) {
+        char *cols[] = {"Analyze"};
+        return write_response(clnt, RESPONSE_COLUMNS_STR, &cols, 1);
+    }
     return write_response(clnt, RESPONSE_COLUMNS, stmt, 0);
 }
 
 static int send_row(struct sqlclntstate *clnt, struct sqlite3_stmt *stmt,
                     uint64_t row_id, int postpone, struct errstat *err)
 {
-    if (skip_row(clnt, row_id))
+    /* explain analyze runs the statement for its actuals only */
+    if (skip_row(clnt, row_id) || clnt->is_explain == EXPLAIN_ANALYZE)
         return 0;
     struct response_data arg = {0};
     arg.err = err;
@@ -3618,6 +3823,9 @@ static int post_sqlite_processing(struct sqlthdstate *thd,
         if (!skip_response(clnt)) {
             if (postponed_write)
                 send_row(clnt, NULL, row_id, 0, NULL);
+            if (clnt->is_explain == EXPLAIN_ANALYZE)
+                explain_analyze_report(clnt, rec->stmt, thd->sqlthd,
+                                       clnt->nrows);
             write_response(clnt, RESPONSE_EFFECTS, 0, 1);
             write_response(clnt, RESPONSE_ROW_LAST, 0, 0);
         }
@@ -3638,6 +3846,7 @@ static int run_stmt(struct sqlthdstate *thd, struct sqlclntstate *clnt,
     int postponed_write = 0;
     sqlite3_stmt *stmt = rec->stmt;
 
+    reqlog_stage_begin(thd->logger, REQL_STAGE_FIRSTROW);
     run_stmt_setup(clnt, stmt);
 
     /* this is a regular sql query, add it to history */
@@ -3645,9 +3854,13 @@ static int run_stmt(struct sqlthdstate *thd, struct sqlclntstate *clnt,
         logmsg(LOGMSG_ERROR,
                "Fail to add query to transaction replay session\n");
 
+    /* rows may come from the result cache instead of the engine */
+    result_cache_begin(clnt, stmt);
+
     /* Get first row to figure out column structure */
     clnt->last_sent_row_sec = time(NULL);
     int steprc = next_row(clnt, stmt);
+    reqlog_stage_end(thd->logger, REQL_STAGE_FIRSTROW);
     if (steprc == SQLITE_SCHEMA_REMOTE) {
         /* remote schema changed;
            Only safe to recover here
@@ -3704,6 +3917,8 @@ static int run_stmt(struct sqlthdstate *thd, struct sqlclntstate *clnt,
             clnt->nrows++;
         }
 
+        result_cache_row(clnt, stmt);
+
         /* return row, if needed */
         if ((clnt->isselect && clnt->osql.replay != OSQL_RETRY_DO) ||
             ((Vdbe *)stmt)->explain) {
@@ -3730,6 +3945,8 @@ static int run_stmt(struct sqlthdstate *thd, struct sqlclntstate *clnt,
      */
 
 postprocessing:
+    if (rc == SQLITE_DONE)
+        result_cache_complete(clnt, stmt);
     /* if we get this message, it means we had to stop the sqlite early
        and we must reset the state */
     if (rc == SQLITE_EARLYSTOP_DOHSQL)
@@ -3770,6 +3987,8 @@ static void sqlite_done(struct sqlthdstate *thd, struct sqlclntstate *clnt,
         distributed = 1;
     }
 
+    result_cache_end(clnt, outrc);
+
     sql_statement_done(thd->sqlthd, thd->logger, clnt, stmt, outrc);
 
     if (stmt && !((Vdbe *)stmt)->explain && ((Vdbe *)stmt)->nScan > 1 &&
@@ -3788,6 +4007,8 @@ static void sqlite_done(struct sqlthdstate *thd, struct sqlclntstate *clnt,
        the next read in sqlite master will find them and try to use them
      */
     clearClientSideRow(clnt);
+
+    sql_arena_end();
 }
 
 static void handle_stored_proc(struct sqlthdstate *thd,
@@ -4058,6 +4279,8 @@ out:
 
         // run the engine
         fast_error = 0;
+        sql_arena_begin();
+        bdb_temp_table_begin_query();
         rc = run_stmt(thd, clnt, &rec, &fast_error, &err, comm);
         if (rc) {
             int irc = errstat_get_rc(&err);
@@ -4269,6 +4492,8 @@ check_version:
                 abort();
             }
             thd->dbopen_gen = bdb_get_dbopen_gen();
+            thd->sqlmaster_gen = get_sqlmaster_gen();
+            thd->lua_version = gbl_lua_version;
         }
 
         comdb2_reset_authstate(thd);
@@ -4418,6 +4643,7 @@ static void sqlengine_work_lua_thread(void *thddata, void *work)
 }
 
 int gbl_debug_sqlthd_failures;
+int gbl_read_lsn_wait_ms = 1000;
 int gbl_enable_internal_sql_stmt_caching = 1;
 
 static int execute_verify_indexes(struct sqlthdstate *thd,
@@ -4434,6 +4660,7 @@ static int execute_verify_indexes(struct sqlthdstate *thd,
         } else {
             /* setting gen to -1 so real SQLs will reopen vm */
             thd->dbopen_gen = -1;
+            thd->sqlmaster_gen = -1;
             thd->analyze_gen = -1;
         }
     }
@@ -4554,6 +4781,7 @@ static int can_execute_sql_query_now(
   clnt->pPool = NULL; /* NOTE: By default, start with the "default" pool. */
   clnt_to_ruleset_item_criteria(clnt, &context);
   size_t count = comdb2_evaluate_ruleset(NULL, gbl_ruleset, &context, &result);
+  clnt->prio_class = result.priorityClass;
   comdb2_ruleset_result_to_str(
     &result, clnt->work.zRuleRes, sizeof(clnt->work.zRuleRes)
   );
@@ -4662,6 +4890,22 @@ void sqlengine_work_appsock(struct sqlthdstate *thd, struct sqlclntstate *clnt)
 
     assert(clnt->dbtran.pStmt == NULL);
 
+    /* read-your-writes: wait until we have applied the client's last commit,
+     * or let it try another node */
+    if (clnt->read_lsn.file && clnt->ctrl_sqlengine == SQLENG_NORMAL_PROCESS &&
+        bdb_wait_for_applied_lsn(thedb->bdb_env, clnt->read_lsn.file,
+                                 clnt->read_lsn.offset,
+                                 gbl_read_lsn_wait_ms) != 0) {
+        send_run_error(clnt, "Client api should change nodes",
+                       CDB2ERR_CHANGENODE);
+        clnt->query_rc = -1;
+        clnt->osql.timings.query_finished = osql_log_time();
+        osql_log_time_done(clnt);
+        clnt_change_state(clnt, CONNECTION_IDLE);
+        signal_clnt_as_done(clnt);
+        return;
+    }
+
     /* everything going in is cursor based */
     int rc = get_curtran(thedb->bdb_env, clnt);
     if (rc) {
@@ -4863,14 +5107,15 @@ static int enqueue_sql_query(struct sqlclntstate *clnt)
     }
 
     struct string_ref *sr = get_ref(clnt->sql_ref);
-    if ((rc = thdpool_enqueue(pool, sqlengine_work_appsock_pp,
-                              clnt, clnt->queue_me, sr, flags)) != 0) {
+    if ((rc = thdpool_enqueue_class(pool, sqlengine_work_appsock_pp, clnt,
+                                    clnt->queue_me, sr, flags,
+                                    clnt->prio_class)) != 0) {
         if ((in_client_trans(clnt) || clnt->osql.replay == OSQL_RETRY_DO) &&
             gbl_requeue_on_tran_dispatch) {
             /* force this request to queue */
-            rc = thdpool_enqueue(pool,
-                                 sqlengine_work_appsock_pp, clnt, 1, sr,
-                                 flags | THDPOOL_FORCE_QUEUE);
+            rc = thdpool_enqueue_class(pool, sqlengine_work_appsock_pp, clnt,
+                                       1, sr, flags | THDPOOL_FORCE_QUEUE,
+                                       clnt->prio_class);
         }
 
         if (rc) {
@@ -4994,6 +5239,7 @@ done:
 static int verify_dispatch_sql_query(struct sqlclntstate *clnt)
 {
     memset(clnt->work.zRuleRes, 0, sizeof(clnt->work.zRuleRes));
+    clnt->prio_class = 0;
 
     if (clnt->admin || !gbl_prioritize_queries || !gbl_ruleset) {
         return 0;
@@ -5032,6 +5278,12 @@ static int dispatch_sql_query_int(struct sqlclntstate *clnt)
     if (rc != 0) {
         return rc;
     }
+    rc = admission_check(clnt);
+    if (rc != 0) {
+        send_run_error(clnt, "Rejected by admission control, database is "
+                             "overloaded", rc);
+        return rc;
+    }
     return enqueue_sql_query(clnt);
 }
 
@@ -5079,7 +5331,7 @@ void cleanup_clnt(struct sqlclntstate *clnt)
         release_node_stats(clnt->argv0, clnt->stack, clnt->origin);
         clnt->rawnodestats = NULL;
     }
-    close_sp(clnt);
+    release_sp(clnt);
     osql_clean_sqlclntstate(clnt);
     if (clnt->dbglog) {
         sbuf2close(clnt->dbglog);
@@ -5210,6 +5462,7 @@ void reset_clnt(struct sqlclntstate *clnt, int initial)
 
     /* reset authentication status */
     clnt->authgen = 0;
+    bzero(&clnt->access_cache, sizeof(clnt->access_cache));
 
     clnt->prepare_only = 0;
     clnt->is_readonly = 0;
@@ -5296,6 +5549,8 @@ void reset_clnt(struct sqlclntstate *clnt, int initial)
     clnt->sqltick = 0;
     clnt->rowbuffer = 1;
     clnt->flat_col_vals = 0;
+    clnt->columnar_rows = 0;
+    clnt->load_info = 0;
     clnt->request_fp = 0;
 
     if (gbl_sockbplog) {
@@ -5823,6 +6078,9 @@ static int execute_sql_query_offload_inner_loop(struct sqlclntstate *clnt,
     int rc = 0;
     int tmp;
     int sent;
+    int pending = 0;
+    int64_t pending_ms = 0;
+    int flush;
 
     if (!clnt->fdb_state.remote_sql_sb) {
         while ((ret = next_row(clnt, stmt)) == SQLITE_ROW)
@@ -5860,10 +6118,24 @@ static int execute_sql_query_offload_inner_loop(struct sqlclntstate *clnt,
             }
 
             if (res.z) {
+                /* stream rows in windows: flush every fdb_stream_window_rows
+                 * rows, or once the oldest unflushed row has waited
+                 * fdb_stream_window_ms */
+                flush = 1;
+                if (gbl_fdb_stream_window_rows > 1) {
+                    int64_t now = comdb2_time_epochms();
+                    if (pending++ == 0)
+                        pending_ms = now;
+                    flush = pending >= gbl_fdb_stream_window_rows ||
+                            now - pending_ms >= gbl_fdb_stream_window_ms;
+                    if (flush)
+                        pending = 0;
+                }
                 /* now we have the packed sqlite row in Mem->z */
                 rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, res.z,
                                      res.n, IX_FNDMORE,
-                                     clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                                     clnt->osql.rqid == OSQL_RQID_USE_UUID,
+                                     flush);
                 if (rc) {
                     /*
                     fprintf(stderr, "%s: failed to send back sql row\n",
@@ -5903,11 +6175,11 @@ static int execute_sql_query_offload_inner_loop(struct sqlclntstate *clnt,
             if (sent == 1) {
                 rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, res.z,
                                      res.n, IX_FND,
-                                     clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                                     clnt->osql.rqid == OSQL_RQID_USE_UUID, 1);
             } else {
                 rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, res.z,
                                      res.n, IX_EMPTY,
-                                     clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                                     clnt->osql.rqid == OSQL_RQID_USE_UUID, 1);
             }
             if (rc) {
                 /*
@@ -6011,7 +6283,7 @@ done:
         tmp = tmp ? tmp : "error string not set";
         rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, (char *)tmp,
                              strlen(tmp) + 1, errstat_get_rc(&clnt->osql.xerr),
-                             clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                             clnt->osql.rqid == OSQL_RQID_USE_UUID, 1);
         if (rc) {
             logmsg(LOGMSG_ERROR,
                    "%s failed to send back error rc=%d errstr=%s\n", __func__,
@@ -6541,6 +6813,8 @@ static void gather_connection_int(struct connection_info *c, struct sqlclntstate
     c->state_int = clnt->state;
     c->time_in_state_int = clnt->state_start_time;
     c->is_admin = clnt->admin;
+    c->net_bytes_written = clnt->net_bytes_written;
+    c->net_write_calls = clnt->net_write_calls;
     c->is_ssl = clnt->plugin.has_ssl(clnt);
     c->has_cert = clnt->plugin.has_x509(clnt);
     if (!c->has_cert) {
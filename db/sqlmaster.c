@@ -25,6 +25,9 @@ struct master_entry {
 /* array */
 static master_entry_t *sqlmaster;
 static int sqlmaster_nentries;
+/* bumped only when the rows sqlite parses change; a schema change that
+   leaves them alone (rebuild, truncate, option changes) keeps it */
+static int sqlmaster_gen;
 
 static void *create_master_row(struct dbtable **dbs, int num_dbs, int rootpage,
                                char *csc2_schema, int tblnum, int ixnum,
@@ -140,6 +143,19 @@ master_entry_t *create_master_entry_array(struct dbtable **dbs, int num_dbs,
     return new_arr;
 }
 
+static int same_master_entries(master_entry_t *a, int na, master_entry_t *b,
+                               int nb)
+{
+    if (!a || na != nb)
+        return 0;
+    for (int i = 0; i < na; i++) {
+        if (a[i].entry_size != b[i].entry_size || !a[i].entry || !b[i].entry ||
+            memcmp(a[i].entry, b[i].entry, a[i].entry_size) != 0)
+            return 0;
+    }
+    return 1;
+}
+
 /**
  * Create sqlite_master row and populate the associated hash
  *
@@ -156,12 +172,21 @@ void create_sqlite_master()
         abort();
     }
 
+    if (!same_master_entries(sqlmaster, sqlmaster_nentries, new_arr,
+                             local_nentries))
+        sqlmaster_gen++;
+
     destroy_sqlite_master(sqlmaster, sqlmaster_nentries);
 
     sqlmaster = new_arr;
     sqlmaster_nentries = local_nentries;
 }
 
+int get_sqlmaster_gen(void)
+{
+    return sqlmaster_gen;
+}
+
 inline static void fill_mem_str(Mem *m, char *str)
 {
     if (str) {
@@ -19,10 +19,15 @@
 #include <metrics.h>
 #include <logmsg.h>
 #include <util.h>
+#include <numa_util.h>
 #include "comdb2_query_preparer.h"
+#include "admission.h"
 
 extern int gbl_use_appsock_as_sqlthread;
 
+/* Spread sql engine threads across NUMA nodes, round-robin. */
+int gbl_sql_numa_pin = 0;
+
 extern void rcache_init(size_t, size_t);
 extern void rcache_destroy(void);
 
@@ -42,6 +47,9 @@ void sqlengine_thd_start(struct thdpool *pool, struct sqlthdstate *thd,
 {
     backend_thread_event(thedb, COMDB2_THR_EVENT_START_RDWR);
 
+    if (gbl_sql_numa_pin)
+        comdb2_numa_pin_thread(comdb2_numa_next_node());
+
     sql_mem_init(NULL);
 
     if (!gbl_use_appsock_as_sqlthread)
@@ -113,6 +121,7 @@ static void thdpool_sqlengine_dque(struct thdpool *pool, struct workitem *item,
 {
     time_metric_add(thedb->sql_queue_time,
                     comdb2_time_epochms() - item->queue_time_ms);
+    admission_note_queue_time(comdb2_time_epochms() - item->queue_time_ms);
 }
 
 static void clnt_queued_event(void *p)
@@ -69,6 +69,8 @@ int gbl_nid_dbname = NID_commonName;
 double gbl_min_tls_ver = 0;
 /* (test-only) are connections from localhost always allowed? */
 int gbl_ssl_allow_localhost = 0;
+/* hand record encryption to the kernel (kTLS) once the handshake is done */
+int gbl_ssl_ktls = 0;
 
 /* number of full ssl handshakes */
 uint64_t gbl_ssl_num_full_handshakes = 0;
@@ -289,6 +291,14 @@ int ssl_process_lrl(char *line, size_t len)
         logmsg(LOGMSG_WARN, "Always allow connections from localhost. "
                             "This option is for testing only and should not be enabled on production.");
         gbl_ssl_allow_localhost = 1;
+    } else if (tokcmp(line, ltok, "ssl_ktls") == 0) {
+        tok = segtok(line, len, &st, &ltok);
+        gbl_ssl_ktls = (ltok <= 0) ? 1 : toknum(tok, ltok);
+#ifndef SSL_OP_ENABLE_KTLS
+        if (gbl_ssl_ktls)
+            logmsg(LOGMSG_WARN, "kTLS is not supported by this OpenSSL "
+                                "build; `ssl_ktls` is ignored.\n");
+#endif
     }
     return 0;
 }
@@ -314,6 +324,12 @@ int ssl_bend_init(const char *default_certdir)
             gbl_sess_cache_sz, gbl_ciphers, gbl_min_tls_ver,
             errmsg, sizeof(errmsg));
         if (rc == 0) {
+#ifdef SSL_OP_ENABLE_KTLS
+            /* OpenSSL silently stays in userspace if the kernel lacks the
+               tls module or the negotiated cipher cannot be offloaded */
+            if (gbl_ssl_ktls)
+                SSL_CTX_set_options(gbl_ssl_ctx, SSL_OP_ENABLE_KTLS);
+#endif
             if (gbl_client_ssl_mode == SSL_UNKNOWN)
                 gbl_client_ssl_mode = SSL_ALLOW;
             if (gbl_rep_ssl_mode == SSL_UNKNOWN)
@@ -398,6 +414,8 @@ void ssl_stats(void)
         logmsg(LOGMSG_USER, "Session Cache Size: %ld\n", gbl_sess_cache_sz);
 
     logmsg(LOGMSG_USER, "Cipher suites: %s\n", gbl_ciphers);
+    logmsg(LOGMSG_USER, "Kernel TLS offload: %s\n",
+           gbl_ssl_ktls ? "YES" : "no");
 
     if (gbl_nid_user == NID_undef)
         logmsg(LOGMSG_USER,
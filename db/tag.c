@@ -58,6 +58,7 @@
 #include "logmsg.h"
 #include "schemachange.h" /* sc_errf() */
 #include "dynschematypes.h"
+#include "zonemap.h"
 
 extern struct dbenv *thedb;
 extern pthread_mutex_t csc2_subsystem_mtx;
@@ -2032,6 +2033,43 @@ int static_tag_blob_conversion(const struct schema *scm, void *record, blob_buff
     return 0;
 }
 
+struct ondisk_map {
+    const struct schema *to;
+    int idx[];
+};
+
+/* The source field of each .ONDISK field, for a client tag converting to it.
+ * Tag writes look this up for every record; it saves matching every column
+ * by name each time.  A client tag is replaced along with the .ONDISK tag by
+ * commit_schemas(), so the map can't outlive its target; dynamic tags are
+ * made per request and don't keep one. */
+static const int *cached_ondisk_map(struct schema *from, struct schema *to)
+{
+    struct ondisk_map *map, *newmap;
+
+    if (from == to || (from->flags & (SCHEMA_DYNAMIC | SCHEMA_INDEX)) ||
+        strcmp(to->tag, ".ONDISK") != 0)
+        return NULL;
+
+    map = __atomic_load_n(&from->ondisk_map, __ATOMIC_ACQUIRE);
+    if (map == NULL) {
+        newmap = malloc(offsetof(struct ondisk_map, idx) +
+                        to->nmembers * sizeof(int));
+        if (newmap == NULL)
+            return NULL;
+        newmap->to = to;
+        for (int field = 0; field < to->nmembers; field++)
+            newmap->idx[field] =
+                find_field_idx_in_tag(from, to->member[field].name);
+        if (__atomic_compare_exchange_n(&from->ondisk_map, &map, newmap, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            map = newmap;
+        else
+            free(newmap);
+    }
+    return map->to == to ? map->idx : NULL;
+}
+
 /* Form server side record from client record.
 *
 * Inputs:
@@ -2084,6 +2122,7 @@ static int ctag_to_stag_int(const char *table, const char *ctag,
     int fflags = 0;
     int got_a_partial_string = 0;
     int rec_srt_off = 1;
+    const int *ondisk_map;
 
     if (gbl_sort_nulls_correctly)
         rec_srt_off = 0;
@@ -2155,11 +2194,13 @@ static int ctag_to_stag_int(const char *table, const char *ctag,
         }
     }
 
+    ondisk_map = cached_ondisk_map(from, to);
     for (field = 0; field < to->nmembers; field++) {
         int outdtsz = 0;
         blob_buffer_t *outblob = NULL;
         to_field = &to->member[field];
-        field_idx = find_field_idx_in_tag(from, to_field->name);
+        field_idx = ondisk_map ? ondisk_map[field]
+                               : find_field_idx_in_tag(from, to_field->name);
         /* field in index set to be descending if converting from
            a client index and that field is marked descending
            */
@@ -2475,6 +2516,94 @@ const uint8_t *flddtasizes_get(struct flddtasizes *p_flddtasizes,
     return p_buf;
 }
 
+/* A vers_plan rewrites a record of an old version into the ondisk layout
+ * with straight copies: runs of fields that kept their type and length are
+ * moved with one memcpy each, and columns added since are filled from
+ * dbstore.  Versions with any other change don't get one. */
+struct vers_plan_op {
+    unsigned int dst;
+    unsigned int src;
+    unsigned int len;
+    int col; /* ondisk column to fill from dbstore, -1 for a copy */
+};
+
+struct vers_plan {
+    int recsize; /* of the old version */
+    int nops;
+    struct vers_plan_op ops[];
+};
+
+static struct vers_plan *compile_vers_plan(dbtable *db, int ver,
+                                           struct schema *from,
+                                           struct schema *to)
+{
+    struct vers_plan *plan;
+    struct vers_plan_op *op = NULL;
+    const int *map = (const int *)db->versmap[ver];
+
+    plan = malloc(offsetof(struct vers_plan, ops) +
+                  to->nmembers * sizeof(struct vers_plan_op));
+    if (plan == NULL)
+        return NULL;
+    plan->recsize = from->recsize;
+    plan->nops = 0;
+
+    for (int i = 0; i < to->nmembers; ++i) {
+        struct field *tf = &to->member[i];
+        struct field *ff;
+
+        /* stag_to_stag_field() makes up values for this one */
+        if (strcasecmp(tf->name, "comdb2_seqno") == 0)
+            goto slow;
+
+        if (map[i] < 0) {
+            /* a column dropped and added back takes its in_default */
+            if (db->dbstore[i].ver <= ver)
+                goto slow;
+            op = &plan->ops[plan->nops++];
+            op->dst = tf->offset;
+            op->src = 0;
+            op->len = tf->len;
+            op->col = i;
+            continue;
+        }
+
+        ff = &from->member[map[i]];
+        if (ff->type != tf->type || ff->len != tf->len)
+            goto slow;
+        if (op && op->col < 0 && op->dst + op->len == tf->offset &&
+            op->src + op->len == ff->offset) {
+            op->len += tf->len;
+            continue;
+        }
+        op = &plan->ops[plan->nops++];
+        op->dst = tf->offset;
+        op->src = ff->offset;
+        op->len = tf->len;
+        op->col = -1;
+    }
+    return plan;
+
+slow:
+    free(plan);
+    return NULL;
+}
+
+static void run_vers_plan(const dbtable *db, const struct vers_plan *plan,
+                          uint8_t *rec)
+{
+    uint8_t *inbuf = alloca(plan->recsize);
+    memcpy(inbuf, rec, plan->recsize);
+
+    for (int i = 0; i < plan->nops; ++i) {
+        const struct vers_plan_op *op = &plan->ops[i];
+        if (op->col < 0)
+            memcpy(&rec[op->dst], &inbuf[op->src], op->len);
+        else
+            set_dbstore(db, op->col, &rec[op->dst], op->len);
+    }
+}
+
 /* Convert record from old version to ondisk.
  * This is a faster version of vtag_to_ondisk()
  * it uses a map of every version to current ondisk so we avoid lookup
@@ -2526,7 +2655,10 @@ int vtag_to_ondisk_vermap(const dbtable *db, uint8_t *rec, int *len,
         abort();
     }
 
-    if (!db->vers_compat_ondisk[ver]) { /* need to convert buffer */
+    if (!db->vers_compat_ondisk[ver] && db->versplan[ver] &&
+        BDB_ATTR_GET(thedb->bdb_attr, USE_VTAG_ONDISK_PLAN)) {
+        run_vers_plan(db, db->versplan[ver], rec);
+    } else if (!db->vers_compat_ondisk[ver]) { /* need to convert buffer */
         /* old version will necessarily be smaller in size.
          * it would make more sense to make a copy of the
          * smaller of the two buffers */
@@ -2550,8 +2682,8 @@ int vtag_to_ondisk_vermap(const dbtable *db, uint8_t *rec, int *len,
 
         /* call new cached version instead of stag_to_stag_buf_flags() */
         rc = stag_to_stag_buf_cachedmap(
-            (int *)db->versmap[ver], from_schema, to_schema, inbuf, (char *)rec,
-            CONVERT_NULL_NO_ERROR, &reason, NULL, 0);
+            (int *)db->versmap[ver], NULL, from_schema, to_schema, inbuf,
+            (char *)rec, CONVERT_NULL_NO_ERROR, &reason, NULL, 0);
 
         if (rc) {
             char err[1024];
@@ -3555,6 +3687,179 @@ static int stag_to_stag_field(const char *inbuf, char *outbuf, int flags,
     return 0;
 }
 
+/* A conversion program makes a server record of one schema from a server
+ * record of another without going back to the schemas.  Target fields that
+ * are straight copies of a source field become copies, fused when they are
+ * adjacent on both sides; everything else is left to stag_to_stag_field().
+ * Index schemas keep one for their table's record (see get_conv_program()),
+ * schema change builds one for the lifetime of the change. */
+enum { CONVOP_COPY, CONVOP_COPY_XOR, CONVOP_FIELD };
+
+struct convop {
+    int op;
+    int field;     /* target field, first one for a fused copy */
+    int field_idx; /* source field, -1 if none */
+    unsigned int inoff;
+    unsigned int outoff;
+    unsigned int len;
+};
+
+struct convprog {
+    const struct schema *from;
+    int nops;
+    struct convop ops[];
+};
+
+/* Would stag_to_stag_field() just copy the source field's bytes? */
+static int conv_field_is_copy(const struct schema *fromsch,
+                              const struct schema *tosch, int field_idx,
+                              int field)
+{
+    const struct field *to_field = &tosch->member[field];
+    const struct field *from_field;
+
+    if (field_idx < 0)
+        return 0;
+    from_field = &fromsch->member[field_idx];
+    if (from_field->type != to_field->type || from_field->len != to_field->len)
+        return 0;
+    switch (to_field->type) {
+    case SERVER_UINT:
+    case SERVER_BINT:
+    case SERVER_BREAL:
+    case SERVER_BCSTR:
+    case SERVER_BYTEARRAY:
+    case SERVER_INTVYM:
+    case SERVER_INTVDS:
+    case SERVER_INTVDSUS:
+        break;
+    default:
+        /* blobs, decimals (quantum), datetimes (fixed up on the way) */
+        return 0;
+    }
+    if (from_field->blob_index >= 0 || to_field->blob_index >= 0)
+        return 0;
+    if (memcmp(&from_field->convopts, &to_field->convopts,
+               sizeof(struct field_conv_opts)) != 0)
+        return 0;
+    if ((tosch->flags & SCHEMA_INDEX) && to_field->isExpr)
+        return 0;
+    if ((to_field->flags & NO_NULL) && !(from_field->flags & NO_NULL))
+        return 0;
+    if (gbl_replicate_local && strcasecmp(to_field->name, "comdb2_seqno") == 0)
+        return 0;
+    return 1;
+}
+
+struct convprog *get_conv_program(struct schema *fromsch, struct schema *tosch,
+                                  const int *tagmap)
+{
+    struct convprog *prog;
+    struct convop *op = NULL;
+
+    prog = malloc(offsetof(struct convprog, ops) +
+                  tosch->nmembers * sizeof(struct convop));
+    if (prog == NULL)
+        return NULL;
+    prog->from = fromsch;
+    prog->nops = 0;
+
+    for (int field = 0; field < tosch->nmembers; field++) {
+        const struct field *to_field = &tosch->member[field];
+        int field_idx, kind = CONVOP_FIELD;
+
+        if (tagmap)
+            field_idx = tagmap[field];
+        else if (fromsch == tosch)
+            field_idx = field;
+        else
+            field_idx = find_field_idx_in_tag(fromsch, to_field->name);
+
+        if (conv_field_is_copy(fromsch, tosch, field_idx, field)) {
+            const struct field *from_field = &fromsch->member[field_idx];
+            /* stag_to_stag_field() flips each side that is descending */
+            kind = ((from_field->flags ^ to_field->flags) & INDEX_DESCEND)
+                       ? CONVOP_COPY_XOR
+                       : CONVOP_COPY;
+            if (kind == CONVOP_COPY && op && op->op == CONVOP_COPY &&
+                op->inoff + op->len == from_field->offset &&
+                op->outoff + op->len == to_field->offset) {
+                op->len += to_field->len;
+                continue;
+            }
+        }
+        op = &prog->ops[prog->nops++];
+        op->op = kind;
+        op->field = field;
+        op->field_idx = field_idx;
+        op->inoff = field_idx >= 0 ? fromsch->member[field_idx].offset : 0;
+        op->outoff = to_field->offset;
+        op->len = to_field->len;
+    }
+    return prog;
+}
+
+static int run_conv_program(const struct convprog *prog, const char *inbuf,
+                            char *outbuf, int flags,
+                            struct convert_failure *fail_reason,
+                            blob_buffer_t *inblobs, blob_buffer_t *outblobs,
+                            int maxblobs, const char *tzname,
+                            struct schema *fromsch, struct schema *tosch)
+{
+    int rec_srt_off = gbl_sort_nulls_correctly ? 0 : 1;
+    int rc;
+
+    for (int i = 0; i < prog->nops; i++) {
+        const struct convop *op = &prog->ops[i];
+        switch (op->op) {
+        case CONVOP_COPY:
+            memcpy(outbuf + op->outoff, inbuf + op->inoff, op->len);
+            break;
+        case CONVOP_COPY_XOR:
+            if (rec_srt_off)
+                outbuf[op->outoff] = inbuf[op->inoff];
+            xorbufcpy(outbuf + op->outoff + rec_srt_off,
+                      inbuf + op->inoff + rec_srt_off, op->len - rec_srt_off);
+            break;
+        default:
+            rc = stag_to_stag_field(inbuf, outbuf, flags, fail_reason, inblobs,
+                                    outblobs, maxblobs, tzname, op->field_idx,
+                                    op->field, fromsch, tosch);
+            if (rc)
+                return rc;
+            break;
+        }
+    }
+    return 0;
+}
+
+/* The program for making tosch from fromsch, if tosch keeps one for it.
+ * Only an index keeps one, for the record of the table it belongs to: the
+ * two are created and freed together, so the program can't outlive its
+ * source. */
+static const struct convprog *cached_conv_program(struct schema *fromsch,
+                                                  struct schema *tosch)
+{
+    struct convprog *prog, *newprog;
+
+    if (!(tosch->flags & SCHEMA_INDEX) || fromsch->ix == NULL ||
+        tosch->ixnum < 0 || tosch->ixnum >= fromsch->nix ||
+        fromsch->ix[tosch->ixnum] != tosch)
+        return NULL;
+
+    prog = __atomic_load_n(&tosch->convprog, __ATOMIC_ACQUIRE);
+    if (prog == NULL) {
+        if ((newprog = get_conv_program(fromsch, tosch, NULL)) == NULL)
+            return NULL;
+        if (__atomic_compare_exchange_n(&tosch->convprog, &prog, newprog, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            prog = newprog;
+        else
+            free(newprog);
+    }
+    return prog->from == fromsch ? prog : NULL;
+}
+
 int stag_set_key_null(const char *table, const char *tag, const char *inkey, const int keylen, char *outkey)
 {
     struct schema *schema;
@@ -3597,6 +3902,12 @@ static int _stag_to_stag_buf_flags_blobs(struct schema *fromsch, struct schema *
         fail_reason->target_schema = tosch;
     }
 
+    const struct convprog *prog = cached_conv_program(fromsch, tosch);
+    if (prog)
+        return run_conv_program(prog, inbuf, outbuf, flags, fail_reason,
+                                inblobs, outblobs, maxblobs, tzname, fromsch,
+                                tosch);
+
     for (int field = 0; field < tosch->nmembers; field++) {
         int field_idx;
 
@@ -3626,12 +3937,13 @@ int *get_tag_mapping(struct schema *fromsch, struct schema *tosch)
     return tagmap;
 }
 
-/* use cached from -> to mapping
+/* use cached from -> to mapping, or the program built from it if there is
+ * one
  * no blobs for now
  */
-int stag_to_stag_buf_cachedmap(int tagmap[], struct schema *from,
-                               struct schema *to, const char *inbuf,
-                               char *outbuf, int flags,
+int stag_to_stag_buf_cachedmap(int tagmap[], const struct convprog *prog,
+                               struct schema *from, struct schema *to,
+                               const char *inbuf, char *outbuf, int flags,
                                struct convert_failure *fail_reason,
                                blob_buffer_t *inblobs, int maxblobs)
 {
@@ -3677,13 +3989,18 @@ int stag_to_stag_buf_cachedmap(int tagmap[], struct schema *from,
         maxblobs = 0;
     }
 
-    for (int field = 0; field < to->nmembers; field++) {
-        rc = stag_to_stag_field(inbuf, outbuf, flags, fail_reason, inblobs,
-                                p_newblobs, maxblobs, NULL, tagmap[field],
-                                field, from, to);
+    if (prog && prog->from == from) {
+        rc = run_conv_program(prog, inbuf, outbuf, flags, fail_reason, inblobs,
+                              p_newblobs, maxblobs, NULL, from, to);
+    } else {
+        for (int field = 0; field < to->nmembers; field++) {
+            rc = stag_to_stag_field(inbuf, outbuf, flags, fail_reason, inblobs,
+                                    p_newblobs, maxblobs, NULL, tagmap[field],
+                                    field, from, to);
 
-        if (rc)
-            break;
+            if (rc)
+                break;
+        }
     }
 
     if (inblobs) /* if we were given blobs */
@@ -5746,6 +6063,7 @@ void set_bdb_option_flags(dbtable *tbl, int odh, int ipu, int isc, int ver,
     bdb_state_type *handle = tbl->handle;
     bdb_set_odh_options(handle, odh, compr, blob_compr);
     bdb_set_inplace_updates(handle, ipu);
+    bdb_set_zonemaps(handle, zonemap_table(tbl));
     bdb_set_instant_schema_change(handle, isc);
     bdb_set_csc2_version(handle, ver);
     bdb_set_datacopy_odh(handle, datacopy_odh);
@@ -5979,6 +6297,17 @@ void update_dbstore(dbtable *db)
             }
         } /* end for each field */
     }     /* end for each version */
+
+    /* dbstore is complete only now that every version has been seen */
+    for (int v = 1; v < db->schema_version; ++v) {
+        char tag[MAXTAGLEN];
+        db->versplan[v] = NULL;
+        if (db->vers_compat_ondisk[v])
+            continue;
+        snprintf(tag, sizeof tag, gbl_ondisk_ver_fmt, v);
+        db->versplan[v] =
+            compile_vers_plan(db, v, find_tag_schema(db->tablename, tag), ondisk);
+    }
 }
 
 void replace_tag_schema(dbtable *db, struct schema *schema)
@@ -6078,6 +6407,10 @@ void freeschema_internals(struct schema *schema)
         freeschema(schema->partial_datacopy);
         schema->partial_datacopy = NULL;
     }
+    free(schema->convprog);
+    schema->convprog = NULL;
+    free(schema->ondisk_map);
+    schema->ondisk_map = NULL;
 }
 
 void freeschema(struct schema *schema)
@@ -6097,6 +6430,7 @@ void freedb_int(dbtable *db, dbtable *replace)
 
     dbs_idx = db->dbs_idx;
 
+    zonemap_release(db);
     if (!replace) 
         free(sqlaliasname);
     free(db->lrlfname);
@@ -6159,6 +6493,8 @@ void freedb_int(dbtable *db, dbtable *replace)
                 free(db->versmap[v]);
                 db->versmap[v] = NULL;
             }
+            free(db->versplan[v]);
+            db->versplan[v] = NULL;
         }
     }
 
@@ -6181,6 +6517,65 @@ void freedb(dbtable *db)
     freedb_int(db, NULL);
 }
 
+/* The .ONDISK schema parsed from the csc2 of old table versions, keyed by
+ * the csc2 text.  A version's csc2 never changes once written, yet every
+ * schema reload on a replicant, and every bulk import, parses all versions
+ * of the table again.  Protected by csc2_subsystem_mtx. */
+int gbl_csc2_version_cache = 0;
+
+struct version_schema {
+    char *csc2;
+    struct schema *schema;
+    LINKC_T(struct version_schema) lnk;
+};
+
+static hash_t *version_schemas;
+static LISTC_T(struct version_schema) version_schemas_lru;
+
+static struct schema *version_schema_find(const char *csc2)
+{
+    struct version_schema *v;
+
+    if (version_schemas == NULL ||
+        (v = hash_find(version_schemas, &csc2)) == NULL)
+        return NULL;
+    listc_rfl(&version_schemas_lru, v);
+    listc_abl(&version_schemas_lru, v);
+    return clone_schema(v->schema);
+}
+
+static void version_schema_add(const char *csc2, struct schema *s)
+{
+    struct version_schema *v;
+
+    if (gbl_csc2_version_cache <= 0)
+        return;
+    if (version_schemas == NULL) {
+        version_schemas =
+            hash_init_strptr(offsetof(struct version_schema, csc2));
+        listc_init(&version_schemas_lru, offsetof(struct version_schema, lnk));
+    }
+    if (hash_find(version_schemas, &csc2) != NULL)
+        return;
+    if ((v = calloc(1, sizeof(struct version_schema))) == NULL)
+        return;
+    if ((v->csc2 = strdup(csc2)) == NULL) {
+        free(v);
+        return;
+    }
+    v->schema = clone_schema(s);
+    hash_add(version_schemas, v);
+    listc_abl(&version_schemas_lru, v);
+
+    while (version_schemas_lru.count > gbl_csc2_version_cache) {
+        v = listc_rtl(&version_schemas_lru);
+        hash_del(version_schemas, v);
+        freeschema(v->schema);
+        free(v->csc2);
+        free(v);
+    }
+}
+
 struct schema *create_version_schema(char *csc2, int version,
                                      struct dbenv *dbenv)
 {
@@ -6191,6 +6586,20 @@ struct schema *create_version_schema(char *csc2, int version,
 
     Pthread_mutex_lock(&csc2_subsystem_mtx);
 
+    if ((ver_schema = version_schema_find(csc2)) != NULL) {
+        tag = malloc(gbl_ondisk_ver_len);
+        if (tag == NULL) {
+            logmsg(LOGMSG_ERROR, "malloc failed %s:%d\n", __FILE__, __LINE__);
+            freeschema(ver_schema);
+            ver_schema = NULL;
+            goto done;
+        }
+        sprintf(tag, gbl_ondisk_ver_fmt, version);
+        free(ver_schema->tag);
+        ver_schema->tag = tag;
+        goto done;
+    }
+
     ver_db = create_new_dbtable(
         thedb, gbl_ver_temp_table, csc2, 0 /* no altname */, 0 /* fake dbnum */,
         0 /* fake dbs_idx */, 1 /* allow ull */, 1 /* no side effects */, &err);
@@ -6215,6 +6624,7 @@ struct schema *create_version_schema(char *csc2, int version,
     ver_schema = clone_schema(s);
     free(ver_schema->tag);
     ver_schema->tag = tag;
+    version_schema_add(csc2, ver_schema);
 
     /* get rid of temp schema */
     del_tag_schema(ver_db->tablename, s->tag);
@@ -24,6 +24,8 @@
 
 struct ireq;
 struct dbtable;
+struct convprog;
+struct ondisk_map;
 
 /* libcmacc2 populates these structures.
    Schema records are added from upon parsing a "csc" directive.
@@ -76,6 +78,12 @@ struct schema {
     char *sqlitetag;
     int *datacopy;
     char *where;
+    /* for indices, how to make one from the table's server record; built
+     * on first use */
+    struct convprog *convprog;
+    /* for client tags, where each .ONDISK field comes from; built on first
+     * use */
+    struct ondisk_map *ondisk_map;
 #if defined STACK_TAG_SCHEMA
     int frames;
     void *buf[MAX_TAG_STACK_FRAMES];
@@ -242,10 +250,12 @@ int ctag_to_stag_buf(const char *table, const char *ctag, const char *inbuf,
                      void *outbufp, int flags, struct convert_failure *reason);
 
 int *get_tag_mapping(struct schema *fromsch, struct schema *tosch);
+struct convprog *get_conv_program(struct schema *fromsch, struct schema *tosch,
+                                  const int *tagmap);
 
-int stag_to_stag_buf_cachedmap(int tagmap[], struct schema *from,
-                               struct schema *to, const char *inbuf,
-                               char *outbuf, int flags,
+int stag_to_stag_buf_cachedmap(int tagmap[], const struct convprog *prog,
+                               struct schema *from, struct schema *to,
+                               const char *inbuf, char *outbuf, int flags,
                                struct convert_failure *fail_reason,
                                blob_buffer_t *inblobs, int maxblobs);
 
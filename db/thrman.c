@@ -636,3 +636,30 @@ const char *thrman_get_where(struct thr_handle *thr)
 {
     return thr->where;
 }
+
+pthread_t thrman_get_tid(struct thr_handle *thr) { return thr->tid; }
+
+/* Get the request logging object of another thread, without resetting it.
+ * May be NULL. */
+struct reqlogger *thrman_peek_reqlogger(struct thr_handle *thr)
+{
+    return thr->reqlogger;
+}
+
+/* Call fn for every registered thread.  The thread list stays locked, so none
+ * of the threads can finish exiting until we return; stops early if fn
+ * returns non-zero. */
+int thrman_foreach(int (*fn)(struct thr_handle *thr, void *arg), void *arg)
+{
+    struct thr_handle *thr;
+    int rc = 0;
+
+    Pthread_mutex_lock(&mutex);
+    LISTC_FOR_EACH(&thr_list, thr, linkv)
+    {
+        if ((rc = fn(thr, arg)) != 0)
+            break;
+    }
+    Pthread_mutex_unlock(&mutex);
+    return rc;
+}
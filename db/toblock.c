@@ -2174,6 +2174,11 @@ static int toblock_outer(struct ireq *iq, block_state_t *blkstate)
     if (!gbl_prefaulthelper_blockops)
         prefaulton = 0;
 
+    /* a helper would only race us to the pages of a single op; not worth
+     * copying the request for it */
+    if (blkstate->numreq < 2)
+        prefaulton = 0;
+
     gaveaway = 0;
 
     my_tid = pthread_self();
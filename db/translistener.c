@@ -38,6 +38,7 @@
 #include <tcputil.h>
 #include <unistd.h>
 #include <logmsg.h>
+#include "crc32c.h"
 #include "str0.h"
 
 struct javasp_trans_state {
@@ -79,6 +80,11 @@ struct stored_proc {
 
     char *qname;
     int flags;
+    /* a partitioned queue hashes events on the value of this column */
+    char *partkey;
+    int npartitions;
+    /* deferred: events come from the log after commit (trigger_log.c) */
+    int async;
     LISTC_T(struct sp_table) tables;
     LINKC_T(struct stored_proc) lnk;
 };
@@ -210,7 +216,11 @@ struct javasp_trans_state *javasp_trans_start(int debug)
 
     SP_READLOCK();
 
-    LISTC_FOR_EACH(&stored_procs, sp, lnk) { st->events |= sp->flags; }
+    LISTC_FOR_EACH(&stored_procs, sp, lnk)
+    {
+        if (!sp->async)
+            st->events |= sp->flags;
+    }
 
     return st;
 }
@@ -750,6 +760,30 @@ static void append_field(struct byte_buffer *bytes, struct field *f,
     }
 }
 
+/* Which partition of a partitioned queue an event goes to: a hash of its
+ * key column, taken from the new record, or the old one for a delete.  So
+ * all events for one key land in the same partition, in order.  A table
+ * without the key column goes to partition 0.  -1 if not partitioned. */
+static int event_partition(struct stored_proc *p, struct schema *s,
+                           struct javasp_rec *oldrec, struct javasp_rec *newrec)
+{
+    struct javasp_rec *rec = newrec ? newrec : oldrec;
+    struct field *f;
+    int i;
+
+    if (p->npartitions < 2)
+        return -1;
+    if (rec == NULL)
+        return 0;
+    for (i = 0; i < s->nmembers; i++) {
+        f = &s->member[i];
+        if (strcasecmp(f->name, p->partkey) == 0)
+            return crc32c((uint8_t *)rec->ondisk_dta + f->offset, f->len) %
+                   p->npartitions;
+    }
+    return 0;
+}
+
 /* This is the actual "stored procedure" call. */
 static int sp_trigger_run(struct javasp_trans_state *javasp_trans_handle,
                           struct stored_proc *p, struct sp_table *t, int event,
@@ -797,6 +831,10 @@ static int sp_trigger_run(struct javasp_trans_state *javasp_trans_handle,
                 /* if we don't know what this is, don't output it */
                 if (field_type == -1)
                     continue;
+                /* blobs aren't in the log records of deferred triggers */
+                if (p->async &&
+                    (f->type == SERVER_BLOB || f->type == SERVER_VUTF8))
+                    continue;
 
                 field_name_len = strlen(fld->name);
                 byte_buffer_append(&bytes, &field_name_len, 1);
@@ -840,8 +878,9 @@ static int sp_trigger_run(struct javasp_trans_state *javasp_trans_handle,
     /* post it to queue */
     usedb = javasp_trans_handle->iq->usedb;
     javasp_trans_handle->iq->usedb = getqueuebyname(p->qname);
-    rc = dbq_add(javasp_trans_handle->iq, javasp_trans_handle->trans,
-                 bytes.bytes, bytes.used);
+    rc = dbq_add_partition(javasp_trans_handle->iq, javasp_trans_handle->trans,
+                           bytes.bytes, bytes.used,
+                           event_partition(p, s, oldrec, newrec));
     javasp_trans_handle->iq->usedb = usedb;
 
 done:
@@ -850,9 +889,10 @@ done:
     return rc;
 }
 
-int javasp_trans_tagged_trigger(struct javasp_trans_state *javasp_trans_handle,
-                                int event, struct javasp_rec *oldrec,
-                                struct javasp_rec *newrec, const char *tblname)
+static int run_triggers(struct javasp_trans_state *javasp_trans_handle,
+                        int event, struct javasp_rec *oldrec,
+                        struct javasp_rec *newrec, const char *tblname,
+                        int async)
 {
     struct stored_proc *p;
     struct sp_table *t;
@@ -866,6 +906,8 @@ int javasp_trans_tagged_trigger(struct javasp_trans_state *javasp_trans_handle,
        off the table structure */
     LISTC_FOR_EACH(&stored_procs, p, lnk)
     {
+        if (p->async != async)
+            continue;
         LISTC_FOR_EACH(&p->tables, t, lnk)
         {
             if (strcasecmp(t->name, tblname) == 0 && (t->flags & event)) {
@@ -884,6 +926,49 @@ int javasp_trans_tagged_trigger(struct javasp_trans_state *javasp_trans_handle,
     return 0;
 }
 
+int javasp_trans_tagged_trigger(struct javasp_trans_state *javasp_trans_handle,
+                                int event, struct javasp_rec *oldrec,
+                                struct javasp_rec *newrec, const char *tblname)
+{
+    return run_triggers(javasp_trans_handle, event, oldrec, newrec, tblname, 0);
+}
+
+int javasp_trans_deferred_trigger(
+    struct javasp_trans_state *javasp_trans_handle, int event,
+    struct javasp_rec *oldrec, struct javasp_rec *newrec, const char *tblname)
+{
+    return run_triggers(javasp_trans_handle, event, oldrec, newrec, tblname, 1);
+}
+
+int javasp_has_deferred_triggers(const char *tblname)
+{
+    struct stored_proc *p;
+    struct sp_table *t;
+    int found = 0;
+
+    SP_READLOCK();
+    LISTC_FOR_EACH(&stored_procs, p, lnk)
+    {
+        if (!p->async)
+            continue;
+        if (tblname == NULL) {
+            found = 1;
+            break;
+        }
+        LISTC_FOR_EACH(&p->tables, t, lnk)
+        {
+            if (strcasecmp(t->name, tblname) == 0) {
+                found = 1;
+                break;
+            }
+        }
+        if (found)
+            break;
+    }
+    SP_RELLOCK();
+    return found;
+}
+
 struct javasp_rec *javasp_alloc_rec(const void *od_dta, size_t od_len,
                                     const char *tblname)
 {
@@ -1021,6 +1106,7 @@ int javasp_unload_procedure_int(const char *name)
             free(sp->name);
             free(sp->param);
             free(sp->qname);
+            free(sp->partkey);
 
             t = listc_rtl(&sp->tables);
             while (t) {
@@ -1155,6 +1241,9 @@ int javasp_load_procedure_int(const char *name, const char *param,
         rc = -1;
         goto done;
     }
+    p->partkey = NULL;
+    p->npartitions = 0;
+    p->async = 0;
     p->name = strdup(name);
     if (!p->name) {
     oom:
@@ -1257,6 +1346,22 @@ int javasp_load_procedure_int(const char *name, const char *param,
                 }
                 p->qname = strdup(queue);
             }
+        } else if (strcasecmp(s, "partition_by") == 0) {
+            char *col = strtok_r(NULL, toksep, &endp);
+            char *n = strtok_r(NULL, toksep, &endp);
+            if (col == NULL || n == NULL || p->partkey ||
+                (p->npartitions = atoi(n)) < 2 ||
+                p->npartitions > QUEUE_MAX_PARTITIONS) {
+                logmsg(LOGMSG_ERROR, "partition_by takes a column and 2 to %d "
+                                     "partitions (config file %s)\n",
+                       QUEUE_MAX_PARTITIONS,
+                       param ? argv[0] : "<from comdb2sc>");
+                rc = -1;
+                goto done;
+            }
+            p->partkey = strdup(col);
+        } else if (strcasecmp(s, "async") == 0) {
+            p->async = 1;
         } else if (strcasecmp(s, "table") == 0) {
             char *tablename;
 
@@ -1394,6 +1499,23 @@ void javasp_rec_have_blob(struct javasp_rec *rec, int blobn,
     }
 }
 
+/* Number of partitions of a trigger's queue, 0 if it isn't partitioned */
+int javasp_queue_partitions(const char *qname)
+{
+    struct stored_proc *sp;
+    int n = 0;
+    SP_READLOCK();
+    LISTC_FOR_EACH(&stored_procs, sp, lnk)
+    {
+        if (sp->qname && strcasecmp(sp->qname, qname) == 0) {
+            n = sp->npartitions;
+            break;
+        }
+    }
+    SP_RELLOCK();
+    return n;
+}
+
 int javasp_exists(const char *name)
 {
     struct stored_proc *sp;
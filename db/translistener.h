@@ -144,6 +144,15 @@ int javasp_trans_tagged_trigger(struct javasp_trans_state *javasp_trans_handle,
                                 int event, struct javasp_rec *oldrec,
                                 struct javasp_rec *newrec, const char *tblname);
 
+/* The same for deferred triggers, called by the trigger log thread for events
+ * it reads back from the log after they commit. */
+int javasp_trans_deferred_trigger(
+    struct javasp_trans_state *javasp_trans_handle, int event,
+    struct javasp_rec *oldrec, struct javasp_rec *newrec, const char *tblname);
+
+/* Is there a deferred trigger on tblname (on any table if NULL)? */
+int javasp_has_deferred_triggers(const char *tblname);
+
 /* This is called for events in an untagged transaction (add/upd/del). */
 int javasp_trans_untagged_trigger(
     struct javasp_trans_state *javasp_trans_handle, int event, void *oldrec,
@@ -192,6 +201,9 @@ int javasp_unload_procedure_int(const char *name);
 /* Check if stored procedure exists. */
 int javasp_exists(const char *name);
 
+/* Number of partitions of a trigger's queue, 0 if it isn't partitioned */
+int javasp_queue_partitions(const char *qname);
+
 /* Get info for qdb, suitable for comdb2_triggers */
 #include <list.h>
 typedef struct trigger_col_info trigger_col_info;
@@ -0,0 +1,520 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+  Deferred triggers
+
+  A trigger created DEFERRED isn't run by the transactions that fire it.
+  Instead one thread on the master reads committed transactions back from
+  the logical log, in commit order, rebuilds the rows they added, updated
+  and deleted, and enqueues the events of every deferred trigger on those
+  tables.  Writers pay nothing for these triggers, and one pass over the log
+  feeds all of them.
+
+  The events of up to deferred_trigger_batch transactions are enqueued in
+  one transaction, which also saves the LSN they were read up to in llmeta,
+  so a new master carries on where the old one stopped, without losing or
+  repeating events.  Log files from that LSN on are not deleted.
+
+  This needs the logical log, so rowlocks or snapshot isolation.  Blobs
+  aren't in it, and blob and vutf8 columns are left out of deferred events.
+*/
+
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "comdb2.h"
+#include "bdb_int.h"
+#include "dbinc/db_swap.h"
+#include "llog_auto.h"
+#include "llog_ext.h"
+#include "bdb_osqllog.h"
+#include "bdb_osql_log_rec.h"
+#include "translistener.h"
+#include "thrman.h"
+#include "thread_util.h"
+#include "locks_wrap.h"
+#include "comdb2_atomic.h"
+#include "logmsg.h"
+
+extern pthread_attr_t gbl_pthread_attr;
+
+int gbl_deferred_trigger_batch = 100;
+
+struct trigger_log {
+    bdb_llog_cursor cur;
+    int positioned;
+    int pending;       /* cur.log is a transaction we haven't read yet */
+    DB_LSN lsn;        /* read up to here */
+    DB_LSN saved;      /* and saved up to here */
+    DB_LOGC *logc;     /* to read single records, without moving cur */
+    DBT logdta;
+    uint8_t *buf[2];   /* old and new record, as logged */
+    uint8_t *unpack[2];
+    bdb_osql_log_rec_t **recs;
+    int nrecs;
+    int allocrecs;
+};
+
+static unsigned int trigger_log_lwm_file;
+
+/* Lowest log file deferred triggers still have to read; 0 if none */
+unsigned int trigger_log_lwm(void)
+{
+    return ATOMIC_LOAD32(trigger_log_lwm_file);
+}
+
+static void set_saved(struct trigger_log *tl, DB_LSN *lsn)
+{
+    tl->saved = *lsn;
+    XCHANGE32(trigger_log_lwm_file, lsn->file);
+}
+
+static inline int is_data_op(bdb_osql_log_rec_t *rec)
+{
+    switch (rec->type) {
+    case DB_llog_undo_add_dta:
+    case DB_llog_undo_add_dta_lk:
+    case DB_llog_undo_del_dta:
+    case DB_llog_undo_del_dta_lk:
+    case DB_llog_undo_upd_dta:
+    case DB_llog_undo_upd_dta_lk:
+        /* dtafile > 0 are blobs */
+        return rec->dtafile == 0;
+    default:
+        return 0;
+    }
+}
+
+/* Unpack a logged record, and bring it up to the table's current version */
+static int unpack_rec(struct dbtable *db, void *dta, int len, void *unpack,
+                      void **out)
+{
+    struct odh odh;
+    int rc;
+
+    if ((rc = bdb_unpack(db->handle, dta, len, unpack, MAXLRL + ODH_SIZE, &odh,
+                         NULL)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: error unpacking rc=%d\n", __func__, rc);
+        return rc;
+    }
+    if ((rc = vtag_to_ondisk_vermap(db, odh.recptr, &len, odh.csc2vers)) <=
+        0) {
+        logmsg(LOGMSG_ERROR, "%s: vtag-to-ondisk error rc=%d\n", __func__, rc);
+        return -1;
+    }
+    *out = odh.recptr;
+    return 0;
+}
+
+/* Rebuild the row(s) of one logged add, delete or update and run the
+ * deferred triggers on its table */
+static int trigger_log_rec(struct trigger_log *tl,
+                           struct javasp_trans_state *st,
+                           bdb_osql_log_rec_t *rec)
+{
+    bdb_state_type *bdb_state = thedb->bdb_env;
+    struct dbtable *db;
+    struct javasp_rec *jold = NULL, *jnew = NULL;
+    void *olddta = NULL, *newdta = NULL;
+    llog_undo_del_dta_args *del_dta = NULL;
+    llog_undo_del_dta_lk_args *del_dta_lk = NULL;
+    llog_undo_upd_dta_args *upd_dta = NULL;
+    llog_undo_upd_dta_lk_args *upd_dta_lk = NULL;
+    unsigned long long genid = 0, oldgenid = 0, prevgenid, newgenid;
+    int rc, event, dtalen, prevlen, ixlen, page, index;
+    int prevgenidlen, newgenidlen;
+
+    /* dropped since */
+    if ((db = get_dbtable_by_name(rec->table)) == NULL)
+        return 0;
+
+    if ((rc = tl->logc->get(tl->logc, &rec->lsn, &tl->logdta, DB_SET)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: rc %d retrieving lsn %u:%u\n", __func__, rc,
+               rec->lsn.file, rec->lsn.offset);
+        return rc;
+    }
+
+    dtalen = prevlen = MAXLRL + ODH_SIZE;
+    switch (rec->type) {
+    case DB_llog_undo_add_dta:
+    case DB_llog_undo_add_dta_lk:
+        event = JAVASP_TRANS_LISTEN_AFTER_ADD;
+        genid = rec->genid;
+        rc = bdb_reconstruct_add(bdb_state, &rec->lsn, NULL, sizeof(genid_t),
+                                 tl->buf[1], dtalen, &dtalen, &ixlen);
+        if (rc == 0)
+            rc = unpack_rec(db, tl->buf[1], dtalen, tl->unpack[1], &newdta);
+        break;
+
+    case DB_llog_undo_del_dta:
+    case DB_llog_undo_del_dta_lk:
+        event = JAVASP_TRANS_LISTEN_AFTER_DEL;
+        if (rec->type == DB_llog_undo_del_dta_lk) {
+            rc = llog_undo_del_dta_lk_read(bdb_state->dbenv,
+                                           tl->logdta.data, &del_dta_lk);
+            if (rc == 0) {
+                genid = del_dta_lk->genid;
+                prevlen = del_dta_lk->dtalen;
+            }
+        } else {
+            rc = llog_undo_del_dta_read(bdb_state->dbenv, tl->logdta.data,
+                                        &del_dta);
+            if (rc == 0) {
+                genid = del_dta->genid;
+                prevlen = del_dta->dtalen;
+            }
+        }
+        if (rc == 0)
+            rc = bdb_reconstruct_delete(bdb_state, &rec->lsn, &page, &index,
+                                        NULL, sizeof(genid_t), tl->buf[0],
+                                        prevlen, &prevlen);
+        if (rc == 0)
+            rc = unpack_rec(db, tl->buf[0], prevlen, tl->unpack[0], &olddta);
+        break;
+
+    case DB_llog_undo_upd_dta:
+    case DB_llog_undo_upd_dta_lk:
+        event = JAVASP_TRANS_LISTEN_AFTER_UPD;
+        if (rec->type == DB_llog_undo_upd_dta_lk) {
+            rc = llog_undo_upd_dta_lk_read(bdb_state->dbenv,
+                                           tl->logdta.data, &upd_dta_lk);
+            if (rc == 0) {
+                genid = upd_dta_lk->newgenid;
+                oldgenid = upd_dta_lk->oldgenid;
+            }
+        } else {
+            rc = llog_undo_upd_dta_read(bdb_state->dbenv, tl->logdta.data,
+                                        &upd_dta);
+            if (rc == 0) {
+                genid = upd_dta->newgenid;
+                oldgenid = upd_dta->oldgenid;
+            }
+        }
+        if (rc)
+            break;
+        if (bdb_inplace_cmp_genids(db->handle, oldgenid, genid) == 0) {
+            rc = bdb_reconstruct_inplace_update(bdb_state, &rec->lsn,
+                                                tl->buf[0], &prevlen,
+                                                tl->buf[1], &dtalen, NULL,
+                                                NULL, NULL);
+        } else {
+            prevgenidlen = newgenidlen = sizeof(unsigned long long);
+            rc = bdb_reconstruct_update(bdb_state, &rec->lsn, &page, &index,
+                                        &prevgenid, &prevgenidlen, tl->buf[0],
+                                        &prevlen, &newgenid, &newgenidlen,
+                                        tl->buf[1], &dtalen);
+        }
+        if (rc == 0)
+            rc = unpack_rec(db, tl->buf[0], prevlen, tl->unpack[0], &olddta);
+        if (rc == 0)
+            rc = unpack_rec(db, tl->buf[1], dtalen, tl->unpack[1], &newdta);
+        break;
+
+    default:
+        return 0;
+    }
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: [%s] can't rebuild lsn %u:%u type %d rc %d\n",
+               __func__, db->tablename, rec->lsn.file, rec->lsn.offset,
+               rec->type, rc);
+        goto done;
+    }
+
+    if (olddta) {
+        jold = javasp_alloc_rec(olddta, db->lrl, db->tablename);
+        javasp_rec_set_trans(jold, st, 2, oldgenid ? oldgenid : genid);
+    }
+    if (newdta) {
+        jnew = javasp_alloc_rec(newdta, db->lrl, db->tablename);
+        javasp_rec_set_trans(jnew, st, 2, genid);
+    }
+    if ((olddta && !jold) || (newdta && !jnew)) {
+        rc = -1;
+        goto done;
+    }
+    rc = javasp_trans_deferred_trigger(st, event, jold, jnew, db->tablename);
+
+done:
+    javasp_dealloc_rec(jold);
+    javasp_dealloc_rec(jnew);
+    free(del_dta);
+    free(del_dta_lk);
+    free(upd_dta);
+    free(upd_dta_lk);
+    return rc;
+}
+
+/* Run the deferred triggers of one committed transaction */
+static int trigger_log_txn(struct trigger_log *tl, struct ireq *iq,
+                           tran_type *trans, int *nevents)
+{
+    bdb_osql_log_rec_t *rec;
+    struct javasp_trans_state *st;
+    const char *last = NULL;
+    int interested = 0, rc = 0, i;
+
+    /* Which of its writes have deferred triggers?  Asked before we start,
+     * as javasp_trans_start holds the procedure lock. */
+    tl->nrecs = 0;
+    LISTC_FOR_EACH(&tl->cur.log->impl->recs, rec, lnk)
+    {
+        if (!is_data_op(rec))
+            continue;
+        if (last == NULL || strcasecmp(last, rec->table) != 0) {
+            last = rec->table;
+            interested = javasp_has_deferred_triggers(rec->table);
+        }
+        if (!interested)
+            continue;
+        if (tl->nrecs == tl->allocrecs) {
+            int n = tl->allocrecs * 2 + 16;
+            bdb_osql_log_rec_t **p = realloc(tl->recs, n * sizeof(*p));
+            if (p == NULL)
+                return ENOMEM;
+            tl->recs = p;
+            tl->allocrecs = n;
+        }
+        tl->recs[tl->nrecs++] = rec;
+    }
+    if (tl->nrecs == 0)
+        return 0;
+
+    st = javasp_trans_start(0);
+    javasp_trans_set_trans(st, iq, trans, trans);
+    for (i = 0; rc == 0 && i < tl->nrecs; i++)
+        rc = trigger_log_rec(tl, st, tl->recs[i]);
+    javasp_trans_end(st);
+    if (rc == 0)
+        *nevents += tl->nrecs;
+    return rc;
+}
+
+static void trigger_log_reset(struct trigger_log *tl)
+{
+    bdb_llog_cursor_reset(&tl->cur);
+    tl->positioned = 0;
+    tl->pending = 0;
+}
+
+/* Open the log at where we were, the saved LSN, or the end of the log the
+ * first time there is a deferred trigger. */
+static int trigger_log_position(struct trigger_log *tl)
+{
+    DB_LSN lsn = {0}, last = {0};
+    int rc, bdberr = 0;
+
+    if (tl->lsn.file == 0) {
+        rc = bdb_get_trigger_log_lsn(NULL, &lsn, &bdberr);
+        if (rc && bdberr != BDBERR_FETCH_DTA) {
+            logmsg(LOGMSG_ERROR, "%s: can't read trigger log lsn bdberr=%d\n",
+                   __func__, bdberr);
+            return -1;
+        }
+        if (rc) {
+            bdb_get_commit_genid(thedb->bdb_env, &lsn);
+            if ((rc = bdb_set_trigger_log_lsn(NULL, &lsn, &bdberr)) != 0) {
+                logmsg(LOGMSG_ERROR,
+                       "%s: can't save trigger log lsn bdberr=%d\n", __func__,
+                       bdberr);
+                return -1;
+            }
+            logmsg(LOGMSG_INFO, "deferred triggers start at %u:%u\n",
+                   lsn.file, lsn.offset);
+        }
+        tl->lsn = lsn;
+        set_saved(tl, &lsn);
+    }
+
+    bdb_llog_cursor_reset(&tl->cur);
+    tl->cur.minLsn = tl->cur.curLsn = tl->lsn;
+    if ((rc = bdb_llog_cursor_find(&tl->cur, &tl->lsn)) != 0)
+        return rc;
+
+    if (tl->cur.hitLast) {
+        bdb_get_commit_genid(thedb->bdb_env, &last);
+        if (log_compare(&last, &tl->lsn) > 0) {
+            logmsg(LOGMSG_ERROR,
+                   "%s: log at %u:%u is gone, deferred triggers restart at "
+                   "%u:%u and miss what is in between\n",
+                   __func__, tl->lsn.file, tl->lsn.offset, last.file,
+                   last.offset);
+            tl->lsn = last;
+            if (bdb_set_trigger_log_lsn(NULL, &last, &bdberr) == 0)
+                set_saved(tl, &last);
+            bdb_llog_cursor_reset(&tl->cur);
+            tl->cur.minLsn = tl->cur.curLsn = last;
+            if ((rc = bdb_llog_cursor_find(&tl->cur, &last)) != 0)
+                return rc;
+        }
+    }
+
+    /* find lands on the transaction that committed at lsn, which was read
+     * already; anything after it wasn't */
+    tl->pending = !tl->cur.hitLast && tl->cur.log &&
+                  log_compare(&tl->cur.curLsn, &tl->lsn) > 0;
+    if (!tl->pending && tl->cur.log) {
+        bdb_osql_log_destroy(tl->cur.log);
+        tl->cur.log = NULL;
+    }
+    tl->positioned = 1;
+    return 0;
+}
+
+/* Read up to deferred_trigger_batch transactions.  Returns how many, or <0 */
+static int trigger_log_batch(struct trigger_log *tl)
+{
+    struct ireq iq;
+    tran_type *trans = NULL;
+    DB_LSN lsn = tl->lsn;
+    int ntxns = 0, nevents = 0, rc = 0, bdberr = 0;
+
+    init_fake_ireq(thedb, &iq);
+
+    while (ntxns < gbl_deferred_trigger_batch && !db_is_exiting()) {
+        if (!tl->pending && (rc = bdb_llog_cursor_next(&tl->cur)) != 0)
+            goto done;
+        tl->pending = 0;
+        if (tl->cur.hitLast || tl->cur.log == NULL)
+            break;
+
+        if (trans == NULL && (rc = trans_start_sc(&iq, NULL, &trans)) != 0) {
+            logmsg(LOGMSG_ERROR, "%s: can't start transaction rc=%d\n",
+                   __func__, rc);
+            trans = NULL;
+            goto done;
+        }
+        rc = trigger_log_txn(tl, &iq, trans, &nevents);
+        bdb_osql_log_destroy(tl->cur.log);
+        tl->cur.log = NULL;
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s: transaction at %u:%u failed rc=%d\n",
+                   __func__, tl->cur.curLsn.file, tl->cur.curLsn.offset, rc);
+            goto done;
+        }
+        lsn = tl->cur.curLsn;
+        ntxns++;
+    }
+
+    if (trans == NULL)
+        return ntxns;
+
+    /* Nothing to enqueue: only save where we are once per log file, which is
+     * all log deletion needs.  A new master may read these again, and
+     * find nothing again. */
+    if (nevents == 0 && lsn.file == tl->saved.file) {
+        trans_abort(&iq, trans);
+        tl->lsn = lsn;
+        return ntxns;
+    }
+
+    if ((rc = bdb_set_trigger_log_lsn(trans, &lsn, &bdberr)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: can't save trigger log lsn bdberr=%d\n",
+               __func__, bdberr);
+        goto done;
+    }
+    rc = trans_commit(&iq, trans, gbl_myhostname);
+    trans = NULL;
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: commit failed rc=%d\n", __func__, rc);
+        goto done;
+    }
+    tl->lsn = lsn;
+    set_saved(tl, &lsn);
+    return ntxns;
+
+done:
+    if (trans)
+        trans_abort(&iq, trans);
+    /* start again from the last transaction we finished */
+    trigger_log_reset(tl);
+    return rc < 0 ? rc : -1;
+}
+
+static void *trigger_log_thd(void *arg)
+{
+    struct trigger_log tl = {{{0}}};
+    int bdberr = 0, rc, i, n;
+    DB_LSN lsn;
+
+    comdb2_name_thread(__func__);
+    thrman_register(THRTYPE_GENERIC);
+    thread_started("trigger log");
+    backend_thread_event(thedb, COMDB2_THR_EVENT_START_RDWR);
+
+    tl.logdta.flags = DB_DBT_REALLOC;
+    for (i = 0; i < 2; i++) {
+        tl.buf[i] = malloc(MAXLRL + ODH_SIZE);
+        tl.unpack[i] = malloc(MAXLRL + ODH_SIZE);
+    }
+
+    for (n = 0; !db_is_exiting(); n++) {
+        if (thedb->master != gbl_myhostname ||
+            !javasp_has_deferred_triggers(NULL)) {
+            trigger_log_reset(&tl);
+            tl.lsn.file = 0;
+            /* keep the logs the master still has to read */
+            if (n % 10 == 0) {
+                if (javasp_has_deferred_triggers(NULL) &&
+                    bdb_get_trigger_log_lsn(NULL, &lsn, &bdberr) == 0)
+                    set_saved(&tl, &lsn);
+                else
+                    XCHANGE32(trigger_log_lwm_file, 0);
+            }
+            sleep(1);
+            continue;
+        }
+
+        if (tl.logc == NULL &&
+            thedb->bdb_env->dbenv->log_cursor(thedb->bdb_env->dbenv, &tl.logc,
+                                              0) != 0) {
+            logmsg(LOGMSG_ERROR, "%s: can't get log cursor\n", __func__);
+            tl.logc = NULL;
+            sleep(1);
+            continue;
+        }
+        if (!tl.positioned && (rc = trigger_log_position(&tl)) != 0) {
+            trigger_log_reset(&tl);
+            sleep(1);
+            continue;
+        }
+
+        rc = trigger_log_batch(&tl);
+        if (rc < 0)
+            sleep(1);
+        else if (rc == 0)
+            poll(NULL, 0, 10);
+    }
+
+    bdb_llog_cursor_close(&tl.cur);
+    if (tl.logc)
+        tl.logc->close(tl.logc, 0);
+    free(tl.logdta.data);
+    for (i = 0; i < 2; i++) {
+        free(tl.buf[i]);
+        free(tl.unpack[i]);
+    }
+    free(tl.recs);
+    backend_thread_event(thedb, COMDB2_THR_EVENT_DONE_RDWR);
+    return NULL;
+}
+
+void create_trigger_log_thread(struct dbenv *dbenv)
+{
+    pthread_t tid;
+    Pthread_create(&tid, &gbl_pthread_attr, trigger_log_thd, dbenv);
+}
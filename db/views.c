@@ -42,6 +42,9 @@
 extern int gbl_is_physical_replicant;
 int gbl_partitioned_table_enabled = 1;
 int gbl_merge_table_enabled = 1;
+int gbl_timepart_prealloc_pct = 0;
+int gbl_timepart_cold_shard_age = 0;
+char *gbl_timepart_cold_shard_compress = NULL;
 
 struct timepart_shard {
     char *tblname; /* name of the table covering the shard, can be an alias */
@@ -107,6 +110,7 @@ static void _remove_view_entry(timepart_views_t *views, int i);
 void *_view_cron_phase1(struct cron_event *event, struct errstat *err);
 void *_view_cron_phase2(struct cron_event *event, struct errstat *err);
 void *_view_cron_phase3(struct cron_event *event, struct errstat *err);
+void *_view_cron_cold_shard(struct cron_event *event, struct errstat *err);
 void *_view_cron_new_rollout(struct cron_event *event, struct errstat *err);
 static int _views_rollout_phase1(timepart_view_t *view, char **newShardName,
                                  struct errstat *err);
@@ -990,7 +994,8 @@ done:
 static int
 _view_cron_schedule_next_rollout(timepart_view_t *view, int timeCrtRollout,
                                  int timeNextRollout, char *removeShardName,
-                                 const char *name, struct errstat *err)
+                                 char *coldShardName, const char *name,
+                                 struct errstat *err)
 {
     int delete_lag = _get_delete_lag(view);
     int preemptive_rolltime = _get_preemptive_rolltime(view);
@@ -1011,10 +1016,29 @@ _view_cron_schedule_next_rollout(timepart_view_t *view, int timeCrtRollout,
             logmsg(LOGMSG_ERROR, "%s: failed rc=%d errstr=%s\n", __func__,
                     err->errval, err->errstr);
             free(removeShardName);
+            free(coldShardName);
             return FDB_ERR_GENERIC;
         }
     }
 
+    if (coldShardName) {
+        /* after the purge, which runs on the same scheduler */
+        tm = timeCrtRollout + delete_lag;
+
+        print_dbg_verbose(view->name, &view->source_id, "LLL",
+                          "Adding cold shard conversion at %d for %s\n", tm,
+                          coldShardName);
+
+        if (cron_add_event(_get_sched_byname(view->period, view->name), NULL,
+                           tm, _view_cron_cold_shard, coldShardName, NULL,
+                           NULL, NULL, &view->source_id, err, NULL) == NULL) {
+            logmsg(LOGMSG_ERROR, "%s: failed rc=%d errstr=%s\n", __func__,
+                   err->errval, err->errstr);
+            free(coldShardName);
+            /* not worth failing the rollout for */
+        }
+    }
+
     /* schedule the next rollout as well */
     tm = timeNextRollout - preemptive_rolltime;
     print_dbg_verbose(view->name, &view->source_id, "LLL",
@@ -1050,6 +1074,7 @@ void *_view_cron_phase2(struct cron_event *event, struct errstat *err)
     int timeNextRollout = 0;
     int timeCrtRollout = 0;
     char *removeShardName = NULL;
+    char *coldShardName = NULL;
     int rc = 0;
     int bdberr;
 
@@ -1119,6 +1144,12 @@ void *_view_cron_phase2(struct cron_event *event, struct errstat *err)
                         "%s -- bdb_llog_views view %s rc:%d bdberr:%d\n",
                         __func__, view->name, rc, bdberr);
             }
+
+            /* the shard that just became old enough to be converted */
+            if (gbl_timepart_cold_shard_age > 0 &&
+                view->nshards > gbl_timepart_cold_shard_age)
+                coldShardName = strdup(
+                    view->shards[gbl_timepart_cold_shard_age].tblname);
         }
 
         BDB_RELLOCK();
@@ -1139,9 +1170,9 @@ done:
 
         /*  schedule next */
         if (rc == VIEW_NOERR) {
-            rc = _view_cron_schedule_next_rollout(view, timeCrtRollout,
-                                                  timeNextRollout,
-                                                  removeShardName, name, err);
+            rc = _view_cron_schedule_next_rollout(
+                view, timeCrtRollout, timeNextRollout, removeShardName,
+                coldShardName, name, err);
             return NULL;
         } else {
             _handle_view_event_error(view, event->source_id, err);
@@ -1203,6 +1234,52 @@ done:
     return NULL;
 }
 
+/**
+ * Rebuild a shard that aged past timepart_cold_shard_age packed and
+ * compressed; the rebuild runs as an asynchronous schema change
+ *
+ */
+void *_view_cron_cold_shard(struct cron_event *event, struct errstat *err)
+{
+    bdb_state_type *bdb_state = thedb->bdb_env;
+    char *pShardName = (char *)event->arg1;
+    int run = 0;
+    int rc;
+
+    print_dbg_verbose(NULL, NULL, "TTT",
+                      "Running cold shard conversion at %u arg1=%p\n",
+                      comdb2_time_epoch(), pShardName);
+
+    if (!pShardName) {
+        errstat_set_rc(err, VIEW_ERR_BUG);
+        errstat_set_strf(err, "%s no shardname?", __func__);
+        goto done;
+    }
+
+    run = (!gbl_exit);
+    if (run && (thedb->master != gbl_myhostname || gbl_is_physical_replicant))
+        run = 0;
+
+    if (run) {
+        const char *algo = gbl_timepart_cold_shard_compress;
+
+        bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_START_RDWR);
+        BDB_READLOCK(__func__);
+
+        rc = sc_timepart_compress_table(
+            pShardName, bdb_compr2algo(algo ? algo : "zlib"), err);
+        if (rc != SC_VIEW_NOERR) {
+            logmsg(LOGMSG_ERROR, "%s: converting %s failed rc=%d errstr=%s\n",
+                   __func__, pShardName, err->errval, err->errstr);
+        }
+
+        BDB_RELLOCK();
+        bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_DONE_RDWR);
+    }
+done:
+    return NULL;
+}
+
 static char* comdb2_partition_info_locked(const char *partition_name, 
                                           const char *option)
 {
@@ -1521,6 +1598,20 @@ static int _views_rollout_phase1(timepart_view_t *view, char **pShardName,
         return err->errval;
     }
 
+    /* reserve disk for the new shard now, so its first period of inserts
+       does not grow the files page by page */
+    if (gbl_timepart_prealloc_pct > 0) {
+        struct dbtable *newdb = get_dbtable_by_name(newShardName);
+        struct dbtable *olddb = get_dbtable_by_name(view->shards[0].tblname);
+        if (newdb && olddb) {
+            rc = bdb_prealloc_like(newdb->handle, olddb->handle,
+                                   gbl_timepart_prealloc_pct);
+            if (rc)
+                logmsg(LOGMSG_WARN, "%s: preallocating %s failed rc %d\n",
+                       __func__, newShardName, rc);
+        }
+    }
+
     *pShardName = strdup(newShardName);
 
     return VIEW_NOERR;
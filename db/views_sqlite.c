@@ -204,13 +204,18 @@ static char *_views_create_view_query(timepart_view_t *view, sqlite3 *db,
         goto malloc;
     }
 
-    /* generate the select union for shards */
-    /* TODO: put conditions for shards */
+    /* generate the select union for shards; each shard carries its rollout
+       bounds as constant hidden columns, so a WHERE term on them is pushed
+       into every leg of the union and decided once per shard, before the
+       shard is scanned */
     select_str = sqlite3_mprintf("");
     for (i = 0; i < view->nshards; i++) {
-        tmp_str = sqlite3_mprintf("%s%sSELECT %s FROM \"%w\"", select_str,
-                                  (i > 0) ? " UNION ALL " : "", cols_str,
-                                  view->shards[i].tblname);
+        tmp_str = sqlite3_mprintf(
+            "%s%sSELECT %s, %d AS __hidden__shard_start, %d AS "
+            "__hidden__shard_end FROM \"%w\"",
+            select_str, (i > 0) ? " UNION ALL " : "", cols_str,
+            view->shards[i].low, view->shards[i].high,
+            view->shards[i].tblname);
         sqlite3_free(select_str);
         if (!tmp_str) {
             sqlite3_free(cols_str);
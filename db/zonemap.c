@@ -0,0 +1,706 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+  Zone maps
+
+  With 48-bit genids, a table's rows sit in each data stripe in the order
+  they were written, so an append-mostly table (events, audit records)
+  keeps its time-like columns clustered by genid.  For the columns listed in
+  zonemap_columns ("table.column,...") the master keeps, per stripe, a list
+  of zones: ranges of zonemap_zone_rows consecutive rows with the smallest
+  and largest value each column had in the range.  A full scan of the table
+  whose WHERE clause bounds a listed column by a constant ("ts >= ?",
+  "ts BETWEEN ? AND ?", "ts = ?") steps over the zones that can't hold a
+  match (see codeZonemapHint in sqlite/src/wherecode.c and
+  cursor_zonemap_skip in sqlglue.c).
+
+  A zone only describes the genids it covers, so it must stay true while
+  those genids exist:
+   - an update of a zone map table never keeps its genid, in place or
+     otherwise (bdb_set_zonemaps); the new version goes to the end of the
+     stripe and the range just loses a row;
+   - deletes only remove rows, which leaves min and max loose but right;
+   - a zone is only built over genids below a fence taken under the
+     table's write lock, so no transaction that allocated a genid inside it
+     is still open.  Only full zones are written; the rows past the last
+     one are picked up on a later pass;
+   - any schema change bumps tableversion, and a zone map is only used
+     for the tableversion it was built for.
+
+  The master builds the zone map incrementally every zonemap_build_sec and
+  saves it in llmeta, whence replicants load it again every
+  zonemap_refresh_sec.  Zone maps a master didn't build itself since it
+  started are rebuilt from scratch, in case the table was updated by a
+  run that didn't keep them.  When there are more zones than
+  zonemap_max_zones, neighbouring zones of a stripe are merged.
+*/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "comdb2.h"
+#include "zonemap.h"
+#include "types.h"
+#include "genid.h"
+#include "endian_core.h"
+#include "thrman.h"
+#include "thread_util.h"
+#include "sc_util.h"
+#include "locks_wrap.h"
+#include "comdb2_atomic.h"
+#include <locks.h>
+#include "logmsg.h"
+
+extern pthread_attr_t gbl_pthread_attr;
+
+char *gbl_zonemap_columns = NULL;
+int gbl_zonemap_zone_rows = 10000;
+int gbl_zonemap_build_sec = 60;
+int gbl_zonemap_refresh_sec = 60;
+int gbl_zonemap_max_zones = 65536;
+
+#define ZONEMAP_VERSION 1
+/* rows a build pass reads from a table; the next pass carries on */
+#define ZONEMAP_PASS_ROWS 1000000
+
+static pthread_mutex_t zonemap_lk = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long long zonemap_nskipped;
+
+/* Is "tbl.col" (or any column of tbl if col is NULL) listed? */
+static int listed(const char *tbl, const char *col)
+{
+    const char *p = gbl_zonemap_columns;
+    size_t tlen = strlen(tbl);
+    size_t clen = col ? strlen(col) : 0;
+
+    while (p && *p) {
+        const char *end = strchr(p, ',');
+        const char *dot;
+        if (end == NULL)
+            end = p + strlen(p);
+        dot = memchr(p, '.', end - p);
+        if (dot && dot - p == tlen && strncasecmp(p, tbl, tlen) == 0 &&
+            (col == NULL ||
+             (end - dot - 1 == clen && strncasecmp(dot + 1, col, clen) == 0)))
+            return 1;
+        p = *end ? end + 1 : end;
+    }
+    return 0;
+}
+
+int zonemap_table_name(const char *table)
+{
+    if (gbl_zonemap_columns == NULL)
+        return 0;
+    return listed(table, NULL);
+}
+
+int zonemap_table(const struct dbtable *tbl)
+{
+    return zonemap_table_name(tbl->tablename);
+}
+
+int zonemap_column(const char *table, const char *column)
+{
+    if (gbl_zonemap_columns == NULL)
+        return 0;
+    return listed(table, column);
+}
+
+/* Types whose sql values order the same way however we decode them */
+static int supported(const struct field *f)
+{
+    switch (f->type) {
+    case SERVER_BINT:
+    case SERVER_BCSTR:
+    case SERVER_DATETIME:
+    case SERVER_DATETIMEUS:
+        return 1;
+    case SERVER_UINT:
+        return f->len <= 5; /* an unsigned long long may not fit */
+    case SERVER_BREAL:
+        return f->len == 9; /* floats come out with their own affinity */
+    default:
+        return 0;
+    }
+}
+
+static void add_col(struct zonemap *zm, const struct schema *sc, int fnum)
+{
+    const struct field *f = &sc->member[fnum];
+    int j = zm->ncols++;
+
+    zm->cols[j].fnum = fnum;
+    zm->cols[j].recoff = f->offset;
+    zm->cols[j].len = f->len;
+    zm->cols[j].off = zm->width;
+    zm->width += f->len;
+}
+
+/* An empty zone map with the listed columns of the table */
+static struct zonemap *zonemap_new(struct dbtable *tbl)
+{
+    struct schema *sc = tbl->schema;
+    struct zonemap *zm = calloc(1, sizeof(struct zonemap));
+
+    zm->refcnt = 1;
+    zm->tableversion = tbl->tableversion;
+    for (int i = 0; i < sc->nmembers && zm->ncols < ZONEMAP_MAXCOLS; i++) {
+        if (supported(&sc->member[i]) &&
+            listed(tbl->tablename, sc->member[i].name))
+            add_col(zm, sc, i);
+    }
+    if (zm->ncols == 0) {
+        free(zm);
+        return NULL;
+    }
+    return zm;
+}
+
+static void zonemap_free(struct zonemap *zm)
+{
+    free(zm->zones);
+    free(zm->vals);
+    free(zm);
+}
+
+static unsigned char *zone_vals(const struct zonemap *zm, int zone, int max)
+{
+    return zm->vals + (size_t)zone * 2 * zm->width + (max ? zm->width : 0);
+}
+
+static void zone_append(struct zonemap *zm, int *alloc,
+                        const struct zonemap_zone *z, const void *vals)
+{
+    if (zm->nzones == *alloc) {
+        *alloc = *alloc ? *alloc * 2 : 64;
+        zm->zones = realloc(zm->zones, *alloc * sizeof(struct zonemap_zone));
+        zm->vals = realloc(zm->vals, (size_t)*alloc * 2 * zm->width);
+    }
+    zm->zones[zm->nzones] = *z;
+    memcpy(zone_vals(zm, zm->nzones, 0), vals, 2 * zm->width);
+    zm->nzones++;
+}
+
+void zonemap_unpack(const struct zonemap *zm, int zone, int max, void *rec)
+{
+    const unsigned char *v = zone_vals(zm, zone, max);
+    for (int j = 0; j < zm->ncols; j++)
+        memcpy((char *)rec + zm->cols[j].recoff, v + zm->cols[j].off,
+               zm->cols[j].len);
+}
+
+/* Pack the values of the columns of records "min" and "max" */
+static void pack(const struct zonemap *zm, const void *min, const void *max,
+                 unsigned char *vals)
+{
+    for (int j = 0; j < zm->ncols; j++) {
+        memcpy(vals + zm->cols[j].off, (char *)min + zm->cols[j].recoff,
+               zm->cols[j].len);
+        memcpy(vals + zm->width + zm->cols[j].off,
+               (char *)max + zm->cols[j].recoff, zm->cols[j].len);
+    }
+}
+
+static int zone_stripe(const struct zonemap_zone *z)
+{
+    return get_dtafile_from_genid(z->lo);
+}
+
+int zonemap_find(const struct zonemap *zm, unsigned long long genid)
+{
+    int stripe = get_dtafile_from_genid(genid);
+    int lo = 0, hi = zm->nzones - 1, fnd = -1;
+
+    if (stripe < 0)
+        return -1;
+
+    /* last zone starting at or before genid */
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        const struct zonemap_zone *z = &zm->zones[mid];
+        int s = zone_stripe(z);
+        if (s < stripe || (s == stripe && bdb_cmp_genids(z->lo, genid) <= 0)) {
+            fnd = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    if (fnd < 0 || zone_stripe(&zm->zones[fnd]) != stripe ||
+        bdb_cmp_genids(genid, zm->zones[fnd].hi) > 0)
+        return -1;
+    return fnd;
+}
+
+/* Serialized, in network order:
+ *   version, tableversion, builttime, ncols,
+ *   per column: name length, name, type, length,
+ *   nzones, per zone: lo, hi (as stored), nonnull,
+ *   then the values of every zone */
+static void *zonemap_serialize(const struct zonemap *zm,
+                               const struct schema *sc, int *len)
+{
+    int version = ZONEMAP_VERSION;
+    size_t sz = 4 + 8 + 4 + 4 + 4;
+    for (int j = 0; j < zm->ncols; j++)
+        sz += 4 + strlen(sc->member[zm->cols[j].fnum].name) + 4 + 4;
+    sz += (size_t)zm->nzones * (8 + 8 + 4 + 2 * zm->width);
+
+    uint8_t *buf = malloc(sz), *p = buf, *end = buf + sz;
+    p = buf_put(&version, sizeof(version), p, end);
+    p = buf_put(&zm->tableversion, sizeof(zm->tableversion), p, end);
+    p = buf_put(&zm->builttime, sizeof(zm->builttime), p, end);
+    p = buf_put(&zm->ncols, sizeof(zm->ncols), p, end);
+    for (int j = 0; j < zm->ncols; j++) {
+        const struct field *f = &sc->member[zm->cols[j].fnum];
+        int namelen = strlen(f->name);
+        p = buf_put(&namelen, sizeof(namelen), p, end);
+        p = buf_no_net_put(f->name, namelen, p, end);
+        p = buf_put(&f->type, sizeof(f->type), p, end);
+        p = buf_put(&f->len, sizeof(f->len), p, end);
+    }
+    p = buf_put(&zm->nzones, sizeof(zm->nzones), p, end);
+    for (int i = 0; i < zm->nzones; i++) {
+        const struct zonemap_zone *z = &zm->zones[i];
+        p = buf_no_net_put(&z->lo, sizeof(z->lo), p, end);
+        p = buf_no_net_put(&z->hi, sizeof(z->hi), p, end);
+        p = buf_put(&z->nonnull, sizeof(z->nonnull), p, end);
+    }
+    p = buf_no_net_put(zm->vals, (size_t)zm->nzones * 2 * zm->width, p, end);
+    if (p != end) {
+        free(buf);
+        return NULL;
+    }
+    *len = sz;
+    return buf;
+}
+
+/* The zone map llmeta has for the table, if it fits its current schema */
+static struct zonemap *zonemap_load(struct dbtable *tbl)
+{
+    struct schema *sc = tbl->schema;
+    struct zonemap *zm = NULL;
+    uint8_t *buf;
+    const uint8_t *p, *end;
+    int len, bdberr, version, ncols, nzones;
+    char name[MAXCOLNAME + 1];
+
+    if (bdb_get_zonemap(NULL, tbl->tablename, (void **)&buf, &len, &bdberr))
+        return NULL;
+    p = buf;
+    end = buf + len;
+
+    zm = calloc(1, sizeof(struct zonemap));
+    zm->refcnt = 1;
+    p = buf_get(&version, sizeof(version), p, end);
+    p = buf_get(&zm->tableversion, sizeof(zm->tableversion), p, end);
+    p = buf_get(&zm->builttime, sizeof(zm->builttime), p, end);
+    p = buf_get(&ncols, sizeof(ncols), p, end);
+    if (p == NULL || version != ZONEMAP_VERSION ||
+        zm->tableversion != tbl->tableversion || ncols <= 0 ||
+        ncols > ZONEMAP_MAXCOLS)
+        goto bad;
+    for (int j = 0; j < ncols; j++) {
+        int namelen, type, flen, fnum;
+        p = buf_get(&namelen, sizeof(namelen), p, end);
+        if (p == NULL || namelen <= 0 || namelen > MAXCOLNAME)
+            goto bad;
+        p = buf_no_net_get(name, namelen, p, end);
+        name[namelen] = 0;
+        p = buf_get(&type, sizeof(type), p, end);
+        p = buf_get(&flen, sizeof(flen), p, end);
+        if (p == NULL ||
+            (fnum = find_field_idx_in_tag(sc, name)) < 0 ||
+            sc->member[fnum].type != type || sc->member[fnum].len != flen ||
+            !supported(&sc->member[fnum]))
+            goto bad;
+        add_col(zm, sc, fnum);
+    }
+    p = buf_get(&nzones, sizeof(nzones), p, end);
+    if (p == NULL || nzones < 0 ||
+        (end - p) != (size_t)nzones * (8 + 8 + 4 + 2 * zm->width))
+        goto bad;
+    zm->nzones = nzones;
+    zm->zones = malloc(sizeof(struct zonemap_zone) * (nzones ? nzones : 1));
+    zm->vals = malloc((size_t)nzones * 2 * zm->width + 1);
+    for (int i = 0; i < nzones; i++) {
+        struct zonemap_zone *z = &zm->zones[i];
+        p = buf_no_net_get(&z->lo, sizeof(z->lo), p, end);
+        p = buf_no_net_get(&z->hi, sizeof(z->hi), p, end);
+        p = buf_get(&z->nonnull, sizeof(z->nonnull), p, end);
+    }
+    buf_no_net_get(zm->vals, (size_t)nzones * 2 * zm->width, p, end);
+    free(buf);
+    return zm;
+
+bad:
+    logmsg(LOGMSG_DEBUG, "%s: ignoring zone map of %s\n", __func__,
+           tbl->tablename);
+    free(buf);
+    zonemap_free(zm);
+    return NULL;
+}
+
+void zonemap_put(struct zonemap *zm)
+{
+    int last;
+    if (zm == NULL)
+        return;
+    Pthread_mutex_lock(&zonemap_lk);
+    last = (--zm->refcnt == 0);
+    Pthread_mutex_unlock(&zonemap_lk);
+    if (last)
+        zonemap_free(zm);
+}
+
+/* Make "zm" (which may be NULL) the table's zone map; takes its reference */
+static void zonemap_install(struct dbtable *tbl, struct zonemap *zm)
+{
+    struct zonemap *old;
+    Pthread_mutex_lock(&zonemap_lk);
+    old = tbl->zonemap;
+    tbl->zonemap = zm;
+    Pthread_mutex_unlock(&zonemap_lk);
+    zonemap_put(old);
+}
+
+void zonemap_release(struct dbtable *tbl)
+{
+    zonemap_install(tbl, NULL);
+    tbl->zonemap_checked = 0;
+}
+
+struct zonemap *zonemap_get(struct dbtable *tbl)
+{
+    struct zonemap *zm;
+    int now = comdb2_time_epoch();
+    int load = 0;
+
+    if (!zonemap_table(tbl) ||
+        bdb_genid_format(thedb->bdb_env) != LLMETA_GENID_48BIT)
+        return NULL;
+
+    Pthread_mutex_lock(&zonemap_lk);
+    if (tbl->zonemap_checked == 0 ||
+        now - tbl->zonemap_checked >= gbl_zonemap_refresh_sec) {
+        /* one of us looks for a newer one, the others use what we have */
+        tbl->zonemap_checked = now;
+        load = 1;
+    }
+    Pthread_mutex_unlock(&zonemap_lk);
+
+    if (load)
+        zonemap_install(tbl, zonemap_load(tbl));
+
+    Pthread_mutex_lock(&zonemap_lk);
+    zm = tbl->zonemap;
+    if (zm && zm->tableversion != tbl->tableversion)
+        zm = NULL;
+    if (zm)
+        zm->refcnt++;
+    Pthread_mutex_unlock(&zonemap_lk);
+    return zm;
+}
+
+void zonemap_skipped(int nzones)
+{
+    ATOMIC_ADD64(zonemap_nskipped, nzones);
+}
+
+/* A genid above that of every row of the table written by a transaction
+ * that is still open: writers hold the table's read lock until they
+ * commit, and allocate their genids under it. */
+static int zonemap_fence(struct dbtable *tbl, unsigned long long *fence)
+{
+    struct ireq iq;
+    tran_type *tran = NULL;
+    int rc;
+
+    init_fake_ireq(thedb, &iq);
+    iq.usedb = tbl;
+    if ((rc = trans_start(&iq, NULL, &tran)) != 0)
+        return rc;
+    rc = bdb_lock_table_write(tbl->handle, tran);
+    if (rc == 0)
+        *fence = bdb_get_a_genid(tbl->handle);
+    trans_abort(&iq, tran);
+    return rc;
+}
+
+/* Merge zone "b" into zone "a" of "zm"; "ra" and "rb" are scratch records */
+static void zone_merge(const struct zonemap *zm, struct schema *sc, int a,
+                       int b, void *ra, void *rb)
+{
+    struct zonemap_zone *za = &zm->zones[a], *zb = &zm->zones[b];
+    for (int max = 0; max <= 1; max++) {
+        unsigned char *va = zone_vals(zm, a, max);
+        const unsigned char *vb = zone_vals(zm, b, max);
+        zonemap_unpack(zm, a, max, ra);
+        zonemap_unpack(zm, b, max, rb);
+        for (int j = 0; j < zm->ncols; j++) {
+            unsigned int bit = 1u << j;
+            int c;
+            if (!(zb->nonnull & bit))
+                continue;
+            if (za->nonnull & bit) {
+                c = ondisk_field_cmp(sc, zm->cols[j].fnum, rb, ra);
+                if (max ? c <= 0 : c >= 0)
+                    continue;
+            }
+            memcpy(va + zm->cols[j].off, vb + zm->cols[j].off,
+                   zm->cols[j].len);
+        }
+    }
+    za->hi = zb->hi;
+    za->nonnull |= zb->nonnull;
+}
+
+/* Halve the zones of each stripe until there are few enough */
+static void zonemap_coarsen(struct zonemap *zm, struct schema *sc, void *ra,
+                            void *rb)
+{
+    while (zm->nzones > gbl_zonemap_max_zones) {
+        int n = 0;
+        for (int i = 0; i < zm->nzones; i++) {
+            if (i != n) {
+                zm->zones[n] = zm->zones[i];
+                memcpy(zone_vals(zm, n, 0), zone_vals(zm, i, 0),
+                       2 * zm->width);
+            }
+            if (i + 1 < zm->nzones &&
+                zone_stripe(&zm->zones[i]) == zone_stripe(&zm->zones[i + 1]))
+                zone_merge(zm, sc, n, ++i, ra, rb);
+            n++;
+        }
+        if (n == zm->nzones)
+            break; /* one zone per stripe */
+        zm->nzones = n;
+    }
+}
+
+/* Fold row "rec" into the zone being built from records "min" and "max" */
+static void zone_add_row(const struct zonemap *zm, struct schema *sc,
+                         struct zonemap_zone *z, const void *rec, void *min,
+                         void *max)
+{
+    for (int j = 0; j < zm->ncols; j++) {
+        int fnum = zm->cols[j].fnum;
+        int off = zm->cols[j].recoff, len = zm->cols[j].len;
+        unsigned int bit = 1u << j;
+        if (stype_is_null((char *)rec + off))
+            continue;
+        if (!(z->nonnull & bit)) {
+            memcpy((char *)min + off, (char *)rec + off, len);
+            memcpy((char *)max + off, (char *)rec + off, len);
+            z->nonnull |= bit;
+        } else if (ondisk_field_cmp(sc, fnum, rec, min) < 0) {
+            memcpy((char *)min + off, (char *)rec + off, len);
+        } else if (ondisk_field_cmp(sc, fnum, rec, max) > 0) {
+            memcpy((char *)max + off, (char *)rec + off, len);
+        }
+    }
+}
+
+/* Extend the table's zone map with the full zones written since the last
+ * pass, and save it.  Called with the schema lock. */
+static int zonemap_build(struct dbtable *tbl)
+{
+    struct schema *sc = tbl->schema;
+    struct zonemap *old, *zm;
+    struct ireq iq;
+    unsigned long long fence, genid;
+    unsigned long long genids[MAXDTASTRIPE] = {0};
+    void *rec = NULL, *min = NULL, *max = NULL;
+    unsigned char *vals = NULL;
+    int alloc = 0, oldi = 0, budget = ZONEMAP_PASS_ROWS, rc, len, bdberr;
+
+    if ((zm = zonemap_new(tbl)) == NULL)
+        return 0;
+
+    Pthread_mutex_lock(&zonemap_lk);
+    old = tbl->zonemap;
+    /* only carry on from what this master built; start over otherwise */
+    if (old && (old->tableversion != tbl->tableversion ||
+                old->builttime < gbl_starttime || old->ncols != zm->ncols ||
+                old->width != zm->width))
+        old = NULL;
+    if (old)
+        old->refcnt++;
+    Pthread_mutex_unlock(&zonemap_lk);
+
+    if ((rc = zonemap_fence(tbl, &fence)) != 0)
+        goto done;
+
+    init_fake_ireq(thedb, &iq);
+    iq.usedb = tbl;
+    rec = malloc(tbl->lrl);
+    min = calloc(1, tbl->lrl);
+    max = calloc(1, tbl->lrl);
+    vals = malloc(2 * zm->width);
+
+    for (int stripe = 0; stripe < gbl_dtastripe; stripe++) {
+        struct zonemap_zone z = {0};
+        int n = 0;
+
+        while (old && oldi < old->nzones &&
+               zone_stripe(&old->zones[oldi]) == stripe) {
+            genids[stripe] = old->zones[oldi].hi;
+            zone_append(zm, &alloc, &old->zones[oldi],
+                        zone_vals(old, oldi, 0));
+            oldi++;
+        }
+
+        while (budget > 0) {
+            int s = stripe;
+            rc = dtas_next(&iq, genids, &genid, &s, 1 /* stay_in_stripe */,
+                           rec, NULL, tbl->lrl, &len, NULL);
+            if (rc == 1)
+                break;
+            if (rc) {
+                logmsg(LOGMSG_ERROR, "%s: %s stripe %d rc %d\n", __func__,
+                       tbl->tablename, stripe, rc);
+                goto done;
+            }
+            if (bdb_cmp_genids(genid, fence) >= 0)
+                break;
+            genids[stripe] = genid;
+            budget--;
+
+            genid = bdb_mask_updateid(tbl->handle, genid);
+            if (n == 0) {
+                z.lo = genid;
+                z.nonnull = 0;
+            }
+            z.hi = genid;
+            zone_add_row(zm, sc, &z, rec, min, max);
+            if (++n == gbl_zonemap_zone_rows) {
+                pack(zm, min, max, vals);
+                zone_append(zm, &alloc, &z, vals);
+                n = 0;
+            }
+        }
+        /* the rows after the last full zone are read again next time */
+    }
+
+    if (old && zm->nzones == old->nzones)
+        goto done; /* nothing new */
+
+    zonemap_coarsen(zm, sc, min, max);
+    zm->builttime = comdb2_time_epoch();
+    void *buf = zonemap_serialize(zm, sc, &len);
+    rc = buf ? bdb_set_zonemap(NULL, tbl->tablename, buf, len, &bdberr) : -1;
+    free(buf);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: can't save zone map of %s rc %d bdberr %d\n",
+               __func__, tbl->tablename, rc, bdberr);
+        goto done;
+    }
+    logmsg(LOGMSG_DEBUG, "%s: %s has %d zones\n", __func__, tbl->tablename,
+           zm->nzones);
+    Pthread_mutex_lock(&zonemap_lk);
+    tbl->zonemap_checked = zm->builttime;
+    Pthread_mutex_unlock(&zonemap_lk);
+    zonemap_install(tbl, zm);
+    zm = NULL;
+
+done:
+    zonemap_put(old);
+    if (zm)
+        zonemap_free(zm);
+    free(rec);
+    free(min);
+    free(max);
+    free(vals);
+    return rc;
+}
+
+static void zonemap_pass(void)
+{
+    bdb_state_type *bdb_state = thedb->bdb_env;
+
+    if (bdb_genid_format(bdb_state) != LLMETA_GENID_48BIT)
+        return;
+
+    BDB_READLOCK(__func__);
+    rdlock_schema_lk();
+    for (int i = 0; i < thedb->num_dbs; i++) {
+        struct dbtable *tbl = thedb->dbs[i];
+        if (thedb->master != gbl_myhostname || db_is_exiting() ||
+            get_schema_change_in_progress(__func__, __LINE__))
+            break;
+        if (tbl->dbtype == DBTYPE_TAGGED_TABLE && zonemap_table(tbl))
+            zonemap_build(tbl);
+    }
+    unlock_schema_lk();
+    BDB_RELLOCK();
+}
+
+static void *zonemap_thd(void *arg)
+{
+    int last = 0;
+
+    comdb2_name_thread(__func__);
+    thrman_register(THRTYPE_GENERIC);
+    thread_started("zone map");
+    backend_thread_event(thedb, COMDB2_THR_EVENT_START_RDWR);
+
+    while (!db_is_exiting()) {
+        int now = comdb2_time_epoch();
+        if (thedb->master == gbl_myhostname && gbl_zonemap_build_sec > 0 &&
+            now - last >= gbl_zonemap_build_sec) {
+            zonemap_pass();
+            last = now;
+        }
+        sleep(1);
+    }
+
+    backend_thread_event(thedb, COMDB2_THR_EVENT_DONE_RDWR);
+    return NULL;
+}
+
+void create_zonemap_thread(struct dbenv *dbenv)
+{
+    pthread_t tid;
+    if (gbl_zonemap_columns == NULL)
+        return;
+    Pthread_create(&tid, &gbl_pthread_attr, zonemap_thd, dbenv);
+}
+
+void zonemap_stat(void)
+{
+    logmsg(LOGMSG_USER, "zone maps: %s\n",
+           gbl_zonemap_columns ? gbl_zonemap_columns : "none");
+    Pthread_mutex_lock(&zonemap_lk);
+    for (int i = 0; i < thedb->num_dbs; i++) {
+        struct dbtable *tbl = thedb->dbs[i];
+        struct zonemap *zm = tbl->zonemap;
+        if (zm == NULL)
+            continue;
+        logmsg(LOGMSG_USER,
+               "table %s: %d zones, %d columns, built at %d, version %llu%s\n",
+               tbl->tablename, zm->nzones, zm->ncols, zm->builttime,
+               zm->tableversion,
+               zm->tableversion != tbl->tableversion ? " (stale)" : "");
+    }
+    Pthread_mutex_unlock(&zonemap_lk);
+    logmsg(LOGMSG_USER, "zones skipped by scans: %llu\n",
+           ATOMIC_LOAD64(zonemap_nskipped));
+}
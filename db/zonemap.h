@@ -0,0 +1,83 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef _ZONEMAP_H_
+#define _ZONEMAP_H_
+
+#include "comdb2.h"
+
+#define ZONEMAP_MAXCOLS 16
+
+/* A range of row versions of one stripe, with the smallest and largest value
+ * each column had in it.  "lo" and "hi" have their update id masked off. */
+struct zonemap_zone {
+    unsigned long long lo;
+    unsigned long long hi;
+    unsigned int nonnull; /* bit j: column j had a value that isn't null */
+};
+
+struct zonemap {
+    int refcnt;
+    unsigned long long tableversion;
+    int builttime;
+    int ncols;
+    struct {
+        int fnum;   /* .ONDISK field */
+        int recoff; /* offset of the field in a .ONDISK record */
+        int len;
+        int off; /* offset of the value in a zone's min and max */
+    } cols[ZONEMAP_MAXCOLS];
+    int width; /* bytes of the values of one bound of one zone */
+    int nzones;
+    /* sorted by stripe, then genid */
+    struct zonemap_zone *zones;
+    /* per zone: min values, then max values */
+    unsigned char *vals;
+};
+
+/* Does this table have any columns listed in zonemap_columns? */
+int zonemap_table(const struct dbtable *tbl);
+int zonemap_table_name(const char *table);
+
+/* Is table.column listed in zonemap_columns? */
+int zonemap_column(const char *table, const char *column);
+
+/* The zone map of a table if there is one we can trust, with a reference the
+ * caller drops with zonemap_put. */
+struct zonemap *zonemap_get(struct dbtable *tbl);
+void zonemap_put(struct zonemap *zm);
+
+/* Drop the table's cached zone map */
+void zonemap_release(struct dbtable *tbl);
+
+/* Index of the zone that holds "genid", or -1 */
+int zonemap_find(const struct zonemap *zm, unsigned long long genid);
+
+/* Write the min (or max) values of zone "zone" into .ONDISK record "rec" */
+void zonemap_unpack(const struct zonemap *zm, int zone, int max, void *rec);
+
+/* Count zones a table scan skipped */
+void zonemap_skipped(int nzones);
+
+void zonemap_stat(void);
+void create_zonemap_thread(struct dbenv *dbenv);
+
+/* Compare field "fnum" of .ONDISK records "a" and "b" the way sql compares
+ * their values.  Neither field may be null.  In sqlglue.c. */
+int ondisk_field_cmp(struct schema *sc, int fnum, const void *a,
+                     const void *b);
+
+#endif
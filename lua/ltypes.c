@@ -184,6 +184,35 @@ void datetime_t_to_dttz(const datetime_t *datetime, dttz_t *dt)
     }
 }
 
+/* Converting a datetime to a dttz goes through its timezone, which is the
+ * bulk of the cost of a comparison.  Procedures mostly compare many values
+ * against the same one or two bounds, so remember the last conversions. */
+#define DTTZ_CACHE_SZ 2
+static __thread struct {
+    datetime_t in;
+    dttz_t out;
+    int valid;
+} dttz_cache[DTTZ_CACHE_SZ];
+static __thread int dttz_cache_next;
+
+static void datetime_t_to_dttz_cached(const datetime_t *in, dttz_t *out)
+{
+    int i;
+    for (i = 0; i < DTTZ_CACHE_SZ; ++i) {
+        if (dttz_cache[i].valid &&
+            memcmp(&dttz_cache[i].in, in, sizeof(*in)) == 0) {
+            *out = dttz_cache[i].out;
+            return;
+        }
+    }
+    datetime_t_to_dttz(in, out);
+    i = dttz_cache_next;
+    dttz_cache_next = (i + 1) % DTTZ_CACHE_SZ;
+    dttz_cache[i].in = *in;
+    dttz_cache[i].out = *out;
+    dttz_cache[i].valid = 1;
+}
+
 void dttz_to_datetime_t(const dttz_t *dt, const char *tz, datetime_t *datetime)
 {
     if (dt->dttz_prec == DTTZ_PREC_MSEC) {
@@ -923,11 +952,25 @@ static void l_decimal_cmp(lua_State *lua, int op) {
     }
 }
 
+static void real_cmp(Lua lua, int op, double val1, double val2)
+{
+    switch (op) {
+    case LUA_OP_EQ: lua_pushboolean(lua, val1 == val2); break;
+    case LUA_OP_LT: lua_pushboolean(lua, val1 <  val2); break;
+    case LUA_OP_LE: lua_pushboolean(lua, val1 <= val2); break;
+    }
+}
+
 static void l_real_cmp(Lua lua, int op)
 {
     double val1, val2;
     luabb_toreal(lua, 1, &val1);
     luabb_toreal(lua, 2, &val2);
+    real_cmp(lua, op, val1, val2);
+}
+
+static void int_cmp(Lua lua, int op, long long val1, long long val2)
+{
     switch (op) {
     case LUA_OP_EQ: lua_pushboolean(lua, val1 == val2); break;
     case LUA_OP_LT: lua_pushboolean(lua, val1 <  val2); break;
@@ -940,11 +983,7 @@ static void l_int_cmp(Lua lua, int op)
     long long val1, val2;
     luabb_tointeger(lua, 1, &val1);
     luabb_tointeger(lua, 2, &val2);
-    switch (op) {
-    case LUA_OP_EQ: lua_pushboolean(lua, val1 == val2); break;
-    case LUA_OP_LT: lua_pushboolean(lua, val1 <  val2); break;
-    case LUA_OP_LE: lua_pushboolean(lua, val1 <= val2); break;
-    }
+    int_cmp(lua, op, val1, val2);
 }
 
 static int datetime_cmp(Lua);
@@ -997,8 +1036,48 @@ static rank_t getrank(Lua lua, int idx)
     }
 }
 
+/* Fast path for the common operands of procedure math: a non-null integer
+ * or real, or a Lua number.  Returns RANK_MAX for anything else, which then
+ * takes the general path. */
+static rank_t num_operand(Lua lua, int idx, long long *i, double *d)
+{
+    const lua_dbtypes_t *t;
+    switch (lua_type(lua, idx)) {
+    case LUA_TNUMBER:
+        *d = lua_tonumber(lua, idx);
+        return RANK_REAL;
+    case LUA_TUSERDATA:
+        t = lua_topointer(lua, idx);
+        if (t->is_null)
+            break;
+        if (t->dbtype == DBTYPES_INTEGER) {
+            *i = ((const lua_int_t *)t)->val;
+            *d = *i;
+            return RANK_INT;
+        }
+        if (t->dbtype == DBTYPES_REAL) {
+            *d = ((const lua_real_t *)t)->val;
+            return RANK_REAL;
+        }
+        break;
+    }
+    return RANK_MAX;
+}
+
 static int l_cmp(Lua lua, int op)
 {
+    long long i1, i2;
+    double d1, d2;
+    rank_t r1 = num_operand(lua, 1, &i1, &d1);
+    rank_t r2 = num_operand(lua, 2, &i2, &d2);
+    if (r1 == RANK_INT && r2 == RANK_INT) {
+        int_cmp(lua, op, i1, i2);
+        return 0;
+    } else if (r1 <= RANK_REAL && r2 <= RANK_REAL) {
+        real_cmp(lua, op, d1, d2);
+        return 0;
+    }
+
     nullchk(lua, 1);
     nullchk(lua, 2);
 
@@ -1125,11 +1204,8 @@ static int l_decimal_div(lua_State *lua)
 }
 
 static int l_int_new(Lua);
-static int l_int_arithmetic(Lua lua, operation_t op)
+static int int_arithmetic(Lua lua, operation_t op, long long v1, long long v2)
 {
-    long long v1, v2;
-    luabb_tointeger(lua, 1, &v1);
-    luabb_tointeger(lua, 2, &v2);
     l_int_new(lua);
     lua_int_t *v = (lua_int_t *)lua_topointer(lua, -1);
     switch (op) {
@@ -1142,12 +1218,17 @@ static int l_int_arithmetic(Lua lua, operation_t op)
     return 1;
 }
 
+static int l_int_arithmetic(Lua lua, operation_t op)
+{
+    long long v1, v2;
+    luabb_tointeger(lua, 1, &v1);
+    luabb_tointeger(lua, 2, &v2);
+    return int_arithmetic(lua, op, v1, v2);
+}
+
 static int l_real_new(Lua);
-static int l_real_arithmetic(Lua lua, operation_t op)
+static int real_arithmetic(Lua lua, operation_t op, double v1, double v2)
 {
-    double v1, v2;
-    luabb_toreal(lua, 1, &v1);
-    luabb_toreal(lua, 2, &v2);
     l_real_new(lua);
     lua_real_t *v = (lua_real_t *)lua_topointer(lua, -1);
     switch (op) {
@@ -1160,6 +1241,14 @@ static int l_real_arithmetic(Lua lua, operation_t op)
     return 1;
 }
 
+static int l_real_arithmetic(Lua lua, operation_t op)
+{
+    double v1, v2;
+    luabb_toreal(lua, 1, &v1);
+    luabb_toreal(lua, 2, &v2);
+    return real_arithmetic(lua, op, v1, v2);
+}
+
 static int l_decimal_arithmetic(Lua lua, operation_t op)
 {
     switch (op) {
@@ -1235,7 +1324,7 @@ static int datetime_intvds(Lua lua, const lua_datetime_t *ldt,
     l_datetime_new(lua);
     lua_datetime_t *out = (lua_datetime_t *)lua_topointer(lua, -1);
     dttz_t dt, rs;
-    datetime_t_to_dttz(&ldt->val, &dt);
+    datetime_t_to_dttz_cached(&ldt->val, &dt);
     if (op == LUA_OP_ADD)
         add_dttz_intvds(&dt, &ds->val, &rs);
     else if (op == LUA_OP_SUB)
@@ -1318,8 +1407,8 @@ static int l_datetime_sub(Lua lua, int date, int other)
         return add_datetime_intvym(lua, d1, &ym);
     case RANK_DATETIME:
         d2 = lua_topointer(lua, 2);
-        datetime_t_to_dttz(&d1->val, &a);
-        datetime_t_to_dttz(&d2->val, &b);
+        datetime_t_to_dttz_cached(&d1->val, &a);
+        datetime_t_to_dttz_cached(&d2->val, &b);
         l_intervalds_new(lua);
         ds = (lua_intervalds_t *)lua_topointer(lua, -1);
         sub_dttz_dttz(&a, &b, &ds->val);
@@ -1349,6 +1438,16 @@ static int l_datetime_arithmetic(Lua lua, operation_t op)
 
 static int l_arithmetic(Lua lua, operation_t op)
 {
+    long long i1, i2;
+    double d1, d2;
+    rank_t r1 = num_operand(lua, 1, &i1, &d1);
+    rank_t r2 = num_operand(lua, 2, &i2, &d2);
+    if (r1 == RANK_INT && r2 == RANK_INT) {
+        return int_arithmetic(lua, op, i1, i2);
+    } else if (r1 <= RANK_REAL && r2 <= RANK_REAL) {
+        return real_arithmetic(lua, op, d1, d2);
+    }
+
     nullchk(lua, 1);
     nullchk(lua, 2);
     rank_t rank1 = getrank(lua, 1);
@@ -1716,8 +1815,8 @@ static int datetime_cmp(Lua lua)
     datetime_t a1, a2;
     luabb_todatetime(lua, 1, &a1);
     luabb_todatetime(lua, 2, &a2);
-    datetime_t_to_dttz(&a1, &d1);
-    datetime_t_to_dttz(&a2, &d2);
+    datetime_t_to_dttz_cached(&a1, &d1);
+    datetime_t_to_dttz_cached(&a2, &d2);
     return dttz_cmp(&d1, &d2);
 }
 
@@ -83,6 +83,7 @@ extern int gbl_notimeouts;
 extern int gbl_epoch_time;
 extern int gbl_allow_lua_print;
 extern int gbl_allow_lua_dynamic_libs;
+int gbl_lua_sp_pool_size = 0;
 extern int gbl_lua_prepare_max_retries;
 extern int gbl_lua_prepare_retry_sleep;
 extern int comdb2_sql_tick();
@@ -155,6 +156,15 @@ struct dbconsumer_t {
     struct bdb_queue_cursor fnd;
     struct consumer *consumer;
     genid_t genid;
+    genid_t high_genid; /* newest event handed out, to spot redeliveries */
+    int64_t get_ms;     /* when the oldest unconsumed event was handed out */
+
+    /* events returned by the last get_batch() */
+    struct bdb_queue_cursor batch_last; /* cursor before the batch */
+    genid_t *batch;
+    int nbatch;
+    int abatch;
+
     int push_tid;
     int push_seq;
     int push_epoch;
@@ -163,6 +173,7 @@ struct dbconsumer_t {
     time_t registration_time;
     char name[MAXTABLELEN];
     const char *type;
+    int partition; /* -1 if the queue is not partitioned */
 
     /* signaling from libdb on qdb insert */
     pthread_mutex_t *lock;
@@ -185,20 +196,6 @@ static void *recover_ddlk_fail_sp(struct sqlclntstate *, void *);
 
 static const int dbq_delay_ms = 1000; // ms
 
-static struct timespec setup_dbq_ts(int delay_ms)
-{
-    struct timeval a, b, c;
-    if (delay_ms > dbq_delay_ms) {
-        delay_ms = dbq_delay_ms;
-    }
-    a.tv_sec = delay_ms / 1000;
-    a.tv_usec = (delay_ms % 1000) * 1000;
-    gettimeofday(&b, NULL);
-    evutil_timeradd(&a, &b, &c);
-    struct timespec t = {.tv_sec = c.tv_sec, .tv_nsec = c.tv_usec * 1000};
-    return t;
-}
-
 #define getdb(x) (x)->thd->sqldb
 #define dbconsumer_sz(spname)                                                  \
     (sizeof(dbconsumer_t) - sizeof(trigger_reg_t) + trigger_reg_sz(spname))
@@ -423,8 +420,41 @@ static int check_retry_conditions(Lua L, trigger_reg_t *reg,
 
 pthread_mutex_t consumer_sqlthds_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-static int luabb_trigger_register(Lua L, trigger_reg_t *reg,
-                                  int register_timeoutms)
+/* Each partition of a partitioned queue is registered with the master as a
+ * trigger of its own, named "spname/partition". reg keeps the name of the
+ * procedure, as that is also the name of its queue. */
+static int trigger_partition_req(trigger_reg_t *reg, int partition,
+                                 int (*req)(trigger_reg_t *))
+{
+    if (partition < 0)
+        return req(reg);
+    char spname[MAX_SPNAME + 8];
+    snprintf(spname, sizeof(spname), "%s/%d", reg->spname, partition);
+    trigger_reg_t *t;
+    trigger_reg_init(t, spname, reg->qdb_locked);
+    t->trigger_cookie = reg->trigger_cookie;
+    return req(t);
+}
+
+/* With partition -1 and npartitions > 1, take whichever partition is free */
+static int trigger_register_partition(trigger_reg_t *reg, int npartitions,
+                                      int *partition)
+{
+    if (*partition >= 0 || npartitions <= 1)
+        return trigger_partition_req(reg, *partition, trigger_register_req);
+    int rc = CDB2_TRIG_ASSIGNED_OTHER;
+    for (int i = 0; i < npartitions; ++i) {
+        rc = trigger_partition_req(reg, i, trigger_register_req);
+        if (rc == CDB2_TRIG_REQ_SUCCESS)
+            *partition = i;
+        if (rc != CDB2_TRIG_ASSIGNED_OTHER)
+            break;
+    }
+    return rc;
+}
+
+static int luabb_trigger_register(Lua L, trigger_reg_t *reg, int npartitions,
+                                  int *partition, int register_timeoutms)
 {
     int rc;
     SP sp = getsp(L);
@@ -439,7 +469,8 @@ static int luabb_trigger_register(Lua L, trigger_reg_t *reg,
     thdpool_add_waitthd(pool);
     Pthread_mutex_unlock(&consumer_sqlthds_mutex);
 
-    while ((rc = trigger_register_req(reg)) != CDB2_TRIG_REQ_SUCCESS) {
+    while ((rc = trigger_register_partition(reg, npartitions, partition)) !=
+           CDB2_TRIG_REQ_SUCCESS) {
         /* trigger_register_req() can take up to 1 second. Tick up immediately
            after this so that it's guaranteed that the appsock thread observes
            a good query state for the next heartbeat. */
@@ -484,7 +515,8 @@ static void luabb_trigger_unregister(Lua L, dbconsumer_t *q)
     int retry = 10;
     while (retry > 0) {
         --retry;
-        rc = trigger_unregister_req(&q->info);
+        rc = trigger_partition_req(&q->info, q->partition,
+                                   trigger_unregister_req);
         /* See comments in luabb_trigger_register(). */
         comdb2_sql_tick();
         if (rc == CDB2_TRIG_REQ_SUCCESS || rc == CDB2_TRIG_ASSIGNED_OTHER)
@@ -509,8 +541,8 @@ static int stop_waiting(Lua L, dbconsumer_t *q)
     if (sp->pingpong == 2) {
         return 0;
     }
-    if (luabb_trigger_register(L, &q->info, q->register_timeoutms) !=
-        CDB2_TRIG_REQ_SUCCESS)
+    if (luabb_trigger_register(L, &q->info, 0, &q->partition,
+                               q->register_timeoutms) != CDB2_TRIG_REQ_SUCCESS)
         return 1;
     q->registration_time = time(NULL);
     return 0;
@@ -747,7 +779,8 @@ static int dbq_poll_int(Lua L, dbconsumer_t *q)
         Pthread_mutex_unlock(q->lock);
         return rc == -2 ? 0 : -1;
     }
-    rc = dbq_get(&q->iq, 0, &q->last, &f.item, NULL, NULL, &q->fnd,
+    int consumer = q->partition < 0 ? 0 : QUEUE_PARTITION_CONSUMER(0, q->partition);
+    rc = dbq_get(&q->iq, consumer, &q->last, &f.item, NULL, NULL, &q->fnd,
                  &f.seq, bdb_get_lid_from_cursortran(clnt->dbtran.cursor_tran));
     Pthread_mutex_unlock(q->lock);
     comdb2_sql_tick();
@@ -760,6 +793,16 @@ static int dbq_poll_int(Lua L, dbconsumer_t *q)
             SP sp = getsp(L);
             luabb_error(L, sp, err);
             free(err);
+        } else {
+            /* events come out in genid order, so one at or before the
+             * newest we've handed out is being handed out again */
+            int redelivered = q->high_genid &&
+                              bdb_cmp_genids(q->genid, q->high_genid) <= 0;
+            if (!redelivered)
+                q->high_genid = q->genid;
+            if (q->get_ms == 0)
+                q->get_ms = comdb2_time_epochms();
+            dbqueuedb_count_dequeue(q->iq.usedb, redelivered);
         }
         return rc;
     }
@@ -769,27 +812,31 @@ static int dbq_poll_int(Lua L, dbconsumer_t *q)
     return -1;
 }
 
+// Waits up to delay_ms for an event.  Enqueues wake us as soon as they
+// land, so there is no polling; waits are still cut into dbq_delay_ms
+// pieces so that stop_waiting gets to heartbeat and give up locks.
 static int dbq_poll(Lua L, dbconsumer_t *q, int delay_ms)
 {
     SP sp = getsp(L);
+    int64_t deadline = comdb2_time_epochms() + delay_ms;
     while (1) {
         if (stop_waiting(L, q)) {
             return -1;
         }
         int rc;
         uint8_t status;
-        struct timespec ts;
+        // Take seq before looking, so an enqueue after we look wakes us
+        uint64_t seq = bdb_trigger_seq(q->iq.usedb->handle);
         Pthread_mutex_lock(q->lock);
-again:  status = *q->status;
+        status = *q->status;
         if (status == TRIGGER_SUBSCRIPTION_OPEN) {
             rc = dbq_poll_int(L, q); // call will release q->lock
         } else if (status == TRIGGER_SUBSCRIPTION_PAUSED) {
-            if (stop_waiting(L, q)) {
-                return -1;
-            }
-            ts = setup_dbq_ts(delay_ms);
-            pthread_cond_timedwait(q->cond, q->lock, &ts); /* RC IGNORED */
-            goto again;
+            // wait for unpause however long it takes, as we always have
+            Pthread_mutex_unlock(q->lock);
+            bdb_trigger_wait(q->iq.usedb->handle, seq, dbq_delay_ms);
+            deadline = comdb2_time_epochms() + delay_ms;
+            continue;
         } else {
             assert(status == TRIGGER_SUBSCRIPTION_CLOSED);
             Pthread_mutex_unlock(q->lock);
@@ -802,21 +849,24 @@ again:  status = *q->status;
             luabb_error(L, sp, "failed to read from:%s rc:%d", q->info.spname, rc);
             return rc;
         }
-        if (delay_ms <= 0) {
+        int64_t left = deadline - comdb2_time_epochms();
+        if (left <= 0) {
             return 0;
         }
-        ts = setup_dbq_ts(delay_ms);
-        Pthread_mutex_lock(q->lock);
-        if (pthread_cond_timedwait(q->cond, q->lock, &ts) == 0) {
-            // was woken up -- try getting from queue
-            goto again;
-        }
+        bdb_trigger_wait(q->iq.usedb->handle, seq,
+                         left < dbq_delay_ms ? left : dbq_delay_ms);
+    }
+}
+
+// Returns 1 and pushes the next event if one is ready; doesn't wait
+static int dbq_poll_nowait(Lua L, dbconsumer_t *q)
+{
+    Pthread_mutex_lock(q->lock);
+    if (*q->status != TRIGGER_SUBSCRIPTION_OPEN) {
         Pthread_mutex_unlock(q->lock);
-        delay_ms -= dbq_delay_ms;
-        if (delay_ms <= 0) {
-            return 0;
-        }
+        return 0;
     }
+    return dbq_poll_int(L, q); // call will release q->lock
 }
 
 // this call will block until queue item available
@@ -896,6 +946,68 @@ static inline int push_and_return(Lua L, int rc)
     return 1;
 }
 
+/*
+** Returns an array of up to n events.  Waits timeout ms (forever if not
+** given) for the first event, but not for the rest.  The events stay in the
+** queue until consume_batch().  Calling get_batch() again without consuming
+** returns the same events first.
+*/
+static int dbconsumer_get_batch(Lua L)
+{
+    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
+    lua_Integer n, delay_ms = -1;
+    lua_Number arg;
+    genid_t *batch;
+    int rc;
+
+    arg = luaL_checknumber(L, 2);
+    lua_number2integer(n, arg);
+    if (n < 1) {
+        return luaL_error(L, "bad batch size:%d", (int)n);
+    }
+    if (lua_gettop(L) >= 3) {
+        arg = luaL_checknumber(L, 3);
+        lua_number2integer(delay_ms, arg);
+        if (delay_ms < 0) {
+            delay_ms = 0;
+        }
+    }
+    lua_settop(L, 1);
+
+    if (q->nbatch) {
+        q->last = q->batch_last;
+    }
+    q->batch_last = q->last;
+    q->nbatch = 0;
+    if (q->abatch < n) {
+        if ((batch = realloc(q->batch, n * sizeof(genid_t))) == NULL) {
+            return luaL_error(L, "%s: out of memory", __func__);
+        }
+        q->batch = batch;
+        q->abatch = n;
+    }
+
+    lua_newtable(L);
+    if (delay_ms < 0) {
+        rc = dbconsumer_get_int(L, q);
+    } else {
+        rc = dbq_poll(L, q, delay_ms);
+    }
+    while (rc == 1) {
+        q->batch[q->nbatch++] = q->genid;
+        lua_rawseti(L, -2, q->nbatch);
+        q->last = q->fnd;
+        if (q->nbatch == n) {
+            break;
+        }
+        rc = dbq_poll_nowait(L, q);
+    }
+    if (rc < 0 && q->nbatch == 0) {
+        return luaL_error(L, getsp(L)->error);
+    }
+    return 1;
+}
+
 static const char *begin_parent(Lua);
 static const char *commit_parent(Lua);
 
@@ -923,14 +1035,9 @@ static void reset_consumer_cursor(struct dbconsumer_t *q)
 ** Start a new transaction in either case.
 ** Commit transaction only for (1)
 */
-static int dbconsumer_consume(Lua L)
+static int dbconsumer_consume_int(Lua L, dbconsumer_t *q, genid_t *genids,
+                                  int ngenids)
 {
-    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
-
-    if (q->genid == 0) {
-        return push_and_return(L, -1);
-    }
-
     int rc = 0;
     const char *err = NULL;
     SP sp = getsp(L);
@@ -955,7 +1062,10 @@ static int dbconsumer_consume(Lua L)
     if ((rc = grab_qdb_table_read_lock(clnt, q->name, &q->iq.usedb, &q->info, 0, NULL)) != 0) {
         luaL_error(L, "%s: grab_qdb_table_read_lock rc:%d\n", __func__, rc);
     }
-    if ((rc = osql_dbq_consume_logic(clnt, q->info.spname, q->genid)) != 0) {
+    for (int i = 0; i < ngenids && rc == 0; i++) {
+        rc = osql_dbq_consume_logic(clnt, q->info.spname, genids[i]);
+    }
+    if (rc != 0) {
         if (implicit_txn) {
             err = db_rollback_int(L, &rc);
             if (err || rc || clnt->intrans) {
@@ -972,10 +1082,32 @@ static int dbconsumer_consume(Lua L)
                        __func__, clnt->intrans, err, rc);
         }
     }
+    dbqueuedb_count_ack(q->iq.usedb, ngenids, comdb2_time_epochms() - q->get_ms);
+    q->get_ms = 0;
     reset_consumer_cursor(q);
+    q->nbatch = 0;
     return push_and_return(L, rc);
 }
 
+static int dbconsumer_consume(Lua L)
+{
+    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
+    if (q->genid == 0) {
+        return push_and_return(L, -1);
+    }
+    return dbconsumer_consume_int(L, q, &q->genid, 1);
+}
+
+/* Consume every event returned by the last get_batch() in one transaction */
+static int dbconsumer_consume_batch(Lua L)
+{
+    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
+    if (q->nbatch == 0) {
+        return push_and_return(L, -1);
+    }
+    return dbconsumer_consume_int(L, q, q->batch, q->nbatch);
+}
+
 static int dbconsumer_next(Lua L)
 {
     dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
@@ -1002,6 +1134,8 @@ static int dbconsumer_next(Lua L)
     if (rc) {
         return luaL_error(L, "%s osql_delrec_qdb rc:%d", __func__, rc);
     }
+    dbqueuedb_count_ack(q->iq.usedb, 1, comdb2_time_epochms() - q->get_ms);
+    q->get_ms = 0;
     q->last = q->fnd;
     return push_and_return(L, 0);
 }
@@ -1036,6 +1170,8 @@ static int dbconsumer_free(Lua L)
     ctrace("%s:%s %016" PRIx64 " unregister req\n", q->type, q->info.spname, q->info.trigger_cookie);
     luabb_trigger_unregister(L, q);
     ctrace("%s:%s %016" PRIx64 " unregister done\n", q->type, q->info.spname, q->info.trigger_cookie);
+    free(q->batch);
+    q->batch = NULL;
     return 0;
 }
 
@@ -3093,10 +3229,41 @@ static int get_func_by_name(Lua L, const char *func, char **err)
     return 0;
 }
 
+/* The chunk last compiled in a Lua state is kept in its registry with its
+ * source, so that running the same source again skips the compiler. The
+ * chunk itself still runs every time, to define the procedure afresh. */
+#define SP_CHUNK_SRC "comdb2_chunk_src"
+#define SP_CHUNK "comdb2_chunk"
+
+static int load_chunk(Lua L, const char *src)
+{
+    size_t len = strlen(src), cached_len;
+    const char *cached;
+    int rc;
+
+    lua_getfield(L, LUA_REGISTRYINDEX, SP_CHUNK_SRC);
+    cached = lua_tolstring(L, -1, &cached_len);
+    if (cached && cached_len == len && memcmp(cached, src, len) == 0) {
+        lua_pop(L, 1);
+        lua_getfield(L, LUA_REGISTRYINDEX, SP_CHUNK);
+        if (lua_isfunction(L, -1))
+            return 0;
+    }
+    lua_pop(L, 1);
+    if ((rc = luaL_loadbuffer(L, src, len, src)) != 0)
+        return rc;
+    lua_pushvalue(L, -1);
+    lua_setfield(L, LUA_REGISTRYINDEX, SP_CHUNK);
+    lua_pushlstring(L, src, len);
+    lua_setfield(L, LUA_REGISTRYINDEX, SP_CHUNK_SRC);
+    return 0;
+}
+
 static int process_src(Lua L, const char *src, char **err)
 {
     int rc;
-    if ((rc = luaL_dostring(L, src)) != 0) {
+    if ((rc = load_chunk(L, src)) != 0 ||
+        (rc = lua_pcall(L, 0, LUA_MULTRET, 0)) != 0) {
         *err = strdup(lua_tostring(L, -1));
         return -1;
     }
@@ -3202,6 +3369,94 @@ static void close_sp_int(SP sp, int freesp)
     free(sp);
 }
 
+/* Idle Lua states of connections that went away.  The next connection of
+ * the same user to call the same procedure takes one instead of building a
+ * state and compiling the procedure.  States are dropped once any procedure
+ * changes (gbl_lua_version moves on), and the oldest go past
+ * lua_sp_pool_size. */
+static pthread_mutex_t sp_pool_lk = PTHREAD_MUTEX_INITIALIZER;
+static TAILQ_HEAD(stored_proc_pool, stored_proc) sp_pool =
+    TAILQ_HEAD_INITIALIZER(sp_pool);
+static int sp_pool_count;
+
+/* An idle SP has nothing to reset and no clnt */
+static void free_pooled_sp(SP sp)
+{
+    comdb2ma mspace = sp->mspace;
+    lua_close(sp->lua);
+    free_spversion(sp);
+    comdb2ma_destroy(mspace);
+    free(sp);
+}
+
+static SP sp_pool_get(const char *spname, struct sqlclntstate *clnt)
+{
+    TAILQ_HEAD(, stored_proc) stale = TAILQ_HEAD_INITIALIZER(stale);
+    SP sp, next, found = NULL;
+
+    Pthread_mutex_lock(&sp_pool_lk);
+    for (sp = TAILQ_FIRST(&sp_pool); sp; sp = next) {
+        next = TAILQ_NEXT(sp, pool_entry);
+        if (sp->lua_version != gbl_lua_version ||
+            sp->had_allow_lua_dynamic_libs != gbl_allow_lua_dynamic_libs) {
+            TAILQ_REMOVE(&sp_pool, sp, pool_entry);
+            TAILQ_INSERT_TAIL(&stale, sp, pool_entry);
+            --sp_pool_count;
+        } else if (found == NULL && strcmp(sp->spname, spname) == 0 &&
+                   strcmp(sp->pool_user, clnt->current_user.name) == 0) {
+            TAILQ_REMOVE(&sp_pool, sp, pool_entry);
+            --sp_pool_count;
+            found = sp;
+        }
+    }
+    Pthread_mutex_unlock(&sp_pool_lk);
+
+    while ((sp = TAILQ_FIRST(&stale)) != NULL) {
+        TAILQ_REMOVE(&stale, sp, pool_entry);
+        free_pooled_sp(sp);
+    }
+    return found;
+}
+
+void release_sp(struct sqlclntstate *clnt)
+{
+    TAILQ_HEAD(, stored_proc) evicted = TAILQ_HEAD_INITIALIZER(evicted);
+    SP sp = clnt->sp;
+
+    if (sp == NULL || gbl_lua_sp_pool_size <= 0 || sp->lua == NULL ||
+        sp->src == NULL || sp->parent != sp || !LIST_EMPTY(&sp->dbthds) ||
+        sp->lua_version != gbl_lua_version ||
+        sp->had_allow_lua_dynamic_libs != gbl_allow_lua_dynamic_libs ||
+        clnt->want_stored_procedure_trace ||
+        clnt->want_stored_procedure_debug) {
+        close_sp(clnt);
+        return;
+    }
+    reset_sp(sp);
+    lua_settop(sp->lua, 0);
+    strncpy0(sp->pool_user, clnt->current_user.name, sizeof(sp->pool_user));
+    sp->clnt = sp->debug_clnt = NULL;
+    sp->thd = NULL;
+    sp->emit_mutex = NULL;
+    clnt->sp = NULL;
+
+    Pthread_mutex_lock(&sp_pool_lk);
+    TAILQ_INSERT_HEAD(&sp_pool, sp, pool_entry);
+    ++sp_pool_count;
+    while (sp_pool_count > gbl_lua_sp_pool_size) {
+        sp = TAILQ_LAST(&sp_pool, stored_proc_pool);
+        TAILQ_REMOVE(&sp_pool, sp, pool_entry);
+        TAILQ_INSERT_TAIL(&evicted, sp, pool_entry);
+        --sp_pool_count;
+    }
+    Pthread_mutex_unlock(&sp_pool_lk);
+
+    while ((sp = TAILQ_FIRST(&evicted)) != NULL) {
+        TAILQ_REMOVE(&evicted, sp, pool_entry);
+        free_pooled_sp(sp);
+    }
+}
+
 static void free_dbthread_type(dbthread_type *thd)
 {
     if (!thd) return;
@@ -3472,6 +3727,69 @@ static int dbstmt_exec(Lua lua)
     return luabb_error(lua, sp, errstr);
 }
 
+/* Run the statement once for every row of an array, binding each row's
+ * values by position (array rows) or by name (rows keyed on parameter name),
+ * without going back to Lua in between. */
+static int dbstmt_exec_batch(Lua lua)
+{
+    SP sp = getsp(lua);
+    sqlite3 *sqldb = getdb(sp);
+
+    luaL_checkudata(lua, 1, dbtypes.dbstmt);
+    luaL_checktype(lua, 2, LUA_TTABLE);
+    lua_settop(lua, 2);
+    dbstmt_t *dbstmt = lua_touserdata(lua, 1);
+    no_stmt_chk(lua, dbstmt);
+    sqlite3_stmt *stmt = dbstmt->stmt;
+    int rows = lua_objlen(lua, 2);
+    int changed = 0;
+    int rc = SQLITE_DONE;
+    if (dbstmt->fetched) {
+        dbstmt->fetched = 0;
+        sqlite3_reset(stmt);
+    }
+    setup_first_sqlite_step(sp, dbstmt, 0);
+    lua_begin_step(sp->clnt, sp, stmt);
+    for (int i = 1; i <= rows && rc == SQLITE_DONE; ++i) {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        lua_rawgeti(lua, 2, i);
+        if (!lua_istable(lua, 3)) {
+            lua_end_step(sp->clnt, sp, stmt);
+            sqlite3_reset(stmt);
+            return luabb_error(lua, sp, "bad argument to 'exec_batch': row %d "
+                               "is not a table", i);
+        }
+        lua_pushnil(lua);
+        while (lua_next(lua, 3)) {
+            rc = stmt_bind_int(lua, stmt, 4, 5);
+            lua_pop(lua, 1);
+            if (rc != SQLITE_OK) {
+                lua_end_step(sp->clnt, sp, stmt);
+                sqlite3_reset(stmt);
+                return luabb_error(lua, sp, "failed to bind row %d", i);
+            }
+        }
+        lua_pop(lua, 1);
+        while ((rc = sqlite3_maybe_step(sp->clnt, stmt)) == SQLITE_ROW) {
+            lua_another_step(sp->clnt, stmt, rc);
+        }
+        changed += sqlite3_changes(sqldb);
+    }
+    lua_end_step(sp->clnt, sp, stmt);
+    dbstmt->rows_changed = changed;
+    if (rc == SQLITE_DONE) {
+        sqlite3_reset(stmt);
+        db_reset(lua);
+        lua_pushinteger(lua, 0);
+        return 1;
+    }
+    const char *errstr = NULL;
+    sql_check_errors(sp->clnt, sqldb, stmt, &errstr);
+    donate_stmt(getsp(lua), dbstmt);
+    return luabb_error(lua, sp, errstr);
+}
+
 static int dbstmt_fetch(Lua lua)
 {
     SP sp = getsp(lua);
@@ -4174,6 +4492,25 @@ static int db_emit(Lua L)
     return db_emit_int(L);
 }
 
+/* Emit every row of an array of rows; the loop stays in C. */
+static int db_emit_rows(Lua L)
+{
+    luaL_checkudata(L, 1, dbtypes.db);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    int rows = lua_objlen(L, 2);
+    lua_settop(L, 2);
+    lua_pushcfunction(L, db_emit_int);
+    for (int i = 1; i <= rows; ++i) {
+        lua_pushvalue(L, 3);
+        lua_rawgeti(L, 2, i);
+        lua_call(L, 1, 1);
+        int rc = lua_tointeger(L, -1);
+        lua_pop(L, 1);
+        if (rc) return push_and_return(L, rc);
+    }
+    return push_and_return(L, 0);
+}
+
 static int db_emiterror(lua_State *lua)
 {
     SP sp = getsp(lua);
@@ -4740,15 +5077,22 @@ static int db_guid_str(Lua lua)
     return 1;
 }
 
-void force_unregister(Lua L, trigger_reg_t *reg)
+static void force_unregister_partition(Lua L, trigger_reg_t *reg,
+                                       int partition)
 {
     // setup fake dbconsumer_t to send unregister
     dbconsumer_t *q = alloca(dbconsumer_sz(reg->spname));
     q->lock = NULL;
+    q->partition = partition;
     memcpy(&q->info, reg, trigger_reg_sz(reg->spname));
     luabb_trigger_unregister(L, q);
 }
 
+void force_unregister(Lua L, trigger_reg_t *reg)
+{
+    force_unregister_partition(L, reg, -1);
+}
+
 static int get_qdb(Lua L, struct sqlclntstate *clnt, char *spname,
                    struct dbtable **pDb, int *got_lock, char **err)
 {
@@ -4817,13 +5161,15 @@ static int db_consumer(Lua L)
     enum consumer_t type = dbqueue_consumer_type(consumer);
     const char *type_str = type == CONSUMER_TYPE_DYNLUA ? "consumer" : "trigger";
 
+    int npartitions = javasp_queue_partitions(db->tablename);
+    int partition = -1;
     trigger_reg_t *t;
     trigger_reg_init(t, sp->spname, got_lock);
     ctrace("%s:%s %016" PRIx64 " register req\n", type_str, t->spname, t->trigger_cookie);
-    rc = luabb_trigger_register(L, t, register_timeoutms);
+    rc = luabb_trigger_register(L, t, npartitions, &partition, register_timeoutms);
     if (rc != CDB2_TRIG_REQ_SUCCESS) {
         ctrace("%s:%s %016" PRIx64 " register failed rc:%d\n", type_str, t->spname, t->trigger_cookie, rc);
-        force_unregister(L, t);
+        force_unregister_partition(L, t, partition);
         if (rc == -2) {
             /* timeout */
             lua_pushnil(L);
@@ -4831,11 +5177,13 @@ static int db_consumer(Lua L)
         }
         return luaL_error(L, sp->error);
     }
-    ctrace("%s:%s %016" PRIx64 " register success\n", type_str, t->spname, t->trigger_cookie);
+    ctrace("%s:%s %016" PRIx64 " register success partition:%d\n", type_str, t->spname,
+           t->trigger_cookie, partition);
 
     dbconsumer_t *q;
     size_t sz = dbconsumer_sz(sp->spname);
     new_lua_t_sz(L, q, DBTYPES_DBCONSUMER, sz);
+    q->partition = partition;
     if (setup_dbconsumer(q, consumer, db, t) != 0) {
         luabb_error(L, sp, "failed to register consumer with qdb");
         lua_pushnil(L);
@@ -4951,6 +5299,7 @@ static const luaL_Reg db_funcs[] = {
     {"copyrow", db_copyrow},
     {"csv_to_table", db_csv_to_table},
     {"emit", db_emit},
+    {"emit_rows", db_emit_rows},
     {"emiterror", db_emiterror},
     {"error", db_error},
     {"exec", db_exec},
@@ -5041,6 +5390,7 @@ static const struct luaL_Reg dbstmt_funcs[] = {
     {"column_type", dbstmt_column_type},
     {"emit", dbstmt_emit},
     {"exec", dbstmt_exec},
+    {"exec_batch", dbstmt_exec_batch},
     {"fetch", dbstmt_fetch},
     {"rows_changed", dbstmt_rows_changed},
     {NULL, NULL}};
@@ -5189,6 +5539,8 @@ static const struct luaL_Reg dbconsumer_funcs[] = {
     {"get", dbconsumer_get},
     {"poll", dbconsumer_poll},
     {"consume", dbconsumer_consume},
+    {"get_batch", dbconsumer_get_batch},
+    {"consume_batch", dbconsumer_consume_batch},
     {"next", dbconsumer_next},
     {"emit", dbconsumer_emit},
     {"emit_timeout", dbconsumer_emit_timeout},
@@ -6184,6 +6536,11 @@ static int setup_sp_int(char *spname, struct sqlthdstate *thd, struct sqlclntsta
                         int trigger, int *new_vm /*out param*/, char **err /*out param*/)
 {
     SP sp = clnt->sp;
+    if (sp == NULL && !trigger && !clnt->want_stored_procedure_trace &&
+        !clnt->want_stored_procedure_debug &&
+        (sp = sp_pool_get(spname, clnt)) != NULL) {
+        clnt->sp = sp;
+    }
     if (sp) {
         if (clnt->want_stored_procedure_trace ||
             clnt->want_stored_procedure_debug ||
@@ -30,6 +30,8 @@ int exec_procedure(struct sqlthdstate *, struct sqlclntstate *, char **err);
 void exec_thread(struct sqlthdstate *, struct sqlclntstate *);
 void *exec_trigger(char *);
 void close_sp(struct sqlclntstate *);
+/* Like close_sp(), but keep the Lua state for another connection */
+void release_sp(struct sqlclntstate *);
 int is_pingpong(struct sqlclntstate *);
 
 #endif
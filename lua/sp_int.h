@@ -71,6 +71,9 @@ struct stored_proc {
     dbstmt_t *prev_dbstmt; // for db_bind -- deprecated
     dbconsumer_t *consumer; // commit/rollback need to clear
 
+    TAILQ_ENTRY(stored_proc) pool_entry; // while idle in the pool
+    char pool_user[MAX_USERNAME_LEN];   // user it last ran for
+
     unsigned initial           : 1;
     /*
     pingpong = 0 -- not waiting to hear from client
@@ -36,6 +36,7 @@
 #include <time.h>
 #include <sys/time.h>
 #include <sys/resource.h>
+#include <sys/mman.h>
 
 #include <dlmalloc.h>
 #include <list.h>
@@ -137,6 +138,7 @@ struct comdb2mspace {
     struct comdb2mspace *parent;           /* parent msapce. */
 
     struct comdb2bmspace *bm; /* points to a blocking allocator */
+    int tcache_idx;           /* static index if frees go to thread caches */
 
     mspace m; /* dlmalloc mspace */
 
@@ -258,6 +260,13 @@ static struct {
 
 int gbl_mem_nice = 0;
 
+/* keep per-thread caches of small blocks of the static areas */
+int gbl_mem_tcache = 0;
+/* huge page size in MB for large regions and segments, 0 if off */
+int gbl_hugepage_mb = 0;
+/* set once the mspaces are going away */
+static int tcache_dead;
+
 /* internal comdb2ma creation */
 static comdb2ma comdb2ma_create_int(void *base, size_t init_sz, size_t max_cap,
                                     const char *name, const char *scope,
@@ -447,6 +456,8 @@ int comdb2ma_init(size_t init_sz, size_t max_cap)
                     NULL, COMDB2MA_MT_SAFE, NULL, NULL, __FILE__, __func__,
                     __LINE__);
 
+                if (COMDB2_STATIC_MAS[i] != NULL)
+                    COMDB2_STATIC_MAS[i]->tcache_idx = i;
                 if (COMDB2_STATIC_MAS[i] == NULL) {
                     /* oops. rollback all previous progress */
                     rc = errno;
@@ -484,6 +495,9 @@ int comdb2ma_exit(void)
     if (root.m == NULL)
         rc = EPERM;
     else {
+        /* blocks still in thread caches go down with their mspaces */
+        tcache_dead = 1;
+
         /* destroy all mspaces */
         LISTC_FOR_EACH_SAFE(&(root.list), curpos, tmppos, lnk)
         {
@@ -754,6 +768,156 @@ static void get_stack_frames(void **fp, mspace m)
 #define get_stack_frames(fp, m)
 #endif
 
+/*
+ * Thread caches
+ *
+ * The static areas are shared by every thread that has no zone of its own,
+ * and each malloc and free takes the area's mutex.  With mem_tcache on, a
+ * free of a small block from a static area parks it in a magazine of the
+ * freeing thread instead, and mallocs of that size class are served from
+ * there.  Magazines are refilled from, and drained to, the mspace a batch at
+ * a time under one hold of the mutex.  Parked blocks are still allocated as
+ * far as dlmalloc can tell, so they are charged to their area in
+ * comdb2ma_stats, as they were before the free.  Static areas live until
+ * comdb2ma_exit(), so a parked block can't outlive its mspace but there.
+ */
+#define TCACHE_MIN_SHIFT 4 /* 16 bytes */
+#define TCACHE_CLASSES 6   /* up to 512 bytes */
+#define TCACHE_SLOTS 32
+#define TCACHE_BATCH (TCACHE_SLOTS / 2)
+
+struct tcache_mag {
+    int n;
+    void *slot[TCACHE_SLOTS];
+};
+
+struct tcache {
+    struct tcache_mag mag[COMDB2MA_COUNT][TCACHE_CLASSES];
+};
+
+static pthread_once_t tcache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t tcache_key;
+static __thread struct tcache *t_tcache;
+
+static void tcache_flush(struct tcache_mag *mag, comdb2ma cm, int keep)
+{
+    if (COMDB2MA_LOCK(cm) != 0)
+        return;
+    while (mag->n > keep) {
+        mspace_free(cm->m, (void **)mag->slot[--mag->n] + COMDB2MA_SENTINEL_OFS);
+#ifdef PER_THREAD_MALLOC
+        --cm->refs;
+#endif
+    }
+    COMDB2MA_UNLOCK(cm);
+}
+
+static void tcache_destroy(void *arg)
+{
+    struct tcache *tc = arg;
+    int i, c;
+
+    if (!tcache_dead) {
+        for (i = 1; i != COMDB2MA_COUNT; ++i) {
+            for (c = 0; c != TCACHE_CLASSES; ++c) {
+                if (tc->mag[i][c].n > 0 && COMDB2_STATIC_MAS[i] != NULL)
+                    tcache_flush(&tc->mag[i][c], COMDB2_STATIC_MAS[i], 0);
+            }
+        }
+    }
+    free(tc);
+}
+
+static void tcache_init(void)
+{
+    Pthread_key_create(&tcache_key, tcache_destroy);
+}
+
+static struct tcache *tcache_get(void)
+{
+    struct tcache *tc = t_tcache;
+    if (tc == NULL) {
+        (void)pthread_once(&tcache_once, tcache_init);
+        if ((tc = calloc(1, sizeof(struct tcache))) == NULL)
+            return NULL;
+        Pthread_setspecific(tcache_key, tc);
+        t_tcache = tc;
+    }
+    return tc;
+}
+
+/* size class serving requests of up to `size' bytes, or -1 */
+static inline int tcache_class(size_t size)
+{
+    int c = 0;
+    if (size > ((size_t)1 << (TCACHE_MIN_SHIFT + TCACHE_CLASSES - 1)))
+        return -1;
+    while (((size_t)1 << (TCACHE_MIN_SHIFT + c)) < size)
+        ++c;
+    return c;
+}
+
+static void *tcache_malloc(comdb2ma cm, size_t size)
+{
+    struct tcache *tc;
+    struct tcache_mag *mag;
+    size_t csz;
+    void **out;
+    int c;
+
+    if ((c = tcache_class(size)) < 0 || (tc = tcache_get()) == NULL)
+        return NULL;
+    mag = &tc->mag[cm->tcache_idx][c];
+
+    if (mag->n == 0 && COMDB2MA_LOCK(cm) == 0) {
+        csz = (size_t)1 << (TCACHE_MIN_SHIFT + c);
+        while (mag->n < TCACHE_BATCH && !COMDB2MA_FULL(cm)) {
+            out = mspace_malloc(cm->m, csz + COMDB2MA_OVERHEAD(0));
+            if (out == NULL)
+                break;
+#ifdef PER_THREAD_MALLOC
+            ++cm->refs;
+#endif
+            out[0] = COMDB2MA_SENTINEL(out, cm);
+            out[1] = (void *)cm;
+            mag->slot[mag->n++] = out - COMDB2MA_SENTINEL_OFS;
+        }
+        COMDB2MA_UNLOCK(cm);
+    }
+
+    return mag->n > 0 ? mag->slot[--mag->n] : NULL;
+}
+
+/* Park a block being freed.  Returns 0 if it has to go to the mspace. */
+static int tcache_free(comdb2ma cm, void **p)
+{
+    struct tcache *tc;
+    struct tcache_mag *mag;
+    size_t usz;
+    int c;
+
+    if (COMDB2MA_ISDEBUG(p) || (tc = tcache_get()) == NULL)
+        return 0;
+
+    /* a block serves the largest class it is big enough for */
+    usz = comdb2_malloc_usable_size(p);
+    if (usz < ((size_t)1 << TCACHE_MIN_SHIFT))
+        return 0;
+    for (c = TCACHE_CLASSES - 1; ((size_t)1 << (TCACHE_MIN_SHIFT + c)) > usz;
+         --c)
+        ;
+    if (c == TCACHE_CLASSES - 1 && usz >= ((size_t)2 << (TCACHE_MIN_SHIFT + c)))
+        return 0;
+
+    mag = &tc->mag[cm->tcache_idx][c];
+    if (mag->n == TCACHE_SLOTS)
+        tcache_flush(mag, cm, TCACHE_SLOTS - TCACHE_BATCH);
+    if (mag->n == TCACHE_SLOTS)
+        return 0;
+    mag->slot[mag->n++] = p;
+    return 1;
+}
+
 /*
  * Memory block layout
  * +----------------+
@@ -789,6 +953,10 @@ void *comdb2_malloc(comdb2ma cm, size_t size)
     int d = debug_started;
     char *fp;
 
+    if (cm->tcache_idx && gbl_mem_tcache && !(d && cm->debug) &&
+        (out = tcache_malloc(cm, size)) != NULL)
+        return (void *)out;
+
     if (size > COMDB2MA_MAX_MEM) {
         // force failure if integer overflow
         errno = ENOMEM;
@@ -1041,10 +1209,11 @@ void comdb2_free(void *ptr)
         } else {
             cm = COMDB2MA_ALLOCATOR(p);
 
-            if (cm->bm == NULL)
-                comdb2_free_int(cm, ptr);
-            else
+            if (cm->bm != NULL)
                 comdb2_bfree(cm->bm, ptr);
+            else if (!cm->tcache_idx || !gbl_mem_tcache || tcache_dead ||
+                     !tcache_free(cm, p))
+                comdb2_free_int(cm, ptr);
         }
     }
 }
@@ -1247,6 +1416,7 @@ static comdb2ma comdb2ma_create_int(void *base, size_t init_sz, size_t max_cap,
 
     out->parent = NULL;
     out->bm = NULL;
+    out->tcache_idx = 0;
     out->use_lock = lock;
     out->init_sz = init_sz;
     out->cap = max_cap;
@@ -2105,25 +2275,46 @@ static int wildcard_match(const char *s, const char *p)
     return (*p == 0) ? 0 : 1;
 }
 
+/*
+ * Segments come from, and go back to, the system malloc, so they can't be
+ * mapped on explicit huge pages.  Ask for transparent huge pages over the
+ * 2MB-aligned part of large ones instead.
+ */
+static void *advise_huge(void *mem, size_t sz)
+{
+#ifdef MADV_HUGEPAGE
+    const uintptr_t huge = 2UL << 20;
+    uintptr_t beg, end;
+
+    if (gbl_hugepage_mb && mem != NULL && sz >= huge) {
+        beg = ((uintptr_t)mem + huge - 1) & ~(huge - 1);
+        end = ((uintptr_t)mem + sz) & ~(huge - 1);
+        if (end > beg)
+            (void)madvise((void *)beg, end - beg, MADV_HUGEPAGE);
+    }
+#endif
+    return mem;
+}
+
 static void *abortable_malloc(size_t sz)
 {
     void *mem = malloc(sz);
     COMDB2MA_MEMCHK(mem, sz);
-    return mem;
+    return advise_huge(mem, sz);
 }
 
 static void *abortable_realloc(void *ptr, size_t sz)
 {
     void *mem = realloc(ptr, sz);
     COMDB2MA_MEMCHK(mem, sz);
-    return mem;
+    return advise_huge(mem, sz);
 }
 
 static void *abortable_calloc(size_t n, size_t sz)
 {
     void *mem = calloc(n, sz);
     COMDB2MA_MEMCHK(mem, sz);
-    return mem;
+    return advise_huge(mem, n * sz);
 }
 
 static void pfx_ctrace(const char *format, ...)
@@ -73,6 +73,7 @@
 #include "thread_util.h"
 #include <timer_util.h>
 #include <comdb2_atomic.h>
+#include <tracering.h>
 
 #ifdef UDP_DEBUG
 static int curr_udp_cnt = 0;
@@ -1818,31 +1819,29 @@ static void dump_queue(netinfo_type *netinfo_ptr, host_node_type *host_node_ptr)
     }
 }
 
-static int net_send_int(netinfo_type *netinfo_ptr, const char *host,
-                        int usertype, void *data, int datalen, int nodelay,
-                        int numtails, void **tails, int *taillens, int nodrop,
-                        int inorder, int trace)
+/* Send a message made of the segments iov[1..iovcount-1]; iov[0] is
+ * reserved for the message header.  The segments are only read, and are
+ * copied once into the host's write queue. */
+static int net_send_iov_int(netinfo_type *netinfo_ptr, const char *host,
+                            int usertype, struct iovec *iov, int iovcount,
+                            int nodelay, int nodrop, int inorder, int trace)
 {
-    if (gbl_libevent) {
-        int f = 0;
-        if (nodelay) f |= NET_SEND_NODELAY;
-        if (nodrop) f |= NET_SEND_NODROP;
-        return net_send_evbuffer(netinfo_ptr, host, usertype, data, datalen, numtails, tails, taillens, f);
-    }
     host_node_type *host_node_ptr;
     net_send_message_header tmphd, msghd;
     uint8_t *p_buf, *p_buf_end;
     int rc;
-    struct iovec iov[35];
-    int iovcount;
-    int total_tails_len = 0;
+    int datalen = 0;
     int i;
-    int tailen;
-#if 0
-   if (strcmp(netinfo_ptr->service, "offloadsql") == 0) {
-       printf("net %s usertype %d to %s\n", netinfo_ptr->service, usertype, host);
-   }
-#endif
+
+    TRACE_RING(TRACE_NET, "%s send to %s type %lld iovs %lld",
+               netinfo_ptr->service, host, usertype, iovcount);
+
+    if (gbl_libevent) {
+        int f = 0;
+        if (nodelay) f |= NET_SEND_NODELAY;
+        if (nodrop) f |= NET_SEND_NODROP;
+        return net_send_iov_evbuffer(netinfo_ptr, host, usertype, iov, iovcount, f);
+    }
 #ifdef UDP_DEBUG
     if (usertype == 2) {
         int last = __atomic_exchange_n(&curr_udp_cnt, 0, __ATOMIC_SEQ_CST);
@@ -1852,11 +1851,6 @@ static int net_send_int(netinfo_type *netinfo_ptr, const char *host,
 #endif
 
     rc = 0;
-    if (numtails > 32) {
-        logmsg(LOGMSG_ERROR, "too many tails %d passed to net_send_tails, max 32\n",
-               numtails);
-        return -1;
-    }
 
     /* testpoint- throw 'queue-full' errors */
     if ((0 == rc) && (NET_TEST_QUEUE_FULL == netinfo_ptr->net_test) &&
@@ -1871,11 +1865,8 @@ static int net_send_int(netinfo_type *netinfo_ptr, const char *host,
         return 0;
     }
 
-    for (i = 0; i < numtails; i++)
-        total_tails_len += taillens[i];
-
-    tailen =
-        (numtails > 0 && tails && total_tails_len > 0) ? total_tails_len : 0;
+    for (i = 1; i < iovcount; i++)
+        datalen += iov[i].iov_len;
 
     Pthread_rwlock_rdlock(&(netinfo_ptr->lock));
     host_node_ptr = get_host_node_by_name_ll(netinfo_ptr, host);
@@ -1924,7 +1915,7 @@ static int net_send_int(netinfo_type *netinfo_ptr, const char *host,
     msghd.usertype = usertype;
     msghd.seqnum = ATOMIC_ADD32(netinfo_ptr->seqnum, 1);
     msghd.waitforack = 0;
-    msghd.datalen = datalen + tailen;
+    msghd.datalen = datalen;
 
     p_buf = (uint8_t *)&tmphd;
     p_buf_end = ((uint8_t *)&tmphd + sizeof(net_send_message_header));
@@ -1933,19 +1924,6 @@ static int net_send_int(netinfo_type *netinfo_ptr, const char *host,
 
     iov[0].iov_base = (int8_t *)&tmphd;
     iov[0].iov_len = sizeof(tmphd);
-    iovcount = 1;
-    if (data && datalen) {
-        iov[iovcount].iov_base = data;
-        iov[iovcount].iov_len = datalen;
-        iovcount++;
-    }
-    if (numtails > 0) {
-        for (i = 0; i < numtails; i++) {
-            iov[iovcount].iov_base = tails[i];
-            iov[iovcount].iov_len = taillens[i];
-            iovcount++;
-        }
-    }
 
     if (nodelay) {
         host_node_ptr->num_flushes++;
@@ -1992,6 +1970,95 @@ end:
     return rc;
 }
 
+static int net_send_int(netinfo_type *netinfo_ptr, const char *host,
+                        int usertype, void *data, int datalen, int nodelay,
+                        int numtails, void **tails, int *taillens, int nodrop,
+                        int inorder, int trace)
+{
+    struct iovec iov[34];
+    int iovcount;
+    int i;
+#if 0
+   if (strcmp(netinfo_ptr->service, "offloadsql") == 0) {
+       printf("net %s usertype %d to %s\n", netinfo_ptr->service, usertype, host);
+   }
+#endif
+
+    if (numtails > 32) {
+        logmsg(LOGMSG_ERROR, "too many tails %d passed to net_send_tails, max 32\n",
+               numtails);
+        return -1;
+    }
+
+    /* iov[0] is filled in with the header */
+    iovcount = 1;
+    if (data && datalen) {
+        iov[iovcount].iov_base = data;
+        iov[iovcount].iov_len = datalen;
+        iovcount++;
+    }
+    if (tails) {
+        for (i = 0; i < numtails; i++) {
+            if (taillens[i] <= 0)
+                continue;
+            iov[iovcount].iov_base = tails[i];
+            iov[iovcount].iov_len = taillens[i];
+            iovcount++;
+        }
+    }
+
+    return net_send_iov_int(netinfo_ptr, host, usertype, iov, iovcount,
+                            nodelay, nodrop, inorder, trace);
+}
+
+int net_send_iov(netinfo_type *netinfo_ptr, const char *host, int usertype,
+                 const struct iovec *iov, int iovcnt, uint32_t flags)
+{
+    struct iovec *msgiov;
+    int i, n = 1;
+
+    if (iovcnt < 0 || iovcnt > NET_SEND_MAX_IOV) {
+        logmsg(LOGMSG_ERROR, "%s: bad iovec count %d, max %d\n", __func__,
+               iovcnt, NET_SEND_MAX_IOV);
+        return -1;
+    }
+
+    msgiov = alloca(sizeof(struct iovec) * (iovcnt + 1));
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_base == NULL || iov[i].iov_len == 0)
+            continue;
+        msgiov[n++] = iov[i];
+    }
+
+    return net_send_iov_int(netinfo_ptr, host, usertype, msgiov, n,
+                            (flags & NET_SEND_NODELAY),
+                            (flags & NET_SEND_NODROP),
+                            (flags & NET_SEND_INORDER),
+                            (flags & NET_SEND_TRACE));
+}
+
+int net_send_owned(netinfo_type *netinfo_ptr, const char *host, int usertype,
+                   void *data, int datalen, uint32_t flags)
+{
+    struct iovec iov[2];
+    int rc;
+
+    if (gbl_libevent) {
+        return net_send_owned_evbuffer(netinfo_ptr, host, usertype, data,
+                                       datalen, flags);
+    }
+
+    /* the write queue keeps its own copy */
+    iov[1].iov_base = data;
+    iov[1].iov_len = datalen;
+    rc = net_send_iov_int(netinfo_ptr, host, usertype, iov, 2,
+                          (flags & NET_SEND_NODELAY), (flags & NET_SEND_NODROP),
+                          (flags & NET_SEND_INORDER), (flags & NET_SEND_TRACE));
+    if (rc == 0)
+        free(data);
+    return rc;
+}
+
 int net_send_authcheck_all(netinfo_type *netinfo_ptr)
 {
     int rc, count = 0, i;
@@ -2515,6 +2582,10 @@ static host_node_type *add_to_netinfo_ll(netinfo_type *netinfo_ptr,
     char *metric_name = comdb2_asprintf("queue_size_%s", hostname);
     ptr->metric_queue_size = time_metric_new(metric_name);
     free(metric_name);
+    metric_name = comdb2_asprintf("queue_latency_%s", hostname);
+    ptr->metric_queue_latency = time_metric_new(metric_name);
+    time_metric_enable_hist(ptr->metric_queue_latency);
+    free(metric_name);
 
     return ptr;
 }
@@ -6682,3 +6753,25 @@ int net_send_all(netinfo_type *netinfo_ptr, int num, void **data, int *sz,
     }
     return rc;
 }
+
+int net_send_all_iov(netinfo_type *netinfo_ptr, int n, const int *usertype,
+                     const struct iovec *const *iov, const int *iovcnt,
+                     uint32_t flags)
+{
+    if (gbl_libevent) {
+        return net_send_all_iov_evbuffer(netinfo_ptr, n, usertype, iov, iovcnt,
+                                         flags);
+    }
+    int rc = 0;
+    const char *hostlist[REPMAX];
+    int count = net_get_all_nodes_connected(netinfo_ptr, hostlist);
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < n; ++j) {
+            if (net_send_iov(netinfo_ptr, hostlist[i], usertype[j], iov[j],
+                             iovcnt[j], flags)) {
+                rc = 1;
+            }
+        }
+    }
+    return rc;
+}
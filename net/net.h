@@ -307,6 +307,22 @@ int net_send_tails(netinfo_type *netinfo_ptr, const char *host, int usertype,
                    void *data, int datalen, int nodelay, int numtails,
                    void **tails, int *taillens);
 
+/*
+  scatter-gather send: the message payload is the concatenation of the
+  iovcnt segments (at most NET_SEND_MAX_IOV); flags are NET_SEND_*
+*/
+#define NET_SEND_MAX_IOV 64
+struct iovec;
+int net_send_iov(netinfo_type *netinfo_ptr, const char *host, int usertype,
+                 const struct iovec *iov, int iovcnt, uint32_t flags);
+
+/*
+  send a malloc'ed payload without copying it: on success net owns data and
+  frees it once it has been written; on failure the caller still owns it
+*/
+int net_send_owned(netinfo_type *netinfo_ptr, const char *host, int usertype,
+                   void *data, int datalen, uint32_t flags);
+
 /* pick a sibling for sql offloading */
 char *net_get_osql_node(netinfo_type *netinfo_ptr);
 
@@ -444,10 +460,17 @@ int64_t net_get_num_accept_timeouts(netinfo_type *netinfo_ptr);
 void net_set_conntime_dump_period(netinfo_type *netinfo_ptr, int value);
 int net_get_conntime_dump_period(netinfo_type *netinfo_ptr);
 int net_send_all(netinfo_type *, int, void **, int *, int *, int *);
+/* scatter-gather broadcast of n messages to every connected node; each
+   payload is gathered once into a buffer shared by all connections, and all
+   n are queued to a connection together with the same flags */
+int net_send_all_iov(netinfo_type *, int n, const int *usertype,
+                     const struct iovec *const *iov, const int *iovcnt,
+                     uint32_t flags);
 
 extern int gbl_libevent;
 extern int gbl_libevent_appsock;
 extern int gbl_libevent_rte_only;
+extern int gbl_libevent_appsock_bases;
 
 extern int gbl_net_maxconn;
 
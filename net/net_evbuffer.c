@@ -47,6 +47,7 @@
 #include <compat.h>
 #include <dbinc/queue.h>
 #include <dbinc/rep_types.h>
+#include <epochlib.h>
 #include <intern_strings.h>
 #include <locks_wrap.h>
 #include <logmsg.h>
@@ -102,6 +103,7 @@ extern int count_newsqls;
 int gbl_libevent = 1;
 int gbl_libevent_appsock = 1;
 int gbl_libevent_rte_only = 0;
+int gbl_libevent_appsock_bases = 0;
 
 extern char *gbl_myhostname;
 extern int gbl_create_mode;
@@ -141,9 +143,13 @@ static struct event_base *base;
 static pthread_t timer_thd;
 static struct event_base *timer_base;
 
-#define NUM_APPSOCK_RD 4
-pthread_t appsock_thd[NUM_APPSOCK_RD];
-struct event_base *appsock_base[NUM_APPSOCK_RD];
+/* Appsock connections are spread over these bases; every event of a
+   connection stays on the base it was given */
+#define MIN_APPSOCK_RD 4
+#define MAX_APPSOCK_RD 64
+static int num_appsock_rd;
+static pthread_t *appsock_thd;
+static struct event_base **appsock_base;
 
 #define get_akq()                                                              \
     ({                                                                         \
@@ -384,6 +390,7 @@ struct event_info {
     struct evbuffer *flush_buf;
     struct evbuffer *wr_buf;
     struct event *wr_ev;
+    int64_t wr_armed_us; /* wr_ev is pending since; 0 if not */
     time_t wr_full;
 };
 
@@ -393,7 +400,7 @@ struct event_hash_entry {
     struct event_info *e;
 };
 static hash_t *event_hash;
-static pthread_mutex_t event_hash_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t event_hash_lk = PTHREAD_RWLOCK_INITIALIZER;
 static void make_event_hash_key(char *key, const char *service, const char *host)
 {
     strcpy(key, service);
@@ -675,9 +682,9 @@ static struct event_info *event_info_new(struct net_info *n, struct host_info *h
     struct event_hash_entry *entry = malloc(sizeof(struct event_hash_entry));
     make_event_hash_key(entry->key, n->service, h->host);
     entry->e = e;
-    Pthread_mutex_lock(&event_hash_lk);
+    Pthread_rwlock_wrlock(&event_hash_lk);
     hash_add(event_hash, entry);
-    Pthread_mutex_unlock(&event_hash_lk);
+    Pthread_rwlock_unlock(&event_hash_lk);
     if (akq_policy == POLICY_PER_EVENT) {
         e->per_event.akq = setup_akq(entry->key);
     }
@@ -863,6 +870,7 @@ static void do_disable_write(struct event_info *e)
         event_free(e->wr_ev);
         e->wr_ev = NULL;
     }
+    e->wr_armed_us = 0;
     if (e->flush_buf) {
         evbuffer_free(e->flush_buf);
         e->flush_buf = NULL;
@@ -1019,7 +1027,15 @@ static void writecb(int fd, short what, void *data)
     Pthread_mutex_lock(&e->wr_lk);
     if (fd != e->fd || !e->flush_buf || !e->wr_buf) abort(); /* sanity check */
     size_t len = get_wr_buf(e);
+    int64_t armed_us = e->wr_armed_us;
     Pthread_mutex_unlock(&e->wr_lk);
+    /* Sampled here, once per batch, to keep the metric locks off the
+     * senders' path */
+    host_node_type *host_node_ptr = e->host_node_ptr;
+    time_metric_add(host_node_ptr->metric_queue_size, len);
+    if (armed_us) {
+        time_metric_add(host_node_ptr->metric_queue_latency, comdb2_time_epochus() - armed_us);
+    }
     while (len) {
         int rc = evbuffer_write(e->wr_buf, fd);
         if (rc <= 0) {
@@ -1037,6 +1053,7 @@ static void writecb(int fd, short what, void *data)
         len = get_wr_buf(e);
         if (len == 0) {
             event_del(e->wr_ev);
+            e->wr_armed_us = 0;
         }
         Pthread_mutex_unlock(&e->wr_lk);
     }
@@ -1044,8 +1061,12 @@ static void writecb(int fd, short what, void *data)
 
 static void flush_evbuffer(struct event_info *e, int nodelay)
 {
-    if (nodelay || evbuffer_get_length(e->flush_buf) > KB(512)) {
+    /* Senders only append to flush_buf while the writer is already armed;
+     * re-adding a pending event would take wr_base's lock and wake it for
+     * nothing. writecb picks up everything queued on its next pass. */
+    if (!e->wr_armed_us && (nodelay || evbuffer_get_length(e->flush_buf) > KB(512))) {
         event_add(e->wr_ev, NULL);
+        e->wr_armed_us = comdb2_time_epochus();
     }
     check_wr_full(e);
 }
@@ -1212,7 +1233,7 @@ static void exit_once_func(void)
         stop_base(timer_base);
     }
     if (gbl_libevent_appsock && dedicated_appsock) {
-        for (int i = 0; i < NUM_APPSOCK_RD; ++i) {
+        for (int i = 0; i < num_appsock_rd; ++i) {
             stop_base(appsock_base[i]);
         }
     }
@@ -2369,7 +2390,7 @@ static void do_read(int fd, short what, void *data)
 
         static int appsock_counter = 0;
         arg->base = appsock_base[appsock_counter++];
-        if (appsock_counter == NUM_APPSOCK_RD) appsock_counter = 0;
+        if (appsock_counter == num_appsock_rd) appsock_counter = 0;
         evtimer_once(arg->base, info->cb, arg); /* handle_newsql_request_evbuffer */
         return;
     }
@@ -2737,7 +2758,7 @@ struct shared_msg {
     uint8_t buf[0];
 };
 
-static struct shared_msg *shared_msg_new(void *buf, int len, int type)
+static struct shared_msg *shared_msg_new_iov(const struct iovec *iov, int n, int len, int type)
 {
     struct shared_msg *msg = malloc(sizeof(struct shared_msg) + len);
     if (msg == NULL) {
@@ -2751,10 +2772,20 @@ static struct shared_msg *shared_msg_new(void *buf, int len, int type)
     };
     net_send_message_header *hdr = &msg->hdr;
     net_send_message_header_put(&tmp, (uint8_t *)hdr, (uint8_t *)(hdr + 1));
-    memcpy(&msg->buf, buf, len);
+    uint8_t *b = msg->buf;
+    for (int i = 0; i < n; ++i) {
+        memcpy(b, iov[i].iov_base, iov[i].iov_len);
+        b += iov[i].iov_len;
+    }
     return msg;
 }
 
+static struct shared_msg *shared_msg_new(void *buf, int len, int type)
+{
+    struct iovec iov = {.iov_base = buf, .iov_len = len};
+    return shared_msg_new_iov(&iov, 1, len, type);
+}
+
 static void shared_msg_free(const void *unused0, size_t unused1, void *ptr)
 {
     struct shared_msg *msg = ptr;
@@ -2820,12 +2851,22 @@ static void setup_bases(void)
         timer_base = base;
     }
     if (gbl_libevent_appsock) {
+        num_appsock_rd = gbl_libevent_appsock_bases;
+        if (num_appsock_rd <= 0) {
+            /* one per core */
+            num_appsock_rd = sysconf(_SC_NPROCESSORS_ONLN);
+            if (num_appsock_rd < MIN_APPSOCK_RD) num_appsock_rd = MIN_APPSOCK_RD;
+        }
+        if (num_appsock_rd > MAX_APPSOCK_RD) num_appsock_rd = MAX_APPSOCK_RD;
+        if (!dedicated_appsock) num_appsock_rd = 1;
+        appsock_thd = calloc(num_appsock_rd, sizeof(pthread_t));
+        appsock_base = calloc(num_appsock_rd, sizeof(struct event_base *));
         if (dedicated_appsock) {
-            for (int i = 0; i < NUM_APPSOCK_RD; ++i) {
+            for (int i = 0; i < num_appsock_rd; ++i) {
                 init_base_priority(&appsock_thd[i], &appsock_base[i], "appsock", 2);
             }
         } else {
-            for (int i = 0; i < NUM_APPSOCK_RD; ++i) {
+            for (int i = 0; i < num_appsock_rd; ++i) {
                 appsock_base[i] = base;
                 appsock_thd[i] = base_thd;
             }
@@ -3117,6 +3158,68 @@ int net_send_all_evbuffer(netinfo_type *netinfo_ptr, int n, void **buf, int *len
     return 0;
 }
 
+int net_send_all_iov_evbuffer(netinfo_type *netinfo_ptr, int n, const int *usertype, const struct iovec *const *iov, const int *iovcnt, int flags)
+{
+    if (net_stop) {
+        return 0;
+    }
+    int *len = alloca(sizeof(int) * n);
+    int sz = (n * NET_SEND_MESSAGE_HEADER_LEN);
+    for (int i = 0; i < n; ++i) {
+        len[i] = 0;
+        for (int j = 0; j < iovcnt[i]; ++j) {
+            len[i] += iov[i][j].iov_len;
+        }
+        sz += len[i];
+    }
+    if (sz <= 256) {
+        uint8_t buf[256], *b = buf;
+        void **data = alloca(sizeof(void *) * n);
+        int *type = alloca(sizeof(int) * n);
+        int *flag = alloca(sizeof(int) * n);
+        for (int i = 0; i < n; ++i) {
+            data[i] = b;
+            type[i] = usertype[i];
+            flag[i] = flags;
+            for (int j = 0; j < iovcnt[i]; ++j) {
+                memcpy(b, iov[i][j].iov_base, iov[i][j].iov_len);
+                b += iov[i][j].iov_len;
+            }
+        }
+        return net_send_all_evbuffer(netinfo_ptr, n, data, len, type, flag);
+    }
+    /* Gather each message straight into the one copy every connection
+       references; all n are queued under a single wr_lk so that they are
+       skipped or sent together and never interleave with other sends. */
+    struct shared_msg **msg = alloca(sizeof(struct shared_msg *) * n);
+    int i;
+    for (i = 0; i < n; ++i) {
+        if ((msg[i] = shared_msg_new_iov(iov[i], iovcnt[i], len[i], usertype[i])) == NULL) break;
+    }
+    if (i < n) {
+        for (int j = 0; j < i; ++j) {
+            shared_msg_free(0, 0, msg[j]);
+        }
+        return NET_SEND_FAIL_MALLOC_FAIL;
+    }
+    int nodrop = flags & NET_SEND_NODROP;
+    int nodelay = flags & NET_SEND_NODELAY;
+    struct net_info *ni = net_info_find(netinfo_ptr->service);
+    struct event_info *e;
+    LIST_FOREACH(e, &ni->event_list, net_list_entry) {
+        Pthread_mutex_lock(&e->wr_lk);
+        if (e->flush_buf && !skip_send(e, nodrop, 1)) {
+            addref_evbuffer(e->flush_buf, e, n, msg);
+            flush_evbuffer(e, nodelay);
+        }
+        Pthread_mutex_unlock(&e->wr_lk);
+    }
+    for (i = 0; i < n; ++i) {
+        shared_msg_free(0, 0, msg[i]);
+    }
+    return 0;
+}
+
 int net_flush_evbuffer(host_node_type *host_node_ptr)
 {
     if (net_stop) {
@@ -3131,18 +3234,18 @@ int net_flush_evbuffer(host_node_type *host_node_ptr)
     return 0;
 }
 
-int net_send_evbuffer(netinfo_type *netinfo_ptr, const char *host,
-                         int usertype, void *data, int datalen, int numtails,
-                         void **tails, int *taillens, int flags)
+/* iov[0] is reserved for the message header */
+int net_send_iov_evbuffer(netinfo_type *netinfo_ptr, const char *host,
+                          int usertype, struct iovec *iov, int n, int flags)
 {
     if (net_stop) {
         return 0;
     }
     char key[EVENT_HASH_KEY_SZ];
     make_event_hash_key(key, netinfo_ptr->service, host);
-    Pthread_mutex_lock(&event_hash_lk);
+    Pthread_rwlock_rdlock(&event_hash_lk);
     struct event_hash_entry *obj = hash_find(event_hash, key);
-    Pthread_mutex_unlock(&event_hash_lk);
+    Pthread_rwlock_unlock(&event_hash_lk);
     if (!obj) {
         return NET_SEND_FAIL_INVALIDNODE;
     }
@@ -3150,23 +3253,9 @@ int net_send_evbuffer(netinfo_type *netinfo_ptr, const char *host,
     if (strcmp(e->host, gbl_myhostname) == 0) {
         return NET_SEND_FAIL_SENDTOME;
     }
-    int n = numtails + 1;
-    if (data && datalen) {
-        ++n;
-    }
-    struct iovec iov[n], *i = iov;
     int total = 0;
-    if (data && datalen) {
-        ++i;
-        i->iov_base = data;
-        i->iov_len = datalen;
-        total += datalen;
-    }
-    for (int t = 0; t < numtails; ++t) {
-        ++i;
-        i->iov_base = tails[t];
-        i->iov_len = taillens[t];
-        total += taillens[t];
+    for (int i = 1; i < n; ++i) {
+        total += iov[i].iov_len;
     }
     net_send_message_header hdr, tmp = {
         .usertype = usertype,
@@ -3187,6 +3276,85 @@ int net_send_evbuffer(netinfo_type *netinfo_ptr, const char *host,
     }
 }
 
+static void free_owned(const void *data, size_t len, void *arg)
+{
+    free(arg);
+}
+
+/* The payload is referenced by flush_buf, not copied; it is only attached
+ * once the send can no longer be skipped, so that on failure the caller
+ * still owns it. */
+int net_send_owned_evbuffer(netinfo_type *netinfo_ptr, const char *host,
+                            int usertype, void *data, int datalen, int flags)
+{
+    if (net_stop) {
+        free(data);
+        return 0;
+    }
+    char key[EVENT_HASH_KEY_SZ];
+    make_event_hash_key(key, netinfo_ptr->service, host);
+    Pthread_rwlock_rdlock(&event_hash_lk);
+    struct event_hash_entry *obj = hash_find(event_hash, key);
+    Pthread_rwlock_unlock(&event_hash_lk);
+    if (!obj) {
+        return NET_SEND_FAIL_INVALIDNODE;
+    }
+    struct event_info *e = obj->e;
+    if (strcmp(e->host, gbl_myhostname) == 0) {
+        return NET_SEND_FAIL_SENDTOME;
+    }
+    net_send_message_header hdr, tmp = {
+        .usertype = usertype,
+        .datalen = datalen
+    };
+    net_send_message_header_put(&tmp, (uint8_t *)&hdr, (uint8_t *)(&hdr + 1));
+    int nodrop = flags & NET_SEND_NODROP;
+    int nodelay = flags & NET_SEND_NODELAY;
+    int rc;
+    Pthread_mutex_lock(&e->wr_lk);
+    if (!e->flush_buf) {
+        rc = -3;
+    } else if ((rc = skip_send(e, nodrop, 0)) == 0) {
+        if (evbuffer_add(e->flush_buf, e->wirehdr[WIRE_HEADER_USER_MSG], e->wirehdr_len) ||
+            evbuffer_add(e->flush_buf, &hdr, sizeof(hdr)) ||
+            evbuffer_add_reference(e->flush_buf, data, datalen, free_owned, data)) {
+            rc = -1;
+        } else {
+            flush_evbuffer(e, nodelay);
+        }
+    }
+    Pthread_mutex_unlock(&e->wr_lk);
+    switch (rc) {
+    case  0: return 0;
+    case -1: return NET_SEND_FAIL_MALLOC_FAIL;
+    case -2: return NET_SEND_FAIL_QUEUE_FULL;
+    case -3: return NET_SEND_FAIL_NOSOCK;
+    default: return NET_SEND_FAIL_WRITEFAIL;
+    }
+}
+
+int net_send_evbuffer(netinfo_type *netinfo_ptr, const char *host,
+                         int usertype, void *data, int datalen, int numtails,
+                         void **tails, int *taillens, int flags)
+{
+    int n = numtails + 1;
+    if (data && datalen) {
+        ++n;
+    }
+    struct iovec iov[n], *i = iov;
+    if (data && datalen) {
+        ++i;
+        i->iov_base = data;
+        i->iov_len = datalen;
+    }
+    for (int t = 0; t < numtails; ++t) {
+        ++i;
+        i->iov_base = tails[t];
+        i->iov_len = taillens[t];
+    }
+    return net_send_iov_evbuffer(netinfo_ptr, host, usertype, iov, n, flags);
+}
+
 int get_hosts_evbuffer(int max_hosts, host_node_type **hosts)
 {
     struct get_hosts_info info = {.max_hosts = max_hosts, .hosts = hosts};
@@ -262,6 +262,7 @@ struct host_node_tag {
     int interval_max_queue_bytes;
     void *qstat;
     struct time_metric *metric_queue_size;
+    struct time_metric *metric_queue_latency; /* usecs until writer ran */
 };
 
 /* Cut down data structure used for storing the sanc list. */
@@ -438,6 +439,7 @@ int get_dedicated_conhost(host_node_type *, struct in_addr *);
 host_node_type *get_host_node_by_name_ll(netinfo_type *, const char *);
 int net_flush_evbuffer(host_node_type *);
 int net_send_all_evbuffer(netinfo_type *, int, void **, int *, int *, int *);
+int net_send_all_iov_evbuffer(netinfo_type *, int, const int *, const struct iovec *const *, const int *, int);
 void rem_from_netinfo(netinfo_type *, host_node_type *);
 int write_connect_message(netinfo_type *, host_node_type *, SBUF2 *);
 int write_connect_message_evbuffer(host_node_type *, const struct iovec *, int);
@@ -447,6 +449,8 @@ int write_hello(netinfo_type *, host_node_type *);
 int write_hello_reply(netinfo_type *, host_node_type *);
 int write_list_evbuffer(host_node_type *, int, const struct iovec *, int, int);
 int net_send_evbuffer(netinfo_type *, const char *, int, void *, int, int, void **, int *, int);
+int net_send_iov_evbuffer(netinfo_type *, const char *, int, struct iovec *, int, int);
+int net_send_owned_evbuffer(netinfo_type *, const char *, int, void *, int, int);
 
 int get_hosts_evbuffer(int n, host_node_type **);
 
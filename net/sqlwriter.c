@@ -16,6 +16,7 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <event2/buffer.h>
@@ -45,6 +46,15 @@ static struct timeval heartbeat_time = {.tv_sec = 0, .tv_usec = MSEC(100)};
 
 BB_COMPILE_TIME_ASSERT(resume_max_buf, resume_buf < max_buf);
 
+//a flush requested this soon (usec) after the previous one is deferred
+int gbl_sql_flush_coalesce_usec = 500;
+
+//unless this much data is outstanding
+#define coalesce_buf KB(64)
+
+//leave the end of a response for the event loop to send
+int gbl_sql_async_done_flush = 1;
+
 struct sqlwriter {
     struct sqlclntstate *clnt;
     struct evbuffer *wr_buf;
@@ -53,10 +63,15 @@ struct sqlwriter {
     struct event *heartbeat_ev;
     struct event *heartbeat_trickle_ev;
     struct event *timeout_ev;
+    struct event *coalesce_ev;
+    struct event *drain_ev;
     struct event_base *timer_base;
     pthread_t timer_thd;
     struct event_base *wr_base;
     time_t sent_at;
+    struct timespec flushed_at;
+    int64_t *bytes_written;
+    int64_t *write_calls;
     sql_pack_fn *pack;
     sql_pack_fn *pack_hb;
     unsigned bad : 1;
@@ -66,6 +81,7 @@ struct sqlwriter {
     unsigned timed_out : 1;
     unsigned wr_continue : 1;
     unsigned packing : 1; /* 1 if writer is in sql_pack_response and wr_lock is held. */
+    unsigned coalescing : 1; /* 1 if coalesce_ev is pending */
     SSL *ssl;
     int (*wr_evbuffer_fn)(struct sqlwriter *, int);
 };
@@ -143,9 +159,21 @@ static int wr_evbuffer_plaintext(struct sqlwriter *writer, int fd)
     return evbuffer_write(writer->wr_buf, fd);
 }
 
+#ifdef SSL_OP_ENABLE_KTLS
+/* Kernel does the record encryption: hand the whole chain to writev() and
+ * skip both the pullup into a contiguous 16KB buffer and SSL_write() */
+static int wr_evbuffer_ktls(struct sqlwriter *writer, int fd)
+{
+    return evbuffer_write(writer->wr_buf, fd);
+}
+#endif
+
 static int wr_evbuffer(struct sqlwriter *writer, int fd)
 {
-    return writer->wr_evbuffer_fn(writer, fd);
+    int n = writer->wr_evbuffer_fn(writer, fd);
+    ++*writer->write_calls;
+    if (n > 0) *writer->bytes_written += n;
+    return n;
 }
 
 /*
@@ -300,6 +328,77 @@ int sql_append_packed(struct sqlwriter *writer, const void *data, size_t len)
     return 0;
 }
 
+static void sql_coalesce_cb(int fd, short what, void *arg)
+{
+    struct sqlwriter *writer = arg;
+    if (pthread_mutex_trylock(&writer->wr_lock) != 0) {
+        /* writer is busy; try again in a moment */
+        struct timeval t = {.tv_sec = 0, .tv_usec = gbl_sql_flush_coalesce_usec};
+        event_add(writer->coalesce_ev, &t);
+        return;
+    }
+    writer->coalescing = 0;
+    if (!writer->bad && !writer->done && evbuffer_get_length(writer->wr_buf)) {
+        clock_gettime(CLOCK_MONOTONIC, &writer->flushed_at);
+        int n = wr_evbuffer(writer, fd);
+        if (n > 0) {
+            writer->sent_at = time(NULL);
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            writer->bad = 1;
+        }
+        /* If the socket is full, the next write or trickle sends the rest */
+    }
+    Pthread_mutex_unlock(&writer->wr_lock);
+}
+
+/* Defer a flush which closely follows the previous one, so that rows
+ * produced in a burst go out in one write; coalesce_ev sends them if no
+ * other write does first. Returns 1 if the flush was deferred. */
+static int sql_coalesce_flush(struct sqlwriter *writer, int outstanding)
+{
+    const int window = gbl_sql_flush_coalesce_usec;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t elapsed = (now.tv_sec - writer->flushed_at.tv_sec) * 1000000 +
+                      (now.tv_nsec - writer->flushed_at.tv_nsec) / 1000;
+    if (window <= 0 || outstanding >= coalesce_buf || elapsed >= window || writer->do_timeout) {
+        writer->flushed_at = now;
+        return 0;
+    }
+    if (!writer->coalescing) {
+        struct timeval t = {.tv_sec = 0, .tv_usec = window - elapsed};
+        writer->coalescing = 1;
+        event_add(writer->coalesce_ev, &t);
+    }
+    return 1;
+}
+
+/* Send what is left of a finished response from the event loop. If the next
+ * statement is already writing, its own flushes send it. */
+static void sql_drain_cb(int fd, short what, void *arg)
+{
+    struct sqlwriter *writer = arg;
+    if (pthread_mutex_trylock(&writer->wr_lock) != 0) {
+        return;
+    }
+    int outstanding = evbuffer_get_length(writer->wr_buf);
+    while (outstanding > 0 && !writer->bad) {
+        int n = wr_evbuffer(writer, fd);
+        if (n <= 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                writer->bad = 1;
+            }
+            break;
+        }
+        writer->sent_at = time(NULL);
+        outstanding -= n;
+    }
+    if (outstanding > 0 && !writer->bad) {
+        event_add(writer->drain_ev, NULL);
+    }
+    Pthread_mutex_unlock(&writer->wr_lock);
+}
+
 int sql_write(struct sqlwriter *writer, void *arg, int flush)
 {
     if (from_timeout_cb(writer)) { /* TODO FIXME : I don't like this special case */
@@ -320,6 +419,10 @@ int sql_write(struct sqlwriter *writer, void *arg, int flush)
         Pthread_mutex_unlock(&writer->wr_lock);
         return 0;
     }
+    if (flush && sql_coalesce_flush(writer, outstanding)) {
+        Pthread_mutex_unlock(&writer->wr_lock);
+        return 0;
+    }
     writer->flush = flush;
     writer->wr_continue = 0;
     Pthread_mutex_unlock(&writer->wr_lock);
@@ -431,7 +534,17 @@ int sql_done(struct sqlwriter *writer)
     }
     sql_disable_heartbeat(writer);
     sql_disable_timeout(writer);
+    if (writer->coalescing) {
+        event_del(writer->coalesce_ev);
+        writer->coalescing = 0;
+    }
     if (evbuffer_get_length(writer->wr_buf)) {
+        if (gbl_sql_async_done_flush) {
+            /* at most max_buf is left; don't hold the engine thread for it */
+            event_add(writer->drain_ev, NULL);
+            Pthread_mutex_unlock(&writer->wr_lock);
+            return 0;
+        }
         Pthread_mutex_unlock(&writer->wr_lock);
         return sql_flush(writer);
     }
@@ -467,6 +580,14 @@ void sqlwriter_free(struct sqlwriter *writer)
         event_free(writer->flush_ev);
         writer->flush_ev = NULL;
     }
+    if (writer->coalesce_ev) {
+        event_free(writer->coalesce_ev);
+        writer->coalesce_ev = NULL;
+    }
+    if (writer->drain_ev) {
+        event_free(writer->drain_ev);
+        writer->drain_ev = NULL;
+    }
     if (writer->wr_buf) {
         evbuffer_free(writer->wr_buf);
         writer->wr_buf = NULL;
@@ -488,6 +609,8 @@ struct sqlwriter *sqlwriter_new(struct sqlwriter_arg *arg)
     writer->pack_hb = arg->pack_hb;
     writer->timer_base = arg->timer_base;
     writer->timer_thd = pthread_self();
+    writer->bytes_written = arg->bytes_written;
+    writer->write_calls = arg->write_calls;
     writer->wr_continue = 1;
     writer->wr_buf = evbuffer_new();
 
@@ -500,6 +623,8 @@ struct sqlwriter *sqlwriter_new(struct sqlwriter_arg *arg)
     writer->flush_ev = event_new(writer->wr_base, arg->fd, EV_WRITE | EV_PERSIST, sql_flush_cb, writer);
     writer->heartbeat_ev = event_new(writer->timer_base, arg->fd, EV_PERSIST, sql_heartbeat_cb, writer);
     writer->heartbeat_trickle_ev = event_new(writer->timer_base, arg->fd, EV_WRITE, sql_trickle_cb, writer);
+    writer->coalesce_ev = event_new(writer->timer_base, arg->fd, EV_TIMEOUT, sql_coalesce_cb, writer);
+    writer->drain_ev = event_new(writer->timer_base, arg->fd, EV_WRITE, sql_drain_cb, writer);
 
     return writer;
 }
@@ -508,6 +633,10 @@ void sql_enable_ssl(struct sqlwriter *writer, SSL *ssl)
 {
     writer->ssl = ssl;
     writer->wr_evbuffer_fn = wr_evbuffer_ssl;
+#ifdef SSL_OP_ENABLE_KTLS
+    if (BIO_get_ktls_send(SSL_get_wbio(ssl)))
+        writer->wr_evbuffer_fn = wr_evbuffer_ktls;
+#endif
 }
 
 void sql_disable_ssl(struct sqlwriter *writer)
@@ -51,6 +51,8 @@ struct sqlwriter_arg {
     struct event_base *timer_base;
     sql_pack_fn *pack;
     sql_pack_fn *pack_hb;
+    int64_t *bytes_written; /* counts bytes sent, and write calls */
+    int64_t *write_calls;
 };
 struct sqlwriter *sqlwriter_new(struct sqlwriter_arg *);
 void sqlwriter_free(struct sqlwriter *);
@@ -59,6 +59,7 @@
 #include <net_types.h>
 #include <cdb2_constants.h>
 #include <trigger.h>
+#include <translistener.h>
 #include <intern_strings.h>
 #include "logmsg.h"
 #include <schema_lk.h>
@@ -447,6 +448,37 @@ static void dbqueue_check_inactivity(struct consumer *consumer)
 static pthread_mutex_t dbqueuedb_admin_lk = PTHREAD_MUTEX_INITIALIZER;
 static int dbqueuedb_admin_running = 0;
 
+static void start_trigger(char *name)
+{
+    char *host = net_get_osql_node(thedb->handle_sibling);
+    if (host == NULL) {
+        trigger_start(name);
+    } else {
+        void *net = thedb->handle_sibling;
+        net_send_message(net, host, NET_TRIGGER_START, name, strlen(name) + 1,
+                         0, 0);
+    }
+}
+
+/* A partitioned queue needs a trigger for each partition.  A trigger takes
+ * whichever partition is free, so start one for each that isn't taken. */
+static void start_trigger_partitions(struct dbtable *db,
+                                     struct consumer *consumer)
+{
+    char name[MAX_SPNAME + 8];
+    int npartitions = javasp_queue_partitions(db->tablename);
+    if (npartitions <= 1) {
+        if (!trigger_registered(consumer->procedure_name))
+            start_trigger(consumer->procedure_name);
+        return;
+    }
+    for (int i = 0; i < npartitions; ++i) {
+        snprintf(name, sizeof(name), "%s/%d", consumer->procedure_name, i);
+        if (!trigger_registered(name))
+            start_trigger(consumer->procedure_name);
+    }
+}
+
 /* This gets called once a second from purge_old_blkseq_thread().
  * If we have become master we make sure that we have threads in place
  * for each consumer. */
@@ -481,18 +513,7 @@ static void admin(struct dbenv *dbenv, int type)
                     case CONSUMER_TYPE_LUA:
                         dbqueue_check_inactivity(consumer);
 
-                        if (!trigger_registered(consumer->procedure_name)) {
-                            char *name = consumer->procedure_name;
-                            char *host =
-                                net_get_osql_node(thedb->handle_sibling);
-                            if (host == NULL) {
-                                trigger_start(name);
-                            } else {
-                                void *net = thedb->handle_sibling;
-                                net_send_message(net, host, NET_TRIGGER_START,
-                                                 name, strlen(name) + 1, 0, 0);
-                            }
-                        }
+                        start_trigger_partitions(db, consumer);
                         break;
                     case CONSUMER_TYPE_DYNLUA:
                         dbqueue_check_inactivity(consumer);
@@ -17,6 +17,7 @@
 #include <pthread.h>
 #include <stdlib.h>
 
+#include <admission.h>
 #include <comdb2_atomic.h>
 #include <osqlsqlsocket.h>
 #include <reqlog.h>
@@ -31,6 +32,9 @@
 extern int gbl_allow_incoherent_sql;
 extern int gbl_disable_skip_rows;
 extern int gbl_return_long_column_names;
+extern int gbl_newsql_columnar_rows;
+extern int gbl_newsql_max_stmt_ids;
+extern int gbl_master_offload_reads;
 
 struct newsql_appdata {
     NEWSQL_APPDATA_COMMON
@@ -221,6 +225,29 @@ static int fill_snapinfo(struct sqlclntstate *clnt, int *file, int *offset)
         }                                                                      \
     }
 
+#define _has_commit_lsn(clnt, sql_response)                                    \
+    CDB2SQLRESPONSE__Snapshotinfo commit_lsn =                                 \
+        CDB2__SQLRESPONSE__SNAPSHOTINFO__INIT;                                 \
+    if (clnt->commit_lsn.file) {                                               \
+        commit_lsn.file = clnt->commit_lsn.file;                               \
+        commit_lsn.offset = clnt->commit_lsn.offset;                           \
+        sql_response.commit_lsn = &commit_lsn;                                 \
+    }
+
+#define _has_load(clnt, sql_response)                                          \
+    CDB2SQLRESPONSE__Loadinfo load = CDB2__SQLRESPONSE__LOADINFO__INIT;        \
+    if (clnt->load_info) {                                                     \
+        struct admission_stats st;                                             \
+        admission_get_stats(&st);                                              \
+        load.has_queue_ms = load.has_cpu_pct = load.has_lag_kb = 1;            \
+        load.queue_ms = st.queue_ms;                                           \
+        load.cpu_pct = st.cpu_pct;                                             \
+        load.lag_kb = st.lag_bytes > INT32_MAX * 1024LL                        \
+                          ? INT32_MAX                                          \
+                          : st.lag_bytes / 1024;                               \
+        sql_response.load = &load;                                             \
+    }
+
 /* Skip spaces and tabs, requires at least one space */
 static inline char *skipws(char *str)
 {
@@ -397,6 +424,10 @@ static int newsql_columns(struct sqlclntstate *clnt, sqlite3_stmt *stmt)
         resp.fp.data = clnt->work.aFingerprint;
         resp.fp.len = FINGERPRINTSZ;
     }
+    if (appdata->stmt_id) {
+        resp.has_stmt_id = 1;
+        resp.stmt_id = appdata->stmt_id;
+    }
     resp.has_flat_col_vals = 1;
     return newsql_response(clnt, &resp, 0);
 }
@@ -505,6 +536,191 @@ static int newsql_send_postponed_row(struct sqlclntstate *clnt)
     return appdata->write_postponed(clnt);
 }
 
+/* Rows for clients with the COLUMNAR_ROWS feature are collected here and
+   sent gbl_newsql_columnar_rows at a time, one column after the other, in
+   the col_block format described in sqlresponse.proto. */
+#define NEWSQL_COL_BATCH_BYTES (1024 * 1024)
+
+struct newsql_col_buf {
+    int width;       /* 8 for integers and reals; 0 for variable width */
+    uint8_t *isnull; /* one flag per row */
+    uint32_t *off;   /* rows + 1 offsets into data, for variable width */
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+};
+
+struct newsql_col_batch {
+    int ncols;
+    int alloc_cols;
+    int nrows;
+    int maxrows;
+    int alloc_rows;
+    int flip;
+    size_t nbytes;
+    struct newsql_col_buf *col;
+};
+
+static void newsql_col_batch_free(struct newsql_appdata *appdata)
+{
+    struct newsql_col_batch *b = appdata->col_batch;
+    if (b == NULL)
+        return;
+    for (int i = 0; i < b->alloc_cols; ++i) {
+        free(b->col[i].isnull);
+        free(b->col[i].off);
+        free(b->col[i].data);
+    }
+    free(b->col);
+    free(b);
+    appdata->col_batch = NULL;
+}
+
+static int newsql_col_batch_flush(struct sqlclntstate *clnt)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    struct newsql_col_batch *b = appdata->col_batch;
+    if (b == NULL || b->nrows == 0)
+        return 0;
+
+    int n = b->nrows;
+    size_t sz = 0;
+    for (int i = 0; i < b->ncols; ++i) {
+        struct newsql_col_buf *c = &b->col[i];
+        sz += 1 + n + c->len;
+        if (c->width == 0)
+            sz += sizeof(uint32_t) * (n + 1);
+    }
+    uint8_t *block = malloc(sz);
+    if (block == NULL)
+        return -1;
+    uint8_t *p = block;
+    for (int i = 0; i < b->ncols; ++i) {
+        struct newsql_col_buf *c = &b->col[i];
+        *p++ = c->width;
+        memcpy(p, c->isnull, n);
+        p += n;
+        if (c->width == 0) {
+            for (int j = 0; j <= n; ++j) {
+                uint32_t off = b->flip ? flibc_intflip(c->off[j]) : c->off[j];
+                memcpy(p, &off, sizeof(off));
+                p += sizeof(off);
+            }
+        }
+        memcpy(p, c->data, c->len);
+        p += c->len;
+        c->len = 0;
+    }
+    b->nrows = 0;
+    b->nbytes = 0;
+
+    CDB2SQLRESPONSE r = CDB2__SQLRESPONSE__INIT;
+    r.response_type = RESPONSE_TYPE__COLUMN_VALUES;
+    r.has_col_rows = 1;
+    r.col_rows = n;
+    r.has_col_block = 1;
+    r.col_block.len = sz;
+    r.col_block.data = block;
+    int rc = newsql_response(clnt, &r, 0);
+    free(block);
+    return rc;
+}
+
+static int newsql_col_batch_grow(struct newsql_col_buf *c, size_t len)
+{
+    if (c->len + len <= c->cap)
+        return 0;
+    size_t cap = c->cap ? c->cap : 4096;
+    while (cap < c->len + len)
+        cap *= 2;
+    uint8_t *data = realloc(c->data, cap);
+    if (data == NULL)
+        return -1;
+    c->data = data;
+    c->cap = cap;
+    return 0;
+}
+
+static int newsql_col_batch_start(struct newsql_appdata *appdata, int ncols,
+                                  int flip)
+{
+    struct newsql_col_batch *b = appdata->col_batch;
+    int maxrows = gbl_newsql_columnar_rows;
+    if (b == NULL) {
+        b = appdata->col_batch = calloc(1, sizeof(struct newsql_col_batch));
+        if (b == NULL)
+            return -1;
+    }
+    if (ncols > b->alloc_cols || maxrows > b->alloc_rows) {
+        int cols = ncols > b->alloc_cols ? ncols : b->alloc_cols;
+        int rows = maxrows > b->alloc_rows ? maxrows : b->alloc_rows;
+        struct newsql_col_buf *col =
+            realloc(b->col, sizeof(struct newsql_col_buf) * cols);
+        if (col == NULL)
+            return -1;
+        b->col = col;
+        for (int i = b->alloc_cols; i < cols; ++i)
+            memset(&col[i], 0, sizeof(struct newsql_col_buf));
+        b->alloc_cols = cols;
+        for (int i = 0; i < cols; ++i) {
+            uint8_t *isnull = realloc(col[i].isnull, rows);
+            uint32_t *off = realloc(col[i].off, sizeof(uint32_t) * (rows + 1));
+            if (isnull)
+                col[i].isnull = isnull;
+            if (off)
+                col[i].off = off;
+            if (isnull == NULL || off == NULL)
+                return -1;
+        }
+        b->alloc_rows = rows;
+    }
+    b->maxrows = maxrows;
+    b->ncols = ncols;
+    b->flip = flip;
+    for (int i = 0; i < ncols; ++i) {
+        int type = appdata->col_info.type[i];
+        b->col[i].width =
+            (type == SQLITE_INTEGER || type == SQLITE_FLOAT) ? 8 : 0;
+        b->col[i].len = 0;
+        b->col[i].off[0] = 0;
+    }
+    return 0;
+}
+
+static int newsql_col_batch_add(struct sqlclntstate *clnt,
+                                CDB2SQLRESPONSE__Column *cols, int ncols,
+                                int flip)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    struct newsql_col_batch *b = appdata->col_batch;
+    if (b == NULL || b->nrows == 0) {
+        if (newsql_col_batch_start(appdata, ncols, flip) != 0)
+            return -1;
+        b = appdata->col_batch;
+    }
+    int row = b->nrows;
+    for (int i = 0; i < ncols; ++i) {
+        struct newsql_col_buf *c = &b->col[i];
+        int isnull = cols[i].has_isnull && cols[i].isnull;
+        size_t len = c->width ? c->width : (isnull ? 0 : cols[i].value.len);
+        if (newsql_col_batch_grow(c, len) != 0)
+            return -1;
+        if (isnull || cols[i].value.len != len)
+            memset(c->data + c->len, 0, len);
+        else
+            memcpy(c->data + c->len, cols[i].value.data, len);
+        c->isnull[row] = isnull;
+        c->len += len;
+        if (c->width == 0)
+            c->off[row + 1] = c->len;
+        b->nbytes += len;
+    }
+    b->nrows++;
+    if (b->nrows >= b->maxrows || b->nbytes >= NEWSQL_COL_BATCH_BYTES)
+        return newsql_col_batch_flush(clnt);
+    return 0;
+}
+
 #define newsql_null(cols, i)                                                   \
     do {                                                                       \
         cols[i].has_isnull = 1;                                                \
@@ -582,6 +798,12 @@ static int newsql_row(struct sqlclntstate *clnt, struct response_data *arg,
                       int postpone)
 {
     sqlite3_stmt *stmt = arg->stmt;
+    int columnar = clnt->columnar_rows && gbl_newsql_columnar_rows > 0 &&
+                   clnt->rowbuffer && !postpone && !arg->pingpong &&
+                   !clnt->num_retry;
+    if (!columnar && newsql_col_batch_flush(clnt) != 0) {
+        return -1;
+    }
     if (stmt == NULL) {
         return newsql_send_postponed_row(clnt);
     }
@@ -689,6 +911,9 @@ static int newsql_row(struct sqlclntstate *clnt, struct response_data *arg,
         if (clnt->flat_col_vals)
             bd[i] = cols[i].value;
     }
+    if (columnar) {
+        return newsql_col_batch_add(clnt, cols, ncols, flip);
+    }
     CDB2SQLRESPONSE r = CDB2__SQLRESPONSE__INIT;
     r.response_type = RESPONSE_TYPE__COLUMN_VALUES;
     if (clnt->flat_col_vals) {
@@ -721,6 +946,8 @@ static int newsql_row_last(struct sqlclntstate *clnt)
     _has_effects(clnt, resp);
     _has_snapshot(clnt, resp);
     _has_features(clnt, resp);
+    _has_commit_lsn(clnt, resp);
+    _has_load(clnt, resp);
     return newsql_response(clnt, &resp, 1);
 }
 
@@ -901,6 +1128,11 @@ static int newsql_cost(struct sqlclntstate *clnt)
 
 static int newsql_write_response(struct sqlclntstate *c, int t, void *a, int i)
 {
+    /* Batched rows go out before anything that follows them */
+    if (t != RESPONSE_ROW && t != RESPONSE_HEARTBEAT && t != RESPONSE_COST &&
+        newsql_col_batch_flush(c) != 0) {
+        return -1;
+    }
     switch (t) {
     case RESPONSE_COLUMNS: return newsql_columns(c, a);
     case RESPONSE_COLUMNS_LUA: return newsql_columns_lua(c, a);
@@ -1719,15 +1951,14 @@ int process_set_commands(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_query)
                     clnt->get_cost = 0;
                 }
             } else if (strncasecmp(sqlstr, "explain", 7) == 0) {
-                /* is_explain flag:
-                   1 - show plan
-                   2 - show plan + wheretrace */
                 sqlstr += 7;
                 sqlstr = skipws(sqlstr);
                 if (strncasecmp(sqlstr, "on", 2) == 0) {
-                    clnt->is_explain = 1;
+                    clnt->is_explain = EXPLAIN_PLAN;
+                } else if (strncasecmp(sqlstr, "analyze", 7) == 0) {
+                    clnt->is_explain = EXPLAIN_ANALYZE;
                 } else if (strncasecmp(sqlstr, "verbose", 7) == 0) {
-                    clnt->is_explain = 2;
+                    clnt->is_explain = EXPLAIN_VERBOSE;
                     sqlstr += 7;
                     sqlstr = skipws(sqlstr);
 
@@ -1746,7 +1977,7 @@ int process_set_commands(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_query)
                     else
                         clnt->where_trace_flags = (int)strtol(sqlstr, NULL, 16);
                 } else {
-                    clnt->is_explain = 0;
+                    clnt->is_explain = EXPLAIN_OFF;
                 }
             } else if (strncasecmp(sqlstr, "maxtransize", 11) == 0) {
                 sqlstr += 11;
@@ -1869,6 +2100,47 @@ static int do_query_on_master_check(struct sqlclntstate *clnt, CDB2SQLQUERY *sql
     return 0;
 }
 
+static int is_offloadable_read(char *sql)
+{
+    sql = skipws(sql);
+    return sql && (strncasecmp(sql, "select", 6) == 0 ||
+                   strncasecmp(sql, "with", 4) == 0);
+}
+
+/* A read that reached the master outside a transaction, on a connection
+ * opened before this node became master or from a misconfigured client,
+ * competes with applying transactions.  Send the client our view of the
+ * cluster and drop the connection; it retries the read elsewhere. */
+static int master_offload_read(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_query)
+{
+    int allow_master_dbinfo = 0;
+
+    if (!gbl_master_offload_reads || clnt->admin ||
+        clnt->ctrl_sqlengine != SQLENG_NORMAL_PROCESS ||
+        !is_offloadable_read(clnt->sql))
+        return 0;
+    for (int ii = 0; ii < sql_query->n_features; ii++) {
+        switch (sql_query->features[ii]) {
+        /* connected directly, or tried every other node */
+        case CDB2_CLIENT_FEATURES__ALLOW_MASTER_EXEC: return 0;
+        case CDB2_CLIENT_FEATURES__ALLOW_MASTER_DBINFO: allow_master_dbinfo = 1; break;
+        }
+    }
+    if (thedb->nsiblings == 1 || thedb->rep_sync == REP_SYNC_NONE || clnt->plugin.local_check(clnt)) {
+        return 0;
+    }
+    if (!bdb_master_should_reject(thedb->bdb_env)) {
+        return 0;
+    }
+    ATOMIC_ADD32(gbl_master_read_offloads, 1);
+    if (allow_master_dbinfo) {
+        struct newsql_appdata *appdata = clnt->appdata;
+        appdata->write_dbinfo(clnt);
+    }
+    logmsg(LOGMSG_DEBUG, "%s offloading read from master, dropping socket\n", __func__);
+    return 1;
+}
+
 static int incoh_reject(int admin, bdb_state_type *bdb_state)
 {
     /* If this isn't from an admin session and the node isn't coherent
@@ -1892,6 +2164,12 @@ int newsql_first_run(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_query)
         case CDB2_CLIENT_FEATURES__REQUEST_FP:
             clnt->request_fp = 1;
             break;
+        case CDB2_CLIENT_FEATURES__COLUMNAR_ROWS:
+            clnt->columnar_rows = 1;
+            break;
+        case CDB2_CLIENT_FEATURES__LOAD_INFO:
+            clnt->load_info = 1;
+            break;
         }
     }
     if (sql_query->client_info) {
@@ -1915,9 +2193,16 @@ int newsql_loop(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_query)
     if (!in_client_trans(clnt)) {
         bzero(&clnt->effects, sizeof(clnt->effects));
         bzero(&clnt->log_effects, sizeof(clnt->log_effects));
+        bzero(&clnt->commit_lsn, sizeof(clnt->commit_lsn));
         clnt->had_errors = 0;
         clnt->ctrl_sqlengine = SQLENG_NORMAL_PROCESS;
     }
+    if (sql_query->read_lsn && sql_query->read_lsn->file > 0) {
+        clnt->read_lsn.file = sql_query->read_lsn->file;
+        clnt->read_lsn.offset = sql_query->read_lsn->offset;
+    } else {
+        bzero(&clnt->read_lsn, sizeof(clnt->read_lsn));
+    }
     if (clnt->dbtran.mode < TRANLEVEL_SOSQL) {
         clnt->dbtran.mode = TRANLEVEL_SOSQL;
     }
@@ -1982,10 +2267,71 @@ int newsql_loop(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_query)
         logmsg(LOGMSG_DEBUG, "%s new query on incoherent node, dropping socket\n", __func__);
         return -1;
     }
+    if (master_offload_read(clnt, sql_query)) {
+        return -1;
+    }
     ATOMIC_ADD32(gbl_nnewsql, 1);
     return 0;
 }
 
+/* Replace the text of a query sent by statement id, or assign an id to the
+   query if the client asked for one. Returns -1 if the id is unknown. */
+int newsql_resolve_stmt_id(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_query,
+                           ProtobufCAllocator *allocator)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    appdata->stmt_id = 0;
+    if (sql_query->has_stmt_id) {
+        int id = sql_query->stmt_id;
+        if (id < 1 || id > appdata->n_stmt_ids) {
+            char errstr[64];
+            snprintf(errstr, sizeof(errstr), "Unknown statement id %d", id);
+            logmsg(LOGMSG_ERROR, "%s\n", errstr);
+            write_response(clnt, RESPONSE_ERROR, errstr,
+                           CDB2__ERROR_CODE__INVALID_ID);
+            return -1;
+        }
+        const char *sql = appdata->stmt_ids[id - 1];
+        size_t len = strlen(sql) + 1;
+        char *copy = allocator->alloc(allocator->allocator_data, len);
+        if (copy == NULL)
+            return -1;
+        memcpy(copy, sql, len);
+        allocator->free(allocator->allocator_data, sql_query->sql_query);
+        sql_query->sql_query = copy;
+        return 0;
+    }
+    if (!sql_query->has_prepare || !sql_query->prepare)
+        return 0;
+    for (int i = 0; i < appdata->n_stmt_ids; ++i) {
+        if (strcmp(appdata->stmt_ids[i], sql_query->sql_query) == 0) {
+            appdata->stmt_id = i + 1;
+            return 0;
+        }
+    }
+    if (appdata->n_stmt_ids >= gbl_newsql_max_stmt_ids)
+        return 0;
+    char **ids = realloc(appdata->stmt_ids,
+                         (appdata->n_stmt_ids + 1) * sizeof(char *));
+    if (ids == NULL)
+        return 0;
+    appdata->stmt_ids = ids;
+    if ((ids[appdata->n_stmt_ids] = strdup(sql_query->sql_query)) == NULL)
+        return 0;
+    appdata->stmt_id = ++appdata->n_stmt_ids;
+    return 0;
+}
+
+static void newsql_free_stmt_ids(struct newsql_appdata *appdata)
+{
+    for (int i = 0; i < appdata->n_stmt_ids; ++i)
+        free(appdata->stmt_ids[i]);
+    free(appdata->stmt_ids);
+    appdata->stmt_ids = NULL;
+    appdata->n_stmt_ids = 0;
+    appdata->stmt_id = 0;
+}
+
 int newsql_should_dispatch(struct sqlclntstate *clnt, int *commit_rollback)
 {
     /* return 0 => shoud dispatch */
@@ -2007,6 +2353,7 @@ void newsql_reset(struct sqlclntstate *clnt)
         handle_sql_intrans_unrecoverable_error(clnt);
     }
     reset_clnt(clnt, 0);
+    newsql_free_stmt_ids(clnt->appdata);
     clnt->tzname[0] = 0;
     clnt->osql.count_changes = 1;
     clnt->heartbeat = 1;
@@ -2022,6 +2369,8 @@ void free_newsql_appdata(struct sqlclntstate *clnt)
         free(appdata->postponed);
         appdata->postponed = NULL;
     }
+    newsql_col_batch_free(appdata);
+    newsql_free_stmt_ids(appdata);
     free(appdata->col_info.type);
 }
 
@@ -22,6 +22,7 @@
 
 struct sqlclntstate;
 struct newsql_appdata;
+struct newsql_col_batch;
 
 struct newsql_stmt {
     CDB2QUERY *query;
@@ -52,6 +53,10 @@ struct newsql_postponed_data {
     CDB2SQLQUERY *sqlquery;                                                    \
     int8_t send_intrans_response;                                              \
     struct newsql_postponed_data *postponed;                                   \
+    struct newsql_col_batch *col_batch;                                        \
+    char **stmt_ids; /* sql of each statement id, from 1 */                    \
+    int n_stmt_ids;                                                            \
+    int stmt_id; /* assigned to the current query */                           \
     struct sql_col_info col_info;
 
 void newsql_setup_clnt(struct sqlclntstate *);
@@ -62,6 +67,8 @@ int newsql_heartbeat(struct sqlclntstate *);
 void setup_newsql_evbuffer_handlers(void);
 int newsql_first_run(struct sqlclntstate *, CDB2SQLQUERY *);
 int newsql_loop(struct sqlclntstate *, CDB2SQLQUERY *);
+int newsql_resolve_stmt_id(struct sqlclntstate *, CDB2SQLQUERY *,
+                           ProtobufCAllocator *);
 int is_commit_rollback(struct sqlclntstate *);
 int newsql_should_dispatch(struct sqlclntstate *, int *is_commit_rollback);
 void newsql_reset(struct sqlclntstate *);
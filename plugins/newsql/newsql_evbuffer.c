@@ -41,6 +41,7 @@
 #include <newsql.h>
 
 extern int gbl_nid_dbname;
+extern int gbl_sql_idle_timeout_sec;
 extern SSL_CTX *gbl_ssl_ctx;
 extern ssl_mode gbl_client_ssl_mode;
 extern uint64_t gbl_ssl_num_full_handshakes;
@@ -72,6 +73,7 @@ struct newsql_appdata_evbuffer {
 
     unsigned initial : 1; /* New connection or called newsql_reset */
     unsigned local : 1;
+    unsigned idle : 1; /* rd_hdr_ev is armed with sql_idle_timeout_sec */
 
     struct sqlwriter *writer;
     struct ssl_data *ssl_data;
@@ -425,6 +427,9 @@ static void process_query(struct newsql_appdata_evbuffer *appdata, CDB2QUERY *qu
         }
         appdata->initial = 0;
     }
+    if (newsql_resolve_stmt_id(clnt, sqlquery, &pb_alloc) != 0) {
+        goto out;
+    }
     if (newsql_loop(clnt, sqlquery) != 0) {
         goto out;
     }
@@ -709,12 +714,22 @@ static void rd_hdr(int dummyfd, short what, void *arg)
     if (evbuffer_get_length(appdata->rd_buf) >= sizeof(struct newsqlheader)) {
         goto hdr;
     }
+    int idle = appdata->idle;
+    appdata->idle = 0;
     if (rd_evbuffer(appdata) <= 0 && (what & EV_READ)) {
         newsql_cleanup(appdata);
         return;
     }
-    if (evbuffer_get_length(appdata->rd_buf) < sizeof(struct newsqlheader)) {
-        add_rd_event(appdata, appdata->rd_hdr_ev, NULL);
+    size_t len = evbuffer_get_length(appdata->rd_buf);
+    if (len < sizeof(struct newsqlheader)) {
+        if (idle && (what & EV_TIMEOUT) && len == 0) {
+            /* nothing between requests for sql_idle_timeout_sec; give back the slot */
+            newsql_cleanup(appdata);
+            return;
+        }
+        struct timeval timeout = {.tv_sec = gbl_sql_idle_timeout_sec};
+        appdata->idle = timeout.tv_sec > 0 && len == 0 && !appdata->clnt.admin && !in_client_trans(&appdata->clnt);
+        add_rd_event(appdata, appdata->rd_hdr_ev, appdata->idle ? &timeout : NULL);
         return;
     }
 hdr:
@@ -950,6 +965,8 @@ static void newsql_setup_clnt_evbuffer(struct appsock_handler_arg *arg, int admi
         .pack = newsql_pack,
         .pack_hb = newsql_pack_hb,
         .timer_base = appdata->base,
+        .bytes_written = &clnt->net_bytes_written,
+        .write_calls = &clnt->net_write_calls,
     };
     appdata->writer = sqlwriter_new(&sqlwriter_arg);
     disable_ssl_evbuffer(appdata);
@@ -603,6 +603,11 @@ static int handle_newsql_request(comdb2_appsock_arg_t *arg)
 #endif
         appdata->query = query;
         appdata->sqlquery = sql_query;
+        if (newsql_resolve_stmt_id(
+                &clnt, sql_query,
+                &appdata->newsql_protobuf_allocator.protobuf_allocator) != 0) {
+            goto done;
+        }
         if (newsql_loop(&clnt, sql_query) != 0) {
             goto done;
         }
@@ -40,6 +40,8 @@ static int delete_table(struct dbtable *db, tran_type *tran)
     MEMORY_SYNC;
     delete_schema(table);
     bdb_del_table_csonparameters(tran, table);
+    bdb_del_zstd_dicts(tran, table, &bdberr);
+    bdb_del_zonemap(tran, table, &bdberr);
     return 0;
 }
 
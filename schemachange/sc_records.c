@@ -266,15 +266,15 @@ int init_sc_genids(struct dbtable *db, struct schema_change_type *s)
 // because we only have one map from old schema to new schema
 //(ie no index mapping--that can speedup insertion into indices too)
 static inline int convert_server_record_cachedmap(
-    const char *table, int tagmap[], const void *inbufp, char *outbuf,
-    struct schema_change_type *s, struct schema *from, struct schema *to,
-    blob_buffer_t *blobs, int maxblobs)
+    const char *table, int tagmap[], const struct convprog *prog,
+    const void *inbufp, char *outbuf, struct schema_change_type *s,
+    struct schema *from, struct schema *to, blob_buffer_t *blobs, int maxblobs)
 {
     char err[1024];
     struct convert_failure reason;
-    int rc =
-        stag_to_stag_buf_cachedmap(tagmap, from, to, (char *)inbufp, outbuf,
-                                   0 /*flags*/, &reason, blobs, maxblobs);
+    int rc = stag_to_stag_buf_cachedmap(tagmap, prog, from, to, (char *)inbufp,
+                                        outbuf, 0 /*flags*/, &reason, blobs,
+                                        maxblobs);
 
     if (rc) {
         convert_failure_reason_str(&reason, table, from->tag, to->tag, err,
@@ -445,7 +445,7 @@ static int prepare_and_verify_newdb_record(struct convert_record_data *data,
     int rc = 0;
     int dta_needs_conversion = 1;
     if ((!data->to->plan || !data->to->plan->dta_plan) &&
-        data->s->rebuild_index)
+        (data->s->rebuild_index || data->ondisk_unchanged))
         dta_needs_conversion = 0;
 
     if (dta_needs_conversion) {
@@ -457,9 +457,9 @@ static int prepare_and_verify_newdb_record(struct convert_record_data *data,
         /* convert current.  this converts blob fields, but we need to make sure
          * we add the right blobs separately. */
         rc = convert_server_record_cachedmap(
-            data->to->tablename, data->tagmap, dta, data->rec->recbuf, data->s,
-            data->from->schema, data->to->schema, data->wrblb,
-            sizeof(data->wrblb) / sizeof(data->wrblb[0]));
+            data->to->tablename, data->tagmap, data->convprog, dta,
+            data->rec->recbuf, data->s, data->from->schema, data->to->schema,
+            data->wrblb, sizeof(data->wrblb) / sizeof(data->wrblb[0]));
         if (rc) {
             logmsg(LOGMSG_ERROR, "%s:%d failed to convert record rc=%d\n",
                    __func__, __LINE__, rc);
@@ -614,6 +614,45 @@ static void increment_sc_logbytes(int64_t bytes)
     Pthread_mutex_unlock(&sc_bps_lk);
 }
 
+/* Without live writers to conflict with, a READ_ONLY schema change
+ * amortises the commit (and the wait for replication) over
+ * num_record_converts records.  Live schema changes commit every record. */
+static inline int convert_batched(struct convert_record_data *data)
+{
+    return !data->live && !data->no_batch && data->num_records_per_trans > 1 &&
+           (data->scanmode == SCAN_PARALLEL ||
+            data->scanmode == SCAN_PAGEORDER);
+}
+
+/* An abort also undoes the records converted earlier in the batch: move
+ * the stripe pointer back so that they are read again */
+static void convert_abort_trans(struct convert_record_data *data)
+{
+    trans_abort(&data->iq, data->trans);
+    data->trans = NULL;
+    if (data->ntrans_recs) {
+        data->sc_genids[data->stripe] = data->trans_genid;
+        data->nrecs -= data->ntrans_recs;
+        data->ntrans_recs = 0;
+    }
+    data->trans_estimate = 0;
+}
+
+static int convert_commit_batch(struct convert_record_data *data)
+{
+    int rc = trans_commit(&data->iq, data->trans, gbl_myhostname);
+    increment_sc_logbytes(data->iq.txnsize - data->trans_estimate);
+    data->trans = NULL;
+    if (rc) {
+        sc_errf(data->s, "convert_record: trans_commit failed with rcode %d", rc);
+        return -2;
+    }
+    ATOMIC_ADD64(data->from->sc_nrecs, data->ntrans_recs);
+    data->ntrans_recs = 0;
+    data->trans_estimate = 0;
+    return 0;
+}
+
 /* converts a single record and prepares for the next one
  * should be called from a while loop
  * param data: pointer to all the state information
@@ -659,6 +698,8 @@ static int convert_record(struct convert_record_data *data)
             sc_errf(data->s, "Error %d starting transaction\n", rc);
             return -2;
         }
+        if (convert_batched(data))
+            data->trans_genid = data->sc_genids[data->stripe];
     }
 
     data->iq.debug = debug_this_request(gbl_debug_until);
@@ -713,6 +754,10 @@ static int convert_record(struct convert_record_data *data)
                 &data->iq, data->sc_genids, &genid, &data->stripe, 1,
                 data->dta_buf, data->trans, data->from->lrl, &dtalen, NULL);
         }
+        /* the next range of the stripe belongs to another thread */
+        if (rc == 0 && data->range_end &&
+            bdb_cmp_genids(genid, data->range_end) > 0)
+            rc = 1;
 
 #ifdef LOGICAL_LIVESC_DEBUG
         logmsg(LOGMSG_DEBUG, "(%u) %s rc=%d genid %llx (%llu)\n", (unsigned int)pthread_self(), __func__, rc, genid,
@@ -755,6 +800,10 @@ static int convert_record(struct convert_record_data *data)
                 return 0;
             }
 
+            /* the stripe must not be marked done ahead of its records */
+            if (data->ntrans_recs && (rc = convert_commit_batch(data)) != 0)
+                return rc;
+
             // AZ: determine what locks we hold at this time
             // bdb_dump_active_locks(data->to->handle, stdout);
             data->sc_genids[data->stripe] = -1ULL;
@@ -773,7 +822,8 @@ static int convert_record(struct convert_record_data *data)
                 usellmeta = 1; /* dta is not being built */
             }
             rc = 0;
-            if (usellmeta && !is_dta_being_rebuilt(data->to->plan)) {
+            if (usellmeta && !is_dta_being_rebuilt(data->to->plan) &&
+                !data->ranged) {
                 int bdberr;
                 rc = bdb_set_high_genid_stripe(NULL, data->to->tablename,
                                                data->stripe, -1ULL, &bdberr);
@@ -785,8 +835,7 @@ static int convert_record(struct convert_record_data *data)
                       data->sc_genids[data->stripe], rc);
             return rc;
         } else if (rc == RC_INTERNAL_RETRY) {
-            trans_abort(&data->iq, data->trans);
-            data->trans = NULL;
+            convert_abort_trans(data);
 
             data->totnretries++;
             if (data->cmembers->is_decrease_thrds)
@@ -894,8 +943,7 @@ static int convert_record(struct convert_record_data *data)
             data->blobix, data->blb.bloblens, data->blb.bloboffs,
             (void **)data->blb.blobptrs, &args, &bdberr);
         if (blobrc != 0 && bdberr == BDBERR_DEADLOCK) {
-            trans_abort(&data->iq, data->trans);
-            data->trans = NULL;
+            convert_abort_trans(data);
             data->totnretries++;
             if (data->cmembers->is_decrease_thrds)
                 decrease_max_threads(&data->cmembers->maxthreads);
@@ -948,7 +996,7 @@ static int convert_record(struct convert_record_data *data)
     }
 
     int dta_needs_conversion = 1;
-    if (usellmeta && data->s->rebuild_index)
+    if (usellmeta && (data->s->rebuild_index || data->ondisk_unchanged))
         dta_needs_conversion = 0;
 
     /* Write record to destination table */
@@ -1019,7 +1067,7 @@ static int convert_record(struct convert_record_data *data)
 
     /* if we have been rebuilding the data files we're gonna
        call bdb_get_high_genid to resume, not look at llmeta */
-    if (usellmeta && !is_dta_being_rebuilt(data->to->plan) &&
+    if (usellmeta && !is_dta_being_rebuilt(data->to->plan) && !data->ranged &&
         (data->nrecs %
          BDB_ATTR_GET(thedb->bdb_attr, INDEXREBUILD_SAVE_EVERY_N)) == 0) {
         int bdberr;
@@ -1062,9 +1110,8 @@ err:
                    __func__, ngenid, data->stripe, data->cv_wait_lsn.file,
                    data->cv_wait_lsn.offset);
             logbytes = bdb_tran_logbytes(data->trans);
-            increment_sc_logbytes(logbytes - estimate);
-            trans_abort(&data->iq, data->trans);
-            data->trans = NULL;
+            increment_sc_logbytes(logbytes - estimate - data->trans_estimate);
+            convert_abort_trans(data);
             poll(0, 0, 200);
             return 1;
         }
@@ -1073,18 +1120,16 @@ err:
     if (gbl_sc_abort || data->from->sc_abort ||
         (data->s->iq && data->s->iq->sc_should_abort)) {
         logbytes = bdb_tran_logbytes(data->trans);
-        increment_sc_logbytes(logbytes - estimate);
-        trans_abort(&data->iq, data->trans);
-        data->trans = NULL;
+        increment_sc_logbytes(logbytes - estimate - data->trans_estimate);
+        convert_abort_trans(data);
         return -1;
     }
 
     /* if we should retry the operation */
     if (rc == RC_INTERNAL_RETRY) {
         logbytes = bdb_tran_logbytes(data->trans);
-        increment_sc_logbytes(logbytes - estimate);
-        trans_abort(&data->iq, data->trans);
-        data->trans = NULL;
+        increment_sc_logbytes(logbytes - estimate - data->trans_estimate);
+        convert_abort_trans(data);
         data->num_retry_errors++;
         data->totnretries++;
         if (!no_wait_rowlock && data->cmembers->is_decrease_thrds)
@@ -1100,13 +1145,19 @@ err:
              * and the stored llmeta genid is stale, some of the records
              * will fail insertion, and that is ok */
 
+            logbytes = bdb_tran_logbytes(data->trans);
+            increment_sc_logbytes(logbytes - estimate - data->trans_estimate);
+            if (data->ntrans_recs) {
+                /* redo the batch one record at a time up to the dup */
+                convert_abort_trans(data);
+                data->no_batch = 1;
+                return 1;
+            }
             sc_errf(data->s, "Skipping duplicate entry in index %d rrn %d genid 0x%llx\n",
                     ixfailnum, rrn, genid);
             data->sc_genids[data->stripe] = genid;
-            logbytes = bdb_tran_logbytes(data->trans);
-            increment_sc_logbytes(logbytes - estimate);
-            trans_abort(&data->iq, data->trans);
-            data->trans = NULL;
+            convert_abort_trans(data);
+            data->no_batch = 0;
             return 1;
         }
 
@@ -1132,27 +1183,36 @@ err:
         data->sc_genids[data->stripe] = genid;
     }
 
-    // now do the commit
-    db_seqnum_type ss;
-    if (data->live) {
-        rc = trans_commit_seqnum(&data->iq, data->trans, &ss);
+    if (convert_batched(data)) {
+        data->trans_estimate += estimate;
+        if (++data->ntrans_recs < data->num_records_per_trans)
+            return 1;
+        /* If commit fail we are failing the whole operation */
+        if ((rc = convert_commit_batch(data)) != 0)
+            return rc;
     } else {
-        rc = trans_commit(&data->iq, data->trans, gbl_myhostname);
-    }
-    increment_sc_logbytes(data->iq.txnsize - estimate);
+        // now do the commit
+        db_seqnum_type ss;
+        if (data->live) {
+            rc = trans_commit_seqnum(&data->iq, data->trans, &ss);
+        } else {
+            rc = trans_commit(&data->iq, data->trans, gbl_myhostname);
+        }
+        increment_sc_logbytes(data->iq.txnsize - estimate);
 
-    data->trans = NULL;
+        data->trans = NULL;
 
-    if (rc) {
-        sc_errf(data->s, "convert_record: trans_commit failed with rcode %d", rc);
-        /* If commit fail we are failing the whole operation */
-        return -2;
-    }
+        if (rc) {
+            sc_errf(data->s, "convert_record: trans_commit failed with rcode %d", rc);
+            /* If commit fail we are failing the whole operation */
+            return -2;
+        }
 
-    if (data->live)
-        delay_sc_if_needed(data, &ss);
+        if (data->live)
+            delay_sc_if_needed(data, &ss);
 
-    ATOMIC_ADD64(data->from->sc_nrecs, 1);
+        ATOMIC_ADD64(data->from->sc_nrecs, 1);
+    }
 
     int now = comdb2_time_epoch();
     if ((rc = report_sc_progress(data, now))) return rc;
@@ -1334,6 +1394,69 @@ static void stop_sc_redo_wait(bdb_state_type *bdb_state,
 
 int gbl_sc_pause_at_end = 0;
 int gbl_sc_is_at_end = 0;
+int gbl_sc_ranges_per_stripe = 1;
+
+/* Split every stripe of a READ_ONLY schema change into nranges genid ranges,
+ * converted by a thread each.  Nothing is being written to the table, so
+ * the ranges only need to stay apart; but the single resume point that is
+ * kept per stripe cannot describe their progress. */
+static int sc_ranges_per_stripe(const struct convert_record_data *data)
+{
+    if (data->live || data->scanmode != SCAN_PARALLEL)
+        return 1;
+    return gbl_sc_ranges_per_stripe > 1 ? gbl_sc_ranges_per_stripe : 1;
+}
+
+/* Give each of the nranges threads of stripe its own stripe pointer, starting
+ * right after the previous range.  Returns the number of ranges to run, which
+ * is 1 if the stripe is small, or -1 on error. */
+static int sc_split_stripe(struct convert_record_data *data,
+                           struct convert_record_data *threadData, int stripe,
+                           int nranges, unsigned long long *genids)
+{
+    unsigned long long oldest, newest;
+    uint8_t ver;
+    int bdberr, dtalen, rc, ii;
+    void *rec;
+
+    /* prepare for the largest possible data */
+    rec = malloc(MAXLRL);
+    if (rec == NULL) {
+        sc_errf(data->s, "[%s] ran out of memory splitting stripe %d\n",
+                data->from->tablename, stripe);
+        return -1;
+    }
+    dtalen = MAXLRL;
+    rc = bdb_find_oldest_genid(data->from->handle, NULL, stripe, rec, &dtalen,
+                               dtalen, &oldest, &ver, &bdberr);
+    if (rc == 0) {
+        dtalen = MAXLRL;
+        rc = bdb_find_newest_genid(data->from->handle, NULL, stripe, rec,
+                                   &dtalen, dtalen, &newest, &ver, &bdberr);
+    }
+    free(rec);
+    if (rc < 0 || bdberr != BDBERR_NOERROR) {
+        sc_errf(data->s, "[%s] failed to find genid range of stripe %d\n",
+                data->from->tablename, stripe);
+        return -1;
+    }
+    if (rc == 1 || bdb_cmp_genids(oldest, newest) >= 0)
+        nranges = 1;
+
+    for (ii = 0; ii < nranges; ++ii) {
+        memcpy(&genids[ii * MAXDTASTRIPE], data->sc_genids,
+               sizeof(unsigned long long) * MAXDTASTRIPE);
+        threadData[ii].sc_genids = &genids[ii * MAXDTASTRIPE];
+        threadData[ii].ranged = 1;
+        if (ii > 0)
+            threadData[ii].sc_genids[stripe] = threadData[ii - 1].range_end;
+        threadData[ii].range_end =
+            (ii == nranges - 1)
+                ? 0
+                : bdb_genid_split(oldest, newest, ii + 1, nranges);
+    }
+    return nranges;
+}
 
 int convert_all_records(struct dbtable *from, struct dbtable *to,
                         unsigned long long *sc_genids,
@@ -1360,6 +1483,14 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
         return -1;
     }
 
+    if (s->resume && sc_ranges_per_stripe(&data) > 1) {
+        /* the ranges have saved no progress to resume from */
+        sc_errf(data.s, "cannot resume a schema change converted with "
+                        "sc_ranges_per_stripe %d\n",
+                gbl_sc_ranges_per_stripe);
+        return -1;
+    }
+
     /* Calculate blob data file numbers to feed direct into bdb.  This used
      * to be a hard coded array.  And it was wrong.  By employing for loop
      * technology, we can't possibly get this wrong again! */
@@ -1409,12 +1540,13 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
     }
 
     data.cmembers = calloc(1, sizeof(struct common_members));
+    int max_threads = gbl_dtastripe * sc_ranges_per_stripe(&data);
     int sc_threads =
         bdb_attr_get(data.from->dbenv->bdb_attr, BDB_ATTR_SC_USE_NUM_THREADS);
-    if (sc_threads <= 0 || sc_threads > gbl_dtastripe) {
+    if (sc_threads <= 0 || sc_threads > max_threads) {
         bdb_attr_set(data.from->dbenv->bdb_attr, BDB_ATTR_SC_USE_NUM_THREADS,
-                     gbl_dtastripe);
-        sc_threads = gbl_dtastripe;
+                     max_threads);
+        sc_threads = max_threads;
     }
     data.cmembers->maxthreads = sc_threads;
     data.cmembers->is_decrease_thrds = bdb_attr_get(
@@ -1424,6 +1556,19 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
     data.tagmap = get_tag_mapping(
         data.from->schema /*tbl .ONDISK tag schema*/,
         data.to->schema /*tbl .NEW..ONDISK schema */); // free tagmap only once
+    data.convprog = get_conv_program(data.from->schema, data.to->schema,
+                                     data.tagmap);
+    /* When only indexes are being built over the existing data file (e.g.
+     * an added index), rows read from it are already laid out as the new
+     * .ONDISK: form their keys directly instead of converting every row. */
+    data.ondisk_unchanged =
+        gbl_use_plan && data.to->plan && !data.to->plan->dta_plan &&
+        data.from->schema->nmembers == data.to->schema->nmembers &&
+        compare_tag_int(data.from->schema, data.to->schema, NULL, 1) ==
+            SC_NO_CHANGE;
+    if (data.ondisk_unchanged)
+        sc_printf(s, "[%s] data layout unchanged, building indexes from "
+                     "stored rows\n", from->tablename);
     int outrc = 0;
 
     if (gbl_logical_live_sc) {
@@ -1530,32 +1675,70 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
         convert_records_thd(&data);
         outrc = data.outrc;
     } else {
-        struct convert_record_data threadData[gbl_dtastripe];
-        int threadSkipped[gbl_dtastripe];
+        int nranges = sc_ranges_per_stripe(&data);
+        int nthreads = gbl_dtastripe * nranges;
+        struct convert_record_data *threadData;
+        int *threadSkipped;
+        unsigned long long *range_genids = NULL;
         pthread_attr_t attr;
         int rc = 0;
 
+        threadData = calloc(nthreads, sizeof(struct convert_record_data));
+        threadSkipped = calloc(nthreads, sizeof(int));
+        if (nranges > 1)
+            range_genids = calloc(nthreads * MAXDTASTRIPE,
+                                  sizeof(unsigned long long));
+        if (!threadData || !threadSkipped || (nranges > 1 && !range_genids)) {
+            sc_errf(s, "[%s] ran out of memory for %d convert threads\n",
+                    from->tablename, nthreads);
+            outrc = -1;
+            nthreads = 0;
+        } else if (nranges > 1)
+            sc_printf(s, "[%s] converting each stripe in %d genid ranges\n",
+                      from->tablename, nranges);
+
         data.isThread = 1;
 
         Pthread_attr_init(&attr);
         Pthread_attr_setstacksize(&attr, DEFAULT_THD_STACKSZ);
         Pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
 
-        /* start one thread for each stripe */
-        for (ii = 0; ii < gbl_dtastripe; ++ii) {
-            /* create a copy of the data, modifying the necessary
-             * thread specific values
-             */
-            threadData[ii] = data;
-            threadData[ii].stripe = ii;
+        /* start one thread for each stripe, or for each range of a stripe */
+        for (ii = 0; ii < nthreads; ++ii) {
+            int stripe = ii / nranges;
+
+            if (ii % nranges == 0) {
+                /* create a copy of the data, modifying the necessary
+                 * thread specific values
+                 */
+                for (int jj = 0; jj < nranges; ++jj) {
+                    threadData[ii + jj] = data;
+                    threadData[ii + jj].stripe = stripe;
+                }
+
+                if (sc_genids[stripe] == -1ULL) {
+                    sc_printf(threadData[ii].s, "[%s] stripe %d was done\n",
+                              from->tablename, threadData[ii].stripe);
+                    for (int jj = 0; jj < nranges; ++jj)
+                        threadSkipped[ii + jj] = 1;
+                }
 
-            if (sc_genids[ii] == -1ULL) {
-                sc_printf(threadData[ii].s, "[%s] stripe %d was done\n",
-                          from->tablename, threadData[ii].stripe);
-                threadSkipped[ii] = 1;
+                if (!threadSkipped[ii] && nranges > 1) {
+                    int n = sc_split_stripe(&data, &threadData[ii], stripe,
+                                            nranges,
+                                            &range_genids[ii * MAXDTASTRIPE]);
+                    if (n < 0) {
+                        outrc = -1;
+                        break;
+                    }
+                    /* a stripe too small to split is left to one thread */
+                    for (int jj = n; jj < nranges; ++jj)
+                        threadSkipped[ii + jj] = 1;
+                }
+            }
+
+            if (threadSkipped[ii])
                 continue;
-            } else
-                threadSkipped[ii] = 0;
 
             sc_printf(threadData[ii].s, "[%s] starting thread for stripe: %d\n",
                       from->tablename, threadData[ii].stripe);
@@ -1579,13 +1762,15 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
         }
 
         /* wait for all convert threads to complete */
-        for (ii = 0; ii < gbl_dtastripe; ++ii) {
+        for (ii = 0; ii < nthreads; ++ii) {
             void *ret;
 
             if (threadSkipped[ii]) continue;
 
             /* if the threadid is NULL, skip this one */
             if (!threadData[ii].tid) {
+                if (outrc)
+                    continue; /* never started */
                 sc_errf(threadData[ii].s, "skip joining thread failed for "
                                           "stripe: %d because tid is null\n",
                         threadData[ii].stripe);
@@ -1608,6 +1793,18 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
             if (threadData[ii].outrc != 0) outrc = threadData[ii].outrc;
         }
 
+        /* report the stripe as far as its first range has got */
+        for (ii = 0; range_genids && ii < nthreads; ii += nranges) {
+            int stripe = ii / nranges;
+            if (!threadSkipped[ii])
+                sc_genids[stripe] = outrc ? threadData[ii].sc_genids[stripe]
+                                          : -1ULL;
+        }
+
+        free(range_genids);
+        free(threadSkipped);
+        free(threadData);
+
         /* destroy attr */
         Pthread_attr_destroy(&attr);
     }
@@ -1635,6 +1832,8 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
         free(data.tagmap);
         data.tagmap = NULL;
     }
+    free(data.convprog);
+    data.convprog = NULL;
 
     if (s->logical_livesc) {
         if (outrc == 0) {
@@ -2587,7 +2786,7 @@ static int live_sc_redo_add(struct convert_record_data *data, DB_LOGC *logc,
     }
 
     int dta_needs_conversion = 1;
-    if (usellmeta && data->s->rebuild_index)
+    if (usellmeta && (data->s->rebuild_index || data->ondisk_unchanged))
         dta_needs_conversion = 0;
 
     unsigned long long dirty_keys = -1ULL;
@@ -3540,6 +3739,8 @@ void *live_sc_logical_redo_thd(struct convert_record_data *data)
     data->tagmap = get_tag_mapping(
         data->from->schema /*tbl .ONDISK tag schema*/,
         data->to->schema /*tbl .NEW..ONDISK schema */); // free tagmap only once
+    data->convprog = get_conv_program(data->from->schema, data->to->schema,
+                                      data->tagmap);
 
     s->hitLastCnt = 0;
 
@@ -3817,6 +4018,7 @@ cleanup:
 
     data->to->sc_from = NULL;
 
+    free(data->convprog);
     free(data);
     return NULL;
 }
@@ -57,6 +57,8 @@ struct convert_record_data {
     struct dbtable *from, *to;
     unsigned long long *sc_genids;
     int stripe;
+    int ranged;                    /* converting one genid range of stripe */
+    unsigned long long range_end;  /* last genid of the range, 0 for all */
     struct dtadump *dmp;
     char *lastkey, *curkey;
     char key1[MAXKEYLEN], key2[MAXKEYLEN];
@@ -69,8 +71,14 @@ struct convert_record_data {
     unsigned n_genids_changed;
     long long nrecs, prev_nrecs, nrecskip;
     int num_records_per_trans;
+    int ntrans_recs;                /* converted in the open batch */
+    int64_t trans_estimate;         /* log bytes throttled for them */
+    unsigned long long trans_genid; /* stripe position the batch began at */
+    int no_batch;                   /* commit one record at a time */
     int num_retry_errors;
     int *tagmap; // mapping of fields from -> to
+    struct convprog *convprog; // tagmap compiled, shared like tagmap
+    int ondisk_unchanged; // rows need no conversion to the new .ONDISK
     /* all the data objects point to the same single cmembers object */
     struct common_members *cmembers;
     unsigned int write_count; // saved write counter to this tbl
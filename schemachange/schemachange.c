@@ -1289,6 +1289,71 @@ error:
     return xerr->errval;
 }
 
+/* Rebuild an old shard, packing its btrees and compressing its records and
+ * blobs with "compress"; a shard already compressed that way is left alone.
+ * The rebuild is live and runs asynchronously */
+int sc_timepart_compress_table(const char *tableName, int compress,
+                               struct errstat *xerr)
+{
+    struct schema_change_type *sc;
+    struct dbtable *db;
+    int crt, crt_blobs;
+    int rc;
+
+    db = get_dbtable_by_name(tableName);
+    if (db == NULL) {
+        errstat_set_rcstrf(xerr, SC_VIEW_ERR_BUG, "table '%s' not found",
+                           tableName);
+        return xerr->errval;
+    }
+    if (db->odh && get_db_compress(db, &crt) == 0 &&
+        get_db_compress_blobs(db, &crt_blobs) == 0 && crt == compress &&
+        crt_blobs == compress) {
+        bzero(xerr, sizeof(*xerr));
+        return SC_VIEW_NOERR;
+    }
+
+    if (thedb->master != gbl_myhostname) {
+        errstat_set_rcstrf(xerr, SC_VIEW_ERR_EXIST,
+                           "I am not master; master is %s", thedb->master);
+        return xerr->errval;
+    }
+
+    sc = new_schemachange_type();
+    if (sc == NULL) {
+        errstat_set_rcstrf(xerr, SC_VIEW_ERR_BUG, "malloc failed");
+        return xerr->errval;
+    }
+    strncpy0(sc->tablename, tableName, sizeof(sc->tablename));
+    sc->kind = SC_REBUILDTABLE;
+    sc->live = 1;
+    sc->finalize = 1;
+    sc->scanmode = gbl_default_sc_scanmode;
+    sc->same_schema = 1;
+    sc->force_rebuild = 1;
+    sc->headers = 1;
+    sc->compress = compress;
+    sc->compress_blobs = compress;
+
+    if (get_csc2_file(tableName, -1 /*highest csc2_version*/, &sc->newcsc2,
+                      NULL /*csc2len*/)) {
+        free_schema_change_type(sc);
+        errstat_set_rcstrf(xerr, SC_VIEW_ERR_BUG,
+                           "could not get schema for table '%s'", tableName);
+        return xerr->errval;
+    }
+
+    rc = start_schema_change(sc);
+    if (rc != SC_OK && rc != SC_ASYNC) {
+        errstat_set_rcstrf(xerr, SC_VIEW_ERR_SC,
+                           "failed to start rebuild rc %d", rc);
+        return xerr->errval;
+    }
+
+    bzero(xerr, sizeof(*xerr));
+    return SC_VIEW_NOERR;
+}
+
 int sc_timepart_truncate_table(const char *tableName, struct errstat *xerr,
                                void *partition)
 {
@@ -40,40 +40,50 @@ typedef struct getactivelocks {
     int count;
     int alloc;
     systable_activelocks_t *records;
+    const struct systable_filter *filter;
 } getactivelocks_t;
 
+/* Called with the lock region locked: rows the query's WHERE clause rules
+ * out are dropped before anything is allocated for them */
 static int collect(void *args, int64_t threadid, int32_t lockerid,
         const char *mode, const char *status, const char *object,
         int64_t page, const char *rectype)
 {
     getactivelocks_t *a = (getactivelocks_t *)args;
-    systable_activelocks_t *l;
+    systable_activelocks_t l = {0};
+    l.threadid = threadid;
+    l.lockerid = lockerid;
+    l.mode = mode;
+    l.status = status;
+    if (page < 0) {
+        l.page_isnull = 1;
+    } else {
+        l.page = page;
+        l.page_isnull = 0;
+    }
+    l.object = (char *)(object ? object : "");
+    l.type = (char *)(rectype ? rectype : "");
+    if (!systable_filter_row(a->filter, &l))
+        return 0;
+
     a->count++;
     if (a->count >= a->alloc) {
         if (a->alloc == 0) a->alloc = 16;
         else a->alloc = a->alloc * 2;
         a->records = realloc(a->records, a->alloc * sizeof(systable_activelocks_t));
     }
-    l = &a->records[a->count - 1];
-    l->threadid = threadid;
-    l->lockerid = lockerid;
-    l->mode = mode;
-    l->status = status;
-    if (page < 0) {
-        l->page_isnull = 1;
-    } else {
-        l->page = page;
-        l->page_isnull = 0;
-    }
-    l->object = strdup(object ? object : "");
-    l->type = strdup(rectype ? rectype : "");
+    l.object = strdup(l.object);
+    l.type = strdup(l.type);
+    memcpy(&a->records[a->count - 1], &l, sizeof(l));
     return 0;
 }
 
-static int get_activelocks(void **data, int *records)
+static int get_activelocks(const struct systable_filter *filter, void **data,
+                           int *records)
 {
     bdb_state_type *bdb_state = thedb->bdb_env;
     getactivelocks_t a = {0};
+    a.filter = filter;
     bdb_state->dbenv->collect_locks(bdb_state->dbenv, collect, &a);
     *data = a.records;
     *records = a.count;
@@ -96,7 +106,7 @@ sqlite3_module systblActiveLocksModule = {
 };
 
 int systblActivelocksInit(sqlite3 *db) {
-    return create_system_table(db, "comdb2_locks", &systblActiveLocksModule,
+    return create_system_table_v3(db, "comdb2_locks", &systblActiveLocksModule,
             get_activelocks, free_activelocks, sizeof(systable_activelocks_t),
             CDB2_INTEGER, "thread", -1, offsetof(systable_activelocks_t, threadid),
             CDB2_INTEGER, "lockerid", -1, offsetof(systable_activelocks_t, lockerid),
@@ -0,0 +1,79 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "admission.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+
+typedef struct systable_admission {
+    const char *state;
+    double level;
+    double queue_ms;
+    double miss_pct;
+    double lockwait_ms;
+    int64_t delayed;
+    int64_t shed;
+} systable_admission_t;
+
+static int get_admission(void **data, int *records)
+{
+    systable_admission_t *p;
+    struct admission_stats st;
+
+    if ((p = calloc(1, sizeof(*p))) == NULL)
+        return ENOMEM;
+    admission_get_stats(&st);
+    p->state = admission_state_name(st.state);
+    p->level = st.level;
+    p->queue_ms = st.queue_ms;
+    p->miss_pct = st.miss_pct;
+    p->lockwait_ms = st.lockwait_ms;
+    p->delayed = st.delayed;
+    p->shed = st.shed;
+    *data = p;
+    *records = 1;
+    return 0;
+}
+
+static void free_admission(void *p, int n)
+{
+    free(p);
+}
+
+sqlite3_module systblAdmissionModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblAdmissionInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_admission", &systblAdmissionModule, get_admission,
+        free_admission, sizeof(systable_admission_t),
+        CDB2_CSTRING, "state", -1, offsetof(systable_admission_t, state),
+        CDB2_REAL, "level", -1, offsetof(systable_admission_t, level),
+        CDB2_REAL, "queue_ms", -1, offsetof(systable_admission_t, queue_ms),
+        CDB2_REAL, "miss_pct", -1, offsetof(systable_admission_t, miss_pct),
+        CDB2_REAL, "lockwait_ms", -1,
+        offsetof(systable_admission_t, lockwait_ms),
+        CDB2_INTEGER, "delayed", -1, offsetof(systable_admission_t, delayed),
+        CDB2_INTEGER, "shed", -1, offsetof(systable_admission_t, shed),
+        SYSTABLE_END_OF_FIELDS);
+}
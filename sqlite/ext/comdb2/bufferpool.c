@@ -0,0 +1,191 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "bdb_api.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+
+extern int gbl_bufferpool_heatmap_ranges;
+
+typedef struct systable_bufferpool {
+    char *file;
+    int64_t level;
+    int64_t resident;
+    int64_t dirty;
+    int64_t accesses;
+    int64_t hits;
+    int64_t misses;
+    double hit_rate;
+    int64_t evictions;
+} systable_bufferpool_t;
+
+typedef struct systable_heatmap {
+    char *file;
+    int64_t first_page;
+    int64_t last_page;
+    int64_t resident;
+    int64_t accesses;
+} systable_heatmap_t;
+
+typedef struct getrows {
+    int count;
+    int alloc;
+    size_t size;
+    void *records;
+} getrows_t;
+
+static void *add_row(getrows_t *a)
+{
+    void *p;
+    if (a->count >= a->alloc) {
+        a->alloc = a->alloc ? a->alloc * 2 : 256;
+        p = realloc(a->records, a->alloc * a->size);
+        if (p == NULL)
+            return NULL;
+        a->records = p;
+    }
+    p = (char *)a->records + a->count * a->size;
+    memset(p, 0, a->size);
+    a->count++;
+    return p;
+}
+
+static int collect_level(void *arg, const char *file, int level,
+                         int64_t resident, int64_t dirty, int64_t accesses,
+                         int64_t hits, int64_t misses, int64_t evictions)
+{
+    systable_bufferpool_t *p = add_row(arg);
+    if (p == NULL || (p->file = strdup(file)) == NULL)
+        return ENOMEM;
+    p->level = level;
+    p->resident = resident;
+    p->dirty = dirty;
+    p->accesses = accesses;
+    p->hits = hits;
+    p->misses = misses;
+    p->hit_rate = hits + misses ? 100.0 * hits / (hits + misses) : 0;
+    p->evictions = evictions;
+    return 0;
+}
+
+static int collect_range(void *arg, const char *file, int64_t first_pgno,
+                         int64_t last_pgno, int64_t resident,
+                         int64_t accesses)
+{
+    systable_heatmap_t *p = add_row(arg);
+    if (p == NULL || (p->file = strdup(file)) == NULL)
+        return ENOMEM;
+    p->first_page = first_pgno;
+    p->last_page = last_pgno;
+    p->resident = resident;
+    p->accesses = accesses;
+    return 0;
+}
+
+/* both row types start with the file name */
+static void free_rows(void *p, int n, size_t size)
+{
+    for (int i = 0; i < n; i++)
+        free(*(char **)((char *)p + i * size));
+    free(p);
+}
+
+static void free_bufferpool(void *p, int n)
+{
+    free_rows(p, n, sizeof(systable_bufferpool_t));
+}
+
+static void free_heatmap(void *p, int n)
+{
+    free_rows(p, n, sizeof(systable_heatmap_t));
+}
+
+static int get_bufferpool(void **data, int *records)
+{
+    getrows_t a = {.size = sizeof(systable_bufferpool_t)};
+    int rc = bdb_collect_bufferpool(thedb->bdb_env, collect_level, &a);
+    if (rc) {
+        free_bufferpool(a.records, a.count);
+        return rc;
+    }
+    *data = a.records;
+    *records = a.count;
+    return 0;
+}
+
+static int get_heatmap(void **data, int *records)
+{
+    getrows_t a = {.size = sizeof(systable_heatmap_t)};
+    int nranges = gbl_bufferpool_heatmap_ranges > 0
+                      ? gbl_bufferpool_heatmap_ranges
+                      : 1;
+    int rc = bdb_collect_bufferpool_heat(thedb->bdb_env, nranges,
+                                         collect_range, &a);
+    if (rc) {
+        free_heatmap(a.records, a.count);
+        return rc;
+    }
+    *data = a.records;
+    *records = a.count;
+    return 0;
+}
+
+sqlite3_module systblBufferPoolModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+sqlite3_module systblBufferPoolHeatmapModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblBufferPoolInit(sqlite3 *db)
+{
+    int rc = create_system_table(
+        db, "comdb2_buffer_pool", &systblBufferPoolModule, get_bufferpool,
+        free_bufferpool, sizeof(systable_bufferpool_t),
+        CDB2_CSTRING, "file", -1, offsetof(systable_bufferpool_t, file),
+        CDB2_INTEGER, "level", -1, offsetof(systable_bufferpool_t, level),
+        CDB2_INTEGER, "resident_pages", -1,
+        offsetof(systable_bufferpool_t, resident),
+        CDB2_INTEGER, "dirty_pages", -1,
+        offsetof(systable_bufferpool_t, dirty),
+        CDB2_INTEGER, "accesses", -1,
+        offsetof(systable_bufferpool_t, accesses),
+        CDB2_INTEGER, "hits", -1, offsetof(systable_bufferpool_t, hits),
+        CDB2_INTEGER, "misses", -1, offsetof(systable_bufferpool_t, misses),
+        CDB2_REAL, "hit_rate", -1, offsetof(systable_bufferpool_t, hit_rate),
+        CDB2_INTEGER, "evictions", -1,
+        offsetof(systable_bufferpool_t, evictions),
+        SYSTABLE_END_OF_FIELDS);
+    if (rc)
+        return rc;
+    return create_system_table(
+        db, "comdb2_buffer_pool_heatmap", &systblBufferPoolHeatmapModule,
+        get_heatmap, free_heatmap, sizeof(systable_heatmap_t),
+        CDB2_CSTRING, "file", -1, offsetof(systable_heatmap_t, file),
+        CDB2_INTEGER, "first_page", -1,
+        offsetof(systable_heatmap_t, first_page),
+        CDB2_INTEGER, "last_page", -1, offsetof(systable_heatmap_t, last_page),
+        CDB2_INTEGER, "resident_pages", -1,
+        offsetof(systable_heatmap_t, resident),
+        CDB2_INTEGER, "accesses", -1, offsetof(systable_heatmap_t, accesses),
+        SYSTABLE_END_OF_FIELDS);
+}
@@ -62,7 +62,18 @@ extern sqlite3_module systblTimepartPermissionsModule;
 int systblTypeSamplesInit(sqlite3 *db);
 int systblRepNetQueueStatInit(sqlite3 *db);
 int systblSqlpoolQueueInit(sqlite3 *db);
+int systblSqlResultCacheInit(sqlite3 *db);
 int systblActivelocksInit(sqlite3 *db);
+int systblLockPartitionsInit(sqlite3 *db);
+int systblFileReclaimInit(sqlite3 *db);
+int systblReplHistoryInit(sqlite3 *db);
+int systblTableIOInit(sqlite3 *db);
+int systblBufferPoolInit(sqlite3 *db);
+int systblProfileInit(sqlite3 *db);
+int systblLatencyHistogramsInit(sqlite3 *db);
+int systblAdmissionInit(sqlite3 *db);
+int systblPgCompactSweepInit(sqlite3 *db);
+int systblLockWaitsInit(sqlite3 *db);
 int systblNetUserfuncsInit(sqlite3 *db);
 int systblClusterInit(sqlite3 *db);
 int systblActiveOsqlsInit(sqlite3 *db);
@@ -97,5 +97,7 @@ int systblConnectionsInit(sqlite3 *db) {
             CDB2_INTEGER, "is_ssl", -1, offsetof(struct connection_info, is_ssl),
             CDB2_INTEGER, "has_cert", -1, offsetof(struct connection_info, has_cert),
             CDB2_CSTRING, "common_name", -1, offsetof(struct connection_info, common_name),
+            CDB2_INTEGER, "bytes_written", -1, offsetof(struct connection_info, net_bytes_written),
+            CDB2_INTEGER, "write_calls", -1, offsetof(struct connection_info, net_write_calls),
             SYSTABLE_END_OF_FIELDS);
 }
@@ -34,7 +34,13 @@
  * boilerplate code. A common case though is that you have an array of
  * structures that you want to emit. create_system_table lets you specify a
  * table name, the size of the structure, and a list of fields and types. It
- * takes care of the boilerplate. */
+ * takes care of the boilerplate.
+ *
+ * Tables created with create_system_table_v3 collect their rows in xFilter
+ * rather than xOpen, and are handed the integer and string comparisons from
+ * the WHERE clause.  The comparisons are not omitted from sqlite's own
+ * checks, so a provider that ignores them, or a type we cannot compare
+ * exactly, only costs the rows it keeps. */
 
 enum {
     FIELD_TYPE_MASK = 0x0fff
@@ -57,6 +63,19 @@ struct systable {
 
     int (*init_v2)(ez_systable_vtab *vtab, void **data, int *npoints);
     void (*release_v2)(ez_systable_vtab *vtab, void *data, int npoints);
+
+    int (*init_v3)(const struct systable_filter *f, void **data,
+                   int *npoints);
+};
+
+struct systable_filter {
+    struct systable *t;
+    int ncons;
+    struct {
+        int column;
+        int op; /* SQLITE_INDEX_CONSTRAINT_xx */
+        sqlite3_value *value;
+    } cons[1];
 };
 
 struct ez_systable_cursor {
@@ -65,9 +84,12 @@ struct ez_systable_cursor {
     int64_t rowid;
     void *data;
     int npoints;
+    int filtered; /* v3: data was collected by xFilter */
 };
 typedef struct ez_systable_cursor ez_systable_cursor;
 
+static void* get_field_ptr(struct systable *t, char *rec, int column);
+
 static int systbl_connect(
   sqlite3 *db,
   void *pAux,
@@ -108,11 +130,138 @@ static int systbl_connect(
     return rc;
 }
 
+static int pushable(struct systable *t, sqlite3_index_info *pIdxInfo, int i)
+{
+    const struct sqlite3_index_constraint *c = &pIdxInfo->aConstraint[i];
+    const char *coll;
+
+    if (!c->usable || c->iColumn < 0 || c->iColumn >= t->nfields)
+        return 0;
+    switch (c->op) {
+    case SQLITE_INDEX_CONSTRAINT_EQ:
+    case SQLITE_INDEX_CONSTRAINT_GT:
+    case SQLITE_INDEX_CONSTRAINT_LE:
+    case SQLITE_INDEX_CONSTRAINT_LT:
+    case SQLITE_INDEX_CONSTRAINT_GE:
+        break;
+    default:
+        return 0;
+    }
+    switch (t->fields[c->iColumn].type & FIELD_TYPE_MASK) {
+    case CDB2_INTEGER:
+        return !(t->fields[c->iColumn].type & SYSTABLE_FIELD_NULLABLE);
+    case CDB2_CSTRING:
+        /* we compare bytes; leave other collations to sqlite */
+        coll = sqlite3_vtab_collation(pIdxInfo, i);
+        return coll == NULL || sqlite3_stricmp(coll, "BINARY") == 0;
+    default:
+        return 0;
+    }
+}
+
 static int systbl_best_index(
   sqlite3_vtab *tab,
   sqlite3_index_info *pIdxInfo
 ){
-  return SQLITE_OK;
+    struct systable *t = ((ez_systable_vtab *)tab)->t;
+    strbuf *ops;
+    int n = 0, neq = 0;
+
+    if (t->init_v3 == NULL)
+        return SQLITE_OK;
+
+    /* idxStr lists "column op" for each argv passed to xFilter */
+    ops = strbuf_new();
+    for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+        if (!pushable(t, pIdxInfo, i))
+            continue;
+        pIdxInfo->aConstraintUsage[i].argvIndex = ++n;
+        pIdxInfo->aConstraintUsage[i].omit = 0;
+        strbuf_appendf(ops, "%d %d ", pIdxInfo->aConstraint[i].iColumn,
+                       pIdxInfo->aConstraint[i].op);
+        if (pIdxInfo->aConstraint[i].op == SQLITE_INDEX_CONSTRAINT_EQ)
+            neq++;
+    }
+    if (n) {
+        pIdxInfo->idxStr = sqlite3_mprintf("%s", strbuf_buf(ops));
+        pIdxInfo->needToFreeIdxStr = 1;
+        pIdxInfo->idxNum = n;
+        pIdxInfo->estimatedCost = neq ? 10 : 1000;
+    } else {
+        pIdxInfo->estimatedCost = 100000;
+    }
+    strbuf_free(ops);
+    return SQLITE_OK;
+}
+
+static int compare_field(struct systable *t, const char *rec, int column,
+                         sqlite3_value *value, int *cmp)
+{
+    void *field = get_field_ptr(t, (char *)rec, column);
+
+    if (field == NULL)
+        return -1; /* NULL never compares */
+    switch (t->fields[column].type & FIELD_TYPE_MASK) {
+    case CDB2_INTEGER: {
+        int64_t a, b;
+        if (sqlite3_value_type(value) != SQLITE_INTEGER)
+            return 1;
+        a = *(int64_t *)field;
+        b = sqlite3_value_int64(value);
+        *cmp = (a > b) - (a < b);
+        return 0;
+    }
+    case CDB2_CSTRING: {
+        const char *a = *(char **)field;
+        const char *b;
+        if (sqlite3_value_type(value) != SQLITE_TEXT)
+            return 1;
+        b = (const char *)sqlite3_value_text(value);
+        if (a == NULL || b == NULL)
+            return 1;
+        *cmp = strcmp(a, b);
+        return 0;
+    }
+    }
+    return 1;
+}
+
+int systable_filter_row(const struct systable_filter *f, const void *rec)
+{
+    if (f == NULL)
+        return 1;
+    for (int i = 0; i < f->ncons; i++) {
+        int cmp = 0;
+        int rc = compare_field(f->t, rec, f->cons[i].column, f->cons[i].value,
+                               &cmp);
+        if (rc < 0)
+            return 0;
+        if (rc > 0) /* can't tell; sqlite will */
+            continue;
+        switch (f->cons[i].op) {
+        case SQLITE_INDEX_CONSTRAINT_EQ:
+            if (cmp != 0)
+                return 0;
+            break;
+        case SQLITE_INDEX_CONSTRAINT_GT:
+            if (cmp <= 0)
+                return 0;
+            break;
+        case SQLITE_INDEX_CONSTRAINT_LE:
+            if (cmp > 0)
+                return 0;
+            break;
+        case SQLITE_INDEX_CONSTRAINT_LT:
+            if (cmp >= 0)
+                return 0;
+            break;
+        case SQLITE_INDEX_CONSTRAINT_GE:
+            if (cmp < 0)
+                return 0;
+            break;
+        }
+    }
+    return 1;
 }
 
 static int systbl_open(sqlite3_vtab *p, sqlite3_vtab_cursor **ppCursor){
@@ -122,7 +271,10 @@ static int systbl_open(sqlite3_vtab *p, sqlite3_vtab_cursor **ppCursor){
     struct systable *t = vtab->t;
     pCur->rowid = 0;
     pCur->t = t;
-    if (t->init_v2) {
+    if (t->init_v3) {
+        /* collected in systbl_filter, once we know the constraints */
+        rc = SQLITE_OK;
+    } else if (t->init_v2) {
         rc = t->init_v2(vtab, &pCur->data, &pCur->npoints);
     } else {
         rc = t->init(&pCur->data, &pCur->npoints);
@@ -134,7 +286,8 @@ static int systbl_open(sqlite3_vtab *p, sqlite3_vtab_cursor **ppCursor){
 static int systbl_close(sqlite3_vtab_cursor *cur){
     struct ez_systable_cursor *pCur = (struct ez_systable_cursor*) cur;
     struct systable *t = pCur->t;
-    t->release(pCur->data, pCur->npoints);
+    if (!t->init_v3 || pCur->filtered)
+        t->release(pCur->data, pCur->npoints);
     free(pCur);
     return SQLITE_OK;
 }
@@ -294,8 +447,45 @@ static int systbl_filter(
   int argc, sqlite3_value **argv
 ){
     struct ez_systable_cursor *pCur = (struct ez_systable_cursor*) pVtabCursor;
+    struct systable *t = pCur->t;
+    struct systable_filter *f;
+    const char *p = idxStr;
+    int rc;
+
     pCur->rowid = 0;
-    return SQLITE_OK;
+    if (!t->init_v3)
+        return SQLITE_OK;
+
+    /* rescanned as the inner table of a join: collect again, the
+     * constraints may have changed */
+    if (pCur->filtered) {
+        t->release(pCur->data, pCur->npoints);
+        pCur->data = NULL;
+        pCur->npoints = 0;
+        pCur->filtered = 0;
+    }
+
+    f = calloc(1, offsetof(struct systable_filter, cons) +
+                      (argc ? argc : 1) * sizeof(f->cons[0]));
+    if (f == NULL)
+        return SQLITE_NOMEM;
+    f->t = t;
+    for (int i = 0; i < argc && p; i++) {
+        int column, op, n;
+        if (sscanf(p, "%d %d %n", &column, &op, &n) != 2)
+            break;
+        p += n;
+        f->cons[f->ncons].column = column;
+        f->cons[f->ncons].op = op;
+        f->cons[f->ncons].value = argv[i];
+        f->ncons++;
+    }
+
+    rc = t->init_v3(f, &pCur->data, &pCur->npoints);
+    free(f);
+    if (rc == 0)
+        pCur->filtered = 1;
+    return rc;
 }
 
 
@@ -397,6 +587,26 @@ int create_system_table(sqlite3 *db, char *name, sqlite3_module *module,
 
     sys->init = init_callback;
     sys->init_v2 = NULL;
+    sys->init_v3 = NULL;
+    sys->release = release_callback;
+
+    va_list args;
+    va_start(args, struct_size);
+    create_system_tableV(sys, db, name, module, struct_size, args);
+    va_end(args);
+
+    return 0;
+}
+
+int create_system_table_v3(sqlite3 *db, char *name, sqlite3_module *module,
+                           int (*init_callback)(const struct systable_filter *f,
+                                                void **data, int *npoints),
+                           void (*release_callback)(void *data, int npoints),
+                           size_t struct_size, ...)
+{
+    struct systable *sys = calloc(1, sizeof(struct systable));
+
+    sys->init_v3 = init_callback;
     sys->release = release_callback;
 
     va_list args;
@@ -417,6 +627,7 @@ int create_system_table_v2(sqlite3 *db, char *name, sqlite3_module *module,
 
     sys->init = NULL;
     sys->init_v2 = init_callback;
+    sys->init_v3 = NULL;
     sys->release = release_callback;
 
     va_list args;
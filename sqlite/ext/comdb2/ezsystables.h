@@ -51,4 +51,25 @@ int create_system_table_v2(sqlite3 *db, char *name, sqlite3_module *module,
         // type, name, offset, type3, name2, offset2, ..., SYSTABLE_END_OF_FIELDS
         ...);
 
+/* Comparisons on integer and string columns that sqlite pushed down to a
+   table created with create_system_table_v3. */
+struct systable_filter;
+
+/* Does rec, laid out like the table's struct, pass every pushed down
+   comparison?  Strings may still point at memory the caller does not own,
+   so a row can be checked before it is copied. */
+int systable_filter_row(const struct systable_filter *f, const void *rec);
+
+/* Like create_system_table, but the rows are collected when the query
+   starts scanning, with the comparisons from its WHERE clause, so the init
+   callback can skip rows (and work done under locks) the query would
+   discard.  sqlite still checks every row it is given. */
+int create_system_table_v3(sqlite3 *db, char *name, sqlite3_module *module,
+        int(*init_callback)(const struct systable_filter *f, void **data,
+                            int *npoints),
+        void(*release_callback)(void *data, int npoints),
+        size_t struct_size,
+        // type, name, offset, type2, name2, offset2, ..., SYSTABLE_END_OF_FIELDS
+        ...);
+
 #endif
@@ -0,0 +1,113 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#if (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2)) &&          \
+    !defined(SQLITE_OMIT_VIRTUALTABLE)
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2) && !defined(SQLITE_CORE)
+#define SQLITE_CORE 1
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "bdb_api.h"
+#include "comdb2systblInt.h"
+#include "sql.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+
+static sqlite3_module systblFileReclaimModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+typedef struct file_reclaim {
+    char *filename;
+    int64_t size;
+    int64_t remaining;
+    cdb2_client_datetime_t queued;
+} file_reclaim_t;
+
+struct file_reclaim_rows {
+    int count;
+    int alloc;
+    file_reclaim_t *rows;
+};
+
+static void free_file_reclaim(void *p, int n)
+{
+    file_reclaim_t *rows = p;
+    for (int i = 0; i < n; i++)
+        free(rows[i].filename);
+    free(rows);
+}
+
+static int collect_file(void *arg, const char *path, int64_t size,
+                        int64_t remaining, int64_t queued_ms)
+{
+    struct file_reclaim_rows *a = arg;
+    file_reclaim_t *p;
+    dttz_t dt;
+
+    if (a->count == a->alloc) {
+        a->alloc = a->alloc * 2 + 16;
+        p = realloc(a->rows, a->alloc * sizeof(file_reclaim_t));
+        if (p == NULL)
+            return ENOMEM;
+        a->rows = p;
+    }
+    p = &a->rows[a->count++];
+    memset(p, 0, sizeof(*p));
+    p->filename = strdup(path);
+    p->size = size;
+    p->remaining = remaining;
+    dt = (dttz_t){.dttz_sec = queued_ms / 1000,
+                  .dttz_frac = queued_ms % 1000,
+                  .dttz_prec = DTTZ_PREC_MSEC};
+    dttz_to_client_datetime(&dt, "UTC", &p->queued);
+    return 0;
+}
+
+static int get_file_reclaim(void **data, int *records)
+{
+    struct file_reclaim_rows a = {0};
+    int rc;
+
+    rc = bdb_collect_file_reclaim(collect_file, &a);
+    if (rc) {
+        free_file_reclaim(a.rows, a.count);
+        return rc;
+    }
+    *data = a.rows;
+    *records = a.count;
+    return 0;
+}
+
+int systblFileReclaimInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_file_reclaim", &systblFileReclaimModule, get_file_reclaim,
+        free_file_reclaim, sizeof(file_reclaim_t),
+        CDB2_CSTRING, "filename", -1, offsetof(file_reclaim_t, filename),
+        CDB2_INTEGER, "size", -1, offsetof(file_reclaim_t, size),
+        CDB2_INTEGER, "remaining", -1, offsetof(file_reclaim_t, remaining),
+        CDB2_DATETIME, "queued", -1, offsetof(file_reclaim_t, queued),
+        SYSTABLE_END_OF_FIELDS);
+}
+
+#endif /* (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2))       \
+          && !defined(SQLITE_OMIT_VIRTUALTABLE) */
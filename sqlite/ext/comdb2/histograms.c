@@ -0,0 +1,127 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "perf.h"
+#include "hdrhist.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+
+typedef struct systable_histograms {
+    const char *metric;
+    int64_t low;
+    int64_t high;
+    int64_t count;
+    int64_t recent;
+} systable_histograms_t;
+
+typedef struct gethistograms {
+    int count;
+    int alloc;
+    int first; /* first row of the metric being collected */
+    int next;  /* row the next recent bucket is matched against */
+    const char *metric;
+    systable_histograms_t *records;
+} gethistograms_t;
+
+static int collect_bucket(void *arg, int64_t low, int64_t high, int64_t count)
+{
+    gethistograms_t *a = arg;
+    systable_histograms_t *p;
+    if (a->count >= a->alloc) {
+        a->alloc = a->alloc ? a->alloc * 2 : 256;
+        p = realloc(a->records, a->alloc * sizeof(systable_histograms_t));
+        if (p == NULL)
+            return ENOMEM;
+        a->records = p;
+    }
+    p = &a->records[a->count++];
+    p->metric = a->metric;
+    p->low = low;
+    p->high = high;
+    p->count = count;
+    p->recent = 0;
+    return 0;
+}
+
+/* every non-empty recent bucket is also non-empty in the cumulative
+ * histogram, and both are walked in ascending order */
+static int collect_recent(void *arg, int64_t low, int64_t high, int64_t count)
+{
+    gethistograms_t *a = arg;
+    while (a->next < a->count && a->records[a->next].low < low)
+        a->next++;
+    if (a->next < a->count && a->records[a->next].low == low)
+        a->records[a->next].recent = count;
+    return 0;
+}
+
+static int get_histograms(void **data, int *records)
+{
+    gethistograms_t a = {0};
+    struct time_metric *t;
+    struct hdrhist *h;
+    int rc = 0;
+
+    for (t = time_metric_first(); t && rc == 0; t = time_metric_next(t)) {
+        if (!time_metric_has_hist(t))
+            continue;
+        a.metric = time_metric_name(t);
+        a.first = a.count;
+        if ((h = time_metric_get_hist(t, 0)) == NULL)
+            continue;
+        rc = hdrhist_foreach(h, collect_bucket, &a);
+        hdrhist_free(h);
+        if (rc || (h = time_metric_get_hist(t, 1)) == NULL)
+            continue;
+        a.next = a.first;
+        hdrhist_foreach(h, collect_recent, &a);
+        hdrhist_free(h);
+    }
+    if (rc) {
+        free(a.records);
+        return rc;
+    }
+    *data = a.records;
+    *records = a.count;
+    return 0;
+}
+
+static void free_histograms(void *p, int n)
+{
+    free(p);
+}
+
+sqlite3_module systblLatencyHistogramsModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblLatencyHistogramsInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_latency_histograms", &systblLatencyHistogramsModule,
+        get_histograms, free_histograms, sizeof(systable_histograms_t),
+        CDB2_CSTRING, "metric", -1, offsetof(systable_histograms_t, metric),
+        CDB2_INTEGER, "low", -1, offsetof(systable_histograms_t, low),
+        CDB2_INTEGER, "high", -1, offsetof(systable_histograms_t, high),
+        CDB2_INTEGER, "count", -1, offsetof(systable_histograms_t, count),
+        CDB2_INTEGER, "recent", -1, offsetof(systable_histograms_t, recent),
+        SYSTABLE_END_OF_FIELDS);
+}
@@ -0,0 +1,102 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "bdb_int.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+
+typedef struct systable_lockpartitions {
+    const char *type;
+    int64_t partition;
+    int64_t acquired;
+    int64_t contended;
+    int64_t waits;
+} systable_lockpartitions_t;
+
+typedef struct getlockpartitions {
+    int count;
+    int alloc;
+    systable_lockpartitions_t *records;
+} getlockpartitions_t;
+
+static int collect(void *args, const char *type, int partition,
+                   u_int64_t acquired, u_int64_t contended, u_int64_t waits)
+{
+    getlockpartitions_t *a = (getlockpartitions_t *)args;
+    systable_lockpartitions_t *p;
+    if (a->count >= a->alloc) {
+        a->alloc = a->alloc ? a->alloc * 2 : 64;
+        p = realloc(a->records, a->alloc * sizeof(systable_lockpartitions_t));
+        if (p == NULL)
+            return ENOMEM;
+        a->records = p;
+    }
+    p = &a->records[a->count++];
+    p->type = type;
+    p->partition = partition;
+    p->acquired = acquired;
+    p->contended = contended;
+    p->waits = waits;
+    return 0;
+}
+
+static int get_lockpartitions(void **data, int *records)
+{
+    bdb_state_type *bdb_state = thedb->bdb_env;
+    getlockpartitions_t a = {0};
+    int rc;
+    rc = bdb_state->dbenv->collect_lock_partitions(bdb_state->dbenv, collect,
+                                                   &a);
+    if (rc) {
+        free(a.records);
+        return rc;
+    }
+    *data = a.records;
+    *records = a.count;
+    return 0;
+}
+
+static void free_lockpartitions(void *p, int n)
+{
+    free(p);
+}
+
+sqlite3_module systblLockPartitionsModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblLockPartitionsInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_lock_partitions", &systblLockPartitionsModule,
+        get_lockpartitions, free_lockpartitions,
+        sizeof(systable_lockpartitions_t),
+        CDB2_CSTRING, "type", -1, offsetof(systable_lockpartitions_t, type),
+        CDB2_INTEGER, "partition", -1,
+        offsetof(systable_lockpartitions_t, partition),
+        CDB2_INTEGER, "acquired", -1,
+        offsetof(systable_lockpartitions_t, acquired),
+        CDB2_INTEGER, "contended", -1,
+        offsetof(systable_lockpartitions_t, contended),
+        CDB2_INTEGER, "waits", -1, offsetof(systable_lockpartitions_t, waits),
+        SYSTABLE_END_OF_FIELDS);
+}
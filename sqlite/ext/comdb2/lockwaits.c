@@ -0,0 +1,109 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "bdb_api.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+
+typedef struct systable_lockwaits {
+    const char *type;
+    char *object;
+    const char *mode;
+    int64_t waits;
+    int64_t total_us;
+    int64_t max_us;
+    char *histogram;
+} systable_lockwaits_t;
+
+typedef struct getlockwaits {
+    int count;
+    int alloc;
+    systable_lockwaits_t *records;
+} getlockwaits_t;
+
+static int collect(void *args, const char *type, const char *object,
+                   const char *mode, int64_t waits, int64_t total_us,
+                   int64_t max_us, const char *histogram)
+{
+    getlockwaits_t *a = (getlockwaits_t *)args;
+    systable_lockwaits_t *p;
+    if (a->count >= a->alloc) {
+        a->alloc = a->alloc ? a->alloc * 2 : 64;
+        p = realloc(a->records, a->alloc * sizeof(systable_lockwaits_t));
+        if (p == NULL)
+            return ENOMEM;
+        a->records = p;
+    }
+    p = &a->records[a->count++];
+    p->type = type;
+    p->object = strdup(object);
+    p->mode = mode;
+    p->waits = waits;
+    p->total_us = total_us;
+    p->max_us = max_us;
+    p->histogram = strdup(histogram);
+    return 0;
+}
+
+static void free_lockwaits(void *p, int n)
+{
+    systable_lockwaits_t *l = p;
+    for (int i = 0; i < n; i++) {
+        free(l[i].object);
+        free(l[i].histogram);
+    }
+    free(p);
+}
+
+static int get_lockwaits(void **data, int *records)
+{
+    getlockwaits_t a = {0};
+    int rc;
+    rc = bdb_collect_lock_waits(thedb->bdb_env, collect, &a);
+    if (rc) {
+        free_lockwaits(a.records, a.count);
+        return rc;
+    }
+    *data = a.records;
+    *records = a.count;
+    return 0;
+}
+
+sqlite3_module systblLockWaitsModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblLockWaitsInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_lock_waits", &systblLockWaitsModule, get_lockwaits,
+        free_lockwaits, sizeof(systable_lockwaits_t),
+        CDB2_CSTRING, "type", -1, offsetof(systable_lockwaits_t, type),
+        CDB2_CSTRING, "object", -1, offsetof(systable_lockwaits_t, object),
+        CDB2_CSTRING, "mode", -1, offsetof(systable_lockwaits_t, mode),
+        CDB2_INTEGER, "waits", -1, offsetof(systable_lockwaits_t, waits),
+        CDB2_INTEGER, "total_us", -1, offsetof(systable_lockwaits_t, total_us),
+        CDB2_INTEGER, "max_us", -1, offsetof(systable_lockwaits_t, max_us),
+        CDB2_CSTRING, "histogram", -1,
+        offsetof(systable_lockwaits_t, histogram),
+        SYSTABLE_END_OF_FIELDS);
+}
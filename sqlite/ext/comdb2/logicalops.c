@@ -33,6 +33,7 @@
 #include <bdb/bdb_int.h>
 #include "llog_ext.h"
 #include "comdb2systbl.h"
+#include "tranlog.h"
 
 /* Allocate maximum for unpacking */
 #define PACKED_MEMORY_SIZE (MAXBLOBLENGTH + 7)
@@ -40,14 +41,16 @@
 /* Column numbers */
 #define LOGICALOPS_COLUMN_START        0
 #define LOGICALOPS_COLUMN_STOP         1
-#define LOGICALOPS_COLUMN_COMMITLSN    2
-#define LOGICALOPS_COLUMN_OPNUM        3
-#define LOGICALOPS_COLUMN_OPERATION    4
-#define LOGICALOPS_COLUMN_TABLE        5
-#define LOGICALOPS_COLUMN_OLDGENID     6
-#define LOGICALOPS_COLUMN_OLDRECORD    7
-#define LOGICALOPS_COLUMN_GENID        8
-#define LOGICALOPS_COLUMN_RECORD       9
+#define LOGICALOPS_COLUMN_FLAGS        2
+#define LOGICALOPS_COLUMN_TABLES       3
+#define LOGICALOPS_COLUMN_COMMITLSN    4
+#define LOGICALOPS_COLUMN_OPNUM        5
+#define LOGICALOPS_COLUMN_OPERATION    6
+#define LOGICALOPS_COLUMN_TABLE        7
+#define LOGICALOPS_COLUMN_OLDGENID     8
+#define LOGICALOPS_COLUMN_OLDRECORD    9
+#define LOGICALOPS_COLUMN_GENID        10
+#define LOGICALOPS_COLUMN_RECORD       11
 
 /* Dynamically reallocating string type */
 typedef struct dynstr {
@@ -67,6 +70,8 @@ struct logicalops_cursor {
   char *curLsnStr;
   char *tz;
   char *table;
+  char *tables;              /* comma separated list to return, or NULL */
+  int flags;                 /* TRANLOG_FLAGS_BLOCK to wait for more */
   void *packedprev;
   void *unpackedprev;
   void *packed;
@@ -95,7 +100,7 @@ static int logicalopsConnect(
   sqlite3_vtab *pNew;
   int rc;
   rc = sqlite3_declare_vtab(db,
-     "CREATE TABLE x(minlsn hidden,maxlsn hidden,commitlsn,opnum,operation,tablename,oldgenid,oldrecord,genid,record)");
+     "CREATE TABLE x(minlsn hidden,maxlsn hidden,flags hidden,tables hidden,commitlsn,opnum,operation,tablename,oldgenid,oldrecord,genid,record)");
   if( rc==SQLITE_OK ){
     pNew = *ppVtab = sqlite3_malloc( sizeof(*pNew) );
     if( pNew==0 ) return SQLITE_NOMEM;
@@ -145,6 +150,8 @@ static int logicalopsClose(sqlite3_vtab_cursor *cur){
       strbuf_free(pCur->oldjsonrec);
   if (pCur->table)
       free(pCur->table);
+  if (pCur->tables)
+      sqlite3_free(pCur->tables);
   sqlite3_free(pCur);
   return SQLITE_OK;
 }
@@ -881,6 +888,26 @@ done:
     return rc;
 }
 
+/* Is table in the cursor's comma separated list of tables? */
+static int want_table(logicalops_cursor *pCur, const char *table)
+{
+    const char *p = pCur->tables, *end;
+    size_t len = strlen(table);
+
+    if (p == NULL)
+        return 1;
+    while (*p) {
+        while (*p == ',' || *p == ' ')
+            p++;
+        for (end = p; *end && *end != ',' && *end != ' '; end++)
+            ;
+        if (end - p == len && strncasecmp(p, table, len) == 0)
+            return 1;
+        p = end;
+    }
+    return 0;
+}
+
 static int unpack_logical_record(logicalops_cursor *pCur)
 {
     bdb_osql_log_rec_t *rec;
@@ -900,6 +927,11 @@ static int unpack_logical_record(logicalops_cursor *pCur)
     while (produced_row == 0 &&
            (rec = listc_rtl(&pCur->llog_cur.log->impl->recs)) != NULL) {
 
+        if (!want_table(pCur, rec->table)) {
+            free(rec);
+            continue;
+        }
+
         reset_json_cursors(pCur);
         logdta.flags = DB_DBT_REALLOC;
         if ((rc = logc->get(logc, &rec->lsn, &logdta, DB_SET)) != 0) {
@@ -972,6 +1004,10 @@ static int unpack_logical_record(logicalops_cursor *pCur)
     return (produced_row && rc != 0) ? -1 : !produced_row;
 }
 
+extern pthread_mutex_t gbl_logput_lk;
+extern pthread_cond_t gbl_logput_cond;
+extern int comdb2_sql_tick();
+
 /*
 ** Advance a logicalops cursor to the next log entry
 */
@@ -987,6 +1023,40 @@ again:
         (bdb_llog_cursor_next(&pCur->llog_cur) != 0))
         return SQLITE_INTERNAL;
 
+    /* Follow the log as it grows, until the client goes away */
+    while (pCur->llog_cur.hitLast && (pCur->flags & TRANLOG_FLAGS_BLOCK) &&
+           (pCur->llog_cur.maxLsn.file == 0 ||
+            log_compare(&pCur->llog_cur.curLsn, &pCur->llog_cur.maxLsn) < 0)) {
+        struct sql_thread *thd = NULL;
+        struct timespec ts;
+        int sleepms = 100;
+
+        if ((rc = comdb2_sql_tick()) != 0)
+            return rc;
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += (200 * 1000000);
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        Pthread_mutex_lock(&gbl_logput_lk);
+        pthread_cond_timedwait(&gbl_logput_cond, &gbl_logput_lk, &ts);
+        Pthread_mutex_unlock(&gbl_logput_lk);
+
+        while (bdb_the_lock_desired()) {
+            if (thd == NULL)
+                thd = pthread_getspecific(query_info_key);
+            recover_deadlock(thedb->bdb_env, thd, NULL, sleepms);
+            sleepms *= 2;
+            if (sleepms > 10000)
+                sleepms = 10000;
+        }
+
+        if (bdb_llog_cursor_next(&pCur->llog_cur) != 0)
+            return SQLITE_INTERNAL;
+    }
+
     if (pCur->llog_cur.log && !pCur->llog_cur.hitLast) {
         rc = unpack_logical_record(pCur);
         switch (rc) {
@@ -1190,6 +1260,19 @@ static int logicalopsFilter(
           return SQLITE_CONV_ERROR;
       }
   }
+  pCur->flags = 0;
+  if( idxNum & 4 ){
+      pCur->flags = sqlite3_value_int64(argv[i++]);
+  }
+  if (pCur->tables) {
+      sqlite3_free(pCur->tables);
+      pCur->tables = NULL;
+  }
+  if( idxNum & 8 ){
+      const unsigned char *tables = sqlite3_value_text(argv[i++]);
+      if (tables)
+          pCur->tables = sqlite3_mprintf("%s", tables);
+  }
   pCur->iRowid = 1;
   return SQLITE_OK;
 }
@@ -1202,6 +1285,8 @@ static int logicalopsBestIndex(
   int idxNum = 0;
   int startIdx = -1;
   int stopIdx = -1;
+  int flagsIdx = -1;
+  int tablesIdx = -1;
   int nArg = 0;
 
   const struct sqlite3_index_constraint *pConstraint;
@@ -1218,6 +1303,14 @@ static int logicalopsBestIndex(
         stopIdx = i;
         idxNum |= 2;
         break;
+      case LOGICALOPS_COLUMN_FLAGS:
+        flagsIdx = i;
+        idxNum |= 4;
+        break;
+      case LOGICALOPS_COLUMN_TABLES:
+        tablesIdx = i;
+        idxNum |= 8;
+        break;
     }
   }
   if( startIdx>=0 ){
@@ -1228,6 +1321,14 @@ static int logicalopsBestIndex(
     pIdxInfo->aConstraintUsage[stopIdx].argvIndex = ++nArg;
     pIdxInfo->aConstraintUsage[stopIdx].omit = 1;
   }
+  if( flagsIdx>=0 ){
+    pIdxInfo->aConstraintUsage[flagsIdx].argvIndex = ++nArg;
+    pIdxInfo->aConstraintUsage[flagsIdx].omit = 1;
+  }
+  if( tablesIdx>=0 ){
+    pIdxInfo->aConstraintUsage[tablesIdx].argvIndex = ++nArg;
+    pIdxInfo->aConstraintUsage[tablesIdx].omit = 1;
+  }
   if( (idxNum & 3)==3 ){
     /* Both start= and stop= boundaries are available.  This is the 
     ** the preferred case */
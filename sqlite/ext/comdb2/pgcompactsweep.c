@@ -0,0 +1,121 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "bdb_api.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+
+typedef struct systable_pgcompact_sweep {
+    char *table;
+    char *file;
+    int64_t passes;
+    int64_t pgno;
+    int64_t last_pgno;
+    int64_t leaf_pages;
+    double leaf_fill;
+    int64_t reclaimable;
+    int64_t queued;
+} systable_pgcompact_sweep_t;
+
+typedef struct getpgcompactsweep {
+    int count;
+    int alloc;
+    systable_pgcompact_sweep_t *records;
+} getpgcompactsweep_t;
+
+static int collect(void *args, const struct bdb_pgsweep_stat *st)
+{
+    getpgcompactsweep_t *a = (getpgcompactsweep_t *)args;
+    systable_pgcompact_sweep_t *p;
+    if (a->count >= a->alloc) {
+        a->alloc = a->alloc ? a->alloc * 2 : 64;
+        p = realloc(a->records, a->alloc * sizeof(systable_pgcompact_sweep_t));
+        if (p == NULL)
+            return ENOMEM;
+        a->records = p;
+    }
+    p = &a->records[a->count++];
+    /* the names belong to the sweeper; copy them out */
+    p->table = strdup(st->table);
+    p->file = strdup(st->file);
+    p->passes = st->passes;
+    p->pgno = st->pgno;
+    p->last_pgno = st->last_pgno;
+    p->leaf_pages = st->leaf_pages;
+    p->leaf_fill = st->leaf_fill;
+    p->reclaimable = st->reclaimable;
+    p->queued = st->queued;
+    return 0;
+}
+
+static void free_pgcompact_sweep(void *p, int n)
+{
+    systable_pgcompact_sweep_t *r = p;
+    for (int i = 0; i < n; i++) {
+        free(r[i].table);
+        free(r[i].file);
+    }
+    free(p);
+}
+
+static int get_pgcompact_sweep(void **data, int *records)
+{
+    getpgcompactsweep_t a = {0};
+    int rc;
+    rc = bdb_pgcompact_sweep_collect(collect, &a);
+    if (rc) {
+        free_pgcompact_sweep(a.records, a.count);
+        return rc;
+    }
+    *data = a.records;
+    *records = a.count;
+    return 0;
+}
+
+sqlite3_module systblPgCompactSweepModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblPgCompactSweepInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_page_compact_sweep", &systblPgCompactSweepModule,
+        get_pgcompact_sweep, free_pgcompact_sweep,
+        sizeof(systable_pgcompact_sweep_t),
+        CDB2_CSTRING, "tablename", -1,
+        offsetof(systable_pgcompact_sweep_t, table),
+        CDB2_CSTRING, "file", -1, offsetof(systable_pgcompact_sweep_t, file),
+        CDB2_INTEGER, "passes", -1,
+        offsetof(systable_pgcompact_sweep_t, passes),
+        CDB2_INTEGER, "pgno", -1, offsetof(systable_pgcompact_sweep_t, pgno),
+        CDB2_INTEGER, "last_pgno", -1,
+        offsetof(systable_pgcompact_sweep_t, last_pgno),
+        CDB2_INTEGER, "leaf_pages", -1,
+        offsetof(systable_pgcompact_sweep_t, leaf_pages),
+        CDB2_REAL, "leaf_fill", -1,
+        offsetof(systable_pgcompact_sweep_t, leaf_fill),
+        CDB2_INTEGER, "reclaimable_pages", -1,
+        offsetof(systable_pgcompact_sweep_t, reclaimable),
+        CDB2_INTEGER, "queued", -1,
+        offsetof(systable_pgcompact_sweep_t, queued),
+        SYSTABLE_END_OF_FIELDS);
+}
@@ -0,0 +1,105 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "profiler.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+
+typedef struct systable_profile {
+    const char *thread_type;
+    char *fingerprint;
+    const char *state;
+    int64_t samples;
+    char *stack;
+} systable_profile_t;
+
+typedef struct getprofile {
+    int count;
+    int alloc;
+    systable_profile_t *records;
+} getprofile_t;
+
+static int collect(void *arg, const char *type, const char *fingerprint,
+                   int oncpu, int64_t samples, const char *stack)
+{
+    getprofile_t *a = arg;
+    systable_profile_t *p;
+    if (a->count >= a->alloc) {
+        a->alloc = a->alloc ? a->alloc * 2 : 256;
+        p = realloc(a->records, a->alloc * sizeof(systable_profile_t));
+        if (p == NULL)
+            return ENOMEM;
+        a->records = p;
+    }
+    p = &a->records[a->count];
+    p->thread_type = type;
+    p->fingerprint = fingerprint ? strdup(fingerprint) : NULL;
+    p->state = oncpu ? "on-cpu" : "off-cpu";
+    p->samples = samples;
+    if ((p->stack = strdup(stack)) == NULL) {
+        free(p->fingerprint);
+        return ENOMEM;
+    }
+    a->count++;
+    return 0;
+}
+
+static void free_profile(void *p, int n)
+{
+    systable_profile_t *r = p;
+    for (int i = 0; i < n; i++) {
+        free(r[i].fingerprint);
+        free(r[i].stack);
+    }
+    free(p);
+}
+
+static int get_profile(void **data, int *records)
+{
+    getprofile_t a = {0};
+    int rc = profiler_foreach(collect, &a);
+    if (rc) {
+        free_profile(a.records, a.count);
+        return rc;
+    }
+    *data = a.records;
+    *records = a.count;
+    return 0;
+}
+
+sqlite3_module systblProfileModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblProfileInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_profile", &systblProfileModule, get_profile, free_profile,
+        sizeof(systable_profile_t),
+        CDB2_CSTRING, "thread_type", -1,
+        offsetof(systable_profile_t, thread_type),
+        CDB2_CSTRING, "fingerprint", -1,
+        offsetof(systable_profile_t, fingerprint),
+        CDB2_CSTRING, "state", -1, offsetof(systable_profile_t, state),
+        CDB2_INTEGER, "samples", -1, offsetof(systable_profile_t, samples),
+        CDB2_CSTRING, "stack", -1, offsetof(systable_profile_t, stack),
+        SYSTABLE_END_OF_FIELDS);
+}
@@ -65,6 +65,11 @@ struct systbl_queues_cursor {
   int           is_last;
   unsigned long long     tot_enqueued;
   unsigned long long     tot_dequeued;
+  long long     file_size;
+  double        fragmentation;
+  struct queue_consumer_stats cstats;
+  long long     dequeue_rate;
+  char          ack_hist[QUEUE_ACK_BUCKETS * 24];
 };
 
 /* Column numbers */
@@ -74,6 +79,17 @@ struct systbl_queues_cursor {
 #define STQUEUE_DEPTH        3
 #define STQUEUE_TOT_ENQUEUED 4
 #define STQUEUE_TOT_DEQUEUED 5
+#define STQUEUE_FILE_SIZE    6
+#define STQUEUE_FRAGMENTATION 7
+#define STQUEUE_DEQUEUED     8
+#define STQUEUE_REDELIVERED  9
+#define STQUEUE_ACKED        10
+#define STQUEUE_DEQUEUE_RATE 11
+#define STQUEUE_ACK_AVG_MS   12
+#define STQUEUE_ACK_P50_MS   13
+#define STQUEUE_ACK_P99_MS   14
+#define STQUEUE_ACK_MAX_MS   15
+#define STQUEUE_ACK_HIST     16
 
 static int systblQueuesConnect(
   sqlite3 *db,
@@ -88,7 +104,9 @@ static int systblQueuesConnect(
 
   rc = sqlite3_declare_vtab(db,
      "CREATE TABLE comdb2_queues(queuename, spname, head_age, depth, "
-     "total_enqueued, total_dequeued)");
+     "total_enqueued, total_dequeued, file_size, fragmentation, dequeued, "
+     "redelivered, acked, dequeue_rate, ack_avg_ms, ack_p50_ms, ack_p99_ms, "
+     "ack_max_ms, ack_latency_hist)");
   if( rc==SQLITE_OK ){
     pNew = *ppVtab = sqlite3_malloc( sizeof(*pNew) );
     if( pNew==0 ) return SQLITE_NOMEM;
@@ -105,6 +123,40 @@ static int systblQueuesDisconnect(sqlite3_vtab *pVtab){
   return SQLITE_OK;
 }
 
+/* Upper bound of the bucket holding the pct'th percentile ack */
+static long long ack_percentile(const struct queue_consumer_stats *s,
+                                double pct) {
+  long long want, seen = 0;
+  if (s->acked == 0)
+    return 0;
+  want = (long long)(s->acked * pct / 100);
+  if (want < 1)
+    want = 1;
+  for (int b = 0; b < QUEUE_ACK_BUCKETS - 1; b++) {
+    seen += s->ack_hist[b];
+    if (seen >= want)
+      return 1LL << b;
+  }
+  return s->ack_max_ms;
+}
+
+/* "<1:n <2:n <4:n ... >=N:n", skipping empty buckets */
+static void format_ack_hist(const struct queue_consumer_stats *s, char *buf,
+                            size_t len) {
+  int n = 0;
+  buf[0] = 0;
+  for (int b = 0; b < QUEUE_ACK_BUCKETS && n < len; b++) {
+    if (s->ack_hist[b] == 0)
+      continue;
+    if (b < QUEUE_ACK_BUCKETS - 1)
+      n += snprintf(buf + n, len - n, "%s<%lld:%lld", n ? " " : "", 1LL << b,
+                    (long long)s->ack_hist[b]);
+    else
+      n += snprintf(buf + n, len - n, "%s>=%lld:%lld", n ? " " : "",
+                    1LL << (b - 1), (long long)s->ack_hist[b]);
+  }
+}
+
 static int get_stats(struct systbl_queues_cursor *pCur) {
   struct consumer_stat stats[MAXCONSUMERS] = {{0}};
   unsigned long long depth = 0;
@@ -138,6 +190,14 @@ static int get_stats(struct systbl_queues_cursor *pCur) {
       pCur->age  = 0;
   pCur->tot_enqueued = bdb_get_qdb_adds(qdb->handle);
   pCur->tot_dequeued = bdb_get_qdb_cons(qdb->handle);
+  int64_t file_size;
+  if (bdb_queuedb_file_stats(qdb->handle, &file_size, &pCur->fragmentation)) {
+      file_size = 0;
+      pCur->fragmentation = -1;
+  }
+  pCur->file_size = file_size;
+  pCur->dequeue_rate = dbqueuedb_get_consumer_stats(qdb, &pCur->cstats);
+  format_ack_hist(&pCur->cstats, pCur->ack_hist, sizeof(pCur->ack_hist));
   return 0;
 }
 
@@ -222,6 +282,57 @@ static int systblQueuesColumn(
       sqlite3_result_int64(ctx, (sqlite3_int64)pCur->age);
       break;
     }
+    case STQUEUE_FILE_SIZE: {
+      sqlite3_result_int64(ctx, (sqlite3_int64)pCur->file_size);
+      break;
+    }
+    case STQUEUE_FRAGMENTATION: {
+      if (pCur->fragmentation < 0)
+        sqlite3_result_null(ctx);
+      else
+        sqlite3_result_double(ctx, pCur->fragmentation);
+      break;
+    }
+    case STQUEUE_DEQUEUED: {
+      sqlite3_result_int64(ctx, pCur->cstats.dequeued);
+      break;
+    }
+    case STQUEUE_REDELIVERED: {
+      sqlite3_result_int64(ctx, pCur->cstats.redelivered);
+      break;
+    }
+    case STQUEUE_ACKED: {
+      sqlite3_result_int64(ctx, pCur->cstats.acked);
+      break;
+    }
+    case STQUEUE_DEQUEUE_RATE: {
+      sqlite3_result_int64(ctx, pCur->dequeue_rate);
+      break;
+    }
+    case STQUEUE_ACK_AVG_MS: {
+      if (pCur->cstats.acked == 0)
+        sqlite3_result_null(ctx);
+      else
+        sqlite3_result_double(ctx, (double)pCur->cstats.ack_total_ms /
+                                   pCur->cstats.acked);
+      break;
+    }
+    case STQUEUE_ACK_P50_MS: {
+      sqlite3_result_int64(ctx, ack_percentile(&pCur->cstats, 50));
+      break;
+    }
+    case STQUEUE_ACK_P99_MS: {
+      sqlite3_result_int64(ctx, ack_percentile(&pCur->cstats, 99));
+      break;
+    }
+    case STQUEUE_ACK_MAX_MS: {
+      sqlite3_result_int64(ctx, pCur->cstats.ack_max_ms);
+      break;
+    }
+    case STQUEUE_ACK_HIST: {
+      sqlite3_result_text(ctx, pCur->ack_hist, -1, NULL);
+      break;
+    }
   }
   return SQLITE_OK;
 }
@@ -0,0 +1,123 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "bdb_api.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+#include "types.h"
+
+typedef struct systable_repl_history {
+    char *host;
+    cdb2_client_datetime_t time;
+    int64_t lag_bytes;
+    int64_t apply_bytes_per_sec;
+    int64_t seconds_behind;
+    double ack_avg_ms;
+    double ack_max_ms;
+    char *degrading;
+} systable_repl_history_t;
+
+typedef struct getrows {
+    int count;
+    int alloc;
+    systable_repl_history_t *records;
+} getrows_t;
+
+static int collect_sample(void *arg, const char *host, int64_t time_ms,
+                          int64_t lag_bytes, int64_t apply_bytes_per_sec,
+                          int64_t seconds_behind, double ack_avg_ms,
+                          double ack_max_ms, int degrading)
+{
+    getrows_t *a = arg;
+    systable_repl_history_t *p;
+    dttz_t dt;
+
+    if (a->count >= a->alloc) {
+        a->alloc = a->alloc ? a->alloc * 2 : 256;
+        p = realloc(a->records, a->alloc * sizeof(*p));
+        if (p == NULL)
+            return ENOMEM;
+        a->records = p;
+    }
+    p = &a->records[a->count];
+    memset(p, 0, sizeof(*p));
+    if ((p->host = strdup(host)) == NULL)
+        return ENOMEM;
+    a->count++;
+    dt = (dttz_t){.dttz_sec = time_ms / 1000,
+                  .dttz_frac = time_ms % 1000,
+                  .dttz_prec = DTTZ_PREC_MSEC};
+    dttz_to_client_datetime(&dt, "UTC", &p->time);
+    p->lag_bytes = lag_bytes;
+    p->apply_bytes_per_sec = apply_bytes_per_sec;
+    p->seconds_behind = seconds_behind;
+    p->ack_avg_ms = ack_avg_ms;
+    p->ack_max_ms = ack_max_ms;
+    p->degrading = degrading ? "Y" : "N";
+    return 0;
+}
+
+static void free_repl_history(void *p, int n)
+{
+    systable_repl_history_t *rows = p;
+    for (int i = 0; i < n; i++)
+        free(rows[i].host);
+    free(rows);
+}
+
+static int get_repl_history(void **data, int *records)
+{
+    getrows_t a = {0};
+    int rc = bdb_collect_repl_history(NULL, collect_sample, &a);
+    if (rc) {
+        free_repl_history(a.records, a.count);
+        return rc;
+    }
+    *data = a.records;
+    *records = a.count;
+    return 0;
+}
+
+sqlite3_module systblReplHistoryModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblReplHistoryInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_repl_history", &systblReplHistoryModule, get_repl_history,
+        free_repl_history, sizeof(systable_repl_history_t),
+        CDB2_CSTRING, "host", -1, offsetof(systable_repl_history_t, host),
+        CDB2_DATETIME, "time", -1, offsetof(systable_repl_history_t, time),
+        CDB2_INTEGER, "lag_bytes", -1,
+        offsetof(systable_repl_history_t, lag_bytes),
+        CDB2_INTEGER, "apply_bytes_per_sec", -1,
+        offsetof(systable_repl_history_t, apply_bytes_per_sec),
+        CDB2_INTEGER, "seconds_behind", -1,
+        offsetof(systable_repl_history_t, seconds_behind),
+        CDB2_REAL, "ack_avg_ms", -1,
+        offsetof(systable_repl_history_t, ack_avg_ms),
+        CDB2_REAL, "ack_max_ms", -1,
+        offsetof(systable_repl_history_t, ack_max_ms),
+        CDB2_CSTRING, "degrading", -1,
+        offsetof(systable_repl_history_t, degrading),
+        SYSTABLE_END_OF_FIELDS);
+}
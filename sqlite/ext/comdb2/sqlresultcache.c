@@ -0,0 +1,55 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stddef.h>
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+#include "sql_result_cache.h"
+
+static int get_result_cache(void **data, int *records)
+{
+    struct result_cache_info *info;
+    int rc;
+
+    if ((rc = result_cache_collect(&info, records)) != 0)
+        return rc;
+    *data = info;
+    return 0;
+}
+
+static void free_result_cache(void *p, int n)
+{
+    result_cache_collect_free(p, n);
+}
+
+sqlite3_module systblSqlResultCacheModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblSqlResultCacheInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_sql_result_cache", &systblSqlResultCacheModule,
+        get_result_cache, free_result_cache, sizeof(struct result_cache_info),
+        CDB2_CSTRING, "sql", -1, offsetof(struct result_cache_info, sql),
+        CDB2_CSTRING, "tables", -1, offsetof(struct result_cache_info, tables),
+        CDB2_INTEGER, "bytes", -1, offsetof(struct result_cache_info, bytes),
+        CDB2_INTEGER, "hits", -1, offsetof(struct result_cache_info, hits),
+        CDB2_INTEGER, "age_ms", -1, offsetof(struct result_cache_info, age_ms),
+        CDB2_CSTRING, "stale", -1, offsetof(struct result_cache_info, stale),
+        SYSTABLE_END_OF_FIELDS);
+}
@@ -0,0 +1,136 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#if (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2)) &&          \
+    !defined(SQLITE_OMIT_VIRTUALTABLE)
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2) && !defined(SQLITE_CORE)
+#define SQLITE_CORE 1
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "bdb_api.h"
+#include "comdb2systblInt.h"
+#include "sql.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+
+static sqlite3_module systblTableIOModule = {
+    .access_flag = CDB2_ALLOW_USER,
+    .systable_lock = "comdb2_tables"
+};
+
+typedef struct table_io {
+    char *tablename;
+    char *file_type;
+    int64_t ixnum;
+    char *ixname;
+    int64_t faults;
+    int64_t reads;
+    int64_t read_bytes;
+    int64_t writes;
+    int64_t write_bytes;
+} table_io_t;
+
+struct table_io_rows {
+    struct dbtable *db;
+    int count;
+    int alloc;
+    table_io_t *rows;
+};
+
+static void free_table_io(void *p, int n)
+{
+    table_io_t *rows = p;
+    for (int i = 0; i < n; i++) {
+        free(rows[i].tablename);
+        free(rows[i].file_type);
+        free(rows[i].ixname);
+    }
+    free(rows);
+}
+
+static int collect_file(void *arg, const char *type, int ix, int64_t faults,
+                        int64_t reads, int64_t read_bytes, int64_t writes,
+                        int64_t write_bytes)
+{
+    struct table_io_rows *a = arg;
+    table_io_t *p;
+
+    if (a->count == a->alloc) {
+        a->alloc = a->alloc * 2 + 16;
+        p = realloc(a->rows, a->alloc * sizeof(table_io_t));
+        if (p == NULL)
+            return ENOMEM;
+        a->rows = p;
+    }
+    p = &a->rows[a->count++];
+    memset(p, 0, sizeof(*p));
+    p->tablename = strdup(a->db->tablename);
+    p->file_type = strdup(type);
+    p->ixnum = ix;
+    if (strcmp(type, "index") == 0 && ix < a->db->nix)
+        p->ixname = strdup(a->db->schema->ix[ix]->csctag);
+    p->faults = faults;
+    p->reads = reads;
+    p->read_bytes = read_bytes;
+    p->writes = writes;
+    p->write_bytes = write_bytes;
+    return 0;
+}
+
+static int get_table_io(void **data, int *records)
+{
+    struct table_io_rows a = {0};
+    int rc = 0;
+
+    for (int dbn = 0; rc == 0 && dbn < thedb->num_dbs; dbn++) {
+        a.db = thedb->dbs[dbn];
+        if (a.db->handle == NULL)
+            continue;
+        rc = bdb_collect_table_io(a.db->handle, collect_file, &a);
+    }
+    if (rc) {
+        free_table_io(a.rows, a.count);
+        return rc;
+    }
+    *data = a.rows;
+    *records = a.count;
+    return 0;
+}
+
+int systblTableIOInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_table_io", &systblTableIOModule, get_table_io,
+        free_table_io, sizeof(table_io_t),
+        CDB2_CSTRING, "tablename", -1, offsetof(table_io_t, tablename),
+        CDB2_CSTRING, "file_type", -1, offsetof(table_io_t, file_type),
+        CDB2_INTEGER, "ix_num", -1, offsetof(table_io_t, ixnum),
+        CDB2_CSTRING, "index_name", -1, offsetof(table_io_t, ixname),
+        CDB2_INTEGER, "faults", -1, offsetof(table_io_t, faults),
+        CDB2_INTEGER, "reads", -1, offsetof(table_io_t, reads),
+        CDB2_INTEGER, "read_bytes", -1, offsetof(table_io_t, read_bytes),
+        CDB2_INTEGER, "writes", -1, offsetof(table_io_t, writes),
+        CDB2_INTEGER, "write_bytes", -1, offsetof(table_io_t, write_bytes),
+        SYSTABLE_END_OF_FIELDS);
+}
+
+#endif /* (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2))       \
+          && !defined(SQLITE_OMIT_VIRTUALTABLE) */
@@ -294,8 +294,30 @@ int comdb2SystblInit(
     rc = systblRepNetQueueStatInit(db);
   if (rc == SQLITE_OK)
     rc = systblActivelocksInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblLockPartitionsInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblFileReclaimInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblReplHistoryInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblTableIOInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblBufferPoolInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblProfileInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblLatencyHistogramsInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblAdmissionInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblPgCompactSweepInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblLockWaitsInit(db);
   if (rc == SQLITE_OK)
     rc = systblSqlpoolQueueInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblSqlResultCacheInit(db);
   if (rc == SQLITE_OK)
     rc = systblNetUserfuncsInit(db);
   if (rc == SQLITE_OK)
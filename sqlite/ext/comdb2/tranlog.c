@@ -138,7 +138,9 @@ static int tranlogNext(sqlite3_vtab_cursor *cur){
                   __func__, __LINE__, rc);
           return SQLITE_INTERNAL;
       }
-      pCur->logc->setflags(pCur->logc, DB_LOG_SILENT_ERR);
+      /* Payloads are returned as stored so that physical replicants
+       * applying them end up with identical logs. */
+      pCur->logc->setflags(pCur->logc, DB_LOG_SILENT_ERR | DB_LOG_RAW);
       pCur->openCursor = 1;
       pCur->data.flags = DB_DBT_REALLOC;
 
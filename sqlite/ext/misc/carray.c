@@ -51,6 +51,13 @@
 ** the integer value of "pointer" as a pointer to the array and "count"
 ** as the number of elements in the array.  The virtual table steps through
 ** the array, element by element.
+**
+** COMDB2: the rowid of each row is its 1-based position in the array, and
+** a rowid= constraint is answered directly, so that arrays bound for the
+** columns of a bulk insert can be zipped together in a single pass:
+**
+**      SELECT a.value, b.value FROM carray($a) a, carray($b) b
+**       WHERE b.rowid=a.rowid
 */
 #include "sqlite3ext.h"
 SQLITE_EXTENSION_INIT1
@@ -94,6 +101,7 @@ struct carray_cursor {
   sqlite3_int64 iRowid;      /* The rowid */
   void *pPtr;                /* Pointer to the array of values */
   sqlite3_int64 iCnt;        /* Number of integers in the array */
+  sqlite3_int64 iEnd;        /* Rowid of the last row to return */
   unsigned char eType;       /* One of the CARRAY_type values */
 };
 
@@ -237,7 +245,7 @@ static int carrayRowid(sqlite3_vtab_cursor *cur, sqlite_int64 *pRowid){
 */
 static int carrayEof(sqlite3_vtab_cursor *cur){
   carray_cursor *pCur = (carray_cursor*)cur;
-  return pCur->iRowid>pCur->iCnt;
+  return pCur->iRowid>pCur->iEnd;
 }
 
 /*
@@ -252,7 +260,7 @@ static int carrayFilter(
   carray_cursor *pCur = (carray_cursor *)pVtabCursor;
   pCur->pPtr = 0;
   pCur->iCnt = 0;
-  switch( idxNum ){
+  switch( idxNum & 0x03 ){
     case 1: {
       carray_bind *pBind = sqlite3_value_pointer(argv[0], "carray-bind");
       if( pBind==0 ) break;
@@ -285,6 +293,16 @@ static int carrayFilter(
     }
   }
   pCur->iRowid = 1;
+  pCur->iEnd = pCur->iCnt;
+  if( idxNum & 0x04 ){
+    /* rowid= constraint, passed as the last argument */
+    sqlite3_int64 iRowid = sqlite3_value_int64(argv[argc-1]);
+    if( iRowid>=1 && iRowid<=pCur->iCnt ){
+      pCur->iRowid = pCur->iEnd = iRowid;
+    }else{
+      pCur->iEnd = 0;
+    }
+  }
   return SQLITE_OK;
 }
 
@@ -306,7 +324,8 @@ static int carrayFilter(
 **
 **    3    if the ctype= constraint also exists.
 **
-** idxNum is 0 otherwise and carray becomes an empty table.
+** idxNum is 0 otherwise and carray becomes an empty table.  If there is a
+** rowid= constraint as well, 4 is added to idxNum.
 */
 static int carrayBestIndex(
   sqlite3_vtab *tab,
@@ -316,6 +335,7 @@ static int carrayBestIndex(
   int ptrIdx = -1;       /* Index of the pointer= constraint, or -1 if none */
   int cntIdx = -1;       /* Index of the count= constraint, or -1 if none */
   int ctypeIdx = -1;     /* Index of the ctype= constraint, or -1 if none */
+  int rowidIdx = -1;     /* Index of the rowid= constraint, or -1 if none */
 
   const struct sqlite3_index_constraint *pConstraint;
   pConstraint = pIdxInfo->aConstraint;
@@ -332,6 +352,9 @@ static int carrayBestIndex(
       case CARRAY_COLUMN_CTYPE:
         ctypeIdx = i;
         break;
+      case -1:
+        rowidIdx = i;
+        break;
     }
   }
   if( ptrIdx>=0 ){
@@ -350,6 +373,17 @@ static int carrayBestIndex(
         pIdxInfo->idxNum = 3;
       }
     }
+    if( rowidIdx>=0 ){
+      pIdxInfo->aConstraintUsage[rowidIdx].argvIndex =
+          (pIdxInfo->idxNum & 0x03) + 1;
+      pIdxInfo->aConstraintUsage[rowidIdx].omit = 1;
+      pIdxInfo->estimatedCost = (double)1;
+      pIdxInfo->estimatedRows = 1;
+      pIdxInfo->idxFlags = SQLITE_INDEX_SCAN_UNIQUE;
+      pIdxInfo->idxNum |= 0x04;
+    }else{
+      pIdxInfo->estimatedCost = (double)100;
+    }
   }else{
     pIdxInfo->estimatedCost = (double)2147483647;
     pIdxInfo->estimatedRows = 2147483647;
@@ -5676,6 +5676,48 @@ char *sqlite3DescribeIndexOrder(
   return ret2;
 }
 
+/*
+** Describe the columns of remote table zName that colMask says are used, for
+** the select list of a remote cursor; unused columns are fetched as NULL, so
+** rows keep their shape.  Returns NULL if every column is needed, or the mask
+** is unknown (0) or does not cover all of them.
+*/
+char *sqlite3DescribeTableColumns(
+  sqlite3 *db,
+  const char *zName,
+  const char *zDb,
+  unsigned long long colMask)
+{
+  Table *pTbl;
+  char  *ret = NULL, *ret2;
+  int    i;
+
+  if( colMask==0 || (colMask & (1ULL<<63)) ){
+    return NULL;
+  }
+  pTbl = sqlite3FindTable(db, zName, zDb);
+  if( !pTbl || pTbl->nCol>=63 ){
+    return NULL;
+  }
+  if( (colMask & ((1ULL<<pTbl->nCol)-1)) == ((1ULL<<pTbl->nCol)-1) ){
+    return NULL;
+  }
+  for(i=0; i<pTbl->nCol; i++){
+    if( colMask & (1ULL<<i) ){
+      ret2 = sqlite3_mprintf("%s%s\"%w\"", ret ? ret : "", ret ? ", " : "",
+                             pTbl->aCol[i].zName);
+    }else{
+      ret2 = sqlite3_mprintf("%s%sNULL", ret ? ret : "", ret ? ", " : "");
+    }
+    sqlite3_free(ret);
+    ret = ret2;
+    if( !ret ){
+      return NULL;
+    }
+  }
+  return ret;
+}
+
 /*
 ** Reset the schema for all remote dbs from an engine.
 */
@@ -16,6 +16,7 @@
 #include <comdb2vdbe.h>
 #include <trigger.h>
 #include <sqlglue.h>
+#include <bdb_api.h>
 
 struct dbtable;
 struct dbtable *getqueuebyname(const char *);
@@ -145,7 +146,7 @@ Cdb2TrigTables *comdb2AddTriggerTable(Parse *parse, Cdb2TrigTables *tables,
 
 // dynamic -> consumer
 void comdb2CreateTrigger(Parse *parse, int dynamic, int seq, Token *proc,
-                         Cdb2TrigTables *tbl)
+                         Cdb2TrigTables *tbl, Cdb2TrigPartition *part)
 {
     if (comdb2IsPrepareOnly(parse))
         return;
@@ -181,7 +182,51 @@ void comdb2CreateTrigger(Parse *parse, int dynamic, int seq, Token *proc,
 		return;
 	}
 
+	char partcol[MAXCOLNAME + 1] = {0};
+	int npartitions = 0;
+	if (part->col.n) {
+		char count[16];
+		if (comdb2TokenToStr(&part->col, partcol, sizeof(partcol)) ||
+		    comdb2TokenToStr(&part->count, count, sizeof(count)) ||
+		    (npartitions = atoi(count)) < 2 ||
+		    npartitions > QUEUE_MAX_PARTITIONS) {
+			sqlite3ErrorMsg(parse, "partitions must be from 2 to %d",
+					QUEUE_MAX_PARTITIONS);
+			return;
+		}
+		if (seq == 1) {
+			sqlite3ErrorMsg(parse, "a partitioned queue can't have a "
+					"persistent sequence");
+			return;
+		}
+		seq = 0;
+		for (Cdb2TrigTables *t = tbl; t; t = t->next) {
+			int i;
+			for (i = 0; i < t->table->nCol; ++i) {
+				if (sqlite3StrICmp(t->table->aCol[i].zName, partcol) == 0)
+					break;
+			}
+			if (i == t->table->nCol) {
+				sqlite3ErrorMsg(parse, "no such column %s in %s", partcol,
+						t->table->zName);
+				return;
+			}
+		}
+	}
+
+	extern int gbl_rowlocks;
+	if (part->deferred && !gbl_rowlocks &&
+	    !bdb_attr_get(thedb->bdb_attr, BDB_ATTR_SNAPISOL)) {
+		sqlite3ErrorMsg(parse, "deferred triggers need rowlocks or "
+				"snapshot isolation");
+		return;
+	}
+
 	strbuf *s = strbuf_new();
+	if (npartitions)
+		strbuf_appendf(s, "partition_by %s %d\n", partcol, npartitions);
+	if (part->deferred)
+		strbuf_append(s, "async\n");
 	while (tbl) {
 		Table *table = tbl->table;
 		Cdb2TrigEvents *events = tbl->events;
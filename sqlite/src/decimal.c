@@ -21,3 +21,108 @@ int sqlite3DecimalToString( sql_decimal_t * dec, char *str, int len){
    return 0;
 }
 
+
+/* 10^n, for n up to DECQUAD_Pmax */
+static const __int128 pow10_128[DECQUAD_Pmax + 1] = {
+   1ULL,
+   10ULL,
+   100ULL,
+   1000ULL,
+   10000ULL,
+   100000ULL,
+   1000000ULL,
+   10000000ULL,
+   100000000ULL,
+   1000000000ULL,
+   10000000000ULL,
+   100000000000ULL,
+   1000000000000ULL,
+   10000000000000ULL,
+   100000000000000ULL,
+   1000000000000000ULL,
+   10000000000000000ULL,
+   100000000000000000ULL,
+   1000000000000000000ULL,
+   10000000000000000000ULL,
+   (__int128)10000000000000000000ULL * 10ULL,
+   (__int128)10000000000000000000ULL * 100ULL,
+   (__int128)10000000000000000000ULL * 1000ULL,
+   (__int128)10000000000000000000ULL * 10000ULL,
+   (__int128)10000000000000000000ULL * 100000ULL,
+   (__int128)10000000000000000000ULL * 1000000ULL,
+   (__int128)10000000000000000000ULL * 10000000ULL,
+   (__int128)10000000000000000000ULL * 100000000ULL,
+   (__int128)10000000000000000000ULL * 1000000000ULL,
+   (__int128)10000000000000000000ULL * 10000000000ULL,
+   (__int128)10000000000000000000ULL * 100000000000ULL,
+   (__int128)10000000000000000000ULL * 1000000000000ULL,
+   (__int128)10000000000000000000ULL * 10000000000000ULL,
+   (__int128)10000000000000000000ULL * 100000000000000ULL,
+   (__int128)10000000000000000000ULL * 1000000000000000ULL,
+};
+
+/*
+** While every operand and every partial sum is exact in DECQUAD_Pmax digits,
+** decQuadAdd() does no rounding and gives its result the smaller of the two
+** exponents, which is what summing scaled coefficients gives too.  Values
+** that would break that (specials, negative zero, a sum that cancels out to
+** zero whose sign depends on the rounding mode, more than DECQUAD_Pmax
+** digits) are refused.
+*/
+int sqlite3DecimalSumAdd(sql_decimal_sum_t *sum, const sql_decimal_t *dec){
+   __int128 limit;
+   uint8_t bcd[DECQUAD_Pmax];
+   unsigned long long hi = 0, lo = 0;
+   __int128 c, acc;
+   int i, sign, exp;
+
+   if( !decQuadIsFinite(dec) ) return 1;
+   limit = pow10_128[DECQUAD_Pmax];
+   sign = decQuadGetCoefficient(dec, bcd);
+   exp = decQuadGetExponent(dec);
+   for( i = 0; i < DECQUAD_Pmax - 16; i++ ) hi = hi * 10 + bcd[i];
+   for( ; i < DECQUAD_Pmax; i++ ) lo = lo * 10 + bcd[i];
+   c = (__int128)hi * 10000000000000000LL + lo;
+   if( c == 0 && sign ) return 1;
+   if( sign ) c = -c;
+
+   acc = sum->coef;
+   if( sum->n == 0 ){
+      sum->coef = c;
+      sum->exp = exp;
+      sum->n = 1;
+      return 0;
+   }
+   if( exp > sum->exp ){
+      if( exp - sum->exp >= DECQUAD_Pmax ) return 1;
+      if( c >= pow10_128[DECQUAD_Pmax - (exp - sum->exp)] ||
+          c <= -pow10_128[DECQUAD_Pmax - (exp - sum->exp)] ) return 1;
+      c *= pow10_128[exp - sum->exp];
+      exp = sum->exp;
+   }else if( exp < sum->exp ){
+      if( sum->exp - exp >= DECQUAD_Pmax ) return 1;
+      if( acc >= pow10_128[DECQUAD_Pmax - (sum->exp - exp)] ||
+          acc <= -pow10_128[DECQUAD_Pmax - (sum->exp - exp)] ) return 1;
+      acc *= pow10_128[sum->exp - exp];
+   }
+   acc += c;
+   if( acc >= limit || acc <= -limit ) return 1;
+   if( acc == 0 && sum->coef != 0 ) return 1;
+   sum->coef = acc;
+   sum->exp = exp;
+   sum->n++;
+   return 0;
+}
+
+void sqlite3DecimalSumValue(const sql_decimal_sum_t *sum, sql_decimal_t *dec){
+   uint8_t bcd[DECQUAD_Pmax];
+   unsigned __int128 c;
+   int i;
+
+   c = sum->coef < 0 ? -(unsigned __int128)sum->coef : sum->coef;
+   for( i = DECQUAD_Pmax - 1; i >= 0; i-- ){
+      bcd[i] = c % 10;
+      c /= 10;
+   }
+   decQuadFromBCD(dec, sum->exp, bcd, sum->coef < 0 ? DECFLOAT_Sign : 0);
+}
@@ -4,4 +4,17 @@
 typedef decQuad   sql_decimal_t;
 int sqlite3DecimalToString(sql_decimal_t * dec, char *str, int len);
 
+/* A running sum of decimals kept as an exact coefficient and exponent, for
+** as long as it fits in DECQUAD_Pmax digits.  Zero it to start. */
+typedef struct sql_decimal_sum {
+   __int128 coef;
+   int exp;
+   int n;            /* values added */
+} sql_decimal_sum_t;
+
+/* Returns non-zero, leaving the sum alone, if dec can't be added exactly;
+** the caller carries on with decQuadAdd() from sqlite3DecimalSumValue(). */
+int sqlite3DecimalSumAdd(sql_decimal_sum_t *sum, const sql_decimal_t *dec);
+void sqlite3DecimalSumValue(const sql_decimal_sum_t *sum, sql_decimal_t *dec);
+
 #endif
@@ -6477,6 +6477,19 @@ default_prec:
                 return ret;
             }
         }
+      } else if (pParamsOut &&
+              (!strcasecmp(pExpr->u.zToken, "sum") ||
+               !strcasecmp(pExpr->u.zToken, "min") ||
+               !strcasecmp(pExpr->u.zToken, "max")) &&
+              pExpr->x.pList && pExpr->x.pList->nExpr == 1) {
+        char *arguments = sqlite3ExprDescribe_inner(v,
+                pExpr->x.pList->a[0].pExpr, atRuntime, pParamsOut,
+                useFullColnames);
+        if (arguments) {
+            char *ret = sqlite3_mprintf("%s(%s)", pExpr->u.zToken, arguments);
+            sqlite3_free(arguments);
+            return ret;
+        }
       }
   }
   return NULL;
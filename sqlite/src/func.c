@@ -2114,6 +2114,8 @@ struct SumCtx {
   u8 approx;        /* True if non-integer value was input to the sum */
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
   u8 decs;          /* True if summing decimals */
+  u8 decSlow;       /* True once decSum holds the sum */
+  sql_decimal_sum_t decFast; /* exact sum, until it no longer fits */
   decQuad decSum;   /* decQuad aggregation */
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 };
@@ -2147,9 +2149,12 @@ static void sumStep(sqlite3_context *context, int argc, sqlite3_value **argv){
     }else if( type==SQLITE_DECIMAL ){
       intv_t v = *(intv_t*)sqlite3_value_interval(argv[0], SQLITE_DECIMAL);
 
-      if( p->decs==0 ){
+      p->decs = 1;
+      if( !p->decSlow && sqlite3DecimalSumAdd(&p->decFast, &v.u.dec)==0 ){
+        /* summed exactly, no decNumber context needed */
+      }else if( !p->decSlow && p->decFast.n==0 ){
         p->decSum = v.u.dec;
-        p->decs = 1;
+        p->decSlow = 1;
 
         if( 0 ){
           char aaa[128];
@@ -2164,6 +2169,10 @@ static void sumStep(sqlite3_context *context, int argc, sqlite3_value **argv){
         decContext ctx;
         decQuad    res;
 
+        if( !p->decSlow ){
+          sqlite3DecimalSumValue(&p->decFast, &p->decSum);
+          p->decSlow = 1;
+        }
         dec_ctx_init( &ctx, DEC_INIT_DECQUAD, gbl_decimal_rounding);
         decQuadAdd( &res, &p->decSum, &v.u.dec, &ctx);
 
@@ -2218,6 +2227,15 @@ static void sumInverse(sqlite3_context *context, int argc, sqlite3_value**argv){
 #else
 # define sumInverse 0
 #endif /* SQLITE_OMIT_WINDOWFUNC */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+static void sumDecimal(SumCtx *p, decQuad *out){
+  if( p->decSlow ){
+    *out = p->decSum;
+  }else{
+    sqlite3DecimalSumValue(&p->decFast, out);
+  }
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 static void sumFinalize(sqlite3_context *context){
   SumCtx *p;
   p = sqlite3_aggregate_context(context, 0);
@@ -2231,7 +2249,7 @@ static void sumFinalize(sqlite3_context *context){
        intv_t res;
        res.type = INTV_DECIMAL_TYPE;
        res.sign = 0;
-       res.u.dec = p->decSum;
+       sumDecimal(p, &res.u.dec);
        sqlite3_result_interval(context, &res);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     }else{
@@ -2247,12 +2265,14 @@ static void avgFinalize(sqlite3_context *context){
     if( p->decs ){
       decContext ctx;
       decQuad denom;
+      decQuad sum;
       decQuad res;
       intv_t  tv;
 
       dec_ctx_init( &ctx, DEC_INIT_DECQUAD, gbl_decimal_rounding);
       decQuadFromInt32( &denom, p->cnt);
-      decQuadDivide( &res, &p->decSum, &denom, &ctx);
+      sumDecimal(p, &sum);
+      decQuadDivide( &res, &sum, &denom, &ctx);
       if( dfp_conv_check_status(&ctx, "quad", "divide(quad)") ){
         sqlite3_result_error(context, "decimal overflow", -1);
       }
@@ -2276,7 +2296,7 @@ static void totalFinalize(sqlite3_context *context){
     intv_t res;
     res.type = INTV_DECIMAL_TYPE;
     res.sign = 0;
-    res.u.dec = p->decSum;
+    sumDecimal(p, &res.u.dec);
     sqlite3_result_interval(context, &res);
   }
   else
@@ -339,7 +339,7 @@ columnname(A) ::= nm(A) typetoken(Y). {sqlite3AddColumn(pParse,&A,&Y);}
   REBUILD READ READONLY REC RESERVED RESUME RETENTION REVOKE RLE ROWLOCKS
   SCALAR SCHEMACHANGE SKIPSCAN START SUMMARIZE
   THREADS THRESHOLD TIME TRUNCATE TUNABLE TYPE
-  VERSION WRITE DDL USERSCHEMA ZLIB
+  VERSION WRITE DDL USERSCHEMA ZLIB ZSTD
 %endif SQLITE_BUILDING_FOR_COMDB2
   .
 %wildcard ANY.
@@ -2465,6 +2465,7 @@ blob_compress_type(A) ::= RLE. {A = BLOB_RLE;}
 //blob_compress_type(A) ::= CRLE. {A = BLOB_CRLE;}
 blob_compress_type(A) ::= ZLIB. {A = BLOB_ZLIB;}
 blob_compress_type(A) ::= LZ4. {A = BLOB_LZ4;}
+blob_compress_type(A) ::= ZSTD. {A = BLOB_ZSTD;}
 
 %type compress_rec {int}
 compress_rec(A) ::= REC rle_compress_type(T). {A = T;}
@@ -2475,6 +2476,7 @@ rle_compress_type(A) ::= RLE. {A = REC_RLE;}
 rle_compress_type(A) ::= CRLE. {A = REC_CRLE;}
 rle_compress_type(A) ::= ZLIB. {A = REC_ZLIB;}
 rle_compress_type(A) ::= LZ4. {A = REC_LZ4;}
+rle_compress_type(A) ::= ZSTD. {A = REC_ZSTD;}
 
 ////////////////////////////// CREATE PROCEDURE ///////////////////////////////
 
@@ -2515,12 +2517,14 @@ cmd ::= createkw LUA AGGREGATE FUNCTION nm(Q). {
 	comdb2CreateAggFunc(pParse, &Q);
 }
 
-cmd ::= createkw LUA TRIGGER nm(Q) withsequence(S) ON table_trigger_event(T). {
-  comdb2CreateTrigger(pParse,0,S,&Q,T);
+cmd ::= createkw LUA TRIGGER nm(Q) withsequence(S) ON table_trigger_event(T) trigpartition(P) trigdeferred(D). {
+  P.deferred = D;
+  comdb2CreateTrigger(pParse,0,S,&Q,T,&P);
 }
 
-cmd ::= createkw LUA CONSUMER nm(Q) withsequence(S) ON table_trigger_event(T). {
-  comdb2CreateTrigger(pParse,1,S,&Q,T);
+cmd ::= createkw LUA CONSUMER nm(Q) withsequence(S) ON table_trigger_event(T) trigpartition(P) trigdeferred(D). {
+  P.deferred = D;
+  comdb2CreateTrigger(pParse,1,S,&Q,T,&P);
 }
 
 table_trigger_event(A) ::= table_trigger_event(B) COMMA LP TABLE fullname(T) FOR trigger_events(C) RP. {
@@ -2536,6 +2540,18 @@ withsequence(A) ::= .                   { A = -1; }
 withsequence(A) ::= WITHOUT SEQUENCE.   { A = 0; }
 withsequence(A) ::= WITH SEQUENCE.      { A = 1; }
 
+%type trigpartition {Cdb2TrigPartition}
+trigpartition(A) ::= .                  { memset(&A, 0, sizeof(A)); }
+trigpartition(A) ::= PARTITIONED BY nm(C) INTO INTEGER(N). {
+  memset(&A, 0, sizeof(A));
+  A.col = C;
+  A.count = N;
+}
+
+%type trigdeferred {int}
+trigdeferred(A) ::= .                   { A = 0; }
+trigdeferred(A) ::= DEFERRED.           { A = 1; }
+
 %type table_trigger_event {Cdb2TrigTables*}
 %destructor table_trigger_event {sqlite3DbFree(pParse->db, $$);}
 
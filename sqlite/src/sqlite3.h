@@ -4854,6 +4854,9 @@ char *stmt_column_decltype(sqlite3_stmt *pStmt, int index);
 char *stmt_cached_column_decltype(sqlite3_stmt *pStmt, int index);
 void stmt_set_cached_columns(sqlite3_stmt *, char **, char **, int);
 void stmt_set_vlock_tables(sqlite3_stmt *, char **, int);
+int stmt_fingerprint(sqlite3_stmt *, const char *, unsigned char *, size_t *);
+void stmt_set_fingerprint(sqlite3_stmt *, const char *, const unsigned char *,
+                          size_t);
 int stmt_do_column_names_match(sqlite3_stmt *);
 int stmt_do_column_decltypes_match(sqlite3_stmt *pStmt);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
@@ -1160,6 +1160,7 @@ typedef struct With With;
 typedef struct Cdb2TrigEvent Cdb2TrigEvent;
 typedef struct Cdb2TrigEvents Cdb2TrigEvents;
 typedef struct Cdb2TrigTables Cdb2TrigTables;
+typedef struct Cdb2TrigPartition Cdb2TrigPartition;
 typedef struct comdb2_ddl_context Cdb2DDL;
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
@@ -4307,6 +4308,7 @@ int sqlite3FunctionUsesThisSrc(Expr*, SrcList*);
 Vdbe *sqlite3GetVdbe(Parse*);
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 void sqlite3CreateUpdCols(Vdbe *,sqlite3 *db, int, int *);
+void sqlite3TagUpdColDelta(Vdbe *, int);
 int sqlite3PredicatedClearViews(sqlite3 *db, 
       int (*predicated_delete)(const char *name, sqlite3 *db, void *arg), void *arg);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
@@ -5016,6 +5018,10 @@ extern int comdb2_dynamic_attach(sqlite3 *db, sqlite3_context *context, int argc
       const char *zName, const char *zFile, char **pzErrDyn, int version);
 extern void comdb2_dynamic_detach(sqlite3 *db, int idx);  
 extern int comdb2_fdb_check_class(const char *dbname);
+extern int counter_table_name(const char *table);
+extern int counter_column(const char *table, const char *column);
+extern int zonemap_table_name(const char *table);
+extern int zonemap_column(const char *table, const char *column);
 int sqlite3InitTable(sqlite3 *db, char **pzErrMsg, const char *zName);
 extern int sqlite3UpdateMemCollAttr(BtCursor *pCur, int idx, Mem *mem);
 char* sqlite3ExprDescribe(Vdbe *v, const Expr *pExpr);
@@ -5030,6 +5036,8 @@ char *sqlite3DescribeIndexOrder(sqlite3 *db,
       int op,
       int is_equality,
       unsigned long long colMask);
+char *sqlite3DescribeTableColumns(sqlite3 *db, const char *zName,
+      const char *zDb, unsigned long long colMask);
 
 #if defined(SQLITE_ENABLE_DBSTAT_VTAB) || defined(SQLITE_TEST)
 int sqlite3DbstatRegister(sqlite3*);
@@ -5054,10 +5062,16 @@ struct Cdb2TrigTables {
   Cdb2TrigEvents *events;
   Cdb2TrigTables *next;
 };
+struct Cdb2TrigPartition {
+  Token col;    /* col.n==0 if the queue is not partitioned */
+  Token count;
+  int deferred; /* run from the log after commit, not by the writer */
+};
 Cdb2TrigEvents *comdb2AddTriggerEvent(Parse*,Cdb2TrigEvents*,Cdb2TrigEvent*);
 void comdb2DropTrigger(Parse*,int,Token*);
 Cdb2TrigTables *comdb2AddTriggerTable(Parse*,Cdb2TrigTables*,SrcList*,Cdb2TrigEvents*);
-void comdb2CreateTrigger(Parse*,int dynamic,int seq,Token*,Cdb2TrigTables*);
+void comdb2CreateTrigger(Parse*,int dynamic,int seq,Token*,Cdb2TrigTables*,
+                         Cdb2TrigPartition*);
 
 void comdb2CreateScalarFunc(Parse *, Token *, int flags);
 void comdb2DropScalarFunc(Parse *, Token *);
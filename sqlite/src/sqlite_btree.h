@@ -54,6 +54,7 @@ int sqlite3BtreeOpen(
 #define BTREE_MEMORY        2  /* This is an in-memory DB */
 #define BTREE_SINGLE        4  /* The file contains at most 1 b-tree */
 #define BTREE_UNORDERED     8  /* Use of a hash implementation is OK */
+#define BTREE_HASHED       16  /* Hashed on a key prefix; COMDB2 */
 
 int sqlite3BtreeClose(Btree*);
 int sqlite3BtreeSetCacheSize(Btree*,int);
@@ -344,6 +345,7 @@ int sqlite3BtreeCursorIsValidNN(BtCursor*);
 #ifndef SQLITE_OMIT_BTREECOUNT
 int sqlite3BtreeCount(BtCursor *, i64 *);
 #endif
+int sqlite3BtreeSetHashPrefix(BtCursor *, int); /* COMDB2 */
 
 #ifdef SQLITE_TEST
 int sqlite3BtreeCursorInfo(BtCursor*, int*, int);
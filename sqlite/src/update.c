@@ -137,6 +137,86 @@ static int indexWhereClauseMightChange(
 
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 int has_comdb2_index_for_sqlite(Table *pTab);
+
+/*
+** Walker callbacks: set eCode if the expression reads a column of the
+** table being updated (any column, or only a counter column).
+*/
+static int tableColumnRef(Walker *pWalker, Expr *pExpr){
+  if( pExpr->op==TK_COLUMN && pExpr->y.pTab==pWalker->u.pSrcList->a[0].pTab ){
+    pWalker->eCode = 1;
+    return WRC_Abort;
+  }
+  return WRC_Continue;
+}
+static int counterColumnRef(Walker *pWalker, Expr *pExpr){
+  Table *pTab = pWalker->u.pSrcList->a[0].pTab;
+  if( pExpr->op==TK_COLUMN && pExpr->y.pTab==pTab && pExpr->iColumn>=0
+   && counter_column(pTab->zName, pTab->aCol[pExpr->iColumn].zName) ){
+    pWalker->eCode = 1;
+    return WRC_Abort;
+  }
+  return WRC_Continue;
+}
+static int exprRefersTo(
+  int (*xRef)(Walker*,Expr*),
+  SrcList *pTabList,
+  Expr *pExpr
+){
+  Walker w;
+  memset(&w, 0, sizeof(w));
+  w.xExprCallback = xRef;
+  w.xSelectCallback = sqlite3SelectWalkNoop;
+  w.u.pSrcList = pTabList;
+  sqlite3WalkExpr(&w, pExpr);
+  return w.eCode;
+}
+
+/* Is pExpr column iCol of the row being updated? */
+static int isUpdatedColumn(SrcList *pTabList, int iCol, Expr *pExpr){
+  return pExpr->op==TK_COLUMN && pExpr->iTable==pTabList->a[0].iCursor
+      && pExpr->iColumn==iCol;
+}
+
+/*
+** Tag in the updCols array the counter columns (see counter_columns) that
+** this UPDATE sets to "c + expr", "expr + c" or "c - expr", where expr
+** reads nothing from the row.  The master may then re-apply such an update
+** to a row version newer than the one we read.  Nothing is tagged if the
+** WHERE clause reads a counter column, since the row might no longer
+** qualify.
+*/
+static void tagCounterDeltas(
+  Vdbe *v,
+  SrcList *pTabList,
+  ExprList *pChanges,
+  Expr *pWhere,
+  int *aXRef
+){
+  Table *pTab = pTabList->a[0].pTab;
+  int j;
+  if( !counter_table_name(pTab->zName) ) return;
+  if( pWhere && exprRefersTo(counterColumnRef, pTabList, pWhere) ) return;
+  for(j=0; j<pTab->nCol; j++){
+    Expr *pExpr, *pDelta;
+    if( aXRef[j]<0 ) continue;
+    if( !counter_column(pTab->zName, pTab->aCol[j].zName) ) continue;
+    pExpr = pChanges->a[aXRef[j]].pExpr;
+    if( pExpr->op==TK_PLUS && isUpdatedColumn(pTabList, j, pExpr->pLeft) ){
+      pDelta = pExpr->pRight;
+    }else if( pExpr->op==TK_PLUS
+           && isUpdatedColumn(pTabList, j, pExpr->pRight) ){
+      pDelta = pExpr->pLeft;
+    }else if( pExpr->op==TK_MINUS
+           && isUpdatedColumn(pTabList, j, pExpr->pLeft) ){
+      pDelta = pExpr->pRight;
+    }else{
+      continue;
+    }
+    if( exprRefersTo(tableColumnRef, pTabList, pDelta) ) continue;
+    sqlite3TagUpdColDelta(v, j);
+  }
+}
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 /*
 ** Process an UPDATE statement.
@@ -408,7 +488,13 @@ void sqlite3Update(
   /* create our updCols array. */
   if( isView && strncmp(pTab->aCol[0].zName, "__hidden__rowid",
                         strlen("__hidden__rowid")+1)==0 ){
-    sqlite3CreateUpdCols(v, db, pTab->nCol-1, aXRef+1);
+    /* time partition views also end with the shard bounds */
+    int nCol = pTab->nCol-1;
+    if( nCol>2 && strcmp(pTab->aCol[pTab->nCol-1].zName,
+                         "__hidden__shard_end")==0 ){
+      nCol -= 2;
+    }
+    sqlite3CreateUpdCols(v, db, nCol, aXRef+1);
   } else {
     sqlite3CreateUpdCols(v, db, pTab->nCol, aXRef);
   }
@@ -456,6 +542,13 @@ void sqlite3Update(
     goto update_cleanup;
   }
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  if( !isView && !pTrigger && !pUpsert && !chngKey
+   && pOrderBy==0 && pLimit==0 ){
+    tagCounterDeltas(v, pTabList, pChanges, pWhere, aXRef);
+  }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
 #ifndef SQLITE_OMIT_VIRTUALTABLE
   /* Virtual tables must be handled separately */
   if( IsVirtual(pTab) ){
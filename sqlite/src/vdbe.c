@@ -26,6 +26,7 @@
 #include <pthread.h>
 #include <strings.h>
 #include <sql.h>
+#include "counters.h"
 
 /* Comdb2 routines called from vdbe */
 void set_cook_fields(BtCursor *pCur, int cols);
@@ -308,6 +309,14 @@ void sqlite3CreateUpdCols(
   v->updCols[0] = cnt;
   memcpy(&v->updCols[1], cols, sizeof(int) * cnt);
 }
+
+/*
+** Mark column iCol of the updCols array as a commutative counter delta.
+*/
+void sqlite3TagUpdColDelta(Vdbe *v, int iCol){
+  if( v->updCols==0 || iCol>=v->updCols[0] ) return;
+  v->updCols[iCol + 1] = UPDCOL_DELTA;
+}
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
 /*
@@ -3081,7 +3090,9 @@ case OP_Column: {
     else if( pC->isTable ){
       zData = (u8 *)sqlite3BtreeDataFetch(pCrsr, &pC->szRow);
       assert(zData != NULL);
+      pCrsr->blob_nofetch = pOp->p5 & (OPFLAG_LENGTHARG|OPFLAG_TYPEOFARG);
       rc = get_data(pCrsr, pCrsr->sc, (u8 *) zData, p2, pDest, 0, pCrsr->clnt->tzname);
+      pCrsr->blob_nofetch = 0;
     }else{
       datacopy = p2;
       if( is_datacopy(pCrsr, &datacopy) ){
@@ -3101,6 +3112,8 @@ case OP_Column: {
 
     pDest->db = p->db;
     pDest->enc = encoding;
+    /* An unfetched blob only passed to length()/typeof(); keep it zero-filled */
+    if( pDest->flags & MEM_Zero ) goto op_column_out;
     rc = sqlite3VdbeMemMakeWriteable(pDest);
     goto op_column_out;
   }
@@ -4393,13 +4406,16 @@ case OP_OpenDup: {
 ** the btree.  The BTREE_OMIT_JOURNAL and BTREE_SINGLE flags are
 ** added automatically.
 */
-/* Opcode: OpenAutoindex P1 P2 * P4 *
+/* Opcode: OpenAutoindex P1 P2 P3 P4 P5
 ** Synopsis: nColumn=P2
 **
 ** This opcode works the same as OP_OpenEphemeral.  It has a
 ** different name to distinguish its use.  Tables created using
 ** by this opcode will be used for automatically created transient
 ** indices in joins.
+**
+** COMDB2: if P5 has BTREE_HASHED, the index is a hash table on its
+** first P3 columns, which only serves equality seeks on those columns.
 */
 case OP_OpenAutoindex: 
 case OP_OpenEphemeral: {
@@ -4452,6 +4468,9 @@ case OP_OpenEphemeral: {
           rc = sqlite3BtreeCursor(p, pCx->pBtx, pCx->pgnoRoot,
                                   BTREE_CUR_WR|BTREE_WRCSR, 0,
                                   pKeyInfo, pCx->uc.pCursor);
+          if( rc==SQLITE_OK && (pOp->p5 & BTREE_HASHED) ){
+            rc = sqlite3BtreeSetHashPrefix(pCx->uc.pCursor, pOp->p3);
+          }
 #else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
           rc = sqlite3BtreeCursor(pCx->pBtx, pCx->pgnoRoot, BTREE_WRCSR,
                                   pKeyInfo, pCx->uc.pCursor);
@@ -593,6 +593,9 @@ struct Vdbe {
   char **oldColDeclTypes; /* Column decltypes returned by old-sqlite version */
   int oldColCount;        /* Column count (refer: sqlitex)*/
   u8 fingerprint_added;   /* Whether fingerprint was added? Only used in SP code */
+  const char *zFpSql;     /* zNormSql that aFingerprint was computed from */
+  int nFpSql;             /* Length of zFpSql */
+  u8 aFingerprint[16];    /* MD5 of zFpSql, see stmt_fingerprint() */
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 };
 
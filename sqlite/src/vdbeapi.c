@@ -233,6 +233,33 @@ int stmt_do_column_decltypes_match(sqlite3_stmt *pStmt) {
   return 1;
 }
 
+/*
+** The fingerprint of a statement is the MD5 of its normalized SQL, which
+** the statement keeps once computed.  Return 1 and the fingerprint if it
+** was computed from zNormSql (as returned by sqlite3_normalized_sql() for
+** this statement), or 0.
+*/
+int stmt_fingerprint(sqlite3_stmt *pStmt, const char *zNormSql,
+                     unsigned char *aFingerprint, size_t *pnNormSql) {
+  Vdbe *vdbe = (Vdbe *)pStmt;
+  if( zNormSql==0 || vdbe->zFpSql!=zNormSql ) return 0;
+  memcpy(aFingerprint, vdbe->aFingerprint, sizeof(vdbe->aFingerprint));
+  *pnNormSql = vdbe->nFpSql;
+  return 1;
+}
+
+/* Keep the fingerprint of zNormSql, if it is this statement's own. */
+void stmt_set_fingerprint(sqlite3_stmt *pStmt, const char *zNormSql,
+                          const unsigned char *aFingerprint, size_t nNormSql) {
+  Vdbe *vdbe = (Vdbe *)pStmt;
+#ifdef SQLITE_ENABLE_NORMALIZE
+  if( zNormSql==0 || zNormSql!=vdbe->zNormSql ) return;
+  memcpy(vdbe->aFingerprint, aFingerprint, sizeof(vdbe->aFingerprint));
+  vdbe->nFpSql = (int)nNormSql;
+  vdbe->zFpSql = zNormSql;
+#endif
+}
+
 void stmt_set_vlock_tables(sqlite3_stmt *pStmt, char **vTableLocks,
         int numVTableLocks) {
   Vdbe *vdbe = (Vdbe *)pStmt;
@@ -165,9 +165,16 @@ void sqlite3VdbeSwap(Vdbe *pA, Vdbe *pB){
 #endif
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
   {
+    int i;
     SWAP(int *, pA->updCols, pB->updCols);
     SWAP(int, pA->oldColCount, pB->oldColCount);
     SWAP(char **, pA->oldColNames, pB->oldColNames);
+    /* the fingerprint stays with zNormSql */
+    SWAP(const char *, pA->zFpSql, pB->zFpSql);
+    SWAP(int, pA->nFpSql, pB->nFpSql);
+    for(i=0; i<sizeof(pA->aFingerprint); i++){
+      SWAP(u8, pA->aFingerprint[i], pB->aFingerprint[i]);
+    }
   }
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   pB->expmask = pA->expmask;
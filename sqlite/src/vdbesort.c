@@ -142,6 +142,7 @@
 #include <inttypes.h>
 #include <cheapstack.h>
 #include <sys/time.h>
+#include <pthread.h>
 
 int comdb2_tmpdir_space_low();
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
@@ -1424,6 +1425,177 @@ static SorterCompare vdbeSorterGetCompare(VdbeSorter *p){
   return vdbeSorterCompare;
 }
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+/*
+** Sorting an in-memory list is split across up to gbl_sql_sorter_threads
+** threads once it holds at least SORTER_PARALLEL_MIN records per thread.
+** Each thread sorts a slice of the list with a private copy of the
+** sub-task and the slices are merged by the calling thread.  The sqlite
+** worker threads cannot be used for this: they are compiled out with the
+** per-thread allocator, which is also why everything a slice needs is
+** allocated up front by the calling thread.
+*/
+int gbl_sql_sorter_threads = 4;
+#define SORTER_PARALLEL_MIN   16384
+#define SORTER_MAX_THREADS    16
+
+extern pthread_key_t query_info_key;
+void sql_mem_shutdown(void *);
+
+typedef struct SorterSlice SorterSlice;
+struct SorterSlice {
+  SortSubtask task;               /* Private copy of the calling sub-task */
+  SorterRecord *pList;            /* Records of the slice, linked by pNext */
+  void *thd;                      /* sql_thread of the calling thread */
+  pthread_t tid;                  /* Thread sorting the slice */
+  int bThread;                    /* True if tid has to be joined */
+};
+
+/*
+** Return the record that follows p in the unsorted list pList.
+*/
+static SorterRecord *vdbeSorterListNext(SorterList *pList, SorterRecord *p){
+  if( pList->aMemory ){
+    if( (u8*)p==pList->aMemory ) return 0;
+    return (SorterRecord*)&pList->aMemory[p->u.iNext];
+  }
+  return p->u.pNext;
+}
+
+/*
+** Sort the pNext-linked list p using the 64 empty slots of aSlot.
+*/
+static SorterRecord *vdbeSorterSortLinked(
+  SortSubtask *pTask,
+  SorterRecord *p,
+  SorterRecord **aSlot
+){
+  int i;
+  while( p ){
+    SorterRecord *pNext = p->u.pNext;
+    p->u.pNext = 0;
+    for(i=0; aSlot[i]; i++){
+      p = vdbeSorterMerge(pTask, p, aSlot[i]);
+      aSlot[i] = 0;
+    }
+    aSlot[i] = p;
+    p = pNext;
+  }
+  p = 0;
+  for(i=0; i<64; i++){
+    if( aSlot[i]==0 ) continue;
+    p = p ? vdbeSorterMerge(pTask, p, aSlot[i]) : aSlot[i];
+  }
+  return p;
+}
+
+static void *vdbeSorterSliceThread(void *pCtx){
+  SorterSlice *pSlice = (SorterSlice*)pCtx;
+  SorterRecord *aSlot[64];
+
+  memset(aSlot, 0, sizeof(aSlot));
+  /* Comparisons may need the timezone of the client */
+  pthread_setspecific(query_info_key, pSlice->thd);
+  pSlice->pList = vdbeSorterSortLinked(&pSlice->task, pSlice->pList, aSlot);
+  pthread_setspecific(query_info_key, NULL);
+  /* Drop the allocator of this thread, if a comparison created one */
+  sql_mem_shutdown(NULL);
+  return 0;
+}
+
+/*
+** Sort pList on several threads if it is large enough.  Set *pbDone and
+** return SQLITE_OK once pList->pList is sorted; otherwise pList is left
+** alone for vdbeSorterSort() to sort on this thread.
+*/
+static int vdbeSorterSortParallel(
+  SortSubtask *pTask,
+  SorterList *pList,
+  int *pbDone
+){
+  SorterSlice *aSlice;
+  SorterRecord **aSlot;
+  SorterRecord *p;
+  SorterRecord **pp;
+  int nRecord = 0;
+  int nSlice;
+  int nEach;
+  int i, j;
+  int rc = SQLITE_OK;
+
+  *pbDone = 0;
+  nSlice = gbl_sql_sorter_threads;
+  if( nSlice>SORTER_MAX_THREADS ) nSlice = SORTER_MAX_THREADS;
+  for(p=pList->pList; p; p=vdbeSorterListNext(pList, p)) nRecord++;
+  if( nRecord/SORTER_PARALLEL_MIN<nSlice ) nSlice = nRecord/SORTER_PARALLEL_MIN;
+  if( nSlice<2 ) return SQLITE_OK;
+
+  aSlice = (SorterSlice*)sqlite3MallocZero(nSlice * sizeof(SorterSlice));
+  aSlot = (SorterRecord**)sqlite3MallocZero(64 * sizeof(SorterRecord*));
+  if( aSlice==0 || aSlot==0 ){
+    sqlite3_free(aSlice);
+    sqlite3_free(aSlot);
+    return SQLITE_NOMEM_BKPT;
+  }
+  for(i=1; i<nSlice; i++){
+    aSlice[i].task = *pTask;
+    aSlice[i].task.pUnpacked = 0;
+    rc = vdbeSortAllocUnpacked(&aSlice[i].task);
+    if( rc!=SQLITE_OK ) goto slice_out;
+    aSlice[i].thd = pthread_getspecific(query_info_key);
+  }
+
+  /* Relink the records by pNext, cutting the list into slices */
+  nEach = nRecord / nSlice;
+  p = pList->pList;
+  for(i=0; i<nSlice; i++){
+    pp = &aSlice[i].pList;
+    for(j=0; p && (j<nEach || i==nSlice-1); j++){
+      SorterRecord *pNext = vdbeSorterListNext(pList, p);
+      *pp = p;
+      pp = &p->u.pNext;
+      p = pNext;
+    }
+    *pp = 0;
+  }
+
+  for(i=1; i<nSlice; i++){
+    if( pthread_create(&aSlice[i].tid, 0, vdbeSorterSliceThread,
+                       &aSlice[i])==0 ){
+      aSlice[i].bThread = 1;
+    }else{
+      aSlice[i].pList = vdbeSorterSortLinked(pTask, aSlice[i].pList, aSlot);
+      memset(aSlot, 0, 64 * sizeof(SorterRecord*));
+    }
+  }
+  aSlice[0].pList = vdbeSorterSortLinked(pTask, aSlice[0].pList, aSlot);
+  for(i=1; i<nSlice; i++){
+    if( aSlice[i].bThread ) pthread_join(aSlice[i].tid, 0);
+    if( aSlice[i].task.pUnpacked->errCode ){
+      pTask->pUnpacked->errCode = aSlice[i].task.pUnpacked->errCode;
+    }
+  }
+
+  /* Merge the sorted slices pairwise */
+  for(j=1; j<nSlice; j*=2){
+    for(i=0; i+j<nSlice; i+=2*j){
+      aSlice[i].pList = vdbeSorterMerge(pTask, aSlice[i].pList,
+                                        aSlice[i+j].pList);
+    }
+  }
+  pList->pList = aSlice[0].pList;
+  *pbDone = 1;
+
+slice_out:
+  for(i=1; i<nSlice; i++){
+    sqlite3DbFree(pTask->pSorter->db, aSlice[i].task.pUnpacked);
+  }
+  sqlite3_free(aSlice);
+  sqlite3_free(aSlot);
+  return rc;
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
 /*
 ** Sort the linked list of records headed at pTask->pList. Return 
 ** SQLITE_OK if successful, or an SQLite error code (i.e. SQLITE_NOMEM) if 
@@ -1441,6 +1613,15 @@ static int vdbeSorterSort(SortSubtask *pTask, SorterList *pList){
   p = pList->pList;
   pTask->xCompare = vdbeSorterGetCompare(pTask->pSorter);
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  if( gbl_sql_sorter_threads>1 ){
+    int bDone;
+    rc = vdbeSorterSortParallel(pTask, pList, &bDone);
+    if( rc!=SQLITE_OK ) return rc;
+    if( bDone ) return pTask->pUnpacked->errCode;
+  }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
   aSlot = (SorterRecord **)sqlite3MallocZero(64 * sizeof(SorterRecord *));
   if( !aSlot ){
     return SQLITE_NOMEM_BKPT;
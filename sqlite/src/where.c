@@ -45,6 +45,7 @@ static int whereLoopResize(sqlite3*, WhereLoop*, int);
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 int gbl_disable_seekscan_optimization = 0;
 int gbl_sqlite_stat4_scan = 0;
+int gbl_sql_hash_join = 1;
 
 int shard_check_parallelism(int iTable);
 int comdb2_shard_table_constraints(Parse *pParse, 
@@ -715,6 +716,41 @@ static int termCanDriveIndex(
   testcase( pTerm->pExpr->op==TK_IS );
   return 1;
 }
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+/*
+** Return the class of values a hashed automatic index can compare for
+** affinity aff, or 0 if values of that affinity may compare equal to
+** values that hash differently (blobs and expressions without affinity
+** may hold datetimes, intervals or decimals).
+*/
+static char hashAffinityClass(char aff){
+  switch( aff ){
+    case SQLITE_AFF_INTEGER:
+    case SQLITE_AFF_REAL:    return SQLITE_AFF_NUMERIC;
+    case SQLITE_AFF_TEXT:    return SQLITE_AFF_TEXT;
+    default:                 return 0;
+  }
+}
+
+/*
+** Return TRUE if the automatic index driven by pTerm, a term accepted by
+** termCanDriveIndex(), can be a hash table on the column instead of an
+** ordered temp table: the comparison must use the binary collation and
+** both sides must hold the same class of values.  This turns the nested
+** loop over the automatic index into a hash join.
+*/
+static int termCanDriveHash(Parse *pParse, WhereTerm *pTerm){
+  Expr *pX = pTerm->pExpr;
+  CollSeq *pColl;
+  char cls;
+  if( !gbl_sql_hash_join ) return 0;
+  pColl = sqlite3BinaryCompareCollSeq(pParse, pX->pLeft, pX->pRight);
+  if( pColl && sqlite3StrICmp(pColl->zName, sqlite3StrBINARY) ) return 0;
+  cls = hashAffinityClass(sqlite3ExprAffinity(pX->pLeft));
+  return cls && cls==hashAffinityClass(sqlite3ExprAffinity(pX->pRight));
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 #endif
 
 
@@ -754,6 +790,9 @@ static void constructAutomaticIndex(
   struct SrcList_item *pTabItem;  /* FROM clause term being indexed */
   int addrCounter = 0;        /* Address where integer counter is initialized */
   int regBase;                /* Array of registers where record is assembled */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  int bHash = 0;              /* Hash the index on its equality columns */
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
   /* Generate code to skip over the creation and initialization of the
   ** transient index on 2nd and subsequent iterations of the loop. */
@@ -849,6 +888,10 @@ static void constructAutomaticIndex(
     }
   }
   assert( (u32)n==pLoop->u.btree.nEq );
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  for(i=0; i<n && termCanDriveHash(pParse, pLoop->aLTerm[i]); i++){}
+  bHash = (i==n);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
   /* Add additional columns needed to make the automatic index into
   ** a covering index */
@@ -873,8 +916,15 @@ static void constructAutomaticIndex(
   /* Create the automatic index */
   assert( pLevel->iIdxCur>=0 );
   pLevel->iIdxCur = pParse->nTab++;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  sqlite3VdbeAddOp3(v, OP_OpenAutoindex, pLevel->iIdxCur, nKeyCol+1,
+                    bHash ? pLoop->u.btree.nEq : 0);
+  sqlite3VdbeSetP4KeyInfo(pParse, pIdx);
+  if( bHash ) sqlite3VdbeChangeP5(v, BTREE_HASHED);
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   sqlite3VdbeAddOp2(v, OP_OpenAutoindex, pLevel->iIdxCur, nKeyCol+1);
   sqlite3VdbeSetP4KeyInfo(pParse, pIdx);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   VdbeComment((v, "for %s", pTable->zName));
 
   /* Fill the automatic index with content */
@@ -3010,6 +3060,15 @@ static int whereLoopAddBtree(
         ** not be unreasonable to make this value much larger. */
         pNew->nOut = 43;  assert( 43==sqlite3LogEst(20) );
         pNew->rRun = sqlite3LogEstAdd(rLogSize,pNew->nOut);
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        /* A hashed automatic index is built in N steps, not N*log2(N),
+        ** and each lookup is a hash probe instead of a btree descent. */
+        if( termCanDriveHash(pWInfo->pParse, pTerm) ){
+          pNew->rSetup -= rLogSize;
+          if( pNew->rSetup<0 ) pNew->rSetup = 0;
+          pNew->rRun = pNew->nOut;
+        }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         pNew->wsFlags = WHERE_AUTO_INDEX;
         pNew->prereq = mPrereq | pTerm->prereqRight;
         rc = whereLoopInsert(pBuilder, pNew);
@@ -1083,9 +1083,133 @@ static void codeCursorHint(
                       (const char*)pExpr, P4_EXPR);
   }
 }
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+/*
+** Return a TK_REGISTER expression holding the value of constant pVal, with
+** the affinity its comparison with column pCol is done in.
+*/
+static Expr *zonemapHintValue(Parse *pParse, Expr *pCol, Expr *pVal){
+  Expr *pReg = sqlite3Expr(pParse->db, TK_REGISTER, 0);
+  if( pReg ){
+    pReg->iTable = ++pParse->nMem;
+    pReg->affinity = sqlite3CompareAffinity(pCol, sqlite3ExprAffinity(pVal));
+    sqlite3ExprCode(pParse, pVal, pReg->iTable);
+  }
+  return pReg;
+}
+
+/*
+** Add "pCol op pVal" to hint pExpr if pCol is a zone map column of the
+** table of cursor iCur and pVal a constant, comparing with binary collation.
+*/
+static Expr *zonemapHintTerm(
+  Parse *pParse,
+  Expr *pExpr,
+  Table *pTab,
+  int iCur,
+  int op,
+  Expr *pCol,
+  Expr *pVal
+){
+  CollSeq *pColl;
+  Expr *pReg;
+  if( pCol->op!=TK_COLUMN || pCol->iTable!=iCur || pCol->iColumn<0 ) return pExpr;
+  if( !sqlite3ExprIsConstant(pVal) ) return pExpr;
+  if( !zonemap_column(pTab->zName, pTab->aCol[pCol->iColumn].zName) ){
+    return pExpr;
+  }
+  pColl = sqlite3BinaryCompareCollSeq(pParse, pCol, pVal);
+  if( pColl && !sqlite3IsBinary(pColl) ) return pExpr;
+  pReg = zonemapHintValue(pParse, pCol, pVal);
+  if( pReg==0 ) return pExpr;
+  return sqlite3ExprAnd(pParse->db, pExpr,
+      sqlite3PExpr(pParse, op, sqlite3ExprDup(pParse->db, pCol, 0), pReg));
+}
+
+/*
+** For a forward full scan of a local table that has zone maps, hint the
+** cursor with the WHERE terms that compare a zone map column with a
+** constant, so it can step over the ranges of rows they rule out (see
+** db/zonemap.c).  Only terms about this table alone are used.
+*/
+static void codeZonemapHint(
+  struct SrcList_item *pTabItem,  /* FROM clause item */
+  WhereInfo *pWInfo,    /* The where clause */
+  WhereLevel *pLevel,   /* Which loop to provide hints for */
+  int iLevel
+){
+  Parse *pParse = pWInfo->pParse;
+  Vdbe *v = pParse->pVdbe;
+  Table *pTab = pTabItem->pTab;
+  WhereClause *pWC = &pWInfo->sWC;
+  int iCur = pLevel->iTabCur;
+  Expr *pExpr = 0;
+  Bitmask msk;
+  int i;
+
+  if( OptimizationDisabled(pParse->db, SQLITE_CursorHints) ) return;
+  if( pWInfo->pTabList->a[iLevel].zDatabase!=0 ) return;
+  if( pTab==0 || IsVirtual(pTab) || pTab->pSelect ) return;
+  if( !zonemap_table_name(pTab->zName) ) return;
+
+  msk = sqlite3WhereGetMask(&pWInfo->sMaskSet, iCur);
+  for(i=0; i<pWC->nTerm; i++){
+    WhereTerm *pTerm = &pWC->a[i];
+    Expr *pE = pTerm->pExpr;
+    if( pTerm->prereqAll!=msk ) continue;
+    if( pTerm->wtFlags & TERM_VIRTUAL ) continue;
+    if( pTabItem->fg.jointype & JT_LEFT ){
+      /* only the ON clause of the LEFT JOIN filters this table's rows */
+      if( !ExprHasProperty(pE, EP_FromJoin)
+       || pE->iRightJoinTable!=pTabItem->iCursor
+      ){
+        continue;
+      }
+    }else if( ExprHasProperty(pE, EP_FromJoin) ){
+      continue;
+    }
+    switch( pE->op ){
+      case TK_LT: case TK_LE: case TK_GT: case TK_GE: case TK_EQ: {
+        Expr *pL = sqlite3ExprSkipCollate(pE->pLeft);
+        Expr *pR = sqlite3ExprSkipCollate(pE->pRight);
+        if( ExprHasProperty(pE->pLeft, EP_Collate)
+         || ExprHasProperty(pE->pRight, EP_Collate)
+        ){
+          break;
+        }
+        if( pL->op==TK_COLUMN ){
+          pExpr = zonemapHintTerm(pParse, pExpr, pTab, iCur, pE->op, pL, pR);
+        }else if( pR->op==TK_COLUMN ){
+          /* "c > x" for "x < c", and so on */
+          int op = pE->op==TK_LT ? TK_GT : pE->op==TK_GT ? TK_LT :
+                   pE->op==TK_LE ? TK_GE : pE->op==TK_GE ? TK_LE : TK_EQ;
+          pExpr = zonemapHintTerm(pParse, pExpr, pTab, iCur, op, pR, pL);
+        }
+        break;
+      }
+      case TK_BETWEEN: {
+        ExprList *pList = pE->x.pList;
+        if( pList==0 || pList->nExpr!=2 ) break;
+        if( ExprHasProperty(pE->pLeft, EP_Collate) ) break;
+        pExpr = zonemapHintTerm(pParse, pExpr, pTab, iCur, TK_GE, pE->pLeft,
+                                pList->a[0].pExpr);
+        pExpr = zonemapHintTerm(pParse, pExpr, pTab, iCur, TK_LE, pE->pLeft,
+                                pList->a[1].pExpr);
+        break;
+      }
+    }
+  }
+  if( pExpr!=0 ){
+    sqlite3VdbeAddOp4(v, OP_CursorHint, iCur, 0, 0, (const char*)pExpr,
+                      P4_EXPR);
+  }
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 #else
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 # define codeCursorHint(A,B,C,D,E)  /* No-op */
+# define codeZonemapHint(A,B,C,D)  /* No-op */
 #else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 # define codeCursorHint(A,B,C,D)  /* No-op */
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
@@ -1123,10 +1247,13 @@ static void codeDeferredSeek(
 
   pWInfo->bDeferredSeek = 1;
   sqlite3VdbeAddOp3(v, OP_DeferredSeek, iIdxCur, 0, iCur);
-  if( (pWInfo->wctrlFlags & WHERE_OR_SUBCLAUSE)
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
-   && DbMaskAllZero(sqlite3ParseToplevel(pParse)->writeMask, 0)
+  /* The table lookup is a data file fetch by genid; let every read-only
+  ** plan serve the columns the index holds (datacopy included) from the
+  ** index cursor, so the fetch happens only for columns it lacks. */
+  if( DbMaskAllZero(sqlite3ParseToplevel(pParse)->writeMask, 0)
 #else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+  if( (pWInfo->wctrlFlags & WHERE_OR_SUBCLAUSE)
    && DbMaskAllZero(sqlite3ParseToplevel(pParse)->writeMask)
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   ){
@@ -2256,6 +2383,7 @@ Bitmask sqlite3WhereCodeOneLoopStart(
     }else{
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
       codeCursorHint(pTabItem, pWInfo, pLevel, 0, iLevel);
+      if( bRev==0 ) codeZonemapHint(pTabItem, pWInfo, pLevel, iLevel);
 #else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
       codeCursorHint(pTabItem, pWInfo, pLevel, 0);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
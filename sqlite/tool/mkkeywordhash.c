@@ -407,6 +407,7 @@ static Keyword aKeywordTable[] = {
   { "VERSION",          "TK_VERSION",        ALWAYS               },
   { "WRITE",            "TK_WRITE",          ALWAYS               },
   { "ZLIB",             "TK_ZLIB",           ALWAYS               },
+  { "ZSTD",             "TK_ZSTD",           ALWAYS               },
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 };
 
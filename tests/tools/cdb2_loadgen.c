@@ -0,0 +1,574 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/* Multi-threaded load driver with fixed workload profiles.
+ *
+ * Run with --setup --load once to create and fill the tables, then with a
+ * profile.  With --rate, each thread issues its share of operations on a
+ * fixed schedule and latency is measured from when an operation was due, not
+ * from when it was sent, so a stall is charged to every operation it delayed
+ * (no coordinated omission).  Without --rate threads run closed-loop as fast
+ * as they can, and only service time is meaningful.
+ *
+ * The report has, for every operation type, the count, errors and latency
+ * percentiles in microseconds; --json writes the same as JSON. */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cdb2api.h>
+
+enum op { OP_READ, OP_UPDATE, OP_INSERT, OP_SCAN, OP_TRANSFER, OP_MAX };
+static const char *op_names[OP_MAX] = {"read", "update", "insert", "scan",
+                                       "transfer"};
+
+struct profile {
+    const char *name;
+    const char *desc;
+    int mix[OP_MAX]; /* percent of each operation */
+    int zipf;        /* zipfian instead of uniform keys */
+};
+
+static struct profile profiles[] = {
+    {"insert", "100% inserts of new keys", {0, 0, 100, 0, 0}, 0},
+    {"ycsb-a", "50% reads, 50% updates, zipfian", {50, 50, 0, 0, 0}, 1},
+    {"ycsb-b", "95% reads, 5% updates, zipfian", {95, 5, 0, 0, 0}, 1},
+    {"ycsb-c", "100% reads, zipfian", {100, 0, 0, 0, 0}, 1},
+    {"ycsb-e", "95% short scans, 5% inserts, zipfian", {0, 0, 5, 95, 0}, 1},
+    {"scan", "100% short scans, uniform", {0, 0, 0, 100, 0}, 0},
+    {"tpcc-lite", "90% transfers (2 updates + insert in one transaction), "
+                  "10% balance reads",
+     {10, 0, 0, 0, 90}, 0},
+    {"mixed", "60% reads, 20% updates, 10% inserts, 10% scans, uniform",
+     {60, 20, 10, 10, 0}, 0},
+};
+
+/* Latency histogram: exact below 64us, then 32 buckets per power of two
+ * (about 3% error) */
+#define HIST_SUB 5
+#define HIST_NBUCKETS ((40 - HIST_SUB) << HIST_SUB)
+
+struct hist {
+    int64_t count;
+    int64_t errors;
+    int64_t max;
+    double sum;
+    int64_t buckets[HIST_NBUCKETS];
+};
+
+static int hist_bucket(int64_t v)
+{
+    int b;
+    if (v < (2 << HIST_SUB))
+        return v < 0 ? 0 : v;
+    b = 63 - __builtin_clzll(v) - HIST_SUB; /* >= 1 */
+    v = (v >> b) - (1 << HIST_SUB);
+    b = ((b + 1) << HIST_SUB) + v;
+    return b < HIST_NBUCKETS ? b : HIST_NBUCKETS - 1;
+}
+
+static int64_t hist_bucket_high(int b)
+{
+    int shift;
+    if (b < (2 << HIST_SUB))
+        return b;
+    shift = (b >> HIST_SUB) - 1;
+    return ((int64_t)((b & ((1 << HIST_SUB) - 1)) + (1 << HIST_SUB) + 1)
+            << shift) - 1;
+}
+
+static void hist_add(struct hist *h, int64_t us)
+{
+    h->count++;
+    h->sum += us;
+    if (us > h->max)
+        h->max = us;
+    h->buckets[hist_bucket(us)]++;
+}
+
+static void hist_merge(struct hist *to, const struct hist *from)
+{
+    to->count += from->count;
+    to->errors += from->errors;
+    to->sum += from->sum;
+    if (from->max > to->max)
+        to->max = from->max;
+    for (int i = 0; i < HIST_NBUCKETS; i++)
+        to->buckets[i] += from->buckets[i];
+}
+
+static int64_t hist_pct(const struct hist *h, double pct)
+{
+    int64_t rank = ceil(h->count * pct / 100), seen = 0;
+    if (h->count == 0)
+        return 0;
+    for (int i = 0; i < HIST_NBUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank)
+            return hist_bucket_high(i) < h->max ? hist_bucket_high(i) : h->max;
+    }
+    return h->max;
+}
+
+/* YCSB's zipfian generator (Gray et al., "Quickly generating billion-record
+ * synthetic databases"), with the result scrambled so that hot keys are
+ * spread over the table */
+struct zipf {
+    int64_t n;
+    double theta, alpha, zetan, eta;
+};
+
+static double zeta(int64_t n, double theta)
+{
+    double sum = 0;
+    for (int64_t i = 1; i <= n; i++)
+        sum += 1 / pow(i, theta);
+    return sum;
+}
+
+static void zipf_init(struct zipf *z, int64_t n, double theta)
+{
+    z->n = n;
+    z->theta = theta;
+    z->alpha = 1 / (1 - theta);
+    z->zetan = zeta(n, theta);
+    z->eta = (1 - pow(2.0 / n, 1 - theta)) / (1 - zeta(2, theta) / z->zetan);
+}
+
+static int64_t zipf_next(const struct zipf *z, unsigned *seed)
+{
+    double u = (double)rand_r(seed) / RAND_MAX;
+    double uz = u * z->zetan;
+    int64_t v;
+    if (uz < 1)
+        v = 0;
+    else if (uz < 1 + pow(0.5, z->theta))
+        v = 1;
+    else
+        v = z->n * pow(z->eta * u - z->eta + 1, z->alpha);
+    return (int64_t)(((uint64_t)v * 0x9e3779b97f4a7c15ULL) % z->n);
+}
+
+static char *dbname;
+static char *tier = "default";
+static struct profile *profile;
+static int nthreads = 8;
+static int duration = 30;
+static int warmup = 5;
+static double rate;
+static int64_t nrecords = 100000;
+static int scanlen = 50;
+static unsigned seed0 = 1;
+static struct zipf zipf;
+static volatile int64_t next_insert;
+static volatile int stop;
+static double t_begin, t_measure;
+
+struct thread {
+    pthread_t tid;
+    int id;
+    unsigned seed;
+    struct hist lat[OP_MAX];     /* from when the op was due */
+    struct hist service[OP_MAX]; /* from when the op was sent */
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int run(cdb2_hndl_tp *h, const char *sql)
+{
+    int rc = cdb2_run_statement(h, sql);
+    if (rc == 0) {
+        while ((rc = cdb2_next_record(h)) == CDB2_OK)
+            ;
+        if (rc == CDB2_OK_DONE)
+            rc = 0;
+    }
+    cdb2_clearbindings(h);
+    return rc;
+}
+
+static int64_t pick_key(struct thread *t)
+{
+    if (profile->zipf)
+        return zipf_next(&zipf, &t->seed);
+    return rand_r(&t->seed) % nrecords;
+}
+
+static int do_op(cdb2_hndl_tp *h, struct thread *t, enum op op)
+{
+    int64_t k, k2, amt;
+    char v[101];
+    int rc;
+
+    switch (op) {
+    case OP_READ:
+        k = pick_key(t);
+        cdb2_bind_param(h, "k", CDB2_INTEGER, &k, sizeof(k));
+        if (profile->mix[OP_TRANSFER])
+            return run(h, "select bal from loadgen_acct where id = @k");
+        return run(h, "select v from loadgen_kv where k = @k");
+    case OP_UPDATE:
+        k = pick_key(t);
+        snprintf(v, sizeof(v), "%0100u", rand_r(&t->seed));
+        cdb2_bind_param(h, "k", CDB2_INTEGER, &k, sizeof(k));
+        cdb2_bind_param(h, "v", CDB2_CSTRING, v, strlen(v));
+        return run(h, "update loadgen_kv set v = @v where k = @k");
+    case OP_INSERT:
+        k = __atomic_fetch_add(&next_insert, 1, __ATOMIC_RELAXED);
+        snprintf(v, sizeof(v), "%0100u", rand_r(&t->seed));
+        cdb2_bind_param(h, "k", CDB2_INTEGER, &k, sizeof(k));
+        cdb2_bind_param(h, "v", CDB2_CSTRING, v, strlen(v));
+        return run(h, "insert into loadgen_kv(k, v) values(@k, @v)");
+    case OP_SCAN:
+        k = pick_key(t);
+        k2 = 1 + rand_r(&t->seed) % scanlen;
+        cdb2_bind_param(h, "k", CDB2_INTEGER, &k, sizeof(k));
+        cdb2_bind_param(h, "n", CDB2_INTEGER, &k2, sizeof(k2));
+        return run(h, "select k, v from loadgen_kv where k >= @k order by k "
+                      "limit @n");
+    case OP_TRANSFER:
+        k = pick_key(t);
+        k2 = pick_key(t);
+        amt = 1 + rand_r(&t->seed) % 100;
+        if ((rc = run(h, "begin")) != 0)
+            return rc;
+        cdb2_bind_param(h, "a", CDB2_INTEGER, &k, sizeof(k));
+        cdb2_bind_param(h, "amt", CDB2_INTEGER, &amt, sizeof(amt));
+        if ((rc = run(h, "update loadgen_acct set bal = bal - @amt where id "
+                         "= @a")) != 0)
+            goto abort;
+        cdb2_bind_param(h, "b", CDB2_INTEGER, &k2, sizeof(k2));
+        cdb2_bind_param(h, "amt", CDB2_INTEGER, &amt, sizeof(amt));
+        if ((rc = run(h, "update loadgen_acct set bal = bal + @amt where id "
+                         "= @b")) != 0)
+            goto abort;
+        cdb2_bind_param(h, "a", CDB2_INTEGER, &k, sizeof(k));
+        cdb2_bind_param(h, "b", CDB2_INTEGER, &k2, sizeof(k2));
+        cdb2_bind_param(h, "amt", CDB2_INTEGER, &amt, sizeof(amt));
+        if ((rc = run(h, "insert into loadgen_hist(src, dst, amt) "
+                         "values(@a, @b, @amt)")) != 0)
+            goto abort;
+        return run(h, "commit");
+    abort:
+        run(h, "rollback");
+        return rc;
+    default:
+        return -1;
+    }
+}
+
+static enum op pick_op(struct thread *t)
+{
+    int r = rand_r(&t->seed) % 100;
+    for (int op = 0; op < OP_MAX; op++) {
+        if (r < profile->mix[op])
+            return op;
+        r -= profile->mix[op];
+    }
+    return OP_READ;
+}
+
+static void *worker(void *arg)
+{
+    struct thread *t = arg;
+    cdb2_hndl_tp *h;
+    double interval = rate > 0 ? nthreads / rate : 0;
+    double due, start, end;
+    int64_t i;
+    enum op op;
+    int rc;
+
+    if ((rc = cdb2_open(&h, dbname, tier, CDB2_RANDOM)) != 0) {
+        fprintf(stderr, "thread %d: cdb2_open rc %d %s\n", t->id, rc,
+                cdb2_errstr(h));
+        return NULL;
+    }
+    /* stagger the threads' schedules across one interval */
+    due = t_begin + interval * t->id / nthreads;
+    for (i = 0; !stop; i++) {
+        if (interval > 0) {
+            due += interval;
+            start = now();
+            if (start < due) {
+                usleep((due - start) * 1e6);
+                start = now();
+            }
+        } else {
+            due = start = now();
+        }
+        op = pick_op(t);
+        rc = do_op(h, t, op);
+        end = now();
+        if (due < t_measure)
+            continue;
+        if (rc) {
+            t->lat[op].errors++;
+            continue;
+        }
+        hist_add(&t->lat[op], (end - due) * 1e6);
+        hist_add(&t->service[op], (end - start) * 1e6);
+    }
+    cdb2_close(h);
+    return NULL;
+}
+
+static int setup(cdb2_hndl_tp *h)
+{
+    static const char *ddl[] = {
+        "create table if not exists loadgen_kv(k int primary key, v cstring(101))",
+        "create table if not exists loadgen_acct(id int primary key, bal int)",
+        "create table if not exists loadgen_hist(src int, dst int, amt int)",
+    };
+    int rc;
+    for (int i = 0; i < sizeof(ddl) / sizeof(ddl[0]); i++) {
+        if ((rc = run(h, ddl[i])) != 0) {
+            fprintf(stderr, "%s: rc %d %s\n", ddl[i], rc, cdb2_errstr(h));
+            return rc;
+        }
+    }
+    return 0;
+}
+
+static int load(cdb2_hndl_tp *h)
+{
+    const int64_t batch = 10000;
+    int64_t lo, hi;
+    int rc;
+
+    if ((rc = run(h, "delete from loadgen_kv where 1")) != 0 ||
+        (rc = run(h, "delete from loadgen_acct where 1")) != 0 ||
+        (rc = run(h, "delete from loadgen_hist where 1")) != 0) {
+        fprintf(stderr, "truncate rc %d %s\n", rc, cdb2_errstr(h));
+        return rc;
+    }
+    for (lo = 0; lo < nrecords; lo += batch) {
+        hi = lo + batch - 1 < nrecords - 1 ? lo + batch - 1 : nrecords - 1;
+        cdb2_bind_param(h, "lo", CDB2_INTEGER, &lo, sizeof(lo));
+        cdb2_bind_param(h, "hi", CDB2_INTEGER, &hi, sizeof(hi));
+        if ((rc = run(h, "insert into loadgen_kv(k, v) select value, "
+                         "printf('%0100d', value) from "
+                         "generate_series(@lo, @hi)")) != 0)
+            break;
+        cdb2_bind_param(h, "lo", CDB2_INTEGER, &lo, sizeof(lo));
+        cdb2_bind_param(h, "hi", CDB2_INTEGER, &hi, sizeof(hi));
+        if ((rc = run(h, "insert into loadgen_acct(id, bal) select value, "
+                         "1000 from generate_series(@lo, @hi)")) != 0)
+            break;
+    }
+    if (rc)
+        fprintf(stderr, "load rc %d %s\n", rc, cdb2_errstr(h));
+    return rc;
+}
+
+static void report(FILE *f, struct hist *lat, struct hist *service,
+                   double elapsed, int json)
+{
+    int64_t total = 0;
+    int op, first = 1;
+
+    for (op = 0; op < OP_MAX; op++)
+        total += lat[op].count;
+
+    if (!json) {
+        fprintf(f, "profile %s, %d threads, %s %.0f/s, %.1fs measured\n",
+                profile->name, nthreads, rate > 0 ? "rate" : "closed loop",
+                rate > 0 ? rate : total / elapsed, elapsed);
+        fprintf(f, "%-9s %10s %7s %10s %8s %8s %8s %8s %8s %8s\n", "op",
+                "count", "errors", "ops/s", "mean", "p50", "p90", "p99",
+                "p99.9", "max");
+    } else {
+        fprintf(f, "{\"profile\":\"%s\",\"threads\":%d,\"rate\":%.0f,"
+                   "\"seconds\":%.1f,\"ops_per_sec\":%.1f,\"ops\":{",
+                profile->name, nthreads, rate, elapsed, total / elapsed);
+    }
+    for (op = 0; op < OP_MAX; op++) {
+        struct hist *h = rate > 0 ? &lat[op] : &service[op];
+        if (h->count == 0 && lat[op].errors == 0)
+            continue;
+        if (!json) {
+            fprintf(f,
+                    "%-9s %10" PRId64 " %7" PRId64 " %10.1f %8.0f %8" PRId64
+                    " %8" PRId64 " %8" PRId64 " %8" PRId64 " %8" PRId64 "\n",
+                    op_names[op], h->count, lat[op].errors,
+                    h->count / elapsed, h->count ? h->sum / h->count : 0,
+                    hist_pct(h, 50), hist_pct(h, 90), hist_pct(h, 99),
+                    hist_pct(h, 99.9), h->max);
+        } else {
+            fprintf(f,
+                    "%s\"%s\":{\"count\":%" PRId64 ",\"errors\":%" PRId64
+                    ",\"mean_us\":%.1f,\"p50_us\":%" PRId64
+                    ",\"p90_us\":%" PRId64 ",\"p99_us\":%" PRId64
+                    ",\"p999_us\":%" PRId64 ",\"max_us\":%" PRId64
+                    ",\"service_p99_us\":%" PRId64 "}",
+                    first ? "" : ",", op_names[op], h->count, lat[op].errors,
+                    h->count ? h->sum / h->count : 0, hist_pct(h, 50),
+                    hist_pct(h, 90), hist_pct(h, 99), hist_pct(h, 99.9),
+                    h->max, hist_pct(&service[op], 99));
+            first = 0;
+        }
+    }
+    if (json)
+        fprintf(f, "}}\n");
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s -d dbname [options]\n"
+            "  -d, --dbname NAME     database\n"
+            "  -T, --tier TIER       tier or host (default: default)\n"
+            "  -c, --cdb2cfg FILE    cdb2api config file (default: "
+            "$CDB2_CONFIG)\n"
+            "  -p, --profile NAME    workload profile (default: ycsb-b)\n"
+            "  -t, --threads N       client threads (default: 8)\n"
+            "  -s, --duration SECS   measured run time (default: 30)\n"
+            "  -w, --warmup SECS     unmeasured time before that (default: "
+            "5)\n"
+            "  -r, --rate OPS        total operations per second; 0 runs "
+            "closed-loop (default: 0)\n"
+            "  -n, --records N       keys in loadgen_kv and loadgen_acct "
+            "(default: 100000)\n"
+            "      --setup           create the tables\n"
+            "      --load            (re)fill the tables with --records "
+            "rows\n"
+            "  -j, --json FILE       also write the report as JSON\n"
+            "  -S, --seed N          random seed (default: 1)\n"
+            "profiles:\n",
+            argv0);
+    for (int i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+        fprintf(stderr, "  %-10s %s\n", profiles[i].name, profiles[i].desc);
+}
+
+int main(int argc, char *argv[])
+{
+    static struct option opts[] = {
+        {"dbname", required_argument, NULL, 'd'},
+        {"tier", required_argument, NULL, 'T'},
+        {"cdb2cfg", required_argument, NULL, 'c'},
+        {"profile", required_argument, NULL, 'p'},
+        {"threads", required_argument, NULL, 't'},
+        {"duration", required_argument, NULL, 's'},
+        {"warmup", required_argument, NULL, 'w'},
+        {"rate", required_argument, NULL, 'r'},
+        {"records", required_argument, NULL, 'n'},
+        {"setup", no_argument, NULL, 'U'},
+        {"load", no_argument, NULL, 'L'},
+        {"json", required_argument, NULL, 'j'},
+        {"seed", required_argument, NULL, 'S'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}};
+    char *conf = getenv("CDB2_CONFIG"), *jsonfile = NULL;
+    const char *pname = "ycsb-b";
+    int c, i, rc, do_setup = 0, do_load = 0;
+    struct thread *threads;
+    struct hist lat[OP_MAX] = {{0}}, service[OP_MAX] = {{0}};
+    cdb2_hndl_tp *h;
+    double elapsed;
+
+    while ((c = getopt_long(argc, argv, "d:T:c:p:t:s:w:r:n:j:S:h", opts,
+                            NULL)) != -1) {
+        switch (c) {
+        case 'd': dbname = optarg; break;
+        case 'T': tier = optarg; break;
+        case 'c': conf = optarg; break;
+        case 'p': pname = optarg; break;
+        case 't': nthreads = atoi(optarg); break;
+        case 's': duration = atoi(optarg); break;
+        case 'w': warmup = atoi(optarg); break;
+        case 'r': rate = atof(optarg); break;
+        case 'n': nrecords = atoll(optarg); break;
+        case 'U': do_setup = 1; break;
+        case 'L': do_load = 1; break;
+        case 'j': jsonfile = optarg; break;
+        case 'S': seed0 = atoi(optarg); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    for (i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++) {
+        if (strcmp(profiles[i].name, pname) == 0)
+            profile = &profiles[i];
+    }
+    if (dbname == NULL || profile == NULL || nthreads <= 0 || nrecords <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (conf)
+        cdb2_set_comdb2db_config(conf);
+
+    if (do_setup || do_load) {
+        if ((rc = cdb2_open(&h, dbname, tier, 0)) != 0) {
+            fprintf(stderr, "cdb2_open rc %d %s\n", rc, cdb2_errstr(h));
+            return 1;
+        }
+        rc = (do_setup && setup(h)) || (do_load && load(h));
+        cdb2_close(h);
+        if (rc)
+            return 1;
+        if (duration <= 0)
+            return 0;
+    }
+
+    if (profile->zipf)
+        zipf_init(&zipf, nrecords, 0.99);
+    /* new keys go above the loaded ones, and above any a previous run
+     * inserted */
+    next_insert = nrecords + ((int64_t)time(NULL) % 100000) * 1000000;
+
+    threads = calloc(nthreads, sizeof(struct thread));
+    t_begin = now();
+    t_measure = t_begin + warmup;
+    for (i = 0; i < nthreads; i++) {
+        threads[i].id = i;
+        threads[i].seed = seed0 * 7919 + i;
+        pthread_create(&threads[i].tid, NULL, worker, &threads[i]);
+    }
+    sleep(warmup + duration);
+    stop = 1;
+    elapsed = now() - t_measure;
+    for (i = 0; i < nthreads; i++) {
+        pthread_join(threads[i].tid, NULL);
+        for (int op = 0; op < OP_MAX; op++) {
+            hist_merge(&lat[op], &threads[i].lat[op]);
+            hist_merge(&service[op], &threads[i].service[op]);
+        }
+    }
+    free(threads);
+
+    report(stdout, lat, service, elapsed, 0);
+    if (jsonfile) {
+        FILE *f = fopen(jsonfile, "w");
+        if (f == NULL) {
+            perror(jsonfile);
+            return 1;
+        }
+        report(f, lat, service, elapsed, 1);
+        fclose(f);
+    }
+    return 0;
+}
@@ -480,6 +480,55 @@ void test_bind_array2()
     test_close(hndl);
 }
 
+void test_bulk_insert()
+{
+    cdb2_hndl_tp *hndl = NULL;
+    test_open(&hndl, db);
+
+    test_exec(hndl, "drop table if exists t4");
+    test_exec(hndl, "create table t4 (a int, b double, c cstring(16))");
+
+    /* more than one batch */
+    int N = 40000;
+    int64_t *a = malloc(N * sizeof(int64_t));
+    double *b = malloc(N * sizeof(double));
+    char **c = malloc(N * sizeof(char *));
+    char *buf = malloc(N * 16);
+    for (int i = 0; i < N; i++) {
+        a[i] = i;
+        b[i] = i / 2.0;
+        c[i] = buf + i * 16;
+        sprintf(c[i], "row%d", i);
+    }
+    const char *columns[] = {"a", "b", "c"};
+    int types[] = {CDB2_INTEGER, CDB2_REAL, CDB2_CSTRING};
+    const void *values[] = {a, b, c};
+    int typelens[] = {sizeof(int64_t), sizeof(double), 0};
+    int rc = cdb2_bulk_insert(hndl, "t4", 3, columns, types, values, typelens, N);
+    if (rc != 0) {
+        fprintf(stderr, "%s:%d:error rc:%d err:%s\n", __func__, __LINE__, rc, cdb2_errstr(hndl));
+        exit(1);
+    }
+
+    test_exec(hndl, "select a, b, c from t4 order by a");
+    for (int i = 0; i < N; i++) {
+        test_next_record(hndl);
+        int64_t *vala = cdb2_column_value(hndl, 0);
+        double *valb = cdb2_column_value(hndl, 1);
+        char *valc = cdb2_column_value(hndl, 2);
+        if (*vala != a[i] || *valb != b[i] || strcmp(valc, c[i]) != 0) {
+            fprintf(stderr, "%s:%d:error got:%"PRId64" %f %s expected:%"PRId64"\n", __func__, __LINE__, *vala, *valb, valc, a[i]);
+            exit(1);
+        }
+    }
+
+    free(a);
+    free(b);
+    free(c);
+    free(buf);
+    test_close(hndl);
+}
+
 
 int main(int argc, char *argv[])
 {
@@ -491,6 +540,7 @@ int main(int argc, char *argv[])
     test_04();
     test_bind_array();
     test_bind_array2();
+    test_bulk_insert();
 
     return 0;
 }
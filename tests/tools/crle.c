@@ -331,11 +331,37 @@ static void test_repeat_rev()
     fprintf(stderr, "passed %s\n", __func__);
 }
 
+/* repeats() against a chunk at a time reference, for runs ending at
+ * every offset so that each vector/word/byte tail gets exercised */
+static void test_repeat_long()
+{
+    uint8_t buf[N];
+    for (unsigned s = 0; s < CNT(sizes); ++s) {
+        uint32_t sz = sizes[s];
+        for (unsigned len = sz * 2; len <= N; len += 7) {
+            for (unsigned i = 0; i < len; ++i)
+                buf[i] = i % sz;
+            buf[len - 1 - (len % 13) % len] = 0xff;
+            Data d = {.dt = buf, .sz = len};
+            uint32_t r, expected = 0;
+            repeats(d, sz, &r);
+            for (unsigned k = 1; (k + 1) * sz <= len; ++k) {
+                if (memcmp(buf, buf + k * sz, sz))
+                    break;
+                ++expected;
+            }
+            assert(r == expected);
+        }
+    }
+    fprintf(stderr, "passed %s\n", __func__);
+}
+
 int main(int argc, char *argv[])
 {
     test_varint();
     test_repeat();
     test_repeat_rev();
+    test_repeat_long();
     test_well_known();
     test_encode_prev();
     test_encode_repeat();
@@ -0,0 +1,118 @@
+/*
+   Copyright 2020 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/* Micro-benchmark for comdb2rle: compresses and decompresses record-shaped
+ * buffers (null/zero padded ints, runs of spaces, random bytes) and prints
+ * throughput plus a checksum of the compressed output, so that builds with
+ * and without vector support can be compared for identical output.
+ *
+ * usage: crle_bench [record size] [iterations] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#undef NDEBUG
+#include <assert.h>
+#include <comdb2rle.h>
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void make_record(uint8_t *buf, size_t sz, unsigned seed)
+{
+    size_t i = 0;
+    srand(seed);
+    while (i < sz) {
+        size_t n = 1 + rand() % 64;
+        if (n > sz - i)
+            n = sz - i;
+        switch (rand() % 5) {
+        case 0: memset(buf + i, 0x00, n); break; /* nulls */
+        case 1: buf[i] = 0x08; memset(buf + i + 1, 0x00, n - 1); buf[i + 1] = 0x80; break;
+        case 2: memset(buf + i, ' ', n); break; /* padded cstring */
+        case 3: memset(buf + i, 0xff, n); break;
+        default:
+            for (size_t j = 0; j < n; ++j)
+                buf[i + j] = rand();
+            break;
+        }
+        i += n;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t sz = argc > 1 ? atoi(argv[1]) : 512;
+    int iter = argc > 2 ? atoi(argv[2]) : 100000;
+    int nrec = 64;
+    uint8_t *in = malloc(sz * nrec);
+    uint8_t *out = malloc(sz * 2 + 64);
+    uint8_t *chk = malloc(sz);
+    size_t *outsz = malloc(sizeof(size_t) * nrec);
+    uint8_t **comp = malloc(sizeof(uint8_t *) * nrec);
+    unsigned long long sum = 0;
+
+    for (int r = 0; r < nrec; ++r) {
+        make_record(in + r * sz, sz, r);
+        Comdb2RLE c = {.in = in + r * sz, .insz = sz, .out = out, .outsz = sz * 2 + 64};
+        assert(compressComdb2RLE(&c) == 0);
+        outsz[r] = c.outsz;
+        comp[r] = malloc(c.outsz);
+        memcpy(comp[r], out, c.outsz);
+        for (size_t j = 0; j < c.outsz; ++j)
+            sum = sum * 31 + out[j];
+
+        Comdb2RLE d = {.in = comp[r], .insz = outsz[r], .out = chk, .outsz = sz};
+        assert(decompressComdb2RLE(&d) == 0);
+        assert(d.outsz == sz && memcmp(chk, in + r * sz, sz) == 0);
+    }
+
+    double start = now();
+    for (int i = 0; i < iter; ++i) {
+        int r = i % nrec;
+        Comdb2RLE c = {.in = in + r * sz, .insz = sz, .out = out, .outsz = sz * 2 + 64};
+        compressComdb2RLE(&c);
+    }
+    double comp_secs = now() - start;
+
+    start = now();
+    for (int i = 0; i < iter; ++i) {
+        int r = i % nrec;
+        Comdb2RLE d = {.in = comp[r], .insz = outsz[r], .out = chk, .outsz = sz};
+        decompressComdb2RLE(&d);
+    }
+    double decomp_secs = now() - start;
+
+    double mb = (double)sz * iter / (1024 * 1024);
+    printf("record size %zu, %d iterations, checksum %llx\n", sz, iter, sum);
+    printf("compress:   %8.1f MB/s\n", mb / comp_secs);
+    printf("decompress: %8.1f MB/s\n", mb / decomp_secs);
+
+    for (int r = 0; r < nrec; ++r)
+        free(comp[r]);
+    free(comp);
+    free(outsz);
+    free(chk);
+    free(out);
+    free(in);
+    return EXIT_SUCCESS;
+}
@@ -420,6 +420,49 @@ static void test_o(void)
     cson_output_FILE(arr_val, stdout);
     cson_value_free(arr_val);
 }
+static int write_FILE(void *f, const void *src, unsigned int n)
+{
+    return fwrite(src, n, 1, f) != 1;
+}
+static void test_p(void)
+{
+    puts(__func__);
+    cson_value *arr_val = cson_value_new_array();
+    cson_array *arr = cson_value_get_array(arr_val);
+    cson_array_append(arr, cson_value_new_integer(1));
+    cson_array_append(arr, cson_value_new_string("two", 3));
+
+    cson_writer *w = cson_writer_new();
+    for (int i = 0; i < 2; ++i) {
+        cson_writer_reset(w);
+        cson_writer_object_begin(w, NULL);
+        cson_writer_int(w, "time", 42 + i);
+        cson_writer_string(w, "sql", "select \"hi\"\n", 12);
+        cson_writer_double(w, "cost", 42.24);
+        cson_writer_bool(w, "victim", 1);
+        cson_writer_null(w, "nothing");
+        cson_writer_array_begin(w, "tables");
+        cson_writer_string(w, NULL, "t1", 2);
+        cson_writer_object_begin(w, NULL);
+        cson_writer_object_end(w);
+        cson_writer_array_end(w);
+        cson_writer_value(w, "bound_parameters", arr_val);
+        cson_writer_object_end(w);
+        cson_writer_output(w, write_FILE, stdout);
+    }
+    cson_buffer buf;
+    cson_writer_output_buffer(w, &buf);
+    cson_value *val;
+    if (cson_parse_string(&val, buf.mem, buf.used) == 0) {
+        cson_output_FILE(val, stdout);
+        cson_value_free(val);
+    }
+    cson_writer_object_begin(w, "unterminated");
+    if (cson_writer_output(w, write_FILE, stdout) == 0)
+        puts("unterminated document written");
+    cson_writer_free(w);
+    cson_value_free(arr_val);
+}
 int main()
 {
     puts(__func__);
@@ -438,5 +481,6 @@ int main()
     test_m();
     test_n();
     test_o();
+    test_p();
     return 0;
 }
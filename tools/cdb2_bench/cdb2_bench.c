@@ -0,0 +1,781 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * cdb2_bench: microbenchmarks of hot-path primitives.
+ *
+ * Every benchmark is run with a growing number of operations until a run
+ * takes at least the target time, and reported as one JSON object per line:
+ *
+ *   {"name":"crc32c","arg":"4096","ops":..,"ns_per_op":..,"mb_per_sec":..}
+ *
+ * mb_per_sec is only present for benchmarks that process bytes.  The output
+ * of two builds can be joined on name and arg to compare them.
+ *
+ * usage: cdb2_bench [-t ms] [-d tmpdir] [-l] [name ...]
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bdb_int.h"
+#include "comdb2rle.h"
+#include "crc32c.h"
+#include "plhash.h"
+#include "sbuf2.h"
+#include "thdpool.h"
+#include "types.h"
+#include "logmsg.h"
+
+extern int comdb2ma_init(size_t init_sz, size_t max_cap);
+
+struct bench {
+    const char *name;
+    const char *arg;
+    size_t bytes_per_op; /* 0 if the benchmark doesn't process bytes */
+    int (*setup)(struct bench *b);
+    /* run n operations; returns non-zero on error */
+    int (*run)(struct bench *b, int64_t n);
+    void (*teardown)(struct bench *b);
+    int iarg;
+    void *state;
+};
+
+static const char *tmpdir = "/tmp";
+static volatile uint64_t sink; /* keeps results live */
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Record-shaped buffer: runs of nulls, packed ints, padded strings, random
+ * bytes */
+static void make_record(uint8_t *buf, size_t sz, unsigned seed)
+{
+    size_t i = 0, n, j;
+    srand(seed);
+    while (i < sz) {
+        n = 1 + rand() % 32;
+        if (n > sz - i)
+            n = sz - i;
+        switch (rand() % 4) {
+        case 0:
+            memset(buf + i, 0, n);
+            break;
+        case 1:
+            buf[i] = 0x08;
+            memset(buf + i + 1, 0, n - 1);
+            break;
+        case 2:
+            memset(buf + i, ' ', n);
+            break;
+        default:
+            for (j = 0; j < n; j++)
+                buf[i + j] = rand();
+            break;
+        }
+        i += n;
+    }
+}
+
+/* crc32c */
+
+static int crc_setup(struct bench *b)
+{
+    if ((b->state = malloc(b->iarg)) == NULL)
+        return ENOMEM;
+    make_record(b->state, b->iarg, 1);
+    b->bytes_per_op = b->iarg;
+    return 0;
+}
+
+static int crc_run(struct bench *b, int64_t n)
+{
+    uint32_t c = 0;
+    for (int64_t i = 0; i < n; i++)
+        c ^= crc32c(b->state, b->iarg);
+    sink += c;
+    return 0;
+}
+
+static void free_state(struct bench *b)
+{
+    free(b->state);
+    b->state = NULL;
+}
+
+/* comdb2rle */
+
+struct rle_state {
+    uint8_t *in;
+    uint8_t *out;
+    uint8_t *back;
+    size_t outsz;
+};
+
+static int rle_setup(struct bench *b)
+{
+    struct rle_state *s = calloc(1, sizeof(*s));
+    if (s == NULL)
+        return ENOMEM;
+    b->state = s;
+    s->in = malloc(b->iarg);
+    s->out = malloc(b->iarg * 2 + 64);
+    s->back = malloc(b->iarg);
+    if (!s->in || !s->out || !s->back)
+        return ENOMEM;
+    make_record(s->in, b->iarg, 2);
+    Comdb2RLE c = {.in = s->in, .insz = b->iarg, .out = s->out,
+                   .outsz = b->iarg * 2 + 64};
+    if (compressComdb2RLE(&c))
+        return EINVAL;
+    s->outsz = c.outsz;
+    b->bytes_per_op = b->iarg;
+    return 0;
+}
+
+static int rle_compress_run(struct bench *b, int64_t n)
+{
+    struct rle_state *s = b->state;
+    for (int64_t i = 0; i < n; i++) {
+        Comdb2RLE c = {.in = s->in, .insz = b->iarg, .out = s->out,
+                       .outsz = b->iarg * 2 + 64};
+        if (compressComdb2RLE(&c))
+            return -1;
+        sink += c.outsz;
+    }
+    return 0;
+}
+
+static int rle_decompress_run(struct bench *b, int64_t n)
+{
+    struct rle_state *s = b->state;
+    for (int64_t i = 0; i < n; i++) {
+        Comdb2RLE c = {.in = s->out, .insz = s->outsz, .out = s->back,
+                       .outsz = b->iarg};
+        if (decompressComdb2RLE(&c))
+            return -1;
+        sink += c.outsz;
+    }
+    return 0;
+}
+
+static void rle_teardown(struct bench *b)
+{
+    struct rle_state *s = b->state;
+    if (s) {
+        free(s->in);
+        free(s->out);
+        free(s->back);
+    }
+    free_state(b);
+}
+
+/* ODH pack/unpack, with a stand-in for the table's bdb_state */
+
+struct odh_state {
+    bdb_state_type bdb_state;
+    uint8_t *rec;
+    uint8_t *packed;
+    uint8_t *unpacked;
+    uint32_t packedsz;
+};
+
+static int odh_setup(struct bench *b)
+{
+    struct odh_state *s = calloc(1, sizeof(*s));
+    struct odh odh;
+    void *recptr, *freeptr;
+    if (s == NULL)
+        return ENOMEM;
+    b->state = s;
+    s->bdb_state.ondisk_header = 1;
+    s->bdb_state.compress = b->iarg;
+    s->bdb_state.bmaszthresh = ~0U;
+    s->bdb_state.name = "bench";
+    if ((s->bdb_state.attr = bdb_attr_create()) == NULL)
+        return ENOMEM;
+    s->rec = malloc(512);
+    s->packed = malloc(512 + ODH_SIZE_RESERVE);
+    s->unpacked = malloc(512);
+    if (!s->rec || !s->packed || !s->unpacked)
+        return ENOMEM;
+    make_record(s->rec, 512, 3);
+    init_odh(&s->bdb_state, &odh, s->rec, 512, 0);
+    if (bdb_pack(&s->bdb_state, &odh, s->packed, 512 + ODH_SIZE_RESERVE,
+                 &recptr, &s->packedsz, &freeptr, -1))
+        return EINVAL;
+    if (recptr != s->packed)
+        memmove(s->packed, recptr, s->packedsz);
+    b->bytes_per_op = 512;
+    return 0;
+}
+
+static int odh_pack_run(struct bench *b, int64_t n)
+{
+    struct odh_state *s = b->state;
+    struct odh odh;
+    void *recptr, *freeptr;
+    uint32_t sz;
+    for (int64_t i = 0; i < n; i++) {
+        init_odh(&s->bdb_state, &odh, s->rec, 512, 0);
+        if (bdb_pack(&s->bdb_state, &odh, s->packed, 512 + ODH_SIZE_RESERVE,
+                     &recptr, &sz, &freeptr, -1))
+            return -1;
+        sink += sz;
+    }
+    return 0;
+}
+
+static int odh_unpack_run(struct bench *b, int64_t n)
+{
+    struct odh_state *s = b->state;
+    struct odh odh;
+    void *freeptr;
+    for (int64_t i = 0; i < n; i++) {
+        if (bdb_unpack(&s->bdb_state, s->packed, s->packedsz, s->unpacked, 512,
+                       &odh, &freeptr))
+            return -1;
+        sink += odh.length;
+    }
+    return 0;
+}
+
+static void odh_teardown(struct bench *b)
+{
+    struct odh_state *s = b->state;
+    if (s) {
+        free(s->bdb_state.attr);
+        free(s->rec);
+        free(s->packed);
+        free(s->unpacked);
+    }
+    free_state(b);
+}
+
+/* db/types.c conversions, client to server and back */
+
+static int types_int_run(struct bench *b, int64_t n)
+{
+    uint8_t server[9];
+    long long in, out;
+    int outdtsz, outnull;
+    for (int64_t i = 0; i < n; i++) {
+        in = i;
+        if (CLIENT_to_SERVER(&in, sizeof(in), CLIENT_INT, 0, NULL, NULL,
+                             server, sizeof(server), SERVER_BINT, 0, &outdtsz,
+                             NULL, NULL))
+            return -1;
+        if (SERVER_to_CLIENT(server, sizeof(server), SERVER_BINT, NULL, NULL,
+                             0, &out, sizeof(out), CLIENT_INT, &outnull,
+                             &outdtsz, NULL, NULL))
+            return -1;
+        sink += out;
+    }
+    return 0;
+}
+
+static int types_cstr_run(struct bench *b, int64_t n)
+{
+    char in[32] = "the quick brown fox", out[32];
+    uint8_t server[33];
+    int outdtsz, outnull;
+    for (int64_t i = 0; i < n; i++) {
+        if (CLIENT_to_SERVER(in, sizeof(in), CLIENT_CSTR, 0, NULL, NULL,
+                             server, sizeof(server), SERVER_BCSTR, 0, &outdtsz,
+                             NULL, NULL))
+            return -1;
+        if (SERVER_to_CLIENT(server, sizeof(server), SERVER_BCSTR, NULL, NULL,
+                             0, out, sizeof(out), CLIENT_CSTR, &outnull,
+                             &outdtsz, NULL, NULL))
+            return -1;
+        sink += out[0];
+    }
+    return 0;
+}
+
+static int types_real_run(struct bench *b, int64_t n)
+{
+    uint8_t server[9];
+    double in, out;
+    int outdtsz, outnull;
+    for (int64_t i = 0; i < n; i++) {
+        in = i * 1.5;
+        if (CLIENT_to_SERVER(&in, sizeof(in), CLIENT_REAL, 0, NULL, NULL,
+                             server, sizeof(server), SERVER_BREAL, 0, &outdtsz,
+                             NULL, NULL))
+            return -1;
+        if (SERVER_to_CLIENT(server, sizeof(server), SERVER_BREAL, NULL, NULL,
+                             0, &out, sizeof(out), CLIENT_REAL, &outnull,
+                             &outdtsz, NULL, NULL))
+            return -1;
+        sink += (uint64_t)out;
+    }
+    return 0;
+}
+
+/* Temp table btree (what bdb_temp_table_create sets up), and btree search */
+
+#define BT_NKEYS 100000
+
+struct bt_state {
+    DB_ENV *dbenv;
+    DB *db;
+};
+
+static void bt_key(uint8_t *key, int64_t i)
+{
+    /* scattered, so that inserts land all over the tree */
+    uint64_t k = (uint64_t)i * 2654435761ULL;
+    for (int j = 7; j >= 0; j--, k >>= 8)
+        key[j] = k & 0xff;
+}
+
+static int bt_open(struct bench *b)
+{
+    struct bt_state *s = calloc(1, sizeof(*s));
+    int rc;
+    if (s == NULL)
+        return ENOMEM;
+    b->state = s;
+    if ((rc = db_env_create(&s->dbenv, 0)) != 0)
+        return rc;
+    s->dbenv->set_is_tmp_tbl(s->dbenv, 1);
+    s->dbenv->set_tmp_dir(s->dbenv, tmpdir);
+    s->dbenv->set_cachesize(s->dbenv, 0, 64 * 1024 * 1024, 1);
+    if ((rc = s->dbenv->open(s->dbenv, tmpdir,
+                             DB_INIT_MPOOL | DB_CREATE | DB_PRIVATE, 0666)))
+        return rc;
+    if ((rc = db_create(&s->db, s->dbenv, 0)) != 0)
+        return rc;
+    s->db->set_pagesize(s->db, 65536);
+    return s->db->open(s->db, NULL, NULL, NULL, DB_BTREE,
+                       DB_CREATE | DB_TRUNCATE | DB_TEMPTABLE, 0666);
+}
+
+static int bt_put(struct bt_state *s, int64_t i)
+{
+    uint8_t key[8], data[64];
+    DBT k = {0}, d = {0};
+    bt_key(key, i);
+    memset(data, i, sizeof(data));
+    k.data = key;
+    k.size = sizeof(key);
+    d.data = data;
+    d.size = sizeof(data);
+    return s->db->put(s->db, NULL, &k, &d, 0);
+}
+
+static int bt_setup_filled(struct bench *b)
+{
+    int rc = bt_open(b);
+    for (int64_t i = 0; rc == 0 && i < BT_NKEYS; i++)
+        rc = bt_put(b->state, i);
+    return rc;
+}
+
+static int temptable_insert_run(struct bench *b, int64_t n)
+{
+    static int64_t next;
+    for (int64_t i = 0; i < n; i++) {
+        if (bt_put(b->state, next++))
+            return -1;
+    }
+    return 0;
+}
+
+static int temptable_scan_run(struct bench *b, int64_t n)
+{
+    struct bt_state *s = b->state;
+    DBC *c;
+    DBT k = {0}, d = {0};
+    int rc = 0;
+    if (s->db->cursor(s->db, NULL, &c, 0))
+        return -1;
+    for (int64_t i = 0; i < n; i++) {
+        rc = c->c_get(c, &k, &d, DB_NEXT);
+        if (rc == DB_NOTFOUND)
+            rc = c->c_get(c, &k, &d, DB_FIRST);
+        if (rc)
+            break;
+        sink += d.size;
+    }
+    c->c_close(c);
+    return rc;
+}
+
+static int btree_search_run(struct bench *b, int64_t n)
+{
+    struct bt_state *s = b->state;
+    uint8_t key[8];
+    DBT k = {0}, d = {0};
+    unsigned seed = 4;
+    k.data = key;
+    k.size = sizeof(key);
+    for (int64_t i = 0; i < n; i++) {
+        bt_key(key, rand_r(&seed) % BT_NKEYS);
+        if (s->db->get(s->db, NULL, &k, &d, 0))
+            return -1;
+        sink += d.size;
+    }
+    return 0;
+}
+
+static void bt_teardown(struct bench *b)
+{
+    struct bt_state *s = b->state;
+    if (s) {
+        if (s->db)
+            s->db->close(s->db, DB_NOSYNC);
+        if (s->dbenv)
+            s->dbenv->close(s->dbenv, 0);
+    }
+    free_state(b);
+}
+
+/* plhash lookups, chained and flat */
+
+struct hash_ent {
+    uint64_t key;
+    uint64_t val;
+};
+
+#define HASH_NKEYS 100000
+
+struct hash_state {
+    hash_t *h;
+    struct hash_ent *ents;
+};
+
+static int hash_setup(struct bench *b)
+{
+    struct hash_state *s = calloc(1, sizeof(*s));
+    if (s == NULL)
+        return ENOMEM;
+    b->state = s;
+    s->h = b->iarg ? hash_init_flat_o(0, sizeof(uint64_t))
+                   : hash_init_o(0, sizeof(uint64_t));
+    s->ents = calloc(HASH_NKEYS, sizeof(struct hash_ent));
+    if (!s->h || !s->ents)
+        return ENOMEM;
+    for (int i = 0; i < HASH_NKEYS; i++) {
+        s->ents[i].key = (uint64_t)i * 0x9e3779b97f4a7c15ULL;
+        hash_add(s->h, &s->ents[i]);
+    }
+    return 0;
+}
+
+static int hash_find_run(struct bench *b, int64_t n)
+{
+    struct hash_state *s = b->state;
+    struct hash_ent *e;
+    uint64_t key;
+    for (int64_t i = 0; i < n; i++) {
+        key = (uint64_t)(i % HASH_NKEYS) * 0x9e3779b97f4a7c15ULL;
+        if ((e = hash_find(s->h, &key)) == NULL)
+            return -1;
+        sink += e->val;
+    }
+    return 0;
+}
+
+static void hash_teardown(struct bench *b)
+{
+    struct hash_state *s = b->state;
+    if (s) {
+        if (s->h)
+            hash_free(s->h);
+        free(s->ents);
+    }
+    free_state(b);
+}
+
+/* thdpool enqueue to completion */
+
+struct pool_state {
+    struct thdpool *pool;
+    pthread_mutex_t lk;
+    pthread_cond_t cd;
+    int64_t done;
+};
+
+static void pool_work(struct thdpool *pool, void *work, void *thddata, int op)
+{
+    struct pool_state *s = work;
+    pthread_mutex_lock(&s->lk);
+    s->done++;
+    pthread_cond_signal(&s->cd);
+    pthread_mutex_unlock(&s->lk);
+}
+
+static int pool_setup(struct bench *b)
+{
+    struct pool_state *s = calloc(1, sizeof(*s));
+    if (s == NULL)
+        return ENOMEM;
+    b->state = s;
+    pthread_mutex_init(&s->lk, NULL);
+    pthread_cond_init(&s->cd, NULL);
+    if ((s->pool = thdpool_create("bench", 0)) == NULL)
+        return ENOMEM;
+    thdpool_set_minthds(s->pool, b->iarg);
+    thdpool_set_maxthds(s->pool, b->iarg);
+    thdpool_set_maxqueue(s->pool, 100000);
+    thdpool_set_linger(s->pool, 30);
+    return 0;
+}
+
+static int pool_run(struct bench *b, int64_t n)
+{
+    struct pool_state *s = b->state;
+    s->done = 0;
+    for (int64_t i = 0; i < n; i++) {
+        if (thdpool_enqueue(s->pool, pool_work, s, 0, NULL, 0))
+            return -1;
+    }
+    pthread_mutex_lock(&s->lk);
+    while (s->done < n)
+        pthread_cond_wait(&s->cd, &s->lk);
+    pthread_mutex_unlock(&s->lk);
+    return 0;
+}
+
+static void pool_teardown(struct bench *b)
+{
+    struct pool_state *s = b->state;
+    if (s && s->pool)
+        thdpool_destroy(&s->pool, 0);
+    free_state(b);
+}
+
+/* sbuf2 buffered reads and writes of small records, against in-memory
+ * read/write functions so that no system calls are measured */
+
+static char sb_src[65536];
+
+static int sb_nullwrite(SBUF2 *sb, const char *buf, int nbytes)
+{
+    return nbytes;
+}
+
+static int sb_memread(SBUF2 *sb, char *buf, int nbytes)
+{
+    if (nbytes > sizeof(sb_src))
+        nbytes = sizeof(sb_src);
+    memcpy(buf, sb_src, nbytes);
+    return nbytes;
+}
+
+static int sb_setup(struct bench *b)
+{
+    /* the fd is only there to satisfy sbuf2open; it is never used */
+    int fd = open("/dev/null", O_RDWR);
+    SBUF2 *sb;
+    if (fd < 0)
+        return errno;
+    if ((sb = sbuf2open(fd, 0)) == NULL) {
+        close(fd);
+        return ENOMEM;
+    }
+    sbuf2setrw(sb, sb_memread, sb_nullwrite);
+    b->state = sb;
+    b->bytes_per_op = b->iarg;
+    return 0;
+}
+
+static int sb_write_run(struct bench *b, int64_t n)
+{
+    char rec[256] = {0};
+    for (int64_t i = 0; i < n; i++) {
+        if (sbuf2write(rec, b->iarg, b->state) != b->iarg)
+            return -1;
+    }
+    return sbuf2flush(b->state) < 0;
+}
+
+static int sb_read_run(struct bench *b, int64_t n)
+{
+    char rec[256];
+    for (int64_t i = 0; i < n; i++) {
+        if (sbuf2fread(rec, b->iarg, 1, b->state) != 1)
+            return -1;
+        sink += rec[0];
+    }
+    return 0;
+}
+
+static void sb_teardown(struct bench *b)
+{
+    if (b->state)
+        sbuf2close(b->state);
+    b->state = NULL;
+}
+
+static struct bench benches[] = {
+    {"crc32c", "64", 0, crc_setup, crc_run, free_state, 64},
+    {"crc32c", "4096", 0, crc_setup, crc_run, free_state, 4096},
+    {"crc32c", "65536", 0, crc_setup, crc_run, free_state, 65536},
+    {"comdb2rle_compress", "512", 0, rle_setup, rle_compress_run,
+     rle_teardown, 512},
+    {"comdb2rle_decompress", "512", 0, rle_setup, rle_decompress_run,
+     rle_teardown, 512},
+    {"odh_pack", "none", 0, odh_setup, odh_pack_run, odh_teardown,
+     BDB_COMPRESS_NONE},
+    {"odh_pack", "crle", 0, odh_setup, odh_pack_run, odh_teardown,
+     BDB_COMPRESS_CRLE},
+    {"odh_pack", "lz4", 0, odh_setup, odh_pack_run, odh_teardown,
+     BDB_COMPRESS_LZ4},
+    {"odh_unpack", "none", 0, odh_setup, odh_unpack_run, odh_teardown,
+     BDB_COMPRESS_NONE},
+    {"odh_unpack", "crle", 0, odh_setup, odh_unpack_run, odh_teardown,
+     BDB_COMPRESS_CRLE},
+    {"odh_unpack", "lz4", 0, odh_setup, odh_unpack_run, odh_teardown,
+     BDB_COMPRESS_LZ4},
+    {"types_roundtrip", "int", 0, NULL, types_int_run, NULL, 0},
+    {"types_roundtrip", "real", 0, NULL, types_real_run, NULL, 0},
+    {"types_roundtrip", "cstring", 0, NULL, types_cstr_run, NULL, 0},
+    {"temptable_insert", "8:64", 0, bt_open, temptable_insert_run,
+     bt_teardown, 0},
+    {"temptable_scan", "100000", 0, bt_setup_filled, temptable_scan_run,
+     bt_teardown, 0},
+    {"btree_search", "100000", 0, bt_setup_filled, btree_search_run,
+     bt_teardown, 0},
+    {"plhash_find", "chained", 0, hash_setup, hash_find_run, hash_teardown,
+     0},
+    {"plhash_find", "flat", 0, hash_setup, hash_find_run, hash_teardown, 1},
+    {"thdpool_enqueue", "1", 0, pool_setup, pool_run, pool_teardown, 1},
+    {"thdpool_enqueue", "8", 0, pool_setup, pool_run, pool_teardown, 8},
+    {"sbuf2_write", "64", 0, sb_setup, sb_write_run, sb_teardown, 64},
+    {"sbuf2_read", "64", 0, sb_setup, sb_read_run, sb_teardown, 64},
+};
+
+static int selected(const struct bench *b, int argc, char *argv[])
+{
+    if (argc == 0)
+        return 1;
+    for (int i = 0; i < argc; i++) {
+        if (strncmp(b->name, argv[i], strlen(argv[i])) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+static int run_bench(struct bench *b, double target)
+{
+    int64_t n = 1;
+    double t0, elapsed;
+    int rc;
+
+    if (b->setup && (rc = b->setup(b)) != 0) {
+        fprintf(stderr, "%s %s: setup failed rc %d\n", b->name, b->arg, rc);
+        goto out;
+    }
+    /* one untimed pass to warm caches, then grow n until a run is long
+     * enough to time */
+    if ((rc = b->run(b, 1)) != 0)
+        goto fail;
+    for (;;) {
+        t0 = now();
+        if ((rc = b->run(b, n)) != 0)
+            goto fail;
+        elapsed = now() - t0;
+        if (elapsed >= target || n >= (1LL << 40))
+            break;
+        if (elapsed < target / 100)
+            n *= 10;
+        else
+            n = n * (target * 1.2 / elapsed) + 1;
+    }
+    printf("{\"name\":\"%s\",\"arg\":\"%s\",\"ops\":%" PRId64
+           ",\"ns_per_op\":%.2f",
+           b->name, b->arg, n, elapsed * 1e9 / n);
+    if (b->bytes_per_op)
+        printf(",\"mb_per_sec\":%.1f",
+               (double)b->bytes_per_op * n / elapsed / (1024 * 1024));
+    printf("}\n");
+    fflush(stdout);
+    goto out;
+
+fail:
+    fprintf(stderr, "%s %s: run failed rc %d\n", b->name, b->arg, rc);
+out:
+    if (b->teardown)
+        b->teardown(b);
+    return rc;
+}
+
+static void usage(const char *progname)
+{
+    fprintf(stderr,
+            "usage: %s [-t ms] [-d tmpdir] [-l] [name ...]\n"
+            "  -t ms      minimum time per benchmark (default 500)\n"
+            "  -d tmpdir  directory for the btree benchmarks (default /tmp)\n"
+            "  -l         list benchmarks\n"
+            "  name       run only benchmarks whose name starts with name\n",
+            progname);
+}
+
+int tool_cdb2_bench_main(int argc, char *argv[])
+{
+    double target = 0.5;
+    int c, i, rc = 0, list = 0;
+
+    crc32c_init(0);
+    comdb2ma_init(0, 0);
+    Pthread_key_create(&DBG_FREE_CURSOR, NULL);
+
+    while ((c = getopt(argc, argv, "t:d:lh")) != -1) {
+        switch (c) {
+        case 't':
+            target = atoi(optarg) / 1000.0;
+            break;
+        case 'd':
+            tmpdir = optarg;
+            break;
+        case 'l':
+            list = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (!selected(&benches[i], argc, argv))
+            continue;
+        if (list) {
+            printf("%s %s\n", benches[i].name, benches[i].arg);
+            continue;
+        }
+        if (run_bench(&benches[i], target))
+            rc = 1;
+    }
+    return rc;
+}
@@ -969,6 +969,9 @@ convprintable(dbenv, instr, outstrp)
 /*
  * dbt_rprint --
  *	Read a printable line into a DBT structure.
+ *
+ * dbt_rprint and dbt_rdump read the input a character at a time; we are
+ * the only thread reading stdin, so they do it without taking its lock.
  */
 static int
 dbt_rprint(dbenv, dbtp)
@@ -984,7 +987,7 @@ dbt_rprint(dbenv, dbtp)
 
 	first = 1;
 	e = escape = 0;
-	for (p = dbtp->data, len = 0; (c1 = getchar()) != '\n';) {
+	for (p = dbtp->data, len = 0; (c1 = getchar_unlocked()) != '\n';) {
 		if (c1 == EOF) {
 			if (len == 0) {
 				G(endofile) = G(endodata) = 1;
@@ -1012,7 +1015,7 @@ dbt_rprint(dbenv, dbtp)
 		}
 		if (escape) {
 			if (c1 != '\\') {
-				if ((c2 = getchar()) == EOF) {
+				if ((c2 = getchar_unlocked()) == EOF) {
 					badend(dbenv);
 					return (1);
 				}
@@ -1062,7 +1065,7 @@ dbt_rdump(dbenv, dbtp)
 
 	first = 1;
 	e = 0;
-	for (p = dbtp->data, len = 0; (c1 = getchar()) != '\n';) {
+	for (p = dbtp->data, len = 0; (c1 = getchar_unlocked()) != '\n';) {
 		if (c1 == EOF) {
 			if (len == 0) {
 				G(endofile) = G(endodata) = 1;
@@ -1088,7 +1091,7 @@ dbt_rdump(dbenv, dbtp)
 				continue;
 			}
 		}
-		if ((c2 = getchar()) == EOF) {
+		if ((c2 = getchar_unlocked()) == EOF) {
 			badend(dbenv);
 			return (1);
 		}
@@ -37,13 +37,17 @@
 #include <cinttypes>
 #include <cassert>
 #include <limits.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 #include "cdb2api.h"
 #include "cson.h"
 
 static cdb2_hndl_tp *cdb2h = nullptr;
 char *dbname;
-int had_errors = 0;
+thread_local int had_errors = 0;
 std::map<std::string, std::string> sqltrack;
 std::map<std::string, std::list<cson_value*>> transactions;
 
@@ -53,6 +57,26 @@ int threshold_percent = 5;
 
 int64_t maxevents = 0;
 
+/* Parallel replay: each connection in the log gets its own client, and
+   statements are issued at their original offsets from the first event,
+   divided by speed (0 for no delays). */
+bool parallel = false;
+double speed = 1;
+bool report = false;
+
+/* Original and replayed latency of every statement, for the report */
+struct latency_sample {
+    std::string fingerprint;
+    int64_t orig_us;
+    int64_t replay_us;
+    int64_t lag_us; /* how late the statement was issued */
+};
+std::mutex report_lock;
+std::mutex output_lock;
+std::vector<latency_sample> samples;
+std::map<std::string, std::string> sample_sql; /* fingerprint -> sql */
+thread_local int64_t current_lag_us = 0;
+
 void replay(cdb2_hndl_tp *db, cson_value *val);
 
 static const char *usage_text =
@@ -63,6 +87,11 @@ static const char *usage_text =
     "  --verbose              Lots of verbose output\n"
     "  --threshold N          Set diff threshold to N% (default 5)\n"
     "  --stopat N             Stop after N events processed\n"
+    "  --parallel             Replay each connection on its own client, with\n"
+    "                         the original timing\n"
+    "  --speed X              Replay X times faster than logged (implies\n"
+    "                         --parallel; 0 replays without delays)\n"
+    "  --report               Compare replayed latencies with logged ones\n"
     "\n"
     ;
 
@@ -318,13 +347,13 @@ bool do_bindings(cdb2_hndl_tp *db, cson_value *event_val,
 
         if (name[0] == '?') {
             int idx = atoi(name + 1);
-            if ((ret = cdb2_bind_index(cdb2h, idx, cdb2_type, varaddr, length)) != 0) {
+            if ((ret = cdb2_bind_index(db, idx, cdb2_type, varaddr, length)) != 0) {
                 std::cerr << "Error from cdb2_bind_index() column " << name << ", ret=" << ret << std::endl;
                 return false;
             }
         }
         else {
-            if ((ret = cdb2_bind_param(cdb2h, name, cdb2_type, varaddr, length)) != 0) {
+            if ((ret = cdb2_bind_param(db, name, cdb2_type, varaddr, length)) != 0) {
                 std::cerr << "Error from cdb2_bind_param column " << name << ", ret=" << ret << std::endl;
                 return false;
             }
@@ -621,6 +650,33 @@ void dump_sql_event(cson_value *event) {
     printf("tranid 0 %s", sql.c_str());
 }
 
+void record_latency(cson_value *event_val, int64_t replay_us) {
+    latency_sample s;
+    const char *fp = get_strprop(event_val, "fingerprint");
+    s.fingerprint = fp ? fp : "";
+    s.orig_us = -1;
+    s.replay_us = replay_us;
+    s.lag_us = current_lag_us;
+
+    cson_object *obj;
+    cson_value_fetch_object(event_val, &obj);
+    cson_value *perf = cson_object_get(obj, "perf");
+    if (perf != nullptr && cson_value_is_object(perf)) {
+        cson_value_fetch_object(perf, &obj);
+        cson_value *jtime = cson_object_get(obj, "tottime");
+        if (jtime != nullptr && cson_value_is_integer(jtime))
+            s.orig_us = cson_value_get_integer(jtime);
+    }
+
+    std::lock_guard<std::mutex> l(report_lock);
+    if (!s.fingerprint.empty() && sample_sql.find(s.fingerprint) == sample_sql.end()) {
+        const char *sql = get_strprop(event_val, "sql");
+        if (sql != nullptr)
+            sample_sql[s.fingerprint] = std::string(sql).substr(0, 60);
+    }
+    samples.push_back(std::move(s));
+}
+
 void replay(cdb2_hndl_tp *db, cson_value *event_val) {
     const char *sql = get_strprop(event_val, "sql");
     if(sql == nullptr) {
@@ -685,6 +741,8 @@ void replay(cdb2_hndl_tp *db, cson_value *event_val) {
         return;
     }
     int64_t end_time = hrtime();
+    if (report)
+        record_latency(event_val, end_time - start_time);
     int64_t new_cost = last_cost(db);
 
     cson_object *obj;
@@ -723,6 +781,7 @@ void replay(cdb2_hndl_tp *db, cson_value *event_val) {
         }
 
         if (diffs && have_diffs) {
+            std::lock_guard<std::mutex> l(output_lock);
             dump_sql_event(event_val);
             printf(" -- time %" PRId64 " (was %" PRId64 ") cost %" PRId64 " (was %" PRId64 ") rows %" PRId64 " (was %" PRId64 ")\n",
                    new_time, old_time,
@@ -966,7 +1025,7 @@ public:
         }
         return true;
     }
-    cson_value *get() {
+    cson_value *get(int *source = nullptr) {
         int64_t min_timestamp = LLONG_MAX;
         int minix = -1;
         for (int i = 0; i < sources.size(); i++) {
@@ -980,6 +1039,8 @@ public:
         cson_value *ret = sources[minix].consume();
         if (minix != -1)
             sources[minix].get();
+        if (source)
+            *source = minix;
         return ret;
     }
 
@@ -987,6 +1048,20 @@ protected:
     std::vector<event_source> sources;
 };
 
+int open_db(cdb2_hndl_tp **db) {
+    int rc;
+    char *conf = getenv("CDB2_CONFIG");
+    if (conf) {
+        cdb2_set_comdb2db_config(conf);
+        rc = cdb2_open(db, dbname, "default", 0);
+    } else { 
+        rc = cdb2_open(db, dbname, "local", 0);
+    }
+    if (rc == 0)
+        cdb2_run_statement(*db, "set getcost on");
+    return rc;
+}
+
 void process_events(cdb2_hndl_tp *db, event_queue &queue) {
     std::string line;
     int linenum = 0;
@@ -1002,13 +1077,7 @@ void process_events(cdb2_hndl_tp *db, event_queue &queue) {
             if (had_errors) {
                 had_errors = 0;
                 cdb2_close(cdb2h);
-                char *conf = getenv("CDB2_CONFIG");
-                if (conf) {
-                    cdb2_set_comdb2db_config(conf);
-                    rc = cdb2_open(&cdb2h, dbname, "default", 0);
-                } else { 
-                    rc = cdb2_open(&cdb2h, dbname, "local", 0);
-                }
+                rc = open_db(&cdb2h);
                 db = cdb2h;
             }
             numevents++;
@@ -1022,6 +1091,206 @@ void process_events(cdb2_hndl_tp *db, event_queue &queue) {
         std::cout << "got " << linenum  << " lines" << std::endl;
 }
 
+/* A client replaying the statements of one connection in the log, in order,
+   on its own handle.  The dispatcher queues each statement when it is due. */
+struct replay_client {
+    std::thread thd;
+    std::mutex lk;
+    std::condition_variable cv;
+    std::deque<std::pair<cson_value *, int64_t>> queue; /* event, due time */
+    bool done = false;
+
+    void add(cson_value *event_val, int64_t due) {
+        std::lock_guard<std::mutex> l(lk);
+        queue.emplace_back(event_val, due);
+        cv.notify_one();
+    }
+
+    bool next(cson_value **event_val, int64_t *due) {
+        std::unique_lock<std::mutex> l(lk);
+        cv.wait(l, [this] { return done || !queue.empty(); });
+        if (queue.empty())
+            return false;
+        *event_val = queue.front().first;
+        *due = queue.front().second;
+        queue.pop_front();
+        return true;
+    }
+
+    void finish() {
+        {
+            std::lock_guard<std::mutex> l(lk);
+            done = true;
+            cv.notify_one();
+        }
+        thd.join();
+    }
+
+    void run() {
+        cdb2_hndl_tp *db = nullptr;
+        cson_value *event_val;
+        int64_t due;
+
+        if (open_db(&db)) {
+            std::cerr << "Error: cdb2_open() failed: " << cdb2_errstr(db) << std::endl;
+            cdb2_close(db);
+            db = nullptr;
+        }
+        while (next(&event_val, &due)) {
+            if (db != nullptr) {
+                current_lag_us = std::max<int64_t>(hrtime() - due, 0);
+                replay(db, event_val);
+                if (had_errors) {
+                    had_errors = 0;
+                    cdb2_close(db);
+                    if (open_db(&db)) {
+                        std::cerr << "Error: cdb2_open() failed: " << cdb2_errstr(db) << std::endl;
+                        cdb2_close(db);
+                        db = nullptr;
+                    }
+                }
+            }
+            cson_free_value(event_val);
+        }
+        if (db != nullptr)
+            cdb2_close(db);
+    }
+};
+
+/* Statements from one connection are replayed on one client; statements
+   that don't say which connection they came from are keyed on their cnonce,
+   which at least keeps a transaction together */
+static std::string client_key(cson_value *event_val, int source) {
+    int64_t connid, pid;
+    const char *host = get_strprop(event_val, "host");
+    std::stringstream key;
+
+    key << source << ":";
+    if (get_intprop(event_val, "connid", &connid)) {
+        if (get_intprop(event_val, "pid", &pid))
+            key << (host ? host : "") << ":" << pid << ":";
+        key << connid;
+    } else {
+        const char *cnonce = get_strprop(event_val, "cnonce");
+        key << "cnonce:" << (cnonce ? cnonce : "");
+    }
+    return key.str();
+}
+
+void process_events_parallel(event_queue &queue) {
+    std::map<std::string, replay_client *> clients;
+    int64_t numevents = 0;
+    int64_t first = -1;
+    int64_t start = hrtime();
+
+    while (!queue.empty()) {
+        int source;
+        cson_value *event_val = queue.get(&source);
+        if (event_val == nullptr)
+            continue;
+        int64_t timestamp;
+        if (!event_is_sql(event_val) || !is_replayable(event_val) ||
+            !get_intprop(event_val, "time", &timestamp)) {
+            cson_free_value(event_val);
+            continue;
+        }
+
+        if (first == -1)
+            first = timestamp;
+        int64_t due = start;
+        if (speed > 0)
+            due += (int64_t) ((timestamp - first) / speed);
+        int64_t now = hrtime();
+        if (due > now)
+            usleep(due - now);
+
+        std::string key = client_key(event_val, source);
+        auto it = clients.find(key);
+        if (it == clients.end()) {
+            replay_client *c = new replay_client();
+            c->thd = std::thread(&replay_client::run, c);
+            it = clients.insert(std::make_pair(key, c)).first;
+            if (verbose)
+                std::cout << "new client " << key << std::endl;
+        }
+        it->second->add(event_val, due);
+
+        numevents++;
+        if (maxevents && numevents >= maxevents)
+            break;
+    }
+
+    for (auto &c : clients) {
+        c.second->finish();
+        delete c.second;
+    }
+    if (verbose)
+        std::cout << "replayed " << numevents << " events on " << clients.size() << " clients" << std::endl;
+}
+
+static int64_t percentile(std::vector<int64_t> &v, double pct) {
+    if (v.empty())
+        return 0;
+    size_t ix = (size_t) (pct / 100 * v.size());
+    if (ix >= v.size())
+        ix = v.size() - 1;
+    return v[ix];
+}
+
+static void print_latency_row(const char *name, std::vector<int64_t> &v) {
+    std::sort(v.begin(), v.end());
+    printf("%-10s %10zu %10" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 "\n",
+           name, v.size(), percentile(v, 50), percentile(v, 90), percentile(v, 99),
+           percentile(v, 99.9), v.empty() ? 0 : v.back());
+}
+
+struct fingerprint_latency {
+    std::vector<int64_t> orig;
+    std::vector<int64_t> replayed;
+    int64_t total = 0;
+};
+
+void print_report() {
+    std::vector<int64_t> orig, replayed, lag;
+    std::map<std::string, fingerprint_latency> byfp;
+
+    for (auto &s : samples) {
+        fingerprint_latency &f = byfp[s.fingerprint];
+        if (s.orig_us >= 0) {
+            orig.push_back(s.orig_us);
+            f.orig.push_back(s.orig_us);
+        }
+        replayed.push_back(s.replay_us);
+        f.replayed.push_back(s.replay_us);
+        f.total += s.replay_us;
+        lag.push_back(s.lag_us);
+    }
+
+    printf("\nLatency (us)      count        p50        p90        p99      p99.9        max\n");
+    print_latency_row("logged", orig);
+    print_latency_row("replayed", replayed);
+    if (parallel)
+        print_latency_row("start lag", lag);
+
+    std::vector<std::pair<int64_t, const std::string *>> order;
+    for (auto &f : byfp)
+        order.emplace_back(f.second.total, &f.first);
+    std::sort(order.rbegin(), order.rend());
+
+    printf("\nBy fingerprint, most replay time first (us)\n");
+    printf("%-32s %8s %10s %10s %10s %10s  %s\n", "fingerprint", "count", "logged p50",
+           "replay p50", "logged p99", "replay p99", "sql");
+    for (size_t i = 0; i < order.size() && i < 20; i++) {
+        fingerprint_latency &f = byfp[*order[i].second];
+        std::sort(f.orig.begin(), f.orig.end());
+        std::sort(f.replayed.begin(), f.replayed.end());
+        printf("%-32s %8zu %10" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 "  %s\n",
+               order[i].second->empty() ? "-" : order[i].second->c_str(), f.replayed.size(),
+               percentile(f.orig, 50), percentile(f.replayed, 50), percentile(f.orig, 99),
+               percentile(f.replayed, 99), sample_sql[*order[i].second].c_str());
+    }
+}
+
 int main(int argc, char **argv) {
     char *filename = nullptr;
 
@@ -1055,6 +1324,24 @@ int main(int argc, char **argv) {
             }
             maxevents = (int) strtol(argv[0], nullptr, 10);
         }
+        else if (strcmp(argv[0], "--parallel") == 0)
+            parallel = true;
+        else if (strcmp(argv[0], "--speed") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--speed expected an argument");
+                return 1;
+            }
+            speed = strtod(argv[0], nullptr);
+            if (speed < 0) {
+                fprintf(stderr, "--speed can't be negative");
+                return 1;
+            }
+            parallel = true;
+        }
+        else if (strcmp(argv[0], "--report") == 0)
+            report = true;
         else {
             fprintf(stderr, "Unknown option %s\n", argv[0]);
         }
@@ -1065,30 +1352,27 @@ int main(int argc, char **argv) {
     argc--;
     argv++;
 
-    /* TODO: tier should be an option */
-    int rc;
-    char *conf = getenv("CDB2_CONFIG");
-    if (conf) {
-        cdb2_set_comdb2db_config(conf);
-        rc = cdb2_open(&cdb2h, dbname, "default", 0);
-    } else { 
-        rc = cdb2_open(&cdb2h, dbname, "local", 0);
-    }
-
-    if (rc) {
-        std::cerr << "Error: cdb2_open() failed: " << cdb2_errstr(cdb2h) << std::endl;
-        exit(EXIT_FAILURE);
-    }
-    cdb2_run_statement(cdb2h, "set getcost on");
-
     event_queue events;
     while (argc) {
         events.add_source(argv[0]);
         argc--;
         argv++;
     }
-    process_events(cdb2h, events);
 
-    cdb2_close(cdb2h);
+    if (parallel) {
+        process_events_parallel(events);
+    } else {
+        /* TODO: tier should be an option */
+        int rc = open_db(&cdb2h);
+        if (rc) {
+            std::cerr << "Error: cdb2_open() failed: " << cdb2_errstr(cdb2h) << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        process_events(cdb2h, events);
+        cdb2_close(cdb2h);
+    }
+
+    if (report)
+        print_report();
     return 0;
 }
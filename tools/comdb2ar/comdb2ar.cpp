@@ -35,6 +35,8 @@ const char *help_text[] = {
 "  Database mydb is serialised into tape archive format on to stdout.",
 "  -s   serialise support files only (lrl, csc2 etc, no data or log files)",
 "  -L   do not disable log file deletion (dangerous)",
+"  -j n read each file up to n 4MB buffers ahead of the output (default 4,",
+"       1 reads and writes in turn)",
 "",
 "To deserialise a db: comdb2ar.tsk [opts] x [/bb/bin /bb/data/mydb] < input",
 "To deserialise a db incrementally:",
@@ -60,6 +62,8 @@ const char *help_text[] = {
 "  -D           turn off directio",
 "  -E dbname    create replicant with dbname",
 "  -T type      override physrep type",
+"  -j n         read each file up to n 4MB buffers ahead of its writes",
+"               (default 4, 1 reads and writes in turn)",
 NULL
 };
 
@@ -111,6 +115,7 @@ int main(int argc, char *argv[])
     bool incr_path_specified = false;
     bool dryrun = false;
     bool copy_physical = false;
+    unsigned read_ahead = 4;
 
     std::string new_db_name = "";
     std::string new_type = "default";
@@ -127,7 +132,7 @@ int main(int argc, char *argv[])
     ss << root << "/bin/comdb2";
     std::string comdb2_task(ss.str());
 
-    while((c = getopt(argc, argv, "hsSLC:I:b:x:u:rRSkKfODE:T:")) != EOF) {
+    while((c = getopt(argc, argv, "hsSLC:I:b:x:u:rRSkKfODE:T:j:")) != EOF) {
         switch(c) {
             case 'O':
                 legacy_mode = true;
@@ -230,6 +235,14 @@ int main(int argc, char *argv[])
                 new_type = std::string(optarg);
                 break;
 
+            case 'j':
+                if (std::atoi(optarg) < 1) {
+                    std::cerr << "-j must be at least 1" << std::endl;
+                    std::exit(2);
+                }
+                read_ahead = std::atoi(optarg);
+                break;
+
             case '?':
                 std::cerr << "Unrecognised option: -" << (char)c << std::endl;
                 usage();
@@ -307,7 +320,8 @@ int main(int argc, char *argv[])
                 incr_create,
                 incr_gen,
                 copy_physical,
-                incr_path
+                incr_path,
+                read_ahead
             );
         } catch(std::exception& e) {
             std::cerr << e.what() << std::endl;
@@ -348,7 +362,8 @@ int main(int argc, char *argv[])
              is_disk_full,
              run_with_done_file,
              incr_ex,
-             dryrun
+             dryrun,
+             read_ahead
            );
         } catch(std::exception& e) {
             std::cerr << e.what() << std::endl;
@@ -110,7 +110,8 @@ void serialise_database(
   bool incr_create,
   bool incr_gen,
   bool copy_physical,
-  const std::string& incr_path
+  const std::string& incr_path,
+  unsigned read_ahead
 );
 // Serialise a database into tape archive format and write it to stdout.
 // If support_only is true then only support files (lrl and schema) will
@@ -133,7 +134,8 @@ void deserialise_database(
   bool& is_disk_full,
   bool run_with_done_file,
   bool incr_mode,
-  bool dryrun
+  bool dryrun,
+  unsigned read_ahead
 );
 // Deserialise a database from serialised form received on stdin.
 // If lrldestdir and datadestdir are not NULL then the lrl and data files
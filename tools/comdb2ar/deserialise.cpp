@@ -10,6 +10,7 @@
 #include "increment.h"
 #include "util.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <map>
 #include <set>
@@ -19,6 +20,12 @@
 #include <fstream>
 #include <vector>
 #include <memory>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -355,6 +362,117 @@ static bool check_dest_dir(const std::string& dir)
 
 #define write_size (1000*1024)
 
+// Number of buffers a file may be read from stdin ahead of its writes; see -j
+static unsigned read_ahead_bufs = 1;
+
+// Writes buffers handed to it with put() on its own thread, so that reading
+// the next part of a file from stdin overlaps with writing the last part.
+// An error from the write function is rethrown by the next get() or by
+// finish(); buffers put after that are dropped.
+class AsyncWriter {
+    std::function<void(const uint8_t *, size_t)> m_write;
+    std::vector<uint8_t *> m_bufs;
+    std::vector<uint8_t *> m_empty;
+    std::deque<std::pair<uint8_t *, size_t> > m_full;
+    std::mutex m_lk;
+    std::condition_variable m_cond;
+    bool m_closing;
+    std::exception_ptr m_err;
+    std::thread m_thd;
+
+    void run()
+    {
+        std::unique_lock<std::mutex> l(m_lk);
+        while (true) {
+            m_cond.wait(l, [&] { return !m_full.empty() || m_closing; });
+            if (m_full.empty())
+                break;
+            std::pair<uint8_t *, size_t> chunk = m_full.front();
+            m_full.pop_front();
+            if (!m_err) {
+                l.unlock();
+                try {
+                    m_write(chunk.first, chunk.second);
+                } catch (...) {
+                    l.lock();
+                    m_err = std::current_exception();
+                    l.unlock();
+                }
+                l.lock();
+            }
+            m_empty.push_back(chunk.first);
+            m_cond.notify_all();
+        }
+    }
+
+    void join()
+    {
+        {
+            std::lock_guard<std::mutex> l(m_lk);
+            m_closing = true;
+            m_cond.notify_all();
+        }
+        if (m_thd.joinable())
+            m_thd.join();
+    }
+
+public:
+    AsyncWriter(size_t nbufs, size_t bufsize,
+                std::function<void(const uint8_t *, size_t)> write)
+        : m_write(write), m_closing(false)
+    {
+        for (size_t i = 0; i < nbufs; i++) {
+            uint8_t *buf;
+#if defined _HP_SOURCE || defined _SUN_SOURCE
+            buf = (uint8_t*) memalign(512, bufsize);
+#else
+            if (posix_memalign((void**) &buf, 512, bufsize)) {
+                for (size_t j = 0; j < m_bufs.size(); j++)
+                    free(m_bufs[j]);
+                throw Error("Failed to allocate output buffer");
+            }
+#endif
+            m_bufs.push_back(buf);
+        }
+        m_empty = m_bufs;
+        m_thd = std::thread(&AsyncWriter::run, this);
+    }
+
+    ~AsyncWriter()
+    {
+        join();
+        for (size_t i = 0; i < m_bufs.size(); i++)
+            free(m_bufs[i]);
+    }
+
+    // Wait for a buffer to read into
+    uint8_t *get()
+    {
+        std::unique_lock<std::mutex> l(m_lk);
+        m_cond.wait(l, [&] { return !m_empty.empty() || m_err; });
+        if (m_err)
+            std::rethrow_exception(m_err);
+        uint8_t *buf = m_empty.back();
+        m_empty.pop_back();
+        return buf;
+    }
+
+    void put(uint8_t *buf, size_t len)
+    {
+        std::lock_guard<std::mutex> l(m_lk);
+        m_full.push_back(std::make_pair(buf, len));
+        m_cond.notify_all();
+    }
+
+    // Wait for every buffer put so far to be written
+    void finish()
+    {
+        join();
+        if (m_err)
+            std::rethrow_exception(m_err);
+    }
+};
+
 void deserialise_database(
         const std::string *p_lrldestdir,
         const std::string *p_datadestdir,
@@ -368,7 +486,8 @@ void deserialise_database(
         bool& is_disk_full,
         bool run_with_done_file,
         bool incr_mode,
-        bool dryrun
+        bool dryrun,
+        unsigned read_ahead
 )
 // Deserialise a database from serialised from received on stdin.
 // If lrldestdir and datadestdir are not NULL then the lrl and data files
@@ -377,10 +496,12 @@ void deserialise_database(
 // The lrl file written out will be updated to reflect the resulting directory
 // structure.  If the destination disk reaches or exceeds the specified
 // percent_full during the deserialisation then the operation is halted.
+// Files are read from stdin up to read_ahead buffers ahead of their writes.
 {
     static const char zero_head[512] = {0};
     int stlen;
     is_disk_full = false;
+    read_ahead_bufs = read_ahead;
     void *empty_page = NULL;
     unsigned long long skipped_bytes = 0;
     int rc =0;
@@ -674,6 +795,7 @@ void deserialise_database(
             throw Error("Failed to allocate output buffer");
 #endif
         RIIA_malloc free_guard(buf);
+        uint8_t *own_buf = buf;
 
         // Read the tar data in and write it out
         unsigned long long bytesleft = filesize;
@@ -684,9 +806,26 @@ void deserialise_database(
 
         bool checksum_failure = false;
 
+        // Plain data files are written on another thread while we read on
+        std::unique_ptr<AsyncWriter> writer;
+        if (!is_text && !file_is_sparse && read_ahead_bufs > 1) {
+            writer.reset(new AsyncWriter(read_ahead_bufs, bufsize,
+                [&](const uint8_t *wbuf, size_t nbytes) {
+                    for (size_t off = 0; off < nbytes; off += write_size) {
+                        size_t lim = std::min<size_t>(nbytes - off, write_size);
+                        if (!of_ptr->write((const char*) wbuf + off, lim)) {
+                            std::ostringstream ss;
+                            ss << "Error Writing " << filename;
+                            throw Error(ss);
+                        }
+                    }
+                }));
+        }
+
         unsigned long long readbytes = 0;
         while(bytesleft > 0)
         {
+            uint8_t *buf = writer ? writer->get() : own_buf;
             readbytes = bytesleft;
 
             if(bytesleft > bufsize)
@@ -759,6 +898,10 @@ void deserialise_database(
                   }
                }
             }
+            else if (writer)
+            {
+                writer->put(buf, readbytes);
+            }
             else
             {
                 uint64_t off = 0;
@@ -836,6 +979,8 @@ void deserialise_database(
                 recheck_count = FS_PERIODIC_CHECK;
             }
         }
+        if (writer)
+            writer->finish();
 
         // Read and discard the null padding
         unsigned long long padding_bytes = (nblocks << 9) - filesize;
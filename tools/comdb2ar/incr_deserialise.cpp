@@ -39,8 +39,9 @@ void update_tree(const std::string& filename,
     FileInfo file_info = file_data.first;
     std::vector<uint32_t> pages = file_data.second;
 
-    int flags = O_RDONLY;
+    int flags = dryrun ? O_RDONLY : O_WRONLY;
     int fd = open(filename.c_str(), flags);
+    RIIA_fd fd_guard(fd);
 
     struct stat st;
     if(fstat(fd, &st) != 0) {
@@ -49,42 +50,53 @@ void update_tree(const std::string& filename,
         throw SerialiseError(filename, ss.str());
     }
 
-    std::ofstream tree_file(filename, std::ofstream::out |
-                            std::ofstream::in | std::ofstream::binary);
-
     size_t pagesize = file_info.get_pagesize();
     if(pagesize == 0) {
         pagesize = 4096;
     }
 
+    // Pages come in the order they are listed, which is mostly ascending:
+    // read each run of consecutive pages from stdin in one go and write it
+    // back with a single pwrite instead of a seek and write per page.
+    size_t maxpages = MAX_BUF_SIZE / pagesize;
+    if (maxpages == 0)
+        maxpages = 1;
+
     uint8_t *pagebuf = NULL;
 
 #if ! defined  ( _SUN_SOURCE ) && ! defined ( _HP_SOURCE )
-    int rc = posix_memalign((void**) &pagebuf, 512, pagesize);
+    int rc = posix_memalign((void**) &pagebuf, 512, maxpages * pagesize);
     if (rc)
         std::cerr << "posix_memalign returns rc " << rc << std::endl;
 #else
-    pagebuf = (uint8_t*) memalign(512, pagesize);
+    pagebuf = (uint8_t*) memalign(512, maxpages * pagesize);
 #endif
+    RIIA_malloc free_guard(pagebuf);
 
-    for(std::vector<uint32_t>::const_iterator
-            it = pages.begin();
-            it != pages.end();
-            ++it){
+    for(size_t i = 0; i < pages.size(); ) {
+        size_t run = 1;
+        while (i + run < pages.size() && run < maxpages &&
+               pages[i + run] == pages[i] + run)
+            run++;
+        size_t nbytes = run * pagesize;
 
-        if(readall(0, &pagebuf[0], pagesize) != pagesize) {
+        if(readall(0, &pagebuf[0], nbytes) != nbytes) {
            std::ostringstream ss;
 
            ss << "Error reading for file " << filename << " page "
-              << *it;
+              << pages[i];
                throw Error(ss);
         }
 
-        // Seek out the offset corresponding to the page number and overwrite
-        if (!dryrun) {
-            tree_file.seekp(pagesize * *it, tree_file.beg);
-            tree_file.write((char *) pagebuf, pagesize);
+        // Overwrite the run at the offset of its first page
+        if (!dryrun &&
+            pwrite(fd, pagebuf, nbytes, (off_t)pagesize * pages[i]) != nbytes) {
+            std::ostringstream ss;
+            ss << "Error writing " << run << " pages at page " << pages[i]
+               << ": " << std::strerror(errno);
+            throw SerialiseError(filename, ss.str());
         }
+        i += run;
     }
 
     std::clog << "x " << file_info.get_filename() << " PARTIAL" << " Pages ";
@@ -101,8 +113,6 @@ void update_tree(const std::string& filename,
        std::clog << " not sparse ";
 
     std::clog << std::endl;
-
-    if(pagebuf) free(pagebuf);
 }
 
 void unpack_incr_data(
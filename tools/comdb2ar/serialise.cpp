@@ -24,6 +24,11 @@
 #include <utility>
 #include <vector>
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 #include <errno.h>
 #include <fcntl.h>
@@ -120,6 +125,17 @@ static void serialise_string(const std::string& filename,
  * that defines this properly */
 void *memalign(size_t boundary, size_t size);
 
+// Number of buffers serialise_file() may read ahead of its output; see -j
+static unsigned read_ahead_bufs = 1;
+
+// Frees the aligned read buffers however serialise_file() exits
+struct AlignedBufs : public std::vector<uint8_t *> {
+    ~AlignedBufs() {
+        for (size_t i = 0; i < size(); i++)
+            free((*this)[i]);
+    }
+};
+
 static void serialise_file(FileInfo& file, volatile iomap *iomap=NULL, const std::string altpath="",
                             const std::string incr_path="", bool incr_create = false)
 // Serialise a single file, in tape archive format, onto stdout.  The input
@@ -219,29 +235,32 @@ reopen:
     while((bufsize << 1) <= MAX_BUF_SIZE) {
         bufsize <<= 1;
     }
-#if 0
-    */
-    std::cerr<<"Computed bufsize="<<bufsize<<" for pagesize="<<pagesize<<" file="<<filename<<"\n";
-
-    std::vector<char> pagebuf(bufsize);
-#endif
-    uint8_t *pagebuf = NULL;
-    off_t bytesleft = st.st_size;
-    unsigned long long pageno = 0;
 
+    // With read_ahead_bufs > 1 a reader thread reads and verifies the file
+    // into up to that many buffers while we write the ones it has finished,
+    // so waiting on the disk and waiting on our consumer overlap.
+    size_t nbufs = read_ahead_bufs > 1 ? read_ahead_bufs : 1;
+    AlignedBufs bufs;
+    for (size_t i = 0; i < nbufs; i++) {
+        uint8_t *pagebuf = NULL;
 #if ! defined  ( _SUN_SOURCE ) && ! defined ( _HP_SOURCE )
         if(posix_memalign((void**) &pagebuf, 512, bufsize))
             throw Error("Failed to allocate output buffer");
 #else
         pagebuf = (uint8_t*) memalign(512, bufsize);
 #endif
+        bufs.push_back(pagebuf);
+    }
+    off_t bytesleft = st.st_size;
+    off_t byteswritten = 0;
 
     std::string incrFilename = incr_path + "/" + filename + ".incr";
     std::ofstream incrFile(incrFilename,
             std::ofstream::binary |
             std::ofstream::trunc);
 
-    while(bytesleft > 0) {
+    // Read the next chunk of the file into pagebuf, verifying its checksums
+    auto read_chunk = [&](uint8_t *pagebuf) -> ssize_t {
         int now;
         unsigned long long nbytes = bytesleft > bufsize ? bufsize : bytesleft;
 
@@ -341,15 +360,89 @@ reopen:
             }
         }
 
-        ssize_t byteswritten = writeall(1, &pagebuf[0], bytesread);
-        if(byteswritten != bytesread) {
+        bytesleft -= bytesread;
+        return bytesread;
+    };
+
+    auto write_chunk = [&](const uint8_t *pagebuf, ssize_t nbytes) {
+        if(writeall(1, &pagebuf[0], nbytes) != nbytes) {
             std::ostringstream ss;
-            ss << "write error after " << bytesleft << "bytes: "
+            ss << "write error after " << byteswritten << " bytes: "
                 << std::strerror(errno);
             throw SerialiseError(filename, ss.str());
         }
+        byteswritten += nbytes;
+    };
 
-        bytesleft -= bytesread;
+    if (nbufs == 1) {
+        while(bytesleft > 0) {
+            ssize_t bytesread = read_chunk(bufs[0]);
+            write_chunk(bufs[0], bytesread);
+        }
+    } else {
+        std::mutex lk;
+        std::condition_variable cond;
+        std::deque<std::pair<uint8_t *, ssize_t> > full;
+        std::vector<uint8_t *> empty(bufs.begin(), bufs.end());
+        bool reader_done = false, writer_failed = false;
+        std::exception_ptr reader_err;
+
+        // Only the reader touches fd, bytesleft, filesize and incrFile
+        // until it is joined.
+        std::thread reader([&]() {
+            try {
+                while (bytesleft > 0) {
+                    uint8_t *pagebuf;
+                    {
+                        std::unique_lock<std::mutex> l(lk);
+                        cond.wait(l, [&] { return !empty.empty() || writer_failed; });
+                        if (writer_failed)
+                            break;
+                        pagebuf = empty.back();
+                        empty.pop_back();
+                    }
+                    ssize_t bytesread = read_chunk(pagebuf);
+                    std::lock_guard<std::mutex> l(lk);
+                    full.push_back(std::make_pair(pagebuf, bytesread));
+                    cond.notify_all();
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> l(lk);
+                reader_err = std::current_exception();
+            }
+            std::lock_guard<std::mutex> l(lk);
+            reader_done = true;
+            cond.notify_all();
+        });
+
+        try {
+            while (true) {
+                std::pair<uint8_t *, ssize_t> chunk;
+                {
+                    std::unique_lock<std::mutex> l(lk);
+                    cond.wait(l, [&] { return !full.empty() || reader_done; });
+                    if (full.empty())
+                        break;
+                    chunk = full.front();
+                    full.pop_front();
+                }
+                write_chunk(chunk.first, chunk.second);
+                std::lock_guard<std::mutex> l(lk);
+                empty.push_back(chunk.first);
+                cond.notify_all();
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> l(lk);
+                writer_failed = true;
+                cond.notify_all();
+            }
+            reader.join();
+            throw;
+        }
+        reader.join();
+        if (reader_err)
+            std::rethrow_exception(reader_err);
     }
 
     file.set_filesize(filesize);
@@ -383,8 +476,6 @@ reopen:
 
 
     std::clog << std::endl;
-    if (pagebuf)
-        free(pagebuf);
 }
 
 std::string replace_dbname(const std::string& replaceWith, const std::string& dbname, 
@@ -763,14 +854,17 @@ void serialise_database(
   bool incr_create,
   bool incr_gen,
   bool copy_physical,
-  const std::string& incr_path
+  const std::string& incr_path,
+  unsigned read_ahead
 )
 // Serialise a database into tape archive format and write it to stdout.
 // If support_only is true then only support files (lrl and schema) will
 // be serialised.  If disable_log_deletion and the database is running then
 // it will be advised to hold log file deletion until the backup is complete
 // (highly recommended!)
+// Each file is read up to read_ahead buffers ahead of its output.
 {
+    read_ahead_bufs = read_ahead;
     std::string dbname;
     std::string dbdir;
     std::string dbtxndir;
@@ -0,0 +1,121 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/* Compare the chained and open-addressed (flat) plhash tables on the kind of
+ * fixed size keys the hot tables use (8 byte rqids, 16 byte fingerprints). */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/types.h>
+#include <string.h>
+
+#include <plhash.h>
+
+typedef struct {
+    unsigned long long id;
+    unsigned char fp[16];
+} ent_t;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int run(const char *name, hash_t *h, ent_t *ents, int n, int keyoff)
+{
+    double t0, t1, t2, t3;
+    int ii, nfound = 0;
+    ent_t miss;
+
+    t0 = now();
+    for (ii = 0; ii < n; ii++) {
+        if (hash_add(h, &ents[ii])) {
+            printf("%s: FAILED TO ADD %d\n", name, ii);
+            return -1;
+        }
+    }
+    t1 = now();
+    for (ii = 0; ii < n; ii++) {
+        if (hash_find(h, (char *)&ents[ii] + keyoff) != &ents[ii]) {
+            printf("%s: ERR: FIND %d\n", name, ii);
+            return -1;
+        }
+        memset(&miss, 0xff, sizeof(miss));
+        miss.id = ents[ii].id ^ 0x5555555555555555ULL;
+        memcpy(miss.fp, &miss.id, sizeof(miss.id));
+        nfound += hash_find(h, (char *)&miss + keyoff) != NULL;
+    }
+    t2 = now();
+    for (ii = 0; ii < n; ii++) {
+        if (hash_del(h, &ents[ii])) {
+            printf("%s: ERR: DEL %d\n", name, ii);
+            return -1;
+        }
+    }
+    t3 = now();
+    if (hash_get_num_entries(h) != 0 || nfound) {
+        printf("%s: ERR: %d LEFT, %d FALSE HITS\n", name,
+               hash_get_num_entries(h), nfound);
+        return -1;
+    }
+    printf("%-16s add %6.1f ns  find hit+miss %6.1f ns  del %6.1f ns\n", name,
+           (t1 - t0) * 1e9 / n, (t2 - t1) * 1e9 / n, (t3 - t2) * 1e9 / n);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int ii, rc = 0;
+    ent_t *ents;
+    hash_t *h;
+
+    if (n <= 0 || (ents = calloc(n, sizeof(ent_t))) == NULL) {
+        printf("usage: %s [nents]\n", argv[0]);
+        return 1;
+    }
+    srandom(time(NULL));
+    for (ii = 0; ii < n; ii++) {
+        /* unique odd ids; misses flip the low bit */
+        ents[ii].id =
+            ((unsigned long long)random() << 32) | ((unsigned)ii << 1) | 1;
+        memcpy(ents[ii].fp, &ents[ii].id, sizeof(ents[ii].id));
+    }
+    printf("%d entries\n", n);
+
+    h = hash_init_o(offsetof(ent_t, id), sizeof(unsigned long long));
+    rc |= run("chained u64", h, ents, n, offsetof(ent_t, id));
+    hash_free(h);
+    h = hash_init_flat_o(offsetof(ent_t, id), sizeof(unsigned long long));
+    rc |= run("flat u64", h, ents, n, offsetof(ent_t, id));
+    hash_dump_stats(h, stdout, NULL);
+    hash_free(h);
+
+    h = hash_init_o(offsetof(ent_t, fp), 16);
+    rc |= run("chained fp16", h, ents, n, offsetof(ent_t, fp));
+    hash_free(h);
+    h = hash_init_flat_o(offsetof(ent_t, fp), 16);
+    rc |= run("flat fp16", h, ents, n, offsetof(ent_t, fp));
+    hash_free(h);
+
+    free(ents);
+    printf(rc ? "FAILED.\n" : "DONE.\n");
+    return rc ? 1 : 0;
+}
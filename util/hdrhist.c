@@ -0,0 +1,161 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hdrhist.h"
+
+#include "mem_util.h"
+#include "mem_override.h"
+
+#define HDR_SUB_BITS 7
+#define HDR_SUB (1 << HDR_SUB_BITS) /* exact values below this */
+#define HDR_HALF (HDR_SUB >> 1)     /* sub-buckets per power of two */
+#define HDR_MAX_BITS 40             /* larger values are clamped */
+#define HDR_NBUCKETS (HDR_SUB + (HDR_MAX_BITS - HDR_SUB_BITS) * HDR_HALF)
+
+struct hdrhist {
+    int64_t count;
+    int64_t sum;
+    int64_t counts[HDR_NBUCKETS];
+};
+
+static inline int hdr_index(int64_t value)
+{
+    uint64_t v = value < 0 ? 0 : value;
+    int msb, shift;
+
+    if (v < HDR_SUB)
+        return v;
+    if (v >= (1ULL << HDR_MAX_BITS))
+        v = (1ULL << HDR_MAX_BITS) - 1;
+    msb = 63 - __builtin_clzll(v);
+    shift = msb - (HDR_SUB_BITS - 1);
+    return HDR_SUB + (shift - 1) * HDR_HALF + (int)((v >> shift) - HDR_HALF);
+}
+
+static inline void hdr_range(int idx, int64_t *low, int64_t *high)
+{
+    int shift;
+    int64_t sub;
+
+    if (idx < HDR_SUB) {
+        *low = *high = idx;
+        return;
+    }
+    idx -= HDR_SUB;
+    shift = idx / HDR_HALF + 1;
+    sub = idx % HDR_HALF + HDR_HALF;
+    *low = sub << shift;
+    *high = ((sub + 1) << shift) - 1;
+}
+
+struct hdrhist *hdrhist_new(void)
+{
+    return calloc(1, sizeof(struct hdrhist));
+}
+
+void hdrhist_free(struct hdrhist *h)
+{
+    free(h);
+}
+
+void hdrhist_reset(struct hdrhist *h)
+{
+    memset(h, 0, sizeof(*h));
+}
+
+void hdrhist_record(struct hdrhist *h, int64_t value)
+{
+    h->counts[hdr_index(value)]++;
+    h->count++;
+    h->sum += value;
+}
+
+void hdrhist_copy(struct hdrhist *dst, const struct hdrhist *src)
+{
+    memcpy(dst, src, sizeof(*dst));
+}
+
+void hdrhist_merge(struct hdrhist *dst, const struct hdrhist *src)
+{
+    for (int i = 0; i < HDR_NBUCKETS; i++)
+        dst->counts[i] += src->counts[i];
+    dst->count += src->count;
+    dst->sum += src->sum;
+}
+
+void hdrhist_diff(struct hdrhist *dst, const struct hdrhist *a,
+                  const struct hdrhist *b)
+{
+    for (int i = 0; i < HDR_NBUCKETS; i++)
+        dst->counts[i] = a->counts[i] - b->counts[i];
+    dst->count = a->count - b->count;
+    dst->sum = a->sum - b->sum;
+}
+
+int64_t hdrhist_count(const struct hdrhist *h)
+{
+    return h->count;
+}
+
+double hdrhist_mean(const struct hdrhist *h)
+{
+    return h->count ? (double)h->sum / h->count : 0;
+}
+
+int64_t hdrhist_percentile(const struct hdrhist *h, double pct)
+{
+    int64_t target, seen = 0, low, high;
+    double rank;
+
+    if (h->count == 0)
+        return 0;
+    if (pct > 100)
+        pct = 100;
+    rank = pct / 100 * h->count;
+    target = (int64_t)rank;
+    if (target < rank)
+        target++;
+    if (target < 1)
+        target = 1;
+    for (int i = 0; i < HDR_NBUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= target) {
+            hdr_range(i, &low, &high);
+            return high;
+        }
+    }
+    hdr_range(HDR_NBUCKETS - 1, &low, &high);
+    return high;
+}
+
+int hdrhist_foreach(const struct hdrhist *h, hdrhist_foreach_fn *cb,
+                    void *arg)
+{
+    int64_t low, high;
+    int rc;
+
+    for (int i = 0; i < HDR_NBUCKETS; i++) {
+        if (h->counts[i] == 0)
+            continue;
+        hdr_range(i, &low, &high);
+        if ((rc = cb(arg, low, high, h->counts[i])) != 0)
+            return rc;
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_HDRHIST_H
+#define INCLUDED_HDRHIST_H
+
+/* High dynamic range histogram of non-negative integer values.
+ *
+ * Values below 128 are counted exactly; above that every power of two is
+ * split into 64 equal sub-buckets, so any recorded value is known to within
+ * 1/64 (~1.6%) up to 2^40.  Histograms with the same layout can be merged
+ * or subtracted bucket by bucket, which is what makes them usable for
+ * percentiles across intervals and nodes.  Not thread safe; callers lock. */
+
+#include <stdint.h>
+
+struct hdrhist;
+
+struct hdrhist *hdrhist_new(void);
+void hdrhist_free(struct hdrhist *h);
+void hdrhist_reset(struct hdrhist *h);
+void hdrhist_record(struct hdrhist *h, int64_t value);
+
+/* dst = src */
+void hdrhist_copy(struct hdrhist *dst, const struct hdrhist *src);
+/* dst += src */
+void hdrhist_merge(struct hdrhist *dst, const struct hdrhist *src);
+/* dst = a - b, where b is an earlier copy of a */
+void hdrhist_diff(struct hdrhist *dst, const struct hdrhist *a,
+                  const struct hdrhist *b);
+
+int64_t hdrhist_count(const struct hdrhist *h);
+double hdrhist_mean(const struct hdrhist *h);
+/* highest value equivalent to the pct'th percentile (0 < pct <= 100);
+ * 0 if the histogram is empty */
+int64_t hdrhist_percentile(const struct hdrhist *h, double pct);
+
+/* call cb for every non-empty bucket in ascending order, with the range of
+ * values it holds; stops early if cb returns non-zero */
+typedef int hdrhist_foreach_fn(void *arg, int64_t low, int64_t high,
+                               int64_t count);
+int hdrhist_foreach(const struct hdrhist *h, hdrhist_foreach_fn *cb,
+                    void *arg);
+
+#endif
@@ -0,0 +1,164 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "numa_util.h"
+#include "logmsg.h"
+#include "comdb2_atomic.h"
+
+#define MPOL_PREFERRED_ 1
+#define MPOL_MF_MOVE_ (1 << 1)
+#define NUMA_MAX_NODES 64
+
+static pthread_once_t numa_once = PTHREAD_ONCE_INIT;
+static int numa_nnodes = 1;
+static unsigned int numa_next;
+
+/* Parse a sysfs list such as "0-3,8-11" and call fn for each member. */
+static void numa_parse_list(const char *s, void (*fn)(int, void *), void *arg)
+{
+    while (*s) {
+        char *end;
+        long lo = strtol(s, &end, 10);
+        long hi = lo;
+        if (end == s)
+            break;
+        if (*end == '-') {
+            s = end + 1;
+            hi = strtol(s, &end, 10);
+        }
+        for (long i = lo; i <= hi; i++)
+            fn((int)i, arg);
+        s = end;
+        while (*s == ',' || *s == '\n' || *s == ' ')
+            s++;
+    }
+}
+
+static int numa_read_list(const char *path, char *buf, size_t sz)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+        return -1;
+    if (fgets(buf, sz, f) == NULL) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+static void count_node(int node, void *arg)
+{
+    int *max = arg;
+    if (node + 1 > *max)
+        *max = node + 1;
+}
+
+static void numa_init(void)
+{
+    char buf[256];
+    int max = 0;
+    if (numa_read_list("/sys/devices/system/node/online", buf, sizeof(buf)))
+        return;
+    numa_parse_list(buf, count_node, &max);
+    if (max > NUMA_MAX_NODES)
+        max = NUMA_MAX_NODES;
+    if (max > 0)
+        numa_nnodes = max;
+}
+
+int comdb2_numa_nodes(void)
+{
+    pthread_once(&numa_once, numa_init);
+    return numa_nnodes;
+}
+
+int comdb2_numa_next_node(void)
+{
+    int n = comdb2_numa_nodes();
+    /* unsigned, so the counter wraps instead of going negative */
+    return (int)((ATOMIC_ADD32(numa_next, 1) - 1) % (unsigned int)n);
+}
+
+int comdb2_numa_bind_memory(void *addr, size_t len, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long mask = 1UL << node;
+    uintptr_t pg = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t)addr + pg - 1) & ~(pg - 1);
+    uintptr_t end = ((uintptr_t)addr + len) & ~(pg - 1);
+
+    if (comdb2_numa_nodes() < 2 || node < 0 || node >= numa_nnodes)
+        return 0;
+    if (end <= start)
+        return 0;
+    if (syscall(SYS_mbind, (void *)start, end - start, MPOL_PREFERRED_, &mask,
+                sizeof(mask) * 8, MPOL_MF_MOVE_) != 0) {
+        logmsg(LOGMSG_WARN, "%s: mbind node %d len %zu failed: %s\n", __func__,
+               node, len, strerror(errno));
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+static void set_cpu(int cpu, void *arg)
+{
+    if (cpu < CPU_SETSIZE)
+        CPU_SET(cpu, (cpu_set_t *)arg);
+}
+
+int comdb2_numa_pin_thread(int node)
+{
+#ifdef __linux__
+    char path[128], buf[1024];
+    cpu_set_t set;
+    int rc;
+
+    if (comdb2_numa_nodes() < 2 || node < 0 || node >= numa_nnodes)
+        return 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+             node);
+    if (numa_read_list(path, buf, sizeof(buf)))
+        return -1;
+    CPU_ZERO(&set);
+    numa_parse_list(buf, set_cpu, &set);
+    if (CPU_COUNT(&set) == 0)
+        return -1;
+    if ((rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) != 0) {
+        logmsg(LOGMSG_WARN, "%s: pin to node %d failed: %s\n", __func__, node,
+               strerror(rc));
+        return -1;
+    }
+#endif
+    return 0;
+}
@@ -100,6 +100,14 @@ typedef struct pooled_object {
     pthread_t tid;
 } pooled_object;
 
+/* objects a thread keeps for its next borrows */
+typedef struct objpool_tcache {
+    struct comdb2_objpool *op;
+    struct objpool_tcache *next;
+    unsigned int nhits;
+    void *slots[OP_THREAD_CACHE_MAX];
+} objpool_tcache;
+
 typedef struct comdb2_objpool {
     enum objpool_type type;
 
@@ -142,6 +150,17 @@ typedef struct comdb2_objpool {
     int min_idle_ratio;
     int idle_time_ms;
 
+    /*
+    ** per-thread caches. slots are taken with atomic
+    ** exchanges; the list is protected by data_mutex
+    */
+    int tcache_size;
+    int tcache_key_valid;
+    pthread_key_t tcache_key;
+    objpool_tcache *tcaches;
+    unsigned int ntcachehits;
+    unsigned int ntcachesteals;
+
     /*
     ** hashtable for storing access history
     ** of an object
@@ -193,6 +212,16 @@ static int opt_evict_ratio(comdb2_objpool_t op, int value);
 static int opt_min_idles(comdb2_objpool_t op, int value);
 static int opt_min_idle_ratio(comdb2_objpool_t op, int value);
 static int opt_idle_time_ms(comdb2_objpool_t op, int value);
+static int opt_thread_cache(comdb2_objpool_t op, int value);
+
+/********************
+** per-thread cache *
+*********************/
+static int tcache_get(comdb2_objpool_t op, void **objp);
+static int tcache_put(comdb2_objpool_t op, void *obj);
+static int tcache_steal_ll(comdb2_objpool_t op, void **objp);
+static void tcache_drain_ll(comdb2_objpool_t op);
+static void tcache_destroy(void *arg);
 
 /**********************************
 ** static return/borrow functions *
@@ -281,6 +310,7 @@ int comdb2_objpool_destroy(comdb2_objpool_t op)
 {
     {
         Pthread_mutex_lock(&op->data_mutex);
+        tcache_drain_ll(op);
         if (op->nactiveobjs > 0) {
             /* active objects out there, can't proceed */
             Pthread_mutex_unlock(&op->data_mutex);
@@ -313,6 +343,15 @@ int comdb2_objpool_destroy(comdb2_objpool_t op)
         hash_free(op->history);
         free(op->objs);
 
+        /* threads still holding a cache don't get to free it */
+        if (op->tcache_key_valid)
+            Pthread_key_delete(op->tcache_key);
+        while (op->tcaches != NULL) {
+            objpool_tcache *tc = op->tcaches;
+            op->tcaches = tc->next;
+            free(tc);
+        }
+
         Pthread_mutex_unlock(&op->data_mutex);
     }
 
@@ -358,6 +397,9 @@ int comdb2_objpool_setopt(comdb2_objpool_t op,
         case OP_IDLE_TIME:
             rc = opt_idle_time_ms(op, value);
             break;
+        case OP_THREAD_CACHE:
+            rc = opt_thread_cache(op, value);
+            break;
         default:
             rc = EINVAL;
             break;
@@ -369,6 +411,8 @@ int comdb2_objpool_setopt(comdb2_objpool_t op,
 
 int comdb2_objpool_return(comdb2_objpool_t op, void *obj)
 {
+    if (!op->stopped && tcache_put(op, obj))
+        return 0;
     return objpool_return_int(op, obj);
 }
 
@@ -435,6 +479,24 @@ int comdb2_objpool_stats(comdb2_objpool_t op)
     logmsg(LOGMSG_USER, "  # peak borrow waits  : %u\n", op->npeakborrowwaits);
     logmsg(LOGMSG_USER, "  Capacity             : %u\n", op->capacity);
 
+    if (op->tcache_size == 0 && op->tcaches == NULL)
+        logmsg(LOGMSG_USER, "  Thread cache         : DISABLED\n");
+    else {
+        objpool_tcache *tc;
+        unsigned int ncached = 0, nhits = op->ntcachehits;
+        int i;
+        for (tc = op->tcaches; tc != NULL; tc = tc->next) {
+            for (i = 0; i != OP_THREAD_CACHE_MAX; ++i)
+                if (tc->slots[i] != NULL)
+                    ++ncached;
+            nhits += tc->nhits;
+        }
+        logmsg(LOGMSG_USER, "  Thread cache         : %d\n", op->tcache_size);
+        logmsg(LOGMSG_USER, "  # thread-cached      : %u\n", ncached);
+        logmsg(LOGMSG_USER, "  # thread cache hits  : %u\n", nhits);
+        logmsg(LOGMSG_USER, "  # thread cache steals: %u\n", op->ntcachesteals);
+    }
+
     /* configuration */
     if (op->max_idles == OPT_DISABLE || op->max_idle_ratio != OPT_DISABLE)
         logmsg(LOGMSG_USER, "  # max idles          : DISABLED\n");
@@ -566,6 +628,11 @@ static int comdb2_objpool_create_int(comdb2_objpool_t *opp, const char *name,
     op->min_idles = 8;
     op->min_idle_ratio = OPT_DISABLE;
     op->idle_time_ms = 300000;
+    op->tcache_size = 0;
+    op->tcache_key_valid = 0;
+    op->tcaches = NULL;
+    op->ntcachehits = 0;
+    op->ntcachesteals = 0;
 
     op->evict_thd_run = 0;
     op->stopped = 0;
@@ -766,6 +833,9 @@ static int objpool_borrow_int(comdb2_objpool_t op, void **objp, long nanosecs,
     if (op->stopped)
         return EPERM;
 
+    if (tcache_get(op, objp))
+        return 0;
+
     Pthread_mutex_lock(&op->data_mutex);
 
     if (op->stopped) {
@@ -776,6 +846,11 @@ static int objpool_borrow_int(comdb2_objpool_t op, void **objp, long nanosecs,
 retry:
 
     if (exhausted(op)) {
+        if (tcache_steal_ll(op, objp)) {
+            Pthread_mutex_unlock(&op->data_mutex);
+            return 0;
+        }
+
         if (!full(op)) {
             /*
              ** if pool is not full, create a new object and an access
@@ -847,6 +922,17 @@ retry:
             if (op->nborrowwaits > op->npeakborrowwaits)
                 op->npeakborrowwaits = op->nborrowwaits;
 
+            /*
+            ** a thread which parked an object before it could
+            ** see us waiting takes it back after. pair with it
+            */
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            if (tcache_steal_ll(op, objp)) {
+                --op->nborrowwaits;
+                Pthread_mutex_unlock(&op->data_mutex);
+                return 0;
+            }
+
             rc = 0;
             if (nanosecs < 0)
                 Pthread_cond_wait(&op->unexhausted, &op->data_mutex);
@@ -1130,6 +1216,8 @@ static void objpool_evict_all_int(comdb2_objpool_t op)
 
     Pthread_mutex_lock(&op->data_mutex);
 
+    tcache_drain_ll(op);
+
     int nidles = nidles(op);
 
     for (indx = 0; indx < nidles; ++indx) {
@@ -1169,7 +1257,12 @@ static int opt_capacity(comdb2_objpool_t op, int value)
        that can be copied to the new ring buffer */
     size_t nidleobjscpy;
 
-    if (value <= 0 || value < op->nactiveobjs)
+    if (value <= 0)
+        return EINVAL;
+
+    /* cached objects count as active */
+    tcache_drain_ll(op);
+    if (value < op->nactiveobjs)
         return EINVAL;
 
     nidleobjscpy = min(value, op->nobjs) - op->nactiveobjs;
@@ -1330,6 +1423,173 @@ static int opt_idle_time_ms(comdb2_objpool_t op, int value)
     return 0;
 }
 
+static int opt_thread_cache(comdb2_objpool_t op, int value)
+{
+    if (value < 0 || value > OP_THREAD_CACHE_MAX)
+        return EINVAL;
+    if (!op->tcache_key_valid && value != 0) {
+        Pthread_key_create(&op->tcache_key, tcache_destroy);
+        op->tcache_key_valid = 1;
+    }
+    /*
+    ** objects left in slots past a smaller size are
+    ** still found by tcache_steal_ll() and drains
+    */
+    __atomic_store_n(&op->tcache_size, value, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int tcache_get(comdb2_objpool_t op, void **objp)
+{
+    objpool_tcache *tc;
+    void *obj;
+    int i, n;
+
+    n = __atomic_load_n(&op->tcache_size, __ATOMIC_ACQUIRE);
+    if (n == 0 || (tc = pthread_getspecific(op->tcache_key)) == NULL)
+        return 0;
+
+    for (i = n - 1; i >= 0; --i) {
+        if (tc->slots[i] != NULL &&
+            (obj = __atomic_exchange_n(&tc->slots[i], NULL,
+                                       __ATOMIC_SEQ_CST)) != NULL) {
+            ++tc->nhits;
+            *objp = obj;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int tcache_put(comdb2_objpool_t op, void *obj)
+{
+    objpool_tcache *tc;
+    void *expected;
+    int i, n;
+
+    /*
+    ** forced objects are deleted when returned, and a
+    ** return is what wakes up waiting borrowers
+    */
+    n = __atomic_load_n(&op->tcache_size, __ATOMIC_ACQUIRE);
+    if (n == 0 || op->nforcedobjs != 0 || op->nborrowwaits != 0)
+        return 0;
+
+    tc = pthread_getspecific(op->tcache_key);
+    if (tc == NULL) {
+        if ((tc = calloc(1, sizeof(objpool_tcache))) == NULL)
+            return 0;
+        tc->op = op;
+        Pthread_mutex_lock(&op->data_mutex);
+        tc->next = op->tcaches;
+        op->tcaches = tc;
+        Pthread_mutex_unlock(&op->data_mutex);
+        Pthread_setspecific(op->tcache_key, tc);
+    }
+
+    for (i = 0; i != n; ++i) {
+        expected = NULL;
+        if (tc->slots[i] == NULL &&
+            __atomic_compare_exchange_n(&tc->slots[i], &expected, obj, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+            break;
+    }
+    if (i == n)
+        return 0;
+
+    /*
+    ** a borrower may have started waiting without seeing the object.
+    ** if no one has stolen it since, return it the slow way
+    */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (op->nborrowwaits != 0 &&
+        __atomic_exchange_n(&tc->slots[i], NULL, __ATOMIC_SEQ_CST) != NULL)
+        return 0;
+
+    OP_DBG(op, "returned to thread cache");
+    return 1;
+}
+
+static int tcache_steal_ll(comdb2_objpool_t op, void **objp)
+{
+    objpool_tcache *tc;
+    void *obj;
+    int i;
+
+    for (tc = op->tcaches; tc != NULL; tc = tc->next) {
+        for (i = 0; i != OP_THREAD_CACHE_MAX; ++i) {
+            if (tc->slots[i] != NULL &&
+                (obj = __atomic_exchange_n(&tc->slots[i], NULL,
+                                           __ATOMIC_SEQ_CST)) != NULL) {
+                ++op->ntcachesteals;
+                OP_DBG(op, "stolen from thread cache");
+                *objp = obj;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void tcache_unpark_ll(comdb2_objpool_t op, void *obj)
+{
+    pooled_object *rec;
+
+    rec = (pooled_object *)hash_find_readonly(op->history, &obj);
+    if (rec == NULL) {
+        /* a forced object slipped in */
+        --op->nforcedobjs;
+        if (op->del_fn != NULL)
+            op->del_fn(obj, op->del_arg);
+        return;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &rec->tm);
+    ++rec->nreturns;
+    rec->active = 0;
+    op->put_impl(op, obj);
+    --op->nactiveobjs;
+}
+
+static void tcache_drain_ll(comdb2_objpool_t op)
+{
+    objpool_tcache *tc;
+    void *obj;
+    int i;
+
+    for (tc = op->tcaches; tc != NULL; tc = tc->next) {
+        for (i = 0; i != OP_THREAD_CACHE_MAX; ++i) {
+            obj = __atomic_exchange_n(&tc->slots[i], NULL, __ATOMIC_SEQ_CST);
+            if (obj != NULL)
+                tcache_unpark_ll(op, obj);
+        }
+    }
+}
+
+/* thread exit: put cached objects back in the pool */
+static void tcache_destroy(void *arg)
+{
+    objpool_tcache *tc = arg, **pp;
+    comdb2_objpool_t op = tc->op;
+    void *obj;
+    int i;
+
+    Pthread_mutex_lock(&op->data_mutex);
+    for (pp = &op->tcaches; *pp != tc; pp = &(*pp)->next)
+        ;
+    *pp = tc->next;
+    op->ntcachehits += tc->nhits;
+    for (i = 0; i != OP_THREAD_CACHE_MAX; ++i) {
+        obj = __atomic_exchange_n(&tc->slots[i], NULL, __ATOMIC_SEQ_CST);
+        if (obj != NULL)
+            tcache_unpark_ll(op, obj);
+    }
+    if (op->nborrowwaits != 0)
+        Pthread_cond_broadcast(&op->unexhausted);
+    Pthread_mutex_unlock(&op->data_mutex);
+    free(tc);
+}
+
 static const char *objpool_type_name(comdb2_objpool_t op)
 {
     switch (op->type) {
@@ -10,6 +10,7 @@
 
 #include "perf.h"
 #include "averager.h"
+#include "hdrhist.h"
 #include "list.h"
 #include <locks_wrap.h>
 
@@ -27,6 +28,12 @@ int gbl_metric_maxage = 30;
 struct time_metric {
     char *name;
     struct averager *avg;
+    /* optional latency histograms: everything since start, and snapshots of
+     * it taken gbl_metric_maxage seconds apart for the recent window */
+    struct hdrhist *hist;
+    struct hdrhist *hist_older;
+    struct hdrhist *hist_newer;
+    time_t hist_rolled;
     pthread_mutex_t lk;
     LINKC_T(struct time_metric) lnk;
 };
@@ -71,9 +78,82 @@ void time_metric_free(struct time_metric *t)
     free(t->name);
     if (t->avg)
         averager_destroy(t->avg);
+    hdrhist_free(t->hist);
+    hdrhist_free(t->hist_older);
+    hdrhist_free(t->hist_newer);
     free(t);
 }
 
+/* Keep an HDR histogram of everything added to this metric, for
+ * percentiles.  Meant for latencies; averages hide their tails. */
+int time_metric_enable_hist(struct time_metric *t)
+{
+    if (t->hist)
+        return 0;
+    t->hist = hdrhist_new();
+    t->hist_older = hdrhist_new();
+    t->hist_newer = hdrhist_new();
+    if (!t->hist || !t->hist_older || !t->hist_newer) {
+        hdrhist_free(t->hist);
+        hdrhist_free(t->hist_older);
+        hdrhist_free(t->hist_newer);
+        t->hist = t->hist_older = t->hist_newer = NULL;
+        return -1;
+    }
+    t->hist_rolled = comdb2_time_epoch();
+    return 0;
+}
+
+int time_metric_has_hist(struct time_metric *t)
+{
+    return t->hist != NULL;
+}
+
+/* Age the recent window; called periodically.  The window then spans the
+ * last gbl_metric_maxage to 2 * gbl_metric_maxage seconds. */
+void time_metric_roll_hist(struct time_metric *t)
+{
+    time_t now = comdb2_time_epoch();
+
+    if (!t->hist || now - t->hist_rolled < gbl_metric_maxage)
+        return;
+    Pthread_mutex_lock(&t->lk);
+    hdrhist_copy(t->hist_older, t->hist_newer);
+    hdrhist_copy(t->hist_newer, t->hist);
+    t->hist_rolled = now;
+    Pthread_mutex_unlock(&t->lk);
+}
+
+/* Copy of the histogram, either since start or over the recent window.
+ * Caller frees with hdrhist_free(); NULL if the metric has none. */
+struct hdrhist *time_metric_get_hist(struct time_metric *t, int recent)
+{
+    struct hdrhist *h;
+
+    if (!t->hist || (h = hdrhist_new()) == NULL)
+        return NULL;
+    Pthread_mutex_lock(&t->lk);
+    if (recent)
+        hdrhist_diff(h, t->hist, t->hist_older);
+    else
+        hdrhist_copy(h, t->hist);
+    Pthread_mutex_unlock(&t->lk);
+    return h;
+}
+
+/* pct'th percentile over the recent window */
+int64_t time_metric_percentile(struct time_metric *t, double pct)
+{
+    struct hdrhist *h = time_metric_get_hist(t, 1);
+    int64_t v;
+
+    if (h == NULL)
+        return 0;
+    v = hdrhist_percentile(h, pct);
+    hdrhist_free(h);
+    return v;
+}
+
 void time_metric_add(struct time_metric *t, int value) {
     if (!gbl_timeseries_metrics)
         return;
@@ -82,6 +162,8 @@ void time_metric_add(struct time_metric *t, int value) {
 
     Pthread_mutex_lock(&t->lk);
     averager_add(t->avg, value, now);
+    if (t->hist)
+        hdrhist_record(t->hist, value);
     Pthread_mutex_unlock(&t->lk);
 }
 
@@ -1,6 +1,7 @@
 #ifndef INCLUDED_PERF_H
 #define INCLUDED_PERF_H
 
+#include <stdint.h>
 #include "averager.h"
 
 struct time_metric;
@@ -17,4 +18,11 @@ double time_metric_average(struct time_metric *t);
 int time_metric_max(struct time_metric *t);
 void time_metric_purge_old(struct time_metric *t);
 
+struct hdrhist;
+int time_metric_enable_hist(struct time_metric *t);
+int time_metric_has_hist(struct time_metric *t);
+void time_metric_roll_hist(struct time_metric *t);
+struct hdrhist *time_metric_get_hist(struct time_metric *t, int recent);
+int64_t time_metric_percentile(struct time_metric *t, double pct);
+
 #endif
@@ -100,7 +100,9 @@ hash_t *hash_init_ptr(void)
 
 typedef void *hash_kfnd_t(hash_t *const h, const void *const restrict vkey);
 
-enum hash_scheme { HASH_BY_PRIMES, HASH_BY_POWER2 };
+/* HASH_BY_FLAT tables are open-addressed (see hash_init_flat_o()) and keep
+ * no hashents; htab stays pointed at starter_htab for their lifetime. */
+enum hash_scheme { HASH_BY_PRIMES, HASH_BY_POWER2, HASH_BY_FLAT };
 
 typedef struct hashent {
     struct hashent *next;
@@ -152,6 +154,10 @@ struct hash {
     hashmalloc_t *malloc_fn;
     hashfree_t *free_fn;
     enum hash_scheme scheme;
+    unsigned char *ctrl;   /* HASH_BY_FLAT: one control byte per slot */
+    unsigned char **slots; /* HASH_BY_FLAT: objects, parallel to ctrl */
+    unsigned int ngroups;  /* HASH_BY_FLAT: power of 2 */
+    unsigned int nused;    /* HASH_BY_FLAT: full + deleted slots */
 };
 
 
@@ -1045,6 +1051,239 @@ static unsigned int hash_default_i4(const unsigned int *a,
 
 #define is_lockfree_query(h) 0
 
+/*
+ * Open addressing for fixed size keys (HASH_BY_FLAT).
+ *
+ * Slots are grouped 16 at a time, and each slot has a control byte: the top
+ * bit is set for empty and deleted slots, otherwise the low 7 bits hold the
+ * low 7 bits of the key's hash.  A lookup selects a group from the rest of
+ * the hash, compares all 16 control bytes against the 7-bit tag at once, and
+ * only dereferences the objects whose tag matches.  Groups are probed
+ * linearly until one containing an empty slot is seen.  Compared to chains,
+ * a miss usually costs one 16 byte load, and a hit one object dereference.
+ */
+#define FLAT_GROUP 16
+#define FLAT_EMPTY 0x80
+#define FLAT_DELETED 0xfe
+#define FLAT_FULL(c) (((c)&0x80) == 0)
+#define FLAT_TAG(hh) ((hh)&0x7f)
+#define FLAT_GRP(h, hh) (((hh) >> 7) & ((h)->ngroups - 1))
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+/* bitmask of slots in group g whose control byte is c */
+static inline unsigned int flat_match(const unsigned char *g, unsigned char c)
+{
+    const __m128i ctrl = _mm_loadu_si128((const __m128i *)g);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)c)));
+}
+
+/* bitmask of empty or deleted slots in group g */
+static inline unsigned int flat_match_free(const unsigned char *g)
+{
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)g));
+}
+#else
+static inline unsigned int flat_match(const unsigned char *g, unsigned char c)
+{
+    unsigned int ii, m = 0;
+    for (ii = 0; ii < FLAT_GROUP; ++ii)
+        m |= (g[ii] == c) << ii;
+    return m;
+}
+
+static inline unsigned int flat_match_free(const unsigned char *g)
+{
+    unsigned int ii, m = 0;
+    for (ii = 0; ii < FLAT_GROUP; ++ii)
+        m |= (g[ii] >> 7) << ii;
+    return m;
+}
+#endif
+
+#ifdef __GNUC__
+#define flat_ctz(m) __builtin_ctz(m)
+#else
+static inline unsigned int flat_ctz(unsigned int m)
+{
+    unsigned int n = 0;
+    while (!(m & 1)) {
+        m >>= 1;
+        ++n;
+    }
+    return n;
+}
+#endif
+
+/* slot index of the next object matching key, probing from group g but
+ * skipping its first 'skip' slots; -1 if none */
+static int flat_probe(hash_t *const h, const void *const restrict key,
+                      const unsigned int hh, unsigned int g, unsigned int skip)
+{
+    const unsigned int mask = h->ngroups - 1;
+    const unsigned char tag = FLAT_TAG(hh);
+    unsigned int m, ii, nsteps = 0;
+
+    if (h->ngroups == 0)
+        return -1;
+    for (;;) {
+        const unsigned char *const ctrl = h->ctrl + g * FLAT_GROUP;
+        m = flat_match(ctrl, tag) & (~0U << skip);
+        for (; m; m &= m - 1) {
+            ii = g * FLAT_GROUP + flat_ctz(m);
+            if (CMP(h, key, &h->slots[ii][h->keyoff]) == 0) {
+                if (h->maxsteps < nsteps)
+                    h->maxsteps = nsteps;
+                h->nsteps += nsteps;
+                return ii;
+            }
+        }
+        /* the table is never full, so some group has an empty slot */
+        if (flat_match(ctrl, FLAT_EMPTY))
+            break;
+        g = (g + 1) & mask;
+        skip = 0;
+        ++nsteps;
+    }
+    if (h->maxsteps < nsteps)
+        h->maxsteps = nsteps;
+    h->nsteps += nsteps;
+    return -1;
+}
+
+static void *flat_hash_kfnd(hash_t *const h, const void *const restrict vkey)
+{
+    const unsigned int hh = HASH(h, vkey);
+    const int ii =
+        h->ngroups ? flat_probe(h, vkey, hh, FLAT_GRP(h, hh), 0)
+                   : -1;
+    if (ii < 0) {
+        h->nmisses++;
+        return 0;
+    }
+    h->nhits++;
+    return h->slots[ii];
+}
+
+static void *flat_hash_kfnd_nofrills(hash_t *const h,
+                                     const void *const restrict vkey)
+{
+    const unsigned int mask = h->ngroups - 1;
+    const unsigned int hh = HASH(h, vkey);
+    const unsigned char tag = FLAT_TAG(hh);
+    unsigned int g, m, ii;
+
+    if (h->ngroups == 0)
+        return 0;
+    for (g = FLAT_GRP(h, hh);; g = (g + 1) & mask) {
+        const unsigned char *const ctrl = h->ctrl + g * FLAT_GROUP;
+        for (m = flat_match(ctrl, tag); m; m &= m - 1) {
+            ii = g * FLAT_GROUP + flat_ctz(m);
+            if (CMP(h, vkey, &h->slots[ii][h->keyoff]) == 0)
+                return h->slots[ii];
+        }
+        if (flat_match(ctrl, FLAT_EMPTY))
+            return 0;
+    }
+}
+
+/* place obj in the first free slot of its probe sequence */
+static void flat_insert(hash_t *const h, unsigned char *const obj,
+                        const unsigned int hh)
+{
+    const unsigned int mask = h->ngroups - 1;
+    unsigned int g, m, ii;
+    for (g = FLAT_GRP(h, hh);; g = (g + 1) & mask) {
+        if ((m = flat_match_free(h->ctrl + g * FLAT_GROUP)) != 0)
+            break;
+    }
+    ii = g * FLAT_GROUP + flat_ctz(m);
+    if (h->ctrl[ii] == FLAT_EMPTY)
+        h->nused++;
+    h->ctrl[ii] = FLAT_TAG(hh);
+    h->slots[ii] = obj;
+}
+
+/* allocate ngroups groups and reinsert all objects, dropping tombstones */
+static int flat_rehash(hash_t *const h, unsigned int ngroups)
+{
+    const unsigned int nslots = ngroups * FLAT_GROUP;
+    const unsigned int oslots = h->ngroups * FLAT_GROUP;
+    unsigned char **const oslot = h->slots;
+    unsigned char *const octrl = h->ctrl;
+    unsigned char **slots;
+    unsigned int ii;
+
+    /* slots first to keep them pointer aligned; control bytes follow */
+    slots = h->malloc_fn(nslots * (sizeof(unsigned char *) + 1));
+    if (slots == 0)
+        return -1;
+    h->slots = slots;
+    h->ctrl = (unsigned char *)(slots + nslots);
+    memset(h->ctrl, FLAT_EMPTY, nslots);
+    h->ngroups = ngroups;
+    h->nused = 0;
+    for (ii = 0; ii < oslots; ++ii) {
+        if (FLAT_FULL(octrl[ii]))
+            flat_insert(h, oslot[ii], HASH(h, &oslot[ii][h->keyoff]));
+    }
+    if (oslot) {
+        h->free_fn(oslot);
+        h->ngrow++;
+    }
+    return 0;
+}
+
+static int flat_add(hash_t *const h, unsigned char *const obj)
+{
+    /* keep at most 7/8 of the slots full or deleted; when that is hit,
+     * rehash into a table sized for the live entries at under half load
+     * (which reclaims tombstones without growing when deletes dominate) */
+    if ((h->nused + 1) * 8 > h->ngroups * FLAT_GROUP * 7) {
+        unsigned int ngroups = h->ngroups ? h->ngroups : 1;
+        while ((h->nents + 1) * 2 > ngroups * FLAT_GROUP)
+            ngroups <<= 1;
+        if (flat_rehash(h, ngroups))
+            return -1;
+    }
+    flat_insert(h, obj, HASH(h, &obj[h->keyoff]));
+    h->nadds++;
+    h->nents++;
+    return 0;
+}
+
+static int flat_delk(hash_t *const h, const void *const key)
+{
+    const unsigned int hh = HASH(h, key);
+    const int ii =
+        h->ngroups ? flat_probe(h, key, hh, FLAT_GRP(h, hh), 0)
+                   : -1;
+    if (ii < 0)
+        return -1;
+    /* a group with an empty slot already terminates every probe sequence
+     * through it, so the slot can go back to empty; otherwise later groups
+     * may hold entries that probed past this one, so leave a tombstone */
+    if (flat_match(h->ctrl + (ii & ~(FLAT_GROUP - 1)), FLAT_EMPTY)) {
+        h->ctrl[ii] = FLAT_EMPTY;
+        h->nused--;
+    } else {
+        h->ctrl[ii] = FLAT_DELETED;
+    }
+    h->ndels++;
+    h->nents--;
+    return 0;
+}
+
+/* next full slot at or after slot ii, or nslots */
+static unsigned int flat_next_full(hash_t *const h, unsigned int ii)
+{
+    const unsigned int nslots = h->ngroups * FLAT_GROUP;
+    while (ii < nslots && !FLAT_FULL(h->ctrl[ii]))
+        ++ii;
+    return ii;
+}
+
 /* enable stats for query steps and flipping found entry to head of chain.
  * or, disable stats and set query function to *_nofrills, which skips stats
  * and is always readonly (required when configuring lockfree query) */
@@ -1060,6 +1299,9 @@ void hash_config_query_stats(hash_t *const h, const int enable)
         } else if (h->hash_kfnd_fn == i4_hash_kfnd_nofrills) {
             h->hash_kfnd_fn = i4_hash_kfnd;
             h->hash_kfnd_fn_readonly = i4_hash_kfnd_readonly;
+        } else if (h->hash_kfnd_fn == flat_hash_kfnd_nofrills) {
+            h->hash_kfnd_fn = flat_hash_kfnd;
+            h->hash_kfnd_fn_readonly = flat_hash_kfnd;
         }
     } else {
         if (h->hash_kfnd_fn == default_hash_kfnd) {
@@ -1071,6 +1313,9 @@ void hash_config_query_stats(hash_t *const h, const int enable)
         } else if (h->hash_kfnd_fn == i4_hash_kfnd) {
             h->hash_kfnd_fn = i4_hash_kfnd_nofrills;
             h->hash_kfnd_fn_readonly = i4_hash_kfnd_nofrills;
+        } else if (h->hash_kfnd_fn == flat_hash_kfnd) {
+            h->hash_kfnd_fn = flat_hash_kfnd_nofrills;
+            h->hash_kfnd_fn_readonly = flat_hash_kfnd_nofrills;
         }
     }
 }
@@ -1188,6 +1433,18 @@ hash_t *hash_init_jenkins_o(int keyoff, int keylen)
                          HASH_BY_POWER2);
 }
 
+/* Open-addressed table for fixed len keys (see HASH_BY_FLAT above).  Same
+ * API and locking rules as the chained tables; lookups stay readonly, but
+ * hash_add() may move every object and must not race hash_find(). */
+hash_t *hash_init_flat_o(int keyoff, int keylen)
+{
+    if (keylen <= 0)
+        return 0;
+    return hash_init_int((hashfunc_t *)jenkins_hashbig, (cmpfunc_t *)memcmp,
+                         malloc, free, keyoff, keylen, flat_hash_kfnd,
+                         HASH_BY_FLAT);
+}
+
 hash_t *hash_init(int keylen)
 {
     return hash_init_user((hashfunc_t *)hash_default_fixedwidth,
@@ -1198,6 +1455,15 @@ int hash_initsize(hash_t *h, unsigned int sz)
 {
     const size_t tsz = sizeof(hashtable) + sz * sizeof(hashent *);
 
+    if (h->scheme == HASH_BY_FLAT) {
+        unsigned int ngroups = 1;
+        if (sz == 0 || h->ngroups)
+            return -1;
+        while (sz * 8 > ngroups * FLAT_GROUP * 7)
+            ngroups <<= 1;
+        return flat_rehash(h, ngroups);
+    }
+
     if (sz == 0 || h->htab != STARTER_HTAB)
         return -1;
 
@@ -1237,6 +1503,69 @@ void *hash_find_readonly(hash_t *const restrict h,
     return h->hash_kfnd_fn_readonly(h, key);
 }
 
+/* walk the chain from he for the next object matching key */
+static void *hash_find_chain(hash_t *const h, const void *const restrict key,
+                             const unsigned int hh, hashent *he,
+                             void **const ent)
+{
+    const int keyoff = h->keyoff; /* key offset */
+
+    while (he && !(he->hash == hh && CMP(h, key, &he->obj[keyoff]) == 0))
+        he = he->next;
+    *ent = he;
+    if (he) {
+        h->nhits++;
+        return he->obj;
+    }
+    return 0;
+}
+
+void *hash_find_first(hash_t *const h, const void *const restrict key,
+                      void **const ent)
+{
+    hashtable *const htab = h->htab;
+    const unsigned int hh = HASH(h, key);
+    if (h->scheme == HASH_BY_FLAT) {
+        /* ent is 1 + slot index of the match */
+        const int ii =
+            h->ngroups ? flat_probe(h, key, hh, FLAT_GRP(h, hh), 0)
+                       : -1;
+        *ent = (void *)(intptr_t)(ii + 1);
+        if (ii < 0) {
+            h->nmisses++;
+            return 0;
+        }
+        h->nhits++;
+        return h->slots[ii];
+    }
+    const unsigned int ii = h->scheme == HASH_BY_POWER2
+                                ? hh & (htab->ntbl - 1)
+                                : BUCKET(hh, htab->ntbl);
+    void *obj = hash_find_chain(h, key, hh, htab->tbl[ii], ent);
+    if (!obj)
+        h->nmisses++;
+    return obj;
+}
+
+void *hash_find_next(hash_t *const h, const void *const restrict key,
+                     void **const ent)
+{
+    hashent *he = (hashent *)(*ent);
+    if (!he)
+        return 0;
+    if (h->scheme == HASH_BY_FLAT) {
+        const unsigned int last = (unsigned int)(intptr_t)he - 1;
+        const int ii = flat_probe(h, key, HASH(h, key), last / FLAT_GROUP,
+                                  last % FLAT_GROUP + 1);
+        *ent = (void *)(intptr_t)(ii + 1);
+        if (ii < 0)
+            return 0;
+        h->nhits++;
+        return h->slots[ii];
+    }
+    return hash_find_chain(h, key, HASH(h, key), he->next, ent);
+}
+
 /*
  * hash_inctbl() resizes hash table (hash_inctbl() called only from hash_add())
  */
@@ -1441,6 +1770,8 @@ int hash_add(hash_t *h, void *vobj)
     hashtable *restrict htab = h->htab;
     hashent *restrict he;
     hashent **tbl;
+    if (h->scheme == HASH_BY_FLAT)
+        return flat_add(h, obj);
     if (h->nents >= htab->ntbl >> 1) {
         if ((htab = hash_inctbl(h)) == STARTER_HTAB)
             return -1; /*(failed to resize starter_htab)*/
@@ -1461,6 +1792,8 @@ int hash_add(hash_t *h, void *vobj)
 int hash_delk(hash_t *const h, const void *const key)
 {
     /* must be protected by mutex in threaded application */
+    if (h->scheme == HASH_BY_FLAT)
+        return flat_delk(h, key);
     hashtable *const restrict htab = h->htab;
     unsigned int nsteps = 0;
     const unsigned int hh = HASH(h, key);
@@ -1528,6 +1861,10 @@ void hash_clear(hash_t *const h)
 {
     hashfree_t *const h_free = h->free_fn;
     hashtable *nxtab, *restrict htab = h->htab;
+    if (h->ngroups) {
+        memset(h->ctrl, FLAT_EMPTY, h->ngroups * FLAT_GROUP);
+        h->nused = 0;
+    }
     if (htab != STARTER_HTAB) {
         /* pool_clear() below will reclaim hashents) */
         memset(htab->tbl, 0, htab->ntbl * sizeof(hashent *));
@@ -1553,6 +1890,8 @@ void hash_free(hash_t *const h)
     }
     if (h->htab != STARTER_HTAB)
         h_free(h->htab);
+    if (h->slots)
+        h_free(h->slots);
     pool_free(h->ents);
     memset(h, -1, sizeof(*h)); /* zap it */
     h_free(h);
@@ -1608,6 +1947,28 @@ void hash_dump_stats(hash_t *h, FILE *out, FILE *detail_out)
     int nused;
     char buf[160];
     hashent *he;
+    if (h->scheme == HASH_BY_FLAT) {
+        const unsigned int nslots = h->ngroups * FLAT_GROUP;
+        logmsgf(LOGMSG_USER, out, "Key Size = %-10u      #Ents = %-10u\n", h->keysz, h->nents);
+        logmsgf(LOGMSG_USER, out, "#Slots   = %-10u      #Used = %-10u\n", nslots, h->nused);
+        logmsgf(LOGMSG_USER, out, "#Steps   = %-10u   MaxSteps = %-10u\n", h->nsteps,
+                h->maxsteps);
+        logmsgf(LOGMSG_USER, out, "#Hits    = %-10u    #Misses = %-10u\n", h->nhits, h->nmisses);
+        logmsgf(LOGMSG_USER, out, "#Adds    = %-10u      #Dels = %-10u\n", h->nadds, h->ndels);
+        logmsgf(LOGMSG_USER, out, "#TBLgrow = %-10u  #Deleted = %-10u\n", h->ngrow,
+                h->nused - h->nents);
+        bzero(cnts, sizeof(cnts));
+        for (ii = 0; ii < h->ngroups; ii++) {
+            unsigned int nfull = 0;
+            for (jj = 0; jj < FLAT_GROUP; jj++)
+                nfull += FLAT_FULL(h->ctrl[ii * FLAT_GROUP + jj]);
+            cnts[nfull < 15 ? nfull : 15]++;
+        }
+        for (ii = 0; ii < 16; ii++)
+            logmsgf(LOGMSG_USER, out, "# OF GROUPS WITH %s%2d FULL SLOTS: %d\n",
+                    ii == 15 ? ">=" : "  ", ii, cnts[ii]);
+        return;
+    }
     pool_info(h->ents, 0, &nused, 0);
     logmsgf(LOGMSG_USER, out, "Key Size = %-10u      #Ents = %-10u\n", h->keysz, h->nents);
     logmsgf(LOGMSG_USER, out, "#Table   = %-10u      #Used = %-10d\n", ntbl, nused);
@@ -1647,6 +2008,17 @@ int hash_for(hash_t *const h, hashforfunc_t *const func,
     hashent **const tbl = htab->tbl;
     const unsigned int ntbl = htab->ntbl;
 
+    if (h->scheme == HASH_BY_FLAT) {
+        /* func may delete the object it is handed */
+        for (ii = flat_next_full(h, 0); ii < h->ngroups * FLAT_GROUP;
+             ii = flat_next_full(h, ii + 1)) {
+            rc = (*func)(h->slots[ii], arg);
+            if (rc != 0)
+                return rc; /*terminate walk*/
+        }
+        return 0;
+    }
+
     for (ii = 0; ii < ntbl; ii++) {
         for (he = tbl[ii]; he; he = nhe) {
             nhe = he->next;
@@ -1667,6 +2039,13 @@ void *hash_first(hash_t *const h, void **const ent,
     const unsigned int ntbl = htab->ntbl;
     unsigned int ii;
 
+    if (h->scheme == HASH_BY_FLAT) {
+        /* bkt is the slot index, ent is unused */
+        *ent = 0;
+        *bkt = ii = flat_next_full(h, 0);
+        return ii < h->ngroups * FLAT_GROUP ? h->slots[ii] : 0;
+    }
+
     for (ii = 0; ii < ntbl && !(he = tbl[ii]); ++ii)
         ;
     *bkt = ii;
@@ -1681,6 +2060,11 @@ void *hash_next(hash_t *const h, void **const ent,
                 unsigned int *const restrict bkt)
 {
     hashent *restrict he = (hashent *)(*ent);
+    if (h->scheme == HASH_BY_FLAT) {
+        const unsigned int ii = flat_next_full(h, *bkt + 1);
+        *bkt = ii;
+        return ii < h->ngroups * FLAT_GROUP ? h->slots[ii] : 0;
+    }
     if (!he) {
         hashtable *const htab = h->htab;
         hashent **const tbl = htab->tbl;
@@ -1707,7 +2091,8 @@ void hash_info2(hash_t *h, int *nhits, int *nmisses, int *nsteps, int *ntbl,
     if (nsteps)
         *nsteps = h->nsteps;
     if (ntbl)
-        *ntbl = h->htab->ntbl;
+        *ntbl = h->scheme == HASH_BY_FLAT ? h->ngroups * FLAT_GROUP
+                                          : h->htab->ntbl;
     if (nents)
         *nents = h->nents;
     if (nadds)
@@ -203,6 +203,31 @@ int quantize_dump(struct quantize *q, FILE *ff)
     return 0;
 }
 
+/* print the non-empty buckets as "<=step:count ... >last:count" */
+int quantize_tostr(struct quantize *q, char *buf, int len)
+{
+    int i, n, off = 0;
+    if (len <= 0)
+        return 0;
+    buf[0] = 0;
+    if (q->cnts == 0)
+        return 0;
+    for (i = 0; i <= q->qnum && off < len; i++) {
+        if (q->cnts[i] == 0)
+            continue;
+        if (i == q->qnum)
+            n = snprintf(buf + off, len - off, "%s>%d:%d", off ? " " : "",
+                         (q->qnum - 1) * q->step, q->cnts[i]);
+        else
+            n = snprintf(buf + off, len - off, "%s<=%d:%d", off ? " " : "",
+                         i * q->step, q->cnts[i]);
+        if (n < 0)
+            break;
+        off += n;
+    }
+    return off < len ? off : len - 1;
+}
+
 #include <plhash.h>
 
 struct qobj {
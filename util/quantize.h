@@ -38,6 +38,9 @@ int quantize_consolidate(struct quantize *dest, struct quantize *source);
 int quantize_dump(struct quantize *q, FILE *ff);
 
 void quantize_clear(struct quantize *q);
+
+/* print non-empty buckets into buf; returns the length written */
+int quantize_tostr(struct quantize *q, char *buf, int len);
 int quantize_ctrace(struct quantize *q, char *title);
 
 /* OBJECT COUNTS */
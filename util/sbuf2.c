@@ -163,6 +163,8 @@ int SBUF2_FUNC(sbuf2close)(SBUF2 *sb)
     return sbuf2free(sb);
 }
 
+static int sbuf2write_direct(SBUF2 *sb, char *ptr, int nbytes);
+
 /* flush output */
 int SBUF2_FUNC(sbuf2flush)(SBUF2 *sb)
 {
@@ -263,6 +265,9 @@ int SBUF2_FUNC(sbuf2write)(char *ptr, int nbytes, SBUF2 *sb)
         if (sb->wbuf == NULL)
             return -1;
     }
+    /* a write at least a buffer long is not copied through wbuf */
+    if (nbytes >= sb->lbuf)
+        return sbuf2write_direct(sb, ptr, nbytes);
     off = 0;
     left = nbytes;
     while (left > 0) {
@@ -393,6 +398,25 @@ int SBUF2_FUNC(sbuf2gets)(char *out, int lout, SBUF2 *sb)
         return -1;
     lout--;
     for (ii = 0; ii < lout;) {
+#if SBUF2_UNGETC
+        if (sb->ungetc_buf_len == 0)
+#endif
+        if (sb->rtl != sb->rhd) {
+            /* take what is buffered up to the newline in one go */
+            int amt = sb->rhd - sb->rtl;
+            unsigned char *nl;
+            if (amt > lout - ii)
+                amt = lout - ii;
+            nl = memchr(&sb->rbuf[sb->rtl], '\n', amt);
+            if (nl)
+                amt = nl - &sb->rbuf[sb->rtl] + 1;
+            memcpy(&out[ii], &sb->rbuf[sb->rtl], amt);
+            sb->rtl += amt;
+            ii += amt;
+            if (nl)
+                break;
+            continue;
+        }
         cc = sbuf2getc(sb);
         if (cc < 0) {
             if (ii == 0)
@@ -456,17 +480,22 @@ static int sbuf2fread_int(char *ptr, int size, int nitems,
         /* if still need more data */
         if (need > 0) {
             int rc;
+            /* a read at least a buffer long goes straight to the caller's
+             * memory instead of being copied through rbuf */
+            int direct = need >= sb->lbuf - 1;
+            char *to = direct ? ptr + done : (char *)sb->rbuf;
+            int len = direct ? need : sb->lbuf - 1;
             sb->rtl = 0;
             sb->rhd = 0;
 #if SBUF2_SERVER
             void *ssl;
 ssl_downgrade:
             ssl = sb->ssl;
-            rc = sb->read(sb, (char *)sb->rbuf, sb->lbuf - 1);
+            rc = sb->read(sb, to, len);
             if (rc == 0 && sb->ssl != ssl)
                 goto ssl_downgrade;
 #else
-            rc = sb->read(sb, (char *)sb->rbuf, sb->lbuf - 1);
+            rc = sb->read(sb, to, len);
 #endif
             if (rc <= 0) {
                 if (rc == 0) { /* this is a timeout */
@@ -475,7 +504,12 @@ ssl_downgrade:
                 }
                 return (done / size);
             }
-            sb->rhd = rc;
+            if (direct) {
+                need -= rc;
+                done += rc;
+            } else {
+                sb->rhd = rc;
+            }
             continue;
         }
         break;
@@ -560,6 +594,79 @@ static int swrite(SBUF2 *sb, const char *cc, int len)
     return rc;
 }
 
+static int swritev_unsecure(SBUF2 *sb, const struct iovec *iov, int cnt)
+{
+    int rc;
+    struct pollfd pol;
+
+    if (sb->writetimeout > 0) {
+        do {
+            pol.fd = sb->fd;
+            pol.events = POLLOUT;
+            rc = poll(&pol, 1, sb->writetimeout);
+        } while (rc == -1 && errno == EINTR);
+
+        if (rc <= 0)
+            return rc; /*timed out or error*/
+        if ((pol.revents & POLLOUT) == 0)
+            return -100000 + pol.revents;
+    }
+    return writev(sb->fd, iov, cnt);
+}
+
+/* Write nbytes from ptr behind whatever is buffered, without copying them.
+ * With the default writer on a plaintext socket the buffered bytes and the
+ * caller's go out in one writev(); otherwise the buffer is flushed first.
+ * Returns nbytes, or how many of them were written before an error. */
+static int sbuf2write_direct(SBUF2 *sb, char *ptr, int nbytes)
+{
+    int rc, written = 0;
+
+    while (sb->whd != sb->wtl && sb->write == swrite && sb->ssl == NULL) {
+        struct iovec iov[3];
+        int cnt = 0, pending;
+        if (sb->wtl > sb->whd) {
+            iov[cnt].iov_base = &sb->wbuf[sb->wtl];
+            iov[cnt++].iov_len = sb->lbuf - sb->wtl;
+            iov[cnt].iov_base = sb->wbuf;
+            iov[cnt++].iov_len = sb->whd;
+            pending = sb->lbuf - sb->wtl + sb->whd;
+        } else {
+            iov[cnt].iov_base = &sb->wbuf[sb->wtl];
+            iov[cnt++].iov_len = sb->whd - sb->wtl;
+            pending = sb->whd - sb->wtl;
+        }
+        iov[cnt].iov_base = ptr;
+        iov[cnt++].iov_len = nbytes;
+        rc = swritev_unsecure(sb, iov, cnt);
+        if (rc <= 0)
+            return 0;
+        if (rc < pending) {
+            sb->wtl = (sb->wtl + rc) % sb->lbuf;
+            continue;
+        }
+        sb->whd = sb->wtl = 0;
+        written = rc - pending;
+    }
+    if (sbuf2flush(sb) < 0)
+        return 0;
+
+    while (written < nbytes) {
+#if SBUF2_SERVER
+        void *ssl = sb->ssl;
+        rc = sb->write(sb, ptr + written, nbytes - written);
+        if (rc == 0 && sb->ssl != ssl)
+            continue; /* ssl downgrade, see sbuf2flush() */
+#else
+        rc = sb->write(sb, ptr + written, nbytes - written);
+#endif
+        if (rc <= 0)
+            return written;
+        written += rc;
+    }
+    return nbytes;
+}
+
 int SBUF2_FUNC(sbuf2unbufferedwrite)(SBUF2 *sb, const char *cc, int len)
 {
     int n;
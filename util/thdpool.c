@@ -58,6 +58,26 @@ extern int thdpool_alarm_on_queing(int len);
 extern int gbl_disable_exit_on_thread_error;
 extern comdb2bma blobmem;
 
+/* Most queued work items a thread takes for itself in one go when the pool
+   is in work-stealing mode */
+#define THDPOOL_LOCAL_MAX 8
+
+/* Queued work is taken from the priority classes by stride scheduling: each
+   item taken from a class advances its pass by THDPOOL_STRIDE / weight, and
+   the waiting class with the lowest pass goes next. */
+#define THDPOOL_STRIDE 65536
+
+struct thdpool_class {
+    LISTC_T(struct workitem) queue; /* also on pool->queue, in arrival order */
+    unsigned weight;  /* share of the threads while other classes wait */
+    unsigned maxthds; /* most threads running this class' work, 0 for no limit */
+    unsigned nrunning;
+    uint64_t pass;
+
+    unsigned num_enqueued;
+    unsigned num_dequeued;
+    uint64_t waitms; /* total time dequeued items spent in the queue */
+};
 
 struct thd {
     pthread_t tid;
@@ -77,6 +97,16 @@ struct thd {
 
     int on_freelist;
 
+    /* Work-stealing mode: queued work items this thread took in a batch.
+     * The thread runs them without the pool lock; idle threads steal them
+     * from the other end.  Items it's done with go back to pool->pool the
+     * next time it holds the pool lock. */
+    pthread_mutex_t local_lk;
+    struct workitem *local[THDPOOL_LOCAL_MAX];
+    int local_head;
+    int local_cnt;
+    LISTC_T(struct workitem) spent;
+
     LINKC_T(struct thd) thdlist_linkv;
     LINKC_T(struct thd) freelist_linkv;
 };
@@ -126,6 +156,13 @@ struct thdpool {
     unsigned num_creates;
     unsigned num_exits;
     unsigned num_failed_dispatches;
+    unsigned num_stolen;
+
+    int worksteal; /* queued work is taken by threads in batches */
+    unsigned nlocal; /* work items held by threads in work-stealing mode */
+
+    struct thdpool_class classes[THDPOOL_MAX_CLASSES];
+    uint64_t class_pass; /* pass of the class work was last taken from */
 
     /* Keep a histogram of how many times we had n threads busy */
     unsigned *busy_hist;
@@ -213,6 +250,10 @@ static void register_thdpool_tunables(char *name, struct thdpool *pool)
     REGISTER_THDPOOL_TUNABLE(name, dump_on_full, "Dump status on full queue.",
                              TUNABLE_BOOLEAN, &pool->dump_on_full, NOARG, NULL,
                              NULL, NULL, NULL);
+    REGISTER_THDPOOL_TUNABLE(
+        name, worksteal,
+        "Threads take queued work in batches and steal from each other.",
+        TUNABLE_BOOLEAN, &pool->worksteal, NOARG, NULL, NULL, NULL, NULL);
     return;
 }
 
@@ -251,6 +292,11 @@ struct thdpool *thdpool_create(const char *name, size_t per_thread_data_sz)
     listc_init(&pool->thdlist, offsetof(struct thd, thdlist_linkv));
     listc_init(&pool->freelist, offsetof(struct thd, freelist_linkv));
     listc_init(&pool->queue, offsetof(struct workitem, linkv));
+    for (int i = 0; i < THDPOOL_MAX_CLASSES; i++) {
+        listc_init(&pool->classes[i].queue,
+                   offsetof(struct workitem, class_linkv));
+        pool->classes[i].weight = 1;
+    }
 
     Pthread_mutex_init(&pool->mutex, NULL);
     Pthread_attr_init(&pool->attrs);
@@ -339,10 +385,22 @@ void thdpool_foreach(struct thdpool *pool, thdpool_foreach_fn foreach_fn,
     LOCK(&pool->mutex)
     {
         struct workitem *item;
+        struct thd *thd;
+        int i;
         LISTC_FOR_EACH(&pool->queue, item, linkv)
         {
             (foreach_fn)(pool, item, user);
         }
+        LISTC_FOR_EACH(&pool->thdlist, thd, thdlist_linkv)
+        {
+            Pthread_mutex_lock(&thd->local_lk);
+            for (i = 0; i < thd->local_cnt; i++)
+                (foreach_fn)(pool,
+                             thd->local[(thd->local_head + i) %
+                                        THDPOOL_LOCAL_MAX],
+                             user);
+            Pthread_mutex_unlock(&thd->local_lk);
+        }
     }
     UNLOCK(&pool->mutex);
 }
@@ -385,6 +443,27 @@ void thdpool_set_maxqueueoverride(struct thdpool *pool,
     pool->maxqueueoverride = maxqueueoverride;
 }
 
+void thdpool_set_class(struct thdpool *pool, int prio_class, unsigned weight,
+                       unsigned maxthds)
+{
+    if (prio_class < 0 || prio_class >= THDPOOL_MAX_CLASSES)
+        return;
+    LOCK(&pool->mutex)
+    {
+        struct thdpool_class *c = &pool->classes[prio_class];
+        struct thd *thd;
+        c->weight = weight > 0 ? weight : 1;
+        c->maxthds = maxthds;
+        /* work held back by the old limit can go to an idle thread now */
+        if (listc_size(&c->queue) > 0 &&
+            (thd = listc_rtl(&pool->freelist)) != NULL) {
+            thd->on_freelist = 0;
+            Pthread_cond_signal(&thd->cond);
+        }
+    }
+    UNLOCK(&pool->mutex);
+}
+
 void thdpool_set_stack_size(struct thdpool *pool, size_t sz_bytes)
 {
     LOCK(&pool->mutex)
@@ -444,6 +523,8 @@ void thdpool_print_stats(FILE *fh, struct thdpool *pool)
         logmsgf(LOGMSG_USER, fh, "  Num work items completed  : %u\n", pool->num_completed);
         logmsgf(LOGMSG_USER, fh, "  Num failed dispatches     : %u\n",
                 pool->num_failed_dispatches);
+        logmsgf(LOGMSG_USER, fh, "  Num work items stolen     : %u\n",
+                pool->num_stolen);
         logmsgf(LOGMSG_USER, fh, "  Desired num threads       : %u\n", pool->minnthd);
         logmsgf(LOGMSG_USER, fh, "  Maximum num threads       : %u\n", pool->maxnthd);
         logmsgf(LOGMSG_USER, fh, "  Num active threads        : %u\n", pool->nactthd);
@@ -452,7 +533,7 @@ void thdpool_print_stats(FILE *fh, struct thdpool *pool)
         logmsgf(LOGMSG_USER, fh, "  Work queue peak size      : %u\n", pool->peakqueue);
         logmsgf(LOGMSG_USER, fh, "  Work queue maximum size   : %u\n", pool->maxqueue);
         logmsgf(LOGMSG_USER, fh, "  Work queue current size   : %u\n",
-                listc_size(&pool->queue));
+                listc_size(&pool->queue) + ATOMIC_LOAD32(pool->nlocal));
         logmsgf(LOGMSG_USER, fh, "  Long wait alarm threshold : %u ms\n", pool->longwaitms);
         logmsgf(LOGMSG_USER, fh, "  Thread linger time        : %u seconds\n",
                 pool->lingersecs);
@@ -466,6 +547,23 @@ void thdpool_print_stats(FILE *fh, struct thdpool *pool)
                 pool->exit_on_create_fail ? "yes" : "no");
         logmsgf(LOGMSG_USER, fh, "  Dump on queue full        : %s\n",
                 pool->dump_on_full ? "yes" : "no");
+        logmsgf(LOGMSG_USER, fh, "  Work stealing             : %s\n",
+                pool->worksteal ? "yes" : "no");
+        for (ii = 0; ii < THDPOOL_MAX_CLASSES; ii++) {
+            struct thdpool_class *c = &pool->classes[ii];
+            if (c->num_enqueued == 0 && c->weight == 1 && c->maxthds == 0)
+                continue;
+            logmsgf(LOGMSG_USER, fh,
+                    "  Class %u                   : weight %u, max threads "
+                    "%u, running %u, queued %u, enqueued %u, dequeued %u, "
+                    "avg wait %" PRIu64 " ms\n",
+                    ii, c->weight, c->maxthds, ATOMIC_LOAD32(c->nrunning),
+                    listc_size(&c->queue), c->num_enqueued,
+                    ATOMIC_LOAD32(c->num_dequeued),
+                    c->num_dequeued ? ATOMIC_LOAD64(c->waitms) /
+                                          ATOMIC_LOAD32(c->num_dequeued)
+                                    : 0);
+        }
         for (ii = 0; ii < pool->busy_hist_len; ii++) {
             if ((ii & 3) == 0) {
                 logmsgf(LOGMSG_USER, fh, "  Busy threads histogram    : ");
@@ -593,7 +691,49 @@ void thdpool_process_message(struct thdpool *pool, char *line, int lline,
             pool->dump_on_full = 0;
             logmsg(LOGMSG_USER, "%s won't dump status on full queue\n", pool->name);
         }
+    } else if (tokcmp(tok, ltok, "worksteal") == 0) {
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok == 0)
+            return;
+        if (tokcmp(tok, ltok, "on") == 0) {
+            pool->worksteal = 1;
+            logmsg(LOGMSG_USER, "%s will take queued work in batches\n", pool->name);
+        } else if (tokcmp(tok, ltok, "off") == 0) {
+            pool->worksteal = 0;
+            logmsg(LOGMSG_USER, "%s will take queued work one item at a time\n", pool->name);
+        }
 
+    } else if (tokcmp(tok, ltok, "class") == 0) {
+        int prio_class;
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok == 0)
+            return;
+        prio_class = toknum(tok, ltok);
+        if (prio_class < 0 || prio_class >= THDPOOL_MAX_CLASSES) {
+            logmsg(LOGMSG_ERROR, "Pool [%s] class must be 0 to %d\n",
+                   pool->name, THDPOOL_MAX_CLASSES - 1);
+            return;
+        }
+        struct thdpool_class *c = &pool->classes[prio_class];
+        unsigned weight = c->weight, maxthds = c->maxthds;
+        tok = segtok(line, lline, &st, &ltok);
+        while (ltok > 0) {
+            if (tokcmp(tok, ltok, "weight") == 0) {
+                tok = segtok(line, lline, &st, &ltok);
+                weight = toknum(tok, ltok);
+            } else if (tokcmp(tok, ltok, "maxt") == 0) {
+                tok = segtok(line, lline, &st, &ltok);
+                maxthds = toknum(tok, ltok);
+            } else {
+                logmsg(LOGMSG_ERROR, "Pool [%s] unknown class option %.*s\n",
+                       pool->name, ltok, tok);
+                return;
+            }
+            tok = segtok(line, lline, &st, &ltok);
+        }
+        thdpool_set_class(pool, prio_class, weight, maxthds);
+        logmsg(LOGMSG_USER, "Pool [%s] class %d weight %u max threads %u\n",
+               pool->name, prio_class, c->weight, c->maxthds);
     } else if (tokcmp(tok, ltok, "help") == 0) {
         logmsg(LOGMSG_USER, "Pool [%s] commands:-\n", pool->name);
         logmsg(LOGMSG_USER, "  stop      -            stop all threads\n");
@@ -608,6 +748,8 @@ void thdpool_process_message(struct thdpool *pool, char *line, int lline,
         logmsg(LOGMSG_USER, "  maxagems #-            set maximum age in ms for in-queue time\n");
         logmsg(LOGMSG_USER, "  exit_on_error on/off - enable/disable exit on thread errors \n");
         logmsg(LOGMSG_USER, "  dump_on_full on/off -  enable/disable dumping status on full queue\n");
+        logmsg(LOGMSG_USER, "  worksteal on/off -     enable/disable batched dequeue with work stealing\n");
+        logmsg(LOGMSG_USER, "  class # [weight #] [maxt #] - set share and thread limit of a priority class\n");
     }
 }
 
@@ -631,10 +773,173 @@ void thdpool_resume(struct thdpool *pool)
     UNLOCK(&pool->mutex);
 }
 
+/* Take a work item out of a thread's batch: the oldest for the thread
+ * itself, the newest for a thief. */
+static struct workitem *take_local(struct thd *thd, int steal)
+{
+    struct workitem *item = NULL;
+    Pthread_mutex_lock(&thd->local_lk);
+    if (thd->local_cnt > 0) {
+        if (steal) {
+            item = thd->local[(thd->local_head + thd->local_cnt - 1) %
+                              THDPOOL_LOCAL_MAX];
+        } else {
+            item = thd->local[thd->local_head];
+            thd->local_head = (thd->local_head + 1) % THDPOOL_LOCAL_MAX;
+        }
+        thd->local_cnt--;
+        ATOMIC_ADD32(thd->pool->nlocal, -1);
+    }
+    Pthread_mutex_unlock(&thd->local_lk);
+    return item;
+}
+
+/* Called with the pool lock held.  Takes the first item off the queue of
+ * the class with the lowest pass among those with work waiting and room
+ * for another thread. */
+static struct workitem *take_queued_ll(struct thdpool *pool,
+                                       struct thdpool_class **pc)
+{
+    struct thdpool_class *c, *best = NULL;
+    struct workitem *item;
+    int i;
+
+    if (listc_size(&pool->queue) == 0)
+        return NULL;
+    for (i = 0; i < THDPOOL_MAX_CLASSES; i++) {
+        c = &pool->classes[i];
+        if (listc_size(&c->queue) == 0 ||
+            (c->maxthds > 0 && ATOMIC_LOAD32(c->nrunning) >= c->maxthds))
+            continue;
+        if (best == NULL || c->pass < best->pass)
+            best = c;
+    }
+    if (best == NULL)
+        return NULL;
+    item = listc_rtl(&best->queue);
+    listc_rfl(&pool->queue, item);
+    pool->class_pass = best->pass;
+    best->pass += THDPOOL_STRIDE / best->weight;
+    *pc = best;
+    return item;
+}
+
+/* Called with the pool lock held.  Returns the next queued work item for
+ * this thread, from its own batch, the pool queue or another thread's batch,
+ * in that order.  The caller releases the item. */
+static struct workitem *next_queued_ll(struct thd *thd)
+{
+    struct thdpool *pool = thd->pool;
+    struct thdpool_class *c;
+    struct workitem *next, *item;
+    struct thd *victim;
+    int nbatch;
+
+    if (thd->local_cnt > 0 && (next = take_local(thd, 0)) != NULL)
+        return next;
+
+    if ((next = take_queued_ll(pool, &c)) != NULL) {
+        if (pool->worksteal && c->maxthds == 0) {
+            /* take a fair share of a long queue, so the next few items
+             * don't need the pool lock; a batch is all of one class */
+            nbatch = listc_size(&c->queue) / listc_size(&pool->thdlist);
+            if (nbatch > THDPOOL_LOCAL_MAX)
+                nbatch = THDPOOL_LOCAL_MAX;
+            if (nbatch > 0) {
+                Pthread_mutex_lock(&thd->local_lk);
+                while (thd->local_cnt < nbatch &&
+                       (item = listc_rtl(&c->queue)) != NULL) {
+                    listc_rfl(&pool->queue, item);
+                    c->pass += THDPOOL_STRIDE / c->weight;
+                    thd->local[(thd->local_head + thd->local_cnt) %
+                               THDPOOL_LOCAL_MAX] = item;
+                    thd->local_cnt++;
+                    ATOMIC_ADD32(pool->nlocal, 1);
+                }
+                Pthread_mutex_unlock(&thd->local_lk);
+            }
+        }
+        return next;
+    }
+
+    if (ATOMIC_LOAD32(pool->nlocal) > 0) {
+        LISTC_FOR_EACH(&pool->thdlist, victim, thdlist_linkv)
+        {
+            if (victim != thd && victim->local_cnt > 0 &&
+                (next = take_local(victim, 1)) != NULL) {
+                pool->num_stolen++;
+                return next;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Hand the work items this thread ran from its batch back to pool->pool.
+ * Called with the pool lock held. */
+static void release_spent_ll(struct thd *thd)
+{
+    struct workitem *item;
+    while ((item = listc_rtl(&thd->spent)) != NULL)
+        pool_relablk(thd->pool->pool, item);
+}
+
+/* Take the work out of a dequeued item.  Returns 0 if it was too old and
+ * was freed instead. */
+static int dequeue_work(struct thdpool *pool, struct workitem *next,
+                        struct workitem *work)
+{
+    int force_timeout = 0;
+    if ((pool->maxqueueagems > 0) && gbl_random_thdpool_work_timeout &&
+        !(rand() % gbl_random_thdpool_work_timeout)) {
+        force_timeout = 1;
+        logmsg(LOGMSG_WARN, "%s: forcing a random work item timeout\n",
+               __func__);
+    }
+    if (force_timeout ||
+        (pool->maxqueueagems > 0 &&
+         comdb2_time_epochms() - next->queue_time_ms > pool->maxqueueagems)) {
+        if (pool->dque_fn)
+            pool->dque_fn(pool, next, 1);
+        if (next->ref_persistent_info) {
+            put_ref(&next->ref_persistent_info);
+        }
+        next->work_fn(pool, next->work, NULL, THD_FREE);
+        ATOMIC_ADD32(pool->num_timeout, 1);
+        return 0;
+    }
+
+    if (pool->dque_fn)
+        pool->dque_fn(pool, next, 0);
+    memcpy(work, next, sizeof(*work));
+    ATOMIC_ADD32(pool->num_dequeued, 1);
+
+    struct thdpool_class *c = &pool->classes[next->prio_class];
+    ATOMIC_ADD32(c->nrunning, 1);
+    ATOMIC_ADD32(c->num_dequeued, 1);
+    ATOMIC_ADD64(c->waitms, comdb2_time_epochms() - next->queue_time_ms);
+    return 1;
+}
+
+/* Work-stealing mode: run the next item of this thread's batch without
+ * taking the pool lock.  Returns 0 if the batch is empty. */
+static int get_local_work(struct thd *thd, struct workitem *work)
+{
+    struct workitem *next;
+    while (thd->local_cnt > 0 && (next = take_local(thd, 0)) != NULL) {
+        int got = dequeue_work(thd->pool, next, work);
+        listc_abl(&thd->spent, next);
+        if (got)
+            return 1;
+    }
+    return 0;
+}
+
 /* Get the next item of work for this thread to do.  Returns 0 if there
  * is no work. */
 static int get_work_ll(struct thd *thd, struct workitem *work)
 {
+    release_spent_ll(thd);
     if (thd->work.available) {
         memcpy(work, &thd->work, sizeof(struct workitem));
         memset(&thd->work, 0, sizeof(struct workitem));
@@ -642,36 +947,11 @@ static int get_work_ll(struct thd *thd, struct workitem *work)
     } else {
         struct thdpool *pool = thd->pool;
         struct workitem *next;
-        while ((next = listc_rtl(&pool->queue)) != NULL) {
-            int force_timeout = 0;
-            if ((thd->pool->maxqueueagems > 0) &&
-                gbl_random_thdpool_work_timeout &&
-                !(rand() % gbl_random_thdpool_work_timeout)) {
-                force_timeout = 1;
-                logmsg(LOGMSG_WARN,
-                       "%s: forcing a random work item timeout\n",
-                       __func__);
-            }
-            if (force_timeout || (thd->pool->maxqueueagems > 0 &&
-                comdb2_time_epochms() - next->queue_time_ms >
-                    pool->maxqueueagems)) {
-                if (pool->dque_fn)
-                    pool->dque_fn(thd->pool, next, 1);
-                if (next->ref_persistent_info) {
-                    put_ref(&next->ref_persistent_info);
-                }
-                next->work_fn(pool, next->work, NULL, THD_FREE);
-                pool_relablk(pool->pool, next);
-                thd->pool->num_timeout++;
-                continue;
-            }
-
-            if (pool->dque_fn)
-                pool->dque_fn(pool, next, 0);
-            memcpy(work, next, sizeof(*work));
+        while ((next = next_queued_ll(thd)) != NULL) {
+            int got = dequeue_work(pool, next, work);
             pool_relablk(pool->pool, next);
-            pool->num_dequeued++;
-            return 1;
+            if (got)
+                return 1;
         }
         return 0;
     }
@@ -714,96 +994,104 @@ static void *thdpool_thd(void *voidarg)
     while (1) {
         int diffms;
 
-        LOCK(&pool->mutex)
-        {
-            thd->persistent_info = "looking for work...";
-
-            struct timespec timeout;
-            struct timespec *ts = NULL;
-            int thr_exit = 0;
-
-            if (pool->maxnthd > 0 &&
-                listc_size(&pool->thdlist) > (pool->maxnthd + pool->nwaitthd))
-                check_exit = 1;
+        if (get_local_work(thd, &work)) {
+            if (work.ref_persistent_info)
+                thd->persistent_info = string_ref_cstr(work.ref_persistent_info);
             else
-                check_exit = 0;
-
-            if (pool->waiting_for_thread)
-                Pthread_cond_signal(&pool->wait_for_thread);
-
-            /* Get work.  If there is no work then place us on the free
-             * list and wait for work. */
-            memset(&work, 0, sizeof(struct workitem)); /* work is output, zero first */
-            while (!get_work_ll(thd, &work)) {
-                int rc = 0;
-                if (listc_size(&pool->thdlist) > pool->minnthd && !ts) {
-                    /* we have more threads than we want - wait for a bit then
-                     * timeout */
-                    if (pool->lingersecs > 0) {
-                        struct timeval tp;
-                        gettimeofday(&tp, NULL);
-                        timeout.tv_sec = tp.tv_sec + pool->lingersecs;
-                        timeout.tv_nsec = tp.tv_usec * 1000;
-                        ts = &timeout;
+                thd->persistent_info = "working on unknown";
+        } else {
+            LOCK(&pool->mutex)
+            {
+                thd->persistent_info = "looking for work...";
+
+                struct timespec timeout;
+                struct timespec *ts = NULL;
+                int thr_exit = 0;
+
+                if (pool->maxnthd > 0 &&
+                    listc_size(&pool->thdlist) > (pool->maxnthd + pool->nwaitthd))
+                    check_exit = 1;
+                else
+                    check_exit = 0;
+
+                if (pool->waiting_for_thread)
+                    Pthread_cond_signal(&pool->wait_for_thread);
+
+                /* Get work.  If there is no work then place us on the free
+                 * list and wait for work. */
+                memset(&work, 0, sizeof(struct workitem)); /* work is output, zero first */
+                while (!get_work_ll(thd, &work)) {
+                    int rc = 0;
+                    if (listc_size(&pool->thdlist) > pool->minnthd && !ts) {
+                        /* we have more threads than we want - wait for a bit then
+                         * timeout */
+                        if (pool->lingersecs > 0) {
+                            struct timeval tp;
+                            gettimeofday(&tp, NULL);
+                            timeout.tv_sec = tp.tv_sec + pool->lingersecs;
+                            timeout.tv_nsec = tp.tv_usec * 1000;
+                            ts = &timeout;
+                        } else {
+                            /* no linger, die now */
+                            thr_exit = 1;
+                        }
+                    }
+                    if (pool->stopped || thr_exit) {
+                        /* Thread exiting - remove from pools lists */
+                        listc_rfl(&pool->thdlist, thd);
+                        if (thd->on_freelist) {
+                            listc_rfl(&pool->freelist, thd);
+                            thd->on_freelist = 0;
+                        }
+                        pool->num_exits++;
+                        release_spent_ll(thd);
+                        errUNLOCK(&pool->mutex);
+
+                        goto thread_exit;
+                    }
+                    /* Go to the head of the free list so we get work sooner.  This
+                     * way the same thread keeps busy most of the time so we get
+                     * better cache localities etc and most significantly of all
+                     * excess threads can timeout and die.  We explicitly don't
+                     * want to round robin our work distribution as that spoils
+                     * the timeout logic. */
+                    if (!thd->on_freelist) {
+                        listc_atl(&pool->freelist, thd);
+                        thd->on_freelist = 1;
+                    }
+                    if (ts) {
+                        rc = pthread_cond_timedwait(&thd->cond, &pool->mutex, ts);
                     } else {
-                        /* no linger, die now */
-                        thr_exit = 1;
+                        Pthread_cond_wait(&thd->cond, &pool->mutex);
                     }
-                }
-                if (pool->stopped || thr_exit) {
-                    /* Thread exiting - remove from pools lists */
-                    listc_rfl(&pool->thdlist, thd);
-                    if (thd->on_freelist) {
-                        listc_rfl(&pool->freelist, thd);
-                        thd->on_freelist = 0;
+                    if (rc == ETIMEDOUT) {
+                        /* Make sure we don't get into a hot loop. */
+                        ts = NULL;
+                        /* If there's still no work we'll die. */
+                        thr_exit = 1;
+                    } else if (rc != 0 && rc != EINTR) {
+                        logmsg(LOGMSG_ERROR,
+                               "%s(%s):pthread_cond_timedwait: %d %s\n", __func__,
+                               pool->name, rc, strerror(rc));
                     }
-                    pool->num_exits++;
-                    errUNLOCK(&pool->mutex);
-
-                    goto thread_exit;
-                }
-                /* Go to the head of the free list so we get work sooner.  This
-                 * way the same thread keeps busy most of the time so we get
-                 * better cache localities etc and most significantly of all
-                 * excess threads can timeout and die.  We explicitly don't
-                 * want to round robin our work distribution as that spoils
-                 * the timeout logic. */
-                if (!thd->on_freelist) {
-                    listc_atl(&pool->freelist, thd);
-                    thd->on_freelist = 1;
                 }
-                if (ts) {
-                    rc = pthread_cond_timedwait(&thd->cond, &pool->mutex, ts);
-                } else {
-                    Pthread_cond_wait(&thd->cond, &pool->mutex);
-                }
-                if (rc == ETIMEDOUT) {
-                    /* Make sure we don't get into a hot loop. */
-                    ts = NULL;
-                    /* If there's still no work we'll die. */
-                    thr_exit = 1;
-                } else if (rc != 0 && rc != EINTR) {
-                    logmsg(LOGMSG_ERROR,
-                           "%s(%s):pthread_cond_timedwait: %d %s\n", __func__,
-                           pool->name, rc, strerror(rc));
-                }
-            }
 
-            /* We have work.  We will already have been removed from the
-             * free list by the enqueue function so just take our work
-             * parameters, release lock and do it. */
+                /* We have work.  We will already have been removed from the
+                 * free list by the enqueue function so just take our work
+                 * parameters, release lock and do it. */
 
-            /* Since there is (now) no escape from this code path without
-             * actually performing the work, set the thread state for the
-             * current work in progress, obtained from get_work_ll, while
-             * still holding the pool lock. */
+                /* Since there is (now) no escape from this code path without
+                 * actually performing the work, set the thread state for the
+                 * current work in progress, obtained from get_work_ll, while
+                 * still holding the pool lock. */
 
-            if (work.ref_persistent_info)
-                thd->persistent_info = string_ref_cstr(work.ref_persistent_info); // will reset this before put_ref() below
-            else
-                thd->persistent_info = "working on unknown";
+                if (work.ref_persistent_info)
+                    thd->persistent_info = string_ref_cstr(work.ref_persistent_info); // will reset this before put_ref() below
+                else
+                    thd->persistent_info = "working on unknown";
+            }
+            UNLOCK(&pool->mutex);
         }
-        UNLOCK(&pool->mutex);
 
         diffms = comdb2_time_epochms() - work.queue_time_ms;
         if (diffms > pool->longwaitms) {
@@ -816,42 +1104,31 @@ static void *thdpool_thd(void *voidarg)
         ATOMIC_ADD32(pool->nwrkthd, -1);
         ATOMIC_ADD32(pool->num_completed, 1);
 
-        /* work is no longer pending, reset thread state for
-         * the current work in progress before doing anything
-         * else.  this should make it as accurate as possible
-         * from the perspective of other threads that may need
-         * to examine it. */
+        /* might this is set at a certain point by work_fn */
+        thread_util_donework();
+
+        /* work is no longer pending: reset thread state for the current
+         * work in progress, see if we are one thread too many, and get
+         * ready to yield, all in one trip through the pool lock. */
         LOCK(&pool->mutex) {
-            thd->persistent_info = "work completed.";
+            thd->persistent_info = "yielding...";
             if (work.ref_persistent_info) {
                 put_ref(&work.ref_persistent_info);
             }
-        }
-        UNLOCK(&pool->mutex);
-
-        /* might this is set at a certain point by work_fn */
-        thread_util_donework();
-        if (check_exit) {
-            LOCK(&pool->mutex)
-            {
-                if (pool->maxnthd > 0 && listc_size(&pool->thdlist) >
-                                             (pool->maxnthd + pool->nwaitthd)) {
-                    listc_rfl(&pool->thdlist, thd);
-                    if (thd->on_freelist) {
-                        listc_rfl(&pool->freelist, thd);
-                        thd->on_freelist = 0;
-                    }
-                    pool->num_exits++;
-                    errUNLOCK(&pool->mutex);
-                    goto thread_exit;
+            ATOMIC_ADD32(pool->classes[work.prio_class].nrunning, -1);
+            /* a thread holding a batch of work stays to finish it */
+            if (check_exit && thd->local_cnt == 0 && pool->maxnthd > 0 &&
+                listc_size(&pool->thdlist) > (pool->maxnthd + pool->nwaitthd)) {
+                listc_rfl(&pool->thdlist, thd);
+                if (thd->on_freelist) {
+                    listc_rfl(&pool->freelist, thd);
+                    thd->on_freelist = 0;
                 }
+                pool->num_exits++;
+                release_spent_ll(thd);
+                errUNLOCK(&pool->mutex);
+                goto thread_exit;
             }
-            UNLOCK(&pool->mutex);
-        }
-
-        // ready to perform yield operation, update thread info again
-        LOCK(&pool->mutex) {
-            thd->persistent_info = "yielding...";
         }
         UNLOCK(&pool->mutex);
 
@@ -865,6 +1142,7 @@ thread_exit:
         delt_fn(pool, thddata);
 
     Pthread_cond_destroy(&thd->cond);
+    Pthread_mutex_destroy(&thd->local_lk);
 
     thread_memdestroy();
 
@@ -881,6 +1159,15 @@ thread_exit:
 int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
                     int queue_override, struct string_ref *ref_persistent_info,
                     uint32_t flags)
+{
+    return thdpool_enqueue_class(pool, work_fn, work, queue_override,
+                                 ref_persistent_info, flags, 0);
+}
+
+int thdpool_enqueue_class(struct thdpool *pool, thdpool_work_fn work_fn,
+                          void *work, int queue_override,
+                          struct string_ref *ref_persistent_info,
+                          uint32_t flags, int prio_class)
 {
     static time_t last_dump = 0;
     int enqueue_front = (flags & THDPOOL_ENQUEUE_FRONT);
@@ -900,6 +1187,14 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
         unsigned nbusy;
         int did_create = 0;
 
+        if (prio_class < 0 || prio_class >= THDPOOL_MAX_CLASSES)
+            prio_class = 0;
+        struct thdpool_class *c = &pool->classes[prio_class];
+        /* a class at its thread limit waits in the queue for one of its
+         * own threads to finish, even if others are free */
+        int class_full =
+            c->maxthds > 0 && ATOMIC_LOAD32(c->nrunning) >= c->maxthds;
+
         if (pool->stopped) {
             pool->num_failed_dispatches++;
             errUNLOCK(&pool->mutex);
@@ -938,12 +1233,12 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
      * until the lock is released, which gives us a window to assign the
      * work item to the new thread. */
     again:
-        thd = listc_rtl(&pool->freelist);
+        thd = class_full ? NULL : listc_rtl(&pool->freelist);
         if (thd) {
             assert(thd->on_freelist);
             thd->on_freelist = 0;
         }
-        if (!thd &&
+        if (!thd && !class_full &&
             (force_dispatch || pool->maxnthd == 0 ||
              listc_size(&pool->thdlist) < (pool->maxnthd + pool->nwaitthd))) {
             int rc;
@@ -958,6 +1253,8 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
             }
 
             Pthread_cond_init(&thd->cond, NULL);
+            Pthread_mutex_init(&thd->local_lk, NULL);
+            listc_init(&thd->spent, offsetof(struct workitem, linkv));
             thd->pool = pool;
             listc_atl(&pool->thdlist, thd);
 
@@ -983,6 +1280,7 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
                 logmsg(LOGMSG_ERROR, "%s(%s):pthread_create: %d %s\n", __func__,
                         pool->name, rc, strerror(rc));
                 Pthread_cond_destroy(&thd->cond);
+                Pthread_mutex_destroy(&thd->local_lk);
                 free(thd);
                 return -1;
             }
@@ -993,7 +1291,8 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
             pool->num_creates++;
         }
 
-        if ((queue_only && did_create) || (thd == NULL && pool->wait)) {
+        if ((queue_only && did_create) ||
+            (thd == NULL && pool->wait && !class_full)) {
 
             pool->waiting_for_thread = 1;
             Pthread_cond_wait(&pool->wait_for_thread, &pool->mutex);
@@ -1005,6 +1304,7 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
         if (!queue_only && thd) {
             item = &thd->work;
             pool->num_passed++;
+            ATOMIC_ADD32(c->nrunning, 1);
         } else {
 #ifndef NDEBUG
             /* TODO: Carefully evaluate this code for non-debug builds. */
@@ -1017,7 +1317,8 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
             }
 #endif
             /* queue work */
-            int queue_count = listc_size(&pool->queue);
+            int queue_count =
+                listc_size(&pool->queue) + ATOMIC_LOAD32(pool->nlocal);
 
             if (queue_count >= pool->maxqueue) {
                 if (force_queue ||
@@ -1098,11 +1399,19 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
                 return -1;
             }
 
-            if (enqueue_front)
+            /* a class that had nothing waiting starts level with the one
+             * served last instead of spending credit it saved up idle */
+            if (listc_size(&c->queue) == 0 && c->pass < pool->class_pass)
+                c->pass = pool->class_pass;
+            if (enqueue_front) {
                 listc_atl(&pool->queue, item);
-            else
+                listc_atl(&c->queue, item);
+            } else {
                 listc_abl(&pool->queue, item);
+                listc_abl(&c->queue, item);
+            }
             pool->num_enqueued++;
+            c->num_enqueued++;
 
             if (pool->queued_callback)
                 pool->queued_callback(work);
@@ -1116,6 +1425,7 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
         item->work_fn = work_fn;
         transfer_ref(&ref_persistent_info, &item->ref_persistent_info); // item gets ownership of reference
         item->queue_time_ms = comdb2_time_epochms();
+        item->prio_class = prio_class;
         item->available = 1;
 
         /* Now wake up the thread with work to do. */
@@ -1234,7 +1544,7 @@ int thdpool_get_maxqueue(struct thdpool *pool)
 
 int thdpool_get_nqueuedworks(struct thdpool *pool)
 {
-    return listc_size(&pool->queue);
+    return listc_size(&pool->queue) + ATOMIC_LOAD32(pool->nlocal);
 }
 
 int thdpool_get_longwaitms(struct thdpool *pool)
@@ -1291,7 +1601,7 @@ struct thdpool *thdpool_next_pool(struct thdpool *pool)
 
 int thdpool_get_queue_depth(struct thdpool *pool)
 {
-    return listc_size(&pool->queue);
+    return listc_size(&pool->queue) + ATOMIC_LOAD32(pool->nlocal);
 }
 
 void thdpool_set_queued_callback(struct thdpool *pool, void(*callback)(void*)) 
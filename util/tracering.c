@@ -0,0 +1,215 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "locks_wrap.h"
+#include "tracering.h"
+
+int gbl_trace_ring_mask = 0;
+int gbl_trace_ring_entries = 4096;
+
+/* An entry is valid while seq is the (nonzero) position it was written at.
+ * The owner zeroes seq before it rewrites an entry, so a reader that sees
+ * the same seq before and after copying it got a consistent copy. */
+struct trace_ent {
+    uint64_t seq;
+    int64_t ns;
+    const char *fmt;
+    uint64_t args[4];
+    int cat;
+};
+
+/* Rings are never freed: when a thread exits its ring keeps its traces and
+ * goes to the next thread that starts tracing. */
+struct trace_ring {
+    uint64_t head;
+    uint64_t mask;
+    int tid;
+    int in_use;
+    struct trace_ring *next;
+    struct trace_ent ents[];
+};
+
+static pthread_mutex_t rings_lk = PTHREAD_MUTEX_INITIALIZER;
+static struct trace_ring *rings;
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+static pthread_key_t ring_key;
+static __thread struct trace_ring *my_ring;
+
+static void ring_release(void *arg)
+{
+    struct trace_ring *r = arg;
+    Pthread_mutex_lock(&rings_lk);
+    r->in_use = 0;
+    Pthread_mutex_unlock(&rings_lk);
+}
+
+static void trace_ring_init(void)
+{
+    pthread_key_create(&ring_key, ring_release);
+}
+
+static struct trace_ring *ring_get(void)
+{
+    struct trace_ring *r;
+    uint64_t n = 64;
+
+    while (n < gbl_trace_ring_entries && n < (1 << 20))
+        n <<= 1;
+
+    pthread_once(&once, trace_ring_init);
+    Pthread_mutex_lock(&rings_lk);
+    for (r = rings; r; r = r->next)
+        if (!r->in_use && r->mask + 1 == n)
+            break;
+    if (r == NULL && (r = calloc(1, sizeof(*r) + n * sizeof(r->ents[0])))) {
+        r->mask = n - 1;
+        r->next = rings;
+        rings = r;
+    }
+    if (r) {
+        r->in_use = 1;
+        r->tid = syscall(SYS_gettid);
+    }
+    Pthread_mutex_unlock(&rings_lk);
+    if (r)
+        pthread_setspecific(ring_key, r);
+    return r;
+}
+
+void trace_ring_add(int cat, const char *fmt, uint64_t a, uint64_t b,
+                    uint64_t c, uint64_t d)
+{
+    struct trace_ring *r = my_ring;
+    struct trace_ent *e;
+    struct timespec ts;
+    uint64_t pos;
+
+    if (r == NULL && (r = my_ring = ring_get()) == NULL)
+        return;
+
+    pos = r->head;
+    e = &r->ents[pos & r->mask];
+    __atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    clock_gettime(CLOCK_REALTIME, &ts);
+    e->ns = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    e->fmt = fmt;
+    e->args[0] = a;
+    e->args[1] = b;
+    e->args[2] = c;
+    e->args[3] = d;
+    e->cat = cat;
+    __atomic_store_n(&e->seq, pos + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&r->head, pos + 1, __ATOMIC_RELEASE);
+}
+
+struct trace_copy {
+    struct trace_ent ent;
+    int tid;
+};
+
+static int copy_cmp(const void *a, const void *b)
+{
+    const struct trace_copy *x = a, *y = b;
+    if (x->ent.ns != y->ent.ns)
+        return x->ent.ns < y->ent.ns ? -1 : 1;
+    return x->ent.seq < y->ent.seq ? -1 : x->ent.seq > y->ent.seq;
+}
+
+static const char *cat_name(int cat)
+{
+    switch (cat) {
+    case TRACE_OSQL: return "osql";
+    case TRACE_NET: return "net";
+    case TRACE_REP: return "rep";
+    default: return "-";
+    }
+}
+
+int trace_ring_dump(FILE *f)
+{
+    struct trace_ring *r;
+    struct trace_copy *copy, *p;
+    struct trace_ent *e;
+    uint64_t seq, i;
+    size_t n = 0, alloc = 0;
+    char tbuf[32];
+    struct tm tm;
+    time_t sec;
+
+    Pthread_mutex_lock(&rings_lk);
+    for (r = rings; r; r = r->next)
+        alloc += r->mask + 1;
+    if ((copy = malloc((alloc ? alloc : 1) * sizeof(*copy))) == NULL) {
+        Pthread_mutex_unlock(&rings_lk);
+        return -1;
+    }
+    for (r = rings; r; r = r->next) {
+        for (i = 0; i <= r->mask; i++) {
+            e = &r->ents[i];
+            p = &copy[n];
+            seq = __atomic_load_n(&e->seq, __ATOMIC_ACQUIRE);
+            if (seq == 0)
+                continue;
+            p->ent = *e;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&e->seq, __ATOMIC_RELAXED) != seq)
+                continue; /* overwritten while we copied it */
+            p->ent.seq = seq;
+            p->tid = r->tid;
+            n++;
+        }
+    }
+    Pthread_mutex_unlock(&rings_lk);
+
+    qsort(copy, n, sizeof(*copy), copy_cmp);
+    for (i = 0; i < n; i++) {
+        e = &copy[i].ent;
+        sec = e->ns / 1000000000LL;
+        localtime_r(&sec, &tm);
+        strftime(tbuf, sizeof(tbuf), "%Y/%m/%d %H:%M:%S", &tm);
+        fprintf(f, "%s.%06lld %d %s: ", tbuf,
+                (long long)(e->ns % 1000000000LL) / 1000, copy[i].tid,
+                cat_name(e->cat));
+        fprintf(f, e->fmt, (unsigned long long)e->args[0],
+                (unsigned long long)e->args[1], (unsigned long long)e->args[2],
+                (unsigned long long)e->args[3]);
+        fputc('\n', f);
+    }
+    free(copy);
+    return 0;
+}
+
+void trace_ring_clear(void)
+{
+    struct trace_ring *r;
+    uint64_t i;
+
+    /* Only the entries' seq is cleared, which makes them invalid; a thread
+     * tracing at the same time may leave one behind, which is harmless. */
+    Pthread_mutex_lock(&rings_lk);
+    for (r = rings; r; r = r->next)
+        for (i = 0; i <= r->mask; i++)
+            __atomic_store_n(&r->ents[i].seq, 0, __ATOMIC_RELAXED);
+    Pthread_mutex_unlock(&rings_lk);
+}
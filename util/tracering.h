@@ -0,0 +1,61 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_TRACERING_H
+#define INCLUDED_TRACERING_H
+
+/* Binary trace rings for hot paths.
+ *
+ * TRACE_RING() stores a timestamp, a format and up to four integer arguments
+ * in a ring owned by the calling thread: no lock, no formatting, no
+ * allocation after a thread's first trace.  Formatting happens when the
+ * rings are dumped ("tracering dump"), merged across threads by time.  A
+ * ring keeps the last trace_ring_entries traces of its thread.
+ *
+ * The format must be a string literal, as it is only read at dump time, and
+ * must only use conversions that take a long long (%lld, %llu, %llx); every
+ * argument is passed as one.  The only strings that can be traced with %s
+ * are ones that are never freed, like interned host names: anything else
+ * may be gone by the time it is printed. */
+
+#include <stdint.h>
+#include <stdio.h>
+
+enum {
+    TRACE_OSQL = 0x1,
+    TRACE_NET = 0x2,
+    TRACE_REP = 0x4,
+};
+
+extern int gbl_trace_ring_mask;
+extern int gbl_trace_ring_entries;
+
+void trace_ring_add(int cat, const char *fmt, uint64_t a, uint64_t b,
+                    uint64_t c, uint64_t d);
+
+#define TRACE_RING(cat, fmt, a, b, c, d)                                       \
+    do {                                                                       \
+        if (gbl_trace_ring_mask & (cat))                                       \
+            trace_ring_add((cat), "" fmt, (uint64_t)(a), (uint64_t)(b),        \
+                           (uint64_t)(c), (uint64_t)(d));                      \
+    } while (0)
+
+/* Write every trace still in the rings to f, oldest first. */
+int trace_ring_dump(FILE *f);
+/* Forget every trace. */
+void trace_ring_clear(void);
+
+#endif